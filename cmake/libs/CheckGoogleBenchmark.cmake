@@ -0,0 +1,15 @@
+# Check for Google Benchmark.
+# Google Benchmark is optional. It's only used for the
+# image decoding benchmark suite in librptexture/tests.
+
+UNSET(HAVE_GOOGLE_BENCHMARK)
+IF(BUILD_BENCHMARKS AND BUILD_TESTING)
+	FIND_PACKAGE(benchmark QUIET)
+	IF(benchmark_FOUND)
+		# Found system Google Benchmark.
+		SET(HAVE_GOOGLE_BENCHMARK 1)
+	ELSE()
+		# System Google Benchmark was not found.
+		MESSAGE(STATUS "Google Benchmark was not found. The benchmark suite will not be built.")
+	ENDIF()
+ENDIF(BUILD_BENCHMARKS AND BUILD_TESTING)
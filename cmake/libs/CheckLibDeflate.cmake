@@ -0,0 +1,15 @@
+# Check for libdeflate.
+# libdeflate is optional. If it isn't found, zlib will be used
+# to decompress zlib-compressed disc image blocks.
+
+UNSET(HAVE_LIBDEFLATE)
+IF(ENABLE_LIBDEFLATE)
+	FIND_PACKAGE(LibDeflate)
+	IF(LibDeflate_FOUND)
+		# Found system libdeflate.
+		SET(HAVE_LIBDEFLATE 1)
+	ELSE()
+		# System libdeflate was not found.
+		MESSAGE(STATUS "libdeflate was not found. zlib will be used for block decompression.")
+	ENDIF()
+ENDIF(ENABLE_LIBDEFLATE)
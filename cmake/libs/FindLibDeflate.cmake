@@ -0,0 +1,22 @@
+# Find libdeflate libraries and headers.
+# If found, the following variables will be defined:
+# - LibDeflate_FOUND: System has libdeflate.
+# - LibDeflate_INCLUDE_DIRS: libdeflate include directories.
+# - LibDeflate_LIBRARIES: libdeflate libraries.
+# - LibDeflate_DEFINITIONS: Compiler switches required for using libdeflate.
+#
+# In addition, a target LibDeflate::libdeflate will be created with all of
+# these definitions.
+#
+# References:
+# - https://cmake.org/Wiki/CMake:How_To_Find_Libraries
+# - http://francesco-cek.com/cmake-and-gtk-3-the-easy-way/
+#
+
+INCLUDE(FindLibraryPkgConfig)
+FIND_LIBRARY_PKG_CONFIG(LibDeflate
+	libdeflate		# pkgconfig
+	libdeflate.h		# header
+	deflate			# library
+	LibDeflate::libdeflate	# imported target
+	)
@@ -0,0 +1,40 @@
+# Find tracker-extract libraries and headers. (tracker-miners 3.x)
+# If found, the following variables will be defined:
+# - TrackerExtract3_FOUND: System has tracker-extract.
+# - TrackerExtract3_INCLUDE_DIRS: tracker-extract include directories.
+# - TrackerExtract3_LIBRARIES: tracker-extract libraries.
+# - TrackerExtract3_DEFINITIONS: Compiler switches required for using tracker-extract.
+# - TrackerExtract3_MODULES_DIR: Extractor modules directory. (for installation)
+# - TrackerExtract3_RULES_DIR: Extractor rules directory. (for installation)
+#
+# In addition, a target Tracker::extract-3.0 will be created with all of
+# these definitions.
+#
+# NOTE: libtracker-extract is part of tracker-miners, which doesn't
+# install its headers by default. Some distributions ship them in a
+# development package; if they aren't available, the tracker-extract
+# module won't be built.
+#
+# References:
+# - https://cmake.org/Wiki/CMake:How_To_Find_Libraries
+# - http://francesco-cek.com/cmake-and-gtk-3-the-easy-way/
+#
+
+INCLUDE(FindLibraryPkgConfig)
+FIND_LIBRARY_PKG_CONFIG(TrackerExtract3
+	tracker-extract-3.0			# pkgconfig
+	libtracker-extract/tracker-extract.h	# header
+	tracker-extract				# library
+	Tracker::extract-3.0			# imported target
+	)
+
+# Extractor modules and rules directories.
+IF(TrackerExtract3_FOUND)
+	INCLUDE(DirInstallPaths)
+	IF(NOT TrackerExtract3_MODULES_DIR)
+		SET(TrackerExtract3_MODULES_DIR "${CMAKE_INSTALL_PREFIX}/${DIR_INSTALL_LIB}/tracker-miners-3.0/extract-modules" CACHE INTERNAL "TrackerExtract3_MODULES_DIR")
+	ENDIF(NOT TrackerExtract3_MODULES_DIR)
+	IF(NOT TrackerExtract3_RULES_DIR)
+		SET(TrackerExtract3_RULES_DIR "${CMAKE_INSTALL_PREFIX}/${CMAKE_INSTALL_DATAROOTDIR}/tracker3-miners/extract-rules" CACHE INTERNAL "TrackerExtract3_RULES_DIR")
+	ENDIF(NOT TrackerExtract3_RULES_DIR)
+ENDIF(TrackerExtract3_FOUND)
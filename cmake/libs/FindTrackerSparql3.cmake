@@ -0,0 +1,22 @@
+# Find Tracker SPARQL libraries and headers. (Tracker 3.x)
+# If found, the following variables will be defined:
+# - TrackerSparql3_FOUND: System has Tracker SPARQL.
+# - TrackerSparql3_INCLUDE_DIRS: Tracker SPARQL include directories.
+# - TrackerSparql3_LIBRARIES: Tracker SPARQL libraries.
+# - TrackerSparql3_DEFINITIONS: Compiler switches required for using Tracker SPARQL.
+#
+# In addition, a target Tracker::sparql-3.0 will be created with all of
+# these definitions.
+#
+# References:
+# - https://cmake.org/Wiki/CMake:How_To_Find_Libraries
+# - http://francesco-cek.com/cmake-and-gtk-3-the-easy-way/
+#
+
+INCLUDE(FindLibraryPkgConfig)
+FIND_LIBRARY_PKG_CONFIG(TrackerSparql3
+	tracker-sparql-3.0			# pkgconfig
+	libtracker-sparql/tracker-sparql.h	# header
+	tracker-sparql-3.0			# library
+	Tracker::sparql-3.0			# imported target
+	)
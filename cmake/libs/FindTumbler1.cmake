@@ -0,0 +1,29 @@
+# Find tumbler libraries and headers.
+# If found, the following variables will be defined:
+# - Tumbler1_FOUND: System has tumbler.
+# - Tumbler1_INCLUDE_DIRS: tumbler include directories.
+# - Tumbler1_LIBRARIES: tumbler libraries.
+# - Tumbler1_DEFINITIONS: Compiler switches required for using tumbler.
+# - Tumbler1_PLUGIN_DIR: Plugin directory. (for installation)
+#
+# In addition, a target Xfce::tumbler-1 will be created with all of
+# these definitions.
+#
+# References:
+# - https://cmake.org/Wiki/CMake:How_To_Find_Libraries
+# - http://francesco-cek.com/cmake-and-gtk-3-the-easy-way/
+#
+
+INCLUDE(FindLibraryPkgConfig)
+FIND_LIBRARY_PKG_CONFIG(Tumbler1
+	tumbler-1		# pkgconfig
+	tumbler/tumbler.h	# header
+	tumbler-1		# library
+	Xfce::tumbler-1		# imported target
+	)
+
+# Plugin directory.
+IF(Tumbler1_FOUND AND NOT Tumbler1_PLUGIN_DIR)
+	INCLUDE(DirInstallPaths)
+	SET(Tumbler1_PLUGIN_DIR "${CMAKE_INSTALL_PREFIX}/${DIR_INSTALL_LIB}/tumbler-1/plugins" CACHE INTERNAL "Tumbler1_PLUGIN_DIR")
+ENDIF(Tumbler1_FOUND AND NOT Tumbler1_PLUGIN_DIR)
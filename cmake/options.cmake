@@ -46,6 +46,7 @@ OPTION(ENABLE_XML "Enable XML parsing for e.g. Windows manifests." ON)
 OPTION(ENABLE_ZSTD "Enable ZSTD decompression. (Required for some unit tests.)" ON)
 OPTION(ENABLE_LZ4 "Enable LZ4 decompression. (Required for some PSP disc formats.)" ON)
 OPTION(ENABLE_LZO "Enable LZO decompression. (Required for some PSP disc formats.)" ON)
+OPTION(ENABLE_LIBDEFLATE "Use libdeflate for faster decompression of zlib-compressed disc image blocks, if available." ON)
 
 IF(WIN32)
 	SET(USE_INTERNAL_ZLIB ON)
@@ -61,6 +62,15 @@ ELSE(WIN32)
 	OPTION(USE_INTERNAL_ZSTD "Use the internal copy of zstd." OFF)
 	OPTION(USE_INTERNAL_LZ4 "Use the internal copy of LZ4." OFF)
 	OPTION(USE_INTERNAL_LZO "Use the internal copy of LZO." OFF)
+
+	# zlib-ng's deflate and inflate are significantly faster than zlib's,
+	# which speeds up PNG encoding and decoding. libpng must also be built
+	# internally, since the system libpng is linked to the system zlib.
+	OPTION(USE_FAST_DEFLATE "Use the internal copies of zlib-ng (zlib-compatible mode) and libpng for faster PNG encoding and decoding." OFF)
+	IF(USE_FAST_DEFLATE)
+		SET(USE_INTERNAL_ZLIB ON CACHE BOOL "Use the internal copy of zlib." FORCE)
+		SET(USE_INTERNAL_PNG ON CACHE BOOL "Use the internal copy of libpng." FORCE)
+	ENDIF(USE_FAST_DEFLATE)
 ENDIF()
 
 # TODO: If APNG export is added, verify that system libpng
@@ -114,6 +124,9 @@ IF(INSTALL_DEBUG AND NOT SPLIT_DEBUG)
 	SET(INSTALL_DEBUG OFF CACHE INTERNAL "Install the split debug files." FORCE)
 ENDIF(INSTALL_DEBUG AND NOT SPLIT_DEBUG)
 
+# Build the benchmark suite. (requires BUILD_TESTING)
+OPTION(BUILD_BENCHMARKS "Build the image decoding benchmark suite using Google Benchmark, if available." ON)
+
 # Enable coverage checking. (gcc/clang only)
 OPTION(ENABLE_COVERAGE "Enable code coverage checking. (gcc/clang only)" OFF)
 
@@ -134,5 +147,15 @@ ELSE(CMAKE_SYSTEM_NAME STREQUAL "Linux")
 	SET(INSTALL_APPARMOR OFF)
 ENDIF(CMAKE_SYSTEM_NAME STREQUAL "Linux")
 
+# Linux io_uring for batched reads.
+IF(CMAKE_SYSTEM_NAME STREQUAL "Linux")
+	OPTION(ENABLE_IO_URING "Use io_uring for batched reads, if supported by the running kernel." ON)
+ELSE(CMAKE_SYSTEM_NAME STREQUAL "Linux")
+	SET(ENABLE_IO_URING OFF)
+ENDIF(CMAKE_SYSTEM_NAME STREQUAL "Linux")
+
+# Trace points. (USDT on Linux, ETW TraceLogging on Windows)
+OPTION(ENABLE_TRACING "Enable trace points on hot paths, if supported by the system headers." ON)
+
 # Achievements. (TODO: "AUTO" option?)
 OPTION(ENABLE_ACHIEVEMENTS "Enable achievement pop-ups." ON)
@@ -112,6 +112,14 @@ void mspack_memory_sys_destroy(struct mspack_system* sys) { free(sys); }
 int lzx_decompress(const void* lzx_data, size_t lzx_len, void* dest,
                    size_t dest_len, uint32_t window_size, void* window_data,
                    size_t window_data_len) {
+  return lzx_decompress_partial(lzx_data, lzx_len, dest, dest_len, dest_len,
+                                window_size, window_data, window_data_len);
+}
+
+int lzx_decompress_partial(const void* lzx_data, size_t lzx_len, void* dest,
+                           size_t dest_len, size_t stream_len,
+                           uint32_t window_size, void* window_data,
+                           size_t window_data_len) {
   int result_code = 1;
   uint32_t window_bits;
 
@@ -128,7 +136,7 @@ int lzx_decompress(const void* lzx_data, size_t lzx_len, void* dest,
   lzxsrc = mspack_memory_open(sys, (void*)lzx_data, lzx_len);
   lzxdst = mspack_memory_open(sys, dest, dest_len);
   lzxd = lzxd_init(sys, (struct mspack_file*)lzxsrc, (struct mspack_file*)lzxdst,
-                window_bits, 0, 0x8000, (off_t)dest_len, 0);
+                window_bits, 0, 0x8000, (off_t)stream_len, 0);
 
   if (lzxd) {
     if (window_data) {
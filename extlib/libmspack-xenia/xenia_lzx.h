@@ -21,6 +21,14 @@ int lzx_decompress(const void* lzx_data, size_t lzx_len, void* dest,
                    size_t dest_len, uint32_t window_size, void* window_data,
                    size_t window_data_len);
 
+// Decompress only the first dest_len bytes of an LZX stream.
+// stream_len is the full uncompressed size of the stream, which
+// is needed to determine the size of the last frame.
+int lzx_decompress_partial(const void* lzx_data, size_t lzx_len, void* dest,
+                           size_t dest_len, size_t stream_len,
+                           uint32_t window_size, void* window_data,
+                           size_t window_data_len);
+
 #ifdef __cplusplus
 }
 #endif
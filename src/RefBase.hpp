@@ -62,7 +62,9 @@ class RefBase
 		template<class T>
 		inline T *ref(void)
 		{
-			ATOMIC_INC_FETCH(&m_ref_cnt);
+			// NOTE: Relaxed ordering is sufficient here, since the
+			// caller already holds a reference to this object.
+			ATOMIC_INC_FETCH_RELAXED(&m_ref_cnt);
 			return static_cast<T*>(this);
 		}
 
@@ -73,12 +75,28 @@ class RefBase
 		void unref(void)
 		{
 			assert(m_ref_cnt > 0);
-			if (ATOMIC_DEC_FETCH(&m_ref_cnt) <= 0) {
+			if (ATOMIC_DEC_FETCH_RELEASE(&m_ref_cnt) <= 0) {
 				// All references removed.
+				// Make sure writes from other threads that
+				// released their references are visible
+				// before the destructor runs.
+				ATOMIC_FENCE_ACQUIRE();
 				delete this;
 			}
 		}
 
+		/**
+		 * Is the caller's reference the only one?
+		 * This is only reliable if no other thread can obtain
+		 * a new reference concurrently, e.g. if the object is
+		 * only reachable through a mutex-protected cache.
+		 * @return True if the reference count is 1.
+		 */
+		inline bool isUniqueRef(void) const
+		{
+			return (m_ref_cnt == 1);
+		}
+
 	private:
 		volatile int m_ref_cnt;
 };
@@ -17,11 +17,12 @@ using LibRpTexture::rp_image;
 
 /**
  * Convert an rp_image to cairo_surface_t.
+ * Standard version using regular C++ code.
  * @param img		[in] rp_image.
  * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
- * @return GdkPixbuf, or nullptr on error.
+ * @return cairo_surface_t, or nullptr on error.
  */
-cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img, bool premultiply)
+cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t_cpp(const rp_image *img, bool premultiply)
 {
 	assert(img != nullptr);
 	if (unlikely(!img || !img->isValid()))
@@ -47,30 +48,43 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 
 	switch (img->format()) {
 		case rp_image::Format::ARGB32: {
-			const rp_image *img_prex;
-			if (premultiply) {
-				// Premultiply the image first.
-				// TODO: Combined dup()/premultiply() function?
-				img_prex = img->dup();
-				const_cast<rp_image*>(img_prex)->premultiply();
-			} else {
-				// No premultiplication.
-				img_prex = img;
-			}
-
 			// Copy the image data.
+			const uint32_t *img_buf = static_cast<const uint32_t*>(img->bits());
 			int dest_stride = cairo_image_surface_get_stride(surface);
-			int src_stride = img_prex->stride();
+			int src_stride = img->stride();
 
-			if (dest_stride == src_stride) {
+			if (premultiply) {
+				// Premultiply the image while copying it.
+				// This doesn't require a temporary copy of the image.
+				const int dest_stride_adj = (dest_stride / sizeof(uint32_t)) - width;
+				const int src_stride_adj = (src_stride / sizeof(uint32_t)) - width;
+				for (unsigned int y = (unsigned int)height; y > 0; y--) {
+					unsigned int x;
+					for (x = (unsigned int)width; x > 3; x -= 4) {
+						px_dest[0] = rp_image::premultiply_pixel(img_buf[0]);
+						px_dest[1] = rp_image::premultiply_pixel(img_buf[1]);
+						px_dest[2] = rp_image::premultiply_pixel(img_buf[2]);
+						px_dest[3] = rp_image::premultiply_pixel(img_buf[3]);
+						px_dest += 4;
+						img_buf += 4;
+					}
+					for (; x > 0; x--, px_dest++, img_buf++) {
+						// Last pixels.
+						*px_dest = rp_image::premultiply_pixel(*img_buf);
+					}
+
+					// Next line.
+					img_buf += src_stride_adj;
+					px_dest += dest_stride_adj;
+				}
+			} else if (dest_stride == src_stride) {
 				// Stride is identical. Copy the whole image all at once.
 				// NOTE: Partial copy for the last line.
 				size_t sz = dest_stride * (height - 1);
 				sz += width * sizeof(uint32_t);
-				memcpy(px_dest, img_prex->bits(), sz);
+				memcpy(px_dest, img_buf, sz);
 			} else {
 				// Stride is not identical. Copy each scanline.
-				const uint32_t *img_buf = static_cast<const uint32_t*>(img_prex->bits());
 				const int row_bytes = img->row_bytes();
 				// We're adding strides to pointers, so the strides
 				// must be in uint32_t units here.
@@ -85,9 +99,6 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 
 			// Mark the surface as dirty.
 			cairo_surface_mark_dirty(surface);
-			if (premultiply) {
-				img_prex->unref();
-			}
 			break;
 		}
 
@@ -134,8 +145,6 @@ cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img
 				for (; x > 0; x--, px_dest++, img_buf++) {
 					// Last pixels.
 					*px_dest = pal_toUse[*img_buf];
-					px_dest++;
-					img_buf++;
 				}
 
 				// Next line.
@@ -10,7 +10,8 @@
 #define __ROMPROPERTIES_GTK_CAIROIMAGECONV_HPP__
 
 // NOTE: Cairo doesn't natively support 8bpp. Because of this,
-// we can't simply make a cairo_surface_t rp_image backend.
+// RpCairoBackend only stores ARGB32 images in a cairo_surface_t,
+// and CI8 images still have to be converted.
 
 #include "common.h"
 #include "librpcpu/cpu_dispatch.h"
@@ -20,6 +21,11 @@ namespace LibRpTexture {
 }
 #include <cairo.h>
 
+#if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
+# include "librpcpu/cpuflags_x86.h"
+# define CAIROIMAGECONV_HAS_SSSE3 1
+#endif
+
 class CairoImageConv
 {
 	private:
@@ -31,11 +37,56 @@ class CairoImageConv
 	public:
 		/**
 		 * Convert an rp_image to cairo_surface_t.
+		 * Standard version using regular C++ code.
 		 * @param img		[in] rp_image.
 		 * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
 		 * @return cairo_surface_t, or nullptr on error.
 		 */
-		static cairo_surface_t *rp_image_to_cairo_surface_t(const LibRpTexture::rp_image *img, bool premultiply = true);
+		static cairo_surface_t *rp_image_to_cairo_surface_t_cpp(const LibRpTexture::rp_image *img, bool premultiply = true);
+
+#ifdef CAIROIMAGECONV_HAS_SSSE3
+		/**
+		 * Convert an rp_image to cairo_surface_t.
+		 * SSSE3-optimized version.
+		 * @param img		[in] rp_image.
+		 * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
+		 * @return cairo_surface_t, or nullptr on error.
+		 */
+		static cairo_surface_t *rp_image_to_cairo_surface_t_ssse3(const LibRpTexture::rp_image *img, bool premultiply = true);
+#endif /* CAIROIMAGECONV_HAS_SSSE3 */
+
+		/**
+		 * Convert an rp_image to cairo_surface_t.
+		 * @param img		[in] rp_image.
+		 * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
+		 * @return cairo_surface_t, or nullptr on error.
+		 */
+		static IFUNC_INLINE cairo_surface_t *rp_image_to_cairo_surface_t(const LibRpTexture::rp_image *img, bool premultiply = true);
 };
 
+#if !defined(RP_HAS_IFUNC) || (!defined(RP_CPU_I386) && !defined(RP_CPU_AMD64))
+
+// System does not support IFUNC, or we don't have optimizations for these CPUs.
+// Use standard inline dispatch.
+
+/**
+ * Convert an rp_image to cairo_surface_t.
+ * @param img		[in] rp_image.
+ * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
+ * @return cairo_surface_t, or nullptr on error.
+ */
+inline cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const LibRpTexture::rp_image *img, bool premultiply)
+{
+#ifdef CAIROIMAGECONV_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return rp_image_to_cairo_surface_t_ssse3(img, premultiply);
+	} else
+#endif /* CAIROIMAGECONV_HAS_SSSE3 */
+	{
+		return rp_image_to_cairo_surface_t_cpp(img, premultiply);
+	}
+}
+
+#endif /* !defined(RP_HAS_IFUNC) || (!defined(RP_CPU_I386) && !defined(RP_CPU_AMD64)) */
+
 #endif /* __ROMPROPERTIES_GTK_CAIROIMAGECONV_HPP__ */
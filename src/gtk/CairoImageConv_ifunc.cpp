@@ -0,0 +1,41 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ common)                      *
+ * CairoImageConv_ifunc.cpp: CairoImageConv IFUNC resolution functions.    *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.librpbase.h"
+
+#ifdef RP_HAS_IFUNC
+
+#include "CairoImageConv.hpp"
+using LibRpTexture::rp_image;
+
+// IFUNC attribute doesn't support C++ name mangling.
+extern "C" {
+
+/**
+ * IFUNC resolver function for rp_image_to_cairo_surface_t().
+ * @return Function pointer.
+ */
+static __typeof__(&CairoImageConv::rp_image_to_cairo_surface_t_cpp) rp_image_to_cairo_surface_t_resolve(void)
+{
+#ifdef CAIROIMAGECONV_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &CairoImageConv::rp_image_to_cairo_surface_t_ssse3;
+	} else
+#endif /* CAIROIMAGECONV_HAS_SSSE3 */
+	{
+		return &CairoImageConv::rp_image_to_cairo_surface_t_cpp;
+	}
+}
+
+}
+
+cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t(const rp_image *img, bool premultiply)
+	IFUNC_ATTR(rp_image_to_cairo_surface_t_resolve);
+
+#endif /* RP_HAS_IFUNC */
@@ -0,0 +1,202 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ common)                      *
+ * CairoImageConv_ssse3.cpp: Helper functions to convert from rp_image to  *
+ * Cairo. (SSSE3-optimized version)                                        *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CairoImageConv.hpp"
+
+// librptexture
+using LibRpTexture::rp_image;
+
+// SSSE3 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+/**
+ * Premultiply 4 ARGB32 pixels. (SSSE3 version)
+ * Based on Qt 5.9.1's qPremultiply().
+ *
+ * Pixels with alpha == 0 or alpha == 255 are returned as-is,
+ * which matches rp_image::premultiply_pixel().
+ *
+ * @param v	[in] 4 ARGB32 pixels.
+ * @return Premultiplied pixels.
+ */
+static FORCEINLINE __m128i premultiply_4px_ssse3(__m128i v)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi16(0x80);
+
+	// Shuffle masks to copy each pixel's alpha value to all four 16-bit words.
+	const __m128i shuf_a_lo = _mm_setr_epi8(3,-1,3,-1,3,-1,3,-1, 7,-1,7,-1,7,-1,7,-1);
+	const __m128i shuf_a_hi = _mm_setr_epi8(11,-1,11,-1,11,-1,11,-1, 15,-1,15,-1,15,-1,15,-1);
+
+	// Expand to 16-bit.
+	__m128i lo = _mm_unpacklo_epi8(v, zero);
+	__m128i hi = _mm_unpackhi_epi8(v, zero);
+	const __m128i a_lo = _mm_shuffle_epi8(v, shuf_a_lo);
+	const __m128i a_hi = _mm_shuffle_epi8(v, shuf_a_hi);
+
+	// t = c * a; c' = (t + (t >> 8) + 0x80) >> 8
+	// NOTE: This can't overflow 16 bits. (max is 0xFF7F)
+	lo = _mm_mullo_epi16(lo, a_lo);
+	hi = _mm_mullo_epi16(hi, a_hi);
+	lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), round), 8);
+	hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), round), 8);
+	const __m128i res = _mm_packus_epi16(lo, hi);
+
+	// Keep the original alpha channel, plus the original pixels
+	// if alpha == 0 or alpha == 255.
+	const __m128i alpha = _mm_srli_epi32(v, 24);
+	__m128i mask_keep = _mm_or_si128(
+		_mm_cmpeq_epi32(alpha, zero),
+		_mm_cmpeq_epi32(alpha, _mm_set1_epi32(0xFF)));
+	mask_keep = _mm_or_si128(mask_keep, _mm_set1_epi32(0xFF000000U));
+	return _mm_or_si128(_mm_and_si128(mask_keep, v), _mm_andnot_si128(mask_keep, res));
+}
+
+/**
+ * Convert an rp_image to cairo_surface_t.
+ * SSSE3-optimized version.
+ * @param img		[in] rp_image.
+ * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
+ * @return cairo_surface_t, or nullptr on error.
+ */
+cairo_surface_t *CairoImageConv::rp_image_to_cairo_surface_t_ssse3(const rp_image *img, bool premultiply)
+{
+	assert(img != nullptr);
+	if (unlikely(!img || !img->isValid()))
+		return nullptr;
+
+	if (!premultiply && img->format() == rp_image::Format::ARGB32) {
+		// No premultiplication. This is a straight copy,
+		// so the standard version is just as fast.
+		return rp_image_to_cairo_surface_t_cpp(img, premultiply);
+	}
+
+	// NOTE: cairo_image_surface_create_for_data() doesn't do a
+	// deep copy, so we can't use it.
+	const int width = img->width();
+	const int height = img->height();
+	cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+	// cairo_image_surface_create() always returns a valid pointer.
+	assert(cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS);
+	if (unlikely(cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)) {
+		cairo_surface_destroy(surface);
+		return nullptr;
+	}
+
+	// NOTE: Cairo only guarantees 4-byte alignment for each row,
+	// so unaligned loads and stores are used here.
+	uint32_t *px_dest = reinterpret_cast<uint32_t*>(cairo_image_surface_get_data(surface));
+	assert(px_dest != nullptr);
+	const int dest_stride_adj = (cairo_image_surface_get_stride(surface) / sizeof(uint32_t)) - width;
+
+	switch (img->format()) {
+		case rp_image::Format::ARGB32: {
+			// Premultiply the image while copying it.
+			// This doesn't require a temporary copy of the image.
+			const uint32_t *img_buf = static_cast<const uint32_t*>(img->bits());
+			const int src_stride_adj = (img->stride() / sizeof(uint32_t)) - width;
+			for (unsigned int y = (unsigned int)height; y > 0; y--) {
+				// Process 8 pixels per iteration using SSSE3.
+				unsigned int x = (unsigned int)width;
+				for (; x > 7; x -= 8, px_dest += 8, img_buf += 8) {
+					const __m128i *xmm_src = reinterpret_cast<const __m128i*>(img_buf);
+					__m128i *xmm_dest = reinterpret_cast<__m128i*>(px_dest);
+
+					const __m128i sa = _mm_loadu_si128(&xmm_src[0]);
+					const __m128i sb = _mm_loadu_si128(&xmm_src[1]);
+					_mm_storeu_si128(&xmm_dest[0], premultiply_4px_ssse3(sa));
+					_mm_storeu_si128(&xmm_dest[1], premultiply_4px_ssse3(sb));
+				}
+
+				// Remaining pixels.
+				for (; x > 0; x--, px_dest++, img_buf++) {
+					*px_dest = rp_image::premultiply_pixel(*img_buf);
+				}
+
+				// Next line.
+				img_buf += src_stride_adj;
+				px_dest += dest_stride_adj;
+			}
+			break;
+		}
+
+		case rp_image::Format::CI8: {
+			const uint32_t *const src_pal = img->palette();
+			const int src_pal_len = img->palette_len();
+			assert(src_pal != nullptr);
+			assert(src_pal_len > 0);
+			assert(src_pal_len <= 256);
+			if (!src_pal || src_pal_len <= 0 || src_pal_len > 256)
+				break;
+
+			// Premultiply the palette.
+			// Unused palette entries are cleared.
+			ALIGNED_VAR(16, uint32_t palette[256]);
+			const uint32_t *pal_toUse;
+			if (premultiply) {
+				// Process 4 colors per iteration using SSSE3.
+				unsigned int i = 0;
+				for (; i + 3 < (unsigned int)src_pal_len; i += 4) {
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_pal[i]));
+					_mm_store_si128(reinterpret_cast<__m128i*>(&palette[i]), premultiply_4px_ssse3(v));
+				}
+				for (; i < (unsigned int)src_pal_len; i++) {
+					palette[i] = rp_image::premultiply_pixel(src_pal[i]);
+				}
+				if (src_pal_len < (int)ARRAY_SIZE(palette)) {
+					memset(&palette[src_pal_len], 0, (ARRAY_SIZE(palette) - src_pal_len) * sizeof(uint32_t));
+				}
+				pal_toUse = palette;
+			} else {
+				pal_toUse = src_pal;
+			}
+
+			// Copy the image data.
+			// NOTE: Palette lookups can't be vectorized with SSSE3,
+			// but the loop is unrolled to process 8 pixels at a time.
+			const uint8_t *img_buf = static_cast<const uint8_t*>(img->bits());
+			const int src_stride_adj = img->stride() - width;
+			for (unsigned int y = (unsigned int)height; y > 0; y--) {
+				unsigned int x = (unsigned int)width;
+				for (; x > 7; x -= 8, px_dest += 8, img_buf += 8) {
+					px_dest[0] = pal_toUse[img_buf[0]];
+					px_dest[1] = pal_toUse[img_buf[1]];
+					px_dest[2] = pal_toUse[img_buf[2]];
+					px_dest[3] = pal_toUse[img_buf[3]];
+					px_dest[4] = pal_toUse[img_buf[4]];
+					px_dest[5] = pal_toUse[img_buf[5]];
+					px_dest[6] = pal_toUse[img_buf[6]];
+					px_dest[7] = pal_toUse[img_buf[7]];
+				}
+
+				// Remaining pixels.
+				for (; x > 0; x--, px_dest++, img_buf++) {
+					*px_dest = pal_toUse[*img_buf];
+				}
+
+				// Next line.
+				img_buf += src_stride_adj;
+				px_dest += dest_stride_adj;
+			}
+			break;
+		}
+
+		default:
+			// Unsupported image format.
+			assert(!"Unsupported rp_image::Format.");
+			cairo_surface_destroy(surface);
+			return nullptr;
+	}
+
+	// Mark the surface as dirty.
+	cairo_surface_mark_dirty(surface);
+	return surface;
+}
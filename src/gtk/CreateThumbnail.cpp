@@ -10,10 +10,13 @@
 
 // librpbase, librptexture
 using namespace LibRpBase;
+#include "librptexture/img/rp_image_backend_pooled.hpp"
 using LibRpTexture::rp_image;
+using LibRpTexture::rp_image_backend_pooled;
 
 // libromdata
 #include "libromdata/RomDataFactory.hpp"
+#include "libromdata/img/XdgThumbnailCache.hpp"
 using LibRomData::RomDataFactory;
 
 // TCreateThumbnail is a templated class,
@@ -159,23 +162,21 @@ string CreateThumbnailPrivate::proxyForUrl(const string &url) const
 /** CreateThumbnail **/
 
 /**
- * Open a file from a filename or URI.
+ * Get the URI and local filename for a filename or URI.
  * @param source_file	[in] Source filename or URI.
- * @param pp_file	[out] Opened file.
  * @param s_uri		[out] Normalized URI. (file:/ for a filename, etc.)
+ * @param s_filename	[out] Local filename, or empty string if it isn't a local file.
  * @return 0 on success; RPCT error code on error.
  */
-static int openFromFilenameOrURI(const char *source_file, IRpFile **pp_file, string &s_uri)
+static int getURIFromFilenameOrURI(const char *source_file, string &s_uri, string &s_filename)
 {
 	// NOTE: Not checking these in Release builds.
 	assert(source_file != nullptr);
-	assert(pp_file != nullptr);
 
-	*pp_file = nullptr;
 	s_uri.clear();
+	s_filename.clear();
 	const bool enableThumbnailOnNetworkFS = Config::instance()->enableThumbnailOnNetworkFS();
 
-	IRpFile *file = nullptr;
 	char *const uri_scheme = g_uri_parse_scheme(source_file);
 	if (uri_scheme != nullptr) {
 		// This is a URI.
@@ -192,8 +193,7 @@ static int openFromFilenameOrURI(const char *source_file, IRpFile **pp_file, str
 				return RPCT_SOURCE_FILE_BAD_FS;
 			}
 
-			// Open the file using RpFile.
-			file = new RpFile(source_filename, RpFile::FM_OPEN_READ_GZ);
+			s_filename = source_filename;
 			g_free(source_filename);
 		} else {
 			// Not a local filename.
@@ -201,53 +201,77 @@ static int openFromFilenameOrURI(const char *source_file, IRpFile **pp_file, str
 				// Thumbnailing on network file systems is disabled.
 				return RPCT_SOURCE_FILE_BAD_FS;
 			}
+		}
+		return 0;
+	}
 
-			// Open the file using RpFileGio.
-			file = new RpFileGio(source_file);
+	// This is a filename.
+	// Note that for everything except the URI, we can use relative paths
+	// as well as absolute paths, so the absolute path conversion is only
+	// needed to get the URI for the thumbnail.
+
+	// Check if it's on a "bad" filesystem.
+	if (FileSystem::isOnBadFS(source_file, enableThumbnailOnNetworkFS)) {
+		// It's on a "bad" filesystem.
+		return RPCT_SOURCE_FILE_BAD_FS;
+	}
+
+	// Check fi we have an absolute or relative path.
+	if (g_path_is_absolute(source_file)) {
+		// We have an absolute path.
+		gchar *const source_uri = g_filename_to_uri(source_file, nullptr, nullptr);
+		if (source_uri) {
+			s_uri = source_uri;
+			g_free(source_uri);
 		}
 	} else {
-		// This is a filename.
-		// Note that for everything except the URI, we can use relative paths
-		// as well as absolute paths, so the absolute path conversion is only
-		// needed to get the URI for the thumbnail.
-
-		// Check if it's on a "bad" filesystem.
-		if (FileSystem::isOnBadFS(source_file, enableThumbnailOnNetworkFS)) {
-			// It's on a "bad" filesystem.
-			return RPCT_SOURCE_FILE_BAD_FS;
-		}
-
-		// Check fi we have an absolute or relative path.
-		if (g_path_is_absolute(source_file)) {
-			// We have an absolute path.
-			gchar *const source_uri = g_filename_to_uri(source_file, nullptr, nullptr);
-			if (source_uri) {
-				s_uri = source_uri;
-				g_free(source_uri);
-			}
-		} else {
-			// We have a relative path.
-			// Convert the filename to an absolute path.
-			GFile *curdir = g_file_new_for_path(".");
-			if (curdir) {
-				GFile *abspath = g_file_resolve_relative_path(curdir, source_file);
-				if (abspath) {
-					gchar *const source_uri = g_file_get_uri(abspath);
-					if (source_uri) {
-						s_uri = source_uri;
-						g_free(source_uri);
-					}
-					g_object_unref(abspath);
+		// We have a relative path.
+		// Convert the filename to an absolute path.
+		GFile *curdir = g_file_new_for_path(".");
+		if (curdir) {
+			GFile *abspath = g_file_resolve_relative_path(curdir, source_file);
+			if (abspath) {
+				gchar *const source_uri = g_file_get_uri(abspath);
+				if (source_uri) {
+					s_uri = source_uri;
+					g_free(source_uri);
 				}
-				g_object_unref(curdir);
+				g_object_unref(abspath);
 			}
+			g_object_unref(curdir);
 		}
+	}
+
+	s_filename = source_file;
+	return 0;
+}
 
+/**
+ * Open a file from a URI and local filename.
+ * @param s_uri		[in] Normalized URI.
+ * @param s_filename	[in] Local filename, or empty string if it isn't a local file.
+ * @param pp_file	[out] Opened file.
+ * @return 0 on success; RPCT error code on error.
+ */
+static int openFromURI(const string &s_uri, const string &s_filename, IRpFile **pp_file)
+{
+	// NOTE: Not checking these in Release builds.
+	assert(pp_file != nullptr);
+	*pp_file = nullptr;
+
+	IRpFile *file;
+	if (!s_filename.empty()) {
 		// Open the file using RpFile.
-		file = new RpFile(source_file, RpFile::FM_OPEN_READ_GZ);
+		file = new RpFile(s_filename, RpFile::FM_OPEN_READ_GZ_MMAP);
+	} else {
+		// Open the file using RpFileGio.
+		// GVfs reads are expensive, so wrap it in a CachedFile.
+		RpFileGio *const gioFile = new RpFileGio(s_uri);
+		file = new LibRpFile::CachedFile(gioFile);
+		gioFile->unref();
 	}
 
-	if (file && file->isOpen()) {
+	if (file->isOpen()) {
 		// File has been opened successfully.
 		*pp_file = file;
 		return 0;
@@ -255,20 +279,58 @@ static int openFromFilenameOrURI(const char *source_file, IRpFile **pp_file, str
 
 	// File was not opened.
 	// TODO: Actual error code?
-	UNREF(file);
+	file->unref();
 	return RPCT_SOURCE_FILE_ERROR;
 }
 
 /**
- * Thumbnail creator function for wrapper programs.
+ * Get the modification time and size of a file.
+ * @param s_uri		[in] Normalized URI.
+ * @param pMTime	[out] Modification time, or 0 if unknown.
+ * @param pSize		[out] File size, or 0 if unknown.
+ */
+static void getFileInfo(const string &s_uri, int64_t *pMTime, int64_t *pSize)
+{
+	*pMTime = 0;
+	*pSize = 0;
+
+	GFile *const f_src = g_file_new_for_uri(s_uri.c_str());
+	if (!f_src)
+		return;
+
+	GError *error = nullptr;
+	GFileInfo *const fi_src = g_file_query_info(f_src,
+		G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_STANDARD_SIZE,
+		G_FILE_QUERY_INFO_NONE, nullptr, &error);
+	if (!error) {
+		*pMTime = static_cast<int64_t>(g_file_info_get_attribute_uint64(fi_src, G_FILE_ATTRIBUTE_TIME_MODIFIED));
+		*pSize = g_file_info_get_size(fi_src);
+		g_object_unref(fi_src);
+	} else {
+		g_error_free(error);
+	}
+	g_object_unref(f_src);
+}
+
+/**
+ * Thumbnail creator function for wrapper programs. (v2)
+ * Same as rp_create_thumbnail(), but the request can be cancelled
+ * or limited to a time budget.
  * @param source_file Source file or URI. (UTF-8)
  * @param output_file Output file. (UTF-8)
  * @param maximum_size Maximum size.
+ * @param pCancel Cancellation flag. (may be NULL)
+ * @param timeout_ms Time budget, in milliseconds. (0 for no limit)
  * @return 0 on success; non-zero on error.
  */
 extern "C"
-G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const char *output_file, int maximum_size)
+G_MODULE_EXPORT int RP_C_API rp_create_thumbnail2(const char *source_file, const char *output_file, int maximum_size, const volatile int *pCancel, unsigned int timeout_ms)
 {
+	// The time budget includes opening the file and detecting the RomData subclass.
+	const uint64_t deadline_ns = (timeout_ms != 0)
+		? rp_monotonic_ns() + (static_cast<uint64_t>(timeout_ms) * 1000000ULL)
+		: 0;
+
 	// Some of this is based on the GNOME Thumbnailer skeleton project.
 	// https://github.com/hadess/gnome-thumbnailer-skeleton/blob/master/gnome-thumbnailer-skeleton.c
 
@@ -283,14 +345,47 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 	g_type_init();
 #endif
 
+	// Thumbnails are usually created in batches, and most of the
+	// rp_images are freed right away, so use pooled image storage.
+	if (!rp_image::backendCreatorFn()) {
+		rp_image::setBackendCreatorFn(rp_image_backend_pooled::creator_fn);
+	}
+
 	// NOTE: TCreateThumbnail() has wrappers for opening the
 	// ROM file and getting RomData*, but we're doing it here
 	// in order to return better error codes.
 
+	// Get the URI and check the filesystem.
+	string s_uri, s_filename;
+	int ret = getURIFromFilenameOrURI(source_file, s_uri, s_filename);
+	if (ret != 0) {
+		// Bad filesystem.
+		return ret;
+	}
+
+	// Get the modification time and file size.
+	int64_t mtime, szFile;
+	getFileInfo(s_uri, &mtime, &szFile);
+
+	// If the XDG thumbnail cache already has a valid thumbnail
+	// for this file, use it instead of opening the ROM.
+	if (mtime > 0 && LibRomData::XdgThumbnailCache::getValidThumbnail(
+		s_uri.c_str(), mtime, maximum_size, output_file) == 0)
+	{
+		return RPCT_SUCCESS;
+	}
+
+	if (pCancel && *pCancel) {
+		// Thumbnail request was cancelled.
+		return RPCT_CANCELLED;
+	} else if (deadline_ns != 0 && rp_monotonic_ns() >= deadline_ns) {
+		// Thumbnail request exceeded its time budget.
+		return RPCT_TIMED_OUT;
+	}
+
 	// Attempt to open the ROM file.
 	IRpFile *file = nullptr;
-	string s_uri;
-	int ret = openFromFilenameOrURI(source_file, &file, s_uri);
+	ret = openFromURI(s_uri, s_filename, &file);
 	if (ret != 0) {
 		// Error opening the file.
 		return ret;
@@ -299,7 +394,7 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 
 	// Get the appropriate RomData class for this ROM.
 	// RomData class *must* support at least one image type.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL | RomDataFactory::RDA_EXT_HINT | RomDataFactory::RDA_NEG_CACHE | RomDataFactory::RDA_CACHE);
 	file->unref();	// file is ref()'d by RomData.
 	if (!romData) {
 		// ROM is not supported.
@@ -309,6 +404,8 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 	// Create the thumbnail.
 	// TODO: If image is larger than maximum_size, resize down.
 	unique_ptr<CreateThumbnailPrivate> d(new CreateThumbnailPrivate());
+	d->setCancelFlag(pCancel);
+	d->setDeadline(deadline_ns);
 	CreateThumbnailPrivate::GetThumbnailOutParams_t outParams;
 	ret = d->getThumbnail(romData, maximum_size, &outParams);
 	if (ret != 0 || !d->isImgClassValid(outParams.retImg)) {
@@ -317,7 +414,7 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 			d->freeImgClass(outParams.retImg);
 		}
 		romData->unref();
-		return RPCT_SOURCE_FILE_NO_IMAGE;
+		return ((ret == RPCT_CANCELLED || ret == RPCT_TIMED_OUT) ? ret : RPCT_SOURCE_FILE_NO_IMAGE);
 	}
 
 	// Save the image using RpPngWriter.
@@ -330,7 +427,6 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 	RpPngWriter::kv_vector kv;
 	char mtime_str[32];
 	char szFile_str[32];
-	GFile *f_src = nullptr;
 	const char *mimeType;
 
 	// gdk-pixbuf doesn't support CI8, so we'll assume all
@@ -344,6 +440,11 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 		ret = RPCT_OUTPUT_FILE_FAILED;
 		goto cleanup;
 	}
+	if (Config::instance()->fastThumbnailPNG()) {
+		// Thumbnails are written often and read rarely,
+		// so trade file size for compression speed.
+		pngWriter->setProfile(RpPngWriter::Profile::Fast);
+	}
 
 	/** tEXt chunks. **/
 	// NOTE: These are written before IHDR in order to put the
@@ -358,31 +459,12 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 
 	// Modification time and file size.
 	mtime_str[0] = 0;
+	if (mtime > 0) {
+		snprintf(mtime_str, sizeof(mtime_str), "%" PRId64, mtime);
+	}
 	szFile_str[0] = 0;
-	f_src = g_file_new_for_uri(s_uri.c_str());
-	if (f_src) {
-		GError *error = nullptr;
-		GFileInfo *const fi_src = g_file_query_info(f_src,
-			G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_STANDARD_SIZE,
-			G_FILE_QUERY_INFO_NONE, nullptr, &error);
-		if (!error) {
-			// Get the modification time.
-			guint64 mtime = g_file_info_get_attribute_uint64(fi_src, G_FILE_ATTRIBUTE_TIME_MODIFIED);
-			if (mtime > 0) {
-				snprintf(mtime_str, sizeof(mtime_str), "%" PRId64, (int64_t)mtime);
-			}
-
-			// Get the file size.
-			gint64 szFile = g_file_info_get_size(fi_src);
-			if (szFile > 0) {
-				snprintf(szFile_str, sizeof(szFile_str), "%" PRId64, szFile);
-			}
-
-			g_object_unref(fi_src);
-		} else {
-			g_error_free(error);
-		}
-		g_object_unref(f_src);
+	if (szFile > 0) {
+		snprintf(szFile_str, sizeof(szFile_str), "%" PRId64, szFile);
 	}
 
 	// Modification time.
@@ -466,3 +548,16 @@ cleanup:
 	romData->unref();
 	return ret;
 }
+
+/**
+ * Thumbnail creator function for wrapper programs.
+ * @param source_file Source file or URI. (UTF-8)
+ * @param output_file Output file. (UTF-8)
+ * @param maximum_size Maximum size.
+ * @return 0 on success; non-zero on error.
+ */
+extern "C"
+G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const char *output_file, int maximum_size)
+{
+	return rp_create_thumbnail2(source_file, output_file, maximum_size, nullptr, 0);
+}
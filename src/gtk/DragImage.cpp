@@ -59,7 +59,9 @@ struct _DragImage {
 		const IconAnimData *iconAnimData;
 		guint tmrIconAnim;	// Timer ID
 		int last_delay;		// Last delay value.
-		std::array<PIMGTYPE, IconAnimData::MAX_FRAMES> iconFrames;
+		PIMGTYPE iconAtlas;	// Frame atlas. (See IconAnimData::atlas().)
+		int frameWidth;		// Width of a single frame in iconAtlas.
+		int frameHeight;	// Height of a single frame in iconAtlas.
 		IconAnimHelper iconAnimHelper;
 		int last_frame_number;	// Last frame number.
 
@@ -67,23 +69,35 @@ struct _DragImage {
 			: iconAnimData(nullptr)
 			, tmrIconAnim(0)
 			, last_delay(0)
+			, iconAtlas(nullptr)
+			, frameWidth(0)
+			, frameHeight(0)
 			, last_frame_number(0)
-		{
-			iconFrames.fill(nullptr);
-		}
+		{ }
 		~anim_vars() {
 			if (tmrIconAnim > 0) {
 				g_source_remove(tmrIconAnim);
 			}
 
-			std::for_each(iconFrames.begin(), iconFrames.end(), [](PIMGTYPE frame) {
-				if (frame) {
-					PIMGTYPE_destroy(frame);
-				}
-			});
+			if (iconAtlas) {
+				PIMGTYPE_destroy(iconAtlas);
+			}
 
 			UNREF(iconAnimData);
 		}
+
+		/**
+		 * Get a frame from the frame atlas.
+		 * @param frame Frame number.
+		 * @return PIMGTYPE (caller must destroy it), or nullptr on error.
+		 */
+		PIMGTYPE getFrame(int frame) const
+		{
+			if (!iconAtlas)
+				return nullptr;
+			return PIMGTYPE_get_subsurface(iconAtlas,
+				frame * frameWidth, 0, frameWidth, frameHeight);
+		}
 	};
 	anim_vars *anim;
 };
@@ -186,20 +200,26 @@ drag_image_update_pixmaps(DragImage *image)
 	if (anim && anim->iconAnimData) {
 		const IconAnimData *const iconAnimData = anim->iconAnimData;
 
-		// Convert the frames to PIMGTYPE.
-		for (int i = iconAnimData->count-1; i >= 0; i--) {
-			// Remove the existing frame first.
-			if (anim->iconFrames[i]) {
-				PIMGTYPE_destroy(anim->iconFrames[i]);
-				anim->iconFrames[i] = nullptr;
-			}
+		// Remove the existing frame atlas first.
+		if (anim->iconAtlas) {
+			PIMGTYPE_destroy(anim->iconAtlas);
+			anim->iconAtlas = nullptr;
+		}
 
-			const rp_image *const frame = iconAnimData->frames[i];
-			if (frame && frame->isValid()) {
-				// NOTE: Allowing NULL frames here...
-				anim->iconFrames[i] = rp_image_to_PIMGTYPE(frame);
-			}
+		// Convert the frame atlas to a single PIMGTYPE.
+		// Individual frames are copied from the atlas as needed.
+		const rp_image *const atlas = iconAnimData->atlas();
+		if (!atlas) {
+			// No valid frames.
+			return false;
 		}
+		anim->iconAtlas = rp_image_to_PIMGTYPE(atlas);
+		if (!anim->iconAtlas) {
+			// Unable to convert the frame atlas.
+			return false;
+		}
+		anim->frameWidth = iconAnimData->atlasFrameWidth();
+		anim->frameHeight = atlas->height();
 
 		// Set up the IconAnimHelper.
 		anim->iconAnimHelper.setIconAnimData(iconAnimData);
@@ -211,7 +231,7 @@ drag_image_update_pixmaps(DragImage *image)
 		}
 
 		// Show the first frame.
-		image->curFrame = PIMGTYPE_ref(anim->iconFrames[anim->iconAnimHelper.frameNumber()]);
+		image->curFrame = anim->getFrame(anim->iconAnimHelper.frameNumber());
 		gtk_image_set_from_PIMGTYPE(image->imageWidget, image->curFrame);
 		bRet = true;
 	} else if (image->img && image->img->isValid()) {
@@ -399,7 +419,12 @@ drag_image_anim_timer_func(DragImage *image)
 	if (frame != anim->last_frame_number) {
 		// New frame number.
 		// Update the icon.
-		gtk_image_set_from_PIMGTYPE(image->imageWidget, anim->iconFrames[frame]);
+		// NOTE: GtkImage takes its own reference to the PIMGTYPE.
+		PIMGTYPE pImgFrame = anim->getFrame(frame);
+		if (pImgFrame) {
+			gtk_image_set_from_PIMGTYPE(image->imageWidget, pImgFrame);
+			PIMGTYPE_destroy(pImgFrame);
+		}
 		anim->last_frame_number = frame;
 	}
 
@@ -0,0 +1,150 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ common)                      *
+ * ExtractMetaData.cpp: Metadata extractor for wrapper programs.           *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+
+// librpbase, librpfile
+#include "librpbase/RomMetaData.hpp"
+#include "librpbase/config/Config.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+
+// libromdata
+#include "libromdata/RomDataFactory.hpp"
+#include "libromdata/img/TCreateThumbnail.hpp"
+using LibRomData::RomDataFactory;
+
+// C includes.
+#include <unistd.h>
+
+// C++ STL classes.
+using std::string;
+
+/**
+ * rp_extract_metadata() callback function.
+ * Called once for each metadata property.
+ * @param user_data User data specified when calling rp_extract_metadata().
+ * @param prop_name Property name, e.g. "Title". (See RomMetaData::getPropertyName().)
+ * @param prop_type Property type. (See PropertyType.)
+ * @param str_value String value. (PropertyType::String only; otherwise NULL)
+ * @param int_value Integer value. (all types except PropertyType::String)
+ */
+typedef void (*PFN_RP_METADATA_CALLBACK)(void *user_data,
+	const char *prop_name, int prop_type, const char *str_value, int64_t int_value);
+
+/**
+ * Metadata extractor function for wrapper programs.
+ *
+ * This is used by desktop indexers, e.g. tracker-extract.
+ * Only the metadata is loaded; fields and images aren't loaded.
+ *
+ * @param source_file	[in] Source file. (UTF-8, local files only)
+ * @param pfnCallback	[in] Callback function for each metadata property.
+ * @param user_data	[in] User data for the callback function.
+ * @param p_file_type	[out,opt] RomData::FileType of the source file.
+ * @return 0 on success; non-zero on error. (RPCT error codes)
+ */
+extern "C"
+G_MODULE_EXPORT int RP_C_API rp_extract_metadata(const char *source_file,
+	PFN_RP_METADATA_CALLBACK pfnCallback, void *user_data, int *p_file_type)
+{
+	if (getuid() == 0 || geteuid() == 0) {
+		g_critical("*** " G_LOG_DOMAIN " does not support running as root.");
+		return RPCT_RUNNING_AS_ROOT;
+	}
+
+	assert(source_file != nullptr);
+	assert(pfnCallback != nullptr);
+	if (!source_file || source_file[0] == '\0' || !pfnCallback) {
+		return RPCT_SOURCE_FILE_ERROR;
+	}
+
+	// Check if the file is on a "bad" filesystem.
+	// Indexers touch every file in a directory, so this
+	// uses the same setting as thumbnailing.
+	const Config *const config = Config::instance();
+	if (FileSystem::isOnBadFS(source_file, config->enableThumbnailOnNetworkFS())) {
+		// It's on a "bad" filesystem.
+		return RPCT_SOURCE_FILE_BAD_FS;
+	}
+
+	// Attempt to open the ROM file.
+	IRpFile *const file = new RpFile(source_file, RpFile::FM_OPEN_READ_GZ_MMAP);
+	if (!file->isOpen()) {
+		// Could not open the file.
+		file->unref();
+		return RPCT_SOURCE_FILE_ERROR;
+	}
+
+	// Get the appropriate RomData class for this ROM.
+	// NOTE: Indexers run extractors for many files in a single
+	// process, so the extension hint and the negative detection
+	// cache are used to avoid probing every subclass.
+	RomData *const romData = RomDataFactory::create(file,
+		RomDataFactory::RDA_HAS_METADATA | RomDataFactory::RDA_EXT_HINT |
+		RomDataFactory::RDA_NEG_CACHE | RomDataFactory::RDA_CACHE);
+	file->unref();	// file is ref()'d by RomData.
+	if (!romData) {
+		// ROM is not supported.
+		return RPCT_SOURCE_FILE_NOT_SUPPORTED;
+	}
+
+	if (p_file_type) {
+		*p_file_type = static_cast<int>(romData->fileType());
+	}
+
+	// Get the metadata properties.
+	// NOTE: This only loads the metadata. Fields and images
+	// aren't loaded, so this is faster than the property page.
+	const RomMetaData *const metaData = romData->metaData();
+	if (!metaData || metaData->empty()) {
+		// No metadata properties.
+		romData->unref();
+		return RPCT_SUCCESS;
+	}
+
+	const int count = metaData->count();
+	for (int i = 0; i < count; i++) {
+		const RomMetaData::MetaData *const prop = metaData->prop(i);
+		assert(prop != nullptr);
+		if (!prop)
+			continue;
+
+		const char *const prop_name = RomMetaData::getPropertyName(prop->name);
+		if (!prop_name)
+			continue;
+
+		const int prop_type = static_cast<int>(prop->type);
+		switch (prop->type) {
+			case PropertyType::Integer:
+				pfnCallback(user_data, prop_name, prop_type, nullptr, prop->data.ivalue);
+				break;
+			case PropertyType::UnsignedInteger:
+				pfnCallback(user_data, prop_name, prop_type, nullptr, prop->data.uvalue);
+				break;
+			case PropertyType::String: {
+				const string *const str = prop->data.str;
+				if (str) {
+					pfnCallback(user_data, prop_name, prop_type, str->c_str(), 0);
+				}
+				break;
+			}
+			case PropertyType::Timestamp:
+				pfnCallback(user_data, prop_name, prop_type, nullptr,
+					static_cast<int64_t>(prop->data.timestamp));
+				break;
+			default:
+				// ERROR!
+				assert(!"Unsupported RomMetaData PropertyType.");
+				break;
+		}
+	}
+
+	romData->unref();
+	return RPCT_SUCCESS;
+}
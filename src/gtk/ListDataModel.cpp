@@ -0,0 +1,669 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ common)                      *
+ * ListDataModel.cpp: GtkTreeModel for RFT_LISTDATA.                       *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+/**
+ * ListDataModel is a virtual GtkTreeModel over RomFields::ListData_t.
+ * Unlike GtkListStore, rows aren't copied into the model; strings and
+ * icons are retrieved when the GtkTreeView requests them.
+ *
+ * Sorting is implemented using GtkTreeSortable. Sort keys are computed
+ * once per sort, and the row map (view row -> ListData_t row) is sorted.
+ */
+
+#include "stdafx.h"
+#include "ListDataModel.hpp"
+
+// librpbase, librptexture
+using LibRpBase::RomFields;
+using LibRpTexture::rp_image;
+
+// C++ STL classes
+using std::string;
+using std::vector;
+
+static void	list_data_model_finalize	(GObject	*object);
+
+static void	list_data_model_tree_model_init	(GtkTreeModelIface	*iface);
+static void	list_data_model_tree_sortable_init(GtkTreeSortableIface	*iface);
+
+// ListDataModel class.
+struct _ListDataModelClass {
+	GObjectClass __parent__;
+};
+
+// ListDataModel instance.
+struct _ListDataModel {
+	GObject __parent__;
+
+	// Iterator stamp.
+	gint stamp;
+
+	// RFT_LISTDATA field.
+	const RomFields::Field *field;
+	// Current ListData_t. (For RFT_LISTDATA_MULTI, this is the current language.)
+	const RomFields::ListData_t *pListData;
+
+	int colCount;		// Number of string columns.
+	int colStart;		// Model column index of the first string column.
+	bool hasCheckboxes;
+	bool hasIcons;
+
+	// Row map: view row -> ListData_t row.
+	vector<int> *rowMap;
+
+	// Icons. (indexed by ListData_t row)
+	// PIMGTYPEs are created on demand.
+	vector<PIMGTYPE> *icons;
+	int icon_sz;
+
+	// Sorting.
+	gint sort_column_id;
+	GtkSortType sort_order;
+};
+
+// NOTE: G_DEFINE_TYPE() doesn't work in C++ mode with gcc-6.2
+// due to an implicit int to GTypeFlags conversion.
+G_DEFINE_TYPE_EXTENDED(ListDataModel, list_data_model,
+	G_TYPE_OBJECT, static_cast<GTypeFlags>(0),
+		G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL,
+			list_data_model_tree_model_init);
+		G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_SORTABLE,
+			list_data_model_tree_sortable_init));
+
+static void
+list_data_model_class_init(ListDataModelClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS(klass);
+	gobject_class->finalize = list_data_model_finalize;
+}
+
+static void
+list_data_model_init(ListDataModel *model)
+{
+	// g_object_new() guarantees that all values are initialized to 0.
+	model->stamp = g_random_int();
+	model->rowMap = new vector<int>();
+	model->icons = new vector<PIMGTYPE>();
+	model->icon_sz = 32;
+	model->sort_column_id = GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID;
+	model->sort_order = GTK_SORT_ASCENDING;
+}
+
+/**
+ * Free all converted icons.
+ * @param model ListDataModel
+ */
+static void
+list_data_model_clear_icons(ListDataModel *model)
+{
+	std::for_each(model->icons->begin(), model->icons->end(),
+		[](PIMGTYPE &pimg) {
+			if (pimg) {
+				PIMGTYPE_destroy(pimg);
+				pimg = nullptr;
+			}
+		}
+	);
+}
+
+static void
+list_data_model_finalize(GObject *object)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(object);
+
+	list_data_model_clear_icons(model);
+	delete model->icons;
+	delete model->rowMap;
+
+	// Call the superclass finalize() function.
+	G_OBJECT_CLASS(list_data_model_parent_class)->finalize(object);
+}
+
+ListDataModel*
+list_data_model_new(const RomFields::Field *field)
+{
+	assert(field != nullptr);
+	assert(field->type == RomFields::RFT_LISTDATA);
+	if (!field || field->type != RomFields::RFT_LISTDATA)
+		return nullptr;
+
+	const auto &listDataDesc = field->desc.list_data;
+
+	// Single language ListData_t.
+	// For RFT_LISTDATA_MULTI, the first language is used
+	// until list_data_model_set_lc() is called.
+	const RomFields::ListData_t *list_data;
+	if (listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI) {
+		const auto *const multi = field->data.list_data.data.multi;
+		if (!multi || multi->empty())
+			return nullptr;
+		list_data = &multi->cbegin()->second;
+	} else {
+		list_data = field->data.list_data.data.single;
+	}
+	if (!list_data || list_data->empty())
+		return nullptr;
+
+	ListDataModel *const model = static_cast<ListDataModel*>(
+		g_object_new(TYPE_LIST_DATA_MODEL, nullptr));
+	model->field = field;
+	model->pListData = list_data;
+	model->hasCheckboxes = !!(listDataDesc.flags & RomFields::RFT_LISTDATA_CHECKBOXES);
+	model->hasIcons = !!(listDataDesc.flags & RomFields::RFT_LISTDATA_ICONS);
+	model->colStart = (model->hasCheckboxes || model->hasIcons) ? 1 : 0;
+	if (listDataDesc.names) {
+		model->colCount = static_cast<int>(listDataDesc.names->size());
+	} else {
+		// No column headers.
+		// Use the first row.
+		model->colCount = static_cast<int>(list_data->at(0).size());
+	}
+
+	// Initialize the row map.
+	model->rowMap->reserve(list_data->size());
+	const int rowCount = static_cast<int>(list_data->size());
+	for (int row = 0; row < rowCount; row++) {
+		// FIXME: Skip even if we don't have checkboxes?
+		// (also check other UI frontends)
+		if (model->hasCheckboxes && list_data->at(row).empty()) {
+			// Skip this row.
+			continue;
+		}
+		model->rowMap->emplace_back(row);
+	}
+
+	if (model->hasIcons && field->data.list_data.mxd.icons) {
+		model->icons->resize(field->data.list_data.mxd.icons->size(), nullptr);
+	}
+
+	return model;
+}
+
+/**
+ * Get the model column index of the first string column.
+ * @param model ListDataModel
+ * @return 1 if the field has checkboxes or icons; 0 otherwise.
+ */
+int
+list_data_model_get_column_start(ListDataModel *model)
+{
+	g_return_val_if_fail(IS_LIST_DATA_MODEL(model), 0);
+	return model->colStart;
+}
+
+/**
+ * Set the icon size.
+ * Icons that have already been converted will be converted again.
+ * @param model ListDataModel
+ * @param icon_sz Icon size
+ */
+void
+list_data_model_set_icon_size(ListDataModel *model, int icon_sz)
+{
+	g_return_if_fail(IS_LIST_DATA_MODEL(model));
+	if (model->icon_sz == icon_sz)
+		return;
+
+	model->icon_sz = icon_sz;
+	list_data_model_clear_icons(model);
+}
+
+/** Sorting **/
+
+/**
+ * Sort key for a single ListData_t row.
+ */
+struct SortKey_t {
+	int row;		// ListData_t row
+	gint64 num;		// COLSORT_NUMERIC: Numeric value
+	bool isNum;		// COLSORT_NUMERIC: String is fully numeric
+	string key;		// Collation key
+};
+
+/**
+ * Sort the row map using the current sort column and order.
+ * The "rows-reordered" signal is emitted if any rows were moved.
+ * @param model ListDataModel
+ */
+static void
+list_data_model_sort(ListDataModel *model)
+{
+	vector<int> &rowMap = *model->rowMap;
+	if (rowMap.size() <= 1)
+		return;
+	const vector<int> oldRowMap = rowMap;
+
+	const int col = model->sort_column_id - model->colStart;
+	if (col < 0 || col >= model->colCount) {
+		// Unsorted, or not a string column.
+		// Restore the original row order.
+		std::sort(rowMap.begin(), rowMap.end());
+	} else {
+		// Sorting method for this column.
+		const uint32_t sorting = (model->field->desc.list_data.col_attrs.sorting >>
+			(col * RomFields::COLSORT_BITS)) & RomFields::COLSORT_MASK;
+
+		// Compute the sort keys.
+		vector<SortKey_t> keys;
+		keys.reserve(rowMap.size());
+		for (int row : rowMap) {
+			const vector<string> &data_row = model->pListData->at(row);
+			const char *const str = (col < (int)data_row.size() ? data_row[col].c_str() : "");
+
+			SortKey_t sortKey;
+			sortKey.row = row;
+			sortKey.num = 0;
+			sortKey.isNum = false;
+
+			gchar *collate_key;
+			switch (sorting) {
+				default:
+					// Unsupported. We'll use standard sorting.
+					assert(!"Unsupported sorting method.");
+					// fall-through
+				case RomFields::COLSORT_STANDARD:
+					// Standard sorting.
+					collate_key = g_utf8_collate_key(str, -1);
+					break;
+				case RomFields::COLSORT_NOCASE: {
+					// Case-insensitive sorting.
+					gchar *const str_casefold = g_utf8_casefold(str, -1);
+					collate_key = g_utf8_collate_key(str_casefold, -1);
+					g_free(str_casefold);
+					break;
+				}
+				case RomFields::COLSORT_NUMERIC: {
+					// Numeric sorting. (case-insensitive)
+					// If the values match, the strings are compared
+					// if they didn't fully convert to numbers.
+					// TODO: Allow arbitrary bases?
+					gchar *endptr = nullptr;
+					sortKey.num = g_ascii_strtoll(str, &endptr, 10);
+					sortKey.isNum = (endptr && *endptr == '\0');
+					gchar *const str_casefold = g_utf8_casefold(str, -1);
+					collate_key = g_utf8_collate_key(str_casefold, -1);
+					g_free(str_casefold);
+					break;
+				}
+			}
+			sortKey.key = collate_key;
+			g_free(collate_key);
+
+			keys.emplace_back(std::move(sortKey));
+		}
+
+		// Sort the keys.
+		// NOTE: Using stable_sort() so rows with equal keys
+		// stay in the same order, and so descending order
+		// is simply the reverse comparison.
+		const bool isNumeric = (sorting == RomFields::COLSORT_NUMERIC);
+		const bool isDescending = (model->sort_order == GTK_SORT_DESCENDING);
+		std::stable_sort(keys.begin(), keys.end(),
+			[isNumeric, isDescending](const SortKey_t &a, const SortKey_t &b) {
+				const SortKey_t &x = (isDescending ? b : a);
+				const SortKey_t &y = (isDescending ? a : b);
+				if (isNumeric && x.num != y.num) {
+					return (x.num < y.num);
+				} else if (isNumeric && x.isNum && y.isNum) {
+					// Both strings are the same number.
+					return false;
+				}
+				return (x.key < y.key);
+			}
+		);
+
+		// Update the row map.
+		auto iter = rowMap.begin();
+		for (const SortKey_t &sortKey : keys) {
+			*iter++ = sortKey.row;
+		}
+	}
+
+	if (rowMap == oldRowMap) {
+		// Nothing changed.
+		return;
+	}
+
+	// Emit "rows-reordered".
+	// new_order[newPos] = oldPos
+	vector<gint> oldPos(model->pListData->size(), 0);
+	const int rowCount = static_cast<int>(oldRowMap.size());
+	for (int i = 0; i < rowCount; i++) {
+		oldPos[oldRowMap[i]] = i;
+	}
+	vector<gint> new_order;
+	new_order.reserve(rowCount);
+	for (int row : rowMap) {
+		new_order.emplace_back(oldPos[row]);
+	}
+
+	GtkTreePath *const path = gtk_tree_path_new();
+	gtk_tree_model_rows_reordered(GTK_TREE_MODEL(model), path, nullptr, new_order.data());
+	gtk_tree_path_free(path);
+}
+
+/**
+ * Set the language code for RFT_LISTDATA_MULTI.
+ * @param model ListDataModel
+ * @param def_lc ROM default language code
+ * @param user_lc User-specified language code
+ */
+void
+list_data_model_set_lc(ListDataModel *model, uint32_t def_lc, uint32_t user_lc)
+{
+	g_return_if_fail(IS_LIST_DATA_MODEL(model));
+	if (!(model->field->desc.list_data.flags & RomFields::RFT_LISTDATA_MULTI))
+		return;
+
+	const auto *const pListData = RomFields::getFromListDataMulti(
+		model->field->data.list_data.data.multi, def_lc, user_lc);
+	assert(pListData != nullptr);
+	if (!pListData || pListData == model->pListData)
+		return;
+
+	// NOTE: All languages are assumed to have the same number of rows.
+	assert(pListData->size() == model->pListData->size());
+	if (pListData->size() != model->pListData->size())
+		return;
+	model->pListData = pListData;
+
+	// Re-sort the rows, since the strings have changed.
+	list_data_model_sort(model);
+
+	// All rows have changed.
+	GtkTreeIter iter;
+	iter.stamp = model->stamp;
+	const int rowCount = static_cast<int>(model->rowMap->size());
+	for (int i = 0; i < rowCount; i++) {
+		iter.user_data = GINT_TO_POINTER(i);
+		GtkTreePath *const path = gtk_tree_path_new_from_indices(i, -1);
+		gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, &iter);
+		gtk_tree_path_free(path);
+	}
+}
+
+/** GtkTreeModel interface **/
+
+static GtkTreeModelFlags
+list_data_model_get_flags(GtkTreeModel *tree_model)
+{
+	RP_UNUSED(tree_model);
+	return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+list_data_model_get_n_columns(GtkTreeModel *tree_model)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(tree_model);
+	return model->colStart + model->colCount;
+}
+
+static GType
+list_data_model_get_column_type(GtkTreeModel *tree_model, gint index)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(tree_model);
+	g_return_val_if_fail(index >= 0 && index < model->colStart + model->colCount, G_TYPE_INVALID);
+
+	if (index >= model->colStart) {
+		return G_TYPE_STRING;
+	} else if (model->hasCheckboxes) {
+		return G_TYPE_BOOLEAN;
+	} else /*if (model->hasIcons)*/ {
+		return PIMGTYPE_GOBJECT_TYPE;
+	}
+}
+
+static gboolean
+list_data_model_get_iter(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreePath *path)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(tree_model);
+	g_return_val_if_fail(gtk_tree_path_get_depth(path) == 1, FALSE);
+
+	const gint row = gtk_tree_path_get_indices(path)[0];
+	if (row < 0 || row >= (gint)model->rowMap->size())
+		return FALSE;
+
+	iter->stamp = model->stamp;
+	iter->user_data = GINT_TO_POINTER(row);
+	return TRUE;
+}
+
+static GtkTreePath*
+list_data_model_get_path(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(tree_model);
+	g_return_val_if_fail(iter->stamp == model->stamp, nullptr);
+	return gtk_tree_path_new_from_indices(GPOINTER_TO_INT(iter->user_data), -1);
+}
+
+static void
+list_data_model_get_value(GtkTreeModel *tree_model, GtkTreeIter *iter, gint column, GValue *value)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(tree_model);
+	g_return_if_fail(iter->stamp == model->stamp);
+	g_return_if_fail(column >= 0 && column < model->colStart + model->colCount);
+
+	const int row = model->rowMap->at(GPOINTER_TO_INT(iter->user_data));
+	if (column >= model->colStart) {
+		// String column.
+		const int col = column - model->colStart;
+		const vector<string> &data_row = model->pListData->at(row);
+		g_value_init(value, G_TYPE_STRING);
+		if (col < (int)data_row.size()) {
+			g_value_set_string(value, data_row[col].c_str());
+		}
+	} else if (model->hasCheckboxes) {
+		// Checkbox column.
+		// NOTE: Checkbox bits are indexed by ListData_t row,
+		// including empty rows that were skipped.
+		g_value_init(value, G_TYPE_BOOLEAN);
+		const uint32_t checkboxes = model->field->data.list_data.mxd.checkboxes;
+		g_value_set_boolean(value, row < 32 && ((checkboxes >> row) & 1));
+	} else /*if (model->hasIcons)*/ {
+		// Icon column.
+		g_value_init(value, PIMGTYPE_GOBJECT_TYPE);
+		if (row >= (int)model->icons->size())
+			return;
+
+		PIMGTYPE &pimg = model->icons->at(row);
+		if (!pimg) {
+			// NOTE: Deferred icons are loaded here, when the row is first shown.
+			const rp_image *const icon = RomFields::listDataIcon(*model->field, row);
+			if (!icon)
+				return;
+
+			pimg = rp_image_to_PIMGTYPE(icon);
+			if (!pimg)
+				return;
+
+			// NOTE: GtkCellRendererPixbuf can't scale the
+			// pixbuf itself...
+			const int icon_sz = model->icon_sz;
+			if (!PIMGTYPE_size_check(pimg, icon_sz, icon_sz)) {
+				// TODO: Use nearest-neighbor if upscaling.
+				// Also, preserve the aspect ratio.
+				PIMGTYPE scaled = PIMGTYPE_scale(pimg, icon_sz, icon_sz, true);
+				if (scaled) {
+					PIMGTYPE_destroy(pimg);
+					pimg = scaled;
+				}
+			}
+		}
+#ifdef RP_GTK_USE_CAIRO
+		g_value_set_boxed(value, pimg);
+#else /* !RP_GTK_USE_CAIRO */
+		g_value_set_object(value, pimg);
+#endif /* RP_GTK_USE_CAIRO */
+	}
+}
+
+static gboolean
+list_data_model_iter_next(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(tree_model);
+	g_return_val_if_fail(iter->stamp == model->stamp, FALSE);
+
+	const gint row = GPOINTER_TO_INT(iter->user_data) + 1;
+	if (row >= (gint)model->rowMap->size()) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	iter->user_data = GINT_TO_POINTER(row);
+	return TRUE;
+}
+
+#if GTK_CHECK_VERSION(3,0,0)
+static gboolean
+list_data_model_iter_previous(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(tree_model);
+	g_return_val_if_fail(iter->stamp == model->stamp, FALSE);
+
+	const gint row = GPOINTER_TO_INT(iter->user_data) - 1;
+	if (row < 0) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	iter->user_data = GINT_TO_POINTER(row);
+	return TRUE;
+}
+#endif /* GTK_CHECK_VERSION(3,0,0) */
+
+static gboolean
+list_data_model_iter_nth_child(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *parent, gint n)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(tree_model);
+	if (parent != nullptr || n < 0 || n >= (gint)model->rowMap->size()) {
+		// List-only model, so rows don't have children.
+		iter->stamp = 0;
+		return FALSE;
+	}
+
+	iter->stamp = model->stamp;
+	iter->user_data = GINT_TO_POINTER(n);
+	return TRUE;
+}
+
+static gboolean
+list_data_model_iter_children(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *parent)
+{
+	return list_data_model_iter_nth_child(tree_model, iter, parent, 0);
+}
+
+static gboolean
+list_data_model_iter_has_child(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	RP_UNUSED(tree_model);
+	RP_UNUSED(iter);
+	return FALSE;
+}
+
+static gint
+list_data_model_iter_n_children(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(tree_model);
+	return (iter == nullptr ? (gint)model->rowMap->size() : 0);
+}
+
+static gboolean
+list_data_model_iter_parent(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *child)
+{
+	RP_UNUSED(tree_model);
+	RP_UNUSED(child);
+	iter->stamp = 0;
+	return FALSE;
+}
+
+static void
+list_data_model_tree_model_init(GtkTreeModelIface *iface)
+{
+	iface->get_flags = list_data_model_get_flags;
+	iface->get_n_columns = list_data_model_get_n_columns;
+	iface->get_column_type = list_data_model_get_column_type;
+	iface->get_iter = list_data_model_get_iter;
+	iface->get_path = list_data_model_get_path;
+	iface->get_value = list_data_model_get_value;
+	iface->iter_next = list_data_model_iter_next;
+#if GTK_CHECK_VERSION(3,0,0)
+	iface->iter_previous = list_data_model_iter_previous;
+#endif /* GTK_CHECK_VERSION(3,0,0) */
+	iface->iter_children = list_data_model_iter_children;
+	iface->iter_has_child = list_data_model_iter_has_child;
+	iface->iter_n_children = list_data_model_iter_n_children;
+	iface->iter_nth_child = list_data_model_iter_nth_child;
+	iface->iter_parent = list_data_model_iter_parent;
+}
+
+/** GtkTreeSortable interface **/
+
+static gboolean
+list_data_model_get_sort_column_id(GtkTreeSortable *sortable, gint *sort_column_id, GtkSortType *order)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(sortable);
+	if (sort_column_id) {
+		*sort_column_id = model->sort_column_id;
+	}
+	if (order) {
+		*order = model->sort_order;
+	}
+	return (model->sort_column_id != GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID &&
+		model->sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID);
+}
+
+static void
+list_data_model_set_sort_column_id(GtkTreeSortable *sortable, gint sort_column_id, GtkSortType order)
+{
+	ListDataModel *const model = LIST_DATA_MODEL(sortable);
+	if (model->sort_column_id == sort_column_id && model->sort_order == order)
+		return;
+
+	model->sort_column_id = sort_column_id;
+	model->sort_order = order;
+	gtk_tree_sortable_sort_column_changed(sortable);
+	list_data_model_sort(model);
+}
+
+static void
+list_data_model_set_sort_func(GtkTreeSortable *sortable, gint sort_column_id,
+	GtkTreeIterCompareFunc sort_func, gpointer user_data, GDestroyNotify destroy)
+{
+	// Custom sort functions aren't supported.
+	// Sorting methods are determined by the RFT_LISTDATA column attributes.
+	RP_UNUSED(sortable);
+	RP_UNUSED(sort_column_id);
+	RP_UNUSED(sort_func);
+	if (destroy) {
+		destroy(user_data);
+	}
+	g_warning("ListDataModel: Custom sort functions are not supported.");
+}
+
+static void
+list_data_model_set_default_sort_func(GtkTreeSortable *sortable,
+	GtkTreeIterCompareFunc sort_func, gpointer user_data, GDestroyNotify destroy)
+{
+	list_data_model_set_sort_func(sortable, GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID,
+		sort_func, user_data, destroy);
+}
+
+static gboolean
+list_data_model_has_default_sort_func(GtkTreeSortable *sortable)
+{
+	RP_UNUSED(sortable);
+	return FALSE;
+}
+
+static void
+list_data_model_tree_sortable_init(GtkTreeSortableIface *iface)
+{
+	iface->get_sort_column_id = list_data_model_get_sort_column_id;
+	iface->set_sort_column_id = list_data_model_set_sort_column_id;
+	iface->set_sort_func = list_data_model_set_sort_func;
+	iface->set_default_sort_func = list_data_model_set_default_sort_func;
+	iface->has_default_sort_func = list_data_model_has_default_sort_func;
+}
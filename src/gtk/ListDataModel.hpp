@@ -0,0 +1,73 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ common)                      *
+ * ListDataModel.hpp: GtkTreeModel for RFT_LISTDATA.                       *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_GTK_LISTDATAMODEL_HPP__
+#define __ROMPROPERTIES_GTK_LISTDATAMODEL_HPP__
+
+#include <gtk/gtk.h>
+
+// librpbase
+#include "librpbase/RomFields.hpp"
+
+G_BEGIN_DECLS
+
+typedef struct _ListDataModelClass	ListDataModelClass;
+typedef struct _ListDataModel		ListDataModel;
+
+#define TYPE_LIST_DATA_MODEL            (list_data_model_get_type())
+#define LIST_DATA_MODEL(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj), TYPE_LIST_DATA_MODEL, ListDataModel))
+#define LIST_DATA_MODEL_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass),  TYPE_LIST_DATA_MODEL, ListDataModelClass))
+#define IS_LIST_DATA_MODEL(obj)         (G_TYPE_CHECK_INSTANCE_TYPE((obj), TYPE_LIST_DATA_MODEL))
+#define IS_LIST_DATA_MODEL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass),  TYPE_LIST_DATA_MODEL))
+#define LIST_DATA_MODEL_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj),  TYPE_LIST_DATA_MODEL, ListDataModelClass))
+
+GType		list_data_model_get_type	(void) G_GNUC_CONST G_GNUC_INTERNAL;
+
+/**
+ * Create a ListDataModel for an RFT_LISTDATA field.
+ *
+ * Rows are not copied. Strings and icons are retrieved from
+ * the RomFields::Field when they're requested by the view,
+ * so the field must remain valid while the model exists.
+ *
+ * Column layout:
+ * - If the field has checkboxes, column 0 is G_TYPE_BOOLEAN.
+ * - If the field has icons, column 0 is PIMGTYPE_GOBJECT_TYPE.
+ * - The remaining columns are G_TYPE_STRING.
+ *
+ * @param field RFT_LISTDATA field
+ * @return ListDataModel, or nullptr on error.
+ */
+ListDataModel	*list_data_model_new		(const LibRpBase::RomFields::Field *field) G_GNUC_MALLOC;
+
+/**
+ * Get the model column index of the first string column.
+ * @param model ListDataModel
+ * @return 1 if the field has checkboxes or icons; 0 otherwise.
+ */
+int		list_data_model_get_column_start(ListDataModel *model);
+
+/**
+ * Set the icon size.
+ * Icons that have already been converted will be converted again.
+ * @param model ListDataModel
+ * @param icon_sz Icon size
+ */
+void		list_data_model_set_icon_size	(ListDataModel *model, int icon_sz);
+
+/**
+ * Set the language code for RFT_LISTDATA_MULTI.
+ * @param model ListDataModel
+ * @param def_lc ROM default language code
+ * @param user_lc User-specified language code
+ */
+void		list_data_model_set_lc		(ListDataModel *model, uint32_t def_lc, uint32_t user_lc);
+
+G_END_DECLS
+
+#endif /* __ROMPROPERTIES_GTK_LISTDATAMODEL_HPP__ */
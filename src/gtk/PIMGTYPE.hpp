@@ -21,6 +21,7 @@
 #  define RP_GTK_USE_CAIRO 1
 #  ifdef __cplusplus
 #    include "CairoImageConv.hpp"
+#    include "RpCairoBackend.hpp"
 #  endif /* __cplusplus */
 #  include <cairo-gobject.h>
 #  define PIMGTYPE_GOBJECT_TYPE CAIRO_GOBJECT_TYPE_SURFACE
@@ -48,6 +49,11 @@ G_END_DECLS
 static inline PIMGTYPE rp_image_to_PIMGTYPE(const LibRpTexture::rp_image *img, bool premultiply = true)
 {
 #ifdef RP_GTK_USE_CAIRO
+	// Images using RpCairoBackend can usually be used without conversion.
+	cairo_surface_t *const surface = RpCairoBackend::getCairoSurface(img, premultiply);
+	if (surface) {
+		return surface;
+	}
 	return CairoImageConv::rp_image_to_cairo_surface_t(img, premultiply);
 #else /* !RP_GTK_USE_CAIRO */
 	((void)premultiply);
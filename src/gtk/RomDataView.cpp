@@ -11,7 +11,6 @@
 
 #include "rp-gtk-enums.h"
 #include "RpGtk.hpp"
-#include "sort_funcs.h"
 
 // ENABLE_MESSAGESOUND is set by CMakeLists.txt.
 #ifdef ENABLE_MESSAGESOUND
@@ -20,6 +19,7 @@
 
 // Custom widgets
 #include "DragImage.hpp"
+#include "ListDataModel.hpp"
 #include "MessageWidget.hpp"
 #include "LanguageComboBox.hpp"
 #include "OptionsMenuButton.hpp"
@@ -79,6 +79,8 @@ static void	rom_data_view_desc_format_type_changed(RomDataView *page,
 
 static void	rom_data_view_init_header_row	(RomDataView	*page);
 static void	rom_data_view_update_display	(RomDataView	*page);
+static void	rom_data_view_init_tab		(RomDataView	*page,
+						 int		 tabIdx);
 static gboolean	rom_data_view_load_rom_data	(gpointer	 data);
 static void	rom_data_view_delete_tabs	(RomDataView	*page);
 
@@ -89,6 +91,10 @@ static void	rom_data_view_map_signal_handler    (RomDataView	*page,
 						     gpointer		 user_data);
 static void	rom_data_view_unmap_signal_handler  (RomDataView	*page,
 						     gpointer		 user_data);
+static void	tabWidget_switch_page_signal_handler(GtkNotebook	*notebook,
+						     gpointer		 page_widget,
+						     guint		 page_num,
+						     RomDataView	*page);
 static void	tree_view_realize_signal_handler    (GtkTreeView	*treeView,
 						     RomDataView	*page);
 static void	cboLanguage_lc_changed_signal_handler(GtkComboBox	*widget,
@@ -120,15 +126,15 @@ struct _RomDataViewClass {
 typedef std::pair<GtkWidget*, const RomFields::Field*> Data_StringMulti_t;
 
 struct Data_ListDataMulti_t {
-	GtkListStore *listStore;
+	ListDataModel *listModel;
 	GtkTreeView *treeView;
 	const RomFields::Field *field;
 
 	Data_ListDataMulti_t(
-		GtkListStore *listStore,
+		ListDataModel *listModel,
 		GtkTreeView *treeView,
 		const RomFields::Field *field)
-		: listStore(listStore)
+		: listModel(listModel)
 		, treeView(treeView)
 		, field(field) { }
 };
@@ -158,8 +164,9 @@ struct _RomDataView {
 		GtkWidget	*vbox;		// Either page or a GtkVBox/GtkBox.
 		GtkWidget	*table;		// GtkTable (2.x); GtkGrid (3.x)
 		GtkWidget	*lblCredits;
+		bool		populated;	// Field widgets have been created.
 
-		tab() : vbox(nullptr), table(nullptr), lblCredits(nullptr) { }
+		tab() : vbox(nullptr), table(nullptr), lblCredits(nullptr), populated(false) { }
 	};
 	vector<tab>	*tabs;
 
@@ -180,13 +187,14 @@ struct _RomDataView {
 
 	// Multi-language functionality.
 	uint32_t	def_lc;
+	uint32_t	user_lc;	// Language code selected in cboLanguage.
 	set<uint32_t>	*set_lc;	// Set of supported language codes.
 	GtkWidget	*cboLanguage;
 
 	// RFT_STRING_MULTI value labels.
 	vector<Data_StringMulti_t> *vecStringMulti;
 
-	// RFT_LISTDATA_MULTI value GtkListStores.
+	// RFT_LISTDATA_MULTI value ListDataModels.
 	vector<Data_ListDataMulti_t> *vecListDataMulti;
 };
 
@@ -223,6 +231,12 @@ rom_data_view_class_init(RomDataViewClass *klass)
 
 	// Install the properties.
 	g_object_class_install_properties(gobject_class, PROP_LAST, klass->properties);
+
+#ifdef RP_GTK_USE_CAIRO
+	// Register RpCairoBackend.
+	// ARGB32 images can then be displayed without converting them.
+	rp_image::setBackendCreatorFn(RpCairoBackend::creator_fn);
+#endif /* RP_GTK_USE_CAIRO */
 }
 
 /**
@@ -887,7 +901,7 @@ static GtkWidget*
 rom_data_view_init_listdata(RomDataView *page,
 	const RomFields::Field &field, int fieldIdx)
 {
-	// ListData type. Create a GtkListStore for the data.
+	// ListData type. Create a ListDataModel for the data.
 	const auto &listDataDesc = field.desc.list_data;
 	// NOTE: listDataDesc.names can be nullptr,
 	// which means we don't have any column headers.
@@ -951,97 +965,18 @@ rom_data_view_init_listdata(RomDataView *page,
 		return nullptr;
 	}
 
-	GtkListStore *listStore;
-	int listStore_col_start;
-	if (hasCheckboxes) {
-		// Prepend an extra column for checkboxes.
-		GType *types = new GType[colCount+1];
-		types[0] = G_TYPE_BOOLEAN;
-		for (int i = colCount; i > 0; i--) {
-			types[i] = G_TYPE_STRING;
-		}
-		listStore = gtk_list_store_newv(colCount+1, types);
-		delete[] types;
-		listStore_col_start = 1;	// Skip the checkbox column for strings.
-	} else if (hasIcons) {
-		// Prepend an extra column for icons.
-		GType *types = new GType[colCount+1];
-		types[0] = PIMGTYPE_GOBJECT_TYPE;
-		for (int i = colCount; i > 0; i--) {
-			types[i] = G_TYPE_STRING;
-		}
-		listStore = gtk_list_store_newv(colCount+1, types);
-		delete[] types;
-		listStore_col_start = 1;	// Skip the icon column for strings.
-	} else {
-		// All strings.
-		GType *types = new GType[colCount];
-		for (int i = colCount-1; i >= 0; i--) {
-			types[i] = G_TYPE_STRING;
-		}
-		listStore = gtk_list_store_newv(colCount, types);
-		delete[] types;
-		listStore_col_start = 0;
+	// Create the ListDataModel.
+	// Rows are retrieved from the RomFields::Field on demand.
+	ListDataModel *const listModel = list_data_model_new(&field);
+	assert(listModel != nullptr);
+	if (!listModel) {
+		return nullptr;
 	}
-
-	// Add the row data.
-	uint32_t checkboxes = 0;
-	if (hasCheckboxes) {
-		checkboxes = field.data.list_data.mxd.checkboxes;
-	}
-	unsigned int row = 0;	// for icons [TODO: Use iterator?]
-	const auto list_data_cend = list_data->cend();
-	for (auto iter = list_data->cbegin(); iter != list_data_cend; ++iter, row++) {
-		const vector<string> &data_row = *iter;
-		// FIXME: Skip even if we don't have checkboxes?
-		// (also check other UI frontends)
-		if (hasCheckboxes && data_row.empty()) {
-			// Skip this row.
-			checkboxes >>= 1;
-			continue;
-		}
-
-		GtkTreeIter treeIter;
-		gtk_list_store_append(listStore, &treeIter);
-		if (hasCheckboxes) {
-			// Checkbox column.
-			gtk_list_store_set(listStore, &treeIter,
-				0, (checkboxes & 1), -1);
-			checkboxes >>= 1;
-		} else if (hasIcons) {
-			// Icon column.
-			const rp_image *const icon = field.data.list_data.mxd.icons->at(row);
-			if (icon) {
-				PIMGTYPE pixbuf = rp_image_to_PIMGTYPE(icon);
-				if (pixbuf) {
-					// TODO: Ideal icon size?
-					// Using 32x32 for now.
-					static const int icon_sz = 32;
-					// NOTE: GtkCellRendererPixbuf can't scale the
-					// pixbuf itself...
-					if (!PIMGTYPE_size_check(pixbuf, icon_sz, icon_sz)) {
-						// TODO: Use nearest-neighbor if upscaling.
-						// Also, preserve the aspect ratio.
-						PIMGTYPE scaled = PIMGTYPE_scale(pixbuf, icon_sz, icon_sz, true);
-						if (scaled) {
-							PIMGTYPE_destroy(pixbuf);
-							pixbuf = scaled;
-						}
-					}
-					gtk_list_store_set(listStore, &treeIter,
-						0, pixbuf, -1);
-					PIMGTYPE_destroy(pixbuf);
-				}
-			}
-		}
-
-		if (!isMulti) {
-			int col = listStore_col_start;
-			const auto data_row_cend = data_row.cend();
-			for (auto iter = data_row.cbegin(); iter != data_row_cend; ++iter, col++) {
-				gtk_list_store_set(listStore, &treeIter, col, iter->c_str(), -1);
-			}
-		}
+	const int model_col_start = list_data_model_get_column_start(listModel);
+	if (hasIcons) {
+		// TODO: Ideal icon size?
+		// Using 32x32 for now.
+		list_data_model_set_icon_size(listModel, 32);
 	}
 
 	// Scroll area for the GtkTreeView.
@@ -1051,11 +986,11 @@ rom_data_view_init_listdata(RomDataView *page,
 	gtk_scrolled_window_set_shadow_type(GTK_SCROLLED_WINDOW(widget), GTK_SHADOW_IN);
 	gtk_widget_show(widget);
 
-	// Sort proxy model for the GtkListStore.
-	GtkTreeModel *sortProxy = gtk_tree_model_sort_new_with_model(GTK_TREE_MODEL(listStore));
-
 	// Create the GtkTreeView.
-	GtkWidget *treeView = gtk_tree_view_new_with_model(GTK_TREE_MODEL(sortProxy));
+	// NOTE: ListDataModel implements GtkTreeSortable, so a
+	// GtkTreeModelSort proxy model isn't needed.
+	GtkWidget *treeView = gtk_tree_view_new_with_model(GTK_TREE_MODEL(listModel));
+	g_object_unref(listModel);	// GtkTreeView takes a reference.
 	gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(treeView),
 		(listDataDesc.names != nullptr));
 	gtk_widget_show(treeView);
@@ -1100,12 +1035,11 @@ rom_data_view_init_listdata(RomDataView *page,
 	uint32_t align_headers = listDataDesc.col_attrs.align_headers;
 	uint32_t align_data = listDataDesc.col_attrs.align_data;
 	uint32_t sizing = listDataDesc.col_attrs.sizing;
-	uint32_t sorting = listDataDesc.col_attrs.sorting;
 	for (int i = 0; i < colCount; i++, align_headers >>= RomFields::TXA_BITS,
 	     align_data >>= RomFields::TXA_BITS,
-	     sizing >>= RomFields::COLSZ_BITS, sorting >>= RomFields::COLSORT_BITS)
+	     sizing >>= RomFields::COLSZ_BITS)
 	{
-		const int listStore_col_idx = i + listStore_col_start;
+		const int model_col_idx = i + model_col_start;
 
 		// NOTE: Not skipping empty column names.
 		// TODO: Hide them.
@@ -1120,7 +1054,7 @@ rom_data_view_init_listdata(RomDataView *page,
 			col0_renderer = nullptr;
 		}
 		gtk_tree_view_column_pack_start(column, renderer, TRUE);
-		gtk_tree_view_column_add_attribute(column, renderer, "text", listStore_col_idx);
+		gtk_tree_view_column_add_attribute(column, renderer, "text", model_col_idx);
 		gtk_tree_view_append_column(GTK_TREE_VIEW(treeView), column);
 
 		// Header alignment
@@ -1161,34 +1095,9 @@ rom_data_view_init_listdata(RomDataView *page,
 		}
 
 		// Enable sorting.
-		gtk_tree_view_column_set_sort_column_id(column, listStore_col_idx);
+		// NOTE: The sorting method is handled by ListDataModel.
+		gtk_tree_view_column_set_sort_column_id(column, model_col_idx);
 		gtk_tree_view_column_set_clickable(column, TRUE);
-
-		// Check what we should use for sorting.
-		// NOTE: We're setting the sorting functions on the proxy model.
-		// That way, it won't affect the underlying data, which ensures
-		// that RFT_LISTDATA_MULTI is still handled correctly.
-		switch (sorting & RomFields::COLSORT_MASK) {
-			default:
-				// Unsupported. We'll use standard sorting.
-				assert(!"Unsupported sorting method.");
-				// fall-through
-			case RomFields::COLSORT_STANDARD:
-				// Standard sorting.
-				break;
-			case RomFields::COLSORT_NOCASE:
-				// Case-insensitive sorting.
-				gtk_tree_sortable_set_sort_func(GTK_TREE_SORTABLE(sortProxy),
-					listStore_col_idx, sort_RFT_LISTDATA_nocase,
-					GINT_TO_POINTER(listStore_col_idx), nullptr);
-				break;
-			case RomFields::COLSORT_NUMERIC:
-				// Numeric sorting. (case-insensitive)
-				gtk_tree_sortable_set_sort_func(GTK_TREE_SORTABLE(sortProxy),
-					listStore_col_idx, sort_RFT_LISTDATA_numeric,
-					GINT_TO_POINTER(listStore_col_idx), nullptr);
-				break;
-		}
 	}
 
 	assert(col0_renderer == nullptr);
@@ -1200,8 +1109,8 @@ rom_data_view_init_listdata(RomDataView *page,
 	// Set the default sorting column.
 	// NOTE: sort_dir maps directly to GtkSortType.
 	if (listDataDesc.col_attrs.sort_col >= 0) {
-		gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(sortProxy),
-			listDataDesc.col_attrs.sort_col + listStore_col_start,
+		gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(listModel),
+			listDataDesc.col_attrs.sort_col + model_col_start,
 			static_cast<GtkSortType>(listDataDesc.col_attrs.sort_dir));
 	}
 
@@ -1227,7 +1136,7 @@ rom_data_view_init_listdata(RomDataView *page,
 
 	if (isMulti) {
 		page->vecListDataMulti->emplace_back(
-			Data_ListDataMulti_t(listStore, GTK_TREE_VIEW(treeView), &field));
+			Data_ListDataMulti_t(listModel, GTK_TREE_VIEW(treeView), &field));
 	}
 
 	page->map_fieldIdx->insert(std::make_pair(fieldIdx, widget));
@@ -1363,16 +1272,20 @@ rom_data_view_init_string_multi(RomDataView *page,
 }
 
 /**
- * Update all multi-language fields.
+ * Update multi-language fields.
  * @param page		[in] RomDataView object.
  * @param user_lc	[in] User-specified language code.
+ * @param sm_start	[in] Index of the first RFT_STRING_MULTI field to update.
+ * @param ldm_start	[in] Index of the first RFT_LISTDATA_MULTI field to update.
+ * @param autosize	[in] If true, resize RFT_LISTDATA_MULTI columns to fit the contents.
  */
 static void
-rom_data_view_update_multi(RomDataView *page, uint32_t user_lc)
+rom_data_view_update_multi(RomDataView *page, uint32_t user_lc,
+	size_t sm_start = 0, size_t ldm_start = 0, bool autosize = false)
 {
 	// RFT_STRING_MULTI
 	const auto vecStringMulti_cend = page->vecStringMulti->cend();
-	for (auto iter = page->vecStringMulti->cbegin();
+	for (auto iter = page->vecStringMulti->cbegin() + sm_start;
 	     iter != vecStringMulti_cend; ++iter)
 	{
 		GtkWidget *const lblString = iter->first;
@@ -1385,17 +1298,6 @@ rom_data_view_update_multi(RomDataView *page, uint32_t user_lc)
 			continue;
 		}
 
-		if (!page->cboLanguage) {
-			// Need to add all supported languages.
-			// TODO: Do we need to do this for all of them, or just one?
-			const auto pStr_multi_cend = pStr_multi->cend();
-			for (auto iter_sm = pStr_multi->cbegin();
-			     iter_sm != pStr_multi_cend; ++iter_sm)
-			{
-				page->set_lc->insert(iter_sm->first);
-			}
-		}
-
 		// Get the string and update the text.
 		const string *const pStr = RomFields::getFromStringMulti(pStr_multi, page->def_lc, user_lc);
 		assert(pStr != nullptr);
@@ -1404,75 +1306,73 @@ rom_data_view_update_multi(RomDataView *page, uint32_t user_lc)
 
 	// RFT_LISTDATA_MULTI
 	const auto vecListDataMulti_cend = page->vecListDataMulti->cend();
-	for (auto iter = page->vecListDataMulti->cbegin();
+	for (auto iter = page->vecListDataMulti->cbegin() + ldm_start;
 	     iter != vecListDataMulti_cend; ++iter)
 	{
-		GtkListStore *const listStore = iter->listStore;
-		const RomFields::Field *const pField = iter->field;
-		const auto *const pListData_multi = pField->data.list_data.data.multi;
-		assert(pListData_multi != nullptr);
-		assert(!pListData_multi->empty());
-		if (!pListData_multi || pListData_multi->empty()) {
-			// Invalid RFT_LISTDATA_MULTI...
-			continue;
-		}
+		// Set the language code.
+		// NOTE: ListDataModel retrieves the strings on demand.
+		list_data_model_set_lc(iter->listModel, page->def_lc, user_lc);
 
-		if (!page->cboLanguage) {
-			// Need to add all supported languages.
-			// TODO: Do we need to do this for all of them, or just one?
-			const auto pListData_multi_cend = pListData_multi->cend();
-			for (auto iter_sm = pListData_multi->cbegin();
-			     iter_sm != pListData_multi_cend; ++iter_sm)
-			{
-				page->set_lc->insert(iter_sm->first);
-			}
+		// Resize the columns to fit the contents.
+		// NOTE: Only done on first load.
+		if (autosize) {
+			gtk_tree_view_columns_autosize(GTK_TREE_VIEW(iter->treeView));
 		}
+	}
+}
 
-		// Get the ListData_t.
-		const auto *const pListData = RomFields::getFromListDataMulti(pListData_multi, page->def_lc, user_lc);
-		assert(pListData != nullptr);
-		if (pListData != nullptr) {
-			const auto &listDataDesc = pField->desc.list_data;
-
-			// If we have checkboxes or icons, start at column 1.
-			// Otherwise, start at column 0.
-			int listStore_col_start;
-			if (listDataDesc.flags & (RomFields::RFT_LISTDATA_CHECKBOXES | RomFields::RFT_LISTDATA_ICONS)) {
-				// Checkboxes and/or icons are present.
-				listStore_col_start = 1;
-			} else {
-				listStore_col_start = 0;
-			}
+/**
+ * Initialize the language combobox.
+ * All supported languages are collected from the RFT_STRING_MULTI
+ * and RFT_LISTDATA_MULTI fields, since the widgets for fields on
+ * tabs that haven't been shown yet don't exist yet.
+ * @param page		[in] RomDataView object.
+ * @param pFields	[in] RomFields
+ */
+static void
+rom_data_view_init_cboLanguage(RomDataView *page, const RomFields *pFields)
+{
+	assert(!page->cboLanguage);
 
-			// Update the list.
-			GtkTreeIter treeIter;
-			gboolean ok = gtk_tree_model_get_iter_first(GTK_TREE_MODEL(listStore), &treeIter);
-			auto iter_listData = pListData->cbegin();
-			const auto pListData_cend = pListData->cend();
-			while (ok && iter_listData != pListData_cend) {
-				// TODO: Verify GtkListStore column count?
-				int col = listStore_col_start;
-				const auto iter_listData_cend = iter_listData->cend();
-				for (auto iter_row = iter_listData->cbegin();
-				     iter_row != iter_listData_cend; ++iter_row, col++)
-				{
-					gtk_list_store_set(listStore, &treeIter, col, iter_row->c_str(), -1);
-				}
+	// Get all supported languages.
+	const auto pFields_cend = pFields->cend();
+	for (auto iter = pFields->cbegin(); iter != pFields_cend; ++iter) {
+		const RomFields::Field &field = *iter;
+		if (!field.isValid)
+			continue;
 
-				// Next row.
-				++iter_listData;
-				ok = gtk_tree_model_iter_next(GTK_TREE_MODEL(listStore), &treeIter);
-			}
+		// Skip fields on hidden tabs.
+		const int tabIdx = field.tabIdx;
+		if (tabIdx < 0 || tabIdx >= (int)page->tabs->size() ||
+		    !page->tabs->at(tabIdx).table)
+		{
+			continue;
+		}
 
-			// Resize the columns to fit the contents.
-			// NOTE: Only done on first load.
-			if (!page->cboLanguage) {
-				gtk_tree_view_columns_autosize(GTK_TREE_VIEW(iter->treeView));
-			}
+		if (field.type == RomFields::RFT_STRING_MULTI) {
+			const auto *const pStr_multi = field.data.str_multi;
+			if (!pStr_multi)
+				continue;
+			std::for_each(pStr_multi->cbegin(), pStr_multi->cend(),
+				[page](const RomFields::StringMultiMap_t::value_type &p) {
+					page->set_lc->insert(p.first);
+				}
+			);
+		} else if (field.type == RomFields::RFT_LISTDATA &&
+			   (field.desc.list_data.flags & RomFields::RFT_LISTDATA_MULTI))
+		{
+			const auto *const pListData_multi = field.data.list_data.data.multi;
+			if (!pListData_multi)
+				continue;
+			std::for_each(pListData_multi->cbegin(), pListData_multi->cend(),
+				[page](const RomFields::ListDataMultiMap_t::value_type &p) {
+					page->set_lc->insert(p.first);
+				}
+			);
 		}
 	}
 
-	if (!page->cboLanguage && page->set_lc->size() > 1) {
+	if (page->set_lc->size() > 1) {
 		// Create a VBox for the combobox to reduce its vertical height.
 #if GTK_CHECK_VERSION(3,0,0)
 		GtkWidget *const vboxCboLanguage = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
@@ -1557,6 +1457,14 @@ rom_data_view_update_field(RomDataView *page, int fieldIdx)
 	if (!field)
 		return 3;
 
+	// If the field's tab hasn't been shown yet, its widget will
+	// be created using the updated value when it's shown.
+	if (field->tabIdx >= 0 && field->tabIdx < (int)page->tabs->size() &&
+	    !page->tabs->at(field->tabIdx).populated)
+	{
+		return 0;
+	}
+
 	// Get the GtkWidget*.
 	auto iter = page->map_fieldIdx->find(fieldIdx);
 	if (iter == page->map_fieldIdx->end()) {
@@ -1861,30 +1769,68 @@ rom_data_view_update_display(RomDataView *page)
 
 	// Reserve enough space for vecDescLabels.
 	page->vecDescLabels->reserve(count);
-	// Per-tab row counts.
-	vector<int> tabRowCount(page->tabs->size());
+
+	// Initialize the language combobox.
+	page->def_lc = pFields->defaultLanguageCode();
+	rom_data_view_init_cboLanguage(page, pFields);
+
+	// Create the widgets for the visible tab.
+	// Widgets for other tabs are created when the tab is first shown.
+	if (page->tabWidget) {
+		GtkNotebook *const notebook = GTK_NOTEBOOK(page->tabWidget);
+		const int curPage = gtk_notebook_get_current_page(notebook);
+		if (curPage >= 0) {
+			tabWidget_switch_page_signal_handler(notebook, nullptr, curPage, page);
+		}
+		g_signal_connect(page->tabWidget, "switch-page",
+			G_CALLBACK(tabWidget_switch_page_signal_handler), page);
+	} else {
+		rom_data_view_init_tab(page, 0);
+	}
+}
+
+/**
+ * Create the field widgets for a tab.
+ * Does nothing if the tab's widgets were already created.
+ * @param page		[in] RomDataView object.
+ * @param tabIdx	[in] Tab index.
+ */
+static void
+rom_data_view_init_tab(RomDataView *page, int tabIdx)
+{
+	assert(tabIdx >= 0 && tabIdx < (int)page->tabs->size());
+	if (tabIdx < 0 || tabIdx >= (int)page->tabs->size())
+		return;
+
+	auto &tab = page->tabs->at(tabIdx);
+	if (tab.populated || !tab.table) {
+		// Tab is already populated, or tab is hidden.
+		return;
+	}
+	tab.populated = true;
+
+	const RomFields *const pFields = page->romData->fields();
+	const int tabCount = static_cast<int>(page->tabs->size());
+#if !GTK_CHECK_VERSION(3,0,0)
+	int rowCount = pFields->count();
+#endif
+
+	// Multi-language fields that are created here
+	// will need to be updated afterwards.
+	const size_t sm_start = page->vecStringMulti->size();
+	const size_t ldm_start = page->vecListDataMulti->size();
 
 	// tr: Field description label.
 	const char *const desc_label_fmt = C_("RomDataView", "%s:");
 
 	// Create the data widgets.
+	int row = 0;
 	int fieldIdx = 0;
 	const auto pFields_cend = pFields->cend();
 	for (auto iter = pFields->cbegin(); iter != pFields_cend; ++iter, fieldIdx++) {
 		const RomFields::Field &field = *iter;
-		if (!field.isValid)
-			continue;
-
-		// Verify the tab index.
-		const int tabIdx = field.tabIdx;
-		assert(tabIdx >= 0 && tabIdx < (int)page->tabs->size());
-		if (tabIdx < 0 || tabIdx >= (int)page->tabs->size()) {
-			// Tab index is out of bounds.
-			continue;
-		} else if (!page->tabs->at(tabIdx).table) {
-			// Tab name is empty. Tab is hidden.
+		if (!field.isValid || field.tabIdx != tabIdx)
 			continue;
-		}
 
 		GtkWidget *widget = nullptr;
 		bool separate_rows = false;
@@ -1923,10 +1869,8 @@ rom_data_view_update_display(RomDataView *page)
 
 		if (widget) {
 			// Add the widget to the table.
-			auto &tab = page->tabs->at(tabIdx);
-
 			// tr: Field description label.
-			const string txt = rp_sprintf(desc_label_fmt, field.name.c_str());
+			const string txt = rp_sprintf(desc_label_fmt, field.name);
 			GtkWidget *lblDesc = gtk_label_new(txt.c_str());
 			gtk_label_set_use_underline(GTK_LABEL(lblDesc), false);
 			gtk_widget_show(lblDesc);
@@ -1942,7 +1886,6 @@ rom_data_view_update_display(RomDataView *page)
 			set_label_format_type(GTK_LABEL(lblDesc), page->desc_format_type);
 
 			// Value widget.
-			int &row = tabRowCount[tabIdx];
 #if USE_GTK_GRID
 			// TODO: GTK_FILL
 			gtk_grid_attach(GTK_GRID(tab.table), lblDesc, 0, row, 1, 1);
@@ -2052,9 +1995,8 @@ rom_data_view_update_display(RomDataView *page)
 	}
 
 	// Initial update of RFT_STRING_MULTI and RFT_LISTDATA_MULTI fields.
-	if (!page->vecStringMulti->empty() || !page->vecListDataMulti->empty()) {
-		page->def_lc = pFields->defaultLanguageCode();
-		rom_data_view_update_multi(page, 0);
+	if (page->vecStringMulti->size() > sm_start || page->vecListDataMulti->size() > ldm_start) {
+		rom_data_view_update_multi(page, page->user_lc, sm_start, ldm_start, true);
 	}
 }
 
@@ -2080,13 +2022,18 @@ rom_data_view_load_rom_data(gpointer data)
 		g_free(filename);
 	} else {
 		// Not a local file. Use RpFileGio.
-		file = new RpFileGio(page->uri);
+		// GVfs reads are expensive, so wrap it in a CachedFile.
+		RpFileGio *const gioFile = new RpFileGio(page->uri);
+		file = new CachedFile(gioFile);
+		gioFile->unref();
 	}
 
 	if (file->isOpen()) {
 		// Create the RomData object.
 		// file is ref()'d by RomData.
-		RomData *const romData = RomDataFactory::create(file);
+		// The parsed-result cache is used if it's enabled,
+		// so large files don't have to be parsed again.
+		RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_PARSED_CACHE);
 		if (romData != page->romData) {
 			// FIXME: If called from rom_data_view_set_property(), this might
 			// result in *two* notifications.
@@ -2131,6 +2078,12 @@ rom_data_view_delete_tabs(RomDataView *page)
 	assert(page->vecStringMulti != nullptr);
 	assert(page->vecListDataMulti != nullptr);
 
+	// Don't create any more tab widgets while the tabs are being deleted.
+	if (page->tabWidget) {
+		g_signal_handlers_disconnect_by_func(page->tabWidget,
+			(gpointer)tabWidget_switch_page_signal_handler, page);
+	}
+
 	// Delete the tab contents.
 	std::for_each(page->tabs->begin(), page->tabs->end(),
 		[page](_RomDataView::tab &tab) {
@@ -2162,6 +2115,7 @@ rom_data_view_delete_tabs(RomDataView *page)
 
 	// Clear the various widget references.
 	page->vecDescLabels->clear();
+	page->user_lc = 0;
 	page->set_lc->clear();
 	page->vecStringMulti->clear();
 	page->vecListDataMulti->clear();
@@ -2230,6 +2184,38 @@ rom_data_view_unmap_signal_handler(RomDataView	*page,
 	}
 }
 
+/**
+ * The GtkNotebook page was changed.
+ * Field widgets for the new tab are created if necessary.
+ * @param notebook	GtkNotebook
+ * @param page_widget	New page (GtkWidget* on GTK+ 3.x; GtkNotebookPage* on GTK+ 2.x)
+ * @param page_num	New page index
+ * @param page		RomDataView
+ */
+static void
+tabWidget_switch_page_signal_handler(GtkNotebook	*notebook,
+				     gpointer		 page_widget,
+				     guint		 page_num,
+				     RomDataView	*page)
+{
+	RP_UNUSED(page_widget);
+
+	// NOTE: Hidden tabs aren't added to the GtkNotebook,
+	// so the page index might not match the tab index.
+	GtkWidget *const vbox = gtk_notebook_get_nth_page(notebook, page_num);
+	if (!vbox)
+		return;
+
+	int tabIdx = 0;
+	const auto tabs_cend = page->tabs->cend();
+	for (auto iter = page->tabs->cbegin(); iter != tabs_cend; ++iter, tabIdx++) {
+		if (iter->vbox == vbox) {
+			rom_data_view_init_tab(page, tabIdx);
+			break;
+		}
+	}
+}
+
 /**
  * GtkTreeView widget has been realized.
  * @param treeView GtkTreeView
@@ -2325,7 +2311,9 @@ cboLanguage_lc_changed_signal_handler(GtkComboBox *widget,
 				      gpointer     user_data)
 {
 	RP_UNUSED(widget);
-	rom_data_view_update_multi(ROM_DATA_VIEW(user_data), lc);
+	RomDataView *const page = ROM_DATA_VIEW(user_data);
+	page->user_lc = lc;
+	rom_data_view_update_multi(page, lc);
 }
 
 /**
@@ -0,0 +1,309 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ 3.x)                         *
+ * RpCairoBackend.cpp: rp_image_backend using Cairo.                       *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RpCairoBackend.hpp"
+#include "CairoImageConv.hpp"
+
+// librpbase, librptexture
+#include "librpbase/aligned_malloc.h"
+using LibRpTexture::rp_image;
+using LibRpTexture::rp_image_backend;
+
+// User data key for the image data buffer.
+static const cairo_user_data_key_t data_key = { 0 };
+
+RpCairoBackend::RpCairoBackend(int width, int height, rp_image::Format format)
+	: super(width, height, format)
+	, m_surface(nullptr)
+	, m_surfacePremult(nullptr)
+	, m_data(nullptr)
+	, m_palette(nullptr)
+	, m_palette_len(0)
+{
+	if (width == 0 || height == 0) {
+		// Error initializing the backend.
+		// (Width, height, or format is probably broken.)
+		return;
+	}
+
+	switch (format) {
+		case rp_image::Format::ARGB32:
+			// NOTE: rp_image_backend uses 16-byte row alignment,
+			// which is also valid for Cairo.
+			m_surface = createSurface(width, height, this->stride);
+			if (!m_surface) {
+				// Error creating the Cairo surface.
+				clear_properties();
+				return;
+			}
+			break;
+
+		case rp_image::Format::CI8:
+			// Cairo doesn't support CI8, so allocate our own buffer.
+			m_data = static_cast<uint8_t*>(aligned_malloc(16, height * this->stride));
+			if (!m_data) {
+				// Error allocating the memory buffer.
+				clear_properties();
+				return;
+			}
+
+			// Palette is initialized to 0 to ensure
+			// there's no weird artifacts if the caller
+			// is converting a lower-color image.
+			m_palette = static_cast<uint32_t*>(aligned_malloc(16, 256*sizeof(*m_palette)));
+			if (!m_palette) {
+				// Error allocating the palette.
+				aligned_free(m_data);
+				m_data = nullptr;
+				clear_properties();
+				return;
+			}
+			memset(m_palette, 0, 256*sizeof(*m_palette));
+			m_palette_len = 256;
+			break;
+
+		default:
+			assert(!"Unsupported rp_image::Format.");
+			clear_properties();
+			return;
+	}
+}
+
+RpCairoBackend::~RpCairoBackend()
+{
+	if (m_surface) {
+		cairo_surface_destroy(m_surface);
+	}
+	if (m_surfacePremult) {
+		cairo_surface_destroy(m_surfacePremult);
+	}
+	aligned_free(m_data);
+	aligned_free(m_palette);
+}
+
+/**
+ * Create an ARGB32 Cairo surface with 16-byte row alignment.
+ * The surface owns the image data.
+ * @param width Width.
+ * @param height Height.
+ * @param stride Stride, in bytes.
+ * @return Cairo surface, or nullptr on error.
+ */
+cairo_surface_t *RpCairoBackend::createSurface(int width, int height, int stride)
+{
+	assert(stride >= cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width));
+	uint8_t *const data = static_cast<uint8_t*>(aligned_malloc(16, height * stride));
+	if (!data) {
+		// Error allocating the memory buffer.
+		return nullptr;
+	}
+
+	// NOTE: cairo_image_surface_create_for_data() doesn't take
+	// ownership of the buffer, so it's freed using user data
+	// when the surface is destroyed. This allows the surface
+	// to outlive the RpCairoBackend.
+	cairo_surface_t *const surface = cairo_image_surface_create_for_data(
+		data, CAIRO_FORMAT_ARGB32, width, height, stride);
+	if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+		cairo_surface_destroy(surface);
+		aligned_free(data);
+		return nullptr;
+	}
+	if (cairo_surface_set_user_data(surface, &data_key, data, aligned_free) != CAIRO_STATUS_SUCCESS) {
+		cairo_surface_destroy(surface);
+		aligned_free(data);
+		return nullptr;
+	}
+
+	return surface;
+}
+
+/**
+ * Make sure this backend has its own copy of the image data.
+ * Called if the surface is in use outside of this backend.
+ */
+void RpCairoBackend::detach(void)
+{
+	assert(m_surface != nullptr);
+	cairo_surface_t *const surface = createSurface(width, height, stride);
+	assert(surface != nullptr);
+	if (!surface) {
+		// Error creating the Cairo surface.
+		// Keep using the shared surface.
+		return;
+	}
+
+	cairo_surface_flush(m_surface);
+	memcpy(cairo_image_surface_get_data(surface),
+		cairo_image_surface_get_data(m_surface), height * stride);
+	cairo_surface_destroy(m_surface);
+	m_surface = surface;
+}
+
+/**
+ * Creator function for rp_image::setBackendCreatorFn().
+ */
+rp_image_backend *RpCairoBackend::creator_fn(int width, int height, rp_image::Format format)
+{
+	return new RpCairoBackend(width, height, format);
+}
+
+void *RpCairoBackend::data(void)
+{
+	if (!m_surface) {
+		// CI8 image.
+		return m_data;
+	}
+
+	// The image data is about to be modified.
+	// If the surface was returned by getCairoSurface()
+	// and it's still in use, get our own copy.
+	if (cairo_surface_get_reference_count(m_surface) > 1) {
+		detach();
+	}
+
+	// The cached premultiplied surface will be out of date.
+	if (m_surfacePremult) {
+		cairo_surface_destroy(m_surfacePremult);
+		m_surfacePremult = nullptr;
+	}
+
+	cairo_surface_flush(m_surface);
+	return cairo_image_surface_get_data(m_surface);
+}
+
+const void *RpCairoBackend::data(void) const
+{
+	if (!m_surface) {
+		// CI8 image.
+		return m_data;
+	}
+	return cairo_image_surface_get_data(m_surface);
+}
+
+size_t RpCairoBackend::data_len(void) const
+{
+	if (width <= 0 || height <= 0)
+		return 0;
+	return height * stride;
+}
+
+uint32_t *RpCairoBackend::palette(void)
+{
+	return m_palette;
+}
+
+const uint32_t *RpCairoBackend::palette(void) const
+{
+	return m_palette;
+}
+
+int RpCairoBackend::palette_len(void) const
+{
+	return m_palette_len;
+}
+
+/**
+ * Shrink image dimensions.
+ * @param width New width.
+ * @param height New height.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpCairoBackend::shrink(int width, int height)
+{
+	assert(width > 0);
+	assert(height > 0);
+	assert(this->width > 0);
+	assert(this->height > 0);
+	assert(width <= this->width);
+	assert(height <= this->height);
+	if (width <= 0 || height <= 0 ||
+	    this->width <= 0 || this->height <= 0 ||
+	    width > this->width || height > this->height)
+	{
+		return -EINVAL;
+	}
+
+	if (m_surface) {
+		// Cairo surfaces can't be resized in-place,
+		// so we'll need to copy it to a new surface.
+		cairo_surface_t *const surface = createSurface(width, height, stride);
+		if (!surface) {
+			return -ENOMEM;
+		}
+
+		cairo_surface_flush(m_surface);
+		memcpy(cairo_image_surface_get_data(surface),
+			cairo_image_surface_get_data(m_surface), height * stride);
+		cairo_surface_destroy(m_surface);
+		m_surface = surface;
+
+		if (m_surfacePremult) {
+			cairo_surface_destroy(m_surfacePremult);
+			m_surfacePremult = nullptr;
+		}
+	}
+
+	// CI8 images can simply reduce width/height
+	// without actually adjusting the image data.
+	this->width = width;
+	this->height = height;
+	return 0;
+}
+
+/**
+ * Get a Cairo surface for an rp_image without converting it, if possible.
+ *
+ * ARGB32 images using RpCairoBackend are returned directly.
+ * If premultiplied alpha is requested and the image might have
+ * an alpha channel, a premultiplied copy is made on first use
+ * and cached until the image data is modified.
+ *
+ * The image data is shared with the returned surface. If the
+ * rp_image is modified later, the backend gets a new copy of
+ * the image data, so the returned surface isn't changed.
+ *
+ * @param img		[in] rp_image.
+ * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
+ * @return Cairo surface (caller must destroy it), or nullptr if the image must be converted.
+ */
+cairo_surface_t *RpCairoBackend::getCairoSurface(const rp_image *img, bool premultiply)
+{
+	assert(img != nullptr);
+	if (unlikely(!img || !img->isValid()))
+		return nullptr;
+
+	const RpCairoBackend *const backend =
+		dynamic_cast<const RpCairoBackend*>(img->backend());
+	if (!backend || !backend->m_surface) {
+		// Not an RpCairoBackend, or not ARGB32.
+		return nullptr;
+	}
+
+	if (premultiply) {
+		// Images without an alpha channel don't need to be premultiplied.
+		// NOTE: RpPngWriter also uses sBIT to check for an alpha channel.
+		rp_image::sBIT_t sBIT;
+		const bool has_alpha = (img->get_sBIT(&sBIT) != 0 || sBIT.alpha != 0);
+		if (has_alpha) {
+			if (!backend->m_surfacePremult) {
+				backend->m_surfacePremult = CairoImageConv::rp_image_to_cairo_surface_t(img, true);
+				if (!backend->m_surfacePremult) {
+					return nullptr;
+				}
+			}
+			return cairo_surface_reference(backend->m_surfacePremult);
+		}
+	}
+
+	// rp_image modifies the image data directly,
+	// so Cairo needs to reload it.
+	cairo_surface_mark_dirty(backend->m_surface);
+	return cairo_surface_reference(backend->m_surface);
+}
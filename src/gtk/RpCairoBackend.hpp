@@ -0,0 +1,110 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (GTK+ 3.x)                         *
+ * RpCairoBackend.hpp: rp_image_backend using Cairo.                       *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_GTK_RPCAIROBACKEND_HPP__
+#define __ROMPROPERTIES_GTK_RPCAIROBACKEND_HPP__
+
+// librptexture
+#include "librptexture/img/rp_image_backend.hpp"
+
+// Cairo
+#include <cairo.h>
+
+/**
+ * rp_image data storage class using a Cairo image surface.
+ *
+ * ARGB32 images are stored in a cairo_surface_t, so they can be
+ * passed to GTK+ without copying the image data.
+ *
+ * NOTE: Cairo doesn't support 8bpp images, so CI8 images
+ * are stored in memory and converted using CairoImageConv.
+ */
+class RpCairoBackend : public LibRpTexture::rp_image_backend
+{
+	public:
+		RpCairoBackend(int width, int height, LibRpTexture::rp_image::Format format);
+		virtual ~RpCairoBackend();
+
+	private:
+		typedef LibRpTexture::rp_image_backend super;
+		RP_DISABLE_COPY(RpCairoBackend)
+
+	private:
+		/**
+		 * Create an ARGB32 Cairo surface with 16-byte row alignment.
+		 * The surface owns the image data.
+		 * @param width Width.
+		 * @param height Height.
+		 * @param stride Stride, in bytes.
+		 * @return Cairo surface, or nullptr on error.
+		 */
+		static cairo_surface_t *createSurface(int width, int height, int stride);
+
+		/**
+		 * Make sure this backend has its own copy of the image data.
+		 * Called if the surface is in use outside of this backend.
+		 */
+		void detach(void);
+
+	public:
+		/**
+		 * Creator function for rp_image::setBackendCreatorFn().
+		 */
+		static LibRpTexture::rp_image_backend *creator_fn(int width, int height, LibRpTexture::rp_image::Format format);
+
+		// Image data.
+		void *data(void) final;
+		const void *data(void) const final;
+		size_t data_len(void) const final;
+
+		// Image palette.
+		uint32_t *palette(void) final;
+		const uint32_t *palette(void) const final;
+		int palette_len(void) const final;
+
+	public:
+		/**
+		 * Shrink image dimensions.
+		 * @param width New width.
+		 * @param height New height.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int shrink(int width, int height) final;
+
+	public:
+		/**
+		 * Get a Cairo surface for an rp_image without converting it, if possible.
+		 *
+		 * ARGB32 images using RpCairoBackend are returned directly.
+		 * If premultiplied alpha is requested and the image might have
+		 * an alpha channel, a premultiplied copy is made on first use
+		 * and cached until the image data is modified.
+		 *
+		 * The image data is shared with the returned surface. If the
+		 * rp_image is modified later, the backend gets a new copy of
+		 * the image data, so the returned surface isn't changed.
+		 *
+		 * @param img		[in] rp_image.
+		 * @param premultiply	[in] If true, premultiply. Needed for display; NOT needed for PNG.
+		 * @return Cairo surface (caller must destroy it), or nullptr if the image must be converted.
+		 */
+		static cairo_surface_t *getCairoSurface(const LibRpTexture::rp_image *img, bool premultiply);
+
+	protected:
+		// ARGB32: Image surface.
+		cairo_surface_t *m_surface;
+		// ARGB32: Cached premultiplied surface.
+		mutable cairo_surface_t *m_surfacePremult;
+
+		// CI8: Image data and palette.
+		uint8_t *m_data;
+		uint32_t *m_palette;
+		int m_palette_len;
+};
+
+#endif /* __ROMPROPERTIES_GTK_RPCAIROBACKEND_HPP__ */
@@ -101,6 +101,7 @@
 #include "librpfile/FileSystem.hpp"
 #include "librpfile/IRpFile.hpp"
 #include "librpfile/RpFile.hpp"
+#include "librpfile/CachedFile.hpp"
 
 // librptexture C++ headers
 #include "librptexture/img/rp_image.hpp"
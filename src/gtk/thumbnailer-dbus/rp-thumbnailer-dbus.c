@@ -16,11 +16,14 @@
 
 #include <glib-object.h>
 #include "SpecializedThumbnailer1.h"
+#include "ThumbnailerStatistics1.h"
 
 // C includes.
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 // from tumbler-utils.h
 #define g_dbus_async_return_val_if_fail(expr, invocation, val) \
@@ -42,6 +45,9 @@ enum RpThumbnailerProperties {
 	PROP_CONNECTION,
 	PROP_CACHE_DIR,
 	PROP_PFN_RP_CREATE_THUMBNAIL,
+	PROP_PFN_RP_CREATE_THUMBNAIL2,
+	PROP_NUM_THREADS,
+	PROP_TIMEOUT_MS,
 	PROP_EXPORTED,
 
 	PROP_LAST
@@ -68,8 +74,14 @@ static void	rp_thumbnailer_set_property	(GObject	*object,
 						 const GValue	*value,
 						 GParamSpec	*pspec);
 
+static void	rp_thumbnailer_start_timeout	(RpThumbnailer	*thumbnailer);
 static gboolean	rp_thumbnailer_timeout		(RpThumbnailer	*thumbnailer);
-static gboolean	rp_thumbnailer_process		(RpThumbnailer	*thumbnailer);
+static void	rp_thumbnailer_process		(gpointer	 data,
+						 gpointer	 user_data);
+static gboolean	rp_thumbnailer_process_finished	(gpointer	 data);
+static gint	rp_thumbnailer_request_compare	(gconstpointer	 a,
+						 gconstpointer	 b,
+						 gpointer	 user_data);
 
 // D-Bus methods.
 static gboolean	rp_thumbnailer_queue		(OrgFreedesktopThumbnailsSpecializedThumbnailer1 *skeleton,
@@ -83,6 +95,9 @@ static gboolean	rp_thumbnailer_dequeue		(OrgFreedesktopThumbnailsSpecializedThum
 						 GDBusMethodInvocation *invocation,
 						 guint32	 handle,
 						 RpThumbnailer	*thumbnailer);
+static gboolean	rp_thumbnailer_get_statistics	(RpThumbnailerStatistics1 *skeleton,
+						 GDBusMethodInvocation *invocation,
+						 RpThumbnailer	*thumbnailer);
 
 struct _RpThumbnailerClass {
 	GObjectClass __parent__;
@@ -91,34 +106,98 @@ struct _RpThumbnailerClass {
 	guint signal_ids[SIGNAL_LAST];
 };
 
+// Idle timeout range.
+// The idle timeout is adjusted based on the gaps between bursts
+// of requests, so the service stays running if more requests
+// are likely to arrive soon.
 #define SHUTDOWN_TIMEOUT_SECONDS 30
+#define SHUTDOWN_TIMEOUT_MAX_SECONDS 300
+
+// Number of latency samples to keep for each MIME type.
+#define LATENCY_SAMPLES 256
+
+// Statistics for a single MIME type.
+// NOTE: Only accessed on the main context.
+struct mime_stats {
+	guint64 completed;
+	guint64 failed;
+	guint64 total_us;	// Total latency, in microseconds.
+
+	// Most recent latencies, in microseconds. (ring buffer)
+	guint32 samples[LATENCY_SAMPLES];
+	guint sample_count;
+	guint sample_pos;
+};
 
 // Thumbnail request information.
+// NOTE: Duplicate requests for the same URI and flavor are coalesced
+// into a single request_info with multiple handles.
 struct request_info {
+	RpThumbnailer *thumbnailer;	// owning RpThumbnailer (ref'd)
 	gchar *uri;
-	guint32 handle;
+	gchar *mime_type;
+	gchar *key;	// Key in RpThumbnailer::uri_requests: flavor + URI
+	gint64 queue_time;	// g_get_monotonic_time() when the request was queued
+	guint32 handle;	// First handle. (used for FIFO ordering within a lane)
 	bool large;	// False for 'normal' (128x128); true for 'large' (256x256)
-	bool urgent;	// 'urgent' value
+	bool urgent;	// 'urgent' value: true for the foreground lane; false for background
+
+	// Handles that are waiting for this request. (guint32)
+	// If all handles are dequeued, the request is cancelled.
+	// NOTE: Only accessed on the main context.
+	GArray *handles;
+
+	// Cancellation flag. Set using g_atomic_int_set().
+	// Checked by the worker thread and rp_create_thumbnail2().
+	volatile gint cancelled;
+
+	// Set by the worker thread if the request was started.
+	bool started;
+
+	// Results. (set by the worker thread)
+	const char *err_msg;	// Error message, or NULL on success. (static string)
+	int err_code;		// Error code for the Error signal.
+	bool err_no_uri;	// If true, don't include the URI in the Error signal.
 };
 
 struct _RpThumbnailer {
 	GObject __parent__;
 	OrgFreedesktopThumbnailsSpecializedThumbnailer1 *skeleton;
+	RpThumbnailerStatistics1 *stats_skeleton;
 
 	// Has the shutdown signal been emitted?
 	bool shutdown_emitted;
 
 	// Shutdown timeout.
 	guint timeout_id;
+	guint idle_timeout;	// Current idle timeout, in seconds.
+	gint64 idle_since;	// g_get_monotonic_time() when the service became idle
+	gint64 idle_gap_avg;	// Average gap between bursts, in microseconds.
+
+	// Worker thread pool.
+	// Requests are processed by the worker threads.
+	// Signals are emitted on the main context.
+	GThreadPool *thread_pool;
+
+	// Number of requests that haven't finished yet.
+	// NOTE: Only accessed on the main context.
+	guint pending_requests;
 
-	// Idle function for processing.
-	guint idle_process;
+	// Active requests, indexed by key (flavor + URI) and by handle.
+	// NOTE: Only accessed on the main context.
+	GHashTable *uri_requests;	// key: gchar*, value: struct request_info*
+	GHashTable *handle_requests;	// key: GUINT_TO_POINTER(handle), value: struct request_info*
 
 	// Last handle value.
 	guint32 last_handle;
 
-	// Request queue.
-	GQueue request_queue;	// element is struct request_info*
+	// Statistics.
+	// NOTE: Only accessed on the main context, except for in_progress.
+	volatile gint in_progress;	// Set using g_atomic_int_*().
+	guint64 completed;
+	guint64 failed;
+	guint64 cache_hits;
+	GHashTable *mime_stats;	// key: gchar*, value: struct mime_stats*
 
 	/** Properties. **/
 
@@ -131,6 +210,16 @@ struct _RpThumbnailer {
 	// rp_create_thumbnail() function pointer.
 	PFN_RP_CREATE_THUMBNAIL pfn_rp_create_thumbnail;
 
+	// rp_create_thumbnail2() function pointer. (supports cancellation; may be NULL)
+	PFN_RP_CREATE_THUMBNAIL2 pfn_rp_create_thumbnail2;
+
+	// Number of worker threads. (0 == number of CPU cores)
+	guint num_threads;
+
+	// Time budget for each thumbnail, in milliseconds. (0 == no limit)
+	// Requires rp_create_thumbnail2().
+	guint timeout_ms;
+
 	// Is the D-Bus object exported?
 	bool exported;
 };
@@ -200,6 +289,20 @@ rp_thumbnailer_class_init(RpThumbnailerClass *klass, gpointer class_data)
 		"pfn-rp-create-thumbnail", "pfn-rp-create-thumbnail", "rp_create_thumbnail() function pointer.",
 		G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT_ONLY);
 
+	klass->properties[PROP_PFN_RP_CREATE_THUMBNAIL2] = g_param_spec_pointer(
+		"pfn-rp-create-thumbnail2", "pfn-rp-create-thumbnail2", "rp_create_thumbnail2() function pointer.",
+		G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT_ONLY);
+
+	klass->properties[PROP_NUM_THREADS] = g_param_spec_uint(
+		"num-threads", "num-threads", "Number of worker threads. (0 == number of CPU cores)",
+		0, 256, 0,
+		G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT_ONLY);
+
+	klass->properties[PROP_TIMEOUT_MS] = g_param_spec_uint(
+		"timeout-ms", "timeout-ms", "Time budget for each thumbnail, in milliseconds. (0 == no limit)",
+		0, G_MAXUINT, 0,
+		G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT_ONLY);
+
 	klass->properties[PROP_EXPORTED] = g_param_spec_boolean(
 		"exported", "exported", "Is the D-Bus object exported?",
 		false,
@@ -221,9 +324,13 @@ static void
 rp_thumbnailer_init(RpThumbnailer *thumbnailer, gpointer g_class)
 {
 	// g_object_new() guarantees that all values are initialized to 0.
-	// Nothing to do here.
-	RP_UNUSED(thumbnailer);
 	RP_UNUSED(g_class);
+
+	// NOTE: The request_info structs are owned by the thread pool
+	// and rp_thumbnailer_process_finished(), not the hash tables.
+	thumbnailer->uri_requests = g_hash_table_new(g_str_hash, g_str_equal);
+	thumbnailer->handle_requests = g_hash_table_new(g_direct_hash, g_direct_equal);
+	thumbnailer->mime_stats = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
 }
 
 static void
@@ -233,6 +340,31 @@ rp_thumbnailer_constructed(GObject *object)
 	RpThumbnailer *const thumbnailer = RP_THUMBNAILER(object);
 
 	GError *error = NULL;
+
+	// Create the worker thread pool.
+	guint num_threads = thumbnailer->num_threads;
+	if (num_threads == 0) {
+#if GLIB_CHECK_VERSION(2,36,0)
+		num_threads = g_get_num_processors();
+#else /* !GLIB_CHECK_VERSION(2,36,0) */
+		const long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = (nprocs > 0 ? (guint)nprocs : 1);
+#endif /* GLIB_CHECK_VERSION(2,36,0) */
+	}
+	thumbnailer->thread_pool = g_thread_pool_new(rp_thumbnailer_process, thumbnailer,
+		(gint)num_threads, false, &error);
+	if (error) {
+		g_critical("Error creating the RpThumbnailer thread pool: %s", error->message);
+		g_error_free(error);
+		thumbnailer->exported = false;
+		return;
+	}
+	g_debug("Using %u worker thread(s).", num_threads);
+
+	// Foreground ('urgent') requests are processed before background requests.
+	g_thread_pool_set_sort_function(thumbnailer->thread_pool, rp_thumbnailer_request_compare, NULL);
+
+	// Export the D-Bus object.
 	thumbnailer->skeleton = org_freedesktop_thumbnails_specialized_thumbnailer1_skeleton_new();
 	g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(thumbnailer->skeleton),
 		thumbnailer->connection, "/com/gerbilsoft/rom_properties/SpecializedThumbnailer1", &error);
@@ -248,10 +380,22 @@ rp_thumbnailer_constructed(GObject *object)
 		G_CALLBACK(rp_thumbnailer_queue), thumbnailer);
 	g_signal_connect(thumbnailer->skeleton, "handle-dequeue",
 		G_CALLBACK(rp_thumbnailer_dequeue), thumbnailer);
-		
+
+	// Export the statistics interface on the same object.
+	// This isn't required for thumbnailing, so errors aren't fatal.
+	thumbnailer->stats_skeleton = rp_thumbnailer_statistics1_skeleton_new();
+	g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(thumbnailer->stats_skeleton),
+		thumbnailer->connection, "/com/gerbilsoft/rom_properties/SpecializedThumbnailer1", &error);
+	if (error) {
+		g_warning("Error exporting RpThumbnailer statistics on session bus: %s", error->message);
+		g_clear_error(&error);
+	} else {
+		g_signal_connect(thumbnailer->stats_skeleton, "handle-get-statistics",
+			G_CALLBACK(rp_thumbnailer_get_statistics), thumbnailer);
+	}
+
 	// Make sure we shut down after inactivity.
-	thumbnailer->timeout_id = g_timeout_add_seconds(SHUTDOWN_TIMEOUT_SECONDS,
-		(GSourceFunc)rp_thumbnailer_timeout, thumbnailer);
+	rp_thumbnailer_start_timeout(thumbnailer);
 
 	// Object is exported.
 	thumbnailer->exported = true;
@@ -270,10 +414,12 @@ rp_thumbnailer_dispose(GObject *object)
 		thumbnailer->timeout_id = 0;
 	}
 
-	// Unregister idle_process.
-	if (G_UNLIKELY(thumbnailer->idle_process != 0)) {
-		g_source_remove(thumbnailer->idle_process);
-		thumbnailer->idle_process = 0;
+	// Shut down the thread pool.
+	// NOTE: Each request holds a reference to the RpThumbnailer,
+	// so there shouldn't be any requests remaining at this point.
+	if (thumbnailer->thread_pool) {
+		g_thread_pool_free(thumbnailer->thread_pool, false, true);
+		thumbnailer->thread_pool = NULL;
 	}
 
 	// No longer exported.
@@ -291,16 +437,13 @@ rp_thumbnailer_finalize(GObject *object)
 	if (thumbnailer->skeleton) {
 		g_object_unref(thumbnailer->skeleton);
 	}
-
-	// Delete any remaining requests and free the queue.
-	for (GList *p = thumbnailer->request_queue.head; p != NULL; p = p->next) {
-		if (p->data) {
-			struct request_info *const req = (struct request_info*)p->data;
-			g_free(req->uri);
-			g_free(req);
-		}
+	if (thumbnailer->stats_skeleton) {
+		g_object_unref(thumbnailer->stats_skeleton);
 	}
-	g_queue_clear(&thumbnailer->request_queue);
+
+	g_hash_table_destroy(thumbnailer->uri_requests);
+	g_hash_table_destroy(thumbnailer->handle_requests);
+	g_hash_table_destroy(thumbnailer->mime_stats);
 
 	/** Properties. **/
 	g_free(thumbnailer->cache_dir);
@@ -333,6 +476,15 @@ rp_thumbnailer_get_property(GObject *object,
 		case PROP_PFN_RP_CREATE_THUMBNAIL:
 			g_value_set_pointer(value, (gpointer)thumbnailer->pfn_rp_create_thumbnail);
 			break;
+		case PROP_PFN_RP_CREATE_THUMBNAIL2:
+			g_value_set_pointer(value, (gpointer)thumbnailer->pfn_rp_create_thumbnail2);
+			break;
+		case PROP_NUM_THREADS:
+			g_value_set_uint(value, thumbnailer->num_threads);
+			break;
+		case PROP_TIMEOUT_MS:
+			g_value_set_uint(value, thumbnailer->timeout_ms);
+			break;
 		case PROP_EXPORTED:
 			g_value_set_boolean(value, thumbnailer->exported);
 			break;
@@ -380,6 +532,19 @@ rp_thumbnailer_set_property(GObject *object,
 				(PFN_RP_CREATE_THUMBNAIL)g_value_get_pointer(value);
 			break;
 
+		case PROP_PFN_RP_CREATE_THUMBNAIL2:
+			thumbnailer->pfn_rp_create_thumbnail2 =
+				(PFN_RP_CREATE_THUMBNAIL2)g_value_get_pointer(value);
+			break;
+
+		case PROP_NUM_THREADS:
+			thumbnailer->num_threads = g_value_get_uint(value);
+			break;
+
+		case PROP_TIMEOUT_MS:
+			thumbnailer->timeout_ms = g_value_get_uint(value);
+			break;
+
 		case PROP_EXPORTED:
 			// FIXME: Read-only property.
 			// Need to show some error message...
@@ -409,7 +574,6 @@ rp_thumbnailer_queue(OrgFreedesktopThumbnailsSpecializedThumbnailer1 *skeleton,
 	const char *flavor, bool urgent,
 	RpThumbnailer *thumbnailer)
 {
-	RP_UNUSED(mime_type);
 	g_dbus_async_return_val_if_fail(IS_RP_THUMBNAILER(thumbnailer), invocation, false);
 	g_dbus_async_return_val_if_fail(uri != NULL, invocation, false);
 
@@ -426,6 +590,15 @@ rp_thumbnailer_queue(OrgFreedesktopThumbnailsSpecializedThumbnailer1 *skeleton,
 		g_source_remove(thumbnailer->timeout_id);
 		thumbnailer->timeout_id = 0;
 	}
+	if (thumbnailer->pending_requests == 0 && thumbnailer->idle_since != 0) {
+		// A new burst of requests is starting.
+		// Update the average gap between bursts.
+		const gint64 gap = g_get_monotonic_time() - thumbnailer->idle_since;
+		thumbnailer->idle_gap_avg = (thumbnailer->idle_gap_avg != 0
+			? (thumbnailer->idle_gap_avg * 3 + gap) / 4
+			: gap);
+		thumbnailer->idle_since = 0;
+	}
 
 	// Queue the URI for processing.
 	guint32 handle = ++thumbnailer->last_handle;
@@ -435,21 +608,38 @@ rp_thumbnailer_queue(OrgFreedesktopThumbnailsSpecializedThumbnailer1 *skeleton,
 		handle = ++thumbnailer->last_handle;
 	}
 
-	// Add the URI to the queue.
 	// NOTE: Currently handling all flavors that aren't "large" as "normal".
-	struct request_info *const req = g_malloc(sizeof(struct request_info));
+	const bool large = flavor && (g_ascii_strcasecmp(flavor, "large") == 0);
+	gchar *const key = g_strconcat(large ? "large:" : "normal:", uri, NULL);
+
+	// If this URI is already queued or being processed,
+	// add the handle to the existing request.
+	struct request_info *req = (struct request_info*)g_hash_table_lookup(thumbnailer->uri_requests, key);
+	if (req) {
+		g_free(key);
+		thumbnailer->cache_hits++;
+		g_array_append_val(req->handles, handle);
+		g_hash_table_insert(thumbnailer->handle_requests, GUINT_TO_POINTER(handle), req);
+		org_freedesktop_thumbnails_specialized_thumbnailer1_complete_queue(skeleton, invocation, handle);
+		return true;
+	}
+
+	// Add the URI to the thread pool's queue.
+	req = g_malloc0(sizeof(struct request_info));
+	req->thumbnailer = g_object_ref(thumbnailer);
 	req->uri = g_strdup(uri);
+	req->mime_type = g_strdup(mime_type ? mime_type : "");
+	req->key = key;
+	req->queue_time = g_get_monotonic_time();
 	req->handle = handle;
-	req->large = flavor && (g_ascii_strcasecmp(flavor, "large") == 0);
+	req->large = large;
 	req->urgent = urgent;
-	// TODO Put 'urgent' requests at the front of the queue?
-	g_queue_push_tail(&thumbnailer->request_queue, req);
-
-	// Make sure the idle process is started.
-	// TODO: Make it multi-threaded? (needs atomic compare and/or mutex...)
-	if (thumbnailer->idle_process == 0) {
-		thumbnailer->idle_process = g_idle_add((GSourceFunc)rp_thumbnailer_process, thumbnailer);
-	}
+	req->handles = g_array_sized_new(false, false, sizeof(guint32), 1);
+	g_array_append_val(req->handles, handle);
+	g_hash_table_insert(thumbnailer->uri_requests, req->key, req);
+	g_hash_table_insert(thumbnailer->handle_requests, GUINT_TO_POINTER(handle), req);
+	thumbnailer->pending_requests++;
+	g_thread_pool_push(thumbnailer->thread_pool, req, NULL);
 
 	org_freedesktop_thumbnails_specialized_thumbnailer1_complete_queue(skeleton, invocation, handle);
 	return true;
@@ -472,11 +662,59 @@ rp_thumbnailer_dequeue(OrgFreedesktopThumbnailsSpecializedThumbnailer1 *skeleton
 	g_dbus_async_return_val_if_fail(IS_RP_THUMBNAILER(thumbnailer), invocation, false);
 	g_dbus_async_return_val_if_fail(handle != 0, invocation, false);
 
-	// TODO
+	struct request_info *const req = (struct request_info*)g_hash_table_lookup(
+		thumbnailer->handle_requests, GUINT_TO_POINTER(handle));
+	if (req) {
+		// Remove the handle from the request.
+		// No signals will be emitted for this handle.
+		g_hash_table_remove(thumbnailer->handle_requests, GUINT_TO_POINTER(handle));
+		for (guint i = 0; i < req->handles->len; i++) {
+			if (g_array_index(req->handles, guint32, i) == handle) {
+				g_array_remove_index(req->handles, i);
+				break;
+			}
+		}
+
+		if (req->handles->len == 0) {
+			// Nothing is waiting for this request anymore.
+			// If it's still queued, the worker thread will skip it.
+			// If it's being processed, rp_create_thumbnail2() will
+			// stop at the next I/O phase.
+			g_atomic_int_set(&req->cancelled, 1);
+			if (g_hash_table_lookup(thumbnailer->uri_requests, req->key) == req) {
+				g_hash_table_remove(thumbnailer->uri_requests, req->key);
+			}
+		}
+	}
+
 	org_freedesktop_thumbnails_specialized_thumbnailer1_complete_dequeue(skeleton, invocation);
 	return true;
 }
 
+/**
+ * Start the inactivity timeout.
+ * The timeout is twice the average gap between bursts of requests,
+ * clamped to [SHUTDOWN_TIMEOUT_SECONDS, SHUTDOWN_TIMEOUT_MAX_SECONDS].
+ * @param thumbnailer RpThumbnailer object.
+ */
+static void
+rp_thumbnailer_start_timeout(RpThumbnailer *thumbnailer)
+{
+	g_return_if_fail(thumbnailer->timeout_id == 0);
+
+	gint64 timeout = (thumbnailer->idle_gap_avg * 2) / G_USEC_PER_SEC;
+	if (timeout < SHUTDOWN_TIMEOUT_SECONDS) {
+		timeout = SHUTDOWN_TIMEOUT_SECONDS;
+	} else if (timeout > SHUTDOWN_TIMEOUT_MAX_SECONDS) {
+		timeout = SHUTDOWN_TIMEOUT_MAX_SECONDS;
+	}
+
+	thumbnailer->idle_timeout = (guint)timeout;
+	thumbnailer->idle_since = g_get_monotonic_time();
+	thumbnailer->timeout_id = g_timeout_add_seconds(thumbnailer->idle_timeout,
+		(GSourceFunc)rp_thumbnailer_timeout, thumbnailer);
+}
+
 /**
  * Inactivity timeout has elapsed.
  * @param thumbnailer RpThumbnailer object.
@@ -485,7 +723,7 @@ static gboolean
 rp_thumbnailer_timeout(RpThumbnailer *thumbnailer)
 {
 	g_return_val_if_fail(IS_RP_THUMBNAILER(thumbnailer), false);
-	if (!g_queue_is_empty(&thumbnailer->request_queue)) {
+	if (thumbnailer->pending_requests != 0) {
 		// Still processing stuff.
 		return true;
 	}
@@ -495,47 +733,48 @@ rp_thumbnailer_timeout(RpThumbnailer *thumbnailer)
 	thumbnailer->timeout_id = 0;
 	thumbnailer->shutdown_emitted = true;
 	g_signal_emit(thumbnailer, klass->signal_ids[SIGNAL_SHUTDOWN], 0);
-	g_debug("Shutting down due to %u seconds of inactivity.", SHUTDOWN_TIMEOUT_SECONDS);
+	g_debug("Shutting down due to %u seconds of inactivity.", thumbnailer->idle_timeout);
 	return false;
 }
 
 /**
  * Process a thumbnail.
- * @param thumbnailer RpThumbnailer object.
+ * This function runs in a worker thread.
+ * The result is signalled on the main context by rp_thumbnailer_process_finished().
+ * @param data struct request_info*
+ * @param user_data RpThumbnailer object.
  */
-static gboolean
-rp_thumbnailer_process(RpThumbnailer *thumbnailer)
+static void
+rp_thumbnailer_process(gpointer data, gpointer user_data)
 {
-	g_return_val_if_fail(IS_RP_THUMBNAILER(thumbnailer), FALSE);
+	struct request_info *const req = (struct request_info*)data;
+	RpThumbnailer *const thumbnailer = (RpThumbnailer*)user_data;
 
-	const gchar *md5_string;	// owned by md5 object
-	const struct request_info *req;	// request info from the map
-	gchar *cache_filename = NULL;	// cache filename (g_strdup_printf())
+	gchar *md5_string = NULL;	// MD5 of the URI (g_compute_checksum_for_data())
+	gchar *cache_filename = NULL;	// cache filename (g_malloc())
 	size_t cache_filename_sz;	// size of cache_filename
 	int pos, pos2;			// snprintf() position
 	int ret;
 
-	// Process one thumbnail.
-	req = (struct request_info*)g_queue_pop_head(&thumbnailer->request_queue);
-	if (req == NULL) {
-		// Nothing in the queue.
-		goto cleanup;
+	if (g_atomic_int_get(&req->cancelled)) {
+		// Request was dequeued before it was started.
+		goto finished;
 	}
+	req->started = true;
+	g_atomic_int_inc(&thumbnailer->in_progress);
 
 	// NOTE: cache_dir and pfn_rp_create_thumbnail should NOT be NULL
 	// at this point, but we're checking it anyway.
 	if (!thumbnailer->cache_dir || thumbnailer->cache_dir[0] == 0) {
 		// No cache directory...
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, "",
-			0, "Thumbnail cache directory is empty.");
+		req->err_msg = "Thumbnail cache directory is empty.";
+		req->err_no_uri = true;
 		goto finished;
 	}
 	if (!thumbnailer->pfn_rp_create_thumbnail) {
 		// No thumbnailer function.
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, "",
-			0, "No thumbnailer function is available.");
+		req->err_msg = "No thumbnailer function is available.";
+		req->err_no_uri = true;
 		goto finished;
 	}
 
@@ -556,16 +795,14 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	// pos does NOT include the NULL terminator, so check >=.
 	if (pos < 0 || ((size_t)pos + 1 + 32 + 4) > cache_filename_sz) {
 		// Not enough memory.
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot snprintf() the thumbnail cache directory name.");
+		req->err_msg = "Cannot snprintf() the thumbnail cache directory name.";
 		goto finished;
 	}
 
+	// NOTE: g_mkdir_with_parents() is safe to call from
+	// multiple threads with the same directory.
 	if (g_mkdir_with_parents(cache_filename, 0777) != 0) {
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot mkdir() the thumbnail cache directory.");
+		req->err_msg = "Cannot mkdir() the thumbnail cache directory.";
 		goto finished;
 	}
 
@@ -573,9 +810,7 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	md5_string = g_compute_checksum_for_data(G_CHECKSUM_MD5, (const guchar*)req->uri, strlen(req->uri));
 	if (!md5_string) {
 		// Cannot compute the checksum...
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "g_compute_checksum_for_data() failed.");
+		req->err_msg = "g_compute_checksum_for_data() failed.";
 		goto finished;
 	}
 
@@ -584,54 +819,237 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	// pos and pos2 do NOT include the NULL terminator, so check >=.
 	if (pos2 < 0 || ((size_t)pos + (size_t)pos2) >= cache_filename_sz) {
 		// Not enough memory.
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot snprintf() the thumbnail filename.");
+		req->err_msg = "Cannot snprintf() the thumbnail filename.";
 		goto finished;
 	}
 
 	// Thumbnail the image.
-	ret = thumbnailer->pfn_rp_create_thumbnail(req->uri, cache_filename, req->large ? 256 : 128);
+	if (thumbnailer->pfn_rp_create_thumbnail2) {
+		ret = thumbnailer->pfn_rp_create_thumbnail2(req->uri, cache_filename,
+			req->large ? 256 : 128, &req->cancelled, thumbnailer->timeout_ms);
+	} else {
+		ret = thumbnailer->pfn_rp_create_thumbnail(req->uri, cache_filename, req->large ? 256 : 128);
+	}
 	if (ret == 0) {
 		// Image thumbnailed successfully.
 		g_debug("rom-properties thumbnail: %s -> %s [OK]", req->uri, cache_filename);
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_ready(
-			thumbnailer->skeleton, req->handle, req->uri);
+	} else if (ret == RP_CREATE_THUMBNAIL_TIMED_OUT) {
+		// Time budget exceeded.
+		// The client can retry later, e.g. at a lower priority.
+		g_debug("rom-properties thumbnail: %s -> %s [TIMED OUT]", req->uri, cache_filename);
+		req->err_code = 2;
+		req->err_msg = "Image thumbnailing timed out.";
 	} else {
 		// Error thumbnailing the image...
 		g_debug("rom-properties thumbnail: %s -> %s [ERR=%d]", req->uri, cache_filename, ret);
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			2, "Image thumbnailing failed... (TODO: return code)");
+		req->err_code = 2;
+		req->err_msg = "Image thumbnailing failed... (TODO: return code)";
 	}
 
 finished:
-	// Request is finished. Emit the finished signal.
-	org_freedesktop_thumbnails_specialized_thumbnailer1_emit_finished(
-		thumbnailer->skeleton, req->handle);
-
-cleanup:
 	// Free allocated things.
+	g_free(md5_string);
 	g_free(cache_filename);
 
-	// req was allocated using g_malloc() before it was
-	// added to the queue. We'll need to free it here.
-	g_free((gpointer)req);
+	// Emit the signals on the main context.
+	g_idle_add(rp_thumbnailer_process_finished, req);
+}
+
+/**
+ * Update the statistics for a finished request.
+ * This function runs on the main context.
+ * @param thumbnailer RpThumbnailer object.
+ * @param req Finished request.
+ */
+static void
+rp_thumbnailer_update_statistics(RpThumbnailer *thumbnailer, const struct request_info *req)
+{
+	if (g_atomic_int_get(&req->cancelled)) {
+		// Cancelled requests aren't counted.
+		return;
+	}
 
-	// Return TRUE if we still have more thumbnails queued.
-	const bool isEmpty = g_queue_is_empty(&thumbnailer->request_queue);
-	if (isEmpty) {
-		// Clear the idle process.
-		// FIXME: Atomic compare and/or mutex? (assuming multi-threaded...)
-		thumbnailer->idle_process = 0;
+	struct mime_stats *stats = (struct mime_stats*)g_hash_table_lookup(thumbnailer->mime_stats, req->mime_type);
+	if (!stats) {
+		stats = g_malloc0(sizeof(struct mime_stats));
+		g_hash_table_insert(thumbnailer->mime_stats, g_strdup(req->mime_type), stats);
+	}
+
+	if (!req->err_msg) {
+		thumbnailer->completed++;
+		stats->completed++;
+	} else {
+		thumbnailer->failed++;
+		stats->failed++;
+	}
+
+	gint64 latency = g_get_monotonic_time() - req->queue_time;
+	if (latency < 0) {
+		latency = 0;
+	} else if (latency > G_MAXUINT32) {
+		latency = G_MAXUINT32;
+	}
+	stats->total_us += (guint64)latency;
+	stats->samples[stats->sample_pos] = (guint32)latency;
+	stats->sample_pos = (stats->sample_pos + 1) % LATENCY_SAMPLES;
+	if (stats->sample_count < LATENCY_SAMPLES) {
+		stats->sample_count++;
+	}
+}
+
+/**
+ * A thumbnail request has been processed.
+ * This function runs on the main context.
+ * @param data struct request_info*
+ * @return False to remove the idle source.
+ */
+static gboolean
+rp_thumbnailer_process_finished(gpointer data)
+{
+	struct request_info *const req = (struct request_info*)data;
+	RpThumbnailer *const thumbnailer = req->thumbnailer;
+
+	if (req->started) {
+		g_atomic_int_dec_and_test(&thumbnailer->in_progress);
+	}
+	rp_thumbnailer_update_statistics(thumbnailer, req);
+
+	// Emit signals for all handles that are still waiting for this request.
+	// NOTE: If the request was cancelled, there won't be any handles.
+	for (guint i = 0; i < req->handles->len; i++) {
+		const guint32 handle = g_array_index(req->handles, guint32, i);
+		if (!req->err_msg) {
+			// Image thumbnailed successfully.
+			org_freedesktop_thumbnails_specialized_thumbnailer1_emit_ready(
+				thumbnailer->skeleton, handle, req->uri);
+		} else {
+			org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
+				thumbnailer->skeleton, handle, (req->err_no_uri ? "" : req->uri),
+				req->err_code, req->err_msg);
+		}
+
+		// Request is finished. Emit the finished signal.
+		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_finished(
+			thumbnailer->skeleton, handle);
+		g_hash_table_remove(thumbnailer->handle_requests, GUINT_TO_POINTER(handle));
+	}
+	if (g_hash_table_lookup(thumbnailer->uri_requests, req->key) == req) {
+		g_hash_table_remove(thumbnailer->uri_requests, req->key);
+	}
 
+	g_assert(thumbnailer->pending_requests > 0);
+	thumbnailer->pending_requests--;
+	if (thumbnailer->pending_requests == 0) {
 		// Restart the inactivity timeout.
 		if (G_LIKELY(thumbnailer->timeout_id == 0)) {
-			thumbnailer->timeout_id = g_timeout_add_seconds(SHUTDOWN_TIMEOUT_SECONDS,
-				(GSourceFunc)rp_thumbnailer_timeout, thumbnailer);
+			rp_thumbnailer_start_timeout(thumbnailer);
 		}
 	}
-	return !isEmpty;
+
+	// req was allocated using g_malloc0() before it was
+	// pushed to the thread pool. We'll need to free it here.
+	g_array_free(req->handles, true);
+	g_free(req->key);
+	g_free(req->mime_type);
+	g_free(req->uri);
+	g_free(req);
+	g_object_unref(thumbnailer);
+	return false;
+}
+
+/**
+ * Compare two latency samples for qsort().
+ * @param a guint32*
+ * @param b guint32*
+ * @return Comparison result.
+ */
+static int
+rp_thumbnailer_latency_compare(const void *a, const void *b)
+{
+	const guint32 la = *(const guint32*)a;
+	const guint32 lb = *(const guint32*)b;
+	return (la < lb ? -1 : (la > lb ? 1 : 0));
+}
+
+/**
+ * Get the thumbnailer statistics.
+ * @param skeleton	[in] GDBusObjectSkeleton
+ * @param invocation	[in/out] GDBusMethodInvocation
+ * @param thumbnailer	[in] RpThumbnailer object.
+ * @return True if the signal was handled; false if not.
+ */
+static gboolean
+rp_thumbnailer_get_statistics(RpThumbnailerStatistics1 *skeleton,
+	GDBusMethodInvocation *invocation,
+	RpThumbnailer *thumbnailer)
+{
+	g_dbus_async_return_val_if_fail(IS_RP_THUMBNAILER(thumbnailer), invocation, false);
+
+	GVariantBuilder builder;
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("a{s(ttdd)}"));
+
+	GHashTableIter iter;
+	gpointer key, value;
+	g_hash_table_iter_init(&iter, thumbnailer->mime_stats);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		const struct mime_stats *const stats = (const struct mime_stats*)value;
+		const guint64 total = stats->completed + stats->failed;
+		const double mean_ms = (total != 0 ? (double)stats->total_us / (double)total / 1000.0 : 0.0);
+
+		// p95 latency, using the nearest-rank method on the recent samples.
+		double p95_ms = 0.0;
+		if (stats->sample_count != 0) {
+			guint32 samples[LATENCY_SAMPLES];
+			memcpy(samples, stats->samples, stats->sample_count * sizeof(samples[0]));
+			qsort(samples, stats->sample_count, sizeof(samples[0]), rp_thumbnailer_latency_compare);
+			const guint idx = ((stats->sample_count * 95) + 99) / 100 - 1;
+			p95_ms = (double)samples[idx] / 1000.0;
+		}
+
+		g_variant_builder_add(&builder, "{s(ttdd)}", (const gchar*)key,
+			stats->completed, stats->failed, mean_ms, p95_ms);
+	}
+
+	// NOTE: The request count includes requests that were
+	// dequeued but haven't been skipped by a worker yet.
+	const guint in_progress = (guint)g_atomic_int_get(&thumbnailer->in_progress);
+	const guint queued = (thumbnailer->pending_requests > in_progress
+		? thumbnailer->pending_requests - in_progress
+		: 0);
+
+	rp_thumbnailer_statistics1_complete_get_statistics(skeleton, invocation,
+		queued, in_progress,
+		thumbnailer->completed, thumbnailer->failed, thumbnailer->cache_hits,
+		thumbnailer->idle_timeout,
+		g_variant_builder_end(&builder));
+	return true;
+}
+
+/**
+ * Compare two requests for the thread pool's queue.
+ * Foreground ('urgent') requests are processed first.
+ * Requests in the same lane are processed in FIFO order.
+ * @param a struct request_info*
+ * @param b struct request_info*
+ * @param user_data Unused.
+ * @return Negative if a should be processed first; positive if b should be processed first.
+ */
+static gint
+rp_thumbnailer_request_compare(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	RP_UNUSED(user_data);
+	const struct request_info *const req_a = (const struct request_info*)a;
+	const struct request_info *const req_b = (const struct request_info*)b;
+
+	if (req_a->urgent != req_b->urgent) {
+		return (req_a->urgent ? -1 : 1);
+	}
+	// NOTE: Handles are assigned in increasing order.
+	// Handle wraparound is ignored here.
+	if (req_a->handle != req_b->handle) {
+		return (req_a->handle < req_b->handle ? -1 : 1);
+	}
+	return 0;
 }
 
 /**
@@ -639,17 +1057,26 @@ cleanup:
  * @param connection			[in] GDBusConnection
  * @param cache_dir			[in] Cache directory.
  * @param pfn_rp_create_thumbnail	[in] rp_create_thumbnail() function pointer.
+ * @param pfn_rp_create_thumbnail2	[in] rp_create_thumbnail2() function pointer. (may be NULL)
+ * @param num_threads			[in] Number of worker threads. (0 == number of CPU cores)
+ * @param timeout_ms			[in] Time budget for each thumbnail, in milliseconds. (0 == no limit)
  * @return RpThumbnailer object.
  */
 RpThumbnailer*
 rp_thumbnailer_new(GDBusConnection *connection,
 	const gchar *cache_dir,
-	PFN_RP_CREATE_THUMBNAIL pfn_rp_create_thumbnail)
+	PFN_RP_CREATE_THUMBNAIL pfn_rp_create_thumbnail,
+	PFN_RP_CREATE_THUMBNAIL2 pfn_rp_create_thumbnail2,
+	guint num_threads,
+	guint timeout_ms)
 {
 	return g_object_new(TYPE_RP_THUMBNAILER,
 		"connection", connection,
 		"cache-dir", cache_dir,
 		"pfn-rp-create-thumbnail", pfn_rp_create_thumbnail,
+		"pfn-rp-create-thumbnail2", pfn_rp_create_thumbnail2,
+		"num-threads", num_threads,
+		"timeout-ms", timeout_ms,
 		NULL);
 }
 
@@ -23,6 +23,23 @@ G_BEGIN_DECLS
  */
 typedef int (*PFN_RP_CREATE_THUMBNAIL)(const char *source_file, const char *output_file, int maximum_size);
 
+/**
+ * rp_create_thumbnail2() function pointer.
+ * Same as rp_create_thumbnail(), but the request can be cancelled
+ * or limited to a time budget.
+ * @param source_file Source file. (UTF-8)
+ * @param output_file Output file. (UTF-8)
+ * @param maximum_size Maximum size.
+ * @param pCancel Cancellation flag. (may be NULL)
+ * @param timeout_ms Time budget, in milliseconds. (0 for no limit)
+ * @return 0 on success; non-zero on error.
+ */
+typedef int (*PFN_RP_CREATE_THUMBNAIL2)(const char *source_file, const char *output_file, int maximum_size, const volatile int *pCancel, unsigned int timeout_ms);
+
+// rp_create_thumbnail2() return value if the time budget was exceeded.
+// (Same as RPCT_TIMED_OUT in libromdata.)
+#define RP_CREATE_THUMBNAIL_TIMED_OUT 11
+
 typedef struct _RpThumbnailerClass	RpThumbnailerClass;
 typedef struct _RpThumbnailer		RpThumbnailer;
 
@@ -37,7 +54,10 @@ GType		rp_thumbnailer_get_type			(void) G_GNUC_CONST G_GNUC_INTERNAL;
 
 RpThumbnailer	*rp_thumbnailer_new			(GDBusConnection *connection,
 							 const gchar *cache_dir,
-							 PFN_RP_CREATE_THUMBNAIL pfn_rp_create_thumbnail)
+							 PFN_RP_CREATE_THUMBNAIL pfn_rp_create_thumbnail,
+							 PFN_RP_CREATE_THUMBNAIL2 pfn_rp_create_thumbnail2,
+							 guint num_threads,
+							 guint timeout_ms)
 							G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
 
 gboolean	rp_thumbnailer_is_exported		(RpThumbnailer *thumbnailer);
@@ -31,6 +31,21 @@ static bool stop_main_loop = false;
 // Cache directory.
 static string cache_dir;
 
+// Number of worker threads. (0 == number of CPU cores)
+static gint num_threads = 0;
+
+// Time budget for each thumbnail, in milliseconds. (0 == no limit)
+static gint timeout_ms = 0;
+
+// Command line options.
+static const GOptionEntry option_entries[] = {
+	{"threads", 'j', 0, G_OPTION_ARG_INT, &num_threads,
+	 "Number of worker threads (default: number of CPU cores)", "N"},
+	{"timeout", 't', 0, G_OPTION_ARG_INT, &timeout_ms,
+	 "Time budget for each thumbnail, in milliseconds (default: no limit)", "MS"},
+	{nullptr, 0, 0, G_OPTION_ARG_NONE, nullptr, nullptr, nullptr}
+};
+
 /**
  * Initialize the cache directory.
  * @return 0 on success; non-zero on error.
@@ -115,14 +130,29 @@ on_dbus_name_lost(GDBusConnection *connection, const gchar *name, gpointer user_
 
 int main(int argc, char *argv[])
 {
-	RP_UNUSED(argc);
-	RP_UNUSED(argv);
-
 	if (getuid() == 0 || geteuid() == 0) {
 		fprintf(stderr, "*** %s does not support running as root.", argv[0]);
 		return EXIT_FAILURE;
 	}
 
+	// Parse the command line options.
+	GError *error = nullptr;
+	GOptionContext *const context = g_option_context_new("- rom-properties D-Bus thumbnailer");
+	g_option_context_add_main_entries(context, option_entries, nullptr);
+	if (!g_option_context_parse(context, &argc, &argv, &error)) {
+		fprintf(stderr, "%s\n", error->message);
+		g_error_free(error);
+		g_option_context_free(context);
+		return EXIT_FAILURE;
+	}
+	g_option_context_free(context);
+	if (num_threads < 0) {
+		num_threads = 0;
+	}
+	if (timeout_ms < 0) {
+		timeout_ms = 0;
+	}
+
 	// Enable security options.
 	rpt_do_security_options();
 
@@ -152,7 +182,6 @@ int main(int argc, char *argv[])
 		return EXIT_FAILURE;
 	}
 
-	GError *error = nullptr;
 	GDBusConnection *const connection = g_bus_get_sync(G_BUS_TYPE_SESSION, nullptr, &error);
 	if (error) {
 		g_critical("Unable to connect to the session bus: %s", error->message);
@@ -163,9 +192,16 @@ int main(int argc, char *argv[])
 
 	GMainLoop *main_loop = g_main_loop_new(nullptr, false);
 
+	// rp_create_thumbnail2() supports cancellation.
+	// It might not be available in older plugins.
+	PFN_RP_CREATE_THUMBNAIL2 pfn_rp_create_thumbnail2 =
+		(PFN_RP_CREATE_THUMBNAIL2)dlsym(pDll, "rp_create_thumbnail2");
+
 	// Create the RpThumbnail service object.
 	RpThumbnailer *const thumbnailer = rp_thumbnailer_new(
-		connection, cache_dir.c_str(), pfn_rp_create_thumbnail);
+		connection, cache_dir.c_str(), pfn_rp_create_thumbnail,
+		pfn_rp_create_thumbnail2, static_cast<guint>(num_threads),
+		static_cast<guint>(timeout_ms));
 
 	// Register the D-Bus service.
 	g_bus_own_name_on_connection(connection,
@@ -32,13 +32,8 @@ int rpt_do_security_options(void)
 		// TODO: Add more syscalls.
 		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
 		// defined in earlier versions, including Ubuntu 14.04.
-
-		// NOTE: Special case for clone(). If it's the first syscall
-		// in the list, it has a parameter restriction added that
-		// ensures it can only be used to create threads.
-		SCMP_SYS(clone),
-		// Other multi-threading syscalls
-		SCMP_SYS(set_robust_list),
+		// NOTE: Multi-threading syscalls (GLib worker threads) are
+		// added by RP_SECURE_PROFILE_PARALLEL.
 
 		SCMP_SYS(access),	// LibUnixCommon::isWritableDirectory()
 		SCMP_SYS(close),
@@ -54,6 +49,7 @@ int rpt_do_security_options(void)
 		SCMP_SYS(getuid),	// TODO: Only use geteuid()?
 		SCMP_SYS(lseek), SCMP_SYS(_llseek),
 		SCMP_SYS(lstat), SCMP_SYS(lstat64),	// LibRpBase::FileSystem::is_symlink(), resolve_symlink()
+		SCMP_SYS(madvise),	// LibRpFile::RpFile::adviseAccess() [FM_MMAP]
 		SCMP_SYS(mkdir),	// g_mkdir_with_parents() [rp_thumbnailer_process()]
 		SCMP_SYS(mmap),		// iconv_open(), dlopen()
 		SCMP_SYS(mmap2),	// iconv_open(), dlopen() [might only be needed on i386...]
@@ -66,10 +62,22 @@ int rpt_do_security_options(void)
 #elif defined(__NR_openat2)
 		__NR_openat2,		// Linux 5.6
 #endif /* __SNR_openat2 || __NR_openat2 */
+		SCMP_SYS(fadvise64), SCMP_SYS(fadvise64_64),	// LibRpFile::RpFile::adviseAccess()
+		SCMP_SYS(pread64), SCMP_SYS(preadv),	// LibRpFile::RpFile::readAt(), readBatch()
 		SCMP_SYS(readlink),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
 		SCMP_SYS(stat), SCMP_SYS(stat64),	// LibUnixCommon::isWritableDirectory()
 		SCMP_SYS(statfs), SCMP_SYS(statfs64),	// LibRpBase::FileSystem::isOnBadFS()
+		SCMP_SYS(rename), SCMP_SYS(renameat),	// NegativeDetectCache: rewriteCache()
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),	// glibc-2.28+ on architectures without renameat()
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(unlink),	// NegativeDetectCache: rewriteCache() [on error]
+		SCMP_SYS(flock),	// CachePack::append(), compact()
+		SCMP_SYS(pwrite64),	// CachePack::append()
 
+#if defined(__SNR_io_uring_setup) || defined(__NR_io_uring_setup)
+		SCMP_SYS(io_uring_setup), SCMP_SYS(io_uring_enter),	// LibRpFile::IoUring
+#endif /* __SNR_io_uring_setup || __NR_io_uring_setup */
 #if defined(__SNR_statx) || defined(__NR_statx)
 		SCMP_SYS(getcwd),	// called by glibc's statx()
 		SCMP_SYS(statx),
@@ -118,6 +126,6 @@ int rpt_do_security_options(void)
 #else
 	param.dummy = 0;
 #endif
-	return rp_secure_enable(param);
+	return rp_secure_enable_ex(param, RP_SECURE_PROFILE_PARALLEL);
 #endif
 }
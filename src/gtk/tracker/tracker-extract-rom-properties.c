@@ -0,0 +1,384 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (tracker-extract module)           *
+ * tracker-extract-rom-properties.c: tracker-extract module.               *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+/**
+ * This module lets tracker-extract (GNOME Tracker / LocalSearch) index
+ * metadata from files supported by rom-properties.
+ *
+ * tracker-extract loads the module once and extracts many files in
+ * the same process, so the rom-properties library is only loaded once.
+ * Only the metadata is loaded; fields and images aren't decoded.
+ *
+ * References:
+ * - https://gitlab.gnome.org/GNOME/tracker-miners/-/tree/master/src/tracker-extract
+ */
+
+#include "common.h"
+#include "libunixcommon/dll-search.h"
+
+#include <gio/gio.h>
+#include <gmodule.h>
+#include <libtracker-extract/tracker-extract.h>
+
+// C includes.
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// dlopen()
+#include <dlfcn.h>
+
+G_MODULE_EXPORT gboolean tracker_extract_module_init	(GError **error);
+G_MODULE_EXPORT void	 tracker_extract_module_shutdown(void);
+G_MODULE_EXPORT gboolean tracker_extract_get_metadata	(TrackerExtractInfo *info, GError **error);
+
+/**
+ * rp_extract_metadata() callback function.
+ * @param user_data User data specified when calling rp_extract_metadata().
+ * @param prop_name Property name, e.g. "Title".
+ * @param prop_type Property type. (RP_PROP_TYPE_*)
+ * @param str_value String value. (RP_PROP_TYPE_STRING only; otherwise NULL)
+ * @param int_value Integer value. (all types except RP_PROP_TYPE_STRING)
+ */
+typedef void (*PFN_RP_METADATA_CALLBACK)(void *user_data,
+	const char *prop_name, int prop_type, const char *str_value, int64_t int_value);
+
+/**
+ * rp_extract_metadata() function pointer.
+ * @param source_file	[in] Source file. (UTF-8, local files only)
+ * @param pfnCallback	[in] Callback function for each metadata property.
+ * @param user_data	[in] User data for the callback function.
+ * @param p_file_type	[out,opt] RomData::FileType of the source file.
+ * @return 0 on success; non-zero on error.
+ */
+typedef int (*PFN_RP_EXTRACT_METADATA)(const char *source_file,
+	PFN_RP_METADATA_CALLBACK pfnCallback, void *user_data, int *p_file_type);
+
+// Property types. (Same as PropertyType in librpbase.)
+#define RP_PROP_TYPE_INTEGER		1
+#define RP_PROP_TYPE_UNSIGNED_INTEGER	2
+#define RP_PROP_TYPE_STRING		3
+#define RP_PROP_TYPE_TIMESTAMP		4
+
+// File types. (Same as RomData::FileType in librpbase.)
+#define RP_FILE_TYPE_TEXTURE_FILE	18
+#define RP_FILE_TYPE_AUDIO_FILE		22
+
+// rom-properties library.
+static void *pDll = NULL;
+static PFN_RP_EXTRACT_METADATA pfn_rp_extract_metadata = NULL;
+
+/**
+ * How a metadata property is stored in the TrackerResource.
+ */
+typedef enum {
+	RP_TRACKER_VALUE,	// Literal value
+	RP_TRACKER_DURATION,	// Duration, in milliseconds (stored in seconds)
+	RP_TRACKER_DATE,	// UNIX timestamp (stored as xsd:dateTime)
+	RP_TRACKER_CONTACT,	// nco:Contact
+	RP_TRACKER_ARTIST,	// nmm:Artist
+} RpTrackerKind;
+
+/**
+ * Which resource types a predicate is valid for.
+ */
+typedef enum {
+	RP_DOMAIN_ANY,		// nie:InformationElement
+	RP_DOMAIN_AUDIO,	// nfo:Audio, nmm:MusicPiece
+	RP_DOMAIN_IMAGE,	// nfo:Image
+} RpTrackerDomain;
+
+/**
+ * RomMetaData property to Nepomuk predicate mapping.
+ */
+typedef struct _RpTrackerProp {
+	const char *prop_name;		// RomMetaData property name
+	const char *predicate;		// Nepomuk predicate
+	uint8_t kind;			// RpTrackerKind
+	uint8_t domain;			// RpTrackerDomain
+} RpTrackerProp;
+
+static const RpTrackerProp prop_map[] = {
+	// Document
+	{"Title",	"nie:title",		RP_TRACKER_VALUE,	RP_DOMAIN_ANY},
+	{"Subject",	"nie:subject",		RP_TRACKER_VALUE,	RP_DOMAIN_ANY},
+	{"Comment",	"nie:comment",		RP_TRACKER_VALUE,	RP_DOMAIN_ANY},
+	{"Copyright",	"nie:copyright",	RP_TRACKER_VALUE,	RP_DOMAIN_ANY},
+	{"Author",	"nco:creator",		RP_TRACKER_CONTACT,	RP_DOMAIN_ANY},
+	{"Publisher",	"nco:publisher",	RP_TRACKER_CONTACT,	RP_DOMAIN_ANY},
+	{"CreationDate", "nie:contentCreated",	RP_TRACKER_DATE,	RP_DOMAIN_ANY},
+
+	// Audio
+	{"Genre",	"nfo:genre",		RP_TRACKER_VALUE,	RP_DOMAIN_AUDIO},
+	{"Duration",	"nfo:duration",		RP_TRACKER_DURATION,	RP_DOMAIN_AUDIO},
+	{"Channels",	"nfo:channels",		RP_TRACKER_VALUE,	RP_DOMAIN_AUDIO},
+	{"SampleRate",	"nfo:sampleRate",	RP_TRACKER_VALUE,	RP_DOMAIN_AUDIO},
+	{"TrackNumber",	"nmm:trackNumber",	RP_TRACKER_VALUE,	RP_DOMAIN_AUDIO},
+	{"Artist",	"nmm:artist",		RP_TRACKER_ARTIST,	RP_DOMAIN_AUDIO},
+	{"Composer",	"nmm:composer",		RP_TRACKER_ARTIST,	RP_DOMAIN_AUDIO},
+
+	// Image
+	{"Width",	"nfo:width",		RP_TRACKER_VALUE,	RP_DOMAIN_IMAGE},
+	{"Height",	"nfo:height",		RP_TRACKER_VALUE,	RP_DOMAIN_IMAGE},
+};
+
+/**
+ * Extraction state for a single file.
+ */
+typedef struct _RpTrackerExtract {
+	TrackerResource *resource;
+	int file_type;
+} RpTrackerExtract;
+
+/**
+ * Debug print function for rp_dll_search().
+ * @param level Debug level.
+ * @param format Format string.
+ * @param ... Format arguments.
+ * @return vfprintf() return value.
+ */
+static int ATTR_PRINTF(2, 3)
+fnDebug(int level, const char *format, ...)
+{
+	// g_warning() may be using g_log_structured(),
+	// and there's no variant of g_log_structured()
+	// that takes va_list, so we'll print it to a
+	// buffer first.
+	char buf[512];
+
+	va_list args;
+	va_start(args, format);
+	int ret = vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+
+	if (level < LEVEL_ERROR) {
+		g_debug("%s", buf);
+	} else {
+		g_warning("%s", buf);
+	}
+	return ret;
+}
+
+/**
+ * Create the TrackerResource for a file.
+ * The resource's types are based on the RomData file type.
+ * @param file_type RomData::FileType
+ * @return TrackerResource
+ */
+static TrackerResource*
+rp_tracker_resource_new(int file_type)
+{
+	TrackerResource *const resource = tracker_resource_new(NULL);
+	switch (file_type) {
+		case RP_FILE_TYPE_AUDIO_FILE:
+			tracker_resource_add_uri(resource, "rdf:type", "nfo:Audio");
+			tracker_resource_add_uri(resource, "rdf:type", "nmm:MusicPiece");
+			break;
+		case RP_FILE_TYPE_TEXTURE_FILE:
+			tracker_resource_add_uri(resource, "rdf:type", "nfo:Image");
+			break;
+		default:
+			tracker_resource_add_uri(resource, "rdf:type", "nfo:SoftwareApplication");
+			break;
+	}
+	return resource;
+}
+
+/**
+ * rp_extract_metadata() callback.
+ * Adds a metadata property to the TrackerResource.
+ * @param user_data RpTrackerExtract
+ * @param prop_name Property name
+ * @param prop_type Property type
+ * @param str_value String value
+ * @param int_value Integer value
+ */
+static void
+rp_tracker_add_property(void *user_data, const char *prop_name, int prop_type,
+			const char *str_value, int64_t int_value)
+{
+	RpTrackerExtract *const extract = (RpTrackerExtract*)user_data;
+
+	const RpTrackerProp *prop = NULL;
+	for (size_t i = 0; i < G_N_ELEMENTS(prop_map); i++) {
+		if (!strcmp(prop_map[i].prop_name, prop_name)) {
+			prop = &prop_map[i];
+			break;
+		}
+	}
+	if (!prop) {
+		// Property isn't mapped to Nepomuk.
+		return;
+	}
+
+	// Make sure the predicate is valid for this resource type.
+	switch (prop->domain) {
+		case RP_DOMAIN_AUDIO:
+			if (extract->file_type != RP_FILE_TYPE_AUDIO_FILE)
+				return;
+			break;
+		case RP_DOMAIN_IMAGE:
+			if (extract->file_type != RP_FILE_TYPE_TEXTURE_FILE)
+				return;
+			break;
+		default:
+			break;
+	}
+
+	// NOTE: file_type is set before the first callback.
+	if (!extract->resource) {
+		extract->resource = rp_tracker_resource_new(extract->file_type);
+	}
+
+	if (prop_type == RP_PROP_TYPE_STRING) {
+		if (!str_value || str_value[0] == '\0')
+			return;
+
+		switch (prop->kind) {
+			case RP_TRACKER_CONTACT: {
+				TrackerResource *const contact = tracker_extract_new_contact(str_value);
+				tracker_resource_set_relation(extract->resource, prop->predicate, contact);
+				g_object_unref(contact);
+				break;
+			}
+			case RP_TRACKER_ARTIST: {
+				TrackerResource *const artist = tracker_extract_new_artist(str_value);
+				tracker_resource_set_relation(extract->resource, prop->predicate, artist);
+				g_object_unref(artist);
+				break;
+			}
+			default:
+				tracker_resource_set_string(extract->resource, prop->predicate, str_value);
+				break;
+		}
+		return;
+	}
+
+	switch (prop->kind) {
+		case RP_TRACKER_DURATION:
+			// Duration needs to be converted from ms to seconds.
+			tracker_resource_set_int(extract->resource, prop->predicate, (int)(int_value / 1000));
+			break;
+
+		case RP_TRACKER_DATE: {
+			if (prop_type != RP_PROP_TYPE_TIMESTAMP || int_value == -1)
+				break;
+			GDateTime *const dateTime = g_date_time_new_from_unix_utc(int_value);
+			if (!dateTime)
+				break;
+			gchar *const str = g_date_time_format(dateTime, "%Y-%m-%dT%H:%M:%SZ");
+			if (str) {
+				tracker_resource_set_string(extract->resource, prop->predicate, str);
+				g_free(str);
+			}
+			g_date_time_unref(dateTime);
+			break;
+		}
+
+		case RP_TRACKER_VALUE:
+			tracker_resource_set_int64(extract->resource, prop->predicate, int_value);
+			break;
+
+		default:
+			// Contacts and artists must be strings.
+			break;
+	}
+}
+
+/** Module entry points **/
+
+/**
+ * Initialize the module.
+ * This is called once per tracker-extract process.
+ * @param error GError
+ * @return TRUE on success; FALSE on error.
+ */
+gboolean
+tracker_extract_module_init(GError **error)
+{
+	if (pDll) {
+		// Already initialized.
+		return TRUE;
+	}
+
+	// Attempt to open a ROM Properties Page library.
+	int ret = rp_dll_search("rp_extract_metadata", &pDll, (void**)&pfn_rp_extract_metadata, fnDebug);
+	if (ret != 0) {
+		pDll = NULL;
+		pfn_rp_extract_metadata = NULL;
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+			"Unable to load a ROM Properties Page library. (error %d)", ret);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Shut down the module.
+ */
+void
+tracker_extract_module_shutdown(void)
+{
+	if (pDll) {
+		dlclose(pDll);
+		pDll = NULL;
+		pfn_rp_extract_metadata = NULL;
+	}
+}
+
+/**
+ * Extract metadata from a file.
+ * @param info TrackerExtractInfo
+ * @param error GError
+ * @return TRUE on success; FALSE on error.
+ */
+gboolean
+tracker_extract_get_metadata(TrackerExtractInfo *info, GError **error)
+{
+	if (!pfn_rp_extract_metadata) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_INITIALIZED,
+			"The ROM Properties Page library is not loaded.");
+		return FALSE;
+	}
+
+	// Only local files are supported.
+	GFile *const file = tracker_extract_info_get_file(info);
+	gchar *const filename = g_file_get_path(file);
+	if (!filename) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+			"Only local files are supported.");
+		return FALSE;
+	}
+
+	RpTrackerExtract extract;
+	extract.resource = NULL;
+	extract.file_type = 0;
+	const int ret = pfn_rp_extract_metadata(filename, rp_tracker_add_property, &extract, &extract.file_type);
+	if (ret != 0) {
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+			"Unable to extract metadata from '%s'. (error %d)", filename, ret);
+		g_free(filename);
+		if (extract.resource) {
+			g_object_unref(extract.resource);
+		}
+		return FALSE;
+	}
+	g_free(filename);
+
+	if (!extract.resource) {
+		// The file is supported, but it doesn't have any
+		// metadata that can be indexed.
+		extract.resource = rp_tracker_resource_new(extract.file_type);
+	}
+
+	tracker_extract_info_set_resource(info, extract.resource);
+	g_object_unref(extract.resource);
+	return TRUE;
+}
@@ -0,0 +1,298 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (tumbler plugin)                   *
+ * rp-tumbler-thumbnailer.c: Tumbler thumbnailer.                          *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+/**
+ * References:
+ * - https://gitlab.xfce.org/xfce/tumbler/-/tree/master/plugins/pixbuf-thumbnailer
+ */
+
+#include "rp-tumbler-thumbnailer.h"
+#include "common.h"
+
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+// C includes.
+#include <stdbool.h>
+#include <unistd.h>
+
+// rp_create_thumbnail2() return values.
+// (Same as the RPCT_* values in libromdata.)
+#define RPCT_SOURCE_FILE_NOT_SUPPORTED	3
+#define RPCT_SOURCE_FILE_NO_IMAGE	4
+#define RPCT_OUTPUT_FILE_FAILED		5
+#define RPCT_SOURCE_FILE_CLASS_DISABLED	6
+#define RPCT_SOURCE_FILE_BAD_FS		7
+#define RPCT_CANCELLED			10
+
+/* Property identifiers. */
+enum RpTumblerThumbnailerProperties {
+	PROP_0,
+
+	PROP_PFN_RP_CREATE_THUMBNAIL2,
+
+	PROP_LAST
+};
+
+// Internal functions.
+static void	rp_tumbler_thumbnailer_get_property	(GObject	*object,
+							 guint		 prop_id,
+							 GValue		*value,
+							 GParamSpec	*pspec);
+static void	rp_tumbler_thumbnailer_set_property	(GObject	*object,
+							 guint		 prop_id,
+							 const GValue	*value,
+							 GParamSpec	*pspec);
+
+static void	rp_tumbler_thumbnailer_create		(TumblerAbstractThumbnailer *thumbnailer,
+							 GCancellable	*cancellable,
+							 TumblerFileInfo *info);
+
+struct _RpTumblerThumbnailerClass {
+	TumblerAbstractThumbnailerClass __parent__;
+
+	GParamSpec *properties[PROP_LAST];
+};
+
+struct _RpTumblerThumbnailer {
+	TumblerAbstractThumbnailer __parent__;
+
+	// rp_create_thumbnail2() function pointer.
+	PFN_RP_CREATE_THUMBNAIL2 pfn_rp_create_thumbnail2;
+};
+
+// NOTE: The type is registered with tumbler's GTypeModule,
+// since the plugin can be unloaded.
+G_DEFINE_DYNAMIC_TYPE(RpTumblerThumbnailer, rp_tumbler_thumbnailer, TUMBLER_TYPE_ABSTRACT_THUMBNAILER);
+
+/**
+ * Register the RpTumblerThumbnailer type.
+ * @param plugin TumblerProviderPlugin
+ */
+void
+rp_tumbler_thumbnailer_register(TumblerProviderPlugin *plugin)
+{
+	rp_tumbler_thumbnailer_register_type(G_TYPE_MODULE(plugin));
+}
+
+static void
+rp_tumbler_thumbnailer_class_init(RpTumblerThumbnailerClass *klass)
+{
+	GObjectClass *const gobject_class = G_OBJECT_CLASS(klass);
+	gobject_class->get_property = rp_tumbler_thumbnailer_get_property;
+	gobject_class->set_property = rp_tumbler_thumbnailer_set_property;
+
+	TumblerAbstractThumbnailerClass *const abstract_thumbnailer_class = TUMBLER_ABSTRACT_THUMBNAILER_CLASS(klass);
+	abstract_thumbnailer_class->create = rp_tumbler_thumbnailer_create;
+
+	/** Properties **/
+
+	klass->properties[PROP_PFN_RP_CREATE_THUMBNAIL2] = g_param_spec_pointer(
+		"pfn-rp-create-thumbnail2", "pfn-rp-create-thumbnail2", "rp_create_thumbnail2() function pointer.",
+		(GParamFlags)(G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	// Install the properties.
+	g_object_class_install_properties(gobject_class, PROP_LAST, klass->properties);
+}
+
+static void
+rp_tumbler_thumbnailer_class_finalize(RpTumblerThumbnailerClass *klass)
+{
+	RP_UNUSED(klass);
+}
+
+static void
+rp_tumbler_thumbnailer_init(RpTumblerThumbnailer *thumbnailer)
+{
+	RP_UNUSED(thumbnailer);
+}
+
+static void
+rp_tumbler_thumbnailer_get_property(GObject *object,
+				    guint prop_id,
+				    GValue *value,
+				    GParamSpec *pspec)
+{
+	RpTumblerThumbnailer *const thumbnailer = RP_TUMBLER_THUMBNAILER(object);
+
+	switch (prop_id) {
+		case PROP_PFN_RP_CREATE_THUMBNAIL2:
+			g_value_set_pointer(value, (gpointer)thumbnailer->pfn_rp_create_thumbnail2);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+rp_tumbler_thumbnailer_set_property(GObject *object,
+				    guint prop_id,
+				    const GValue *value,
+				    GParamSpec *pspec)
+{
+	RpTumblerThumbnailer *const thumbnailer = RP_TUMBLER_THUMBNAILER(object);
+
+	switch (prop_id) {
+		case PROP_PFN_RP_CREATE_THUMBNAIL2:
+			thumbnailer->pfn_rp_create_thumbnail2 =
+				(PFN_RP_CREATE_THUMBNAIL2)g_value_get_pointer(value);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+/**
+ * Emit the "error" signal.
+ * @param thumbnailer TumblerAbstractThumbnailer
+ * @param info TumblerFileInfo
+ * @param code TumblerErrorEnum
+ * @param message Error message
+ */
+static void
+rp_tumbler_thumbnailer_emit_error(TumblerAbstractThumbnailer *thumbnailer,
+				  TumblerFileInfo *info,
+				  gint code,
+				  const gchar *message)
+{
+#if TUMBLER_CHECK_VERSION(4,17,1)
+	// tumbler-4.17.1 changed the "error" signal to take
+	// a TumblerFileInfo and an error domain.
+	g_signal_emit_by_name(thumbnailer, "error", info, TUMBLER_ERROR, code, message);
+#else /* !TUMBLER_CHECK_VERSION(4,17,1) */
+	g_signal_emit_by_name(thumbnailer, "error", tumbler_file_info_get_uri(info), code, message);
+#endif /* TUMBLER_CHECK_VERSION(4,17,1) */
+}
+
+/**
+ * GCancellable "cancelled" callback.
+ * @param cancellable GCancellable
+ * @param user_data Cancellation flag for rp_create_thumbnail2(). (volatile gint*)
+ */
+static void
+rp_tumbler_thumbnailer_cancelled(GCancellable *cancellable, gpointer user_data)
+{
+	RP_UNUSED(cancellable);
+	g_atomic_int_set((volatile gint*)user_data, 1);
+}
+
+/**
+ * Create a thumbnail.
+ * This function runs in one of tumbler's worker threads.
+ * @param thumbnailer TumblerAbstractThumbnailer
+ * @param cancellable GCancellable
+ * @param info TumblerFileInfo
+ */
+static void
+rp_tumbler_thumbnailer_create(TumblerAbstractThumbnailer *thumbnailer,
+			      GCancellable *cancellable,
+			      TumblerFileInfo *info)
+{
+	g_return_if_fail(RP_IS_TUMBLER_THUMBNAILER(thumbnailer));
+	g_return_if_fail(TUMBLER_IS_FILE_INFO(info));
+
+	RpTumblerThumbnailer *const rp_thumbnailer = RP_TUMBLER_THUMBNAILER(thumbnailer);
+	const gchar *const uri = tumbler_file_info_get_uri(info);
+	if (g_cancellable_is_cancelled(cancellable))
+		return;
+
+	// Get the thumbnail size.
+	TumblerThumbnail *const thumbnail = tumbler_file_info_get_thumbnail(info);
+	g_assert(thumbnail != NULL);
+	TumblerThumbnailFlavor *const flavor = tumbler_thumbnail_get_flavor(thumbnail);
+	gint width = 0, height = 0;
+	tumbler_thumbnail_flavor_get_size(flavor, &width, &height);
+	g_object_unref(flavor);
+
+	// rp_create_thumbnail2() writes a PNG image to a file,
+	// so write it to a temporary file, then have tumbler
+	// save it to its thumbnail cache.
+	gchar *tmp_filename = NULL;
+	GError *error = NULL;
+	const gint fd = g_file_open_tmp("rp-tumbler-XXXXXX.png", &tmp_filename, &error);
+	if (fd < 0) {
+		rp_tumbler_thumbnailer_emit_error(thumbnailer, info, TUMBLER_ERROR_FAILED, error->message);
+		g_error_free(error);
+		g_object_unref(thumbnail);
+		return;
+	}
+	close(fd);
+
+	// Thumbnail the image.
+	volatile gint cancelled = 0;
+	gulong cancel_id = 0;
+	if (cancellable) {
+		// NOTE: If the GCancellable is already cancelled,
+		// the callback is called immediately.
+		cancel_id = g_cancellable_connect(cancellable,
+			G_CALLBACK(rp_tumbler_thumbnailer_cancelled), (gpointer)&cancelled, NULL);
+	}
+	const int ret = rp_thumbnailer->pfn_rp_create_thumbnail2(uri, tmp_filename,
+		MAX(width, height), &cancelled, 0);
+	if (cancellable) {
+		g_cancellable_disconnect(cancellable, cancel_id);
+	}
+
+	switch (ret) {
+		case 0: {
+			// Image thumbnailed successfully.
+			// Save it to tumbler's thumbnail cache.
+			GFile *const tmp_file = g_file_new_for_path(tmp_filename);
+			const bool saved = tumbler_thumbnail_save_file(thumbnail, tmp_file,
+				tumbler_file_info_get_mtime(info), cancellable, &error);
+			g_object_unref(tmp_file);
+			if (saved) {
+				g_debug("rom-properties thumbnail: %s [OK]", uri);
+				g_signal_emit_by_name(thumbnailer, "ready", uri);
+			} else {
+				rp_tumbler_thumbnailer_emit_error(thumbnailer, info, TUMBLER_ERROR_SAVE_FAILED, error->message);
+				g_error_free(error);
+			}
+			break;
+		}
+
+		case RPCT_CANCELLED:
+			// Request was cancelled. Tumbler doesn't expect a signal here.
+			g_debug("rom-properties thumbnail: %s [CANCELLED]", uri);
+			break;
+
+		case RPCT_SOURCE_FILE_NOT_SUPPORTED:
+			g_debug("rom-properties thumbnail: %s [ERR=%d]", uri, ret);
+			rp_tumbler_thumbnailer_emit_error(thumbnailer, info,
+				TUMBLER_ERROR_UNSUPPORTED, "File is not supported by rom-properties.");
+			break;
+
+		case RPCT_SOURCE_FILE_NO_IMAGE:
+		case RPCT_SOURCE_FILE_CLASS_DISABLED:
+		case RPCT_SOURCE_FILE_BAD_FS:
+			g_debug("rom-properties thumbnail: %s [ERR=%d]", uri, ret);
+			rp_tumbler_thumbnailer_emit_error(thumbnailer, info,
+				TUMBLER_ERROR_NO_CONTENT, "File does not have a thumbnail image.");
+			break;
+
+		case RPCT_OUTPUT_FILE_FAILED:
+			g_debug("rom-properties thumbnail: %s [ERR=%d]", uri, ret);
+			rp_tumbler_thumbnailer_emit_error(thumbnailer, info,
+				TUMBLER_ERROR_SAVE_FAILED, "Unable to save the thumbnail image.");
+			break;
+
+		default:
+			g_debug("rom-properties thumbnail: %s [ERR=%d]", uri, ret);
+			rp_tumbler_thumbnailer_emit_error(thumbnailer, info,
+				TUMBLER_ERROR_FAILED, "Image thumbnailing failed.");
+			break;
+	}
+
+	g_unlink(tmp_filename);
+	g_free(tmp_filename);
+	g_object_unref(thumbnail);
+}
@@ -0,0 +1,43 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (tumbler plugin)                   *
+ * rp-tumbler-thumbnailer.h: Tumbler thumbnailer.                          *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_GTK_TUMBLER_RP_TUMBLER_THUMBNAILER_H__
+#define __ROMPROPERTIES_GTK_TUMBLER_RP_TUMBLER_THUMBNAILER_H__
+
+#include <glib-object.h>
+#include <tumbler/tumbler.h>
+
+G_BEGIN_DECLS
+
+/**
+ * rp_create_thumbnail2() function pointer.
+ * @param source_file Source file. (UTF-8)
+ * @param output_file Output file. (UTF-8)
+ * @param maximum_size Maximum size.
+ * @param pCancel Cancellation flag. (may be NULL)
+ * @param timeout_ms Time budget, in milliseconds. (0 for no limit)
+ * @return 0 on success; non-zero on error.
+ */
+typedef int (*PFN_RP_CREATE_THUMBNAIL2)(const char *source_file, const char *output_file, int maximum_size, const volatile int *pCancel, unsigned int timeout_ms);
+
+typedef struct _RpTumblerThumbnailerClass	RpTumblerThumbnailerClass;
+typedef struct _RpTumblerThumbnailer		RpTumblerThumbnailer;
+
+#define RP_TYPE_TUMBLER_THUMBNAILER		(rp_tumbler_thumbnailer_get_type())
+#define RP_TUMBLER_THUMBNAILER(obj)		(G_TYPE_CHECK_INSTANCE_CAST((obj), RP_TYPE_TUMBLER_THUMBNAILER, RpTumblerThumbnailer))
+#define RP_TUMBLER_THUMBNAILER_CLASS(klass)	(G_TYPE_CHECK_CLASS_CAST((klass),  RP_TYPE_TUMBLER_THUMBNAILER, RpTumblerThumbnailerClass))
+#define RP_IS_TUMBLER_THUMBNAILER(obj)		(G_TYPE_CHECK_INSTANCE_TYPE((obj), RP_TYPE_TUMBLER_THUMBNAILER))
+#define RP_IS_TUMBLER_THUMBNAILER_CLASS(klass)	(G_TYPE_CHECK_CLASS_TYPE((klass),  RP_TYPE_TUMBLER_THUMBNAILER))
+#define RP_TUMBLER_THUMBNAILER_GET_CLASS(obj)	(G_TYPE_INSTANCE_GET_CLASS((obj),  RP_TYPE_TUMBLER_THUMBNAILER, RpTumblerThumbnailerClass))
+
+GType	rp_tumbler_thumbnailer_get_type		(void) G_GNUC_CONST G_GNUC_INTERNAL;
+void	rp_tumbler_thumbnailer_register		(TumblerProviderPlugin *plugin) G_GNUC_INTERNAL;
+
+G_END_DECLS
+
+#endif /* __ROMPROPERTIES_GTK_TUMBLER_RP_TUMBLER_THUMBNAILER_H__ */
@@ -0,0 +1,214 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (tumbler plugin)                   *
+ * tumbler-rom-properties-plugin.c: Tumbler plugin entry points.           *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+/**
+ * This plugin lets tumblerd create thumbnails in-process using
+ * tumbler's own thread pool, instead of using the D-Bus thumbnailer.
+ *
+ * References:
+ * - https://gitlab.xfce.org/xfce/tumbler/-/tree/master/plugins/pixbuf-thumbnailer
+ */
+
+#include "config.tumbler.h"
+#include "rp-tumbler-thumbnailer.h"
+#include "common.h"
+#include "libunixcommon/dll-search.h"
+
+#include <gmodule.h>
+
+// C includes.
+#include <stdarg.h>
+#include <stdio.h>
+
+// dlopen()
+#include <dlfcn.h>
+
+G_MODULE_EXPORT void tumbler_plugin_initialize	(TumblerProviderPlugin *plugin);
+G_MODULE_EXPORT void tumbler_plugin_shutdown	(void);
+G_MODULE_EXPORT void tumbler_plugin_get_types	(const GType **types, gint *n_types);
+
+/** RpTumblerProvider **/
+
+typedef struct _RpTumblerProviderClass	RpTumblerProviderClass;
+typedef struct _RpTumblerProvider	RpTumblerProvider;
+
+#define RP_TYPE_TUMBLER_PROVIDER	(rp_tumbler_provider_get_type())
+
+struct _RpTumblerProviderClass {
+	GObjectClass __parent__;
+};
+
+struct _RpTumblerProvider {
+	GObject __parent__;
+};
+
+static GType	rp_tumbler_provider_get_type		(void) G_GNUC_CONST;
+static void	rp_tumbler_provider_iface_init		(TumblerThumbnailerProviderIface *iface);
+static GList	*rp_tumbler_provider_get_thumbnailers	(TumblerThumbnailerProvider *provider);
+
+G_DEFINE_DYNAMIC_TYPE_EXTENDED(RpTumblerProvider, rp_tumbler_provider, G_TYPE_OBJECT, 0,
+	G_IMPLEMENT_INTERFACE_DYNAMIC(TUMBLER_TYPE_THUMBNAILER_PROVIDER, rp_tumbler_provider_iface_init));
+
+// Registered types.
+static GType type_list[1];
+
+// rom-properties library.
+static void *pDll = NULL;
+static PFN_RP_CREATE_THUMBNAIL2 pfn_rp_create_thumbnail2 = NULL;
+
+static void
+rp_tumbler_provider_class_init(RpTumblerProviderClass *klass)
+{
+	RP_UNUSED(klass);
+}
+
+static void
+rp_tumbler_provider_class_finalize(RpTumblerProviderClass *klass)
+{
+	RP_UNUSED(klass);
+}
+
+static void
+rp_tumbler_provider_init(RpTumblerProvider *provider)
+{
+	RP_UNUSED(provider);
+}
+
+static void
+rp_tumbler_provider_iface_init(TumblerThumbnailerProviderIface *iface)
+{
+	iface->get_thumbnailers = rp_tumbler_provider_get_thumbnailers;
+}
+
+/**
+ * Debug print function for rp_dll_search().
+ * @param level Debug level.
+ * @param format Format string.
+ * @param ... Format arguments.
+ * @return vfprintf() return value.
+ */
+static int ATTR_PRINTF(2, 3)
+fnDebug(int level, const char *format, ...)
+{
+	// g_warning() may be using g_log_structured(),
+	// and there's no variant of g_log_structured()
+	// that takes va_list, so we'll print it to a
+	// buffer first.
+	char buf[512];
+
+	va_list args;
+	va_start(args, format);
+	int ret = vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+
+	if (level < LEVEL_ERROR) {
+		g_debug("%s", buf);
+	} else {
+		g_warning("%s", buf);
+	}
+	return ret;
+}
+
+/**
+ * Get the thumbnailers provided by this plugin.
+ * @param provider TumblerThumbnailerProvider
+ * @return List of thumbnailers.
+ */
+static GList*
+rp_tumbler_provider_get_thumbnailers(TumblerThumbnailerProvider *provider)
+{
+	RP_UNUSED(provider);
+
+	if (!pDll) {
+		// Attempt to open a ROM Properties Page library.
+		// NOTE: rp_create_thumbnail2() is required, since it
+		// supports cancellation.
+		int ret = rp_dll_search("rp_create_thumbnail2", &pDll, (void**)&pfn_rp_create_thumbnail2, fnDebug);
+		if (ret != 0) {
+			pDll = NULL;
+			pfn_rp_create_thumbnail2 = NULL;
+			return NULL;
+		}
+	}
+
+	// Only local files are supported.
+	// TODO: Add more URI schemes if TCreateThumbnail can handle them.
+	static const gchar *const uri_schemes[] = {"file", NULL};
+
+	// MIME types. (semicolon-separated list from mime.thumbnail.types)
+	gchar **const mime_types = g_strsplit(RP_TUMBLER_MIME_TYPES, ";", -1);
+
+	// Remove empty strings from the MIME type list.
+	gchar **src = mime_types, **dest = mime_types;
+	for (; *src != NULL; src++) {
+		if ((*src)[0] != '\0') {
+			*dest++ = *src;
+		} else {
+			g_free(*src);
+		}
+	}
+	*dest = NULL;
+
+	RpTumblerThumbnailer *const thumbnailer = g_object_new(RP_TYPE_TUMBLER_THUMBNAILER,
+		"uri-schemes", uri_schemes,
+		"mime-types", mime_types,
+		"pfn-rp-create-thumbnail2", pfn_rp_create_thumbnail2,
+		NULL);
+	g_strfreev(mime_types);
+
+	return g_list_append(NULL, thumbnailer);
+}
+
+/** Plugin entry points **/
+
+/**
+ * Initialize the plugin.
+ * @param plugin TumblerProviderPlugin
+ */
+void
+tumbler_plugin_initialize(TumblerProviderPlugin *plugin)
+{
+	const gchar *const mismatch = tumbler_check_version(
+		TUMBLER_MAJOR_VERSION, TUMBLER_MINOR_VERSION, TUMBLER_MICRO_VERSION);
+	if (G_UNLIKELY(mismatch != NULL)) {
+		g_warning("Version mismatch: %s", mismatch);
+		return;
+	}
+
+	// Register the types provided by this plugin.
+	rp_tumbler_thumbnailer_register(plugin);
+	rp_tumbler_provider_register_type(G_TYPE_MODULE(plugin));
+
+	// Set up the plugin provider type list.
+	type_list[0] = RP_TYPE_TUMBLER_PROVIDER;
+}
+
+/**
+ * Shut down the plugin.
+ */
+void
+tumbler_plugin_shutdown(void)
+{
+	if (pDll) {
+		dlclose(pDll);
+		pDll = NULL;
+		pfn_rp_create_thumbnail2 = NULL;
+	}
+}
+
+/**
+ * Get the types provided by this plugin.
+ * @param types		[out] Type list.
+ * @param n_types	[out] Number of types.
+ */
+void
+tumbler_plugin_get_types(const GType **types, gint *n_types)
+{
+	*types = type_list;
+	*n_types = G_N_ELEMENTS(type_list);
+}
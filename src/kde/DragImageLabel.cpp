@@ -137,29 +137,34 @@ void DragImageLabel::clearRp(void)
  * Automatically resizes the QImage if it's smaller
  * than the minimum size.
  * @param img QImage.
+ * @param frameCount Number of frames in the QImage, if it's a frame atlas.
  * @return QPixmap.
  */
-QPixmap DragImageLabel::imgToPixmap(const QImage &img) const
+QPixmap DragImageLabel::imgToPixmap(const QImage &img, int frameCount) const
 {
-	if (img.width() >= m_minimumImageSize.width() &&
-	    img.height() >= m_minimumImageSize.height())
+	assert(frameCount > 0);
+	const QSize frame_size(img.width() / frameCount, img.height());
+	if (frame_size.width() >= m_minimumImageSize.width() &&
+	    frame_size.height() >= m_minimumImageSize.height())
 	{
 		// No resize necessary.
 		return QPixmap::fromImage(img);
 	}
 
 	// Resize the image.
-	QSize img_size = img.size();
+	// NOTE: The size is calculated using a single frame.
+	QSize img_size = frame_size;
 	do {
 		// Increase by integer multiples until
 		// the icon is at least 32x32.
 		// TODO: Constrain to 32x32?
-		img_size.setWidth(img_size.width() + img.width());
-		img_size.setHeight(img_size.height() + img.height());
+		img_size.setWidth(img_size.width() + frame_size.width());
+		img_size.setHeight(img_size.height() + frame_size.height());
 	} while (img_size.width() < m_minimumImageSize.width() &&
 		 img_size.height() < m_minimumImageSize.height());
+	img_size.setWidth(img_size.width() * frameCount);
 
-	return QPixmap::fromImage(img.scaled(img_size, Qt::KeepAspectRatio, Qt::FastTransformation));
+	return QPixmap::fromImage(img.scaled(img_size, Qt::IgnoreAspectRatio, Qt::FastTransformation));
 }
 
 /**
@@ -171,14 +176,15 @@ bool DragImageLabel::updatePixmaps(void)
 	if (m_anim && m_anim->iconAnimData) {
 		const IconAnimData *const iconAnimData = m_anim->iconAnimData;
 
-		// Convert the icons to QPixmaps.
-		for (int i = iconAnimData->count-1; i >= 0; i--) {
-			const rp_image *const frame = iconAnimData->frames[i];
-			if (frame && frame->isValid()) {
-				// NOTE: Allowing NULL frames here...
-				m_anim->iconFrames[i] = imgToPixmap(rpToQImage(frame));
-			}
+		// Convert the frame atlas to a single QPixmap.
+		// Individual frames are copied from the atlas as needed.
+		const rp_image *const atlas = iconAnimData->atlas();
+		if (!atlas) {
+			// No valid frames.
+			return false;
 		}
+		m_anim->iconAtlas = imgToPixmap(rpToQImage(atlas), iconAnimData->count);
+		m_anim->frameWidth = m_anim->iconAtlas.width() / iconAnimData->count;
 
 		// Set up the IconAnimHelper.
 		m_anim->iconAnimHelper.setIconAnimData(iconAnimData);
@@ -195,7 +201,7 @@ bool DragImageLabel::updatePixmaps(void)
 		}
 
 		// Show the first frame.
-		this->setPixmap(m_anim->iconFrames[m_anim->iconAnimHelper.frameNumber()]);
+		this->setPixmap(m_anim->framePixmap(m_anim->iconAnimHelper.frameNumber()));
 		return true;
 	}
 
@@ -278,7 +284,7 @@ void DragImageLabel::tmrIconAnim_timeout(void)
 	if (frame != m_anim->last_frame_number) {
 		// New frame number.
 		// Update the icon.
-		this->setPixmap(m_anim->iconFrames[frame]);
+		this->setPixmap(m_anim->framePixmap(frame));
 		m_anim->last_frame_number = frame;
 	}
 
@@ -360,8 +366,8 @@ void DragImageLabel::mouseMoveEvent(QMouseEvent *event)
 	// Get the first frame and use it for the drag pixmap.
 	if (m_anim && m_anim->iconAnimHelper.isAnimated()) {
 		const int frame = m_anim->iconAnimData->seq_index[0];
-		if (!m_anim->iconFrames[frame].isNull()) {
-			drag->setPixmap(m_anim->iconFrames[frame]);
+		if (m_anim->iconAnimData->frame(frame) && !m_anim->iconAtlas.isNull()) {
+			drag->setPixmap(m_anim->framePixmap(frame));
 		}
 	} else {
 		// Not animated. Use the QLabel pixmap directly.
@@ -19,9 +19,6 @@ namespace LibRpTexture {
 #include "librpbase/img/IconAnimData.hpp"
 #include "librpbase/img/IconAnimHelper.hpp"
 
-// C++ includes.
-#include <array>
-
 // Qt includes.
 #include <QtCore/QTimer>
 #include <QLabel>
@@ -100,9 +97,10 @@ class DragImageLabel : public QLabel
 		 * Automatically resizes the QImage if it's smaller
 		 * than the minimum size.
 		 * @param img QImage.
+		 * @param frameCount Number of frames in the QImage, if it's a frame atlas.
 		 * @return QPixmap.
 		 */
-		QPixmap imgToPixmap(const QImage &img) const;
+		QPixmap imgToPixmap(const QImage &img, int frameCount = 1) const;
 
 		/**
 		 * Update the pixmap(s).
@@ -163,20 +161,32 @@ class DragImageLabel : public QLabel
 		struct anim_vars {
 			const LibRpBase::IconAnimData *iconAnimData;
 			QTimer *tmrIconAnim;
-			std::array<QPixmap, LibRpBase::IconAnimData::MAX_FRAMES> iconFrames;
+			QPixmap iconAtlas;		// Frame atlas. (See IconAnimData::atlas().)
 			LibRpBase::IconAnimHelper iconAnimHelper;
+			int frameWidth;			// Width of a single frame in iconAtlas.
 			int last_frame_number;		// Last frame number.
 			bool anim_running;		// Animation is running.
 
 			anim_vars()
 				: iconAnimData(nullptr)
 				, tmrIconAnim(nullptr)
+				, frameWidth(0)
 				, last_frame_number(0)
 				, anim_running(false) { }
 			~anim_vars() {
 				UNREF(iconAnimData);
 				delete tmrIconAnim;
 			}
+
+			/**
+			 * Get a frame from the frame atlas.
+			 * @param frame Frame number.
+			 * @return QPixmap.
+			 */
+			QPixmap framePixmap(int frame) const
+			{
+				return iconAtlas.copy(frame * frameWidth, 0, frameWidth, iconAtlas.height());
+			}
 		};
 		anim_vars *m_anim;
 };
@@ -69,8 +69,12 @@ class ListDataModelPrivate
 		// Icons.
 		// NOTE: References to rp_image* are kept in case
 		// the icon size is changed.
-		std::vector<QPixmap> icons;
-		std::vector<const rp_image*> icons_rp;
+		// QPixmaps are created on demand by getIconPixmap().
+		// rp_images are loaded on demand from pIconField,
+		// since the RomData subclass may defer loading them.
+		mutable std::vector<QPixmap> icons;
+		mutable std::vector<const rp_image*> icons_rp;
+		const RomFields::Field *pIconField;
 		QSize iconSize;
 
 		// Current language code.
@@ -83,9 +87,18 @@ class ListDataModelPrivate
 		void clearData(void);
 
 		/**
-		 * Update the icons pixmap vector.
+		 * Reset the icons pixmap vector.
+		 * The pixmaps will be recreated on demand.
 		 */
-		void updateIconPixmaps(void);
+		void resetIconPixmaps(void);
+
+		/**
+		 * Get an icon pixmap.
+		 * The pixmap is created the first time it's requested.
+		 * @param row Row index.
+		 * @return Icon pixmap. (may be null)
+		 */
+		const QPixmap &getIconPixmap(int row) const;
 
 		/**
 		 * Convert a single language from RFT_LISTDATA or RFT_LISTDATA_MULTI to vector<QString>.
@@ -135,6 +148,7 @@ ListDataModelPrivate::ListDataModelPrivate(ListDataModel *q)
 	, align_data(0)
 	, checkboxes(0)
 	, hasCheckboxes(false)
+	, pIconField(nullptr)
 	, iconSize(QSize(32, 32))
 	, lc('en')
 {
@@ -174,36 +188,57 @@ void ListDataModelPrivate::clearData(void)
 		}
 	);
 	icons_rp.clear();
+	pIconField = nullptr;
 }
 
 /**
- * Update the icons pixmap vector.
+ * Reset the icons pixmap vector.
+ * The pixmaps will be recreated on demand.
  */
-void ListDataModelPrivate::updateIconPixmaps(void)
+void ListDataModelPrivate::resetIconPixmaps(void)
 {
 	icons.clear();
-	icons.reserve(icons_rp.size());
-
-	const auto icons_rp_cend = icons_rp.cend();
-	for (auto iter = icons_rp.cbegin(); iter != icons_rp_cend; ++iter) {
-		const rp_image *const img = *iter;
-		if (!img) {
-			icons.emplace_back(QPixmap());
-			continue;
-		}
+	icons.resize(icons_rp.size());
+}
 
-		QPixmap pixmap = QPixmap::fromImage(rpToQImage(img));
+/**
+ * Get an icon pixmap.
+ * The pixmap is created the first time it's requested.
+ * @param row Row index.
+ * @return Icon pixmap. (may be null)
+ */
+const QPixmap &ListDataModelPrivate::getIconPixmap(int row) const
+{
+	QPixmap &pixmap = icons[row];
+	if (!pixmap.isNull()) {
+		// Pixmap was already created.
+		return pixmap;
+	}
 
-		// Do we need to resize the icon?
-		if (img->width() != iconSize.width() ||
-		    img->height() != iconSize.height())
-		{
-			// Resize is needed.
-			pixmap = pixmap.scaled(iconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+	const rp_image *img = icons_rp[row];
+	if (!img && pIconField) {
+		// Load the icon. This may decode a deferred icon.
+		img = RomFields::listDataIcon(*pIconField, static_cast<unsigned int>(row));
+		if (img) {
+			icons_rp[row] = img->ref();
 		}
+	}
+	if (!img) {
+		// No icon for this row.
+		return pixmap;
+	}
+
+	pixmap = QPixmap::fromImage(rpToQImage(img));
 
-		icons.emplace_back(pixmap);
+	// Do we need to resize the icon?
+	if (img->width() != iconSize.width() ||
+	    img->height() != iconSize.height())
+	{
+		// Resize is needed.
+		pixmap = pixmap.scaled(iconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
 	}
+
+	return pixmap;
 }
 
 /**
@@ -399,8 +434,8 @@ QVariant ListDataModel::data(const QModelIndex& index, int role) const
 		case Qt::DecorationRole:
 			if (column != 0 || d->icons.empty())
 				break;
-			if (row <= (int)d->icons.size())
-				return d->icons[row];
+			if (row < (int)d->icons.size())
+				return d->getIconPixmap(row);
 			break;
 
 		default:
@@ -612,14 +647,10 @@ void ListDataModel::setField(const RomFields::Field *pField)
 		// NOTE: Icons are the same for all languages.
 		// Also, we can assume all rows are present, since
 		// icons and checkboxes are mutually exclusive.
-		d->icons.reserve(rowCount);
-		const auto icons_cend = pField->data.list_data.mxd.icons->cend();
-		for (auto iter = pField->data.list_data.mxd.icons->cbegin(); iter != icons_cend; ++iter) {
-			const rp_image *const icon = *iter;
-			d->icons_rp.emplace_back(icon ? icon->ref() : nullptr);
-		}
-		// Update the icons pixmap vector.
-		d->updateIconPixmaps();
+		// rp_images and pixmaps are loaded on demand.
+		d->icons_rp.resize(pField->data.list_data.mxd.icons->size(), nullptr);
+		d->pIconField = pField;
+		d->resetIconPixmaps();
 	}
 
 	if (d->pData) {
@@ -712,7 +743,7 @@ void ListDataModel::setIconSize(const QSize &iconSize)
 
 	d->iconSize = iconSize;
 	if (!d->icons_rp.empty()) {
-		d->updateIconPixmaps();
+		d->resetIconPixmaps();
 		QModelIndex indexFirst = createIndex(0, 0);
 		QModelIndex indexLast = createIndex(d->rowCount-1, 0);
 		emit dataChanged(indexFirst, indexLast);
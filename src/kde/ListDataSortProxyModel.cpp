@@ -13,6 +13,9 @@
 #include "librpbase/RomFields.hpp"
 using LibRpBase::RomFields;
 
+// C++ STL classes.
+using std::vector;
+
 /**
  * Parse a QString as a number.
  * @param str		[in] QString
@@ -45,26 +48,68 @@ qlonglong ListDataSortProxyModel::parseQString(const QString &str, bool *pbAllNu
 	return str.mid(0, pos).toLongLong();
 }
 
+/**
+ * Get the sort keys for a column.
+ * Sort keys are computed the first time a column is sorted.
+ * @param column Column
+ * @return Sort keys, indexed by source row.
+ */
+const vector<ListDataSortProxyModel::SortKey> &ListDataSortProxyModel::sortKeys(int column) const
+{
+	if (column >= (int)m_sortKeys.size()) {
+		m_sortKeys.resize(column + 1);
+	}
+	vector<SortKey> &keys = m_sortKeys[column];
+
+	const QAbstractItemModel *const model = sourceModel();
+	if (!keys.empty() || !model) {
+		// Sort keys were already computed.
+		return keys;
+	}
+
+	const uint32_t method = (m_sortingMethods >> (column * RomFields::COLSORT_BITS)) & RomFields::COLSORT_MASK;
+	const int rowCount = model->rowCount();
+	keys.resize(rowCount);
+	for (int row = 0; row < rowCount; row++) {
+		SortKey &key = keys[row];
+		const QString str = model->index(row, column).data().toString();
+		switch (method) {
+			default:
+				key.str = str;
+				key.num = 0;
+				key.isAllNumeric = false;
+				break;
+			case RomFields::COLSORT_NOCASE:
+				key.str = str.toCaseFolded();
+				key.num = 0;
+				key.isAllNumeric = false;
+				break;
+			case RomFields::COLSORT_NUMERIC:
+				key.num = parseQString(str, &key.isAllNumeric);
+				key.str = str;
+				break;
+		}
+	}
+
+	return keys;
+}
+
 /**
  * Numeric comparison function.
- * @param strA
- * @param strB
- * @return True if strA < strB
+ * @param keyA
+ * @param keyB
+ * @return True if keyA < keyB
  */
-bool ListDataSortProxyModel::doNumericCompare(const QString &strA, const QString &strB)
+bool ListDataSortProxyModel::doNumericCompare(const SortKey &keyA, const SortKey &keyB)
 {
-	if (strA.isEmpty() && strB.isEmpty()) {
+	if (keyA.str.isEmpty() && keyB.str.isEmpty()) {
 		// Both strings are empty.
 		return false;
 	}
 
-	bool okA = false, okB = false;
-	qlonglong valA = parseQString(strA, &okA);
-	qlonglong valB = parseQString(strB, &okB);
-
-	if (valA == valB) {
+	if (keyA.num == keyB.num) {
 		// Values are identical.
-		if (okA && !okB) {
+		if (keyA.isAllNumeric && !keyB.isAllNumeric) {
 			// Second string is not fully numeric.
 			// strA < strB
 			return true;
@@ -74,7 +119,47 @@ bool ListDataSortProxyModel::doNumericCompare(const QString &strA, const QString
 		}
 	}
 
-	return (valA < valB);
+	return (keyA.num < keyB.num);
+}
+
+/**
+ * Set the source model.
+ * @param sourceModel Source model
+ */
+void ListDataSortProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+	QAbstractItemModel *const oldModel = this->sourceModel();
+	if (oldModel) {
+		disconnect(oldModel, nullptr, this, SLOT(invalidateSortKeys()));
+	}
+	invalidateSortKeys();
+
+	// NOTE: The signals must be connected before calling the
+	// superclass function, since QSortFilterProxyModel re-sorts
+	// the rows when the source model's data changes.
+	if (sourceModel) {
+		connect(sourceModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+			this, SLOT(invalidateSortKeys()));
+		connect(sourceModel, SIGNAL(layoutChanged()),
+			this, SLOT(invalidateSortKeys()));
+		connect(sourceModel, SIGNAL(modelReset()),
+			this, SLOT(invalidateSortKeys()));
+		connect(sourceModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+			this, SLOT(invalidateSortKeys()));
+		connect(sourceModel, SIGNAL(rowsRemoved(QModelIndex,int,int)),
+			this, SLOT(invalidateSortKeys()));
+	}
+
+	super::setSourceModel(sourceModel);
+}
+
+/**
+ * Invalidate the sort keys.
+ * This is called if the source model's data is changed.
+ */
+void ListDataSortProxyModel::invalidateSortKeys(void)
+{
+	m_sortKeys.clear();
 }
 
 /**
@@ -86,36 +171,46 @@ bool ListDataSortProxyModel::doNumericCompare(const QString &strA, const QString
 bool ListDataSortProxyModel::lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const
 {
 	// Columns must be identical.
-	if (source_left.column() != source_right.column()) {
+	const int column = source_left.column();
+	if (column != source_right.column() || column < 0) {
 		// Columns don't match. Use standard sorting.
 		return super::lessThan(source_left, source_right);
 	}
 
+	const vector<SortKey> &keys = sortKeys(column);
+	const int rowA = source_left.row();
+	const int rowB = source_right.row();
+	if (rowA < 0 || rowA >= (int)keys.size() || rowB < 0 || rowB >= (int)keys.size()) {
+		// Out of range. Use standard sorting.
+		return super::lessThan(source_left, source_right);
+	}
+	const SortKey &keyA = keys[rowA];
+	const SortKey &keyB = keys[rowB];
+
 	// Check the sorting method.
 	bool bRet;
-	switch ((m_sortingMethods >> (source_left.column() * RomFields::COLSORT_BITS)) & RomFields::COLSORT_MASK) {
+	switch ((m_sortingMethods >> (column * RomFields::COLSORT_BITS)) & RomFields::COLSORT_MASK) {
 		default:
 			// Unsupported. We'll use standard sorting.
 			assert(!"Unsupported sorting method.");
 			// fall-through
 		case RomFields::COLSORT_STANDARD:
 			// Standard sorting.
-			bRet = super::lessThan(source_left, source_right);
+			if (isSortLocaleAware()) {
+				bRet = (QString::localeAwareCompare(keyA.str, keyB.str) < 0);
+			} else {
+				bRet = (QString::compare(keyA.str, keyB.str, sortCaseSensitivity()) < 0);
+			}
 			break;
-		case RomFields::COLSORT_NOCASE: {
+		case RomFields::COLSORT_NOCASE:
 			// Case-insensitive sorting.
-			QString strA = source_left.data().toString();
-			QString strB = source_right.data().toString();
-			bRet = (QString::compare(strA, strB, Qt::CaseInsensitive) < 0);
+			// NOTE: The sort keys are already case-folded.
+			bRet = (QString::compare(keyA.str, keyB.str, Qt::CaseSensitive) < 0);
 			break;
-		}
-		case RomFields::COLSORT_NUMERIC: {
+		case RomFields::COLSORT_NUMERIC:
 			// Numeric sorting.
-			QString strA = source_left.data().toString();
-			QString strB = source_right.data().toString();
-			bRet = doNumericCompare(strA, strB);
+			bRet = doNumericCompare(keyA, keyB);
 			break;
-		}
 	}
 	return bRet;
 }
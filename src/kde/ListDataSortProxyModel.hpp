@@ -12,6 +12,9 @@
 // C includes.
 #include <stdint.h>
 
+// C++ includes.
+#include <vector>
+
 // Qt includes.
 #include <QSortFilterProxyModel>
 
@@ -25,7 +28,8 @@ class ListDataSortProxyModel : public QSortFilterProxyModel
 
 	public:
 		explicit ListDataSortProxyModel(QObject *parent = 0)
-			: super(parent) { }
+			: super(parent)
+			, m_sortingMethods(0) { }
 		virtual ~ListDataSortProxyModel() { }
 
 	private:
@@ -40,15 +44,36 @@ class ListDataSortProxyModel : public QSortFilterProxyModel
 		 */
 		static qlonglong parseQString(const QString &str, bool *pbAllNumeric);
 
+		// Precomputed sort key for a single cell.
+		struct SortKey {
+			QString str;		// COLSORT_NOCASE: case-folded; otherwise, unmodified
+			qlonglong num;		// COLSORT_NUMERIC: numeric value
+			bool isAllNumeric;	// COLSORT_NUMERIC: true if the entire string is numeric
+		};
+
+		/**
+		 * Get the sort keys for a column.
+		 * Sort keys are computed the first time a column is sorted.
+		 * @param column Column
+		 * @return Sort keys, indexed by source row.
+		 */
+		const std::vector<SortKey> &sortKeys(int column) const;
+
 		/**
 		 * Numeric comparison function.
-		 * @param strA
-		 * @param strB
-		 * @return True if strA < strB
+		 * @param keyA
+		 * @param keyB
+		 * @return True if keyA < keyB
 		 */
-		static bool doNumericCompare(const QString &strA, const QString &strB);
+		static bool doNumericCompare(const SortKey &keyA, const SortKey &keyB);
 
 	public:
+		/**
+		 * Set the source model.
+		 * @param sourceModel Source model
+		 */
+		void setSourceModel(QAbstractItemModel *sourceModel) final;
+
 		/**
 		 * Comparison function.
 		 * @param source_left
@@ -67,6 +92,7 @@ class ListDataSortProxyModel : public QSortFilterProxyModel
 			if (m_sortingMethods == sortingMethods)
 				return;
 			m_sortingMethods = sortingMethods;
+			invalidateSortKeys();
 			emit sortingMethodsChanged(sortingMethods);
 		}
 
@@ -86,8 +112,19 @@ class ListDataSortProxyModel : public QSortFilterProxyModel
 		 */
 		void sortingMethodsChanged(uint32_t sortingMethods);
 
+	private slots:
+		/**
+		 * Invalidate the sort keys.
+		 * This is called if the source model's data is changed.
+		 */
+		void invalidateSortKeys(void);
+
 	private:
 		uint32_t m_sortingMethods;
+
+		// Sort keys. (index: column)
+		// Empty vectors haven't been computed yet.
+		mutable std::vector<std::vector<SortKey> > m_sortKeys;
 };
 
 #endif /* __MCRECOVER_MEMCARDMODEL_HPP__ */
@@ -96,8 +96,9 @@ class RomDataViewPrivate
 			QVBoxLayout *vbox;
 			QFormLayout *form;
 			QLabel *lblCredits;
+			bool populated;	// Field widgets have been created.
 
-			tab() : vbox(nullptr), form(nullptr), lblCredits(nullptr) { }
+			tab() : vbox(nullptr), form(nullptr), lblCredits(nullptr), populated(false) { }
 		};
 		vector<tab> tabs;
 
@@ -115,6 +116,7 @@ class RomDataViewPrivate
 
 		// Multi-language functionality.
 		uint32_t def_lc;
+		uint32_t user_lc;	// Language code selected in cboLanguage.
 		LanguageComboBox *cboLanguage;
 
 		// RFT_STRING_MULTI value labels.
@@ -231,10 +233,22 @@ class RomDataViewPrivate
 			const RomFields::Field &field, int fieldIdx);
 
 		/**
-		 * Update all multi-language fields.
-		 * @param user_lc User-specified language code.
+		 * Update multi-language fields.
+		 * @param user_lc	[in] User-specified language code.
+		 * @param sm_start	[in] Index of the first RFT_STRING_MULTI field to update.
+		 * @param ldm_start	[in] Index of the first RFT_LISTDATA_MULTI field to update.
+		 * @param autosize	[in] If true, resize RFT_LISTDATA_MULTI columns to fit the contents.
 		 */
-		void updateMulti(uint32_t user_lc);
+		void updateMulti(uint32_t user_lc, size_t sm_start = 0, size_t ldm_start = 0, bool autosize = false);
+
+		/**
+		 * Initialize the language combobox.
+		 * All supported languages are collected from the RFT_STRING_MULTI
+		 * and RFT_LISTDATA_MULTI fields, since the widgets for fields on
+		 * tabs that haven't been shown yet don't exist yet.
+		 * @param pFields RomFields
+		 */
+		void initLanguageComboBox(const RomFields *pFields);
 
 		/**
 		 * Update a field's value.
@@ -244,6 +258,13 @@ class RomDataViewPrivate
 		 */
 		int updateField(int fieldIdx);
 
+		/**
+		 * Create the field widgets for a tab.
+		 * Does nothing if the tab's widgets were already created.
+		 * @param tabIdx Tab index.
+		 */
+		void initTab(int tabIdx);
+
 		/**
 		 * Initialize the display widgets.
 		 * If the widgets already exist, they will
@@ -266,6 +287,7 @@ RomDataViewPrivate::RomDataViewPrivate(RomDataView *q, RomData *romData)
 #  endif /* AUTO_TIMEOUT_MESSAGEWIDGET */
 #endif /* HAVE_KMESSAGEWIDGET */
 	, def_lc(0)
+	, user_lc(0)
 	, cboLanguage(nullptr)
 {
 	if (romData) {
@@ -998,18 +1020,17 @@ void RomDataViewPrivate::initStringMulti(QLabel *lblDesc,
 }
 
 /**
- * Update all multi-language fields.
- * @param user_lc User-specified language code.
+ * Update multi-language fields.
+ * @param user_lc	[in] User-specified language code.
+ * @param sm_start	[in] Index of the first RFT_STRING_MULTI field to update.
+ * @param ldm_start	[in] Index of the first RFT_LISTDATA_MULTI field to update.
+ * @param autosize	[in] If true, resize RFT_LISTDATA_MULTI columns to fit the contents.
  */
-void RomDataViewPrivate::updateMulti(uint32_t user_lc)
+void RomDataViewPrivate::updateMulti(uint32_t user_lc, size_t sm_start, size_t ldm_start, bool autosize)
 {
-	// Set of supported language codes.
-	// NOTE: Using std::set instead of QSet for sorting.
-	set<uint32_t> set_lc;
-
 	// RFT_STRING_MULTI
 	const auto vecStringMulti_cend = vecStringMulti.cend();
-	for (auto iter = vecStringMulti.cbegin(); iter != vecStringMulti_cend; ++iter) {
+	for (auto iter = vecStringMulti.cbegin() + sm_start; iter != vecStringMulti_cend; ++iter) {
 		QLabel *const lblString = iter->first;
 		const RomFields::Field *const pField = iter->second;
 		const auto *const pStr_multi = pField->data.str_multi;
@@ -1020,17 +1041,6 @@ void RomDataViewPrivate::updateMulti(uint32_t user_lc)
 			continue;
 		}
 
-		if (!cboLanguage) {
-			// Need to add all supported languages.
-			// TODO: Do we need to do this for all of them, or just one?
-			const auto pStr_multi_cend = pStr_multi->cend();
-			for (auto iter_sm = pStr_multi->cbegin();
-			     iter_sm != pStr_multi_cend; ++iter_sm)
-			{
-				set_lc.insert(iter_sm->first);
-			}
-		}
-
 		// Get the string and update the text.
 		const string *const pStr = RomFields::getFromStringMulti(pStr_multi, def_lc, user_lc);
 		assert(pStr != nullptr);
@@ -1039,25 +1049,18 @@ void RomDataViewPrivate::updateMulti(uint32_t user_lc)
 
 	// RFT_LISTDATA_MULTI
 	const auto vecListDataMulti_cend = vecListDataMulti.cend();
-	for (auto iter = vecListDataMulti.cbegin(); iter != vecListDataMulti_cend; ++iter) {
+	for (auto iter = vecListDataMulti.cbegin() + ldm_start; iter != vecListDataMulti_cend; ++iter) {
 		QTreeView *const treeView = iter->first;
 		ListDataModel *const listModel = iter->second;
 
 		if (listModel != nullptr) {
-			if (!cboLanguage) {
-				// Need to add all supported languages.
-				// TODO: Do we need to do this for all of them, or just one?
-				const set<uint32_t> list_set_lc = listModel->getLCs();
-				set_lc.insert(list_set_lc.cbegin(), list_set_lc.cend());
-			}
-
 			// Set the language code.
 			listModel->setLC(def_lc, user_lc);
 		}
 
 		// Resize the columns to fit the contents.
 		// NOTE: Only done on first load.
-		if (!cboLanguage) {
+		if (autosize) {
 			const int colCount = treeView->model()->columnCount();
 #if QT_VERSION >= QT_VERSION_CHECK(5,0,0)
 			// Check if explicit column sizing was used.
@@ -1081,8 +1084,58 @@ void RomDataViewPrivate::updateMulti(uint32_t user_lc)
 			treeView->resizeColumnToContents(colCount);
 		}
 	}
+}
+
+/**
+ * Initialize the language combobox.
+ * All supported languages are collected from the RFT_STRING_MULTI
+ * and RFT_LISTDATA_MULTI fields, since the widgets for fields on
+ * tabs that haven't been shown yet don't exist yet.
+ * @param pFields RomFields
+ */
+void RomDataViewPrivate::initLanguageComboBox(const RomFields *pFields)
+{
+	assert(cboLanguage == nullptr);
+
+	// Set of supported language codes.
+	// NOTE: Using std::set instead of QSet for sorting.
+	set<uint32_t> set_lc;
+
+	const auto pFields_cend = pFields->cend();
+	for (auto iter = pFields->cbegin(); iter != pFields_cend; ++iter) {
+		const RomFields::Field &field = *iter;
+		if (!field.isValid)
+			continue;
+
+		// Skip fields on hidden tabs.
+		const int tabIdx = field.tabIdx;
+		if (tabIdx < 0 || tabIdx >= (int)tabs.size() || !tabs[tabIdx].form)
+			continue;
+
+		if (field.type == RomFields::RFT_STRING_MULTI) {
+			const auto *const pStr_multi = field.data.str_multi;
+			if (!pStr_multi)
+				continue;
+			std::for_each(pStr_multi->cbegin(), pStr_multi->cend(),
+				[&set_lc](const RomFields::StringMultiMap_t::value_type &p) {
+					set_lc.insert(p.first);
+				}
+			);
+		} else if (field.type == RomFields::RFT_LISTDATA &&
+			   (field.desc.list_data.flags & RomFields::RFT_LISTDATA_MULTI))
+		{
+			const auto *const pListData_multi = field.data.list_data.data.multi;
+			if (!pListData_multi)
+				continue;
+			std::for_each(pListData_multi->cbegin(), pListData_multi->cend(),
+				[&set_lc](const RomFields::ListDataMultiMap_t::value_type &p) {
+					set_lc.insert(p.first);
+				}
+			);
+		}
+	}
 
-	if (!cboLanguage && set_lc.size() > 1) {
+	if (set_lc.size() > 1) {
 		// Create the language combobox.
 		Q_Q(RomDataView);
 		cboLanguage = new LanguageComboBox(q);
@@ -1141,6 +1194,14 @@ int RomDataViewPrivate::updateField(int fieldIdx)
 	if (!field)
 		return 3;
 
+	// If the field's tab hasn't been shown yet, its widget will
+	// be created using the updated value when it's shown.
+	if (field->tabIdx >= 0 && field->tabIdx < (int)tabs.size() &&
+	    !tabs[field->tabIdx].populated)
+	{
+		return 0;
+	}
+
 	// Get the QObject*.
 	auto iter = map_fieldIdx.find(fieldIdx);
 	if (iter == map_fieldIdx.end()) {
@@ -1229,6 +1290,98 @@ int RomDataViewPrivate::updateField(int fieldIdx)
 	return ret;
 }
 
+/**
+ * Create the field widgets for a tab.
+ * Does nothing if the tab's widgets were already created.
+ * @param tabIdx Tab index.
+ */
+void RomDataViewPrivate::initTab(int tabIdx)
+{
+	assert(tabIdx >= 0 && tabIdx < (int)tabs.size());
+	if (tabIdx < 0 || tabIdx >= (int)tabs.size())
+		return;
+
+	auto &tab = tabs[tabIdx];
+	if (tab.populated || !tab.form) {
+		// Tab is already populated, or tab is hidden.
+		return;
+	}
+	tab.populated = true;
+
+	// Multi-language fields that are created here
+	// will need to be updated afterwards.
+	const size_t sm_start = vecStringMulti.size();
+	const size_t ldm_start = vecListDataMulti.size();
+
+	// tr: Field description label.
+	const char *const desc_label_fmt = C_("RomDataView", "%s:");
+
+	// Create the data widgets.
+	Q_Q(RomDataView);
+	const RomFields *const pFields = romData->fields();
+	int fieldIdx = 0;
+	const auto pFields_cend = pFields->cend();
+	for (auto iter = pFields->cbegin(); iter != pFields_cend; ++iter, fieldIdx++) {
+		const RomFields::Field &field = *iter;
+		if (!field.isValid || field.tabIdx != tabIdx)
+			continue;
+
+		// tr: Field description label.
+		string txt = rp_sprintf(desc_label_fmt, field.name);
+		QLabel *lblDesc = new QLabel(U82Q(txt), q);
+		lblDesc->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+		lblDesc->setTextFormat(Qt::PlainText);
+
+		switch (field.type) {
+			case RomFields::RFT_INVALID:
+				// No data here.
+				delete lblDesc;
+				break;
+			default:
+				// Unsupported right now.
+				assert(!"Unsupported RomFields::RomFieldsType.");
+				delete lblDesc;
+				break;
+
+			case RomFields::RFT_STRING:
+				initString(lblDesc, field, fieldIdx);
+				break;
+			case RomFields::RFT_BITFIELD:
+				initBitfield(lblDesc, field, fieldIdx);
+				break;
+			case RomFields::RFT_LISTDATA:
+				initListData(lblDesc, field, fieldIdx);
+				break;
+			case RomFields::RFT_DATETIME:
+				initDateTime(lblDesc, field, fieldIdx);
+				break;
+			case RomFields::RFT_AGE_RATINGS:
+				initAgeRatings(lblDesc, field, fieldIdx);
+				break;
+			case RomFields::RFT_DIMENSIONS:
+				initDimensions(lblDesc, field, fieldIdx);
+				break;
+			case RomFields::RFT_STRING_MULTI:
+				initStringMulti(lblDesc, field, fieldIdx);
+				break;
+		}
+	}
+
+	// Initial update of RFT_STRING_MULTI and RFT_LISTDATA_MULTI fields.
+	if (vecStringMulti.size() > sm_start || vecListDataMulti.size() > ldm_start) {
+		updateMulti(user_lc, sm_start, ldm_start, true);
+	}
+
+	// Check if the last field in the tab was RFT_LISTDATA.
+	// If it is, expand it vertically.
+	// NOTE: Only for RFT_LISTDATA_SEPARATE_ROW.
+	adjustListData(tabIdx);
+
+	// Add a vertical spacer to the QFormLayout.
+	// This is mostly needed for e.g. DSi and 3DS permissions.
+	tab.form->addItem(new QSpacerItem(0, 0));
+}
+
 /**
  * Initialize the display widgets.
  * If the widgets already exist, they will
@@ -1236,6 +1389,11 @@ int RomDataViewPrivate::updateField(int fieldIdx)
  */
 void RomDataViewPrivate::initDisplayWidgets(void)
 {
+	// Don't create any more tab widgets while the tabs are being deleted.
+	Q_Q(RomDataView);
+	QObject::disconnect(ui.tabWidget, SIGNAL(currentChanged(int)),
+	                    q, SLOT(tabWidget_currentChanged_slot(int)));
+
 	// Clear the tabs.
 	std::for_each(tabs.begin(), tabs.end(),
 		[this](RomDataViewPrivate::tab &tab) {
@@ -1257,6 +1415,13 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 	ui.tabWidget->clear();
 	ui.tabWidget->hide();
 
+	// Clear the multi-language widgets.
+	vecStringMulti.clear();
+	vecListDataMulti.clear();
+	delete cboLanguage;
+	cboLanguage = nullptr;
+	user_lc = 0;
+
 	// Initialize the header row.
 	initHeaderRow();
 
@@ -1275,7 +1440,6 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 	}
 
 	// Initialize the QTabWidget.
-	Q_Q(RomDataView);
 	const int tabCount = pFields->tabCount();
 	if (tabCount > 1) {
 		tabs.resize(tabCount);
@@ -1321,100 +1485,20 @@ void RomDataViewPrivate::initDisplayWidgets(void)
 	// TODO: Ensure the description column has the
 	// same width on all tabs.
 
-	// tr: Field description label.
-	const char *const desc_label_fmt = C_("RomDataView", "%s:");
-
-	// Create the data widgets.
-	int prevTabIdx = 0;
-	int fieldIdx = 0;
-	const auto pFields_cend = pFields->cend();
-	for (auto iter = pFields->cbegin(); iter != pFields_cend; ++iter, fieldIdx++) {
-		const RomFields::Field &field = *iter;
-		if (!field.isValid)
-			continue;
-
-		// Verify the tab index.
-		const int tabIdx = field.tabIdx;
-		assert(tabIdx >= 0 && tabIdx < (int)tabs.size());
-		if (tabIdx < 0 || tabIdx >= (int)tabs.size()) {
-			// Tab index is out of bounds.
-			continue;
-		} else if (!tabs[tabIdx].form) {
-			// Tab name is empty. Tab is hidden.
-			continue;
-		}
-
-		// Did the tab index change?
-		if (prevTabIdx != tabIdx) {
-			// Check if the last field in the previous tab
-			// was RFT_LISTDATA. If it is, expand it vertically.
-			// NOTE: Only for RFT_LISTDATA_SEPARATE_ROW.
-			adjustListData(prevTabIdx);
-			prevTabIdx = tabIdx;
-		}
+	// Initialize the language combobox.
+	def_lc = pFields->defaultLanguageCode();
+	initLanguageComboBox(pFields);
 
-		// tr: Field description label.
-		string txt = rp_sprintf(desc_label_fmt, field.name.c_str());
-		QLabel *lblDesc = new QLabel(U82Q(txt), q);
-		lblDesc->setAlignment(Qt::AlignLeft | Qt::AlignTop);
-		lblDesc->setTextFormat(Qt::PlainText);
-
-		switch (field.type) {
-			case RomFields::RFT_INVALID:
-				// No data here.
-				delete lblDesc;
-				break;
-			default:
-				// Unsupported right now.
-				assert(!"Unsupported RomFields::RomFieldsType.");
-				delete lblDesc;
-				break;
-
-			case RomFields::RFT_STRING:
-				initString(lblDesc, field, fieldIdx);
-				break;
-			case RomFields::RFT_BITFIELD:
-				initBitfield(lblDesc, field, fieldIdx);
-				break;
-			case RomFields::RFT_LISTDATA:
-				initListData(lblDesc, field, fieldIdx);
-				break;
-			case RomFields::RFT_DATETIME:
-				initDateTime(lblDesc, field, fieldIdx);
-				break;
-			case RomFields::RFT_AGE_RATINGS:
-				initAgeRatings(lblDesc, field, fieldIdx);
-				break;
-			case RomFields::RFT_DIMENSIONS:
-				initDimensions(lblDesc, field, fieldIdx);
-				break;
-			case RomFields::RFT_STRING_MULTI:
-				initStringMulti(lblDesc, field, fieldIdx);
-				break;
-		}
-	}
-
-	// Initial update of RFT_STRING_MULTI and RFT_LISTDATA_MULTI fields.
-	if (!vecStringMulti.empty() || !vecListDataMulti.empty()) {
-		def_lc = pFields->defaultLanguageCode();
-		updateMulti(0);
-	}
-
-	// Check if the last field in the last tab
-	// was RFT_LISTDATA. If it is, expand it vertically.
-	// NOTE: Only for RFT_LISTDATA_SEPARATE_ROW.
-	if (!tabs.empty()) {
-		adjustListData(static_cast<int>(tabs.size()-1));
+	// Create the widgets for the visible tab.
+	// Widgets for other tabs are created when the tab is first shown.
+	if (tabCount > 1) {
+		q->tabWidget_currentChanged_slot(ui.tabWidget->currentIndex());
+		QObject::connect(ui.tabWidget, SIGNAL(currentChanged(int)),
+		                 q, SLOT(tabWidget_currentChanged_slot(int)));
+	} else {
+		initTab(0);
 	}
 
-	// Add vertical spacers to each QFormLayout.
-	// This is mostly needed for e.g. DSi and 3DS permissions.
-	std::for_each(tabs.cbegin(), tabs.cend(),
-		[](const tab &tab) {
-			tab.form->addItem(new QSpacerItem(0, 0));
-		}
-	);
-
 	// Close the file.
 	// Keeping the file open may prevent the user from
 	// changing the file.
@@ -1585,9 +1669,34 @@ void RomDataView::bitfield_clicked_slot(bool checked)
 void RomDataView::cboLanguage_lcChanged_slot(uint32_t lc)
 {
 	Q_D(RomDataView);
+	d->user_lc = lc;
 	d->updateMulti(lc);
 }
 
+/**
+ * The current QTabWidget tab was changed.
+ * Field widgets for the new tab are created if necessary.
+ * @param index New tab index.
+ */
+void RomDataView::tabWidget_currentChanged_slot(int index)
+{
+	Q_D(RomDataView);
+	QWidget *const widget = d->ui.tabWidget->widget(index);
+	if (!widget)
+		return;
+
+	// NOTE: Hidden tabs aren't added to the QTabWidget,
+	// so the QTabWidget index might not match the tab index.
+	int tabIdx = 0;
+	const auto tabs_cend = d->tabs.cend();
+	for (auto iter = d->tabs.cbegin(); iter != tabs_cend; ++iter, tabIdx++) {
+		if (iter->vbox && iter->vbox->parentWidget() == widget) {
+			d->initTab(tabIdx);
+			break;
+		}
+	}
+}
+
 /** Properties. **/
 
 /**
@@ -72,6 +72,13 @@ class RomDataView : public QWidget
 		 */
 		void cboLanguage_lcChanged_slot(uint32_t lc);
 
+		/**
+		 * The current QTabWidget tab was changed.
+		 * Field widgets for the new tab are created if necessary.
+		 * @param index New tab index.
+		 */
+		void tabWidget_currentChanged_slot(int index);
+
 	public:
 		/** Properties. **/
 
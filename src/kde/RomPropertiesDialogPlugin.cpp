@@ -49,7 +49,9 @@ RomPropertiesDialogPlugin::RomPropertiesDialogPlugin(KPropertiesDialog *props, c
 	}
 
 	// Get the appropriate RomData class for this ROM.
-	RomData *const romData = RomDataFactory::create(file);
+	// The parsed-result cache is used if it's enabled,
+	// so large files don't have to be parsed again.
+	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_PARSED_CACHE);
 	file->unref();	// file is ref()'d by RomData.
 	if (!romData) {
 		// ROM is not supported.
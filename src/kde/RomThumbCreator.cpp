@@ -22,6 +22,7 @@ using LibRpTexture::rp_image;
 
 // libromdata
 #include "libromdata/RomDataFactory.hpp"
+#include "libromdata/img/XdgThumbnailCache.hpp"
 using LibRomData::RomDataFactory;
 
 // TCreateThumbnail is a templated class,
@@ -261,15 +262,24 @@ ThumbCreator::Flags RomThumbCreator::flags(void) const
 /** CreateThumbnail **/
 
 /**
- * Thumbnail creator function for wrapper programs.
+ * Thumbnail creator function for wrapper programs. (v2)
+ * Same as rp_create_thumbnail(), but the request can be cancelled
+ * or limited to a time budget.
  * @param source_file Source file. (UTF-8)
  * @param output_file Output file. (UTF-8)
  * @param maximum_size Maximum size.
+ * @param pCancel Cancellation flag. (may be NULL)
+ * @param timeout_ms Time budget, in milliseconds. (0 for no limit)
  * @return 0 on success; non-zero on error.
  */
 extern "C"
-Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const char *output_file, int maximum_size)
+Q_DECL_EXPORT int RP_C_API rp_create_thumbnail2(const char *source_file, const char *output_file, int maximum_size, const volatile int *pCancel, unsigned int timeout_ms)
 {
+	// The time budget includes opening the file and detecting the RomData subclass.
+	const uint64_t deadline_ns = (timeout_ms != 0)
+		? rp_monotonic_ns() + (static_cast<uint64_t>(timeout_ms) * 1000000ULL)
+		: 0;
+
 	// NOTE: TCreateThumbnail() has wrappers for opening the
 	// ROM file and getting RomData*, but we're doing it here
 	// in order to return better error codes.
@@ -283,8 +293,41 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const ch
 	// TODO: Static initializer somewhere?
 	rp_image::setBackendCreatorFn(RpQImageBackend::creator_fn);
 
-	// Attempt to open the ROM file.
+	// Local filename.
 	QUrl localUrl = localizeQUrl(QUrl(QString::fromUtf8(source_file)));
+	QString qs_source_filename;
+	if (localUrl.scheme().isEmpty() || localUrl.isLocalFile()) {
+		qs_source_filename = localUrl.toLocalFile();
+	}
+
+	// Get the modification time and file size.
+	// FIXME: Local files only. Figure out how to handle this for remote.
+	int64_t mtime = 0;
+	off64_t szFile = 0;
+	if (!qs_source_filename.isEmpty()) {
+		QFileInfo fi_src(qs_source_filename);
+		mtime = fi_src.lastModified().toMSecsSinceEpoch() / 1000;
+		szFile = fi_src.size();
+	}
+
+	// If the XDG thumbnail cache already has a valid thumbnail
+	// for this file, use it instead of opening the ROM.
+	const QByteArray ba_uri = localUrl.toEncoded();
+	if (mtime > 0 && LibRomData::XdgThumbnailCache::getValidThumbnail(
+		ba_uri.constData(), mtime, maximum_size, output_file) == 0)
+	{
+		return RPCT_SUCCESS;
+	}
+
+	if (pCancel && *pCancel) {
+		// Thumbnail request was cancelled.
+		return RPCT_CANCELLED;
+	} else if (deadline_ns != 0 && rp_monotonic_ns() >= deadline_ns) {
+		// Thumbnail request exceeded its time budget.
+		return RPCT_TIMED_OUT;
+	}
+
+	// Attempt to open the ROM file.
 	IRpFile *const file = openQUrl(localUrl, true);
 	if (!file) {
 		// Could not open the file.
@@ -293,7 +336,7 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const ch
 
 	// Get the appropriate RomData class for this ROM.
 	// RomData class *must* support at least one image type.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL | RomDataFactory::RDA_EXT_HINT | RomDataFactory::RDA_NEG_CACHE | RomDataFactory::RDA_CACHE);
 	file->unref();	// file is ref()'d by RomData.
 	if (!romData) {
 		// ROM is not supported.
@@ -303,6 +346,8 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const ch
 	// Create the thumbnail.
 	// TODO: If image is larger than maximum_size, resize down.
 	RomThumbCreatorPrivate *const d = new RomThumbCreatorPrivate();
+	d->setCancelFlag(pCancel);
+	d->setDeadline(deadline_ns);
 	RomThumbCreatorPrivate::GetThumbnailOutParams_t outParams;
 	int ret = d->getThumbnail(romData, maximum_size, &outParams);
 	delete d;
@@ -310,7 +355,7 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const ch
 	if (ret != 0 || outParams.retImg.isNull()) {
 		// No image.
 		romData->unref();
-		return RPCT_SOURCE_FILE_NO_IMAGE;
+		return ((ret == RPCT_CANCELLED || ret == RPCT_TIMED_OUT) ? ret : RPCT_SOURCE_FILE_NO_IMAGE);
 	}
 
 	// Save the image using RpPngWriter.
@@ -351,32 +396,24 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const ch
 		romData->unref();
 		return RPCT_OUTPUT_FILE_FAILED;
 	}
+	if (Config::instance()->fastThumbnailPNG()) {
+		// Thumbnails are written often and read rarely,
+		// so trade file size for compression speed.
+		pngWriter->setProfile(RpPngWriter::Profile::Fast);
+	}
 
 	// Software.
 	static const char sw[] = "ROM Properties Page shell extension (" RP_KDE_UPPER QT_MAJOR_STR ")";
 	kv.emplace_back("Software", sw);
 
-	// Local filename.
-	QString qs_source_filename;
-	if (localUrl.scheme().isEmpty() || localUrl.isLocalFile()) {
-		qs_source_filename = localUrl.toLocalFile();
+	// Modification time.
+	if (mtime > 0) {
+		kv.emplace_back("Thumb::MTime", rp_sprintf("%" PRId64, mtime));
 	}
 
-	// FIXME: Local files only. Figure out how to handle this for remote.
-	if (!qs_source_filename.isEmpty()) {
-		QFileInfo fi_src(qs_source_filename);
-
-		// Modification time.
-		int64_t mtime = fi_src.lastModified().toMSecsSinceEpoch() / 1000;
-		if (mtime > 0) {
-			kv.emplace_back("Thumb::MTime", rp_sprintf("%" PRId64, mtime));
-		}
-
-		// File size.
-		off64_t szFile = fi_src.size();
-		if (szFile > 0) {
-			kv.emplace_back("Thumb::Size", rp_sprintf("%" PRId64, szFile));
-		}
+	// File size.
+	if (szFile > 0) {
+		kv.emplace_back("Thumb::Size", rp_sprintf("%" PRId64, szFile));
 	}
 
 	// MIME type.
@@ -398,7 +435,7 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const ch
 	// NOTE: KDE desktops don't urlencode spaces or non-ASCII characters.
 	// GTK+ desktops *do* urlencode spaces and non-ASCII characters.
 	// FIXME: Do we want to store the local URI or the original URI?
-	kv.emplace_back("Thumb::URI", localUrl.toEncoded().constData());
+	kv.emplace_back("Thumb::URI", ba_uri.constData());
 
 	// Write the tEXt chunks.
 	pngWriter->write_tEXt(kv);
@@ -444,3 +481,16 @@ Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const ch
 	romData->unref();
 	return ret;
 }
+
+/**
+ * Thumbnail creator function for wrapper programs.
+ * @param source_file Source file. (UTF-8)
+ * @param output_file Output file. (UTF-8)
+ * @param maximum_size Maximum size.
+ * @return 0 on success; non-zero on error.
+ */
+extern "C"
+Q_DECL_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const char *output_file, int maximum_size)
+{
+	return rp_create_thumbnail2(source_file, output_file, maximum_size, nullptr, 0);
+}
@@ -12,6 +12,7 @@
 
 // librpbase, librpfile, librptexture
 #include "librpbase/config/Config.hpp"
+#include "librpfile/CachedFile.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
 using LibRpTexture::rp_image;
@@ -191,7 +192,10 @@ IRpFile *openQUrl(const QUrl &url, bool isThumbnail)
 	} else {
 		// Remote filename. Use RpFile_kio.
 #ifdef HAVE_RPFILE_KIO
-		file = new RpFileKio(url);
+		// KIO reads are expensive, so wrap it in a CachedFile.
+		RpFileKio *const kioFile = new RpFileKio(url);
+		file = new CachedFile(kioFile);
+		kioFile->unref();
 #else /* !HAVE_RPFILE_KIO */
 		// Not supported...
 		return nullptr;
@@ -103,6 +103,12 @@ static int recursiveScan(const char *path, list<pair<tstring, uint8_t> > &rlist)
 			// Thumbs.db files can be deleted.
 			if (!strcasecmp(dirent->d_name, _T("Thumbs.db")))
 				goto isok;
+			// The download cache's LRU index can be deleted.
+			if (!strcmp(dirent->d_name, "cache-lru.idx"))
+				goto isok;
+			// Same with the download cache's pack file.
+			if (!strcmp(dirent->d_name, "cache.pak"))
+				goto isok;
 
 			// Check the extension.
 			size_t len = strlen(dirent->d_name);
@@ -29,6 +29,7 @@ using std::vector;
 #include <kfileitem.h>
 #include <kfilemetadata/extractorplugin.h>
 #include <kfilemetadata/properties.h>
+#include <kfilemetadata/types.h>
 using KFileMetaData::ExtractorPlugin;
 using KFileMetaData::ExtractionResult;
 using namespace KFileMetaData::Property;
@@ -74,6 +75,12 @@ QStringList ExtractorPlugin::mimetypes(void) const
 
 void ExtractorPlugin::extract(ExtractionResult *result)
 {
+	// Baloo may only want plain text, which we don't have.
+	if (!(result->inputFlags() & ExtractionResult::ExtractMetaData)) {
+		// Metadata wasn't requested.
+		return;
+	}
+
 	// Attempt to open the ROM file.
 	IRpFile *const file = openQUrl(QUrl(result->inputUrl()), false);
 	if (!file) {
@@ -83,14 +90,33 @@ void ExtractorPlugin::extract(ExtractionResult *result)
 
 	// Get the appropriate RomData class for this ROM.
 	// file is dup()'d by RomData.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_METADATA);
+	// NOTE: Baloo runs extractors in batches in a separate process,
+	// so the extension hint and the negative detection cache are used
+	// to avoid probing every subclass for files that aren't supported.
+	RomData *const romData = RomDataFactory::create(file,
+		RomDataFactory::RDA_HAS_METADATA | RomDataFactory::RDA_EXT_HINT |
+		RomDataFactory::RDA_NEG_CACHE | RomDataFactory::RDA_CACHE);
 	file->unref();	// file is ref()'d by RomData.
 	if (!romData) {
 		// ROM is not supported.
 		return;
 	}
 
+	// Set the file type for types that KFileMetaData knows about.
+	switch (romData->fileType()) {
+		case RomData::FileType::AudioFile:
+			result->addType(KFileMetaData::Type::Audio);
+			break;
+		case RomData::FileType::TextureFile:
+			result->addType(KFileMetaData::Type::Image);
+			break;
+		default:
+			break;
+	}
+
 	// Get the metadata properties.
+	// NOTE: This only loads the metadata. Fields and images
+	// aren't loaded, so this is faster than the property page.
 	const RomMetaData *const metaData = romData->metaData();
 	if (!metaData || metaData->empty()) {
 		// No metadata properties.
@@ -70,6 +70,15 @@ QStringList OverlayIconPlugin::getOverlays(const QUrl &item)
 		return sl;
 	}
 
+	// Only a few RomData subclasses can have "dangerous" permissions.
+	// Check the file extension first so other files aren't opened.
+	if (!RomDataFactory::isExtensionSupported(item.fileName().toUtf8().constData(),
+	    RomDataFactory::RDA_HAS_DPOVERLAY))
+	{
+		// File extension isn't supported.
+		return sl;
+	}
+
 	// Attempt to open the ROM file.
 	IRpFile *const file = openQUrl(item, true);
 	if (!file) {
@@ -78,7 +87,7 @@ QStringList OverlayIconPlugin::getOverlays(const QUrl &item)
 	}
 
 	// Get the appropriate RomData class for this ROM.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_DPOVERLAY);
+	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_DPOVERLAY | RomDataFactory::RDA_CACHE);
 	file->unref();	// file is ref()'d by RomData.
 	if (!romData) {
 		// No RomData.
@@ -55,12 +55,18 @@ class VGMPrivate final : public RomDataPrivate
 		// All strings must be in UTF-8 format.
 		typedef array<string, GD3_TAG_MAX> gd3_tags_t;
 
+		// GD3 tags. (loaded on demand)
+		unique_ptr<gd3_tags_t> gd3_tags;
+		bool gd3_loaded;
+
 		/**
 		 * Load GD3 tags.
-		 * @param addr Starting address of the GD3 tag block.
-		 * @return Allocated GD3 tags, or nullptr on error.
+		 * The tags are only loaded once, since they're usually
+		 * at the end of the file, which is expensive to reach
+		 * in gzipped VGZ files.
+		 * @return GD3 tags, or nullptr if not present or on error.
 		 */
-		gd3_tags_t *loadGD3(unsigned int addr);
+		const gd3_tags_t *loadGD3(void);
 
 		/**
 		 * Add a common sound chip field.
@@ -80,6 +86,7 @@ VGMPrivate::VGMPrivate(VGM *q, IRpFile *file)
 	, s_dualchip(nullptr)
 	, s_yes(nullptr)
 	, s_no(nullptr)
+	, gd3_loaded(false)
 {
 	// Clear the VGM header struct.
 	memset(&vgmHeader, 0, sizeof(vgmHeader));
@@ -117,16 +124,34 @@ string VGMPrivate::formatClockRate(unsigned int clock_rate)
 
 /**
  * Load GD3 tags.
- * @param addr Starting address of the GD3 tag block.
- * @return Allocated GD3 tags, or nullptr on error.
+ * The tags are only loaded once, since they're usually
+ * at the end of the file, which is expensive to reach
+ * in gzipped VGZ files.
+ * @return GD3 tags, or nullptr if not present or on error.
  */
-VGMPrivate::gd3_tags_t *VGMPrivate::loadGD3(unsigned int addr)
+const VGMPrivate::gd3_tags_t *VGMPrivate::loadGD3(void)
 {
+	if (gd3_loaded) {
+		// GD3 tags were already loaded.
+		return gd3_tags.get();
+	}
+
 	assert(file != nullptr);
 	assert(file->isOpen());
 	if (!file || !file->isOpen()) {
 		return nullptr;
 	}
+	gd3_loaded = true;
+
+	// NOTE: Not byteswapping when checking for 0 because
+	// 0 in big-endian is the same as 0 in little-endian.
+	if (vgmHeader.gd3_offset == 0) {
+		// No GD3 tags.
+		return nullptr;
+	}
+
+	// TODO: Make sure the GD3 offset is stored after the header.
+	const unsigned int addr = le32_to_cpu(vgmHeader.gd3_offset) + offsetof(VGM_Header, gd3_offset);
 
 	GD3_Header gd3Header;
 	size_t size = file->seekAndRead(addr, &gd3Header, sizeof(gd3Header));
@@ -168,7 +193,7 @@ VGMPrivate::gd3_tags_t *VGMPrivate::loadGD3(unsigned int addr)
 		return nullptr;
 	}
 
-	gd3_tags_t *gd3_tags = new gd3_tags_t;
+	gd3_tags.reset(new gd3_tags_t);
 
 	// Convert from NULL-terminated strings to gd3_tags_t.
 	size_t tag_idx = 0;
@@ -186,7 +211,7 @@ VGMPrivate::gd3_tags_t *VGMPrivate::loadGD3(unsigned int addr)
 	}
 
 	// TODO: Return an error if there's more than GD3_TAG_MAX strings?
-	return gd3_tags;
+	return gd3_tags.get();
 }
 
 /**
@@ -424,10 +449,8 @@ int VGM::loadFieldData(void)
 	// 0 in big-endian is the same as 0 in little-endian.
 
 	// GD3 tags.
-	if (d->vgmHeader.gd3_offset != 0) {
-		// TODO: Make sure the GD3 offset is stored after the header.
-		const unsigned int addr = le32_to_cpu(d->vgmHeader.gd3_offset) + offsetof(VGM_Header, gd3_offset);
-		VGMPrivate::gd3_tags_t *const gd3_tags = d->loadGD3(addr);
+	{
+		const VGMPrivate::gd3_tags_t *const gd3_tags = d->loadGD3();
 		if (gd3_tags) {
 			// TODO: Option to show Japanese instead of English.
 
@@ -469,8 +492,6 @@ int VGM::loadFieldData(void)
 						dpgettext_expr(RP_I18N_DOMAIN, pTag->ctx, pTag->desc), str);
 				}
 			}
-
-			delete gd3_tags;
 		}
 	}
 
@@ -918,10 +939,8 @@ int VGM::loadMetaData(void)
 		convSampleToMs(le32_to_cpu(vgmHeader->sample_count), VGM_SAMPLE_RATE));
 
 	// Attempt to load the GD3 tags.
-	if (d->vgmHeader.gd3_offset != 0) {
-		// TODO: Make sure the GD3 offset is stored after the header.
-		const unsigned int addr = le32_to_cpu(d->vgmHeader.gd3_offset) + offsetof(VGM_Header, gd3_offset);
-		VGMPrivate::gd3_tags_t *const gd3_tags = d->loadGD3(addr);
+	{
+		const VGMPrivate::gd3_tags_t *const gd3_tags = d->loadGD3();
 		if (gd3_tags) {
 			// TODO: Option to show Japanese instead of English.
 
@@ -974,8 +993,6 @@ int VGM::loadMetaData(void)
 					d->metaData->addMetaData_string(pTag->prop, str);
 				}
 			}
-
-			delete gd3_tags;
 		}
 	}
 
@@ -0,0 +1,1005 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CachedRomData.cpp: RomData object loaded from the parsed-result cache.  *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CachedRomData.hpp"
+#include "librpbase/RomData_p.hpp"
+
+// librpbase, librpfile, librptexture
+#include "librpbase/img/RpPng.hpp"
+#include "librpfile/RpMemFile.hpp"
+#include "librpfile/RpVectorFile.hpp"
+using namespace LibRpBase;
+using LibRpFile::RpMemFile;
+using LibRpFile::RpVectorFile;
+using LibRpTexture::rp_image;
+
+// C++ STL classes.
+using std::string;
+using std::vector;
+
+namespace LibRomData {
+
+class CachedRomDataPrivate final : public RomDataPrivate
+{
+	public:
+		CachedRomDataPrivate(CachedRomData *q, const char *filename);
+		~CachedRomDataPrivate();
+
+	private:
+		typedef RomDataPrivate super;
+		RP_DISABLE_COPY(CachedRomDataPrivate)
+
+	public:
+		// Maximum dimensions for cached images.
+		// Files with larger internal images aren't cached.
+		static const int MAX_IMAGE_DIM = 512;
+
+		// Class information.
+		string s_className;
+		string s_mimeType;
+
+		// System names, indexed by sysNameIndex().
+		string s_systemNames[6];
+		bool hasSystemName[6];
+		bool hasDangerousPermissions;
+
+		// Internal images.
+		uint32_t imgbf;
+		uint32_t imgpf[RomData::IMG_INT_MAX - RomData::IMG_INT_MIN + 1];
+		rp_image *img[RomData::IMG_INT_MAX - RomData::IMG_INT_MIN + 1];
+
+		// RFT_LISTDATA_ICONS icons. (owned by this object)
+		vector<rp_image*> listIcons;
+
+		/**
+		 * Get the s_systemNames[] index for a SystemNameType bitfield.
+		 * The type must have been validated by the caller.
+		 * @param type SystemNameType bitfield
+		 * @return Index
+		 */
+		static inline unsigned int sysNameIndex(unsigned int type)
+		{
+			return (type & RomData::SYSNAME_TYPE_MASK) +
+				((type & RomData::SYSNAME_REGION_MASK) ? 3 : 0);
+		}
+};
+
+namespace CachedRomDataSerial {
+
+// Serialized data is stored in host byte order,
+// since the cache is only used on the local system.
+// Strings are stored as a uint32_t length followed by
+// the string data, with NULL_STR indicating nullptr.
+static const uint32_t NULL_STR = ~0U;
+
+class BlobWriter
+{
+	public:
+		explicit BlobWriter(vector<uint8_t> &buf)
+			: buf(buf) { }
+
+	private:
+		RP_DISABLE_COPY(BlobWriter)
+
+	public:
+		template<typename T>
+		inline void put(T val)
+		{
+			const uint8_t *const p = reinterpret_cast<const uint8_t*>(&val);
+			buf.insert(buf.end(), p, p + sizeof(val));
+		}
+
+		inline void putStr(const char *str)
+		{
+			if (!str) {
+				put<uint32_t>(NULL_STR);
+				return;
+			}
+			const size_t len = strlen(str);
+			put<uint32_t>(static_cast<uint32_t>(len));
+			buf.insert(buf.end(), str, str + len);
+		}
+
+		inline void putStr(const string &str)
+		{
+			put<uint32_t>(static_cast<uint32_t>(str.size()));
+			buf.insert(buf.end(), str.begin(), str.end());
+		}
+
+		inline void putStrVector(const vector<string> *vec)
+		{
+			if (!vec) {
+				put<uint32_t>(NULL_STR);
+				return;
+			}
+			put<uint32_t>(static_cast<uint32_t>(vec->size()));
+			for (const string &str : *vec) {
+				putStr(str);
+			}
+		}
+
+		inline void putListData(const RomFields::ListData_t *list_data)
+		{
+			if (!list_data) {
+				put<uint32_t>(NULL_STR);
+				return;
+			}
+			put<uint32_t>(static_cast<uint32_t>(list_data->size()));
+			for (const vector<string> &row : *list_data) {
+				putStrVector(&row);
+			}
+		}
+
+		/**
+		 * Write an image as PNG data.
+		 * @param img Image (may be nullptr)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int putImage(const rp_image *img)
+		{
+			if (!img) {
+				put<uint32_t>(NULL_STR);
+				return 0;
+			}
+
+			RpVectorFile *const pngData = new RpVectorFile();
+			const int ret = RpPng::save(pngData, img);
+			if (ret == 0) {
+				const vector<uint8_t> &vec = pngData->vector();
+				put<uint32_t>(static_cast<uint32_t>(vec.size()));
+				buf.insert(buf.end(), vec.begin(), vec.end());
+			}
+			pngData->unref();
+			return ret;
+		}
+
+	private:
+		vector<uint8_t> &buf;
+};
+
+class BlobReader
+{
+	public:
+		BlobReader(const uint8_t *data, size_t size)
+			: p(data), end(data + size), ok(true) { }
+
+	private:
+		RP_DISABLE_COPY(BlobReader)
+
+	public:
+		/**
+		 * Has all data been read successfully?
+		 * @return True if no read errors occurred.
+		 */
+		inline bool isOk(void) const
+		{
+			return ok;
+		}
+
+		/**
+		 * Number of bytes remaining.
+		 * @return Bytes remaining.
+		 */
+		inline size_t remaining(void) const
+		{
+			return static_cast<size_t>(end - p);
+		}
+
+		template<typename T>
+		inline T get(void)
+		{
+			T val;
+			if (!ok || remaining() < sizeof(val)) {
+				ok = false;
+				memset(&val, 0, sizeof(val));
+				return val;
+			}
+			memcpy(&val, p, sizeof(val));
+			p += sizeof(val);
+			return val;
+		}
+
+		/**
+		 * Get a count, verifying that enough data is remaining
+		 * for count elements of at least minElemSize bytes each.
+		 * @param minElemSize Minimum size of each element
+		 * @return Count, or NULL_STR if nullptr. (0 on error)
+		 */
+		inline uint32_t getCount(size_t minElemSize)
+		{
+			const uint32_t count = get<uint32_t>();
+			if (count == NULL_STR)
+				return count;
+			if (!ok || (count * static_cast<uint64_t>(minElemSize)) > remaining()) {
+				ok = false;
+				return 0;
+			}
+			return count;
+		}
+
+		/**
+		 * Get a string.
+		 * @param str	[out] String
+		 * @return True if the string was not nullptr; false if it was (or on error).
+		 */
+		inline bool getStr(string &str)
+		{
+			const uint32_t len = getCount(1);
+			if (len == NULL_STR || !ok) {
+				str.clear();
+				return false;
+			}
+			str.assign(reinterpret_cast<const char*>(p), len);
+			p += len;
+			return true;
+		}
+
+		inline vector<string> *getStrVector(void)
+		{
+			const uint32_t count = getCount(sizeof(uint32_t));
+			if (count == NULL_STR || !ok)
+				return nullptr;
+			vector<string> *const vec = new vector<string>(count);
+			for (string &str : *vec) {
+				getStr(str);
+			}
+			return vec;
+		}
+
+		inline RomFields::ListData_t *getListData(void)
+		{
+			const uint32_t count = getCount(sizeof(uint32_t));
+			if (count == NULL_STR || !ok)
+				return nullptr;
+			RomFields::ListData_t *const list_data = new RomFields::ListData_t(count);
+			for (vector<string> &row : *list_data) {
+				vector<string> *const vec = getStrVector();
+				if (vec) {
+					row = std::move(*vec);
+					delete vec;
+				}
+			}
+			return list_data;
+		}
+
+		/**
+		 * Get an image from PNG data.
+		 * @return Image, or nullptr if none. (Check isOk() for errors.)
+		 */
+		rp_image *getImage(void)
+		{
+			const uint32_t len = getCount(1);
+			if (len == NULL_STR || !ok)
+				return nullptr;
+
+			RpMemFile *const pngData = new RpMemFile(p, len);
+			rp_image *const img = RpPng::load(pngData);
+			pngData->unref();
+			p += len;
+			if (!img) {
+				ok = false;
+			}
+			return img;
+		}
+
+	private:
+		const uint8_t *p;
+		const uint8_t *const end;
+		bool ok;
+};
+
+/**
+ * Serialize RomFields.
+ * @param w	[in] BlobWriter
+ * @param fields	[in] RomFields (may be nullptr)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int serializeFields(BlobWriter &w, const RomFields *fields)
+{
+	if (!fields) {
+		// No fields.
+		w.put<uint32_t>(0);	// tabs
+		w.put<uint32_t>(0);	// def_lc
+		w.put<uint32_t>(0);	// fields
+		return 0;
+	}
+
+	const int tabCount = fields->tabCount();
+	w.put<uint32_t>(static_cast<uint32_t>(tabCount));
+	for (int i = 0; i < tabCount; i++) {
+		w.putStr(fields->tabName(i));
+	}
+	w.put<uint32_t>(fields->defaultLanguageCode());
+
+	// Invalid fields are skipped.
+	uint32_t count = 0;
+	for (auto iter = fields->cbegin(); iter != fields->cend(); ++iter) {
+		if (iter->isValid && iter->type != RomFields::RFT_INVALID) {
+			count++;
+		}
+	}
+	w.put<uint32_t>(count);
+
+	for (auto iter = fields->cbegin(); iter != fields->cend(); ++iter) {
+		const RomFields::Field &field = *iter;
+		if (!field.isValid || field.type == RomFields::RFT_INVALID)
+			continue;
+
+		w.put<uint8_t>(field.type);
+		w.put<uint8_t>(field.tabIdx);
+		w.putStr(field.name);
+
+		switch (field.type) {
+			default:
+				assert(!"Unsupported RomFields::RomFieldsType.");
+				return -ENOTSUP;
+
+			case RomFields::RFT_STRING:
+				w.put<uint32_t>(field.desc.flags);
+				if (field.data.str) {
+					w.putStr(*field.data.str);
+				} else {
+					w.putStr(nullptr);
+				}
+				break;
+
+			case RomFields::RFT_BITFIELD:
+				w.put<int32_t>(field.desc.bitfield.elemsPerRow);
+				w.putStrVector(field.desc.bitfield.names);
+				w.put<uint32_t>(field.data.bitfield);
+				break;
+
+			case RomFields::RFT_LISTDATA: {
+				const auto &list_data = field.desc.list_data;
+				w.put<uint32_t>(list_data.flags);
+				w.put<int32_t>(list_data.rows_visible);
+				w.put<uint32_t>(list_data.col_attrs.align_headers);
+				w.put<uint32_t>(list_data.col_attrs.align_data);
+				w.put<uint32_t>(list_data.col_attrs.sizing);
+				w.put<uint32_t>(list_data.col_attrs.sorting);
+				w.put<int8_t>(list_data.col_attrs.sort_col);
+				w.put<uint8_t>(list_data.col_attrs.sort_dir);
+				w.putStrVector(list_data.names);
+
+				if (list_data.flags & RomFields::RFT_LISTDATA_MULTI) {
+					const RomFields::ListDataMultiMap_t *const multi = field.data.list_data.data.multi;
+					if (!multi) {
+						w.put<uint32_t>(NULL_STR);
+					} else {
+						w.put<uint32_t>(static_cast<uint32_t>(multi->size()));
+						for (const auto &pair : *multi) {
+							w.put<uint32_t>(pair.first);
+							w.putListData(&pair.second);
+						}
+					}
+				} else {
+					w.putListData(field.data.list_data.data.single);
+				}
+
+				if (list_data.flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+					w.put<uint32_t>(field.data.list_data.mxd.checkboxes);
+				} else if (list_data.flags & RomFields::RFT_LISTDATA_ICONS) {
+					// Deferred icons are loaded now, since the
+					// CachedRomData object can't load them later.
+					const RomFields::ListDataIcons_t *const icons = field.data.list_data.mxd.icons;
+					const unsigned int iconCount = (icons ? static_cast<unsigned int>(icons->size()) : 0);
+					w.put<uint32_t>(iconCount);
+					for (unsigned int row = 0; row < iconCount; row++) {
+						int ret = w.putImage(RomFields::listDataIcon(field, row));
+						if (ret != 0)
+							return ret;
+					}
+				}
+				break;
+			}
+
+			case RomFields::RFT_DATETIME:
+				w.put<uint32_t>(field.desc.flags);
+				w.put<int64_t>(static_cast<int64_t>(field.data.date_time));
+				break;
+
+			case RomFields::RFT_AGE_RATINGS:
+				if (field.data.age_ratings) {
+					w.put<uint8_t>(1);
+					for (uint16_t rating : *field.data.age_ratings) {
+						w.put<uint16_t>(rating);
+					}
+				} else {
+					w.put<uint8_t>(0);
+				}
+				break;
+
+			case RomFields::RFT_DIMENSIONS:
+				w.put<int32_t>(field.data.dimensions[0]);
+				w.put<int32_t>(field.data.dimensions[1]);
+				w.put<int32_t>(field.data.dimensions[2]);
+				break;
+
+			case RomFields::RFT_STRING_MULTI: {
+				w.put<uint32_t>(field.desc.flags);
+				const RomFields::StringMultiMap_t *const str_multi = field.data.str_multi;
+				if (!str_multi) {
+					w.put<uint32_t>(NULL_STR);
+				} else {
+					w.put<uint32_t>(static_cast<uint32_t>(str_multi->size()));
+					for (const auto &pair : *str_multi) {
+						w.put<uint32_t>(pair.first);
+						w.putStr(pair.second);
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Deserialize RomFields.
+ * @param r	[in] BlobReader
+ * @param d	[in,out] CachedRomDataPrivate
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int deserializeFields(BlobReader &r, CachedRomDataPrivate *d)
+{
+	RomFields *const fields = d->fields;
+	string str;
+
+	const uint32_t tabCount = r.getCount(sizeof(uint32_t));
+	if (!r.isOk() || tabCount == NULL_STR)
+		return -EIO;
+	if (tabCount > 0) {
+		fields->reserveTabs(static_cast<int>(tabCount));
+		for (uint32_t i = 0; i < tabCount; i++) {
+			r.getStr(str);
+			fields->setTabName(static_cast<int>(i), str.c_str());
+		}
+	}
+	const uint32_t def_lc = r.get<uint32_t>();
+
+	const uint32_t count = r.getCount(2);
+	if (!r.isOk() || count == NULL_STR)
+		return -EIO;
+	fields->reserve(static_cast<int>(count));
+
+	string name;
+	for (uint32_t i = 0; i < count && r.isOk(); i++) {
+		const uint8_t type = r.get<uint8_t>();
+		fields->setTabIndex(r.get<uint8_t>());
+		r.getStr(name);
+
+		switch (type) {
+			default:
+				// Invalid field type.
+				return -EIO;
+
+			case RomFields::RFT_STRING: {
+				const unsigned int flags = r.get<uint32_t>();
+				if (r.getStr(str)) {
+					fields->addField_string(name.c_str(), str, flags);
+				} else {
+					fields->addField_string(name.c_str(), nullptr, flags);
+				}
+				break;
+			}
+
+			case RomFields::RFT_BITFIELD: {
+				const int elemsPerRow = r.get<int32_t>();
+				vector<string> *const names = r.getStrVector();
+				const uint32_t bitfield = r.get<uint32_t>();
+				if (!names || !r.isOk()) {
+					delete names;
+					return -EIO;
+				}
+				fields->addField_bitfield(name.c_str(), names, elemsPerRow, bitfield);
+				break;
+			}
+
+			case RomFields::RFT_LISTDATA: {
+				const unsigned int flags = r.get<uint32_t>();
+				const int rows_visible = r.get<int32_t>();
+				RomFields::AFLD_PARAMS params(flags, rows_visible);
+				params.col_attrs.align_headers = r.get<uint32_t>();
+				params.col_attrs.align_data = r.get<uint32_t>();
+				params.col_attrs.sizing = r.get<uint32_t>();
+				params.col_attrs.sorting = r.get<uint32_t>();
+				params.col_attrs.sort_col = r.get<int8_t>();
+				params.col_attrs.sort_dir = static_cast<RomFields::ColSortOrder>(r.get<uint8_t>());
+				params.def_lc = def_lc;
+				params.headers = r.getStrVector();
+
+				if (params.flags & RomFields::RFT_LISTDATA_MULTI) {
+					const uint32_t lcCount = r.getCount(sizeof(uint32_t) * 2);
+					if (lcCount != NULL_STR && r.isOk()) {
+						RomFields::ListDataMultiMap_t *const multi = new RomFields::ListDataMultiMap_t();
+						for (uint32_t j = 0; j < lcCount && r.isOk(); j++) {
+							const uint32_t lc = r.get<uint32_t>();
+							RomFields::ListData_t *const list_data = r.getListData();
+							if (list_data) {
+								multi->emplace(lc, std::move(*list_data));
+								delete list_data;
+							}
+						}
+						params.data.multi = multi;
+					}
+				} else {
+					params.data.single = r.getListData();
+				}
+
+				if (params.flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+					params.mxd.checkboxes = r.get<uint32_t>();
+				} else if (params.flags & RomFields::RFT_LISTDATA_ICONS) {
+					const uint32_t iconCount = r.getCount(sizeof(uint32_t));
+					RomFields::ListDataIcons_t *const icons = new RomFields::ListDataIcons_t();
+					if (iconCount != NULL_STR) {
+						icons->resize(iconCount);
+						for (uint32_t row = 0; row < iconCount && r.isOk(); row++) {
+							rp_image *const icon = r.getImage();
+							if (icon) {
+								d->listIcons.emplace_back(icon);
+							}
+							(*icons)[row] = icon;
+						}
+					}
+					params.mxd.icons = icons;
+				}
+
+				// NOTE: RomFields takes ownership of the headers,
+				// data, and icons vector, even if a read error
+				// occurred, so they'll be deleted properly.
+				fields->addField_listData(name.c_str(), &params);
+				break;
+			}
+
+			case RomFields::RFT_DATETIME: {
+				const unsigned int flags = r.get<uint32_t>();
+				const time_t date_time = static_cast<time_t>(r.get<int64_t>());
+				fields->addField_dateTime(name.c_str(), date_time, flags);
+				break;
+			}
+
+			case RomFields::RFT_AGE_RATINGS: {
+				if (r.get<uint8_t>() == 0) {
+					// No age ratings.
+					break;
+				}
+				RomFields::age_ratings_t age_ratings;
+				for (uint16_t &rating : age_ratings) {
+					rating = r.get<uint16_t>();
+				}
+				fields->addField_ageRatings(name.c_str(), age_ratings);
+				break;
+			}
+
+			case RomFields::RFT_DIMENSIONS: {
+				const int dimX = r.get<int32_t>();
+				const int dimY = r.get<int32_t>();
+				const int dimZ = r.get<int32_t>();
+				fields->addField_dimensions(name.c_str(), dimX, dimY, dimZ);
+				break;
+			}
+
+			case RomFields::RFT_STRING_MULTI: {
+				const unsigned int flags = r.get<uint32_t>();
+				const uint32_t lcCount = r.getCount(sizeof(uint32_t) * 2);
+				if (lcCount == NULL_STR || !r.isOk()) {
+					// No strings.
+					break;
+				}
+				RomFields::StringMultiMap_t *const str_multi = new RomFields::StringMultiMap_t();
+				for (uint32_t j = 0; j < lcCount && r.isOk(); j++) {
+					const uint32_t lc = r.get<uint32_t>();
+					r.getStr(str);
+					str_multi->emplace(lc, str);
+				}
+				fields->addField_string_multi(name.c_str(), str_multi, def_lc, flags);
+				break;
+			}
+		}
+	}
+
+	return (r.isOk() ? 0 : -EIO);
+}
+
+/**
+ * Serialize RomMetaData.
+ * @param w		[in] BlobWriter
+ * @param metaData	[in] RomMetaData (may be nullptr)
+ */
+static void serializeMetaData(BlobWriter &w, const RomMetaData *metaData)
+{
+	const int count = (metaData ? metaData->count() : 0);
+	w.put<uint32_t>(static_cast<uint32_t>(count));
+	for (int i = 0; i < count; i++) {
+		const RomMetaData::MetaData *const prop = metaData->prop(i);
+		w.put<int8_t>(static_cast<int8_t>(prop->name));
+		w.put<uint8_t>(static_cast<uint8_t>(prop->type));
+		switch (prop->type) {
+			default:
+				// Invalid type. Store it as 0.
+				assert(!"Unsupported RomMetaData PropertyType.");
+				w.put<int64_t>(0);
+				break;
+			case PropertyType::Integer:
+				w.put<int64_t>(prop->data.ivalue);
+				break;
+			case PropertyType::UnsignedInteger:
+				w.put<int64_t>(prop->data.uvalue);
+				break;
+			case PropertyType::Timestamp:
+				w.put<int64_t>(static_cast<int64_t>(prop->data.timestamp));
+				break;
+			case PropertyType::String:
+				if (prop->data.str) {
+					w.putStr(*prop->data.str);
+				} else {
+					w.putStr(nullptr);
+				}
+				break;
+		}
+	}
+}
+
+/**
+ * Deserialize RomMetaData.
+ * @param r	[in] BlobReader
+ * @param d	[in,out] CachedRomDataPrivate
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int deserializeMetaData(BlobReader &r, CachedRomDataPrivate *d)
+{
+	const uint32_t count = r.getCount(2 + sizeof(uint32_t));
+	if (!r.isOk() || count == NULL_STR)
+		return -EIO;
+	if (count == 0) {
+		// No metadata.
+		return 0;
+	}
+
+	RomMetaData *const metaData = new RomMetaData();
+	d->metaData = metaData;
+	metaData->reserve(static_cast<int>(count));
+
+	string str;
+	for (uint32_t i = 0; i < count && r.isOk(); i++) {
+		const Property name = static_cast<Property>(r.get<int8_t>());
+		const PropertyType type = static_cast<PropertyType>(r.get<uint8_t>());
+		switch (type) {
+			default:
+				// Invalid type.
+				r.get<int64_t>();
+				break;
+			case PropertyType::Integer:
+				metaData->addMetaData_integer(name, static_cast<int>(r.get<int64_t>()));
+				break;
+			case PropertyType::UnsignedInteger:
+				metaData->addMetaData_uint(name, static_cast<unsigned int>(r.get<int64_t>()));
+				break;
+			case PropertyType::Timestamp:
+				metaData->addMetaData_timestamp(name, static_cast<time_t>(r.get<int64_t>()));
+				break;
+			case PropertyType::String:
+				if (r.getStr(str)) {
+					metaData->addMetaData_string(name, str);
+				}
+				break;
+		}
+	}
+
+	return (r.isOk() ? 0 : -EIO);
+}
+
+}
+
+/** CachedRomDataPrivate **/
+
+CachedRomDataPrivate::CachedRomDataPrivate(CachedRomData *q, const char *filename)
+	: super(q, nullptr)
+	, hasDangerousPermissions(false)
+	, imgbf(0)
+{
+	if (filename) {
+		this->filename = filename;
+	}
+	memset(hasSystemName, 0, sizeof(hasSystemName));
+	memset(imgpf, 0, sizeof(imgpf));
+	memset(img, 0, sizeof(img));
+}
+
+CachedRomDataPrivate::~CachedRomDataPrivate()
+{
+	for (rp_image *p : img) {
+		if (p) {
+			p->unref();
+		}
+	}
+	for (rp_image *p : listIcons) {
+		p->unref();
+	}
+}
+
+/** CachedRomData **/
+
+/**
+ * Create an empty CachedRomData object.
+ * Use deserialize() to create a CachedRomData object.
+ * @param filename Filename of the original file (UTF-8)
+ */
+CachedRomData::CachedRomData(const char *filename)
+	: super(new CachedRomDataPrivate(this, filename))
+{ }
+
+/**
+ * Serialize a RomData object's fields, metadata, and internal images.
+ *
+ * The fields, metadata, and internal images are loaded if they
+ * haven't been loaded yet, so the RomData object's file must be open.
+ *
+ * @param romData	[in] RomData object
+ * @param buf		[out] Serialized data
+ * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if romData can't be cached)
+ */
+int CachedRomData::serialize(const RomData *romData, vector<uint8_t> &buf)
+{
+	using namespace CachedRomDataSerial;
+	assert(romData != nullptr);
+	if (!romData || !romData->isValid())
+		return -EINVAL;
+
+	// Check the internal images first, since files with
+	// animated icons or large images can't be cached.
+	const uint32_t imgbf = romData->supportedImageTypes() &
+		((1U << (IMG_INT_MAX + 1)) - (1U << IMG_INT_MIN));
+	if ((imgbf & IMGBF_INT_ICON) && (romData->imgpf(IMG_INT_ICON) & IMGPF_ICON_ANIMATED) &&
+	    romData->iconAnimData() != nullptr)
+	{
+		// Animated icons aren't cached.
+		return -ENOTSUP;
+	}
+
+	const rp_image *imgs[IMG_INT_MAX - IMG_INT_MIN + 1];
+	for (int i = IMG_INT_MIN; i <= IMG_INT_MAX; i++) {
+		const rp_image *img = nullptr;
+		if (imgbf & (1U << i)) {
+			img = romData->image(static_cast<ImageType>(i));
+			if (img && (img->width() > CachedRomDataPrivate::MAX_IMAGE_DIM ||
+			            img->height() > CachedRomDataPrivate::MAX_IMAGE_DIM))
+			{
+				// Image is too large.
+				return -ENOTSUP;
+			}
+		}
+		imgs[i - IMG_INT_MIN] = img;
+	}
+
+	buf.clear();
+	BlobWriter w(buf);
+
+	// Class information.
+	w.putStr(romData->className());
+	w.putStr(romData->mimeType());
+	w.put<uint8_t>(static_cast<uint8_t>(romData->fileType()));
+	w.put<uint8_t>(romData->hasDangerousPermissions() ? 1 : 0);
+
+	// System names.
+	for (unsigned int region = 0; region <= SYSNAME_REGION_ROM_LOCAL; region += SYSNAME_REGION_ROM_LOCAL) {
+		for (unsigned int type = SYSNAME_TYPE_LONG; type <= SYSNAME_TYPE_ABBREVIATION; type++) {
+			w.putStr(romData->systemName(type | region));
+		}
+	}
+
+	// Fields and metadata.
+	int ret = serializeFields(w, romData->fields());
+	if (ret != 0)
+		return ret;
+	serializeMetaData(w, romData->metaData());
+
+	// Internal images.
+	w.put<uint32_t>(imgbf);
+	for (int i = IMG_INT_MIN; i <= IMG_INT_MAX; i++) {
+		if (!(imgbf & (1U << i)))
+			continue;
+		w.put<uint32_t>(romData->imgpf(static_cast<ImageType>(i)));
+		ret = w.putImage(imgs[i - IMG_INT_MIN]);
+		if (ret != 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * Create a CachedRomData object from serialized data.
+ * @param filename	[in] Filename of the original file (UTF-8)
+ * @param data		[in] Serialized data, from serialize()
+ * @param size		[in] Size of data
+ * @return CachedRomData object, or nullptr on error.
+ */
+CachedRomData *CachedRomData::deserialize(const char *filename, const uint8_t *data, size_t size)
+{
+	using namespace CachedRomDataSerial;
+	assert(data != nullptr);
+	if (!data || size == 0)
+		return nullptr;
+
+	CachedRomData *const romData = new CachedRomData(filename);
+	CachedRomDataPrivate *const d = static_cast<CachedRomDataPrivate*>(romData->d_ptr);
+	BlobReader r(data, size);
+
+	// Class information.
+	r.getStr(d->s_className);
+	const bool hasMimeType = r.getStr(d->s_mimeType);
+	const uint8_t fileType = r.get<uint8_t>();
+	d->hasDangerousPermissions = !!r.get<uint8_t>();
+	d->className = (!d->s_className.empty() ? d->s_className.c_str() : nullptr);
+	d->mimeType = (hasMimeType ? d->s_mimeType.c_str() : nullptr);
+	d->fileType = (fileType < static_cast<uint8_t>(FileType::Max))
+		? static_cast<FileType>(fileType)
+		: FileType::Unknown;
+
+	// System names.
+	for (unsigned int i = 0; i < ARRAY_SIZE(d->s_systemNames); i++) {
+		d->hasSystemName[i] = r.getStr(d->s_systemNames[i]);
+	}
+
+	// Fields and metadata.
+	int ret = deserializeFields(r, d);
+	if (ret == 0) {
+		ret = deserializeMetaData(r, d);
+	}
+
+	// Internal images.
+	if (ret == 0) {
+		d->imgbf = r.get<uint32_t>() & ((1U << (IMG_INT_MAX + 1)) - (1U << IMG_INT_MIN));
+		for (int i = IMG_INT_MIN; i <= IMG_INT_MAX && r.isOk(); i++) {
+			if (!(d->imgbf & (1U << i)))
+				continue;
+			d->imgpf[i - IMG_INT_MIN] = r.get<uint32_t>();
+			d->img[i - IMG_INT_MIN] = r.getImage();
+		}
+	}
+
+	if (ret != 0 || !r.isOk() || r.remaining() != 0) {
+		// Invalid data.
+		romData->unref();
+		return nullptr;
+	}
+
+	d->isValid = true;
+	return romData;
+}
+
+/**
+ * Is a ROM image supported by this object?
+ * CachedRomData objects can't be used for detection.
+ * @param info DetectInfo containing ROM detection information.
+ * @return -1
+ */
+int CachedRomData::isRomSupported(const DetectInfo *info) const
+{
+	RP_UNUSED(info);
+	return -1;
+}
+
+/**
+ * Get the name of the system the loaded ROM is designed for.
+ * @param type System name type. (See the SystemName enum.)
+ * @return System name, or nullptr if type is invalid.
+ */
+const char *CachedRomData::systemName(unsigned int type) const
+{
+	RP_D(const CachedRomData);
+	if (!d->isValid || !isSystemNameTypeValid(type))
+		return nullptr;
+
+	const unsigned int idx = CachedRomDataPrivate::sysNameIndex(type);
+	return (d->hasSystemName[idx] ? d->s_systemNames[idx].c_str() : nullptr);
+}
+
+/**
+ * Get a list of all supported file extensions.
+ * CachedRomData objects aren't registered for any extensions.
+ * @return nullptr
+ */
+const char *const *CachedRomData::supportedFileExtensions(void) const
+{
+	return nullptr;
+}
+
+/**
+ * Get a list of all supported MIME types.
+ * CachedRomData objects aren't registered for any MIME types.
+ * @return nullptr
+ */
+const char *const *CachedRomData::supportedMimeTypes(void) const
+{
+	return nullptr;
+}
+
+/**
+ * Get a bitfield of image types this object can retrieve.
+ * Only internal images that were cached are included.
+ * @return Bitfield of supported image types. (ImageTypesBF)
+ */
+uint32_t CachedRomData::supportedImageTypes(void) const
+{
+	RP_D(const CachedRomData);
+	return d->imgbf;
+}
+
+/**
+ * Get image processing flags.
+ * @param imageType Image type.
+ * @return Bitfield of ImageProcessingBF operations to perform.
+ */
+uint32_t CachedRomData::imgpf(ImageType imageType) const
+{
+	ASSERT_imgpf(imageType);
+	if (imageType < IMG_INT_MIN || imageType > IMG_INT_MAX)
+		return 0;
+
+	// Animated icons aren't cached.
+	RP_D(const CachedRomData);
+	return d->imgpf[imageType - IMG_INT_MIN] & ~IMGPF_ICON_ANIMATED;
+}
+
+/**
+ * Load an internal image.
+ * Called by RomData::image().
+ * @param imageType	[in] Image type to load.
+ * @param pImage	[out] Pointer to const rp_image* to store the image in.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CachedRomData::loadInternalImage(ImageType imageType, const rp_image **pImage)
+{
+	ASSERT_loadInternalImage(imageType, pImage);
+
+	RP_D(const CachedRomData);
+	if (!(d->imgbf & (1U << imageType))) {
+		// Image type isn't cached.
+		*pImage = nullptr;
+		return -ENOENT;
+	}
+
+	*pImage = d->img[imageType - IMG_INT_MIN];
+	return (*pImage ? 0 : -EIO);
+}
+
+/**
+ * Does this ROM image have "dangerous" permissions?
+ * @return True if the ROM image has "dangerous" permissions; false if not.
+ */
+bool CachedRomData::hasDangerousPermissions(void) const
+{
+	RP_D(const CachedRomData);
+	return d->hasDangerousPermissions;
+}
+
+/**
+ * Load field data.
+ * Fields are loaded by deserialize(), so this does nothing.
+ * @return 0
+ */
+int CachedRomData::loadFieldData(void)
+{
+	return 0;
+}
+
+/**
+ * Load metadata properties.
+ * Metadata is loaded by deserialize(), so this does nothing.
+ * @return 0
+ */
+int CachedRomData::loadMetaData(void)
+{
+	return 0;
+}
+
+}
@@ -0,0 +1,143 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CachedRomData.hpp: RomData object loaded from the parsed-result cache.  *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_CACHEDROMDATA_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_CACHEDROMDATA_HPP__
+
+#include "librpbase/RomData.hpp"
+
+// C++ includes.
+#include <vector>
+
+namespace LibRomData {
+
+/**
+ * RomData object that serves previously-parsed fields, metadata,
+ * and internal images without opening the original file.
+ *
+ * Objects are created by ParsedResultCache from data serialized
+ * with serialize(). External images, animated icons, and ROM
+ * operations aren't available.
+ */
+class CachedRomDataPrivate;
+class CachedRomData final : public LibRpBase::RomData
+{
+	private:
+		/**
+		 * Create an empty CachedRomData object.
+		 * Use deserialize() to create a CachedRomData object.
+		 * @param filename Filename of the original file (UTF-8)
+		 */
+		explicit CachedRomData(const char *filename);
+	protected:
+		virtual ~CachedRomData() { }
+	private:
+		typedef RomData super;
+		friend class CachedRomDataPrivate;
+		RP_DISABLE_COPY(CachedRomData);
+
+	public:
+		/**
+		 * Serialize a RomData object's fields, metadata, and internal images.
+		 *
+		 * The fields, metadata, and internal images are loaded if they
+		 * haven't been loaded yet, so the RomData object's file must be open.
+		 *
+		 * @param romData	[in] RomData object
+		 * @param buf		[out] Serialized data
+		 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if romData can't be cached)
+		 */
+		static int serialize(const LibRpBase::RomData *romData, std::vector<uint8_t> &buf);
+
+		/**
+		 * Create a CachedRomData object from serialized data.
+		 * @param filename	[in] Filename of the original file (UTF-8)
+		 * @param data		[in] Serialized data, from serialize()
+		 * @param size		[in] Size of data
+		 * @return CachedRomData object, or nullptr on error.
+		 */
+		static CachedRomData *deserialize(const char *filename, const uint8_t *data, size_t size);
+
+	public:
+		/**
+		 * Is a ROM image supported by this object?
+		 * CachedRomData objects can't be used for detection.
+		 * @param info DetectInfo containing ROM detection information.
+		 * @return -1
+		 */
+		int isRomSupported(const DetectInfo *info) const final;
+
+		/**
+		 * Get the name of the system the loaded ROM is designed for.
+		 * @param type System name type. (See the SystemName enum.)
+		 * @return System name, or nullptr if type is invalid.
+		 */
+		const char *systemName(unsigned int type) const final;
+
+		/**
+		 * Get a list of all supported file extensions.
+		 * CachedRomData objects aren't registered for any extensions.
+		 * @return nullptr
+		 */
+		const char *const *supportedFileExtensions(void) const final;
+
+		/**
+		 * Get a list of all supported MIME types.
+		 * CachedRomData objects aren't registered for any MIME types.
+		 * @return nullptr
+		 */
+		const char *const *supportedMimeTypes(void) const final;
+
+		/**
+		 * Get a bitfield of image types this object can retrieve.
+		 * Only internal images that were cached are included.
+		 * @return Bitfield of supported image types. (ImageTypesBF)
+		 */
+		uint32_t supportedImageTypes(void) const final;
+
+		/**
+		 * Get image processing flags.
+		 * @param imageType Image type.
+		 * @return Bitfield of ImageProcessingBF operations to perform.
+		 */
+		uint32_t imgpf(ImageType imageType) const final;
+
+		/**
+		 * Load an internal image.
+		 * Called by RomData::image().
+		 * @param imageType	[in] Image type to load.
+		 * @param pImage	[out] Pointer to const rp_image* to store the image in.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadInternalImage(ImageType imageType, const LibRpTexture::rp_image **pImage) final;
+
+		/**
+		 * Does this ROM image have "dangerous" permissions?
+		 * @return True if the ROM image has "dangerous" permissions; false if not.
+		 */
+		bool hasDangerousPermissions(void) const final;
+
+	protected:
+		/**
+		 * Load field data.
+		 * Fields are loaded by deserialize(), so this does nothing.
+		 * @return 0
+		 */
+		int loadFieldData(void) final;
+
+		/**
+		 * Load metadata properties.
+		 * Metadata is loaded by deserialize(), so this does nothing.
+		 * @return 0
+		 */
+		int loadMetaData(void) final;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_CACHEDROMDATA_HPP__ */
@@ -8,6 +8,7 @@
 
 #include "stdafx.h"
 #include "DreamcastSave.hpp"
+#include "MemCardScanner.hpp"
 #include "dc_structs.h"
 
 // librpbase, librpfile, librptexture
@@ -125,6 +126,14 @@ class DreamcastSavePrivate final : public RomDataPrivate
 		 */
 		int readVmiHeader(IRpFile *vmi_file);
 
+		/**
+		 * Read and verify the save file headers.
+		 * This function sets saveType, data_area_offset, and the loaded headers.
+		 * @param vmi_file VMI file for a .VMI+.VMS pair, or nullptr to detect the save type from this->file.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readHeaders(IRpFile *vmi_file);
+
 		// Graphic eyecatch sizes.
 		static const uint32_t eyecatch_sizes[4];
 
@@ -152,8 +161,8 @@ class DreamcastSavePrivate final : public RomDataPrivate
 		/**
 		 * Load the save file's icons.
 		 *
-		 * This will load all of the animated icon frames,
-		 * though only the first frame will be returned.
+		 * This will load the raw data for all of the animated icon frames,
+		 * though only the first frame will be decoded and returned.
 		 *
 		 * @return Icon, or nullptr on error.
 		 */
@@ -404,11 +413,50 @@ int DreamcastSavePrivate::readVmiHeader(IRpFile *vmi_file)
 	return 0;
 }
 
+/**
+ * Frame decoder for VMS icons.
+ */
+class DC_VmsIconFrameDecoder : public IconAnimData::FrameDecoder
+{
+	public:
+		DC_VmsIconFrameDecoder() { }
+
+	public:
+		// VMU files have a maximum of 3 frames.
+		static const int MAX_ICONS = 3;
+
+		// NOTE: DCI byteswapping must be applied before decoding.
+		union {
+			uint16_t u16[DC_VMS_ICON_PALETTE_SIZE >> 1];
+			uint32_t u32[DC_VMS_ICON_PALETTE_SIZE >> 2];
+		} palette;
+		union {
+			uint8_t   u8[DC_VMS_ICON_DATA_SIZE * MAX_ICONS];
+			uint32_t u32[(DC_VMS_ICON_DATA_SIZE * MAX_ICONS) >> 2];
+		} icon_color;
+
+	public:
+		/**
+		 * Decode a frame.
+		 * @param idx Frame index.
+		 * @return Decoded frame, or nullptr if the frame is empty or invalid.
+		 */
+		rp_image *decodeFrame(int idx) final
+		{
+			assert(idx >= 0 && idx < MAX_ICONS);
+			return ImageDecoder::fromLinearCI4(
+				ImageDecoder::PixelFormat::ARGB4444, true,
+				DC_VMS_ICON_W, DC_VMS_ICON_H,
+				&icon_color.u8[idx * DC_VMS_ICON_DATA_SIZE], DC_VMS_ICON_DATA_SIZE,
+				palette.u16, sizeof(palette.u16));
+		}
+};
+
 /**
  * Load the save file's icons.
  *
- * This will load all of the animated icon frames,
- * though only the first frame will be returned.
+ * This will load the raw data for all of the animated icon frames,
+ * though only the first frame will be decoded and returned.
  *
  * @return Icon, or nullptr on error.
  */
@@ -416,7 +464,7 @@ const rp_image *DreamcastSavePrivate::loadIcon(void)
 {
 	if (iconAnimData) {
 		// Icon has already been loaded.
-		return iconAnimData->frames[0];
+		return iconAnimData->frame(0);
 	} else if (!this->file || !this->isValid) {
 		// Can't load the icon.
 		return nullptr;
@@ -432,10 +480,10 @@ const rp_image *DreamcastSavePrivate::loadIcon(void)
 	if (icon_count == 0) {
 		// No icon.
 		return nullptr;
-	} else if (icon_count > 3) {
+	} else if (icon_count > DC_VmsIconFrameDecoder::MAX_ICONS) {
 		// VMU files have a maximum of 3 frames.
 		// Truncate the frame count.
-		icon_count = 3;
+		icon_count = DC_VmsIconFrameDecoder::MAX_ICONS;
 	}
 
 	// Sanity check: Each icon is 512 bytes, plus a 32-byte palette.
@@ -452,57 +500,42 @@ const rp_image *DreamcastSavePrivate::loadIcon(void)
 		return nullptr;
 	}
 
-	// Temporary icon buffer.
-	VmsIcon_buf_t buf;
+	// Frames are decoded on demand, since thumbnailers
+	// usually only need the first frame.
+	DC_VmsIconFrameDecoder *const decoder = new DC_VmsIconFrameDecoder();
 
 	// Load the palette.
 	size_t size = file->seekAndRead(vms_header_offset + static_cast<uint32_t>(sizeof(vms_header)),
-					buf.palette.u16, sizeof(buf.palette.u16));
-	if (size != sizeof(buf.palette.u16)) {
+					decoder->palette.u16, sizeof(decoder->palette.u16));
+	if (size != sizeof(decoder->palette.u16)) {
 		// Seek and/or read error.
+		delete decoder;
 		return nullptr;
 	}
 
+	// Load the icons. (32x32, 4bpp)
+	// Icons are stored contiguously immediately after the palette.
+	size = file->read(decoder->icon_color.u8, icon_count * DC_VMS_ICON_DATA_SIZE);
+	icon_count = static_cast<uint16_t>(size / DC_VMS_ICON_DATA_SIZE);
+
 	if (this->saveType == SaveType::DCI) {
-		// Apply 32-bit byteswapping to the palette.
-		__byte_swap_32_array(buf.palette.u32, sizeof(buf.palette.u32));
+		// Apply 32-bit byteswapping to the palette and icons.
+		__byte_swap_32_array(decoder->palette.u32, sizeof(decoder->palette.u32));
+		__byte_swap_32_array(decoder->icon_color.u32, icon_count * DC_VMS_ICON_DATA_SIZE);
 	}
 
 	this->iconAnimData = new IconAnimData();
-	iconAnimData->count = 0;
+	iconAnimData->count = icon_count;
 
 	// icon_anim_speed is in units of 1/30th of a second.
 	const IconAnimData::delay_t delay = {
 		vms_header.icon_anim_speed, 30,
 		(vms_header.icon_anim_speed * 100) / 30
 	};
-
-	// Load the icons. (32x32, 4bpp)
-	// Icons are stored contiguously immediately after the palette.
 	for (int i = 0; i < icon_count; i++) {
-		size = file->read(buf.icon_color.u8, sizeof(buf.icon_color.u8));
-		if (size != sizeof(buf.icon_color)) {
-			// Read error.
-			break;
-		}
-
-		if (this->saveType == SaveType::DCI) {
-			// Apply 32-bit byteswapping to the palette.
-			__byte_swap_32_array(buf.icon_color.u32, sizeof(buf.icon_color.u32));
-		}
-
 		iconAnimData->delays[i] = delay;
-		iconAnimData->frames[i] = ImageDecoder::fromLinearCI4(
-			ImageDecoder::PixelFormat::ARGB4444, true,
-			DC_VMS_ICON_W, DC_VMS_ICON_H,
-			buf.icon_color.u8, sizeof(buf.icon_color.u8),
-			buf.palette.u16, sizeof(buf.palette.u16));
-		if (!iconAnimData->frames[i])
-			break;
-
-		// Icon loaded.
-		iconAnimData->count++;
 	}
+	iconAnimData->setFrameDecoder(decoder);
 
 	// NOTE: We're not deleting iconAnimData even if we only have
 	// a single icon because iconAnimData() will call loadIcon()
@@ -515,7 +548,7 @@ const rp_image *DreamcastSavePrivate::loadIcon(void)
 	iconAnimData->seq_count = iconAnimData->count;
 
 	// Return the first frame.
-	return iconAnimData->frames[0];
+	return iconAnimData->frame(0);
 }
 
 /**
@@ -530,7 +563,7 @@ const rp_image *DreamcastSavePrivate::loadIcon_ICONDATA_VMS(void)
 {
 	if (iconAnimData) {
 		// Icon has already been loaded.
-		return iconAnimData->frames[0];
+		return iconAnimData->frame(0);
 	} else if (!this->file || !this->isValid) {
 		// Can't load the icon.
 		return nullptr;
@@ -734,109 +767,124 @@ const rp_image *DreamcastSavePrivate::loadBanner(void)
 /** DreamcastSave **/
 
 /**
- * Read a Sega Dreamcast save file.
- *
- * A save file must be opened by the caller. The file handle
- * will be ref()'d and must be kept open in order to load
- * data from the disc image.
- *
- * To close the file, either delete this object or call close().
- *
- * NOTE: Check isValid() to determine if this is a valid save file.
- *
- * @param file Open disc image.
+ * Read and verify the save file headers.
+ * This function sets saveType, data_area_offset, and the loaded headers.
+ * @param vmi_file VMI file for a .VMI+.VMS pair, or nullptr to detect the save type from this->file.
+ * @return 0 on success; negative POSIX error code on error.
  */
-DreamcastSave::DreamcastSave(IRpFile *file)
-	: super(new DreamcastSavePrivate(this, file))
+int DreamcastSavePrivate::readHeaders(IRpFile *vmi_file)
 {
-	// This class handles save files.
-	RP_D(DreamcastSave);
-	d->className = "DreamcastSave";
-	d->fileType = FileType::SaveFile;
+	// NOTE: vmi_file shadows this->vmi_file.
+	if (vmi_file) {
+		// .VMI+.VMS pair.
+		// Sanity check:
+		// - VMS file should be a multiple of 512 bytes,
+		//   or 160 bytes for some monochrome ICONDATA_VMS.
+		// - VMI file should be 108 bytes.
+		const off64_t vms_fileSize = file->size();
+		const off64_t vmi_fileSize = vmi_file->size();
+		if (((vms_fileSize % 512 != 0) && vms_fileSize != DC_VMS_ICONDATA_MONO_MINSIZE) ||
+		      vmi_fileSize != sizeof(DC_VMI_Header))
+		{
+			// Invalid file(s).
+			return -EIO;
+		}
 
-	if (!d->file) {
-		// Could not ref() the file handle.
-		return;
-	}
+		// Initialize the save type and data area offset.
+		saveType = SaveType::VMS;
+		data_area_offset = DATA_AREA_OFFSET_VMS;
 
-	static_assert(DC_VMS_ICON_PALETTE_SIZE == 32,
-		"DC_VMS_ICON_PALETTE_SIZE is wrong. (Should be 32.)");
-	static_assert(DC_VMS_ICON_DATA_SIZE == 512,
-		"DC_VMS_ICON_DATA_SIZE is wrong. (Should be 512.)");
+		// Read the VMI header and copy it to the directory entry.
+		// TODO: Verify that the file size from vmi_header matches
+		// the actual VMS file size? (also vms_dirent.address)
+		int ret = readVmiHeader(vmi_file);
+		if (ret != 0) {
+			// Error reading the VMI header.
+			return ret;
+		}
 
-	static_assert(DC_VMS_EYECATCH_ARGB4444_DATA_SIZE == 8064,
-		"DC_VMS_EYECATCH_ARGB4444_DATA_SIZE is wrong. (Should be 8,064.)");
-	static_assert(DC_VMS_EYECATCH_CI8_PALETTE_SIZE + DC_VMS_EYECATCH_CI8_DATA_SIZE == 4544,
-		"DC_VMS_EYECATCH_CI8_PALETTE_SIZE + DC_VMS_EYECATCH_CI8_DATA_SIZE is wrong. (Should be 4,544.)");
-	static_assert(DC_VMS_EYECATCH_CI4_PALETTE_SIZE + DC_VMS_EYECATCH_CI4_DATA_SIZE == 2048,
-		"DC_VMS_EYECATCH_CI4_PALETTE_SIZE + DC_VMS_EYECATCH_CI4_DATA_SIZE is wrong. (Should be 2,048.)");
+		// Is this ICONDATA_VMS?
+		if (!strncmp(vms_dirent.filename, "ICONDATA_VMS", sizeof(vms_dirent.filename))) {
+			// This is ICONDATA_VMS.
+			loaded_headers |= DC_IS_ICONDATA_VMS;
+		} else {
+			// Load the VMS header.
+			// Use the header address specified in the directory entry.
+			unsigned int headerLoaded = readAndVerifyVmsHeader(
+				data_area_offset + (vms_dirent.header_addr * DC_VMS_BLOCK_SIZE));
+			if (headerLoaded != DC_HAVE_UNKNOWN) {
+				// Valid VMS header.
+				loaded_headers |= headerLoaded;
+			} else {
+				// Not valid.
+				return -EIO;
+			}
+		}
+		return 0;
+	}
 
 	// Determine the VMS save type by checking the file size.
 	// Standard VMS is always a multiple of DC_VMS_BLOCK_SIZE.
 	// DCI is a multiple of DC_VMS_BLOCK_SIZE, plus 32 bytes.
 	// NOTE: May be DC_VMS_ICONDATA_MONO_MINSIZE for ICONDATA_VMS.
-	const off64_t fileSize = d->file->size();
+	const off64_t fileSize = file->size();
 	if (fileSize % DC_VMS_BLOCK_SIZE == 0 ||
 	    fileSize == DC_VMS_ICONDATA_MONO_MINSIZE)
 	{
 		// VMS file.
-		d->saveType = DreamcastSavePrivate::SaveType::VMS;
-		d->data_area_offset = DreamcastSavePrivate::DATA_AREA_OFFSET_VMS;
+		saveType = SaveType::VMS;
+		data_area_offset = DATA_AREA_OFFSET_VMS;
 	}
 	else if ((fileSize - 32) % DC_VMS_BLOCK_SIZE == 0 ||
 		 (fileSize - 32) == DC_VMS_ICONDATA_MONO_MINSIZE)
 	{
-		d->saveType = DreamcastSavePrivate::SaveType::DCI;
-		d->data_area_offset = DreamcastSavePrivate::DATA_AREA_OFFSET_DCI;
+		saveType = SaveType::DCI;
+		data_area_offset = DATA_AREA_OFFSET_DCI;
 
 		// Load the directory entry.
-		d->file->rewind();
-		size_t size = d->file->read(&d->vms_dirent, sizeof(d->vms_dirent));
-		if (size != sizeof(d->vms_dirent)) {
+		file->rewind();
+		size_t size = file->read(&vms_dirent, sizeof(vms_dirent));
+		if (size != sizeof(vms_dirent)) {
 			// Read error.
-			UNREF_AND_NULL_NOCHK(d->file);
-			return;
+			return -EIO;
 		}
 
 		// Byteswap the directory entry.
-		d->vms_dirent.address     = le16_to_cpu(d->vms_dirent.address);
-		d->vms_dirent.size        = le16_to_cpu(d->vms_dirent.size);
-		d->vms_dirent.header_addr = le16_to_cpu(d->vms_dirent.header_addr);
+		vms_dirent.address     = le16_to_cpu(vms_dirent.address);
+		vms_dirent.size        = le16_to_cpu(vms_dirent.size);
+		vms_dirent.header_addr = le16_to_cpu(vms_dirent.header_addr);
 
-		d->isGameFile = !!(d->vms_dirent.filetype == DC_VMS_DIRENT_FTYPE_GAME);
-		d->loaded_headers |= DreamcastSavePrivate::DC_HAVE_DIR_ENTRY;
+		isGameFile = !!(vms_dirent.filetype == DC_VMS_DIRENT_FTYPE_GAME);
+		loaded_headers |= DC_HAVE_DIR_ENTRY;
 
 		// Is this ICONDATA_VMS?
-		if (!strncmp(d->vms_dirent.filename, "ICONDATA_VMS", sizeof(d->vms_dirent.filename))) {
+		if (!strncmp(vms_dirent.filename, "ICONDATA_VMS", sizeof(vms_dirent.filename))) {
 			// This is ICONDATA_VMS.
-			d->loaded_headers |= DreamcastSavePrivate::DC_IS_ICONDATA_VMS;
+			loaded_headers |= DC_IS_ICONDATA_VMS;
 		}
 	} else if (fileSize == sizeof(DC_VMI_Header)) {
 		// Standalone VMI file.
-		d->saveType = DreamcastSavePrivate::SaveType::VMI;
-		d->data_area_offset = DreamcastSavePrivate::DATA_AREA_OFFSET_VMS;
+		saveType = SaveType::VMI;
+		data_area_offset = DATA_AREA_OFFSET_VMS;
 
 		// Load the VMI header.
-		int ret = d->readVmiHeader(d->file);
+		int ret = readVmiHeader(file);
 		if (ret != 0) {
 			// Read error.
-			UNREF_AND_NULL_NOCHK(d->file);
-			return;
+			return -EIO;
 		}
 
 		// Nothing else to do here for standalone VMI files.
-		d->mimeType = d->mimeType_tbl[(int)d->saveType];
-		d->isValid = true;
-		return;
+		mimeType = mimeType_tbl[(int)saveType];
+		return 0;
 	} else {
 		// Not valid.
-		d->saveType = DreamcastSavePrivate::SaveType::Unknown;
-		UNREF_AND_NULL_NOCHK(d->file);
-		return;
+		saveType = SaveType::Unknown;
+		return -EIO;
 	}
 
 	// Set the MIME type.
-	d->mimeType = d->mimeType_tbl[(int)d->saveType];
+	mimeType = mimeType_tbl[(int)saveType];
 
 	// TODO: Load both VMI and VMS timestamps?
 	// Currently, only the VMS timestamp is loaded.
@@ -844,46 +892,92 @@ DreamcastSave::DreamcastSave(IRpFile *file)
 	// Read the save file header.
 	// Regular save files have the header in block 0.
 	// Game files have the header in block 1.
-	if (d->loaded_headers & DreamcastSavePrivate::DC_HAVE_DIR_ENTRY) {
+	if (loaded_headers & DC_HAVE_DIR_ENTRY) {
 		// Use the header address specified in the directory entry.
-		unsigned int headerLoaded = d->readAndVerifyVmsHeader(
-			d->data_area_offset + (d->vms_dirent.header_addr * DC_VMS_BLOCK_SIZE));
-		if (headerLoaded != DreamcastSavePrivate::DC_HAVE_UNKNOWN) {
+		unsigned int headerLoaded = readAndVerifyVmsHeader(
+			data_area_offset + (vms_dirent.header_addr * DC_VMS_BLOCK_SIZE));
+		if (headerLoaded != DC_HAVE_UNKNOWN) {
 			// Valid VMS header.
-			d->loaded_headers |= headerLoaded;
+			loaded_headers |= headerLoaded;
 		} else {
 			// Not valid.
-			UNREF_AND_NULL_NOCHK(d->file);
-			return;
+			return -EIO;
 		}
 
 		// Convert the VMS BCD time to Unix time.
-		d->ctime = d->bcd_to_unix_time(
-			reinterpret_cast<const uint8_t*>(&d->vms_dirent.ctime),
-			sizeof(d->vms_dirent.ctime));
+		ctime = bcd_to_unix_time(
+			reinterpret_cast<const uint8_t*>(&vms_dirent.ctime),
+			sizeof(vms_dirent.ctime));
 	} else {
 		// If the VMI file is not available, we'll use a heuristic:
 		// The description fields cannot contain any control
 		// characters other than 0x00 (NULL).
-		unsigned int headerLoaded = d->readAndVerifyVmsHeader(d->data_area_offset);
-		if (headerLoaded != DreamcastSavePrivate::DC_HAVE_UNKNOWN) {
+		unsigned int headerLoaded = readAndVerifyVmsHeader(data_area_offset);
+		if (headerLoaded != DC_HAVE_UNKNOWN) {
 			// Valid in block 0: This is a standard save file.
-			d->isGameFile = false;
-			d->loaded_headers |= headerLoaded;
+			isGameFile = false;
+			loaded_headers |= headerLoaded;
 		} else {
-			headerLoaded = d->readAndVerifyVmsHeader(d->data_area_offset + DC_VMS_BLOCK_SIZE);
-			if (headerLoaded != DreamcastSavePrivate::DC_HAVE_UNKNOWN) {
+			headerLoaded = readAndVerifyVmsHeader(data_area_offset + DC_VMS_BLOCK_SIZE);
+			if (headerLoaded != DC_HAVE_UNKNOWN) {
 				// Valid in block 1: This is a game file.
-				d->isGameFile = true;
-				d->loaded_headers |= headerLoaded;
+				isGameFile = true;
+				loaded_headers |= headerLoaded;
 			} else {
 				// Not valid.
-				UNREF_AND_NULL_NOCHK(d->file);
-				return;
+				return -EIO;
 			}
 		}
 	}
 
+	return 0;
+}
+
+/**
+ * Read a Sega Dreamcast save file.
+ *
+ * A save file must be opened by the caller. The file handle
+ * will be ref()'d and must be kept open in order to load
+ * data from the disc image.
+ *
+ * To close the file, either delete this object or call close().
+ *
+ * NOTE: Check isValid() to determine if this is a valid save file.
+ *
+ * @param file Open disc image.
+ */
+DreamcastSave::DreamcastSave(IRpFile *file)
+	: super(new DreamcastSavePrivate(this, file))
+{
+	// This class handles save files.
+	RP_D(DreamcastSave);
+	d->className = "DreamcastSave";
+	d->fileType = FileType::SaveFile;
+
+	if (!d->file) {
+		// Could not ref() the file handle.
+		return;
+	}
+
+	static_assert(DC_VMS_ICON_PALETTE_SIZE == 32,
+		"DC_VMS_ICON_PALETTE_SIZE is wrong. (Should be 32.)");
+	static_assert(DC_VMS_ICON_DATA_SIZE == 512,
+		"DC_VMS_ICON_DATA_SIZE is wrong. (Should be 512.)");
+
+	static_assert(DC_VMS_EYECATCH_ARGB4444_DATA_SIZE == 8064,
+		"DC_VMS_EYECATCH_ARGB4444_DATA_SIZE is wrong. (Should be 8,064.)");
+	static_assert(DC_VMS_EYECATCH_CI8_PALETTE_SIZE + DC_VMS_EYECATCH_CI8_DATA_SIZE == 4544,
+		"DC_VMS_EYECATCH_CI8_PALETTE_SIZE + DC_VMS_EYECATCH_CI8_DATA_SIZE is wrong. (Should be 4,544.)");
+	static_assert(DC_VMS_EYECATCH_CI4_PALETTE_SIZE + DC_VMS_EYECATCH_CI4_DATA_SIZE == 2048,
+		"DC_VMS_EYECATCH_CI4_PALETTE_SIZE + DC_VMS_EYECATCH_CI4_DATA_SIZE is wrong. (Should be 2,048.)");
+
+	// Read the save file headers.
+	if (d->readHeaders(nullptr) != 0) {
+		// Not a valid save file.
+		UNREF_AND_NULL_NOCHK(d->file);
+		return;
+	}
+
 	// TODO: Verify the file extension and header fields?
 	d->isValid = true;
 }
@@ -925,58 +1019,100 @@ DreamcastSave::DreamcastSave(IRpFile *vms_file, IRpFile *vmi_file)
 		return;
 	}
 
-	// Sanity check:
-	// - VMS file should be a multiple of 512 bytes,
-	//   or 160 bytes for some monochrome ICONDATA_VMS.
-	// - VMI file should be 108 bytes.
-	const off64_t vms_fileSize = d->file->size();
-	const off64_t vmi_fileSize = d->vmi_file->size();
-	if (((vms_fileSize % 512 != 0) && vms_fileSize != DC_VMS_ICONDATA_MONO_MINSIZE) ||
-	      vmi_fileSize != sizeof(DC_VMI_Header))
-	{
-		// Invalid file(s).
+	// Read the save file headers.
+	if (d->readHeaders(d->vmi_file) != 0) {
+		// Not a valid save file.
 		UNREF_AND_NULL_NOCHK(d->vmi_file);
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
 	}
 
-	// Initialize the save type and data area offset.
-	d->saveType = DreamcastSavePrivate::SaveType::VMS;
-	d->data_area_offset = DreamcastSavePrivate::DATA_AREA_OFFSET_VMS;
+	// TODO: Verify the file extension and header fields?
+	d->isValid = true;
+}
+
+/**
+ * Read a save file descriptor without creating a DreamcastSave object.
+ * Icons and eyecatches are not loaded.
+ * @param vms_file	[in] Open .VMS or .DCI save file.
+ * @param vmi_file	[in,opt] Open .VMI file for a .VMI+.VMS pair, or nullptr if not available.
+ * @param pInfo		[out] Save file descriptor. (filenames are not set)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int DreamcastSave::readSaveInfo(IRpFile *vms_file, IRpFile *vmi_file, MemCardSaveInfo *pInfo)
+{
+	assert(vms_file != nullptr);
+	assert(pInfo != nullptr);
+	if (!vms_file || !pInfo) {
+		return -EINVAL;
+	}
 
-	// Read the VMI header and copy it to the directory entry.
-	// TODO: Verify that the file size from vmi_header matches
-	// the actual VMS file size? (also vms_dirent.address)
-	int ret = d->readVmiHeader(d->vmi_file);
+	// NOTE: The private class is only used for parsing.
+	DreamcastSavePrivate d(nullptr, vms_file);
+	if (!d.file) {
+		// Could not ref() the file handle.
+		return -EBADF;
+	}
+	int ret = d.readHeaders(vmi_file);
 	if (ret != 0) {
-		// Error reading the VMI header.
-		UNREF_AND_NULL_NOCHK(d->vmi_file);
-		UNREF_AND_NULL_NOCHK(d->file);
-		return;
+		return ret;
+	} else if (d.saveType == DreamcastSavePrivate::SaveType::VMI) {
+		// Standalone VMI file. There's no save data here.
+		return -EINVAL;
 	}
 
-	// Is this ICONDATA_VMS?
-	if (!strncmp(d->vms_dirent.filename, "ICONDATA_VMS", sizeof(d->vms_dirent.filename))) {
-		// This is ICONDATA_VMS.
-		d->loaded_headers |= DreamcastSavePrivate::DC_IS_ICONDATA_VMS;
+	pInfo->system = MemCardSaveInfo::System::Dreamcast;
+	pInfo->gameID.clear();
+	pInfo->title.clear();
+	pInfo->description.clear();
+	if (d.loaded_headers & DreamcastSavePrivate::DC_IS_ICONDATA_VMS) {
+		// DC ICONDATA_VMS header.
+		const DC_VMS_ICONDATA_Header *const icondata_vms = &d.vms_header.icondata_vms;
+		pInfo->title = cp1252_sjis_to_utf8(
+			icondata_vms->vms_description, sizeof(icondata_vms->vms_description));
+	} else if (d.loaded_headers & DreamcastSavePrivate::DC_HAVE_VMS) {
+		// DC VMS header.
+		const DC_VMS_Header *const vms_header = &d.vms_header;
+		pInfo->title = cp1252_sjis_to_utf8(
+			vms_header->vms_description, sizeof(vms_header->vms_description));
+		pInfo->description = cp1252_sjis_to_utf8(
+			vms_header->dc_description, sizeof(vms_header->dc_description));
+	}
+	trimEnd(pInfo->title);
+	trimEnd(pInfo->description);
+
+	pInfo->timestamp = d.ctime;
+	if (d.loaded_headers & DreamcastSavePrivate::DC_HAVE_DIR_ENTRY) {
+		pInfo->blocks = d.vms_dirent.size;
 	} else {
-		// Load the VMS header.
-		// Use the header address specified in the directory entry.
-		unsigned int headerLoaded = d->readAndVerifyVmsHeader(
-			d->data_area_offset + (d->vms_dirent.header_addr * DC_VMS_BLOCK_SIZE));
-		if (headerLoaded != DreamcastSavePrivate::DC_HAVE_UNKNOWN) {
-			// Valid VMS header.
-			d->loaded_headers |= headerLoaded;
-		} else {
-			// Not valid.
-			UNREF_AND_NULL_NOCHK(d->vmi_file);
-			UNREF_AND_NULL_NOCHK(d->file);
-			return;
-		}
+		pInfo->blocks = static_cast<unsigned int>(
+			(vms_file->size() + DC_VMS_BLOCK_SIZE - 1) / DC_VMS_BLOCK_SIZE);
+	}
+	return 0;
+}
+
+/**
+ * Is a .VMI+.VMS pair supported by this class?
+ * The headers are verified without creating a DreamcastSave object.
+ * @param vms_file Open .VMS save file.
+ * @param vmi_file Open .VMI save file.
+ * @return True if the .VMI+.VMS pair is supported; false if not.
+ */
+bool DreamcastSave::isVmsVmiPairSupported_static(IRpFile *vms_file, IRpFile *vmi_file)
+{
+	assert(vms_file != nullptr);
+	assert(vmi_file != nullptr);
+	if (!vms_file || !vmi_file) {
+		return false;
 	}
 
-	// TODO: Verify the file extension and header fields?
-	d->isValid = true;
+	// NOTE: The private class is only used for parsing.
+	DreamcastSavePrivate d(nullptr, vms_file);
+	if (!d.file) {
+		// Could not ref() the file handle.
+		return false;
+	}
+	return (d.readHeaders(vmi_file) == 0);
 }
 
 /**
@@ -1551,7 +1687,7 @@ int DreamcastSave::loadInternalImage(ImageType imageType, const rp_image **pImag
 				// Return the first icon frame.
 				// NOTE: DC save icon animations are always
 				// sequential, so we can use a shortcut here.
-				*pImage = d->iconAnimData->frames[0];
+				*pImage = d->iconAnimData->frame(0);
 				return 0;
 			}
 			break;
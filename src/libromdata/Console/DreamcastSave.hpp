@@ -13,6 +13,8 @@
 
 namespace LibRomData {
 
+struct MemCardSaveInfo;
+
 ROMDATA_DECL_BEGIN(DreamcastSave)
 
 	public:
@@ -34,6 +36,25 @@ ROMDATA_DECL_BEGIN(DreamcastSave)
 		 */
 		DreamcastSave(LibRpFile::IRpFile *vms_file, LibRpFile::IRpFile *vmi_file);
 
+		/**
+		 * Read a save file descriptor without creating a DreamcastSave object.
+		 * Icons and eyecatches are not loaded.
+		 * @param vms_file	[in] Open .VMS or .DCI save file.
+		 * @param vmi_file	[in,opt] Open .VMI file for a .VMI+.VMS pair, or nullptr if not available.
+		 * @param pInfo		[out] Save file descriptor. (filenames are not set)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int readSaveInfo(LibRpFile::IRpFile *vms_file, LibRpFile::IRpFile *vmi_file, MemCardSaveInfo *pInfo);
+
+		/**
+		 * Is a .VMI+.VMS pair supported by this class?
+		 * The headers are verified without creating a DreamcastSave object.
+		 * @param vms_file Open .VMS save file.
+		 * @param vmi_file Open .VMI save file.
+		 * @return True if the .VMI+.VMS pair is supported; false if not.
+		 */
+		static bool isVmsVmiPairSupported_static(LibRpFile::IRpFile *vms_file, LibRpFile::IRpFile *vmi_file);
+
 ROMDATA_DECL_CLOSE()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
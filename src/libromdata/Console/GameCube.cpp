@@ -43,7 +43,6 @@ using LibRpTexture::rp_image;
 #include "librpbase/TextFuncs_libc.h"
 
 // C++ STL classes.
-using std::array;
 using std::string;
 using std::unique_ptr;
 using std::vector;
@@ -128,7 +127,7 @@ class GameCubePrivate final : public RomDataPrivate
 			off64_t start;		// Starting address, in bytes.
 			off64_t size;		// Estimated partition size, in bytes.
 
-			WiiPartition *partition;	// Partition object.
+			WiiPartition *partition;	// Partition object. (opened on demand)
 			uint32_t type;		// Partition type. (See WiiPartitionType.)
 			uint8_t vg;		// Volume group number.
 			uint8_t pt;		// Partition number.
@@ -148,6 +147,22 @@ class GameCubePrivate final : public RomDataPrivate
 		 */
 		int loadWiiPartitionTables(void);
 
+		/**
+		 * Get the crypto method for Wii partitions on this disc.
+		 * @return Crypto method.
+		 */
+		WiiPartition::CryptoMethod wii_cryptoMethod(void) const;
+
+		/**
+		 * Open a Wii partition from the partition table.
+		 * Partitions are opened on demand, since each partition
+		 * requires reading its partition header, and only the
+		 * update and game partitions are needed for most fields.
+		 * @param entry Partition table entry.
+		 * @return WiiPartition. (owned by the entry)
+		 */
+		WiiPartition *openWiiPartition(WiiPartEntry &entry);
+
 	public:
 		/**
 		 * Get the disc publisher.
@@ -286,21 +301,23 @@ int GameCubePrivate::loadWiiPartitionTables(void)
 	);
 	wiiPtbl.clear();
 
-	// Assuming a maximum of 128 partitions per table.
-	// (This is a rather high estimate.)
-	RVL_VolumeGroupTable vgtbl;
-	array<RVL_PartitionTableEntry, 1024> pt;
-
-	// Read the volume group table.
+	// Read the volume group table and the partition tables.
+	// The partition tables are usually located right after the
+	// volume group table, so read a single block that covers all
+	// of them. Tables outside of this block are read separately.
 	// References:
 	// - https://wiibrew.org/wiki/Wii_Disc#Partitions_information
 	// - http://blog.delroth.net/2011/06/reading-wii-discs-with-python/
-	size_t size = discReader->seekAndRead(RVL_VolumeGroupTable_ADDRESS, &vgtbl, sizeof(vgtbl));
-	if (size != sizeof(vgtbl)) {
+	static const unsigned int PTBL_BLOCK_SIZE = 4096;
+	unique_ptr<uint8_t[]> ptblBlock(new uint8_t[PTBL_BLOCK_SIZE]);
+	const size_t blockSize = discReader->seekAndRead(RVL_VolumeGroupTable_ADDRESS, ptblBlock.get(), PTBL_BLOCK_SIZE);
+	if (blockSize < sizeof(RVL_VolumeGroupTable)) {
 		// Could not read the volume group table.
 		// TODO: Return error from fread()?
 		return -EIO;
 	}
+	const RVL_VolumeGroupTable *const vgtbl =
+		reinterpret_cast<const RVL_VolumeGroupTable*>(ptblBlock.get());
 
 	// Get the size of the disc image.
 	const off64_t discSize = discReader->size();
@@ -309,34 +326,40 @@ int GameCubePrivate::loadWiiPartitionTables(void)
 		return -errno;
 	}
 
-	// Check the crypto and hash method.
-	// TODO: Lookup table instead of branches?
-	unsigned int cryptoMethod = 0;
-	if (discHeader.disc_noCrypto != 0 || (discType & DISC_FORMAT_MASK) == DISC_FORMAT_NASOS) {
-		// No encryption.
-		cryptoMethod |= WiiPartition::CM_UNENCRYPTED;
-	}
-	if (discHeader.hash_verify != 0) {
-		// No hashes.
-		cryptoMethod |= WiiPartition::CM_32K;
-	}
-
 	// Process each volume group.
+	// Assuming a maximum of 1024 partitions per table.
+	// (This is a rather high estimate.)
+	static const unsigned int PTBL_MAX_COUNT = 1024;
+	unique_ptr<RVL_PartitionTableEntry[]> ptExtra;
 	for (unsigned int i = 0; i < 4; i++) {
-		unsigned int count = be32_to_cpu(vgtbl.vg[i].count);
+		unsigned int count = be32_to_cpu(vgtbl->vg[i].count);
 		if (count == 0) {
 			continue;
-		} else if (count > pt.size()) {
-			count = static_cast<unsigned int>(pt.size());
+		} else if (count > PTBL_MAX_COUNT) {
+			count = PTBL_MAX_COUNT;
 		}
 
-		// Read the partition table entries.
-		off64_t pt_addr = static_cast<off64_t>(be32_to_cpu(vgtbl.vg[i].addr)) << 2;
-		static constexpr size_t pt_size = pt.size() * sizeof(pt[0]);
-		size = discReader->seekAndRead(pt_addr, pt.data(), pt_size);
-		if (size != pt_size) {
-			// Error reading the partition table entries.
-			return -EIO;
+		// Get the partition table entries.
+		const off64_t pt_addr = static_cast<off64_t>(be32_to_cpu(vgtbl->vg[i].addr)) << 2;
+		const size_t pt_size = count * sizeof(RVL_PartitionTableEntry);
+		const RVL_PartitionTableEntry *pt;
+		if (pt_addr >= RVL_VolumeGroupTable_ADDRESS &&
+		    pt_addr + static_cast<off64_t>(pt_size) <= static_cast<off64_t>(RVL_VolumeGroupTable_ADDRESS + blockSize))
+		{
+			// The partition table is in the block that was already read.
+			pt = reinterpret_cast<const RVL_PartitionTableEntry*>(
+				&ptblBlock[static_cast<size_t>(pt_addr - RVL_VolumeGroupTable_ADDRESS)]);
+		} else {
+			// Read the partition table entries.
+			if (!ptExtra) {
+				ptExtra.reset(new RVL_PartitionTableEntry[PTBL_MAX_COUNT]);
+			}
+			const size_t size = discReader->seekAndRead(pt_addr, ptExtra.get(), pt_size);
+			if (size != pt_size) {
+				// Error reading the partition table entries.
+				return -EIO;
+			}
+			pt = ptExtra.get();
 		}
 
 		// Process each partition table entry.
@@ -352,43 +375,42 @@ int GameCubePrivate::loadWiiPartitionTables(void)
 		}
 	}
 
-	// Sort partitions by starting address in order to calculate the sizes.
-	std::sort(wiiPtbl.begin(), wiiPtbl.end(),
-		[](const WiiPartEntry &a, const WiiPartEntry &b) {
-			return (a.start < b.start);
-		}
-	);
-
-	// Calculate the size values.
-	// Technically not needed for retail and RVT-R images, but unencrypted
-	// images on RVT-H systems don't have the partition size set in the
-	// partition header.
-	size_t pt_idx;
-	for (pt_idx = 0; pt_idx < wiiPtbl.size()-1; pt_idx++) {
-		wiiPtbl[pt_idx].size = wiiPtbl[pt_idx+1].start - wiiPtbl[pt_idx].size;
-	}
-	// Last partition.
-	wiiPtbl[pt_idx].size = discSize - wiiPtbl[pt_idx].start;
-
-	// Restore the original sorting order. (VG#, then PT#)
-	std::sort(wiiPtbl.begin(), wiiPtbl.end(),
-		[](const WiiPartEntry &a, const WiiPartEntry &b) {
-			return (a.vg < b.vg || a.pt < b.pt);
+	if (!wiiPtbl.empty()) {
+		// Sort partitions by starting address in order to calculate the sizes.
+		std::sort(wiiPtbl.begin(), wiiPtbl.end(),
+			[](const WiiPartEntry &a, const WiiPartEntry &b) {
+				return (a.start < b.start);
+			}
+		);
+
+		// Calculate the size values.
+		// Technically not needed for retail and RVT-R images, but unencrypted
+		// images on RVT-H systems don't have the partition size set in the
+		// partition header.
+		size_t pt_idx;
+		for (pt_idx = 0; pt_idx < wiiPtbl.size()-1; pt_idx++) {
+			wiiPtbl[pt_idx].size = wiiPtbl[pt_idx+1].start - wiiPtbl[pt_idx].start;
 		}
-	);
+		// Last partition.
+		wiiPtbl[pt_idx].size = discSize - wiiPtbl[pt_idx].start;
 
-	// Create the WiiPartition objects.
-	const auto wiiPtbl_end = wiiPtbl.end();
-	for (auto iter = wiiPtbl.begin(); iter != wiiPtbl_end; ++iter) {
-		iter->partition = new WiiPartition(discReader, iter->start, iter->size,
-			(WiiPartition::CryptoMethod)cryptoMethod);
+		// Restore the original sorting order. (VG#, then PT#)
+		std::sort(wiiPtbl.begin(), wiiPtbl.end(),
+			[](const WiiPartEntry &a, const WiiPartEntry &b) {
+				return (a.vg < b.vg || (a.vg == b.vg && a.pt < b.pt));
+			}
+		);
+	}
 
-		if (iter->type == RVL_PT_UPDATE && !updatePartition) {
+	// Open the System Update and Game partitions.
+	// Other partitions are opened on demand.
+	for (WiiPartEntry &entry : wiiPtbl) {
+		if (entry.type == RVL_PT_UPDATE && !updatePartition) {
 			// System Update partition.
-			updatePartition = iter->partition;
-		} else if (iter->type == RVL_PT_GAME && !gamePartition) {
+			updatePartition = openWiiPartition(entry);
+		} else if (entry.type == RVL_PT_GAME && !gamePartition) {
 			// Game partition.
-			gamePartition = iter->partition;
+			gamePartition = openWiiPartition(entry);
 		}
 	}
 
@@ -397,6 +419,42 @@ int GameCubePrivate::loadWiiPartitionTables(void)
 	return 0;
 }
 
+/**
+ * Get the crypto method for Wii partitions on this disc.
+ * @return Crypto method.
+ */
+WiiPartition::CryptoMethod GameCubePrivate::wii_cryptoMethod(void) const
+{
+	// Check the crypto and hash method.
+	// TODO: Lookup table instead of branches?
+	unsigned int cryptoMethod = 0;
+	if (discHeader.disc_noCrypto != 0 || (discType & DISC_FORMAT_MASK) == DISC_FORMAT_NASOS) {
+		// No encryption.
+		cryptoMethod |= WiiPartition::CM_UNENCRYPTED;
+	}
+	if (discHeader.hash_verify != 0) {
+		// No hashes.
+		cryptoMethod |= WiiPartition::CM_32K;
+	}
+	return static_cast<WiiPartition::CryptoMethod>(cryptoMethod);
+}
+
+/**
+ * Open a Wii partition from the partition table.
+ * Partitions are opened on demand, since each partition
+ * requires reading its partition header, and only the
+ * update and game partitions are needed for most fields.
+ * @param entry Partition table entry.
+ * @return WiiPartition. (owned by the entry)
+ */
+WiiPartition *GameCubePrivate::openWiiPartition(WiiPartEntry &entry)
+{
+	if (!entry.partition) {
+		entry.partition = new WiiPartition(discReader, entry.start, entry.size, wii_cryptoMethod());
+	}
+	return entry.partition;
+}
+
 /**
  * Get the disc publisher.
  * @return Disc publisher.
@@ -1087,6 +1145,65 @@ void GameCube::close(void)
 	super::close();
 }
 
+/**
+ * Get the approximate amount of memory used by this object.
+ * @return Approximate memory usage, in bytes.
+ */
+size_t GameCube::memoryUsage(void) const
+{
+	RP_D(const GameCube);
+	size_t total = super::memoryUsage();
+	switch (d->discType & GameCubePrivate::DISC_SYSTEM_MASK) {
+		case GameCubePrivate::DISC_SYSTEM_GCN:
+			if (d->opening_bnr.gcn.partition) {
+				total += d->opening_bnr.gcn.partition->memoryUsage();
+			}
+			if (d->opening_bnr.gcn.data) {
+				total += d->opening_bnr.gcn.data->memoryUsage();
+			}
+			break;
+		case GameCubePrivate::DISC_SYSTEM_WII:
+			for (const auto &entry : d->wiiPtbl) {
+				if (entry.partition) {
+					total += entry.partition->memoryUsage();
+				}
+			}
+			break;
+		default:
+			break;
+	}
+	return total;
+}
+
+/**
+ * Release cached data that can be rebuilt on demand.
+ */
+void GameCube::releaseMemory(void)
+{
+	RP_D(GameCube);
+	switch (d->discType & GameCubePrivate::DISC_SYSTEM_MASK) {
+		case GameCubePrivate::DISC_SYSTEM_GCN:
+			if (d->opening_bnr.gcn.partition) {
+				d->opening_bnr.gcn.partition->releaseMemory();
+			}
+			if (d->opening_bnr.gcn.data) {
+				d->opening_bnr.gcn.data->releaseMemory();
+			}
+			break;
+		case GameCubePrivate::DISC_SYSTEM_WII:
+			// NOTE: The FSTs are reloaded on demand.
+			for (auto &entry : d->wiiPtbl) {
+				if (entry.partition) {
+					entry.partition->releaseMemory();
+				}
+			}
+			break;
+		default:
+			break;
+	}
+	super::releaseMemory();
+}
+
 /** ROM detection functions. **/
 
 /**
@@ -1780,7 +1897,7 @@ int GameCube::loadFieldData(void)
 		auto vv_partitions = new RomFields::ListData_t();
 		vv_partitions->resize(d->wiiPtbl.size());
 
-		auto src_iter = d->wiiPtbl.cbegin();
+		auto src_iter = d->wiiPtbl.begin();
 		auto dest_iter = vv_partitions->begin();
 		const auto vv_partitions_end = vv_partitions->end();
 		for ( ; dest_iter != vv_partitions_end; ++src_iter, ++dest_iter) {
@@ -1788,7 +1905,9 @@ int GameCube::loadFieldData(void)
 			data_row.reserve(5);	// 5 fields per row.
 
 			// Partition entry.
-			const GameCubePrivate::WiiPartEntry &entry = *src_iter;
+			// NOTE: The partition is opened here if it wasn't needed before.
+			GameCubePrivate::WiiPartEntry &entry = *src_iter;
+			const WiiPartition *const partition = d->openWiiPartition(entry);
 
 			// Partition number.
 			data_row.emplace_back(rp_sprintf("%dp%d", entry.vg, entry.pt));
@@ -1834,11 +1953,11 @@ int GameCube::loadFieldData(void)
 				// NASOS disc image.
 				// If this would normally be an encrypted image, use encKeyReal().
 				encKey = (d->discHeader.disc_noCrypto == 0
-					? entry.partition->encKeyReal()
-					: entry.partition->encKey());
+					? partition->encKeyReal()
+					: partition->encKey());
 			} else {
 				// Other disc image. Use encKey().
-				encKey = entry.partition->encKey();
+				encKey = partition->encKey();
 			}
 
 			static const char *const wii_key_tbl[] = {
@@ -1872,7 +1991,7 @@ int GameCube::loadFieldData(void)
 			data_row.emplace_back(s_key_name);
 
 			// Used size.
-			const off64_t used_size = entry.partition->partition_size_used();
+			const off64_t used_size = partition->partition_size_used();
 			if (used_size >= 0) {
 				data_row.emplace_back(LibRpBase::formatFileSize(used_size));
 			} else {
@@ -1881,7 +2000,7 @@ int GameCube::loadFieldData(void)
 			}
 
 			// Partition size.
-			data_row.emplace_back(LibRpBase::formatFileSize(entry.partition->partition_size()));
+			data_row.emplace_back(LibRpBase::formatFileSize(partition->partition_size()));
 		}
 
 		// Fields.
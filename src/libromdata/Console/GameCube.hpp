@@ -15,6 +15,7 @@ namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(GameCube)
 ROMDATA_DECL_CLOSE()
+ROMDATA_DECL_MEMORY()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
@@ -8,6 +8,7 @@
 
 #include "stdafx.h"
 #include "GameCubeSave.hpp"
+#include "MemCardScanner.hpp"
 #include "data/NintendoPublishers.hpp"
 #include "gcn_card.h"
 
@@ -20,7 +21,9 @@ using namespace LibRpTexture;
 // C++ STL classes.
 #include <string>
 #include <vector>
+using std::array;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 namespace LibRomData {
@@ -84,11 +87,26 @@ class GameCubeSavePrivate final : public RomDataPrivate
 		 */
 		static bool isCardDirEntry(const uint8_t *buffer, uint32_t data_size, SaveType saveType);
 
+		/**
+		 * Read and verify the save file header.
+		 * This function sets saveType, direntry, and dataOffset.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readHeader(void);
+
+		/**
+		 * Read the save file's comment.
+		 * @param desc		[out] Game description.
+		 * @param fileDesc	[out] File description.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readComment(string &desc, string &fileDesc);
+
 		/**
 		 * Load the save file's icons.
 		 *
-		 * This will load all of the animated icon frames,
-		 * though only the first frame will be returned.
+		 * This will load the raw data for all of the animated icon frames,
+		 * though only the first frame will be decoded and returned.
 		 *
 		 * @return Icon, or nullptr on error.
 		 */
@@ -260,11 +278,168 @@ bool GameCubeSavePrivate::isCardDirEntry(const uint8_t *buffer, uint32_t data_si
 	return true;
 }
 
+/**
+ * Read and verify the save file header.
+ * This function sets saveType, direntry, and dataOffset.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GameCubeSavePrivate::readHeader(void)
+{
+	// Read the save file header.
+	uint8_t header[1024];
+	file->rewind();
+	size_t size = file->read(&header, sizeof(header));
+	if (size != sizeof(header)) {
+		return -EIO;
+	}
+
+	// Check if this save file is supported.
+	RomData::DetectInfo info;
+	info.header.addr = 0;
+	info.header.size = sizeof(header);
+	info.header.pData = header;
+	info.ext = nullptr;	// Not needed for GCN save files.
+	info.szFile = file->size();
+	saveType = static_cast<SaveType>(GameCubeSave::isRomSupported_static(&info));
+
+	// Save the directory entry for later.
+	uint32_t gciOffset;	// offset to GCI header
+	switch (saveType) {
+		case SaveType::GCI:
+			gciOffset = 0;
+			break;
+		case SaveType::GCS:
+			gciOffset = 0x110;
+			break;
+		case SaveType::SAV:
+			gciOffset = 0x80;
+			break;
+		default:
+			// Unknown save type.
+			saveType = SaveType::Unknown;
+			return -ENOTSUP;
+	}
+
+	// Save the directory entry for later.
+	memcpy(&direntry, &header[gciOffset], sizeof(direntry));
+	byteswap_direntry(&direntry, saveType);
+	// Data area offset.
+	dataOffset = gciOffset + 0x40;
+	return 0;
+}
+
+/**
+ * Read the save file's comment.
+ * @param desc		[out] Game description.
+ * @param fileDesc	[out] File description.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GameCubeSavePrivate::readComment(string &desc, string &fileDesc)
+{
+	union {
+		struct {
+			char desc[32];
+			char file[32];
+		};
+		char full[64];
+	} comment;
+	size_t size = file->seekAndRead(dataOffset + direntry.commentaddr,
+					&comment, sizeof(comment));
+	if (size != sizeof(comment)) {
+		// Seek and/or read error.
+		return -EIO;
+	}
+
+	// NOTE: Some games have garbage after the first NULL byte
+	// in the two description fields, which prevents the rest
+	// of the field from being displayed.
+
+	// Check for a NULL byte in the game description.
+	size_t desc_len = sizeof(comment.desc);
+	const char *null_pos = static_cast<const char*>(memchr(comment.desc, 0, desc_len));
+	if (null_pos) {
+		// Found a NULL byte.
+		desc_len = null_pos - comment.desc;
+	}
+	desc = cp1252_sjis_to_utf8(comment.desc, static_cast<int>(desc_len));
+
+	// Check for a NULL byte in the file description.
+	desc_len = sizeof(comment.file);
+	null_pos = static_cast<const char*>(memchr(comment.file, 0, desc_len));
+	if (null_pos) {
+		// Found a NULL byte.
+		desc_len = null_pos - comment.file;
+	}
+	fileDesc = cp1252_sjis_to_utf8(comment.file, desc_len);
+	return 0;
+}
+
+/**
+ * Frame decoder for GameCube save file icons.
+ */
+class GCN_IconFrameDecoder : public IconAnimData::FrameDecoder
+{
+	public:
+		explicit GCN_IconFrameDecoder(unsigned int iconsizetotal)
+			: icondata(aligned_uptr<uint8_t>(16, iconsizetotal))
+			, pal_CI8_shared(nullptr)
+		{
+			iconfmt.fill(0);
+			iconaddr.fill(0);
+		}
+
+	public:
+		unique_ptr<uint8_t, decltype(&aligned_free)> icondata;	// Raw icon data
+		const uint16_t *pal_CI8_shared;	// Shared CI8 palette (within icondata)
+		array<uint8_t, IconAnimData::MAX_FRAMES> iconfmt;	// Icon format (CARD_ICON_*)
+		array<unsigned int, IconAnimData::MAX_FRAMES> iconaddr;	// Icon address (within icondata)
+
+	public:
+		/**
+		 * Decode a frame.
+		 * @param idx Frame index.
+		 * @return Decoded frame, or nullptr if the frame is empty or invalid.
+		 */
+		rp_image *decodeFrame(int idx) final
+		{
+			assert(idx >= 0 && idx < (int)iconfmt.size());
+			const uint8_t *const p = icondata.get() + iconaddr[idx];
+			static const unsigned int iconsize_CI8 = CARD_ICON_W * CARD_ICON_H * 1;
+			switch (iconfmt[idx]) {
+				case CARD_ICON_RGB:
+					// RGB5A3
+					return ImageDecoder::fromGcn16(
+						ImageDecoder::PixelFormat::RGB5A3, CARD_ICON_W, CARD_ICON_H,
+						reinterpret_cast<const uint16_t*>(p),
+						CARD_ICON_W * CARD_ICON_H * 2);
+
+				case CARD_ICON_CI_UNIQUE:
+					// CI8 with a unique palette.
+					// Palette is located immediately after the icon.
+					return ImageDecoder::fromGcnCI8(
+						CARD_ICON_W, CARD_ICON_H,
+						p, iconsize_CI8,
+						reinterpret_cast<const uint16_t*>(p + iconsize_CI8), 256*2);
+
+				case CARD_ICON_CI_SHARED:
+					// CI8 with a shared palette.
+					return ImageDecoder::fromGcnCI8(
+						CARD_ICON_W, CARD_ICON_H,
+						p, iconsize_CI8,
+						pal_CI8_shared, 256*2);
+
+				default:
+					// No icon.
+					return nullptr;
+			}
+		}
+};
+
 /**
  * Load the save file's icons.
  *
- * This will load all of the animated icon frames,
- * though only the first frame will be returned.
+ * This will load the raw data for all of the animated icon frames,
+ * though only the first frame will be decoded and returned.
  *
  * @return Icon, or nullptr on error.
  */
@@ -272,7 +447,7 @@ const rp_image *GameCubeSavePrivate::loadIcon(void)
 {
 	if (iconAnimData) {
 		// Icon has already been loaded.
-		return iconAnimData->frames[0];
+		return iconAnimData->frame(0);
 	} else if (!this->file || !this->isValid) {
 		// Can't load the icon.
 		return nullptr;
@@ -339,19 +514,20 @@ const rp_image *GameCubeSavePrivate::loadIcon(void)
 	}
 
 	// Load the icon data.
-	// TODO: Only read the first frame unless specifically requested?
-	auto icondata = aligned_uptr<uint8_t>(16, iconsizetotal);
-	size_t size = file->seekAndRead(dataOffset + iconaddr, icondata.get(), iconsizetotal);
+	// Frames are decoded on demand, since thumbnailers
+	// usually only need the first frame.
+	GCN_IconFrameDecoder *const decoder = new GCN_IconFrameDecoder(iconsizetotal);
+	size_t size = file->seekAndRead(dataOffset + iconaddr, decoder->icondata.get(), iconsizetotal);
 	if (size != iconsizetotal) {
 		// Seek and/or read error.
+		delete decoder;
 		return nullptr;
 	}
 
-	const uint16_t *pal_CI8_shared = nullptr;
 	if (is_CI8_shared) {
 		// Shared CI8 palette is at the end of the data.
-		pal_CI8_shared = reinterpret_cast<const uint16_t*>(
-			icondata.get() + (iconsizetotal - (256*2)));
+		decoder->pal_CI8_shared = reinterpret_cast<const uint16_t*>(
+			decoder->icondata.get() + (iconsizetotal - (256*2)));
 	}
 
 	this->iconAnimData = new IconAnimData();
@@ -374,49 +550,34 @@ const rp_image *GameCubeSavePrivate::loadIcon(void)
 		iconAnimData->delays[i].denom = 8;
 		iconAnimData->delays[i].ms = delay * 125;
 
+		decoder->iconfmt[i] = (iconfmt & CARD_ICON_MASK);
+		decoder->iconaddr[i] = iconaddr_cur;
 		switch (iconfmt & CARD_ICON_MASK) {
-			case CARD_ICON_RGB: {
+			case CARD_ICON_RGB:
 				// RGB5A3
-				static const unsigned int iconsize = CARD_ICON_W * CARD_ICON_H * 2;
-				iconAnimData->frames[i] = ImageDecoder::fromGcn16(
-					ImageDecoder::PixelFormat::RGB5A3, CARD_ICON_W, CARD_ICON_H,
-					reinterpret_cast<const uint16_t*>(icondata.get() + iconaddr_cur),
-					iconsize);
-				iconaddr_cur += iconsize;
+				iconaddr_cur += (CARD_ICON_W * CARD_ICON_H * 2);
 				break;
-			}
 
-			case CARD_ICON_CI_UNIQUE: {
+			case CARD_ICON_CI_UNIQUE:
 				// CI8 with a unique palette.
 				// Palette is located immediately after the icon.
-				static const unsigned int iconsize = CARD_ICON_W * CARD_ICON_H * 1;
-				iconAnimData->frames[i] = ImageDecoder::fromGcnCI8(
-					CARD_ICON_W, CARD_ICON_H,
-					icondata.get() + iconaddr_cur, iconsize,
-					reinterpret_cast<const uint16_t*>(icondata.get() + iconaddr_cur + iconsize), 256*2);
-				iconaddr_cur += iconsize + (256*2);
+				iconaddr_cur += (CARD_ICON_W * CARD_ICON_H * 1) + (256*2);
 				break;
-			}
 
-			case CARD_ICON_CI_SHARED: {
-				static const unsigned int iconsize = CARD_ICON_W * CARD_ICON_H * 1;
-				iconAnimData->frames[i] = ImageDecoder::fromGcnCI8(
-					CARD_ICON_W, CARD_ICON_H,
-					icondata.get() + iconaddr_cur, iconsize,
-					pal_CI8_shared, 256*2);
-				iconaddr_cur += iconsize;
+			case CARD_ICON_CI_SHARED:
+				// CI8 with a shared palette.
+				iconaddr_cur += (CARD_ICON_W * CARD_ICON_H * 1);
 				break;
-			}
 
 			default:
 				// No icon.
-				// Add a nullptr as a placeholder.
-				iconAnimData->frames[i] = 0;
+				// The frame will be nullptr as a placeholder.
 				break;
 		}
 
 		iconAnimData->count++;
 	}
+	iconAnimData->setFrameDecoder(decoder);
 
 	// NOTE: We're not deleting iconAnimData even if we only have
 	// a single icon because iconAnimData() will call loadIcon()
@@ -440,7 +601,7 @@ const rp_image *GameCubeSavePrivate::loadIcon(void)
 	iconAnimData->seq_count = idx;
 
 	// Return the first frame.
-	return iconAnimData->frames[0];
+	return iconAnimData->frame(0);
 }
 
 /**
@@ -536,49 +697,61 @@ GameCubeSave::GameCubeSave(IRpFile *file)
 	}
 
 	// Read the save file header.
-	uint8_t header[1024];
-	d->file->rewind();
-	size_t size = d->file->read(&header, sizeof(header));
-	if (size != sizeof(header)) {
+	if (d->readHeader() != 0) {
+		// Not a supported save file.
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
 	}
 
-	// Check if this disc image is supported.
-	DetectInfo info;
-	info.header.addr = 0;
-	info.header.size = sizeof(header);
-	info.header.pData = header;
-	info.ext = nullptr;	// Not needed for GCN save files.
-	info.szFile = d->file->size();
-	d->saveType = static_cast<GameCubeSavePrivate::SaveType>(isRomSupported_static(&info));
+	d->isValid = true;
+}
 
-	// Save the directory entry for later.
-	uint32_t gciOffset;	// offset to GCI header
-	switch (d->saveType) {
-		case GameCubeSavePrivate::SaveType::GCI:
-			gciOffset = 0;
-			break;
-		case GameCubeSavePrivate::SaveType::GCS:
-			gciOffset = 0x110;
-			break;
-		case GameCubeSavePrivate::SaveType::SAV:
-			gciOffset = 0x80;
-			break;
-		default:
-			// Unknown save type.
-			d->saveType = GameCubeSavePrivate::SaveType::Unknown;
-			UNREF_AND_NULL_NOCHK(d->file);
-			return;
+/**
+ * Read a save file descriptor without creating a GameCubeSave object.
+ * Icons and banners are not loaded.
+ * @param file	[in] Open save file.
+ * @param pInfo	[out] Save file descriptor. (filenames are not set)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GameCubeSave::readSaveInfo(IRpFile *file, MemCardSaveInfo *pInfo)
+{
+	assert(file != nullptr);
+	assert(pInfo != nullptr);
+	if (!file || !pInfo) {
+		return -EINVAL;
 	}
 
-	d->isValid = true;
+	// NOTE: The private class is only used for parsing.
+	GameCubeSavePrivate d(nullptr, file);
+	if (!d.file) {
+		// Could not ref() the file handle.
+		return -EBADF;
+	}
+	int ret = d.readHeader();
+	if (ret != 0) {
+		return ret;
+	}
 
-	// Save the directory entry for later.
-	memcpy(&d->direntry, &header[gciOffset], sizeof(d->direntry));
-	d->byteswap_direntry(&d->direntry, static_cast<GameCubeSavePrivate::SaveType>(d->saveType));
-	// Data area offset.
-	d->dataOffset = gciOffset + 0x40;
+	// Game ID.
+	// Replace any non-printable characters with underscores.
+	char id6[7];
+	for (int i = 0; i < 6; i++) {
+		id6[i] = (ISPRINT(d.direntry.id6[i])
+			? d.direntry.id6[i]
+			: '_');
+	}
+	id6[6] = 0;
+
+	pInfo->system = MemCardSaveInfo::System::GameCube;
+	pInfo->gameID = latin1_to_utf8(id6, 6);
+	pInfo->title.clear();
+	pInfo->description.clear();
+	d.readComment(pInfo->title, pInfo->description);
+	trimEnd(pInfo->title);
+	trimEnd(pInfo->description);
+	pInfo->timestamp = static_cast<time_t>(d.direntry.lastmodified) + GC_UNIX_TIME_DIFF;
+	pInfo->blocks = d.direntry.length;
+	return 0;
 }
 
 /** ROM detection functions. **/
@@ -884,41 +1057,11 @@ int GameCubeSave::loadFieldData(void)
 			direntry->filename, sizeof(direntry->filename)));
 
 	// Description.
-	union {
-		struct {
-			char desc[32];
-			char file[32];
-		};
-		char full[64];
-	} comment;
-	size_t size = d->file->seekAndRead(d->dataOffset + direntry->commentaddr,
-					   &comment, sizeof(comment));
-	if (size == sizeof(comment)) {
-		// Add the description.
-		// NOTE: Some games have garbage after the first NULL byte
-		// in the two description fields, which prevents the rest
-		// of the field from being displayed.
-
-		// Check for a NULL byte in the game description.
-		size_t desc_len = sizeof(comment.desc);
-		const char *null_pos = static_cast<const char*>(memchr(comment.desc, 0, desc_len));
-		if (null_pos) {
-			// Found a NULL byte.
-			desc_len = null_pos - comment.desc;
-		}
-		string desc = cp1252_sjis_to_utf8(comment.desc, static_cast<int>(desc_len));
+	string desc, fileDesc;
+	if (d->readComment(desc, fileDesc) == 0) {
 		desc += '\n';
-
-		// Check for a NULL byte in the file description.
-		desc_len = sizeof(comment.file);
-		null_pos = static_cast<const char*>(memchr(comment.file, 0, desc_len));
-		if (null_pos) {
-			// Found a NULL byte.
-			desc_len = null_pos - comment.file;
-		}
-		desc += cp1252_sjis_to_utf8(comment.file, desc_len);
-
-		d->fields->addField_string(C_("GameCubeSave", "Description"), desc);
+		desc += fileDesc;
+		d->fields->addField_string(C_("GameCubeSave", "Description"), std::move(desc));
 	}
 
 	// Last Modified timestamp.
@@ -1039,7 +1182,7 @@ int GameCubeSave::loadInternalImage(ImageType imageType, const rp_image **pImage
 				// Return the first icon frame.
 				// NOTE: GCN save icon animations are always
 				// sequential, so we can use a shortcut here.
-				*pImage = d->iconAnimData->frames[0];
+				*pImage = d->iconAnimData->frame(0);
 				return 0;
 			}
 			break;
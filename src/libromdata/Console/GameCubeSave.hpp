@@ -13,7 +13,20 @@
 
 namespace LibRomData {
 
+struct MemCardSaveInfo;
+
 ROMDATA_DECL_BEGIN(GameCubeSave)
+
+	public:
+		/**
+		 * Read a save file descriptor without creating a GameCubeSave object.
+		 * Icons and banners are not loaded.
+		 * @param file	[in] Open save file.
+		 * @param pInfo	[out] Save file descriptor. (filenames are not set)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int readSaveInfo(LibRpFile::IRpFile *file, MemCardSaveInfo *pInfo);
+
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
@@ -13,6 +13,7 @@
 #include "data/SegaPublishers.hpp"
 #include "MegaDriveRegions.hpp"
 #include "CopierFormats.h"
+#include "utils/RomChecksum.hpp"
 #include "utils/SuperMagicDrive.hpp"
 
 // librpbase, librpfile
@@ -27,23 +28,14 @@ using LibRpFile::IRpFile;
 using std::string;
 using std::vector;
 
-// zlib for crc32()
-#include <zlib.h>
-#ifdef _MSC_VER
-// MSVC: Exception handling for /DELAYLOAD.
-#  include "libwin32common/DelayLoadHelper.h"
-#endif /* _MSC_VER */
+// librpcpu
+#include "librpcpu/crc32_rp.h"
 
 namespace LibRomData {
 
 ROMDATA_IMPL(MegaDrive)
 ROMDATA_IMPL_IMG(MegaDrive)
 
-#ifdef _MSC_VER
-// DelayLoad test implementation.
-DELAYLOAD_TEST_FUNCTION_IMPL0(get_crc_table);
-#endif /* _MSC_VER */
-
 class MegaDrivePrivate final : public RomDataPrivate
 {
 	public:
@@ -396,6 +388,34 @@ void MegaDrivePrivate::addFields_romHeader(const MD_RomHeader *pRomHeader, bool
 		// Checksum. (MD only; not valid for Mega CD.)
 		fields->addField_string_numeric(C_("RomData", "Checksum"),
 			checksum, RomFields::Base::Hex, 4, RomFields::STRF_MONOSPACE);
+
+		// Full checksum. (optional; reads the entire ROM)
+		// This is the 16-bit sum of all big-endian words
+		// starting at 0x200, i.e. after the ROM header.
+		// NOTE: Only supported for binary-format ROMs without
+		// a locked-on ROM, since the checksum only covers the
+		// ROM that contains the header.
+		if (pRomHeader == &romHeader && !pRomHeaderLockOn &&
+		    (romType & ROM_FORMAT_MASK) == ROM_FORMAT_CART_BIN &&
+		    RomChecksum::isEnabled())
+		{
+			const off64_t fileSize = file->size();
+			rp_sum8_t sum = {0, 0};
+			if (fileSize > 0x200 &&
+			    RomChecksum::sumFileRange(file, 0x200, fileSize - 0x200, &sum) == 0)
+			{
+				const uint16_t full_checksum = static_cast<uint16_t>((sum.even << 8) + sum.odd);
+				const char *const full_checksum_title = C_("RomData", "Full Checksum");
+				if (full_checksum != checksum) {
+					fields->addField_string(full_checksum_title,
+						rp_sprintf_p(C_("MegaDrive", "0x%1$04X (INVALID; should be 0x%2$04X)"),
+							checksum, full_checksum));
+				} else {
+					fields->addField_string(full_checksum_title,
+						rp_sprintf(C_("MegaDrive", "0x%04X (valid)"), full_checksum));
+				}
+			}
+		}
 	}
 
 	// I/O support bitfield.
@@ -825,25 +845,11 @@ MegaDrive::MegaDrive(IRpFile *file)
 	    !memcmp(s_serial_number, "GM 00054503-00", sizeof(d->romHeader.serial_number)) &&
 	    (d->romType & MegaDrivePrivate::ROM_FORMAT_MASK) == MegaDrivePrivate::ROM_FORMAT_CART_BIN)
 	{
-#if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
-		// Delay load verification.
-		// TODO: Only if linked with /DELAYLOAD?
-		if (DelayLoad_test_get_crc_table() != 0) {
-			// Delay load failed.
-			// Can't calculate the CRC32.
-			return;
-		}
-#else /* !defined(_MSC_VER) || !defined(ZLIB_IS_DLL) */
-		// zlib isn't in a DLL, but we need to ensure that the
-		// CRC table is initialized anyway.
-		get_crc_table();
-#endif /* defined(_MSC_VER) && defined(ZLIB_IS_DLL) */
-
 		// Calculate the CRC32 of $20000-$200FF.
 		// TODO: SMD deinterleaving.
 		uint8_t buf[256];
 		d->file->seekAndRead(0x20000, buf, sizeof(buf));
-		d->gt_crc = crc32(0, buf, sizeof(buf));
+		d->gt_crc = rp_crc32(0, buf, sizeof(buf));
 	}
 	// If this is S&K, try reading the locked-on ROM header.
 	else if (fileSize >= ((2*1024*1024)+512) &&
@@ -1324,9 +1330,9 @@ int MegaDrive::loadFieldData(void)
 	}
 
 	// Maximum number of fields:
-	// - ROM Header: 13
+	// - ROM Header: 14
 	// - Vector table: 1 (LIST_DATA)
-	d->fields->reserve(14);
+	d->fields->reserve(15);
 
 	// Reserve at least 2 tabs.
 	d->fields->reserveTabs(2);
@@ -372,13 +372,25 @@ NES::NES(IRpFile *file)
 		return;
 	}
 	
-	// Seek to the beginning of the header.
-	d->file->rewind();
-
-	// Read the ROM header. [128 bytes]
+	// Get the ROM header. [128 bytes]
 	// NOTE: Allowing smaller headers for certain types.
-	uint8_t header[128];
-	size_t size = d->file->read(header, sizeof(header));
+	// If the file is memory-mapped, the header is used in place,
+	// which also covers the TNES FDS header at 0x2010.
+	static const size_t TNES_FDS_HEADER_END = 0x2010 + sizeof(FDS_DiskHeader);
+	const off64_t fileSize = d->file->size();
+	uint8_t header_buf[128];
+	const uint8_t *header = nullptr;
+	size_t size = 0;
+	if (fileSize >= static_cast<off64_t>(sizeof(header_buf))) {
+		size = (fileSize >= static_cast<off64_t>(TNES_FDS_HEADER_END)
+			? TNES_FDS_HEADER_END : sizeof(header_buf));
+		header = d->file->peek(0, size);
+	}
+	if (!header) {
+		// Not memory-mapped. Read the header.
+		size = d->file->seekAndRead(0, header_buf, sizeof(header_buf));
+		header = header_buf;
+	}
 	if (size < 16) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
@@ -387,10 +399,10 @@ NES::NES(IRpFile *file)
 	// Check if this ROM image is supported.
 	DetectInfo info;
 	info.header.addr = 0;
-	info.header.size = sizeof(header);
+	info.header.size = static_cast<uint32_t>(std::min(size, sizeof(header_buf)));
 	info.header.pData = header;
 	info.ext = nullptr;	// Not needed for NES.
-	info.szFile = d->file->size();
+	info.szFile = fileSize;
 	d->romType = isRomSupported_static(&info);
 
 	switch (d->romType & NESPrivate::ROM_FORMAT_MASK) {
@@ -437,8 +449,10 @@ NES::NES(IRpFile *file)
 
 		case NESPrivate::ROM_FORMAT_FDS_TNES: {
 			// FDS disk image. (TNES/TDS format)
-			size_t szret = d->file->seekAndRead(0x2010, &d->header.fds, sizeof(d->header.fds));
-			if (szret != sizeof(d->header.fds)) {
+			if (size >= TNES_FDS_HEADER_END) {
+				// The FDS header is in the peeked header data.
+				memcpy(&d->header.fds, &header[0x2010], sizeof(d->header.fds));
+			} else if (d->file->seekAndRead(0x2010, &d->header.fds, sizeof(d->header.fds)) != sizeof(d->header.fds)) {
 				// Seek and/or read error.
 				UNREF_AND_NULL_NOCHK(d->file);
 				d->fileType = FileType::Unknown;
@@ -586,6 +600,10 @@ int NES::isRomSupported_static(const DetectInfo *info)
 		// fwNES header is present.
 		// TODO: Check required NULL bytes.
 		// For now, assume this is correct.
+		if (info->header.size < sizeof(FDS_DiskHeader_fwNES) + sizeof(FDS_DiskHeader)) {
+			// Not enough data for the FDS header.
+			return -1;
+		}
 		const FDS_DiskHeader *fdsHeader =
 			reinterpret_cast<const FDS_DiskHeader*>(&info->header.pData[16]);
 		if (fdsHeader->block_code == 0x01 &&
@@ -597,6 +615,10 @@ int NES::isRomSupported_static(const DetectInfo *info)
 		}
 	} else {
 		// fwNES header is not present.
+		if (info->header.size < sizeof(FDS_DiskHeader)) {
+			// Not enough data for the FDS header.
+			return -1;
+		}
 		const FDS_DiskHeader *fdsHeader =
 			reinterpret_cast<const FDS_DiskHeader*>(info->header.pData);
 		if (fdsHeader->block_code == 0x01 &&
@@ -27,12 +27,8 @@ using LibRpFile::RpFile;
 #include "Console/PlayStationEXE.hpp"
 #include "Other/ELF.hpp"
 
-// inih for SYSTEM.CNF
-#include "ini.h"
-
 // C++ STL classes.
 using std::string;
-using std::unordered_map;
 using std::vector;
 
 namespace LibRomData {
@@ -52,19 +48,35 @@ class PlayStationDiscPrivate final : public RomDataPrivate
 	public:
 		ISO_Primary_Volume_Descriptor pvd;
 
+		// SYSTEM.CNF keys
+		enum SystemCnfKey {
+			CNF_BOOT,	// PS1 boot filename
+			CNF_BOOT2,	// PS2 boot filename
+			CNF_STACK,	// PS1 stack pointer override
+			CNF_TCB,	// PS1 max thread count
+			CNF_EVENT,	// PS1 max event count
+			CNF_VER,	// PS2 version
+			CNF_VMODE,	// PS2 video mode
+
+			CNF_MAX
+		};
+
 		// SYSTEM.CNF contents
-		// Keys are stored in upper-case.
-		unordered_map<string, string> system_cnf;
+		// Values point into system_cnf_buf[]. (nullptr if not present)
+		const char *system_cnf[CNF_MAX];
+		char system_cnf_buf[2049];
 
 		/**
-		 * ini.h callback for parsing SYSTEM.CNF.
-		 * @param user		[in] User data parameter (this)
-		 * @param section	[in] Section name
-		 * @param name		[in] Value name
-		 * @param value		[in] Value
-		 * @return 0 to continue; 1 to stop.
+		 * Parse SYSTEM.CNF in system_cnf_buf[].
+		 * Values are NULL-terminated in place; nothing is allocated.
+		 * This follows the same rules as inih:
+		 * - ';' and '#' start a comment line. ';' after whitespace
+		 *   starts an inline comment.
+		 * - Names and values are separated by '=' or ':'.
+		 * - Names are case-insensitive. The first value wins.
+		 * - Anything in a [section] is ignored.
 		 */
-		static int parse_system_cnf(void *user, const char *section, const char *name, const char *value);
+		void parseSystemCnf(void);
 
 		/**
 		 * Load SYSTEM.CNF.
@@ -117,6 +129,8 @@ PlayStationDiscPrivate::PlayStationDiscPrivate(PlayStationDisc *q, IRpFile *file
 {
 	// Clear the structs.
 	memset(&pvd, 0, sizeof(pvd));
+	memset(system_cnf, 0, sizeof(system_cnf));
+	system_cnf_buf[0] = '\0';
 }
 
 PlayStationDiscPrivate::~PlayStationDiscPrivate()
@@ -127,28 +141,104 @@ PlayStationDiscPrivate::~PlayStationDiscPrivate()
 }
 
 /**
- * ini.h callback for parsing SYSTEM.CNF.
- * @param user		[in] User data parameter (this)
- * @param section	[in] Section name
- * @param name		[in] Value name
- * @param value		[in] Value
- * @return 0 to continue; 1 to stop.
+ * Parse SYSTEM.CNF in system_cnf_buf[].
+ * Values are NULL-terminated in place; nothing is allocated.
+ * This follows the same rules as inih:
+ * - ';' and '#' start a comment line. ';' after whitespace
+ *   starts an inline comment.
+ * - Names and values are separated by '=' or ':'.
+ * - Names are case-insensitive. The first value wins.
+ * - Anything in a [section] is ignored.
  */
-int PlayStationDiscPrivate::parse_system_cnf(void *user, const char *section, const char *name, const char *value)
+void PlayStationDiscPrivate::parseSystemCnf(void)
 {
-	if (section[0] != '\0') {
-		// Sections aren't expected here...
-		return 1;
+	static const char key_names[CNF_MAX][8] = {
+		"BOOT", "BOOT2", "STACK", "TCB", "EVENT", "VER", "VMODE"
+	};
+
+	// Find a character in `chars`, or an inline comment.
+	// If `chars` is nullptr, only inline comments are checked.
+	auto find_chars_or_comment = [](char *p, const char *chars) -> char* {
+		bool was_space = false;
+		for (; *p != '\0'; p++) {
+			if ((chars && strchr(chars, *p)) || (was_space && *p == ';'))
+				break;
+			was_space = !!ISSPACE(*p);
+		}
+		return p;
+	};
+	auto rstrip = [](char *p_start, char *p_end) {
+		while (p_end > p_start && ISSPACE(p_end[-1])) {
+			*--p_end = '\0';
+		}
+	};
+
+	char *p = system_cnf_buf;
+	if (!memcmp(p, "\xEF\xBB\xBF", 3)) {
+		// Skip the UTF-8 BOM.
+		p += 3;
 	}
 
-	// Save the value for later.
-	string s_name(name);
-	std::transform(s_name.begin(), s_name.end(), s_name.begin(),
-		[](unsigned char c) { return std::toupper(c); });
+	bool has_prev_name = false;
+	while (*p != '\0') {
+		// Split off the next line.
+		char *const line = p;
+		char *const nl = strchr(p, '\n');
+		if (nl) {
+			*nl = '\0';
+			p = nl + 1;
+		} else {
+			p += strlen(p);
+		}
 
-	PlayStationDiscPrivate *const d = static_cast<PlayStationDiscPrivate*>(user);
-	auto ret = d->system_cnf.emplace(std::make_pair(std::move(s_name), value));
-	return (ret.second ? 0 : 1);
+		char *start = line;
+		while (ISSPACE(*start)) {
+			start++;
+		}
+		rstrip(start, start + strlen(start));
+
+		if (*start == '\0' || *start == ';' || *start == '#') {
+			// Empty line or comment.
+			continue;
+		} else if (has_prev_name && start > line) {
+			// Continuation line. The previous name already
+			// has a value, and the first value wins.
+			continue;
+		} else if (*start == '[') {
+			if (*find_chars_or_comment(start + 1, "]") == ']') {
+				// Sections aren't expected here...
+				break;
+			}
+			// Invalid section line.
+			continue;
+		}
+
+		char *end = find_chars_or_comment(start, "=:");
+		if (*end != '=' && *end != ':') {
+			// No name/value separator.
+			continue;
+		}
+		*end = '\0';
+		rstrip(start, end);
+		has_prev_name = (*start != '\0');
+
+		char *value = end + 1;
+		end = find_chars_or_comment(value, nullptr);
+		*end = '\0';
+		while (ISSPACE(*value)) {
+			value++;
+		}
+		rstrip(value, end);
+
+		for (unsigned int i = 0; i < CNF_MAX; i++) {
+			if (!strcasecmp(start, key_names[i])) {
+				if (!system_cnf[i]) {
+					system_cnf[i] = value;
+				}
+				break;
+			}
+		}
+	}
 }
 
 /**
@@ -158,7 +248,7 @@ int PlayStationDiscPrivate::parse_system_cnf(void *user, const char *section, co
  */
 int PlayStationDiscPrivate::loadSystemCnf(IsoPartition *pt)
 {
-	if (!system_cnf.empty()) {
+	if (system_cnf[CNF_BOOT] || system_cnf[CNF_BOOT2]) {
 		// Already loaded.
 		return 0;
 	}
@@ -171,14 +261,12 @@ int PlayStationDiscPrivate::loadSystemCnf(IsoPartition *pt)
 		if (ret == ENOENT) {
 			// SYSTEM.CNF not found. Check for PSX.EXE.
 			IRpFile *const f_psx_exe = pt->open("PSX.EXE");
-			if (f_psx_exe && f_psx_exe->isOpen()) {
+			const bool found = (f_psx_exe && f_psx_exe->isOpen());
+			UNREF(f_psx_exe);
+			if (found) {
 				// Found PSX.EXE.
-				boot_filename = "PSX.EXE";
-				system_cnf.emplace(std::make_pair("BOOT", boot_filename));
-				if (f_psx_exe) {
-					f_psx_exe->unref();
-				}
 				// Pretend that we did find SYSTEM.CNF.
+				system_cnf[CNF_BOOT] = "PSX.EXE";
 				return 0;
 			} else {
 				// Not found.
@@ -204,21 +292,26 @@ int PlayStationDiscPrivate::loadSystemCnf(IsoPartition *pt)
 	}
 
 	// Read the entire file into memory.
-	char buf[2049];
-	size_t size = f_system_cnf->read(buf, 2048);
+	size_t size = f_system_cnf->read(system_cnf_buf, 2048);
+	f_system_cnf->unref();
 	if (size != static_cast<size_t>(fileSize)) {
 		// Short read.
-		f_system_cnf->unref();
+		system_cnf_buf[0] = '\0';
 		return -EIO;
 	}
-	buf[static_cast<size_t>(fileSize)] = '\0';
+	system_cnf_buf[static_cast<size_t>(fileSize)] = '\0';
 
 	// Process the file.
 	// TODO: Fail on error?
-	ini_parse_string(buf, parse_system_cnf, this);
+	parseSystemCnf();
 
-	f_system_cnf->unref();
-	return (!system_cnf.empty() ? 0 : -EIO);
+	for (const char *value : system_cnf) {
+		if (value) {
+			// Found at least one key.
+			return 0;
+		}
+	}
+	return -EIO;
 }
 
 /**
@@ -251,11 +344,11 @@ RomData *PlayStationDiscPrivate::openBootExe(void)
 			case ConsoleType::PS1: {
 				// Check if we have a STACK override in SYSTEM.CNF.
 				uint32_t sp_override = 0;
-				auto iter = system_cnf.find("STACK");
-				if (iter != system_cnf.end() && !iter->second.empty()) {
+				const char *const stack = system_cnf[CNF_STACK];
+				if (stack && stack[0] != '\0') {
 					// Validate the value.
 					char *endptr = nullptr;
-					sp_override = strtoul(iter->second.c_str(), &endptr, 16);
+					sp_override = strtoul(stack, &endptr, 16);
 					if (*endptr != '\0') {
 						sp_override = 0;
 					}
@@ -355,7 +448,9 @@ PlayStationDisc::PlayStationDisc(IRpFile *file)
 	}
 
 	// Try to open the ISO partition.
-	IsoPartition *const isoPartition = new IsoPartition(discReader, 0, 0);
+	// NOTE: The PVD was already read above, so pass it in
+	// to avoid reading it again.
+	IsoPartition *const isoPartition = new IsoPartition(discReader, 0, 0, &d->pvd);
 	if (!isoPartition->isOpen()) {
 		// Error opening the ISO partition.
 		UNREF(isoPartition);
@@ -378,13 +473,13 @@ PlayStationDisc::PlayStationDisc(IRpFile *file)
 
 	// Check if we have a boot filename.
 	PlayStationDiscPrivate::ConsoleType consoleType = PlayStationDiscPrivate::ConsoleType::Unknown;
-	auto iter = d->system_cnf.find("BOOT2");
-	if (iter != d->system_cnf.end()) {
+	const char *bf_str = d->system_cnf[PlayStationDiscPrivate::CNF_BOOT2];
+	if (bf_str) {
 		// Found BOOT2. (PS2)
 		consoleType = PlayStationDiscPrivate::ConsoleType::PS2;
 	} else {
-		iter = d->system_cnf.find("BOOT");
-		if (iter != d->system_cnf.end()) {
+		bf_str = d->system_cnf[PlayStationDiscPrivate::CNF_BOOT];
+		if (bf_str) {
 			// Found BOOT. (PS1)
 			consoleType = PlayStationDiscPrivate::ConsoleType::PS1;
 		} else {
@@ -401,10 +496,9 @@ PlayStationDisc::PlayStationDisc(IRpFile *file)
 	// - cdrom0: (PS2)
 	// There's usually a backslash after the colon, but some
 	// prototypes don't have it.
-	const auto &bf_str = iter->second;
-	if (!bf_str.empty()) {
+	if (bf_str[0] != '\0') {
 		size_t pos = 0;
-		if (!strncasecmp(bf_str.c_str(), "cdrom", 5)) {
+		if (!strncasecmp(bf_str, "cdrom", 5)) {
 			pos = 5;
 			if (bf_str[pos] == '0') {
 				// "cdrom0"
@@ -420,7 +514,7 @@ PlayStationDisc::PlayStationDisc(IRpFile *file)
 				}
 			}
 		}
-		d->boot_filename = bf_str.substr(pos);
+		d->boot_filename = &bf_str[pos];
 	}
 	if (d->boot_filename.empty()) {
 		// No boot filename specified.
@@ -437,12 +531,12 @@ PlayStationDisc::PlayStationDisc(IRpFile *file)
 	}
 
 	// Check if there is a space.
-	size_t pos = bf_str.find(' ');
+	size_t pos = d->boot_filename.find(' ');
 	if (pos != string::npos && pos > 0) {
 		// Found a space.
 		// Everything after the space is a boot argument.
 		d->boot_argument = d->boot_filename.substr(pos+1);
-		d->boot_filename.resize(pos-1);
+		d->boot_filename.resize(pos);
 	}
 
 	// Remove the ISO version number.
@@ -480,6 +574,38 @@ void PlayStationDisc::close(void)
 	super::close();
 }
 
+/**
+ * Get the approximate amount of memory used by this object.
+ * @return Approximate memory usage, in bytes.
+ */
+size_t PlayStationDisc::memoryUsage(void) const
+{
+	RP_D(const PlayStationDisc);
+	size_t total = super::memoryUsage();
+	if (d->isoPartition) {
+		total += d->isoPartition->memoryUsage();
+	}
+	if (d->bootExeData) {
+		total += d->bootExeData->memoryUsage();
+	}
+	return total;
+}
+
+/**
+ * Release cached data that can be rebuilt on demand.
+ */
+void PlayStationDisc::releaseMemory(void)
+{
+	RP_D(PlayStationDisc);
+	if (d->isoPartition) {
+		d->isoPartition->releaseMemory();
+	}
+	if (d->bootExeData) {
+		d->bootExeData->releaseMemory();
+	}
+	super::releaseMemory();
+}
+
 /** ROM detection functions. **/
 
 /**
@@ -684,31 +810,31 @@ int PlayStationDisc::loadFieldData(void)
 		default:
 		case PlayStationDiscPrivate::ConsoleType::PS1: {
 			// Max thread count
-			auto iter = d->system_cnf.find("TCB");
-			if (iter != d->system_cnf.end() && !iter->second.empty()) {
-				d->fields->addField_string(C_("PlayStationDisc", "Max Thread Count"), iter->second);
+			const char *value = d->system_cnf[PlayStationDiscPrivate::CNF_TCB];
+			if (value && value[0] != '\0') {
+				d->fields->addField_string(C_("PlayStationDisc", "Max Thread Count"), value);
 			}
 
 			// Max event count
-			iter = d->system_cnf.find("EVENT");
-			if (iter != d->system_cnf.end() && !iter->second.empty()) {
-				d->fields->addField_string(C_("PlayStationDisc", "Max Event Count"), iter->second);
+			value = d->system_cnf[PlayStationDiscPrivate::CNF_EVENT];
+			if (value && value[0] != '\0') {
+				d->fields->addField_string(C_("PlayStationDisc", "Max Event Count"), value);
 			}
 			break;
 		}
 
 		case PlayStationDiscPrivate::ConsoleType::PS2: {
 			// Version
-			auto iter = d->system_cnf.find("VER");
-			if (iter != d->system_cnf.end() && !iter->second.empty()) {
-				d->fields->addField_string(C_("PlayStationDisc", "Version"), iter->second);
+			const char *value = d->system_cnf[PlayStationDiscPrivate::CNF_VER];
+			if (value && value[0] != '\0') {
+				d->fields->addField_string(C_("PlayStationDisc", "Version"), value);
 			}
 
 			// Video mode
 			// TODO: Validate this?
-			iter = d->system_cnf.find("VMODE");
-			if (iter != d->system_cnf.end() && !iter->second.empty()) {
-				d->fields->addField_string(C_("PlayStationDisc", "Video Mode"), iter->second);
+			value = d->system_cnf[PlayStationDiscPrivate::CNF_VMODE];
+			if (value && value[0] != '\0') {
+				d->fields->addField_string(C_("PlayStationDisc", "Video Mode"), value);
 			}
 			break;
 		}
@@ -16,6 +16,7 @@ namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(PlayStationDisc)
 ROMDATA_DECL_CLOSE()
+ROMDATA_DECL_MEMORY()
 
 	public:
 		/**
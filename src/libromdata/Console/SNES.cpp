@@ -11,6 +11,7 @@
 #include "data/NintendoPublishers.hpp"
 #include "snes_structs.h"
 #include "CopierFormats.h"
+#include "utils/RomChecksum.hpp"
 
 // librpbase, librpfile
 #include "librpbase/SystemRegion.hpp"
@@ -19,6 +20,7 @@ using namespace LibRpFile;
 
 // C++ STL classes.
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 namespace LibRomData {
@@ -108,6 +110,13 @@ class SNESPrivate final : public RomDataPrivate
 		 * @return Game ID if available; empty string if not.
 		 */
 		string getGameID(bool doFake = false) const;
+
+		/**
+		 * Verify the full ROM checksum and add a field for it.
+		 * This reads the entire ROM image.
+		 * (SNES/SFC ROM images only.)
+		 */
+		void addField_fullChecksum(void);
 };
 
 /** SNESPrivate **/
@@ -722,6 +731,58 @@ string SNESPrivate::getGameID(bool doFake) const
 	return gameID;
 }
 
+/**
+ * Verify the full ROM checksum and add a field for it.
+ * This reads the entire ROM image.
+ * (SNES/SFC ROM images only.)
+ */
+void SNESPrivate::addField_fullChecksum(void)
+{
+	assert(romType == RomType::SNES);
+
+	// Skip the copier header, if present.
+	const off64_t romOffset = ((header_address & 0xFFF) != 0xFB0 ? 512 : 0);
+	const off64_t romSize = file->size() - romOffset;
+	if (romSize <= 0)
+		return;
+
+	// The checksum is the 16-bit sum of all bytes in the ROM.
+	// If the ROM size isn't a power of two, the last part of the
+	// ROM is mirrored to fill the next power of two.
+	off64_t baseSize = 1;
+	while (baseSize <= (romSize >> 1)) {
+		baseSize <<= 1;
+	}
+	const off64_t remSize = romSize - baseSize;
+	if (remSize > 0 && (baseSize % remSize) != 0) {
+		// Can't mirror the remainder evenly.
+		return;
+	}
+
+	rp_sum8_t sum = {0, 0};
+	if (RomChecksum::sumFileRange(file, romOffset, baseSize, &sum) != 0)
+		return;
+	uint64_t full_checksum = sum.even + sum.odd;
+	if (remSize > 0) {
+		rp_sum8_t sum_rem = {0, 0};
+		if (RomChecksum::sumFileRange(file, romOffset + baseSize, remSize, &sum_rem) != 0)
+			return;
+		full_checksum += (sum_rem.even + sum_rem.odd) * static_cast<uint64_t>(baseSize / remSize);
+	}
+
+	const uint16_t checksum16 = static_cast<uint16_t>(full_checksum);
+	const uint16_t rom_checksum = le16_to_cpu(romHeader.snes.checksum);
+	const char *const full_checksum_title = C_("RomData", "Full Checksum");
+	if (checksum16 != rom_checksum) {
+		fields->addField_string(full_checksum_title,
+			rp_sprintf_p(C_("SNES", "0x%1$04X (INVALID; should be 0x%2$04X)"),
+				rom_checksum, checksum16));
+	} else {
+		fields->addField_string(full_checksum_title,
+			rp_sprintf(C_("SNES", "0x%04X (valid)"), checksum16));
+	}
+}
+
 /** SNES **/
 
 /**
@@ -764,19 +825,45 @@ SNES::SNES(IRpFile *file)
 		}
 	}
 
+	// Read the beginning of the file, up to and including the
+	// last header address that might be checked, all at once.
+	// All of the header checks below use this buffer instead of
+	// reading from the file, since SNES ROM images don't have a
+	// header at a fixed location.
+	static const size_t PREFIX_SIZE = 0xFFB0 + 512 + sizeof(SNES_RomHeader);
+	const off64_t fileSize = d->file->size();
+	if (fileSize <= 0) {
+		UNREF_AND_NULL_NOCHK(d->file);
+		return;
+	}
+	const size_t prefix_size = (fileSize < static_cast<off64_t>(PREFIX_SIZE)
+		? static_cast<size_t>(fileSize) : PREFIX_SIZE);
+	unique_ptr<uint8_t[]> prefix_buf;
+	const uint8_t *prefix = d->file->peek(0, prefix_size);
+	if (!prefix) {
+		// Not memory-mapped. Read the data.
+		prefix_buf.reset(new uint8_t[prefix_size]);
+		size_t size = d->file->seekAndRead(0, prefix_buf.get(), prefix_size);
+		if (size != prefix_size) {
+			// Read error.
+			UNREF_AND_NULL_NOCHK(d->file);
+			return;
+		}
+		prefix = prefix_buf.get();
+	}
+
 	if (d->romType == SNESPrivate::RomType::Unknown) {
 		// Check for BS-X "Memory Pack" headers.
 		static const uint16_t bsx_addrs[2] = {0x7F00, 0xFF00};
 		static const uint8_t bsx_mempack_magic[6] = {'M', 0, 'P', 0, 0, 0};
-		uint8_t buf[7];
 
 		for (unsigned int i = 0; i < 2; i++) {
-			size_t size = d->file->seekAndRead(bsx_addrs[i], buf, sizeof(buf));
-			if (size != sizeof(buf)) {
-				// Read error.
+			if (bsx_addrs[i] + 7U > prefix_size) {
+				// File is too small.
 				UNREF_AND_NULL_NOCHK(d->file);
 				return;
 			}
+			const uint8_t *const buf = &prefix[bsx_addrs[i]];
 
 			if (!memcmp(buf, bsx_mempack_magic, sizeof(bsx_mempack_magic))) {
 				// Found BS-X memory pack magic.
@@ -800,12 +887,11 @@ SNES::SNES(IRpFile *file)
 
 		// Check if a copier header is present.
 		SMD_Header smdHeader;
-		d->file->rewind();
-		size_t size = d->file->read(&smdHeader, sizeof(smdHeader));
-		if (size != sizeof(smdHeader)) {
+		if (prefix_size < sizeof(smdHeader)) {
 			UNREF_AND_NULL_NOCHK(d->file);
 			return;
 		}
+		memcpy(&smdHeader, prefix, sizeof(smdHeader));
 
 		if (smdHeader.id[0] == 0xAA && smdHeader.id[1] == 0xBB) {
 			// TODO: Check page count?
@@ -845,6 +931,12 @@ SNES::SNES(IRpFile *file)
 				if (!memcmp(&u8ptr[8], superufo, sizeof(superufo)-1)) {
 					// Super UFO ROM header.
 					isCopierHeader = true;
+				} else if ((fileSize & 0x3FF) == 0x200) {
+					// No known copier header signature, but the
+					// file size is 512 bytes more than a multiple
+					// of 1 KB, so there's probably a copier header.
+					// Check the +512 header addresses first.
+					isCopierHeader = true;
 				}
 			}
 		}
@@ -866,11 +958,11 @@ SNES::SNES(IRpFile *file)
 		if (*pHeaderAddress == 0)
 			break;
 
-		size_t size = d->file->seekAndRead(*pHeaderAddress, &d->romHeader, sizeof(d->romHeader));
-		if (size != sizeof(d->romHeader)) {
-			// Seek and/or read error.
+		if (*pHeaderAddress + sizeof(d->romHeader) > prefix_size) {
+			// File is too small for this header address.
 			continue;
 		}
+		memcpy(&d->romHeader, &prefix[*pHeaderAddress], sizeof(d->romHeader));
 
 		if (d->romType == SNESPrivate::RomType::BSX) {
 			// Check for a valid BS-X ROM header first.
@@ -1416,6 +1508,11 @@ int SNES::loadFieldData(void)
 			d->fields->addField_string_numeric(C_("SNES", "Revision"),
 				romHeader->snes.version, RomFields::Base::Dec, 2);
 
+			// Full checksum. (optional; reads the entire ROM)
+			if (RomChecksum::isEnabled()) {
+				d->addField_fullChecksum();
+			}
+
 			break;
 		}
 
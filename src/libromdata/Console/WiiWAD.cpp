@@ -31,6 +31,13 @@ using LibRpTexture::rp_image;
 #  include "librpbase/disc/CBCReader.hpp"
 // For sections delegated to other RomData subclasses.
 #  include "librpbase/disc/PartitionFile.hpp"
+// Content verification.
+#  include "librpbase/crypto/Hash.hpp"
+#  include "librpthreads/Semaphore.hpp"
+#  include "librpthreads/Thread.hpp"
+#  include "utils/RomChecksum.hpp"
+using LibRpThreads::Semaphore;
+using LibRpThreads::Thread;
 #endif /* ENABLE_DECRYPTION */
 
 // RomData subclasses.
@@ -58,6 +65,7 @@ WiiWADPrivate::WiiWADPrivate(WiiWAD *q, IRpFile *file)
 #ifdef ENABLE_DECRYPTION
 	, cbcReader(nullptr)
 	, mainContent(nullptr)
+	, mainContentLoaded(false)
 #endif /* ENABLE_DECRYPTION */
 	, key_idx(WiiPartition::Key_Max)
 	, key_status(KeyManager::VerifyResult::Unknown)
@@ -91,7 +99,7 @@ string WiiWADPrivate::getGameInfo(void)
 
 #ifdef ENABLE_DECRYPTION
 	// IMET header.
-	// TODO: Read on demand instead of always reading in the constructor.
+	loadMainContent();
 	if (imet.magic != cpu_to_be32(WII_IMET_MAGIC)) {
 		// Not valid.
 		return string();
@@ -159,28 +167,12 @@ int WiiWADPrivate::openSRL(void)
 	}
 
 	// If the CBCReader is closed, reopen it.
-	if (!cbcReader) {
-		// Data area IV:
-		// - First two bytes are the big-endian content index.
-		// - Remaining bytes are zero.
-		uint8_t iv[16];
-		memcpy(iv, &pIMETContent->index, sizeof(pIMETContent->index));
-		memset(&iv[2], 0, sizeof(iv)-2);
-
-		cbcReader = new CBCReader(file,
-			data_offset, data_size, dec_title_key, iv);
-		if (!cbcReader->isOpen()) {
-			// Unable to open a CBC reader.
-			int ret = -cbcReader->lastError();
-			if (ret == 0) {
-				ret = -EIO;
-			}
-			UNREF_AND_NULL(cbcReader);
-			return ret;
-		}
+	int ret = openCBCReader();
+	if (ret != 0) {
+		// Unable to open a CBC reader.
+		return ret;
 	}
 
-	int ret = 0;
 	PartitionFile *const ptFile = new PartitionFile(cbcReader,
 		imetContentOffset, be64_to_cpu(pIMETContent->size));
 	if (ptFile->isOpen()) {
@@ -203,6 +195,387 @@ int WiiWADPrivate::openSRL(void)
 	UNREF(ptFile);
 	return ret;
 }
+
+/**
+ * Verify the common key and decrypt the title key, if it hasn't been done yet.
+ * This sets key_status.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WiiWADPrivate::decryptTitleKey(void)
+{
+	if (key_status != KeyManager::VerifyResult::Unknown) {
+		// The title key has already been decrypted,
+		// or the common key couldn't be verified.
+		return (key_status == KeyManager::VerifyResult::OK ? 0 : -ENOENT);
+	}
+
+	// TODO: WiiVerifyKeys class.
+	KeyManager *const keyManager = KeyManager::instance();
+	assert(keyManager != nullptr);
+
+	// Key verification data.
+	// TODO: Move out of WiiPartition and into WiiVerifyKeys?
+	const char *const keyName = WiiPartition::encryptionKeyName_static(key_idx);
+	const uint8_t *const verifyData = WiiPartition::encryptionVerifyData_static(key_idx);
+	assert(keyName != nullptr);
+	assert(keyName[0] != '\0');
+	assert(verifyData != nullptr);
+
+	// Get and verify the key.
+	KeyManager::KeyData_t keyData;
+	key_status = keyManager->getAndVerify(keyName, &keyData, verifyData, 16);
+	if (key_status != KeyManager::VerifyResult::OK) {
+		// Unable to get and verify the key.
+		return -ENOENT;
+	}
+
+	// Create a cipher to decrypt the title key.
+	IAesCipher *cipher = AesCipherFactory::create();
+
+	// Initialize parameters for title key decryption.
+	// TODO: Error checking.
+	// Parameters:
+	// - Chaining mode: CBC
+	// - IV: Title ID (little-endian)
+	cipher->setChainingMode(IAesCipher::ChainingMode::CBC);
+	cipher->setKey(keyData.key, keyData.length);
+	// Title key IV: High 8 bytes are the title ID (in big-endian), low 8 bytes are 0.
+	uint8_t iv[16];
+	memcpy(iv, &ticket.title_id.id, sizeof(ticket.title_id.id));
+	memset(&iv[8], 0, 8);
+	cipher->setIV(iv, sizeof(iv));
+
+	// Decrypt the title key.
+	memcpy(dec_title_key, ticket.enc_title_key, sizeof(ticket.enc_title_key));
+	cipher->decrypt(dec_title_key, sizeof(dec_title_key));
+	delete cipher;
+	return 0;
+}
+
+/**
+ * Open the CBC reader for the boot content if it isn't already opened.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WiiWADPrivate::openCBCReader(void)
+{
+	if (cbcReader) {
+		// CBC reader is already open.
+		return 0;
+	} else if (!file || !file->isOpen()) {
+		// File isn't open.
+		return -EBADF;
+	} else if (!pIMETContent) {
+		// No boot content...
+		return -ENOENT;
+	}
+
+	int ret = decryptTitleKey();
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Data area IV:
+	// - First two bytes are the big-endian content index.
+	// - Remaining bytes are zero.
+	uint8_t iv[16];
+	memcpy(iv, &pIMETContent->index, sizeof(pIMETContent->index));
+	memset(&iv[2], 0, sizeof(iv)-2);
+
+	// Create a CBC reader to decrypt the data section.
+	// TODO: Verify some known data?
+	cbcReader = new CBCReader(file,
+		data_offset, data_size, dec_title_key, iv);
+	if (!cbcReader->isOpen()) {
+		// Unable to open a CBC reader.
+		ret = -cbcReader->lastError();
+		if (ret == 0) {
+			ret = -EIO;
+		}
+		UNREF_AND_NULL(cbcReader);
+		return ret;
+	}
+	return 0;
+}
+
+/**
+ * Load the main content object and the IMET header.
+ * This is only done once; subsequent calls do nothing.
+ */
+void WiiWADPrivate::loadMainContent(void)
+{
+	if (mainContentLoaded) {
+		// Already loaded.
+		return;
+	} else if (!isValid || !file || !file->isOpen()) {
+		// Can't load anything.
+		return;
+	}
+	mainContentLoaded = true;
+
+	// Verify the common key and decrypt the title key.
+	// NOTE: This also sets key_status for the field data.
+	if (decryptTitleKey() != 0) {
+		// Unable to decrypt the title key.
+		return;
+	}
+
+	if (tmdHeader.title_id.sysID == cpu_to_be16(NINTENDO_SYSID_TWL)) {
+		// Nintendo DSi: Main content is an SRL.
+		openSRL();
+		return;
+	}
+
+	if (openCBCReader() != 0) {
+		// Unable to decrypt the boot content.
+		return;
+	}
+
+	// Wii: Contents may be one of the following:
+	// - IMET header: Most common.
+	// - WIBN header: DLC titles.
+	size_t size = cbcReader->seekAndRead(imetContentOffset, &imet, sizeof(imet));
+	if (size == sizeof(imet) &&
+	    imet.magic == cpu_to_be32(WII_IMET_MAGIC))
+	{
+		// This is an IMET header.
+		// TODO: Do something here?
+	} else if (size >= (offsetof(Wii_IMET_t, magic) + sizeof(imet.magic)) &&
+		   imet.magic == cpu_to_be32(WII_WIBN_MAGIC))
+	{
+		// This is a WIBN header.
+		// Create the PartitionFile and WiiWIBN subclass.
+		// NOTE: Not sure how big the WIBN data is, so we'll
+		// allow it to read the rest of the file.
+		PartitionFile *const ptFile = new PartitionFile(cbcReader,
+			offsetof(Wii_IMET_t, magic),
+			be64_to_cpu(pIMETContent->size) - offsetof(Wii_IMET_t, magic));
+		if (ptFile->isOpen()) {
+			// Open the WiiWIBN.
+			WiiWIBN *const wibn = new WiiWIBN(ptFile);
+			if (wibn->isOpen()) {
+				// Opened successfully.
+				mainContent = wibn;
+			} else {
+				// Unable to open the WiiWIBN.
+				UNREF(wibn);
+			}
+		}
+		UNREF(ptFile);
+	} else {
+		// Sometimes the IMET header has a 64-byte offset.
+		// FIXME: Figure out why.
+		size = cbcReader->seekAndRead(imetContentOffset + 64, &imet, sizeof(imet));
+		if (size == sizeof(imet) &&
+		    imet.magic == cpu_to_be32(WII_IMET_MAGIC))
+		{
+			// This is an IMET header.
+			// TODO: Do something here?
+		}
+	}
+}
+
+/**
+ * Pipelined SHA-1 calculation for WAD contents.
+ *
+ * The calling thread reads and decrypts the content into a ring
+ * of buffers, and a worker thread hashes them, so decryption and
+ * hashing overlap. If the worker thread can't be created, the
+ * calling thread hashes the data itself.
+ */
+class WiiWADContentHasher
+{
+	public:
+		WiiWADContentHasher();
+
+	private:
+		RP_DISABLE_COPY(WiiWADContentHasher)
+
+	public:
+		/**
+		 * Calculate the SHA-1 hash of a content.
+		 * @param reader	[in] Content reader (decrypted)
+		 * @param size		[in] Content size
+		 * @param sha1		[out] SHA-1 hash
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int run(IDiscReader *reader, uint64_t size, uint8_t sha1[20]);
+
+	private:
+		/**
+		 * Hash worker thread function.
+		 * @param param WiiWADContentHasher
+		 */
+		static void workerFunc(void *param);
+
+		// Size of each read buffer.
+		static const size_t BUF_SIZE = 256U*1024U;
+		// Number of read buffers.
+		static const unsigned int BUF_COUNT = 2;
+
+		struct Buffer {
+			std::unique_ptr<uint8_t[]> data;
+			size_t size;	// 0 == end of content
+		};
+
+		Buffer m_bufs[BUF_COUNT];
+		Semaphore m_free;	// Number of buffers available to the reader.
+		Semaphore m_filled;	// Number of buffers available to the worker.
+		Hash m_hash;
+};
+
+WiiWADContentHasher::WiiWADContentHasher()
+	: m_free(BUF_COUNT)
+	, m_filled(0)
+	, m_hash(Hash::Algorithm::SHA1)
+{
+	for (Buffer &buf : m_bufs) {
+		buf.data.reset(new uint8_t[BUF_SIZE]);
+		buf.size = 0;
+	}
+}
+
+/**
+ * Hash worker thread function.
+ * @param param WiiWADContentHasher
+ */
+void WiiWADContentHasher::workerFunc(void *param)
+{
+	WiiWADContentHasher *const hasher = static_cast<WiiWADContentHasher*>(param);
+
+	for (unsigned int slot = 0;; slot = (slot + 1) % BUF_COUNT) {
+		hasher->m_filled.obtain();
+		const Buffer &buf = hasher->m_bufs[slot];
+		if (buf.size == 0) {
+			// End of content.
+			break;
+		}
+		hasher->m_hash.process(buf.data.get(), buf.size);
+		hasher->m_free.release();
+	}
+}
+
+/**
+ * Calculate the SHA-1 hash of a content.
+ * @param reader	[in] Content reader (decrypted)
+ * @param size		[in] Content size
+ * @param sha1		[out] SHA-1 hash
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WiiWADContentHasher::run(IDiscReader *reader, uint64_t size, uint8_t sha1[20])
+{
+	m_hash.reset();
+	Thread thread;
+	const bool isRunning = (thread.create(workerFunc, this) == 0);
+
+	int ret = 0;
+	reader->rewind();
+	for (unsigned int slot = 0;; slot = (slot + 1) % BUF_COUNT) {
+		m_free.obtain();
+		Buffer &buf = m_bufs[slot];
+		if (ret == 0 && size > 0) {
+			const size_t toRead = (size < BUF_SIZE ? static_cast<size_t>(size) : BUF_SIZE);
+			buf.size = reader->read(buf.data.get(), toRead);
+			if (buf.size != toRead) {
+				// Short read. Stop hashing after this buffer.
+				ret = -EIO;
+				buf.size = 0;
+			}
+			size -= buf.size;
+		} else {
+			// End of content.
+			buf.size = 0;
+		}
+
+		if (isRunning) {
+			m_filled.release();
+		} else if (buf.size != 0) {
+			m_hash.process(buf.data.get(), buf.size);
+			m_free.release();
+		}
+
+		if (buf.size == 0) {
+			// End of content.
+			break;
+		}
+	}
+
+	// Wait for the worker to finish.
+	if (isRunning) {
+		thread.join();
+	}
+	// The end-of-content buffer is available again.
+	m_free.release();
+
+	if (ret != 0) {
+		return ret;
+	}
+	return m_hash.getHash(sha1, 20);
+}
+
+/**
+ * Verify the SHA-1 hashes of the TMD contents.
+ * This reads and decrypts the entire data area.
+ * @param pBadIdx	[out] Index of the first invalid content, or -1 if all are valid.
+ * @return Number of contents verified on success; negative POSIX error code on error.
+ */
+int WiiWADPrivate::verifyContents(int *pBadIdx)
+{
+	assert(pBadIdx != nullptr);
+	*pBadIdx = -1;
+	if (!file || !file->isOpen()) {
+		// File isn't open.
+		return -EBADF;
+	} else if (tmdContentsTbl.empty()) {
+		// No contents.
+		return -ENOENT;
+	}
+
+	int ret = decryptTitleKey();
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Contents are stored in TMD order, and each
+	// content starts on a 64-byte boundary.
+	WiiWADContentHasher hasher;
+	uint64_t content_offset = 0;
+	int count = 0;
+	for (const RVL_Content_Entry &entry : tmdContentsTbl) {
+		const uint64_t size = be64_to_cpu(entry.size);
+		const uint64_t enc_size = (size + 15) & ~15ULL;
+		if (content_offset + enc_size > data_size) {
+			// Content isn't present in the WAD.
+			return -EIO;
+		}
+
+		// Content IV:
+		// - First two bytes are the big-endian content index.
+		// - Remaining bytes are zero.
+		uint8_t iv[16];
+		memcpy(iv, &entry.index, sizeof(entry.index));
+		memset(&iv[2], 0, sizeof(iv)-2);
+
+		CBCReader *const reader = new CBCReader(file,
+			data_offset + content_offset, enc_size, dec_title_key, iv);
+		uint8_t sha1[20];
+		ret = (reader->isOpen() ? hasher.run(reader, size, sha1) : -EIO);
+		reader->unref();
+		if (ret != 0) {
+			return ret;
+		}
+
+		if (memcmp(sha1, entry.sha1_hash, sizeof(sha1)) != 0) {
+			// Hash mismatch.
+			*pBadIdx = count;
+			return count;
+		}
+
+		count++;
+		content_offset += toNext64(size);
+	}
+
+	return count;
+}
 #endif /* ENABLE_DECRYPTION */
 
 /** WiiWAD **/
@@ -378,112 +751,8 @@ WiiWAD::WiiWAD(IRpFile *file)
 	d->isValid = true;
 
 #ifdef ENABLE_DECRYPTION
-	// Initialize the CBC reader for the main data area.
-
-	// TODO: WiiVerifyKeys class.
-	KeyManager *const keyManager = KeyManager::instance();
-	assert(keyManager != nullptr);
-
-	// Key verification data.
-	// TODO: Move out of WiiPartition and into WiiVerifyKeys?
-	const char *const keyName = WiiPartition::encryptionKeyName_static(d->key_idx);
-	const uint8_t *const verifyData = WiiPartition::encryptionVerifyData_static(d->key_idx);
-	assert(keyName != nullptr);
-	assert(keyName[0] != '\0');
-	assert(verifyData != nullptr);
-
-	// Get and verify the key.
-	KeyManager::KeyData_t keyData;
-	d->key_status = keyManager->getAndVerify(keyName, &keyData, verifyData, 16);
-	if (d->key_status != KeyManager::VerifyResult::OK) {
-		// Unable to get and verify the key.
-		return;
-	}
-
-	// Create a cipher to decrypt the title key.
-	IAesCipher *cipher = AesCipherFactory::create();
-
-	// Initialize parameters for title key decryption.
-	// TODO: Error checking.
-	// Parameters:
-	// - Chaining mode: CBC
-	// - IV: Title ID (little-endian)
-	cipher->setChainingMode(IAesCipher::ChainingMode::CBC);
-	cipher->setKey(keyData.key, keyData.length);
-	// Title key IV: High 8 bytes are the title ID (in big-endian), low 8 bytes are 0.
-	uint8_t iv[16];
-	memcpy(iv, &d->ticket.title_id.id, sizeof(d->ticket.title_id.id));
-	memset(&iv[8], 0, 8);
-	cipher->setIV(iv, sizeof(iv));
-	
-	// Decrypt the title key.
-	memcpy(d->dec_title_key, d->ticket.enc_title_key, sizeof(d->ticket.enc_title_key));
-	cipher->decrypt(d->dec_title_key, sizeof(d->dec_title_key));
-	delete cipher;
-
-	if (!d->pIMETContent) {
-		// No boot content...
-		return;
-	}
-
-	// Data area IV:
-	// - First two bytes are the big-endian content index.
-	// - Remaining bytes are zero.
-	memcpy(iv, &d->pIMETContent->index, sizeof(d->pIMETContent->index));
-	memset(&iv[2], 0, sizeof(iv)-2);
-
-	// Create a CBC reader to decrypt the data section.
-	// TODO: Verify some known data?
-	d->cbcReader = new CBCReader(d->file,
-		d->data_offset, d->data_size, d->dec_title_key, iv);
-
-	if (d->tmdHeader.title_id.sysID != cpu_to_be16(3)) {
-		// Wii: Contents may be one of the following:
-		// - IMET header: Most common.
-		// - WIBN header: DLC titles.
-		size = d->cbcReader->seekAndRead(d->imetContentOffset, &d->imet, sizeof(d->imet));
-		if (size == sizeof(d->imet) &&
-		    d->imet.magic == cpu_to_be32(WII_IMET_MAGIC))
-		{
-			// This is an IMET header.
-			// TODO: Do something here?
-		} else if (size >= (offsetof(Wii_IMET_t, magic) + sizeof(d->imet.magic)) &&
-			   d->imet.magic == cpu_to_be32(WII_WIBN_MAGIC))
-		{
-			// This is a WIBN header.
-			// Create the PartitionFile and WiiWIBN subclass.
-			// NOTE: Not sure how big the WIBN data is, so we'll
-			// allow it to read the rest of the file.
-			PartitionFile *const ptFile = new PartitionFile(d->cbcReader,
-				offsetof(Wii_IMET_t, magic),
-				be64_to_cpu(d->pIMETContent->size) - offsetof(Wii_IMET_t, magic));
-			if (ptFile->isOpen()) {
-				// Open the WiiWIBN.
-				WiiWIBN *const wibn = new WiiWIBN(ptFile);
-				if (wibn->isOpen()) {
-					// Opened successfully.
-					d->mainContent = wibn;
-				} else {
-					// Unable to open the WiiWIBN.
-					UNREF(wibn);
-				}
-			}
-			UNREF(ptFile);
-		} else {
-			// Sometimes the IMET header has a 64-byte offset.
-			// FIXME: Figure out why.
-			size = d->cbcReader->seekAndRead(d->imetContentOffset + 64, &d->imet, sizeof(d->imet));
-			if (size == sizeof(d->imet) &&
-			    d->imet.magic == cpu_to_be32(WII_IMET_MAGIC))
-			{
-				// This is an IMET header.
-				// TODO: Do something here?
-			}
-		}
-	} else {
-		// Nintendo DSi: Main content is an SRL.
-		d->openSRL();
-	}
+	// NOTE: The title key is decrypted and the main content
+	// is loaded on demand by WiiWADPrivate::loadMainContent().
 #else /* !ENABLE_DECRYPTION */
 	// Cannot decrypt anything...
 	d->key_status = KeyManager::VerifyResult::NoSupport;
@@ -692,6 +961,7 @@ uint32_t WiiWAD::supportedImageTypes(void) const
 	RP_D(const WiiWAD);
 	uint32_t ret;
 #ifdef ENABLE_DECRYPTION
+	const_cast<WiiWADPrivate*>(d)->loadMainContent();
 	if (d->mainContent) {
 		// TODO: Verify external types?
 		ret = d->mainContent->supportedImageTypes() |
@@ -796,6 +1066,9 @@ vector<RomData::ImageSizeDef> WiiWAD::supportedImageSizes(ImageType imageType) c
 {
 	ASSERT_supportedImageSizes(imageType);
 	RP_D(const WiiWAD);
+#ifdef ENABLE_DECRYPTION
+	const_cast<WiiWADPrivate*>(d)->loadMainContent();
+#endif /* ENABLE_DECRYPTION */
 
 	if (d->tmdHeader.title_id.sysID != cpu_to_be16(3)) {
 		// WiiWare
@@ -891,6 +1164,7 @@ uint32_t WiiWAD::imgpf(ImageType imageType) const
 
 #ifdef ENABLE_DECRYPTION
 	RP_D(const WiiWAD);
+	const_cast<WiiWADPrivate*>(d)->loadMainContent();
 	if (d->mainContent) {
 		// Get imgpf from the main content object.
 		return d->mainContent->imgpf(imageType);
@@ -923,9 +1197,15 @@ int WiiWAD::loadFieldData(void)
 	// WAD headers are read in the constructor.
 	const RVL_TMD_Header *const tmdHeader = &d->tmdHeader;
 	const uint16_t sys_id = be16_to_cpu(tmdHeader->title_id.sysID);
-	d->fields->reserve(12);	// Maximum of 12 fields.
+	d->fields->reserve(13);	// Maximum of 13 fields.
 	d->fields->setTabName(0, (sys_id != NINTENDO_SYSID_TWL) ? "WAD" : "TAD");
 
+#ifdef ENABLE_DECRYPTION
+	// Load the main content object.
+	// This also verifies the decryption key.
+	d->loadMainContent();
+#endif /* ENABLE_DECRYPTION */
+
 	if (d->key_status != KeyManager::VerifyResult::OK) {
 		// Unable to get the decryption key.
 		const char *err = KeyManager::verifyResultToString(d->key_status);
@@ -1177,6 +1457,26 @@ int WiiWAD::loadFieldData(void)
 		RomFields::STRF_MONOSPACE);
 
 #ifdef ENABLE_DECRYPTION
+	// Content hashes. (optional; reads the entire WAD)
+	if (d->key_status == KeyManager::VerifyResult::OK && RomChecksum::isEnabled()) {
+		int badIdx;
+		const int count = d->verifyContents(&badIdx);
+		const char *const contents_title = C_("WiiWAD", "Contents");
+		if (count < 0) {
+			d->fields->addField_string(contents_title,
+				C_("WiiWAD", "Unable to verify the contents."));
+		} else if (badIdx >= 0) {
+			d->fields->addField_string(contents_title,
+				rp_sprintf_p(C_("WiiWAD", "Content %1$u (ID %2$08X) is INVALID"),
+					static_cast<unsigned int>(badIdx),
+					be32_to_cpu(d->tmdContentsTbl[badIdx].content_id)));
+		} else {
+			d->fields->addField_string(contents_title,
+				rp_sprintf(NC_("WiiWAD", "%u content is valid", "All %u contents are valid", count),
+					static_cast<unsigned int>(count)));
+		}
+	}
+
 	// Do we have a main content object?
 	// If so, we don't have IMET data.
 	// TODO: Decrypt Wii content.bin for more stuff?
@@ -1231,6 +1531,7 @@ int WiiWAD::loadMetaData(void)
 	if (be16_to_cpu(d->tmdHeader.title_id.sysID) == NINTENDO_SYSID_TWL) {
 		// DSi TAD package.
 		// Get the metadata from the SRL if it's available.
+		d->loadMainContent();
 		if (d->mainContent) {
 			const RomMetaData *const srlMetaData = d->mainContent->metaData();
 			if (srlMetaData && !srlMetaData->empty()) {
@@ -1292,6 +1593,7 @@ int WiiWAD::loadInternalImage(ImageType imageType, const rp_image **pImage)
 
 #ifdef ENABLE_DECRYPTION
 	// Forward this call to the main content object.
+	d->loadMainContent();
 	if (d->mainContent) {
 		return d->mainContent->loadInternalImage(imageType, pImage);
 	}
@@ -1318,6 +1620,7 @@ const IconAnimData *WiiWAD::iconAnimData(void) const
 #ifdef ENABLE_DECRYPTION
 	// Forward this call to the main content object.
 	RP_D(const WiiWAD);
+	const_cast<WiiWADPrivate*>(d)->loadMainContent();
 	if (d->mainContent) {
 		return d->mainContent->iconAnimData();
 	}
@@ -104,10 +104,14 @@ class WiiWADPrivate final : public LibRpBase::RomDataPrivate
 		LibRpBase::RomData *mainContent;	// WiiWIBN or NintendoDS
 
 		// Decrypted title key.
+		// Only valid if key_status == KeyManager::VerifyResult::OK.
 		uint8_t dec_title_key[16];
 
 		// Main data headers.
 		Wii_IMET_t imet;	// NOTE: May be WIBN.
+
+		// Set once loadMainContent() has been called.
+		bool mainContentLoaded;
 #endif /* ENABLE_DECRYPTION */
 
 		// Key index.
@@ -122,6 +126,33 @@ class WiiWADPrivate final : public LibRpBase::RomDataPrivate
 		std::string getGameInfo(void);
 
 #ifdef ENABLE_DECRYPTION
+		/**
+		 * Verify the common key and decrypt the title key, if it hasn't been done yet.
+		 * This sets key_status.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int decryptTitleKey(void);
+
+		/**
+		 * Open the CBC reader for the boot content if it isn't already opened.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int openCBCReader(void);
+
+		/**
+		 * Load the main content object and the IMET header.
+		 * This is only done once; subsequent calls do nothing.
+		 */
+		void loadMainContent(void);
+
+		/**
+		 * Verify the SHA-1 hashes of the TMD contents.
+		 * This reads and decrypts the entire data area.
+		 * @param pBadIdx	[out] Index of the first invalid content, or -1 if all are valid.
+		 * @return Number of contents verified on success; negative POSIX error code on error.
+		 */
+		int verifyContents(int *pBadIdx);
+
 		/**
 		 * Open the SRL if it isn't already opened.
 		 * This operation only works for DSi TAD packages.
@@ -132,6 +132,17 @@ class Xbox360_STFS_Private final : public RomDataPrivate
 		 */
 		int32_t dataBlockNumberToPhys(int dataBlockNumber);
 
+		/**
+		 * Read consecutive data blocks.
+		 * Hash blocks are skipped. Data blocks that are physically
+		 * contiguous are read with a single read.
+		 * @param dataBlockNumber	[in] First data block number.
+		 * @param ptr			[out] Output buffer.
+		 * @param size			[in] Number of bytes to read.
+		 * @return Number of bytes read.
+		 */
+		size_t readDataBlocks(int32_t dataBlockNumber, void *ptr, size_t size);
+
 		/**
 		 * Load the file table.
 		 * @return 0 on success; negative POSIX error code on error.
@@ -362,6 +373,53 @@ int32_t Xbox360_STFS_Private::dataBlockNumberToPhys(int dataBlockNumber)
 	return ret;
 }
 
+/**
+ * Read consecutive data blocks.
+ * Hash blocks are skipped. Data blocks that are physically
+ * contiguous are read with a single read.
+ * @param dataBlockNumber	[in] First data block number.
+ * @param ptr			[out] Output buffer.
+ * @param size			[in] Number of bytes to read.
+ * @return Number of bytes read.
+ */
+size_t Xbox360_STFS_Private::readDataBlocks(int32_t dataBlockNumber, void *ptr, size_t size)
+{
+	uint8_t *p = static_cast<uint8_t*>(ptr);
+	size_t total = 0;
+	while (size > 0) {
+		// Find the run of data blocks that are physically contiguous.
+		// A hash block is inserted every 0xAA data blocks, so runs
+		// are at most 0xAA blocks long.
+		const int32_t physStart = dataBlockNumberToPhys(dataBlockNumber);
+		int32_t count = 1;
+		size_t runSize = std::min<size_t>(size, STFS_BLOCK_SIZE);
+		while (runSize < size &&
+		       dataBlockNumberToPhys(dataBlockNumber + count) == physStart + count)
+		{
+			count++;
+			runSize = std::min<size_t>(size, static_cast<size_t>(count) * STFS_BLOCK_SIZE);
+		}
+
+		const int32_t offset = blockNumberToOffset(physStart);
+		if (offset < 0) {
+			// Invalid block number.
+			break;
+		}
+		const size_t sz_read = file->seekAndRead(offset, p, runSize);
+		total += sz_read;
+		if (sz_read != runSize) {
+			// Seek and/or read error.
+			break;
+		}
+
+		p += runSize;
+		size -= runSize;
+		dataBlockNumber += count;
+	}
+
+	return total;
+}
+
 /**
  * Load the file table.
  * @return 0 on success; negative POSIX error code on error.
@@ -399,20 +457,21 @@ int Xbox360_STFS_Private::loadFileTable(void)
 		(stfsMetadata.stfs_desc.file_table_block_number[0] << 16) |
 		(stfsMetadata.stfs_desc.file_table_block_number[1] <<  8) |
 		 stfsMetadata.stfs_desc.file_table_block_number[2];
-	const int32_t offset = blockNumberToOffset(dataBlockNumberToPhys(blockNumber));
-	if (offset < 0) {
+	if (blockNumberToOffset(dataBlockNumberToPhys(blockNumber)) < 0) {
 		// Invalid block number.
 		return -EIO;
 	}
 
 	// Load the file table.
+	// NOTE: The file table may span a hash block,
+	// so it has to be read using readDataBlocks().
 	size_t fileTableSize = ((uint32_t)blockCount * STFS_BLOCK_SIZE);
 	assert(fileTableSize % sizeof(STFS_DirEntry_t) == 0);
 	if (fileTableSize % sizeof(STFS_DirEntry_t) != 0) {
 		fileTableSize += sizeof(STFS_DirEntry_t);
 	}
 	fileTable.resize(fileTableSize / sizeof(STFS_DirEntry_t));
-	size_t size = file->seekAndRead(offset, fileTable.data(), fileTableSize);
+	size_t size = readDataBlocks(blockNumber, fileTable.data(), fileTableSize);
 	if (size != fileTableSize) {
 		// Seek and/or read error.
 		fileTable.clear();
@@ -15,9 +15,11 @@
 // librpbase, librpfile, librptexture
 #include "librpbase/img/RpPng.hpp"
 #include "librpfile/RpMemFile.hpp"
+#include "librpfile/SubFile.hpp"
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
 using LibRpFile::RpMemFile;
+using LibRpFile::SubFile;
 using LibRpTexture::rp_image;
 
 // C++ STL classes.
@@ -68,6 +70,19 @@ class Xbox360_XDBF_Private final : public RomDataPrivate
 		// - Value: rp_image*
 		unordered_map<uint64_t, rp_image*> map_images;
 
+		// Image IDs for the deferred RFT_LISTDATA icons, indexed by row.
+		// Icons are decoded by RomFields::listDataIcon() when a row is shown.
+		// NO_IMAGE_ID is used for rows without an icon.
+		enum : uint32_t { NO_IMAGE_ID = ~0U };
+		vector<uint32_t> xach_image_ids;	// Achievements
+		vector<uint32_t> xgaa_image_ids;	// Avatar Awards
+
+		// Compressed PNG data for deferred icons that weren't
+		// decoded before the file was closed.
+		// - Key: resource_id
+		// - Value: PNG data
+		unordered_map<uint64_t, ao::uvector<uint8_t> > map_pngData;
+
 	public:
 		// XDBF header.
 		XDBF_Header xdbfHeader;
@@ -157,6 +172,36 @@ class Xbox360_XDBF_Private final : public RomDataPrivate
 		 */
 		rp_image *loadImage(uint64_t image_id);
 
+		/**
+		 * Load a deferred icon. (RomFields::pfnListDataIconLoader_t)
+		 * @param image_ids	[in,out] Image IDs, indexed by row.
+		 * @param row		[in] Row index.
+		 * @return Icon, or nullptr if the row doesn't have an icon.
+		 */
+		const rp_image *loadDeferredIcon(vector<uint32_t> &image_ids, unsigned int row);
+
+		/**
+		 * Load a deferred achievement icon.
+		 * @param userdata	[in] Xbox360_XDBF_Private
+		 * @param row		[in] Row index.
+		 * @return Icon, or nullptr if the row doesn't have an icon.
+		 */
+		static const rp_image *loadAchievementIcon(void *userdata, unsigned int row);
+
+		/**
+		 * Load a deferred avatar award icon.
+		 * @param userdata	[in] Xbox360_XDBF_Private
+		 * @param row		[in] Row index.
+		 * @return Icon, or nullptr if the row doesn't have an icon.
+		 */
+		static const rp_image *loadAvatarAwardIcon(void *userdata, unsigned int row);
+
+		/**
+		 * Save the compressed PNG data for deferred icons that haven't
+		 * been decoded yet, so they can still be shown after close().
+		 */
+		void savePendingIconData(void);
+
 		/**
 		 * Load the main title icon.
 		 * @return Icon, or nullptr on error.
@@ -707,6 +752,21 @@ rp_image *Xbox360_XDBF_Private::loadImage(uint64_t image_id)
 		return iter->second;
 	}
 
+	// Was the PNG data saved by close()?
+	auto png_iter = map_pngData.find(image_id);
+	if (png_iter != map_pngData.end()) {
+		RpMemFile *const f_mem = new RpMemFile(png_iter->second.data(), png_iter->second.size());
+		rp_image *img = RpPng::load(f_mem);
+		f_mem->unref();
+		map_pngData.erase(png_iter);
+
+		if (img) {
+			// Save the image for later use.
+			map_images.insert(std::make_pair(image_id, img));
+		}
+		return img;
+	}
+
 	if (entryTable.empty()) {
 		// Entry table isn't loaded...
 		return nullptr;
@@ -740,18 +800,11 @@ rp_image *Xbox360_XDBF_Private::loadImage(uint64_t image_id)
 		return nullptr;
 	}
 
-	unique_ptr<uint8_t[]> png_buf(new uint8_t[length]);
-	size_t size = file->seekAndRead(addr, png_buf.get(), length);
-	if (size != length) {
-		// Seek and/or read error.
-		return nullptr;
-	}
-
-	// Create an RpMemFile and decode the image.
+	// Decode the image in place using a SubFile view.
 	// TODO: For rpcli, shortcut to extract the PNG directly.
-	RpMemFile *const f_mem = new RpMemFile(png_buf.get(), length);
-	rp_image *img = RpPng::load(f_mem);
-	f_mem->unref();
+	SubFile *const f_png = new SubFile(file, addr, length);
+	rp_image *img = RpPng::load(f_png);
+	f_png->unref();
 
 	if (img) {
 		// Save the image for later use.
@@ -761,6 +814,93 @@ rp_image *Xbox360_XDBF_Private::loadImage(uint64_t image_id)
 	return img;
 }
 
+/**
+ * Load a deferred icon. (RomFields::pfnListDataIconLoader_t)
+ * @param image_ids	[in,out] Image IDs, indexed by row.
+ * @param row		[in] Row index.
+ * @return Icon, or nullptr if the row doesn't have an icon.
+ */
+const rp_image *Xbox360_XDBF_Private::loadDeferredIcon(vector<uint32_t> &image_ids, unsigned int row)
+{
+	if (row >= image_ids.size() || image_ids[row] == NO_IMAGE_ID) {
+		// No icon for this row.
+		return nullptr;
+	}
+
+	const rp_image *const img = loadImage(image_ids[row]);
+	if (!img) {
+		// Don't try loading this icon again.
+		image_ids[row] = NO_IMAGE_ID;
+	}
+	return img;
+}
+
+/**
+ * Load a deferred achievement icon.
+ * @param userdata	[in] Xbox360_XDBF_Private
+ * @param row		[in] Row index.
+ * @return Icon, or nullptr if the row doesn't have an icon.
+ */
+const rp_image *Xbox360_XDBF_Private::loadAchievementIcon(void *userdata, unsigned int row)
+{
+	Xbox360_XDBF_Private *const d = static_cast<Xbox360_XDBF_Private*>(userdata);
+	return d->loadDeferredIcon(d->xach_image_ids, row);
+}
+
+/**
+ * Load a deferred avatar award icon.
+ * @param userdata	[in] Xbox360_XDBF_Private
+ * @param row		[in] Row index.
+ * @return Icon, or nullptr if the row doesn't have an icon.
+ */
+const rp_image *Xbox360_XDBF_Private::loadAvatarAwardIcon(void *userdata, unsigned int row)
+{
+	Xbox360_XDBF_Private *const d = static_cast<Xbox360_XDBF_Private*>(userdata);
+	return d->loadDeferredIcon(d->xgaa_image_ids, row);
+}
+
+/**
+ * Save the compressed PNG data for deferred icons that haven't
+ * been decoded yet, so they can still be shown after close().
+ */
+void Xbox360_XDBF_Private::savePendingIconData(void)
+{
+	if (!file || !isValid || entryTable.empty()) {
+		// Can't load anything.
+		return;
+	}
+
+	for (const vector<uint32_t> *pImageIDs : {&xach_image_ids, &xgaa_image_ids}) {
+		for (const uint32_t image_id : *pImageIDs) {
+			if (image_id == NO_IMAGE_ID ||
+			    map_images.find(image_id) != map_images.end() ||
+			    map_pngData.find(image_id) != map_pngData.end())
+			{
+				// No icon, or the icon has already been loaded.
+				continue;
+			}
+
+			const XDBF_Entry *const entry = findResource(XDBF_SPA_NAMESPACE_IMAGE, image_id);
+			if (!entry) {
+				continue;
+			}
+			const uint32_t addr = be32_to_cpu(entry->offset) + this->data_offset;
+			const uint32_t length = be32_to_cpu(entry->length);
+			if (length < 16 || length > 1024*1024) {
+				// Size is out of range.
+				continue;
+			}
+
+			ao::uvector<uint8_t> pngData;
+			pngData.resize(length);
+			size_t size = file->seekAndRead(addr, pngData.data(), length);
+			if (size == length) {
+				map_pngData.emplace(image_id, std::move(pngData));
+			}
+		}
+	}
+}
+
 /**
  * Load the main title icon.
  * @return Icon, or nullptr on error.
@@ -1001,13 +1141,14 @@ int Xbox360_XDBF_Private::addFields_achievements_SPA(void)
 			? new RomFields::ListData_t(xach_count)
 			: nullptr;
 	}
+	// Icons are loaded when the rows are shown.
 	auto vv_icons = new RomFields::ListDataIcons_t(xach_count);
-	auto icon_iter = vv_icons->begin();
-	for (unsigned int i = 0; p < p_end && i < xach_count; p++, i++, ++icon_iter) {
+	xach_image_ids.assign(xach_count, NO_IMAGE_ID);
+	for (unsigned int i = 0; p < p_end && i < xach_count; p++, i++) {
 		// NOTE: Not deduplicating strings here.
 
 		// Icon
-		*icon_iter = loadImage(be32_to_cpu(p->image_id));
+		xach_image_ids[i] = be32_to_cpu(p->image_id);
 
 		// Achievement IDs.
 		const uint16_t name_id = be16_to_cpu(p->name_id);
@@ -1107,6 +1248,8 @@ int Xbox360_XDBF_Private::addFields_achievements_SPA(void)
 	params.col_attrs.sort_col	= 0;	// ID
 	params.col_attrs.sort_dir	= RomFields::COLSORTORDER_ASCENDING;
 	params.mxd.icons = vv_icons;
+	params.iconLoader.func = loadAchievementIcon;
+	params.iconLoader.userdata = this;
 	fields->addField_listData(C_("Xbox360_XDBF", "Achievements"), &params);
 	return 0;
 }
@@ -1213,13 +1356,14 @@ int Xbox360_XDBF_Private::addFields_avatarAwards_SPA(void)
 			? new RomFields::ListData_t(xgaa_count)
 			: nullptr;
 	}
+	// Icons are loaded when the rows are shown.
 	auto vv_icons = new RomFields::ListDataIcons_t(xgaa_count);
-	auto icon_iter = vv_icons->begin();
-	for (unsigned int i = 0; p < p_end && i < xgaa_count; p++, i++, ++icon_iter) {
+	xgaa_image_ids.assign(xgaa_count, NO_IMAGE_ID);
+	for (unsigned int i = 0; p < p_end && i < xgaa_count; p++, i++) {
 		// NOTE: Not deduplicating strings here.
 
 		// Icon
-		*icon_iter = loadImage(be32_to_cpu(p->image_id));
+		xgaa_image_ids[i] = be32_to_cpu(p->image_id);
 
 		// Avatar award IDs.
 		const uint16_t name_id = be16_to_cpu(p->name_id);
@@ -1313,6 +1457,8 @@ int Xbox360_XDBF_Private::addFields_avatarAwards_SPA(void)
 	params.col_attrs.sort_dir	= RomFields::COLSORTORDER_ASCENDING;
 	params.data.multi = mvv_xgaa;
 	params.mxd.icons = vv_icons;
+	params.iconLoader.func = loadAvatarAwardIcon;
+	params.iconLoader.userdata = this;
 	fields->addField_listData(C_("Xbox360_XDBF", "Avatar Awards"), &params);
 	return 0;
 }
@@ -1388,7 +1534,7 @@ int Xbox360_XDBF_Private::addFields_strings_GPD(RomFields *fields) const
 	const char *const s_title_title = C_("RomData", "Title");
 	string s_title = const_cast<Xbox360_XDBF_Private*>(this)->loadString_GPD(XDBF_ID_TITLE);
 	if (!s_title.empty()) {
-		fields->addField_string(s_title_title, s_title);
+		fields->addField_string(s_title_title, std::move(s_title));
 	} else {
 		fields->addField_string(s_title_title, C_("RomData", "Unknown"));
 	}
@@ -1432,9 +1578,9 @@ int Xbox360_XDBF_Private::addFields_achievements_GPD(void)
 		"Xbox360_XDBF|Achievements", xach_col_names, ARRAY_SIZE(xach_col_names));
 
 	RomFields::ListData_t *vv_xach = new RomFields::ListData_t();
-	auto vv_icons = new RomFields::ListDataIcons_t();
 	vv_xach->reserve(16);
-	vv_icons->reserve(16);
+	xach_image_ids.clear();
+	xach_image_ids.reserve(16);
 
 	// GPD doesn't have an achievements table.
 	// Instead, each achievement is its own entry in the main resource table.
@@ -1481,7 +1627,8 @@ int Xbox360_XDBF_Private::addFields_achievements_GPD(void)
 		// Icon.
 		// TODO: Grayscale version if locked?
 		// NOTE: Most GPDs don't have achievement icons...
-		vv_icons->push_back(loadImage(be32_to_cpu(p->image_id)));
+		// Icons are loaded when the rows are shown.
+		xach_image_ids.push_back(be32_to_cpu(p->image_id));
 
 		// TODO: Localized numeric formatting?
 		char s_achievement_id[16];
@@ -1543,10 +1690,12 @@ int Xbox360_XDBF_Private::addFields_achievements_GPD(void)
 		// No achievements.
 		delete v_xach_col_names;
 		delete vv_xach;
-		delete vv_icons;
 		return -ENOENT;
 	}
 
+	// Icons are loaded when the rows are shown.
+	auto vv_icons = new RomFields::ListDataIcons_t(xach_image_ids.size());
+
 	// Add the list data.
 	RomFields::AFLD_PARAMS params(RomFields::RFT_LISTDATA_SEPARATE_ROW |
 	                              RomFields::RFT_LISTDATA_ICONS, 0);
@@ -1561,6 +1710,8 @@ int Xbox360_XDBF_Private::addFields_achievements_GPD(void)
 	params.col_attrs.sort_col	= 0;	// ID
 	params.col_attrs.sort_dir	= RomFields::COLSORTORDER_ASCENDING;
 	params.mxd.icons = vv_icons;
+	params.iconLoader.func = loadAchievementIcon;
+	params.iconLoader.userdata = this;
 	fields->addField_listData(C_("Xbox360_XDBF", "Achievements"), &params);
 	return 0;
 }
@@ -1707,6 +1858,75 @@ void Xbox360_XDBF::init(void)
 	d->initStrTblIndexes();
 }
 
+/**
+ * Close the opened file.
+ */
+void Xbox360_XDBF::close(void)
+{
+	// Deferred achievement icons can't be read once the file
+	// is closed, so save their compressed PNG data first.
+	RP_D(Xbox360_XDBF);
+	d->savePendingIconData();
+
+	// Call the superclass function.
+	super::close();
+}
+
+/**
+ * Get the approximate amount of memory used by this object.
+ * @return Approximate memory usage, in bytes.
+ */
+size_t Xbox360_XDBF::memoryUsage(void) const
+{
+	RP_D(const Xbox360_XDBF);
+	size_t total = super::memoryUsage();
+	total += d->entryTable.size() * sizeof(XDBF_Entry);
+	for (const ao::uvector<char> *pStrTbl : d->strTbls) {
+		if (pStrTbl) {
+			total += pStrTbl->size();
+		}
+	}
+	for (const auto &p : d->map_images) {
+		if (p.second) {
+			total += p.second->data_len();
+		}
+	}
+	for (const auto &p : d->map_pngData) {
+		total += p.second.size();
+	}
+	return total;
+}
+
+/**
+ * Release cached data that can be rebuilt on demand.
+ */
+void Xbox360_XDBF::releaseMemory(void)
+{
+	RP_D(Xbox360_XDBF);
+	if (!d->file) {
+		// File is closed. Nothing can be reloaded.
+		return;
+	}
+
+	// String tables are reloaded by loadStringTable().
+	for (ao::uvector<char> *&pStrTbl : d->strTbls) {
+		delete pStrTbl;
+		pStrTbl = nullptr;
+	}
+
+	// Achievement icons in the RomFields are owned by map_images,
+	// so the images can only be released if the fields weren't loaded.
+	if (d->fields->empty()) {
+		for (auto &p : d->map_images) {
+			UNREF(p.second);
+		}
+		d->map_images.clear();
+		d->img_icon = nullptr;
+	}
+
+	super::releaseMemory();
+}
+
 /** ROM detection functions. **/
 
 /**
@@ -18,10 +18,12 @@ namespace LibRomData {
 
 class Xbox360_XDBF_Private;
 ROMDATA_DECL_BEGIN(Xbox360_XDBF)
+ROMDATA_DECL_CLOSE()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
 ROMDATA_DECL_IMGINT()
+ROMDATA_DECL_MEMORY()
 
 	public:
 		/**
@@ -786,14 +786,29 @@ CBCReader *Xbox360_XEX_Private::initPeReader(void)
 			uint8_t *p_dblk = compressed_deblock.get();
 			uint8_t *const p_dblk_end = p_dblk + compressed_size;
 
-			// CBCReader index.
-			// If a block size is invalid, we'll switch to the other one.
-			// If both are invalid, we have a problem.
+			// Determine which key is in use before walking the block chain.
+			// The second block header is stored at the beginning of the
+			// compressed data, so only the first block has to be decrypted.
+			// If the key is wrong, the decrypted block size will be garbage.
 			unsigned int rd_idx = (reader[0] ? 0 : 1);
-			if (!reader[rd_idx]) {
-				// No readers available...
-				// FIXME: Not sure if this is needed...
-				UNREF(reader[!rd_idx]);
+			if (first_block.block_size != 0) {
+				rd_idx = ~0U;
+				for (unsigned int i = 0; i < 2; i++) {
+					if (!reader[i])
+						continue;
+					XEX2_Compression_Normal_Info next_block;
+					size = reader[i]->seekAndRead(0, &next_block, sizeof(next_block));
+					if (size == sizeof(next_block) && be32_to_cpu(next_block.block_size) <= 65536) {
+						// Block size is valid.
+						rd_idx = i;
+						break;
+					}
+				}
+			}
+			if (rd_idx > 1 || !reader[rd_idx]) {
+				// No usable readers...
+				UNREF(reader[0]);
+				UNREF(reader[1]);
 				return nullptr;
 			}
 
@@ -817,29 +832,9 @@ CBCReader *Xbox360_XEX_Private::initPeReader(void)
 #endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
 				if (lzx_blocks[!lzx_idx].block_size > 65536) {
 					// Block size is invalid.
-					// Switch to the other reader.
-					if (rd_idx == 1) {
-						// No more readers...
-						UNREF(reader[1]);
-						return nullptr;
-					}
-					UNREF_AND_NULL(reader[0]);
-
-					// reader[1] might be nullptr here...
-					if (!reader[1]) {
-						// Cannot continue.
-						return nullptr;
-					}
-					rd_idx = 1;
-
-					// Restart decompression in case the first few blocks
-					// were decompressed without any "errors".
-					// TODO: Also do this for errors after reading the block size?
-					reader[1]->rewind();
-					lzx_idx = 0;
-					memcpy(&lzx_blocks[0], &first_block, sizeof(first_block));
-					p_dblk = compressed_deblock.get();
-					continue;
+					UNREF(reader[0]);
+					UNREF(reader[1]);
+					return nullptr;
 				}
 
 				// Read the current block.
@@ -903,11 +898,30 @@ CBCReader *Xbox360_XEX_Private::initPeReader(void)
 				lzx_idx = !lzx_idx;
 			}
 
+			// Only the PE header and the XDBF section are needed,
+			// so stop decompressing once both have been reached.
+			const XEX2_Resource_Info *const pResInfo = getXdbfResInfo();
+			uint32_t xdbf_physaddr = 0;
+			bool has_xdbf = false;
+			size_t out_size = PE_HEADER_SIZE;
+			if (pResInfo) {
+				const uint32_t load_address = be32_to_cpu(
+					(xexType != XexType::XEX1
+						? secInfo.xex2.load_address
+						: secInfo.xex1.load_address));
+
+				xdbf_physaddr = pResInfo->vaddr - load_address;
+				if (pResInfo->size <= image_size && xdbf_physaddr <= image_size - pResInfo->size) {
+					has_xdbf = true;
+					out_size = std::max(out_size, static_cast<size_t>(xdbf_physaddr) + pResInfo->size);
+				}
+			}
+
 			// Decompress the data.
-			unique_ptr<uint8_t[]> decompressed_exe(new uint8_t[image_size]);
-			int res = lzx_decompress(compressed_deblock.get(),
+			unique_ptr<uint8_t[]> decompressed_exe(new uint8_t[out_size]);
+			int res = lzx_decompress_partial(compressed_deblock.get(),
 				static_cast<size_t>(p_dblk - compressed_deblock.get()),
-				decompressed_exe.get(), image_size,
+				decompressed_exe.get(), out_size, image_size,
 				window_size, nullptr, 0);
 			if (res != MSPACK_ERR_OK) {
 				// Error decompressing the data.
@@ -932,20 +946,11 @@ CBCReader *Xbox360_XEX_Private::initPeReader(void)
 			memcpy(lzx_peHeader.data(), decompressed_exe.get(), PE_HEADER_SIZE);
 
 			// Copy the XDBF section.
-			const XEX2_Resource_Info *const pResInfo = getXdbfResInfo();
-			if (pResInfo) {
-				const uint32_t load_address = be32_to_cpu(
-					(xexType != XexType::XEX1
-						? secInfo.xex2.load_address
-						: secInfo.xex1.load_address));
-
-				const uint32_t xdbf_physaddr = pResInfo->vaddr - load_address;
-				if (xdbf_physaddr + pResInfo->size <= image_size) {
-					lzx_xdbfSection.resize(pResInfo->size);
-					memcpy(lzx_xdbfSection.data(),
-						decompressed_exe.get() + xdbf_physaddr,
-						pResInfo->size);
-				}
+			if (has_xdbf) {
+				lzx_xdbfSection.resize(pResInfo->size);
+				memcpy(lzx_xdbfSection.data(),
+					decompressed_exe.get() + xdbf_physaddr,
+					pResInfo->size);
 			}
 
 			// Save the correct reader.
@@ -1456,6 +1461,63 @@ void Xbox360_XEX::close(void)
 	super::close();
 }
 
+/**
+ * Get the approximate amount of memory used by this object.
+ * @return Approximate memory usage, in bytes.
+ */
+size_t Xbox360_XEX::memoryUsage(void) const
+{
+	RP_D(const Xbox360_XEX);
+	size_t total = super::memoryUsage();
+#ifdef ENABLE_LIBMSPACK
+	total += d->lzx_peHeader.size() + d->lzx_xdbfSection.size();
+#endif /* ENABLE_LIBMSPACK */
+	if (d->pe_exe) {
+		total += d->pe_exe->memoryUsage();
+	}
+	if (d->pe_xdbf) {
+		total += d->pe_xdbf->memoryUsage();
+	}
+	return total;
+}
+
+/**
+ * Release cached data that can be rebuilt on demand.
+ */
+void Xbox360_XEX::releaseMemory(void)
+{
+	RP_D(Xbox360_XEX);
+	if (!d->file || !d->fields->empty()) {
+		// The file is closed, so nothing can be rebuilt, or
+		// the fields reference images owned by pe_xdbf.
+		// Only trim the sub-objects.
+		if (d->pe_exe) {
+			d->pe_exe->releaseMemory();
+		}
+		if (d->pe_xdbf) {
+			d->pe_xdbf->releaseMemory();
+		}
+		super::releaseMemory();
+		return;
+	}
+
+	// The EXE and XDBF objects read from the decompressed
+	// LZX buffers, so they have to be released as well.
+	// initPeReader(), initEXE(), and initXDBF() will
+	// reload everything on demand.
+	UNREF_AND_NULL(d->pe_xdbf);
+	UNREF_AND_NULL(d->pe_exe);
+	UNREF_AND_NULL(d->peReader);
+#ifdef ENABLE_LIBMSPACK
+	d->lzx_peHeader.clear();
+	d->lzx_peHeader.shrink_to_fit();
+	d->lzx_xdbfSection.clear();
+	d->lzx_xdbfSection.shrink_to_fit();
+#endif /* ENABLE_LIBMSPACK */
+
+	super::releaseMemory();
+}
+
 /** ROM detection functions. **/
 
 /**
@@ -17,6 +17,7 @@ namespace LibRomData {
 class Xbox360_XEX_Private;
 ROMDATA_DECL_BEGIN(Xbox360_XEX)
 ROMDATA_DECL_CLOSE()
+ROMDATA_DECL_MEMORY()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
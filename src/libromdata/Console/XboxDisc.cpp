@@ -438,6 +438,38 @@ void XboxDisc::close(void)
 	super::close();
 }
 
+/**
+ * Get the approximate amount of memory used by this object.
+ * @return Approximate memory usage, in bytes.
+ */
+size_t XboxDisc::memoryUsage(void) const
+{
+	RP_D(const XboxDisc);
+	size_t total = super::memoryUsage();
+	if (d->xdvdfsPartition) {
+		total += d->xdvdfsPartition->memoryUsage();
+	}
+	if (d->defaultExeData) {
+		total += d->defaultExeData->memoryUsage();
+	}
+	return total;
+}
+
+/**
+ * Release cached data that can be rebuilt on demand.
+ */
+void XboxDisc::releaseMemory(void)
+{
+	RP_D(XboxDisc);
+	if (d->xdvdfsPartition) {
+		d->xdvdfsPartition->releaseMemory();
+	}
+	if (d->defaultExeData) {
+		d->defaultExeData->releaseMemory();
+	}
+	super::releaseMemory();
+}
+
 /** ROM detection functions. **/
 
 /**
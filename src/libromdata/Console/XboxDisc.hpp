@@ -16,6 +16,7 @@ namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(XboxDisc)
 ROMDATA_DECL_CLOSE()
+ROMDATA_DECL_MEMORY()
 ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
@@ -53,9 +53,16 @@ class Xbox_XBE_Private final : public RomDataPrivate
 		// NOTE: **NOT** byteswapped.
 		XBE_Header xbeHeader;
 
-		// XBE certificate
+		// XBE certificate (loaded on demand)
 		// NOTE: **NOT** byteswapped.
 		XBE_Certificate xbeCertificate;
+		bool certLoaded;
+
+		// Section headers and names (loaded on demand)
+		// NOTE: Section headers are **NOT** byteswapped.
+		vector<XBE_Section_Header> sectionHeaders;
+		vector<string> sectionNames;
+		bool sectionHeadersLoaded;
 
 		// RomData subclasses.
 		// TODO: Also get the save image? ($$XSIMAGE)
@@ -73,6 +80,19 @@ class Xbox_XBE_Private final : public RomDataPrivate
 		} xtImage;
 
 	public:
+		/**
+		 * Load the XBE certificate.
+		 * If the certificate can't be loaded, it will be zeroed.
+		 * @return XBE certificate.
+		 */
+		const XBE_Certificate *loadCertificate(void);
+
+		/**
+		 * Load the section headers and section names.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadSectionHeaders(void);
+
 		/**
 		 * Find an XBE section header.
 		 * @param name		[in] Section header name.
@@ -105,6 +125,8 @@ class Xbox_XBE_Private final : public RomDataPrivate
 
 Xbox_XBE_Private::Xbox_XBE_Private(Xbox_XBE *q, IRpFile *file)
 	: super(q, file)
+	, certLoaded(false)
+	, sectionHeadersLoaded(false)
 	, pe_exe(nullptr)
 {
 	// Clear the XBE structs.
@@ -131,23 +153,51 @@ Xbox_XBE_Private::~Xbox_XBE_Private()
 }
 
 /**
- * Find an XBE section header.
- * @param name		[in] Section header name.
- * @param pOutHeader	[out] Buffer to store the header. (Byteswapped to host-endian.)
+ * Load the XBE certificate.
+ * If the certificate can't be loaded, it will be zeroed.
+ * @return XBE certificate.
+ */
+const XBE_Certificate *Xbox_XBE_Private::loadCertificate(void)
+{
+	if (certLoaded || !file || !file->isOpen()) {
+		// Certificate is already loaded, or the file isn't open.
+		return &xbeCertificate;
+	}
+	certLoaded = true;
+
+	const uint32_t base_address = le32_to_cpu(xbeHeader.base_address);
+	const uint32_t cert_address = le32_to_cpu(xbeHeader.cert_address);
+	if (cert_address > base_address) {
+		size_t size = file->seekAndRead(cert_address - base_address,
+			&xbeCertificate, sizeof(xbeCertificate));
+		if (size != sizeof(xbeCertificate)) {
+			// Unable to load the certificate.
+			// Continue anyway.
+			xbeCertificate.size = 0;
+		}
+	}
+	return &xbeCertificate;
+}
+
+/**
+ * Load the section headers and section names.
  * @return 0 on success; negative POSIX error code on error.
  */
-int Xbox_XBE_Private::findXbeSectionHeader(const char *name, XBE_Section_Header *pOutHeader)
+int Xbox_XBE_Private::loadSectionHeaders(void)
 {
-	// Load the section headers.
-	if (!file || !file->isOpen()) {
+	if (sectionHeadersLoaded) {
+		// Section headers are already loaded.
+		return 0;
+	} else if (!file || !file->isOpen()) {
 		// File is not open.
 		return -EBADF;
 	}
 
-	// We're loading the first 64 KB of the executable.
-	// Section headers and names are usually there.
+	// Section headers and names are usually in the first 64 KB.
 	// TODO: Find any exceptions?
-	static const size_t XBE_READ_SIZE = 64*1024;
+	static const uint32_t XBE_SHDR_MAX_ADDRESS = 64*1024;
+	// Maximum section name length, plus NULL terminator.
+	static const uint32_t XBE_SECTION_NAME_SIZE = 16;
 
 	// Load the section headers.
 	const uint32_t base_address = le32_to_cpu(xbeHeader.base_address);
@@ -159,66 +209,113 @@ int Xbox_XBE_Private::findXbeSectionHeader(const char *name, XBE_Section_Header
 	}
 
 	const uint32_t shdr_address_phys = section_headers_address - base_address;
-	if (shdr_address_phys >= XBE_READ_SIZE) {
+	if (shdr_address_phys >= XBE_SHDR_MAX_ADDRESS) {
 		// Section headers is not in the first 64 KB.
 		return -EIO;
 	}
 
-	// Read the XBE header.
-	unique_ptr<uint8_t[]> first64KB(new uint8_t[XBE_READ_SIZE]);
-	size_t size = file->seekAndRead(0, first64KB.get(), XBE_READ_SIZE);
-	if (size != XBE_READ_SIZE) {
-		// Seek and/or read error.
-		return -EIO;
-	}
-
 	// Section count.
 	unsigned int section_count = le32_to_cpu(xbeHeader.section_count);
 	// If this goes over the 64 KB limit, reduce the section count.
-	if (shdr_address_phys + (section_count * sizeof(XBE_Section_Header)) > XBE_READ_SIZE) {
+	if (shdr_address_phys + (section_count * sizeof(XBE_Section_Header)) > XBE_SHDR_MAX_ADDRESS) {
 		// Out of bounds. Reduce it.
-		section_count = (XBE_READ_SIZE - shdr_address_phys) / sizeof(XBE_Section_Header);
+		section_count = (XBE_SHDR_MAX_ADDRESS - shdr_address_phys) / sizeof(XBE_Section_Header);
 	}
 
-	// First section header.
-	const XBE_Section_Header *pHdr = reinterpret_cast<const XBE_Section_Header*>(
-		&first64KB[shdr_address_phys]);
-	const XBE_Section_Header *const pHdr_end = pHdr + section_count;
+	// Read all of the section headers at once.
+	vector<XBE_Section_Header> shdrs(section_count);
+	const size_t shdrs_size = section_count * sizeof(XBE_Section_Header);
+	size_t size = file->seekAndRead(shdr_address_phys, shdrs.data(), shdrs_size);
+	if (size != shdrs_size) {
+		// Seek and/or read error.
+		return -EIO;
+	}
 
-	// Find the $$XTIMAGE section.
-	// TODO: Cache a "not found" result so we don't have to
-	// re-check the section headers again?
-	for (; pHdr < pHdr_end; pHdr++) {
-		char section_name[16];	// Allow up to 15 chars plus NULL terminator.
+	// Section names are usually stored together, so read
+	// all of them at once if they're close enough.
+	uint32_t name_min = ~0U, name_max = 0;
+	for (const XBE_Section_Header &shdr : shdrs) {
+		const uint32_t name_address = le32_to_cpu(shdr.section_name_address);
+		if (name_address <= base_address) {
+			// Out of range.
+			continue;
+		}
+		name_min = std::min(name_min, name_address - base_address);
+		name_max = std::max(name_max, name_address - base_address);
+	}
+	unique_ptr<char[]> names;
+	size_t names_len = 0;
+	if (name_min <= name_max && name_max - name_min < XBE_SHDR_MAX_ADDRESS) {
+		names_len = name_max - name_min + XBE_SECTION_NAME_SIZE;
+		names.reset(new char[names_len]);
+		names_len = file->seekAndRead(name_min, names.get(), names_len);
+	}
 
-		const uint32_t name_address = le32_to_cpu(pHdr->section_name_address);
+	vector<string> names_vec;
+	names_vec.reserve(section_count);
+	for (const XBE_Section_Header &shdr : shdrs) {
+		const uint32_t name_address = le32_to_cpu(shdr.section_name_address);
 		if (name_address <= base_address) {
 			// Out of range.
+			names_vec.emplace_back();
 			continue;
 		}
 
-		// Read the name.
-		size = file->seekAndRead(name_address - base_address, section_name, sizeof(section_name));
-		if (size != sizeof(section_name)) {
-			// Seek and/or read error.
-			return -EIO;
+		const uint32_t name_address_phys = name_address - base_address;
+		char section_name[XBE_SECTION_NAME_SIZE];
+		if (names && name_address_phys - name_min + XBE_SECTION_NAME_SIZE <= names_len) {
+			// Name is in the batched read.
+			memcpy(section_name, &names[name_address_phys - name_min], sizeof(section_name));
+		} else {
+			// Read the name.
+			size = file->seekAndRead(name_address_phys, section_name, sizeof(section_name));
+			if (size != sizeof(section_name)) {
+				// Seek and/or read error.
+				return -EIO;
+			}
 		}
 		section_name[sizeof(section_name)-1] = '\0';
+		names_vec.emplace_back(section_name);
+	}
 
-		if (!strcmp(section_name, name)) {
-			// Found it!
-			pOutHeader->flags = le32_to_cpu(pHdr->flags);
-			pOutHeader->vaddr = le32_to_cpu(pHdr->vaddr);
-			pOutHeader->vsize = le32_to_cpu(pHdr->vsize);
-			pOutHeader->paddr = le32_to_cpu(pHdr->paddr);
-			pOutHeader->psize = le32_to_cpu(pHdr->psize);
-			pOutHeader->section_name_address		= le32_to_cpu(pHdr->section_name_address);
-			pOutHeader->section_name_refcount		= le32_to_cpu(pHdr->section_name_refcount);
-			pOutHeader->head_shared_page_recount_address	= le32_to_cpu(pHdr->head_shared_page_recount_address);
-			pOutHeader->tail_shared_page_recount_address	= le32_to_cpu(pHdr->tail_shared_page_recount_address);
-			memcpy(pOutHeader->sha1_digest, pHdr->sha1_digest, sizeof(pHdr->sha1_digest));
-			return 0;
-		}
+	sectionHeaders = std::move(shdrs);
+	sectionNames = std::move(names_vec);
+	sectionHeadersLoaded = true;
+	return 0;
+}
+
+/**
+ * Find an XBE section header.
+ * @param name		[in] Section header name.
+ * @param pOutHeader	[out] Buffer to store the header. (Byteswapped to host-endian.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Xbox_XBE_Private::findXbeSectionHeader(const char *name, XBE_Section_Header *pOutHeader)
+{
+	// Load the section headers.
+	int ret = loadSectionHeaders();
+	if (ret != 0) {
+		return ret;
+	}
+
+	assert(sectionHeaders.size() == sectionNames.size());
+	for (size_t i = 0; i < sectionHeaders.size(); i++) {
+		if (sectionNames[i] != name)
+			continue;
+
+		// Found it!
+		const XBE_Section_Header *const pHdr = &sectionHeaders[i];
+		pOutHeader->flags = le32_to_cpu(pHdr->flags);
+		pOutHeader->vaddr = le32_to_cpu(pHdr->vaddr);
+		pOutHeader->vsize = le32_to_cpu(pHdr->vsize);
+		pOutHeader->paddr = le32_to_cpu(pHdr->paddr);
+		pOutHeader->psize = le32_to_cpu(pHdr->psize);
+		pOutHeader->section_name_address		= le32_to_cpu(pHdr->section_name_address);
+		pOutHeader->section_name_refcount		= le32_to_cpu(pHdr->section_name_refcount);
+		pOutHeader->head_shared_page_recount_address	= le32_to_cpu(pHdr->head_shared_page_recount_address);
+		pOutHeader->tail_shared_page_recount_address	= le32_to_cpu(pHdr->tail_shared_page_recount_address);
+		memcpy(pOutHeader->sha1_digest, pHdr->sha1_digest, sizeof(pHdr->sha1_digest));
+		return 0;
 	}
 
 	// Not found.
@@ -430,18 +527,8 @@ Xbox_XBE::Xbox_XBE(IRpFile *file)
 		return;
 	}
 
-	// Load the certificate.
-	const uint32_t base_address = le32_to_cpu(d->xbeHeader.base_address);
-	const uint32_t cert_address = le32_to_cpu(d->xbeHeader.cert_address);
-	if (cert_address > base_address) {
-		size = d->file->seekAndRead(cert_address - base_address,
-			&d->xbeCertificate, sizeof(d->xbeCertificate));
-		if (size != sizeof(d->xbeCertificate)) {
-			// Unable to load the certificate.
-			// Continue anyway.
-			d->xbeCertificate.size = 0;
-		}
-	}
+	// NOTE: The certificate and section headers are loaded on demand.
+	// Thumbnails only need the $$XTIMAGE section header.
 }
 
 /**
@@ -697,7 +784,7 @@ int Xbox_XBE::loadFieldData(void)
 	// Parse the XBE file.
 	// NOTE: The magic number is NOT byteswapped in the constructor.
 	const XBE_Header *const xbeHeader = &d->xbeHeader;
-	const XBE_Certificate *const xbeCertificate = &d->xbeCertificate;
+	const XBE_Certificate *const xbeCertificate = d->loadCertificate();
 	if (xbeHeader->magic != cpu_to_be32(XBE_MAGIC)) {
 		// Invalid magic number.
 		return 0;
@@ -883,7 +970,7 @@ int Xbox_XBE::loadMetaData(void)
 	d->metaData = new RomMetaData();
 	d->metaData->reserve(2);	// Maximum of 2 metadata properties.
 
-	const XBE_Certificate *const xbeCertificate = &d->xbeCertificate;
+	const XBE_Certificate *const xbeCertificate = d->loadCertificate();
 
 	// Title
 	d->metaData->addMetaData_string(Property::Title,
@@ -11,6 +11,7 @@
 #include "DMG.hpp"
 #include "data/NintendoPublishers.hpp"
 #include "dmg_structs.h"
+#include "utils/RomChecksum.hpp"
 
 // librpbase, librpfile
 #include "librpbase/config/Config.hpp"
@@ -872,9 +873,9 @@ int DMG::loadFieldData(void)
 	const DMG_RomHeader *const romHeader = &d->romHeader;
 
 	// DMG ROM header:
-	// - 12 regular fields.
+	// - 13 regular fields.
 	// - 5 fields for the GBX footer.
-	d->fields->reserve(12+5);
+	d->fields->reserve(13+5);
 
 	// Reserve at least 3 tabs:
 	// DMG, GBX, GBS
@@ -1050,6 +1051,46 @@ int DMG::loadFieldData(void)
 			rp_sprintf(C_("DMG", "0x%02X (valid)"), checksum));
 	}
 
+	// Global checksum. (optional; reads the entire ROM)
+	// This is the 16-bit sum of all bytes in the ROM,
+	// excluding the global checksum itself.
+	if (RomChecksum::isEnabled()) {
+		// Check for a copier header. (See the constructor.)
+		off64_t romOffset = 0;
+		uint32_t logo32;
+		size_t size = d->file->seekAndRead(0x104, &logo32, sizeof(logo32));
+		if (size == sizeof(logo32) && logo32 != cpu_to_be32(0xCEED6666)) {
+			romOffset = 0x200;
+		}
+
+		off64_t romSize = d->file->size() - romOffset;
+		if (d->gbxFooter.magic == cpu_to_be32(GBX_MAGIC)) {
+			// Exclude the GBX footer.
+			romSize -= be32_to_cpu(d->gbxFooter.footer_size);
+		}
+
+		rp_sum8_t sum = {0, 0};
+		if (romSize > 0x150 &&
+		    RomChecksum::sumFileRange(d->file, romOffset, romSize, &sum) == 0)
+		{
+			const uint8_t *const pRomChecksum =
+				reinterpret_cast<const uint8_t*>(&romHeader->rom_checksum);
+			const uint16_t full_checksum = static_cast<uint16_t>(
+				sum.even + sum.odd - pRomChecksum[0] - pRomChecksum[1]);
+			const uint16_t rom_checksum = be16_to_cpu(romHeader->rom_checksum);
+
+			const char *const full_checksum_title = C_("RomData", "Full Checksum");
+			if (full_checksum != rom_checksum) {
+				d->fields->addField_string(full_checksum_title,
+					rp_sprintf_p(C_("DMG", "0x%1$04X (INVALID; should be 0x%2$04X)"),
+						rom_checksum, full_checksum));
+			} else {
+				d->fields->addField_string(full_checksum_title,
+					rp_sprintf(C_("DMG", "0x%04X (valid)"), full_checksum));
+			}
+		}
+	}
+
 	/** GBX footer. **/
 	const GBX_Footer *const gbxFooter = &d->gbxFooter;
 	if (gbxFooter->magic == cpu_to_be32(GBX_MAGIC)) {
@@ -32,26 +32,16 @@ using namespace LibRpTexture;
 
 // C++ STL classes.
 using std::string;
-using std::unique_ptr;
 using std::vector;
 
-// zlib for crc32()
-#include <zlib.h>
-#ifdef _MSC_VER
-// MSVC: Exception handling for /DELAYLOAD.
-#  include "libwin32common/DelayLoadHelper.h"
-#endif /* _MSC_VER */
+// librpcpu
+#include "librpcpu/crc32_rp.h"
 
 namespace LibRomData {
 
 ROMDATA_IMPL(Nintendo3DS)
 ROMDATA_IMPL_IMG_SIZES(Nintendo3DS)
 
-#ifdef _MSC_VER
-// DelayLoad test implementation.
-DELAYLOAD_TEST_FUNCTION_IMPL0(get_crc_table);
-#endif /* _MSC_VER */
-
 /** Nintendo3DSPrivate **/
 
 // MIME type table.
@@ -85,6 +75,19 @@ Nintendo3DSPrivate::~Nintendo3DSPrivate()
 {
 	UNREF(mainContent);
 	UNREF(ncch_reader);
+	unrefNCCHReaders();
+}
+
+/**
+ * Release all cached NCCH readers.
+ * NOTE: The primary NCCH reader is not released.
+ */
+void Nintendo3DSPrivate::unrefNCCHReaders(void)
+{
+	for (NCCHReader *reader : ncch_readers) {
+		UNREF(reader);
+	}
+	ncch_readers.clear();
 }
 
 /**
@@ -222,6 +225,12 @@ int Nintendo3DSPrivate::loadNCCH(int idx, NCCHReader **pOutNcchReader)
 	if (!pOutNcchReader)
 		return -EINVAL;
 
+	// Has this NCCH reader already been created?
+	if (idx >= 0 && idx < static_cast<int>(ncch_readers.size()) && ncch_readers[idx]) {
+		*pOutNcchReader = static_cast<NCCHReader*>(ncch_readers[idx]->ref());
+		return 0;
+	}
+
 	off64_t offset = 0;
 	uint32_t length = 0;
 	switch (romType) {
@@ -356,6 +365,17 @@ int Nintendo3DSPrivate::loadNCCH(int idx, NCCHReader **pOutNcchReader)
 
 	// We don't need to keep a reference to the CIAReader.
 	UNREF(ciaReader);
+
+	// Cache the NCCH reader for later.
+	// NOTE: CIA content indexes are 16-bit, but there's
+	// a maximum of 255 contents, so don't cache anything
+	// with an unusually high index.
+	if (idx < 256) {
+		if (idx >= static_cast<int>(ncch_readers.size())) {
+			ncch_readers.resize(idx+1);
+		}
+		ncch_readers[idx] = static_cast<NCCHReader*>((*pOutNcchReader)->ref());
+	}
 	return 0;
 }
 
@@ -746,29 +766,18 @@ void Nintendo3DSPrivate::addTitleIdAndProductCodeFields(bool showContentType)
 	if (f_logo) {
 		const off64_t szFile = f_logo->size();
 		if (szFile == 8192) {
-#if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
-			// Delay load verification.
-			// TODO: Only if linked with /DELAYLOAD?
-			bool has_zlib = true;
-			if (DelayLoad_test_get_crc_table() != 0) {
-				// Delay load failed.
-				// Can't calculate the CRC32.
-				has_zlib = false;
-			}
-#else /* !defined(_MSC_VER) || !defined(ZLIB_IS_DLL) */
-			// zlib isn't in a DLL, but we need to ensure that the
-			// CRC table is initialized anyway.
-			static const bool has_zlib = true;
-			get_crc_table();
-#endif /* defined(_MSC_VER) && defined(ZLIB_IS_DLL) */
-
-			if (has_zlib) {
-				// Calculate the CRC32.
-				unique_ptr<uint8_t[]> buf(new uint8_t[static_cast<unsigned int>(szFile)]);
-				size_t size = f_logo->read(buf.get(), static_cast<unsigned int>(szFile));
-				if (size == static_cast<unsigned int>(szFile)) {
-					crc = crc32(0, buf.get(), static_cast<unsigned int>(szFile));
+			// Calculate the CRC32.
+			uint8_t buf[2048];
+			unsigned int remain = static_cast<unsigned int>(szFile);
+			while (remain > 0) {
+				const size_t size = f_logo->read(buf, sizeof(buf));
+				if (size != sizeof(buf)) {
+					// Read error.
+					crc = 0;
+					break;
 				}
+				crc = rp_crc32(crc, buf, size);
+				remain -= static_cast<unsigned int>(size);
 			}
 		} else if (szFile > 0) {
 			// Some other custom logo.
@@ -1310,6 +1319,9 @@ void Nintendo3DS::close(void)
 		d->mainContent->close();
 	}
 
+	// Release the NCCH readers.
+	d->unrefNCCHReaders();
+
 	// Call the superclass function.
 	super::close();
 }
@@ -23,22 +23,13 @@ using std::string;
 using std::unique_ptr;
 using std::vector;
 
-// zlib for crc32()
-#include <zlib.h>
-#ifdef _MSC_VER
-// MSVC: Exception handling for /DELAYLOAD.
-#  include "libwin32common/DelayLoadHelper.h"
-#endif /* _MSC_VER */
+// librpcpu
+#include "librpcpu/crc32_rp.h"
 
 namespace LibRomData {
 
 ROMDATA_IMPL(Nintendo3DSFirm)
 
-#ifdef _MSC_VER
-// DelayLoad test implementation.
-DELAYLOAD_TEST_FUNCTION_IMPL0(get_crc_table);
-#endif /* _MSC_VER */
-
 class Nintendo3DSFirmPrivate final : public RomDataPrivate
 {
 	public:
@@ -52,10 +43,52 @@ class Nintendo3DSFirmPrivate final : public RomDataPrivate
 		// Firmware header.
 		// NOTE: Must be byteswapped on access.
 		N3DS_FIRM_Header_t firmHeader;
+
+	public:
+		// ARM9 homebrew version strings.
+		struct Arm9VerStr_t {
+			const char *title;	// Application title.
+			const char *searchstr;	// Search string.
+			unsigned int searchlen;	// Search string length, without the NULL terminator.
+		};
+		static const Arm9VerStr_t arm9VerStr[];
+
+		// Firmware binary scan results.
+		struct FirmScan_t {
+			uint32_t crc;			// CRC32 of the entire firmware binary.
+			const Arm9VerStr_t *arm9;	// First matching ARM9 version string, or nullptr if none.
+			string s_verstr;		// ARM9 version, if found.
+		};
+
+		/**
+		 * Scan the firmware binary.
+		 *
+		 * This calculates the CRC32 and searches for ARM9 homebrew
+		 * version strings. The file is processed in blocks, so it
+		 * doesn't need to be loaded into memory all at once.
+		 *
+		 * @param scan	[out] Scan results.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int scanFirmBin(FirmScan_t &scan);
 };
 
 /** Nintendo3DSFirmPrivate **/
 
+const Nintendo3DSFirmPrivate::Arm9VerStr_t Nintendo3DSFirmPrivate::arm9VerStr[] = {
+	{"Luma3DS",		"Luma3DS v", 9},
+	{"GodMode9",		"GodMode9 Explorer v", 19},	// Older versions
+	{"GodMode9",		"GodMode9 v", 10},		// Newer versions (v1.9.1; TODO check for first one?)
+	{"Decrypt9WIP",		"Decrypt9WIP (", 13},
+	{"Hourglass9",		"Hourglass9 v", 12},
+	{"ntrboot_flasher",	"ntrboot_flasher: %s", 19},	// version info isn't hard-coded
+	{"SafeB9SInstaller",	"SafeB9SInstaller v", 18},
+	{"OpenFirmInstaller",	"OpenFirmInstaller v", 19},
+	{"fastboot3DS",		"fastboot3DS v", 13},
+
+	{nullptr, nullptr, 0}
+};
+
 Nintendo3DSFirmPrivate::Nintendo3DSFirmPrivate(Nintendo3DSFirm *q, IRpFile *file)
 	: super(q, file)
 {
@@ -63,6 +96,94 @@ Nintendo3DSFirmPrivate::Nintendo3DSFirmPrivate(Nintendo3DSFirm *q, IRpFile *file
 	memset(&firmHeader, 0, sizeof(firmHeader));
 }
 
+/**
+ * Scan the firmware binary.
+ *
+ * This calculates the CRC32 and searches for ARM9 homebrew
+ * version strings. The file is processed in blocks, so it
+ * doesn't need to be loaded into memory all at once.
+ *
+ * @param scan	[out] Scan results.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Nintendo3DSFirmPrivate::scanFirmBin(FirmScan_t &scan)
+{
+	scan.crc = 0;
+	scan.arm9 = nullptr;
+	scan.s_verstr.clear();
+
+	// Maximum version string length.
+	static const unsigned int VERSTR_MAX = 32;
+	// Bytes kept from the previous block so matches can span blocks.
+	// Must be larger than the longest search string plus VERSTR_MAX.
+	static const unsigned int OVERLAP = 64;
+	static const unsigned int BLOCK_SIZE = 64*1024;
+	unique_ptr<uint8_t[]> buf(new uint8_t[OVERLAP + BLOCK_SIZE]);
+
+	// Index of arm9VerStr[] that must be beaten by a new match.
+	// Earlier entries in arm9VerStr[] have priority over later ones,
+	// regardless of where they are in the file.
+	unsigned int arm9_best = ARRAY_SIZE(arm9VerStr) - 1;
+
+	file->rewind();
+	size_t carry = 0;
+	const off64_t fileSize = file->size();
+	off64_t pos = 0;
+	while (pos < fileSize) {
+		const size_t size = file->read(&buf[carry], BLOCK_SIZE);
+		if (size == 0) {
+			// Read error.
+			const int err = file->lastError();
+			return (err != 0 ? -err : -EIO);
+		}
+		scan.crc = rp_crc32(scan.crc, &buf[carry], size);
+		pos += size;
+
+		const size_t len = carry + size;
+		if (arm9_best > 0) {
+			// Only accept matches that start before the overlap region,
+			// unless this is the last block. Anything later will be
+			// checked again with the next block.
+			const bool isLast = (pos >= fileSize);
+			const char *const pBuf = reinterpret_cast<const char*>(buf.get());
+			const char *const pEnd = pBuf + len;
+			const char *const pLimit = (isLast || len <= OVERLAP) ? pEnd : (pEnd - OVERLAP);
+
+			for (unsigned int i = 0; i < arm9_best; i++) {
+				const Arm9VerStr_t *const p = &arm9VerStr[i];
+				const char *verstr = static_cast<const char*>(memmem(
+					pBuf, len, p->searchstr, p->searchlen));
+				if (!verstr || verstr >= pLimit)
+					continue;
+
+				// Version does NOT include the 'v' character.
+				verstr += p->searchlen;
+				int count = 0;
+				while (verstr + count < pEnd && count < (int)VERSTR_MAX &&
+				       verstr[count] != 0 && !ISSPACE(verstr[count]) && verstr[count] != ')')
+				{
+					count++;
+				}
+				scan.arm9 = p;
+				// NOTE: Most ARM9 homebrew uses UTF-8 strings.
+				scan.s_verstr.assign(verstr, count);
+				arm9_best = i;
+				break;
+			}
+		}
+
+		// Keep the end of this block for the next search.
+		if (len > OVERLAP) {
+			memmove(buf.get(), &buf[len - OVERLAP], OVERLAP);
+			carry = OVERLAP;
+		} else {
+			carry = len;
+		}
+	}
+
+	return 0;
+}
+
 /** Nintendo3DSFirm **/
 
 /**
@@ -239,21 +360,6 @@ int Nintendo3DSFirm::loadFieldData(void)
 	const N3DS_FIRM_Header_t *const firmHeader = &d->firmHeader;
 	d->fields->reserve(6);	// Maximum of 6 fields.
 
-	// Read the firmware binary.
-	unique_ptr<uint8_t[]> firmBuf;
-	unsigned int szFile = 0;
-	if (d->file->size() <= 4*1024*1024) {
-		// Firmware binary is 4 MB or less.
-		szFile = static_cast<unsigned int>(d->file->size());
-		firmBuf.reset(new uint8_t[szFile]);
-		d->file->rewind();
-		size_t size = d->file->read(firmBuf.get(), szFile);
-		if (size != szFile) {
-			// Error reading the firmware binary.
-			firmBuf.reset();
-		}
-	}
-
 	// If both ARM11 and ARM9 entry points are non-zero,
 	// check if this is an official 3DS firmware binary.
 	const Nintendo3DSFirmData::FirmBin_t *firmBin = nullptr;
@@ -262,27 +368,19 @@ int Nintendo3DSFirm::loadFieldData(void)
 	const char *firmBinDesc = nullptr;
 	bool checkCustomFIRM = false;	// Check for a custom FIRM, e.g. Boot9Strap.
 	bool checkARM9 = false;		// Check for ARM9 homebrew.
+
+	// Scan the firmware binary if it's 4 MB or less.
+	// This calculates the CRC32 and finds ARM9 version strings.
+	Nintendo3DSFirmPrivate::FirmScan_t scan;
+	bool scanned = false;
+	if (arm9_entrypoint != 0 && d->file->size() <= 4*1024*1024) {
+		scanned = (d->scanFirmBin(scan) == 0);
+	}
+
 	if (arm11_entrypoint != 0 && arm9_entrypoint != 0) {
-#if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
-		// Delay load verification.
-		// TODO: Only if linked with /DELAYLOAD?
-		bool has_zlib = true;
-		if (DelayLoad_test_get_crc_table() != 0) {
-			// Delay load failed.
-			// Can't calculate the CRC32.
-			has_zlib = false;
-		}
-#else /* !defined(_MSC_VER) || !defined(ZLIB_IS_DLL) */
-		// zlib isn't in a DLL, but we need to ensure that the
-		// CRC table is initialized anyway.
-		static const bool has_zlib = true;
-		get_crc_table();
-#endif /* defined(_MSC_VER) && defined(ZLIB_IS_DLL) */
-
-		// Calculate the CRC32 and look it up.
-		if (has_zlib && firmBuf) {
-			const uint32_t crc = crc32(0, firmBuf.get(), static_cast<unsigned int>(szFile));
-			firmBin = Nintendo3DSFirmData::lookup_firmBin(crc);
+		// Look up the CRC32.
+		if (scanned) {
+			firmBin = Nintendo3DSFirmData::lookup_firmBin(scan.crc);
 			if (firmBin != nullptr) {
 				// Official firmware binary.
 				firmBinDesc = (firmBin->isNew3DS ? "New3DS FIRM" : "Old3DS FIRM");
@@ -311,11 +409,13 @@ int Nintendo3DSFirm::loadFieldData(void)
 		if (!memcmp(&firmHeader->reserved[0x2D], "B9S", 3)) {
 			// This is Boot9Strap.
 			firmBinDesc = "Boot9Strap";
-		} else if (firmBuf) {
+		} else {
 			// Check for sighax installer.
 			// NOTE: String has a NULL terminator.
 			static const char sighax_magic[] = "3DS BOOTHAX INS";
-			if (!memcmp(&firmBuf[0x208], sighax_magic, sizeof(sighax_magic))) {
+			char buf[sizeof(sighax_magic)];
+			size_t size = d->file->seekAndRead(0x208, buf, sizeof(buf));
+			if (size == sizeof(buf) && !memcmp(buf, sighax_magic, sizeof(sighax_magic))) {
 				// Found derrek's sighax installer.
 				firmBinDesc = "sighax installer";
 			}
@@ -338,55 +438,15 @@ int Nintendo3DSFirm::loadFieldData(void)
 	} else if (checkARM9) {
 		// Check for ARM9 homebrew.
 
-		// Version strings.
-		struct Arm9VerStr_t {
-			const char *title;	// Application title.
-			const char *searchstr;	// Search string.
-			unsigned int searchlen;	// Search string length, without the NULL terminator.
-		};
-		static const Arm9VerStr_t arm9VerStr[] = {
-			{"Luma3DS",		"Luma3DS v", 9},
-			{"GodMode9",		"GodMode9 Explorer v", 19},	// Older versions
-			{"GodMode9",		"GodMode9 v", 10},		// Newer versions (v1.9.1; TODO check for first one?)
-			{"Decrypt9WIP",		"Decrypt9WIP (", 13},
-			{"Hourglass9",		"Hourglass9 v", 12},
-			{"ntrboot_flasher",	"ntrboot_flasher: %s", 19},	// version info isn't hard-coded
-			{"SafeB9SInstaller",	"SafeB9SInstaller v", 18},
-			{"OpenFirmInstaller",	"OpenFirmInstaller v", 19},
-			{"fastboot3DS",		"fastboot3DS v", 13},
-
-			{nullptr, nullptr, 0}
-		};
-
 		const char *arm9VerStr_title = nullptr;
 		string s_verstr;
-		for (const Arm9VerStr_t *p = arm9VerStr; p->title != nullptr; p++) {
-			const char *verstr = static_cast<const char*>(memmem(
-				firmBuf.get(), szFile, p->searchstr, p->searchlen));
-			if (!verstr)
-				continue;
-
-			arm9VerStr_title = p->title;
-
-			// Version does NOT include the 'v' character.
-			verstr += p->searchlen;
-			const char *end = (const char*)firmBuf.get() + szFile;
-			int count = 0;
-			while (verstr < end && count < 32 && verstr[count] != 0 &&
-			       !ISSPACE(verstr[count]) && verstr[count] != ')')
-			{
-				count++;
-			}
-			if (count > 0) {
+		if (scanned && scan.arm9) {
+			arm9VerStr_title = scan.arm9->title;
+			if (!scan.s_verstr.empty()) {
 				// Make sure this is labeled as ARM9 homebrew.
 				firmBinDesc = C_("Nintendo3DSFirm", "ARM9 Homebrew");
-
-				// NOTE: Most ARM9 homebrew uses UTF-8 strings.
-				s_verstr.assign(verstr, count);
+				s_verstr = std::move(scan.s_verstr);
 			}
-
-			// We're done here.
-			break;
 		}
 
 		// Sighax status.
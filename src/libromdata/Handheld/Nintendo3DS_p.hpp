@@ -29,6 +29,9 @@ namespace LibRpFile {
 // Reference: http://andreoffringa.org/?q=uvector
 #include "librpbase/uvector.h"
 
+// C++ includes.
+#include <vector>
+
 namespace LibRomData {
 
 class NCCHReader;
@@ -139,6 +142,19 @@ class Nintendo3DSPrivate final : public LibRpBase::RomDataPrivate
 		// Use loadNCCH() instead.
 		NCCHReader *ncch_reader;
 
+		// NCCH readers, indexed by content/partition index.
+		// Created on demand by loadNCCH(idx) and reused, since
+		// creating an NCCHReader sets up the AES keys and decrypts
+		// the NCCH, ExHeader, and ExeFS headers.
+		std::vector<NCCHReader*> ncch_readers;
+
+	public:
+		/**
+		 * Release all cached NCCH readers.
+		 * NOTE: The primary NCCH reader is not released.
+		 */
+		void unrefNCCHReaders(void);
+
 	public:
 		// Main content object.
 		// - If SMDH is present, this is Nintendo3DS_SMDH.
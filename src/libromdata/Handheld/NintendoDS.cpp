@@ -116,6 +116,62 @@ int NintendoDSPrivate::loadIconTitleData(void)
 	return 0;
 }
 
+/**
+ * Frame decoder for DSi animated icons.
+ * Each frame is a unique combination of bitmap, palette, and flip bits.
+ */
+class NDS_DSiIconFrameDecoder : public IconAnimData::FrameDecoder
+{
+	public:
+		explicit NDS_DSiIconFrameDecoder(const NDS_IconTitleData &nds_icon_title)
+		{
+			memcpy(icon_data, nds_icon_title.dsi_icon_data, sizeof(icon_data));
+			memcpy(icon_pal, nds_icon_title.dsi_icon_pal, sizeof(icon_pal));
+			tokens.fill(0);
+		}
+
+	public:
+		// High byte of the sequence token for each frame.
+		array<uint8_t, IconAnimData::MAX_FRAMES> tokens;
+
+	private:
+		uint8_t icon_data[8][0x200];
+		uint16_t icon_pal[8][0x10];
+
+	public:
+		/**
+		 * Decode a frame.
+		 * @param idx Frame index.
+		 * @return Decoded frame, or nullptr if the frame is empty or invalid.
+		 */
+		rp_image *decodeFrame(int idx) final
+		{
+			assert(idx >= 0 && idx < (int)tokens.size());
+			const uint8_t high_token = tokens[idx];
+			const uint8_t bmp = (high_token & 7);
+			const uint8_t pal = (high_token >> 3) & 7;
+			rp_image *img = ImageDecoder::fromNDS_CI4(32, 32,
+				icon_data[bmp], sizeof(icon_data[bmp]),
+				icon_pal[pal], sizeof(icon_pal[pal]));
+			if (img && (high_token & (3U << 6))) {
+				// At least one flip bit is set.
+				rp_image::FlipOp flipOp = rp_image::FLIP_NONE;
+				if (high_token & (1U << 6)) {
+					// H-flip
+					flipOp = rp_image::FLIP_H;
+				}
+				if (high_token & (1U << 7)) {
+					// V-flip
+					flipOp = static_cast<rp_image::FlipOp>(flipOp | rp_image::FLIP_V);
+				}
+				rp_image *const flipimg = img->flip(flipOp);
+				img->unref();
+				img = flipimg;
+			}
+			return img;
+		}
+};
+
 /**
  * Load the ROM image's icon.
  * @return Icon, or nullptr on error.
@@ -138,7 +194,6 @@ const rp_image *NintendoDSPrivate::loadIcon(void)
 	}
 
 	// Load the icon data.
-	// TODO: Only read the first frame unless specifically requested?
 	this->iconAnimData = new IconAnimData();
 	iconAnimData->count = 0;
 
@@ -159,6 +214,9 @@ const rp_image *NintendoDSPrivate::loadIcon(void)
 		iconAnimData->count = 1;
 	} else {
 		// Animated icon is present.
+		// Frames are decoded on demand, since thumbnailers
+		// usually only need the first frame.
+		NDS_DSiIconFrameDecoder *const decoder = new NDS_DSiIconFrameDecoder(nds_icon_title);
 
 		// Maximum number of combinations based on bitmap index,
 		// palette index, and flip bits is 256. We don't want to
@@ -197,30 +255,8 @@ const rp_image *NintendoDSPrivate::loadIcon(void)
 			// of 64 bitmaps.
 			uint8_t high_token = (seq >> 8);
 			if (arr_bmpUsed[high_token] == 0xFF) {
-				// Not used yet. Create the bitmap.
-				const uint8_t bmp = (high_token & 7);
-				const uint8_t pal = (high_token >> 3) & 7;
-				rp_image *img = ImageDecoder::fromNDS_CI4(32, 32,
-					nds_icon_title.dsi_icon_data[bmp],
-					sizeof(nds_icon_title.dsi_icon_data[bmp]),
-					nds_icon_title.dsi_icon_pal[pal],
-					sizeof(nds_icon_title.dsi_icon_pal[pal]));
-				if (high_token & (3U << 6)) {
-					// At least one flip bit is set.
-					rp_image::FlipOp flipOp = rp_image::FLIP_NONE;
-					if (high_token & (1U << 6)) {
-						// H-flip
-						flipOp = rp_image::FLIP_H;
-					}
-					if (high_token & (1U << 7)) {
-						// V-flip
-						flipOp = static_cast<rp_image::FlipOp>(flipOp | rp_image::FLIP_V);
-					}
-					rp_image *const flipimg = img->flip(flipOp);
-					img->unref();
-					img = flipimg;
-				}
-				iconAnimData->frames[bmp_idx] = img;
+				// Not used yet. The bitmap will be decoded on demand.
+				decoder->tokens[bmp_idx] = high_token;
 				arr_bmpUsed[high_token] = bmp_idx;
 				bmp_idx++;
 			}
@@ -231,6 +267,7 @@ const rp_image *NintendoDSPrivate::loadIcon(void)
 		}
 		iconAnimData->count = bmp_idx;
 		iconAnimData->seq_count = seq_idx;
+		iconAnimData->setFrameDecoder(decoder);
 	}
 
 	// NOTE: We're not deleting iconAnimData even if we only have
@@ -238,7 +275,7 @@ const rp_image *NintendoDSPrivate::loadIcon(void)
 	// if iconAnimData is nullptr.
 
 	// Return a pointer to the first frame.
-	icon_first_frame = iconAnimData->frames[iconAnimData->seq_index[0]];
+	icon_first_frame = iconAnimData->frame(iconAnimData->seq_index[0]);
 	return icon_first_frame;
 }
 
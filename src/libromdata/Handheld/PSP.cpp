@@ -14,9 +14,11 @@
 // librpbase, librpfile, librptexture
 #include "librpbase/img/RpPng.hpp"
 #include "librpfile/RpFile.hpp"
+#include "librpfile/RpMemFile.hpp"
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
 using LibRpFile::RpFile;
+using LibRpFile::RpMemFile;
 using namespace LibRpTexture;
 
 // DiscReader
@@ -69,6 +71,25 @@ class PSPPrivate final : public LibRpBase::RomDataPrivate
 		// Icon.
 		rp_image *img_icon;
 
+		// Prefetched files.
+		// UMD_DATA.BIN and ICON0.PNG are read together in disc order,
+		// so each CISO block is only decompressed once.
+		bool prefetched;
+		std::string umdDataBin;			// UMD_DATA.BIN (up to 128 bytes)
+		std::vector<uint8_t> icon0_png;		// ICON0.PNG
+
+		/**
+		 * Prefetch UMD_DATA.BIN and ICON0.PNG.
+		 */
+		void prefetchFiles(void);
+
+		/**
+		 * Get the game ID from UMD_DATA.BIN.
+		 * This is the video title on UMD Video discs.
+		 * @return Game ID, or empty string if not found.
+		 */
+		std::string getUmdDataGameID(void);
+
 		/**
 		 * Load the icon.
 		 * @return Icon, or nullptr on error.
@@ -93,6 +114,7 @@ PSPPrivate::PSPPrivate(PSP *q, IRpFile *file)
 	, discReader(nullptr)
 	, isoPartition(nullptr)
 	, img_icon(nullptr)
+	, prefetched(false)
 	, bootExeData(nullptr)
 {
 	// Clear the structs.
@@ -108,6 +130,86 @@ PSPPrivate::~PSPPrivate()
 	UNREF(img_icon);
 }
 
+/**
+ * Prefetch UMD_DATA.BIN and ICON0.PNG.
+ */
+void PSPPrivate::prefetchFiles(void)
+{
+	if (prefetched || !this->isValid || !this->isoPartition) {
+		// Already prefetched, or the ISO partition isn't open.
+		return;
+	}
+	prefetched = true;
+
+	// Maximum ICON0.PNG size to prefetch.
+	// Larger icons are read directly by loadIcon().
+	static const off64_t ICON0_PNG_SIZE_MAX = 1024*1024;
+
+	// Look up both files first. IsoPartition caches directories,
+	// so the directory blocks are only read once.
+	// NOTE: IsoPartition::open() always returns a PartitionFile.
+	const char *const icon_filename =
+		(unlikely(discType == DiscType::UmdVideo)
+			? "/UMD_VIDEO/ICON0.PNG"
+			: "/PSP_GAME/ICON0.PNG");
+	PartitionFile *const f_umdData = static_cast<PartitionFile*>(isoPartition->open("/UMD_DATA.BIN"));
+	PartitionFile *const f_icon = static_cast<PartitionFile*>(isoPartition->open(icon_filename));
+
+	// Read the files in disc order.
+	PartitionFile *files[2] = {f_umdData, f_icon};
+	if (f_umdData && f_icon && f_icon->offset() < f_umdData->offset()) {
+		std::swap(files[0], files[1]);
+	}
+	for (PartitionFile *f : files) {
+		if (!f || !f->isOpen()) {
+			continue;
+		}
+
+		if (f == f_umdData) {
+			// Read up to 128 bytes.
+			char buf[128];
+			size_t size = f->seekAndRead(0, buf, sizeof(buf));
+			umdDataBin.assign(buf, size);
+		} else {
+			const off64_t fileSize = f->size();
+			if (fileSize <= 0 || fileSize > ICON0_PNG_SIZE_MAX) {
+				continue;
+			}
+			icon0_png.resize(static_cast<size_t>(fileSize));
+			size_t size = f->seekAndRead(0, icon0_png.data(), icon0_png.size());
+			if (size != icon0_png.size()) {
+				// Read error.
+				icon0_png.clear();
+			}
+		}
+	}
+
+	UNREF(f_umdData);
+	UNREF(f_icon);
+}
+
+/**
+ * Get the game ID from UMD_DATA.BIN.
+ * This is the video title on UMD Video discs.
+ * @return Game ID, or empty string if not found.
+ */
+string PSPPrivate::getUmdDataGameID(void)
+{
+	// FIXME: Figure out what the fields are.
+	// - '|'-terminated fields.
+	// - Field 0: Game ID
+	// - Field 1: Encryption key?
+	// - Field 2: Revision?
+	// - Field 3: Age rating?
+	prefetchFiles();
+	const size_t pos = umdDataBin.find('|');
+	if (pos == string::npos) {
+		// No '|' found.
+		return string();
+	}
+	return latin1_to_utf8(umdDataBin.data(), static_cast<int>(pos));
+}
+
 /**
  * Load the icon.
  * @return Icon, or nullptr on error.
@@ -123,11 +225,18 @@ const rp_image *PSPPrivate::loadIcon(void)
 	}
 
 	// Icon is located on disc as a regular PNG image.
-	const char *const icon_filename =
-		(unlikely(discType == DiscType::UmdVideo)
-			? "/UMD_VIDEO/ICON0.PNG"
-			: "/PSP_GAME/ICON0.PNG");
-	IRpFile *const f_icon = isoPartition->open(icon_filename);
+	IRpFile *f_icon;
+	prefetchFiles();
+	if (!icon0_png.empty()) {
+		// Use the prefetched icon.
+		f_icon = new RpMemFile(icon0_png.data(), icon0_png.size());
+	} else {
+		const char *const icon_filename =
+			(unlikely(discType == DiscType::UmdVideo)
+				? "/UMD_VIDEO/ICON0.PNG"
+				: "/PSP_GAME/ICON0.PNG");
+		f_icon = isoPartition->open(icon_filename);
+	}
 	if (!f_icon || !f_icon->isOpen()) {
 		// Unable to open the icon file.
 		UNREF(f_icon);
@@ -138,6 +247,10 @@ const rp_image *PSPPrivate::loadIcon(void)
 	// TODO: For rpcli, shortcut to extract the PNG directly.
 	this->img_icon = RpPng::load(f_icon);
 	f_icon->unref();
+
+	// The prefetched icon is no longer needed.
+	icon0_png.clear();
+	icon0_png.shrink_to_fit();
 	return this->img_icon;
 }
 
@@ -546,32 +659,15 @@ int PSP::loadFieldData(void)
 	d->fields->setTabName(0, (unlikely(d->discType == PSPPrivate::DiscType::UmdVideo) ? "UMD" : "PSP"));
 
 	// Show UMD_DATA.BIN fields.
-	// FIXME: Figure out what the fields are.
-	// - '|'-terminated fields.
-	// - Field 0: Game ID
-	// - Field 1: Encryption key?
-	// - Field 2: Revision?
-	// - Field 3: Age rating?
-	IRpFile *const umdDataBin = d->isoPartition->open("/UMD_DATA.BIN");
-	if (umdDataBin->isOpen()) {
-		// Read up to 128 bytes.
-		char buf[129];
-		size_t size = umdDataBin->read(buf, sizeof(buf)-1);
-		buf[size] = 0;
-
-		// Find the first '|'.
-		const char *p = static_cast<const char*>(memchr(buf, '|', sizeof(buf)));
-		if (p) {
-			// Game ID field on UMD Video discs is the video title.
-			const char *const gameID_title =
-				(unlikely(d->discType == PSPPrivate::DiscType::UmdVideo)
-					? C_("RomData", "Video Title")
-					: C_("RomData", "Game ID"));
-			d->fields->addField_string(gameID_title,
-				latin1_to_utf8(buf, static_cast<int>(p - buf)));
-		}
+	string gameID = d->getUmdDataGameID();
+	if (!gameID.empty()) {
+		// Game ID field on UMD Video discs is the video title.
+		const char *const gameID_title =
+			(unlikely(d->discType == PSPPrivate::DiscType::UmdVideo)
+				? C_("RomData", "Video Title")
+				: C_("RomData", "Game ID"));
+		d->fields->addField_string(gameID_title, std::move(gameID));
 	}
-	UNREF(umdDataBin);
 
 	// TODO: Add fields from PARAM.SFO.
 
@@ -661,29 +757,11 @@ int PSP::loadMetaData(void)
 	// Add the disc ID and/or title from UMD_DATA.BIN.
 	// The PVD title is useless in most cases.
 	// TODO: Split this into a separate function?
-	// Show UMD_DATA.BIN fields.
-	// FIXME: Figure out what the fields are.
-	// - '|'-terminated fields.
-	// - Field 0: Game ID
-	// - Field 1: Encryption key?
-	// - Field 2: Revision?
-	// - Field 3: Age rating?
-	IRpFile *const umdDataBin = d->isoPartition->open("/UMD_DATA.BIN");
-	if (umdDataBin->isOpen()) {
-		// Read up to 128 bytes.
-		char buf[129];
-		size_t size = umdDataBin->read(buf, sizeof(buf)-1);
-		buf[size] = 0;
-
-		// Find the first '|'.
-		const char *p = static_cast<const char*>(memchr(buf, '|', sizeof(buf)));
-		if (p) {
-			// Game ID field on UMD Video discs is the video title.
-			d->metaData->addMetaData_string(Property::Title,
-				latin1_to_utf8(buf, static_cast<int>(p - buf)));
-		}
+	string gameID = d->getUmdDataGameID();
+	if (!gameID.empty()) {
+		// Game ID field on UMD Video discs is the video title.
+		d->metaData->addMetaData_string(Property::Title, gameID);
 	}
-	UNREF(umdDataBin);
 
 	// TODO: More PSP-specific metadata?
 
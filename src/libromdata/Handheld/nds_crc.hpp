@@ -8,31 +8,27 @@
 
 #include <string.h>
 
+// librpcpu
+#include "librpcpu/crc16_rp.h"
+
 //#include "little.h"		// FixCrc is not yet big endian compatible
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/*
- * Data
- */
-extern const uint16_t crc16tab[];
-
 /*
  * CalcCrc16
  * Does not perform final inversion.
+ * NOTE: Uses librpcpu's slicing-by-8 CRC16.
  */
-static inline uint16_t CalcCrc16(uint8_t *data, size_t length, uint16_t crc
+static inline uint16_t CalcCrc16(const uint8_t *data, size_t length, uint16_t crc
 #ifdef __cplusplus
 	= (uint16_t)~0U
 #endif /* __cplusplus */
 	)
 {
-	for (; length > 0; length--, data++) {
-		crc = (crc >> 8) ^ crc16tab[(crc ^ *data) & 0xFF];
-	}
-	return crc;
+	return rp_crc16(crc, data, length);
 }
 
 #ifdef __cplusplus
@@ -14,7 +14,7 @@
 #include "ndscrypt.hpp"
 
 #include "byteswap_rp.h"
-#include "nds_crc.hpp"	// TODO: Optimized versions?
+#include "nds_crc.hpp"
 
 // C includes.
 #include <stdint.h>
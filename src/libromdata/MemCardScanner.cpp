@@ -0,0 +1,323 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * MemCardScanner.cpp: Memory card save directory scanner.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "MemCardScanner.hpp"
+
+#include "Console/DreamcastSave.hpp"
+#include "Console/GameCubeSave.hpp"
+
+// librpbase, librpfile, librptexture
+#include "librpfile/RpFile.hpp"
+#include "librptexture/img/rp_image.hpp"
+using LibRpBase::RomData;
+using LibRpFile::RpFile;
+using LibRpTexture::rp_image;
+
+#ifdef _WIN32
+# include "libwin32common/RpWin32_sdk.h"
+# include "librpbase/TextFuncs_wchar.hpp"
+#else /* !_WIN32 */
+# include <dirent.h>
+# include <sys/stat.h>
+#endif /* _WIN32 */
+
+// C includes. (C++ namespace)
+#include <cerrno>
+
+// C++ includes.
+#include <algorithm>
+using std::string;
+using std::vector;
+
+namespace LibRomData {
+
+namespace MemCardScannerPrivate {
+
+/**
+ * Save file type, based on the file extension.
+ */
+enum class FileType {
+	Unknown,
+	GCN,	// .gci, .gcs, .sav
+	VMS,	// .vms
+	VMI,	// .vmi
+	DCI,	// .dci
+};
+
+/**
+ * Determine the save file type from a filename.
+ * @param filename Filename.
+ * @return FileType.
+ */
+static FileType getFileType(const string &filename)
+{
+	const size_t dot_pos = filename.rfind('.');
+	if (dot_pos == string::npos || filename.size() - dot_pos != 4) {
+		// All supported extensions have 3 characters.
+		return FileType::Unknown;
+	}
+
+	const char *const ext = &filename[dot_pos + 1];
+	if (!strcasecmp(ext, "gci") || !strcasecmp(ext, "gcs") || !strcasecmp(ext, "sav")) {
+		return FileType::GCN;
+	} else if (!strcasecmp(ext, "vms")) {
+		return FileType::VMS;
+	} else if (!strcasecmp(ext, "vmi")) {
+		return FileType::VMI;
+	} else if (!strcasecmp(ext, "dci")) {
+		return FileType::DCI;
+	}
+	return FileType::Unknown;
+}
+
+/**
+ * List the regular files in a directory.
+ * Subdirectories are not scanned.
+ * @param path	[in] Directory.
+ * @param files	[out] Filenames, without the directory.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int listFiles(const string &path, vector<string> &files)
+{
+#ifdef _WIN32
+	tstring tpath = U82T_s(path);
+	if (!tpath.empty() && tpath[tpath.size()-1] != _T('\\') && tpath[tpath.size()-1] != _T('/')) {
+		tpath += _T('\\');
+	}
+	tpath += _T('*');
+
+	WIN32_FIND_DATA ffd;
+	HANDLE hFind = FindFirstFile(tpath.c_str(), &ffd);
+	if (!hFind || hFind == INVALID_HANDLE_VALUE) {
+		return -ENOENT;
+	}
+	do {
+		if (ffd.dwFileAttributes & (FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_DEVICE)) {
+			continue;
+		}
+		files.emplace_back(T2U8(ffd.cFileName));
+	} while (FindNextFile(hFind, &ffd));
+	FindClose(hFind);
+	return 0;
+#else /* !_WIN32 */
+	DIR *const pdir = opendir(path.c_str());
+	if (!pdir) {
+		// Error opening the directory.
+		return -errno;
+	}
+
+	struct dirent *dirent;
+	while ((dirent = readdir(pdir)) != nullptr) {
+		uint8_t d_type = dirent->d_type;
+		if (d_type == DT_UNKNOWN || d_type == DT_LNK) {
+			// Unknown, or a symbolic link. Use stat().
+			string fullpath(path);
+			fullpath += '/';
+			fullpath += dirent->d_name;
+			struct stat sb;
+			if (stat(fullpath.c_str(), &sb) != 0 || !S_ISREG(sb.st_mode))
+				continue;
+			d_type = DT_REG;
+		}
+
+		if (d_type == DT_REG) {
+			files.emplace_back(dirent->d_name);
+		}
+	}
+
+	closedir(pdir);
+	return 0;
+#endif /* _WIN32 */
+}
+
+/**
+ * Find the .VMI file for a .VMS file.
+ * @param files		[in] Filenames in the directory, sorted.
+ * @param vms_filename	[in] .VMS filename.
+ * @return .VMI filename, or empty string if not found.
+ */
+static string findVmiFile(const vector<string> &files, const string &vms_filename)
+{
+	// Try the same case as the .VMS extension first,
+	// then fall back to a case-insensitive search.
+	string vmi_filename = vms_filename;
+	const size_t ext_pos = vmi_filename.size() - 2;
+	vmi_filename[ext_pos] = (vmi_filename[ext_pos] == 'M' ? 'I' : 'i');
+	if (std::binary_search(files.cbegin(), files.cend(), vmi_filename)) {
+		return vmi_filename;
+	}
+
+	for (const string &file : files) {
+		if (file.size() == vmi_filename.size() &&
+		    !strcasecmp(file.c_str(), vmi_filename.c_str()))
+		{
+			return file;
+		}
+	}
+	return string();
+}
+
+}
+
+/**
+ * Scan a directory for GameCube and Dreamcast save files.
+ *
+ * Supported files:
+ * - GameCube: .gci, .gcs, .sav
+ * - Dreamcast: .vms (with .vmi if present), .dci
+ *
+ * Subdirectories are not scanned. Files that can't be
+ * parsed are skipped.
+ *
+ * @param path	[in] Directory.
+ * @param saves	[out] Save file descriptors, sorted by filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int MemCardScanner::scanDirectory(const string &path, vector<MemCardSaveInfo> &saves)
+{
+	using namespace MemCardScannerPrivate;
+
+	saves.clear();
+	assert(!path.empty());
+	if (path.empty()) {
+		return -EINVAL;
+	}
+
+	vector<string> files;
+	int ret = listFiles(path, files);
+	if (ret != 0) {
+		return ret;
+	}
+	std::sort(files.begin(), files.end());
+
+	string dirname(path);
+#ifdef _WIN32
+	if (dirname[dirname.size()-1] != '\\' && dirname[dirname.size()-1] != '/') {
+		dirname += '\\';
+	}
+#else /* !_WIN32 */
+	if (dirname[dirname.size()-1] != '/') {
+		dirname += '/';
+	}
+#endif /* _WIN32 */
+
+	for (const string &file : files) {
+		const FileType fileType = getFileType(file);
+		if (fileType == FileType::Unknown || fileType == FileType::VMI) {
+			// Not a save file, or a .VMI file.
+			// .VMI files are handled with their .VMS files.
+			continue;
+		}
+
+		MemCardSaveInfo info;
+		info.filename = dirname + file;
+		info.timestamp = -1;
+		info.blocks = 0;
+		info.system = MemCardSaveInfo::System::Unknown;
+
+		RpFile *const f = new RpFile(info.filename, RpFile::FM_OPEN_READ);
+		if (!f->isOpen()) {
+			f->unref();
+			continue;
+		}
+
+		switch (fileType) {
+			case FileType::GCN:
+				ret = GameCubeSave::readSaveInfo(f, &info);
+				break;
+
+			case FileType::VMS: {
+				const string vmi_file = findVmiFile(files, file);
+				RpFile *fvmi = nullptr;
+				if (!vmi_file.empty()) {
+					fvmi = new RpFile(dirname + vmi_file, RpFile::FM_OPEN_READ);
+					if (fvmi->isOpen()) {
+						info.vmi_filename = dirname + vmi_file;
+					} else {
+						UNREF_AND_NULL_NOCHK(fvmi);
+					}
+				}
+				ret = DreamcastSave::readSaveInfo(f, fvmi, &info);
+				if (fvmi) {
+					fvmi->unref();
+				}
+				break;
+			}
+
+			case FileType::DCI:
+				ret = DreamcastSave::readSaveInfo(f, nullptr, &info);
+				break;
+
+			default:
+				assert(!"Unhandled file type.");
+				ret = -EINVAL;
+				break;
+		}
+		f->unref();
+
+		if (ret == 0) {
+			saves.emplace_back(std::move(info));
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Load the icon for a save file.
+ * Only the first frame of an animated icon is decoded.
+ * @param info Save file descriptor.
+ * @return Icon (caller must unref()), or nullptr on error.
+ */
+rp_image *MemCardScanner::loadIcon(const MemCardSaveInfo &info)
+{
+	RpFile *const f = new RpFile(info.filename, RpFile::FM_OPEN_READ);
+	if (!f->isOpen()) {
+		f->unref();
+		return nullptr;
+	}
+
+	RomData *romData = nullptr;
+	switch (info.system) {
+		case MemCardSaveInfo::System::GameCube:
+			romData = new GameCubeSave(f);
+			break;
+
+		case MemCardSaveInfo::System::Dreamcast:
+			if (!info.vmi_filename.empty()) {
+				RpFile *const fvmi = new RpFile(info.vmi_filename, RpFile::FM_OPEN_READ);
+				if (fvmi->isOpen()) {
+					romData = new DreamcastSave(f, fvmi);
+				}
+				fvmi->unref();
+			} else {
+				romData = new DreamcastSave(f);
+			}
+			break;
+
+		default:
+			break;
+	}
+	f->unref();
+	if (!romData) {
+		return nullptr;
+	}
+
+	rp_image *img = nullptr;
+	if (romData->isValid()) {
+		const rp_image *const icon = romData->image(RomData::IMG_INT_ICON);
+		if (icon) {
+			img = const_cast<rp_image*>(icon)->ref();
+		}
+	}
+	romData->unref();
+	return img;
+}
+
+}
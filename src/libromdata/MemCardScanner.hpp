@@ -0,0 +1,91 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * MemCardScanner.hpp: Memory card save directory scanner.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_MEMCARDSCANNER_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_MEMCARDSCANNER_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stdint.h>
+#include <time.h>
+
+// C++ includes.
+#include <string>
+#include <vector>
+
+namespace LibRpTexture {
+	class rp_image;
+}
+
+namespace LibRomData {
+
+/**
+ * Lightweight save file descriptor.
+ * Filled in by MemCardScanner without creating RomData objects.
+ */
+struct MemCardSaveInfo {
+	enum class System : uint8_t {
+		Unknown = 0,
+		GameCube,	// .gci, .gcs, .sav
+		Dreamcast,	// .vms (+.vmi), .dci
+	};
+
+	std::string filename;		// Save file (VMS file for .VMI+.VMS pairs)
+	std::string vmi_filename;	// VMI file for .VMI+.VMS pairs (Dreamcast only)
+	std::string gameID;		// Game ID (GameCube only)
+	std::string title;		// Title (first description line)
+	std::string description;	// Description (second description line)
+	time_t timestamp;		// GameCube: Last modified; Dreamcast: Created (-1 if unknown)
+	unsigned int blocks;		// Size, in memory card blocks
+	System system;
+};
+
+/**
+ * Enumerates the save files in a memory card export directory.
+ *
+ * Only the save file headers are read, so no icons or banners
+ * are decoded. Use loadIcon() to load an icon on demand.
+ */
+class MemCardScanner
+{
+	private:
+		MemCardScanner();
+		~MemCardScanner();
+	private:
+		RP_DISABLE_COPY(MemCardScanner)
+
+	public:
+		/**
+		 * Scan a directory for GameCube and Dreamcast save files.
+		 *
+		 * Supported files:
+		 * - GameCube: .gci, .gcs, .sav
+		 * - Dreamcast: .vms (with .vmi if present), .dci
+		 *
+		 * Subdirectories are not scanned. Files that can't be
+		 * parsed are skipped.
+		 *
+		 * @param path	[in] Directory.
+		 * @param saves	[out] Save file descriptors, sorted by filename.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int scanDirectory(const std::string &path, std::vector<MemCardSaveInfo> &saves);
+
+		/**
+		 * Load the icon for a save file.
+		 * Only the first frame of an animated icon is decoded.
+		 * @param info Save file descriptor.
+		 * @return Icon (caller must unref()), or nullptr on error.
+		 */
+		static LibRpTexture::rp_image *loadIcon(const MemCardSaveInfo &info);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_MEMCARDSCANNER_HPP__ */
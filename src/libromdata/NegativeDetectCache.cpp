@@ -0,0 +1,409 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * NegativeDetectCache.cpp: Persistent cache of unsupported files.         *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.version.h"
+#include "NegativeDetectCache.hpp"
+
+// librpfile
+using namespace LibRpFile;
+using LibRpFile::FileSystem::FileIdentity;
+
+// librpthreads
+#include "librpthreads/pthread_once.h"
+#include "librpthreads/Mutex.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+// libcachecommon
+#include "libcachecommon/CacheDir.hpp"
+
+// OS-specific includes.
+#ifdef _WIN32
+# include "libwin32common/RpWin32_sdk.h"
+# include "libwin32common/w32err.h"
+# include "librpbase/TextFuncs_wchar.hpp"
+#else /* !_WIN32 */
+// getpid(), rename()
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif /* _WIN32 */
+
+// C++ STL classes.
+using std::string;
+using std::unordered_set;
+using std::vector;
+
+namespace LibRomData {
+
+namespace NegativeDetectCachePrivate {
+
+// Cache file header.
+// NOTE: Records are stored in host byte order, since
+// the cache is only used on the local system.
+static const char CACHE_MAGIC[8] = {'R','P','N','E','G','D','C','2'};
+struct CacheHeader {
+	char magic[8];		// CACHE_MAGIC
+	char version[24];	// RP_VERSION_STRING, NULL-padded
+};
+ASSERT_STRUCT(CacheHeader, 32);
+
+// Cache record.
+struct CacheRecord {
+	uint64_t device;
+	uint64_t inode;
+	int64_t size;
+	int64_t mtime_ns;
+	uint32_t attrs;
+	uint32_t name_hash;	// Hash of the filename, without the directory.
+
+	inline bool operator==(const CacheRecord &other) const
+	{
+		return (device == other.device && inode == other.inode &&
+		        size == other.size && mtime_ns == other.mtime_ns &&
+		        attrs == other.attrs && name_hash == other.name_hash);
+	}
+};
+ASSERT_STRUCT(CacheRecord, 40);
+
+struct CacheRecordHash {
+	inline size_t operator()(const CacheRecord &rec) const
+	{
+		// FNV-1a over the key fields.
+		uint64_t h = 14695981039346656037ULL;
+		const uint64_t vals[] = {
+			rec.device, rec.inode,
+			static_cast<uint64_t>(rec.size),
+			static_cast<uint64_t>(rec.mtime_ns),
+			rec.attrs, rec.name_hash
+		};
+		for (uint64_t v : vals) {
+			h ^= v;
+			h *= 1099511628211ULL;
+		}
+		return static_cast<size_t>(h);
+	}
+};
+
+// Maximum number of records in the cache.
+// When this is exceeded, the oldest half is discarded.
+static const size_t MAX_RECORDS = 16384;
+
+// Cache contents.
+// vec_records is in insertion order; set_records is used for lookups.
+static vector<CacheRecord> vec_records;
+static unordered_set<CacheRecord, CacheRecordHash> set_records;
+static string cache_filename;
+static Mutex mtxCache;
+static pthread_once_t once_control = PTHREAD_ONCE_INIT;
+
+/**
+ * Initialize a cache header for this version.
+ * @param header Cache header
+ */
+static void initHeader(CacheHeader &header)
+{
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+	strncpy(header.version, RP_VERSION_STRING, sizeof(header.version)-1);
+}
+
+/**
+ * Load the cache file.
+ * Called by pthread_once().
+ */
+static void loadCache(void)
+{
+	const string &cache_dir = LibCacheCommon::getCacheDirectory();
+	if (cache_dir.empty())
+		return;
+	cache_filename = cache_dir;
+#ifdef _WIN32
+	cache_filename += "\\negdetect.bin";
+#else /* !_WIN32 */
+	cache_filename += "/negdetect.bin";
+#endif /* _WIN32 */
+
+	RpFile *const file = new RpFile(cache_filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		// No cache file yet.
+		file->unref();
+		return;
+	}
+
+	CacheHeader header, header_expected;
+	initHeader(header_expected);
+	size_t size = file->read(&header, sizeof(header));
+	if (size != sizeof(header) || memcmp(&header, &header_expected, sizeof(header)) != 0) {
+		// Incorrect header, or written by a different version.
+		// The cache file will be rewritten on the next add.
+		file->unref();
+		return;
+	}
+
+	// Read the records.
+	// Records are appended, so if there are too many records,
+	// only the newest records at the end of the file are read.
+	const off64_t fileSize = file->size();
+	const size_t total = static_cast<size_t>((fileSize - sizeof(header)) / sizeof(CacheRecord));
+	const size_t count = std::min(total, MAX_RECORDS);
+	const off64_t pos = static_cast<off64_t>(sizeof(header)) +
+		static_cast<off64_t>(total - count) * static_cast<off64_t>(sizeof(CacheRecord));
+	vec_records.resize(count);
+	size = file->seekAndRead(pos, vec_records.data(), count * sizeof(CacheRecord));
+	file->unref();
+	vec_records.resize(size / sizeof(CacheRecord));
+
+#ifdef HAVE_UNORDERED_SET_RESERVE
+	set_records.reserve(vec_records.size());
+#endif /* HAVE_UNORDERED_SET_RESERVE */
+	set_records.insert(vec_records.cbegin(), vec_records.cend());
+}
+
+/**
+ * Rewrite the entire cache file.
+ * mtxCache must be locked by the caller.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int rewriteCache(void)
+{
+	if (FileSystem::rmkdir(cache_filename) != 0)
+		return -EIO;
+
+	// Write to a temporary file, then rename it over the cache file.
+	// Other processes may be reading the cache file or appending to it,
+	// so it must never be truncated or partially written.
+	char pid_buf[24];
+#ifdef _WIN32
+	snprintf(pid_buf, sizeof(pid_buf), ".%lu.tmp", static_cast<unsigned long>(GetCurrentProcessId()));
+#else /* !_WIN32 */
+	snprintf(pid_buf, sizeof(pid_buf), ".%ld.tmp", static_cast<long>(getpid()));
+#endif /* _WIN32 */
+	const string tmp_filename = cache_filename + pid_buf;
+
+	RpFile *const file = new RpFile(tmp_filename, RpFile::FM_CREATE_WRITE);
+	if (!file->isOpen()) {
+		int ret = -file->lastError();
+		if (ret == 0) {
+			ret = -EIO;
+		}
+		file->unref();
+		return ret;
+	}
+
+	CacheHeader header;
+	initHeader(header);
+	const size_t data_len = vec_records.size() * sizeof(CacheRecord);
+	int ret = 0;
+	if (file->write(&header, sizeof(header)) != sizeof(header) ||
+	    file->write(vec_records.data(), data_len) != data_len)
+	{
+		// Short write.
+		ret = -file->lastError();
+		if (ret == 0) {
+			ret = -EIO;
+		}
+	}
+	file->unref();
+
+	if (ret == 0) {
+#ifdef _WIN32
+		if (!MoveFileEx(U82T_s(tmp_filename), U82T_s(cache_filename), MOVEFILE_REPLACE_EXISTING)) {
+			ret = -w32err_to_posix(GetLastError());
+		}
+#else /* !_WIN32 */
+		if (rename(tmp_filename.c_str(), cache_filename.c_str()) != 0) {
+			ret = -errno;
+			if (ret == 0) {
+				ret = -EIO;
+			}
+		}
+#endif /* _WIN32 */
+	}
+	if (ret != 0) {
+		// Write or rename failed. Remove the temporary file.
+		FileSystem::delete_file(tmp_filename);
+	}
+	return ret;
+}
+
+/**
+ * Append a record to the cache file.
+ * mtxCache must be locked by the caller.
+ * @param rec Cache record
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int appendRecord(const CacheRecord &rec)
+{
+	// NOTE: Other processes may be appending records at the same time,
+	// so the file is opened in append mode. Each record is written
+	// with a single write, which is atomic in append mode.
+#ifdef _WIN32
+	HANDLE hFile = CreateFile(U82T_s(cache_filename),
+		FILE_APPEND_DATA | FILE_READ_ATTRIBUTES,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (!hFile || hFile == INVALID_HANDLE_VALUE) {
+		// Cache file is missing. Rewrite it.
+		return rewriteCache();
+	}
+	LARGE_INTEGER liFileSize;
+	if (!GetFileSizeEx(hFile, &liFileSize) ||
+	    liFileSize.QuadPart < static_cast<LONGLONG>(sizeof(CacheHeader)))
+	{
+		// Cache file is invalid. Rewrite it.
+		CloseHandle(hFile);
+		return rewriteCache();
+	}
+
+	int ret = 0;
+	DWORD dwBytesWritten = 0;
+	if (!WriteFile(hFile, &rec, sizeof(rec), &dwBytesWritten, nullptr)) {
+		ret = -w32err_to_posix(GetLastError());
+	} else if (dwBytesWritten != sizeof(rec)) {
+		ret = -ENOSPC;
+	}
+	CloseHandle(hFile);
+	return ret;
+#else /* !_WIN32 */
+	int fd = ::open(cache_filename.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+	if (fd < 0) {
+		// Cache file is missing. Rewrite it.
+		return rewriteCache();
+	}
+	struct stat sb;
+	if (fstat(fd, &sb) != 0 || sb.st_size < static_cast<off_t>(sizeof(CacheHeader))) {
+		// Cache file is invalid. Rewrite it.
+		::close(fd);
+		return rewriteCache();
+	}
+
+	int ret = 0;
+	const ssize_t sz = ::write(fd, &rec, sizeof(rec));
+	if (sz < 0) {
+		ret = -errno;
+	} else if (static_cast<size_t>(sz) != sizeof(rec)) {
+		ret = -ENOSPC;
+	}
+	::close(fd);
+	return ret;
+#endif /* _WIN32 */
+}
+
+/**
+ * Hash a filename for a CacheRecord.
+ * Only the filename itself is used, not the directory.
+ * RomData subclasses may check the file extension, so renaming
+ * a file must invalidate its entry.
+ * @param filename Filename (UTF-8)
+ * @return Filename hash (FNV-1a)
+ */
+static uint32_t hashFilename(const char *filename)
+{
+	const char *name = filename;
+	for (const char *p = filename; *p != '\0'; p++) {
+#ifdef _WIN32
+		if (*p == '\\' || *p == '/')
+#else /* !_WIN32 */
+		if (*p == '/')
+#endif /* _WIN32 */
+		{
+			name = p + 1;
+		}
+	}
+
+	uint32_t h = 2166136261U;
+	for (; *name != '\0'; name++) {
+		h ^= static_cast<uint8_t>(*name);
+		h *= 16777619U;
+	}
+	return h;
+}
+
+/**
+ * Convert a FileIdentity, filename, and attributes to a CacheRecord.
+ * @param id File identity
+ * @param filename Filename (UTF-8)
+ * @param attrs RomDataAttr bitfield
+ * @return CacheRecord
+ */
+static inline CacheRecord makeRecord(const FileIdentity &id, const char *filename, unsigned int attrs)
+{
+	CacheRecord rec;
+	rec.device = id.device;
+	rec.inode = id.inode;
+	rec.size = id.size;
+	rec.mtime_ns = id.mtime_ns;
+	rec.attrs = attrs;
+	rec.name_hash = hashFilename(filename);
+	return rec;
+}
+
+}
+
+/**
+ * Is a file known to be unsupported?
+ * @param id File identity
+ * @param filename Filename (UTF-8)
+ * @param attrs RomDataAttr bitfield
+ * @return True if the file is known to be unsupported; false if not.
+ */
+bool NegativeDetectCache::isUnsupported(const FileIdentity &id, const char *filename, unsigned int attrs)
+{
+	using namespace NegativeDetectCachePrivate;
+	assert(filename != nullptr);
+	if (!filename)
+		return false;
+	pthread_once(&once_control, loadCache);
+
+	MutexLocker locker(mtxCache);
+	return (set_records.find(makeRecord(id, filename, attrs)) != set_records.end());
+}
+
+/**
+ * Mark a file as unsupported.
+ * The entry is written to the cache file immediately.
+ * @param id File identity
+ * @param filename Filename (UTF-8)
+ * @param attrs RomDataAttr bitfield
+ */
+void NegativeDetectCache::addUnsupported(const FileIdentity &id, const char *filename, unsigned int attrs)
+{
+	using namespace NegativeDetectCachePrivate;
+	assert(filename != nullptr);
+	if (!filename)
+		return;
+	pthread_once(&once_control, loadCache);
+	if (cache_filename.empty()) {
+		// No cache directory.
+		return;
+	}
+
+	const CacheRecord rec = makeRecord(id, filename, attrs);
+	MutexLocker locker(mtxCache);
+	if (!set_records.insert(rec).second) {
+		// Already in the cache.
+		return;
+	}
+	vec_records.emplace_back(rec);
+
+	if (vec_records.size() > MAX_RECORDS) {
+		// Too many records. Discard the oldest half.
+		const size_t discard = vec_records.size() - (MAX_RECORDS / 2);
+		for (size_t i = 0; i < discard; i++) {
+			set_records.erase(vec_records[i]);
+		}
+		vec_records.erase(vec_records.begin(), vec_records.begin() + discard);
+		rewriteCache();
+	} else {
+		appendRecord(rec);
+	}
+}
+
+}
@@ -0,0 +1,57 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * NegativeDetectCache.hpp: Persistent cache of unsupported files.         *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_NEGATIVEDETECTCACHE_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_NEGATIVEDETECTCACHE_HPP__
+
+#include "common.h"
+#include "librpfile/FileSystem.hpp"
+
+namespace LibRomData {
+
+/**
+ * Persistent cache of files that RomDataFactory doesn't support.
+ *
+ * Entries are keyed by the file's identity (device, inode, size,
+ * and mtime), the filename without the directory, and the requested
+ * RomDataAttr bitfield, so modifying or renaming a file automatically
+ * invalidates its entry. The cache is stored
+ * in the rom-properties cache directory and is discarded if it was
+ * written by a different version of rom-properties.
+ */
+class NegativeDetectCache
+{
+	private:
+		NegativeDetectCache();
+		~NegativeDetectCache();
+	private:
+		RP_DISABLE_COPY(NegativeDetectCache)
+
+	public:
+		/**
+		 * Is a file known to be unsupported?
+		 * @param id File identity
+		 * @param filename Filename (UTF-8)
+		 * @param attrs RomDataAttr bitfield
+		 * @return True if the file is known to be unsupported; false if not.
+		 */
+		static bool isUnsupported(const LibRpFile::FileSystem::FileIdentity &id, const char *filename, unsigned int attrs);
+
+		/**
+		 * Mark a file as unsupported.
+		 * The entry is written to the cache file immediately.
+		 * @param id File identity
+		 * @param filename Filename (UTF-8)
+		 * @param attrs RomDataAttr bitfield
+		 */
+		static void addUnsupported(const LibRpFile::FileSystem::FileIdentity &id, const char *filename, unsigned int attrs);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_NEGATIVEDETECTCACHE_HPP__ */
@@ -144,6 +144,17 @@ class ELFPrivate final : public RomDataPrivate
 				: __swab64(x);
 		}
 
+		/**
+		 * Read a program or section header table.
+		 * The entire table is read at once.
+		 * @param tbl		[out] Table data.
+		 * @param offset	[in] Table offset.
+		 * @param count		[in] Number of entries.
+		 * @param entsize	[in] Entry size.
+		 * @return Number of entries read.
+		 */
+		unsigned int readHeaderTable(ao::uvector<uint8_t> &tbl, off64_t offset, unsigned int count, unsigned int entsize);
+
 		/**
 		 * Check program headers.
 		 * @return 0 on success; non-zero on error.
@@ -211,6 +222,31 @@ ELFPrivate::hdr_info_t ELFPrivate::readProgramHeader(const uint8_t *phbuf)
 	return info;
 }
 
+/**
+ * Read a program or section header table.
+ * The entire table is read at once.
+ * @param tbl		[out] Table data.
+ * @param offset	[in] Table offset.
+ * @param count		[in] Number of entries.
+ * @param entsize	[in] Entry size.
+ * @return Number of entries read.
+ */
+unsigned int ELFPrivate::readHeaderTable(ao::uvector<uint8_t> &tbl, off64_t offset, unsigned int count, unsigned int entsize)
+{
+	// NOTE: e_phnum and e_shnum are 16-bit, so the
+	// table can't be larger than 64K entries.
+	assert(count <= 65535);
+	const size_t tbl_size = static_cast<size_t>(count) * entsize;
+	tbl.resize(tbl_size);
+	size_t size = file->seekAndRead(offset, tbl.data(), tbl_size);
+	if (size != tbl_size) {
+		// Short read. Use the entries that were read in full.
+		count = static_cast<unsigned int>(size / entsize);
+		tbl.resize(static_cast<size_t>(count) * entsize);
+	}
+	return count;
+}
+
 /**
  * Check program headers.
  * @return 0 on success; non-zero on error.
@@ -232,7 +268,6 @@ int ELFPrivate::checkProgramHeaders(void)
 	off64_t e_phoff;
 	unsigned int e_phnum;
 	unsigned int phsize;
-	uint8_t phbuf[sizeof(Elf64_Phdr)];
 
 	if (Elf_Header.primary.e_class == ELFCLASS64) {
 		e_phoff = static_cast<off64_t>(Elf_Header.elf64.e_phoff);
@@ -249,20 +284,12 @@ int ELFPrivate::checkProgramHeaders(void)
 		return 0;
 	}
 
-	int ret = file->seek(e_phoff);
-	if (ret != 0) {
-		// Seek error.
-		return ret;
-	}
-
 	// Read all of the program header entries.
+	ao::uvector<uint8_t> phtbl;
+	e_phnum = readHeaderTable(phtbl, e_phoff, e_phnum, phsize);
 	const bool isHostEndian = (Elf_Header.primary.e_data == ELFDATAHOST);
-	for (; e_phnum > 0; e_phnum--) {
-		size_t size = file->read(phbuf, phsize);
-		if (size != phsize) {
-			// Read error.
-			break;
-		}
+	const uint8_t *phbuf = phtbl.data();
+	for (; e_phnum > 0; e_phnum--, phbuf += phsize) {
 
 		// Check the type.
 		uint32_t p_type;
@@ -283,17 +310,11 @@ int ELFPrivate::checkProgramHeaders(void)
 				// NOTE: Interpreter should be NULL-terminated.
 				if (info.size <= 256) {
 					char buf[256];
-					const off64_t prevoff = file->tell();
-					size = file->seekAndRead(info.addr, buf, info.size);
+					size_t size = file->seekAndRead(info.addr, buf, info.size);
 					if (size != info.size) {
 						// Seek and/or read error.
 						return -EIO;
 					}
-					ret = file->seek(prevoff);
-					if (ret != 0) {
-						// Seek error.
-						return ret;
-					}
 
 					// Remove trailing NULLs.
 					while (info.size > 0 && buf[info.size-1] == 0) {
@@ -341,7 +362,6 @@ int ELFPrivate::checkSectionHeaders(void)
 	off64_t e_shoff;
 	unsigned int e_shnum;
 	unsigned int shsize;
-	uint8_t shbuf[sizeof(Elf64_Shdr)];
 
 	if (Elf_Header.primary.e_class == ELFCLASS64) {
 		e_shoff = static_cast<off64_t>(Elf_Header.elf64.e_shoff);
@@ -358,21 +378,17 @@ int ELFPrivate::checkSectionHeaders(void)
 		return 0;
 	}
 
-	int ret = file->seek(e_shoff);
-	if (ret != 0) {
-		// Seek error.
-		return ret;
-	}
-
 	// Read all of the section header entries.
-	const bool isHostEndian = (Elf_Header.primary.e_data == ELFDATAHOST);
-	for (; e_shnum > 0; e_shnum--) {
-		size_t size = file->read(shbuf, shsize);
-		if (size != shsize) {
-			// Read error.
-			break;
-		}
+	ao::uvector<uint8_t> shtbl;
+	e_shnum = readHeaderTable(shtbl, e_shoff, e_shnum, shsize);
 
+	// Find the notes.
+	// NOTE: Only notes are supported right now.
+	static const unsigned int NOTE_SIZE_MAX = 256;
+	const bool isHostEndian = (Elf_Header.primary.e_data == ELFDATAHOST);
+	vector<IRpFile::ReadRequest> reqs;
+	const uint8_t *shbuf = shtbl.data();
+	for (; e_shnum > 0; e_shnum--, shbuf += shsize) {
 		// Check the type.
 		uint32_t s_type;
 		memcpy(&s_type, &shbuf[4], sizeof(s_type));
@@ -380,7 +396,6 @@ int ELFPrivate::checkSectionHeaders(void)
 			s_type = __swab32(s_type);
 		}
 
-		// Only NOTEs are supported right now.
 		if (s_type != SHT_NOTE)
 			continue;
 
@@ -410,23 +425,38 @@ int ELFPrivate::checkSectionHeaders(void)
 		// Sanity check: Note must be 256 bytes or less,
 		// and must be greater than sizeof(Elf32_Nhdr).
 		// NOTE: Elf32_Nhdr and Elf64_Nhdr are identical.
-		if (int_size < sizeof(Elf32_Nhdr) || int_size > 256) {
+		if (int_size < sizeof(Elf32_Nhdr) || int_size > NOTE_SIZE_MAX) {
 			// Out of range. Ignore it.
 			continue;
 		}
 
-		uint8_t buf[256];
-		const off64_t prevoff = file->tell();
-		size = file->seekAndRead(int_addr, buf, int_size);
-		if (size != int_size) {
+		IRpFile::ReadRequest req;
+		req.pos = int_addr;
+		req.ptr = nullptr;	// set below
+		req.size = static_cast<size_t>(int_size);
+		reqs.push_back(req);
+	}
+	if (reqs.empty()) {
+		// No notes.
+		return 0;
+	}
+
+	// Read all of the notes at once.
+	ao::uvector<uint8_t> notebuf(reqs.size() * NOTE_SIZE_MAX);
+	for (size_t i = 0; i < reqs.size(); i++) {
+		reqs[i].ptr = &notebuf[i * NOTE_SIZE_MAX];
+	}
+	const size_t notesRead = file->readBatch(reqs.data(), reqs.size());
+
+	int ret = 0;
+	for (size_t i = 0; i < reqs.size(); i++) {
+		if (i >= notesRead) {
 			// Seek and/or read error.
-			return -EIO;
-		}
-		ret = file->seek(prevoff);
-		if (ret != 0) {
-			// Seek error.
-			return ret;
+			ret = -EIO;
+			break;
 		}
+		uint8_t *const buf = &notebuf[i * NOTE_SIZE_MAX];
+		const uint64_t int_size = reqs[i].size;
 
 		// Parse the note.
 		Elf32_Nhdr *const nhdr = reinterpret_cast<Elf32_Nhdr*>(buf);
@@ -602,8 +632,8 @@ int ELFPrivate::checkSectionHeaders(void)
 		}
 	}
 
-	// Program headers checked.
-	return 0;
+	// Section headers checked.
+	return ret;
 }
 
 /**
@@ -871,9 +901,10 @@ ELF::ELF(IRpFile *file)
 		}
 	} else {
 		// Standard ELF executable.
-		// Check program and section headers.
+		// Check program headers.
+		// NOTE: Section headers are only needed for fields,
+		// so they're checked in loadFieldData().
 		d->checkProgramHeaders();
-		d->checkSectionHeaders();
 
 		// Determine the file and MIME types.
 		// NOTE: All of these MIME types are present on FreeDesktop.org,
@@ -1518,7 +1549,7 @@ int ELF::loadFieldData(void)
 			}
 
 			if (!s_cf_isa.empty()) {
-				d->fields->addField_string(C_("ELF", "ColdFire ISA"), s_cf_isa);
+				d->fields->addField_string(C_("ELF", "ColdFire ISA"), std::move(s_cf_isa));
 			}
 			break;
 		}
@@ -1714,6 +1745,13 @@ int ELF::loadFieldData(void)
 		d->fields->addField_string(C_("ELF", "Interpreter"), d->interpreter);
 	}
 
+	// Check section headers for the OS version and build ID.
+	// NOTE: Not done in the constructor, since these are
+	// only needed for fields.
+	if (!d->isWiiU) {
+		d->checkSectionHeaders();
+	}
+
 	// Operating system.
 	if (!d->osVersion.empty()) {
 		d->fields->addField_string(C_("ELF", "OS Version"), d->osVersion);
@@ -14,6 +14,10 @@
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
 
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+using LibRpTexture::rp_image;
+
 // C++ STL classes.
 using std::string;
 using std::vector;
@@ -28,6 +32,7 @@ using std::vector;
 namespace LibRomData {
 
 ROMDATA_IMPL(EXE)
+ROMDATA_IMPL_IMG_TYPES(EXE)
 
 /** EXEPrivate **/
 
@@ -47,6 +52,7 @@ EXEPrivate::EXEPrivate(EXE *q, IRpFile *file)
 	, exeType(ExeType::Unknown)
 	, rsrcReader(nullptr)
 	, pe_subsystem(IMAGE_SUBSYSTEM_UNKNOWN)
+	, iconDirLoaded(false)
 {
 	// Clear the structs.
 	memset(&mz, 0, sizeof(mz));
@@ -56,6 +62,9 @@ EXEPrivate::EXEPrivate(EXE *q, IRpFile *file)
 EXEPrivate::~EXEPrivate()
 {
 	UNREF(rsrcReader);
+	for (rp_image *img : img_icons) {
+		UNREF(img);
+	}
 }
 
 /**
@@ -813,6 +822,83 @@ const char *const *EXE::supportedMimeTypes_static(void)
 	return mimeTypes;
 }
 
+/**
+ * Get a bitfield of image types this class can retrieve.
+ * @return Bitfield of supported image types. (ImageTypesBF)
+ */
+uint32_t EXE::supportedImageTypes_static(void)
+{
+	return IMGBF_INT_ICON;
+}
+
+/**
+ * Get a list of all available image sizes for the specified image type.
+ * @param imageType Image type.
+ * @return Vector of available image sizes, or empty vector if no images are available.
+ */
+vector<RomData::ImageSizeDef> EXE::supportedImageSizes(ImageType imageType) const
+{
+	ASSERT_supportedImageSizes(imageType);
+
+	RP_D(const EXE);
+	if (!d->isValid || imageType != IMG_INT_ICON) {
+		return vector<ImageSizeDef>();
+	}
+
+	// Only the icon group directory is read here.
+	// The icon images are decoded by loadInternalImageSize().
+	if (const_cast<EXEPrivate*>(d)->loadIconDir() != 0) {
+		return vector<ImageSizeDef>();
+	}
+
+	// One entry per icon size. The largest icon is the default.
+	vector<ImageSizeDef> sizeDefs;
+	sizeDefs.reserve(d->iconSizeOrder.size());
+	for (const uint16_t idx : d->iconSizeOrder) {
+		const GRPICONDIRENTRY &entry = d->iconDir[idx];
+		const ImageSizeDef imgsz = {nullptr,
+			static_cast<uint16_t>(entry.bWidth != 0 ? entry.bWidth : 256),
+			static_cast<uint16_t>(entry.bHeight != 0 ? entry.bHeight : 256),
+			idx
+		};
+		sizeDefs.emplace_back(imgsz);
+	}
+	return sizeDefs;
+}
+
+/**
+ * Get image processing flags.
+ *
+ * These specify post-processing operations for images,
+ * e.g. applying transparency masks.
+ *
+ * @param imageType Image type.
+ * @return Bitfield of ImageProcessingBF operations to perform.
+ */
+uint32_t EXE::imgpf(ImageType imageType) const
+{
+	ASSERT_imgpf(imageType);
+
+	RP_D(const EXE);
+	if (imageType != IMG_INT_ICON) {
+		// Only IMG_INT_ICON is supported by EXE.
+		return 0;
+	}
+
+	// If the largest icon is 64x64 or smaller,
+	// specify nearest-neighbor scaling.
+	uint32_t ret = 0;
+	if (const_cast<EXEPrivate*>(d)->loadIconDir() == 0) {
+		const GRPICONDIRENTRY &entry = d->iconDir[d->iconSizeOrder[0]];
+		if (entry.bWidth != 0 && entry.bWidth <= 64 &&
+		    entry.bHeight != 0 && entry.bHeight <= 64)
+		{
+			ret = IMGPF_RESCALE_NEAREST;
+		}
+	}
+	return ret;
+}
+
 /**
  * Load field data.
  * Called by RomData::fields() if the field data hasn't been loaded yet.
@@ -917,6 +1003,72 @@ bool EXE::hasDangerousPermissions(void) const
 #endif /* ENABLE_XML */
 }
 
+/**
+ * Load an internal image.
+ * Called by RomData::image().
+ * @param imageType	[in] Image type to load.
+ * @param pImage	[out] Pointer to const rp_image* to store the image in.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int EXE::loadInternalImage(ImageType imageType, const rp_image **pImage)
+{
+	ASSERT_loadInternalImage(imageType, pImage);
+	RP_D(EXE);
+	if (imageType != IMG_INT_ICON) {
+		*pImage = nullptr;
+		return -ENOENT;
+	} else if (!d->file) {
+		*pImage = nullptr;
+		return -EBADF;
+	} else if (!d->isValid) {
+		*pImage = nullptr;
+		return -EIO;
+	}
+
+	// Load the default (largest) icon.
+	int ret = d->loadIconDir();
+	if (ret != 0) {
+		*pImage = nullptr;
+		return ret;
+	}
+	*pImage = d->loadIcon(d->iconSizeOrder[0]);
+	return (*pImage != nullptr ? 0 : -EIO);
+}
+
+/**
+ * Load an internal image with a specific size.
+ * Called by RomData::image() if an image size was requested.
+ * @param imageType	[in] Image type to load.
+ * @param index		[in] Image index, from ImageSizeDef::index. (icon group directory entry)
+ * @param pImage	[out] Pointer to const rp_image* to store the image in.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int EXE::loadInternalImageSize(ImageType imageType, unsigned int index, const rp_image **pImage)
+{
+	ASSERT_loadInternalImage(imageType, pImage);
+	RP_D(EXE);
+	if (imageType != IMG_INT_ICON) {
+		*pImage = nullptr;
+		return -ENOENT;
+	} else if (!d->file) {
+		*pImage = nullptr;
+		return -EBADF;
+	} else if (!d->isValid) {
+		*pImage = nullptr;
+		return -EIO;
+	}
+
+	int ret = d->loadIconDir();
+	if (ret != 0) {
+		*pImage = nullptr;
+		return ret;
+	}
+
+	// Only decode the requested icon.
+	*pImage = d->loadIcon(index);
+	return (*pImage != nullptr ? 0 : -EIO);
+}
+
 /**
  * Check for "viewed" achievements.
  *
@@ -14,6 +14,10 @@
 namespace LibRomData {
 
 ROMDATA_DECL_BEGIN(EXE)
+ROMDATA_DECL_IMGSUPPORT()
+ROMDATA_DECL_IMGPF()
+ROMDATA_DECL_IMGINT()
+ROMDATA_DECL_IMGINT_SIZE()
 ROMDATA_DECL_DANGEROUS()
 ROMDATA_DECL_VIEWED_ACHIEVEMENTS()
 ROMDATA_DECL_END()
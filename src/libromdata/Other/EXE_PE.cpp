@@ -520,7 +520,7 @@ void EXEPrivate::addFields_PE(void)
 		// .NET executable.
 		s_cpu += " (.NET)";
 	}
-	fields->addField_string(C_("EXE", "CPU"), s_cpu);
+	fields->addField_string(C_("EXE", "CPU"), std::move(s_cpu));
 
 	// OS version.
 	fields->addField_string(C_("EXE", "OS Version"),
@@ -638,7 +638,7 @@ void EXEPrivate::addFields_PE(void)
 	int ret = findPERuntimeDLL(runtime_dll, runtime_link);
 	if (ret == 0 && !runtime_dll.empty()) {
 		// TODO: Show the link?
-		fields->addField_string(C_("EXE", "Runtime DLL"), runtime_dll);
+		fields->addField_string(C_("EXE", "Runtime DLL"), std::move(runtime_dll));
 	}
 
 	// Load resources.
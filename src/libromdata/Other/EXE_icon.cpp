@@ -0,0 +1,333 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * EXE_icon.cpp: DOS/Windows executable reader.                            *
+ * Icon resources. (NE and PE)                                             *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "EXE_p.hpp"
+
+// librpbase, librpfile, librptexture
+#include "librpbase/img/RpPng.hpp"
+using namespace LibRpBase;
+using LibRpFile::IRpFile;
+using LibRpTexture::rp_image;
+
+// C++ STL classes.
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData {
+
+/** EXEPrivate **/
+
+/**
+ * Load the icon group directory. (first RT_GROUP_ICON resource)
+ * This only reads the directory; icon images are not decoded.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int EXEPrivate::loadIconDir(void)
+{
+	if (iconDirLoaded) {
+		// Icon group directory is already loaded.
+		return (!iconDir.empty() ? 0 : -ENOENT);
+	} else if (!file || !file->isOpen()) {
+		// File isn't open.
+		return -EBADF;
+	} else if (!isValid) {
+		// Unknown executable type.
+		return -EIO;
+	}
+
+	// Load the resource table.
+	int ret;
+	switch (exeType) {
+		case ExeType::NE:
+			ret = loadNEResourceTable();
+			break;
+		case ExeType::PE:
+		case ExeType::PE32PLUS:
+			ret = loadPEResourceTypes();
+			break;
+		default:
+			// Icons are not supported for this executable type.
+			ret = -ENOENT;
+			break;
+	}
+	if (ret != 0) {
+		return ret;
+	}
+	assert(rsrcReader != nullptr);
+
+	// Don't retry if the directory is missing or invalid.
+	iconDirLoaded = true;
+
+	// Use the first icon group. This is the icon
+	// that Windows Explorer shows for the executable.
+	IRpFile *const f_grp = rsrcReader->open(RT_GROUP_ICON, -1, -1);
+	if (!f_grp) {
+		// No icon group.
+		return -ENOENT;
+	}
+
+	GRPICONDIR grpHdr;
+	size_t size = f_grp->read(&grpHdr, sizeof(grpHdr));
+	if (size != sizeof(grpHdr) ||
+	    grpHdr.idReserved != cpu_to_le16(0) ||
+	    grpHdr.idType != cpu_to_le16(1) ||
+	    grpHdr.idCount == cpu_to_le16(0))
+	{
+		// Not a valid icon group.
+		f_grp->unref();
+		return -EIO;
+	}
+
+	const unsigned int idCount = le16_to_cpu(grpHdr.idCount);
+	iconDir.resize(idCount);
+	const size_t dir_size = idCount * sizeof(GRPICONDIRENTRY);
+	size = f_grp->read(iconDir.data(), dir_size);
+	f_grp->unref();
+	if (size != dir_size) {
+		// Read error.
+		iconDir.clear();
+		return -EIO;
+	}
+
+#if SYS_BYTEORDER == SYS_BIG_ENDIAN
+	for (GRPICONDIRENTRY &entry : iconDir) {
+		entry.wPlanes		= le16_to_cpu(entry.wPlanes);
+		entry.wBitCount		= le16_to_cpu(entry.wBitCount);
+		entry.dwBytesInRes	= le32_to_cpu(entry.dwBytesInRes);
+		entry.nID		= le16_to_cpu(entry.nID);
+	}
+#endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+
+	// Select one entry per icon size, preferring the highest bit depth.
+	// Nothing is decoded here, so selecting a size only costs one
+	// RT_ICON read and decode in loadIcon().
+	for (unsigned int i = 0; i < idCount; i++) {
+		const GRPICONDIRENTRY &entry = iconDir[i];
+		auto iter = std::find_if(iconSizeOrder.begin(), iconSizeOrder.end(),
+			[this, &entry](uint16_t idx) {
+				return (iconDir[idx].bWidth == entry.bWidth &&
+				        iconDir[idx].bHeight == entry.bHeight);
+			});
+		if (iter == iconSizeOrder.end()) {
+			iconSizeOrder.push_back(static_cast<uint16_t>(i));
+		} else if (entry.wBitCount > iconDir[*iter].wBitCount) {
+			*iter = static_cast<uint16_t>(i);
+		}
+	}
+
+	// Largest icon first. (0 == 256)
+	std::stable_sort(iconSizeOrder.begin(), iconSizeOrder.end(),
+		[this](uint16_t a, uint16_t b) {
+			const unsigned int area_a = (iconDir[a].bWidth != 0 ? iconDir[a].bWidth : 256) *
+			                            (iconDir[a].bHeight != 0 ? iconDir[a].bHeight : 256);
+			const unsigned int area_b = (iconDir[b].bWidth != 0 ? iconDir[b].bWidth : 256) *
+			                            (iconDir[b].bHeight != 0 ? iconDir[b].bHeight : 256);
+			return (area_a > area_b);
+		});
+
+	img_icons.resize(idCount);
+	return 0;
+}
+
+/**
+ * Decode a DIB icon image. (BITMAPINFOHEADER, XOR mask, AND mask)
+ * @param buf Icon resource data.
+ * @param size Size of buf.
+ * @return rp_image, or nullptr on error.
+ */
+static rp_image *decodeIconDIB(const uint8_t *buf, size_t size)
+{
+	if (size < sizeof(BITMAPINFOHEADER)) {
+		return nullptr;
+	}
+
+	BITMAPINFOHEADER bih;
+	memcpy(&bih, buf, sizeof(bih));
+	const uint32_t biSize = le32_to_cpu(bih.biSize);
+	const int width = static_cast<int>(le32_to_cpu(bih.biWidth));
+	// Height includes the AND mask.
+	const int height = static_cast<int>(le32_to_cpu(bih.biHeight)) / 2;
+	const unsigned int bpp = le16_to_cpu(bih.biBitCount);
+	if (biSize < sizeof(BITMAPINFOHEADER) || biSize > size ||
+	    width <= 0 || width > 256 || height <= 0 || height > 256 ||
+	    le16_to_cpu(bih.biPlanes) != 1 ||
+	    bih.biCompression != cpu_to_le32(BI_RGB))
+	{
+		// Invalid or unsupported header.
+		return nullptr;
+	}
+
+	// Palette. (RGBQUAD: B, G, R, reserved)
+	unsigned int palSize = 0;
+	switch (bpp) {
+		case 1: case 4: case 8: {
+			palSize = le32_to_cpu(bih.biClrUsed);
+			if (palSize == 0 || palSize > (1U << bpp)) {
+				palSize = (1U << bpp);
+			}
+			break;
+		}
+		case 24: case 32:
+			break;
+		default:
+			// Unsupported bit depth.
+			return nullptr;
+	}
+	const uint8_t *const pal = buf + biSize;
+
+	// Rows are stored bottom-up, and each row is DWORD-aligned.
+	const unsigned int xor_stride = ((width * bpp + 31) / 32) * 4;
+	const unsigned int and_stride = ((width + 31) / 32) * 4;
+	const size_t xor_offset = biSize + (palSize * 4);
+	const size_t and_offset = xor_offset + (xor_stride * height);
+	if (and_offset > size) {
+		// XOR mask is out of range.
+		return nullptr;
+	}
+	// Some 32-bpp icons don't have an AND mask.
+	const bool has_and_mask = (and_offset + (and_stride * height) <= size);
+	if (!has_and_mask && bpp != 32) {
+		return nullptr;
+	}
+	const uint8_t *const xor_mask = buf + xor_offset;
+	const uint8_t *const and_mask = buf + and_offset;
+
+	// If a 32-bpp icon has an all-zero alpha channel,
+	// it's actually opaque and the AND mask is used.
+	bool use_and_mask = true;
+	if (bpp == 32) {
+		for (int y = 0; y < height && use_and_mask; y++) {
+			const uint8_t *src = xor_mask + (y * xor_stride);
+			for (int x = 0; x < width; x++, src += 4) {
+				if (src[3] != 0) {
+					use_and_mask = false;
+					break;
+				}
+			}
+		}
+		if (use_and_mask && !has_and_mask) {
+			return nullptr;
+		}
+	}
+
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		img->unref();
+		return nullptr;
+	}
+
+	for (int y = 0; y < height; y++) {
+		const uint8_t *const src = xor_mask + ((height - 1 - y) * xor_stride);
+		const uint8_t *const msk = and_mask + ((height - 1 - y) * and_stride);
+		uint32_t *const dest = static_cast<uint32_t*>(img->scanLine(y));
+
+		for (int x = 0; x < width; x++) {
+			uint32_t argb;
+			switch (bpp) {
+				default:
+				case 1: case 4: case 8: {
+					// Paletted. Out-of-range indexes are black.
+					const unsigned int shift = 8 - bpp - ((x * bpp) & 7);
+					const unsigned int idx = (src[(x * bpp) / 8] >> shift) & ((1U << bpp) - 1);
+					argb = 0xFF000000U;
+					if (idx < palSize) {
+						const uint8_t *const p = &pal[idx * 4];
+						argb |= (p[2] << 16) | (p[1] << 8) | p[0];
+					}
+					break;
+				}
+				case 24: {
+					const uint8_t *const p = &src[x * 3];
+					argb = 0xFF000000U | (p[2] << 16) | (p[1] << 8) | p[0];
+					break;
+				}
+				case 32: {
+					const uint8_t *const p = &src[x * 4];
+					argb = (p[3] << 24) | (p[2] << 16) | (p[1] << 8) | p[0];
+					if (use_and_mask) {
+						argb |= 0xFF000000U;
+					}
+					break;
+				}
+			}
+
+			// AND mask: set bits are transparent.
+			if (use_and_mask && (msk[x / 8] & (0x80 >> (x & 7)))) {
+				argb = 0;
+			}
+			dest[x] = argb;
+		}
+	}
+
+	return img;
+}
+
+/**
+ * Load an icon from the icon group directory.
+ * Only the selected RT_ICON resource is read and decoded.
+ * @param index Icon group directory entry index.
+ * @return Icon, or nullptr on error.
+ */
+const rp_image *EXEPrivate::loadIcon(unsigned int index)
+{
+	if (index >= iconDir.size()) {
+		// Index is out of range.
+		return nullptr;
+	} else if (img_icons[index]) {
+		// Icon has already been loaded.
+		return img_icons[index];
+	} else if (!file || !file->isOpen() || !rsrcReader) {
+		// File isn't open.
+		return nullptr;
+	}
+
+	IRpFile *const f_icon = rsrcReader->open(RT_ICON, iconDir[index].nID, -1);
+	if (!f_icon) {
+		// Icon resource not found.
+		return nullptr;
+	}
+
+	// Largest valid icon: 256x256 at 32-bpp, plus the AND mask.
+	const off64_t icon_size = f_icon->size();
+	if (icon_size < 8 || icon_size > 1024*1024) {
+		f_icon->unref();
+		return nullptr;
+	}
+
+	// Windows Vista and later can store 256x256 icons as PNG.
+	static const uint8_t png_magic[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	uint8_t magic[8];
+	size_t size = f_icon->read(magic, sizeof(magic));
+	if (size != sizeof(magic)) {
+		f_icon->unref();
+		return nullptr;
+	}
+
+	rp_image *img;
+	if (!memcmp(magic, png_magic, sizeof(png_magic))) {
+		// PNG icon.
+		img = RpPng::load(f_icon);
+	} else {
+		// DIB icon.
+		const size_t buf_size = static_cast<size_t>(icon_size);
+		unique_ptr<uint8_t[]> buf(new uint8_t[buf_size]);
+		memcpy(buf.get(), magic, sizeof(magic));
+		size = f_icon->read(&buf[sizeof(magic)], buf_size - sizeof(magic));
+		img = (size == buf_size - sizeof(magic))
+			? decodeIconDIB(buf.get(), buf_size)
+			: nullptr;
+	}
+	f_icon->unref();
+
+	img_icons[index] = img;
+	return img;
+}
+
+}
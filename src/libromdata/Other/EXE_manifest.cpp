@@ -66,19 +66,14 @@ do { } while (0)
 } while (0)
 
 /**
- * Load the Win32 manifest resource.
- *
- * The XML is loaded and parsed using the specified
- * TinyXML document.
- *
- * NOTE: DelayLoad must be checked by the caller, since it's
- * passing an XMLDocument reference to this function.
- *
- * @param doc		[in/out] XML document.
+ * Load the Win32 manifest resource data.
+ * The XML is not parsed; the data is NULL-terminated.
+ * @param xml		[out] XML data.
+ * @param xml_size	[out] XML data size. (not including the NULL terminator)
  * @param ppResName	[out,opt] Pointer to receive the loaded resource name. (statically-allocated string)
  * @return 0 on success; negative POSIX error code on error.
  */
-int EXEPrivate::loadWin32ManifestResource(XMLDocument &doc, const char **ppResName) const
+int EXEPrivate::loadWin32ManifestData(unique_ptr<char[]> &xml, size_t &xml_size, const char **ppResName) const
 {
 	// Make sure the resource directory is loaded.
 	int ret = const_cast<EXEPrivate*>(this)->loadPEResourceTypes();
@@ -117,21 +112,52 @@ int EXEPrivate::loadWin32ManifestResource(XMLDocument &doc, const char **ppResNa
 
 	// Read the entire resource into memory.
 	// Assuming a limit of 64 KB for manifests.
-	const size_t xml_size = static_cast<size_t>(f_manifest->size());
-	if (xml_size > 65536) {
+	const size_t size_total = static_cast<size_t>(f_manifest->size());
+	if (size_total > 65536) {
 		// Manifest is too big.
 		// (Or, it's negative, and wraps around due to unsigned.)
 		f_manifest->unref();
 		return -ENOMEM;
 	}
-	unique_ptr<char[]> xml(new char[xml_size+1]);
-	size_t size = f_manifest->read(xml.get(), xml_size);
+	xml.reset(new char[size_total+1]);
+	size_t size = f_manifest->read(xml.get(), size_total);
 	f_manifest->unref();
-	if (size != xml_size) {
+	if (size != size_total) {
 		// Read error.
+		xml.reset();
 		return -EIO;
 	}
-	xml[xml_size] = 0;
+	xml[size_total] = 0;
+	xml_size = size_total;
+
+	if (ppResName) {
+		*ppResName = resource_ids[id_idx].name;
+	}
+	return 0;
+}
+
+/**
+ * Load the Win32 manifest resource.
+ *
+ * The XML is loaded and parsed using the specified
+ * TinyXML document.
+ *
+ * NOTE: DelayLoad must be checked by the caller, since it's
+ * passing an XMLDocument reference to this function.
+ *
+ * @param doc		[in/out] XML document.
+ * @param ppResName	[out,opt] Pointer to receive the loaded resource name. (statically-allocated string)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int EXEPrivate::loadWin32ManifestResource(XMLDocument &doc, const char **ppResName) const
+{
+	unique_ptr<char[]> xml;
+	size_t xml_size = 0;
+	const char *pResName = nullptr;
+	int ret = loadWin32ManifestData(xml, xml_size, &pResName);
+	if (ret != 0) {
+		return ret;
+	}
 
 	// Parse the XML.
 	// FIXME: TinyXML2 2.0.0 added XMLDocument::Clear().
@@ -183,7 +209,7 @@ int EXEPrivate::loadWin32ManifestResource(XMLDocument &doc, const char **ppResNa
 
 	// XML document loaded.
 	if (ppResName) {
-		*ppResName = resource_ids[id_idx].name;
+		*ppResName = pResName;
 	}
 	return 0;
 }
@@ -405,53 +431,278 @@ int EXEPrivate::addFields_PE_Manifest(void)
 	return 0;
 }
 
+/** Manifest scanner **/
+
+/**
+ * Minimal non-DOM XML tag scanner for Win32 manifests.
+ *
+ * This only tokenizes start and end tags and reads attributes.
+ * Text content, entities, and namespaces aren't processed.
+ * It's used to check a few attributes without building the
+ * full TinyXML2 DOM, e.g. for the overlay icon check.
+ */
+class ManifestScanner
+{
+	public:
+		ManifestScanner(const char *xml, size_t xml_size)
+			: p(xml)
+			, p_end(xml + xml_size)
+		{ }
+
+	public:
+		struct Tag {
+			const char *name;	// Element name (not NULL-terminated)
+			size_t name_len;	// Element name length
+			const char *attrs;	// Attributes (not NULL-terminated)
+			size_t attrs_len;	// Attributes length
+			bool isEnd;		// True for an end tag, e.g. </assembly>
+			bool isEmpty;		// True for an empty-element tag, e.g. <assembly/>
+		};
+
+		/**
+		 * Get the next start or end tag.
+		 * Comments, processing instructions, CDATA, and DOCTYPE are skipped.
+		 * @param tag [out] Tag
+		 * @return 1 if a tag was found; 0 at the end of the document; negative POSIX error code on error.
+		 */
+		int nextTag(Tag &tag)
+		{
+			for (;;) {
+				// Find the next '<'.
+				p = static_cast<const char*>(memchr(p, '<', p_end - p));
+				if (!p) {
+					// End of document.
+					p = p_end;
+					return 0;
+				}
+				p++;
+
+				// Skip comments, processing instructions, CDATA, and DOCTYPE.
+				if (p < p_end && (*p == '!' || *p == '?')) {
+					const char *term;
+					if (p_end - p >= 3 && !memcmp(p, "!--", 3)) {
+						term = "-->";
+					} else if (p_end - p >= 8 && !memcmp(p, "![CDATA[", 8)) {
+						term = "]]>";
+					} else if (*p == '?') {
+						term = "?>";
+					} else {
+						term = ">";
+					}
+					if (!skipPast(term)) {
+						return -EIO;
+					}
+					continue;
+				}
+
+				// Start or end tag.
+				tag.isEnd = (p < p_end && *p == '/');
+				if (tag.isEnd) {
+					p++;
+				}
+				tag.name = p;
+				while (p < p_end && !ISSPACE(*p) && *p != '>' && *p != '/') {
+					p++;
+				}
+				tag.name_len = p - tag.name;
+				if (tag.name_len == 0) {
+					return -EIO;
+				}
+
+				// Find the end of the tag, skipping quoted attribute values.
+				tag.attrs = p;
+				char quote = 0;
+				for (; p < p_end; p++) {
+					if (quote) {
+						if (*p == quote)
+							quote = 0;
+					} else if (*p == '"' || *p == '\'') {
+						quote = *p;
+					} else if (*p == '>') {
+						break;
+					}
+				}
+				if (p >= p_end) {
+					// Unterminated tag.
+					return -EIO;
+				}
+				tag.attrs_len = p - tag.attrs;
+				tag.isEmpty = (tag.attrs_len > 0 && tag.attrs[tag.attrs_len-1] == '/');
+				if (tag.isEmpty) {
+					tag.attrs_len--;
+				}
+				p++;
+				return 1;
+			}
+		}
+
+		/**
+		 * Check if a tag name matches, with or without a namespace prefix.
+		 * @param tag Tag
+		 * @param name Element name
+		 * @param ns Namespace prefix (or nullptr for none)
+		 * @return True if the name matches.
+		 */
+		static bool nameIs(const Tag &tag, const char *name, const char *ns)
+		{
+			const size_t len = strlen(name);
+			if (tag.name_len == len && !memcmp(tag.name, name, len))
+				return true;
+			if (!ns)
+				return false;
+
+			const size_t ns_len = strlen(ns);
+			return (tag.name_len == ns_len + 1 + len &&
+			        !memcmp(tag.name, ns, ns_len) &&
+			        tag.name[ns_len] == ':' &&
+			        !memcmp(&tag.name[ns_len + 1], name, len));
+		}
+
+		/**
+		 * Get an attribute value from a tag.
+		 * Entities are not decoded.
+		 * @param tag Tag
+		 * @param name Attribute name
+		 * @return Attribute value, or empty string if not found.
+		 */
+		static string attribute(const Tag &tag, const char *name)
+		{
+			const size_t len = strlen(name);
+			const char *a = tag.attrs;
+			const char *const a_end = tag.attrs + tag.attrs_len;
+			while (a < a_end) {
+				// Attribute name
+				while (a < a_end && ISSPACE(*a))
+					a++;
+				const char *const a_name = a;
+				while (a < a_end && *a != '=' && !ISSPACE(*a))
+					a++;
+				const size_t a_name_len = a - a_name;
+				while (a < a_end && ISSPACE(*a))
+					a++;
+				if (a >= a_end || *a != '=')
+					break;
+				a++;
+				while (a < a_end && ISSPACE(*a))
+					a++;
+				if (a >= a_end || (*a != '"' && *a != '\''))
+					break;
+
+				// Attribute value
+				const char quote = *a++;
+				const char *const a_value = a;
+				while (a < a_end && *a != quote)
+					a++;
+				if (a >= a_end)
+					break;
+				if (a_name_len == len && !memcmp(a_name, name, len)) {
+					return string(a_value, a - a_value);
+				}
+				a++;
+			}
+			return string();
+		}
+
+	private:
+		/**
+		 * Skip past a terminator string.
+		 * @param term Terminator
+		 * @return True if found; false if not.
+		 */
+		bool skipPast(const char *term)
+		{
+			const size_t term_len = strlen(term);
+			for (; p_end - p >= static_cast<ptrdiff_t>(term_len); p++) {
+				if (!memcmp(p, term, term_len)) {
+					p += term_len;
+					return true;
+				}
+			}
+			return false;
+		}
+
+	private:
+		const char *p;
+		const char *const p_end;
+};
+
 /**
  * Is the requestedExecutionLevel set to requireAdministrator?
+ *
+ * This is called for the overlay icon, so it uses ManifestScanner
+ * instead of parsing the manifest into a TinyXML2 DOM.
+ *
  * @return True if set; false if not or unable to determine.
  */
 bool EXEPrivate::doesExeRequireAdministrator(void) const
 {
-#if defined(_MSC_VER) && defined(XML_IS_DLL)
-	// Delay load verification.
-	// TODO: Only if linked with /DELAYLOAD?
-	int ret_dl = DelayLoad_test_TinyXML2();
-	if (ret_dl != 0) {
-		// Delay load failed.
-		return false;
-	}
-#endif /* defined(_MSC_VER) && defined(XML_IS_DLL) */
-
-	XMLDocument doc;
-	if (loadWin32ManifestResource(doc) != 0) {
+	unique_ptr<char[]> xml;
+	size_t xml_size = 0;
+	if (loadWin32ManifestData(xml, xml_size) != 0) {
 		// No Win32 manifest resource.
 		return false;
 	}
 
-	// Assembly element.
-	const XMLElement *const assembly = doc.FirstChildElement("assembly");
-	if (!assembly) {
-		// No assembly element.
-		return false;
-	}
+	// Element path to requestedExecutionLevel.
+	// NOTE: Element names may have namespace prefixes.
+	static const struct {
+		const char *name;
+		const char *ns;
+	} path[] = {
+		{"assembly", nullptr},
+		{"trustInfo", "asmv2"},
+		{"security", "asmv2"},
+		{"requestedPrivileges", "asmv2"},
+		{"requestedExecutionLevel", "asmv2"},
+	};
 
-	// Trust info.
-	FIRST_CHILD_ELEMENT_NS(trustInfo, assembly, "trustInfo", "asmv2");
-	if (!trustInfo)
-		return false;
-	FIRST_CHILD_ELEMENT_NS(security, trustInfo, "security", "asmv2");
-	if (!security)
-		return false;
-	FIRST_CHILD_ELEMENT_NS(requestedPrivileges, security, "requestedPrivileges", "asmv2");
-	if (!requestedPrivileges)
-		return false;
-	FIRST_CHILD_ELEMENT_NS(requestedExecutionLevel, requestedPrivileges, "requestedExecutionLevel", "asmv2");
-	if (!requestedExecutionLevel)
-		return false;
+	ManifestScanner scanner(xml.get(), xml_size);
+	ManifestScanner::Tag tag;
+	unsigned int depth = 0;		// Current element depth
+	unsigned int matched = 0;	// Number of path elements matched
+	while (scanner.nextTag(tag) > 0) {
+		if (tag.isEnd) {
+			// End tag.
+			if (depth == 0)
+				return false;
+			depth--;
+			if (matched > depth) {
+				matched = depth;
+			}
+			if (depth == 0) {
+				// End of the root element.
+				break;
+			}
+			continue;
+		}
 
-	const char *const attr = requestedExecutionLevel->Attribute("level");
-	if (!attr)
-		return false;
-	return (!strcasecmp(attr, "requireAdministrator"));
+		if (depth == matched && ManifestScanner::nameIs(tag, path[matched].name, path[matched].ns)) {
+			if (matched == 0) {
+				// Root element must be assembly with the correct attributes.
+				// (See loadWin32ManifestResource().)
+				if (ManifestScanner::attribute(tag, "xmlns") != "urn:schemas-microsoft-com:asm.v1" ||
+				    ManifestScanner::attribute(tag, "manifestVersion") != "1.0")
+				{
+					return false;
+				}
+			} else if (matched == ARRAY_SIZE(path) - 1) {
+				// Found requestedExecutionLevel.
+				const string level = ManifestScanner::attribute(tag, "level");
+				return (!strcasecmp(level.c_str(), "requireAdministrator"));
+			}
+			matched++;
+		} else if (depth == 0) {
+			// Root element is not assembly.
+			return false;
+		}
+
+		if (!tag.isEmpty) {
+			depth++;
+		}
+	}
+
+	// requestedExecutionLevel not found.
+	return false;
 }
 
 }
@@ -177,8 +177,48 @@ class EXEPrivate final : public LibRpBase::RomDataPrivate
 		 */
 		void addFields_PE(void);
 
+		/** Icons (NE and PE) **/
+
+		// Icon group directory entries. (RT_GROUP_ICON)
+		ao::uvector<GRPICONDIRENTRY> iconDir;
+		// Entry indexes for supportedImageSizes(), one per size.
+		// Largest first; for duplicate sizes, the highest bit depth is used.
+		std::vector<uint16_t> iconSizeOrder;
+		bool iconDirLoaded;
+
+		// Decoded icons, indexed by icon group directory entry.
+		// Only icons that were actually requested are decoded.
+		std::vector<LibRpTexture::rp_image*> img_icons;
+
+		/**
+		 * Load the icon group directory. (first RT_GROUP_ICON resource)
+		 * This only reads the directory; icon images are not decoded.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadIconDir(void);
+
+		/**
+		 * Load an icon from the icon group directory.
+		 * Only the selected RT_ICON resource is read and decoded.
+		 * @param index Icon group directory entry index.
+		 * @return Icon, or nullptr on error.
+		 */
+		const LibRpTexture::rp_image *loadIcon(unsigned int index);
+
 #ifdef ENABLE_XML
 	private:
+		/**
+		 * Load the Win32 manifest resource data.
+		 * The XML is not parsed; the data is NULL-terminated.
+		 * @param xml		[out] XML data.
+		 * @param xml_size	[out] XML data size. (not including the NULL terminator)
+		 * @param ppResName	[out,opt] Pointer to receive the loaded resource name. (statically-allocated string)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		ATTR_ACCESS(write_only, 4)
+		int loadWin32ManifestData(std::unique_ptr<char[]> &xml, size_t &xml_size,
+			const char **ppResName = nullptr) const;
+
 		/**
 		 * Load the Win32 manifest resource.
 		 *
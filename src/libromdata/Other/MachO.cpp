@@ -188,9 +188,12 @@ MachO::MachO(IRpFile *file)
 				reinterpret_cast<const fat_header*>(info.header.pData);
 			const unsigned int nfat_arch = std::min<uint32_t>(
 				MAX_MACH_HEADERS, be32_to_cpu(fatHeader->nfat_arch));
-			d->machFormats.reserve(nfat_arch);
-			d->machHeaders.reserve(nfat_arch);
 
+			// Read all of the Mach-O headers in a single batch.
+			// Architectures with invalid offsets are skipped.
+			ao::uvector<mach_header> fatHeaders(nfat_arch);
+			IRpFile::ReadRequest reqs[MAX_MACH_HEADERS];
+			unsigned int reqCount = 0;
 			const fat_arch *fatArch =
 				reinterpret_cast<const fat_arch*>(info.header.pData + 8);
 			for (unsigned int i = 0; i < nfat_arch; i++, fatArch++) {
@@ -199,18 +202,31 @@ MachO::MachO(IRpFile *file)
 					continue;
 				}
 
-				size_t idx = d->machFormats.size();
-				d->machFormats.resize(idx+1);
-				d->machHeaders.resize(idx+1);
-				size_t size = d->file->seekAndRead(offset, &d->machHeaders[i], sizeof(mach_header));
-				if (size == sizeof(mach_header)) {
-					d->machFormats[idx] = d->checkMachMagicNumber(d->machHeaders[idx].magic);
-				} else {
-					// Unable to read this header.
-					// TODO: Show an error?
-					d->machFormats.resize(idx);
-					d->machHeaders.resize(idx);
+				IRpFile::ReadRequest &req = reqs[reqCount];
+				req.pos = offset;
+				req.ptr = &fatHeaders[reqCount];
+				req.size = sizeof(mach_header);
+				reqCount++;
+			}
+
+			// NOTE: readBatch() stops at the first request that
+			// can't be read in full, so read the rest individually.
+			unsigned int reqsRead = static_cast<unsigned int>(
+				d->file->readBatch(reqs, reqCount));
+			d->machFormats.reserve(reqCount);
+			d->machHeaders.reserve(reqCount);
+			for (unsigned int i = 0; i < reqCount; i++) {
+				if (i >= reqsRead) {
+					size_t size = d->file->seekAndRead(reqs[i].pos, reqs[i].ptr, reqs[i].size);
+					if (size != reqs[i].size) {
+						// Unable to read this header.
+						// TODO: Show an error?
+						continue;
+					}
 				}
+
+				d->machHeaders.push_back(fatHeaders[i]);
+				d->machFormats.push_back(d->checkMachMagicNumber(fatHeaders[i].magic));
 			}
 
 			d->isValid = !d->machFormats.empty();
@@ -251,7 +251,18 @@ const rp_image *NintendoBadgePrivate::loadImage(int idx)
 		}
 
 		// Convert to rp_image.
-		if (badge_a4_sz > 0) {
+		if (badgeType == BadgeType::CABS) {
+			// Only decode the top-left 48x48 region of the 64x64 image.
+			// N3DS tiled images use 8x8 tiles. (RGB565: 128 bytes per tile)
+			img = ImageDecoder::fromTiled_region(
+				[](int width, int height, const uint8_t *img_buf, int img_siz) {
+					return ImageDecoder::fromN3DSTiledRGB565(width, height,
+						reinterpret_cast<const uint16_t*>(img_buf), img_siz);
+				}, 8, 8, 8*8*2,
+				badge_dims, badge_dims,
+				badgeData.get(), badge_rgb_sz,
+				0, 0, 48, 48);
+		} else if (badge_a4_sz > 0) {
 			img = ImageDecoder::fromN3DSTiledRGB565_A4(
 				badge_dims, badge_dims,
 				reinterpret_cast<const uint16_t*>(badgeData.get()), badge_rgb_sz,
@@ -261,13 +272,6 @@ const rp_image *NintendoBadgePrivate::loadImage(int idx)
 				badge_dims, badge_dims,
 				reinterpret_cast<const uint16_t*>(badgeData.get()), badge_rgb_sz);
 		}
-
-		if (badgeType == BadgeType::CABS) {
-			// Need to crop the 64x64 image to 48x48.
-			rp_image *const img48 = img->resized(48, 48);
-			img->unref();
-			img = img48;
-		}
 	} else {
 		// Mega badge. Need to convert each 64x64 badge
 		// and concatenate them manually.
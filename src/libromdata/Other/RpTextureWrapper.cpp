@@ -41,6 +41,10 @@ class RpTextureWrapperPrivate final : public RomDataPrivate
 	public:
 		// librptexture file format object.
 		FileFormat *texture;
+
+		// ImageSizeDef index for the embedded preview image.
+		// (Other indexes are mipmap levels.)
+		static const uint16_t PREVIEW_IMAGE_INDEX = 0xFFFF;
 };
 
 /** RpTextureWrapperPrivate **/
@@ -133,9 +137,10 @@ int RpTextureWrapper::isRomSupported_static(const DetectInfo *info)
 		return -1;
 	}
 
-	// TODO: FileFormatFactory::isTextureSupported()
-	// For now, delegate to FileFormatFactory::create().
-	return 0;
+	// Check the magic number and header heuristics.
+	// FileFormatFactory::create() will do the full check.
+	return (FileFormatFactory::isTextureSupported(
+		info->header.pData, info->header.size, info->ext) ? 0 : -1);
 }
 
 /**
@@ -215,13 +220,48 @@ vector<RomData::ImageSizeDef> RpTextureWrapper::supportedImageSizes(ImageType im
 		return vector<ImageSizeDef>();
 	}
 
-	// Return the image's size.
-	const ImageSizeDef imgsz[] = {{nullptr,
-		static_cast<uint16_t>(d->texture->width()),
-		static_cast<uint16_t>(d->texture->height()),
-		0
-	}};
-	return vector<ImageSizeDef>(imgsz, imgsz + 1);
+	// Return the image's size, plus the size of each mipmap level.
+	// The full image (mipmap 0) is the default size.
+	// NOTE: Height might be 0 for 1D textures.
+	const int width = d->texture->width();
+	const int height = d->texture->height();
+	int mipmapCount = d->texture->mipmapCount();
+	if (mipmapCount < 1) {
+		// No mipmaps == one image.
+		mipmapCount = 1;
+	}
+
+	vector<ImageSizeDef> sizeDefs;
+	sizeDefs.reserve(mipmapCount + 1);
+	for (int mip = 0; mip < mipmapCount; mip++) {
+		const int mip_width = std::max(width >> mip, 1);
+		const int mip_height = (height > 0 ? std::max(height >> mip, 1) : 0);
+		const ImageSizeDef imgsz = {nullptr,
+			static_cast<uint16_t>(mip_width),
+			static_cast<uint16_t>(mip_height),
+			static_cast<uint16_t>(mip)
+		};
+		sizeDefs.emplace_back(imgsz);
+
+		if (mip_width == 1 && mip_height <= 1) {
+			// Smallest possible mipmap.
+			// The mipmap count might be incorrect.
+			break;
+		}
+	}
+
+	// Embedded preview image, e.g. the VTF low-resolution image.
+	// This is listed last, so a mipmap of the same size is preferred.
+	int pdims[2];
+	if (d->texture->getPreviewDimensions(pdims) == 0) {
+		const ImageSizeDef imgsz = {nullptr,
+			static_cast<uint16_t>(pdims[0]),
+			static_cast<uint16_t>(pdims[1]),
+			RpTextureWrapperPrivate::PREVIEW_IMAGE_INDEX
+		};
+		sizeDefs.emplace_back(imgsz);
+	}
+	return sizeDefs;
 }
 
 /**
@@ -361,4 +401,39 @@ int RpTextureWrapper::loadInternalImage(ImageType imageType, const rp_image **pI
 		d->texture->image);	// func
 }
 
+/**
+ * Load an internal image with a specific size.
+ * Called by RomData::image() if an image size was requested.
+ * @param imageType	[in] Image type to load.
+ * @param index		[in] Image index, from ImageSizeDef::index. (mipmap level, or PREVIEW_IMAGE_INDEX)
+ * @param pImage	[out] Pointer to const rp_image* to store the image in.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpTextureWrapper::loadInternalImageSize(ImageType imageType, unsigned int index, const rp_image **pImage)
+{
+	ASSERT_loadInternalImage(imageType, pImage);
+	RP_D(RpTextureWrapper);
+	if (imageType != IMG_INT_IMAGE) {
+		*pImage = nullptr;
+		return -ENOENT;
+	} else if (!d->file) {
+		*pImage = nullptr;
+		return -EBADF;
+	} else if (!d->isValid) {
+		*pImage = nullptr;
+		return -EIO;
+	}
+
+	if (index == RpTextureWrapperPrivate::PREVIEW_IMAGE_INDEX) {
+		// Embedded preview image.
+		*pImage = d->texture->previewImage();
+		return (*pImage != nullptr ? 0 : -EIO);
+	}
+
+	// Only decode the requested mipmap level.
+	// NOTE: Some formats can only decode mipmap 0.
+	*pImage = d->texture->mipmap(static_cast<int>(index));
+	return (*pImage != nullptr ? 0 : -EIO);
+}
+
 }
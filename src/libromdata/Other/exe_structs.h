@@ -517,6 +517,77 @@ typedef enum {
 	XP_VISUAL_STYLE_MANIFEST_RESOURCE_ID = 123,
 } PE_ManifestID;
 
+/** Icon resources. (Shared by NE and PE) **/
+// References:
+// - https://devblogs.microsoft.com/oldnewthing/20120720-00/?p=7083
+// - https://docs.microsoft.com/en-us/windows/win32/menurc/newheader
+
+/**
+ * Icon group directory header. (RT_GROUP_ICON)
+ * Followed by idCount GRPICONDIRENTRY structs.
+ *
+ * All fields are in little-endian.
+ */
+typedef struct _GRPICONDIR {
+	uint16_t idReserved;	// [0x000] Must be 0
+	uint16_t idType;	// [0x002] 1 == icon; 2 == cursor
+	uint16_t idCount;	// [0x004] Number of entries
+} GRPICONDIR;
+ASSERT_STRUCT(GRPICONDIR, 3*sizeof(uint16_t));
+
+/**
+ * Icon group directory entry. (RT_GROUP_ICON)
+ *
+ * All fields are in little-endian.
+ */
+#pragma pack(2)
+typedef struct PACKED _GRPICONDIRENTRY {
+	uint8_t bWidth;		// [0x000] Width (0 == 256)
+	uint8_t bHeight;	// [0x001] Height (0 == 256)
+	uint8_t bColorCount;	// [0x002] Palette size (0 if >= 8bpp)
+	uint8_t bReserved;	// [0x003]
+	uint16_t wPlanes;	// [0x004] Color planes
+	uint16_t wBitCount;	// [0x006] Bits per pixel
+	uint32_t dwBytesInRes;	// [0x008] Size of the RT_ICON resource
+	uint16_t nID;		// [0x00C] RT_ICON resource ID
+} GRPICONDIRENTRY;
+ASSERT_STRUCT(GRPICONDIRENTRY, 14);
+#pragma pack()
+
+/**
+ * Icon image header. (RT_ICON)
+ * The height is doubled, since it includes the AND mask.
+ * (Some icons are stored as PNG images instead.)
+ *
+ * All fields are in little-endian.
+ */
+typedef struct _BITMAPINFOHEADER {
+	uint32_t biSize;		// [0x000] sizeof(BITMAPINFOHEADER)
+	int32_t biWidth;		// [0x004]
+	int32_t biHeight;		// [0x008]
+	uint16_t biPlanes;		// [0x00C]
+	uint16_t biBitCount;		// [0x00E]
+	uint32_t biCompression;		// [0x010] See BitmapCompression_e
+	uint32_t biSizeImage;		// [0x014]
+	int32_t biXPelsPerMeter;	// [0x018]
+	int32_t biYPelsPerMeter;	// [0x01C]
+	uint32_t biClrUsed;		// [0x020]
+	uint32_t biClrImportant;	// [0x024]
+} BITMAPINFOHEADER;
+ASSERT_STRUCT(BITMAPINFOHEADER, 40);
+
+/**
+ * Bitmap compression.
+ */
+typedef enum {
+	BI_RGB		= 0,
+	BI_RLE8		= 1,
+	BI_RLE4		= 2,
+	BI_BITFIELDS	= 3,
+	BI_JPEG		= 4,
+	BI_PNG		= 5,
+} BitmapCompression_e;
+
 /** New Executable (Win16) structs. **/
 // References:
 // - http://wiki.osdev.org/NE
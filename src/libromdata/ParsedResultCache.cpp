@@ -0,0 +1,250 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * ParsedResultCache.cpp: Persistent cache of parsed RomData results.      *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.version.h"
+#include "ParsedResultCache.hpp"
+#include "CachedRomData.hpp"
+
+// librpbase, librpfile
+#include "librpbase/config/Config.hpp"
+using LibRpBase::Config;
+using LibRpBase::RomData;
+using namespace LibRpFile;
+using LibRpFile::FileSystem::FileIdentity;
+
+// libcachecommon
+#include "libcachecommon/CacheDir.hpp"
+
+// C++ STL classes.
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData {
+
+namespace ParsedResultCachePrivate {
+
+// Cache entry header.
+// The header is followed by the filename (UTF-8, not NULL-terminated)
+// and the serialized CachedRomData.
+// NOTE: The header is stored in host byte order, since
+// the cache is only used on the local system.
+static const char CACHE_MAGIC[8] = {'R','P','P','A','R','S','E','1'};
+struct CacheHeader {
+	char magic[8];		// CACHE_MAGIC
+	char version[24];	// RP_VERSION_STRING, NULL-padded
+	uint64_t device;
+	uint64_t inode;
+	int64_t size;
+	int64_t mtime_ns;
+	uint32_t attrs;
+	uint32_t filename_len;
+	uint32_t data_len;
+	uint32_t reserved;
+};
+ASSERT_STRUCT(CacheHeader, 80);
+
+// Maximum size of a cache entry's serialized data.
+static const uint32_t MAX_DATA_LEN = 16U*1024*1024;
+
+/**
+ * Initialize a cache header.
+ * @param header	[out] Cache header
+ * @param id		[in] File identity
+ * @param filename_len	[in] Filename length
+ * @param attrs		[in] RomDataAttr bitfield
+ */
+static void initHeader(CacheHeader &header, const FileIdentity &id, size_t filename_len, unsigned int attrs)
+{
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+	strncpy(header.version, RP_VERSION_STRING, sizeof(header.version)-1);
+	header.device = id.device;
+	header.inode = id.inode;
+	header.size = id.size;
+	header.mtime_ns = id.mtime_ns;
+	header.attrs = attrs;
+	header.filename_len = static_cast<uint32_t>(filename_len);
+}
+
+/**
+ * Get the cache entry filename for a file.
+ *
+ * Entries are named using a hash of the filename and attributes,
+ * so a modified file replaces its previous entry instead of
+ * adding a new one.
+ *
+ * @param filename Filename (UTF-8)
+ * @param attrs RomDataAttr bitfield
+ * @return Cache entry filename, or empty string on error.
+ */
+static string getEntryFilename(const char *filename, unsigned int attrs)
+{
+	const string &cache_dir = LibCacheCommon::getCacheDirectory();
+	if (cache_dir.empty())
+		return string();
+
+	// FNV-1a over the filename and attributes.
+	uint64_t h = 14695981039346656037ULL;
+	for (const char *p = filename; *p != '\0'; p++) {
+		h ^= static_cast<uint8_t>(*p);
+		h *= 1099511628211ULL;
+	}
+	h ^= attrs;
+	h *= 1099511628211ULL;
+
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%08x%08x.bin",
+		static_cast<uint32_t>(h >> 32), static_cast<uint32_t>(h));
+
+	string entry_filename = cache_dir;
+#ifdef _WIN32
+	entry_filename += "\\parsed\\";
+#else /* !_WIN32 */
+	entry_filename += "/parsed/";
+#endif /* _WIN32 */
+	entry_filename += buf;
+	return entry_filename;
+}
+
+}
+
+/**
+ * Is the parsed-result cache enabled in the configuration?
+ * @return True if enabled; false if not.
+ */
+bool ParsedResultCache::isEnabled(void)
+{
+	return Config::instance()->parsedResultCache();
+}
+
+/**
+ * Look up a parsed result.
+ * @param id File identity
+ * @param filename Filename (UTF-8)
+ * @param attrs RomDataAttr bitfield
+ * @return CachedRomData object, or nullptr if not found.
+ */
+RomData *ParsedResultCache::lookup(const FileIdentity &id, const char *filename, unsigned int attrs)
+{
+	using namespace ParsedResultCachePrivate;
+	assert(filename != nullptr);
+	if (!filename || filename[0] == '\0')
+		return nullptr;
+
+	const string entry_filename = getEntryFilename(filename, attrs);
+	if (entry_filename.empty())
+		return nullptr;
+
+	RpFile *const file = new RpFile(entry_filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		// No cache entry.
+		file->unref();
+		return nullptr;
+	}
+
+	// Verify the header. The entry is replaced on the next store()
+	// if the file was modified or rom-properties was upgraded.
+	const size_t filename_len = strlen(filename);
+	CacheHeader header, header_expected;
+	initHeader(header_expected, id, filename_len, attrs);
+	size_t size = file->read(&header, sizeof(header));
+	header_expected.data_len = header.data_len;
+	if (size != sizeof(header) || memcmp(&header, &header_expected, sizeof(header)) != 0 ||
+	    header.data_len == 0 || header.data_len > MAX_DATA_LEN ||
+	    file->size() != static_cast<off64_t>(sizeof(header) + filename_len + header.data_len))
+	{
+		// Incorrect header, or a partially-written entry.
+		file->unref();
+		return nullptr;
+	}
+
+	// Verify the filename, in case of a hash collision.
+	unique_ptr<char[]> entry_fn(new char[filename_len]);
+	size = file->read(entry_fn.get(), filename_len);
+	if (size != filename_len || memcmp(entry_fn.get(), filename, filename_len) != 0) {
+		file->unref();
+		return nullptr;
+	}
+
+	unique_ptr<uint8_t[]> data(new uint8_t[header.data_len]);
+	size = file->read(data.get(), header.data_len);
+	file->unref();
+	if (size != header.data_len) {
+		// Read error.
+		return nullptr;
+	}
+
+	return CachedRomData::deserialize(filename, data.get(), header.data_len);
+}
+
+/**
+ * Store a parsed result.
+ *
+ * The RomData object's fields, metadata, and internal images
+ * are loaded if they haven't been loaded yet, so its file
+ * must be open. RomData objects that can't be cached, e.g.
+ * ones with animated icons or large images, are skipped.
+ *
+ * @param id File identity
+ * @param filename Filename (UTF-8)
+ * @param attrs RomDataAttr bitfield
+ * @param romData RomData object
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ParsedResultCache::store(const FileIdentity &id, const char *filename, unsigned int attrs,
+	const RomData *romData)
+{
+	using namespace ParsedResultCachePrivate;
+	assert(filename != nullptr);
+	assert(romData != nullptr);
+	if (!filename || filename[0] == '\0' || !romData)
+		return -EINVAL;
+
+	const string entry_filename = getEntryFilename(filename, attrs);
+	if (entry_filename.empty())
+		return -ENOENT;
+
+	vector<uint8_t> data;
+	int ret = CachedRomData::serialize(romData, data);
+	if (ret != 0) {
+		return ret;
+	} else if (data.empty() || data.size() > MAX_DATA_LEN) {
+		return -ENOTSUP;
+	}
+
+	if (FileSystem::rmkdir(entry_filename) != 0)
+		return -EIO;
+
+	RpFile *const file = new RpFile(entry_filename, RpFile::FM_CREATE_WRITE);
+	if (!file->isOpen()) {
+		const int err = -file->lastError();
+		file->unref();
+		return (err != 0 ? err : -EIO);
+	}
+
+	const size_t filename_len = strlen(filename);
+	CacheHeader header;
+	initHeader(header, id, filename_len, attrs);
+	header.data_len = static_cast<uint32_t>(data.size());
+
+	size_t size = file->write(&header, sizeof(header));
+	size += file->write(filename, filename_len);
+	size += file->write(data.data(), data.size());
+	file->unref();
+
+	if (size != sizeof(header) + filename_len + data.size()) {
+		// Write error. Delete the partial entry.
+		FileSystem::delete_file(entry_filename);
+		return -EIO;
+	}
+	return 0;
+}
+
+}
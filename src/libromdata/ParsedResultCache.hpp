@@ -0,0 +1,84 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * ParsedResultCache.hpp: Persistent cache of parsed RomData results.      *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_PARSEDRESULTCACHE_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_PARSEDRESULTCACHE_HPP__
+
+#include "common.h"
+#include "librpfile/FileSystem.hpp"
+
+namespace LibRpBase {
+	class RomData;
+}
+
+namespace LibRomData {
+
+/**
+ * Persistent cache of parsed RomData results.
+ *
+ * The fields, metadata, and small internal images of a RomData
+ * object are serialized to the "parsed" subdirectory of the
+ * rom-properties cache directory, with one entry per filename
+ * and RomDataAttr bitfield. Cached entries are returned as
+ * CachedRomData objects, so the original file doesn't have to
+ * be opened or parsed again.
+ *
+ * Each entry stores the file's identity (device, inode, size,
+ * and mtime) and the rom-properties version, so modifying the
+ * file or upgrading rom-properties invalidates the entry.
+ *
+ * This cache is disabled by default; it's enabled by the
+ * "ParsedResultCache" option in rom-properties.conf.
+ */
+class ParsedResultCache
+{
+	private:
+		ParsedResultCache();
+		~ParsedResultCache();
+	private:
+		RP_DISABLE_COPY(ParsedResultCache)
+
+	public:
+		/**
+		 * Is the parsed-result cache enabled in the configuration?
+		 * @return True if enabled; false if not.
+		 */
+		static bool isEnabled(void);
+
+		/**
+		 * Look up a parsed result.
+		 * @param id File identity
+		 * @param filename Filename (UTF-8)
+		 * @param attrs RomDataAttr bitfield
+		 * @return CachedRomData object, or nullptr if not found.
+		 */
+		static LibRpBase::RomData *lookup(const LibRpFile::FileSystem::FileIdentity &id,
+			const char *filename, unsigned int attrs);
+
+		/**
+		 * Store a parsed result.
+		 *
+		 * The RomData object's fields, metadata, and internal images
+		 * are loaded if they haven't been loaded yet, so its file
+		 * must be open. RomData objects that can't be cached, e.g.
+		 * ones with animated icons or large images, are skipped.
+		 *
+		 * @param id File identity
+		 * @param filename Filename (UTF-8)
+		 * @param attrs RomDataAttr bitfield
+		 * @param romData RomData object
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int store(const LibRpFile::FileSystem::FileIdentity &id,
+			const char *filename, unsigned int attrs,
+			const LibRpBase::RomData *romData);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_PARSEDRESULTCACHE_HPP__ */
@@ -0,0 +1,280 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomDataCache.cpp: In-process cache of RomData objects.                  *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RomDataCache.hpp"
+
+// librpbase, librpfile
+#include "librpbase/monotonic_time.h"
+#include "librpbase/config/Config.hpp"
+using LibRpBase::Config;
+using LibRpBase::RomData;
+using LibRpFile::FileSystem::FileIdentity;
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+// C++ includes.
+#include <algorithm>
+#include <list>
+using std::list;
+using std::vector;
+
+namespace LibRomData {
+
+namespace RomDataCachePrivate {
+
+// Cache entry.
+struct CacheEntry {
+	FileIdentity id;
+	unsigned int attrs;	// RomDataAttr bitfield used to create romData
+	RomData *romData;	// ref()'d
+	uint64_t ts_added;	// rp_monotonic_ns() when added
+
+	inline bool matches(const FileIdentity &other) const
+	{
+		return (id.device == other.device && id.inode == other.inode &&
+		        id.size == other.size && id.mtime_ns == other.mtime_ns);
+	}
+};
+
+// Maximum number of entries in the cache.
+// Each entry keeps its file open, so this is kept small.
+static const size_t MAX_ENTRIES = 8;
+
+// Maximum age of a cache entry, in nanoseconds.
+// The handlers for a given file are usually called within
+// a few seconds of each other. Expiring entries quickly
+// limits how long the cached files are kept open.
+static const uint64_t MAX_AGE_NS = 30ULL * 1000000000ULL;
+
+// Cache entries, from most recently used to least recently used.
+// NOTE: The cache is small, so a linear search is fine.
+static list<CacheEntry> lst_entries;
+static Mutex mtxCache;
+
+// Memory budget for idle entries, in bytes. (0 for unlimited)
+// Loaded from Config on first use. (protected by mtxCache)
+static size_t memoryBudget;
+static bool memoryBudgetLoaded = false;
+
+/**
+ * Remove expired entries from the cache.
+ * mtxCache must be locked by the caller.
+ * @param now		[in] Current time, from rp_monotonic_ns()
+ * @param vec_unref	[out] RomData objects to unref() after unlocking mtxCache
+ */
+static void removeExpired(uint64_t now, vector<RomData*> &vec_unref)
+{
+	for (auto iter = lst_entries.begin(); iter != lst_entries.end(); ) {
+		if (now - iter->ts_added >= MAX_AGE_NS) {
+			vec_unref.emplace_back(iter->romData);
+			iter = lst_entries.erase(iter);
+		} else {
+			++iter;
+		}
+	}
+}
+
+/**
+ * Release memory from idle entries until the cache is within
+ * the memory budget, least recently used first.
+ *
+ * Only entries that are referenced solely by the cache are
+ * measured and trimmed, since releasing buffers from an object
+ * that's in use by another thread isn't safe. While mtxCache is
+ * locked, no new references to those entries can be obtained.
+ *
+ * First, cached parse buffers and images are released. If that
+ * isn't enough, idle entries are discarded.
+ *
+ * mtxCache must be locked by the caller.
+ * @param vec_unref	[out] RomData objects to unref() after unlocking mtxCache
+ */
+static void enforceMemoryBudget(vector<RomData*> &vec_unref)
+{
+	if (unlikely(!memoryBudgetLoaded)) {
+		memoryBudget = static_cast<size_t>(Config::instance()->memoryBudget()) << 20;
+		memoryBudgetLoaded = true;
+	}
+	if (memoryBudget == 0) {
+		// No limit.
+		return;
+	}
+
+	size_t total = 0;
+	for (const CacheEntry &entry : lst_entries) {
+		if (entry.romData->isUniqueRef()) {
+			total += entry.romData->memoryUsage();
+		}
+	}
+	if (total <= memoryBudget) {
+		// Within the budget.
+		return;
+	}
+
+	// Release cached data, least recently used first.
+	for (auto iter = lst_entries.rbegin(); iter != lst_entries.rend() && total > memoryBudget; ++iter) {
+		RomData *const romData = iter->romData;
+		if (!romData->isUniqueRef())
+			continue;
+
+		const size_t before = romData->memoryUsage();
+		romData->releaseMemory();
+		const size_t after = romData->memoryUsage();
+		if (after < before) {
+			total -= (before - after);
+		}
+	}
+
+	// Discard idle entries if still over the budget.
+	auto iter = lst_entries.end();
+	while (iter != lst_entries.begin() && total > memoryBudget) {
+		--iter;
+		if (!iter->romData->isUniqueRef())
+			continue;
+
+		const size_t usage = iter->romData->memoryUsage();
+		total -= std::min(total, usage);
+		vec_unref.emplace_back(iter->romData);
+		iter = lst_entries.erase(iter);
+	}
+}
+
+}
+
+/**
+ * Look up a RomData object.
+ *
+ * An entry matches if it was added with all of the
+ * requested attributes. Entries whose RomData object
+ * has been closed are discarded.
+ *
+ * Entries whose RomData object is still in use aren't
+ * returned, since RomData objects aren't thread-safe.
+ *
+ * @param id File identity
+ * @param attrs RomDataAttr bitfield
+ * @return ref()'d RomData object, or nullptr if not found.
+ */
+RomData *RomDataCache::lookup(const FileIdentity &id, unsigned int attrs)
+{
+	using namespace RomDataCachePrivate;
+	RomData *romData = nullptr;
+	vector<RomData*> vec_unref;
+
+	{
+		MutexLocker locker(mtxCache);
+		removeExpired(rp_monotonic_ns(), vec_unref);
+		for (auto iter = lst_entries.begin(); iter != lst_entries.end(); ++iter) {
+			if (!iter->matches(id))
+				continue;
+
+			if (!iter->romData->isOpen()) {
+				// RomData object was closed by one of its users.
+				// It can't load images anymore, so discard it.
+				vec_unref.emplace_back(iter->romData);
+				lst_entries.erase(iter);
+				break;
+			}
+			if ((iter->attrs & attrs) != attrs) {
+				// Created with fewer attributes than requested.
+				break;
+			}
+			if (!iter->romData->isUniqueRef()) {
+				// RomData object is currently in use, possibly by
+				// another thread. RomData objects aren't thread-safe,
+				// so the file will have to be parsed again.
+				break;
+			}
+
+			// Found a match. Move it to the front of the list.
+			romData = iter->romData->ref();
+			lst_entries.splice(lst_entries.begin(), lst_entries, iter);
+			break;
+		}
+
+		// Objects may have grown while they were in use.
+		enforceMemoryBudget(vec_unref);
+	}
+
+	for (RomData *romData_old : vec_unref) {
+		romData_old->unref();
+	}
+	return romData;
+}
+
+/**
+ * Add a RomData object to the cache.
+ * The RomData object will be ref()'d.
+ * If the cache is full, the least recently used entry is discarded.
+ * @param id File identity
+ * @param attrs RomDataAttr bitfield that was used to create the RomData object
+ * @param romData RomData object
+ */
+void RomDataCache::add(const FileIdentity &id, unsigned int attrs, RomData *romData)
+{
+	using namespace RomDataCachePrivate;
+	assert(romData != nullptr);
+	if (!romData)
+		return;
+
+	CacheEntry entry;
+	entry.id = id;
+	entry.attrs = attrs;
+	entry.romData = romData->ref();
+	entry.ts_added = rp_monotonic_ns();
+
+	vector<RomData*> vec_unref;
+	{
+		MutexLocker locker(mtxCache);
+		removeExpired(entry.ts_added, vec_unref);
+		for (auto iter = lst_entries.begin(); iter != lst_entries.end(); ++iter) {
+			if (iter->matches(id)) {
+				// Replace the existing entry for this file.
+				vec_unref.emplace_back(iter->romData);
+				lst_entries.erase(iter);
+				break;
+			}
+		}
+		lst_entries.push_front(entry);
+
+		if (lst_entries.size() > MAX_ENTRIES) {
+			// Discard the least recently used entry.
+			vec_unref.emplace_back(lst_entries.back().romData);
+			lst_entries.pop_back();
+		}
+		enforceMemoryBudget(vec_unref);
+	}
+
+	for (RomData *romData_old : vec_unref) {
+		romData_old->unref();
+	}
+}
+
+/**
+ * Clear the cache.
+ * All cached RomData objects will be unref()'d.
+ */
+void RomDataCache::clear(void)
+{
+	using namespace RomDataCachePrivate;
+	list<CacheEntry> lst_old;
+	{
+		MutexLocker locker(mtxCache);
+		lst_old.swap(lst_entries);
+	}
+
+	for (const CacheEntry &entry : lst_old) {
+		entry.romData->unref();
+	}
+}
+
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomDataCache.hpp: In-process cache of RomData objects.                  *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_ROMDATACACHE_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_ROMDATACACHE_HPP__
+
+#include "common.h"
+#include "librpfile/FileSystem.hpp"
+
+namespace LibRpBase {
+	class RomData;
+}
+
+namespace LibRomData {
+
+/**
+ * Small process-wide LRU cache of RomData objects.
+ *
+ * Long-lived frontends (file managers, Explorer) call several
+ * handlers on the same file: thumbnailer, overlay icon, metadata.
+ * With this cache, the file only has to be parsed once.
+ *
+ * Entries are keyed by the file's identity (device, inode, size,
+ * and mtime), so modifying a file automatically invalidates its
+ * entry. Each entry holds a reference to its RomData object, which
+ * keeps the file open, so entries expire after a short time.
+ */
+class RomDataCache
+{
+	private:
+		RomDataCache();
+		~RomDataCache();
+	private:
+		RP_DISABLE_COPY(RomDataCache)
+
+	public:
+		/**
+		 * Look up a RomData object.
+		 *
+		 * An entry matches if it was added with all of the
+		 * requested attributes. Entries whose RomData object
+		 * has been closed are discarded.
+		 *
+		 * Entries whose RomData object is still in use aren't
+		 * returned, since RomData objects aren't thread-safe.
+		 *
+		 * @param id File identity
+		 * @param attrs RomDataAttr bitfield
+		 * @return ref()'d RomData object, or nullptr if not found.
+		 */
+		static LibRpBase::RomData *lookup(const LibRpFile::FileSystem::FileIdentity &id, unsigned int attrs);
+
+		/**
+		 * Add a RomData object to the cache.
+		 * The RomData object will be ref()'d.
+		 * If the cache is full, the least recently used entry is discarded.
+		 * @param id File identity
+		 * @param attrs RomDataAttr bitfield that was used to create the RomData object
+		 * @param romData RomData object
+		 */
+		static void add(const LibRpFile::FileSystem::FileIdentity &id, unsigned int attrs, LibRpBase::RomData *romData);
+
+		/**
+		 * Clear the cache.
+		 * All cached RomData objects will be unref()'d.
+		 */
+		static void clear(void);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_ROMDATACACHE_HPP__ */
@@ -11,14 +11,29 @@
 #include "libromdata/config.libromdata.h"
 
 #include "RomDataFactory.hpp"
+#include "NegativeDetectCache.hpp"
+#include "ParsedResultCache.hpp"
+#include "RomDataCache.hpp"
 
 // librpbase, librpfile
+#include "librpbase/monotonic_time.h"
 #include "librpfile/RelatedFile.hpp"
+#include "librpfile/RpTrace.hpp"
+#include "librpfile/config.librpfile.h"
+#ifdef HAVE_IO_URING
+#  include "librpfile/linux/IoUring.hpp"
+#endif /* HAVE_IO_URING */
 using namespace LibRpBase;
 using namespace LibRpFile;
 
 // librpthreads
+#include "librpthreads/Atomics.h"
 #include "librpthreads/pthread_once.h"
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+using LibRpThreads::ThreadPool;
 
 // librptexture
 #include "librptexture/FileFormatFactory.hpp"
@@ -27,7 +42,6 @@ using LibRpTexture::FileFormatFactory;
 // C++ STL classes.
 using std::string;
 using std::unordered_map;
-using std::unordered_set;
 using std::vector;
 
 // RomData subclasses: Consoles
@@ -124,6 +138,7 @@ class RomDataFactoryPrivate
 			pfnNewRomData_t newRomData;
 			pfnSupportedFileExtensions_t supportedFileExtensions;
 			pfnSupportedMimeTypes_t supportedMimeTypes;
+			const char *className;
 			unsigned int attrs;
 
 			// Extra fields for files whose headers
@@ -147,14 +162,14 @@ class RomDataFactoryPrivate
 	 RomDataFactoryPrivate::RomData_ctor<sys>, \
 	 sys::supportedFileExtensions_static, \
 	 sys::supportedMimeTypes_static, \
-	 attrs, 0, 0}
+	 #sys, attrs, 0, 0}
 
 #define GetRomDataFns_addr(sys, attrs, address, size) \
 	{sys::isRomSupported_static, \
 	 RomDataFactoryPrivate::RomData_ctor<sys>, \
 	 sys::supportedFileExtensions_static, \
 	 sys::supportedMimeTypes_static, \
-	 attrs, address, size}
+	 #sys, attrs, address, size}
 
 		// RomData subclasses that use a header at 0 and
 		// definitely have a 32-bit magic number in the header.
@@ -170,6 +185,17 @@ class RomDataFactoryPrivate
 		// RomData subclasses that use a footer.
 		static const RomDataFns romDataFns_footer[];
 
+		// Minimum footer window size.
+		static const uint32_t FOOTER_SIZE_MIN = 1024;
+
+		/**
+		 * Get the footer window size.
+		 * This is the largest window requested by romDataFns_footer[],
+		 * or FOOTER_SIZE_MIN, whichever is larger.
+		 * @return Footer window size
+		 */
+		static uint32_t footerSize(void);
+
 		// Table of pointers to tables.
 		// This reduces duplication by only requiring a single loop
 		// in each function.
@@ -178,9 +204,10 @@ class RomDataFactoryPrivate
 		/**
 		 * Attempt to open the other file in a Dreamcast .VMI+.VMS pair.
 		 * @param file One opened file in the .VMI+.VMS pair.
-		 * @return DreamcastSave if valid; nullptr if not.
+		 * @param pIdInfo [out,opt] If not nullptr, identify the pair without constructing a DreamcastSave.
+		 * @return DreamcastSave if valid; nullptr if not or identifying only.
 		 */
-		static RomData *openDreamcastVMSandVMI(IRpFile *file);
+		static RomData *openDreamcastVMSandVMI(IRpFile *file, RomDataFactory::IdentifyInfo *pIdInfo = nullptr);
 
 		// Vectors for file extensions and MIME types.
 		// We want to collect them once per session instead of
@@ -192,6 +219,58 @@ class RomDataFactoryPrivate
 		static pthread_once_t once_exts;
 		static pthread_once_t once_mimeTypes;
 
+		// Extension hints for RDA_EXT_HINT.
+		// Key: Lowercase file extension, including the leading dot.
+		// Value: romDataFns_magic[] and romDataFns_header[] entries
+		// with header address 0 that support the extension, in table order.
+		// NOTE: Initialized by init_supportedFileExtensions().
+		static unordered_map<string, vector<const RomDataFns*> > map_extHints;
+
+		// Magic number dispatch index for romDataFns_magic[].
+		// Key: (address << 32) | magic
+		// Value: Indexes into romDataFns_magic[], in table order.
+		// NOTE: A class may have multiple magic numbers and/or
+		// addresses; duplicate matches are only checked once.
+		static unordered_map<uint64_t, vector<uint8_t> > map_magic;
+		// Distinct magic number addresses, sorted.
+		static vector<uint32_t> vec_magic_addrs;
+		static pthread_once_t once_magic;
+
+		/**
+		 * Initialize the magic number dispatch index.
+		 * Internal function; must be called using pthread_once().
+		 */
+		static void init_magicIndex(void);
+
+		// Probe plan for romDataFns_header[] entries with
+		// non-zero addresses. Ranges that are close together
+		// are coalesced so they can be read with a single I/O.
+		struct ProbeRange {
+			uint32_t addr;		// Start address in the file.
+			uint32_t size;		// Length.
+			uint32_t buf_offset;	// Offset in the probe buffer.
+		};
+		static vector<ProbeRange> vec_probeRanges;
+		static uint32_t probeBufSize;
+		static pthread_once_t once_probePlan;
+
+		// Maximum gap between two ranges for them to be coalesced.
+		static const uint32_t PROBE_MAX_GAP = 32*1024;
+
+		/**
+		 * Initialize the probe plan for non-zero header addresses.
+		 * Internal function; must be called using pthread_once().
+		 */
+		static void init_probePlan(void);
+
+		/**
+		 * Read all ranges in the probe plan.
+		 * @param file		[in] ROM file
+		 * @param buf		[out] Probe buffer (resized to probeBufSize)
+		 * @param readSizes	[out] Number of bytes read for each range
+		 */
+		static void readProbeRanges(IRpFile *file, ao::uvector<uint8_t> &buf, vector<uint32_t> &readSizes);
+
 		/**
 		 * Initialize the vector of supported file extensions.
 		 * Used for Win32 COM registration.
@@ -218,9 +297,119 @@ class RomDataFactoryPrivate
 		 * RomData subclasses support it, an ISO object will be returned.
 		 *
 		 * @param file ISO-9660 disc image
-		 * @return Game-specific RomData subclass, or nullptr if none are supported.
+		 * @param pIdInfo [out,opt] If not nullptr, identify the subclass without constructing it.
+		 * @return Game-specific RomData subclass, or nullptr if none are supported or identifying only.
+		 */
+		static RomData *checkISO(IRpFile *file, RomDataFactory::IdentifyInfo *pIdInfo = nullptr);
+
+		/**
+		 * Check a RomData subclass and construct it if it supports the file.
+		 * @param fns RomDataFns
+		 * @param file ROM file
+		 * @param info DetectInfo
+		 * @param pIdInfo [out,opt] If not nullptr, identify the subclass without constructing it.
+		 * @return RomData subclass, or nullptr if not supported or identifying only.
+		 */
+		static RomData *tryRomDataFns(const RomDataFns *fns, IRpFile *file,
+			const RomData::DetectInfo *info, RomDataFactory::IdentifyInfo *pIdInfo);
+
+		/**
+		 * tryRomDataFns() with detection statistics.
+		 * @param fns RomDataFns
+		 * @param file ROM file
+		 * @param info DetectInfo
+		 * @param pIdInfo [out,opt] If not nullptr, identify the subclass without constructing it.
+		 * @return RomData subclass, or nullptr if not supported or identifying only.
+		 */
+		static RomData *tryRomDataFns_stats(const RomDataFns *fns, IRpFile *file,
+			const RomData::DetectInfo *info, RomDataFactory::IdentifyInfo *pIdInfo);
+
+		/**
+		 * Detect the RomData subclass for the specified ROM file.
+		 * @param file ROM file.
+		 * @param attrs RomDataAttr bitfield.
+		 * @param pIdInfo [out,opt] If not nullptr, identify the subclass without constructing it.
+		 * @return RomData subclass, or nullptr if the ROM isn't supported or identifying only.
+		 */
+		static RomData *detect(IRpFile *file, unsigned int attrs, RomDataFactory::IdentifyInfo *pIdInfo);
+
+		// createBatch() job information.
+		struct BatchJob {
+			// Only one of these is set.
+			const vector<string> *filenames;
+			const vector<IRpFile*> *files;
+
+			unsigned int attrs;
+			RomDataFactory::pfnBatchCallback_t callback;
+			void *userdata;
+
+			size_t count;		// Number of files
+			size_t claimCount;	// Files claimed at once if prefetching
+			Mutex mtxCallback;	// Serializes callback calls
+		};
+
+#ifdef HAVE_IO_URING
+		// Number of files claimed at once by a batch worker if
+		// io_uring is available. Their headers are prefetched
+		// together before detection.
+		static const size_t BATCH_PREFETCH_COUNT = 16;
+		static const size_t BATCH_PREFETCH_SIZE = 64U*1024U;
+#endif /* HAVE_IO_URING */
+
+		/**
+		 * createBatch() range function for ThreadPool::parallelFor().
+		 * @param param BatchJob
+		 * @param begin First file index
+		 * @param end One past the last file index
+		 */
+		static void batchRange(void *param, size_t begin, size_t end);
+
+		/**
+		 * Run a createBatch() job.
+		 * @param job BatchJob
+		 * @param threads Number of threads (0 to use the process-wide thread pool)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int runBatch(BatchJob &job, unsigned int threads);
+
+		// Detection statistics.
+		// Enabled by setDetectStatsEnabled() or the
+		// RP_DETECT_STATS environment variable.
+		struct DetectStats {
+			uint64_t probes;	// Number of isRomSupported() calls
+			uint64_t hits;		// Number of isRomSupported() calls that succeeded
+			uint64_t probe_ns;	// Time spent in isRomSupported()
+			uint64_t ctor_ns;	// Time spent in the constructor and isValid()
+		};
+		static volatile int statsEnabled;	// Written using ATOMIC_EXCHANGE().
+		static uint64_t statsBytesRead;	// Bytes read by the factory itself
+		static unordered_map<const RomDataFns*, DetectStats> map_stats;
+		static Mutex mtxStats;
+		static pthread_once_t once_stats;
+
+		/**
+		 * Initialize detection statistics.
+		 * Checks the RP_DETECT_STATS environment variable.
+		 * Internal function; must be called using pthread_once().
 		 */
-		static RomData *checkISO(IRpFile *file);
+		static void init_stats(void);
+
+		/**
+		 * Print detection statistics to stderr on exit.
+		 */
+		static void atexit_printStats(void);
+
+		/**
+		 * Add to the number of bytes read during detection.
+		 * @param size Number of bytes read
+		 */
+		static inline void addBytesRead(size_t size)
+		{
+			if (unlikely(statsEnabled)) {
+				MutexLocker locker(mtxStats);
+				statsBytesRead += size;
+			}
+		}
 };
 
 /** RomDataFactoryPrivate **/
@@ -229,6 +418,23 @@ vector<RomDataFactory::ExtInfo> RomDataFactoryPrivate::vec_exts;
 vector<const char*> RomDataFactoryPrivate::vec_mimeTypes;
 pthread_once_t RomDataFactoryPrivate::once_exts = PTHREAD_ONCE_INIT;
 pthread_once_t RomDataFactoryPrivate::once_mimeTypes = PTHREAD_ONCE_INIT;
+unordered_map<string, vector<const RomDataFactoryPrivate::RomDataFns*> > RomDataFactoryPrivate::map_extHints;
+unordered_map<uint64_t, vector<uint8_t> > RomDataFactoryPrivate::map_magic;
+vector<uint32_t> RomDataFactoryPrivate::vec_magic_addrs;
+pthread_once_t RomDataFactoryPrivate::once_magic = PTHREAD_ONCE_INIT;
+vector<RomDataFactoryPrivate::ProbeRange> RomDataFactoryPrivate::vec_probeRanges;
+uint32_t RomDataFactoryPrivate::probeBufSize = 0;
+pthread_once_t RomDataFactoryPrivate::once_probePlan = PTHREAD_ONCE_INIT;
+volatile int RomDataFactoryPrivate::statsEnabled = 0;
+uint64_t RomDataFactoryPrivate::statsBytesRead = 0;
+unordered_map<const RomDataFactoryPrivate::RomDataFns*, RomDataFactoryPrivate::DetectStats> RomDataFactoryPrivate::map_stats;
+Mutex RomDataFactoryPrivate::mtxStats;
+pthread_once_t RomDataFactoryPrivate::once_stats = PTHREAD_ONCE_INIT;
+#ifdef HAVE_IO_URING
+// Out-of-class definitions, since BATCH_PREFETCH_COUNT is passed by reference to std::min().
+const size_t RomDataFactoryPrivate::BATCH_PREFETCH_COUNT;
+const size_t RomDataFactoryPrivate::BATCH_PREFETCH_SIZE;
+#endif /* HAVE_IO_URING */
 
 #define ATTR_NONE		RomDataFactory::RDA_NONE
 #define ATTR_HAS_THUMBNAIL	RomDataFactory::RDA_HAS_THUMBNAIL
@@ -241,7 +447,9 @@ pthread_once_t RomDataFactoryPrivate::once_mimeTypes = PTHREAD_ONCE_INIT;
 // definitely have a 32-bit magic number in the header.
 // - address: Address of magic number within the header.
 // - size: 32-bit magic number.
-// TODO: Add support for multiple magic numbers per class.
+// NOTE: Classes with multiple magic numbers should have
+// one entry per magic number. init_magicIndex() handles
+// the deduplication.
 const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_magic[] = {
 	// Consoles
 	GetRomDataFns_addr(PlayStationEXE, 0, 0, 'PS-X'),
@@ -290,7 +498,7 @@ const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_magic[
 	GetRomDataFns_addr(Xbox360_STFS, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'PIRS'),
 	GetRomDataFns_addr(Xbox360_STFS, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 'LIVE'),
 
-	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
+	{nullptr, nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
 };
 
 // RomData subclasses that use a header.
@@ -331,7 +539,12 @@ const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_header
 
 	// The following formats have 16-bit magic numbers,
 	// so they should go at the end of the address=0 section.
-	GetRomDataFns(EXE, ATTR_HAS_DPOVERLAY),	// TODO: Thumbnailing on non-Windows platforms.
+#ifdef _WIN32
+	// Windows Explorer already shows EXE icons.
+	GetRomDataFns(EXE, ATTR_HAS_DPOVERLAY),
+#else /* !_WIN32 */
+	GetRomDataFns(EXE, ATTR_HAS_THUMBNAIL | ATTR_HAS_DPOVERLAY),
+#endif /* _WIN32 */
 	GetRomDataFns(PlayStationSave, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA),
 
 	// NOTE: game.com may be at either 0 or 0x40000.
@@ -352,14 +565,16 @@ const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_header
 	// NOTE: ATTR_HAS_THUMBNAIL is needed for Xbox 360.
 	GetRomDataFns_addr(ISO, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA | ATTR_SUPPORTS_DEVICES | ATTR_CHECK_ISO, 0x40000, 0x20),
 
-	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
+	{nullptr, nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
 };
 
 // RomData subclasses that use a footer.
+// - size: Minimum footer window size, counted from the end of the file.
+// The footer is read once using the largest window from this table.
 const RomDataFactoryPrivate::RomDataFns RomDataFactoryPrivate::romDataFns_footer[] = {
-	GetRomDataFns(VirtualBoy, ATTR_NONE),
-	GetRomDataFns(WonderSwan, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA),
-	{nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
+	GetRomDataFns_addr(VirtualBoy, ATTR_NONE, 0, 0x220),
+	GetRomDataFns_addr(WonderSwan, ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA, 0, 0x10),
+	{nullptr, nullptr, nullptr, nullptr, nullptr, ATTR_NONE, 0, 0}
 };
 
 // Table of pointers to tables.
@@ -372,12 +587,32 @@ const RomDataFactoryPrivate::RomDataFns *const RomDataFactoryPrivate::romDataFns
 	nullptr
 };
 
+/**
+ * Get the footer window size.
+ * This is the largest window requested by romDataFns_footer[],
+ * or FOOTER_SIZE_MIN, whichever is larger.
+ * @return Footer window size
+ */
+uint32_t RomDataFactoryPrivate::footerSize(void)
+{
+	uint32_t footer_size = FOOTER_SIZE_MIN;
+	for (const RomDataFns *fns = &romDataFns_footer[0];
+	     fns->supportedFileExtensions != nullptr; fns++)
+	{
+		if (fns->size > footer_size) {
+			footer_size = fns->size;
+		}
+	}
+	return footer_size;
+}
+
 /**
  * Attempt to open the other file in a Dreamcast .VMI+.VMS pair.
  * @param file One opened file in the .VMI+.VMS pair.
- * @return DreamcastSave if valid; nullptr if not.
+ * @param pIdInfo [out,opt] If not nullptr, identify the pair without constructing a DreamcastSave.
+ * @return DreamcastSave if valid; nullptr if not or identifying only.
  */
-RomData *RomDataFactoryPrivate::openDreamcastVMSandVMI(IRpFile *file)
+RomData *RomDataFactoryPrivate::openDreamcastVMSandVMI(IRpFile *file, RomDataFactory::IdentifyInfo *pIdInfo)
 {
 	// We're assuming the file extension was already checked.
 	// VMS files are always a multiple of 512 bytes,
@@ -424,6 +659,18 @@ RomData *RomDataFactoryPrivate::openDreamcastVMSandVMI(IRpFile *file)
 		return nullptr;
 	}
 
+	if (pIdInfo) {
+		// Identify only. Verify the headers without
+		// constructing a DreamcastSave.
+		if (DreamcastSave::isVmsVmiPairSupported_static(vms_file, vmi_file)) {
+			pIdInfo->className = "DreamcastSave";
+			pIdInfo->romType = 0;
+			pIdInfo->attrs = ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA;
+		}
+		(*other_file)->unref();
+		return nullptr;
+	}
+
 	// Attempt to create a DreamcastSave using both the
 	// VMS and VMI files.
 	DreamcastSave *const dcSave = new DreamcastSave(vms_file, vmi_file);
@@ -438,6 +685,116 @@ RomData *RomDataFactoryPrivate::openDreamcastVMSandVMI(IRpFile *file)
 	return dcSave;
 }
 
+/**
+ * Initialize the magic number dispatch index.
+ * Internal function; must be called using pthread_once().
+ */
+void RomDataFactoryPrivate::init_magicIndex(void)
+{
+	static_assert(ARRAY_SIZE(romDataFns_magic) <= 256,
+		"romDataFns_magic[] has too many entries for uint8_t indexes.");
+
+#ifdef HAVE_UNORDERED_MAP_RESERVE
+	map_magic.reserve(ARRAY_SIZE(romDataFns_magic));
+#endif /* HAVE_UNORDERED_MAP_RESERVE */
+
+	uint8_t idx = 0;
+	for (const RomDataFns *fns = &romDataFns_magic[0];
+	     fns->supportedFileExtensions != nullptr; fns++, idx++)
+	{
+		// TODO: Verify alignment restrictions.
+		assert(fns->address % 4 == 0);
+		const uint64_t key = (static_cast<uint64_t>(fns->address) << 32) | fns->size;
+		map_magic[key].emplace_back(idx);
+
+		if (std::find(vec_magic_addrs.cbegin(), vec_magic_addrs.cend(), fns->address) == vec_magic_addrs.cend()) {
+			vec_magic_addrs.emplace_back(fns->address);
+		}
+	}
+
+	std::sort(vec_magic_addrs.begin(), vec_magic_addrs.end());
+}
+
+/**
+ * Initialize the probe plan for non-zero header addresses.
+ * Internal function; must be called using pthread_once().
+ */
+void RomDataFactoryPrivate::init_probePlan(void)
+{
+	// Collect the header ranges.
+	vector<ProbeRange> ranges;
+	for (const RomDataFns *fns = &romDataFns_header[0];
+	     fns->supportedFileExtensions != nullptr; fns++)
+	{
+		if (fns->address == 0)
+			continue;
+		assert(fns->size != 0);
+		ranges.push_back({fns->address, fns->size, 0});
+	}
+
+	std::sort(ranges.begin(), ranges.end(),
+		[](const ProbeRange &a, const ProbeRange &b) {
+			return (a.addr < b.addr);
+		});
+
+	// Coalesce overlapping and nearby ranges.
+	for (const ProbeRange &range : ranges) {
+		if (!vec_probeRanges.empty()) {
+			ProbeRange &last = vec_probeRanges.back();
+			const uint32_t last_end = last.addr + last.size;
+			if (range.addr <= last_end + PROBE_MAX_GAP) {
+				// Extend the previous range.
+				const uint32_t range_end = range.addr + range.size;
+				if (range_end > last_end) {
+					last.size = range_end - last.addr;
+				}
+				continue;
+			}
+		}
+		vec_probeRanges.push_back(range);
+	}
+
+	// Assign buffer offsets.
+	probeBufSize = 0;
+	for (ProbeRange &range : vec_probeRanges) {
+		range.buf_offset = probeBufSize;
+		probeBufSize += range.size;
+	}
+}
+
+/**
+ * Read all ranges in the probe plan.
+ * @param file		[in] ROM file
+ * @param buf		[out] Probe buffer (resized to probeBufSize)
+ * @param readSizes	[out] Number of bytes read for each range
+ */
+void RomDataFactoryPrivate::readProbeRanges(IRpFile *file, ao::uvector<uint8_t> &buf, vector<uint32_t> &readSizes)
+{
+	pthread_once(&once_probePlan, init_probePlan);
+	buf.resize(probeBufSize);
+	readSizes.resize(vec_probeRanges.size());
+
+	const off64_t fileSize = file->size();
+	for (size_t i = 0; i < vec_probeRanges.size(); i++) {
+		const ProbeRange &range = vec_probeRanges[i];
+		readSizes[i] = 0;
+		if (static_cast<off64_t>(range.addr) >= fileSize) {
+			// Ranges are sorted, so none of the
+			// remaining ranges are in the file.
+			break;
+		}
+
+		// Don't read past the end of the file.
+		uint32_t size = range.size;
+		if (static_cast<off64_t>(range.addr) + size > fileSize) {
+			size = static_cast<uint32_t>(fileSize - range.addr);
+		}
+		readSizes[i] = static_cast<uint32_t>(
+			file->seekAndRead(range.addr, &buf[range.buf_offset], size));
+		addBytesRead(readSizes[i]);
+	}
+}
+
 /**
  * Check an ISO-9660 disc image for a game-specific file system.
  *
@@ -445,24 +802,36 @@ RomData *RomDataFactoryPrivate::openDreamcastVMSandVMI(IRpFile *file)
  * RomData subclasses support it, an ISO object will be returned.
  *
  * @param file ISO-9660 disc image
- * @return Game-specific RomData subclass, or nullptr if none are supported.
+ * @param pIdInfo [out,opt] If not nullptr, identify the subclass without constructing it.
+ * @return Game-specific RomData subclass, or nullptr if none are supported or identifying only.
  */
-RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
+RomData *RomDataFactoryPrivate::checkISO(IRpFile *file, RomDataFactory::IdentifyInfo *pIdInfo)
 {
-	// Check for a CD file system with 2048-byte sectors.
-	CDROM_2352_Sector_t sector;
-	size_t size = file->seekAndRead(ISO_PVD_ADDRESS_2048, &sector.m1.data, sizeof(sector.m1.data));
-	if (size != sizeof(sector.m1.data)) {
+	// Read the entire region that may contain a PVD or an XDVDFS header
+	// in a single read, then check each sector size from memory.
+	// - Start: PVD with 2048-byte sectors.
+	// - End: XDVDFS header. (2048-byte sectors only)
+	static const unsigned int probe_start = ISO_PVD_ADDRESS_2048;
+	static const unsigned int xdvdfs_addr = XDVDFS_HEADER_LBA_OFFSET * XDVDFS_BLOCK_SIZE;
+	static const unsigned int probe_end = xdvdfs_addr + sizeof(XDVDFS_Header);
+	static_assert(2448U * (ISO_PVD_LBA + 1) <= probe_end, "probe region does not cover the 2448-byte sector PVD");
+
+	ao::uvector<uint8_t> probeBuf;
+	probeBuf.resize(probe_end - probe_start);
+	const size_t size = file->seekAndRead(probe_start, probeBuf.data(), probeBuf.size());
+	if (size < ISO_SECTOR_SIZE_MODE1_COOKED) {
 		// Unable to read the PVD.
 		return nullptr;
 	}
+	const size_t probe_avail = probe_start + size;
 
+	// Check for a CD file system with 2048-byte sectors.
 	bool is2048;
 	const ISO_Primary_Volume_Descriptor *pvd = nullptr;
-	int discType = ISO::checkPVD(sector.m1.data);
+	int discType = ISO::checkPVD(probeBuf.data());
 	if (discType >= 0) {
 		// Found a PVD with 2048-byte sectors.
-		pvd = reinterpret_cast<const ISO_Primary_Volume_Descriptor*>(sector.m1.data);
+		pvd = reinterpret_cast<const ISO_Primary_Volume_Descriptor*>(probeBuf.data());
 		is2048 = true;
 	} else {
 		// Check for a PVD with 2352-byte or 2448-byte sectors.
@@ -470,14 +839,17 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 		is2048 = false;
 
 		for (const unsigned int *p = sector_sizes; *p != 0; p++) {
-			size_t size = file->seekAndRead(*p * ISO_PVD_LBA, &sector, sizeof(sector));
-			if (size != sizeof(sector)) {
+			const unsigned int sector_addr = *p * ISO_PVD_LBA;
+			if (sector_addr + sizeof(CDROM_2352_Sector_t) > probe_avail) {
 				// Unable to read the PVD.
 				return nullptr;
 			}
 
-			const uint8_t *const pData = cdromSectorDataPtr(&sector);
-			if (ISO::checkPVD(pData) >= 0) {
+			const CDROM_2352_Sector_t *const pSector = reinterpret_cast<const CDROM_2352_Sector_t*>(
+				&probeBuf[sector_addr - probe_start]);
+			const uint8_t *const pData = cdromSectorDataPtr(pSector);
+			discType = ISO::checkPVD(pData);
+			if (discType >= 0) {
 				// Found the correct sector size.
 				pvd = reinterpret_cast<const ISO_Primary_Volume_Descriptor*>(pData);
 				break;
@@ -495,22 +867,33 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 	struct RomDataFns_ISO {
 		pfnIsRomSupported_ISO_t isRomSupported;
 		pfnNewRomData_t newRomData;
+		const char *className;
 	};
 #define GetRomDataFns_ISO(sys) \
 	{sys::isRomSupported_static, \
-	 RomDataFactoryPrivate::RomData_ctor<sys>}
+	 RomDataFactoryPrivate::RomData_ctor<sys>, \
+	 #sys}
 	static const RomDataFns_ISO romDataFns_ISO[] = {
 		GetRomDataFns_ISO(PlayStationDisc),
 		GetRomDataFns_ISO(PSP),
 		GetRomDataFns_ISO(XboxDisc),
 
-		{nullptr, nullptr}
+		{nullptr, nullptr, nullptr}
 	};
 
 	const RomDataFns_ISO *fns = &romDataFns_ISO[0];
 	for (; fns->isRomSupported != nullptr; fns++) {
-		if (fns->isRomSupported(pvd) >= 0) {
+		const int romType = fns->isRomSupported(pvd);
+		if (romType >= 0) {
+			if (pIdInfo) {
+				// Identify only.
+				pIdInfo->className = fns->className;
+				pIdInfo->romType = romType;
+				return nullptr;
+			}
+
 			// This might be the correct RomData subclass.
+			RP_TRACE_SCOPE_D("RomData::ctor", fns->className);
 			RomData *const romData = fns->newRomData(file);
 			if (romData->isValid()) {
 				// Found the correct RomData subclass.
@@ -523,14 +906,21 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 	// Check for extracted XDVDFS. (2048-byte sector images only)
 	if (is2048) {
 		// Check for the magic number at the base offset.
-		XDVDFS_Header xdvdfsHeader;
-		size = file->seekAndRead(XDVDFS_HEADER_LBA_OFFSET * XDVDFS_BLOCK_SIZE,
-			&xdvdfsHeader, sizeof(xdvdfsHeader));
-		if (size == sizeof(xdvdfsHeader)) {
+		// The XDVDFS header is at the end of the probe region.
+		if (probe_avail >= probe_end) {
+			const XDVDFS_Header *const xdvdfsHeader = reinterpret_cast<const XDVDFS_Header*>(
+				&probeBuf[xdvdfs_addr - probe_start]);
 			// Check the magic numbers.
-			if (!memcmp(xdvdfsHeader.magic, XDVDFS_MAGIC, sizeof(xdvdfsHeader.magic)) &&
-			    !memcmp(xdvdfsHeader.magic_footer, XDVDFS_MAGIC, sizeof(xdvdfsHeader.magic_footer)))
+			if (!memcmp(xdvdfsHeader->magic, XDVDFS_MAGIC, sizeof(xdvdfsHeader->magic)) &&
+			    !memcmp(xdvdfsHeader->magic_footer, XDVDFS_MAGIC, sizeof(xdvdfsHeader->magic_footer)))
 			{
+				if (pIdInfo) {
+					// Identify only.
+					pIdInfo->className = "XboxDisc";
+					pIdInfo->romType = 0;
+					return nullptr;
+				}
+
 				// It's a match! Try opening as XboxDisc.
 				RomData *const romData = new XboxDisc(file);
 				if (romData->isValid()) {
@@ -544,29 +934,160 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 
 	// Not a game-specific file system.
 	// Use the generic ISO-9660 parser.
+	if (pIdInfo) {
+		// Identify only.
+		pIdInfo->className = "ISO";
+		pIdInfo->romType = discType;
+		return nullptr;
+	}
 	return new ISO(file);
 }
 
-/** RomDataFactory **/
+/**
+ * Check a RomData subclass and construct it if it supports the file.
+ * @param fns RomDataFns
+ * @param file ROM file
+ * @param info DetectInfo
+ * @param pIdInfo [out,opt] If not nullptr, identify the subclass without constructing it.
+ * @return RomData subclass, or nullptr if not supported or identifying only.
+ */
+RomData *RomDataFactoryPrivate::tryRomDataFns(const RomDataFns *fns, IRpFile *file,
+	const RomData::DetectInfo *info, RomDataFactory::IdentifyInfo *pIdInfo)
+{
+	if (unlikely(statsEnabled)) {
+		return tryRomDataFns_stats(fns, file, info, pIdInfo);
+	}
+
+	const int romType = fns->isRomSupported(info);
+	if (romType < 0) {
+		// Not supported.
+		return nullptr;
+	}
+
+	if (pIdInfo) {
+		// Identify only.
+		pIdInfo->attrs = fns->attrs & ~ATTR_CHECK_ISO;
+		if (fns->attrs & ATTR_CHECK_ISO) {
+			// Check for a game-specific ISO subclass.
+			// NOTE: className will be nullptr if the PVD is invalid.
+			checkISO(file, pIdInfo);
+		} else {
+			pIdInfo->className = fns->className;
+			pIdInfo->romType = romType;
+		}
+		return nullptr;
+	}
+
+	RomData *romData;
+	if (fns->attrs & ATTR_CHECK_ISO) {
+		// Check for a game-specific ISO subclass.
+		romData = checkISO(file);
+	} else {
+		// Standard RomData subclass.
+		RP_TRACE_SCOPE_D("RomData::ctor", fns->className);
+		romData = fns->newRomData(file);
+	}
+
+	if (romData) {
+		if (romData->isValid()) {
+			// RomData subclass obtained.
+			return romData;
+		}
+		// Not actually supported.
+		romData->unref();
+	}
+	return nullptr;
+}
 
 /**
- * Create a RomData subclass for the specified ROM file.
- *
- * NOTE: RomData::isValid() is checked before returning a
- * created RomData instance, so returned objects can be
- * assumed to be valid as long as they aren't nullptr.
- *
- * If imgbf is non-zero, at least one of the specified image
- * types must be supported by the RomData subclass in order to
- * be returned.
- *
+ * tryRomDataFns() with detection statistics.
+ * @param fns RomDataFns
+ * @param file ROM file
+ * @param info DetectInfo
+ * @param pIdInfo [out,opt] If not nullptr, identify the subclass without constructing it.
+ * @return RomData subclass, or nullptr if not supported or identifying only.
+ */
+RomData *RomDataFactoryPrivate::tryRomDataFns_stats(const RomDataFns *fns, IRpFile *file,
+	const RomData::DetectInfo *info, RomDataFactory::IdentifyInfo *pIdInfo)
+{
+	// Time the isRomSupported() call separately.
+	uint64_t ts_start = rp_monotonic_ns();
+	const int romType = fns->isRomSupported(info);
+	const uint64_t probe_ns = rp_monotonic_ns() - ts_start;
+
+	RomData *romData = nullptr;
+	uint64_t ctor_ns = 0;
+	if (romType >= 0) {
+		// Time the constructor and isValid() check.
+		ts_start = rp_monotonic_ns();
+		if (pIdInfo) {
+			pIdInfo->attrs = fns->attrs & ~ATTR_CHECK_ISO;
+			if (fns->attrs & ATTR_CHECK_ISO) {
+				checkISO(file, pIdInfo);
+			} else {
+				pIdInfo->className = fns->className;
+				pIdInfo->romType = romType;
+			}
+		} else {
+			RP_TRACE_SCOPE_D("RomData::ctor", fns->className);
+			romData = (fns->attrs & ATTR_CHECK_ISO) ? checkISO(file) : fns->newRomData(file);
+			if (romData && !romData->isValid()) {
+				// Not actually supported.
+				romData->unref();
+				romData = nullptr;
+			}
+		}
+		ctor_ns = rp_monotonic_ns() - ts_start;
+	}
+
+	MutexLocker locker(mtxStats);
+	DetectStats &stats = map_stats[fns];
+	stats.probes++;
+	if (romType >= 0) {
+		stats.hits++;
+	}
+	stats.probe_ns += probe_ns;
+	stats.ctor_ns += ctor_ns;
+	return romData;
+}
+
+/**
+ * Initialize detection statistics.
+ * Checks the RP_DETECT_STATS environment variable.
+ * Internal function; must be called using pthread_once().
+ */
+void RomDataFactoryPrivate::init_stats(void)
+{
+	const char *const env = getenv("RP_DETECT_STATS");
+	if (env && env[0] != '\0' && strcmp(env, "0") != 0) {
+		ATOMIC_EXCHANGE(&statsEnabled, 1);
+		atexit(atexit_printStats);
+	}
+}
+
+/**
+ * Print detection statistics to stderr on exit.
+ */
+void RomDataFactoryPrivate::atexit_printStats(void)
+{
+	RomDataFactory::printDetectStats(stderr);
+}
+
+/**
+ * Detect the RomData subclass for the specified ROM file.
  * @param file ROM file.
- * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
- * @return RomData subclass, or nullptr if the ROM isn't supported.
+ * @param attrs RomDataAttr bitfield.
+ * @param pIdInfo [out,opt] If not nullptr, identify the subclass without constructing it.
+ * @return RomData subclass, or nullptr if the ROM isn't supported or identifying only.
  */
-RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
+RomData *RomDataFactoryPrivate::detect(IRpFile *file, unsigned int attrs, RomDataFactory::IdentifyInfo *pIdInfo)
 {
 	RomData::DetectInfo info;
+	pthread_once(&once_stats, init_stats);
+
+	// RDA_EXT_HINT is a create() flag, not a subclass attribute.
+	const bool extHint = !!(attrs & RomDataFactory::RDA_EXT_HINT);
+	attrs &= ~RomDataFactory::RDA_EXT_HINT;
 
 	// Get the file size.
 	info.szFile = file->size();
@@ -577,10 +1098,30 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 		uint8_t u8[4096+256];
 		uint32_t u32[(4096+256)/4];
 	} header;
-	file->rewind();
 	info.header.addr = 0;
-	info.header.pData = header.u8;
-	info.header.size = static_cast<uint32_t>(file->read(header.u8, sizeof(header.u8)));
+
+	// If the file is backed by memory, use the data in place.
+	// NOTE: The magic number checks need 32-bit alignment.
+	const uint32_t *pHeader32 = header.u32;
+	const uint8_t *pPeek = nullptr;
+	if (info.szFile > 0) {
+		info.header.size = static_cast<uint32_t>(
+			std::min(info.szFile, static_cast<off64_t>(sizeof(header.u8))));
+		pPeek = file->peek(0, info.header.size);
+		if (pPeek && (reinterpret_cast<uintptr_t>(pPeek) & 3) != 0) {
+			pPeek = nullptr;
+		}
+	}
+	if (pPeek) {
+		info.header.pData = pPeek;
+		pHeader32 = reinterpret_cast<const uint32_t*>(pPeek);
+		file->rewind();
+	} else {
+		file->rewind();
+		info.header.pData = header.u8;
+		info.header.size = static_cast<uint32_t>(file->read(header.u8, sizeof(header.u8)));
+	}
+	addBytesRead(info.header.size);
 	if (info.header.size == 0) {
 		// Read error.
 		return nullptr;
@@ -613,53 +1154,134 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 	{
 		// Dreamcast .VMI+.VMS pair.
 		// Attempt to open the other file in the pair.
-		RomData *romData = RomDataFactoryPrivate::openDreamcastVMSandVMI(file);
-		if (romData) {
-			if (romData->isValid()) {
-				// .VMI+.VMS pair opened.
-				return romData;
-			}
-			// Not a .VMI+.VMS pair.
-			romData->unref();
+		RomData *const romData = openDreamcastVMSandVMI(file, pIdInfo);
+		if (romData || (pIdInfo && pIdInfo->className)) {
+			// .VMI+.VMS pair opened.
+			return romData;
 		}
 
 		// Not a .VMI+.VMS pair.
 	}
 
+	// If requested, check RomData subclasses that support
+	// this file extension first.
+	const vector<const RomDataFns*> *pHints = nullptr;
+	if (extHint && info.ext != nullptr) {
+		pthread_once(&once_exts, init_supportedFileExtensions);
+		string ext_lower = info.ext;
+		std::transform(ext_lower.begin(), ext_lower.end(), ext_lower.begin(), ::tolower);
+		auto iter = map_extHints.find(ext_lower);
+		if (iter != map_extHints.end()) {
+			pHints = &iter->second;
+		}
+	}
+	if (pHints) {
+		pfnIsRomSupported_t pfnLastChecked = nullptr;
+		for (const RomDataFns *fns : *pHints) {
+			if ((fns->attrs & attrs) != attrs) {
+				// This RomData subclass doesn't have the
+				// required attributes.
+				continue;
+			}
+
+			if (fns->size != 0) {
+				// romDataFns_magic[] entry: Check the magic number first.
+				if (fns->address + sizeof(uint32_t) > info.header.size ||
+				    be32_to_cpu(pHeader32[fns->address/4]) != fns->size)
+				{
+					continue;
+				}
+			}
+			if (fns->isRomSupported == pfnLastChecked) {
+				// Already checked this class.
+				continue;
+			}
+			pfnLastChecked = fns->isRomSupported;
+
+			RomData *const romData = tryRomDataFns(fns, file, &info, pIdInfo);
+			if (romData || (pIdInfo && pIdInfo->className)) {
+				// RomData subclass obtained.
+				return romData;
+			}
+		}
+	}
+
+	// Was a table entry already checked by the extension hints?
+	auto wasHinted = [pHints](const RomDataFns *fns) -> bool {
+		return (pHints && std::find(pHints->cbegin(), pHints->cend(), fns) != pHints->cend());
+	};
+
 	// Check RomData subclasses that take a header at 0
 	// and definitely have a 32-bit magic number in the header.
-	const RomDataFactoryPrivate::RomDataFns *fns =
-		&RomDataFactoryPrivate::romDataFns_magic[0];
-	for (; fns->supportedFileExtensions != nullptr; fns++) {
+	// The dispatch index is used to find matching entries
+	// without checking every entry in romDataFns_magic[].
+	pthread_once(&once_magic, init_magicIndex);
+	uint8_t magic_idx[16];
+	unsigned int magic_idx_count = 0;
+	for (const uint32_t address : vec_magic_addrs) {
+		if (address + sizeof(uint32_t) > info.header.size) {
+			// Addresses are sorted, so none of the
+			// remaining addresses will fit, either.
+			break;
+		}
+
+		const uint64_t key = (static_cast<uint64_t>(address) << 32) |
+			be32_to_cpu(pHeader32[address/4]);
+		auto iter = map_magic.find(key);
+		if (iter == map_magic.end())
+			continue;
+
+		for (const uint8_t idx : iter->second) {
+			assert(magic_idx_count < ARRAY_SIZE(magic_idx));
+			if (magic_idx_count >= ARRAY_SIZE(magic_idx))
+				break;
+			magic_idx[magic_idx_count++] = idx;
+		}
+	}
+
+	// Check the matching entries in table order.
+	std::sort(&magic_idx[0], &magic_idx[magic_idx_count]);
+	const RomDataFns *fns;
+	pfnIsRomSupported_t pfnLastChecked = nullptr;
+	for (unsigned int i = 0; i < magic_idx_count; i++) {
+		fns = &romDataFns_magic[magic_idx[i]];
 		if ((fns->attrs & attrs) != attrs) {
 			// This RomData subclass doesn't have the
 			// required attributes.
 			continue;
 		}
+		if (fns->isRomSupported == pfnLastChecked) {
+			// Already checked this class with a different
+			// magic number or address.
+			// NOTE: This requires all entries for a given
+			// class to be adjacent in romDataFns_magic[].
+			continue;
+		}
+		pfnLastChecked = fns->isRomSupported;
+		if (wasHinted(fns)) {
+			// Already checked by the extension hints.
+			continue;
+		}
 
-		// Check the magic number.
-		// TODO: Verify alignment restrictions.
-		assert(fns->address % 4 == 0);
-		assert(fns->address + sizeof(uint32_t) <= sizeof(header.u32));
-		uint32_t magic = header.u32[fns->address/4];
-		if (be32_to_cpu(magic) == fns->size) {
-			// Found a matching magic number.
-			if (fns->isRomSupported(&info) >= 0) {
-				RomData *const romData = fns->newRomData(file);
-				if (romData->isValid()) {
-					// RomData subclass obtained.
-					return romData;
-				}
-
-				// Not actually supported.
-				romData->unref();
-			}
+		// Found a matching magic number.
+		RomData *const romData = tryRomDataFns(fns, file, &info, pIdInfo);
+		if (romData || (pIdInfo && pIdInfo->className)) {
+			// RomData subclass obtained.
+			return romData;
 		}
 	}
 
 	// Check for supported textures.
-	{
-		// TODO: RpTextureWrapper::isRomSupported()?
+	// NOTE: Devices are never textures.
+	if (!file->isDevice() && RpTextureWrapper::isRomSupported_static(&info) >= 0) {
+		if (pIdInfo) {
+			// Identify only.
+			pIdInfo->className = "RpTextureWrapper";
+			pIdInfo->romType = 0;
+			pIdInfo->attrs = ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA;
+			return nullptr;
+		}
+
 		RomData *const romData = new RpTextureWrapper(file);
 		if (romData->isValid()) {
 			// RomData subclass obtained.
@@ -672,8 +1294,10 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 
 	// Check other RomData subclasses that take a header,
 	// but don't have a simple 32-bit magic number check.
-	fns = &RomDataFactoryPrivate::romDataFns_header[0];
+	fns = &romDataFns_header[0];
 	bool checked_exts = false;
+	ao::uvector<uint8_t> probeBuf;
+	vector<uint32_t> probeReadSizes;
 	for (; fns->supportedFileExtensions != nullptr; fns++) {
 		if ((fns->attrs & attrs) != attrs) {
 			// This RomData subclass doesn't have the
@@ -724,14 +1348,11 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 				checked_exts = true;
 			}
 
-			// Read the new header data.
-
 			// NOTE: fns->size == 0 is only correct
 			// for headers located at 0, since we
 			// read the whole 4096+256 bytes for these.
 			assert(fns->size != 0);
-			assert(fns->size <= sizeof(header));
-			if (fns->size == 0 || fns->size > sizeof(header))
+			if (fns->size == 0)
 				continue;
 
 			// Make sure the file is big enough to
@@ -739,34 +1360,43 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 			if ((static_cast<off64_t>(fns->address) + fns->size) > info.szFile)
 				continue;
 
-			// Read the header data.
-			info.header.addr = fns->address;
-			int ret = file->seek(info.header.addr);
-			if (ret != 0)
-				continue;
-			info.header.size = static_cast<uint32_t>(file->read(header.u8, fns->size));
-			if (info.header.size != fns->size)
-				continue;
-		}
-
-		if (fns->isRomSupported(&info) >= 0) {
-			RomData *romData;
-			if (fns->attrs & RDA_CHECK_ISO) {
-				// Check for a game-specific ISO subclass.
-				romData = RomDataFactoryPrivate::checkISO(file);
-			} else {
-				// Standard RomData subclass.
-				romData = fns->newRomData(file);
+			// Read all of the non-zero header ranges at once.
+			// This reduces the number of seeks and reads, which
+			// matters for e.g. network file systems.
+			if (probeReadSizes.empty()) {
+				readProbeRanges(file, probeBuf, probeReadSizes);
 			}
 
-			if (romData) {
-				if (romData->isValid()) {
-					// RomData subclass obtained.
-					return romData;
+			// Find the probe range that contains this header.
+			const uint8_t *pData = nullptr;
+			for (size_t i = 0; i < vec_probeRanges.size(); i++) {
+				const ProbeRange &range = vec_probeRanges[i];
+				if (fns->address < range.addr || fns->address >= range.addr + range.size)
+					continue;
+
+				const uint32_t offset = fns->address - range.addr;
+				if (offset + fns->size <= probeReadSizes[i]) {
+					pData = &probeBuf[range.buf_offset + offset];
 				}
-				// Not actually supported.
-				romData->unref();
+				break;
 			}
+			if (!pData)
+				continue;
+
+			info.header.addr = fns->address;
+			info.header.size = fns->size;
+			info.header.pData = pData;
+		}
+
+		if (wasHinted(fns)) {
+			// Already checked by the extension hints.
+			continue;
+		}
+
+		RomData *const romData = tryRomDataFns(fns, file, &info, pIdInfo);
+		if (romData || (pIdInfo && pIdInfo->className)) {
+			// RomData subclass obtained.
+			return romData;
 		}
 	}
 
@@ -777,8 +1407,10 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 		return nullptr;
 	}
 
+	// The footer is read once and shared by all footer classes.
 	bool readFooter = false;
-	fns = &RomDataFactoryPrivate::romDataFns_footer[0];
+	ao::uvector<uint8_t> footerBuf;
+	fns = &romDataFns_footer[0];
 	for (; fns->supportedFileExtensions != nullptr; fns++) {
 		if ((fns->attrs & attrs) != attrs) {
 			// This RomData subclass doesn't have the
@@ -816,10 +1448,28 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 
 		// Make sure we've read the footer.
 		if (!readFooter) {
-			static const int footer_size = 1024;
-			if (info.szFile > footer_size) {
-				info.header.addr = static_cast<uint32_t>(info.szFile - footer_size);
-				info.header.size = static_cast<uint32_t>(file->seekAndRead(info.header.addr, header.u8, footer_size));
+			const uint32_t footer_size = footerSize();
+			// If the whole file is already in the header buffer,
+			// we don't need to read anything.
+			if (info.szFile > footer_size || info.header.addr != 0 ||
+			    info.header.size < info.szFile)
+			{
+				uint8_t *pBuf = header.u8;
+				if (footer_size > sizeof(header.u8)) {
+					footerBuf.resize(footer_size);
+					pBuf = footerBuf.data();
+				}
+
+				uint32_t size = footer_size;
+				if (info.szFile > footer_size) {
+					info.header.addr = static_cast<uint32_t>(info.szFile - footer_size);
+				} else {
+					info.header.addr = 0;
+					size = static_cast<uint32_t>(info.szFile);
+				}
+				info.header.pData = pBuf;
+				info.header.size = static_cast<uint32_t>(file->seekAndRead(info.header.addr, pBuf, size));
+				addBytesRead(info.header.size);
 				if (info.header.size == 0) {
 					// Seek and/or read error.
 					return nullptr;
@@ -828,15 +1478,10 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 			readFooter = true;
 		}
 
-		if (fns->isRomSupported(&info) >= 0) {
-			RomData *const romData = fns->newRomData(file);
-			if (romData->isValid()) {
-				// RomData subclass obtained.
-				return romData;
-			}
-
-			// Not actually supported.
-			romData->unref();
+		RomData *const romData = tryRomDataFns(fns, file, &info, pIdInfo);
+		if (romData || (pIdInfo && pIdInfo->className)) {
+			// RomData subclass obtained.
+			return romData;
 		}
 	}
 
@@ -844,6 +1489,409 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 	return nullptr;
 }
 
+/** RomDataFactory **/
+
+/**
+ * Create a RomData subclass for the specified ROM file.
+ *
+ * NOTE: RomData::isValid() is checked before returning a
+ * created RomData instance, so returned objects can be
+ * assumed to be valid as long as they aren't nullptr.
+ *
+ * If imgbf is non-zero, at least one of the specified image
+ * types must be supported by the RomData subclass in order to
+ * be returned.
+ *
+ * @param file ROM file.
+ * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @return RomData subclass, or nullptr if the ROM isn't supported.
+ */
+RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
+{
+	RP_TRACE_SCOPE("RomDataFactory::create");
+
+	// Get the file identity if any of the caches were requested.
+	// NOTE: The cache keys don't include create() flags.
+	FileSystem::FileIdentity id;
+	string filename;
+	bool haveId = false;
+	const bool useNegCache = !!(attrs & RDA_NEG_CACHE);
+	const bool useCache = !!(attrs & RDA_CACHE);
+	const bool useParsedCache = (attrs & RDA_PARSED_CACHE) && ParsedResultCache::isEnabled();
+	attrs &= ~(RDA_NEG_CACHE | RDA_CACHE | RDA_PARSED_CACHE);
+	if ((useNegCache || useCache || useParsedCache) && !file->isDevice()) {
+		filename = file->filename();
+		haveId = (!filename.empty() &&
+			FileSystem::get_file_identity(filename, &id) == 0);
+	}
+	const unsigned int keyAttrs = attrs & ~RDA_EXT_HINT;
+
+	if (haveId && useCache) {
+		// Check the in-process RomData cache.
+		RomData *const romData = RomDataCache::lookup(id, keyAttrs);
+		if (romData) {
+			return romData;
+		}
+	}
+	if (haveId && useParsedCache) {
+		// Check the persistent parsed-result cache.
+		RomData *const romData = ParsedResultCache::lookup(id, filename.c_str(), keyAttrs);
+		if (romData) {
+			return romData;
+		}
+	}
+	if (haveId && useNegCache && NegativeDetectCache::isUnsupported(id, filename.c_str(), keyAttrs)) {
+		// File is known to be unsupported.
+		return nullptr;
+	}
+
+	RomData *const romData = RomDataFactoryPrivate::detect(file, attrs, nullptr);
+	if (haveId) {
+		if (romData) {
+			if (useCache) {
+				RomDataCache::add(id, keyAttrs, romData);
+			}
+			if (useParsedCache) {
+				ParsedResultCache::store(id, filename.c_str(), keyAttrs, romData);
+			}
+		} else if (useNegCache && file->lastError() == 0) {
+			// Not supported, and not due to an I/O error.
+			NegativeDetectCache::addUnsupported(id, filename.c_str(), keyAttrs);
+		}
+	}
+	return romData;
+}
+
+/**
+ * Is a file known to be unsupported?
+ *
+ * This checks the persistent negative detection cache
+ * without opening the file. Use this before opening a
+ * file that will be passed to create() with RDA_NEG_CACHE.
+ *
+ * @param filename	[in] Filename (UTF-8)
+ * @param attrs		[in] RomDataAttr bitfield, as in create()
+ * @return True if the file is known to be unsupported; false if not.
+ */
+bool RomDataFactory::isKnownUnsupported(const char *filename, unsigned int attrs)
+{
+	assert(filename != nullptr);
+	if (!filename || filename[0] == '\0')
+		return false;
+
+	FileSystem::FileIdentity id;
+	if (FileSystem::get_file_identity(filename, &id) != 0)
+		return false;
+	return NegativeDetectCache::isUnsupported(id, filename, attrs & ~(RDA_EXT_HINT | RDA_NEG_CACHE | RDA_CACHE | RDA_PARSED_CACHE));
+}
+
+/**
+ * Can a file with the specified filename's extension be
+ * handled by a RomData subclass with the specified attributes?
+ *
+ * This only checks the extension, so the file isn't opened.
+ * A trailing ".gz" extension is ignored, since .gz files
+ * are decompressed transparently.
+ *
+ * This is intended as a fast-reject check for callers that
+ * need a specific attribute, e.g. RDA_HAS_DPOVERLAY.
+ *
+ * @param filename	[in] Filename (UTF-8)
+ * @param attrs		[in] RomDataAttr bitfield
+ * @return True if a RomData subclass with the specified attributes supports the extension.
+ */
+bool RomDataFactory::isExtensionSupported(const char *filename, unsigned int attrs)
+{
+	assert(filename != nullptr);
+	if (!filename || filename[0] == '\0')
+		return false;
+
+	string s_filename(filename);
+	const char *ext = FileSystem::file_ext(s_filename);
+	if (ext && !strcasecmp(ext, ".gz")) {
+		// Check the extension before ".gz".
+		s_filename.resize(ext - s_filename.c_str());
+		ext = FileSystem::file_ext(s_filename);
+	}
+	if (!ext || ext[0] == '\0')
+		return false;
+
+	string ext_lower(ext);
+	std::transform(ext_lower.begin(), ext_lower.end(), ext_lower.begin(), ::tolower);
+
+	// vec_exts is sorted by extension.
+	pthread_once(&RomDataFactoryPrivate::once_exts, RomDataFactoryPrivate::init_supportedFileExtensions);
+	const vector<ExtInfo> &vec_exts = RomDataFactoryPrivate::vec_exts;
+	auto iter = std::lower_bound(vec_exts.cbegin(), vec_exts.cend(), ext_lower.c_str(),
+		[](const ExtInfo &a, const char *b) {
+			return (strcmp(a.ext, b) < 0);
+		}
+	);
+	if (iter == vec_exts.cend() || strcmp(iter->ext, ext_lower.c_str()) != 0) {
+		// Extension is not supported.
+		return false;
+	}
+
+	// NOTE: Attributes are merged for all subclasses
+	// that support this extension.
+	attrs &= ~(RDA_EXT_HINT | RDA_NEG_CACHE | RDA_CACHE | RDA_PARSED_CACHE);
+	return ((iter->attrs & attrs) == attrs);
+}
+
+/**
+ * Identify the RomData subclass for the specified ROM file
+ * without constructing it.
+ *
+ * Only the isRomSupported_static() checks are run, so this is
+ * less accurate than create(): a subclass that passes the
+ * detection check might still fail to load the file.
+ *
+ * @param file		[in] ROM file.
+ * @param pIdInfo	[out] Identification information.
+ * @param attrs		[in] RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @return True if a RomData subclass was identified; false if not.
+ */
+bool RomDataFactory::identify(IRpFile *file, IdentifyInfo *pIdInfo, unsigned int attrs)
+{
+	assert(pIdInfo != nullptr);
+	if (!pIdInfo)
+		return false;
+
+	pIdInfo->className = nullptr;
+	pIdInfo->romType = -1;
+	pIdInfo->attrs = 0;
+	RomData *const romData = RomDataFactoryPrivate::detect(file, attrs, pIdInfo);
+	assert(romData == nullptr);
+	if (romData) {
+		romData->unref();
+	}
+	return (pIdInfo->className != nullptr);
+}
+
+/**
+ * Enable or disable detection statistics.
+ *
+ * Statistics can also be enabled by setting the RP_DETECT_STATS
+ * environment variable, in which case they will be printed
+ * to stderr when the process exits.
+ *
+ * @param enable True to enable; false to disable.
+ */
+void RomDataFactory::setDetectStatsEnabled(bool enable)
+{
+	pthread_once(&RomDataFactoryPrivate::once_stats, RomDataFactoryPrivate::init_stats);
+	ATOMIC_EXCHANGE(&RomDataFactoryPrivate::statsEnabled, (enable ? 1 : 0));
+}
+
+/**
+ * Print detection statistics.
+ * Entries are sorted by total time spent, in descending order.
+ * @param f Output file
+ */
+void RomDataFactory::printDetectStats(FILE *f)
+{
+	typedef std::pair<const RomDataFactoryPrivate::RomDataFns*, RomDataFactoryPrivate::DetectStats> stats_pair_t;
+	vector<stats_pair_t> vec_stats;
+	uint64_t bytesRead;
+	{
+		MutexLocker locker(RomDataFactoryPrivate::mtxStats);
+		vec_stats.assign(RomDataFactoryPrivate::map_stats.cbegin(), RomDataFactoryPrivate::map_stats.cend());
+		bytesRead = RomDataFactoryPrivate::statsBytesRead;
+	}
+
+	std::sort(vec_stats.begin(), vec_stats.end(),
+		[](const stats_pair_t &a, const stats_pair_t &b) {
+			return (a.second.probe_ns + a.second.ctor_ns) > (b.second.probe_ns + b.second.ctor_ns);
+		});
+
+	fprintf(f, "RomDataFactory detection statistics:\n");
+	fprintf(f, "%-20s %-8s %-10s %10s %10s %12s %12s\n",
+		"Class", "Address", "Magic", "Probes", "Hits", "Probe (us)", "Ctor (us)");
+	for (const stats_pair_t &p : vec_stats) {
+		const RomDataFactoryPrivate::RomDataFns *const fns = p.first;
+		const RomDataFactoryPrivate::DetectStats &stats = p.second;
+		fprintf(f, "%-20s %08X %08X   %10llu %10llu %12llu %12llu\n",
+			fns->className, fns->address, fns->size,
+			static_cast<unsigned long long>(stats.probes),
+			static_cast<unsigned long long>(stats.hits),
+			static_cast<unsigned long long>(stats.probe_ns / 1000),
+			static_cast<unsigned long long>(stats.ctor_ns / 1000));
+	}
+	fprintf(f, "Bytes read by RomDataFactory: %llu\n",
+		static_cast<unsigned long long>(bytesRead));
+}
+
+/**
+ * Get the detection statistics totals for all subclasses.
+ * Detection statistics must be enabled.
+ * @param pProbeNs	[out,opt] Total time spent in isRomSupported(), in nanoseconds.
+ * @param pCtorNs	[out,opt] Total time spent in constructors, in nanoseconds.
+ */
+void RomDataFactory::getDetectStatsTotals(uint64_t *pProbeNs, uint64_t *pCtorNs)
+{
+	uint64_t probe_ns = 0, ctor_ns = 0;
+	{
+		MutexLocker locker(RomDataFactoryPrivate::mtxStats);
+		for (const auto &p : RomDataFactoryPrivate::map_stats) {
+			probe_ns += p.second.probe_ns;
+			ctor_ns += p.second.ctor_ns;
+		}
+	}
+
+	if (pProbeNs) {
+		*pProbeNs = probe_ns;
+	}
+	if (pCtorNs) {
+		*pCtorNs = ctor_ns;
+	}
+}
+
+/**
+ * createBatch() range function for ThreadPool::parallelFor().
+ * @param param BatchJob
+ * @param begin First file index
+ * @param end One past the last file index
+ */
+void RomDataFactoryPrivate::batchRange(void *param, size_t begin, size_t end)
+{
+	BatchJob *const job = static_cast<BatchJob*>(param);
+
+#ifdef HAVE_IO_URING
+	if (job->filenames && end - begin > 1) {
+		// Read the headers of all files in this range at once.
+		// Detection will then be served from the page cache.
+		IoUring *const ring = IoUring::forThread();
+		if (ring) {
+			ring->prefetch(&(*job->filenames)[begin], end - begin, BATCH_PREFETCH_SIZE);
+		}
+	}
+#endif /* HAVE_IO_URING */
+
+	// NOTE: Files are processed using create(), since job->attrs
+	// may have cache flags that detect() doesn't handle.
+	for (size_t index = begin; index < end; index++) {
+		RomData *romData = nullptr;
+		if (job->filenames) {
+			RpFile *const file = new RpFile((*job->filenames)[index], RpFile::FM_OPEN_READ_GZ_MMAP);
+			if (file->isOpen()) {
+				romData = RomDataFactory::create(file, job->attrs);
+			}
+			file->unref();	// file is ref()'d by RomData.
+		} else {
+			IRpFile *const file = (*job->files)[index];
+			if (file && file->isOpen()) {
+				romData = RomDataFactory::create(file, job->attrs);
+			}
+		}
+
+		MutexLocker locker(job->mtxCallback);
+		job->callback(job->userdata, index, romData);
+	}
+}
+
+/**
+ * Run a createBatch() job.
+ * @param job BatchJob
+ * @param threads Number of threads (0 to use the process-wide thread pool)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomDataFactoryPrivate::runBatch(BatchJob &job, unsigned int threads)
+{
+	assert(job.callback != nullptr);
+	if (!job.callback)
+		return -EINVAL;
+	if (job.count == 0)
+		return 0;
+
+	// Use the process-wide thread pool unless a
+	// specific number of threads was requested.
+	// NOTE: The calling thread also processes files.
+	std::unique_ptr<ThreadPool> localPool;
+	ThreadPool *pool;
+	if (threads == 0) {
+		pool = ThreadPool::instance();
+		threads = pool->threadCount() + 1;
+	} else {
+		if (threads > job.count) {
+			threads = static_cast<unsigned int>(job.count);
+		}
+		if (threads > 1) {
+			localPool.reset(new ThreadPool(threads - 1));
+			threads = localPool->threadCount() + 1;
+		}
+		pool = localPool.get();
+	}
+	if (threads > job.count) {
+		threads = static_cast<unsigned int>(job.count);
+	}
+
+	// Don't claim so many files at once that some threads are left idle.
+	job.claimCount = 1;
+#ifdef HAVE_IO_URING
+	job.claimCount = std::min(BATCH_PREFETCH_COUNT, job.count / threads);
+#endif /* HAVE_IO_URING */
+
+	if (pool) {
+		pool->parallelFor(0, job.count, batchRange, &job, job.claimCount);
+	} else {
+		batchRange(&job, 0, job.count);
+	}
+	return 0;
+}
+
+/**
+ * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+ *
+ * Each file is opened with RpFile::FM_OPEN_READ_GZ_MMAP.
+ * This function blocks until all files have been processed.
+ *
+ * @param filenames	[in] ROM filenames (UTF-8)
+ * @param attrs		[in] RomDataAttr bitfield, as in create()
+ * @param threads	[in] Number of threads (0 to use the process-wide thread pool)
+ * @param callback	[in] Callback function
+ * @param userdata	[in] User data for the callback function
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomDataFactory::createBatch(const vector<string> &filenames, unsigned int attrs,
+	unsigned int threads, pfnBatchCallback_t callback, void *userdata)
+{
+	RomDataFactoryPrivate::BatchJob job;
+	job.filenames = &filenames;
+	job.files = nullptr;
+	job.attrs = attrs;
+	job.callback = callback;
+	job.userdata = userdata;
+	job.count = filenames.size();
+	return RomDataFactoryPrivate::runBatch(job, threads);
+}
+
+/**
+ * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+ *
+ * NOTE: Each IRpFile must be a separate object, since
+ * IRpFile objects are not safe to share between threads.
+ * This function blocks until all files have been processed.
+ *
+ * @param files		[in] ROM files
+ * @param attrs		[in] RomDataAttr bitfield, as in create()
+ * @param threads	[in] Number of threads (0 to use the process-wide thread pool)
+ * @param callback	[in] Callback function
+ * @param userdata	[in] User data for the callback function
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomDataFactory::createBatch(const vector<IRpFile*> &files, unsigned int attrs,
+	unsigned int threads, pfnBatchCallback_t callback, void *userdata)
+{
+	RomDataFactoryPrivate::BatchJob job;
+	job.filenames = nullptr;
+	job.files = &files;
+	job.attrs = attrs;
+	job.callback = callback;
+	job.userdata = userdata;
+	job.count = files.size();
+	return RomDataFactoryPrivate::runBatch(job, threads);
+}
+
 /**
  * Initialize the vector of supported file extensions.
  * Used for Win32 COM registration.
@@ -855,24 +1903,18 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
  */
 void RomDataFactoryPrivate::init_supportedFileExtensions(void)
 {
-	// In order to handle multiple RomData subclasses
-	// that support the same extensions, we're using
-	// an unordered_map<string, unsigned int>. If any of the
-	// handlers for a given extension support thumbnails,
-	// then the thumbnail handlers will be registered.
+	// Multiple RomData subclasses may support the same extensions.
+	// All extensions are added to vec_exts, which is then sorted
+	// and deduplicated in place. If any of the handlers for a given
+	// extension support thumbnails, then the thumbnail handlers
+	// will be registered.
 	//
-	// The actual data is stored in the vector<ExtInfo>.
-	unordered_map<string, unsigned int> map_exts;
-
-	static const size_t reserve_size =
-		(ARRAY_SIZE(romDataFns_magic) +
-		 ARRAY_SIZE(romDataFns_header) +
-		 ARRAY_SIZE(romDataFns_footer)) * 2;
-	vec_exts.reserve(reserve_size);
-#ifdef HAVE_UNORDERED_MAP_RESERVE
-	map_exts.reserve(reserve_size);
-#endif /* HAVE_UNORDERED_MAP_RESERVE */
+	// This avoids building a temporary hash table at runtime.
+	// The resulting vector is sorted by extension.
+	vector<const char*> vec_exts_fileFormat = FileFormatFactory::supportedFileExtensions();
 
+	// Count the extensions first so we only allocate once.
+	size_t count = vec_exts_fileFormat.size();
 	for (const RomDataFns *const *tblptr = &romDataFns_tbl[0];
 	     *tblptr != nullptr; tblptr++)
 	{
@@ -881,47 +1923,67 @@ void RomDataFactoryPrivate::init_supportedFileExtensions(void)
 			const char *const *sys_exts = fns->supportedFileExtensions();
 			if (!sys_exts)
 				continue;
+			for (; *sys_exts != nullptr; sys_exts++) {
+				count++;
+			}
+		}
+	}
+	vec_exts.reserve(count);
+
+	for (const RomDataFns *const *tblptr = &romDataFns_tbl[0];
+	     *tblptr != nullptr; tblptr++)
+	{
+		const RomDataFns *fns = *tblptr;
+		for (; fns->supportedFileExtensions != nullptr; fns++) {
+			const char *const *sys_exts = fns->supportedFileExtensions();
+			if (!sys_exts)
+				continue;
+
+			// Extension hints are only used for magic number
+			// classes and classes with a header at address 0.
+			const bool isHintable = (*tblptr != romDataFns_footer &&
+				fns->address == 0 && !(fns->attrs & ATTR_CHECK_ISO)) ||
+				(*tblptr == romDataFns_magic);
 
 			for (; *sys_exts != nullptr; sys_exts++) {
-				auto iter = map_exts.find(*sys_exts);
-				if (iter != map_exts.end()) {
-					// We already had this extension.
-					// Update its attributes.
-					iter->second |= fns->attrs;
-				} else {
-					// First time encountering this extension.
-					map_exts[*sys_exts] = fns->attrs;
-					vec_exts.emplace_back(RomDataFactory::ExtInfo(
-						*sys_exts, fns->attrs));
+				if (isHintable) {
+					string ext_lower = *sys_exts;
+					std::transform(ext_lower.begin(), ext_lower.end(), ext_lower.begin(), ::tolower);
+					vector<const RomDataFns*> &vec_hints = map_extHints[ext_lower];
+					if (std::find(vec_hints.cbegin(), vec_hints.cend(), fns) == vec_hints.cend()) {
+						vec_hints.emplace_back(fns);
+					}
 				}
+
+				vec_exts.emplace_back(RomDataFactory::ExtInfo(*sys_exts, fns->attrs));
 			}
 		}
 	}
 
 	// Get file extensions from FileFormatFactory.
 	static const unsigned int FFF_ATTRS = ATTR_HAS_THUMBNAIL | ATTR_HAS_METADATA;
-	vector<const char*> vec_exts_fileFormat = FileFormatFactory::supportedFileExtensions();
-	std::for_each(vec_exts_fileFormat.cbegin(), vec_exts_fileFormat.cend(),
-		[&map_exts](const char *ext) {
-			auto iter = map_exts.find(ext);
-			if (iter != map_exts.end()) {
-				// We already had this extension.
-				// Update its attributes.
-				iter->second |= FFF_ATTRS;
-			} else {
-				// First time encountering this extension.
-				map_exts[ext] = FFF_ATTRS;
-				vec_exts.emplace_back(RomDataFactory::ExtInfo(ext, FFF_ATTRS));
-			}
-		}
-	);
+	for (const char *ext : vec_exts_fileFormat) {
+		vec_exts.emplace_back(RomDataFactory::ExtInfo(ext, FFF_ATTRS));
+	}
 
-	// Make sure the vector's attributes fields are up to date.
-	std::for_each(vec_exts.begin(), vec_exts.end(),
-		[&map_exts](RomDataFactory::ExtInfo &extInfo) {
-			extInfo.attrs = map_exts[extInfo.ext];
+	// Sort the extensions, then merge duplicates.
+	std::sort(vec_exts.begin(), vec_exts.end(),
+		[](const RomDataFactory::ExtInfo &a, const RomDataFactory::ExtInfo &b) {
+			return (strcmp(a.ext, b.ext) < 0);
 		}
 	);
+	auto iter_out = vec_exts.begin();
+	for (auto iter = vec_exts.begin(); iter != vec_exts.end(); ++iter) {
+		if (iter_out != vec_exts.begin() && !strcmp((iter_out - 1)->ext, iter->ext)) {
+			// We already had this extension.
+			// Update its attributes.
+			(iter_out - 1)->attrs |= iter->attrs;
+		} else {
+			// First time encountering this extension.
+			*iter_out++ = *iter;
+		}
+	}
+	vec_exts.erase(iter_out, vec_exts.end());
 }
 
 /**
@@ -932,7 +1994,7 @@ void RomDataFactoryPrivate::init_supportedFileExtensions(void)
  * indicating if the file type handler supports thumbnails
  * and/or may have "dangerous" permissions.
  *
- * @return All supported file extensions, including the leading dot.
+ * @return All supported file extensions, including the leading dot, sorted by extension.
  */
 const vector<RomDataFactory::ExtInfo> &RomDataFactory::supportedFileExtensions(void)
 {
@@ -950,21 +2012,13 @@ void RomDataFactoryPrivate::init_supportedMimeTypes(void)
 {
 	// TODO: Add generic types, e.g. application/octet-stream?
 
-	// In order to handle multiple RomData subclasses
-	// that support the same MIME types, we're using
-	// an unordered_set<string>. The actual data
-	// is stored in the vector<const char*>.
-	unordered_set<string> set_mimeTypes;
-
-	static const size_t reserve_size =
-		(ARRAY_SIZE(romDataFns_magic) +
-		 ARRAY_SIZE(romDataFns_header) +
-		 ARRAY_SIZE(romDataFns_footer)) * 2;
-	vec_mimeTypes.reserve(reserve_size);
-#ifdef HAVE_UNORDERED_SET_RESERVE
-	set_mimeTypes.reserve(reserve_size);
-#endif /* HAVE_UNORDERED_SET_RESERVE */
+	// Multiple RomData subclasses may support the same MIME types.
+	// All MIME types are added to vec_mimeTypes, which is then
+	// sorted and deduplicated in place.
+	vector<const char*> vec_mimeTypes_fileFormat = FileFormatFactory::supportedMimeTypes();
 
+	// Count the MIME types first so we only allocate once.
+	size_t count = vec_mimeTypes_fileFormat.size();
 	for (const RomDataFns *const *tblptr = &romDataFns_tbl[0];
 	     *tblptr != nullptr; tblptr++)
 	{
@@ -973,35 +2027,48 @@ void RomDataFactoryPrivate::init_supportedMimeTypes(void)
 			const char *const *sys_mimeTypes = fns->supportedMimeTypes();
 			if (!sys_mimeTypes)
 				continue;
+			for (; *sys_mimeTypes != nullptr; sys_mimeTypes++) {
+				count++;
+			}
+		}
+	}
+	vec_mimeTypes.reserve(count);
 
+	for (const RomDataFns *const *tblptr = &romDataFns_tbl[0];
+	     *tblptr != nullptr; tblptr++)
+	{
+		const RomDataFns *fns = *tblptr;
+		for (; fns->supportedFileExtensions != nullptr; fns++) {
+			const char *const *sys_mimeTypes = fns->supportedMimeTypes();
+			if (!sys_mimeTypes)
+				continue;
 			for (; *sys_mimeTypes != nullptr; sys_mimeTypes++) {
-				auto iter = set_mimeTypes.find(*sys_mimeTypes);
-				if (iter == set_mimeTypes.end()) {
-					set_mimeTypes.insert(*sys_mimeTypes);
-					vec_mimeTypes.emplace_back(*sys_mimeTypes);
-				}
+				vec_mimeTypes.emplace_back(*sys_mimeTypes);
 			}
 		}
 	}
 
 	// Get MIME types from FileFormatFactory.
-	vector<const char*> vec_mimeTypes_fileFormat = FileFormatFactory::supportedMimeTypes();
-	std::for_each(vec_mimeTypes_fileFormat.cbegin(), vec_mimeTypes_fileFormat.cend(),
-		[&set_mimeTypes](const char *mimeType) {
-			auto iter = set_mimeTypes.find(mimeType);
-			if (iter == set_mimeTypes.end()) {
-				set_mimeTypes.insert(mimeType);
-				vec_mimeTypes.emplace_back(mimeType);
-			}
+	vec_mimeTypes.insert(vec_mimeTypes.end(),
+		vec_mimeTypes_fileFormat.cbegin(), vec_mimeTypes_fileFormat.cend());
+
+	// Sort the MIME types, then remove duplicates.
+	std::sort(vec_mimeTypes.begin(), vec_mimeTypes.end(),
+		[](const char *a, const char *b) {
+			return (strcmp(a, b) < 0);
 		}
 	);
+	vec_mimeTypes.erase(std::unique(vec_mimeTypes.begin(), vec_mimeTypes.end(),
+		[](const char *a, const char *b) {
+			return !strcmp(a, b);
+		}), vec_mimeTypes.end());
 }
 
 /**
  * Get all supported MIME types.
  * Used for KFileMetaData.
  *
- * @return All supported MIME types.
+ * @return All supported MIME types, sorted.
  */
 const vector<const char*> &RomDataFactory::supportedMimeTypes(void)
 {
@@ -11,7 +11,12 @@
 
 #include "common.h"
 
+// C includes.
+#include <stdint.h>
+#include <stdio.h>
+
 // C++ includes.
+#include <string>
 #include <vector>
 
 namespace LibRpBase {
@@ -56,6 +61,40 @@ class RomDataFactory
 			// Check for game-specific disc file systems.
 			// (For internal RomDataFactory use only.)
 			RDA_CHECK_ISO		= (1U << 8),
+
+			// Try RomData subclasses that support the file's
+			// extension before checking all subclasses.
+			// (This is a create() flag, not a subclass attribute.)
+			RDA_EXT_HINT		= (1U << 16),
+
+			// Use the persistent negative detection cache.
+			// If the file is known to be unsupported, create()
+			// returns nullptr without reading it. If the file
+			// isn't supported, it's added to the cache.
+			// (This is a create() flag, not a subclass attribute.)
+			RDA_NEG_CACHE		= (1U << 17),
+
+			// Use the in-process RomData cache.
+			// If the file was recently opened in this process,
+			// create() returns the same RomData object instead
+			// of parsing the file again. RomData objects returned
+			// with this flag may be shared, so they must not be
+			// close()'d by the caller. A cached object is only
+			// returned if no one else is using it, but it must
+			// not be used from more than one thread at a time.
+			// (This is a create() flag, not a subclass attribute.)
+			RDA_CACHE		= (1U << 18),
+
+			// Use the persistent parsed-result cache, if it's
+			// enabled in the configuration. If the file was parsed
+			// before, create() returns a CachedRomData object that
+			// serves the cached fields, metadata, and internal
+			// images without reading the file. Otherwise, the
+			// file is parsed and the result is added to the cache.
+			// CachedRomData objects don't have an open file, so
+			// external images and ROM operations aren't available.
+			// (This is a create() flag, not a subclass attribute.)
+			RDA_PARSED_CACHE	= (1U << 19),
 		};
 
 		/**
@@ -69,12 +108,153 @@ class RomDataFactory
 		 * types must be supported by the RomData subclass in order to
 		 * be returned.
 		 *
+		 * If RDA_EXT_HINT is set, RomData subclasses that support
+		 * the file's extension are checked first. If none of them
+		 * support the file, all other subclasses are checked.
+		 *
+		 * If RDA_CACHE is set, the returned RomData object might
+		 * have been created from a different IRpFile for the
+		 * same file. RomData objects aren't thread-safe, so an
+		 * object returned with RDA_CACHE must not be used from
+		 * more than one thread, and it must not be passed to
+		 * another thread while it's still in use.
+		 *
+		 * If RDA_PARSED_CACHE is set, the returned RomData object
+		 * might be a CachedRomData object that doesn't use the file.
+		 *
 		 * @param file ROM file.
 		 * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
 		 * @return RomData subclass, or nullptr if the ROM isn't supported.
 		 */
 		static LibRpBase::RomData *create(LibRpFile::IRpFile *file, unsigned int attrs = 0);
 
+		/**
+		 * Is a file known to be unsupported?
+		 *
+		 * This checks the persistent negative detection cache
+		 * without opening the file. Use this before opening a
+		 * file that will be passed to create() with RDA_NEG_CACHE.
+		 *
+		 * @param filename	[in] Filename (UTF-8)
+		 * @param attrs		[in] RomDataAttr bitfield, as in create()
+		 * @return True if the file is known to be unsupported; false if not.
+		 */
+		static bool isKnownUnsupported(const char *filename, unsigned int attrs = 0);
+
+		/**
+		 * Can a file with the specified filename's extension be
+		 * handled by a RomData subclass with the specified attributes?
+		 *
+		 * This only checks the extension, so the file isn't opened.
+		 * A trailing ".gz" extension is ignored, since .gz files
+		 * are decompressed transparently.
+		 *
+		 * This is intended as a fast-reject check for callers that
+		 * need a specific attribute, e.g. RDA_HAS_DPOVERLAY.
+		 *
+		 * @param filename	[in] Filename (UTF-8)
+		 * @param attrs		[in] RomDataAttr bitfield
+		 * @return True if a RomData subclass with the specified attributes supports the extension.
+		 */
+		static bool isExtensionSupported(const char *filename, unsigned int attrs = 0);
+
+		/**
+		 * RomData subclass identification information.
+		 */
+		struct IdentifyInfo {
+			const char *className;	// RomData subclass name, or nullptr if not identified.
+			int romType;		// Class-specific ROM type, as returned by isRomSupported_static().
+			unsigned int attrs;	// RomDataAttr bitfield for the subclass.
+		};
+
+		/**
+		 * Identify the RomData subclass for the specified ROM file
+		 * without constructing it.
+		 *
+		 * Only the isRomSupported_static() checks are run, so this is
+		 * less accurate than create(): a subclass that passes the
+		 * detection check might still fail to load the file.
+		 *
+		 * @param file		[in] ROM file.
+		 * @param pIdInfo	[out] Identification information.
+		 * @param attrs		[in] RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+		 * @return True if a RomData subclass was identified; false if not.
+		 */
+		static bool identify(LibRpFile::IRpFile *file, IdentifyInfo *pIdInfo, unsigned int attrs = 0);
+
+		/**
+		 * Enable or disable detection statistics.
+		 *
+		 * Statistics can also be enabled by setting the RP_DETECT_STATS
+		 * environment variable, in which case they will be printed
+		 * to stderr when the process exits.
+		 *
+		 * @param enable True to enable; false to disable.
+		 */
+		static void setDetectStatsEnabled(bool enable);
+
+		/**
+		 * Print detection statistics.
+		 * Entries are sorted by total time spent, in descending order.
+		 * @param f Output file
+		 */
+		static void printDetectStats(FILE *f);
+
+		/**
+		 * Get the detection statistics totals for all subclasses.
+		 * Detection statistics must be enabled.
+		 * @param pProbeNs	[out,opt] Total time spent in isRomSupported(), in nanoseconds.
+		 * @param pCtorNs	[out,opt] Total time spent in constructors, in nanoseconds.
+		 */
+		static void getDetectStatsTotals(uint64_t *pProbeNs, uint64_t *pCtorNs);
+
+		/**
+		 * Callback for createBatch().
+		 *
+		 * This is called from a worker thread as each file is processed.
+		 * Calls are serialized, so the callback does not need to be
+		 * reentrant, but it should return quickly.
+		 *
+		 * @param userdata	[in] User data specified in createBatch().
+		 * @param index		[in] Index of the file in the input list.
+		 * @param romData	[in] RomData subclass, or nullptr if the ROM isn't supported. (Callback must unref() it.)
+		 */
+		typedef void (*pfnBatchCallback_t)(void *userdata, size_t index, LibRpBase::RomData *romData);
+
+		/**
+		 * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+		 * The calling thread also processes files.
+		 *
+		 * Each file is opened with RpFile::FM_OPEN_READ_GZ_MMAP.
+		 * This function blocks until all files have been processed.
+		 *
+		 * @param filenames	[in] ROM filenames (UTF-8)
+		 * @param attrs		[in] RomDataAttr bitfield, as in create()
+		 * @param threads	[in] Number of threads (0 to use the process-wide thread pool)
+		 * @param callback	[in] Callback function
+		 * @param userdata	[in] User data for the callback function
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int createBatch(const std::vector<std::string> &filenames, unsigned int attrs,
+			unsigned int threads, pfnBatchCallback_t callback, void *userdata);
+
+		/**
+		 * Create RomData subclasses for multiple ROM files using a pool of worker threads.
+		 *
+		 * NOTE: Each IRpFile must be a separate object, since
+		 * IRpFile objects are not safe to share between threads.
+		 * This function blocks until all files have been processed.
+		 *
+		 * @param files		[in] ROM files
+		 * @param attrs		[in] RomDataAttr bitfield, as in create()
+		 * @param threads	[in] Number of threads (0 to use the process-wide thread pool)
+		 * @param callback	[in] Callback function
+		 * @param userdata	[in] User data for the callback function
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int createBatch(const std::vector<LibRpFile::IRpFile*> &files, unsigned int attrs,
+			unsigned int threads, pfnBatchCallback_t callback, void *userdata);
+
 		struct ExtInfo {
 			const char *ext;
 			unsigned int attrs;
@@ -93,7 +273,7 @@ class RomDataFactory
 		 * indicating if the file type handler supports thumbnails
 		 * and/or may have "dangerous" permissions.
 		 *
-		 * @return All supported file extensions, including the leading dot.
+		 * @return All supported file extensions, including the leading dot, sorted by extension.
 		 */
 		static const std::vector<ExtInfo> &supportedFileExtensions(void);
 
@@ -101,7 +281,7 @@ class RomDataFactory
 		 * Get all supported MIME types.
 		 * Used for KFileMetaData.
 		 *
-		 * @return All supported MIME types.
+		 * @return All supported MIME types, sorted.
 		 */
 		static const std::vector<const char*> &supportedMimeTypes(void);
 };
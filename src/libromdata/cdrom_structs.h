@@ -17,6 +17,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include "common.h"
 
 #ifdef __cplusplus
@@ -172,6 +173,22 @@ static inline const uint8_t *cdromSectorDataPtr(const CDROM_2352_Sector_t *secto
 		: sector->m1.data);
 }
 
+/**
+ * Copy the user data sections of consecutive raw CD-ROM sectors.
+ * Each sector's mode is checked separately.
+ * @param dest Destination buffer. (Must be at least count * 2048 bytes!)
+ * @param src Raw CD-ROM sectors.
+ * @param physBlockSize Physical sector size. (2352 or 2448)
+ * @param count Number of sectors.
+ */
+static inline void cdromCopySectorData(uint8_t *dest, const uint8_t *src,
+	unsigned int physBlockSize, unsigned int count)
+{
+	for (; count > 0; count--, dest += 2048, src += physBlockSize) {
+		memcpy(dest, cdromSectorDataPtr((const CDROM_2352_Sector_t*)src), 2048);
+	}
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -179,16 +179,12 @@ int CtrKeyScrambler::CtrScramble(u128_t *keyNormal,
 	}
 
 	// Load the key scrambler constant.
-	KeyManager *const keyManager = KeyManager::instance();
-	if (!keyManager) {
-		// Unable to initialize the KeyManager.
-		return -EIO;
-	}
-
+	// NOTE: N3DSVerifyKeys caches the verification result,
+	// since this is called for every NCCH that's opened.
 	KeyManager::KeyData_t keyData;
-	KeyManager::VerifyResult res = keyManager->getAndVerify(
+	KeyManager::VerifyResult res = N3DSVerifyKeys::getAndVerify(
 		CtrKeyScramblerPrivate::EncryptionKeyNames[Key_Ctr_Scrambler], &keyData,
-		CtrKeyScramblerPrivate::EncryptionKeyVerifyData[Key_Ctr_Scrambler], 16);
+		CtrKeyScramblerPrivate::EncryptionKeyVerifyData[Key_Ctr_Scrambler]);
 	if (res != KeyManager::VerifyResult::OK) {
 		// Key error.
 		// TODO: Return the key error?
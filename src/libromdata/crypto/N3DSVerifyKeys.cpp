@@ -16,6 +16,11 @@ using LibRpBase::IAesCipher;
 using LibRpBase::AesCipherFactory;
 using LibRpBase::KeyManager;
 
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
 // libromdata
 #include "CtrKeyScrambler.hpp"
 
@@ -24,6 +29,147 @@ using std::unique_ptr;
 
 namespace LibRomData {
 
+namespace N3DSVerifyKeysPrivate {
+
+// Cache of keys that have been verified.
+// NCCH keys are loaded for every content in a CIA and every
+// partition in a CCI, and verifying a key requires an AES
+// key schedule and decryption. Entries are keyed by the key
+// value, so changes to keys.conf don't need to be tracked.
+struct VerifiedKey {
+	uint8_t key[32];
+	uint8_t verifyData[16];
+	unsigned int length;
+};
+static const unsigned int MAX_VERIFIED_KEYS = 32;
+static VerifiedKey verifiedKeys[MAX_VERIFIED_KEYS];
+static unsigned int verifiedKeyCount = 0;
+static unsigned int verifiedKeyNext = 0;	// Next entry to replace if the cache is full
+static Mutex mtxVerifiedKeys;
+
+/**
+ * Verify a key using the verification test data.
+ * Successful verifications are cached.
+ * @param pKey		[in] Key data.
+ * @param length	[in] Key length. (16, 24, or 32)
+ * @param pVerifyData	[in] Verification data. (16 bytes)
+ * @return VerifyResult.
+ */
+static KeyManager::VerifyResult verifyKey(const uint8_t *pKey, unsigned int length, const uint8_t *pVerifyData)
+{
+	if (length != 16 && length != 24 && length != 32) {
+		// Key length is invalid.
+		return KeyManager::VerifyResult::KeyInvalid;
+	}
+
+	{
+		MutexLocker mtxLocker(mtxVerifiedKeys);
+		for (unsigned int i = 0; i < verifiedKeyCount; i++) {
+			const VerifiedKey &entry = verifiedKeys[i];
+			if (entry.length == length &&
+			    !memcmp(entry.key, pKey, length) &&
+			    !memcmp(entry.verifyData, pVerifyData, sizeof(entry.verifyData)))
+			{
+				// Key was already verified.
+				return KeyManager::VerifyResult::OK;
+			}
+		}
+	}
+
+	// TODO: Make this a function in KeyManager, and share it
+	// with KeyManager::getAndVerify().
+	unique_ptr<IAesCipher> cipher(AesCipherFactory::create());
+	if (!cipher) {
+		// Unable to create the IAesCipher.
+		return KeyManager::VerifyResult::IAesCipherInitErr;
+	}
+	// Set cipher parameters.
+	int ret = cipher->setChainingMode(IAesCipher::ChainingMode::ECB);
+	if (ret != 0) {
+		return KeyManager::VerifyResult::IAesCipherInitErr;
+	}
+	ret = cipher->setKey(pKey, length);
+	if (ret != 0) {
+		return KeyManager::VerifyResult::IAesCipherInitErr;
+	}
+
+	// Decrypt the test data.
+	// NOTE: IAesCipher decrypts in place, so we need to
+	// make a temporary copy.
+	uint8_t tmpData[16];
+	memcpy(tmpData, pVerifyData, sizeof(tmpData));
+	size_t size = cipher->decrypt(tmpData, sizeof(tmpData));
+	if (size != 16) {
+		// Decryption failed.
+		return KeyManager::VerifyResult::IAesCipherDecryptErr;
+	}
+
+	// Verify the test data.
+	if (memcmp(tmpData, KeyManager::verifyTestString, sizeof(tmpData)) != 0) {
+		// Verification failed.
+		return KeyManager::VerifyResult::WrongKey;
+	}
+
+	// Add the key to the cache.
+	MutexLocker mtxLocker(mtxVerifiedKeys);
+	VerifiedKey *entry;
+	if (verifiedKeyCount < MAX_VERIFIED_KEYS) {
+		entry = &verifiedKeys[verifiedKeyCount++];
+	} else {
+		entry = &verifiedKeys[verifiedKeyNext];
+		verifiedKeyNext = (verifiedKeyNext + 1) % MAX_VERIFIED_KEYS;
+	}
+	memcpy(entry->key, pKey, length);
+	memcpy(entry->verifyData, pVerifyData, sizeof(entry->verifyData));
+	entry->length = length;
+	return KeyManager::VerifyResult::OK;
+}
+
+}
+
+/**
+ * Get and verify a key from KeyManager.
+ *
+ * Same as KeyManager::getAndVerify(), but successful
+ * verifications are cached, so each key is only
+ * verified once per process.
+ *
+ * @param keyName	[in] Encryption key name.
+ * @param pKeyData	[out] Key data struct.
+ * @param pVerifyData	[in] Verification data block. (16 bytes)
+ * @return VerifyResult.
+ */
+KeyManager::VerifyResult N3DSVerifyKeys::getAndVerify(const char *keyName,
+	KeyManager::KeyData_t *pKeyData, const uint8_t *pVerifyData)
+{
+	assert(keyName != nullptr);
+	assert(pKeyData != nullptr);
+	assert(pVerifyData != nullptr);
+	if (!keyName || !pKeyData || !pVerifyData) {
+		// Invalid parameters.
+		return KeyManager::VerifyResult::InvalidParams;
+	}
+
+	KeyManager *const keyManager = KeyManager::instance();
+	assert(keyManager != nullptr);
+	if (!keyManager) {
+		// TODO: Some other error?
+		return KeyManager::VerifyResult::KeyDBError;
+	}
+
+	// Get the key first.
+	KeyManager::VerifyResult res = keyManager->get(keyName, pKeyData);
+	if (res != KeyManager::VerifyResult::OK) {
+		// Error obtaining the key.
+		return res;
+	} else if (!pKeyData->key || pKeyData->length == 0) {
+		// Key is invalid.
+		return KeyManager::VerifyResult::KeyInvalid;
+	}
+
+	return N3DSVerifyKeysPrivate::verifyKey(pKeyData->key, pKeyData->length, pVerifyData);
+}
+
 /**
  * Attempt to load an AES normal key.
  * @param pKeyOut		[out] Output key data.
@@ -62,9 +208,7 @@ KeyManager::VerifyResult N3DSVerifyKeys::loadKeyNormal(u128_t *pKeyOut,
 	if (keyNormal_name) {
 		KeyManager::KeyData_t keyNormal_data;
 		if (keyNormal_verify) {
-			res = keyManager->getAndVerify(
-				keyNormal_name, &keyNormal_data,
-				keyNormal_verify, 16);
+			res = getAndVerify(keyNormal_name, &keyNormal_data, keyNormal_verify);
 		} else {
 			res = keyManager->get(keyNormal_name, &keyNormal_data);
 		}
@@ -97,9 +241,7 @@ KeyManager::VerifyResult N3DSVerifyKeys::loadKeyNormal(u128_t *pKeyOut,
 
 	// Load KeyX.
 	if (keyX_verify) {
-		res = keyManager->getAndVerify(
-			keyX_name, &keyX_data,
-			keyX_verify, 16);
+		res = getAndVerify(keyX_name, &keyX_data, keyX_verify);
 	} else {
 		res = keyManager->get(keyX_name, &keyX_data);
 	}
@@ -111,9 +253,7 @@ KeyManager::VerifyResult N3DSVerifyKeys::loadKeyNormal(u128_t *pKeyOut,
 
 	// Load KeyY.
 	if (keyY_verify) {
-		res = keyManager->getAndVerify(
-			keyY_name, &keyY_data,
-			keyY_verify, 16);
+		res = getAndVerify(keyY_name, &keyY_data, keyY_verify);
 	} else {
 		res = keyManager->get(keyY_name, &keyY_data);
 	}
@@ -134,38 +274,9 @@ KeyManager::VerifyResult N3DSVerifyKeys::loadKeyNormal(u128_t *pKeyOut,
 
 	if (keyNormal_verify) {
 		// Verify the generated Normal key.
-		// TODO: Make this a function in KeyManager, and share it
-		// with KeyManager::getAndVerify().
-		unique_ptr<IAesCipher> cipher(AesCipherFactory::create());
-		if (!cipher) {
-			// Unable to create the IAesCipher.
-			return KeyManager::VerifyResult::IAesCipherInitErr;
-		}
-		// Set cipher parameters.
-		ret = cipher->setChainingMode(IAesCipher::ChainingMode::ECB);
-		if (ret != 0) {
-			return KeyManager::VerifyResult::IAesCipherInitErr;
-		}
-		ret = cipher->setKey(pKeyOut->u8, sizeof(*pKeyOut));
-		if (ret != 0) {
-			return KeyManager::VerifyResult::IAesCipherInitErr;
-		}
-
-		// Decrypt the test data.
-		// NOTE: IAesCipher decrypts in place, so we need to
-		// make a temporary copy.
-		uint8_t tmpData[16];
-		memcpy(tmpData, keyNormal_verify, sizeof(tmpData));
-		size_t size = cipher->decrypt(tmpData, sizeof(tmpData));
-		if (size != 16) {
-			// Decryption failed.
-			return KeyManager::VerifyResult::IAesCipherDecryptErr;
-		}
-
-		// Verify the test data.
-		if (memcmp(tmpData, KeyManager::verifyTestString, sizeof(tmpData)) != 0) {
-			// Verification failed.
-			return KeyManager::VerifyResult::WrongKey;
+		res = N3DSVerifyKeysPrivate::verifyKey(pKeyOut->u8, sizeof(*pKeyOut), keyNormal_verify);
+		if (res != KeyManager::VerifyResult::OK) {
+			return res;
 		}
 	}
 
@@ -298,9 +409,7 @@ KeyManager::VerifyResult N3DSVerifyKeys::loadNCCHKeys(u128_t pKeyOut[2],
 		}
 
 		if (keyX_verify[i]) {
-			res = keyManager->getAndVerify(
-				keyX_name[i], &keyX_data[i],
-				keyX_verify[i], 16);
+			res = getAndVerify(keyX_name[i], &keyX_data[i], keyX_verify[i]);
 		} else {
 			res = keyManager->get(keyX_name[i], &keyX_data[i]);
 		}
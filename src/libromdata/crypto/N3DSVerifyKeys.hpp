@@ -57,6 +57,21 @@ class N3DSVerifyKeys
 		RP_DISABLE_COPY(N3DSVerifyKeys)
 
 	public:
+		/**
+		 * Get and verify a key from KeyManager.
+		 *
+		 * Same as KeyManager::getAndVerify(), but successful
+		 * verifications are cached, so each key is only
+		 * verified once per process.
+		 *
+		 * @param keyName	[in] Encryption key name.
+		 * @param pKeyData	[out] Key data struct.
+		 * @param pVerifyData	[in] Verification data block. (16 bytes)
+		 * @return VerifyResult.
+		 */
+		static LibRpBase::KeyManager::VerifyResult getAndVerify(const char *keyName,
+			LibRpBase::KeyManager::KeyData_t *pKeyData, const uint8_t *pVerifyData);
+
 		/**
 		 * Attempt to load an AES normal key.
 		 * @param pKeyOut		[out] Output key data.
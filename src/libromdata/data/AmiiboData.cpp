@@ -21,6 +21,9 @@
 
 #include "librpfile/FileSystem.hpp"
 #include "librpfile/RpFile.hpp"
+
+// librpthreads
+#include "librpthreads/pthread_once.h"
 using namespace LibRpFile;
 
 // C++ includes.
@@ -61,19 +64,29 @@ namespace LibRomData {
 class AmiiboDataPrivate {
 	public:
 		AmiiboDataPrivate();
+		~AmiiboDataPrivate();
 
 	private:
 		RP_DISABLE_COPY(AmiiboDataPrivate)
 
 	public:
 		// Static AmiiboData instance.
-		// TODO: Q_GLOBAL_STATIC() equivalent, though we
-		// may need special initialization if the compiler
-		// doesn't support thread-safe statics.
-		static AmiiboData instance;
+		// Constructed on first use by initInstance().
+		static pthread_once_t once_control;
+		static AmiiboData *pInstance;
+
+		/**
+		 * Construct the singleton instance.
+		 * Called by pthread_once().
+		 */
+		static void initInstance(void);
 
 	public:
 		// amiibo.bin data
+		// If the system file can be memory-mapped, amiibo_bin_file is
+		// kept open and the table pointers point into the mapping.
+		// Otherwise, the file is read into amiibo_bin_data.
+		RpFile *amiibo_bin_file;
 		ao::uvector<uint8_t> amiibo_bin_data;
 		time_t amiibo_bin_check_ts;	// Last check timestamp
 		time_t amiibo_bin_file_ts;	// File mtime
@@ -128,6 +141,11 @@ class AmiiboDataPrivate {
 		 */
 		void clear(void);
 
+		/**
+		 * Release the memory-mapped file and/or the data buffer.
+		 */
+		void releaseData(void);
+
 	public:
 		/**
 		 * String table lookup.
@@ -157,7 +175,8 @@ class AmiiboDataPrivate {
 #define AMIIBO_BIN_FILENAME "amiibo-data.bin"
 
 AmiiboDataPrivate::AmiiboDataPrivate()
-	: amiibo_bin_check_ts(-1)
+	: amiibo_bin_file(nullptr)
+	, amiibo_bin_check_ts(-1)
 	, amiibo_bin_file_ts(-1)
 	, amiiboBinFileType(AmiiboBinFileType::None)
 	, pHeader(nullptr)
@@ -190,6 +209,11 @@ AmiiboDataPrivate::AmiiboDataPrivate()
 #endif /* _WIN32 */
 }
 
+AmiiboDataPrivate::~AmiiboDataPrivate()
+{
+	UNREF(amiibo_bin_file);
+}
+
 /**
  * Get an amiibo-data.bin filename.
  * @param amiiboBinFileType AmiiboBinFileType
@@ -263,7 +287,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	string filename;
 
 	time_t now = time(nullptr);
-	if (!amiibo_bin_data.empty()) {
+	if (pHeader) {
 		// amiibo data is already loaded.
 		if (now == amiibo_bin_check_ts) {
 			// Same time as last time. (seconds resolution)
@@ -328,11 +352,25 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	if (!ok) {
 		// Unable to find any valid amiibo-data.bin file.
 		// If data was already loaded before, keep using it.
-		return (amiibo_bin_data.empty() ? -ENOENT : 0);
+		return (!pHeader ? -ENOENT : 0);
 	}
 
 	// Load amiibo.bin.
-	RpFile *const pFile = new RpFile(filename, RpFile::FM_OPEN_READ);
+	// The mapping is used for as long as the file is loaded, so it
+	// would crash with SIGBUS if the file was truncated in place.
+	// Package managers replace files instead of rewriting them, so
+	// only the system file is mapped, and only if it isn't writable.
+	// The user file might be edited in place, so it's always read
+	// into memory.
+	bool canMap = (bin_ft == AmiiboBinFileType::System);
+#ifndef _WIN32
+	if (canMap && FileSystem::access(filename, W_OK) == 0) {
+		canMap = false;
+	}
+#endif /* !_WIN32 */
+	RpFile *const pFile = new RpFile(filename, (canMap
+		? static_cast<RpFile::FileMode>(RpFile::FM_OPEN_READ | RpFile::FM_MMAP)
+		: RpFile::FM_OPEN_READ));
 	if (!pFile->isOpen()) {
 		// Unable to open the file.
 		int err = -pFile->lastError();
@@ -352,26 +390,36 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	// Clear all offsets before loading the data.
 	clear();
 
-	// Load the data.
-	amiibo_bin_data.resize(filesize);
-	size_t size = pFile->read(amiibo_bin_data.data(), filesize);
-	pFile->unref();
-	if (size != static_cast<size_t>(filesize)) {
-		// Read error.
-		int err = -pFile->lastError();
-		if (err == 0) {
-			err = -EIO;
+	// Use the memory-mapped file if possible.
+	// The tables are used in place, so the data isn't
+	// copied into each process's heap.
+	// Otherwise, read the entire file into memory.
+	const uint8_t *data = pFile->peek(0, static_cast<size_t>(filesize));
+	if (data) {
+		amiibo_bin_file = pFile;
+	} else {
+		amiibo_bin_data.resize(filesize);
+		size_t size = pFile->read(amiibo_bin_data.data(), filesize);
+		if (size != static_cast<size_t>(filesize)) {
+			// Read error.
+			int err = -pFile->lastError();
+			pFile->unref();
+			if (err == 0) {
+				err = -EIO;
+			}
+			releaseData();
+			return err;
 		}
-		amiibo_bin_data.clear();
-		return err;
+		pFile->unref();
+		data = amiibo_bin_data.data();
 	}
 
 	// Verify the header.
 	const AmiiboBinHeader *const pHeader_tmp =
-		reinterpret_cast<const AmiiboBinHeader*>(&amiibo_bin_data[0]);
+		reinterpret_cast<const AmiiboBinHeader*>(data);
 	if (memcmp(pHeader_tmp->magic, AMIIBO_BIN_MAGIC, sizeof(pHeader_tmp->magic)) != 0) {
 		// Invalid magic.
-		amiibo_bin_data.clear();
+		releaseData();
 		return -EIO;
 	}
 
@@ -382,16 +430,16 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)strtbl_offset + (uint64_t)strtbl_len) > static_cast<uint64_t>(filesize))
 	{
 		// String table offsets are invalid.
-		amiibo_bin_data.clear();
+		releaseData();
 		return -EIO;
 	}
 
 	// Make sure the string table both starts and ends with NULL.
-	if (amiibo_bin_data[strtbl_offset] != 0 ||
-	    amiibo_bin_data[strtbl_offset + strtbl_len - 1] != 0)
+	if (data[strtbl_offset] != 0 ||
+	    data[strtbl_offset + strtbl_len - 1] != 0)
 	{
 		// Missing NULLs.
-		amiibo_bin_data.clear();
+		releaseData();
 		return -EIO;
 	}
 
@@ -403,7 +451,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)cseries_offset + (uint64_t)cseries_len) > static_cast<uint64_t>(filesize))
 	{
 		// p.21 character series table offsets are invalid.
-		amiibo_bin_data.clear();
+		releaseData();
 		return -EIO;
 	}
 
@@ -414,7 +462,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)char_offset + (uint64_t)char_len) > static_cast<uint64_t>(filesize))
 	{
 		// p.21 character table offsets are invalid.
-		amiibo_bin_data.clear();
+		releaseData();
 		return -EIO;
 	}
 
@@ -425,7 +473,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)cvar_offset + (uint64_t)cvar_len) > static_cast<uint64_t>(filesize))
 	{
 		// p.21 character variant table offsets are invalid.
-		amiibo_bin_data.clear();
+		releaseData();
 		return -EIO;
 	}
 
@@ -436,7 +484,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)aseries_offset + (uint64_t)aseries_len) > static_cast<uint64_t>(filesize))
 	{
 		// p.22 amiibo series table offsets are invalid.
-		amiibo_bin_data.clear();
+		releaseData();
 		return -EIO;
 	}
 
@@ -447,7 +495,7 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	    ((uint64_t)amiibo_offset + (uint64_t)amiibo_len) > static_cast<uint64_t>(filesize))
 	{
 		// p.22 amiibo ID table offsets are invalid.
-		amiibo_bin_data.clear();
+		releaseData();
 		return -EIO;
 	}
 
@@ -457,12 +505,13 @@ int AmiiboDataPrivate::loadIfNeeded(void)
 	amiiboBinFileType = bin_ft;
 
 	// Save the table values and offsets.
-	pStrTbl = reinterpret_cast<const char*>(&amiibo_bin_data[strtbl_offset]);
-	pCSeriesTbl = reinterpret_cast<const uint32_t*>(&amiibo_bin_data[cseries_offset]);
-	pCharTbl = reinterpret_cast<const CharTableEntry*>(&amiibo_bin_data[char_offset]);
-	pCharVarTbl = reinterpret_cast<const CharVariantTableEntry*>(&amiibo_bin_data[cvar_offset]);
-	pASeriesTbl = reinterpret_cast<const uint32_t*>(&amiibo_bin_data[aseries_offset]);
-	pAmiiboIDTbl = reinterpret_cast<const AmiiboIDTableEntry*>(&amiibo_bin_data[amiibo_offset]);
+	pHeader = pHeader_tmp;
+	pStrTbl = reinterpret_cast<const char*>(&data[strtbl_offset]);
+	pCSeriesTbl = reinterpret_cast<const uint32_t*>(&data[cseries_offset]);
+	pCharTbl = reinterpret_cast<const CharTableEntry*>(&data[char_offset]);
+	pCharVarTbl = reinterpret_cast<const CharVariantTableEntry*>(&data[cvar_offset]);
+	pASeriesTbl = reinterpret_cast<const uint32_t*>(&data[aseries_offset]);
+	pAmiiboIDTbl = reinterpret_cast<const AmiiboIDTableEntry*>(&data[amiibo_offset]);
 	strTbl_len = strtbl_len;
 	cseriesTbl_count = cseries_len / sizeof(uint32_t);
 	charTbl_count = char_len / sizeof(CharTableEntry);
@@ -494,6 +543,17 @@ void AmiiboDataPrivate::clear(void)
 	charVarTbl_count = 0;
 	aseriesTbl_count = 0;
 	amiiboIdTbl_count = 0;
+
+	releaseData();
+}
+
+/**
+ * Release the memory-mapped file and/or the data buffer.
+ */
+void AmiiboDataPrivate::releaseData(void)
+{
+	UNREF_AND_NULL(amiibo_bin_file);
+	amiibo_bin_data.clear();
 }
 
 /**
@@ -561,10 +621,16 @@ int RP_C_API AmiiboDataPrivate::CharVariantTableEntry_compar(const void *a, cons
 
 /** AmiiboData **/
 
-// Singleton instance.
-// Using a static non-pointer variable in order to
-// handle proper destruction when the DLL is unloaded.
-AmiiboData AmiiboDataPrivate::instance;
+// Singleton instance. (constructed on first use)
+pthread_once_t AmiiboDataPrivate::once_control = PTHREAD_ONCE_INIT;
+AmiiboData *AmiiboDataPrivate::pInstance = nullptr;
+
+void AmiiboDataPrivate::initInstance(void)
+{
+	// Destroyed when the DLL is unloaded.
+	static AmiiboData instance;
+	pInstance = &instance;
+}
 
 AmiiboData::AmiiboData()
 	: d_ptr(new AmiiboDataPrivate())
@@ -589,7 +655,8 @@ AmiiboData::~AmiiboData()
 AmiiboData *AmiiboData::instance(void)
 {
 	// Initialize the singleton instance.
-	AmiiboData *const q = &AmiiboDataPrivate::instance;
+	pthread_once(&AmiiboDataPrivate::once_control, AmiiboDataPrivate::initInstance);
+	AmiiboData *const q = AmiiboDataPrivate::pInstance;
 
 	// amiibo data is loaded on demand.
 
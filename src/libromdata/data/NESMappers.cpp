@@ -10,6 +10,9 @@
 #include "stdafx.h"
 #include "NESMappers.hpp"
 
+// librpthreads
+#include "librpthreads/pthread_once.h"
+
 namespace LibRomData {
 
 /**
@@ -93,21 +96,31 @@ class NESMappersPrivate
 		};
 		static const SubmapperEntry submappers[];
 
+		// Mapper planes, indexed by (mapper >> 8).
+		struct MapperPlane {
+			const MapperEntry *entries;	// Mapper entries.
+			unsigned int count;		// Number of entries.
+		};
+		static const MapperPlane mapper_planes[3];
+
+		// NES 2.0 mapper numbers are 12-bit.
+		static const unsigned int NES2_MAPPER_MAX = 4096;
+
 		/**
-		 * bsearch() comparison function for SubmapperInfo.
-		 * @param a
-		 * @param b
-		 * @return
+		 * Direct-indexed submapper table.
+		 * Value is the submappers[] index plus one, or 0 if the
+		 * mapper doesn't have any submappers.
 		 */
-		static int RP_C_API SubmapperInfo_compar(const void *a, const void *b);
+		static uint8_t submapper_idx[NES2_MAPPER_MAX];
+
+		// pthread_once() control variable for submapper_idx[].
+		static pthread_once_t submapper_once_control;
 
 		/**
-		 * bsearch() comparison function for SubmapperEntry.
-		 * @param a
-		 * @param b
-		 * @return
+		 * Initialize submapper_idx[].
+		 * Called by pthread_once().
 		 */
-		static int RP_C_API SubmapperEntry_compar(const void *a, const void *b);
+		static void initSubmapperIdx(void);
 };
 
 /**
@@ -858,34 +871,33 @@ const NESMappersPrivate::SubmapperEntry NESMappersPrivate::submappers[] = {
 	{0, 0, nullptr}
 };
 
-/**
- * bsearch() comparison function for SubmapperInfo.
- * @param a
- * @param b
- * @return
- */
-int RP_C_API NESMappersPrivate::SubmapperInfo_compar(const void *a, const void *b)
-{
-	uint8_t submapper1 = static_cast<const SubmapperInfo*>(a)->submapper;
-	uint8_t submapper2 = static_cast<const SubmapperInfo*>(b)->submapper;
-	if (submapper1 < submapper2) return -1;
-	if (submapper1 > submapper2) return 1;
-	return 0;
-}
+// Mapper planes, indexed by (mapper >> 8).
+const NESMappersPrivate::MapperPlane NESMappersPrivate::mapper_planes[3] = {
+	{mappers_plane0, ARRAY_SIZE(mappers_plane0)},	// NES 2.0 Plane 0 [000-255] (iNES 1.0)
+	{mappers_plane1, ARRAY_SIZE(mappers_plane1)},	// NES 2.0 Plane 1 [256-511]
+	{mappers_plane2, ARRAY_SIZE(mappers_plane2)},	// NES 2.0 Plane 2 [512-767]
+};
+
+uint8_t NESMappersPrivate::submapper_idx[NESMappersPrivate::NES2_MAPPER_MAX];
+pthread_once_t NESMappersPrivate::submapper_once_control = PTHREAD_ONCE_INIT;
 
 /**
- * bsearch() comparison function for SubmapperEntry.
- * @param a
- * @param b
- * @return
+ * Initialize submapper_idx[].
+ * Called by pthread_once().
  */
-int RP_C_API NESMappersPrivate::SubmapperEntry_compar(const void *a, const void *b)
+void NESMappersPrivate::initSubmapperIdx(void)
 {
-	uint16_t mapper1 = static_cast<const SubmapperEntry*>(a)->mapper;
-	uint16_t mapper2 = static_cast<const SubmapperEntry*>(b)->mapper;
-	if (mapper1 < mapper2) return -1;
-	if (mapper1 > mapper2) return 1;
-	return 0;
+	static_assert(ARRAY_SIZE(submappers)-1 < 256,
+		"NESMappersPrivate::submappers[] has too many entries for uint8_t indexes.");
+
+	// NOTE: submappers[] has a NULL terminator entry.
+	for (unsigned int i = 0; i < ARRAY_SIZE(submappers)-1; i++) {
+		const unsigned int mapper = submappers[i].mapper;
+		assert(mapper < NES2_MAPPER_MAX);
+		if (mapper < NES2_MAPPER_MAX) {
+			submapper_idx[mapper] = static_cast<uint8_t>(i + 1);
+		}
+	}
 }
 
 /** NESMappers **/
@@ -903,31 +915,22 @@ const char *NESMappers::lookup_ines(int mapper)
 		return nullptr;
 	}
 
-	if (mapper < 256) {
-		// NES 2.0 Plane 0 [000-255] (iNES 1.0)
-		static_assert(sizeof(NESMappersPrivate::mappers_plane0) == (256 * sizeof(NESMappersPrivate::MapperEntry)),
-			"NESMappersPrivate::mappers_plane0[] doesn't have 256 entries.");
-		return NESMappersPrivate::mappers_plane0[mapper].name;
-	} else if (mapper < 512) {
-		// NES 2.0 Plane 1 [256-511]
-		mapper -= 256;
-		if (mapper >= ARRAY_SIZE(NESMappersPrivate::mappers_plane1)) {
-			// Mapper number is out of range for plane 1.
-			return nullptr;
-		}
-		return NESMappersPrivate::mappers_plane1[mapper].name;
-	} else if (mapper < 768) {
-		// NES 2.0 Plane 2 [512-767]
-		mapper -= 512;
-		if (mapper >= ARRAY_SIZE(NESMappersPrivate::mappers_plane2)) {
-			// Mapper number is out of range for plane 2.
-			return nullptr;
-		}
-		return NESMappersPrivate::mappers_plane2[mapper].name;
-	}
+	static_assert(sizeof(NESMappersPrivate::mappers_plane0) == (256 * sizeof(NESMappersPrivate::MapperEntry)),
+		"NESMappersPrivate::mappers_plane0[] doesn't have 256 entries.");
 
-	// Invalid mapper number.
-	return nullptr;
+	// Look up the plane, then the mapper within the plane.
+	const unsigned int plane = static_cast<unsigned int>(mapper) >> 8;
+	if (plane >= ARRAY_SIZE(NESMappersPrivate::mapper_planes)) {
+		// No mappers are defined in this plane.
+		return nullptr;
+	}
+	const NESMappersPrivate::MapperPlane &mp = NESMappersPrivate::mapper_planes[plane];
+	const unsigned int idx = static_cast<unsigned int>(mapper) & 0xFF;
+	if (idx >= mp.count) {
+		// Mapper number is out of range for this plane.
+		return nullptr;
+	}
+	return mp.entries[idx].name;
 }
 
 /**
@@ -1032,26 +1035,31 @@ const char *NESMappers::lookup_nes2_submapper(int mapper, int submapper)
 		return nullptr;
 	}
 
-	// Do a binary search in submappers[].
-	const NESMappersPrivate::SubmapperEntry key = { static_cast<uint16_t>(mapper), 0, nullptr };
-	const NESMappersPrivate::SubmapperEntry *res =
-		static_cast<const NESMappersPrivate::SubmapperEntry*>(bsearch(&key,
-			NESMappersPrivate::submappers,
-			ARRAY_SIZE(NESMappersPrivate::submappers)-1,
-			sizeof(NESMappersPrivate::SubmapperEntry),
-			NESMappersPrivate::SubmapperEntry_compar));
-	if (!res || !res->info || res->info_size == 0)
+	if (mapper >= static_cast<int>(NESMappersPrivate::NES2_MAPPER_MAX)) {
+		// Not a valid NES 2.0 mapper number.
+		return nullptr;
+	}
+
+	// Get the submapper list from the direct-indexed table.
+	pthread_once(&NESMappersPrivate::submapper_once_control, NESMappersPrivate::initSubmapperIdx);
+	const unsigned int idx = NESMappersPrivate::submapper_idx[mapper];
+	if (idx == 0)
+		return nullptr;
+	const NESMappersPrivate::SubmapperEntry *const res = &NESMappersPrivate::submappers[idx-1];
+	if (!res->info || res->info_size == 0)
 		return nullptr;
 
-	// Do a binary search in res->info.
-	const NESMappersPrivate::SubmapperInfo key2 = { static_cast<uint8_t>(submapper), 0, 0, nullptr };
-	const NESMappersPrivate::SubmapperInfo *res2 =
-		static_cast<const NESMappersPrivate::SubmapperInfo*>(bsearch(&key2,
-			res->info, res->info_size,
-			sizeof(NESMappersPrivate::SubmapperInfo),
-			NESMappersPrivate::SubmapperInfo_compar));
-	// TODO: Return the "deprecated" value?
-	return (res2 ? res2->desc : nullptr);
+	// Submapper lists are short and sorted by submapper number.
+	const NESMappersPrivate::SubmapperInfo *const p_end = res->info + res->info_size;
+	for (const NESMappersPrivate::SubmapperInfo *p = res->info; p < p_end; p++) {
+		if (p->submapper == submapper) {
+			// TODO: Return the "deprecated" value?
+			return p->desc;
+		} else if (p->submapper > submapper) {
+			break;
+		}
+	}
+	return nullptr;
 }
 
 }
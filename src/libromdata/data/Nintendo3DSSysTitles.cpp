@@ -40,6 +40,28 @@ class Nintendo3DSSysTitlesPrivate
 		static const SysTitle sys_title_00040010[];	// System applications.
 		static const SysTitle sys_title_00040030[];	// System applets.
 
+		// Sorted index of all tid_lo values in a SysTitle array.
+		// This allows bsearch() instead of a linear scan of
+		// all six regions of every title.
+		struct SysTitleIndex {
+			uint32_t tid_lo;	// Title ID Low
+			uint8_t title;		// Index in the SysTitle array
+			uint8_t region;		// Index in regions[]
+		};
+
+		static const SysTitleIndex sys_title_idx_00040010[];	// System applications.
+		static const SysTitleIndex sys_title_idx_00040030[];	// System applets.
+
+		/**
+		 * Comparison function for bsearch().
+		 * For use with SysTitleIndex.
+		 *
+		 * @param a
+		 * @param b
+		 * @return
+		 */
+		static int RP_C_API compar(const void *a, const void *b);
+
 		//static const SysTitleGroup sys_title_group[];	// All SysTitle[] arrays.
 };
 
@@ -106,6 +128,231 @@ const Nintendo3DSSysTitlesPrivate::SysTitle Nintendo3DSSysTitlesPrivate::sys_tit
 	{{0x2000C003, 0x2000C803, 0x2000D003,          0, 0x2000DE03,          0}, NOP_C_("Nintendo3DSSysTitles", "Software Keyboard (SAFE_MODE)")},
 };
 
+/**
+ * System applications index. (tid hi == 0x00040010)
+ * NOTE: Must be sorted by tid_lo for bsearch().
+ * This must be updated if sys_title_00040010[] is changed.
+ */
+const Nintendo3DSSysTitlesPrivate::SysTitleIndex Nintendo3DSSysTitlesPrivate::sys_title_idx_00040010[] = {
+	{0x00020000,  0, 0},
+	{0x00020100,  1, 0},
+	{0x00020200,  2, 0},
+	{0x00020300,  3, 0},
+	{0x00020400,  4, 0},
+	{0x00020500,  5, 0},
+	{0x00020700,  6, 0},
+	{0x00020800,  7, 0},
+	{0x00020900,  8, 0},
+	{0x00020A00,  9, 0},
+	{0x00020B00, 10, 0},
+	{0x00020D00, 11, 0},
+	{0x00020E00, 12, 0},
+	{0x00020F00, 13, 0},
+	{0x00021000,  0, 1},
+	{0x00021100,  1, 1},
+	{0x00021200,  2, 1},
+	{0x00021300,  3, 1},
+	{0x00021400,  4, 1},
+	{0x00021500,  5, 1},
+	{0x00021700,  6, 1},
+	{0x00021800,  7, 1},
+	{0x00021900,  8, 1},
+	{0x00021A00,  9, 1},
+	{0x00021B00, 10, 1},
+	{0x00021D00, 11, 1},
+	{0x00021E00, 12, 1},
+	{0x00021F00, 13, 1},
+	{0x00022000,  0, 2},
+	{0x00022100,  1, 2},
+	{0x00022200,  2, 2},
+	{0x00022300,  3, 2},
+	{0x00022400,  4, 2},
+	{0x00022500,  5, 2},
+	{0x00022700,  6, 2},
+	{0x00022800,  7, 2},
+	{0x00022900,  8, 2},
+	{0x00022A00,  9, 2},
+	{0x00022B00, 10, 2},
+	{0x00022D00, 11, 2},
+	{0x00022E00, 12, 2},
+	{0x00022F00, 13, 2},
+	{0x00023000, 14, 0},
+	{0x00024000, 14, 1},
+	{0x00025000, 14, 2},
+	{0x00026000,  0, 3},
+	{0x00026100,  1, 3},
+	{0x00026200,  2, 3},
+	{0x00026300,  3, 3},
+	{0x00026400,  4, 3},
+	{0x00026500,  5, 3},
+	{0x00026700,  6, 3},
+	{0x00026800,  7, 3},
+	{0x00026D00, 11, 3},
+	{0x00026E00, 12, 3},
+	{0x00026F00, 13, 3},
+	{0x00027000,  0, 4},
+	{0x00027100,  1, 4},
+	{0x00027200,  2, 4},
+	{0x00027300,  3, 4},
+	{0x00027400,  4, 4},
+	{0x00027500,  5, 4},
+	{0x00027700,  6, 4},
+	{0x00027800,  7, 4},
+	{0x00027900,  8, 4},
+	{0x00027A00,  9, 4},
+	{0x00027D00, 11, 4},
+	{0x00027E00, 12, 4},
+	{0x00027F00, 13, 4},
+	{0x00028000,  0, 5},
+	{0x00028100,  1, 5},
+	{0x00028200,  2, 5},
+	{0x00028300,  3, 5},
+	{0x00028400,  4, 5},
+	{0x00028500,  5, 5},
+	{0x00028700,  6, 5},
+	{0x00028800,  7, 5},
+	{0x00028900,  8, 5},
+	{0x00028A00,  9, 5},
+	{0x00028D00, 11, 5},
+	{0x00028E00, 12, 5},
+	{0x00028F00, 13, 5},
+	{0x0002BF00, 15, 0},
+	{0x0002C000, 15, 1},
+	{0x0002C100, 15, 2},
+	{0x20020300, 16, 0},
+	{0x20020D00, 17, 0},
+	{0x20021300, 16, 1},
+	{0x20021D00, 17, 1},
+	{0x20022300, 16, 2},
+	{0x20022D00, 17, 2},
+	{0x20023100, 18, 0},
+	{0x20024100, 18, 1},
+	{0x20025100, 18, 2},
+	{0x20027300, 16, 4},
+	{0x20027D00, 17, 4},
+};
+
+/**
+ * System applets index. (tid hi == 0x00040030)
+ * NOTE: Must be sorted by tid_lo for bsearch().
+ * This must be updated if sys_title_00040030[] is changed.
+ */
+const Nintendo3DSSysTitlesPrivate::SysTitleIndex Nintendo3DSSysTitlesPrivate::sys_title_idx_00040030[] = {
+	{0x00008202,  0, 0},
+	{0x00008302, 14, 0},
+	{0x00008402,  1, 0},
+	{0x00008602,  2, 0},
+	{0x00008702,  3, 0},
+	{0x00008802,  4, 0},
+	{0x00008B02, 14, 1},
+	{0x00008C02, 15, 4},
+	{0x00008D02,  5, 0},
+	{0x00008E02,  6, 0},
+	{0x00008F02,  0, 1},
+	{0x00009002,  1, 1},
+	{0x00009202,  2, 1},
+	{0x00009302,  3, 1},
+	{0x00009402,  4, 1},
+	{0x00009502, 15, 0},
+	{0x00009602,  5, 1},
+	{0x00009702,  6, 1},
+	{0x00009802,  0, 2},
+	{0x00009902,  1, 2},
+	{0x00009B02,  2, 2},
+	{0x00009C02,  3, 2},
+	{0x00009D02,  4, 2},
+	{0x00009E02, 15, 1},
+	{0x00009F02,  5, 2},
+	{0x0000A002,  6, 2},
+	{0x0000A102,  0, 3},
+	{0x0000A202,  1, 3},
+	{0x0000A402,  2, 3},
+	{0x0000A502,  3, 3},
+	{0x0000A602,  4, 3},
+	{0x0000A702,  5, 3},
+	{0x0000A802,  6, 3},
+	{0x0000A902,  0, 4},
+	{0x0000AA02,  1, 4},
+	{0x0000AC02,  2, 4},
+	{0x0000AD02,  3, 4},
+	{0x0000AE02,  4, 4},
+	{0x0000AF02,  5, 4},
+	{0x0000B002,  6, 4},
+	{0x0000B102,  0, 5},
+	{0x0000B202,  1, 5},
+	{0x0000B402,  2, 5},
+	{0x0000B502,  3, 5},
+	{0x0000B602,  4, 5},
+	{0x0000B702,  5, 5},
+	{0x0000B802,  6, 5},
+	{0x0000B902, 15, 2},
+	{0x0000BA02, 14, 2},
+	{0x0000BC02, 13, 0},
+	{0x0000BD02, 13, 1},
+	{0x0000BE02, 13, 2},
+	{0x0000BF02, 15, 5},
+	{0x0000C002,  7, 0},
+	{0x0000C003,  8, 0},
+	{0x0000C102,  9, 0},
+	{0x0000C302, 10, 0},
+	{0x0000C402, 11, 0},
+	{0x0000C602, 12, 0},
+	{0x0000C802,  7, 1},
+	{0x0000C803,  8, 1},
+	{0x0000C902,  9, 1},
+	{0x0000CB02, 10, 1},
+	{0x0000CC02, 11, 1},
+	{0x0000CE02, 12, 1},
+	{0x0000D002,  7, 2},
+	{0x0000D003,  8, 2},
+	{0x0000D102,  9, 2},
+	{0x0000D302, 10, 2},
+	{0x0000D402, 11, 2},
+	{0x0000D602, 12, 2},
+	{0x0000D802,  7, 3},
+	{0x0000D803,  8, 3},
+	{0x0000D902,  9, 3},
+	{0x0000DB02, 10, 3},
+	{0x0000DC02, 11, 3},
+	{0x0000DE02,  7, 4},
+	{0x0000DE03,  8, 4},
+	{0x0000DF02,  9, 4},
+	{0x0000E102, 10, 4},
+	{0x0000E202, 11, 4},
+	{0x0000E302, 12, 4},
+	{0x0000E402,  7, 5},
+	{0x0000E403,  8, 5},
+	{0x0000E502,  9, 5},
+	{0x0000E702, 10, 5},
+	{0x0000E802, 11, 5},
+	{0x0000E902, 12, 5},
+	{0x20008802, 16, 0},
+	{0x20009402, 16, 1},
+	{0x20009D02, 16, 2},
+	{0x2000AE02, 16, 4},
+	{0x2000C003, 17, 0},
+	{0x2000C803, 17, 1},
+	{0x2000D003, 17, 2},
+	{0x2000DE03, 17, 4},
+};
+
+/**
+ * Comparison function for bsearch().
+ * For use with SysTitleIndex.
+ *
+ * @param a
+ * @param b
+ * @return
+ */
+int RP_C_API Nintendo3DSSysTitlesPrivate::compar(const void *a, const void *b)
+{
+	const uint32_t tid_lo1 = static_cast<const SysTitleIndex*>(a)->tid_lo;
+	const uint32_t tid_lo2 = static_cast<const SysTitleIndex*>(b)->tid_lo;
+	if (tid_lo1 < tid_lo2) return -1;
+	if (tid_lo1 > tid_lo2) return 1;
+	return 0;
+}
+
 /** Nintendo3DSSysTitles **/
 
 /**
@@ -118,7 +365,8 @@ const Nintendo3DSSysTitlesPrivate::SysTitle Nintendo3DSSysTitlesPrivate::sys_tit
 const char *Nintendo3DSSysTitles::lookup_sys_title(uint32_t tid_hi, uint32_t tid_lo, const char **pRegion)
 {
 	const Nintendo3DSSysTitlesPrivate::SysTitle *titles;
-	int title_count;
+	const Nintendo3DSSysTitlesPrivate::SysTitleIndex *idx;
+	size_t idx_count;
 
 	if (tid_hi == 0 || tid_lo == 0 ||
 	    tid_hi == 0xFFFFFFFF || tid_lo == 0xFFFFFFFF)
@@ -132,10 +380,12 @@ const char *Nintendo3DSSysTitles::lookup_sys_title(uint32_t tid_hi, uint32_t tid
 
 	if (tid_hi == 0x00040010) {
 		titles = Nintendo3DSSysTitlesPrivate::sys_title_00040010;
-		title_count = ARRAY_SIZE(Nintendo3DSSysTitlesPrivate::sys_title_00040010);
+		idx = Nintendo3DSSysTitlesPrivate::sys_title_idx_00040010;
+		idx_count = ARRAY_SIZE(Nintendo3DSSysTitlesPrivate::sys_title_idx_00040010);
 	} else if (tid_hi == 0x00040030) {
 		titles = Nintendo3DSSysTitlesPrivate::sys_title_00040030;
-		title_count = ARRAY_SIZE(Nintendo3DSSysTitlesPrivate::sys_title_00040030);
+		idx = Nintendo3DSSysTitlesPrivate::sys_title_idx_00040030;
+		idx_count = ARRAY_SIZE(Nintendo3DSSysTitlesPrivate::sys_title_idx_00040030);
 	} else {
 		// tid_hi not supported.
 		if (pRegion) {
@@ -144,17 +394,20 @@ const char *Nintendo3DSSysTitles::lookup_sys_title(uint32_t tid_hi, uint32_t tid
 		return nullptr;
 	}
 
-	// TODO: bsearch()?
-	for (; title_count > 0; title_count--, titles++) {
-		for (unsigned int region = 0; region < 6; region++) {
-			if (titles->tid_lo[region] != 0 && titles->tid_lo[region] == tid_lo) {
-				// Found a match!
-				if (pRegion) {
-					*pRegion = Nintendo3DSSysTitlesPrivate::regions[region];
-				}
-				return dpgettext_expr(RP_I18N_DOMAIN, "Nintendo3DSSysTitles", titles->desc);
-			}
+	// Do a binary search.
+	const Nintendo3DSSysTitlesPrivate::SysTitleIndex key = {tid_lo, 0, 0};
+	const Nintendo3DSSysTitlesPrivate::SysTitleIndex *const res =
+		static_cast<const Nintendo3DSSysTitlesPrivate::SysTitleIndex*>(bsearch(&key,
+			idx, idx_count,
+			sizeof(Nintendo3DSSysTitlesPrivate::SysTitleIndex),
+			Nintendo3DSSysTitlesPrivate::compar));
+	if (res) {
+		// Found a match!
+		assert(titles[res->title].tid_lo[res->region] == tid_lo);
+		if (pRegion) {
+			*pRegion = Nintendo3DSSysTitlesPrivate::regions[res->region];
 		}
+		return dpgettext_expr(RP_I18N_DOMAIN, "Nintendo3DSSysTitles", titles[res->title].desc);
 	}
 
 	// Not found.
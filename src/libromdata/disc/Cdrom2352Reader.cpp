@@ -21,6 +21,9 @@
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
 
+// C++ STL classes.
+using std::unique_ptr;
+
 namespace LibRomData {
 
 class Cdrom2352ReaderPrivate : public SparseDiscReaderPrivate {
@@ -39,12 +42,19 @@ class Cdrom2352ReaderPrivate : public SparseDiscReaderPrivate {
 		// Supported block sizes: 2352 (raw), 2448 (raw+subchan)
 		unsigned int physBlockSize;
 
-		// Number of 2352-byte blocks.
+		// Number of physical blocks.
 		unsigned int blockCount;
+
+		// Maximum number of physical sectors to read at once
+		// in readBlocks(). (32 sectors is ~74 KiB)
+		static const unsigned int SECTOR_BATCH_COUNT = 32;
 };
 
 /** Cdrom2352ReaderPrivate **/
 
+// Out-of-class definition, since it's passed by reference to std::min().
+const unsigned int Cdrom2352ReaderPrivate::SECTOR_BATCH_COUNT;
+
 // CD-ROM sync magic magic.
 const uint8_t Cdrom2352ReaderPrivate::CDROM_2352_MAGIC[12] =
 	{0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00};
@@ -53,7 +63,10 @@ Cdrom2352ReaderPrivate::Cdrom2352ReaderPrivate(Cdrom2352Reader *q, unsigned int
 	: super(q)
 	, physBlockSize(physBlockSize)
 	, blockCount(0)
-{ }
+{
+	// readBlock() is overridden.
+	rawBlocks = false;
+}
 
 /** Cdrom2352Reader **/
 
@@ -93,7 +106,7 @@ void Cdrom2352Reader::init(void)
 
 	// Disc parameters.
 	// NOTE: A 32-bit block count allows for ~8 TiB with 2048-byte sectors.
-	d->blockCount = static_cast<unsigned int>(fileSize / 2352LL);
+	d->blockCount = static_cast<unsigned int>(fileSize / d->physBlockSize);
 	d->block_size = 2048U;
 	d->disc_size = fileSize / (off64_t)d->physBlockSize * 2048LL;
 
@@ -142,16 +155,21 @@ int Cdrom2352Reader::isDiscSupported(const uint8_t *pHeader, size_t szHeader) co
 /**
  * Get the physical address of the specified logical block index.
  *
+ * NOTE: This is the address of the raw sector, which includes the
+ * sector header. It should only be used for access pattern hints.
+ * Use the readBlock() function to read data.
+ *
  * @param blockIdx	[in] Block index.
  * @return Physical address. (0 == empty block; -1 == invalid block index)
  */
 off64_t Cdrom2352Reader::getPhysBlockAddr(uint32_t blockIdx) const
 {
-	// NOTE: This function should NOT be used.
-	// Use the readBlock() function instead.
-	RP_UNUSED(blockIdx);
-	assert(!"Cdrom2352Reader::getPhysBlockAddr() should not be used!");
-	return -1;
+	RP_D(const Cdrom2352Reader);
+	if (blockIdx >= d->blockCount) {
+		// Out of range.
+		return -1;
+	}
+	return static_cast<off64_t>(blockIdx) * d->physBlockSize;
 }
 
 /**
@@ -196,7 +214,7 @@ int Cdrom2352Reader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t siz
 	// NOTE 2: No changes neeed for 2448-byte mode, since subchannels are
 	// stored *after* the 2352-byte sector data.
 	CDROM_2352_Sector_t sector;
-	size_t sz_read = m_file->seekAndRead(physBlockAddr, &sector, sizeof(sector));
+	size_t sz_read = m_file->readAt(physBlockAddr, &sector, sizeof(sector));
 	m_lastError = m_file->lastError();
 	if (sz_read != sizeof(sector)) {
 		// Read error.
@@ -209,4 +227,49 @@ int Cdrom2352Reader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t siz
 	return size;
 }
 
+/**
+ * Read multiple full blocks.
+ *
+ * Consecutive physical sectors are read using a single read,
+ * and then the user data sections are copied out.
+ *
+ * @param blockIdxStart	[in] First block index.
+ * @param blockCount	[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+ * @return Number of blocks read. (If less than blockCount, an error occurred.)
+ */
+unsigned int Cdrom2352Reader::readBlocks(uint32_t blockIdxStart, unsigned int blockCount, void *ptr)
+{
+	RP_D(const Cdrom2352Reader);
+	assert(blockCount > 0);
+	if (blockCount == 0) {
+		return 0;
+	}
+
+	const unsigned int physBlockSize = d->physBlockSize;
+	const unsigned int batchCount = std::min(blockCount, Cdrom2352ReaderPrivate::SECTOR_BATCH_COUNT);
+	unique_ptr<uint8_t[]> buf(new uint8_t[batchCount * physBlockSize]);
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	unsigned int blocksOk = 0;
+	while (blocksOk < blockCount) {
+		const unsigned int count = std::min(blockCount - blocksOk, batchCount);
+		const off64_t physBlockAddr = static_cast<off64_t>(blockIdxStart + blocksOk) * physBlockSize;
+		const size_t sz_read = m_file->readAt(physBlockAddr, buf.get(), count * physBlockSize);
+		m_lastError = m_file->lastError();
+
+		// NOTE: Sector user data area position depends on the sector mode.
+		const unsigned int sectorsRead = static_cast<unsigned int>(sz_read / physBlockSize);
+		cdromCopySectorData(ptr8, buf.get(), physBlockSize, sectorsRead);
+		ptr8 += sectorsRead * 2048U;
+		blocksOk += sectorsRead;
+		if (sectorsRead != count) {
+			// Read error.
+			break;
+		}
+	}
+
+	return blocksOk;
+}
+
 }
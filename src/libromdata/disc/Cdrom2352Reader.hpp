@@ -75,6 +75,10 @@ class Cdrom2352Reader : public LibRpBase::SparseDiscReader
 		/**
 		 * Get the physical address of the specified logical block index.
 		 *
+		 * NOTE: This is the address of the raw sector, which includes the
+		 * sector header. It should only be used for access pattern hints.
+		 * Use the readBlock() function to read data.
+		 *
 		 * @param blockIdx	[in] Block index.
 		 * @return Physical address. (0 == empty block; -1 == invalid block index)
 		 */
@@ -94,6 +98,19 @@ class Cdrom2352Reader : public LibRpBase::SparseDiscReader
 		 */
 		ATTR_ACCESS_SIZE(write_only, 4, 5)
 		int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size) final;
+
+		/**
+		 * Read multiple full blocks.
+		 *
+		 * Consecutive physical sectors are read using a single read,
+		 * and then the user data sections are copied out.
+		 *
+		 * @param blockIdxStart	[in] First block index.
+		 * @param blockCount	[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+		 * @return Number of blocks read. (If less than blockCount, an error occurred.)
+		 */
+		unsigned int readBlocks(uint32_t blockIdxStart, unsigned int blockCount, void *ptr) final;
 };
 
 }
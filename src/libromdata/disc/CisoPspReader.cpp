@@ -16,6 +16,13 @@
 #include "CisoPspReader.hpp"
 #include "librpbase/disc/SparseDiscReader_p.hpp"
 #include "ciso_psp_structs.h"
+#include "InflateBlock.hpp"
+
+// librpcpu
+#include "librpcpu/byteswap_struct.hpp"
+
+// librpthreads
+#include "librpthreads/ThreadPool.hpp"
 
 // zlib
 #include <zlib.h>
@@ -39,13 +46,31 @@
 #  endif
 #endif /* HAVE_LZO */
 
-// librpbase, librpfile
+// librpbase, librpfile, librpthreads
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
+using LibRpThreads::ThreadPool;
 
 // C++ STL classes.
 using std::unique_ptr;
 
+// Header byteswap layouts.
+RP_BYTESWAP_LAYOUT(CisoPspHeader,
+	RP_BYTESWAP_FIELD(CisoPspHeader, magic),
+	RP_BYTESWAP_FIELD(CisoPspHeader, header_size),
+	RP_BYTESWAP_FIELD(CisoPspHeader, uncompressed_size),
+	RP_BYTESWAP_FIELD(CisoPspHeader, block_size))
+RP_BYTESWAP_LAYOUT(JisoHeader,
+	RP_BYTESWAP_FIELD(JisoHeader, magic),
+	RP_BYTESWAP_FIELD(JisoHeader, block_size),
+	RP_BYTESWAP_FIELD(JisoHeader, uncompressed_size),
+	RP_BYTESWAP_FIELD(JisoHeader, header_size))
+RP_BYTESWAP_LAYOUT(DaxHeader,
+	RP_BYTESWAP_FIELD(DaxHeader, magic),
+	RP_BYTESWAP_FIELD(DaxHeader, uncompressed_size),
+	RP_BYTESWAP_FIELD(DaxHeader, version),
+	RP_BYTESWAP_FIELD(DaxHeader, nc_areas))
+
 namespace LibRomData {
 
 #ifdef _MSC_VER
@@ -117,10 +142,72 @@ class CisoPspReaderPrivate : public SparseDiscReaderPrivate {
 		 * @return Block's compressed size, or 0 on error.
 		 */
 		uint32_t getBlockCompressedSize(uint32_t blockNum) const;
+
+	public:
+		enum class CompressionMode {
+			None = 0,
+			Deflate = 1,
+			LZ4 = 2,
+			LZO = 3,
+		};
+
+		struct BlockInfo {
+			off64_t physBlockAddr;		// Physical address of the compressed data.
+			uint32_t z_block_size;		// Compressed size.
+			CompressionMode z_mode;		// Compression mode.
+			InflateBlock::Format z_format;	// Deflate format. (Deflate only)
+		};
+
+		/**
+		 * Get the physical address and compression mode of a block.
+		 * @param blockIdx	[in] Block index.
+		 * @param info		[out] Block information.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int getBlockInfo(uint32_t blockIdx, BlockInfo &info) const;
+
+		/**
+		 * Decompress a block.
+		 * This function is thread-safe.
+		 * @param info		[in] Block information.
+		 * @param z_src		[in] Compressed data. (info.z_block_size bytes)
+		 * @param pOut		[out] Output buffer. (block_size bytes)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int decompressBlock(const BlockInfo &info, const uint8_t *z_src, uint8_t *pOut) const;
+
+		// Minimum amount of uncompressed data for parallel decompression.
+		static const unsigned int PARALLEL_MIN_SIZE = 1024U*1024U;
+		// Number of blocks claimed by a decompression thread at once.
+		static const unsigned int PARALLEL_CHUNK_BLOCKS = 16;
+
+		struct DecompressJob {
+			const CisoPspReaderPrivate *d;
+			const BlockInfo *infos;		// Block information.
+			const uint8_t *z_data;		// Compressed data for all blocks.
+			off64_t z_data_addr;		// Physical address of z_data.
+			uint8_t *pOut;			// Output buffer.
+			unsigned int blockCount;	// Number of blocks.
+			uint8_t *blockOk;		// Set to 1 for each decompressed block.
+		};
+
+		/**
+		 * Decompress a range of blocks.
+		 * Used as a ThreadPool::parallelFor() range function.
+		 * @param param DecompressJob
+		 * @param begin First block index in the job
+		 * @param end Last block index in the job, plus one
+		 */
+		static void decompressRange(void *param, size_t begin, size_t end);
 };
 
 /** CisoPspReaderPrivate **/
 
+// Out-of-class definitions for the constants, since they're
+// passed by reference to std::min().
+const unsigned int CisoPspReaderPrivate::PARALLEL_MIN_SIZE;
+const unsigned int CisoPspReaderPrivate::PARALLEL_CHUNK_BLOCKS;
+
 CisoPspReaderPrivate::CisoPspReaderPrivate(CisoPspReader *q)
 	: super(q)
 	, cisoType(CisoType::Unknown)
@@ -128,6 +215,9 @@ CisoPspReaderPrivate::CisoPspReaderPrivate(CisoPspReader *q)
 	, index_shift(0)
 	, blockCacheIdx(~0U)
 {
+	// readBlock() is overridden.
+	rawBlocks = false;
+
 	// Clear the header structs.
 	memset(&header, 0, sizeof(header));
 }
@@ -192,6 +282,245 @@ uint32_t CisoPspReaderPrivate::getBlockCompressedSize(uint32_t blockNum) const
 	return size;
 }
 
+/**
+ * Get the physical address and compression mode of a block.
+ * @param blockIdx	[in] Block index.
+ * @param info		[out] Block information.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CisoPspReaderPrivate::getBlockInfo(uint32_t blockIdx, BlockInfo &info) const
+{
+	const uint32_t indexEntry = indexEntries[blockIdx];
+	info.z_block_size = getBlockCompressedSize(blockIdx);
+	if (info.z_block_size == 0) {
+		// Unable to get the block's compressed size...
+		return -EIO;
+	}
+	info.z_format = InflateBlock::Format::Raw;
+
+	switch (cisoType) {
+		default:
+		case CisoPspReaderPrivate::CisoType::Unknown:
+			assert(!"Unsupported CisoType.");
+			return -ENOTSUP;
+
+		case CisoPspReaderPrivate::CisoType::CISO:
+			// CISO uses raw deflate.
+			info.z_format = InflateBlock::Format::Raw;
+
+			// Mask off the compression bit, and shift the address
+			// based on the index shift.
+			info.physBlockAddr = static_cast<off64_t>(indexEntry & ~CISO_PSP_V0_NOT_COMPRESSED);
+			info.physBlockAddr <<= index_shift;
+
+			if (header.cisoPsp.version < 2) {
+				// CISO v0/v1: Check if compressed.
+				info.z_mode = (indexEntry & CISO_PSP_V0_NOT_COMPRESSED)
+					? CompressionMode::None
+					: CompressionMode::Deflate;
+
+				if (info.z_mode == CompressionMode::None) {
+					// (Un)compressed block size must match the actual block size.
+					if (info.z_block_size != block_size) {
+						// Error...
+						return -EIO;
+					}
+				}
+			} else {
+				// CISO v2: Check if compressed, and if so, which algorithm.
+				if (info.z_block_size == block_size) {
+					info.z_mode = CompressionMode::None;
+				} else {
+					info.z_mode = (indexEntry & CISO_PSP_V2_LZ4_COMPRESSED)
+						? CompressionMode::LZ4
+						: CompressionMode::Deflate;
+				}
+			}
+			break;
+
+#ifdef HAVE_LZ4
+		case CisoPspReaderPrivate::CisoType::ZISO:
+			// ZISO uses LZ4.
+
+			// Mask off the compression bit, and shift the address
+			// based on the index shift.
+			info.physBlockAddr = static_cast<off64_t>(indexEntry & ~CISO_PSP_V0_NOT_COMPRESSED);
+			info.physBlockAddr <<= index_shift;
+
+			info.z_mode = (indexEntry & CISO_PSP_V0_NOT_COMPRESSED)
+				? CompressionMode::None
+				: CompressionMode::LZ4;
+			break;
+#endif /* HAVE_LZ4 */
+
+#ifdef HAVE_LZO
+		case CisoPspReaderPrivate::CisoType::JISO:
+			// JISO uses LZO or zlib.
+			// TODO: Verify the rest of this.
+
+			// JISO does *not* indicate compression using the high bit.
+			// Instead, the compressed block size will match the uncompressed
+			// block size, similar to CISOv2.
+			info.physBlockAddr = static_cast<off64_t>(indexEntry);
+			info.physBlockAddr <<= index_shift;
+
+			if (header.jiso.block_headers) {
+				// Block headers are present.
+				// TODO: jiso.exe says this can provide for "faster decompression".
+				if (info.z_block_size <= 4) {
+					// Incorrect block size.
+					return -EIO;
+				}
+				info.physBlockAddr += 4;
+				info.z_block_size -= 4;
+			}
+
+			if (info.z_block_size == block_size) {
+				info.z_mode = CompressionMode::None;
+			} else {
+				switch (header.jiso.method) {
+					case JISO_METHOD_LZO:
+						info.z_mode = CompressionMode::LZO;
+						break;
+					case JISO_METHOD_ZLIB:
+						// JISO zlib uses raw deflate.
+						info.z_format = InflateBlock::Format::Raw;
+						info.z_mode = CompressionMode::Deflate;
+						break;
+					default:
+						assert(!"Unsupported JISO compression method.");
+						return -ENOTSUP;
+				}
+			}
+			break;
+#endif /* HAVE_LZO */
+
+		case CisoPspReaderPrivate::CisoType::DAX:
+			info.physBlockAddr = static_cast<off64_t>(indexEntry);
+			if (header.dax.nc_areas > 0 && daxNCTable[blockIdx]) {
+				// Uncompressed block.
+				info.z_mode = CompressionMode::None;
+			} else {
+				// Compressed block.
+				// DAX uses zlib deflate.
+				info.z_format = InflateBlock::Format::Zlib;
+				info.z_mode = CompressionMode::Deflate;
+			}
+			break;
+	}
+
+	uint32_t z_max_size = block_size;
+	if (unlikely(isDaxWithoutNCTable)) {
+		// DAX without NC table can end up compressing to larger
+		// than the uncompressed size.
+		z_max_size *= 2;
+	}
+	if (info.z_block_size > z_max_size) {
+		// Compressed data is larger than the uncompressed block size.
+		// This is only allowed for DAX without NC table.
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/**
+ * Decompress a block.
+ * This function is thread-safe.
+ * @param info		[in] Block information.
+ * @param z_src		[in] Compressed data. (info.z_block_size bytes)
+ * @param pOut		[out] Output buffer. (block_size bytes)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CisoPspReaderPrivate::decompressBlock(const BlockInfo &info, const uint8_t *z_src, uint8_t *pOut) const
+{
+	switch (info.z_mode) {
+		default:
+			assert(!"Compression mode not supported...");
+			return -ENOTSUP;
+
+		case CompressionMode::None:
+			memcpy(pOut, z_src, block_size);
+			break;
+
+		case CompressionMode::Deflate: {
+			// Decompress the data.
+			int ret = InflateBlock::decompress(info.z_format,
+				z_src, info.z_block_size, pOut, block_size);
+			if (ret != 0) {
+				// Decompression error.
+				return ret;
+			}
+			break;
+		}
+
+		case CompressionMode::LZ4: {
+#ifdef HAVE_LZ4
+			// Decompress the data.
+			int size = LZ4_decompress_safe(
+				reinterpret_cast<const char*>(z_src),
+				reinterpret_cast<char*>(pOut),
+				info.z_block_size, block_size);
+			if (size != (int)block_size) {
+				// Decompression error.
+				// TODO: Print warnings and/or more comprehensive error codes.
+				return -EIO;
+			}
+			break;
+#else /* !HAVE_LZ4 */
+			// TODO: If it's CISOv2, check for LZ4-compressed blocks and fail early?
+			assert(!"LZ4 is not enabled in this build.");
+			return -EIO;
+#endif /* HAVE_LZ4 */
+		}
+
+		case CompressionMode::LZO: {
+#ifdef HAVE_LZO
+			// Decompress the data.
+			// TODO: LZO in-place decompression?
+			lzo_uint dst_len = block_size;
+			int ret = lzo1x_decompress_safe(
+				z_src, info.z_block_size,
+				pOut, &dst_len,
+				nullptr);
+			if (ret != LZO_E_OK || dst_len != block_size) {
+				// Decompression error.
+				// TODO: Print warnings and/or more comprehensive error codes.
+				return -EIO;
+			}
+			break;
+#else /* !HAVE_LZO */
+			assert(!"LZO is not enabled in this build.");
+			return -EIO;
+#endif /* HAVE_LZO */
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Decompress a range of blocks.
+ * Used as a ThreadPool::parallelFor() range function.
+ * @param param DecompressJob
+ * @param begin First block index in the job
+ * @param end Last block index in the job, plus one
+ */
+void CisoPspReaderPrivate::decompressRange(void *param, size_t begin, size_t end)
+{
+	const DecompressJob *const job = static_cast<const DecompressJob*>(param);
+	const CisoPspReaderPrivate *const d = job->d;
+
+	for (size_t i = begin; i < end; i++) {
+		const BlockInfo &info = job->infos[i];
+		const uint8_t *const z_src = &job->z_data[info.physBlockAddr - job->z_data_addr];
+		uint8_t *const pOut = &job->pOut[i * d->block_size];
+		if (d->decompressBlock(info, z_src, pOut) == 0) {
+			job->blockOk[i] = 1;
+		}
+	}
+}
+
 /** CisoPspReader **/
 
 CisoPspReader::CisoPspReader(IRpFile *file)
@@ -243,17 +572,12 @@ CisoPspReader::CisoPspReader(IRpFile *file)
 
 		case CisoPspReaderPrivate::CisoType::CISO:
 			isZlib = true;
-			break;
 #ifdef HAVE_LZ4
+			// fall-through
 		case CisoPspReaderPrivate::CisoType::ZISO:
 #endif /* HAVE_LZ4 */
-#if SYS_BYTEORDER != SYS_LIL_ENDIAN
 			// Byteswap the header.
-			d->header.cisoPsp.magic			= le32_to_cpu(d->header.cisoPsp.magic);
-			d->header.cisoPsp.header_size		= le32_to_cpu(d->header.cisoPsp.header_size);
-			d->header.cisoPsp.uncompressed_size	= le64_to_cpu(d->header.cisoPsp.uncompressed_size);
-			d->header.cisoPsp.block_size		= le32_to_cpu(d->header.cisoPsp.block_size);
-#endif /* SYS_BYTEORDER != SYS_LIL_ENDIAN */
+			le_struct_to_cpu(d->header.cisoPsp);
 
 			d->block_size = d->header.cisoPsp.block_size;
 			d->disc_size = d->header.cisoPsp.uncompressed_size;
@@ -281,13 +605,8 @@ CisoPspReader::CisoPspReader(IRpFile *file)
 			}
 #endif /* HAVE_LZO */
 
-#if SYS_BYTEORDER != SYS_LIL_ENDIAN
 			// Byteswap the header.
-			d->header.jiso.magic			= le32_to_cpu(d->header.jiso.magic);
-			d->header.jiso.block_size		= le16_to_cpu(d->header.jiso.block_size);
-			d->header.jiso.uncompressed_size	= le32_to_cpu(d->header.jiso.uncompressed_size);
-			d->header.jiso.header_size		= le32_to_cpu(d->header.jiso.block_size);
-#endif /* SYS_BYTEORDER != SYS_LIL_ENDIAN */
+			le_struct_to_cpu(d->header.jiso);
 
 #ifdef _MSC_VER
 			// Determine which library should be checked
@@ -315,13 +634,8 @@ CisoPspReader::CisoPspReader(IRpFile *file)
 
 		case CisoPspReaderPrivate::CisoType::DAX:
 			isZlib = true;
-#if SYS_BYTEORDER != SYS_LIL_ENDIAN
 			// Byteswap the header.
-			d->header.dax.magic		= le32_to_cpu(d->header.dax.magic);
-			d->header.dax.uncompressed_size	= le32_to_cpu(d->header.dax.uncompressed_size);
-			d->header.dax.version		= le32_to_cpu(d->header.dax.version);
-			d->header.dax.nc_areas		= le32_to_cpu(d->header.dax.nc_areas);
-#endif /* SYS_BYTEORDER != SYS_LIL_ENDIAN */
+			le_struct_to_cpu(d->header.dax);
 
 			d->block_size = DAX_BLOCK_SIZE;
 			d->disc_size = d->header.dax.uncompressed_size;
@@ -758,316 +1072,144 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 	}
 
 	// Get the physical address first.
-	const uint32_t indexEntry = d->indexEntries[blockIdx];
-	uint32_t z_block_size = d->getBlockCompressedSize(blockIdx);
-	if (z_block_size == 0) {
-		// Unable to get the block's compressed size...
-		m_lastError = EIO;
+	CisoPspReaderPrivate::BlockInfo info;
+	int ret = d->getBlockInfo(blockIdx, info);
+	if (ret != 0) {
+		m_lastError = -ret;
 		return 0;
 	}
 
-	enum class CompressionMode {
-		None = 0,
-		Deflate = 1,
-		LZ4 = 2,
-		LZO = 3,
-	};
-	CompressionMode z_mode;
-	int windowBits = 0;
-
-	off64_t physBlockAddr;
-	switch (d->cisoType) {
-		default:
-		case CisoPspReaderPrivate::CisoType::Unknown:
-			assert(!"Unsupported CisoType.");
-			UNREF_AND_NULL_NOCHK(m_file);
-			m_lastError = ENOTSUP;
-			return 0;
-
-		case CisoPspReaderPrivate::CisoType::CISO:
-			// CISO uses raw deflate.
-			windowBits = -15;
-
-			// Mask off the compression bit, and shift the address
-			// based on the index shift.
-			physBlockAddr = static_cast<off64_t>(indexEntry & ~CISO_PSP_V0_NOT_COMPRESSED);
-			physBlockAddr <<= d->index_shift;
-
-			if (d->header.cisoPsp.version < 2) {
-				// CISO v0/v1: Check if compressed.
-				z_mode = (indexEntry & CISO_PSP_V0_NOT_COMPRESSED)
-					? CompressionMode::None
-					: CompressionMode::Deflate;
-
-				if (z_mode == CompressionMode::None) {
-					// (Un)compressed block size must match the actual block size.
-					if (z_block_size != d->block_size) {
-						// Error...
-						m_lastError = EIO;
-						return 0;
-					}
-				}
-			} else {
-				// CISO v2: Check if compressed, and if so, which algorithm.
-				if (z_block_size == d->block_size) {
-					z_mode = CompressionMode::None;
-				} else {
-					z_mode = (indexEntry & CISO_PSP_V2_LZ4_COMPRESSED)
-						? CompressionMode::LZ4
-						: CompressionMode::Deflate;
-				}
-			}
-			break;
-
-#ifdef HAVE_LZ4
-		case CisoPspReaderPrivate::CisoType::ZISO:
-			// ZISO uses LZ4.
-
-			// Mask off the compression bit, and shift the address
-			// based on the index shift.
-			physBlockAddr = static_cast<off64_t>(indexEntry & ~CISO_PSP_V0_NOT_COMPRESSED);
-			physBlockAddr <<= d->index_shift;
-
-			z_mode = (indexEntry & CISO_PSP_V0_NOT_COMPRESSED)
-				? CompressionMode::None
-				: CompressionMode::LZ4;
-			break;
-#endif /* HAVE_LZ4 */
-
-#ifdef HAVE_LZO
-		case CisoPspReaderPrivate::CisoType::JISO:
-			// JISO uses LZO or zlib.
-			// TODO: Verify the rest of this.
-
-			// JISO does *not* indicate compression using the high bit.
-			// Instead, the compressed block size will match the uncompressed
-			// block size, similar to CISOv2.
-			physBlockAddr = static_cast<off64_t>(indexEntry);
-			physBlockAddr <<= d->index_shift;
-
-			if (d->header.jiso.block_headers) {
-				// Block headers are present.
-				// TODO: jiso.exe says this can provide for "faster decompression".
-				if (z_block_size <= 4) {
-					// Incorrect block size.
-					m_lastError = EIO;
-					return 0;
-				}
-				physBlockAddr += 4;
-				z_block_size -= 4;
-			}
-
-			if (z_block_size == d->block_size) {
-				z_mode = CompressionMode::None;
-			} else {
-				switch (d->header.jiso.method) {
-					case JISO_METHOD_LZO:
-						z_mode = CompressionMode::LZO;
-						break;
-					case JISO_METHOD_ZLIB:
-						// JISO zlib uses raw deflate.
-						windowBits = -15;
-						z_mode = CompressionMode::Deflate;
-						break;
-					default:
-						assert(!"Unsupported JISO compression method.");
-						m_lastError = ENOTSUP;
-						return 0;
-				}
-			}
-			break;
-#endif /* HAVE_LZO */
-
-		case CisoPspReaderPrivate::CisoType::DAX:
-			physBlockAddr = static_cast<off64_t>(indexEntry);
-			if (d->header.dax.nc_areas > 0 && d->daxNCTable[blockIdx]) {
-				// Uncompressed block.
-				z_mode = CompressionMode::None;
-			} else {
-				// Compressed block.
-				// DAX uses zlib deflate.
-				windowBits = 15;
-				z_mode = CompressionMode::Deflate;
-			}
-			break;
+	// Uncompressed data is read directly into the cache.
+	// Compressed data is read into a temporary buffer,
+	// then decompressed into the cache.
+	const bool isCompressed = (info.z_mode != CisoPspReaderPrivate::CompressionMode::None);
+	d->blockCacheIdx = ~0U;
+	uint8_t *const z_dest = (isCompressed ? d->z_buffer.data() : d->blockCache.data());
+	size_t sz_read = m_file->readAt(info.physBlockAddr, z_dest, info.z_block_size);
+	if (sz_read != info.z_block_size) {
+		// Seek and/or read error.
+		m_lastError = m_file->lastError();
+		if (m_lastError == 0) {
+			m_lastError = EIO;
+		}
+		return 0;
 	}
 
-	switch (z_mode) {
-		default:
-			assert(!"Compression mode not supported...");
-			m_lastError = ENOTSUP;
+	if (isCompressed) {
+		ret = d->decompressBlock(info, d->z_buffer.data(), d->blockCache.data());
+		if (ret != 0) {
+			// Decompression error.
+			m_lastError = -ret;
 			return 0;
-
-		case CompressionMode::None: {
-			// Reading uncompressed data directly into the cache.
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->blockCache.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				d->blockCacheIdx = ~0U;
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
-				}
-				return 0;
-			}
-			d->blockCacheIdx = blockIdx;
-			break;
 		}
+	}
 
-		case CompressionMode::Deflate: {
-			// Read compressed data into a temporary buffer,
-			// then decompress it.
-			assert(windowBits != 0);
-			if (windowBits == 0) {
-				m_lastError = EINVAL;
-			}
-			uint32_t z_max_size = d->block_size;
-			if (unlikely(d->isDaxWithoutNCTable)) {
-				// DAX without NC table can end up compressing to larger
-				// than the uncompressed size.
-				z_max_size *= 2;
-			}
-			if (z_block_size > z_max_size) {
-				// Compressed data is larger than the uncompressed block size.
-				// This is only allowed for DAX without NC table.
-				m_lastError = EIO;
-				return 0;
-			}
+	// Block has been loaded into the cache.
+	memcpy(ptr, &d->blockCache[pos], size);
+	d->blockCacheIdx = blockIdx;
+	return size;
+}
 
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
-				}
-				return 0;
-			}
+/**
+ * Read multiple full blocks.
+ *
+ * The compressed data for all of the blocks is read at once,
+ * and then the blocks are decompressed in parallel if there's
+ * enough data to make it worthwhile.
+ *
+ * @param blockIdxStart	[in] First block index.
+ * @param blockCount	[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+ * @return Number of blocks read. (If less than blockCount, an error occurred.)
+ */
+unsigned int CisoPspReader::readBlocks(uint32_t blockIdxStart, unsigned int blockCount, void *ptr)
+{
+	RP_D(CisoPspReader);
+	assert(blockCount > 0);
+	if (blockCount == 0) {
+		return 0;
+	}
 
-			// Decompress the data.
-			z_stream z = { };
-			z.next_in = d->z_buffer.data();
-			z.avail_in = z_block_size;
-			z.next_out = d->blockCache.data();
-			z.avail_out = d->block_size;
-			inflateInit2(&z, windowBits);
-
-			int status = inflate(&z, Z_FULL_FLUSH);
-			const uint32_t uncomp_size = d->block_size - z.avail_out;
-			inflateEnd(&z);
-
-			if (status != Z_STREAM_END || uncomp_size != d->block_size) {
-				// Decompression error.
-				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
-				m_lastError = EIO;
-				return 0;
-			}
+	// Get the block information.
+	// The compressed blocks should be stored in order.
+	// If they aren't, read them one at a time instead.
+	unique_ptr<CisoPspReaderPrivate::BlockInfo[]> infos(new CisoPspReaderPrivate::BlockInfo[blockCount]);
+	unsigned int infoCount = 0;
+	off64_t z_end = 0;
+	for (; infoCount < blockCount; infoCount++) {
+		CisoPspReaderPrivate::BlockInfo &info = infos[infoCount];
+		if (d->getBlockInfo(blockIdxStart + infoCount, info) != 0 ||
+		    (infoCount > 0 && info.physBlockAddr < z_end))
+		{
 			break;
 		}
+		z_end = info.physBlockAddr + info.z_block_size;
+	}
+	if (infoCount < 2) {
+		// Not worth reading multiple blocks.
+		return super::readBlocks(blockIdxStart, blockCount, ptr);
+	}
 
-		case CompressionMode::LZ4: {
-#ifdef HAVE_LZ4
-			// Read compressed data into a temporary buffer,
-			// then decompress it.
-			uint32_t z_max_size = d->block_size;
-			if (unlikely(d->isDaxWithoutNCTable)) {
-				// DAX without NC table can end up compressing to larger
-				// than the uncompressed size.
-				z_max_size *= 2;
-			}
-			if (z_block_size > z_max_size) {
-				// Compressed data is larger than the uncompressed block size.
-				// This is only allowed for DAX without NC table.
-				m_lastError = EIO;
-				return 0;
-			}
-
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
-				}
-				return 0;
-			}
-
-			// Decompress the data.
-			int size = LZ4_decompress_safe(
-				reinterpret_cast<const char*>(d->z_buffer.data()),
-				reinterpret_cast<char*>(d->blockCache.data()),
-				z_block_size, d->block_size);
-			if (size != (int)d->block_size) {
-				// Decompression error.
-				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
-				m_lastError = EIO;
-				return 0;
-			}
-			break;
-#else /* !HAVE_LZ4 */
-			// TODO: If it's CISOv2, check for LZ4-compressed blocks and fail early?
-			assert(!"LZ4 is not enabled in this build.");
+	// Read all of the compressed data at once.
+	const off64_t z_start = infos[0].physBlockAddr;
+	const off64_t z_size = z_end - z_start;
+	if (z_size > static_cast<off64_t>(infoCount * d->z_buffer.size())) {
+		// Too much space between blocks.
+		return super::readBlocks(blockIdxStart, blockCount, ptr);
+	}
+	ao::uvector<uint8_t> z_data;
+	z_data.resize(static_cast<size_t>(z_size));
+	size_t sz_read = m_file->readAt(z_start, z_data.data(), z_data.size());
+	if (sz_read != z_data.size()) {
+		// Seek and/or read error.
+		m_lastError = m_file->lastError();
+		if (m_lastError == 0) {
 			m_lastError = EIO;
-			return 0;
-#endif /* HAVE_LZ4 */
 		}
+		return 0;
+	}
 
-		case CompressionMode::LZO: {
-#ifdef HAVE_LZO
-			// Read compressed data into a temporary buffer,
-			// then decompress it.
-			uint32_t z_max_size = d->block_size;
-			if (unlikely(d->isDaxWithoutNCTable)) {
-				// DAX without NC table can end up compressing to larger
-				// than the uncompressed size.
-				z_max_size *= 2;
-			}
-			if (z_block_size > z_max_size) {
-				// Compressed data is larger than the uncompressed block size.
-				// This is only allowed for DAX without NC table.
-				m_lastError = EIO;
-				return 0;
-			}
-
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
-				}
-				return 0;
-			}
+	// Decompress the blocks.
+	unique_ptr<uint8_t[]> blockOk(new uint8_t[infoCount]);
+	memset(blockOk.get(), 0, infoCount);
+	CisoPspReaderPrivate::DecompressJob job;
+	job.d = d;
+	job.infos = infos.get();
+	job.z_data = z_data.data();
+	job.z_data_addr = z_start;
+	job.pOut = static_cast<uint8_t*>(ptr);
+	job.blockCount = infoCount;
+	job.blockOk = blockOk.get();
+
+	if (static_cast<off64_t>(infoCount) * d->block_size >= CisoPspReaderPrivate::PARALLEL_MIN_SIZE) {
+		// Decompress the blocks using the process-wide thread pool.
+		// The calling thread also decompresses blocks.
+		ThreadPool::instance()->parallelFor(0, infoCount,
+			CisoPspReaderPrivate::decompressRange, &job,
+			CisoPspReaderPrivate::PARALLEL_CHUNK_BLOCKS);
+	} else {
+		// Not enough data to make multithreading worthwhile.
+		CisoPspReaderPrivate::decompressRange(&job, 0, infoCount);
+	}
 
-			// Decompress the data.
-			// TODO: LZO in-place decompression?
-			lzo_uint dst_len = d->block_size;
-			int ret = lzo1x_decompress_safe(
-				d->z_buffer.data(), z_block_size,
-				d->blockCache.data(), &dst_len,
-				nullptr);
-			if (ret != LZO_E_OK || dst_len != d->block_size) {
-				// Decompression error.
-				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
-				m_lastError = EIO;
-				return 0;
-			}
-			break;
-#else /* !HAVE_LZO */
-			assert(!"LZO is not enabled in this build.");
-			m_lastError = EIO;
-			return 0;
-#endif /* HAVE_LZO */
-		}
+	// Check for errors.
+	unsigned int blocksOk = 0;
+	while (blocksOk < infoCount && blockOk[blocksOk]) {
+		blocksOk++;
+	}
+	if (blocksOk != infoCount) {
+		// Decompression error.
+		m_lastError = EIO;
+		return blocksOk;
 	}
 
-	// Block has been loaded into the cache.
-	memcpy(ptr, &d->blockCache[pos], size);
-	d->blockCacheIdx = blockIdx;
-	return size;
+	if (infoCount < blockCount) {
+		// Read the rest of the blocks.
+		const size_t sz_done = static_cast<size_t>(infoCount) * d->block_size;
+		blocksOk += super::readBlocks(blockIdxStart + infoCount, blockCount - infoCount,
+			static_cast<uint8_t*>(ptr) + sz_done);
+	}
+	return blocksOk;
 }
 
 }
@@ -77,6 +77,20 @@ class CisoPspReader : public LibRpBase::SparseDiscReader
 		 */
 		ATTR_ACCESS_SIZE(write_only, 4, 5)
 		int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size) final;
+
+		/**
+		 * Read multiple full blocks.
+		 *
+		 * The compressed data for all of the blocks is read at once,
+		 * and then the blocks are decompressed in parallel if there's
+		 * enough data to make it worthwhile.
+		 *
+		 * @param blockIdxStart	[in] First block index.
+		 * @param blockCount	[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+		 * @return Number of blocks read. (If less than blockCount, an error occurred.)
+		 */
+		unsigned int readBlocks(uint32_t blockIdxStart, unsigned int blockCount, void *ptr) final;
 };
 
 }
@@ -15,9 +15,13 @@
 // librpbase
 using namespace LibRpBase;
 
+// C++ includes.
+#include <vector>
+
 // C++ STL classes.
 using std::string;
 using std::unordered_map;
+using std::vector;
 
 namespace LibRomData {
 
@@ -52,6 +56,22 @@ class GcnFstPrivate
 		// IFst::Dir* reference counter.
 		int fstDirCount;
 
+		// Path index.
+		// - Key: Full path, starting with '/', with no trailing slash.
+		// - Value: FST entry index.
+		// The index is built by buildPathIndex(), which is called
+		// automatically after PATH_INDEX_LOOKUP_COUNT lookups.
+		static const unsigned int PATH_INDEX_LOOKUP_COUNT = 4;
+		unordered_map<string, int> pathIndex;
+		unsigned int lookupCount;
+		bool hasPathIndex;
+
+		/**
+		 * Build the path index.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int buildPathIndex(void);
+
 		/**
 		 * Check if an fst_entry is a directory.
 		 * @return True if this is a directory; false if it's a regular file.
@@ -82,7 +102,7 @@ class GcnFstPrivate
 		 * @param path Path. (Absolute paths only!)
 		 * @return fst_entry if found, or nullptr if not.
 		 */
-		const GCN_FST_Entry *find_path(const char *path) const;
+		const GCN_FST_Entry *find_path(const char *path);
 };
 
 /** GcnFstPrivate **/
@@ -95,6 +115,8 @@ GcnFstPrivate::GcnFstPrivate(const uint8_t *fstData, uint32_t len, uint8_t offse
 	, string_table_sz(0)
 	, offsetShift(offsetShift)
 	, fstDirCount(0)
+	, lookupCount(0)
+	, hasPathIndex(false)
 {
 	assert(fstData != nullptr);
 	assert(len >= sizeof(GCN_FST_Entry));
@@ -222,12 +244,82 @@ const GCN_FST_Entry *GcnFstPrivate::entry(int idx, const char **ppszName) const
 	return &fstData[idx];
 }
 
+/**
+ * Build the path index.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GcnFstPrivate::buildPathIndex(void)
+{
+	if (hasPathIndex) {
+		// Path index has already been built.
+		return 0;
+	} else if (!fstData) {
+		// No FST.
+		return -EBADF;
+	}
+
+	const int file_count = static_cast<int>(be32_to_cpu(fstData[0].root_dir.file_count));
+#ifdef HAVE_UNORDERED_MAP_RESERVE
+	pathIndex.reserve(file_count);
+#endif
+
+	// Root directory.
+	pathIndex.emplace("/", 0);
+
+	// Walk the FST in order, keeping track of the current
+	// directory path. Each directory entry is followed by
+	// its contents, up to next_offset.
+	struct DirLevel {
+		int next_idx;		// Index after the last entry in the directory.
+		size_t path_len;	// Length of the parent directory's path.
+	};
+	vector<DirLevel> dirStack;
+	string path;
+	for (int idx = 1; idx < file_count; idx++) {
+		while (!dirStack.empty() && idx >= dirStack.back().next_idx) {
+			// End of this directory.
+			path.resize(dirStack.back().path_len);
+			dirStack.pop_back();
+		}
+
+		const GCN_FST_Entry *const fst_entry = &fstData[idx];
+		const char *const pName = entry_name(fst_entry);
+		if (!pName || pName[0] == 0) {
+			// Empty or NULL name. This is invalid.
+			hasErrors = true;
+			continue;
+		}
+
+		const size_t path_len = path.size();
+		path += '/';
+		path += pName;
+		// NOTE: If a path is listed twice, find_path() would
+		// return the first one, so don't overwrite it.
+		pathIndex.emplace(path, idx);
+
+		if (is_dir(fst_entry)) {
+			int next_idx = static_cast<int>(be32_to_cpu(fst_entry->dir.next_offset));
+			if (next_idx <= idx || next_idx > file_count) {
+				// Invalid directory. Treat it as empty.
+				hasErrors = true;
+				next_idx = idx + 1;
+			}
+			dirStack.push_back({next_idx, path_len});
+		} else {
+			path.resize(path_len);
+		}
+	}
+
+	hasPathIndex = true;
+	return 0;
+}
+
 /**
  * Find a path.
  * @param path Path. (Absolute paths only!)
  * @return fst_entry if found, or nullptr if not.
  */
-const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path) const
+const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path)
 {
 	if (!path) {
 		// Invalid path.
@@ -265,6 +357,24 @@ const GCN_FST_Entry *GcnFstPrivate::find_path(const char *path) const
 		return fst_entry;
 	}
 
+	if (!hasPathIndex && ++lookupCount >= PATH_INDEX_LOOKUP_COUNT) {
+		// Enough lookups have been done that indexing is worth it.
+		buildPathIndex();
+	}
+	if (hasPathIndex) {
+		// Remove empty path components.
+		string key;
+		key.reserve(s_path.size());
+		for (const char chr : s_path) {
+			if (chr == '/' && !key.empty() && key[key.size()-1] == '/')
+				continue;
+			key += chr;
+		}
+
+		auto iter = pathIndex.find(key);
+		return (iter != pathIndex.end() ? &fstData[iter->second] : nullptr);
+	}
+
 	// Skip the initial slash.
 	int idx = 1;	// Ignore the root directory.
 	// NOTE: This is the index *after* the last file.
@@ -577,6 +687,20 @@ int GcnFst::find_file(const char *filename, DirEnt *dirent)
 	return 0;
 }
 
+/**
+ * Build an index of all paths in the FST.
+ *
+ * By default, each path lookup walks the FST. With the index,
+ * find_file() and opendir() use a single hash table lookup.
+ * The index is built automatically after a few lookups.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GcnFst::buildPathIndex(void)
+{
+	return d->buildPathIndex();
+}
+
 /**
  * Get the total size of all files.
  *
@@ -607,4 +731,20 @@ off64_t GcnFst::totalUsedSize(void) const
 	return total_size;
 }
 
+/**
+ * Get the approximate amount of memory used by the FST.
+ * @return Approximate memory usage, in bytes.
+ */
+size_t GcnFst::memoryUsage(void) const
+{
+	size_t total = d->fstData_sz;
+	for (const auto &p : d->u8_string_table) {
+		total += sizeof(p.first) + p.second.size();
+	}
+	for (const auto &p : d->pathIndex) {
+		total += p.first.size() + sizeof(p.second);
+	}
+	return total;
+}
+
 }
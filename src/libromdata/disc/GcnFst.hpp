@@ -81,6 +81,17 @@ class GcnFst : public LibRpBase::IFst
 		 */
 		int find_file(const char *filename, DirEnt *dirent) final;
 
+		/**
+		 * Build an index of all paths in the FST.
+		 *
+		 * By default, each path lookup walks the FST. With the index,
+		 * find_file() and opendir() use a single hash table lookup.
+		 * The index is built automatically after a few lookups.
+		 *
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int buildPathIndex(void) final;
+
 	public:
 		/**
 		 * Get the total size of all files.
@@ -91,6 +102,12 @@ class GcnFst : public LibRpBase::IFst
 		 * @return Size of all files, in bytes. (-1 on error)
 		 */
 		off64_t totalUsedSize(void) const;
+
+		/**
+		 * Get the approximate amount of memory used by the FST.
+		 * @return Approximate memory usage, in bytes.
+		 */
+		size_t memoryUsage(void) const;
 };
 
 }
@@ -72,6 +72,31 @@ size_t GcnPartition::read(void *ptr, size_t size)
 	return m_discReader->read(ptr, size);
 }
 
+/**
+ * Read data from the partition at the specified position.
+ * The partition position is not changed.
+ * @param pos	[in] Partition position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t GcnPartition::readAt(off64_t pos, void *ptr, size_t size)
+{
+	RP_D(const GcnPartition);
+	assert(m_discReader != nullptr);
+	assert(m_discReader->isOpen());
+	if (!m_discReader || !m_discReader->isOpen()) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	// GCN partitions are stored as-is.
+	// TODO: data_size checks?
+	size_t ret = m_discReader->readAt(d->data_offset + pos, ptr, size);
+	m_lastError = m_discReader->lastError();
+	return ret;
+}
+
 /**
  * Set the partition position.
  * @param pos Partition position.
@@ -129,6 +154,16 @@ off64_t GcnPartition::size(void)
 	return d->data_size;
 }
 
+/**
+ * Get the natural block size of the partition.
+ * This is the underlying disc image's block size.
+ * @return Block size, in bytes, or 0 if there isn't a natural block size.
+ */
+unsigned int GcnPartition::blockSize(void) const
+{
+	return (m_discReader ? m_discReader->blockSize() : 0);
+}
+
 /** IPartition **/
 
 /**
@@ -189,6 +224,28 @@ off64_t GcnPartition::partition_size_used(void) const
 	return size;
 }
 
+/**
+ * Get the approximate amount of memory used by
+ * cached metadata, e.g. directory tables or the FST.
+ * @return Approximate memory usage, in bytes.
+ */
+size_t GcnPartition::memoryUsage(void) const
+{
+	RP_D(const GcnPartition);
+	return (d->fst ? d->fst->memoryUsage() : 0);
+}
+
+/**
+ * Release cached metadata.
+ * It will be reloaded on demand.
+ */
+void GcnPartition::releaseMemory(void)
+{
+	RP_D(GcnPartition);
+	delete d->fst;
+	d->fst = nullptr;
+}
+
 /** GcnPartition **/
 
 /** GcnFst wrapper functions. **/
@@ -55,6 +55,17 @@ class GcnPartition : public LibRpBase::IPartition
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) override;
 
+		/**
+		 * Read data from the partition at the specified position.
+		 * The partition position is not changed.
+		 * @param pos	[in] Partition position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) override;
+
 		/**
 		 * Set the partition position.
 		 * @param pos Partition position.
@@ -76,6 +87,13 @@ class GcnPartition : public LibRpBase::IPartition
 		 */
 		off64_t size(void) final;
 
+		/**
+		 * Get the natural block size of the partition.
+		 * This is the underlying disc image's block size.
+		 * @return Block size, in bytes, or 0 if there isn't a natural block size.
+		 */
+		unsigned int blockSize(void) const override;
+
 	public:
 		/** IPartition **/
 
@@ -94,6 +112,20 @@ class GcnPartition : public LibRpBase::IPartition
 		 */
 		off64_t partition_size_used(void) const override;
 
+	public:
+		/**
+		 * Get the approximate amount of memory used by
+		 * cached metadata, e.g. directory tables or the FST.
+		 * @return Approximate memory usage, in bytes.
+		 */
+		size_t memoryUsage(void) const override;
+
+		/**
+		 * Release cached metadata.
+		 * It will be reloaded on demand.
+		 */
+		void releaseMemory(void) override;
+
 	public:
 		/** IFst wrapper functions. **/
 
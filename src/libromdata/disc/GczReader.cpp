@@ -16,6 +16,10 @@
 #include "GczReader.hpp"
 #include "librpbase/disc/SparseDiscReader_p.hpp"
 #include "gcz_structs.h"
+#include "InflateBlock.hpp"
+
+// librpcpu
+#include "librpcpu/byteswap_struct.hpp"
 
 // zlib
 #include <zlib.h>
@@ -31,6 +35,15 @@ using LibRpFile::IRpFile;
 // C++ STL classes.
 using std::unique_ptr;
 
+// GCZ header byteswap layout.
+RP_BYTESWAP_LAYOUT(GczHeader,
+	RP_BYTESWAP_FIELD(GczHeader, magic),
+	RP_BYTESWAP_FIELD(GczHeader, sub_type),
+	RP_BYTESWAP_FIELD(GczHeader, z_data_size),
+	RP_BYTESWAP_FIELD(GczHeader, data_size),
+	RP_BYTESWAP_FIELD(GczHeader, block_size),
+	RP_BYTESWAP_FIELD(GczHeader, num_blocks))
+
 namespace LibRomData {
 
 #ifdef _MSC_VER
@@ -83,6 +96,9 @@ GczReaderPrivate::GczReaderPrivate(GczReader *q)
 	, blockCacheIdx(~0U)
 	, dataOffset(0)
 {
+	// readBlock() is overridden.
+	rawBlocks = false;
+
 	// Clear the GCZ header struct.
 	memset(&gczHeader, 0, sizeof(gczHeader));
 }
@@ -155,15 +171,8 @@ GczReader::GczReader(IRpFile *file)
 		return;
 	}
 
-#if SYS_BYTEORDER != SYS_LIL_ENDIAN
 	// Byteswap the header.
-	d->gczHeader.magic	= le32_to_cpu(d->gczHeader.magic);
-	d->gczHeader.sub_type	= le32_to_cpu(d->gczHeader.sub_type);
-	d->gczHeader.z_data_size = le32_to_cpu(d->gczHeader.z_data_size);
-	d->gczHeader.data_size	= le32_to_cpu(d->gczHeader.data_size);
-	d->gczHeader.block_size = le32_to_cpu(d->gczHeader.block_size);
-	d->gczHeader.num_blocks = le32_to_cpu(d->gczHeader.num_blocks);
-#endif /* SYS_BYTEORDER != SYS_LIL_ENDIAN */
+	le_struct_to_cpu(d->gczHeader);
 
 	// Check if the block size is a supported power of two.
 	// - Minimum: GCZ_BLOCK_SIZE_MIN (32 KB, 1 << 15)
@@ -449,7 +458,7 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 			memset(d->blockCache.data(), 0, d->blockCache.size());
 		}
 
-		size_t sz_read = m_file->seekAndRead(physBlockAddr, d->blockCache.data(), z_block_size);
+		size_t sz_read = m_file->readAt(physBlockAddr, d->blockCache.data(), z_block_size);
 		if (sz_read != z_block_size && !isLastBlock) {
 			// Seek and/or read error.
 			d->blockCacheIdx = ~0U;
@@ -469,7 +478,7 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 			return 0;
 		}
 
-		size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
+		size_t sz_read = m_file->readAt(physBlockAddr, d->z_buffer.data(), z_block_size);
 		if (sz_read != z_block_size) {
 			// Seek and/or read error.
 			m_lastError = m_file->lastError();
@@ -490,22 +499,14 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 		}
 
 		// Decompress the data.
-		z_stream z = { };
-		z.next_in = d->z_buffer.data();
-		z.avail_in = z_block_size;
-		z.next_out = d->blockCache.data();
-		z.avail_out = d->block_size;
-		inflateInit(&z);
-
-		int status = inflate(&z, Z_FULL_FLUSH);
-		const uint32_t uncomp_size = d->block_size - z.avail_out;
-		inflateEnd(&z);
-
-		if (status != Z_STREAM_END || uncomp_size != d->block_size) {
+		// GCZ blocks are zlib streams.
+		int ret = InflateBlock::decompress(InflateBlock::Format::Zlib,
+			d->z_buffer.data(), z_block_size, d->blockCache.data(), d->block_size);
+		if (ret != 0) {
 			// Decompression error.
 			// TODO: Print warnings and/or more comprehensive error codes.
 			d->blockCacheIdx = ~0U;
-			m_lastError = EIO;
+			m_lastError = -ret;
 			return 0;
 		}
 	}
@@ -55,7 +55,8 @@ class GdiReaderPrivate : public SparseDiscReaderPrivate {
 			uint8_t reserved;
 			// TODO: Data vs. audio?
 			string filename;		// Relative to the .gdi file. Cleared on error.
-			IRpFile *file;
+			IRpFile *file;			// nullptr if the track isn't open.
+			uint32_t lastUse;		// Last use. (for LRU replacement)
 		};
 		vector<BlockRange> blockRanges;
 
@@ -64,6 +65,21 @@ class GdiReaderPrivate : public SparseDiscReaderPrivate {
 		// Value = pointer to BlockRange in blockRanges.
 		vector<BlockRange*> trackMappings;
 
+		// Open track files. (LRU)
+		// Only MAX_OPEN_TRACKS track files are kept open at once.
+		// Closed tracks keep their blockEnd, so they don't have
+		// to be reopened to find out which blocks they contain.
+		static const unsigned int MAX_OPEN_TRACKS = 4;
+		unsigned int openTrackCount;
+		uint32_t trackUseCounter;
+
+		// Block range used by the last findBlockRange() call.
+		BlockRange *lastBlockRange;
+
+		// Maximum number of 2352-byte sectors to read at once
+		// in readBlocks(). (32 sectors is ~74 KiB)
+		static const unsigned int SECTOR_BATCH_COUNT = 32;
+
 		/**
 		 * Close all opened files.
 		 */
@@ -83,14 +99,31 @@ class GdiReaderPrivate : public SparseDiscReaderPrivate {
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
 		int openTrack(int trackNumber);
+
+		/**
+		 * Find the block range containing the specified block.
+		 * The track is opened if necessary.
+		 * @param blockIdx Block index.
+		 * @return Block range, or nullptr if the block isn't in a data track.
+		 */
+		BlockRange *findBlockRange(uint32_t blockIdx);
 };
 
 /** GdiReaderPrivate **/
 
+// Out-of-class definition, since it's passed by reference to std::min().
+const unsigned int GdiReaderPrivate::SECTOR_BATCH_COUNT;
+
 GdiReaderPrivate::GdiReaderPrivate(GdiReader *q)
 	: super(q)
 	, blockCount(0)
-{ }
+	, openTrackCount(0)
+	, trackUseCounter(0)
+	, lastBlockRange(nullptr)
+{
+	// readBlock() is overridden.
+	rawBlocks = false;
+}
 
 GdiReaderPrivate::~GdiReaderPrivate()
 {
@@ -109,6 +142,8 @@ void GdiReaderPrivate::close(void)
 	);
 	blockRanges.clear();
 	trackMappings.clear();
+	openTrackCount = 0;
+	lastBlockRange = nullptr;
 
 	// GDI file.
 	RP_Q(GdiReader);
@@ -217,6 +252,7 @@ int GdiReaderPrivate::parseGdiFile(char *gdibuf)
 		filename[sizeof(filename)-1] = 0;
 		blockRange.filename = latin1_to_utf8(filename, -1);
 		blockRange.file = nullptr;
+		blockRange.lastUse = 0;
 
 		// Save the track mapping.
 		trackMappings[trackNumber-1] = &blockRange;
@@ -256,9 +292,24 @@ int GdiReaderPrivate::openTrack(int trackNumber)
 
 	if (blockRange->file) {
 		// File is already open.
+		blockRange->lastUse = ++trackUseCounter;
 		return 0;
 	}
 
+	if (openTrackCount >= MAX_OPEN_TRACKS) {
+		// Too many open tracks. Close the least recently used track.
+		BlockRange *lru = nullptr;
+		for (BlockRange &br : blockRanges) {
+			if (br.file && (!lru || br.lastUse < lru->lastUse)) {
+				lru = &br;
+			}
+		}
+		if (lru) {
+			UNREF_AND_NULL_NOCHK(lru->file);
+			openTrackCount--;
+		}
+	}
+
 	// Separate the file extension.
 	string basename = blockRange->filename;
 	string ext;
@@ -297,9 +348,53 @@ int GdiReaderPrivate::openTrack(int trackNumber)
 	// File opened.
 	blockRange->blockEnd = blockRange->blockStart + static_cast<unsigned int>(fileSize / blockRange->sectorSize) - 1;
 	blockRange->file = file;
+	blockRange->lastUse = ++trackUseCounter;
+	openTrackCount++;
 	return 0;
 }
 
+/**
+ * Find the block range containing the specified block.
+ * The track is opened if necessary.
+ * @param blockIdx Block index.
+ * @return Block range, or nullptr if the block isn't in a data track.
+ */
+GdiReaderPrivate::BlockRange *GdiReaderPrivate::findBlockRange(uint32_t blockIdx)
+{
+	BlockRange *blockRange = lastBlockRange;
+	if (!blockRange || blockIdx < blockRange->blockStart || blockIdx > blockRange->blockEnd) {
+		// Find the track with the highest starting LBA
+		// that's at or before the requested block.
+		// NOTE: Tracks don't overlap, so there's no need to open
+		// any other tracks to check their end blocks.
+		blockRange = nullptr;
+		for (BlockRange &br : blockRanges) {
+			if (blockIdx >= br.blockStart &&
+			    (!blockRange || br.blockStart > blockRange->blockStart))
+			{
+				blockRange = &br;
+			}
+		}
+		if (!blockRange) {
+			// Not found in any block range.
+			return nullptr;
+		}
+	}
+
+	// Make sure the track is open.
+	// This also sets blockEnd if the track wasn't opened before.
+	if (openTrack(blockRange->trackNumber) != 0) {
+		// Unable to open the track.
+		return nullptr;
+	} else if (blockIdx > blockRange->blockEnd) {
+		// Block is past the end of the track.
+		return nullptr;
+	}
+
+	lastBlockRange = blockRange;
+	return blockRange;
+}
+
 /** GdiReader **/
 
 GdiReader::GdiReader(IRpFile *file)
@@ -455,7 +550,8 @@ int GdiReader::isDiscSupported(const uint8_t *pHeader, size_t szHeader) const
 /**
  * Get the physical address of the specified logical block index.
  *
- * NOTE: Not implemented in this subclass.
+ * NOTE: Not implemented in this subclass, since each track
+ * is stored in a separate file.
  *
  * @param blockIdx	[in] Block index.
  * @return Physical block address. (-1 due to not being implemented)
@@ -463,7 +559,6 @@ int GdiReader::isDiscSupported(const uint8_t *pHeader, size_t szHeader) const
 off64_t GdiReader::getPhysBlockAddr(uint32_t blockIdx) const
 {
 	RP_UNUSED(blockIdx);
-	assert(!"GdiReader::getPhysBlockAddr() is not implemented.");
 	return -1;
 }
 
@@ -505,36 +600,7 @@ int GdiReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 	}
 
 	// Find the block.
-	// TODO: Cache this lookup somewhere or something.
-	const GdiReaderPrivate::BlockRange *blockRange = nullptr;
-	const auto blockRanges_cend = d->blockRanges.cend();
-	for (auto iter = d->blockRanges.cbegin(); iter != blockRanges_cend; ++iter) {
-		// NOTE: Using volatile because it can change in d->openTrack().
-		const volatile GdiReaderPrivate::BlockRange *const vbr = &(*iter);
-		if (blockIdx < vbr->blockStart) {
-			// Not in this track.
-			continue;
-		}
-
-		// Is the track loaded?
-		if (vbr->blockEnd == 0) {
-			// Track isn't loaded. Load it.
-			int ret = d->openTrack(vbr->trackNumber);
-			if (ret != 0) {
-				// Unable to load the track.
-				// Skip for now.
-				continue;
-			}
-		}
-
-		// Check the end block.
-		if (vbr->blockEnd != 0 && blockIdx <= vbr->blockEnd) {
-			// Found the track.
-			blockRange = (const GdiReaderPrivate::BlockRange*)vbr;
-			break;
-		}
-	}
-
+	const GdiReaderPrivate::BlockRange *const blockRange = d->findBlockRange(blockIdx);
 	if (!blockRange) {
 		// Not found in any block range.
 		return 0;
@@ -552,7 +618,7 @@ int GdiReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 		// 2352-byte sectors.
 		// TODO: Handle audio tracks properly?
 		CDROM_2352_Sector_t sector;
-		size_t sz_read = blockRange->file->seekAndRead(phys_pos, &sector, sizeof(sector));
+		size_t sz_read = blockRange->file->readAt(phys_pos, &sector, sizeof(sector));
 		m_lastError = blockRange->file->lastError();
 		if (sz_read != sizeof(sector)) {
 			// Read error.
@@ -566,10 +632,87 @@ int GdiReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 	}
 
 	// 2048-byte sectors.
-	size_t sz_read = blockRange->file->seekAndRead(phys_pos, ptr, size);
+	size_t sz_read = blockRange->file->readAt(phys_pos + pos, ptr, size);
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read multiple full blocks.
+ *
+ * Consecutive sectors within each track are read using a single read.
+ * For 2352-byte sectors, the user data sections are copied out.
+ *
+ * @param blockIdxStart	[in] First block index.
+ * @param blockCount	[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+ * @return Number of blocks read. (If less than blockCount, an error occurred.)
+ */
+unsigned int GdiReader::readBlocks(uint32_t blockIdxStart, unsigned int blockCount, void *ptr)
+{
+	RP_D(GdiReader);
+	assert(blockCount > 0);
+	if (blockCount == 0) {
+		return 0;
+	}
+
+	// Buffer for 2352-byte sectors. (allocated on first use)
+	unique_ptr<uint8_t[]> buf;
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	unsigned int blocksOk = 0;
+	while (blocksOk < blockCount) {
+		const uint32_t blockIdx = blockIdxStart + blocksOk;
+		const GdiReaderPrivate::BlockRange *const blockRange = d->findBlockRange(blockIdx);
+		if (!blockRange) {
+			// Not found in any block range.
+			break;
+		}
+		IRpFile *const file = blockRange->file;
+		assert(file != nullptr);
+
+		// Read as many blocks as possible from this track.
+		const unsigned int count = std::min(blockCount - blocksOk,
+			blockRange->blockEnd - blockIdx + 1);
+		const off64_t phys_pos = static_cast<off64_t>(blockIdx - blockRange->blockStart) * blockRange->sectorSize;
+		unsigned int trackBlocksOk = 0;
+		if (blockRange->sectorSize == 2352) {
+			// 2352-byte sectors.
+			if (!buf) {
+				buf.reset(new uint8_t[GdiReaderPrivate::SECTOR_BATCH_COUNT * 2352U]);
+			}
+			while (trackBlocksOk < count) {
+				const unsigned int batchCount = std::min(count - trackBlocksOk,
+					GdiReaderPrivate::SECTOR_BATCH_COUNT);
+				const size_t sz_read = file->readAt(phys_pos + (trackBlocksOk * 2352U),
+					buf.get(), batchCount * 2352U);
+
+				// NOTE: Sector user data area position depends on the sector mode.
+				const unsigned int sectorsRead = static_cast<unsigned int>(sz_read / 2352U);
+				cdromCopySectorData(ptr8 + (trackBlocksOk * 2048U), buf.get(), 2352U, sectorsRead);
+				trackBlocksOk += sectorsRead;
+				if (sectorsRead != batchCount) {
+					// Read error.
+					break;
+				}
+			}
+		} else {
+			// 2048-byte sectors.
+			const size_t sz_read = file->readAt(phys_pos, ptr8, count * 2048U);
+			trackBlocksOk = static_cast<unsigned int>(sz_read / 2048U);
+		}
+		m_lastError = file->lastError();
+
+		ptr8 += trackBlocksOk * 2048U;
+		blocksOk += trackBlocksOk;
+		if (trackBlocksOk != count) {
+			// Read error.
+			break;
+		}
+	}
+
+	return blocksOk;
+}
+
 /** GDI-specific functions. **/
 // TODO: "CdromReader" class?
 
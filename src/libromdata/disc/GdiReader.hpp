@@ -61,7 +61,8 @@ class GdiReader : public LibRpBase::SparseDiscReader
 		/**
 		 * Get the physical address of the specified logical block index.
 		 *
-		 * NOTE: Not implemented in this subclass.
+		 * NOTE: Not implemented in this subclass, since each track
+		 * is stored in a separate file.
 		 *
 		 * @param blockIdx	[in] Block index.
 		 * @return Physical block address. (-1 due to not being implemented)
@@ -83,6 +84,19 @@ class GdiReader : public LibRpBase::SparseDiscReader
 		ATTR_ACCESS_SIZE(write_only, 4, 5)
 		int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size) final;
 
+		/**
+		 * Read multiple full blocks.
+		 *
+		 * Consecutive sectors within each track are read using a single read.
+		 * For 2352-byte sectors, the user data sections are copied out.
+		 *
+		 * @param blockIdxStart	[in] First block index.
+		 * @param blockCount	[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+		 * @return Number of blocks read. (If less than blockCount, an error occurred.)
+		 */
+		unsigned int readBlocks(uint32_t blockIdxStart, unsigned int blockCount, void *ptr) final;
+
 	public:
 		/** GDI-specific functions. **/
 
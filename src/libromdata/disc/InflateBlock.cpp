@@ -0,0 +1,113 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * InflateBlock.cpp: Decompress complete deflate streams.                  *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.libromdata.h"
+#include "InflateBlock.hpp"
+
+// zlib
+#include <zlib.h>
+
+#ifdef HAVE_LIBDEFLATE
+// libdeflate
+#  include <libdeflate.h>
+#endif /* HAVE_LIBDEFLATE */
+
+// C++ includes.
+#include <memory>
+
+// C++ STL classes.
+using std::unique_ptr;
+
+namespace LibRomData { namespace InflateBlock {
+
+#ifdef HAVE_LIBDEFLATE
+struct DecompressorDeleter {
+	void operator()(struct libdeflate_decompressor *p) const
+	{
+		libdeflate_free_decompressor(p);
+	}
+};
+
+/**
+ * Get this thread's libdeflate decompressor.
+ * libdeflate decompressors can't be shared between threads,
+ * so one is allocated for each thread on first use.
+ * @return libdeflate decompressor, or nullptr on error.
+ */
+static struct libdeflate_decompressor *getDecompressor(void)
+{
+	static thread_local unique_ptr<struct libdeflate_decompressor, DecompressorDeleter> tls_decompressor;
+	if (!tls_decompressor) {
+		tls_decompressor.reset(libdeflate_alloc_decompressor());
+	}
+	return tls_decompressor.get();
+}
+#endif /* HAVE_LIBDEFLATE */
+
+/**
+ * Decompress a complete deflate stream into a buffer of known size.
+ *
+ * This is intended for compressed disc image blocks, where both
+ * the compressed and uncompressed sizes are known in advance.
+ * If libdeflate is available, it will be used, since it's
+ * significantly faster than zlib for one-shot decompression.
+ * zlib is used as a fallback.
+ *
+ * This function is thread-safe.
+ *
+ * @param format	[in] Compressed data format.
+ * @param pIn		[in] Compressed data.
+ * @param inSize	[in] Size of the compressed data.
+ * @param pOut		[out] Output buffer.
+ * @param outSize	[in] Expected uncompressed size.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int decompress(Format format, const uint8_t *pIn, size_t inSize, uint8_t *pOut, size_t outSize)
+{
+	assert(pIn != nullptr);
+	assert(pOut != nullptr);
+
+#ifdef HAVE_LIBDEFLATE
+	struct libdeflate_decompressor *const decompressor = getDecompressor();
+	if (decompressor) {
+		// NOTE: actual_out_nbytes_ret is nullptr, so libdeflate
+		// fails if the output isn't exactly outSize bytes.
+		const enum libdeflate_result res = (format == Format::Zlib)
+			? libdeflate_zlib_decompress(decompressor, pIn, inSize, pOut, outSize, nullptr)
+			: libdeflate_deflate_decompress(decompressor, pIn, inSize, pOut, outSize, nullptr);
+		if (res == LIBDEFLATE_SUCCESS) {
+			return 0;
+		}
+		// libdeflate is stricter than zlib about some malformed
+		// streams, so try again using zlib before giving up.
+	}
+#endif /* HAVE_LIBDEFLATE */
+
+	z_stream z = { };
+	z.next_in = const_cast<Bytef*>(pIn);
+	z.avail_in = static_cast<uInt>(inSize);
+	z.next_out = pOut;
+	z.avail_out = static_cast<uInt>(outSize);
+	if (inflateInit2(&z, (format == Format::Zlib) ? 15 : -15) != Z_OK) {
+		return -ENOMEM;
+	}
+
+	const int status = inflate(&z, Z_FULL_FLUSH);
+	const size_t uncomp_size = outSize - z.avail_out;
+	inflateEnd(&z);
+
+	if (status != Z_STREAM_END || uncomp_size != outSize) {
+		// Decompression error.
+		// TODO: Print warnings and/or more comprehensive error codes.
+		return -EIO;
+	}
+	return 0;
+}
+
+} }
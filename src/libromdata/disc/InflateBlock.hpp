@@ -0,0 +1,48 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * InflateBlock.hpp: Decompress complete deflate streams.                  *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_DISC_INFLATEBLOCK_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_DISC_INFLATEBLOCK_HPP__
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+namespace LibRomData { namespace InflateBlock {
+
+/**
+ * Compressed data format.
+ */
+enum class Format {
+	Raw,	// Raw deflate. (no header)
+	Zlib,	// zlib header and Adler-32 trailer
+};
+
+/**
+ * Decompress a complete deflate stream into a buffer of known size.
+ *
+ * This is intended for compressed disc image blocks, where both
+ * the compressed and uncompressed sizes are known in advance.
+ * If libdeflate is available, it will be used, since it's
+ * significantly faster than zlib for one-shot decompression.
+ * zlib is used as a fallback.
+ *
+ * This function is thread-safe.
+ *
+ * @param format	[in] Compressed data format.
+ * @param pIn		[in] Compressed data.
+ * @param inSize	[in] Size of the compressed data.
+ * @param pOut		[out] Output buffer.
+ * @param outSize	[in] Expected uncompressed size.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int decompress(Format format, const uint8_t *pIn, size_t inSize, uint8_t *pOut, size_t outSize);
+
+} }
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_DISC_INFLATEBLOCK_HPP__ */
@@ -24,7 +24,8 @@ class IsoPartitionPrivate
 {
 	public:
 		IsoPartitionPrivate(IsoPartition *q,
-			off64_t partition_offset, int iso_start_offset);
+			off64_t partition_offset, int iso_start_offset,
+			const ISO_Primary_Volume_Descriptor *pPvd);
 		~IsoPartitionPrivate();
 
 	private:
@@ -44,13 +45,66 @@ class IsoPartitionPrivate
 		// ISO primary volume descriptor.
 		ISO_Primary_Volume_Descriptor pvd;
 
-		// Directories.
-		// - Key: Directory name, WITHOUT leading slash. (Root == empty string)
-		// - Value: Directory entries.
+		// Directory entries.
 		// NOTE: Directory entries are variable-length, so this
 		// is a byte array, not an ISO_DirEntry array.
 		typedef ao::uvector<uint8_t> DirData_t;
-		unordered_map<string, DirData_t> dir_data;
+
+		struct DirIndexEntry {
+			uint32_t offset;	// Offset of the ISO_DirEntry in the directory data.
+			bool hasVersion;	// True if ";1" was removed to form the key.
+		};
+
+		struct Directory {
+			DirData_t data;
+
+			// Name index.
+			// - Key: Filename, in uppercase. (cp1252)
+			// - Value: Directory entry.
+			// Filenames ending with ";1" are indexed both
+			// with and without the version suffix.
+			unordered_map<string, DirIndexEntry> index;
+		};
+
+		// Directories.
+		// - Key: Directory path, in uppercase, WITHOUT leading or trailing slashes. (Root == empty string)
+		// - Value: Directory.
+		unordered_map<string, Directory> dir_data;
+
+		// Path table.
+		// - Key: Directory path, in the same format as dir_data.
+		// - Value: Starting block of the directory.
+		unordered_map<string, uint32_t> path_table;
+		bool path_table_loaded;
+
+		/**
+		 * Normalize a path for use as a dir_data key.
+		 * Leading, trailing, and duplicate slashes are removed,
+		 * backslashes are converted to slashes, and ASCII letters
+		 * are converted to uppercase.
+		 * @param path Path. (cp1252)
+		 * @param len Length of path, or -1 for NULL-terminated.
+		 * @return Normalized path.
+		 */
+		static string normalizePath(const char *path, int len = -1);
+
+		/**
+		 * Load the path table.
+		 * This allows any directory to be loaded without
+		 * loading all of its parent directories first.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadPathTable(void);
+
+		/**
+		 * Load a directory and build its name index.
+		 * @param key	[in] Normalized directory path.
+		 * @param block	[in] Starting block.
+		 * @param size	[in] Directory size, or 0 to get it from the directory's "." entry.
+		 * @param pError	[out] POSIX error code on error.
+		 * @return Directory on success; nullptr on error.
+		 */
+		const Directory *loadDirectory(string &&key, uint32_t block, uint32_t size, int *pError);
 
 		/**
 		 * Find the last slash or backslash in a path.
@@ -76,7 +130,7 @@ class IsoPartitionPrivate
 		 * @param bFindDir	[in] True to find a subdirectory; false to find a file.
 		 * @return ISO directory entry.
 		 */
-		const ISO_DirEntry *lookup_int(const DirData_t *pDir, const char *filename, bool bFindDir);
+		const ISO_DirEntry *lookup_int(const Directory *pDir, const char *filename, bool bFindDir);
 
 		/**
 		 * Get a directory.
@@ -84,7 +138,7 @@ class IsoPartitionPrivate
 		 * @param pError	[out] POSIX error code on error.
 		 * @return Directory on success; nullptr on error.
 		 */
-		const DirData_t *getDirectory(const char *path, int *pError = nullptr);
+		const Directory *getDirectory(const char *path, int *pError = nullptr);
 
 		/**
 		 * Look up a directory entry from a filename.
@@ -104,11 +158,13 @@ class IsoPartitionPrivate
 /** IsoPartitionPrivate **/
 
 IsoPartitionPrivate::IsoPartitionPrivate(IsoPartition *q,
-	off64_t partition_offset, int iso_start_offset)
+	off64_t partition_offset, int iso_start_offset,
+	const ISO_Primary_Volume_Descriptor *pPvd)
 	: q_ptr(q)
 	, partition_offset(partition_offset)
 	, partition_size(0)
 	, iso_start_offset(iso_start_offset)
+	, path_table_loaded(false)
 {
 	// Clear the PVD struct.
 	memset(&pvd, 0, sizeof(pvd));
@@ -128,14 +184,19 @@ IsoPartitionPrivate::IsoPartitionPrivate(IsoPartition *q,
 	// Calculated partition size.
 	partition_size = q->m_discReader->size() - partition_offset;
 
-	// Load the primary volume descriptor.
-	// TODO: Assuming this is the first one.
-	// Check for multiple?
-	size_t size = q->m_discReader->seekAndRead(partition_offset + ISO_PVD_ADDRESS_2048, &pvd, sizeof(pvd));
-	if (size != sizeof(pvd)) {
-		// Seek and/or read error.
-		UNREF_AND_NULL_NOCHK(q->m_discReader);
-		return;
+	if (pPvd) {
+		// The caller already read the primary volume descriptor.
+		memcpy(&pvd, pPvd, sizeof(pvd));
+	} else {
+		// Load the primary volume descriptor.
+		// TODO: Assuming this is the first one.
+		// Check for multiple?
+		size_t size = q->m_discReader->seekAndRead(partition_offset + ISO_PVD_ADDRESS_2048, &pvd, sizeof(pvd));
+		if (size != sizeof(pvd)) {
+			// Seek and/or read error.
+			UNREF_AND_NULL_NOCHK(q->m_discReader);
+			return;
+		}
 	}
 
 	// Verify the signature and volume descriptor type.
@@ -155,26 +216,225 @@ IsoPartitionPrivate::~IsoPartitionPrivate()
 { }
 
 /**
- * Look up a directory entry from a base filename and directory.
- * @param pDir		[in] Directory.
- * @param filename	[in] Base filename. (cp1252)
- * @param bFindDir	[in] True to find a subdirectory; false to find a file.
- * @return ISO directory entry.
+ * Normalize a path for use as a dir_data key.
+ * Leading, trailing, and duplicate slashes are removed,
+ * backslashes are converted to slashes, and ASCII letters
+ * are converted to uppercase.
+ * @param path Path. (cp1252)
+ * @param len Length of path, or -1 for NULL-terminated.
+ * @return Normalized path.
  */
-const ISO_DirEntry *IsoPartitionPrivate::lookup_int(const DirData_t *pDir, const char *filename, bool bFindDir)
+string IsoPartitionPrivate::normalizePath(const char *path, int len)
 {
-	// Find the file in the directory.
-	// NOTE: Filenames are case-insensitive.
-	// NOTE: File might have a ";1" suffix.
-	int err = ENOENT;
-	const unsigned int filename_len = static_cast<unsigned int>(strlen(filename));
-	const ISO_DirEntry *dirEntry_found = nullptr;
-	const uint8_t *p = pDir->data();
-	const uint8_t *const p_end = p + pDir->size();
-	while (p < p_end) {
-		const ISO_DirEntry *dirEntry = reinterpret_cast<const ISO_DirEntry*>(p);
-		if (dirEntry->entry_length < sizeof(*dirEntry)) {
-			// End of directory.
+	string key;
+	if (!path) {
+		return key;
+	}
+	const char *const p_end = (len >= 0 ? path + len : path + strlen(path));
+	key.reserve(p_end - path);
+	for (; path < p_end; path++) {
+		char chr = *path;
+		if (chr == '\\') {
+			chr = '/';
+		} else if (chr >= 'a' && chr <= 'z') {
+			chr &= ~0x20;
+		}
+
+		if (chr == '/' && (key.empty() || key[key.size()-1] == '/')) {
+			// Leading or duplicate slash.
+			continue;
+		}
+		key += chr;
+	}
+
+	// Remove the trailing slash.
+	if (!key.empty() && key[key.size()-1] == '/') {
+		key.resize(key.size()-1);
+	}
+	return key;
+}
+
+/**
+ * Load the path table.
+ * This allows any directory to be loaded without
+ * loading all of its parent directories first.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int IsoPartitionPrivate::loadPathTable(void)
+{
+	if (path_table_loaded) {
+		// Path table was already loaded.
+		// NOTE: If it failed to load, it will be empty.
+		return (!path_table.empty() ? 0 : -ENOENT);
+	}
+	path_table_loaded = true;
+
+	RP_Q(IsoPartition);
+	if (!q->m_discReader || iso_start_offset < 0) {
+		return -EIO;
+	}
+
+	// Make sure the path table is a reasonable size.
+	const uint32_t pt_size = pvd.path_table_size.he;
+	const uint32_t pt_lba = le32_to_cpu(pvd.path_table_lba_L);
+	if (pt_size < sizeof(ISO_PathTableEntry) || pt_size > 1024*1024 ||
+	    pt_lba < static_cast<uint32_t>(iso_start_offset))
+	{
+		return -EIO;
+	}
+
+	const unsigned int block_size = pvd.logical_block_size.he;
+	ao::uvector<uint8_t> pt_buf(pt_size);
+	const off64_t pt_addr = partition_offset +
+		static_cast<off64_t>(pt_lba - iso_start_offset) * block_size;
+	size_t size = q->m_discReader->seekAndRead(pt_addr, pt_buf.data(), pt_buf.size());
+	if (size != pt_buf.size()) {
+		// Seek and/or read error.
+		return -EIO;
+	}
+
+	// Parse the path table.
+	// Directory numbers are 1-based, and parents always
+	// precede their subdirectories.
+	// NOTE: The first entry is the root directory.
+	std::vector<string> paths;
+	paths.reserve(pt_size / (sizeof(ISO_PathTableEntry) + 8));
+	const uint8_t *p = pt_buf.data();
+	const uint8_t *const p_end = p + pt_buf.size();
+	while (p + sizeof(ISO_PathTableEntry) <= p_end) {
+		const ISO_PathTableEntry *const ptEntry = reinterpret_cast<const ISO_PathTableEntry*>(p);
+		if (ptEntry->dirid_length == 0) {
+			// End of path table. (padding)
+			break;
+		}
+		const char *const dirid = reinterpret_cast<const char*>(p) + sizeof(*ptEntry);
+		if (dirid + ptEntry->dirid_length > reinterpret_cast<const char*>(p_end)) {
+			// Directory identifier is out of bounds.
+			break;
+		}
+
+		const unsigned int parent_dir = le16_to_cpu(ptEntry->parent_dir);
+		if (paths.empty()) {
+			// Root directory.
+			paths.emplace_back();
+		} else if (parent_dir == 0 || parent_dir > paths.size()) {
+			// Invalid parent directory.
+			paths.emplace_back();
+		} else {
+			string path = paths[parent_dir - 1];
+			if (!path.empty()) {
+				path += '/';
+			}
+			path += normalizePath(dirid, ptEntry->dirid_length);
+			path_table.emplace(path, le32_to_cpu(ptEntry->block));
+			paths.emplace_back(std::move(path));
+		}
+
+		// Next entry. The directory identifier is padded to an even length.
+		p += sizeof(*ptEntry) + ptEntry->dirid_length + (ptEntry->dirid_length & 1);
+	}
+
+	return (!path_table.empty() ? 0 : -ENOENT);
+}
+
+/**
+ * Load a directory and build its name index.
+ * @param key	[in] Normalized directory path.
+ * @param block	[in] Starting block.
+ * @param size	[in] Directory size, or 0 to get it from the directory's "." entry.
+ * @param pError	[out] POSIX error code on error.
+ * @return Directory on success; nullptr on error.
+ */
+const IsoPartitionPrivate::Directory *IsoPartitionPrivate::loadDirectory(string &&key, uint32_t block, uint32_t size, int *pError)
+{
+	RP_Q(IsoPartition);
+
+	// Block size.
+	// Should be 2048, but other values are possible.
+	const unsigned int block_size = pvd.logical_block_size.he;
+
+	if (block < static_cast<uint32_t>(iso_start_offset)) {
+		// Starting block is invalid.
+		q->m_lastError = EIO;
+		if (pError) {
+			*pError = EIO;
+		}
+		return nullptr;
+	}
+	const off64_t dir_addr = partition_offset +
+		static_cast<off64_t>(block - iso_start_offset) * block_size;
+
+	// NOTE: Due to variable-length entries, we need to load
+	// the entire directory all at once.
+	Directory dir;
+	if (size == 0) {
+		// Size is unknown. Read the first block, then
+		// get the size from the "." entry.
+		dir.data.resize(block_size);
+		size_t sz_read = q->m_discReader->seekAndRead(dir_addr, dir.data.data(), dir.data.size());
+		const ISO_DirEntry *const dotEntry = reinterpret_cast<const ISO_DirEntry*>(dir.data.data());
+		if (sz_read != dir.data.size() || dotEntry->entry_length < sizeof(*dotEntry) ||
+		    dotEntry->block.he != block)
+		{
+			// Read error, or this isn't the directory.
+			q->m_lastError = (sz_read != dir.data.size() ? q->m_discReader->lastError() : 0);
+			if (q->m_lastError == 0) {
+				q->m_lastError = EIO;
+			}
+			if (pError) {
+				*pError = q->m_lastError;
+			}
+			return nullptr;
+		}
+		size = dotEntry->size.he;
+	}
+
+	if (size > 16*1024*1024) {
+		// Directory is too big.
+		q->m_lastError = EIO;
+		if (pError) {
+			*pError = EIO;
+		}
+		return nullptr;
+	}
+
+	const size_t sz_have = (dir.data.size() <= size ? dir.data.size() : 0);
+	dir.data.resize(size);
+	if (sz_have < size) {
+		size_t sz_read = q->m_discReader->seekAndRead(dir_addr + sz_have,
+			dir.data.data() + sz_have, size - sz_have);
+		if (sz_read != size - sz_have) {
+			// Seek and/or read error.
+			q->m_lastError = q->m_discReader->lastError();
+			if (q->m_lastError == 0) {
+				q->m_lastError = EIO;
+			}
+			if (pError) {
+				*pError = q->m_lastError;
+			}
+			return nullptr;
+		}
+	}
+
+	// Build the name index.
+	const uint8_t *const p_start = dir.data.data();
+	const uint8_t *p = p_start;
+	const uint8_t *const p_end = p + dir.data.size();
+	while (p + sizeof(ISO_DirEntry) <= p_end) {
+		const ISO_DirEntry *const dirEntry = reinterpret_cast<const ISO_DirEntry*>(p);
+		if (dirEntry->entry_length == 0) {
+			// Directory records can't cross block boundaries,
+			// so the rest of the block is zero-padded.
+			// Continue at the next block.
+			const size_t next_block = ALIGN_BYTES(block_size, static_cast<size_t>(p - p_start) + 1);
+			if (next_block >= dir.data.size()) {
+				// End of directory.
+				break;
+			}
+			p = p_start + next_block;
+			continue;
+		} else if (dirEntry->entry_length < sizeof(*dirEntry)) {
+			// Invalid entry.
 			break;
 		}
 
@@ -184,49 +444,75 @@ const ISO_DirEntry *IsoPartitionPrivate::lookup_int(const DirData_t *pDir, const
 			break;
 		}
 
-		// Check the filename.
-		// 1990s and early 2000s CD-ROM games usually have
-		// ";1" filenames, so check for that first.
-		if (dirEntry->filename_length == filename_len + 2) {
-			// +2 length match.
-			// This might have ";1".
-			if (!strncasecmp(entry_filename, filename, filename_len)) {
-				// Check for ";1".
-				// TODO: Also allow other version numbers?
-				if (entry_filename[filename_len]   == ';' &&
-				    entry_filename[filename_len+1] == '1')
-				{
-					// Found it!
-					// Verify directory vs. file.
-					bool isDir = !!(dirEntry->flags & ISO_FLAG_DIRECTORY);
-					if (isDir == bFindDir) {
-						// Directory attribute matches.
-						dirEntry_found = dirEntry;
-					} else {
-						// Not a match.
-						err = (isDir ? EISDIR : ENOTDIR);
-					}
-					break;
+		// Skip the "." and ".." entries. (0x00 and 0x01)
+		const uint8_t filename_length = dirEntry->filename_length;
+		if (filename_length > 1 || (filename_length == 1 && static_cast<uint8_t>(entry_filename[0]) > 0x01)) {
+			// NOTE: If a name is listed twice, the first one is used.
+			string name(entry_filename, filename_length);
+			for (char &chr : name) {
+				if (chr >= 'a' && chr <= 'z') {
+					chr &= ~0x20;
 				}
 			}
-		} else if (dirEntry->filename_length == filename_len) {
-			// Exact length match.
-			if (!strncasecmp(entry_filename, filename, filename_len)) {
-				// Found it!
-				dirEntry_found = dirEntry;
-				break;
+			const uint32_t offset = static_cast<uint32_t>(p - p_start);
+			if (filename_length > 2 &&
+			    name[filename_length-2] == ';' && name[filename_length-1] == '1')
+			{
+				// 1990s and early 2000s CD-ROM games usually have
+				// ";1" filenames, so index it without the suffix, too.
+				dir.index.emplace(name.substr(0, filename_length-2), DirIndexEntry{offset, true});
 			}
+			dir.index.emplace(std::move(name), DirIndexEntry{offset, false});
 		}
 
 		// Next entry.
 		p += dirEntry->entry_length;
 	}
 
-	if (!dirEntry_found) {
-		RP_Q(IsoPartition);
-		q->m_lastError = err;
+	auto ins = dir_data.emplace(std::move(key), std::move(dir));
+	return &(ins.first->second);
+}
+
+/**
+ * Look up a directory entry from a base filename and directory.
+ * @param pDir		[in] Directory.
+ * @param filename	[in] Base filename. (cp1252)
+ * @param bFindDir	[in] True to find a subdirectory; false to find a file.
+ * @return ISO directory entry.
+ */
+const ISO_DirEntry *IsoPartitionPrivate::lookup_int(const Directory *pDir, const char *filename, bool bFindDir)
+{
+	// Find the file in the directory.
+	// NOTE: Filenames are case-insensitive.
+	// NOTE: File might have a ";1" suffix.
+	RP_Q(IsoPartition);
+	string key(filename);
+	for (char &chr : key) {
+		if (chr >= 'a' && chr <= 'z') {
+			chr &= ~0x20;
+		}
 	}
-	return dirEntry_found;
+
+	auto iter = pDir->index.find(key);
+	if (iter == pDir->index.end()) {
+		// Not found.
+		q->m_lastError = ENOENT;
+		return nullptr;
+	}
+
+	const ISO_DirEntry *const dirEntry = reinterpret_cast<const ISO_DirEntry*>(&pDir->data[iter->second.offset]);
+	if (iter->second.hasVersion) {
+		// Verify directory vs. file.
+		// TODO: Also allow other version numbers?
+		const bool isDir = !!(dirEntry->flags & ISO_FLAG_DIRECTORY);
+		if (isDir != bFindDir) {
+			// Not a match.
+			q->m_lastError = (isDir ? EISDIR : ENOTDIR);
+			return nullptr;
+		}
+	}
+
+	return dirEntry;
 }
 
 /**
@@ -235,16 +521,13 @@ const ISO_DirEntry *IsoPartitionPrivate::lookup_int(const DirData_t *pDir, const
  * @param pError	[out] POSIX error code on error.
  * @return Directory on success; nullptr on error.
  */
-const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const char *path, int *pError)
+const IsoPartitionPrivate::Directory *IsoPartitionPrivate::getDirectory(const char *path, int *pError)
 {
 	RP_Q(IsoPartition);
-	if (!path || !strcmp(path, "/")) {
-		// Root directory. Use "".
-		path = "";
-	}
+	string key = normalizePath(path);
 
 	// Check if this directory was already loaded.
-	auto iter = dir_data.find(path);
+	auto iter = dir_data.find(key);
 	if (iter != dir_data.end()) {
 		// Directory is already loaded.
 		return &iter->second;
@@ -266,24 +549,11 @@ const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const ch
 		return nullptr;
 	}
 
-	// Block size.
-	// Should be 2048, but other values are possible.
-	const unsigned int block_size = pvd.logical_block_size.he;
-
-	if (path[0] == '\0') {
+	if (key.empty()) {
 		// Loading the root directory.
 
 		// Check the root directory entry.
 		const ISO_DirEntry *const rootdir = &pvd.dir_entry_root;
-		if (rootdir->size.he > 16*1024*1024) {
-			// Root directory is too big.
-			q->m_lastError = EIO;
-			if (pError) {
-				*pError = EIO;
-			}
-			return nullptr;
-		}
-
 		if (iso_start_offset >= 0) {
 			// ISO start address was already determined.
 			if (rootdir->block.he < ((unsigned int)iso_start_offset + 2)) {
@@ -312,44 +582,36 @@ const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const ch
 		}
 
 		// Load the root directory.
-		// NOTE: Due to variable-length entries, we need to load
-		// the entire root directory all at once.
-		DirData_t dir;
-		dir.resize(rootdir->size.he);
-		const off64_t rootDir_addr = partition_offset +
-			static_cast<off64_t>(rootdir->block.he - iso_start_offset) * block_size;
-		size_t size = q->m_discReader->seekAndRead(rootDir_addr, dir.data(), dir.size());
-		if (size != dir.size()) {
-			// Seek and/or read error.
-			dir.clear();
-			q->m_lastError = q->m_discReader->lastError();
-			if (q->m_lastError == 0) {
-				q->m_lastError = EIO;
-			}
+		// NOTE: A size of 0 would mean "unknown", so reject it.
+		if (rootdir->size.he == 0) {
+			q->m_lastError = EIO;
 			if (pError) {
-				*pError = q->m_lastError;
+				*pError = EIO;
 			}
 			return nullptr;
 		}
-
-		// Root directory loaded.
-		auto ins = dir_data.emplace("", std::move(dir));
-		return &(ins.first->second);
+		return loadDirectory(std::move(key), rootdir->block.he, rootdir->size.he, pError);
 	}
 
-	// Get the parent directory.
-	const DirData_t *pDir;
-	const char *const sl = findLastSlash(path);
-	if (!sl) {
-		// No slash. Parent is root.
-		pDir = getDirectory("");
-	} else {
-		// Found a slash.
-		string s_parentDir(path, (sl - path));
-		path = sl + 1;
-		pDir = getDirectory(s_parentDir.c_str());
+	// Get the parent directory path.
+	const size_t sl = key.rfind('/');
+	const string s_parentDir = (sl != string::npos ? key.substr(0, sl) : string());
+
+	if (dir_data.find(s_parentDir) == dir_data.end() && loadPathTable() == 0) {
+		// Parent directory isn't loaded.
+		// Use the path table to load this directory directly.
+		auto pt_iter = path_table.find(key);
+		if (pt_iter != path_table.end()) {
+			const Directory *const pDir = loadDirectory(string(key), pt_iter->second, 0, nullptr);
+			if (pDir) {
+				return pDir;
+			}
+			// Path table is incorrect? Try walking the directories.
+		}
 	}
 
+	// Get the parent directory.
+	const Directory *const pDir = getDirectory(s_parentDir.c_str(), pError);
 	if (!pDir) {
 		// Can't find the parent directory.
 		// getDirectory() already set q->lastError().
@@ -357,38 +619,26 @@ const IsoPartitionPrivate::DirData_t *IsoPartitionPrivate::getDirectory(const ch
 	}
 
 	// Find this directory.
-	string s_subdir(utf8_to_cp1252(path, -1));
-	const ISO_DirEntry *const entry = lookup_int(pDir, s_subdir.c_str(), true);
+	const char *const subdir = key.c_str() + (sl != string::npos ? sl + 1 : 0);
+	const ISO_DirEntry *const entry = lookup_int(pDir, subdir, true);
 	if (!entry) {
 		// Not found.
 		// lookup_int() already set q->lastError().
+		if (pError) {
+			*pError = q->m_lastError;
+		}
 		return nullptr;
 	}
 
 	// Load the subdirectory.
-	// NOTE: Due to variable-length entries, we need to load
-	// the entire root directory all at once.
-	DirData_t dir;
-	dir.resize(entry->size.he);
-	const off64_t rootDir_addr = partition_offset +
-		static_cast<off64_t>(entry->block.he - iso_start_offset) * block_size;
-	size_t size = q->m_discReader->seekAndRead(rootDir_addr, dir.data(), dir.size());
-	if (size != dir.size()) {
-		// Seek and/or read error.
-		dir.clear();
-		q->m_lastError = q->m_discReader->lastError();
-		if (q->m_lastError == 0) {
-			q->m_lastError = EIO;
-		}
+	if (entry->size.he == 0) {
+		q->m_lastError = EIO;
 		if (pError) {
-			*pError = q->m_lastError;
+			*pError = EIO;
 		}
 		return nullptr;
 	}
-
-	// Subdirectory loaded.
-	auto ins = dir_data.emplace(std::move(s_subdir), std::move(dir));
-	return &(ins.first->second);
+	return loadDirectory(std::move(key), entry->block.he, entry->size.he, pError);
 }
 
 /**
@@ -414,7 +664,7 @@ const ISO_DirEntry *IsoPartitionPrivate::lookup(const char *filename)
 
 	// TODO: Which encoding?
 	// Assuming cp1252...
-	const DirData_t *pDir;
+	const Directory *pDir;
 
 	// Is this file in a subdirectory?
 	const char *const sl = findLastSlash(filename);
@@ -491,10 +741,12 @@ time_t IsoPartitionPrivate::parseTimestamp(const ISO_Dir_DateTime_t *isofiletime
  * @param discReader IDiscReader.
  * @param partition_offset Partition start offset.
  * @param iso_start_offset ISO start offset, in blocks. (If -1, uses heuristics.)
+ * @param pPvd Primary volume descriptor, if it was already read by the caller. (optional)
  */
-IsoPartition::IsoPartition(IDiscReader *discReader, off64_t partition_offset, int iso_start_offset)
+IsoPartition::IsoPartition(IDiscReader *discReader, off64_t partition_offset, int iso_start_offset,
+	const ISO_Primary_Volume_Descriptor *pPvd)
 	: super(discReader)
-	, d_ptr(new IsoPartitionPrivate(this, partition_offset, iso_start_offset))
+	, d_ptr(new IsoPartitionPrivate(this, partition_offset, iso_start_offset, pPvd))
 { }
 
 IsoPartition::~IsoPartition()
@@ -613,6 +865,39 @@ off64_t IsoPartition::partition_size_used(void) const
 	return partition_size();
 }
 
+/**
+ * Get the approximate amount of memory used by
+ * cached metadata, e.g. directory tables or the FST.
+ * @return Approximate memory usage, in bytes.
+ */
+size_t IsoPartition::memoryUsage(void) const
+{
+	RP_D(const IsoPartition);
+	size_t total = 0;
+	for (const auto &p : d->dir_data) {
+		total += p.first.size() + p.second.data.size();
+		for (const auto &ie : p.second.index) {
+			total += ie.first.size() + sizeof(ie.second);
+		}
+	}
+	for (const auto &p : d->path_table) {
+		total += p.first.size() + sizeof(uint32_t);
+	}
+	return total;
+}
+
+/**
+ * Release cached metadata.
+ * It will be reloaded on demand.
+ */
+void IsoPartition::releaseMemory(void)
+{
+	RP_D(IsoPartition);
+	d->dir_data.clear();
+	d->path_table.clear();
+	d->path_table_loaded = false;
+}
+
 /** IsoPartition **/
 
 /** GcnFst wrapper functions. **/
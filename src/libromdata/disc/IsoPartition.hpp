@@ -12,6 +12,9 @@
 #include "librpbase/disc/IPartition.hpp"
 //#include "librpbase/disc/IFst.hpp"
 
+// ISO-9660 structs
+#include "../iso_structs.h"
+
 namespace LibRomData {
 
 class IsoPartitionPrivate;
@@ -27,8 +30,10 @@ class IsoPartition : public LibRpBase::IPartition
 		 * @param discReader IDiscReader.
 		 * @param partition_offset Partition start offset.
 		 * @param iso_start_offset ISO start offset, in blocks. (If -1, uses heuristics.)
+		 * @param pPvd Primary volume descriptor, if it was already read by the caller. (optional)
 		 */
-		IsoPartition(IDiscReader *discReader, off64_t partition_offset, int iso_start_offset = -1);
+		IsoPartition(IDiscReader *discReader, off64_t partition_offset, int iso_start_offset = -1,
+			const ISO_Primary_Volume_Descriptor *pPvd = nullptr);
 	protected:
 		virtual ~IsoPartition();	// call unref() instead
 
@@ -91,6 +96,20 @@ class IsoPartition : public LibRpBase::IPartition
 		 */
 		off64_t partition_size_used(void) const final;
 
+	public:
+		/**
+		 * Get the approximate amount of memory used by
+		 * cached metadata, e.g. directory tables or the FST.
+		 * @return Approximate memory usage, in bytes.
+		 */
+		size_t memoryUsage(void) const final;
+
+		/**
+		 * Release cached metadata.
+		 * It will be reloaded on demand.
+		 */
+		void releaseMemory(void) final;
+
 	public:
 		/** IFst wrapper functions. **/
 
@@ -27,6 +27,10 @@ namespace LibRomData {
 
 /** NCCHReaderPrivate **/
 
+// Out-of-class definitions, since CHUNK_SIZE is passed by reference to std::min().
+const unsigned int NCCHReaderPrivate::CHUNK_SIZE;
+const unsigned int NCCHReaderPrivate::CHUNK_CACHE_COUNT;
+
 NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 	uint8_t media_unit_shift,
 	off64_t ncch_offset, uint32_t ncch_length)
@@ -41,10 +45,21 @@ NCCHReaderPrivate::NCCHReaderPrivate(NCCHReader *q,
 #ifdef ENABLE_DECRYPTION
 	, tid_be(0)
 	, cipher(nullptr)
+	, cipherKeyIdx(0xFF)
+	, chunkCacheUseCounter(0)
 	, tmd_content_index(0)
 	, isDebug(false)
 #endif /* ENABLE_DECRYPTION */
 {
+#ifdef ENABLE_DECRYPTION
+	for (CachedChunk &chunk : chunkCache) {
+		chunk.address = ~0U;
+		chunk.size = 0;
+		chunk.lastUse = 0;
+	}
+#endif /* ENABLE_DECRYPTION */
+
+
 	// Clear the various structs.
 	memset(&ncch_header, 0, sizeof(ncch_header));
 	memset(&ncch_exheader, 0, sizeof(ncch_exheader));
@@ -347,6 +362,107 @@ int NCCHReaderPrivate::findEncSection(uint32_t address) const
 	// Not an encrypted section.
 	return -1;
 }
+
+/**
+ * Read and decrypt data from an encrypted section.
+ * The entire range is decrypted in a single AES-CTR pass.
+ *
+ * NOTE: Offset and size must both be multiples of 16.
+ *
+ * @param section	[in] Encrypted section.
+ * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+ * @param ptr		[out] Output buffer.
+ * @param size		[in] Amount of data to read.
+ * @return Number of bytes read, or 0 on error.
+ */
+size_t NCCHReaderPrivate::readDecrypted(const EncSection *section, uint32_t offset, uint8_t *ptr, size_t size)
+{
+	// Read from the ROM image.
+	// This automatically removes the outer CIA
+	// title key encryption if it's present.
+	size_t ret_sz = readFromROM(offset, ptr, size);
+	if (section->section <= N3DS_NCCH_SECTION_PLAIN) {
+		// Not encrypted.
+		return ret_sz;
+	}
+
+	// Only decrypt whole AES blocks if a short read occurred.
+	ret_sz &= ~static_cast<size_t>(15);
+	if (ret_sz == 0) {
+		return 0;
+	}
+
+	// Set the required key if it changed.
+	if (cipherKeyIdx != section->keyIdx) {
+		cipher->setKey(ncch_keys[section->keyIdx].u8, sizeof(ncch_keys[section->keyIdx].u8));
+		cipherKeyIdx = section->keyIdx;
+	}
+
+	// Initialize the counter based on section and offset.
+	u128_t ctr;
+	ctr.init_ctr(tid_be, section->section, offset - section->ctr_base);
+	cipher->setIV(ctr.u8, sizeof(ctr.u8));
+
+	// Decrypt the data.
+	return cipher->decrypt(ptr, ret_sz);
+}
+
+/**
+ * Read decrypted data using the chunk cache.
+ * The range must not cross a chunk boundary.
+ * @param section	[in] Encrypted section.
+ * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+ * @param ptr		[out] Output buffer.
+ * @param size		[in] Amount of data to read.
+ * @return Number of bytes read, or 0 on error.
+ */
+size_t NCCHReaderPrivate::readFromChunk(const EncSection *section, uint32_t offset, uint8_t *ptr, size_t size)
+{
+	const uint32_t section_offset = offset - section->address;
+	const uint32_t chunk_address = section->address + (section_offset & ~(CHUNK_SIZE - 1));
+	const uint32_t chunk_offset = offset - chunk_address;
+	assert(chunk_offset + size <= CHUNK_SIZE);
+
+	// Check if the chunk is cached.
+	// If it isn't, find the least recently used chunk.
+	CachedChunk *chunk = nullptr;
+	CachedChunk *lru = &chunkCache[0];
+	for (CachedChunk &p : chunkCache) {
+		if (p.address == chunk_address) {
+			chunk = &p;
+			break;
+		}
+		if (p.lastUse < lru->lastUse) {
+			lru = &p;
+		}
+	}
+
+	if (!chunk) {
+		// Read and decrypt the chunk.
+		// NOTE: The end of the section might not be
+		// a multiple of 16, so round it up.
+		chunk = lru;
+		if (!chunk->data) {
+			chunk->data.reset(new uint8_t[CHUNK_SIZE]);
+		}
+		uint32_t chunk_size = std::min(CHUNK_SIZE, section->length - (chunk_address - section->address));
+		const size_t sz_read = readDecrypted(section, chunk_address, chunk->data.get(), ALIGN_BYTES(16, chunk_size));
+		chunk->address = chunk_address;
+		chunk->size = std::min(chunk_size, static_cast<uint32_t>(sz_read));
+	}
+	chunk->lastUse = ++chunkCacheUseCounter;
+
+	// Copy the data from the chunk.
+	if (chunk_offset >= chunk->size) {
+		// Short read.
+		return 0;
+	}
+	if (size > chunk->size - chunk_offset) {
+		size = chunk->size - chunk_offset;
+	}
+	memcpy(ptr, &chunk->data[chunk_offset], size);
+	return size;
+}
 #endif /* ENABLE_DECRYPTION */
 
 /**
@@ -375,13 +491,13 @@ size_t NCCHReaderPrivate::readFromROM(uint32_t offset, void *ptr, size_t size)
 		return 0;
 	}
 
-	// Seek to the start of the data and read it.
+	// Read the data.
 	const off64_t phys_addr = ncch_offset + offset;
 	size_t sz_read;
 	if (q->m_hasDiscReader) {
-		sz_read = q->m_discReader->seekAndRead(phys_addr, ptr, size);
+		sz_read = q->m_discReader->readAt(phys_addr, ptr, size);
 	} else {
-		sz_read = q->m_file->seekAndRead(phys_addr, ptr, size);
+		sz_read = q->m_file->readAt(phys_addr, ptr, size);
 	}
 	if (sz_read != size) {
 		// Seek and/or read error.
@@ -572,14 +688,6 @@ size_t NCCHReader::read(void *ptr, size_t size)
 	}
 
 #ifdef ENABLE_DECRYPTION
-	// TODO: Handle reads that aren't a multiple of 16 bytes.
-	assert(d->pos % 16 == 0);
-	assert(size % 16 == 0);
-	if (d->pos % 16 != 0 || size % 16 != 0) {
-		// Cannot read now.
-		return 0;
-	}
-
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 	size_t sz_total_read = 0;
 	while (size > 0) {
@@ -588,42 +696,35 @@ size_t NCCHReader::read(void *ptr, size_t size)
 		const NCCHReaderPrivate::EncSection *section = (
 			sectIdx >= 0 ? &d->encSections.at(sectIdx) : nullptr);
 
-		size_t sz_to_read = 0;
 		if (!section) {
 			// Not in a defined section.
 			// TODO: Handle this?
 			assert(!"Reading in an undefined section.");
 			return sz_total_read;
-		} else {
-			// We're in an encrypted section.
-			uint32_t section_offset = static_cast<uint32_t>(d->pos - section->address);
-			if (section_offset + size <= section->length) {
-				// Remainder of reading is in this section.
-				sz_to_read = size;
-			} else {
-				// We're reading past the end of this section.
-				sz_to_read = section->length - section_offset;
-			}
 		}
 
-		// Read from the ROM image.
-		// This automatically removes the outer CIA
-		// title key encryption if it's present.
-		size_t ret_sz = d->readFromROM(d->pos, ptr8, sz_to_read);
-
-		if (section && section->section > N3DS_NCCH_SECTION_PLAIN) {
-			// Set the required key.
-			// TODO: Don't set the key if it hasn't changed.
-			d->cipher->setKey(d->ncch_keys[section->keyIdx].u8, sizeof(d->ncch_keys[section->keyIdx].u8));
-
-			// Initialize the counter based on section and offset.
-			u128_t ctr;
-			ctr.init_ctr(d->tid_be, section->section, d->pos - section->ctr_base);
-			d->cipher->setIV(ctr.u8, sizeof(ctr.u8));
+		// We're in an encrypted section.
+		const uint32_t section_offset = static_cast<uint32_t>(d->pos - section->address);
+		size_t sz_to_read = section->length - section_offset;
+		if (sz_to_read > size) {
+			// Remainder of reading is in this section.
+			sz_to_read = size;
+		}
 
-			// Decrypt the data.
-			// FIXME: Round up to 16 if a short read occurred?
-			ret_sz = d->cipher->decrypt(static_cast<uint8_t*>(ptr), ret_sz);
+		size_t ret_sz;
+		if (d->pos % 16 == 0 && sz_to_read >= NCCHReaderPrivate::CHUNK_SIZE) {
+			// Large aligned read. Decrypt directly into the output buffer.
+			// Any unaligned tail is handled by the chunk cache.
+			sz_to_read &= ~static_cast<size_t>(15);
+			ret_sz = d->readDecrypted(section, d->pos, ptr8, sz_to_read);
+		} else {
+			// Small or unaligned read. Use the chunk cache.
+			const uint32_t chunk_remain = NCCHReaderPrivate::CHUNK_SIZE -
+				(section_offset & (NCCHReaderPrivate::CHUNK_SIZE - 1));
+			if (sz_to_read > chunk_remain) {
+				sz_to_read = chunk_remain;
+			}
+			ret_sz = d->readFromChunk(section, d->pos, ptr8, sz_to_read);
 		}
 
 		d->pos += static_cast<uint32_t>(ret_sz);
@@ -704,6 +805,22 @@ off64_t NCCHReader::size(void)
 	return (ret >= 0 ? ret : 0);
 }
 
+/**
+ * Get the natural block size of the NCCH.
+ * For encrypted NCCHs, this is the decrypted chunk size.
+ * @return Block size, in bytes, or 0 if there isn't a natural block size.
+ */
+unsigned int NCCHReader::blockSize(void) const
+{
+#ifdef ENABLE_DECRYPTION
+	RP_D(const NCCHReader);
+	if (!(d->ncch_header.hdr.flags[N3DS_NCCH_FLAG_BIT_MASKS] & N3DS_NCCH_BIT_MASK_NoCrypto)) {
+		return NCCHReaderPrivate::CHUNK_SIZE;
+	}
+#endif /* ENABLE_DECRYPTION */
+	return 0;
+}
+
 /** IPartition **/
 
 /**
@@ -97,6 +97,13 @@ class NCCHReader : public LibRpBase::IPartition
 		 */
 		off64_t size(void) final;
 
+		/**
+		 * Get the natural block size of the NCCH.
+		 * For encrypted NCCHs, this is the decrypted chunk size.
+		 * @return Block size, in bytes, or 0 if there isn't a natural block size.
+		 */
+		unsigned int blockSize(void) const final;
+
 	public:
 		/** IPartition **/
 
@@ -25,6 +25,8 @@
 #include <stdint.h>
 
 // C++ includes.
+#include <array>
+#include <memory>
 #include <vector>
 
 #ifdef ENABLE_DECRYPTION
@@ -156,6 +158,50 @@ class NCCHReaderPrivate
 		 */
 		int findEncSection(uint32_t address) const;
 
+		// Currently loaded key. (ncch_keys[] index, or 0xFF if unknown)
+		uint8_t cipherKeyIdx;
+
+		/**
+		 * Read and decrypt data from an encrypted section.
+		 * The entire range is decrypted in a single AES-CTR pass.
+		 *
+		 * NOTE: Offset and size must both be multiples of 16.
+		 *
+		 * @param section	[in] Encrypted section.
+		 * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+		 * @param ptr		[out] Output buffer.
+		 * @param size		[in] Amount of data to read.
+		 * @return Number of bytes read, or 0 on error.
+		 */
+		size_t readDecrypted(const EncSection *section, uint32_t offset, uint8_t *ptr, size_t size);
+
+		// Decrypted chunk cache.
+		// Chunks are aligned to CHUNK_SIZE relative to the start
+		// of their section, so they never cross a key or counter
+		// boundary. Small reads, e.g. repeated icon and banner
+		// lookups, only have to decrypt a chunk once.
+		static const unsigned int CHUNK_SIZE = 32U*1024U;
+		static const unsigned int CHUNK_CACHE_COUNT = 4;
+		struct CachedChunk {
+			uint32_t address;	// NCCH-relative address, or ~0U if unused.
+			uint32_t size;		// Valid data size.
+			uint32_t lastUse;	// Last use counter.
+			std::unique_ptr<uint8_t[]> data;
+		};
+		std::array<CachedChunk, CHUNK_CACHE_COUNT> chunkCache;
+		uint32_t chunkCacheUseCounter;
+
+		/**
+		 * Read decrypted data using the chunk cache.
+		 * The range must not cross a chunk boundary.
+		 * @param section	[in] Encrypted section.
+		 * @param offset	[in] Starting address, relative to the beginning of the NCCH.
+		 * @param ptr		[out] Output buffer.
+		 * @param size		[in] Amount of data to read.
+		 * @return Number of bytes read, or 0 on error.
+		 */
+		size_t readFromChunk(const EncSection *section, uint32_t offset, uint8_t *ptr, size_t size);
+
 		// TMD content index.
 		uint16_t tmd_content_index;
 
@@ -16,7 +16,6 @@ using namespace LibRpFile;
 // C++ STL classes.
 using std::string;
 using std::unique_ptr;
-using std::unordered_map;
 using std::vector;
 
 // Uninitialized vector class.
@@ -45,7 +44,48 @@ class PEResourceReaderPrivate
 		// Read position.
 		off64_t pos;
 
-		// Resource directory entry.
+		// Flattened resource index.
+		// This is built in one pass over the resource directory
+		// tree in the constructor, so resource lookups don't need
+		// to read the directories again.
+		// Entries are stored in directory order, so all entries
+		// for a given type are contiguous, as are all entries
+		// for a given type and ID.
+		struct ResEntry {
+			uint16_t type;		// Resource type.
+			uint16_t id;		// Resource ID.
+			uint16_t lang;		// Language ID.
+			uint32_t data_addr;	// Address of the resource data, relative to rsrc_addr.
+			uint32_t data_size;	// Size of the resource data.
+		};
+		ao::uvector<ResEntry> res_index;
+
+		// Range of res_index entries for each resource type.
+		struct TypeRange {
+			uint16_t type;		// Resource type.
+			uint32_t first;		// Index of the first entry in res_index.
+			uint32_t count;		// Number of entries.
+		};
+		ao::uvector<TypeRange> type_ranges;
+
+		// Resource directory data used while building the index.
+		// The directories are usually at the start of .rsrc, so
+		// they're read all at once if the file isn't memory-mapped.
+		const uint8_t *dirData;
+		uint32_t dirData_size;
+
+		/**
+		 * Read data from the .rsrc section while building the index.
+		 * Data within dirData is copied from memory; anything
+		 * else is read from the file.
+		 * @param addr	[in] Address. (relative to the start of .rsrc)
+		 * @param ptr	[out] Output buffer.
+		 * @param size	[in] Size to read.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int readDirData(uint32_t addr, void *ptr, uint32_t size);
+
+		// Resource directory entry. (used while building the index)
 		struct ResDirEntry {
 			uint16_t id;	// Resource ID.
 			uint32_t addr;	// Address of the IMAGE_RESOURCE_DIRECTORY or
@@ -54,19 +94,6 @@ class PEResourceReaderPrivate
 		};
 		typedef ao::uvector<ResDirEntry> rsrc_dir_t;
 
-		// Resource types. (Top-level directory.)
-		rsrc_dir_t res_types;
-
-		// Cached top-level directories. (type)
-		// Key: type
-		// Value: Resources contained within the directory.
-		unordered_map<uint16_t, rsrc_dir_t> type_dirs;
-
-		// Cached second-level directories. (type and ID)
-		// Key: LOWORD == type, HIWORD == id
-		// Value: Resources contained within the directory.
-		unordered_map<uint32_t, rsrc_dir_t> type_and_id_dirs;
-
 		/**
 		 * Load a resource directory.
 		 *
@@ -80,19 +107,17 @@ class PEResourceReaderPrivate
 		int loadResDir(uint32_t addr, rsrc_dir_t &dir);
 
 		/**
-		 * Get the resource directory for the specified type.
-		 * @param type Resource type.
-		 * @return Resource directory, or nullptr if not found.
+		 * Build the resource index.
+		 * @return Number of resources in the index, or negative POSIX error code on error.
 		 */
-		const rsrc_dir_t *getTypeDir(uint16_t type);
+		int buildIndex(void);
 
 		/**
-		 * Get the resource directory for the specified type and ID.
+		 * Find the index range for the specified type.
 		 * @param type Resource type.
-		 * @param id Resource ID.
-		 * @return Resource directory, or nullptr if not found.
+		 * @return TypeRange, or nullptr if not found.
 		 */
-		const rsrc_dir_t *getTypeIdDir(uint16_t type, uint16_t id);
+		const TypeRange *findType(uint16_t type) const;
 
 		/**
 		 * Read the section header in a PE version resource.
@@ -129,6 +154,8 @@ PEResourceReaderPrivate::PEResourceReaderPrivate(
 	, rsrc_size(rsrc_size)
 	, rsrc_va(rsrc_va)
 	, pos(0)
+	, dirData(nullptr)
+	, dirData_size(0)
 {
 	if (!q->m_file) {
 		q->m_lastError = -EBADF;
@@ -161,14 +188,69 @@ PEResourceReaderPrivate::PEResourceReaderPrivate(
 		return;
 	}
 
-	// Load the root resource directory.
-	int ret = loadResDir(0, res_types);
+	// Get the resource directory data.
+	// If the file is memory-mapped, the entire section is used.
+	// Otherwise, read the first 64 KB of the section, which is
+	// usually enough for all of the directories and data entries.
+	unique_ptr<uint8_t[]> dirBuf;
+	dirData = q->m_file->peek(rsrc_addr, rsrc_size);
+	if (dirData) {
+		dirData_size = rsrc_size;
+	} else {
+		dirData_size = (rsrc_size < 65536U ? rsrc_size : 65536U);
+		dirBuf.reset(new uint8_t[dirData_size]);
+		size_t size = q->m_file->seekAndRead(rsrc_addr, dirBuf.get(), dirData_size);
+		if (size != dirData_size) {
+			// Seek and/or read error.
+			q->m_lastError = q->m_file->lastError();
+			UNREF_AND_NULL_NOCHK(q->m_file);
+			return;
+		}
+		dirData = dirBuf.get();
+	}
+
+	// Build the resource index.
+	int ret = buildIndex();
+	dirData = nullptr;
+	dirData_size = 0;
 	if (ret <= 0) {
 		// No resources, or an error occurred.
 		UNREF_AND_NULL_NOCHK(q->m_file);
 	}
 }
 
+/**
+ * Read data from the .rsrc section while building the index.
+ * Data within dirData is copied from memory; anything
+ * else is read from the file.
+ * @param addr	[in] Address. (relative to the start of .rsrc)
+ * @param ptr	[out] Output buffer.
+ * @param size	[in] Size to read.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int PEResourceReaderPrivate::readDirData(uint32_t addr, void *ptr, uint32_t size)
+{
+	if (addr < dirData_size && size <= dirData_size - addr) {
+		// Data is in memory.
+		memcpy(ptr, &dirData[addr], size);
+		return 0;
+	}
+
+	// Data is outside of the directory buffer.
+	RP_Q(PEResourceReader);
+	if (addr >= rsrc_size || size > rsrc_size - addr) {
+		// Out of range.
+		return -EIO;
+	}
+	size_t sz_read = q->m_file->seekAndRead(rsrc_addr + addr, ptr, size);
+	if (sz_read != size) {
+		// Seek and/or read error.
+		q->m_lastError = q->m_file->lastError();
+		return (q->m_lastError != 0 ? q->m_lastError : -EIO);
+	}
+	return 0;
+}
+
 /**
  * Load a resource directory.
  *
@@ -181,14 +263,11 @@ PEResourceReaderPrivate::PEResourceReaderPrivate(
  */
 int PEResourceReaderPrivate::loadResDir(uint32_t addr, rsrc_dir_t &dir)
 {
-	RP_Q(PEResourceReader);
-
 	IMAGE_RESOURCE_DIRECTORY root;
-	size_t size = q->m_file->seekAndRead(rsrc_addr + addr, &root, sizeof(root));
-	if (size != sizeof(root)) {
-		// Seek and/or read error.
-		q->m_lastError = q->m_file->lastError();
-		return q->m_lastError;
+	int ret = readDirData(addr, &root, sizeof(root));
+	if (ret != 0) {
+		// Read error.
+		return ret;
 	}
 
 	// Total number of entries.
@@ -200,11 +279,10 @@ int PEResourceReaderPrivate::loadResDir(uint32_t addr, rsrc_dir_t &dir)
 	}
 	uint32_t szToRead = static_cast<uint32_t>(entryCount * sizeof(IMAGE_RESOURCE_DIRECTORY_ENTRY));
 	unique_ptr<IMAGE_RESOURCE_DIRECTORY_ENTRY[]> irdEntries(new IMAGE_RESOURCE_DIRECTORY_ENTRY[entryCount]);
-	size = q->m_file->read(irdEntries.get(), szToRead);
-	if (size != szToRead) {
+	ret = readDirData(addr + sizeof(root), irdEntries.get(), szToRead);
+	if (ret != 0) {
 		// Read error.
-		q->m_lastError = q->m_file->lastError();
-		return q->m_lastError;
+		return ret;
 	}
 
 	// Read each directory header.
@@ -236,104 +314,98 @@ int PEResourceReaderPrivate::loadResDir(uint32_t addr, rsrc_dir_t &dir)
 }
 
 /**
- * Get the resource directory for the specified type.
- * @param type Resource type.
- * @return Resource directory, or nullptr if not found.
+ * Build the resource index.
+ * @return Number of resources in the index, or negative POSIX error code on error.
  */
-const PEResourceReaderPrivate::rsrc_dir_t *PEResourceReaderPrivate::getTypeDir(uint16_t type)
+int PEResourceReaderPrivate::buildIndex(void)
 {
-	// Check if the type is already cached.
-	auto iter_td = type_dirs.find(type);
-	if (iter_td != type_dirs.end()) {
-		// Type is already cached.
-		return &(iter_td->second);
+	res_index.clear();
+	type_ranges.clear();
+
+	// Load the root resource directory. (types)
+	rsrc_dir_t res_types;
+	int ret = loadResDir(0, res_types);
+	if (ret <= 0) {
+		// No resources, or an error occurred.
+		return ret;
 	}
 
-	// Not cached. Find the type in the root directory.
-	auto iter = std::find_if(res_types.cbegin(), res_types.cend(),
-		[type](const ResDirEntry &entry) -> bool {
-			return (entry.id == type);
+	rsrc_dir_t id_dir, lang_dir;
+	for (const ResDirEntry &type_entry : res_types) {
+		if (!(type_entry.addr & 0x80000000)) {
+			// Not a subdirectory.
+			continue;
 		}
-	);
-
-	uint32_t type_addr = 0;
-	if (iter != res_types.cend()) {
-		// Make sure this type is a subdirectory.
-		if (iter->addr & 0x80000000) {
-			// This is a subdirectory.
-			type_addr = (iter->addr & ~0x80000000);
+		if (loadResDir(type_entry.addr & ~0x80000000, id_dir) <= 0) {
+			// No IDs, or an error occurred.
+			continue;
 		}
-	}
 
-	if (type_addr == 0) {
-		// Not found.
-		return nullptr;
-	}
+		const uint32_t first = static_cast<uint32_t>(res_index.size());
+		for (const ResDirEntry &id_entry : id_dir) {
+			if (!(id_entry.addr & 0x80000000)) {
+				// Not a subdirectory.
+				continue;
+			}
+			if (loadResDir(id_entry.addr & ~0x80000000, lang_dir) <= 0) {
+				// No languages, or an error occurred.
+				continue;
+			}
 
-	// Load the directory.
-	auto iter_type = type_dirs.insert(std::make_pair(type, rsrc_dir_t()));
-	if (!iter_type.second) {
-		// Error adding to the map.
-		return nullptr;
+			for (const ResDirEntry &lang_entry : lang_dir) {
+				assert(!(lang_entry.addr & 0x80000000));
+				if (lang_entry.addr & 0x80000000) {
+					// This is a subdirectory.
+					continue;
+				}
+
+				// Get the IMAGE_RESOURCE_DATA_ENTRY.
+				IMAGE_RESOURCE_DATA_ENTRY irdata;
+				if (readDirData(lang_entry.addr, &irdata, sizeof(irdata)) != 0) {
+					// Read error.
+					continue;
+				}
+
+				// NOTE: OffsetToData is an RVA, not relative to the physical address.
+				// NOTE: Address 0 in IDiscReader equals rsrc_addr.
+				ResEntry entry;
+				entry.type = type_entry.id;
+				entry.id = id_entry.id;
+				entry.lang = lang_entry.id;
+				entry.data_addr = le32_to_cpu(irdata.OffsetToData) - rsrc_va;
+				entry.data_size = le32_to_cpu(irdata.Size);
+				res_index.push_back(entry);
+			}
+		}
+
+		const uint32_t count = static_cast<uint32_t>(res_index.size()) - first;
+		if (count > 0) {
+			TypeRange range;
+			range.type = type_entry.id;
+			range.first = first;
+			range.count = count;
+			type_ranges.push_back(range);
+		}
 	}
-	rsrc_dir_t *type_dir = &(iter_type.first->second);
-	loadResDir(type_addr, *type_dir);
-	return type_dir;
+
+	return static_cast<int>(res_index.size());
 }
 
 /**
- * Get the resource directory for the specified type and ID.
+ * Find the index range for the specified type.
  * @param type Resource type.
- * @param id Resource ID.
- * @return Resource directory, or nullptr if not found.
+ * @return TypeRange, or nullptr if not found.
  */
-const PEResourceReaderPrivate::rsrc_dir_t *PEResourceReaderPrivate::getTypeIdDir(uint16_t type, uint16_t id)
+const PEResourceReaderPrivate::TypeRange *PEResourceReaderPrivate::findType(uint16_t type) const
 {
-	// Check if the type and ID is already cached.
-	uint32_t type_and_id = (type | (static_cast<uint32_t>(id) << 16));
-	auto iter_td = type_and_id_dirs.find(type_and_id);
-	if (iter_td != type_and_id_dirs.end()) {
-		// Type and ID is already cached.
-		return &(iter_td->second);
-	}
-
-	// Not cached. Find the type in the root directory.
-	const rsrc_dir_t *type_dir = getTypeDir(type);
-	if (!type_dir) {
-		// Type not found.
-		return nullptr;
-	}
-
-	// Find the ID in the type directory.
-	auto iter = std::find_if(type_dir->cbegin(), type_dir->cend(),
-		[id](const ResDirEntry &entry) -> bool {
-			return (entry.id == id);
+	// NOTE: There are usually only a handful of resource types,
+	// so a linear search is fine here.
+	for (const TypeRange &range : type_ranges) {
+		if (range.type == type) {
+			return &range;
 		}
-	);
-
-	uint32_t id_addr = 0;
-	if (iter != type_dir->cend()) {
-		// Make sure this ID is a subdirectory.
-		if (iter->addr & 0x80000000) {
-			// This is a subdirectory.
-			id_addr = (iter->addr & ~0x80000000);
-		}
-	}
-
-	if (id_addr == 0) {
-		// Not found.
-		return nullptr;
-	}
-
-	// Load the directory.
-	auto iter_type_and_id = type_and_id_dirs.insert(std::make_pair(type_and_id, rsrc_dir_t()));
-	if (!iter_type_and_id.second) {
-		// Error adding to the map.
-		return nullptr;
 	}
-	rsrc_dir_t *id_dir = &(iter_type_and_id.first->second);
-	loadResDir(id_addr, *id_dir);
-	return id_dir;
+	return nullptr;
 }
 
 /**
@@ -592,7 +664,7 @@ size_t PEResourceReader::read(void *ptr, size_t size)
 	}
 
 	// Read the data.
-	size_t read = m_file->seekAndRead(static_cast<off64_t>(d->rsrc_addr) + static_cast<off64_t>(d->pos), ptr, size);
+	size_t read = m_file->readAt(static_cast<off64_t>(d->rsrc_addr) + static_cast<off64_t>(d->pos), ptr, size);
 	if (read != size) {
 		// Seek and/or read error.
 		m_lastError = m_file->lastError();
@@ -696,70 +768,37 @@ off64_t PEResourceReader::partition_size_used(void) const
  */
 IRpFile *PEResourceReader::open(uint16_t type, int id, int lang)
 {
-	// Check if the directory has been cached.
 	RP_D(PEResourceReader);
+	const PEResourceReaderPrivate::TypeRange *const range = d->findType(type);
+	if (!range)
+		return nullptr;
 
+	// Find the resource in the index.
+	// If id is -1, the first ID for this type is used.
+	// If lang is -1, the first language for this ID is used.
+	const PEResourceReaderPrivate::ResEntry *entry = &d->res_index[range->first];
+	const PEResourceReaderPrivate::ResEntry *const entry_end = entry + range->count;
 	if (id == -1) {
-		// Get the first ID for this type.
-		const PEResourceReaderPrivate::rsrc_dir_t *type_dir = d->getTypeDir(type);
-		if (!type_dir || type_dir->empty())
-			return nullptr;
-		id = type_dir->at(0).id;
+		id = entry->id;
 	}
-
-	// Get the directory for the type and ID.
-	const PEResourceReaderPrivate::rsrc_dir_t *type_id_dir =
-		d->getTypeIdDir(type, static_cast<uint16_t>(id));
-	if (!type_id_dir || type_id_dir->empty())
-		return nullptr;
-
-	const PEResourceReaderPrivate::ResDirEntry *dirEntry = nullptr;
-	if (lang == -1) {
-		// Get the first language for this type.
-		dirEntry = &type_id_dir->at(0);
-	} else {
-		// Find the specified language ID.
-		auto iter = std::find_if(type_id_dir->cbegin(), type_id_dir->cend(),
-			[lang](const PEResourceReaderPrivate::ResDirEntry &entry) -> bool {
-				return (entry.id == static_cast<uint16_t>(lang));
-			}
-		);
-
-		if (iter == type_id_dir->cend()) {
-			// Not found.
-			return nullptr;
+	for (; entry < entry_end; entry++) {
+		if (entry->id == static_cast<uint16_t>(id) &&
+		    (lang == -1 || entry->lang == static_cast<uint16_t>(lang)))
+		{
+			break;
 		}
-
-		// Found the language ID.
-		dirEntry = &(*iter);
-	}
-
-	// Make sure this is a file.
-	assert(!(dirEntry->addr & 0x80000000));
-	if (dirEntry->addr & 0x80000000) {
-		// This is a subdirectory.
-		return nullptr;
 	}
-
-	// Get the IMAGE_RESOURCE_DATA_ENTRY.
-	IMAGE_RESOURCE_DATA_ENTRY irdata;
-	size_t size = m_file->seekAndRead(d->rsrc_addr + dirEntry->addr, &irdata, sizeof(irdata));
-	if (size != sizeof(irdata)) {
-		// Seek and/or read error.
-		m_lastError = m_file->lastError();
+	if (entry == entry_end) {
+		// Not found.
 		return nullptr;
 	}
 
-	// NOTE: OffsetToData is an RVA, not relative to the physical address.
-	// NOTE: Address 0 in IDiscReader equals rsrc_addr.
-	const uint32_t data_addr = le32_to_cpu(irdata.OffsetToData) - d->rsrc_va;
-
 	// Create the PartitionFile.
 	// This is an IRpFile implementation that uses an
 	// IPartition as the reader and takes an offset
 	// and size as the file parameters.
 	// TODO: Set the codepage somewhere?
-	return new PartitionFile(this, data_addr, le32_to_cpu(irdata.Size));
+	return new PartitionFile(this, entry->data_addr, entry->data_size);
 }
 
 /**
@@ -30,6 +30,8 @@ namespace LibRomData {
 #define SECTOR_SIZE_ENCRYPTED 0x8000
 #define SECTOR_SIZE_DECRYPTED 0x7C00
 #define SECTOR_SIZE_DECRYPTED_OFFSET 0x400
+// Location of the data IV in the hash area.
+#define SECTOR_IV_OFFSET 0x3D0
 
 class WiiPartitionPrivate : public GcnPartitionPrivate
 {
@@ -69,10 +71,9 @@ class WiiPartitionPrivate : public GcnPartitionPrivate
 		// NOTE: Actual read position if ((cryptoMethod & CM_MASK_SECTOR) == CM_32K).
 		off64_t pos_7C00;
 
-		// Decrypted sector cache.
+		// Decrypted sector.
 		// NOTE: Actual data starts at 0x400.
 		// Hashes and the sector IV are stored first.
-		uint32_t sector_num;				// Sector number.
 		union EncSector_t {
 			struct {
 				// NOTE: &hashes.H2[7][4], when encrypted, is the sector IV.
@@ -89,17 +90,69 @@ class WiiPartitionPrivate : public GcnPartitionPrivate
 			uint8_t fulldata[SECTOR_SIZE_ENCRYPTED];
 		};
 		ASSERT_STRUCT(EncSector_t, SECTOR_SIZE_ENCRYPTED);
-		static_assert(offsetof(EncSector_t, hashes.H2) + (7*20) + 4 == 0x3D0, "IV location is wrong");
-		EncSector_t sector_buf;	// Decrypted sector data.
+		static_assert(offsetof(EncSector_t, hashes.H2) + (7*20) + 4 == SECTOR_IV_OFFSET, "IV location is wrong");
+
+		// Decrypted sector cache. (LRU)
+		// FST and banner reads are often interleaved,
+		// so more than one sector is kept.
+		static const unsigned int SECTOR_CACHE_COUNT = 4;
+		struct CachedSector {
+			uint32_t sector_num;	// Sector number. (~0 if unused)
+			uint32_t lastUse;	// Last use. (for LRU replacement)
+			EncSector_t buf;	// Decrypted sector data.
+		};
+		std::array<CachedSector, SECTOR_CACHE_COUNT> sectorCache;
+		uint32_t sectorCacheUseCounter;
 
 		/**
 		 * Read and decrypt a sector.
-		 * The decrypted sector is stored in sector_buf.
+		 * The decrypted sector is stored in the sector cache.
 		 *
 		 * @param sector_num Sector number. (address / 0x7C00)
+		 * @return Decrypted sector, or nullptr on error.
+		 */
+		const EncSector_t *readSector(uint32_t sector_num);
+
+		/**
+		 * Find a sector in the sector cache.
+		 * @param sector_num Sector number. (address / 0x7C00)
+		 * @return Decrypted sector, or nullptr if it isn't cached.
+		 */
+		const EncSector_t *findCachedSector(uint32_t sector_num);
+
+		// Maximum size for readSectorPartial().
+		// Larger reads use the sector cache.
+		static const unsigned int SECTOR_PARTIAL_MAX = 4096;
+
+		/**
+		 * Read part of a sector's data without caching it.
+		 * Only the AES blocks that overlap the requested range are
+		 * read and decrypted. The IV is either the sector IV or the
+		 * ciphertext block immediately before the range.
+		 *
+		 * @param sector_num	[in] Sector number. (address / 0x7C00)
+		 * @param pos		[in] Starting position within the sector data.
+		 * @param ptr		[out] Output buffer.
+		 * @param size		[in] Amount of data to read. (Must be <= SECTOR_PARTIAL_MAX!)
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		int readSector(uint32_t sector_num);
+		int readSectorPartial(uint32_t sector_num, uint32_t pos, uint8_t *ptr, uint32_t size);
+
+		// Maximum number of sectors to read at once in readSectors().
+		static const unsigned int SECTOR_BATCH_COUNT = 64;
+
+		/**
+		 * Read and decrypt multiple full sectors.
+		 * The sectors are read from the disc using a single read,
+		 * and then each sector is decrypted directly into the
+		 * output buffer. The sector cache is bypassed.
+		 *
+		 * @param sector_start	[in] First sector number.
+		 * @param sector_count	[in] Number of sectors.
+		 * @param ptr		[out] Output buffer. (sector_count * sector data size)
+		 * @return Number of sectors read.
+		 */
+		uint32_t readSectors(uint32_t sector_start, uint32_t sector_count, uint8_t *ptr);
 
 #ifdef ENABLE_DECRYPTION
 	public:
@@ -125,6 +178,9 @@ class WiiPartitionPrivate : public GcnPartitionPrivate
 
 /** WiiPartitionPrivate **/
 
+// Out-of-class definition, since it's passed by reference to std::min().
+const unsigned int WiiPartitionPrivate::SECTOR_BATCH_COUNT;
+
 #ifdef ENABLE_DECRYPTION
 
 // Verification key names.
@@ -194,7 +250,7 @@ WiiPartitionPrivate::WiiPartitionPrivate(WiiPartition *q,
 	, encKeyReal(WiiPartition::EncKey::Unknown)
 	, cryptoMethod(cryptoMethod)
 	, pos_7C00(-1)
-	, sector_num(~0)
+	, sectorCacheUseCounter(0)
 	, aes_title(nullptr)
 #else /* !ENABLE_DECRYPTION */
 	, verifyResult(KeyManager::VerifyResult::NoSupport)
@@ -202,7 +258,7 @@ WiiPartitionPrivate::WiiPartitionPrivate(WiiPartition *q,
 	, encKeyReal(WiiPartition::EncKey::Unknown)
 	, cryptoMethod(cryptoMethod)
 	, pos_7C00(-1)
-	, sector_num(~0)
+	, sectorCacheUseCounter(0)
 #endif /* ENABLE_DECRYPTION */
 {
 	// Clear data set by GcnPartition in case the
@@ -214,6 +270,12 @@ WiiPartitionPrivate::WiiPartitionPrivate(WiiPartition *q,
 	// Clear the partition header struct.
 	memset(&partitionHeader, 0, sizeof(partitionHeader));
 
+	// Clear the sector cache.
+	for (CachedSector &sector : sectorCache) {
+		sector.sector_num = ~0U;
+		sector.lastUse = 0;
+	}
+
 	// Partition header will be read in the WiiPartition constructor.
 }
 
@@ -380,7 +442,8 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 
 	// Read sector 0, which contains a disc header.
 	// NOTE: readSector() doesn't check verifyResult.
-	if (readSector(0) != 0) {
+	const EncSector_t *const sector0 = readSector(0);
+	if (!sector0) {
 		// Error reading sector 0.
 		delete aes_title;
 		aes_title = nullptr;
@@ -391,7 +454,7 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 	// Verify that this is a Wii partition.
 	// If it isn't, the key is probably wrong.
 	const GCN_DiscHeader *const discHeader =
-		reinterpret_cast<const GCN_DiscHeader*>(sector_buf.data);
+		reinterpret_cast<const GCN_DiscHeader*>(sector0->data);
 	if (discHeader->magic_wii != cpu_to_be32(WII_MAGIC)) {
 		// Invalid disc header.
 
@@ -402,7 +465,7 @@ KeyManager::VerifyResult WiiPartitionPrivate::initDecryption(void)
 			0x00,0x00,0x00,0x10, 0x00,0x00,0x00,0x14,
 			0x00,0x00,0x00,0x18, 0x00,0x00,0x00,0x1C,
 		};
-		if (!memcmp(sector_buf.data, incr_vals, sizeof(incr_vals))) {
+		if (!memcmp(sector0->data, incr_vals, sizeof(incr_vals))) {
 			// Found incrementing values.
 			verifyResult = KeyManager::VerifyResult::IncrementingValues;
 		} else {
@@ -428,16 +491,26 @@ WiiPartitionPrivate::~WiiPartitionPrivate()
 
 /**
  * Read and decrypt a sector.
- * The decrypted sector is stored in sector_buf.
+ * The decrypted sector is stored in the sector cache.
  *
  * @param sector_num Sector number. (address / 0x7C00)
- * @return 0 on success; negative POSIX error code on error.
+ * @return Decrypted sector, or nullptr on error.
  */
-int WiiPartitionPrivate::readSector(uint32_t sector_num)
+const WiiPartitionPrivate::EncSector_t *WiiPartitionPrivate::readSector(uint32_t sector_num)
 {
-	if (this->sector_num == sector_num) {
+	// Check if the sector is cached.
+	const EncSector_t *const cached = findCachedSector(sector_num);
+	if (cached) {
 		// Sector is already in memory.
-		return 0;
+		return cached;
+	}
+
+	// Find the least recently used sector.
+	CachedSector *lru = &sectorCache[0];
+	for (CachedSector &sector : sectorCache) {
+		if (sector.lastUse < lru->lastUse) {
+			lru = &sector;
+		}
 	}
 
 	RP_Q(WiiPartition);
@@ -446,7 +519,7 @@ int WiiPartitionPrivate::readSector(uint32_t sector_num)
 	if (isCrypted) {
 		// Decryption is disabled.
 		q->m_lastError = EIO;
-		return -1;
+		return nullptr;
 	}
 #endif /* !ENABLE_DECRYPTION */
 
@@ -456,37 +529,232 @@ int WiiPartitionPrivate::readSector(uint32_t sector_num)
 	off64_t sector_addr = partition_offset + data_offset;
 	sector_addr += (static_cast<off64_t>(sector_num) * SECTOR_SIZE_ENCRYPTED);
 
-	int ret = q->m_discReader->seek(sector_addr);
-	if (ret != 0) {
-		q->m_lastError = q->m_discReader->lastError();
-		return ret;
+	// Only the sector data is needed, plus the data IV if it's encrypted.
+	// The rest of the hash area is neither read nor decrypted.
+	uint32_t readOffset;
+	if ((cryptoMethod & WiiPartition::CM_MASK_SECTOR) == WiiPartition::CM_32K) {
+		readOffset = 0;
+	} else {
+		readOffset = (isCrypted ? SECTOR_IV_OFFSET : SECTOR_SIZE_DECRYPTED_OFFSET);
 	}
 
-	size_t sz = q->m_discReader->read(&sector_buf, sizeof(sector_buf));
-	if (sz != sizeof(sector_buf)) {
-		// sector_buf may be invalid.
-		this->sector_num = ~0;
-		q->m_lastError = EIO;
-		return -1;
+	// The least recently used sector will be overwritten.
+	lru->sector_num = ~0U;
+	EncSector_t *const buf = &lru->buf;
+	const size_t sz_req = SECTOR_SIZE_ENCRYPTED - readOffset;
+	size_t sz = q->m_discReader->seekAndRead(sector_addr + readOffset, &buf->fulldata[readOffset], sz_req);
+	if (sz != sz_req) {
+		// Read error.
+		q->m_lastError = q->m_discReader->lastError();
+		if (q->m_lastError == 0) {
+			q->m_lastError = EIO;
+		}
+		return nullptr;
 	}
 
 #ifdef ENABLE_DECRYPTION
 	if (isCrypted) {
 		// Decrypt the sector.
-		if (aes_title->decrypt(sector_buf.data, sizeof(sector_buf.data),
-		    &sector_buf.hashes.H2[7][4], 16) != SECTOR_SIZE_DECRYPTED)
+		if (aes_title->decrypt(buf->data, sizeof(buf->data),
+		    &buf->hashes.H2[7][4], 16) != SECTOR_SIZE_DECRYPTED)
 		{
-			// sector_buf may be invalid.
-			this->sector_num = ~0;
+			// Decryption error.
 			q->m_lastError = EIO;
-			return -1;
+			return nullptr;
 		}
 	}
 #endif /* ENABLE_DECRYPTION */
 
 	// Sector read and decrypted.
-	this->sector_num = sector_num;
+	lru->sector_num = sector_num;
+	lru->lastUse = ++sectorCacheUseCounter;
+	return buf;
+}
+
+/**
+ * Find a sector in the sector cache.
+ * @param sector_num Sector number. (address / 0x7C00)
+ * @return Decrypted sector, or nullptr if it isn't cached.
+ */
+const WiiPartitionPrivate::EncSector_t *WiiPartitionPrivate::findCachedSector(uint32_t sector_num)
+{
+	for (CachedSector &sector : sectorCache) {
+		if (sector.sector_num == sector_num) {
+			sector.lastUse = ++sectorCacheUseCounter;
+			return &sector.buf;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Read part of a sector's data without caching it.
+ * Only the AES blocks that overlap the requested range are
+ * read and decrypted. The IV is either the sector IV or the
+ * ciphertext block immediately before the range.
+ *
+ * @param sector_num	[in] Sector number. (address / 0x7C00)
+ * @param pos		[in] Starting position within the sector data.
+ * @param ptr		[out] Output buffer.
+ * @param size		[in] Amount of data to read. (Must be <= SECTOR_PARTIAL_MAX!)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int WiiPartitionPrivate::readSectorPartial(uint32_t sector_num, uint32_t pos, uint8_t *ptr, uint32_t size)
+{
+	RP_Q(WiiPartition);
+	assert(size <= SECTOR_PARTIAL_MAX);
+	if (size > SECTOR_PARTIAL_MAX) {
+		return -EINVAL;
+	}
+
+	const off64_t sector_addr = partition_offset + data_offset +
+		(static_cast<off64_t>(sector_num) * SECTOR_SIZE_ENCRYPTED);
+
+	const bool isCrypted = ((cryptoMethod & WiiPartition::CM_MASK_ENCRYPTED) == WiiPartition::CM_ENCRYPTED);
+	if (!isCrypted) {
+		// Not encrypted. Read the data directly.
+		const off64_t addr = sector_addr + pos +
+			(((cryptoMethod & WiiPartition::CM_MASK_SECTOR) == WiiPartition::CM_32K)
+				? 0 : SECTOR_SIZE_DECRYPTED_OFFSET);
+		size_t sz = q->m_discReader->seekAndRead(addr, ptr, size);
+		if (sz != size) {
+			q->m_lastError = q->m_discReader->lastError();
+			if (q->m_lastError == 0) {
+				q->m_lastError = EIO;
+			}
+			return -q->m_lastError;
+		}
+		return 0;
+	}
+
+#ifdef ENABLE_DECRYPTION
+	// Determine which AES blocks are needed.
+	const uint32_t aesStart = pos & ~15U;
+	const uint32_t aesEnd = ALIGN_BYTES(16, pos + size);
+
+	// The IV for the first block is the sector IV if this is the
+	// start of the sector data. Otherwise, it's the previous block.
+	// NOTE: The sector IV is 0x20 bytes before the sector data,
+	// so it's read along with the data.
+	const uint32_t readStart = (aesStart == 0)
+		? SECTOR_IV_OFFSET
+		: (SECTOR_SIZE_DECRYPTED_OFFSET + aesStart - 16);
+	const uint32_t readEnd = SECTOR_SIZE_DECRYPTED_OFFSET + aesEnd;
+	const uint32_t dataStart = SECTOR_SIZE_DECRYPTED_OFFSET + aesStart - readStart;
+
+	uint8_t buf[SECTOR_PARTIAL_MAX + 64];
+	const size_t sz_req = readEnd - readStart;
+	assert(sz_req <= sizeof(buf));
+	size_t sz = q->m_discReader->seekAndRead(sector_addr + readStart, buf, sz_req);
+	if (sz != sz_req) {
+		q->m_lastError = q->m_discReader->lastError();
+		if (q->m_lastError == 0) {
+			q->m_lastError = EIO;
+		}
+		return -q->m_lastError;
+	}
+
+	// Decrypt the blocks.
+	const uint32_t aesSize = aesEnd - aesStart;
+	if (aes_title->decrypt(&buf[dataStart], aesSize, buf, 16) != aesSize) {
+		// Decryption error.
+		q->m_lastError = EIO;
+		return -EIO;
+	}
+
+	memcpy(ptr, &buf[dataStart + (pos - aesStart)], size);
 	return 0;
+#else /* !ENABLE_DECRYPTION */
+	// Decryption is disabled.
+	q->m_lastError = EIO;
+	return -EIO;
+#endif /* ENABLE_DECRYPTION */
+}
+
+/**
+ * Read and decrypt multiple full sectors.
+ * The sectors are read from the disc using a single read,
+ * and then each sector is decrypted directly into the
+ * output buffer. The sector cache is bypassed.
+ *
+ * @param sector_start	[in] First sector number.
+ * @param sector_count	[in] Number of sectors.
+ * @param ptr		[out] Output buffer. (sector_count * sector data size)
+ * @return Number of sectors read.
+ */
+uint32_t WiiPartitionPrivate::readSectors(uint32_t sector_start, uint32_t sector_count, uint8_t *ptr)
+{
+	RP_Q(WiiPartition);
+	const off64_t sector_addr = partition_offset + data_offset +
+		(static_cast<off64_t>(sector_start) * SECTOR_SIZE_ENCRYPTED);
+
+	if ((cryptoMethod & WiiPartition::CM_MASK_SECTOR) == WiiPartition::CM_32K) {
+		// Full 32K sectors. (implies no encryption)
+		// Read the sectors directly into the output buffer.
+		const size_t sz_req = static_cast<size_t>(sector_count) * SECTOR_SIZE_ENCRYPTED;
+		size_t sz = q->m_discReader->seekAndRead(sector_addr, ptr, sz_req);
+		if (sz != sz_req) {
+			q->m_lastError = q->m_discReader->lastError();
+			if (q->m_lastError == 0) {
+				q->m_lastError = EIO;
+			}
+		}
+		return static_cast<uint32_t>(sz / SECTOR_SIZE_ENCRYPTED);
+	}
+
+	const bool isCrypted = ((cryptoMethod & WiiPartition::CM_MASK_ENCRYPTED) == WiiPartition::CM_ENCRYPTED);
+#ifndef ENABLE_DECRYPTION
+	if (isCrypted) {
+		// Decryption is disabled.
+		q->m_lastError = EIO;
+		return 0;
+	}
+#endif /* !ENABLE_DECRYPTION */
+
+	// Read the encrypted sectors in batches.
+	const uint32_t batch_count = std::min(sector_count, SECTOR_BATCH_COUNT);
+	unique_ptr<EncSector_t[]> encBuf(new EncSector_t[batch_count]);
+
+	uint32_t sectors_ok = 0;
+	while (sectors_ok < sector_count) {
+		const uint32_t count = std::min(sector_count - sectors_ok, batch_count);
+		const size_t sz_req = static_cast<size_t>(count) * SECTOR_SIZE_ENCRYPTED;
+		const size_t sz = q->m_discReader->seekAndRead(
+			sector_addr + (static_cast<off64_t>(sectors_ok) * SECTOR_SIZE_ENCRYPTED),
+			encBuf.get(), sz_req);
+		const uint32_t count_read = static_cast<uint32_t>(sz / SECTOR_SIZE_ENCRYPTED);
+
+		for (uint32_t i = 0; i < count_read; i++, ptr += SECTOR_SIZE_DECRYPTED) {
+			// Copy the encrypted data to the output buffer.
+			// NOTE: Each sector has its own IV, stored in its hash area,
+			// so sectors can't be decrypted as a single CBC stream.
+			memcpy(ptr, encBuf[i].data, SECTOR_SIZE_DECRYPTED);
+#ifdef ENABLE_DECRYPTION
+			if (isCrypted) {
+				// Decrypt the sector.
+				if (aes_title->decrypt(ptr, SECTOR_SIZE_DECRYPTED,
+				    &encBuf[i].hashes.H2[7][4], 16) != SECTOR_SIZE_DECRYPTED)
+				{
+					// Decryption error.
+					q->m_lastError = EIO;
+					return sectors_ok;
+				}
+			}
+#endif /* ENABLE_DECRYPTION */
+			sectors_ok++;
+		}
+
+		if (count_read != count) {
+			// Read error.
+			q->m_lastError = q->m_discReader->lastError();
+			if (q->m_lastError == 0) {
+				q->m_lastError = EIO;
+			}
+			break;
+		}
+	}
+
+	return sectors_ok;
 }
 
 /** WiiPartition **/
@@ -598,7 +866,6 @@ size_t WiiPartition::read(void *ptr, size_t size)
 		return 0;
 	}
 
-	// TODO: Consolidate this code and optimize it.
 	size_t ret = 0;
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 
@@ -612,155 +879,158 @@ size_t WiiPartition::read(void *ptr, size_t size)
 		size = static_cast<size_t>(d->data_size - d->pos_7C00);
 	}
 
-	if ((d->cryptoMethod & CM_MASK_SECTOR) == CM_32K) {
-		// Full 32K sectors. (implies no encryption)
-
-		// Check if we're not starting on a block boundary.
-		const uint32_t blockStartOffset = d->pos_7C00 % SECTOR_SIZE_ENCRYPTED;
-		if (blockStartOffset != 0) {
-			// Not a block boundary.
-			// Read the end of the block.
-			uint32_t read_sz = SECTOR_SIZE_ENCRYPTED - blockStartOffset;
-			if (size < static_cast<size_t>(read_sz)) {
-				read_sz = static_cast<uint32_t>(size);
-			}
-
-			// Read and decrypt the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, &d->sector_buf.fulldata[blockStartOffset], read_sz);
-
-			// Starting block read.
-			size -= read_sz;
-			ptr8 += read_sz;
-			ret += read_sz;
-			d->pos_7C00 += read_sz;
-		}
-
-		// Read entire blocks.
-		for (; size >= SECTOR_SIZE_ENCRYPTED;
-		     size -= SECTOR_SIZE_ENCRYPTED, ptr8 += SECTOR_SIZE_ENCRYPTED,
-		     ret += SECTOR_SIZE_ENCRYPTED, d->pos_7C00 += SECTOR_SIZE_ENCRYPTED)
-		{
-			assert(d->pos_7C00 % SECTOR_SIZE_ENCRYPTED == 0);
-
-			// Read the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.fulldata, SECTOR_SIZE_ENCRYPTED);
-		}
-
-		// Check if we still have data left. (not a full block)
-		if (size > 0) {
-			// Not a full block.
-
-			// Read the sector.
-			assert(d->pos_7C00 % SECTOR_SIZE_ENCRYPTED == 0);
-			const uint32_t blockEnd = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_ENCRYPTED);
-			d->readSector(blockEnd);
-
-			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.fulldata, size);
-
-			ret += size;
-			d->pos_7C00 += size;
-		}
-	} else {
-		if ((d->cryptoMethod & CM_MASK_ENCRYPTED) == CM_ENCRYPTED) {
+	const bool is32K = ((d->cryptoMethod & CM_MASK_SECTOR) == CM_32K);
+	if (!is32K && (d->cryptoMethod & CM_MASK_ENCRYPTED) == CM_ENCRYPTED) {
 #ifdef ENABLE_DECRYPTION
-			// Make sure decryption is initialized.
-			switch (d->verifyResult) {
-				case KeyManager::VerifyResult::Unknown:
-					// Attempt to initialize decryption.
-					if (d->initDecryption() != KeyManager::VerifyResult::OK) {
-						// Decryption could not be initialized.
-						// TODO: Better error?
-						m_lastError = EIO;
-						return 0;
-					}
-					break;
-
-				case KeyManager::VerifyResult::OK:
-					// Decryption is initialized.
-					break;
-
-				default:
-					// Decryption failed to initialize.
+		// Make sure decryption is initialized.
+		switch (d->verifyResult) {
+			case KeyManager::VerifyResult::Unknown:
+				// Attempt to initialize decryption.
+				if (d->initDecryption() != KeyManager::VerifyResult::OK) {
+					// Decryption could not be initialized.
 					// TODO: Better error?
 					m_lastError = EIO;
 					return 0;
-			}
+				}
+				break;
+
+			case KeyManager::VerifyResult::OK:
+				// Decryption is initialized.
+				break;
+
+			default:
+				// Decryption failed to initialize.
+				// TODO: Better error?
+				m_lastError = EIO;
+				return 0;
+		}
 #else /* !ENABLE_DECRYPTION */
-			// Decryption is not enabled.
-			m_lastError = EIO;
-			ret = 0;
+		// Decryption is not enabled.
+		m_lastError = EIO;
+		return 0;
 #endif /* ENABLE_DECRYPTION */
-		}
-
-		// Check if we're not starting on a block boundary.
-		const uint32_t blockStartOffset = d->pos_7C00 % SECTOR_SIZE_DECRYPTED;
-		if (blockStartOffset != 0) {
-			// Not a block boundary.
-			// Read the end of the block.
-			uint32_t read_sz = SECTOR_SIZE_DECRYPTED - blockStartOffset;
-			if (size < static_cast<size_t>(read_sz)) {
-				read_sz = static_cast<uint32_t>(size);
-			}
-
-			// Read and decrypt the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockStart);
-
-			// Copy data from the sector.
-			memcpy(ptr8, &d->sector_buf.data[blockStartOffset], read_sz);
+	}
 
-			// Starting block read.
-			size -= read_sz;
-			ptr8 += read_sz;
-			ret += read_sz;
-			d->pos_7C00 += read_sz;
+	// Full 32K sectors have no hash area. (implies no encryption)
+	// Otherwise, the sector data is 0x7C00 bytes starting at 0x400.
+	const uint32_t sectorDataSize = (is32K ? SECTOR_SIZE_ENCRYPTED : SECTOR_SIZE_DECRYPTED);
+	const uint32_t sectorDataOffset = (is32K ? 0 : SECTOR_SIZE_DECRYPTED_OFFSET);
+
+	// Check if we're not starting on a block boundary.
+	const uint32_t blockStartOffset = d->pos_7C00 % sectorDataSize;
+	if (blockStartOffset != 0) {
+		// Not a block boundary.
+		// Read the end of the block.
+		uint32_t read_sz = sectorDataSize - blockStartOffset;
+		if (size < static_cast<size_t>(read_sz)) {
+			read_sz = static_cast<uint32_t>(size);
 		}
 
-		// Read entire blocks.
-		for (; size >= SECTOR_SIZE_DECRYPTED;
-		size -= SECTOR_SIZE_DECRYPTED, ptr8 += SECTOR_SIZE_DECRYPTED,
-		ret += SECTOR_SIZE_DECRYPTED, d->pos_7C00 += SECTOR_SIZE_DECRYPTED)
+		// Read and decrypt the sector.
+		// Small reads from uncached sectors only decrypt what's needed.
+		const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / sectorDataSize);
+		const WiiPartitionPrivate::EncSector_t *const sector = (read_sz <= WiiPartitionPrivate::SECTOR_PARTIAL_MAX)
+			? d->findCachedSector(blockStart)
+			: d->readSector(blockStart);
+		if (sector) {
+			// Copy data from the sector.
+			memcpy(ptr8, &sector->fulldata[sectorDataOffset + blockStartOffset], read_sz);
+		} else if (read_sz > WiiPartitionPrivate::SECTOR_PARTIAL_MAX ||
+		           d->readSectorPartial(blockStart, blockStartOffset, ptr8, read_sz) != 0)
 		{
-			assert(d->pos_7C00 % SECTOR_SIZE_DECRYPTED == 0);
+			// Error reading the sector.
+			return ret;
+		}
 
-			// Read and decrypt the sector.
-			const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockStart);
+		// Starting block read.
+		size -= read_sz;
+		ptr8 += read_sz;
+		ret += read_sz;
+		d->pos_7C00 += read_sz;
+	}
 
-			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.data, SECTOR_SIZE_DECRYPTED);
+	// Read entire blocks.
+	if (size >= sectorDataSize * 2) {
+		// Multiple sectors. Read them all at once.
+		const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / sectorDataSize);
+		const uint32_t blockCount = static_cast<uint32_t>(size / sectorDataSize);
+		const uint32_t blocksOk = d->readSectors(blockStart, blockCount, ptr8);
+
+		const size_t sz_blocks = static_cast<size_t>(blocksOk) * sectorDataSize;
+		ret += sz_blocks;
+		d->pos_7C00 += sz_blocks;
+		if (blocksOk != blockCount) {
+			// Error reading the sectors.
+			return ret;
+		}
+		size -= sz_blocks;
+		ptr8 += sz_blocks;
+	} else if (size >= sectorDataSize) {
+		// Single sector.
+		assert(d->pos_7C00 % sectorDataSize == 0);
+		const uint32_t blockStart = static_cast<uint32_t>(d->pos_7C00 / sectorDataSize);
+		const WiiPartitionPrivate::EncSector_t *const sector = d->readSector(blockStart);
+		if (!sector) {
+			// Error reading the sector.
+			return ret;
 		}
 
-		// Check if we still have data left. (not a full block)
-		if (size > 0) {
-			// Not a full block.
+		// Copy data from the sector.
+		memcpy(ptr8, &sector->fulldata[sectorDataOffset], sectorDataSize);
 
-			// Read and decrypt the sector.
-			assert(d->pos_7C00 % SECTOR_SIZE_DECRYPTED == 0);
-			const uint32_t blockEnd = static_cast<uint32_t>(d->pos_7C00 / SECTOR_SIZE_DECRYPTED);
-			d->readSector(blockEnd);
+		size -= sectorDataSize;
+		ptr8 += sectorDataSize;
+		ret += sectorDataSize;
+		d->pos_7C00 += sectorDataSize;
+	}
 
+	// Check if we still have data left. (not a full block)
+	if (size > 0) {
+		// Not a full block.
+
+		// Read and decrypt the sector.
+		// Small reads from uncached sectors only decrypt what's needed.
+		assert(d->pos_7C00 % sectorDataSize == 0);
+		const uint32_t blockEnd = static_cast<uint32_t>(d->pos_7C00 / sectorDataSize);
+		const WiiPartitionPrivate::EncSector_t *const sector = (size <= WiiPartitionPrivate::SECTOR_PARTIAL_MAX)
+			? d->findCachedSector(blockEnd)
+			: d->readSector(blockEnd);
+		if (sector) {
 			// Copy data from the sector.
-			memcpy(ptr8, d->sector_buf.data, size);
-
-			ret += size;
-			d->pos_7C00 += size;
+			memcpy(ptr8, &sector->fulldata[sectorDataOffset], size);
+		} else if (size > WiiPartitionPrivate::SECTOR_PARTIAL_MAX ||
+		           d->readSectorPartial(blockEnd, 0, ptr8, static_cast<uint32_t>(size)) != 0)
+		{
+			// Error reading the sector.
+			return ret;
 		}
+
+		ret += size;
+		d->pos_7C00 += size;
 	}
 
 	// Finished reading the data.
 	return ret;
 }
 
+/**
+ * Read data from the partition at the specified position.
+ * The partition position is not changed.
+ *
+ * NOTE: GcnPartition::readAt() reads directly from the disc,
+ * which doesn't account for the sector hashes or encryption,
+ * so this uses the default seek-and-read implementation.
+ *
+ * @param pos	[in] Partition position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t WiiPartition::readAt(off64_t pos, void *ptr, size_t size)
+{
+	return IDiscReader::readAt(pos, ptr, size);
+}
+
 /**
  * Set the partition position.
  * @param pos Partition position.
@@ -806,6 +1076,19 @@ off64_t WiiPartition::tell(void)
 	return d->pos_7C00;
 }
 
+/**
+ * Get the natural block size of the partition.
+ * This is the amount of user data in each sector.
+ * @return Block size, in bytes.
+ */
+unsigned int WiiPartition::blockSize(void) const
+{
+	RP_D(const WiiPartition);
+	return ((d->cryptoMethod & CM_MASK_SECTOR) == CM_32K)
+		? SECTOR_SIZE_ENCRYPTED
+		: SECTOR_SIZE_DECRYPTED;
+}
+
 /**
  * Get the used partition size.
  * This size includes the partition header and hashes,
@@ -73,6 +73,22 @@ class WiiPartition : public GcnPartition
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the partition at the specified position.
+		 * The partition position is not changed.
+		 *
+		 * NOTE: GcnPartition::readAt() reads directly from the disc,
+		 * which doesn't account for the sector hashes or encryption,
+		 * so this uses the default seek-and-read implementation.
+		 *
+		 * @param pos	[in] Partition position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
 		/**
 		 * Set the partition position.
 		 * @param pos Partition position.
@@ -86,6 +102,13 @@ class WiiPartition : public GcnPartition
 		 */
 		off64_t tell(void) final;
 
+		/**
+		 * Get the natural block size of the partition.
+		 * This is the amount of user data in each sector.
+		 * @return Block size, in bytes.
+		 */
+		unsigned int blockSize(void) const final;
+
 	public:
 		/**
 		 * Get the used partition size.
@@ -14,9 +14,14 @@
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
 
+// C++ includes.
+#include <list>
+
 // C++ STL classes.
+using std::list;
 using std::string;
 using std::unordered_map;
+using std::vector;
 
 namespace LibRomData {
 
@@ -41,37 +46,71 @@ class XDVDFSPartitionPrivate
 		// All fields are byteswapped in the constructor.
 		XDVDFS_Header xdvdfsHeader;
 
-		// Cached directories.
-		// - Key: Directory. ("/" for root)
-		// - Value: Raw directory table from the disc.
-		// NOTE: Directory entries are variable-length, so this
-		// is a byte array, not an ISO_DirEntry array.
-		unordered_map<std::string, ao::uvector<uint8_t> > dirTables;
+		// Directory table.
+		struct DirTable {
+			// Raw directory table from the disc.
+			// NOTE: Directory entries are variable-length, so this
+			// is a byte array, not an XDVDFS_DirEntry array.
+			ao::uvector<uint8_t> data;
+
+			// Sorted name index. (built on first lookup)
+			// Offsets of all XDVDFS_DirEntry records reachable
+			// from the root of the tree, sorted by filename
+			// using xdvdfs_strncasecmp().
+			vector<uint32_t> nameIndex;
+			bool hasNameIndex;
+
+			DirTable() : hasNameIndex(false) { }
+		};
+
+		// Cached directories. (most recently used first)
+		// - Key: Directory, in uppercase. ("/" for root)
+		// - Value: Directory table.
+		// The cache is limited to DIR_CACHE_MAX_SIZE bytes.
+		static const size_t DIR_CACHE_MAX_SIZE = 2U*1024U*1024U;
+		typedef std::pair<string, DirTable> DirCacheEntry;
+		list<DirCacheEntry> dirCache;
+		unordered_map<string, list<DirCacheEntry>::iterator> dirCacheMap;
+		size_t dirCacheSize;
+
+		/**
+		 * Build a directory table's sorted name index.
+		 * @param dirTable Directory table.
+		 */
+		static void buildNameIndex(DirTable *dirTable);
 
 		/**
 		 * Get an entry within a specified directory table.
 		 * @param dirTable Directory table.
-		 * @param filename Filename to find, without subdirectories.
+		 * @param filename Filename to find, without subdirectories. (UTF-8)
 		 * @return Pointer to XDVDFS_DirEntry within dirTable, or nullptr if not found.
 		 */
-		const XDVDFS_DirEntry *getDirEntry(const ao::uvector<uint8_t> *dirTable, const char *filename);
+		const XDVDFS_DirEntry *getDirEntry(DirTable *dirTable, const char *filename);
 
 		/**
 		 * Get the specified directory.
 		 * This should *only* be the directory, not a filename.
-		 * @param path Directory path.
-		 * @return Pointer to directory table (ao::uvector), or nullptr if not found.
+		 *
+		 * NOTE: The returned pointer is only valid until
+		 * the next call to getDirectory().
+		 *
+		 * @param path Directory path. (UTF-8)
+		 * @return Pointer to directory table, or nullptr if not found.
 		 */
-		const ao::uvector<uint8_t> *getDirectory(const char *path);
+		DirTable *getDirectory(const char *path);
 
 		/**
-		 * XDVDFS strcasecmp() implementation.
+		 * XDVDFS strncasecmp() implementation.
 		 * Uses generic ASCII handling instead of locale-specific case folding.
+		 * The strings do not need to be NULL-terminated.
 		 * @param s1 String 1
+		 * @param len1 Length of s1
 		 * @param s2 String 2
+		 * @param len2 Length of s2
 		 * @return 0 (==), negative (<), or positive (>).
 		 */
-		static int xdvdfs_strcasecmp(const char *s1, const char *s2);
+		static int xdvdfs_strncasecmp(const char *s1, size_t len1, const char *s2, size_t len2);
+
 };
 
 /** XDVDFSPartitionPrivate **/
@@ -81,6 +120,7 @@ XDVDFSPartitionPrivate::XDVDFSPartitionPrivate(XDVDFSPartition *q,
 	: q_ptr(q)
 	, partition_offset(partition_offset)
 	, partition_size(partition_size)
+	, dirCacheSize(0)
 {
 	// Clear the XDVDFS header struct.
 	memset(&xdvdfsHeader, 0, sizeof(xdvdfsHeader));
@@ -120,9 +160,9 @@ XDVDFSPartitionPrivate::XDVDFSPartitionPrivate(XDVDFSPartition *q,
 
 #if SYS_BYTEORDER == SYS_BIG_ENDIAN
 	// Byteswap the fields.
-	d->xdvdfsHeader.root_dir_sector	= le32_to_cpu(d->xdvdfsHeader.root_dir_sector);
-	d->xdvdfsHeader.root_dir_size	= le32_to_cpu(d->xdvdfsHeader.root_dir_size);
-	d->xdvdfsHeader.timestamp	= le64_to_cpu(d->xdvdfsHeader.timestamp);
+	xdvdfsHeader.root_dir_sector	= le32_to_cpu(xdvdfsHeader.root_dir_sector);
+	xdvdfsHeader.root_dir_size	= le32_to_cpu(xdvdfsHeader.root_dir_size);
+	xdvdfsHeader.timestamp	= le64_to_cpu(xdvdfsHeader.timestamp);
 #endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
 
 	// Load the root directory.
@@ -133,96 +173,144 @@ XDVDFSPartitionPrivate::~XDVDFSPartitionPrivate()
 { }
 
 /**
- * XDVDFS strcasecmp() implementation.
+ * XDVDFS strncasecmp() implementation.
  * Uses generic ASCII handling instead of locale-specific case folding.
+ * The strings do not need to be NULL-terminated.
  * @param s1 String 1
+ * @param len1 Length of s1
  * @param s2 String 2
+ * @param len2 Length of s2
  * @return 0 (==), negative (<), or positive (>).
  */
-int XDVDFSPartitionPrivate::xdvdfs_strcasecmp(const char *s1, const char *s2)
+int XDVDFSPartitionPrivate::xdvdfs_strncasecmp(const char *s1, size_t len1, const char *s2, size_t len2)
 {
 	// Reference: https://github.com/XboxDev/extract-xiso/blob/master/extract-xiso.c
 	// av1_compare_key()
-	while (true) {
-		char a = *s1++;
-		char b = *s2++;
+	const size_t len = std::min(len1, len2);
+	for (size_t i = 0; i < len; i++) {
+		char a = s1[i];
+		char b = s2[i];
 
 		// Convert to uppercase.
 		if (a >= 'a' && a <= 'z') a &= ~0x20;
 		if (b >= 'a' && b <= 'z') b &= ~0x20;
 
-		if (a) {
-			if (b) {
-				if (a < b) return -1;
-				if (a > b) return 1;
-			} else return 1;
-		} else return (b ? -1 : 0);
+		if (a < b) return -1;
+		if (a > b) return 1;
 	}
+
+	if (len1 < len2) return -1;
+	if (len1 > len2) return 1;
+	return 0;
+}
+
+/**
+ * Build a directory table's sorted name index.
+ * @param dirTable Directory table.
+ */
+void XDVDFSPartitionPrivate::buildNameIndex(DirTable *dirTable)
+{
+	dirTable->hasNameIndex = true;
+	const uint8_t *const p_start = dirTable->data.data();
+	const size_t dir_size = dirTable->data.size();
+	if (dir_size < sizeof(XDVDFS_DirEntry)) {
+		// Empty directory.
+		return;
+	}
+
+	// Walk the entire tree, starting at the root entry.
+	// Offsets are in DWORDs; the visited list prevents loops.
+	vector<bool> visited(dir_size / sizeof(uint32_t));
+	vector<uint32_t> pending;
+	pending.push_back(0);
+	while (!pending.empty()) {
+		const uint32_t offset = pending.back();
+		pending.pop_back();
+		if (visited[offset / sizeof(uint32_t)]) {
+			// Already visited.
+			continue;
+		}
+		visited[offset / sizeof(uint32_t)] = true;
+
+		const XDVDFS_DirEntry *const dirEntry = reinterpret_cast<const XDVDFS_DirEntry*>(p_start + offset);
+		if (offset + sizeof(*dirEntry) + dirEntry->name_length > dir_size) {
+			// Filename is out of bounds.
+			continue;
+		}
+		dirTable->nameIndex.push_back(offset);
+
+		const uint16_t subtree_offsets[2] = {
+			le16_to_cpu(dirEntry->left_offset),
+			le16_to_cpu(dirEntry->right_offset),
+		};
+		for (const uint16_t subtree_offset : subtree_offsets) {
+			if (subtree_offset == 0 || subtree_offset == 0xFFFF) {
+				// No subtree.
+				continue;
+			}
+			const uint32_t next = subtree_offset * sizeof(uint32_t);
+			if (next + sizeof(XDVDFS_DirEntry) <= dir_size) {
+				pending.push_back(next);
+			}
+		}
+	}
+
+	// Sort the index by filename.
+	std::sort(dirTable->nameIndex.begin(), dirTable->nameIndex.end(),
+		[p_start](uint32_t a, uint32_t b) {
+			const XDVDFS_DirEntry *const ea = reinterpret_cast<const XDVDFS_DirEntry*>(p_start + a);
+			const XDVDFS_DirEntry *const eb = reinterpret_cast<const XDVDFS_DirEntry*>(p_start + b);
+			return xdvdfs_strncasecmp(
+				reinterpret_cast<const char*>(ea + 1), ea->name_length,
+				reinterpret_cast<const char*>(eb + 1), eb->name_length) < 0;
+		});
 }
 
 /**
  * Get an entry within a specified directory table.
  * @param dirTable Directory table.
- * @param filename Filename to find, without subdirectories.
+ * @param filename Filename to find, without subdirectories. (UTF-8)
  * @return Pointer to XDVDFS_DirEntry within dirTable, or nullptr if not found.
  */
-const XDVDFS_DirEntry *XDVDFSPartitionPrivate::getDirEntry(const ao::uvector<uint8_t> *dirTable, const char *filename)
+const XDVDFS_DirEntry *XDVDFSPartitionPrivate::getDirEntry(DirTable *dirTable, const char *filename)
 {
 	assert(dirTable != nullptr);
 	assert(filename != nullptr);
+	RP_Q(XDVDFSPartition);
 	if (unlikely(!dirTable || !filename)) {
-		RP_Q(XDVDFSPartition);
 		q->m_lastError = EINVAL;
 		return nullptr;
 	}
 
+	if (!dirTable->hasNameIndex) {
+		// Build the name index on first use.
+		buildNameIndex(dirTable);
+	}
+
 	// Convert the filename portion to cp1252 before searching.
 	const string s_filename = utf8_to_cp1252(filename, -1);
 
-	// Find the file in the specified directory.
+	// Find the file in the name index.
 	// NOTE: Filenames are case-insensitive.
-	const XDVDFS_DirEntry *dirEntry_found = nullptr;
-	const uint8_t *const p_start = dirTable->data();
-	const uint8_t *const p_end = p_start + dirTable->size();
-	const uint8_t *p = p_start;
-	string s_entry_filename;	// Temporary for NULL termination.
-	while (p < p_end) {
-		const XDVDFS_DirEntry *dirEntry = reinterpret_cast<const XDVDFS_DirEntry*>(p);
-		const char *entry_filename = reinterpret_cast<const char*>(p) + sizeof(*dirEntry);
-		if (entry_filename + dirEntry->name_length > reinterpret_cast<const char*>(p_end)) {
-			// Filename is out of bounds.
-			break;
-		}
-
-		// NOTE: Filename might not be NULL-terminated.
-		// Temporarily cache the filename.
-		s_entry_filename.assign(entry_filename, dirEntry->name_length);
-
-		// Check the filename.
-		// TODO: Use non-locale-specific case-insensitive check? (only letters)
-		uint16_t subtree_offset = 0;
-		int cmp = xdvdfs_strcasecmp(s_filename.c_str(), s_entry_filename.c_str());
-		if (cmp == 0) {
-			// Found it!
-			dirEntry_found = dirEntry;
-			break;
-		} else if (cmp < 0) {
-			// Left subtree.
-			subtree_offset = le16_to_cpu(dirEntry->left_offset);
-		} else if (cmp > 0) {
-			// Right subtree.
-			subtree_offset = le16_to_cpu(dirEntry->right_offset);
-		}
-
-		if (subtree_offset == 0 || subtree_offset == 0xFFFF) {
-			// End of directory.
-			break;
-		}
-		p = p_start + (subtree_offset * sizeof(uint32_t));
+	const uint8_t *const p_start = dirTable->data.data();
+	auto iter = std::lower_bound(dirTable->nameIndex.cbegin(), dirTable->nameIndex.cend(), s_filename,
+		[p_start](uint32_t offset, const string &name) {
+			const XDVDFS_DirEntry *const dirEntry = reinterpret_cast<const XDVDFS_DirEntry*>(p_start + offset);
+			return xdvdfs_strncasecmp(
+				reinterpret_cast<const char*>(dirEntry + 1), dirEntry->name_length,
+				name.data(), name.size()) < 0;
+		});
+	if (iter == dirTable->nameIndex.cend()) {
+		// Not found.
+		q->m_lastError = ENOENT;
+		return nullptr;
 	}
-
-	if (!dirEntry_found) {
+	const XDVDFS_DirEntry *const dirEntry_found = reinterpret_cast<const XDVDFS_DirEntry*>(p_start + *iter);
+	if (xdvdfs_strncasecmp(reinterpret_cast<const char*>(dirEntry_found + 1), dirEntry_found->name_length,
+	                       s_filename.data(), s_filename.size()) != 0)
+	{
 		// Not found.
+		q->m_lastError = ENOENT;
 		return nullptr;
 	}
 
@@ -234,7 +322,6 @@ const XDVDFS_DirEntry *XDVDFSPartitionPrivate::getDirEntry(const ao::uvector<uin
 	    file_addr > (this->partition_size + this->partition_offset - file_size))
 	{
 		// File is out of bounds.
-		RP_Q(XDVDFSPartition);
 		q->m_lastError = EIO;
 		return nullptr;
 	}
@@ -246,10 +333,14 @@ const XDVDFS_DirEntry *XDVDFSPartitionPrivate::getDirEntry(const ao::uvector<uin
 /**
  * Get the specified directory.
  * This should *only* be the directory, not a filename.
- * @param path Directory path.
- * @return Pointer to directory table (ao::uvector), or nullptr if not found.
+ *
+ * NOTE: The returned pointer is only valid until
+ * the next call to getDirectory().
+ *
+ * @param path Directory path. (UTF-8)
+ * @return Pointer to directory table, or nullptr if not found.
  */
-const ao::uvector<uint8_t> *XDVDFSPartitionPrivate::getDirectory(const char *path)
+XDVDFSPartitionPrivate::DirTable *XDVDFSPartitionPrivate::getDirectory(const char *path)
 {
 	RP_Q(XDVDFSPartition);
 	if (unlikely(!path || path[0] != '/')) {
@@ -262,13 +353,29 @@ const ao::uvector<uint8_t> *XDVDFSPartitionPrivate::getDirectory(const char *pat
 		return nullptr;
 	}
 
-	// TODO: Remove unnecessary leading and trailing slashes.
+	// Normalize the path: Remove duplicate and trailing
+	// slashes, and convert to uppercase.
+	string key;
+	key.reserve(strlen(path));
+	for (; *path != '\0'; path++) {
+		char chr = *path;
+		if (chr == '/' && !key.empty() && key[key.size()-1] == '/')
+			continue;
+		if (chr >= 'a' && chr <= 'z')
+			chr &= ~0x20;
+		key += chr;
+	}
+	if (key.size() > 1 && key[key.size()-1] == '/') {
+		key.resize(key.size()-1);
+	}
 
 	// Is this directory table already loaded?
-	auto iter = dirTables.find(path);
-	if (iter != dirTables.end()) {
+	auto iter = dirCacheMap.find(key);
+	if (iter != dirCacheMap.end()) {
 		// Directory table is already loaded.
-		return &(iter->second);
+		// Move it to the front of the LRU list.
+		dirCache.splice(dirCache.begin(), dirCache, iter->second);
+		return &(iter->second->second);
 	}
 
 	// DiscReader must be available now.
@@ -282,30 +389,50 @@ const ao::uvector<uint8_t> *XDVDFSPartitionPrivate::getDirectory(const char *pat
 	off64_t dir_addr = 0;
 	uint32_t dir_size = 0;
 
-	if (!strcmp(path, "/")) {
+	if (key == "/") {
 		// Special handling for the root directory.
-
-		// Root directory size should be less than 16 MB.
-		if (xdvdfsHeader.root_dir_size > 16*1024*1024) {
-			// Root directory is too big.
-			q->m_lastError = EIO;
-			return nullptr;
-		}
-
-		// Root directory offsets.
 		dir_addr = partition_offset + (
 			static_cast<off64_t>(xdvdfsHeader.root_dir_sector) * XDVDFS_BLOCK_SIZE);
 		dir_size = xdvdfsHeader.root_dir_size;
 	} else {
 		// Get the parent directory.
-		// TODO
+		const size_t sl = key.rfind('/');
+		const string s_parentDir = (sl == 0 ? string(1, '/') : key.substr(0, sl));
+		DirTable *const parentDir = getDirectory(s_parentDir.c_str());
+		if (!parentDir) {
+			// Parent directory not found.
+			// getDirectory() has already set m_lastError.
+			return nullptr;
+		}
+
+		const XDVDFS_DirEntry *const dirEntry = getDirEntry(parentDir, key.c_str() + sl + 1);
+		if (!dirEntry) {
+			// Directory not found.
+			// getDirEntry() has already set m_lastError.
+			return nullptr;
+		} else if (!(dirEntry->attributes & XDVDFS_ATTR_DIRECTORY)) {
+			// Not a directory.
+			q->m_lastError = ENOTDIR;
+			return nullptr;
+		}
+
+		dir_addr = partition_offset + (
+			static_cast<off64_t>(le32_to_cpu(dirEntry->start_sector)) * XDVDFS_BLOCK_SIZE);
+		dir_size = le32_to_cpu(dirEntry->file_size);
+	}
+
+	// Directory size should be less than 16 MB.
+	if (dir_size > 16*1024*1024) {
+		// Directory is too big.
+		q->m_lastError = EIO;
 		return nullptr;
 	}
 
 	// Read the directory.
-	ao::uvector<uint8_t> dirTable(dir_size);
-	size_t size = q->m_discReader->seekAndRead(dir_addr, dirTable.data(), dirTable.size());
-	if (size != dirTable.size()) {
+	DirTable dirTable;
+	dirTable.data.resize(dir_size);
+	size_t size = q->m_discReader->seekAndRead(dir_addr, dirTable.data.data(), dirTable.data.size());
+	if (size != dirTable.data.size()) {
 		// Seek and/or read error.
 		q->m_lastError = q->m_discReader->lastError();
 		if (q->m_lastError == 0) {
@@ -315,10 +442,20 @@ const ao::uvector<uint8_t> *XDVDFSPartitionPrivate::getDirectory(const char *pat
 	}
 
 	// Save the directory table for later.
-	auto ins_iter = dirTables.insert(std::make_pair(path, std::move(dirTable)));
+	dirCache.emplace_front(key, std::move(dirTable));
+	dirCacheMap.emplace(std::move(key), dirCache.begin());
+	dirCacheSize += dir_size;
+
+	// Evict the least recently used directory tables
+	// if the cache is too big. The new table is kept.
+	while (dirCacheSize > DIR_CACHE_MAX_SIZE && dirCache.size() > 1) {
+		const DirCacheEntry &lru = dirCache.back();
+		dirCacheSize -= lru.second.data.size();
+		dirCacheMap.erase(lru.first);
+		dirCache.pop_back();
+	}
 
-	// Root directory loaded.
-	return &(ins_iter.first->second);
+	return &(dirCache.front().second);
 }
 
 /** XDVDFSPartition **/
@@ -452,6 +589,33 @@ off64_t XDVDFSPartition::partition_size_used(void) const
 	return partition_size();
 }
 
+/**
+ * Get the approximate amount of memory used by
+ * cached metadata, e.g. directory tables or the FST.
+ * @return Approximate memory usage, in bytes.
+ */
+size_t XDVDFSPartition::memoryUsage(void) const
+{
+	RP_D(const XDVDFSPartition);
+	size_t total = d->dirCacheSize;
+	for (const auto &entry : d->dirCache) {
+		total += entry.second.nameIndex.size() * sizeof(uint32_t);
+	}
+	return total;
+}
+
+/**
+ * Release cached metadata.
+ * It will be reloaded on demand.
+ */
+void XDVDFSPartition::releaseMemory(void)
+{
+	RP_D(XDVDFSPartition);
+	d->dirCacheMap.clear();
+	d->dirCache.clear();
+	d->dirCacheSize = 0;
+}
+
 /** XDVDFSPartition **/
 
 /** IFst wrapper functions. **/
@@ -523,8 +687,6 @@ IRpFile *XDVDFSPartition::open(const char *filename)
 	// TODO: File reference counter.
 	// This might be difficult to do because PartitionFile is a separate class.
 
-	// TODO: Support subdirectories.
-
 	// Filename must be valid, and must start with a slash.
 	// Only absolute paths are supported.
 	if (!filename || filename[0] != '/') {
@@ -534,27 +696,25 @@ IRpFile *XDVDFSPartition::open(const char *filename)
 		return nullptr;
 	}
 
-	// Remove leading slashes.
-	while (*filename == '/') {
-		filename++;
-	}
-	if (filename[0] == 0) {
-		// Nothing but slashes...
+	// Split the filename into the directory and the file.
+	const char *const sl = strrchr(filename, '/');
+	if (sl[1] == '\0') {
+		// No filename. (trailing slash)
+		m_lastError = EINVAL;
 		return nullptr;
 	}
+	const string s_dir(filename, (sl == filename ? 1 : sl - filename));
 
-	// TODO: Handle subdirectories.
-	// For now, assuming the file is in the root directory.
 	RP_D(XDVDFSPartition);
-	const ao::uvector<uint8_t> *const dirTable = d->getDirectory("/");
+	XDVDFSPartitionPrivate::DirTable *const dirTable = d->getDirectory(s_dir.c_str());
 	if (!dirTable) {
 		// Directory not found.
 		// getDirectory() has already set m_lastError.
 		return nullptr;
 	}
 
-	// Find the file in the root directory.
-	const XDVDFS_DirEntry *const dirEntry = d->getDirEntry(dirTable, filename);
+	// Find the file in the directory.
+	const XDVDFS_DirEntry *const dirEntry = d->getDirEntry(dirTable, sl + 1);
 	if (!dirEntry) {
 		// File not found.
 		// getDirEntry() has already set m_lastError.
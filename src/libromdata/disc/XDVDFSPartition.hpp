@@ -93,6 +93,20 @@ class XDVDFSPartition : public LibRpBase::IPartition
 		 */
 		off64_t partition_size_used(void) const final;
 
+	public:
+		/**
+		 * Get the approximate amount of memory used by
+		 * cached metadata, e.g. directory tables or the FST.
+		 * @return Approximate memory usage, in bytes.
+		 */
+		size_t memoryUsage(void) const final;
+
+		/**
+		 * Release cached metadata.
+		 * It will be reloaded on demand.
+		 */
+		void releaseMemory(void) final;
+
 	public:
 		/** IFst wrapper functions. **/
 
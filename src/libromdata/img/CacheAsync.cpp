@@ -0,0 +1,231 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CacheAsync.cpp: Asynchronous downloads.                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CacheManager.hpp"
+
+// librpfile, librpthreads
+#include "librpfile/IRpFile.hpp"
+#include "librpthreads/Thread.hpp"
+using LibRpFile::IRpFile;
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+using LibRpThreads::Thread;
+
+// C++ includes.
+#include <deque>
+#include <string>
+#include <utility>
+using std::deque;
+using std::string;
+
+namespace LibRomData {
+
+/**
+ * Asynchronous download state.
+ * There's a single download thread for all CacheManager instances.
+ * It's started when a request is queued, and it exits once the
+ * queue is empty.
+ */
+class CacheAsyncState
+{
+	public:
+		CacheAsyncState()
+			: cur_userdata(nullptr)
+			, cur_cancelled(false)
+			, isRunning(false)
+			, isExiting(false)
+		{ }
+
+		~CacheAsyncState()
+		{
+			// Discard any queued requests.
+			// The download thread is joined when it's destroyed.
+			MutexLocker locker(mutex);
+			queue.clear();
+			isExiting = true;
+		}
+
+	private:
+		RP_DISABLE_COPY(CacheAsyncState)
+
+	public:
+		// Download request.
+		struct Request {
+			string cache_key;
+			string proxyUrl;
+			bool offlineOnly;
+			bool packCache;
+			CacheManager::pfnDownloadAsyncCallback_t callback;
+			void *userdata;
+		};
+
+		Mutex mutex;		// Protects everything except cb_mutex.
+		Mutex cb_mutex;		// Held while a callback is running.
+		deque<Request> queue;
+
+		void *cur_userdata;	// User data for the current request
+		bool cur_cancelled;	// True if the current request was cancelled
+		bool isRunning;		// True if the download thread is running
+		bool isExiting;		// True if the library is being unloaded
+
+		// NOTE: Must be last so it's joined before
+		// the other fields are destroyed.
+		Thread thread;
+
+	public:
+		/**
+		 * Download thread function.
+		 * @param param CacheAsyncState
+		 */
+		static void thread_func(void *param);
+};
+
+static CacheAsyncState asyncState;
+
+/**
+ * Download thread function.
+ * @param param CacheAsyncState
+ */
+void CacheAsyncState::thread_func(void *param)
+{
+	CacheAsyncState *const state = static_cast<CacheAsyncState*>(param);
+
+	state->mutex.lock();
+	while (!state->queue.empty()) {
+		const Request req = std::move(state->queue.front());
+		state->queue.pop_front();
+		state->cur_userdata = req.userdata;
+		state->cur_cancelled = false;
+		state->mutex.unlock();
+
+		// Download the file.
+		CacheManager cache;
+		cache.setProxyUrl(req.proxyUrl);
+		cache.setOfflineOnly(req.offlineOnly);
+		cache.setPackCacheEnabled(req.packCache);
+		IRpFile *const file = cache.download(req.cache_key);
+
+		// Run the callback unless the request was cancelled
+		// while it was being downloaded.
+		// NOTE: cb_mutex must be locked before checking cur_cancelled.
+		// See cancelDownloadAsync().
+		state->cb_mutex.lock();
+		state->mutex.lock();
+		const bool cancelled = state->cur_cancelled;
+		state->mutex.unlock();
+		if (!cancelled) {
+			req.callback(req.cache_key, file, req.userdata);
+		}
+		state->cb_mutex.unlock();
+
+		if (file) {
+			file->unref();
+		}
+
+		state->mutex.lock();
+		state->cur_userdata = nullptr;
+	}
+
+	// Queue is empty. The thread will be joined
+	// the next time a request is queued.
+	state->isRunning = false;
+	state->mutex.unlock();
+}
+
+/**
+ * Download a file asynchronously.
+ *
+ * This works like download(), but it returns immediately.
+ * Requests are queued and handled in order by a download
+ * thread, which calls the callback function when each
+ * request is finished.
+ *
+ * The current proxy server and offline-only mode settings
+ * are used for the request.
+ *
+ * @param cache_key	[in] Cache key.
+ * @param callback	[in] Callback function.
+ * @param userdata	[in] User data for the callback function.
+ * @return 0 if the request was queued; negative POSIX error code on error.
+ */
+int CacheManager::downloadAsync(const string &cache_key,
+	pfnDownloadAsyncCallback_t callback, void *userdata)
+{
+	assert(callback != nullptr);
+	if (cache_key.empty() || !callback) {
+		return -EINVAL;
+	}
+
+	CacheAsyncState::Request req;
+	req.cache_key = cache_key;
+	req.proxyUrl = m_proxyUrl;
+	req.offlineOnly = m_offlineOnly;
+	req.packCache = m_packCache;
+	req.callback = callback;
+	req.userdata = userdata;
+
+	MutexLocker locker(asyncState.mutex);
+	if (asyncState.isExiting) {
+		return -ECANCELED;
+	}
+	asyncState.queue.push_back(std::move(req));
+	if (asyncState.isRunning) {
+		// The download thread will handle the new request.
+		return 0;
+	}
+
+	// Start the download thread.
+	// If it ran before, it has already finished processing
+	// the queue, so join() won't block for long.
+	asyncState.thread.join();
+	int ret = asyncState.thread.create(CacheAsyncState::thread_func, &asyncState);
+	if (ret != 0) {
+		// Unable to start the download thread.
+		asyncState.queue.pop_back();
+		return ret;
+	}
+	asyncState.isRunning = true;
+	return 0;
+}
+
+/**
+ * Cancel asynchronous downloads.
+ *
+ * Queued requests with the specified user data are removed.
+ * If a callback for the user data is currently running, this
+ * function waits for it to return, so the user data can be
+ * freed afterwards.
+ *
+ * NOTE: Don't call this function from the callback function.
+ *
+ * @param userdata User data specified in downloadAsync().
+ */
+void CacheManager::cancelDownloadAsync(void *userdata)
+{
+	asyncState.mutex.lock();
+	for (auto iter = asyncState.queue.begin(); iter != asyncState.queue.end(); ) {
+		if (iter->userdata == userdata) {
+			iter = asyncState.queue.erase(iter);
+		} else {
+			++iter;
+		}
+	}
+	const bool isCurrent = (asyncState.cur_userdata == userdata);
+	if (isCurrent) {
+		asyncState.cur_cancelled = true;
+	}
+	asyncState.mutex.unlock();
+
+	if (isCurrent) {
+		// Wait for the callback to return if it's already running.
+		MutexLocker cbLocker(asyncState.cb_mutex);
+	}
+}
+
+}
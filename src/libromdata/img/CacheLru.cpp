@@ -0,0 +1,441 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CacheLru.cpp: Cache size limit with LRU eviction.                       *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CacheManager.hpp"
+#include "CachePack.hpp"
+
+// librpbase, librpfile, librpthreads
+#include "librpbase/config/Config.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librpfile/FileSystem.hpp"
+using LibRpBase::Config;
+using namespace LibRpFile;
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+// libcachecommon
+#include "libcachecommon/CacheDir.hpp"
+
+// OS-specific includes.
+#ifdef _WIN32
+# include "libwin32common/RpWin32_sdk.h"
+# include "librpbase/TextFuncs_wchar.hpp"
+#else /* !_WIN32 */
+# include <dirent.h>
+# include <sys/stat.h>
+# include <sys/types.h>
+#endif /* _WIN32 */
+
+// C++ includes.
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+using std::pair;
+using std::string;
+using std::unordered_map;
+using std::vector;
+#ifdef _WIN32
+using std::wstring;
+#endif /* _WIN32 */
+
+namespace LibRomData {
+
+// Cache files accessed since the LRU index was last saved.
+// Key: Cache filename
+unordered_map<string, CacheManager::CacheLruEntry> CacheManager::m_lruPending;
+Mutex CacheManager::m_lruMutex;
+
+// LRU index filename, relative to the cache directory.
+// NOTE: The cache cleaners in the configuration UIs
+// must allow this file.
+static const char lru_index_filename[] = "cache-lru.idx";
+
+// Pack filename, relative to the cache directory.
+// The pack file is compacted separately.
+static const char pack_filename[] = "cache.pak";
+
+// Maximum LRU index file size.
+static const off64_t LRU_INDEX_MAX_SIZE = 16*1024*1024;
+
+#ifdef _WIN32
+static const char dir_sep_chr = '\\';
+#else /* !_WIN32 */
+static const char dir_sep_chr = '/';
+#endif /* _WIN32 */
+
+/**
+ * Load the LRU index file.
+ *
+ * Format: One line per cache file, "atime filesize filename",
+ * where filename is relative to the cache directory.
+ * Lines starting with '#' are comments. Invalid lines are ignored.
+ *
+ * @param filename	[in] LRU index filename
+ * @param index		[out] LRU index (Key: relative filename)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int loadLruIndex(const string &filename, unordered_map<string, CacheManager::CacheLruEntry> &index)
+{
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		const int err = file->lastError();
+		file->unref();
+		return (err != 0 ? -err : -EIO);
+	}
+
+	const off64_t fileSize = file->size();
+	if (fileSize <= 0 || fileSize > LRU_INDEX_MAX_SIZE) {
+		// Empty or too big.
+		file->unref();
+		return -EIO;
+	}
+
+	string data;
+	data.resize(static_cast<size_t>(fileSize));
+	const size_t size = file->read(&data[0], data.size());
+	file->unref();
+	if (size != data.size()) {
+		// Short read.
+		return -EIO;
+	}
+
+	size_t pos = 0;
+	while (pos < data.size()) {
+		size_t nl_pos = data.find('\n', pos);
+		if (nl_pos == string::npos) {
+			nl_pos = data.size();
+		}
+		const string line = data.substr(pos, nl_pos - pos);
+		pos = nl_pos + 1;
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		// Parse the access time and the file size.
+		const char *const s_line = line.c_str();
+		char *endptr = nullptr;
+		CacheManager::CacheLruEntry entry;
+		entry.atime = static_cast<time_t>(strtoll(s_line, &endptr, 10));
+		if (*endptr != ' ')
+			continue;
+		const char *const s_filesize = endptr + 1;
+		entry.filesize = strtoll(s_filesize, &endptr, 10);
+		if (*endptr != ' ' || endptr == s_filesize || entry.filesize < 0)
+			continue;
+		const char *const s_filename = endptr + 1;
+		if (*s_filename == '\0')
+			continue;
+
+		index[s_filename] = entry;
+	}
+
+	return 0;
+}
+
+/**
+ * Save the LRU index file.
+ * @param filename	[in] LRU index filename
+ * @param index		[in] LRU index (Key: relative filename)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int saveLruIndex(const string &filename, const unordered_map<string, CacheManager::CacheLruEntry> &index)
+{
+	string data;
+	data.reserve(64 + (index.size() * 48));
+	data += "# rom-properties download cache LRU index\n";
+	data += "# atime filesize filename\n";
+	char buf[48];
+	for (const auto &p : index) {
+		snprintf(buf, sizeof(buf), "%lld %lld ",
+			static_cast<long long>(p.second.atime),
+			static_cast<long long>(p.second.filesize));
+		data += buf;
+		data += p.first;
+		data += '\n';
+	}
+
+	RpFile *const file = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+	if (!file->isOpen()) {
+		const int err = file->lastError();
+		file->unref();
+		return (err != 0 ? -err : -EIO);
+	}
+	const size_t size = file->write(data.data(), data.size());
+	file->unref();
+	return (size == data.size() ? 0 : -EIO);
+}
+
+/**
+ * Recursively scan the cache directory.
+ * Access times are taken from old_index if available;
+ * otherwise, the file's mtime is used.
+ * @param path		[in] Directory to scan
+ * @param prefix_len	[in] Length of the cache directory prefix, including the trailing separator
+ * @param old_index	[in] Previous LRU index
+ * @param index		[out] LRU index
+ */
+static void scanCacheDir(const string &path, size_t prefix_len,
+	const unordered_map<string, CacheManager::CacheLruEntry> &old_index,
+	unordered_map<string, CacheManager::CacheLruEntry> &index)
+{
+	// Add a file to the LRU index.
+	auto addFile = [prefix_len, &old_index, &index](const string &fullpath) {
+		const string rel = fullpath.substr(prefix_len);
+		if (rel == lru_index_filename || rel == pack_filename)
+			return;
+
+		CacheManager::CacheLruEntry entry;
+		time_t mtime = 0;
+		if (FileSystem::get_file_size_and_mtime(fullpath, &entry.filesize, &mtime) != 0)
+			return;
+		auto iter = old_index.find(rel);
+		entry.atime = (iter != old_index.end() ? iter->second.atime : mtime);
+		index[rel] = entry;
+	};
+
+#ifdef _WIN32
+	WIN32_FIND_DATA findFileData;
+	HANDLE hFindFile = FindFirstFile(U82T_s(path + "\\*"), &findFileData);
+	if (!hFindFile || hFindFile == INVALID_HANDLE_VALUE) {
+		// Error finding files.
+		return;
+	}
+
+	do {
+		// Skip "." and "..".
+		if (findFileData.cFileName[0] == _T('.') &&
+		    (findFileData.cFileName[1] == _T('\0') ||
+		     (findFileData.cFileName[1] == _T('.') && findFileData.cFileName[2] == _T('\0'))))
+		{
+			continue;
+		}
+
+		string fullpath(path);
+		fullpath += dir_sep_chr;
+		fullpath += T2U8(findFileData.cFileName);
+
+		if (findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			scanCacheDir(fullpath, prefix_len, old_index, index);
+		} else {
+			addFile(fullpath);
+		}
+	} while (FindNextFile(hFindFile, &findFileData));
+	FindClose(hFindFile);
+#else /* !_WIN32 */
+	DIR *const pdir = opendir(path.c_str());
+	if (!pdir) {
+		// Error opening the directory.
+		return;
+	}
+
+	struct dirent *dirent;
+	while ((dirent = readdir(pdir)) != nullptr) {
+		// Skip "." and "..".
+		if (dirent->d_name[0] == '.' &&
+		    (dirent->d_name[1] == '\0' ||
+		     (dirent->d_name[1] == '.' && dirent->d_name[2] == '\0')))
+		{
+			continue;
+		}
+
+		string fullpath(path);
+		fullpath += dir_sep_chr;
+		fullpath += dirent->d_name;
+
+		uint8_t d_type = dirent->d_type;
+		if (d_type == DT_UNKNOWN) {
+			// Unknown. Use lstat().
+			struct stat sb;
+			if (lstat(fullpath.c_str(), &sb) != 0)
+				continue;
+			if (S_ISREG(sb.st_mode)) {
+				d_type = DT_REG;
+			} else if (S_ISDIR(sb.st_mode)) {
+				d_type = DT_DIR;
+			}
+		}
+
+		switch (d_type) {
+			case DT_REG:
+				addFile(fullpath);
+				break;
+			case DT_DIR:
+				scanCacheDir(fullpath, prefix_len, old_index, index);
+				break;
+			default:
+				// Not a regular file or directory.
+				break;
+		}
+	}
+	closedir(pdir);
+#endif /* _WIN32 */
+}
+
+/**
+ * Record an access to a cache file for LRU eviction.
+ * The LRU index file is updated the next time compactCache() runs.
+ * @param cache_filename Cache filename.
+ */
+void CacheManager::touchLruEntry(const string &cache_filename)
+{
+	off64_t filesize = 0;
+	time_t filemtime = 0;
+	if (getCacheFileInfo(cache_filename, &filesize, &filemtime) != 0) {
+		// Cache file not found.
+		return;
+	}
+
+	MutexLocker locker(m_lruMutex);
+	CacheLruEntry &entry = m_lruPending[cache_filename];
+	entry.atime = time(nullptr);
+	entry.filesize = filesize;
+}
+
+/**
+ * Compact the download cache.
+ *
+ * Least-recently-used cache files are deleted until the cache
+ * is no larger than the maximum size. Access times are tracked
+ * in an LRU index file in the cache directory, so the directory
+ * tree only has to be scanned if the index doesn't exist yet.
+ *
+ * Negative cache entries (0-byte files) are never evicted.
+ *
+ * Images in the pack file count toward the maximum size. If the
+ * cache is still too big after evicting the other cache files,
+ * the oldest images in the pack file are removed.
+ *
+ * @param maxSize Maximum cache size, in bytes. (0 to use MaxCacheSize from the configuration)
+ * @param rescan If true, rescan the cache directory to rebuild the LRU index.
+ * @return Number of files deleted, or negative POSIX error code on error.
+ */
+int CacheManager::compactCache(off64_t maxSize, bool rescan)
+{
+	if (maxSize <= 0) {
+		const Config *const config = Config::instance();
+		maxSize = static_cast<off64_t>(config->maxCacheSize()) * 1024 * 1024;
+	}
+
+	// Packed images count toward the maximum cache size.
+	// NOTE: The pack file is checked even if PackCache is
+	// disabled, since it may still have images in it.
+	CachePack *const pack = getCachePack();
+
+	MutexLocker locker(m_lruMutex);
+	if (maxSize <= 0 && !rescan) {
+		// Cache size is unlimited.
+		// Superseded records are still removed from the pack file.
+		m_lruPending.clear();
+		if (pack) {
+			pack->compact(0);
+		}
+		return 0;
+	}
+
+	const string &cacheDir = LibCacheCommon::getCacheDirectory();
+	if (cacheDir.empty()) {
+		// Cache directory is not accessible.
+		return -ENOENT;
+	}
+	const string index_filename = cacheDir + dir_sep_chr + lru_index_filename;
+	const size_t prefix_len = cacheDir.size() + 1;
+
+	// Load the LRU index.
+	// If it doesn't exist, scan the cache directory instead.
+	unordered_map<string, CacheLruEntry> index;
+	const bool haveIndex = (loadLruIndex(index_filename, index) == 0);
+	if (!haveIndex || rescan) {
+		unordered_map<string, CacheLruEntry> old_index;
+		old_index.swap(index);
+		scanCacheDir(cacheDir, prefix_len, old_index, index);
+	}
+
+	// Merge pending accesses.
+	for (const auto &p : m_lruPending) {
+		const string &filename = p.first;
+		if (filename.size() <= prefix_len ||
+		    filename.compare(0, cacheDir.size(), cacheDir) != 0 ||
+		    filename[cacheDir.size()] != dir_sep_chr)
+		{
+			// Not in the cache directory.
+			continue;
+		}
+
+		CacheLruEntry &entry = index[filename.substr(prefix_len)];
+		entry.atime = std::max(entry.atime, p.second.atime);
+		entry.filesize = p.second.filesize;
+	}
+	m_lruPending.clear();
+
+	// Evict the least-recently-used files if the cache is too big.
+	// Loose files are evicted first, since packed images aren't
+	// tracked in the LRU index.
+	int evicted = 0;
+	const off64_t packSize = (pack ? pack->liveSize() : 0);
+	off64_t totalSize = packSize;
+	for (const auto &p : index) {
+		totalSize += p.second.filesize;
+	}
+	if (maxSize > 0 && totalSize > maxSize) {
+		vector<pair<time_t, const string*> > lru;
+		lru.reserve(index.size());
+		for (const auto &p : index) {
+			if (p.second.filesize > 0) {
+				lru.emplace_back(p.second.atime, &p.first);
+			}
+		}
+		std::sort(lru.begin(), lru.end(),
+			[](const pair<time_t, const string*> &a, const pair<time_t, const string*> &b) {
+				return a.first < b.first;
+			});
+
+		vector<string> removed;
+		for (const auto &p : lru) {
+			if (totalSize <= maxSize)
+				break;
+
+			const string filename = cacheDir + dir_sep_chr + *p.second;
+			const int ret = FileSystem::delete_file(filename);
+			if (ret != 0 && ret != -ENOENT) {
+				// Unable to delete the file.
+				continue;
+			}
+			updateCacheIndex(filename);
+			if (ret == 0) {
+				evicted++;
+			}
+
+			totalSize -= index[*p.second].filesize;
+			removed.push_back(*p.second);
+		}
+		for (const string &rel : removed) {
+			index.erase(rel);
+		}
+	}
+
+	if (pack) {
+		// Compact the pack file. If the cache is still too big,
+		// the oldest packed images are removed.
+		off64_t packMax = 0;
+		if (maxSize > 0) {
+			packMax = std::max(maxSize - (totalSize - packSize), static_cast<off64_t>(1));
+		}
+		const int packEvicted = pack->compact(packMax);
+		if (packEvicted > 0) {
+			evicted += packEvicted;
+		}
+	}
+
+	// Save the LRU index.
+	int ret = saveLruIndex(index_filename, index);
+	return (ret == 0 ? evicted : ret);
+}
+
+}
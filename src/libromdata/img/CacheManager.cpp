@@ -9,17 +9,23 @@
 #include "stdafx.h"
 #include "config.libromdata.h"
 #include "CacheManager.hpp"
+#include "CachePack.hpp"
 
 // librpbase, librpfile, librpthreads
 #include "librpbase/TextFuncs.hpp"
+#include "librpbase/config/Config.hpp"
 #include "librpfile/RpFile.hpp"
 #include "librpfile/FileSystem.hpp"
+#include "librpfile/RpTrace.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
 using LibRpThreads::Semaphore;
 using LibRpThreads::SemaphoreLocker;
 
 // libcachecommon
+#include "libcachecommon/CacheDir.hpp"
 #include "libcachecommon/CacheKeys.hpp"
 
 // OS-specific includes.
@@ -39,19 +45,47 @@ using LibRpThreads::SemaphoreLocker;
 #include <ctime>
 
 // C++ includes.
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 using std::string;
+using std::unique_ptr;
+using std::unordered_map;
+using std::vector;
 #ifdef _WIN32
 using std::wstring;
 #endif /* _WIN32 */
 
 namespace LibRomData {
 
-// Semaphore used to limit the number of simultaneous downloads.
-// TODO: Determine the best number of simultaneous downloads.
+// Semaphore used to limit the number of simultaneous callers.
+// Each caller gets its own rp-download process. The number of
+// simultaneous connections is limited by rp-download itself,
+// using the MaxConnectionsPerHost configuration option.
 // TODO: Test this on XP with IEIFLAG_ASYNC.
 Semaphore CacheManager::m_dlsem(2);
 
+// In-process cache index.
+unordered_map<string, CacheManager::CacheIndexDir> CacheManager::m_index;
+Mutex CacheManager::m_indexMutex;
+bool CacheManager::m_indexEnabled = true;
+
+// Directory mtimes are rechecked at most this often, in seconds.
+// Until then, cache index entries are used without any filesystem access.
+static const time_t CACHE_INDEX_RECHECK_SECS = 5;
+
+// Pack file.
+unique_ptr<CachePack> CacheManager::m_pack;
+Mutex CacheManager::m_packMutex;
+
+CacheManager::CacheManager()
+{
+	const Config *const config = Config::instance();
+	m_offlineOnly = config->offlineOnly();
+	m_packCache = config->packCache();
+}
+
 /** Proxy server functions. **/
 // NOTE: This is only useful for downloaders that
 // can't retrieve the system proxy server normally.
@@ -98,33 +132,133 @@ void CacheManager::setProxyUrl(const string &proxyUrl)
  * will be retrieved. Otherwise, the file will be downloaded.
  *
  * If the file was not found on the server, or it was not found
- * the last time it was requested, an empty string will be
- * returned, and a zero-byte file will be stored in the cache.
+ * the last time it was requested, nullptr will be returned,
+ * and a negative cache entry will be stored in the cache.
  *
- * @return Absolute path to the cached file.
+ * @return Cached file, or nullptr on error. (Caller must unref() it.)
  */
-string CacheManager::download(const string &cache_key)
+IRpFile *CacheManager::download(const string &cache_key)
 {
+	RP_TRACE_SCOPE("CacheManager::download");
+
 	// TODO: Only filter the cache key once.
 	// Currently it's filtered twice:
 	// - getCacheFilename() filters it
 	// - We call filterCacheKey() before passing it to rp-download.
 
 	// Check the main cache key.
-	string cache_filename = LibCacheCommon::getCacheFilename(cache_key);
+	const string cache_filename = LibCacheCommon::getCacheFilename(cache_key);
 	if (cache_filename.empty()) {
 		// Error obtaining the cache key filename.
-		return string();
+		return nullptr;
 	}
 
 	// Lock the semaphore to make sure we don't
 	// download too many files at once.
 	SemaphoreLocker locker(m_dlsem);
 
+	// Check if the file already exists.
+	int ret = checkCacheFile(cache_key, cache_filename);
+	if (ret > 0) {
+		// File was cached successfully.
+		touchLruEntry(cache_filename);
+		return openCacheFile(cache_key, cache_filename);
+	} else if (ret < 0) {
+		// File didn't exist on the server, or an error occurred.
+		return nullptr;
+	}
+
+	if (m_offlineOnly) {
+		// Offline only. Don't run rp-download.
+		return nullptr;
+	}
+
+	// Subdirectories will be created by rp-download to
+	// ensure they keep the "low integrity" label on Win7.
+
+	// Execute rp-download.
+	// NOTE: Using the unfiltered cache key, since filtering it
+	// results in slashes being changed to backslashes on Windows.
+	// rp-download will filter the key itself.
+	ret = execRpDownload(cache_key);
+	updateCacheIndex(cache_filename);
+	if (m_packCache) {
+		// Move the new cache file into the pack file.
+		// This includes negative cache entries.
+		packCacheFile(cache_key, cache_filename);
+	}
+	if (ret != 0) {
+		// rp-download failed for some reason.
+		return nullptr;
+	}
+
+	// rp-download has successfully downloaded the file.
+	// Make sure the cache doesn't exceed the maximum size.
+	touchLruEntry(cache_filename);
+	compactCache();
+	return openCacheFile(cache_key, cache_filename);
+}
+
+/**
+ * Has a negative cache entry expired?
+ * Negative cache entries are valid for a week.
+ * @param mtime Modification time of the negative cache entry.
+ * @return True if the file should be downloaded again.
+ */
+static inline bool isNegativeEntryExpired(time_t mtime)
+{
+	// TODO: Configurable time.
+	const time_t systime = time(nullptr);
+	return ((systime - mtime) >= (86400*7));
+}
+
+/**
+ * Check if a cache file needs to be downloaded.
+ *
+ * A 0-byte cache file is a negative cache entry. If it's
+ * more than a week old, it needs to be downloaded again.
+ *
+ * If the pack file is enabled, it's checked first.
+ *
+ * @param cache_key Cache key.
+ * @param cache_filename Cache filename.
+ * @return 1 if the file is cached; 0 if it needs to be downloaded; negative POSIX error code if it shouldn't be downloaded.
+ */
+int CacheManager::checkCacheFile(const string &cache_key, const string &cache_filename)
+{
+	if (m_packCache) {
+		CachePack *const pack = getCachePack();
+		if (pack) {
+			CachePack::Entry entry;
+			int ret = pack->find(cache_key, &entry);
+			if (ret != 0) {
+				// Not in the pack file. If a cache file was
+				// stored separately, move it into the pack file.
+				if (packCacheFile(cache_key, cache_filename) == 0) {
+					ret = pack->find(cache_key, &entry);
+				}
+			}
+			if (ret == 0) {
+				if (entry.size > 0) {
+					// File was cached successfully.
+					return 1;
+				}
+				// Negative cache entry.
+				// NOTE: If it's expired, the new result will be
+				// appended, which overrides the existing entry.
+				return (isNegativeEntryExpired(entry.mtime) ? 0 : -ENOENT);
+			}
+
+			// Not in the pack file.
+			// Check for a separate cache file in case
+			// it couldn't be moved into the pack file.
+		}
+	}
+
 	// Check if the file already exists.
 	off64_t filesize = 0;
 	time_t filemtime = 0;
-	int ret = FileSystem::get_file_size_and_mtime(cache_filename.c_str(), &filesize, &filemtime);
+	int ret = getCacheFileInfo(cache_filename, &filesize, &filemtime);
 	if (ret == 0) {
 		// Check if the file is 0 bytes.
 		// TODO: How should we handle errors?
@@ -132,71 +266,408 @@ string CacheManager::download(const string &cache_key)
 			// File is 0 bytes, which indicates it didn't exist
 			// on the server. If the file is older than a week,
 			// try to redownload it.
-			// TODO: Configurable time.
-			const time_t systime = time(nullptr);
-			if ((systime - filemtime) < (86400*7)) {
+			if (!isNegativeEntryExpired(filemtime)) {
 				// Less than a week old.
-				return string();
+				return -ENOENT;
 			}
 
-			// More than a week old.
-			// Delete the cache file and try to download it again.
-			if (FileSystem::delete_file(cache_filename) != 0) {
-				// Unable to delete the cache file.
-				return string();
-			}
+			// More than a week old. Try to download it again.
+			// NOTE: The negative cache file isn't deleted here.
+			// rp-download will overwrite it, which refreshes its
+			// timestamp if the file still isn't available.
 		} else if (filesize > 0) {
 			// File is larger than 0 bytes, which indicates
 			// it was cached successfully.
-			return cache_filename;
+			return 1;
 		}
 	} else if (ret != -ENOENT) {
 		// Some error other than "file not found" occurred.
-		return string();
+		return ret;
 	}
 
-	// TODO: Add an option for "offline only".
-	// Previously this was done by checking for a blank URL.
-	// We don't have any offline-only databases right now, so
-	// this has been temporarily removed.
+	// File needs to be downloaded.
+	return 0;
+}
 
-	// Subdirectories will be created by rp-download to
-	// ensure they keep the "low integrity" label on Win7.
+/**
+ * Open a cached file.
+ * If the pack file is enabled, it's checked first.
+ * @param cache_key Cache key.
+ * @param cache_filename Cache filename.
+ * @return Cached file, or nullptr on error. (Caller must unref() it.)
+ */
+IRpFile *CacheManager::openCacheFile(const string &cache_key, const string &cache_filename)
+{
+	if (m_packCache) {
+		CachePack *const pack = getCachePack();
+		CachePack::Entry entry;
+		if (pack && pack->find(cache_key, &entry) == 0) {
+			// Found in the pack file.
+			IRpFile *const file = pack->open(cache_key, entry);
+			if (file) {
+				return file;
+			}
+			// The pack file may have been compacted by another
+			// process. Look up the entry again.
+			if (pack->find(cache_key, &entry) == 0) {
+				return pack->open(cache_key, entry);
+			}
+		}
+	}
+
+	RpFile *const file = new RpFile(cache_filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		// Unable to open the cache file.
+		file->unref();
+		return nullptr;
+	}
+	return file;
+}
+
+/**
+ * Download multiple files.
+ *
+ * This works like download(), but all files that aren't
+ * already cached are submitted to rp-download at once,
+ * which allows them to be downloaded in parallel.
+ *
+ * @param cache_keys Cache keys.
+ * @return Results for each cache key. (0 if cached; negative POSIX error code on error.)
+ */
+vector<int> CacheManager::downloadMultiple(const vector<string> &cache_keys)
+{
+	vector<int> results(cache_keys.size(), -ENOENT);
+
+	// Lock the semaphore to make sure we don't
+	// download too many files at once.
+	SemaphoreLocker locker(m_dlsem);
+
+	// Determine which files need to be downloaded.
+	vector<string> dl_keys;
+	vector<size_t> dl_idx;
+	for (size_t i = 0; i < cache_keys.size(); i++) {
+		const string cache_filename = LibCacheCommon::getCacheFilename(cache_keys[i]);
+		if (cache_filename.empty()) {
+			// Error obtaining the cache key filename.
+			results[i] = -EINVAL;
+			continue;
+		}
+
+		const int ret = checkCacheFile(cache_keys[i], cache_filename);
+		if (ret > 0) {
+			// File was cached successfully.
+			touchLruEntry(cache_filename);
+			results[i] = 0;
+		} else if (ret == 0 && !m_offlineOnly) {
+			// File needs to be downloaded.
+			// NOTE: Using the unfiltered cache key. (See download().)
+			dl_keys.push_back(cache_keys[i]);
+			dl_idx.push_back(i);
+		} else if (ret < 0) {
+			results[i] = ret;
+		}
+	}
+	if (dl_keys.empty()) {
+		// Nothing to download.
+		return results;
+	}
 
 	// Execute rp-download.
-	// NOTE: Using the unfiltered cache key, since filtering it
-	// results in slashes being changed to backslashes on Windows.
-	// rp-download will filter the key itself.
-	ret = execRpDownload(cache_key);
-	if (ret != 0) {
-		// rp-download failed for some reason.
-		return string();
+	vector<int> dl_results;
+	const int ret = execRpDownloadMultiple(dl_keys, dl_results);
+	for (size_t i = 0; i < dl_keys.size(); i++) {
+		const string cache_filename = LibCacheCommon::getCacheFilename(dl_keys[i]);
+		updateCacheIndex(cache_filename);
+		if (m_packCache) {
+			// Move the new cache file into the pack file.
+			packCacheFile(dl_keys[i], cache_filename);
+		}
+		if (ret != 0) {
+			results[dl_idx[i]] = ret;
+		} else {
+			results[dl_idx[i]] = dl_results[i];
+			if (dl_results[i] == 0) {
+				// rp-download has successfully downloaded the file.
+				touchLruEntry(cache_filename);
+			}
+		}
 	}
 
-	// rp-download has successfully downloaded the file.
-	return cache_filename;
+	// Make sure the cache doesn't exceed the maximum size.
+	compactCache();
+
+	return results;
 }
 
 /**
  * Check if a file has already been cached.
  * @param cache_key Cache key.
- * @return Filename in the cache, or empty string if not found.
+ * @return Cached file, or nullptr if not found. (Caller must unref() it.)
  */
-string CacheManager::findInCache(const string &cache_key)
+IRpFile *CacheManager::findInCache(const string &cache_key)
 {
 	// Get the cache key filename.
-	string cache_filename = LibCacheCommon::getCacheFilename(cache_key);
+	const string cache_filename = LibCacheCommon::getCacheFilename(cache_key);
 	if (cache_filename.empty()) {
 		// Error obtaining the cache key filename.
+		return nullptr;
+	}
+
+	// Open the file if it's cached.
+	// NOTE: Negative cache entries are not returned.
+	if (checkCacheFile(cache_key, cache_filename) <= 0) {
+		// Cache file not found.
+		return nullptr;
+	}
+	return openCacheFile(cache_key, cache_filename);
+}
+
+/** Pack file functions. **/
+
+/**
+ * Get the pack file.
+ * @return Pack file, or nullptr if the cache directory couldn't be determined.
+ */
+CachePack *CacheManager::getCachePack(void)
+{
+	MutexLocker locker(m_packMutex);
+	if (!m_pack) {
+		const string &cacheDir = LibCacheCommon::getCacheDirectory();
+		if (cacheDir.empty()) {
+			// Unable to get the cache directory.
+			return nullptr;
+		}
+
+		// NOTE: The cache cleaners in the configuration UIs
+		// must allow this file.
+#ifdef _WIN32
+		m_pack.reset(new CachePack(cacheDir + "\\cache.pak"));
+#else /* !_WIN32 */
+		m_pack.reset(new CachePack(cacheDir + "/cache.pak"));
+#endif /* _WIN32 */
+	}
+	return m_pack.get();
+}
+
+/**
+ * Move a cache file into the pack file.
+ * The cache file is deleted once it's been added to the pack file.
+ * @param cache_key Cache key.
+ * @param cache_filename Cache filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheManager::packCacheFile(const string &cache_key, const string &cache_filename)
+{
+	CachePack *const pack = getCachePack();
+	if (!pack) {
+		return -ENOENT;
+	}
+
+	off64_t filesize = 0;
+	time_t filemtime = 0;
+	int ret = getCacheFileInfo(cache_filename, &filesize, &filemtime);
+	if (ret != 0) {
+		// Cache file not found.
+		return ret;
+	} else if (filesize > 64*1024*1024) {
+		// Too big to store in the pack file.
+		return -EFBIG;
+	}
+
+	uint32_t size = static_cast<uint32_t>(filesize);
+	unique_ptr<uint8_t[]> data;
+	if (size > 0) {
+		unique_RefBase<RpFile> file(new RpFile(cache_filename, RpFile::FM_OPEN_READ));
+		if (!file->isOpen()) {
+			ret = -file->lastError();
+			return (ret != 0 ? ret : -EIO);
+		}
+		data.reset(new uint8_t[size]);
+		if (file->read(data.get(), size) != size) {
+			// Short read.
+			return -EIO;
+		}
+	}
+
+	ret = pack->append(cache_key, data.get(), size, filemtime);
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Remove the original cache file.
+	FileSystem::delete_file(cache_filename);
+	updateCacheIndex(cache_filename);
+	return 0;
+}
+
+/** Cache index functions. **/
+
+/**
+ * Enable or disable the in-process cache index.
+ * This affects all CacheManager instances.
+ * The cache index is enabled by default.
+ * @param enable True to enable; false to disable.
+ */
+void CacheManager::setIndexEnabled(bool enable)
+{
+	MutexLocker locker(m_indexMutex);
+	m_indexEnabled = enable;
+	if (!enable) {
+		// Clear the index so stale entries
+		// aren't used if it's enabled again.
+		m_index.clear();
+	}
+}
+
+/**
+ * Is the in-process cache index enabled?
+ * @return True if enabled; false if not.
+ */
+bool CacheManager::isIndexEnabled(void)
+{
+	MutexLocker locker(m_indexMutex);
+	return m_indexEnabled;
+}
+
+/**
+ * Get the directory portion of a cache filename.
+ * @param cache_filename Cache filename.
+ * @return Directory name, or empty string if there is no directory separator.
+ */
+static inline string getCacheDirName(const string &cache_filename)
+{
+#ifdef _WIN32
+	const size_t slash_pos = cache_filename.find_last_of("\\/");
+#else /* !_WIN32 */
+	const size_t slash_pos = cache_filename.rfind('/');
+#endif /* _WIN32 */
+	if (slash_pos == string::npos) {
 		return string();
 	}
+	return cache_filename.substr(0, slash_pos);
+}
+
+/**
+ * Get a cache file's size and modification time.
+ * If the cache index is enabled, the index will be used.
+ * @param cache_filename	[in] Cache filename.
+ * @param pFileSize		[out] File size.
+ * @param pMtime		[out] Modification time.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheManager::getCacheFileInfo(const string &cache_filename, off64_t *pFileSize, time_t *pMtime)
+{
+	MutexLocker locker(m_indexMutex);
+	if (!m_indexEnabled) {
+		// Cache index is disabled.
+		return FileSystem::get_file_size_and_mtime(cache_filename, pFileSize, pMtime);
+	}
+
+	const string dirname = getCacheDirName(cache_filename);
+	if (dirname.empty()) {
+		// No directory. Don't use the index.
+		return FileSystem::get_file_size_and_mtime(cache_filename, pFileSize, pMtime);
+	}
+
+	// Check if the directory was modified since it was last validated.
+	// The directory mtime changes if files are added or removed,
+	// e.g. by another process.
+	const time_t now = time(nullptr);
+	auto dir_iter = m_index.find(dirname);
+	if (dir_iter == m_index.end() || (now - dir_iter->second.last_check) >= CACHE_INDEX_RECHECK_SECS) {
+		time_t dir_mtime = 0;
+		if (FileSystem::get_mtime(dirname, &dir_mtime) != 0) {
+			// Unable to get the directory mtime.
+			// The directory might not exist yet.
+			if (dir_iter != m_index.end()) {
+				m_index.erase(dir_iter);
+			}
+			return FileSystem::get_file_size_and_mtime(cache_filename, pFileSize, pMtime);
+		}
+
+		if (dir_iter == m_index.end()) {
+			// Directory isn't indexed yet.
+			dir_iter = m_index.emplace(dirname, CacheIndexDir()).first;
+		} else if (dir_iter->second.dir_mtime != dir_mtime) {
+			// Directory was modified. Invalidate its entries.
+			dir_iter->second.files.clear();
+		}
+		dir_iter->second.dir_mtime = dir_mtime;
+		dir_iter->second.last_check = now;
+	}
+
+	auto &files = dir_iter->second.files;
+	auto file_iter = files.find(cache_filename);
+	if (file_iter == files.end()) {
+		// Not in the index yet.
+		CacheIndexFile entry;
+		int ret = FileSystem::get_file_size_and_mtime(cache_filename, &entry.filesize, &entry.filemtime);
+		if (ret == -ENOENT) {
+			// File doesn't exist.
+			entry.filesize = -1;
+			entry.filemtime = 0;
+		} else if (ret != 0) {
+			// Some other error occurred. Don't index this file.
+			return ret;
+		}
+		file_iter = files.emplace(cache_filename, entry).first;
+	}
+
+	if (file_iter->second.filesize < 0) {
+		// File doesn't exist.
+		return -ENOENT;
+	}
+	*pFileSize = file_iter->second.filesize;
+	*pMtime = file_iter->second.filemtime;
+	return 0;
+}
+
+/**
+ * Update a cache file in the cache index.
+ * This should be called after a cache file is created or deleted.
+ * @param cache_filename Cache filename.
+ */
+void CacheManager::updateCacheIndex(const string &cache_filename)
+{
+	MutexLocker locker(m_indexMutex);
+	if (!m_indexEnabled) {
+		// Cache index is disabled.
+		return;
+	}
+
+	const string dirname = getCacheDirName(cache_filename);
+	auto dir_iter = m_index.find(dirname);
+	if (dir_iter == m_index.end()) {
+		// Directory isn't indexed.
+		// It will be indexed on the next lookup.
+		return;
+	}
+
+	// Re-read the directory mtime, since we just modified it.
+	// NOTE: If another process modified the directory at the
+	// same time, we won't notice it. That's fine for a cache.
+	time_t dir_mtime = 0;
+	if (FileSystem::get_mtime(dirname, &dir_mtime) != 0) {
+		// Unable to get the directory mtime.
+		m_index.erase(dir_iter);
+		return;
+	}
+	dir_iter->second.dir_mtime = dir_mtime;
+	dir_iter->second.last_check = time(nullptr);
 
-	// Return the filename if the file exists.
-	if (FileSystem::access(cache_filename, R_OK) != 0) {
-		// Unable to read the cache file.
-		cache_filename.clear();
+	// Update the file entry.
+	CacheIndexFile entry;
+	int ret = FileSystem::get_file_size_and_mtime(cache_filename, &entry.filesize, &entry.filemtime);
+	if (ret == -ENOENT) {
+		// File doesn't exist.
+		entry.filesize = -1;
+		entry.filemtime = 0;
+	} else if (ret != 0) {
+		// Some other error occurred. Remove the file from the index.
+		dir_iter->second.files.erase(cache_filename);
+		return;
 	}
-	return cache_filename;
+	dir_iter->second.files[cache_filename] = entry;
 }
 
 }
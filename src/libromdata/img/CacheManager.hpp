@@ -12,17 +12,30 @@
 #include "common.h"
 
 // librpthreads
+#include "librpthreads/Mutex.hpp"
 #include "librpthreads/Semaphore.hpp"
 
+// C includes. (C++ namespace)
+#include <ctime>
+
 // C++ includes.
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace LibRpFile {
+	class IRpFile;
+}
 
 namespace LibRomData {
 
+class CachePack;
+
 class CacheManager
 {
 	public:
-		CacheManager() { }
+		CacheManager();
 		~CacheManager() { }
 
 	private:
@@ -51,6 +64,29 @@ class CacheManager
 		 */
 		void setProxyUrl(const std::string &proxyUrl);
 
+	public:
+		/**
+		 * Is offline-only mode enabled?
+		 * If enabled, download() will only return files that
+		 * are already in the cache, and rp-download won't be run.
+		 * The default value is taken from the OfflineOnly
+		 * configuration option.
+		 * @return True if offline-only mode is enabled.
+		 */
+		bool isOfflineOnly(void) const
+		{
+			return m_offlineOnly;
+		}
+
+		/**
+		 * Enable or disable offline-only mode.
+		 * @param offlineOnly True to enable offline-only mode.
+		 */
+		void setOfflineOnly(bool offlineOnly)
+		{
+			m_offlineOnly = offlineOnly;
+		}
+
 	public:
 		/**
 		 * Download a file.
@@ -63,21 +99,226 @@ class CacheManager
 		 * will be retrieved. Otherwise, the file will be downloaded.
 		 *
 		 * If the file was not found on the server, or it was not found
-		 * the last time it was requested, an empty string will be
-		 * returned, and a zero-byte file will be stored in the cache.
+		 * the last time it was requested, nullptr will be returned,
+		 * and a negative cache entry will be stored in the cache.
 		 *
-		 * @return Absolute path to the cached file.
+		 * @return Cached file, or nullptr on error. (Caller must unref() it.)
 		 */
-		std::string download(const std::string &cache_key);
+		LibRpFile::IRpFile *download(const std::string &cache_key);
+
+		/**
+		 * Download multiple files.
+		 *
+		 * This works like download(), but all files that aren't
+		 * already cached are submitted to rp-download at once,
+		 * which allows them to be downloaded in parallel.
+		 *
+		 * @param cache_keys Cache keys.
+		 * @return Results for each cache key. (0 if cached; negative POSIX error code on error.)
+		 */
+		std::vector<int> downloadMultiple(const std::vector<std::string> &cache_keys);
 
 		/**
 		 * Check if a file has already been cached.
 		 * @param cache_key Cache key.
-		 * @return Filename in the cache, or empty string if not found.
+		 * @return Cached file, or nullptr if not found. (Caller must unref() it.)
+		 */
+		LibRpFile::IRpFile *findInCache(const std::string &cache_key);
+
+	public:
+		/**
+		 * Is the pack file enabled?
+		 * If enabled, downloaded files are stored in a single pack
+		 * file in the cache directory instead of one file per image.
+		 * The default value is taken from the PackCache
+		 * configuration option.
+		 * @return True if the pack file is enabled.
+		 */
+		bool isPackCacheEnabled(void) const
+		{
+			return m_packCache;
+		}
+
+		/**
+		 * Enable or disable the pack file.
+		 * @param packCache True to enable the pack file.
+		 */
+		void setPackCacheEnabled(bool packCache)
+		{
+			m_packCache = packCache;
+		}
+
+	public:
+		/** Asynchronous download functions. **/
+
+		/**
+		 * Asynchronous download callback.
+		 *
+		 * NOTE: This is called from the download thread,
+		 * not the thread that called downloadAsync().
+		 *
+		 * @param cache_key	[in] Cache key.
+		 * @param file		[in] Cached file, or nullptr on error. (Call ref() to keep it.)
+		 * @param userdata	[in] User data specified in downloadAsync().
+		 */
+		typedef void (*pfnDownloadAsyncCallback_t)(const std::string &cache_key,
+			LibRpFile::IRpFile *file, void *userdata);
+
+		/**
+		 * Download a file asynchronously.
+		 *
+		 * This works like download(), but it returns immediately.
+		 * Requests are queued and handled in order by a download
+		 * thread, which calls the callback function when each
+		 * request is finished.
+		 *
+		 * The current proxy server and offline-only mode settings
+		 * are used for the request.
+		 *
+		 * @param cache_key	[in] Cache key.
+		 * @param callback	[in] Callback function.
+		 * @param userdata	[in] User data for the callback function.
+		 * @return 0 if the request was queued; negative POSIX error code on error.
+		 */
+		int downloadAsync(const std::string &cache_key,
+			pfnDownloadAsyncCallback_t callback, void *userdata);
+
+		/**
+		 * Cancel asynchronous downloads.
+		 *
+		 * Queued requests with the specified user data are removed.
+		 * If a callback for the user data is currently running, this
+		 * function waits for it to return, so the user data can be
+		 * freed afterwards.
+		 *
+		 * NOTE: Don't call this function from the callback function.
+		 *
+		 * @param userdata User data specified in downloadAsync().
+		 */
+		static void cancelDownloadAsync(void *userdata);
+
+	public:
+		/** Cache index functions. **/
+		// The cache index is an in-process index of cache files
+		// that were previously looked up, which avoids repeated
+		// filesystem accesses for the same cache keys.
+
+		/**
+		 * Enable or disable the in-process cache index.
+		 * This affects all CacheManager instances.
+		 * The cache index is enabled by default.
+		 * @param enable True to enable; false to disable.
+		 */
+		static void setIndexEnabled(bool enable);
+
+		/**
+		 * Is the in-process cache index enabled?
+		 * @return True if enabled; false if not.
+		 */
+		static bool isIndexEnabled(void);
+
+	public:
+		/** Cache size limit functions. **/
+
+		// LRU index entry.
+		struct CacheLruEntry {
+			time_t atime;		// Last access time
+			off64_t filesize;	// File size
+
+			CacheLruEntry()
+				: atime(0)
+				, filesize(0)
+			{ }
+		};
+
+		/**
+		 * Compact the download cache.
+		 *
+		 * Least-recently-used cache files are deleted until the cache
+		 * is no larger than the maximum size. Access times are tracked
+		 * in an LRU index file in the cache directory, so the directory
+		 * tree only has to be scanned if the index doesn't exist yet.
+		 *
+		 * Negative cache entries (0-byte files) are never evicted.
+		 *
+		 * Images in the pack file count toward the maximum size. If the
+		 * cache is still too big after evicting the other cache files,
+		 * the oldest images in the pack file are removed.
+		 *
+		 * @param maxSize Maximum cache size, in bytes. (0 to use MaxCacheSize from the configuration)
+		 * @param rescan If true, rescan the cache directory to rebuild the LRU index.
+		 * @return Number of files deleted, or negative POSIX error code on error.
+		 */
+		static int compactCache(off64_t maxSize = 0, bool rescan = false);
+
+	protected:
+		/**
+		 * Record an access to a cache file for LRU eviction.
+		 * The LRU index file is updated the next time compactCache() runs.
+		 * @param cache_filename Cache filename.
+		 */
+		static void touchLruEntry(const std::string &cache_filename);
+
+	protected:
+		/**
+		 * Get a cache file's size and modification time.
+		 * If the cache index is enabled, the index will be used.
+		 * @param cache_filename	[in] Cache filename.
+		 * @param pFileSize		[out] File size.
+		 * @param pMtime		[out] Modification time.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int getCacheFileInfo(const std::string &cache_filename, off64_t *pFileSize, time_t *pMtime);
+
+		/**
+		 * Update a cache file in the cache index.
+		 * This should be called after a cache file is created or deleted.
+		 * @param cache_filename Cache filename.
+		 */
+		static void updateCacheIndex(const std::string &cache_filename);
+
+	protected:
+		/**
+		 * Check if a cache file needs to be downloaded.
+		 *
+		 * A 0-byte cache file is a negative cache entry. If it's
+		 * more than a week old, it needs to be downloaded again.
+		 *
+		 * If the pack file is enabled, it's checked first.
+		 *
+		 * @param cache_key Cache key.
+		 * @param cache_filename Cache filename.
+		 * @return 1 if the file is cached; 0 if it needs to be downloaded; negative POSIX error code if it shouldn't be downloaded.
 		 */
-		std::string findInCache(const std::string &cache_key);
+		int checkCacheFile(const std::string &cache_key, const std::string &cache_filename);
+
+		/**
+		 * Open a cached file.
+		 * If the pack file is enabled, it's checked first.
+		 * @param cache_key Cache key.
+		 * @param cache_filename Cache filename.
+		 * @return Cached file, or nullptr on error. (Caller must unref() it.)
+		 */
+		LibRpFile::IRpFile *openCacheFile(const std::string &cache_key, const std::string &cache_filename);
 
 	protected:
+		/** Pack file functions. **/
+
+		/**
+		 * Get the pack file.
+		 * @return Pack file, or nullptr if the cache directory couldn't be determined.
+		 */
+		static CachePack *getCachePack(void);
+
+		/**
+		 * Move a cache file into the pack file.
+		 * The cache file is deleted once it's been added to the pack file.
+		 * @param cache_key Cache key.
+		 * @param cache_filename Cache filename.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int packCacheFile(const std::string &cache_key, const std::string &cache_filename);
+
 		/**
 		 * Execute rp-download.
 		 * @param filtered_cache_key Filtered cache key.
@@ -85,11 +326,43 @@ class CacheManager
 		 */
 		int execRpDownload(const std::string &filtered_cache_key);
 
+		/**
+		 * Execute rp-download for multiple cache keys.
+		 * @param cache_keys	[in] Cache keys.
+		 * @param results	[out] Results for each cache key. (0 on success; negative POSIX error code on error.)
+		 * @return 0 if rp-download was executed; negative POSIX error code on error.
+		 */
+		int execRpDownloadMultiple(const std::vector<std::string> &cache_keys, std::vector<int> &results);
+
 	protected:
 		std::string m_proxyUrl;
+		bool m_offlineOnly;
+		bool m_packCache;
 
-		// Semaphore used to limit the number of simultaneous downloads.
+		// Semaphore used to limit the number of simultaneous callers.
 		static LibRpThreads::Semaphore m_dlsem;
+
+		// In-process cache index.
+		struct CacheIndexFile {
+			off64_t filesize;	// File size (-1 if the file doesn't exist)
+			time_t filemtime;	// Modification time
+		};
+		struct CacheIndexDir {
+			time_t dir_mtime;	// Directory mtime when the index was validated
+			time_t last_check;	// Time when dir_mtime was last checked
+			std::unordered_map<std::string, CacheIndexFile> files;	// Key: cache filename
+		};
+		static std::unordered_map<std::string, CacheIndexDir> m_index;	// Key: directory name
+		static LibRpThreads::Mutex m_indexMutex;
+		static bool m_indexEnabled;
+
+		// Cache files accessed since the LRU index was last saved.
+		static std::unordered_map<std::string, CacheLruEntry> m_lruPending;	// Key: cache filename
+		static LibRpThreads::Mutex m_lruMutex;
+
+		// Pack file.
+		static std::unique_ptr<CachePack> m_pack;
+		static LibRpThreads::Mutex m_packMutex;
 };
 
 }
@@ -0,0 +1,910 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CachePack.cpp: Pack file storage for the download cache.                *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CachePack.hpp"
+
+// librpcpu, librpfile, librpthreads
+#include "librpcpu/byteswap_rp.h"
+#include "librpfile/RpFile.hpp"
+#include "librpfile/SubFile.hpp"
+using namespace LibRpFile;
+using LibRpThreads::MutexLocker;
+
+// OS-specific includes.
+#ifdef _WIN32
+# include "libwin32common/RpWin32_sdk.h"
+# include "libwin32common/w32err.h"
+# include "librpbase/TextFuncs_wchar.hpp"
+#else /* !_WIN32 */
+// getpid(), rename()
+# include <fcntl.h>
+# include <sys/file.h>
+# include <sys/stat.h>
+# include <sys/types.h>
+# include <unistd.h>
+#endif /* _WIN32 */
+
+// C++ includes.
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+using std::pair;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData {
+
+/**
+ * Pack file record header.
+ * All fields are in little-endian.
+ *
+ * The header is followed by the cache key (key_len bytes, not
+ * NULL-terminated), which is followed by the data (data_len bytes).
+ */
+#define CACHEPACK_RECORD_MAGIC 'RPCK'
+typedef struct _CachePack_RecordHeader {
+	uint32_t magic;		// [0x000] 'RPCK' (big-endian)
+	uint16_t key_len;	// [0x004] Cache key length
+	uint16_t reserved1;	// [0x006]
+	uint32_t data_len;	// [0x008] Data length (0 for negative entries)
+	uint32_t reserved2;	// [0x00C]
+	int64_t mtime;		// [0x010] Modification time (UNIX timestamp)
+} CachePack_RecordHeader;
+ASSERT_STRUCT(CachePack_RecordHeader, 24);
+
+// The pack file is rescanned for new records
+// at most this often, in seconds.
+static const time_t CACHEPACK_RECHECK_SECS = 5;
+
+// The pack file isn't rewritten to remove superseded
+// records unless there's at least this much to remove.
+static const off64_t CACHEPACK_MIN_DEAD_SIZE = 1024*1024;
+
+namespace {
+
+/**
+ * Exclusive lock on the pack file.
+ * The lock is released when this object is destroyed.
+ */
+class PackFileLock
+{
+	public:
+		explicit PackFileLock(const string &filename)
+			: m_filename(filename)
+#ifdef _WIN32
+			, hFile(INVALID_HANDLE_VALUE)
+#else /* !_WIN32 */
+			, fd(-1)
+#endif /* _WIN32 */
+		{ }
+
+		~PackFileLock()
+		{
+			unlock();
+		}
+
+	private:
+		RP_DISABLE_COPY(PackFileLock)
+
+	public:
+		/**
+		 * Open and lock the pack file.
+		 * The pack file is created if it doesn't exist.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int lock(void);
+
+		/**
+		 * Unlock and close the pack file.
+		 */
+		void unlock(void);
+
+		/**
+		 * Truncate the pack file.
+		 * @param size New size.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int truncate(off64_t size);
+
+		/**
+		 * Write data to the pack file.
+		 * @param offset Offset.
+		 * @param data Data.
+		 * @param size Data size.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int writeAt(off64_t offset, const void *data, size_t size);
+
+	private:
+		const string &m_filename;
+#ifdef _WIN32
+		HANDLE hFile;
+		OVERLAPPED ov;
+#else /* !_WIN32 */
+		int fd;
+#endif /* _WIN32 */
+};
+
+/**
+ * Open and lock the pack file.
+ * The pack file is created if it doesn't exist.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int PackFileLock::lock(void)
+{
+	unlock();
+
+#ifdef _WIN32
+	// NOTE: The pack file can't be replaced while it's open
+	// on Windows, so it doesn't need to be checked here.
+	hFile = CreateFile(U82T_s(m_filename),
+		GENERIC_READ | GENERIC_WRITE,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (!hFile || hFile == INVALID_HANDLE_VALUE) {
+		hFile = INVALID_HANDLE_VALUE;
+		return -w32err_to_posix(GetLastError());
+	}
+
+	// NOTE: Windows file locks are mandatory, so lock a byte
+	// that's far past the end of the file. Otherwise, other
+	// processes wouldn't be able to read the pack file.
+	memset(&ov, 0, sizeof(ov));
+	ov.Offset = 0;
+	ov.OffsetHigh = 0x7FFFFFFF;
+	if (!LockFileEx(hFile, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &ov)) {
+		const int err = -w32err_to_posix(GetLastError());
+		CloseHandle(hFile);
+		hFile = INVALID_HANDLE_VALUE;
+		return err;
+	}
+	return 0;
+#else /* !_WIN32 */
+	for (;;) {
+		fd = ::open(m_filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (fd < 0) {
+			return -errno;
+		}
+		if (flock(fd, LOCK_EX) != 0) {
+			const int err = -errno;
+			::close(fd);
+			fd = -1;
+			return err;
+		}
+
+		// If another process compacted the pack file while we were
+		// waiting for the lock, we locked the old pack file.
+		struct stat sb_fd, sb_path;
+		if (fstat(fd, &sb_fd) != 0) {
+			const int err = -errno;
+			unlock();
+			return err;
+		}
+		if (stat(m_filename.c_str(), &sb_path) == 0 &&
+		    sb_fd.st_dev == sb_path.st_dev && sb_fd.st_ino == sb_path.st_ino)
+		{
+			// Locked the current pack file.
+			return 0;
+		}
+
+		// Pack file was replaced. Try again.
+		unlock();
+	}
+#endif /* _WIN32 */
+}
+
+/**
+ * Unlock and close the pack file.
+ */
+void PackFileLock::unlock(void)
+{
+#ifdef _WIN32
+	if (hFile != INVALID_HANDLE_VALUE) {
+		UnlockFileEx(hFile, 0, 1, 0, &ov);
+		CloseHandle(hFile);
+		hFile = INVALID_HANDLE_VALUE;
+	}
+#else /* !_WIN32 */
+	if (fd >= 0) {
+		flock(fd, LOCK_UN);
+		::close(fd);
+		fd = -1;
+	}
+#endif /* _WIN32 */
+}
+
+/**
+ * Truncate the pack file.
+ * @param size New size.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int PackFileLock::truncate(off64_t size)
+{
+#ifdef _WIN32
+	LARGE_INTEGER liOffset;
+	liOffset.QuadPart = size;
+	if (!SetFilePointerEx(hFile, liOffset, nullptr, FILE_BEGIN) ||
+	    !SetEndOfFile(hFile))
+	{
+		return -w32err_to_posix(GetLastError());
+	}
+#else /* !_WIN32 */
+	if (ftruncate(fd, size) != 0) {
+		return -errno;
+	}
+#endif /* _WIN32 */
+	return 0;
+}
+
+/**
+ * Write data to the pack file.
+ * @param offset Offset.
+ * @param data Data.
+ * @param size Data size.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int PackFileLock::writeAt(off64_t offset, const void *data, size_t size)
+{
+#ifdef _WIN32
+	LARGE_INTEGER liOffset;
+	liOffset.QuadPart = offset;
+	DWORD dwBytesWritten = 0;
+	if (!SetFilePointerEx(hFile, liOffset, nullptr, FILE_BEGIN) ||
+	    !WriteFile(hFile, data, static_cast<DWORD>(size), &dwBytesWritten, nullptr))
+	{
+		return -w32err_to_posix(GetLastError());
+	} else if (dwBytesWritten != size) {
+		return -ENOSPC;
+	}
+#else /* !_WIN32 */
+	const ssize_t sz = pwrite(fd, data, size, offset);
+	if (sz < 0) {
+		return -errno;
+	} else if (static_cast<size_t>(sz) != size) {
+		return -ENOSPC;
+	}
+#endif /* _WIN32 */
+	return 0;
+}
+
+/**
+ * Read and validate a record header.
+ * @param file		[in] Pack file.
+ * @param offset	[in] Record offset.
+ * @param fileSize	[in] Pack file size.
+ * @param pHdr		[out] Record header. (byteswapped to host-endian)
+ * @return True if the record is valid and complete; false if not.
+ */
+static bool readRecordHeader(IRpFile *file, off64_t offset, off64_t fileSize, CachePack_RecordHeader *pHdr)
+{
+	if (offset + static_cast<off64_t>(sizeof(*pHdr)) > fileSize)
+		return false;
+
+	size_t size = file->readAt(offset, pHdr, sizeof(*pHdr));
+	if (size != sizeof(*pHdr) ||
+	    pHdr->magic != cpu_to_be32(CACHEPACK_RECORD_MAGIC) ||
+	    pHdr->key_len == 0)
+	{
+		// Invalid record.
+		return false;
+	}
+
+	pHdr->key_len = le16_to_cpu(pHdr->key_len);
+	pHdr->data_len = le32_to_cpu(pHdr->data_len);
+	pHdr->mtime = le64_to_cpu(pHdr->mtime);
+
+	// Make sure the record is complete.
+	return (offset + static_cast<off64_t>(sizeof(*pHdr)) + pHdr->key_len + pHdr->data_len <= fileSize);
+}
+
+/**
+ * Find the next record magic number.
+ * @param file		[in] Pack file.
+ * @param offset	[in] Starting offset.
+ * @param fileSize	[in] Pack file size.
+ * @return Offset of the next record magic number, or -1 if not found.
+ */
+static off64_t findRecordMagic(IRpFile *file, off64_t offset, off64_t fileSize)
+{
+	static const uint8_t magic[4] = {'R','P','C','K'};
+	uint8_t buf[65536];
+	while (offset + static_cast<off64_t>(sizeof(magic)) <= fileSize) {
+		const size_t size = file->readAt(offset, buf, sizeof(buf));
+		if (size < sizeof(magic))
+			break;
+
+		const uint8_t *const pEnd = buf + size - (sizeof(magic) - 1);
+		for (const uint8_t *p = buf; p < pEnd; p++) {
+			p = static_cast<const uint8_t*>(memchr(p, magic[0], pEnd - p));
+			if (!p)
+				break;
+			if (!memcmp(p, magic, sizeof(magic))) {
+				return offset + (p - buf);
+			}
+		}
+
+		// Overlap the next read in case the magic number
+		// straddles the buffer boundary.
+		offset += size - (sizeof(magic) - 1);
+	}
+	return -1;
+}
+
+/**
+ * Initialize a record header.
+ * @param pHdr		[out] Record header.
+ * @param key_len	[in] Cache key length.
+ * @param data_len	[in] Data length. (0 for negative entries)
+ * @param mtime		[in] Modification time.
+ */
+static void initRecordHeader(CachePack_RecordHeader *pHdr, size_t key_len, uint32_t data_len, time_t mtime)
+{
+	pHdr->magic = cpu_to_be32(CACHEPACK_RECORD_MAGIC);
+	pHdr->key_len = cpu_to_le16(static_cast<uint16_t>(key_len));
+	pHdr->reserved1 = 0;
+	pHdr->data_len = cpu_to_le32(data_len);
+	pHdr->reserved2 = 0;
+	pHdr->mtime = cpu_to_le64(static_cast<int64_t>(mtime));
+}
+
+/**
+ * Does the pack file need to be compacted?
+ * @param end		[in] End of the last valid record.
+ * @param liveSize	[in] Total size of the current records.
+ * @param maxSize	[in] Maximum size of the current records. (0 for no limit)
+ * @return True if the pack file needs to be compacted.
+ */
+static inline bool needsCompaction(off64_t end, off64_t liveSize, off64_t maxSize)
+{
+	if (maxSize > 0 && liveSize > maxSize) {
+		// Too big.
+		return true;
+	}
+
+	// Check for superseded records.
+	const off64_t deadSize = end - liveSize;
+	return (deadSize >= CACHEPACK_MIN_DEAD_SIZE && deadSize > end / 2);
+}
+
+}
+
+/**
+ * Open a cache pack file.
+ * The file isn't accessed until it's needed.
+ * @param filename Pack filename.
+ */
+CachePack::CachePack(const string &filename)
+	: m_filename(filename)
+	, m_scanned(0)
+	, m_liveSize(0)
+	, m_last_check(0)
+{
+	memset(&m_packId, 0, sizeof(m_packId));
+}
+
+/**
+ * Add a record to the pack index.
+ * m_mutex must be locked by the caller.
+ * @param cache_key	[in] Cache key.
+ * @param offset	[in] Data offset.
+ * @param size		[in] Data size. (0 for negative entries)
+ * @param mtime		[in] Modification time.
+ */
+void CachePack::addEntry(const string &cache_key, off64_t offset, uint32_t size, time_t mtime)
+{
+	const off64_t rec_overhead = static_cast<off64_t>(sizeof(CachePack_RecordHeader) + cache_key.size());
+	auto res = m_entries.emplace(cache_key, Entry());
+	Entry &entry = res.first->second;
+	if (!res.second) {
+		// Superseding an existing record.
+		m_liveSize -= (rec_overhead + entry.size);
+	}
+	entry.offset = offset;
+	entry.size = size;
+	entry.mtime = mtime;
+	m_liveSize += (rec_overhead + size);
+}
+
+/**
+ * Discard the pack index.
+ * The pack file will be rescanned on the next lookup.
+ * m_mutex must be locked by the caller.
+ */
+void CachePack::resetIndex(void)
+{
+	m_entries.clear();
+	m_scanned = 0;
+	m_liveSize = 0;
+	m_last_check = 0;
+	memset(&m_packId, 0, sizeof(m_packId));
+}
+
+/**
+ * Scan records that were appended since the last scan.
+ *
+ * If the caller holds the pack file lock, no records can be in
+ * the process of being written, so invalid records are skipped
+ * instead of ending the scan.
+ *
+ * m_mutex must be locked by the caller.
+ * @param file		[in] Pack file.
+ * @param locked	[in] True if the caller holds the pack file lock.
+ * @param pSkipped	[out,opt] Set to true if invalid records were skipped.
+ * @return End of the last valid record.
+ */
+off64_t CachePack::scan(IRpFile *file, bool locked, bool *pSkipped)
+{
+	// If the pack file was replaced, e.g. by compact() in
+	// another process, the index is no longer valid.
+	FileSystem::FileIdentity id;
+	if (FileSystem::get_file_identity(m_filename, &id) == 0 &&
+	    (id.device != m_packId.device || id.inode != m_packId.inode))
+	{
+		resetIndex();
+		m_packId = id;
+	}
+
+	const off64_t fileSize = file->size();
+	if (fileSize < m_scanned) {
+		// The pack file was truncated.
+		resetIndex();
+		m_packId = id;
+	}
+
+	string cache_key;
+	off64_t offset = m_scanned;
+	while (offset + static_cast<off64_t>(sizeof(CachePack_RecordHeader)) <= fileSize) {
+		CachePack_RecordHeader hdr;
+		bool valid = readRecordHeader(file, offset, fileSize, &hdr);
+		if (valid) {
+			cache_key.resize(hdr.key_len);
+			const size_t size = file->readAt(offset + sizeof(hdr), &cache_key[0], hdr.key_len);
+			valid = (size == hdr.key_len);
+		}
+
+		if (!valid) {
+			if (!locked) {
+				// Invalid or incomplete record. It might still
+				// be in the process of being written.
+				break;
+			}
+
+			// Invalid record. Since we're holding the lock, it isn't
+			// being written, so skip to the next record header.
+			offset = findRecordMagic(file, offset + 1, fileSize);
+			if (offset < 0) {
+				// No more records.
+				break;
+			}
+			if (pSkipped) {
+				*pSkipped = true;
+			}
+			continue;
+		}
+
+		const off64_t data_offset = offset + sizeof(hdr) + hdr.key_len;
+		addEntry(cache_key, data_offset, hdr.data_len, static_cast<time_t>(hdr.mtime));
+		offset = data_offset + hdr.data_len;
+		m_scanned = offset;
+	}
+
+	return m_scanned;
+}
+
+/**
+ * Find a cache key in the pack file.
+ * @param cache_key	[in] Cache key.
+ * @param pEntry	[out] Pack index entry.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CachePack::find(const string &cache_key, Entry *pEntry)
+{
+	MutexLocker locker(m_mutex);
+	auto iter = m_entries.find(cache_key);
+	if (iter == m_entries.end()) {
+		// Not in the index. Check if any records were
+		// appended by another process.
+		const time_t now = time(nullptr);
+		if ((now - m_last_check) < CACHEPACK_RECHECK_SECS) {
+			// Checked recently.
+			return -ENOENT;
+		}
+		m_last_check = now;
+
+		unique_RefBase<RpFile> file(new RpFile(m_filename, RpFile::FM_OPEN_READ));
+		if (!file->isOpen()) {
+			// Pack file doesn't exist yet.
+			return -ENOENT;
+		}
+		scan(file.get());
+
+		iter = m_entries.find(cache_key);
+		if (iter == m_entries.end()) {
+			// Not found.
+			return -ENOENT;
+		}
+	}
+
+	*pEntry = iter->second;
+	return 0;
+}
+
+/**
+ * Open a pack file entry.
+ *
+ * The returned file is a read-only view of the entry's data,
+ * backed by a memory-mapped view of the pack file.
+ *
+ * The record is verified first, since the pack file may have
+ * been compacted by another process. If it doesn't match, the
+ * index is discarded, and nullptr is returned.
+ *
+ * @param cache_key	[in] Cache key.
+ * @param entry		[in] Pack index entry.
+ * @return IRpFile, or nullptr on error. (Caller must unref() it.)
+ */
+IRpFile *CachePack::open(const string &cache_key, const Entry &entry)
+{
+	if (entry.size == 0) {
+		// Negative entry.
+		return nullptr;
+	}
+
+	// NOTE: Each view gets its own RpFile, since SubFile::read()
+	// uses the underlying file's position.
+	RpFile *const file = new RpFile(m_filename, RpFile::FM_OPEN_READ_MMAP);
+	const off64_t fileSize = file->size();
+	if (!file->isOpen() || fileSize < entry.offset + entry.size) {
+		// Unable to open the pack file, or it was truncated.
+		file->unref();
+		return nullptr;
+	}
+
+	// Verify the record header and cache key.
+	const off64_t rec_offset = entry.offset - static_cast<off64_t>(sizeof(CachePack_RecordHeader) + cache_key.size());
+	CachePack_RecordHeader hdr;
+	bool ok = (rec_offset >= 0 && readRecordHeader(file, rec_offset, fileSize, &hdr) &&
+		hdr.key_len == cache_key.size() && hdr.data_len == entry.size);
+	if (ok) {
+		string rec_key;
+		rec_key.resize(hdr.key_len);
+		const size_t size = file->readAt(rec_offset + sizeof(hdr), &rec_key[0], hdr.key_len);
+		ok = (size == hdr.key_len && rec_key == cache_key);
+	}
+	if (!ok) {
+		// The pack file was replaced.
+		file->unref();
+		MutexLocker locker(m_mutex);
+		resetIndex();
+		return nullptr;
+	}
+
+	SubFile *const subFile = new SubFile(file, entry.offset, entry.size);
+	file->unref();
+	return subFile;
+}
+
+/**
+ * Append an entry to the pack file.
+ * @param cache_key	[in] Cache key.
+ * @param data		[in] Data. (nullptr for negative entries)
+ * @param size		[in] Data size. (0 for negative entries)
+ * @param mtime		[in] Modification time.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CachePack::append(const string &cache_key, const void *data, uint32_t size, time_t mtime)
+{
+	assert(!cache_key.empty());
+	assert(cache_key.size() <= 0xFFFF);
+	assert(data != nullptr || size == 0);
+	if (cache_key.empty() || cache_key.size() > 0xFFFF ||
+	    (!data && size != 0))
+	{
+		return -EINVAL;
+	}
+
+	// Build the record in memory so it can be written all at once.
+	CachePack_RecordHeader hdr;
+	initRecordHeader(&hdr, cache_key.size(), size, mtime);
+
+	const size_t rec_size = sizeof(hdr) + cache_key.size() + size;
+	unique_ptr<uint8_t[]> rec(new uint8_t[rec_size]);
+	memcpy(rec.get(), &hdr, sizeof(hdr));
+	memcpy(&rec[sizeof(hdr)], cache_key.data(), cache_key.size());
+	if (size > 0) {
+		memcpy(&rec[sizeof(hdr) + cache_key.size()], data, size);
+	}
+
+	MutexLocker locker(m_mutex);
+	PackFileLock lock(m_filename);
+	int ret = lock.lock();
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Scan any records that were appended by other processes.
+	off64_t offset = 0, fileSize = 0;
+	bool skipped = false;
+	{
+		unique_RefBase<RpFile> file(new RpFile(m_filename, RpFile::FM_OPEN_READ));
+		if (!file->isOpen()) {
+			ret = -file->lastError();
+			return (ret != 0 ? ret : -EIO);
+		}
+		offset = scan(file.get(), true, &skipped);
+		fileSize = file->size();
+		if (skipped) {
+			// Invalid records were skipped. Readers stop scanning
+			// at the first invalid record, so rewrite the pack file
+			// without them.
+			ret = rewrite(file.get(), 0);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+	}
+	if (skipped) {
+		// Lock the new pack file.
+		ret = lock.lock();
+		if (ret != 0) {
+			return ret;
+		}
+		unique_RefBase<RpFile> file(new RpFile(m_filename, RpFile::FM_OPEN_READ));
+		if (!file->isOpen()) {
+			ret = -file->lastError();
+			return (ret != 0 ? ret : -EIO);
+		}
+		offset = scan(file.get(), true);
+		fileSize = file->size();
+	}
+
+	if (fileSize > offset) {
+		// Anything after the last valid record is an incomplete
+		// record left behind by a process that crashed while
+		// appending it, since we're holding the lock.
+		ret = lock.truncate(offset);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	// Write the record.
+	ret = lock.writeAt(offset, rec.get(), rec_size);
+	if (ret == 0) {
+		// Add the record to the index.
+		addEntry(cache_key, offset + sizeof(hdr) + cache_key.size(), size, mtime);
+		m_scanned = offset + rec_size;
+	}
+	return ret;
+}
+
+/**
+ * Get the total size of the current records in the pack file.
+ * Superseded records aren't included.
+ * @return Total size of the current records, in bytes.
+ */
+off64_t CachePack::liveSize(void)
+{
+	MutexLocker locker(m_mutex);
+	unique_RefBase<RpFile> file(new RpFile(m_filename, RpFile::FM_OPEN_READ));
+	if (!file->isOpen()) {
+		// Pack file doesn't exist.
+		resetIndex();
+		return 0;
+	}
+	scan(file.get());
+	return m_liveSize;
+}
+
+/**
+ * Compact the pack file.
+ *
+ * The pack file is rewritten if more than half of it consists of
+ * superseded records, or if the current records are larger than
+ * maxSize. In the latter case, the oldest entries are removed until
+ * the pack file is no larger than 3/4 of maxSize, so it doesn't have
+ * to be rewritten again after the next append.
+ *
+ * Negative cache entries are never removed.
+ *
+ * @param maxSize Maximum size of the current records, in bytes. (0 for no limit)
+ * @return Number of entries removed, or negative POSIX error code on error.
+ */
+int CachePack::compact(off64_t maxSize)
+{
+	MutexLocker locker(m_mutex);
+
+	// Check if the pack file needs to be compacted before locking it.
+	{
+		unique_RefBase<RpFile> file(new RpFile(m_filename, RpFile::FM_OPEN_READ));
+		if (!file->isOpen()) {
+			// Pack file doesn't exist.
+			return 0;
+		}
+		const off64_t end = scan(file.get());
+		if (!needsCompaction(end, m_liveSize, maxSize)) {
+			// Nothing to do.
+			return 0;
+		}
+	}
+
+	PackFileLock lock(m_filename);
+	int ret = lock.lock();
+	if (ret != 0) {
+		return ret;
+	}
+
+	// Check again, since another process may have
+	// compacted the pack file in the meantime.
+	unique_RefBase<RpFile> file(new RpFile(m_filename, RpFile::FM_OPEN_READ));
+	if (!file->isOpen()) {
+		ret = -file->lastError();
+		return (ret != 0 ? ret : -EIO);
+	}
+	bool skipped = false;
+	const off64_t end = scan(file.get(), true, &skipped);
+	if (!skipped && !needsCompaction(end, m_liveSize, maxSize)) {
+		// Nothing to do.
+		return 0;
+	}
+	return rewrite(file.get(), maxSize);
+}
+
+/**
+ * Rewrite the pack file without superseded records.
+ * The pack file must have been scanned with the lock held.
+ * m_mutex and the pack file lock must be held by the caller.
+ * @param file		[in] Pack file.
+ * @param maxSize	[in] Maximum size of the current records, in bytes. (0 for no limit)
+ * @return Number of entries removed, or negative POSIX error code on error.
+ */
+int CachePack::rewrite(IRpFile *file, off64_t maxSize)
+{
+	// Current records.
+	struct Record {
+		const string *cache_key;
+		const Entry *entry;
+		bool keep;
+	};
+	vector<Record> recs;
+	recs.reserve(m_entries.size());
+	for (const auto &p : m_entries) {
+		Record rec = {&p.first, &p.second, true};
+		recs.push_back(rec);
+	}
+
+	int removed = 0;
+	if (maxSize > 0 && m_liveSize > maxSize) {
+		// Remove the oldest entries until the pack file
+		// is no larger than 3/4 of the maximum size.
+		// Negative entries are small, so they're kept.
+		const off64_t target = maxSize / 4 * 3;
+		off64_t liveSize = m_liveSize;
+
+		vector<Record*> byAge;
+		byAge.reserve(recs.size());
+		for (Record &rec : recs) {
+			if (rec.entry->size > 0) {
+				byAge.push_back(&rec);
+			}
+		}
+		std::sort(byAge.begin(), byAge.end(), [](const Record *a, const Record *b) {
+			return (a->entry->mtime != b->entry->mtime
+				? a->entry->mtime < b->entry->mtime
+				: a->entry->offset < b->entry->offset);
+		});
+		for (Record *rec : byAge) {
+			if (liveSize <= target)
+				break;
+			rec->keep = false;
+			liveSize -= static_cast<off64_t>(sizeof(CachePack_RecordHeader) + rec->cache_key->size() + rec->entry->size);
+			removed++;
+		}
+	}
+
+	// Keep the records in their original order.
+	std::sort(recs.begin(), recs.end(), [](const Record &a, const Record &b) {
+		return (a.entry->offset < b.entry->offset);
+	});
+
+	// Write to a temporary file, then rename it over the pack file.
+	// Existing views of the old pack file remain valid, and other
+	// processes will notice that the pack file was replaced.
+	char pid_buf[24];
+#ifdef _WIN32
+	snprintf(pid_buf, sizeof(pid_buf), ".%lu.tmp", static_cast<unsigned long>(GetCurrentProcessId()));
+#else /* !_WIN32 */
+	snprintf(pid_buf, sizeof(pid_buf), ".%ld.tmp", static_cast<long>(getpid()));
+#endif /* _WIN32 */
+	const string tmp_filename = m_filename + pid_buf;
+
+	RpFile *const tmpFile = new RpFile(tmp_filename, RpFile::FM_CREATE_WRITE);
+	if (!tmpFile->isOpen()) {
+		int ret = -tmpFile->lastError();
+		tmpFile->unref();
+		return (ret != 0 ? ret : -EIO);
+	}
+
+	std::unordered_map<string, Entry> new_entries;
+	off64_t offset = 0;
+	vector<uint8_t> buf;
+	int ret = 0;
+	for (const Record &rec : recs) {
+		if (!rec.keep)
+			continue;
+
+		const string &cache_key = *rec.cache_key;
+		const Entry &entry = *rec.entry;
+		const size_t rec_size = sizeof(CachePack_RecordHeader) + cache_key.size() + entry.size;
+		buf.resize(rec_size);
+
+		CachePack_RecordHeader hdr;
+		initRecordHeader(&hdr, cache_key.size(), entry.size, entry.mtime);
+		memcpy(buf.data(), &hdr, sizeof(hdr));
+		memcpy(&buf[sizeof(hdr)], cache_key.data(), cache_key.size());
+		if (entry.size > 0) {
+			const size_t size = file->readAt(entry.offset, &buf[sizeof(hdr) + cache_key.size()], entry.size);
+			if (size != entry.size) {
+				// Read error.
+				ret = -EIO;
+				break;
+			}
+		}
+		if (tmpFile->write(buf.data(), rec_size) != rec_size) {
+			// Write error.
+			ret = -tmpFile->lastError();
+			if (ret == 0) {
+				ret = -EIO;
+			}
+			break;
+		}
+
+		Entry &new_entry = new_entries[cache_key];
+		new_entry.offset = offset + sizeof(hdr) + cache_key.size();
+		new_entry.size = entry.size;
+		new_entry.mtime = entry.mtime;
+		offset += rec_size;
+	}
+	tmpFile->unref();
+
+	if (ret == 0) {
+		// NOTE: On Windows, this will fail if another
+		// process has the pack file open.
+#ifdef _WIN32
+		if (!MoveFileEx(U82T_s(tmp_filename), U82T_s(m_filename), MOVEFILE_REPLACE_EXISTING)) {
+			ret = -w32err_to_posix(GetLastError());
+		}
+#else /* !_WIN32 */
+		if (rename(tmp_filename.c_str(), m_filename.c_str()) != 0) {
+			ret = -errno;
+			if (ret == 0) {
+				ret = -EIO;
+			}
+		}
+#endif /* _WIN32 */
+	}
+	if (ret != 0) {
+		// Write or rename failed. Remove the temporary file.
+		FileSystem::delete_file(tmp_filename);
+		return ret;
+	}
+
+	// Update the index for the new pack file.
+	m_entries.swap(new_entries);
+	m_scanned = offset;
+	m_liveSize = offset;
+	if (FileSystem::get_file_identity(m_filename, &m_packId) != 0) {
+		memset(&m_packId, 0, sizeof(m_packId));
+	}
+	return removed;
+}
+
+}
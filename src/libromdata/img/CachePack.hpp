@@ -0,0 +1,192 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * CachePack.hpp: Pack file storage for the download cache.                *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_IMG_CACHEPACK_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_IMG_CACHEPACK_HPP__
+
+#include "common.h"
+
+// librpfile, librpthreads
+#include "librpfile/FileSystem.hpp"
+#include "librpfile/IRpFile.hpp"
+#include "librpthreads/Mutex.hpp"
+
+// C includes. (C++ namespace)
+#include <ctime>
+
+// C++ includes.
+#include <string>
+#include <unordered_map>
+
+namespace LibRomData {
+
+/**
+ * Append-only pack file for the download cache.
+ *
+ * Each record consists of a header, the cache key, and the file data.
+ * A record with no data is a negative cache entry. If a cache key is
+ * stored more than once, the last record takes precedence.
+ *
+ * Records are appended while holding an exclusive lock on the pack
+ * file, so multiple processes can share it. Readers don't lock the
+ * file; an incomplete record at the end of the file is ignored until
+ * it has been fully written.
+ *
+ * compact() rewrites the pack file without superseded records, and
+ * it can also remove the oldest entries to limit the pack file size.
+ * The new pack file is written to a temporary file, which is then
+ * renamed over the pack file, so existing views remain valid.
+ */
+class CachePack
+{
+	public:
+		/**
+		 * Open a cache pack file.
+		 * The file isn't accessed until it's needed.
+		 * @param filename Pack filename.
+		 */
+		explicit CachePack(const std::string &filename);
+
+	private:
+		RP_DISABLE_COPY(CachePack)
+
+	public:
+		// Pack index entry.
+		struct Entry {
+			off64_t offset;		// Data offset
+			uint32_t size;		// Data size (0 for negative entries)
+			time_t mtime;		// Modification time
+		};
+
+		/**
+		 * Get the pack filename.
+		 * @return Pack filename.
+		 */
+		const std::string &filename(void) const
+		{
+			return m_filename;
+		}
+
+		/**
+		 * Find a cache key in the pack file.
+		 * @param cache_key	[in] Cache key.
+		 * @param pEntry	[out] Pack index entry.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int find(const std::string &cache_key, Entry *pEntry);
+
+		/**
+		 * Open a pack file entry.
+		 *
+		 * The returned file is a read-only view of the entry's data,
+		 * backed by a memory-mapped view of the pack file.
+		 *
+		 * The record is verified first, since the pack file may have
+		 * been compacted by another process. If it doesn't match, the
+		 * index is discarded, and nullptr is returned.
+		 *
+		 * @param cache_key	[in] Cache key.
+		 * @param entry		[in] Pack index entry.
+		 * @return IRpFile, or nullptr on error. (Caller must unref() it.)
+		 */
+		LibRpFile::IRpFile *open(const std::string &cache_key, const Entry &entry);
+
+		/**
+		 * Append an entry to the pack file.
+		 * @param cache_key	[in] Cache key.
+		 * @param data		[in] Data. (nullptr for negative entries)
+		 * @param size		[in] Data size. (0 for negative entries)
+		 * @param mtime		[in] Modification time.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int append(const std::string &cache_key, const void *data, uint32_t size, time_t mtime);
+
+		/**
+		 * Get the total size of the current records in the pack file.
+		 * Superseded records aren't included.
+		 * @return Total size of the current records, in bytes.
+		 */
+		off64_t liveSize(void);
+
+		/**
+		 * Compact the pack file.
+		 *
+		 * The pack file is rewritten if more than half of it consists of
+		 * superseded records, or if the current records are larger than
+		 * maxSize. In the latter case, the oldest entries are removed until
+		 * the pack file is no larger than 3/4 of maxSize, so it doesn't have
+		 * to be rewritten again after the next append.
+		 *
+		 * Negative cache entries are never removed.
+		 *
+		 * @param maxSize Maximum size of the current records, in bytes. (0 for no limit)
+		 * @return Number of entries removed, or negative POSIX error code on error.
+		 */
+		int compact(off64_t maxSize);
+
+	protected:
+		/**
+		 * Scan records that were appended since the last scan.
+		 *
+		 * If the caller holds the pack file lock, no records can be in
+		 * the process of being written, so invalid records are skipped
+		 * instead of ending the scan.
+		 *
+		 * m_mutex must be locked by the caller.
+		 * @param file		[in] Pack file.
+		 * @param locked	[in] True if the caller holds the pack file lock.
+		 * @param pSkipped	[out,opt] Set to true if invalid records were skipped.
+		 * @return End of the last valid record.
+		 */
+		off64_t scan(LibRpFile::IRpFile *file, bool locked = false, bool *pSkipped = nullptr);
+
+		/**
+		 * Add a record to the pack index.
+		 * m_mutex must be locked by the caller.
+		 * @param cache_key	[in] Cache key.
+		 * @param offset	[in] Data offset.
+		 * @param size		[in] Data size. (0 for negative entries)
+		 * @param mtime		[in] Modification time.
+		 */
+		void addEntry(const std::string &cache_key, off64_t offset, uint32_t size, time_t mtime);
+
+		/**
+		 * Discard the pack index.
+		 * The pack file will be rescanned on the next lookup.
+		 * m_mutex must be locked by the caller.
+		 */
+		void resetIndex(void);
+
+		/**
+		 * Rewrite the pack file without superseded records.
+		 * The pack file must have been scanned with the lock held.
+		 * m_mutex and the pack file lock must be held by the caller.
+		 * @param file		[in] Pack file.
+		 * @param maxSize	[in] Maximum size of the current records, in bytes. (0 for no limit)
+		 * @return Number of entries removed, or negative POSIX error code on error.
+		 */
+		int rewrite(LibRpFile::IRpFile *file, off64_t maxSize);
+
+	protected:
+		std::string m_filename;
+		LibRpThreads::Mutex m_mutex;
+
+		// Pack index.
+		std::unordered_map<std::string, Entry> m_entries;	// Key: cache key
+		off64_t m_scanned;	// End of the last record that was scanned
+		off64_t m_liveSize;	// Total size of the records in m_entries
+		time_t m_last_check;	// Time when the pack file was last scanned
+
+		// Identity of the pack file that was scanned.
+		// If the pack file is replaced, the index is discarded.
+		LibRpFile::FileSystem::FileIdentity m_packId;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_IMG_CACHEPACK_HPP__ */
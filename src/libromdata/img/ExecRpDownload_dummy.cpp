@@ -11,7 +11,9 @@
 
 // C++ includes.
 #include <string>
+#include <vector>
 using std::string;
+using std::vector;
 
 namespace LibRomData {
 
@@ -26,4 +28,17 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	return -ENOSYS;
 }
 
+/**
+ * Execute rp-download for multiple cache keys. (Dummy version)
+ * @param cache_keys	[in] Cache keys.
+ * @param results	[out] Results for each cache key. (0 on success; negative POSIX error code on error.)
+ * @return 0 if rp-download was executed; negative POSIX error code on error.
+ */
+int CacheManager::execRpDownloadMultiple(const vector<string> &cache_keys, vector<int> &results)
+{
+#warning CacheManager::execRpDownloadMultiple() is not implemented!
+	results.assign(cache_keys.size(), -ENOSYS);
+	return -ENOSYS;
+}
+
 }
@@ -10,8 +10,20 @@
 #include "config.libromdata.h"
 #include "CacheManager.hpp"
 
+// librpbase
+#include "librpbase/config/Config.hpp"
+using LibRpBase::Config;
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
 // OS-specific includes.
+#include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -19,12 +31,240 @@
 # include <spawn.h>
 #endif /* HAVE_POSIX_SPAWN */
 
+#ifndef MSG_NOSIGNAL
+// Mac OS X doesn't have MSG_NOSIGNAL.
+// SO_NOSIGPIPE is set on the socket instead.
+# define MSG_NOSIGNAL 0
+#endif /* !MSG_NOSIGNAL */
+
 // C++ includes.
+#include <array>
 #include <string>
+#include <unordered_map>
+#include <vector>
+using std::array;
 using std::string;
+using std::unordered_map;
+using std::vector;
 
 namespace LibRomData {
 
+/**
+ * Persistent rp-download worker process.
+ *
+ * rp-download is started in batch mode (-b), which reads cache keys
+ * from stdin and writes results to stdout. Keeping the process around
+ * lets it reuse its network connections for multiple downloads.
+ *
+ * There's one worker per simultaneous caller. (See m_dlsem.)
+ * Each worker can download multiple files in parallel.
+ */
+struct RpDownloadWorker {
+	pid_t pid;	// Process ID (0 if not running)
+	int fd;		// Socket connected to the worker's stdin/stdout
+	string env;	// Environment used to start the worker
+	string rbuf;	// Partially-received result line
+	unsigned int maxConnectionsPerHost;	// -c parameter used to start the worker
+	bool busy;	// Worker is handling a download
+
+	RpDownloadWorker()
+		: pid(0)
+		, fd(-1)
+		, maxConnectionsPerHost(0)
+		, busy(false)
+	{ }
+};
+static array<RpDownloadWorker, 2> rpdl_workers;
+static Mutex rpdl_workers_mutex;
+
+/**
+ * Stop an rp-download worker process.
+ * @param worker Worker
+ */
+static void stopWorker(RpDownloadWorker &worker)
+{
+	if (worker.fd >= 0) {
+		// Closing the socket will cause the worker to exit.
+		close(worker.fd);
+		worker.fd = -1;
+	}
+	if (worker.pid > 0) {
+		// Terminate the worker if it's still running, then reap it.
+		if (waitpid(worker.pid, nullptr, WNOHANG) == 0) {
+			kill(worker.pid, SIGTERM);
+			waitpid(worker.pid, nullptr, 0);
+		}
+		worker.pid = 0;
+	}
+	worker.env.clear();
+	worker.rbuf.clear();
+}
+
+/**
+ * Start an rp-download worker process.
+ * @param worker	[in,out] Worker
+ * @param argv		[in] Arguments
+ * @param envp		[in] Environment
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int startWorker(RpDownloadWorker &worker, const char *const *argv, const char *const *envp)
+{
+	// Create a socket pair for the worker's stdin/stdout.
+	// NOTE: Using a socket instead of pipes so we can use
+	// MSG_NOSIGNAL if the worker exits unexpectedly.
+	int sv[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+		int err = errno;
+		return (err != 0 ? -err : -EIO);
+	}
+	// Don't let other child processes inherit the sockets.
+	fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+	fcntl(sv[1], F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+	int one = 1;
+	setsockopt(sv[0], SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif /* SO_NOSIGPIPE */
+
+#ifdef HAVE_POSIX_SPAWN
+	// posix_spawn()
+	// NOTE: dup2() clears FD_CLOEXEC on the new descriptors.
+	posix_spawn_file_actions_t file_actions;
+	posix_spawn_file_actions_init(&file_actions);
+	posix_spawn_file_actions_adddup2(&file_actions, sv[1], STDIN_FILENO);
+	posix_spawn_file_actions_adddup2(&file_actions, sv[1], STDOUT_FILENO);
+
+	errno = 0;
+	pid_t pid;
+	int ret = posix_spawn(&pid, argv[0],
+		&file_actions,
+		nullptr,	// attrp
+		(char *const *)argv, (char *const *)envp);
+	posix_spawn_file_actions_destroy(&file_actions);
+	if (ret != 0) {
+		// Error creating the child process.
+		// NOTE: posix_spawn() returns the error code.
+		close(sv[0]);
+		close(sv[1]);
+		return -ret;
+	}
+#else /* !HAVE_POSIX_SPAWN */
+	// fork()/execve().
+	errno = 0;
+	pid_t pid = fork();
+	if (pid == 0) {
+		// Child process.
+		// NOTE: dup2() clears FD_CLOEXEC on the new descriptors.
+		if (dup2(sv[1], STDIN_FILENO) < 0 || dup2(sv[1], STDOUT_FILENO) < 0) {
+			_exit(EXIT_FAILURE);
+		}
+		execve(argv[0], (char *const *)argv, (char *const *)envp);
+		// execve() failed.
+		_exit(EXIT_FAILURE);
+	} else if (pid == -1) {
+		// fork() failed.
+		int err = errno;
+		close(sv[0]);
+		close(sv[1]);
+		return (err != 0 ? -err : -EIO);
+	}
+#endif /* HAVE_POSIX_SPAWN */
+
+	// Parent process.
+	close(sv[1]);
+	worker.pid = pid;
+	worker.fd = sv[0];
+	return 0;
+}
+
+/**
+ * Send cache keys to an rp-download worker process.
+ * @param worker Worker
+ * @param cache_keys Cache keys
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int sendCacheKeys(RpDownloadWorker &worker, const vector<string> &cache_keys)
+{
+	// Send all of the cache keys at once so rp-download
+	// can download them in parallel.
+	string lines;
+	for (const string &cache_key : cache_keys) {
+		lines += cache_key;
+		lines += '\n';
+	}
+
+	const char *p = lines.data();
+	size_t remain = lines.size();
+	while (remain > 0) {
+		ssize_t sz = send(worker.fd, p, remain, MSG_NOSIGNAL);
+		if (sz < 0) {
+			if (errno == EINTR)
+				continue;
+			int err = errno;
+			return (err != 0 ? -err : -EIO);
+		}
+		p += sz;
+		remain -= sz;
+	}
+	return 0;
+}
+
+/**
+ * Receive a result line from an rp-download worker process.
+ *
+ * Result lines are "0 cache_key\n" on success and "1 cache_key\n"
+ * on failure. Results may be received in a different order than
+ * the cache keys were sent.
+ *
+ * @param worker	[in] Worker
+ * @param cache_key	[out] Cache key
+ * @param timeout_ms	[in] Timeout, in milliseconds
+ * @return 0 if the download succeeded; -EIO if it failed; other negative POSIX error code on error.
+ */
+static int recvResult(RpDownloadWorker &worker, string &cache_key, int timeout_ms)
+{
+	size_t nl_pos;
+	while ((nl_pos = worker.rbuf.find('\n')) == string::npos) {
+		struct pollfd pfd;
+		pfd.fd = worker.fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		int ret = poll(&pfd, 1, timeout_ms);
+		if (ret == 0) {
+			// Timed out.
+			// TODO: Reduce the timeout for each poll() call?
+			return -ETIMEDOUT;
+		} else if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			int err = errno;
+			return (err != 0 ? -err : -EIO);
+		}
+
+		char buf[1024];
+		ssize_t sz = recv(worker.fd, buf, sizeof(buf), 0);
+		if (sz == 0) {
+			// Worker exited.
+			return -EPIPE;
+		} else if (sz < 0) {
+			if (errno == EINTR)
+				continue;
+			int err = errno;
+			return (err != 0 ? -err : -EIO);
+		}
+		worker.rbuf.append(buf, sz);
+	}
+
+	const string line = worker.rbuf.substr(0, nl_pos);
+	worker.rbuf.erase(0, nl_pos + 1);
+	if (line.size() < 3 || (line[0] != '0' && line[0] != '1') || line[1] != ' ') {
+		// Invalid result.
+		return -EPROTO;
+	}
+
+	cache_key = line.substr(2);
+	return (line[0] == '0' ? 0 : -EIO);
+}
+
 /**
  * Execute rp-download. (POSIX version)
  * @param filteredCacheKey Filtered cache key.
@@ -32,13 +272,53 @@ namespace LibRomData {
  */
 int CacheManager::execRpDownload(const string &filteredCacheKey)
 {
+	const vector<string> cache_keys(1, filteredCacheKey);
+	vector<int> results;
+	int ret = execRpDownloadMultiple(cache_keys, results);
+	return (ret != 0 ? ret : results[0]);
+}
+
+/**
+ * Execute rp-download for multiple cache keys. (POSIX version)
+ * @param cache_keys	[in] Cache keys.
+ * @param results	[out] Results for each cache key. (0 on success; negative POSIX error code on error.)
+ * @return 0 if rp-download was executed; negative POSIX error code on error.
+ */
+int CacheManager::execRpDownloadMultiple(const vector<string> &cache_keys, vector<int> &results)
+{
+	results.assign(cache_keys.size(), -EIO);
+	if (cache_keys.empty()) {
+		// Nothing to do.
+		return 0;
+	}
+
+	// Pending cache keys. Value is the list of indexes in cache_keys.
+	unordered_map<string, vector<size_t> > pending;
+	for (size_t i = 0; i < cache_keys.size(); i++) {
+		const string &cache_key = cache_keys[i];
+		if (cache_key.empty() || cache_key.find('\n') != string::npos) {
+			// Invalid cache key.
+			return -EINVAL;
+		}
+		pending[cache_key].push_back(i);
+	}
+
 	// TODO: Mac OS X path. (bundle?)
  	static const char rp_download_exe[] = DIR_INSTALL_LIBEXEC "/rp-download";
 
+	// Maximum number of connections per host.
+	const Config *const config = Config::instance();
+	const unsigned int maxConnectionsPerHost = config->maxConnectionsPerHost();
+	char s_maxConnectionsPerHost[16];
+	snprintf(s_maxConnectionsPerHost, sizeof(s_maxConnectionsPerHost), "%u", maxConnectionsPerHost);
+
 	// Parameters.
-	const char *const argv[3] = {
+	// NOTE: rp-download is run in batch mode, and cache keys
+	// are sent over its stdin.
+	const char *const argv[5] = {
 		rp_download_exe,
-		filteredCacheKey.c_str(),
+		"-c", s_maxConnectionsPerHost,
+		"-b",
 		nullptr
 	};
 
@@ -101,95 +381,99 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 		}
 	}
 
-	// TODO: Maybe we should close file handles...
-#ifdef HAVE_POSIX_SPAWN
-	// posix_spawn()
-	errno = 0;
-	pid_t pid;
-	int ret = posix_spawn(&pid, rp_download_exe,
-		nullptr,	// file_actions
-		nullptr,	// attrp
-		(char *const *)argv, (char *const *)envp);
-	if (ret != 0) {
-		// Error creating the child process.
-		int err = errno;
-		if (err == 0) {
-			err = EIO;
+	// Get a free worker.
+	// NOTE: m_dlsem limits the number of simultaneous callers,
+	// so there should always be a free worker.
+	RpDownloadWorker *worker = nullptr;
+	{
+		MutexLocker locker(rpdl_workers_mutex);
+		for (RpDownloadWorker &w : rpdl_workers) {
+			if (!w.busy) {
+				worker = &w;
+				worker->busy = true;
+				break;
+			}
 		}
-		return -err;
 	}
-#else /* !HAVE_POSIX_SPAWN */
-	// fork()/execve().
-	errno = 0;
-	pid_t pid = fork();
-	if (pid == 0) {
-		// Child process.
-		int ret = execve(rp_download_exe, (char *const *)argv, (char *const *)envp);
-		if (ret != 0) {
-			// execve() failed.
-			exit(EXIT_FAILURE);
-		}
-		assert(!"Shouldn't get here...");
-		exit(EXIT_FAILURE);
-	} else if (pid == -1) {
-		// fork() failed.
-		int err = errno;
-		if (err == 0) {
-			err = EIO;
-		}
-		return -err;
+	assert(worker != nullptr);
+	if (!worker) {
+		// No free workers.
+		return -EBUSY;
 	}
-#endif /* HAVE_POSIX_SPAWN */
 
-	// Parent process.
-	// Wait up to 10 seconds for the process to exit.
-	// TODO: User-configurable timeout?
-	// TODO: Report errors somewhere.
-	bool ok = false;	// rp-download terminated successfully.
-	bool waited = false;	// waitpid() was successful.
-	int wstatus = 0;
-	for (unsigned int i = 10*4; i > 0; i--) {
-		pid_t wpid = waitpid(pid, &wstatus, WNOHANG);
-		if (wpid == pid) {
-			// Process has changed state.
-			if (WIFEXITED(wstatus)) {
-				// Child process has exited.
-				// If the return status is non-zero, it failed.
-				if (WEXITSTATUS(wstatus) != 0) {
-					// Failure.
-					break;
-				}
-				// Success!
-				ok = true;
-				waited = true;
-				break;
-			} else if (WIFSIGNALED(wstatus)) {
-				// Child process terminated abnormally.
-				waited = true;
+	// Send the cache keys to the worker.
+	// If the worker isn't running, or if it exited due to its
+	// idle timeout, start a new worker and try again.
+	int ret = -ECHILD;
+	for (int attempt = 0; attempt < 2; attempt++) {
+		if (worker->pid > 0 &&
+		    (worker->env != s_env || worker->maxConnectionsPerHost != maxConnectionsPerHost))
+		{
+			// Environment or configuration has changed,
+			// e.g. proxy settings.
+			stopWorker(*worker);
+		}
+
+		if (worker->pid <= 0) {
+			ret = startWorker(*worker, argv, envp);
+			if (ret != 0) {
+				// Error creating the child process.
 				break;
 			}
+			worker->env = s_env;
+			worker->maxConnectionsPerHost = maxConnectionsPerHost;
 		}
 
-		// Wait 250ms before checking again.
-		usleep(250*1000);
-	}
+		ret = sendCacheKeys(*worker, cache_keys);
+		if (ret == 0) {
+			break;
+		}
 
-	if (!waited) {
-		// Process did not complete.
-		// TODO: Prevent race conditions by using waitid() instead of waitpid()?
-		// TODO: Better error code?
-		kill(pid, SIGTERM);
-		return -ECHILD;
+		// Worker probably exited. Try again with a new worker.
+		stopWorker(*worker);
 	}
 
-	if (!ok) {
-		// rp-download failed for some reason.
-		// TODO: Better error code?
-		return -EIO;
+	// Wait for the results.
+	// The timeout is reset whenever a result is received, since
+	// a large batch may take a while to download in total.
+	// TODO: User-configurable timeout?
+	// TODO: Report errors somewhere.
+	while (ret == 0 && !pending.empty()) {
+		string cache_key;
+		int result = recvResult(*worker, cache_key, 10*1000);
+		if (result == 0 || result == -EIO) {
+			auto iter = pending.find(cache_key);
+			if (iter == pending.end()) {
+				// Not one of our cache keys.
+				continue;
+			}
+			for (size_t idx : iter->second) {
+				results[idx] = result;
+			}
+			pending.erase(iter);
+			continue;
+		}
+
+		// Worker is in an unknown state. Stop it.
+		stopWorker(*worker);
+		if (result == -ETIMEDOUT) {
+			// Process did not complete.
+			result = -ECHILD;
+		} else {
+			// rp-download failed for some reason.
+			result = -EIO;
+		}
+		for (const auto &p : pending) {
+			for (size_t idx : p.second) {
+				results[idx] = result;
+			}
+		}
+		break;
 	}
 
-	// rp-download has successfully downloaded the file.
-	return 0;
+	MutexLocker locker(rpdl_workers_mutex);
+	worker->busy = false;
+	return ret;
 }
 
 }
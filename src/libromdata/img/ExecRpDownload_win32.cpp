@@ -18,7 +18,9 @@
 
 // C++ includes.
 #include <string>
+#include <vector>
 using std::string;
+using std::vector;
 using std::wstring;
 
 // Defined in win32/DllMain.cpp.
@@ -135,4 +137,21 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	return 0;
 }
 
+/**
+ * Execute rp-download for multiple cache keys. (Windows version)
+ * @param cache_keys	[in] Cache keys.
+ * @param results	[out] Results for each cache key. (0 on success; negative POSIX error code on error.)
+ * @return 0 if rp-download was executed; negative POSIX error code on error.
+ */
+int CacheManager::execRpDownloadMultiple(const vector<string> &cache_keys, vector<int> &results)
+{
+	// TODO: Batch mode isn't supported on Windows yet.
+	// Run rp-download once per cache key.
+	results.resize(cache_keys.size());
+	for (size_t i = 0; i < cache_keys.size(); i++) {
+		results[i] = execRpDownload(cache_keys[i]);
+	}
+	return 0;
+}
+
 }
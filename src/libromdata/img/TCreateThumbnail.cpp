@@ -35,12 +35,64 @@ using LibRpTexture::rp_image;
 
 // C++ includes.
 #include <memory>
+#include <unordered_set>
+#include <vector>
 using std::unique_ptr;
+using std::unordered_set;
+using std::vector;
 
 namespace LibRomData {
 
+/**
+ * Get the external image sizes to try, in order.
+ *
+ * The smallest size that's at least req_size is tried first.
+ * If it isn't available, larger sizes are tried, so the
+ * thumbnail doesn't have to be upscaled.
+ *
+ * @param romData	[in] RomData object.
+ * @param imageType	[in] Image type.
+ * @param req_size	[in] Requested image size.
+ * @return Sizes to pass to RomData::extURLs().
+ */
+static inline vector<int> getExtImageSizes(const RomData *romData, RomData::ImageType imageType, int req_size)
+{
+	vector<int> sizes;
+	if (req_size > 0) {
+		const vector<RomData::ImageSizeDef> sizeDefs = romData->supportedImageSizes(imageType);
+		sizes.reserve(sizeDefs.size());
+		for (const RomData::ImageSizeDef &sizeDef : sizeDefs) {
+			const int sz = std::max(sizeDef.width, sizeDef.height);
+			if (sz <= 0) {
+				// Unknown size. Let the RomData subclass select it.
+				sizes.clear();
+				break;
+			}
+			sizes.emplace_back(sz);
+		}
+	}
+	if (sizes.size() <= 1) {
+		// Zero or one known size.
+		return vector<int>(1, req_size);
+	}
+
+	std::sort(sizes.begin(), sizes.end());
+	sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+	// Skip sizes that are smaller than the requested size,
+	// unless all of them are smaller.
+	auto iter = std::lower_bound(sizes.begin(), sizes.end(), req_size);
+	if (iter == sizes.end()) {
+		--iter;
+	}
+	sizes.erase(sizes.begin(), iter);
+	return sizes;
+}
+
 template<typename ImgClass>
 TCreateThumbnail<ImgClass>::TCreateThumbnail()
+	: m_pCancel(nullptr)
+	, m_deadline_ns(0)
 { }
 
 template<typename ImgClass>
@@ -49,9 +101,15 @@ TCreateThumbnail<ImgClass>::~TCreateThumbnail()
 
 /**
  * Get an internal image.
+ *
+ * If the image is available in multiple sizes (e.g. texture mipmaps),
+ * the smallest image that is at least req_size will be returned.
+ * pOutSize will still be set to the full image size.
+ *
  * @param romData	[in] RomData object.
  * @param imageType	[in] Image type.
- * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size.
+ * @param req_size	[in] Requested image size.
+ * @param pOutSize	[out,opt] Pointer to ImgSize to store the full image's size.
  * @param sBIT		[out,opt] sBIT metadata.
  * @return Internal image, or null ImgClass on error.
  */
@@ -59,6 +117,7 @@ template<typename ImgClass>
 ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 	const RomData *romData,
 	RomData::ImageType imageType,
+	int req_size,
 	ImgSize *pOutSize,
 	rp_image::sBIT_t *sBIT)
 {
@@ -71,7 +130,7 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 		return getNullImgClass();
 	}
 
-	const rp_image *image = romData->image(imageType);
+	const rp_image *image = romData->image(imageType, req_size);
 	if (!image) {
 		// No image.
 		if (sBIT) {
@@ -80,8 +139,13 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 		return getNullImgClass();
 	}
 
+	// Downscale the image if it's larger than the requested size.
+	rp_image *const ds_img = downscale_rp_image(image, req_size, romData->imgpf(imageType));
+	const bool is_downscaled = (ds_img != nullptr);
+
 	// Convert the rp_image to ImgClass.
-	ImgClass ret_img = rpImageToImgClass(image);
+	ImgClass ret_img = rpImageToImgClass(is_downscaled ? ds_img : image);
+	UNREF(ds_img);
 	if (isImgClassValid(ret_img)) {
 		// Image converted successfully.
 		if (pOutSize) {
@@ -90,7 +154,28 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 			// since Windows has issues with non-square images.
 			// Hence, we have to get the size from ret_img.
 			// TODO: Check for errors?
-			getImgClassSize(ret_img, pOutSize);
+			if (is_downscaled) {
+				// Image was downscaled. Report the original size.
+				pOutSize->width = image->width();
+				pOutSize->height = image->height();
+			} else {
+				getImgClassSize(ret_img, pOutSize);
+			}
+
+			// If a smaller image (e.g. a mipmap) was returned,
+			// report the size of the full image instead.
+			if (req_size != RomData::IMAGE_SIZE_DEFAULT) {
+				const vector<RomData::ImageSizeDef> sizeDefs = romData->supportedImageSizes(imageType);
+				if (!sizeDefs.empty()) {
+					const RomData::ImageSizeDef &fullSizeDef = sizeDefs[0];
+					if (fullSizeDef.width >= image->width() && fullSizeDef.height >= image->height() &&
+					    (fullSizeDef.width > image->width() || fullSizeDef.height > image->height()))
+					{
+						pOutSize->width = fullSizeDef.width;
+						pOutSize->height = fullSizeDef.height;
+					}
+				}
+			}
 		}
 		if (sBIT) {
 			// Get the sBIT metadata.
@@ -109,7 +194,7 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
  * @param romData	[in] RomData object.
  * @param imageType	[in] Image type.
  * @param req_size	[in] Requested image size.
- * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size.
+ * @param pOutSize	[out,opt] Pointer to ImgSize to store the full image's size.
  * @param sBIT		[out,opt] sBIT metadata.
  * @return External image, or null ImgClass on error.
  */
@@ -128,82 +213,105 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 		return getNullImgClass();
 	}
 
-	// Synchronously download from the source URLs.
-	// TODO: Image size selection.
-	std::vector<RomData::ExtURL> extURLs;
-	int ret = romData->extURLs(imageType, &extURLs, req_size);
-	if (ret != 0 || extURLs.empty()) {
-		// No URLs.
-		if (sBIT) {
-			memset(sBIT, 0, sizeof(*sBIT));
-		}
-		return getNullImgClass();
-	}
-
 	// NOTE: This will force a configuration timestamp check.
 	const Config *const config = Config::instance();
 	const bool extImgDownloadEnabled = config->extImgDownloadEnabled();
 	const bool downloadHighResScans = config->downloadHighResScans();
 
+	// If the image will be downscaled, JPEG images can be decoded
+	// at a reduced scale. Images that will be rescaled to 8:7 need
+	// to be decoded at full size.
+	const uint32_t imgpf = romData->imgpf(imageType);
+	const int load_size = (imgpf & RomData::IMGPF_RESCALE_ASPECT_8to7) ? 0 : req_size;
+
+	// Synchronously download from the source URLs.
+	// The best-fit image size is tried first. If it isn't available,
+	// e.g. if it's not in the cache and downloads are disabled,
+	// larger sizes are tried.
+	const vector<int> sizes = getExtImageSizes(romData, imageType, req_size);
+	unordered_set<std::string> tried_keys;
 	CacheManager cache;
-	const auto extURLs_cend = extURLs.cend();
-	for (auto iter = extURLs.cbegin(); iter != extURLs_cend; ++iter) {
-		const RomData::ExtURL &extURL = *iter;
-		std::string proxy = proxyForUrl(extURL.url);
-		cache.setProxyUrl(!proxy.empty() ? proxy.c_str() : nullptr);
-
-		// Should we attempt to download the image,
-		// or just use the local cache?
-		// TODO: Verify that this works correctly.
-		bool download = extImgDownloadEnabled;
-		if (!downloadHighResScans && extURL.high_res) {
-			// Don't download high-resolution images, but
-			// use them if they've already been downloaded.
-			download = false;
+	for (int size : sizes) {
+		if (checkStop() != 0) {
+			// Don't download anything else.
+			break;
 		}
 
-		// TODO: Have download() return the actual data and/or load the cached file.
-		std::string cache_filename;
-		if (download) {
-			// Attempt to download the image if it isn't already
-			// present in the rom-properties cache.
-			cache_filename = cache.download(extURL.cache_key);
-		} else {
-			// Don't attempt to download the image.
-			// Only check the rom-properties cache.
-			cache_filename = cache.findInCache(extURL.cache_key);
-		}
-		if (cache_filename.empty())
+		std::vector<RomData::ExtURL> extURLs;
+		int ret = romData->extURLs(imageType, &extURLs, size);
+		if (ret != 0 || extURLs.empty()) {
+			// No URLs for this size.
 			continue;
+		}
 
-		// Attempt to load the image.
-		unique_RefBase<RpFile> file(new RpFile(cache_filename, RpFile::FM_OPEN_READ));
-		if (file->isOpen()) {
-			rp_image *const dl_img = RpImageLoader::load(file.get());
-			if (dl_img && dl_img->isValid()) {
-				// Image loaded successfully.
-				file->close();
-				ImgClass ret_img = rpImageToImgClass(dl_img);
-				if (isImgClassValid(ret_img)) {
-					// Image converted successfully.
-					if (pOutSize) {
-						// Get the image size.
-						pOutSize->width = dl_img->width();
-						pOutSize->height = dl_img->height();
-					}
-					// Get the sBIT metadata.
-					if (sBIT) {
-						if (dl_img->get_sBIT(sBIT) != 0) {
-							// No sBIT metadata.
-							// Clear the struct.
-							memset(sBIT, 0, sizeof(*sBIT));
+		const auto extURLs_cend = extURLs.cend();
+		for (auto iter = extURLs.cbegin(); iter != extURLs_cend && checkStop() == 0; ++iter) {
+			const RomData::ExtURL &extURL = *iter;
+			if (!tried_keys.insert(extURL.cache_key).second) {
+				// Already tried this image with a different size.
+				continue;
+			}
+			std::string proxy = proxyForUrl(extURL.url);
+			cache.setProxyUrl(!proxy.empty() ? proxy.c_str() : nullptr);
+
+			// Should we attempt to download the image,
+			// or just use the local cache?
+			// TODO: Verify that this works correctly.
+			bool download = extImgDownloadEnabled;
+			if (!downloadHighResScans && extURL.high_res) {
+				// Don't download high-resolution images, but
+				// use them if they've already been downloaded.
+				download = false;
+			}
+
+			IRpFile *cache_file;
+			if (download) {
+				// Attempt to download the image if it isn't already
+				// present in the rom-properties cache.
+				cache_file = cache.download(extURL.cache_key);
+			} else {
+				// Don't attempt to download the image.
+				// Only check the rom-properties cache.
+				cache_file = cache.findInCache(extURL.cache_key);
+			}
+			if (!cache_file)
+				continue;
+
+			// Attempt to load the image.
+			unique_RefBase<IRpFile> file(cache_file);
+			if (file->isOpen()) {
+				ImgSize fullSize = {0, 0};
+				rp_image *const dl_img = RpImageLoader::load(file.get(), load_size,
+					&fullSize.width, &fullSize.height);
+				if (dl_img && dl_img->isValid()) {
+					// Image loaded successfully.
+					file->close();
+
+					// Downscale the image if it's larger than the requested size.
+					rp_image *const ds_img = downscale_rp_image(dl_img, req_size, imgpf);
+					ImgClass ret_img = rpImageToImgClass(ds_img ? ds_img : dl_img);
+					UNREF(ds_img);
+					if (isImgClassValid(ret_img)) {
+						// Image converted successfully.
+						if (pOutSize) {
+							// Get the full image size.
+							// NOTE: dl_img may have been decoded at a reduced scale.
+							*pOutSize = fullSize;
 						}
+						// Get the sBIT metadata.
+						if (sBIT) {
+							if (dl_img->get_sBIT(sBIT) != 0) {
+								// No sBIT metadata.
+								// Clear the struct.
+								memset(sBIT, 0, sizeof(*sBIT));
+							}
+						}
+						// TODO: Transparency processing?
+						return ret_img;
 					}
-					// TODO: Transparency processing?
-					return ret_img;
 				}
+				UNREF(dl_img);
 			}
-			UNREF(dl_img);
 		}
 	}
 
@@ -242,6 +350,40 @@ inline void TCreateThumbnail<ImgClass>::rescale_aspect(ImgSize &rs_size, const I
 	}
 }
 
+/**
+ * Downscale an rp_image if it's larger than the requested size.
+ * The aspect ratio will be maintained.
+ * @param img		[in] rp_image.
+ * @param req_size	[in] Requested image size.
+ * @param imgpf		[in] Image processing flags.
+ * @return Downscaled rp_image (must be unref()'d), or nullptr if downscaling isn't needed.
+ */
+template<typename ImgClass>
+rp_image *TCreateThumbnail<ImgClass>::downscale_rp_image(const rp_image *img, int req_size, uint32_t imgpf)
+{
+	if (req_size <= 0 || (img->width() <= req_size && img->height() <= req_size)) {
+		// No downscaling is needed.
+		return nullptr;
+	}
+	if (imgpf & RomData::IMGPF_RESCALE_ASPECT_8to7) {
+		// Image will be rescaled to an 8:7 pixel aspect ratio
+		// using its full size, so don't downscale it here.
+		return nullptr;
+	}
+
+	ImgSize sz = {img->width(), img->height()};
+	const ImgSize tgt_sz = {req_size, req_size};
+	rescale_aspect(sz, tgt_sz);
+	if (sz.width <= 0 || sz.height <= 0) {
+		// Very narrow image. Don't downscale it.
+		return nullptr;
+	}
+
+	// NOTE: Box filtering averages all source pixels,
+	// which is best for large reductions.
+	return img->scaled(sz.width, sz.height, rp_image::ScaleFilter::Box);
+}
+
 /**
  * Create a thumbnail for the specified ROM file.
  * @param romData	[in] RomData object.
@@ -296,7 +438,7 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomData *romData, int reqSize
 		// Check for an icon first.
 		// TODO: Define "small sizes" somewhere. (DPI independence?)
 		if (imgbf & RomData::IMGBF_INT_ICON) {
-			pOutParams->retImg = getInternalImage(romData, RomData::IMG_INT_ICON, &pOutParams->fullSize, &pOutParams->sBIT);
+			pOutParams->retImg = getInternalImage(romData, RomData::IMG_INT_ICON, reqSize, &pOutParams->fullSize, &pOutParams->sBIT);
 			imgpf = romData->imgpf(RomData::IMG_INT_ICON);
 			imgbf &= ~RomData::IMGBF_INT_ICON;
 
@@ -311,6 +453,12 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomData *romData, int reqSize
 	// Check all available images in image priority order.
 	// TODO: Use pointer arithmetic in this loop?
 	for (unsigned int i = 0; i < imgTypePrio.length; i++) {
+		const int stop = checkStop();
+		if (stop != 0) {
+			// Thumbnail request was cancelled or timed out.
+			return stop;
+		}
+
 		const RomData::ImageType imgType =
 			static_cast<RomData::ImageType>(imgTypePrio.imgTypes[i]);
 		assert(imgType <= RomData::IMG_EXT_MAX);
@@ -328,7 +476,7 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomData *romData, int reqSize
 		// This image may be present.
 		if (imgType <= RomData::IMG_INT_MAX) {
 			// Internal image.
-			pOutParams->retImg = getInternalImage(romData, imgType, &pOutParams->fullSize, &pOutParams->sBIT);
+			pOutParams->retImg = getInternalImage(romData, imgType, reqSize, &pOutParams->fullSize, &pOutParams->sBIT);
 			imgpf = romData->imgpf(imgType);
 		} else {
 			// External image.
@@ -349,7 +497,8 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomData *romData, int reqSize
 
 	if (!isImgClassValid(pOutParams->retImg)) {
 		// No image.
-		return RPCT_SOURCE_FILE_NO_IMAGE;
+		const int stop = checkStop();
+		return (stop != 0 ? stop : RPCT_SOURCE_FILE_NO_IMAGE);
 	}
 
 skip_image_check:
@@ -360,6 +509,14 @@ skip_image_check:
 		return RPCT_SOURCE_FILE_ERROR;
 	}
 
+	// Get the size of the retrieved image.
+	// NOTE: This may be smaller than the full image size
+	// if a mipmap level was selected.
+	ImgSize imgSize;
+	if (getImgClassSize(pOutParams->retImg, &imgSize) != 0) {
+		imgSize = pOutParams->fullSize;
+	}
+
 	if (imgpf & RomData::IMGPF_RESCALE_ASPECT_8to7) {
 		// If the image width is 256 or 512, rescale to an 8:7 pixel aspect ratio.
 		int scaleW = 0;
@@ -378,6 +535,7 @@ skip_image_check:
 			ImgClass scaled_img = rescaleImgClass(pOutParams->retImg, pOutParams->fullSize);
 			freeImgClass(pOutParams->retImg);
 			pOutParams->retImg = scaled_img;
+			imgSize = pOutParams->fullSize;
 
 			// Disable nearest-neighbor scaling, since we already lost
 			// pixel-perfect sharpness with the 8:7 rescale.
@@ -385,7 +543,8 @@ skip_image_check:
 		}
 	}
 
-	// TODO: If image is larger than req_size, resize down.
+	// NOTE: Images larger than req_size were already downscaled
+	// by getInternalImage() and getExternalImage().
 	if (imgpf & RomData::IMGPF_RESCALE_NEAREST) {
 		// TODO: User configuration.
 		ResizeNearestUpPolicy resize_up = RESIZE_UP_HALF;
@@ -402,15 +561,15 @@ skip_image_check:
 			default:
 				// Only resize images that are less than or equal to
 				// half requested thumbnail size.
-				needs_resize_up = (pOutParams->fullSize.width  <= (reqSize/2)) ||
-						  (pOutParams->fullSize.height <= (reqSize/2));
+				needs_resize_up = (imgSize.width  <= (reqSize/2)) ||
+						  (imgSize.height <= (reqSize/2));
 				break;
 
 			case RESIZE_UP_ALL:
 				// Resize all images that are smaller than the
 				// requested thumbnail size.
-				needs_resize_up = (pOutParams->fullSize.width  < reqSize) ||
-						  (pOutParams->fullSize.height < reqSize);
+				needs_resize_up = (imgSize.width  < reqSize) ||
+						  (imgSize.height < reqSize);
 				break;
 		}
 
@@ -418,12 +577,12 @@ skip_image_check:
 			// Need to upscale the image.
 			ImgSize int_sz = {reqSize, reqSize};
 			// Resize to the next highest integer multiple.
-			int_sz.width -= (int_sz.width % pOutParams->fullSize.width);
-			int_sz.height -= (int_sz.height % pOutParams->fullSize.height);
+			int_sz.width -= (int_sz.width % imgSize.width);
+			int_sz.height -= (int_sz.height % imgSize.height);
 
 			// Calculate the closest size while maintaining the aspect ratio.
 			// Based on Qt 4.8's QSize::scale().
-			ImgSize rescale_sz = pOutParams->fullSize;
+			ImgSize rescale_sz = imgSize;
 			rescale_aspect(rescale_sz, int_sz);
 
 			// FIXME: If the original image is 64x1024, the rescale
@@ -435,16 +594,16 @@ skip_image_check:
 				freeImgClass(pOutParams->retImg);
 				pOutParams->retImg = scaled_img;
 			} else {
-				// Unable to rescale. Use the full image size.
-				pOutParams->thumbSize = pOutParams->fullSize;
+				// Unable to rescale. Use the retrieved image size.
+				pOutParams->thumbSize = imgSize;
 			}
 		} else {
-			// Resize Up isn't needed. Use the full image size.
-			pOutParams->thumbSize = pOutParams->fullSize;
+			// Resize Up isn't needed. Use the retrieved image size.
+			pOutParams->thumbSize = imgSize;
 		}
 	} else {
-		// Thumbnail size matches the full image size.
-		pOutParams->thumbSize = pOutParams->fullSize;
+		// Thumbnail size matches the retrieved image size.
+		pOutParams->thumbSize = imgSize;
 	}
 
 	// Image retrieved successfully.
@@ -469,9 +628,15 @@ int TCreateThumbnail<ImgClass>::getThumbnail(IRpFile *file, int reqSize, GetThum
 		return RPCT_INVALID_IMAGE_SIZE;
 	}
 
+	const int stop = checkStop();
+	if (stop != 0) {
+		// Thumbnail request was cancelled or timed out.
+		return stop;
+	}
+
 	// Get the appropriate RomData class for this ROM.
 	// RomData class *must* support at least one image type.
-	RomData *romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+	RomData *romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL | RomDataFactory::RDA_EXT_HINT | RomDataFactory::RDA_NEG_CACHE | RomDataFactory::RDA_CACHE);
 	if (!romData) {
 		// ROM is not supported.
 		return RPCT_SOURCE_FILE_NOT_SUPPORTED;
@@ -501,10 +666,22 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const char *filename, int reqSize,
 		return RPCT_INVALID_IMAGE_SIZE;
 	}
 
+	// Skip files that are known to be unsupported
+	// without opening them.
+	if (RomDataFactory::isKnownUnsupported(filename, RomDataFactory::RDA_HAS_THUMBNAIL)) {
+		return RPCT_SOURCE_FILE_NOT_SUPPORTED;
+	}
+
+	const int stop = checkStop();
+	if (stop != 0) {
+		// Thumbnail request was cancelled or timed out.
+		return stop;
+	}
+
 	// Attempt to open the ROM file.
 	// TODO: OS-specific wrappers, e.g. RpQFile or RpGVfsFile.
 	// For now, using RpFile, which is an stdio wrapper.
-	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ_MMAP);
 	if (!file->isOpen()) {
 		// Could not open the file.
 		file->unref();
@@ -513,7 +690,7 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const char *filename, int reqSize,
 
 	// Get the appropriate RomData class for this ROM.
 	// RomData class *must* support at least one image type.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL | RomDataFactory::RDA_EXT_HINT | RomDataFactory::RDA_NEG_CACHE | RomDataFactory::RDA_CACHE);
 	file->unref();	// file is ref()'d by RomData.
 	if (!romData) {
 		// ROM is not supported.
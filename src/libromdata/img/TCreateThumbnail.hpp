@@ -33,6 +33,8 @@ typedef enum {
 	RPCT_SOURCE_FILE_BAD_FS		= 7,	// Source file is located on a "bad" file system.
 	RPCT_RUNNING_AS_ROOT		= 8,	// Running as root is not supported.
 	RPCT_INVALID_IMAGE_SIZE		= 9,	// Invalid image size requested. (e.g. 0 or less)
+	RPCT_CANCELLED			= 10,	// Thumbnail request was cancelled.
+	RPCT_TIMED_OUT			= 11,	// Thumbnail request exceeded its time budget.
 } RpCreateThumbnailError;
 
 /**
@@ -64,12 +66,27 @@ typedef enum {
  */
 typedef int (RP_C_API *PFN_RP_CREATE_THUMBNAIL)(const char *source_file, const char *output_file, int maximum_size);
 
+/**
+ * rp_create_thumbnail2() function pointer.
+ * Same as rp_create_thumbnail(), but the request can be cancelled
+ * or limited to a time budget.
+ * Used for wrapper programs that don't link to libromdata directly.
+ * @param source_file Source file. (UTF-8)
+ * @param output_file Output file. (UTF-8)
+ * @param maximum_size Maximum size.
+ * @param pCancel Cancellation flag. If this is set to non-zero while the thumbnail is being created, RPCT_CANCELLED is returned. (may be NULL)
+ * @param timeout_ms Time budget, in milliseconds. If it's exceeded, RPCT_TIMED_OUT is returned. (0 for no limit)
+ * @return 0 on success; non-zero on error.
+ */
+typedef int (RP_C_API *PFN_RP_CREATE_THUMBNAIL2)(const char *source_file, const char *output_file, int maximum_size, const volatile int *pCancel, unsigned int timeout_ms);
+
 #ifdef __cplusplus
 }
 #endif
 
 #ifdef __cplusplus
 #include "librpbase/RomData.hpp"
+#include "librpbase/monotonic_time.h"
 #include "librptexture/img/rp_image.hpp"
 
 // C++ includes.
@@ -93,6 +110,67 @@ class TCreateThumbnail
 	private:
 		RP_DISABLE_COPY(TCreateThumbnail)
 
+	public:
+		/**
+		 * Set the cancellation flag.
+		 *
+		 * The flag is checked between I/O phases, e.g. before loading
+		 * each image type and before downloading each external image.
+		 * If it's non-zero, getThumbnail() returns RPCT_CANCELLED.
+		 *
+		 * @param pCancel Cancellation flag. (may be nullptr; must stay valid until the thumbnail is created)
+		 */
+		inline void setCancelFlag(const volatile int *pCancel)
+		{
+			m_pCancel = pCancel;
+		}
+
+		/**
+		 * Set a deadline for creating the thumbnail.
+		 *
+		 * The deadline is checked at the same points as the
+		 * cancellation flag. If it has passed, getThumbnail()
+		 * returns RPCT_TIMED_OUT.
+		 *
+		 * NOTE: A stage that's already running, e.g. a download,
+		 * won't be interrupted.
+		 *
+		 * @param deadline_ns Deadline, in rp_monotonic_ns() time. (0 for no deadline)
+		 */
+		inline void setDeadline(uint64_t deadline_ns)
+		{
+			m_deadline_ns = deadline_ns;
+		}
+
+		/**
+		 * Set a time budget for creating the thumbnail, starting now.
+		 * @param budget_ms Time budget, in milliseconds. (0 for no limit)
+		 */
+		inline void setTimeBudget(unsigned int budget_ms)
+		{
+			m_deadline_ns = (budget_ms != 0)
+				? rp_monotonic_ns() + (static_cast<uint64_t>(budget_ms) * 1000000ULL)
+				: 0;
+		}
+
+		/**
+		 * Should the thumbnail request be stopped?
+		 * @return RPCT_CANCELLED if cancelled; RPCT_TIMED_OUT if the deadline has passed; 0 to continue.
+		 */
+		inline int checkStop(void) const
+		{
+			if (m_pCancel && *m_pCancel != 0) {
+				return RPCT_CANCELLED;
+			} else if (m_deadline_ns != 0 && rp_monotonic_ns() >= m_deadline_ns) {
+				return RPCT_TIMED_OUT;
+			}
+			return 0;
+		}
+
+	private:
+		const volatile int *m_pCancel;
+		uint64_t m_deadline_ns;
+
 	public:
 		/**
 		 * Image size struct.
@@ -104,14 +182,21 @@ class TCreateThumbnail
 
 		/**
 		 * Get an internal image.
+		 *
+		 * If the image is available in multiple sizes (e.g. texture mipmaps),
+		 * the smallest image that is at least req_size will be returned.
+		 * pOutSize will still be set to the full image size.
+		 *
 		 * @param romData	[in] RomData object.
 		 * @param imageType	[in] Image type.
-		 * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size.
+		 * @param req_size	[in] Requested image size.
+		 * @param pOutSize	[out,opt] Pointer to ImgSize to store the full image's size.
 		 * @param sBIT		[out,opt] sBIT metadata.
 		 * @return Internal image, or null ImgClass on error.
 		 */
 		ImgClass getInternalImage(const LibRpBase::RomData *romData,
 			LibRpBase::RomData::ImageType imageType,
+			int req_size = LibRpBase::RomData::IMAGE_SIZE_DEFAULT,
 			ImgSize *pOutSize = nullptr,
 			LibRpTexture::rp_image::sBIT_t *sBIT = nullptr);
 
@@ -175,6 +260,16 @@ class TCreateThumbnail
 		 */
 		static inline void rescale_aspect(ImgSize &rs_size, const ImgSize &tgt_size);
 
+		/**
+		 * Downscale an rp_image if it's larger than the requested size.
+		 * The aspect ratio will be maintained.
+		 * @param img		[in] rp_image.
+		 * @param req_size	[in] Requested image size.
+		 * @param imgpf		[in] Image processing flags.
+		 * @return Downscaled rp_image (must be unref()'d), or nullptr if downscaling isn't needed.
+		 */
+		static LibRpTexture::rp_image *downscale_rp_image(const LibRpTexture::rp_image *img, int req_size, uint32_t imgpf);
+
 	protected:
 		/** Pure virtual functions. **/
 
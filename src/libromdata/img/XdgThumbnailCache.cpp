@@ -0,0 +1,255 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * XdgThumbnailCache.cpp: XDG thumbnail cache lookup.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.librpbase.h"
+#include "XdgThumbnailCache.hpp"
+
+// librpbase, librpfile
+#ifdef ENABLE_DECRYPTION
+# include "librpbase/crypto/MD5Hash.hpp"
+#endif /* ENABLE_DECRYPTION */
+#include "librpfile/RpFile.hpp"
+using LibRpFile::RpFile;
+
+// libunixcommon
+#include "libunixcommon/userdirs.hpp"
+
+// C includes.
+#include <inttypes.h>
+#include <zlib.h>
+
+// C++ STL classes.
+using std::string;
+using std::unique_ptr;
+
+namespace LibRomData { namespace XdgThumbnailCache {
+
+/**
+ * Maximum tEXt chunk size to read.
+ * Thumb::URI is the largest value we care about.
+ */
+static const uint32_t TEXT_CHUNK_MAX_SIZE = 8192;
+
+/**
+ * Get the filename of a thumbnail in the XDG thumbnail cache.
+ *
+ * Only the standard thumbnail sizes are supported:
+ * 128 (normal), 256 (large), 512 (x-large), and 1024 (xx-large).
+ *
+ * @param uri Source file URI, as written to Thumb::URI.
+ * @param reqSize Requested thumbnail size.
+ * @return Thumbnail filename, or empty string if not available.
+ */
+string getThumbnailFilename(const char *uri, int reqSize)
+{
+	assert(uri != nullptr);
+	if (!uri || uri[0] == '\0')
+		return string();
+
+	// NOTE: Non-standard sizes might be scaled differently
+	// than the cached thumbnail, so they aren't checked.
+	const char *subdir;
+	switch (reqSize) {
+		case 128:	subdir = "/thumbnails/normal/"; break;
+		case 256:	subdir = "/thumbnails/large/"; break;
+		case 512:	subdir = "/thumbnails/x-large/"; break;
+		case 1024:	subdir = "/thumbnails/xx-large/"; break;
+		default:
+			return string();
+	}
+
+#ifdef ENABLE_DECRYPTION
+	// The thumbnail filename is the MD5 hash of the URI.
+	uint8_t md5[16] = {};
+	if (LibRpBase::MD5Hash::calcHash(md5, sizeof(md5), uri, strlen(uri)) != 0)
+		return string();
+
+	string filename = LibUnixCommon::getCacheDirectory();
+	if (filename.empty())
+		return filename;
+	filename += subdir;
+
+	static const char hex_lookup[] = "0123456789abcdef";
+	for (uint8_t b : md5) {
+		filename += hex_lookup[b >> 4];
+		filename += hex_lookup[b & 0x0F];
+	}
+	filename += ".png";
+	return filename;
+#else /* !ENABLE_DECRYPTION */
+	// MD5 isn't available without decryption support.
+	RP_UNUSED(subdir);
+	return string();
+#endif /* ENABLE_DECRYPTION */
+}
+
+/**
+ * Check if a cached thumbnail is valid for the specified source file.
+ * This checks Thumb::URI and Thumb::MTime without decoding the image.
+ * @param thumb_filename Thumbnail filename.
+ * @param uri Source file URI.
+ * @param mtime Source file modification time.
+ * @return True if the thumbnail is valid; false if not.
+ */
+bool isThumbnailValid(const char *thumb_filename, const char *uri, int64_t mtime)
+{
+	assert(thumb_filename != nullptr);
+	assert(uri != nullptr);
+	if (!thumb_filename || thumb_filename[0] == '\0' || !uri || mtime <= 0)
+		return false;
+
+	RpFile *const file = new RpFile(thumb_filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		// Thumbnail doesn't exist.
+		file->unref();
+		return false;
+	}
+
+	// Check the PNG signature.
+	static const uint8_t png_sig[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	uint8_t buf[8];
+	if (file->read(buf, sizeof(buf)) != sizeof(buf) || memcmp(buf, png_sig, sizeof(png_sig)) != 0) {
+		// Not a PNG image.
+		file->unref();
+		return false;
+	}
+
+	// Check the tEXt chunks before the first IDAT chunk.
+	char mtime_str[32];
+	snprintf(mtime_str, sizeof(mtime_str), "%" PRId64, mtime);
+	bool uriOK = false, mtimeOK = false;
+	unique_ptr<char[]> text_buf, ztxt_buf;
+	while (!uriOK || !mtimeOK) {
+		// Chunk header: length, type
+		if (file->read(buf, sizeof(buf)) != sizeof(buf))
+			break;
+		uint32_t chunk_len;
+		memcpy(&chunk_len, buf, sizeof(chunk_len));
+		chunk_len = be32_to_cpu(chunk_len);
+		if (chunk_len > 0x7FFFFFFFU || !memcmp(&buf[4], "IDAT", 4) || !memcmp(&buf[4], "IEND", 4)) {
+			// Invalid chunk, or no more metadata.
+			break;
+		}
+
+		const off64_t next_chunk = file->tell() + chunk_len + 4;	// including CRC32
+		const bool is_zTXt = !memcmp(&buf[4], "zTXt", 4);
+		if ((is_zTXt || !memcmp(&buf[4], "tEXt", 4)) && chunk_len <= TEXT_CHUNK_MAX_SIZE) {
+			// tEXt chunk: keyword, NULL, text (not NULL-terminated)
+			// zTXt chunk: keyword, NULL, compression method, compressed text
+			// NOTE: RpPngWriter (and Qt) use zTXt for values that are
+			// 40 bytes or longer, which includes most Thumb::URI values.
+			if (!text_buf) {
+				text_buf.reset(new char[TEXT_CHUNK_MAX_SIZE + 1]);
+			}
+			if (file->read(text_buf.get(), chunk_len) != chunk_len)
+				break;
+			text_buf[chunk_len] = '\0';
+
+			const size_t key_len = strlen(text_buf.get());
+			if (key_len < chunk_len) {
+				const char *value = &text_buf[key_len + 1];
+				if (is_zTXt) {
+					// Only zlib compression (method 0) is defined.
+					if (key_len + 2 > chunk_len || text_buf[key_len + 1] != 0)
+						break;
+					if (!ztxt_buf) {
+						ztxt_buf.reset(new char[TEXT_CHUNK_MAX_SIZE + 1]);
+					}
+					uLongf dest_len = TEXT_CHUNK_MAX_SIZE;
+					if (uncompress(reinterpret_cast<Bytef*>(ztxt_buf.get()), &dest_len,
+					    reinterpret_cast<const Bytef*>(&text_buf[key_len + 2]),
+					    static_cast<uLong>(chunk_len - key_len - 2)) != Z_OK)
+					{
+						break;
+					}
+					ztxt_buf[dest_len] = '\0';
+					value = ztxt_buf.get();
+				}
+				if (!strcmp(text_buf.get(), "Thumb::URI")) {
+					if (strcmp(value, uri) != 0)
+						break;
+					uriOK = true;
+				} else if (!strcmp(text_buf.get(), "Thumb::MTime")) {
+					if (strcmp(value, mtime_str) != 0)
+						break;
+					mtimeOK = true;
+				}
+			}
+		}
+
+		if (file->seek(next_chunk) != 0)
+			break;
+	}
+
+	file->unref();
+	return (uriOK && mtimeOK);
+}
+
+/**
+ * Look up a valid thumbnail in the XDG thumbnail cache.
+ *
+ * If a valid thumbnail is found, it's copied to output_file,
+ * unless output_file is the cached thumbnail itself.
+ *
+ * @param uri Source file URI.
+ * @param mtime Source file modification time.
+ * @param reqSize Requested thumbnail size.
+ * @param output_file Output file.
+ * @return 0 if output_file now contains a valid thumbnail; negative POSIX error code if not.
+ */
+int getValidThumbnail(const char *uri, int64_t mtime, int reqSize, const char *output_file)
+{
+	assert(output_file != nullptr);
+	if (!output_file || output_file[0] == '\0')
+		return -EINVAL;
+
+	const string thumb_filename = getThumbnailFilename(uri, reqSize);
+	if (thumb_filename.empty())
+		return -ENOTSUP;
+	if (!isThumbnailValid(thumb_filename.c_str(), uri, mtime))
+		return -ENOENT;
+
+	if (thumb_filename == output_file) {
+		// Thumbnailer is writing directly to the cache,
+		// and the cached thumbnail is still valid.
+		return 0;
+	}
+
+	// Copy the cached thumbnail to the output file.
+	// Thumbnails are small, so read it all at once.
+	RpFile *const srcFile = new RpFile(thumb_filename, RpFile::FM_OPEN_READ);
+	if (!srcFile->isOpen()) {
+		const int err = srcFile->lastError();
+		srcFile->unref();
+		return (err != 0 ? -err : -EIO);
+	}
+	const off64_t fileSize = srcFile->size();
+	if (fileSize <= 0 || fileSize > 16*1024*1024) {
+		// Thumbnail is empty or too big.
+		srcFile->unref();
+		return -EIO;
+	}
+	unique_ptr<uint8_t[]> data(new uint8_t[static_cast<size_t>(fileSize)]);
+	const size_t size = srcFile->read(data.get(), static_cast<size_t>(fileSize));
+	srcFile->unref();
+	if (size != static_cast<size_t>(fileSize))
+		return -EIO;
+
+	RpFile *const destFile = new RpFile(output_file, RpFile::FM_CREATE_WRITE);
+	if (!destFile->isOpen()) {
+		const int err = destFile->lastError();
+		destFile->unref();
+		return (err != 0 ? -err : -EIO);
+	}
+	const size_t written = destFile->write(data.get(), size);
+	destFile->unref();
+	return (written == size ? 0 : -EIO);
+}
+
+} }
@@ -0,0 +1,60 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * XdgThumbnailCache.hpp: XDG thumbnail cache lookup.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_IMG_XDGTHUMBNAILCACHE_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_IMG_XDGTHUMBNAILCACHE_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stdint.h>
+
+// C++ includes.
+#include <string>
+
+namespace LibRomData { namespace XdgThumbnailCache {
+
+/**
+ * Get the filename of a thumbnail in the XDG thumbnail cache.
+ *
+ * Only the standard thumbnail sizes are supported:
+ * 128 (normal), 256 (large), 512 (x-large), and 1024 (xx-large).
+ *
+ * @param uri Source file URI, as written to Thumb::URI.
+ * @param reqSize Requested thumbnail size.
+ * @return Thumbnail filename, or empty string if not available.
+ */
+std::string getThumbnailFilename(const char *uri, int reqSize);
+
+/**
+ * Check if a cached thumbnail is valid for the specified source file.
+ * This checks Thumb::URI and Thumb::MTime without decoding the image.
+ * @param thumb_filename Thumbnail filename.
+ * @param uri Source file URI.
+ * @param mtime Source file modification time.
+ * @return True if the thumbnail is valid; false if not.
+ */
+bool isThumbnailValid(const char *thumb_filename, const char *uri, int64_t mtime);
+
+/**
+ * Look up a valid thumbnail in the XDG thumbnail cache.
+ *
+ * If a valid thumbnail is found, it's copied to output_file,
+ * unless output_file is the cached thumbnail itself.
+ *
+ * @param uri Source file URI.
+ * @param mtime Source file modification time.
+ * @param reqSize Requested thumbnail size.
+ * @param output_file Output file.
+ * @return 0 if output_file now contains a valid thumbnail; negative POSIX error code if not.
+ */
+int getValidThumbnail(const char *uri, int64_t mtime, int reqSize, const char *output_file);
+
+} }
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_IMG_XDGTHUMBNAILCACHE_HPP__ */
@@ -0,0 +1,296 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * NegativeDetectCacheTest.cpp: NegativeDetectCache tests.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpbase, librpfile
+#include "librpbase/RomData.hpp"
+#include "librpfile/RpFile.hpp"
+using LibRpBase::RomData;
+using LibRpFile::RpFile;
+
+// libromdata
+#include "RomDataFactory.hpp"
+
+// C includes.
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class NegativeDetectCacheTest : public ::testing::Test
+{
+	public:
+		static void SetUpTestCase(void);
+		static void TearDownTestCase(void);
+
+	protected:
+		void TearDown(void) final;
+
+	public:
+		/**
+		 * Write a test file in the temporary directory.
+		 * The file will be deleted when the test finishes.
+		 * @param name Filename, without the directory.
+		 * @param data File contents.
+		 * @return Full filename.
+		 */
+		string writeFile(const char *name, const vector<uint8_t> &data);
+
+		/**
+		 * Rename a test file.
+		 * @param oldName Full old filename.
+		 * @param name New filename, without the directory.
+		 * @return Full new filename, or an empty string on error.
+		 */
+		string renameFile(const string &oldName, const char *name);
+
+		/**
+		 * Run RomDataFactory::create() with the negative detection cache.
+		 * @param filename Full filename.
+		 * @return True if the file is supported; false if not.
+		 */
+		static bool isSupported(const string &filename);
+
+		/**
+		 * Get unsupported file data.
+		 * @param size File size.
+		 * @return Unsupported file data.
+		 */
+		static vector<uint8_t> unsupportedData(size_t size);
+
+	protected:
+		// Temporary cache directory. (XDG_CACHE_HOME)
+		static string ms_tmpDir;
+
+		// Test files to delete.
+		vector<string> m_tmpFiles;
+};
+
+string NegativeDetectCacheTest::ms_tmpDir;
+
+void NegativeDetectCacheTest::SetUpTestCase(void)
+{
+	// Use a temporary cache directory.
+	// NOTE: The cache directory is only determined once per process,
+	// so this must be set before the cache is used.
+	char tmpl[] = "/tmp/rpNegativeDetectCacheTest.XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(tmpl));
+	ms_tmpDir = tmpl;
+	ASSERT_EQ(0, setenv("XDG_CACHE_HOME", tmpl, 1));
+}
+
+void NegativeDetectCacheTest::TearDownTestCase(void)
+{
+	const string cacheDir = ms_tmpDir + "/rom-properties";
+	unlink((cacheDir + "/negdetect.bin").c_str());
+	rmdir(cacheDir.c_str());
+	rmdir(ms_tmpDir.c_str());
+	unsetenv("XDG_CACHE_HOME");
+}
+
+void NegativeDetectCacheTest::TearDown(void)
+{
+	for (const string &filename : m_tmpFiles) {
+		unlink(filename.c_str());
+	}
+	m_tmpFiles.clear();
+}
+
+/**
+ * Write a test file in the temporary directory.
+ * The file will be deleted when the test finishes.
+ * @param name Filename, without the directory.
+ * @param data File contents.
+ * @return Full filename.
+ */
+string NegativeDetectCacheTest::writeFile(const char *name, const vector<uint8_t> &data)
+{
+	string filename = ms_tmpDir;
+	filename += '/';
+	filename += name;
+	m_tmpFiles.emplace_back(filename);
+
+	FILE *f = fopen(filename.c_str(), "wb");
+	EXPECT_TRUE(f != nullptr) << filename;
+	if (!f) {
+		return filename;
+	}
+	EXPECT_EQ(data.size(), fwrite(data.data(), 1, data.size(), f)) << filename;
+	fclose(f);
+	return filename;
+}
+
+/**
+ * Rename a test file.
+ * @param oldName Full old filename.
+ * @param name New filename, without the directory.
+ * @return Full new filename, or an empty string on error.
+ */
+string NegativeDetectCacheTest::renameFile(const string &oldName, const char *name)
+{
+	string filename = ms_tmpDir;
+	filename += '/';
+	filename += name;
+	if (rename(oldName.c_str(), filename.c_str()) != 0) {
+		return string();
+	}
+	m_tmpFiles.emplace_back(filename);
+	return filename;
+}
+
+/**
+ * Run RomDataFactory::create() with the negative detection cache.
+ * @param filename Full filename.
+ * @return True if the file is supported; false if not.
+ */
+bool NegativeDetectCacheTest::isSupported(const string &filename)
+{
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	EXPECT_TRUE(file->isOpen()) << filename;
+	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_NEG_CACHE);
+	file->unref();
+
+	const bool ret = (romData != nullptr);
+	UNREF(romData);
+	return ret;
+}
+
+/**
+ * Get unsupported file data.
+ * @param size File size.
+ * @return Unsupported file data.
+ */
+vector<uint8_t> NegativeDetectCacheTest::unsupportedData(size_t size)
+{
+	vector<uint8_t> data(size);
+	uint32_t seed = 0x5EED1234U;
+	for (size_t i = 0; i < size; i++) {
+		seed = (seed * 1664525U) + 1013904223U;
+		data[i] = static_cast<uint8_t>(seed >> 24);
+	}
+	return data;
+}
+
+/**
+ * An unsupported file is cached, and a supported file isn't.
+ */
+TEST_F(NegativeDetectCacheTest, unsupportedFileIsCached)
+{
+	const string filename = writeFile("unsupported.bin", unsupportedData(0x8000));
+	EXPECT_FALSE(RomDataFactory::isKnownUnsupported(filename.c_str()));
+	EXPECT_FALSE(isSupported(filename));
+	EXPECT_TRUE(RomDataFactory::isKnownUnsupported(filename.c_str()));
+	// A cached file is still reported as unsupported.
+	EXPECT_FALSE(isSupported(filename));
+
+	// iNES header: 2 PRG banks, 1 CHR bank, mapper 0.
+	vector<uint8_t> nesData = unsupportedData(0x8000 + 0x2000 + 16);
+	static const uint8_t ines_header[16] = {
+		'N','E','S',0x1A, 2, 1, 0x00, 0x00,
+		0,0,0,0, 0,0,0,0,
+	};
+	memcpy(nesData.data(), ines_header, sizeof(ines_header));
+	const string nesFilename = writeFile("supported.nes", nesData);
+	EXPECT_TRUE(isSupported(nesFilename));
+	EXPECT_FALSE(RomDataFactory::isKnownUnsupported(nesFilename.c_str()));
+}
+
+/**
+ * Renaming a file invalidates its entry, since
+ * RomData subclasses may check the file extension.
+ */
+TEST_F(NegativeDetectCacheTest, renameInvalidates)
+{
+	const string filename = writeFile("rename.bin", unsupportedData(0x8000));
+	EXPECT_FALSE(isSupported(filename));
+	EXPECT_TRUE(RomDataFactory::isKnownUnsupported(filename.c_str()));
+
+	const string newFilename = renameFile(filename, "rename.iso");
+	ASSERT_FALSE(newFilename.empty());
+	EXPECT_FALSE(RomDataFactory::isKnownUnsupported(newFilename.c_str()));
+
+	// Renaming it back restores the entry.
+	ASSERT_EQ(filename, renameFile(newFilename, "rename.bin"));
+	EXPECT_TRUE(RomDataFactory::isKnownUnsupported(filename.c_str()));
+}
+
+/**
+ * Changing a file's size invalidates its entry.
+ */
+TEST_F(NegativeDetectCacheTest, sizeChangeInvalidates)
+{
+	const string filename = writeFile("size.bin", unsupportedData(0x8000));
+	EXPECT_FALSE(isSupported(filename));
+	EXPECT_TRUE(RomDataFactory::isKnownUnsupported(filename.c_str()));
+
+	// Keep the original mtime so only the size changes.
+	struct stat sb;
+	ASSERT_EQ(0, stat(filename.c_str(), &sb));
+	FILE *f = fopen(filename.c_str(), "ab");
+	ASSERT_TRUE(f != nullptr);
+	EXPECT_EQ(1U, fwrite("X", 1, 1, f));
+	fclose(f);
+	const struct timespec times[2] = {sb.st_atim, sb.st_mtim};
+	ASSERT_EQ(0, utimensat(AT_FDCWD, filename.c_str(), times, 0));
+
+	EXPECT_FALSE(RomDataFactory::isKnownUnsupported(filename.c_str()));
+}
+
+/**
+ * Changing a file's mtime invalidates its entry.
+ */
+TEST_F(NegativeDetectCacheTest, mtimeChangeInvalidates)
+{
+	const string filename = writeFile("mtime.bin", unsupportedData(0x8000));
+	EXPECT_FALSE(isSupported(filename));
+	EXPECT_TRUE(RomDataFactory::isKnownUnsupported(filename.c_str()));
+
+	struct stat sb;
+	ASSERT_EQ(0, stat(filename.c_str(), &sb));
+	struct timespec times[2] = {sb.st_atim, sb.st_mtim};
+	times[1].tv_sec -= 3600;
+	ASSERT_EQ(0, utimensat(AT_FDCWD, filename.c_str(), times, 0));
+	EXPECT_FALSE(RomDataFactory::isKnownUnsupported(filename.c_str()));
+
+	// Restoring the original mtime restores the entry.
+	times[1] = sb.st_mtim;
+	ASSERT_EQ(0, utimensat(AT_FDCWD, filename.c_str(), times, 0));
+	EXPECT_TRUE(RomDataFactory::isKnownUnsupported(filename.c_str()));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: NegativeDetectCache tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,271 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * RomDataFactoryTest.cpp: RomDataFactory tests.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpbase, librpfile
+#include "librpbase/RomData.hpp"
+#include "librpfile/RpMemFile.hpp"
+using namespace LibRpBase;
+using LibRpFile::IRpFile;
+using LibRpFile::RpMemFile;
+
+// libromdata
+#include "RomDataFactory.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class RomDataFactoryTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Number of test files.
+		static const unsigned int FILE_COUNT = 96;
+
+		/**
+		 * Result of creating a RomData object for a file.
+		 */
+		struct Result {
+			unsigned int callCount;	// Number of callbacks for this file
+			string className;	// RomData class name, or empty if not supported
+			bool isValid;		// RomData::isValid()
+		};
+
+		/**
+		 * Get the result for a RomData object.
+		 * @param result	[out] Result
+		 * @param romData	[in] RomData object, or nullptr if not supported
+		 */
+		static void setResult(Result &result, const RomData *romData)
+		{
+			result.callCount++;
+			if (romData) {
+				result.className = romData->className();
+				result.isValid = romData->isValid();
+			} else {
+				result.className.clear();
+				result.isValid = false;
+			}
+		}
+
+		/**
+		 * createBatch() callback.
+		 * @param userdata	[in] vector<Result>
+		 * @param index		[in] File index
+		 * @param romData	[in] RomData object, or nullptr if not supported
+		 */
+		static void batchCallback(void *userdata, size_t index, RomData *romData)
+		{
+			vector<Result> *const results = static_cast<vector<Result>*>(userdata);
+			ASSERT_LT(index, results->size());
+			setResult((*results)[index], romData);
+			UNREF(romData);
+		}
+
+		/**
+		 * Run createBatch() and compare the results to create().
+		 * @param threads Number of threads
+		 */
+		void checkBatch(unsigned int threads);
+
+	protected:
+		vector<vector<uint8_t> > m_fileData;	// Test file contents
+		vector<IRpFile*> m_files;		// One RpMemFile per test file
+		vector<Result> m_expected;		// Results from create()
+};
+
+const unsigned int RomDataFactoryTest::FILE_COUNT;
+
+void RomDataFactoryTest::SetUp(void)
+{
+	// Test files: NES ROMs, Mega Drive ROMs, and random data.
+	m_fileData.resize(FILE_COUNT);
+	uint32_t seed = 0x600DF00DU;
+	for (unsigned int i = 0; i < FILE_COUNT; i++) {
+		vector<uint8_t> &data = m_fileData[i];
+		data.resize(0x10000 + (i * 0x100));
+		for (size_t j = 0; j < data.size(); j++) {
+			seed = (seed * 1664525U) + 1013904223U;
+			data[j] = static_cast<uint8_t>(seed >> 24);
+		}
+
+		switch (i % 3) {
+			case 0: {
+				// iNES header: 2 PRG banks, 1 CHR bank, mapper 0.
+				static const uint8_t ines_header[16] = {
+					'N','E','S',0x1A, 2, 1, 0x00, 0x00,
+					0,0,0,0, 0,0,0,0,
+				};
+				memcpy(data.data(), ines_header, sizeof(ines_header));
+				break;
+			}
+			case 1:
+				// Mega Drive header.
+				memcpy(&data[0x100], "SEGA MEGA DRIVE ", 16);
+				break;
+			default:
+				// Random data. Make sure it doesn't look like
+				// an iNES header by accident.
+				data[0] = 0;
+				break;
+		}
+	}
+
+	m_expected.resize(FILE_COUNT);
+	for (unsigned int i = 0; i < FILE_COUNT; i++) {
+		m_files.push_back(new RpMemFile(m_fileData[i].data(), m_fileData[i].size()));
+
+		// Serial results.
+		RpMemFile *const file = new RpMemFile(m_fileData[i].data(), m_fileData[i].size());
+		RomData *const romData = RomDataFactory::create(file);
+		m_expected[i].callCount = 0;
+		setResult(m_expected[i], romData);
+		UNREF(romData);
+		file->unref();
+	}
+}
+
+void RomDataFactoryTest::TearDown(void)
+{
+	for (IRpFile *file : m_files) {
+		file->unref();
+	}
+	m_files.clear();
+}
+
+/**
+ * Run createBatch() and compare the results to create().
+ * @param threads Number of threads
+ */
+void RomDataFactoryTest::checkBatch(unsigned int threads)
+{
+	// Sanity check: Both supported and unsupported files are present.
+	unsigned int supported = 0;
+	for (const Result &result : m_expected) {
+		if (!result.className.empty()) {
+			supported++;
+		}
+	}
+	ASSERT_GT(supported, 0U);
+	ASSERT_LT(supported, FILE_COUNT);
+
+	vector<Result> results(FILE_COUNT);
+	for (Result &result : results) {
+		result.callCount = 0;
+		result.isValid = false;
+	}
+
+	ASSERT_EQ(0, RomDataFactory::createBatch(m_files, 0, threads, batchCallback, &results));
+	for (unsigned int i = 0; i < FILE_COUNT; i++) {
+		EXPECT_EQ(1U, results[i].callCount) << "index == " << i;
+		EXPECT_EQ(m_expected[i].className, results[i].className) << "index == " << i;
+		EXPECT_EQ(m_expected[i].isValid, results[i].isValid) << "index == " << i;
+	}
+}
+
+/**
+ * createBatch() on the calling thread only.
+ */
+TEST_F(RomDataFactoryTest, createBatchSingleThread)
+{
+	ASSERT_NO_FATAL_FAILURE(checkBatch(1));
+}
+
+/**
+ * createBatch() with a local thread pool.
+ */
+TEST_F(RomDataFactoryTest, createBatchMultiThread)
+{
+	ASSERT_NO_FATAL_FAILURE(checkBatch(4));
+}
+
+/**
+ * createBatch() with the process-wide thread pool.
+ */
+TEST_F(RomDataFactoryTest, createBatchThreadPool)
+{
+	ASSERT_NO_FATAL_FAILURE(checkBatch(0));
+}
+
+/**
+ * createBatch() with filenames instead of IRpFile objects.
+ */
+TEST_F(RomDataFactoryTest, createBatchFilenames)
+{
+	// Write the test files to the current directory.
+	vector<string> filenames;
+	filenames.reserve(FILE_COUNT);
+	for (unsigned int i = 0; i < FILE_COUNT; i++) {
+		char filename[64];
+		snprintf(filename, sizeof(filename), "RomDataFactoryTest.%02u.bin", i);
+		FILE *f = fopen(filename, "wb");
+		ASSERT_TRUE(f != nullptr) << filename;
+		filenames.push_back(filename);
+		const size_t size = fwrite(m_fileData[i].data(), 1, m_fileData[i].size(), f);
+		fclose(f);
+		ASSERT_EQ(m_fileData[i].size(), size) << filename;
+	}
+
+	vector<Result> results(FILE_COUNT);
+	for (Result &result : results) {
+		result.callCount = 0;
+		result.isValid = false;
+	}
+	EXPECT_EQ(0, RomDataFactory::createBatch(filenames, 0, 4, batchCallback, &results));
+	for (const string &filename : filenames) {
+		remove(filename.c_str());
+	}
+
+	for (unsigned int i = 0; i < FILE_COUNT; i++) {
+		EXPECT_EQ(1U, results[i].callCount) << "index == " << i;
+		EXPECT_EQ(m_expected[i].className, results[i].className) << "index == " << i;
+		EXPECT_EQ(m_expected[i].isValid, results[i].isValid) << "index == " << i;
+	}
+}
+
+/**
+ * createBatch() with an empty list of files.
+ */
+TEST_F(RomDataFactoryTest, createBatchEmpty)
+{
+	vector<Result> results;
+	const vector<IRpFile*> files;
+	EXPECT_EQ(0, RomDataFactory::createBatch(files, 0, 4, batchCallback, &results));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: RomDataFactory tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -129,6 +129,12 @@ class GcnFstTest : public ::testing::TestWithParam<GcnFstTest_mode>
 		 */
 		void checkNoDuplicateFilenames(const char *subdir);
 
+		/**
+		 * Recursively verify that find_file() matches readdir().
+		 * @param subdir Subdirectory path.
+		 */
+		void checkFindFile(const string &subdir);
+
 	public:
 		/** Test case parameters. **/
 
@@ -376,6 +382,50 @@ void GcnFstTest::checkNoDuplicateFilenames(const char *subdir)
 	m_fst->closedir(dirp);
 }
 
+/**
+ * Recursively verify that find_file() matches readdir().
+ * @param subdir Subdirectory path.
+ */
+void GcnFstTest::checkFindFile(const string &subdir)
+{
+	vector<string> subdirs;
+
+	IFst::Dir *dirp = m_fst->opendir(subdir);
+	ASSERT_TRUE(dirp != nullptr) <<
+		"Failed to open directory '" << subdir << "'.";
+
+	IFst::DirEnt *dirent = m_fst->readdir(dirp);
+	while (dirent != nullptr) {
+		string path = subdir;
+		if (path[path.size()-1] != '/') {
+			path += '/';
+		}
+		path += dirent->name;
+
+		IFst::DirEnt found;
+		EXPECT_EQ(0, m_fst->find_file(path.c_str(), &found)) <<
+			"Failed to find '" << path << "'.";
+		EXPECT_EQ(dirent->type, found.type) << "Path: '" << path << "'";
+		EXPECT_EQ(dirent->offset, found.offset) << "Path: '" << path << "'";
+		EXPECT_EQ(dirent->size, found.size) << "Path: '" << path << "'";
+
+		if (dirent->type == DT_DIR) {
+			subdirs.emplace_back(std::move(path));
+		}
+
+		// Next entry.
+		dirent = m_fst->readdir(dirp);
+	}
+
+	// End of directory.
+	m_fst->closedir(dirp);
+
+	// Check subdirectories.
+	for (const string &path : subdirs) {
+		checkFindFile(path);
+	}
+}
+
 /**
  * Verify that '/' is collapsed correctly.
  */
@@ -400,6 +450,35 @@ TEST_P(GcnFstTest, NoDuplicateFilenames)
 	EXPECT_FALSE(m_fst->hasErrors());
 }
 
+/**
+ * Verify that the path index returns the same entries as readdir().
+ */
+TEST_P(GcnFstTest, PathIndex)
+{
+	ASSERT_EQ(0, m_fst->buildPathIndex());
+	ASSERT_NO_FATAL_FAILURE(checkFindFile("/"));
+
+	// Empty path components and trailing slashes should be ignored.
+	IFst::Dir *dirp = m_fst->opendir("/");
+	ASSERT_TRUE(dirp != nullptr);
+	IFst::DirEnt *dirent = m_fst->readdir(dirp);
+	while (dirent != nullptr) {
+		if (dirent->type == DT_DIR) {
+			const string path = string("//") + dirent->name + "//";
+			IFst::DirEnt found;
+			EXPECT_EQ(0, m_fst->find_file(path.c_str(), &found)) <<
+				"Failed to find '" << path << "'.";
+			EXPECT_EQ(DT_DIR, found.type) << "Path: '" << path << "'";
+		}
+		dirent = m_fst->readdir(dirp);
+	}
+	m_fst->closedir(dirp);
+
+	// Nonexistent paths.
+	IFst::DirEnt found;
+	EXPECT_EQ(-ENOENT, m_fst->find_file("/rom-properties-nonexistent", &found));
+}
+
 /**
  * Print the FST directory structure and compare it to a known-good version.
  */
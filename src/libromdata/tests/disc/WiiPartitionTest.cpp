@@ -0,0 +1,308 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * WiiPartitionTest.cpp: WiiPartition tests.                               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpbase, librpcpu, librpfile
+#include "librpbase/disc/DiscReader.hpp"
+#include "librpcpu/byteswap_rp.h"
+#include "librpfile/RpMemFile.hpp"
+using namespace LibRpBase;
+using LibRpFile::RpMemFile;
+
+// libromdata
+#include "disc/WiiPartition.hpp"
+#include "Console/wii_structs.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * DiscReader that counts read requests.
+ */
+class CountingDiscReader : public DiscReader
+{
+	public:
+		explicit CountingDiscReader(LibRpFile::IRpFile *file)
+			: super(file)
+			, readCount(0)
+			, bytesRead(0)
+		{ }
+
+	private:
+		typedef DiscReader super;
+		RP_DISABLE_COPY(CountingDiscReader)
+
+	public:
+		size_t read(void *ptr, size_t size) final
+		{
+			readCount++;
+			bytesRead += size;
+			return super::read(ptr, size);
+		}
+
+	public:
+		size_t readCount;	// Number of read requests
+		size_t bytesRead;	// Number of bytes requested
+};
+
+/**
+ * The partition is unencrypted, since the Wii keys aren't
+ * available to the test suite. This still exercises the
+ * sector cache and the multi-sector read path.
+ */
+class WiiPartitionTest : public ::testing::TestWithParam<WiiPartition::CryptoMethod>
+{
+	protected:
+		WiiPartitionTest()
+			: m_file(nullptr)
+			, m_discReader(nullptr)
+			, m_partition(nullptr)
+		{ }
+
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Partition layout.
+		static const unsigned int PARTITION_OFFSET = 0x50000;
+		static const unsigned int DATA_OFFSET = 0x20000;
+		static const unsigned int SECTOR_SIZE = 0x8000;
+		static const unsigned int SECTOR_COUNT = 160;
+
+		/**
+		 * Read from the partition and compare to the expected data.
+		 * @param pos Position
+		 * @param size Size
+		 * @param useReadAt If true, use readAt(); otherwise, use seek() and read().
+		 */
+		void checkRead(size_t pos, size_t size, bool useReadAt);
+
+	protected:
+		vector<uint8_t> m_image;	// Disc image
+		vector<uint8_t> m_expected;	// Expected partition data
+		unsigned int m_sectorDataSize;	// Amount of data in each sector
+
+		RpMemFile *m_file;
+		CountingDiscReader *m_discReader;
+		WiiPartition *m_partition;
+};
+
+const unsigned int WiiPartitionTest::PARTITION_OFFSET;
+const unsigned int WiiPartitionTest::DATA_OFFSET;
+const unsigned int WiiPartitionTest::SECTOR_SIZE;
+const unsigned int WiiPartitionTest::SECTOR_COUNT;
+
+void WiiPartitionTest::SetUp(void)
+{
+	const WiiPartition::CryptoMethod cryptoMethod = GetParam();
+	const bool is32K = ((cryptoMethod & WiiPartition::CM_MASK_SECTOR) == WiiPartition::CM_32K);
+	m_sectorDataSize = (is32K ? SECTOR_SIZE : 0x7C00);
+	const unsigned int sectorDataOffset = SECTOR_SIZE - m_sectorDataSize;
+
+	// Random data, including the hash areas.
+	m_image.resize(PARTITION_OFFSET + DATA_OFFSET + (SECTOR_COUNT * SECTOR_SIZE));
+	uint32_t seed = 0x2468ACE0U;
+	for (size_t i = 0; i < m_image.size(); i++) {
+		seed = (seed * 1664525U) + 1013904223U;
+		m_image[i] = static_cast<uint8_t>(seed >> 24);
+	}
+
+	// Partition header.
+	RVL_PartitionHeader *const pHdr = reinterpret_cast<RVL_PartitionHeader*>(&m_image[PARTITION_OFFSET]);
+	memset(pHdr, 0, sizeof(*pHdr));
+	pHdr->ticket.signature_type = cpu_to_be32(RVL_SIGNATURE_TYPE_RSA2048);
+	pHdr->data_offset = cpu_to_be32(DATA_OFFSET >> 2);
+	pHdr->data_size = cpu_to_be32((SECTOR_COUNT * SECTOR_SIZE) >> 2);
+
+	// Expected partition data: The data area of each sector.
+	m_expected.resize(SECTOR_COUNT * m_sectorDataSize);
+	const uint8_t *src = &m_image[PARTITION_OFFSET + DATA_OFFSET + sectorDataOffset];
+	for (unsigned int i = 0; i < SECTOR_COUNT; i++, src += SECTOR_SIZE) {
+		memcpy(&m_expected[i * m_sectorDataSize], src, m_sectorDataSize);
+	}
+
+	m_file = new RpMemFile(m_image.data(), m_image.size());
+	m_discReader = new CountingDiscReader(m_file);
+	ASSERT_TRUE(m_discReader->isOpen());
+	m_partition = new WiiPartition(m_discReader, PARTITION_OFFSET,
+		m_image.size() - PARTITION_OFFSET, cryptoMethod);
+	ASSERT_TRUE(m_partition->isOpen());
+	EXPECT_EQ(KeyManager::VerifyResult::OK, m_partition->verifyResult());
+
+	// Don't count the partition header reads.
+	m_discReader->readCount = 0;
+	m_discReader->bytesRead = 0;
+}
+
+void WiiPartitionTest::TearDown(void)
+{
+	UNREF_AND_NULL(m_partition);
+	UNREF_AND_NULL(m_discReader);
+	UNREF_AND_NULL(m_file);
+}
+
+/**
+ * Read from the partition and compare to the expected data.
+ * @param pos Position
+ * @param size Size
+ * @param useReadAt If true, use readAt(); otherwise, use seek() and read().
+ */
+void WiiPartitionTest::checkRead(size_t pos, size_t size, bool useReadAt)
+{
+	ASSERT_LE(pos + size, m_expected.size());
+
+	unique_ptr<uint8_t[]> buf(new uint8_t[size > 0 ? size : 1]);
+	size_t sz_read;
+	if (useReadAt) {
+		sz_read = m_partition->readAt(static_cast<off64_t>(pos), buf.get(), size);
+	} else {
+		ASSERT_EQ(0, m_partition->seek(static_cast<off64_t>(pos)));
+		sz_read = m_partition->read(buf.get(), size);
+	}
+	ASSERT_EQ(size, sz_read) << "pos == " << pos << ", size == " << size;
+	if (size > 0) {
+		ASSERT_EQ(0, memcmp(buf.get(), &m_expected[pos], size))
+			<< "pos == " << pos << ", size == " << size;
+	}
+}
+
+/**
+ * Random-offset reads must match a plain read of the sector data.
+ */
+TEST_P(WiiPartitionTest, randomReads)
+{
+	uint32_t seed = 0x0F1E2D3CU;
+	for (unsigned int i = 0; i < 2048; i++) {
+		seed = (seed * 1664525U) + 1013904223U;
+		// Mostly reads within a sector or two,
+		// with some multi-sector reads.
+		size_t size = (i % 16 == 0)
+			? seed % (m_sectorDataSize * 8)
+			: seed % (m_sectorDataSize + 4096);
+		seed = (seed * 1664525U) + 1013904223U;
+		const size_t pos = seed % (m_expected.size() - size + 1);
+		ASSERT_NO_FATAL_FAILURE(checkRead(pos, size, (i & 1)));
+	}
+	EXPECT_EQ(0, m_partition->lastError());
+}
+
+/**
+ * Read the entire partition sequentially with odd chunk sizes.
+ */
+TEST_P(WiiPartitionTest, sequentialRead)
+{
+	static const size_t chunkSizes[] = {1, 4095, 0x7C00, 0x8000, 0x10001, 0x3E000 + 3};
+
+	ASSERT_EQ(0, m_partition->seek(0));
+	vector<uint8_t> buf(m_expected.size());
+	size_t total = 0;
+	for (unsigned int i = 0; total < buf.size(); i++) {
+		size_t chunkSize = chunkSizes[i % ARRAY_SIZE(chunkSizes)];
+		if (chunkSize > buf.size() - total) {
+			chunkSize = buf.size() - total;
+		}
+		ASSERT_EQ(chunkSize, m_partition->read(&buf[total], chunkSize)) << "pos == " << total;
+		total += chunkSize;
+	}
+	EXPECT_EQ(static_cast<off64_t>(total), m_partition->tell());
+	EXPECT_EQ(0, memcmp(buf.data(), m_expected.data(), m_expected.size()));
+}
+
+/**
+ * Interleaved reads from a few sectors are served from
+ * the sector cache after each sector is read once.
+ */
+TEST_P(WiiPartitionTest, sectorCacheInterleaved)
+{
+	// Reads must be larger than readSectorPartial()'s limit
+	// in order to go through the sector cache.
+	static const size_t readOffset = 0x100;
+	static const size_t readSize = 0x2000;
+	static const unsigned int sectors[] = {3, 17, 4, 90};
+
+	for (unsigned int sector : sectors) {
+		ASSERT_NO_FATAL_FAILURE(checkRead((sector * m_sectorDataSize) + readOffset, readSize, false));
+	}
+	EXPECT_EQ(ARRAY_SIZE(sectors), m_discReader->readCount);
+
+	// All four sectors should now be cached.
+	m_discReader->readCount = 0;
+	for (unsigned int i = 0; i < 4; i++) {
+		for (unsigned int sector : sectors) {
+			ASSERT_NO_FATAL_FAILURE(checkRead((sector * m_sectorDataSize) + readOffset + (i * 16), readSize, (i & 1)));
+		}
+	}
+	EXPECT_EQ(0U, m_discReader->readCount);
+
+	// A fifth sector evicts the least recently used sector. (3)
+	ASSERT_NO_FATAL_FAILURE(checkRead((50 * m_sectorDataSize) + readOffset, readSize, false));
+	EXPECT_EQ(1U, m_discReader->readCount);
+	ASSERT_NO_FATAL_FAILURE(checkRead((90 * m_sectorDataSize) + readOffset, readSize, false));
+	EXPECT_EQ(1U, m_discReader->readCount);
+	ASSERT_NO_FATAL_FAILURE(checkRead((3 * m_sectorDataSize) + readOffset, readSize, false));
+	EXPECT_EQ(2U, m_discReader->readCount);
+}
+
+/**
+ * Reads of multiple full sectors are done with one
+ * disc read per SECTOR_BATCH_COUNT (64) sectors.
+ */
+TEST_P(WiiPartitionTest, multiSectorRead)
+{
+	// 10 sectors: One disc read.
+	ASSERT_NO_FATAL_FAILURE(checkRead(5 * m_sectorDataSize, 10 * m_sectorDataSize, false));
+	EXPECT_EQ(1U, m_discReader->readCount);
+	EXPECT_EQ(10U * SECTOR_SIZE, m_discReader->bytesRead);
+
+	// 150 sectors: Three disc reads for unencrypted 31K sectors,
+	// since they're read in batches. 32K sectors are read directly.
+	m_discReader->readCount = 0;
+	m_discReader->bytesRead = 0;
+	ASSERT_NO_FATAL_FAILURE(checkRead(2 * m_sectorDataSize, 150 * m_sectorDataSize, true));
+	const bool is32K = ((GetParam() & WiiPartition::CM_MASK_SECTOR) == WiiPartition::CM_32K);
+	EXPECT_EQ((is32K ? 1U : 3U), m_discReader->readCount);
+	EXPECT_EQ(150U * SECTOR_SIZE, m_discReader->bytesRead);
+
+	// Unaligned start and end: The partial sectors at
+	// either end are read separately.
+	m_discReader->readCount = 0;
+	ASSERT_NO_FATAL_FAILURE(checkRead((20 * m_sectorDataSize) + 0x1234, (8 * m_sectorDataSize) + 0x2345, false));
+	EXPECT_EQ(3U, m_discReader->readCount);
+}
+
+INSTANTIATE_TEST_SUITE_P(WiiPartition, WiiPartitionTest,
+	::testing::Values(WiiPartition::CM_NASOS, WiiPartition::CM_RVTH));
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: WiiPartition tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -32,6 +32,7 @@
 
 // librpbase, librpfile
 #include "common.h"
+#include "librpcpu/byteswap_rp.h"
 #include "librpbase/img/RpImageLoader.hpp"
 #include "librpfile/RpFile.hpp"
 #include "librpfile/RpMemFile.hpp"
@@ -42,6 +43,8 @@ using namespace LibRpFile;
 // librptexture
 #include "librptexture/img/rp_image.hpp"
 #include "librptexture/decoder/ImageDecoder.hpp"
+#include "librptexture/fileformat/dds_structs.h"
+#include "librptexture/fileformat/vtf_structs.h"
 using namespace LibRpTexture;
 
 // TODO: Separate out the actual DDS texture loader
@@ -1121,6 +1124,645 @@ INSTANTIATE_TEST_SUITE_P(BC7, ImageDecoderTest,
 			"BC7/w5_wood503_prm.png"))
 	, ImageDecoderTest::test_case_suffix_generator);
 
+#ifdef IMAGEDECODER_HAS_SSE41
+/**
+ * Verify that the SSE4.1 BC7 decoder is bit-exact
+ * with the standard decoder for all BC7 modes.
+ */
+TEST(ImageDecoderBC7Test, fromBC7_sse41_bitexact)
+{
+	if (!RP_CPU_HasSSE41()) {
+		fprintf(stderr, "*** SSE4.1 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	// Not a multiple of 4, so the last row and column of tiles are cut off.
+	static const int width = 62, height = 62;
+	static const unsigned int blockCount = (64 / 4) * (64 / 4);
+	ao::uvector<uint8_t> bc7_buf(blockCount * 16);
+
+	// Pseudo-random block data. (LCG from Numerical Recipes)
+	uint32_t seed = 0x12345678;
+	for (unsigned int mode = 0; mode < 8; mode++) {
+		for (unsigned int i = 0; i < bc7_buf.size(); i++) {
+			seed = (seed * 1664525U) + 1013904223U;
+			bc7_buf[i] = static_cast<uint8_t>(seed >> 24);
+		}
+		for (unsigned int i = 0; i < blockCount; i++) {
+			// Set the mode bit and clear the bits below it.
+			uint8_t &b = bc7_buf[i * 16];
+			b = (b & ~((2U << mode) - 1)) | (1U << mode);
+		}
+
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_cpp(
+			ImageDecoder::fromBC7_cpp(width, height, bc7_buf.data(), static_cast<int>(bc7_buf.size())),
+			RpImageUnrefDeleter());
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_sse41(
+			ImageDecoder::fromBC7_sse41(width, height, bc7_buf.data(), static_cast<int>(bc7_buf.size())),
+			RpImageUnrefDeleter());
+		ASSERT_TRUE(img_cpp != nullptr) << "mode " << mode;
+		ASSERT_TRUE(img_sse41 != nullptr) << "mode " << mode;
+		SCOPED_TRACE(::testing::Message() << "mode " << mode);
+		ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::Compare_RpImage(img_cpp.get(), img_sse41.get()));
+	}
+}
+#endif /* IMAGEDECODER_HAS_SSE41 */
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Compare the SSSE3 S3TC decoders with the standard C++ decoders.
+ * Random block data is used to cover both palette modes.
+ */
+TEST(ImageDecoderS3TCTest, fromS3TC_ssse3_bitexact)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	typedef rp_image *(*pfnDecode_t)(int width, int height, const uint8_t *img_buf, int img_siz);
+	static const struct {
+		const char *name;
+		pfnDecode_t pfn_cpp;
+		pfnDecode_t pfn_ssse3;
+		unsigned int blockSize;
+	} decoders[] = {
+		{"DXT1",    ImageDecoder::fromDXT1_cpp,    ImageDecoder::fromDXT1_ssse3,     8},
+		{"DXT1_A1", ImageDecoder::fromDXT1_A1_cpp, ImageDecoder::fromDXT1_A1_ssse3,  8},
+		{"DXT5",    ImageDecoder::fromDXT5_cpp,    ImageDecoder::fromDXT5_ssse3,    16},
+		{"BC4",     ImageDecoder::fromBC4_cpp,     ImageDecoder::fromBC4_ssse3,      8},
+		{"BC5",     ImageDecoder::fromBC5_cpp,     ImageDecoder::fromBC5_ssse3,     16},
+	};
+
+	// Not a multiple of 4, so the last row and column of tiles are cut off.
+	// Also not a multiple of 16, so the SSSE3 DXT1/DXT5 decoders have to
+	// handle a partial group of blocks at the end of each row.
+	static const int width = 54, height = 54;
+	static const unsigned int blockCount = (56 / 4) * (56 / 4);
+
+	// Pseudo-random block data. (LCG from Numerical Recipes)
+	uint32_t seed = 0x12345678;
+	for (const auto &dec : decoders) {
+		ao::uvector<uint8_t> buf(blockCount * dec.blockSize);
+		for (unsigned int i = 0; i < buf.size(); i++) {
+			seed = (seed * 1664525U) + 1013904223U;
+			buf[i] = static_cast<uint8_t>(seed >> 24);
+		}
+
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_cpp(
+			dec.pfn_cpp(width, height, buf.data(), static_cast<int>(buf.size())),
+			RpImageUnrefDeleter());
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_ssse3(
+			dec.pfn_ssse3(width, height, buf.data(), static_cast<int>(buf.size())),
+			RpImageUnrefDeleter());
+		ASSERT_TRUE(img_cpp != nullptr) << dec.name;
+		ASSERT_TRUE(img_ssse3 != nullptr) << dec.name;
+		SCOPED_TRACE(dec.name);
+		ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::Compare_RpImage(img_cpp.get(), img_ssse3.get()));
+	}
+}
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Compare the SSSE3 GameCube 16-bit decoder with the standard C++ decoder.
+ * Random pixel data is used to cover both RGB5A3 pixel modes.
+ */
+TEST(ImageDecoderGCNTest, fromGcn16_ssse3_bitexact)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	static const struct {
+		const char *name;
+		ImageDecoder::PixelFormat px_format;
+	} formats[] = {
+		{"RGB5A3", ImageDecoder::PixelFormat::RGB5A3},
+		{"RGB565", ImageDecoder::PixelFormat::RGB565},
+		{"IA8",    ImageDecoder::PixelFormat::IA8},
+	};
+
+	// GameCube banner size.
+	static const int width = 96, height = 32;
+
+	// Pseudo-random pixel data. (LCG from Numerical Recipes)
+	uint32_t seed = 0x12345678;
+	for (const auto &fmt : formats) {
+		ao::uvector<uint16_t> buf(width * height);
+		for (unsigned int i = 0; i < buf.size(); i++) {
+			seed = (seed * 1664525U) + 1013904223U;
+			buf[i] = static_cast<uint16_t>(seed >> 16);
+		}
+		const int img_siz = static_cast<int>(buf.size() * sizeof(uint16_t));
+
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_cpp(
+			ImageDecoder::fromGcn16_cpp(fmt.px_format, width, height, buf.data(), img_siz),
+			RpImageUnrefDeleter());
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_ssse3(
+			ImageDecoder::fromGcn16_ssse3(fmt.px_format, width, height, buf.data(), img_siz),
+			RpImageUnrefDeleter());
+		ASSERT_TRUE(img_cpp != nullptr) << fmt.name;
+		ASSERT_TRUE(img_ssse3 != nullptr) << fmt.name;
+		SCOPED_TRACE(fmt.name);
+		ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::Compare_RpImage(img_cpp.get(), img_ssse3.get()));
+	}
+}
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#ifdef IMAGEDECODER_HAS_SSE2
+/**
+ * Compare the SSE2 Nintendo 3DS tiled decoders with the standard C++ decoders.
+ */
+TEST(ImageDecoderN3DSTest, fromN3DSTiled_sse2_bitexact)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	// Multiple tiles in both directions.
+	static const int width = 48, height = 24;
+
+	// Pseudo-random pixel data. (LCG from Numerical Recipes)
+	uint32_t seed = 0x12345678;
+	ao::uvector<uint16_t> img_buf(width * height);
+	for (unsigned int i = 0; i < img_buf.size(); i++) {
+		seed = (seed * 1664525U) + 1013904223U;
+		img_buf[i] = static_cast<uint16_t>(seed >> 16);
+	}
+	ao::uvector<uint8_t> alpha_buf((width * height) / 2);
+	for (unsigned int i = 0; i < alpha_buf.size(); i++) {
+		seed = (seed * 1664525U) + 1013904223U;
+		alpha_buf[i] = static_cast<uint8_t>(seed >> 24);
+	}
+	const int img_siz = static_cast<int>(img_buf.size() * sizeof(uint16_t));
+	const int alpha_siz = static_cast<int>(alpha_buf.size());
+
+	unique_ptr<rp_image, RpImageUnrefDeleter> img_cpp(
+		ImageDecoder::fromN3DSTiledRGB565_cpp(width, height, img_buf.data(), img_siz),
+		RpImageUnrefDeleter());
+	unique_ptr<rp_image, RpImageUnrefDeleter> img_sse2(
+		ImageDecoder::fromN3DSTiledRGB565_sse2(width, height, img_buf.data(), img_siz),
+		RpImageUnrefDeleter());
+	ASSERT_TRUE(img_cpp != nullptr);
+	ASSERT_TRUE(img_sse2 != nullptr);
+	{
+		SCOPED_TRACE("RGB565");
+		ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::Compare_RpImage(img_cpp.get(), img_sse2.get()));
+	}
+
+	img_cpp.reset(ImageDecoder::fromN3DSTiledRGB565_A4_cpp(width, height,
+		img_buf.data(), img_siz, alpha_buf.data(), alpha_siz));
+	img_sse2.reset(ImageDecoder::fromN3DSTiledRGB565_A4_sse2(width, height,
+		img_buf.data(), img_siz, alpha_buf.data(), alpha_siz));
+	ASSERT_TRUE(img_cpp != nullptr);
+	ASSERT_TRUE(img_sse2 != nullptr);
+	{
+		SCOPED_TRACE("RGB565_A4");
+		ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::Compare_RpImage(img_cpp.get(), img_sse2.get()));
+	}
+}
+#endif /* IMAGEDECODER_HAS_SSE2 */
+
+#ifdef IMAGEDECODER_HAS_SSE41
+/**
+ * Compare the SSE4.1 ETC1/ETC2 decoders with the standard C++ decoders.
+ * Random block data is used to cover all ETC2 block modes.
+ */
+TEST(ImageDecoderETCTest, fromETC_sse41_bitexact)
+{
+	if (!RP_CPU_HasSSE41()) {
+		fprintf(stderr, "*** SSE4.1 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	typedef rp_image *(*pfnDecode_t)(int width, int height, const uint8_t *img_buf, int img_siz);
+	static const struct {
+		const char *name;
+		pfnDecode_t pfn_cpp;
+		pfnDecode_t pfn_sse41;
+		unsigned int blockSize;
+	} decoders[] = {
+		{"ETC1",        ImageDecoder::fromETC1_cpp,        ImageDecoder::fromETC1_sse41,         8},
+		{"ETC2_RGB",    ImageDecoder::fromETC2_RGB_cpp,    ImageDecoder::fromETC2_RGB_sse41,     8},
+		{"ETC2_RGBA",   ImageDecoder::fromETC2_RGBA_cpp,   ImageDecoder::fromETC2_RGBA_sse41,   16},
+		{"ETC2_RGB_A1", ImageDecoder::fromETC2_RGB_A1_cpp, ImageDecoder::fromETC2_RGB_A1_sse41,  8},
+	};
+
+	static const int width = 64, height = 64;
+	static const unsigned int blockCount = (width / 4) * (height / 4);
+
+	// Pseudo-random block data. (LCG from Numerical Recipes)
+	uint32_t seed = 0x12345678;
+	for (const auto &dec : decoders) {
+		ao::uvector<uint8_t> buf(blockCount * dec.blockSize);
+		for (unsigned int i = 0; i < buf.size(); i++) {
+			seed = (seed * 1664525U) + 1013904223U;
+			buf[i] = static_cast<uint8_t>(seed >> 24);
+		}
+
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_cpp(
+			dec.pfn_cpp(width, height, buf.data(), static_cast<int>(buf.size())),
+			RpImageUnrefDeleter());
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_sse41(
+			dec.pfn_sse41(width, height, buf.data(), static_cast<int>(buf.size())),
+			RpImageUnrefDeleter());
+		ASSERT_TRUE(img_cpp != nullptr) << dec.name;
+		ASSERT_TRUE(img_sse41 != nullptr) << dec.name;
+		SCOPED_TRACE(dec.name);
+		ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::Compare_RpImage(img_cpp.get(), img_sse41.get()));
+	}
+}
+#endif /* IMAGEDECODER_HAS_SSE41 */
+
+#if defined(ENABLE_PVRTC) && defined(IMAGEDECODER_HAS_SSE2)
+/**
+ * Compare the SSE2 PVRTC/PVRTC-II decoders with the PowerVR Native SDK.
+ * Random word data is used to cover all color and modulation modes.
+ */
+TEST(ImageDecoderPVRTCTest, fromPVRTC_sse2_bitexact)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	typedef rp_image *(*pfnDecode_t)(int width, int height, const uint8_t *img_buf, int img_siz, uint8_t mode);
+	static const struct {
+		const char *name;
+		pfnDecode_t pfn_cpp;
+		pfnDecode_t pfn_sse2;
+		uint8_t mode;
+	} decoders[] = {
+		{"PVRTC_4bpp",   ImageDecoder::fromPVRTC_cpp,   ImageDecoder::fromPVRTC_sse2,
+			ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES},
+		{"PVRTC_2bpp",   ImageDecoder::fromPVRTC_cpp,   ImageDecoder::fromPVRTC_sse2,
+			ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES},
+		{"PVRTCII_4bpp", ImageDecoder::fromPVRTCII_cpp, ImageDecoder::fromPVRTCII_sse2,
+			ImageDecoder::PVRTC_4BPP},
+		{"PVRTCII_2bpp", ImageDecoder::fromPVRTCII_cpp, ImageDecoder::fromPVRTCII_sse2,
+			ImageDecoder::PVRTC_2BPP},
+	};
+
+	// Non-square, so the PVRTC-I Morton order has leftover bits.
+	static const int width = 128, height = 32;
+
+	// Pseudo-random word data. (LCG from Numerical Recipes)
+	uint32_t seed = 0x12345678;
+	for (const auto &dec : decoders) {
+		const bool is2bpp = ((dec.mode & ImageDecoder::PVRTC_BPP_MASK) == ImageDecoder::PVRTC_2BPP);
+		ao::uvector<uint8_t> buf((width * height) / (is2bpp ? 4 : 2));
+		for (unsigned int i = 0; i < buf.size(); i++) {
+			seed = (seed * 1664525U) + 1013904223U;
+			buf[i] = static_cast<uint8_t>(seed >> 24);
+		}
+
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_cpp(
+			dec.pfn_cpp(width, height, buf.data(), static_cast<int>(buf.size()), dec.mode),
+			RpImageUnrefDeleter());
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_sse2(
+			dec.pfn_sse2(width, height, buf.data(), static_cast<int>(buf.size()), dec.mode),
+			RpImageUnrefDeleter());
+		ASSERT_TRUE(img_cpp != nullptr) << dec.name;
+		ASSERT_TRUE(img_sse2 != nullptr) << dec.name;
+		SCOPED_TRACE(dec.name);
+		ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::Compare_RpImage(img_cpp.get(), img_sse2.get()));
+	}
+}
+#endif /* ENABLE_PVRTC && IMAGEDECODER_HAS_SSE2 */
+
+/**
+ * Verify that multithreaded decoding of large block-compressed
+ * images matches single-threaded decoding.
+ */
+TEST(ImageDecoderParallelTest, decodeTileRows_matches_single_thread)
+{
+	typedef rp_image *(*pfnDecode_t)(int width, int height, const uint8_t *img_buf, int img_siz);
+	static const struct {
+		const char *name;
+		pfnDecode_t pfn;
+		unsigned int blockSize;
+	} decoders[] = {
+		// NOTE: Using the *_cpp versions, since taking the address
+		// of an IFUNC function in static data doesn't work.
+		{"DXT1", ImageDecoder::fromDXT1_cpp,   8},
+		{"DXT5", ImageDecoder::fromDXT5_cpp,  16},
+		{"BC5",  ImageDecoder::fromBC5_cpp,   16},
+		{"BC7",  ImageDecoder::fromBC7_cpp,   16},
+		{"ETC2", ImageDecoder::fromETC2_RGBA_cpp, 16},
+	};
+
+	// Large enough to be decoded using multiple threads.
+	// Height is not a multiple of the strip size.
+	static const int width = 1024, height = 1036;
+	static const unsigned int blockCount = (width / 4) * (height / 4);
+
+	uint32_t seed = 0x87654321;
+	for (const auto &dec : decoders) {
+		ao::uvector<uint8_t> buf(blockCount * dec.blockSize);
+		for (unsigned int i = 0; i < buf.size(); i++) {
+			seed = (seed * 1664525U) + 1013904223U;
+			buf[i] = static_cast<uint8_t>(seed >> 24);
+		}
+		if (dec.pfn == ImageDecoder::fromBC7_cpp) {
+			// Make sure every BC7 block has a valid mode.
+			for (unsigned int i = 0; i < buf.size(); i += 16) {
+				buf[i] |= 0x80;
+			}
+		}
+
+		ImageDecoder::setMaxThreads(1);
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_single(
+			dec.pfn(width, height, buf.data(), static_cast<int>(buf.size())),
+			RpImageUnrefDeleter());
+		ImageDecoder::setMaxThreads(4);
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_multi(
+			dec.pfn(width, height, buf.data(), static_cast<int>(buf.size())),
+			RpImageUnrefDeleter());
+		ImageDecoder::setMaxThreads(0);
+
+		ASSERT_TRUE(img_single != nullptr) << dec.name;
+		ASSERT_TRUE(img_multi != nullptr) << dec.name;
+		SCOPED_TRACE(dec.name);
+		ASSERT_NO_FATAL_FAILURE(ImageDecoderTest::Compare_RpImage(img_single.get(), img_multi.get()));
+	}
+}
+
+/**
+ * Verify that a requested image size selects the smallest
+ * DDS mipmap that is at least as large as the requested size.
+ */
+TEST(ImageDecoderMipmapTest, selectMipmapBySize)
+{
+	// 64x64 ARGB8888 texture with a full mipmap chain. (7 levels)
+	// Each mipmap level is filled with a different color.
+	static const unsigned int width = 64, height = 64, mipmapCount = 7;
+	DDS_HEADER ddsHeader;
+	memset(&ddsHeader, 0, sizeof(ddsHeader));
+	ddsHeader.dwSize = cpu_to_le32(sizeof(ddsHeader));
+	ddsHeader.dwFlags = cpu_to_le32(DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH |
+	                                DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT);
+	ddsHeader.dwHeight = cpu_to_le32(height);
+	ddsHeader.dwWidth = cpu_to_le32(width);
+	ddsHeader.dwMipMapCount = cpu_to_le32(mipmapCount);
+	ddsHeader.ddspf.dwSize = cpu_to_le32(sizeof(ddsHeader.ddspf));
+	ddsHeader.ddspf.dwFlags = cpu_to_le32(DDPF_RGB | DDPF_ALPHAPIXELS);
+	ddsHeader.ddspf.dwRGBBitCount = cpu_to_le32(32);
+	ddsHeader.ddspf.dwRBitMask = cpu_to_le32(0x00FF0000);
+	ddsHeader.ddspf.dwGBitMask = cpu_to_le32(0x0000FF00);
+	ddsHeader.ddspf.dwBBitMask = cpu_to_le32(0x000000FF);
+	ddsHeader.ddspf.dwABitMask = cpu_to_le32(0xFF000000);
+	ddsHeader.dwCaps = cpu_to_le32(DDSCAPS_COMPLEX | DDSCAPS_MIPMAP | DDSCAPS_TEXTURE);
+
+	ao::uvector<uint8_t> dds_buf;
+	const uint32_t dds_magic = cpu_to_be32(DDS_MAGIC);
+	dds_buf.insert(dds_buf.end(), reinterpret_cast<const uint8_t*>(&dds_magic),
+		reinterpret_cast<const uint8_t*>(&dds_magic) + sizeof(dds_magic));
+	dds_buf.insert(dds_buf.end(), reinterpret_cast<const uint8_t*>(&ddsHeader),
+		reinterpret_cast<const uint8_t*>(&ddsHeader) + sizeof(ddsHeader));
+	for (unsigned int mip = 0; mip < mipmapCount; mip++) {
+		const uint32_t color = cpu_to_le32(0xFF000000U | (mip * 0x102030U));
+		const unsigned int px_count = (width >> mip) * (height >> mip);
+		for (unsigned int i = 0; i < px_count; i++) {
+			dds_buf.insert(dds_buf.end(), reinterpret_cast<const uint8_t*>(&color),
+				reinterpret_cast<const uint8_t*>(&color) + sizeof(color));
+		}
+	}
+
+	unique_RefBase<RpMemFile> f_dds(new RpMemFile(dds_buf.data(), dds_buf.size()));
+	ASSERT_TRUE(f_dds->isOpen()) << "Could not create RpMemFile for the DDS image.";
+	unique_RefBase<RomData> romData(new RpTextureWrapper(f_dds.get()));
+	ASSERT_TRUE(romData->isValid()) << "Could not load the DDS image.";
+
+	// All mipmap levels should be listed, with the full image first.
+	const auto sizeDefs = romData->supportedImageSizes(RomData::IMG_INT_IMAGE);
+	ASSERT_EQ(mipmapCount, sizeDefs.size());
+	EXPECT_EQ(width, sizeDefs[0].width);
+	EXPECT_EQ(height, sizeDefs[0].height);
+
+	static const struct {
+		int reqSize;
+		unsigned int mip;
+	} sizeTests[] = {
+		{RomData::IMAGE_SIZE_DEFAULT, 0},
+		{256, 0},
+		{64, 0},
+		{48, 0},
+		{32, 1},
+		{20, 1},
+		{16, 2},
+		{1, 6},
+	};
+	for (const auto &sizeTest : sizeTests) {
+		SCOPED_TRACE(sizeTest.reqSize);
+		const rp_image *const img = romData->image(RomData::IMG_INT_IMAGE, sizeTest.reqSize);
+		ASSERT_TRUE(img != nullptr);
+		EXPECT_EQ(static_cast<int>(width >> sizeTest.mip), img->width());
+		EXPECT_EQ(static_cast<int>(height >> sizeTest.mip), img->height());
+		ASSERT_EQ(rp_image::Format::ARGB32, img->format());
+		const uint32_t *const px = static_cast<const uint32_t*>(img->bits());
+		EXPECT_EQ(0xFF000000U | (sizeTest.mip * 0x102030U), px[0]);
+	}
+}
+
+/**
+ * Verify that a small requested image size uses the
+ * embedded VTF low-resolution image instead of the
+ * full image.
+ */
+TEST(ImageDecoderMipmapTest, selectVtfLowResImage)
+{
+	// 64x64 BGRA8888 texture with no mipmaps,
+	// plus a 16x16 BGRA8888 low-resolution image.
+	static const unsigned int width = 64, height = 64;
+	static const unsigned int lowResWidth = 16, lowResHeight = 16;
+	static const uint32_t lowResColor = 0xFF112233U;
+	static const uint32_t highResColor = 0xFF445566U;
+	static const unsigned int headerSize = 80;
+
+	VTFHEADER vtfHeader;
+	memset(&vtfHeader, 0, sizeof(vtfHeader));
+	vtfHeader.signature = cpu_to_be32(VTF_SIGNATURE);
+	vtfHeader.version[0] = cpu_to_le32(7);
+	vtfHeader.version[1] = cpu_to_le32(2);
+	vtfHeader.headerSize = cpu_to_le32(headerSize);
+	vtfHeader.width = cpu_to_le16(width);
+	vtfHeader.height = cpu_to_le16(height);
+	vtfHeader.frames = cpu_to_le16(1);
+	vtfHeader.highResImageFormat = static_cast<int>(cpu_to_le32(VTF_IMAGE_FORMAT_BGRA8888));
+	vtfHeader.mipmapCount = 1;
+	vtfHeader.lowResImageFormat = static_cast<int>(cpu_to_le32(VTF_IMAGE_FORMAT_BGRA8888));
+	vtfHeader.lowResImageWidth = lowResWidth;
+	vtfHeader.lowResImageHeight = lowResHeight;
+	vtfHeader.depth = cpu_to_le16(1);
+
+	ao::uvector<uint8_t> vtf_buf;
+	vtf_buf.insert(vtf_buf.end(), reinterpret_cast<const uint8_t*>(&vtfHeader),
+		reinterpret_cast<const uint8_t*>(&vtfHeader) + sizeof(vtfHeader));
+	vtf_buf.resize(headerSize, 0);
+	auto appendPixels = [&vtf_buf](uint32_t color, unsigned int px_count) {
+		const uint32_t le_color = cpu_to_le32(color);
+		for (unsigned int i = 0; i < px_count; i++) {
+			vtf_buf.insert(vtf_buf.end(), reinterpret_cast<const uint8_t*>(&le_color),
+				reinterpret_cast<const uint8_t*>(&le_color) + sizeof(le_color));
+		}
+	};
+	appendPixels(lowResColor, lowResWidth * lowResHeight);
+	appendPixels(highResColor, width * height);
+
+	unique_RefBase<RpMemFile> f_vtf(new RpMemFile(vtf_buf.data(), vtf_buf.size()));
+	ASSERT_TRUE(f_vtf->isOpen()) << "Could not create RpMemFile for the VTF image.";
+	unique_RefBase<RomData> romData(new RpTextureWrapper(f_vtf.get()));
+	ASSERT_TRUE(romData->isValid()) << "Could not load the VTF image.";
+
+	// The full image is listed first, followed by the low-resolution image.
+	const auto sizeDefs = romData->supportedImageSizes(RomData::IMG_INT_IMAGE);
+	ASSERT_EQ(2U, sizeDefs.size());
+	EXPECT_EQ(width, sizeDefs[0].width);
+	EXPECT_EQ(lowResWidth, sizeDefs[1].width);
+
+	static const struct {
+		int reqSize;
+		unsigned int width;
+		uint32_t color;
+	} sizeTests[] = {
+		{RomData::IMAGE_SIZE_DEFAULT, width, highResColor},
+		{64, width, highResColor},
+		{32, width, highResColor},
+		{16, lowResWidth, lowResColor},
+		{8, lowResWidth, lowResColor},
+	};
+	for (const auto &sizeTest : sizeTests) {
+		SCOPED_TRACE(sizeTest.reqSize);
+		const rp_image *const img = romData->image(RomData::IMG_INT_IMAGE, sizeTest.reqSize);
+		ASSERT_TRUE(img != nullptr);
+		EXPECT_EQ(static_cast<int>(sizeTest.width), img->width());
+		EXPECT_EQ(static_cast<int>(sizeTest.width), img->height());
+		ASSERT_EQ(rp_image::Format::ARGB32, img->format());
+		const uint32_t *const px = static_cast<const uint32_t*>(img->bits());
+		EXPECT_EQ(sizeTest.color, px[0]);
+	}
+}
+
+/**
+ * Verify that region decoding matches the same region
+ * of a full image decode.
+ */
+TEST(ImageDecoderRegionTest, region_matches_full_decode)
+{
+	// Compare a decoded region to the same region in the full image.
+	auto compareRegion = [](const rp_image *img_full, const rp_image *img_region, int x, int y) {
+		ASSERT_TRUE(img_full != nullptr);
+		ASSERT_TRUE(img_region != nullptr);
+		ASSERT_EQ(rp_image::Format::ARGB32, img_full->format());
+		ASSERT_EQ(rp_image::Format::ARGB32, img_region->format());
+		ASSERT_LE(x + img_region->width(), img_full->width());
+		ASSERT_LE(y + img_region->height(), img_full->height());
+		for (int py = 0; py < img_region->height(); py++) {
+			const uint32_t *const pFull = static_cast<const uint32_t*>(img_full->scanLine(y + py)) + x;
+			const uint32_t *const pRegion = static_cast<const uint32_t*>(img_region->scanLine(py));
+			ASSERT_EQ(0, memcmp(pFull, pRegion, img_region->width() * sizeof(uint32_t))) << "row " << py;
+		}
+	};
+
+	// Pseudo-random image data. (LCG from Numerical Recipes)
+	uint32_t seed = 0x13579BDF;
+	auto fillRandom = [&seed](ao::uvector<uint8_t> &buf) {
+		for (unsigned int i = 0; i < buf.size(); i++) {
+			seed = (seed * 1664525U) + 1013904223U;
+			buf[i] = static_cast<uint8_t>(seed >> 24);
+		}
+	};
+
+	// Linear formats, with padding at the end of each row.
+	static const int lin_w = 100, lin_h = 60;
+	static const int rx = 13, ry = 7, rw = 50, rh = 40;
+	for (int bytespp = 2; bytespp <= 4; bytespp++) {
+		SCOPED_TRACE(bytespp);
+		const int stride = (lin_w * bytespp) + 16;
+		ao::uvector<uint8_t> buf(stride * lin_h);
+		fillRandom(buf);
+
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_full(nullptr, RpImageUnrefDeleter());
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_region(nullptr, RpImageUnrefDeleter());
+		switch (bytespp) {
+			case 2:
+				img_full.reset(ImageDecoder::fromLinear16(ImageDecoder::PixelFormat::RGB565,
+					lin_w, lin_h, reinterpret_cast<const uint16_t*>(buf.data()),
+					static_cast<int>(buf.size()), stride));
+				img_region.reset(ImageDecoder::fromLinear16_region(ImageDecoder::PixelFormat::RGB565,
+					lin_w, lin_h, reinterpret_cast<const uint16_t*>(buf.data()),
+					static_cast<int>(buf.size()), stride, rx, ry, rw, rh));
+				break;
+			case 3:
+				img_full.reset(ImageDecoder::fromLinear24(ImageDecoder::PixelFormat::RGB888,
+					lin_w, lin_h, buf.data(), static_cast<int>(buf.size()), stride));
+				img_region.reset(ImageDecoder::fromLinear24_region(ImageDecoder::PixelFormat::RGB888,
+					lin_w, lin_h, buf.data(), static_cast<int>(buf.size()), stride, rx, ry, rw, rh));
+				break;
+			case 4:
+				img_full.reset(ImageDecoder::fromLinear32(ImageDecoder::PixelFormat::ARGB8888,
+					lin_w, lin_h, reinterpret_cast<const uint32_t*>(buf.data()),
+					static_cast<int>(buf.size()), stride));
+				img_region.reset(ImageDecoder::fromLinear32_region(ImageDecoder::PixelFormat::ARGB8888,
+					lin_w, lin_h, reinterpret_cast<const uint32_t*>(buf.data()),
+					static_cast<int>(buf.size()), stride, rx, ry, rw, rh));
+				break;
+		}
+		ASSERT_TRUE(img_region != nullptr);
+		EXPECT_EQ(rw, img_region->width());
+		EXPECT_EQ(rh, img_region->height());
+		ASSERT_NO_FATAL_FAILURE(compareRegion(img_full.get(), img_region.get(), rx, ry));
+	}
+
+	// Block-compressed and tiled formats.
+	// The last region extends to the partial tiles at the bottom-right edge.
+	static const struct {
+		const char *name;
+		ImageDecoder::pfnFromTiled_t pfn;
+		int tileW, tileH, tileSize;
+		int width, height;
+		int x, y, w, h;
+	} tiledTests[] = {
+		{"DXT1",   ImageDecoder::fromDXT1_cpp,   4, 4,  8,  54, 54,   8, 12, 30, 20},
+		{"DXT1_full_rows", ImageDecoder::fromDXT1_cpp, 4, 4, 8, 54, 54, 0, 16, 54, 20},
+		{"DXT5",   ImageDecoder::fromDXT5_cpp,   4, 4, 16,  54, 54,  20, 12, 34, 42},
+		{"BC7",    ImageDecoder::fromBC7_cpp,    4, 4, 16,  64, 32,  16,  8, 32, 16},
+		{"N3DS",   [](int width, int height, const uint8_t *img_buf, int img_siz) {
+				return ImageDecoder::fromN3DSTiledRGB565(width, height,
+					reinterpret_cast<const uint16_t*>(img_buf), img_siz);
+			}, 8, 8, 128,  64, 64,   0,  0, 48, 48},
+	};
+	for (const auto &test : tiledTests) {
+		SCOPED_TRACE(test.name);
+		const int tilesX = (test.width + test.tileW - 1) / test.tileW;
+		const int tilesY = (test.height + test.tileH - 1) / test.tileH;
+		ao::uvector<uint8_t> buf(tilesX * tilesY * test.tileSize);
+		fillRandom(buf);
+		if (test.pfn == ImageDecoder::fromBC7_cpp) {
+			// Make sure every BC7 block has a valid mode.
+			for (unsigned int i = 0; i < buf.size(); i += 16) {
+				buf[i] |= 0x80;
+			}
+		}
+
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_full(
+			test.pfn(test.width, test.height, buf.data(), static_cast<int>(buf.size())),
+			RpImageUnrefDeleter());
+		unique_ptr<rp_image, RpImageUnrefDeleter> img_region(
+			ImageDecoder::fromTiled_region(test.pfn, test.tileW, test.tileH, test.tileSize,
+				test.width, test.height, buf.data(), static_cast<int>(buf.size()),
+				test.x, test.y, test.w, test.h),
+			RpImageUnrefDeleter());
+		ASSERT_TRUE(img_region != nullptr);
+		EXPECT_EQ(test.w, img_region->width());
+		EXPECT_EQ(test.h, img_region->height());
+		ASSERT_NO_FATAL_FAILURE(compareRegion(img_full.get(), img_region.get(), test.x, test.y));
+	}
+}
+
 // SMDH tests.
 // From *New* Nintendo 3DS 9.2.0-20J.
 #define SMDH_TEST(file) ImageDecoderTest_mode( \
@@ -0,0 +1,239 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * XdgThumbnailCacheTest.cpp: XdgThumbnailCache test.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpbase, librpfile, librptexture
+#include "librpbase/img/RpPngWriter.hpp"
+#include "librpfile/FileSystem.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librptexture/img/rp_image.hpp"
+using LibRpBase::RpPngWriter;
+using LibRpFile::RpFile;
+using LibRpTexture::rp_image;
+
+// libromdata
+#include "libromdata/img/XdgThumbnailCache.hpp"
+
+// C includes.
+#include <inttypes.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cerrno>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+class XdgThumbnailCacheTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Source file parameters.
+		static const char TEST_URI[];
+		static const int64_t TEST_MTIME = 1234567890;
+
+		// Temporary cache directory.
+		string m_cacheDir;
+		// Files to delete in TearDown().
+		vector<string> m_tmpFiles;
+
+		/**
+		 * Write a thumbnail with Thumb::URI and Thumb::MTime.
+		 * @param filename Thumbnail filename.
+		 * @param uri Thumb::URI
+		 * @param mtime Thumb::MTime
+		 * @return 0 on success; non-zero on error.
+		 */
+		int writeThumbnail(const string &filename, const char *uri, int64_t mtime);
+
+		/**
+		 * Read an entire file.
+		 * @param filename Filename.
+		 * @return File contents, or an empty vector on error.
+		 */
+		static vector<uint8_t> readFile(const string &filename);
+};
+
+// Example URI from the Thumbnail Managing Standard.
+const char XdgThumbnailCacheTest::TEST_URI[] = "file:///home/jens/photos/me.png";
+
+void XdgThumbnailCacheTest::SetUp(void)
+{
+	// Use a temporary cache directory.
+	char tmpl[] = "/tmp/rpXdgThumbnailCacheTest.XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(tmpl));
+	m_cacheDir = tmpl;
+	ASSERT_EQ(0, setenv("XDG_CACHE_HOME", tmpl, 1));
+}
+
+void XdgThumbnailCacheTest::TearDown(void)
+{
+	for (const string &filename : m_tmpFiles) {
+		unlink(filename.c_str());
+	}
+	static const char *const subdirs[] = {
+		"/thumbnails/normal", "/thumbnails/large", "/thumbnails",
+	};
+	for (const char *subdir : subdirs) {
+		rmdir((m_cacheDir + subdir).c_str());
+	}
+	rmdir(m_cacheDir.c_str());
+	unsetenv("XDG_CACHE_HOME");
+}
+
+/**
+ * Write a thumbnail with Thumb::URI and Thumb::MTime.
+ * @param filename Thumbnail filename.
+ * @param uri Thumb::URI
+ * @param mtime Thumb::MTime
+ * @return 0 on success; non-zero on error.
+ */
+int XdgThumbnailCacheTest::writeThumbnail(const string &filename, const char *uri, int64_t mtime)
+{
+	if (LibRpFile::FileSystem::rmkdir(filename) != 0)
+		return -EIO;
+	m_tmpFiles.emplace_back(filename);
+
+	rp_image *const img = new rp_image(16, 16, rp_image::Format::ARGB32);
+
+	char mtime_str[32];
+	snprintf(mtime_str, sizeof(mtime_str), "%" PRId64, mtime);
+	RpPngWriter::kv_vector kv;
+	kv.emplace_back("Software", "XdgThumbnailCacheTest");
+	kv.emplace_back("Thumb::MTime", mtime_str);
+	kv.emplace_back("Thumb::URI", uri);
+
+	RpPngWriter *const pngWriter = new RpPngWriter(filename.c_str(), img);
+	int ret = -EIO;
+	if (pngWriter->isOpen()) {
+		pngWriter->write_tEXt(kv);
+		if (pngWriter->write_IHDR() == 0 && pngWriter->write_IDAT() == 0) {
+			ret = 0;
+		}
+	}
+	delete pngWriter;
+	img->unref();
+	return ret;
+}
+
+/**
+ * Read an entire file.
+ * @param filename Filename.
+ * @return File contents, or an empty vector on error.
+ */
+vector<uint8_t> XdgThumbnailCacheTest::readFile(const string &filename)
+{
+	vector<uint8_t> ret;
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	if (file->isOpen()) {
+		ret.resize(static_cast<size_t>(file->size()));
+		if (file->read(ret.data(), ret.size()) != ret.size()) {
+			ret.clear();
+		}
+	}
+	file->unref();
+	return ret;
+}
+
+/**
+ * Thumbnail filenames use the MD5 hash of the URI.
+ */
+TEST_F(XdgThumbnailCacheTest, getThumbnailFilename)
+{
+	EXPECT_EQ(m_cacheDir + "/thumbnails/normal/c6ee772d9e49320e97ec29a7eb5b1697.png",
+		XdgThumbnailCache::getThumbnailFilename(TEST_URI, 128));
+	EXPECT_EQ(m_cacheDir + "/thumbnails/large/c6ee772d9e49320e97ec29a7eb5b1697.png",
+		XdgThumbnailCache::getThumbnailFilename(TEST_URI, 256));
+
+	// Non-standard sizes aren't supported.
+	EXPECT_EQ(string(), XdgThumbnailCache::getThumbnailFilename(TEST_URI, 200));
+}
+
+/**
+ * A matching thumbnail is valid, and is copied to the output file.
+ */
+TEST_F(XdgThumbnailCacheTest, validThumbnail)
+{
+	const string thumb_filename = XdgThumbnailCache::getThumbnailFilename(TEST_URI, 256);
+	ASSERT_EQ(0, writeThumbnail(thumb_filename, TEST_URI, TEST_MTIME));
+	EXPECT_TRUE(XdgThumbnailCache::isThumbnailValid(thumb_filename.c_str(), TEST_URI, TEST_MTIME));
+
+	// Output file is the cached thumbnail.
+	EXPECT_EQ(0, XdgThumbnailCache::getValidThumbnail(TEST_URI, TEST_MTIME, 256, thumb_filename.c_str()));
+
+	// Output file is somewhere else.
+	const string output_file = m_cacheDir + "/output.png";
+	m_tmpFiles.emplace_back(output_file);
+	EXPECT_EQ(0, XdgThumbnailCache::getValidThumbnail(TEST_URI, TEST_MTIME, 256, output_file.c_str()));
+	const vector<uint8_t> expected = readFile(thumb_filename);
+	ASSERT_FALSE(expected.empty());
+	EXPECT_EQ(expected, readFile(output_file));
+}
+
+/**
+ * Thumbnails with a different URI or modification time are invalid.
+ */
+TEST_F(XdgThumbnailCacheTest, staleThumbnail)
+{
+	const string thumb_filename = XdgThumbnailCache::getThumbnailFilename(TEST_URI, 128);
+	ASSERT_EQ(0, writeThumbnail(thumb_filename, TEST_URI, TEST_MTIME));
+
+	EXPECT_FALSE(XdgThumbnailCache::isThumbnailValid(thumb_filename.c_str(), TEST_URI, TEST_MTIME + 1));
+	EXPECT_FALSE(XdgThumbnailCache::isThumbnailValid(thumb_filename.c_str(), "file:///home/jens/photos/you.png", TEST_MTIME));
+
+	const string output_file = m_cacheDir + "/output.png";
+	EXPECT_EQ(-ENOENT, XdgThumbnailCache::getValidThumbnail(TEST_URI, TEST_MTIME + 1, 128, output_file.c_str()));
+	EXPECT_NE(0, access(output_file.c_str(), F_OK));
+
+	// No thumbnail at this size.
+	EXPECT_EQ(-ENOENT, XdgThumbnailCache::getValidThumbnail(TEST_URI, TEST_MTIME, 256, output_file.c_str()));
+}
+
+/**
+ * Values that are 40 bytes or longer are written as zTXt,
+ * which is used for most Thumb::URI values.
+ */
+TEST_F(XdgThumbnailCacheTest, zTXtThumbnail)
+{
+	static const char long_uri[] = "file:///home/jens/Games/Nintendo%20DS/Some%20Long%20Game%20Name%20%28USA%29.nds";
+	const string thumb_filename = XdgThumbnailCache::getThumbnailFilename(long_uri, 256);
+	ASSERT_EQ(0, writeThumbnail(thumb_filename, long_uri, TEST_MTIME));
+
+	EXPECT_TRUE(XdgThumbnailCache::isThumbnailValid(thumb_filename.c_str(), long_uri, TEST_MTIME));
+	EXPECT_FALSE(XdgThumbnailCache::isThumbnailValid(thumb_filename.c_str(), long_uri, TEST_MTIME + 1));
+	EXPECT_FALSE(XdgThumbnailCache::isThumbnailValid(thumb_filename.c_str(), TEST_URI, TEST_MTIME));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: XdgThumbnailCache tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -14,9 +14,18 @@
 #include "libromdata/utils/SuperMagicDrive.hpp"
 #include "librpbase/aligned_malloc.h"
 
+// librpfile
+#include "librpfile/RpMemFile.hpp"
+#include "librpfile/RpVectorFile.hpp"
+using LibRpFile::RpMemFile;
+using LibRpFile::RpVectorFile;
+
 // C includes. (C++ namespace)
 #include <cstdio>
 
+// C++ includes.
+#include <vector>
+
 // zlib
 #define CHUNK 4096
 #include <zlib.h>
@@ -300,8 +309,39 @@ TEST_F(SuperMagicDriveTest, decodeBlock_sse2_benchmark)
 }
 #endif /* SMD_HAS_SSE2 */
 
+#ifdef SMD_HAS_AVX2
+/**
+ * Test the AVX2-optimized SMD decoder.
+ */
+TEST_F(SuperMagicDriveTest, decodeBlock_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	SuperMagicDrive::decodeBlock_avx2(align_buf, m_smd_data);
+	EXPECT_EQ(0, memcmp(m_bin_data, align_buf, SuperMagicDrive::SMD_BLOCK_SIZE));
+}
+
+/**
+ * Benchmark the AVX2-optimized SMD decoder.
+ */
+TEST_F(SuperMagicDriveTest, decodeBlock_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		SuperMagicDrive::decodeBlock_avx2(align_buf, m_smd_data);
+	}
+}
+#endif /* SMD_HAS_AVX2 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(SMD_HAS_MMX) || defined(SMD_HAS_SSE2)
+#if defined(SMD_HAS_MMX) || defined(SMD_HAS_SSE2) || defined(SMD_HAS_AVX2)
 /**
  * Test the decodeBlock() dispatch function.
  */
@@ -320,7 +360,40 @@ TEST_F(SuperMagicDriveTest, decodeBlock_dispatch_benchmark)
 		SuperMagicDrive::decodeBlock(align_buf, m_smd_data);
 	}
 }
-#endif /* SMD_HAS_MMX || SMD_HAS_SSE2 */
+#endif /* SMD_HAS_MMX || SMD_HAS_SSE2 || SMD_HAS_AVX2 */
+
+/**
+ * Test the decodeFile() streaming function.
+ * The source file has a 512-byte SMD header, 40 SMD blocks
+ * (more than one chunk), and a trailing partial block.
+ */
+TEST_F(SuperMagicDriveTest, decodeFile_test)
+{
+	static const unsigned int BLOCK_COUNT = 40;
+	static const unsigned int SMD_HEADER_SIZE = 512;
+	static const unsigned int TRAILING_SIZE = 100;
+
+	std::vector<uint8_t> smd_file;
+	smd_file.resize(SMD_HEADER_SIZE + (BLOCK_COUNT * SuperMagicDrive::SMD_BLOCK_SIZE) + TRAILING_SIZE, 0xFF);
+	for (unsigned int i = 0; i < BLOCK_COUNT; i++) {
+		memcpy(&smd_file[SMD_HEADER_SIZE + (i * SuperMagicDrive::SMD_BLOCK_SIZE)],
+			m_smd_data, SuperMagicDrive::SMD_BLOCK_SIZE);
+	}
+
+	RpMemFile *const srcFile = new RpMemFile(smd_file.data(), smd_file.size());
+	RpVectorFile *const destFile = new RpVectorFile();
+	EXPECT_EQ(static_cast<int>(BLOCK_COUNT), SuperMagicDrive::decodeFile(destFile, srcFile, SMD_HEADER_SIZE));
+
+	const std::vector<uint8_t> &bin_file = destFile->vector();
+	ASSERT_EQ(BLOCK_COUNT * SuperMagicDrive::SMD_BLOCK_SIZE, bin_file.size());
+	for (unsigned int i = 0; i < BLOCK_COUNT; i++) {
+		EXPECT_EQ(0, memcmp(m_bin_data, &bin_file[i * SuperMagicDrive::SMD_BLOCK_SIZE],
+			SuperMagicDrive::SMD_BLOCK_SIZE)) << "Block " << i;
+	}
+
+	destFile->unref();
+	srcFile->unref();
+}
 
 } }
 
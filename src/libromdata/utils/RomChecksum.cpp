@@ -0,0 +1,99 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomChecksum.cpp: Full ROM checksum verification.                        *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RomChecksum.hpp"
+
+// librpbase, librpfile
+#include "librpbase/config/Config.hpp"
+#include "librpfile/IRpFile.hpp"
+using LibRpBase::Config;
+using LibRpFile::IRpFile;
+
+// C++ STL classes.
+using std::unique_ptr;
+
+namespace LibRomData {
+
+// Force verification on, regardless of the configuration file.
+static bool forceEnabled = false;
+
+/**
+ * Is full ROM checksum verification enabled?
+ * This reads the entire ROM image, so it's disabled by default.
+ * It can be enabled in the configuration file or with
+ * setForceEnabled().
+ * @return True if enabled; false if not.
+ */
+bool RomChecksum::isEnabled(void)
+{
+	if (forceEnabled)
+		return true;
+	const Config *const config = Config::instance();
+	return config->verifyROMChecksums();
+}
+
+/**
+ * Force full ROM checksum verification on, regardless
+ * of the configuration file. (Used by rpcli.)
+ * @param enable True to force verification on.
+ */
+void RomChecksum::setForceEnabled(bool enable)
+{
+	forceEnabled = enable;
+}
+
+/**
+ * Sum the bytes in a range of a file.
+ * @param file	[in] File.
+ * @param offset	[in] Starting offset.
+ * @param length	[in] Length, in bytes.
+ * @param sum	[in,out] Sums. (Initialize to 0 for the first range.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomChecksum::sumFileRange(IRpFile *file, off64_t offset, off64_t length, rp_sum8_t *sum)
+{
+	assert(file != nullptr);
+	assert(offset >= 0);
+	assert(length >= 0);
+	if (!file || offset < 0 || length < 0)
+		return -EINVAL;
+	if (length == 0)
+		return 0;
+
+	// If the file is memory-mapped, sum it in place.
+	if (sizeof(size_t) >= sizeof(off64_t) || length <= static_cast<off64_t>(SIZE_MAX)) {
+		const uint8_t *const p = file->peek(offset, static_cast<size_t>(length));
+		if (p) {
+			rp_sum8(sum, p, static_cast<size_t>(length));
+			return 0;
+		}
+	}
+
+	// Read the file in 1 MB blocks.
+	// NOTE: The block size must be even. (See rp_sum8_t.)
+	static const size_t BLOCK_SIZE = 1024U*1024U;
+	const size_t buf_size = (length < static_cast<off64_t>(BLOCK_SIZE)
+		? static_cast<size_t>(length) : BLOCK_SIZE);
+	unique_ptr<uint8_t[]> buf(new uint8_t[buf_size]);
+
+	for (; length > 0; offset += buf_size, length -= buf_size) {
+		const size_t size = (length < static_cast<off64_t>(buf_size)
+			? static_cast<size_t>(length) : buf_size);
+		if (file->seekAndRead(offset, buf.get(), size) != size) {
+			// Read error.
+			const int err = file->lastError();
+			return (err != 0 ? -err : -EIO);
+		}
+		rp_sum8(sum, buf.get(), size);
+	}
+
+	return 0;
+}
+
+}
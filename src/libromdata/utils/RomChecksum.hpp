@@ -0,0 +1,62 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomChecksum.hpp: Full ROM checksum verification.                        *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_UTILS_ROMCHECKSUM_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_UTILS_ROMCHECKSUM_HPP__
+
+#include "common.h"
+#include "librpcpu/sum8_rp.h"
+
+// C includes.
+#include <stdint.h>
+
+namespace LibRpFile {
+	class IRpFile;
+}
+
+namespace LibRomData {
+
+class RomChecksum
+{
+	private:
+		// Static class.
+		RomChecksum();
+		~RomChecksum();
+		RP_DISABLE_COPY(RomChecksum)
+
+	public:
+		/**
+		 * Is full ROM checksum verification enabled?
+		 * This reads the entire ROM image, so it's disabled by default.
+		 * It can be enabled in the configuration file or with
+		 * setForceEnabled().
+		 * @return True if enabled; false if not.
+		 */
+		static bool isEnabled(void);
+
+		/**
+		 * Force full ROM checksum verification on, regardless
+		 * of the configuration file. (Used by rpcli.)
+		 * @param enable True to force verification on.
+		 */
+		static void setForceEnabled(bool enable);
+
+		/**
+		 * Sum the bytes in a range of a file.
+		 * @param file	[in] File.
+		 * @param offset	[in] Starting offset.
+		 * @param length	[in] Length, in bytes.
+		 * @param sum	[in,out] Sums. (Initialize to 0 for the first range.)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int sumFileRange(LibRpFile::IRpFile *file, off64_t offset, off64_t length, rp_sum8_t *sum);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_UTILS_ROMCHECKSUM_HPP__ */
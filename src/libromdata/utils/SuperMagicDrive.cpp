@@ -10,6 +10,11 @@
 #include "stdafx.h"
 #include "SuperMagicDrive.hpp"
 
+// librpbase, librpfile
+#include "librpbase/aligned_malloc.h"
+#include "librpfile/IRpFile.hpp"
+using LibRpFile::IRpFile;
+
 namespace LibRomData {
 
 /**
@@ -47,4 +52,82 @@ void SuperMagicDrive::decodeBlock_cpp(uint8_t *RESTRICT pDest, const uint8_t *RE
 	}
 }
 
+/**
+ * Decode a Super Magic Drive interleaved ROM image.
+ *
+ * The source file is read and decoded in chunks of multiple blocks,
+ * and the decoded data is written to the destination file at its
+ * current position. Any trailing partial block is ignored.
+ *
+ * @param pDest		[out] Destination file. (Must be writable.)
+ * @param pSrc		[in] Source file.
+ * @param srcOffset	[in] Offset of the first SMD block in pSrc. (usually 512, after the SMD header)
+ * @return Number of blocks decoded on success; negative POSIX error code on error.
+ */
+int SuperMagicDrive::decodeFile(IRpFile *pDest, IRpFile *pSrc, off64_t srcOffset)
+{
+	assert(pDest != nullptr);
+	assert(pSrc != nullptr);
+	assert(srcOffset >= 0);
+	if (!pDest || !pSrc || srcOffset < 0) {
+		return -EINVAL;
+	}
+
+	const off64_t fileSize = pSrc->size();
+	if (fileSize < 0) {
+		const int err = pSrc->lastError();
+		return (err != 0 ? -err : -EIO);
+	} else if (fileSize <= srcOffset) {
+		// No blocks.
+		return 0;
+	}
+	const off64_t blockCount64 = (fileSize - srcOffset) / SMD_BLOCK_SIZE;
+	if (blockCount64 > 0x7FFFFFFF) {
+		// Too many blocks.
+		return -EFBIG;
+	}
+	const unsigned int blockCount = static_cast<unsigned int>(blockCount64);
+
+	// Decode up to 32 blocks (512 KB) per chunk.
+	static const unsigned int CHUNK_BLOCKS = 32;
+	const unsigned int bufBlocks = std::min(blockCount, CHUNK_BLOCKS);
+	if (bufBlocks == 0) {
+		// No blocks.
+		return 0;
+	}
+	auto smd_buf = aligned_uptr<uint8_t>(16, bufBlocks * SMD_BLOCK_SIZE);
+	auto bin_buf = aligned_uptr<uint8_t>(16, bufBlocks * SMD_BLOCK_SIZE);
+
+	int ret = pSrc->seek(srcOffset);
+	if (ret != 0) {
+		const int err = pSrc->lastError();
+		return (err != 0 ? -err : -EIO);
+	}
+
+	for (unsigned int block = 0; block < blockCount; ) {
+		const unsigned int n = std::min(blockCount - block, CHUNK_BLOCKS);
+		const size_t len = static_cast<size_t>(n) * SMD_BLOCK_SIZE;
+		if (pSrc->read(smd_buf.get(), len) != len) {
+			// Short read.
+			const int err = pSrc->lastError();
+			return (err != 0 ? -err : -EIO);
+		}
+
+		const uint8_t *pSmd = smd_buf.get();
+		uint8_t *pBin = bin_buf.get();
+		for (unsigned int i = n; i > 0; i--, pSmd += SMD_BLOCK_SIZE, pBin += SMD_BLOCK_SIZE) {
+			decodeBlock(pBin, pSmd);
+		}
+
+		if (pDest->write(bin_buf.get(), len) != len) {
+			// Short write.
+			const int err = pDest->lastError();
+			return (err != 0 ? -err : -EIO);
+		}
+		block += n;
+	}
+
+	return static_cast<int>(blockCount);
+}
+
 }
@@ -23,16 +23,23 @@ using std::unordered_map;
 // Reference: http://andreoffringa.org/?q=uvector
 #include "uvector.h"
 
-// zlib for CRC32.
-#include <zlib.h>
-#ifdef _MSC_VER
-// MSVC: Exception handling for /DELAYLOAD.
-# include "libwin32common/DelayLoadHelper.h"
-#endif /* _MSC_VER */
+// librpcpu
+#include "librpcpu/crc32_rp.h"
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/Thread.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+using LibRpThreads::Thread;
 
 #ifdef _WIN32
-// Win32 needed for GetCurrentProcessId().
+// Win32 needed for GetCurrentProcessId() and MoveFileEx().
 # include "libwin32common/RpWin32_sdk.h"
+# include "TextFuncs_wchar.hpp"
+#else /* !_WIN32 */
+// getpid(), rename()
+# include <unistd.h>
 #endif /* _WIN32 */
 
 // DEBUG: Uncomment this to force obfuscation in debug builds.
@@ -41,15 +48,11 @@ using std::unordered_map;
 
 namespace LibRpBase {
 
-#ifdef _MSC_VER
-// DelayLoad test implementation.
-DELAYLOAD_TEST_FUNCTION_IMPL0(get_crc_table);
-#endif /* _MSC_VER */
-
 class AchievementsPrivate
 {
 	public:
 		AchievementsPrivate();
+		~AchievementsPrivate();
 
 	private:
 		RP_DISABLE_COPY(AchievementsPrivate)
@@ -69,6 +72,26 @@ class AchievementsPrivate
 		// Have achievements been loaded from disk?
 		bool loaded;
 
+		// Achievement data mutex.
+		// Protects mapAchData, dirty, and flushRunning.
+		mutable Mutex mtxData;
+
+		// Achievements have been modified but not saved yet.
+		// The in-memory data is authoritative within this process.
+		bool dirty;
+
+		// Background flush thread.
+		// Achievements are written to disk on this thread so
+		// unlock() doesn't block on file I/O.
+		Thread flushThread;
+		bool flushRunning;	// True if flushThread is writing achievements
+
+		// Cached achievements filename for save().
+		// (protected by mtxData)
+		// NOTE: The destructor may call save() after
+		// FileSystem's static data has been destroyed.
+		string saveFilename;
+
 	public:
 		// Achievement types
 		enum AchType : uint8_t {
@@ -193,10 +216,30 @@ class AchievementsPrivate
 		}
 
 		/**
-		 * Save the achievements data.
+		 * Serialize the achievements data.
+		 * mtxData must be locked by the caller.
+		 * @param buf	[out] Achievements file data.
+		 */
+		void serialize(ao::uvector<uint8_t> &buf) const;
+
+		/**
+		 * Save the achievements data if it has been modified.
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
-		int save(void) const;
+		int save(void);
+
+		/**
+		 * Schedule the achievements data to be saved on the flush thread.
+		 * If the flush thread can't be started, the data is saved immediately.
+		 * mtxData must NOT be locked by the caller.
+		 */
+		void scheduleSave(void);
+
+		/**
+		 * Flush thread function.
+		 * @param param AchievementsPrivate
+		 */
+		static void flushThreadFunc(void *param);
 
 		/**
 		 * Load the achievements data.
@@ -246,8 +289,17 @@ AchievementsPrivate::AchievementsPrivate()
 	: notifyFunc(nullptr)
 	, user_data(0)
 	, loaded(false)
+	, dirty(false)
+	, flushRunning(false)
 { }
 
+AchievementsPrivate::~AchievementsPrivate()
+{
+	// Wait for the flush thread, then save any remaining changes.
+	flushThread.join();
+	save();
+}
+
 /**
  * Append a uint64_t to an ao::uvector<> using varlenint format.
  * @param vec ao::uvector<>
@@ -343,27 +395,13 @@ void AchievementsPrivate::doObfuscate(uint16_t iv, uint8_t *buf, size_t size)
 }
 
 /**
- * Save the achievements data.
- * @return 0 on success; negative POSIX error code on error.
+ * Serialize the achievements data.
+ * mtxData must be locked by the caller.
+ * @param buf	[out] Achievements file data.
  */
-int AchievementsPrivate::save(void) const
+void AchievementsPrivate::serialize(ao::uvector<uint8_t> &buf) const
 {
-#if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
-	// Delay load verification.
-	// TODO: Only if linked with /DELAYLOAD?
-	if (DelayLoad_test_get_crc_table() != 0) {
-		// Delay load failed.
-		// Can't calculate the CRC32.
-		return -ENOTSUP;
-	}
-#else /* !defined(_MSC_VER) || !defined(ZLIB_IS_DLL) */
-	// zlib isn't in a DLL, but we need to ensure that the
-	// CRC table is initialized anyway.
-	get_crc_table();
-#endif /* defined(_MSC_VER) && defined(ZLIB_IS_DLL) */
-
 	// Create the achievements file in memory.
-	ao::uvector<uint8_t> buf;
 	buf.reserve(sizeof(AchBinHeader) + ((int)Achievements::ID::Max * 12));
 	buf.resize(sizeof(AchBinHeader));
 
@@ -429,7 +467,7 @@ int AchievementsPrivate::save(void) const
 	// CRC32 of achievement data.
 	// Includes count.
 	if (buf.size() > HeaderSizeMinusCount) {
-		header->crc32 = cpu_to_le32(crc32(0, &buf.data()[HeaderSizeMinusCount], buf.size() - HeaderSizeMinusCount));
+		header->crc32 = cpu_to_le32(rp_crc32(0, &buf.data()[HeaderSizeMinusCount], buf.size() - HeaderSizeMinusCount));
 	}
 
 #if defined(NDEBUG) || defined(FORCE_OBFUSCATE)
@@ -457,15 +495,50 @@ int AchievementsPrivate::save(void) const
 
 	doObfuscate(iv.u16[0], buf.data(), ivpos);
 #endif /* NDEBUG || FORCE_OBFUSCATE */
+}
+
+/**
+ * Save the achievements data if it has been modified.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AchievementsPrivate::save(void)
+{
+	// Serialize the achievements while holding the mutex.
+	// The file is written after the mutex is released.
+	ao::uvector<uint8_t> buf;
+	string filename;
+	{
+		MutexLocker mtxLocker(mtxData);
+		if (!dirty) {
+			// Nothing to save.
+			return 0;
+		}
+		serialize(buf);
+		dirty = false;
+
+		if (saveFilename.empty()) {
+			saveFilename = getFilename();
+		}
+		filename = saveFilename;
+	}
 
 	// Write the achievements file.
-	string filename = getFilename();
 	if (filename.empty()) {
 		// Unable to get the filename.
 		return -EIO;
 	}
 
-	RpFile *const file = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+	// Write to a temporary file, then rename it over the achievements file.
+	// This ensures the achievements file is never partially written.
+	char pid_buf[24];
+#ifdef _WIN32
+	snprintf(pid_buf, sizeof(pid_buf), ".%lu.tmp", static_cast<unsigned long>(GetCurrentProcessId()));
+#else /* !_WIN32 */
+	snprintf(pid_buf, sizeof(pid_buf), ".%ld.tmp", static_cast<long>(getpid()));
+#endif /* _WIN32 */
+	const string tmp_filename = filename + pid_buf;
+
+	RpFile *const file = new RpFile(tmp_filename, RpFile::FM_CREATE_WRITE);
 	if (!file->isOpen()) {
 		int ret = -file->lastError();
 		if (ret == 0) {
@@ -474,40 +547,100 @@ int AchievementsPrivate::save(void) const
 		file->unref();
 		return ret;
 	}
-	size_t size = file->write(buf.data(), buf.size());
+	const size_t size = file->write(buf.data(), buf.size());
+	int ret = 0;
 	if (size != buf.size()) {
 		// Short write.
-		// TODO: Delete the file?
-		int ret = -file->lastError();
+		ret = -file->lastError();
 		if (ret == 0) {
 			ret = -EIO;
 		}
-		file->unref();
-		return -EIO;
 	}
 	file->unref();
 
+	if (ret == 0) {
+#ifdef _WIN32
+		if (!MoveFileEx(U82T_s(tmp_filename), U82T_s(filename), MOVEFILE_REPLACE_EXISTING)) {
+			ret = -EIO;
+		}
+#else /* !_WIN32 */
+		if (rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+			ret = -errno;
+			if (ret == 0) {
+				ret = -EIO;
+			}
+		}
+#endif /* _WIN32 */
+	}
+	if (ret != 0) {
+		// Write or rename failed. Remove the temporary file.
+		FileSystem::delete_file(tmp_filename);
+		return ret;
+	}
+
 	// Achievements written.
-	const_cast<AchievementsPrivate*>(this)->loaded = true;
 	return 0;
 }
 
+/**
+ * Schedule the achievements data to be saved on the flush thread.
+ * If the flush thread can't be started, the data is saved immediately.
+ * mtxData must NOT be locked by the caller.
+ */
+void AchievementsPrivate::scheduleSave(void)
+{
+	{
+		MutexLocker mtxLocker(mtxData);
+		if (flushRunning) {
+			// The flush thread is running.
+			// It will save the new changes before it exits.
+			return;
+		}
+		flushRunning = true;
+	}
+
+	// Join the previous flush thread, if any.
+	// It has already finished, since flushRunning was false.
+	flushThread.join();
+	if (flushThread.create(flushThreadFunc, this) != 0) {
+		// Unable to start the flush thread.
+		// Save the achievements on this thread instead.
+		{
+			MutexLocker mtxLocker(mtxData);
+			flushRunning = false;
+		}
+		save();
+	}
+}
+
+/**
+ * Flush thread function.
+ * @param param AchievementsPrivate
+ */
+void AchievementsPrivate::flushThreadFunc(void *param)
+{
+	AchievementsPrivate *const d = static_cast<AchievementsPrivate*>(param);
+
+	// Save the achievements until there are no more changes.
+	// NOTE: Checking dirty and clearing flushRunning must be
+	// done atomically so changes aren't missed.
+	for (;;) {
+		d->save();
+
+		MutexLocker mtxLocker(d->mtxData);
+		if (!d->dirty) {
+			d->flushRunning = false;
+			break;
+		}
+	}
+}
+
 /**
  * Load the achievements data.
  * @return 0 on success; negative POSIX error code on error.
  */
 int AchievementsPrivate::load(void)
 {
-#if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
-	// Delay load verification.
-	// TODO: Only if linked with /DELAYLOAD?
-	if (DelayLoad_test_get_crc_table() != 0) {
-		// Delay load failed.
-		// Can't calculate the CRC32.
-		return -ENOTSUP;
-	}
-#endif /* defined(_MSC_VER) && defined(ZLIB_IS_DLL) */
-
 	// Clear loaded achievements.
 	loaded = false;
 	mapAchData.clear();
@@ -525,6 +658,11 @@ int AchievementsPrivate::load(void)
 			ret = -EIO;
 		}
 		file->unref();
+		if (ret == -ENOENT) {
+			// No achievements file yet.
+			// Don't check for it again.
+			loaded = true;
+		}
 		return ret;
 	}
 
@@ -599,7 +737,7 @@ int AchievementsPrivate::load(void)
 	buf.resize(data_len + HeaderSizeMinusCount);
 
 	// Verify the CRC32.
-	const uint32_t crc = crc32(0, &buf.data()[HeaderSizeMinusCount], data_len);
+	const uint32_t crc = rp_crc32(0, &buf.data()[HeaderSizeMinusCount], data_len);
 	if (crc != le32_to_cpu(header->crc32)) {
 		// Incorrect CRC32.
 		return -EBADF;
@@ -788,17 +926,6 @@ void Achievements::clearNotifyFunction(NotifyFunc func, intptr_t user_data)
  */
 int Achievements::unlock(ID id, int bit)
 {
-#if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
-	// Delay load verification.
-	// TODO: Only if linked with /DELAYLOAD?
-	if (DelayLoad_test_get_crc_table() != 0) {
-		// Delay load failed.
-		// We won't be able to calculate CRC32s, so don't
-		// enable achievements at all.
-		return -ENOTSUP;
-	}
-#endif /* defined(_MSC_VER) && defined(ZLIB_IS_DLL) */
-
 	// If this achievement is bool/count, increment the value.
 	// If the value has hit the maximum, achievement is unlocked.
 	assert((int)id >= 0);
@@ -808,78 +935,86 @@ int Achievements::unlock(ID id, int bit)
 		return -EINVAL;
 	}
 
-	// Make sure achievements have been loaded.
 	RP_D(Achievements);
-	if (!d->loaded) {
-		d->load();
-	}
-
-	// Check the type.
 	bool unlocked = false;
-	const AchievementsPrivate::AchInfo_t *const achInfo = &d->achInfo[(int)id];
-	switch (achInfo->type) {
-		default:
-			assert(!"Achievement type not supported.");
-			return -EINVAL;
-
-		case AchievementsPrivate::AT_COUNT: {
-			// Check if we've already reached the required count.
-			uint8_t count = d->mapAchData[id].count;
-			if (count >= achInfo->count) {
-				// Count has been reached.
-				// Achievement is already unlocked.
-				return 0;
-			}
-
-			// Increment the count.
-			count++;
-			d->mapAchData[id].count = count;
-			d->mapAchData[id].timestamp = time(nullptr);
-			if (count >= achInfo->count) {
-				// Achievement unlocked!
-				unlocked = true;
-			}
-			break;
+	{
+		MutexLocker mtxLocker(d->mtxData);
+
+		// Make sure achievements have been loaded.
+		// NOTE: Once achievements are modified, the in-memory data
+		// is authoritative, so the file won't be loaded again.
+		if (!d->loaded) {
+			d->load();
+			d->loaded = true;
 		}
 
-		case AchievementsPrivate::AT_BITFIELD: {
-			// Bitfield value.
-			assert(bit >= 0);
-			assert(bit < achInfo->count);
-			if (bit < 0 || bit >= achInfo->count) {
-				// Invalid bit index.
+		// Check the type.
+		const AchievementsPrivate::AchInfo_t *const achInfo = &d->achInfo[(int)id];
+		switch (achInfo->type) {
+			default:
+				assert(!"Achievement type not supported.");
 				return -EINVAL;
-			}
 
-			// Check if we've already filled the bitfield.
-			// TODO: Verify 32-bit and 64-bit operation for values 32 and 64.
-			const uint64_t bf_filled = (1ULL << achInfo->count) - 1;
-			uint64_t bf_value = d->mapAchData[id].bitfield;
-			if (bf_value == bf_filled) {
-				// Bitfield is already filled.
-				// Achievement is already unlocked.
-				return 0;
-			}
+			case AchievementsPrivate::AT_COUNT: {
+				// Check if we've already reached the required count.
+				uint8_t count = d->mapAchData[id].count;
+				if (count >= achInfo->count) {
+					// Count has been reached.
+					// Achievement is already unlocked.
+					return 0;
+				}
 
-			// Set the bit.
-			uint64_t bf_new = bf_value | (1ULL << (unsigned int)bit);
-			if (bf_new == bf_value) {
-				// No change.
-				return 0;
+				// Increment the count.
+				count++;
+				d->mapAchData[id].count = count;
+				d->mapAchData[id].timestamp = time(nullptr);
+				if (count >= achInfo->count) {
+					// Achievement unlocked!
+					unlocked = true;
+				}
+				break;
 			}
 
-			d->mapAchData[id].bitfield = bf_new;
-			d->mapAchData[id].timestamp = time(nullptr);
-			if (bf_new == bf_filled) {
-				// Achievement unlocked!
-				unlocked = true;
+			case AchievementsPrivate::AT_BITFIELD: {
+				// Bitfield value.
+				assert(bit >= 0);
+				assert(bit < achInfo->count);
+				if (bit < 0 || bit >= achInfo->count) {
+					// Invalid bit index.
+					return -EINVAL;
+				}
+
+				// Check if we've already filled the bitfield.
+				// TODO: Verify 32-bit and 64-bit operation for values 32 and 64.
+				const uint64_t bf_filled = (1ULL << achInfo->count) - 1;
+				uint64_t bf_value = d->mapAchData[id].bitfield;
+				if (bf_value == bf_filled) {
+					// Bitfield is already filled.
+					// Achievement is already unlocked.
+					return 0;
+				}
+
+				// Set the bit.
+				uint64_t bf_new = bf_value | (1ULL << (unsigned int)bit);
+				if (bf_new == bf_value) {
+					// No change.
+					return 0;
+				}
+
+				d->mapAchData[id].bitfield = bf_new;
+				d->mapAchData[id].timestamp = time(nullptr);
+				if (bf_new == bf_filled) {
+					// Achievement unlocked!
+					unlocked = true;
+				}
+				break;
 			}
-			break;
 		}
-	}
 
-	// Save the achievement data.
-	d->save();
+		// Save the achievement data in the background.
+		d->dirty = true;
+	}
+	d->scheduleSave();
 
 	if (unlocked) {
 		// Achievement unlocked!
@@ -898,17 +1033,6 @@ int Achievements::unlock(ID id, int bit)
  */
 time_t Achievements::isUnlocked(ID id) const
 {
-#if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
-	// Delay load verification.
-	// TODO: Only if linked with /DELAYLOAD?
-	if (DelayLoad_test_get_crc_table() != 0) {
-		// Delay load failed.
-		// We won't be able to calculate CRC32s, so don't
-		// enable achievements at all.
-		return -1;
-	}
-#endif /* defined(_MSC_VER) && defined(ZLIB_IS_DLL) */
-
 	// If this achievement is bool/count, increment the value.
 	// If the value has hit the maximum, achievement is unlocked.
 	assert((int)id >= 0);
@@ -920,6 +1044,7 @@ time_t Achievements::isUnlocked(ID id) const
 
 	// Make sure achievements have been loaded.
 	RP_D(const Achievements);
+	MutexLocker mtxLocker(d->mtxData);
 	if (!d->loaded) {
 		const_cast<AchievementsPrivate*>(d)->load();
 	}
@@ -20,6 +20,7 @@ using std::string;
 using std::vector;
 
 // librpfile, librptexture
+#include "librpfile/RpTrace.hpp"
 #include "librptexture/img/rp_image.hpp"
 using LibRpFile::IRpFile;
 using LibRpFile::RpFile;
@@ -42,6 +43,9 @@ RomDataPrivate::RomDataPrivate(RomData *q, IRpFile *file)
 	, file(nullptr)
 	, fields(new RomFields())
 	, metaData(nullptr)
+#ifdef _DEBUG
+	, inLoadMetaData(false)
+#endif /* _DEBUG */
 	, className(nullptr)
 	, mimeType(nullptr)
 	, fileType(RomData::FileType::ROM_Image)
@@ -536,6 +540,38 @@ IRpFile *RomData::ref_file(void)
 	return (d->file ? d->file->ref() : nullptr);
 }
 
+/**
+ * Get the approximate amount of memory used by this object,
+ * including cached parse buffers and decoded images.
+ * Subclasses that cache large buffers should override this
+ * and add their own usage to the superclass's.
+ * @return Approximate memory usage, in bytes.
+ */
+size_t RomData::memoryUsage(void) const
+{
+	RP_D(const RomData);
+	size_t total = d->fields->count() * sizeof(RomFields::Field);
+	if (d->metaData) {
+		total += d->metaData->count() * sizeof(RomMetaData::MetaData);
+	}
+	return total;
+}
+
+/**
+ * Release cached parse buffers and decoded images
+ * that can be rebuilt on demand from the open file.
+ *
+ * Images previously returned by image() are invalidated
+ * unless they were ref()'d by the caller, so this must
+ * only be called if nothing else is using this object.
+ */
+void RomData::releaseMemory(void)
+{
+	// Nothing is cached by the base class.
+	// (RomFields and RomMetaData are kept, since
+	// pointers to them may have been returned.)
+}
+
 /**
  * Get the filename that was loaded.
  * @return Filename, or nullptr on error.
@@ -747,9 +783,35 @@ int RomData::loadInternalImage(ImageType imageType, const rp_image **pImage)
 	return -ENOENT;
 }
 
+/**
+ * Load an internal image with a specific size.
+ * Called by RomData::image() if an image size was requested.
+ *
+ * The default implementation ignores the size index
+ * and calls loadInternalImage().
+ *
+ * @param imageType	[in] Image type to load.
+ * @param index		[in] Image index, from ImageSizeDef::index.
+ * @param pImage	[out] Pointer to const rp_image* to store the image in.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomData::loadInternalImageSize(ImageType imageType, unsigned int index, const rp_image **pImage)
+{
+	// Only one size is supported by default.
+	RP_UNUSED(index);
+	return loadInternalImage(imageType, pImage);
+}
+
 /**
  * Load metadata properties.
  * Called by RomData::metaData() if the field data hasn't been loaded yet.
+ *
+ * This is used by desktop indexers, so it must be fast:
+ * it must not load the RomFields or decode images.
+ * Shared parsing should be done by RomDataPrivate helpers
+ * that both loadFieldData() and loadMetaData() can call.
+ * (Debug builds assert if fields() or image() is called.)
+ *
  * @return Number of metadata properties read on success; negative POSIX error code on error.
  */
 int RomData::loadMetaData(void)
@@ -765,9 +827,14 @@ int RomData::loadMetaData(void)
 const RomFields *RomData::fields(void) const
 {
 	RP_D(const RomData);
+#ifdef _DEBUG
+	// loadMetaData() must not load the field data.
+	assert(!d->inLoadMetaData);
+#endif /* _DEBUG */
 	if (d->fields->empty()) {
 		// Data has not been loaded.
 		// Load it now.
+		RP_TRACE_SCOPE_D("RomData::loadFieldData", d->className);
 		int ret = const_cast<RomData*>(this)->loadFieldData();
 		if (ret < 0)
 			return nullptr;
@@ -785,7 +852,17 @@ const RomMetaData *RomData::metaData(void) const
 	if (!d->metaData || d->metaData->empty()) {
 		// Data has not been loaded.
 		// Load it now.
+#ifdef _DEBUG
+		RomDataPrivate *const dw = const_cast<RomDataPrivate*>(d);
+		const bool fieldsWereEmpty = d->fields->empty();
+		dw->inLoadMetaData = true;
 		int ret = const_cast<RomData*>(this)->loadMetaData();
+		dw->inLoadMetaData = false;
+		// loadMetaData() must not load the field data.
+		assert(!fieldsWereEmpty || d->fields->empty());
+#else /* !_DEBUG */
+		int ret = const_cast<RomData*>(this)->loadMetaData();
+#endif /* _DEBUG */
 		if (ret < 0)
 			return nullptr;
 	}
@@ -810,6 +887,12 @@ const rp_image *RomData::image(ImageType imageType) const
 	}
 	// TODO: Check supportedImageTypes()?
 
+#ifdef _DEBUG
+	// loadMetaData() must not decode images.
+	RP_D(const RomData);
+	assert(!d->inLoadMetaData);
+#endif /* _DEBUG */
+
 	// Load the internal image.
 	// The subclass maintains ownership of the image.
 #ifdef _DEBUG
@@ -819,7 +902,11 @@ const rp_image *RomData::image(ImageType imageType) const
 #else /* !_DEBUG */
 	const rp_image *img;
 #endif
-	int ret = const_cast<RomData*>(this)->loadInternalImage(imageType, &img);
+	int ret;
+	{
+		RP_TRACE_SCOPE_D("RomData::loadInternalImage", d_ptr->className);
+		ret = const_cast<RomData*>(this)->loadInternalImage(imageType, &img);
+	}
 
 	// SANITY CHECK: If loadInternalImage() returns 0,
 	// img *must* be valid. Otherwise, it must be nullptr.
@@ -832,6 +919,60 @@ const rp_image *RomData::image(ImageType imageType) const
 	return (ret == 0 ? img : nullptr);
 }
 
+/**
+ * Get an internal image from the ROM, using the specified size.
+ *
+ * If the image is available in multiple sizes, the smallest
+ * image that is at least as large as the requested size will
+ * be returned. This is useful for textures with mipmaps, since
+ * the full image doesn't need to be decoded for a thumbnail.
+ *
+ * The retrieved image must be ref()'d by the caller if the
+ * caller stores it instead of using it immediately.
+ *
+ * @param imageType Image type to load.
+ * @param size Requested image size. This may be a requested
+ *             thumbnail size in pixels, or an ImageSizeType
+ *             enum value.
+ * @return Internal image, or nullptr if the ROM doesn't have one.
+ */
+const rp_image *RomData::image(ImageType imageType, int size) const
+{
+	assert(imageType >= IMG_INT_MIN && imageType <= IMG_INT_MAX);
+	if (imageType < IMG_INT_MIN || imageType > IMG_INT_MAX) {
+		// ImageType is out of range.
+		return nullptr;
+	}
+
+	const vector<ImageSizeDef> sizeDefs = supportedImageSizes(imageType);
+	const ImageSizeDef *const sizeDef = RomDataPrivate::selectBestSize(sizeDefs, size);
+	if (!sizeDef || sizeDef == &sizeDefs[0]) {
+		// Default image size.
+		return image(imageType);
+	}
+
+	// Load the internal image with the selected size.
+	// The subclass maintains ownership of the image.
+	const rp_image *img = nullptr;
+	int ret;
+	{
+		RP_TRACE_SCOPE_D("RomData::loadInternalImage", d_ptr->className);
+		ret = const_cast<RomData*>(this)->loadInternalImageSize(imageType, sizeDef->index, &img);
+	}
+
+	// SANITY CHECK: If loadInternalImageSize() returns 0,
+	// img *must* be valid. Otherwise, it must be nullptr.
+	assert((ret == 0 && img != nullptr) ||
+	       (ret != 0 && img == nullptr));
+
+	if (ret != 0 || !img) {
+		// Unable to load the selected size.
+		// Fall back to the default image.
+		return image(imageType);
+	}
+	return img;
+}
+
 /**
  * Get a list of URLs for an external image type.
  *
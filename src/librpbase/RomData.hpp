@@ -111,6 +111,25 @@ class RomData : public RefBase
 		 */
 		LibRpFile::IRpFile *ref_file(void);
 
+		/**
+		 * Get the approximate amount of memory used by this object,
+		 * including cached parse buffers and decoded images.
+		 * Subclasses that cache large buffers should override this
+		 * and add their own usage to the superclass's.
+		 * @return Approximate memory usage, in bytes.
+		 */
+		virtual size_t memoryUsage(void) const;
+
+		/**
+		 * Release cached parse buffers and decoded images
+		 * that can be rebuilt on demand from the open file.
+		 *
+		 * Images previously returned by image() are invalidated
+		 * unless they were ref()'d by the caller, so this must
+		 * only be called if nothing else is using this object.
+		 */
+		virtual void releaseMemory(void);
+
 		/**
 		 * Get the filename that was loaded.
 		 * @return Filename, or nullptr on error.
@@ -417,6 +436,13 @@ class RomData : public RefBase
 		/**
 		 * Load metadata properties.
 		 * Called by RomData::metaData() if the field data hasn't been loaded yet.
+		 *
+		 * This is used by desktop indexers, so it must be fast:
+		 * it must not load the RomFields or decode images.
+		 * Shared parsing should be done by RomDataPrivate helpers
+		 * that both loadFieldData() and loadMetaData() can call.
+		 * (Debug builds assert if fields() or image() is called.)
+		 *
 		 * @return Number of metadata properties read on success; negative POSIX error code on error.
 		 */
 		virtual int loadMetaData(void);
@@ -433,6 +459,20 @@ class RomData : public RefBase
 		 */
 		virtual int loadInternalImage(ImageType imageType, const LibRpTexture::rp_image **pImage);
 
+		/**
+		 * Load an internal image with a specific size.
+		 * Called by RomData::image() if an image size was requested.
+		 *
+		 * The default implementation ignores the size index
+		 * and calls loadInternalImage().
+		 *
+		 * @param imageType	[in] Image type to load.
+		 * @param index		[in] Image index, from ImageSizeDef::index.
+		 * @param pImage	[out] Pointer to const rp_image* to store the image in.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		virtual int loadInternalImageSize(ImageType imageType, unsigned int index, const LibRpTexture::rp_image **pImage);
+
 	public:
 		/**
 		 * Get the ROM Fields object.
@@ -466,6 +506,25 @@ class RomData : public RefBase
 		 */
 		const LibRpTexture::rp_image *image(ImageType imageType) const;
 
+		/**
+		 * Get an internal image from the ROM, using the specified size.
+		 *
+		 * If the image is available in multiple sizes, the smallest
+		 * image that is at least as large as the requested size will
+		 * be returned. This is useful for textures with mipmaps, since
+		 * the full image doesn't need to be decoded for a thumbnail.
+		 *
+		 * The retrieved image must be ref()'d by the caller if the
+		 * caller stores it instead of using it immediately.
+		 *
+		 * @param imageType Image type to load.
+		 * @param size Requested image size. This may be a requested
+		 *             thumbnail size in pixels, or an ImageSizeType
+		 *             enum value.
+		 * @return Internal image, or nullptr if the ROM doesn't have one.
+		 */
+		const LibRpTexture::rp_image *image(ImageType imageType, int size) const;
+
 		/**
 		 * External URLs for a media type.
 		 * Includes URL and "cache key" for local caching,
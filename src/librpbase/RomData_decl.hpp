@@ -204,6 +204,22 @@ class klass final : public LibRpBase::RomData { \
 		 */ \
 		int loadInternalImage(ImageType imageType, const LibRpTexture::rp_image **pImage) final;
 
+/**
+ * RomData subclass function declaration for loading internal images
+ * with a specific size. (e.g. texture mipmaps)
+ */
+#define ROMDATA_DECL_IMGINT_SIZE() \
+	public: \
+		/** \
+		 * Load an internal image with a specific size. \
+		 * Called by RomData::image() if an image size was requested. \
+		 * @param imageType	[in] Image type to load. \
+		 * @param index		[in] Image index, from ImageSizeDef::index. \
+		 * @param pImage	[out] Pointer to const rp_image* to store the image in. \
+		 * @return 0 on success; negative POSIX error code on error. \
+		 */ \
+		int loadInternalImageSize(ImageType imageType, unsigned int index, const LibRpTexture::rp_image **pImage) final;
+
 /**
  * RomData subclass function declaration for obtaining URLs for external images.
  */
@@ -300,6 +316,23 @@ class klass final : public LibRpBase::RomData { \
 		 */ \
 		void close(void) final;
 
+/**
+ * RomData subclass function declarations for memory accounting.
+ * Only needed if large parse buffers or images are cached.
+ */
+#define ROMDATA_DECL_MEMORY() \
+	public: \
+		/** \
+		 * Get the approximate amount of memory used by this object. \
+		 * @return Approximate memory usage, in bytes. \
+		 */ \
+		size_t memoryUsage(void) const final; \
+		\
+		/** \
+		 * Release cached data that can be rebuilt on demand. \
+		 */ \
+		void releaseMemory(void) final;
+
 /**
  * End of RomData subclass declaration.
  */
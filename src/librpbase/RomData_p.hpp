@@ -59,6 +59,9 @@ class RomDataPrivate
 		std::string filename;		// Copy of the filename.
 		RomFields *const fields;	// ROM fields. (NOTE: allocated by the base class)
 		RomMetaData *metaData;		// ROM metadata. (NOTE: nullptr initially.)
+#ifdef _DEBUG
+		bool inLoadMetaData;		// True while loadMetaData() is running.
+#endif /* _DEBUG */
 
 	public:
 		/** These fields must be set by RomData subclasses in their constructors. **/
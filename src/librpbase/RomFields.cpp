@@ -15,6 +15,8 @@
 #include "librpthreads/Atomics.h"
 
 // C++ STL classes.
+#include <new>
+#include <utility>
 using std::map;
 using std::string;
 using std::unique_ptr;
@@ -52,6 +54,46 @@ class RomFieldsPrivate
 		 * The vector will be cleared afterwards.
 		 */
 		void delete_data(void);
+
+	public:
+		/** Arena allocator **/
+		// Field names and small fixed-size field data are allocated
+		// from memory blocks owned by RomFields instead of being
+		// allocated separately. Arena memory is only freed when
+		// the fields are deleted.
+
+		// Arena block size.
+		static const size_t ARENA_BLOCK_SIZE = 4096;
+
+		vector<unique_ptr<char[]> > arena_blocks;
+		size_t arena_used;	// Bytes used in the last block
+
+		/**
+		 * Allocate memory from the arena.
+		 * @param size Size, in bytes.
+		 * @return Memory, aligned for any fundamental type.
+		 */
+		void *arena_alloc(size_t size);
+
+		/**
+		 * Copy a string into the arena.
+		 * @param str String.
+		 * @return Copy of the string in the arena.
+		 */
+		const char *arena_strdup(const char *str);
+
+		/**
+		 * Allocate a std::string in the arena.
+		 * The std::string object itself is stored in the arena;
+		 * its destructor is called by delete_data().
+		 * @param str String.
+		 * @return std::string in the arena.
+		 */
+		template<typename T>
+		inline string *arena_new_string(T &&str)
+		{
+			return new (arena_alloc(sizeof(string))) string(std::forward<T>(str));
+		}
 };
 
 /** RomFieldsPrivate **/
@@ -59,6 +101,7 @@ class RomFieldsPrivate
 RomFieldsPrivate::RomFieldsPrivate()
 	: tabIdx(0)
 	, def_lc(0)
+	, arena_used(ARENA_BLOCK_SIZE)
 { }
 
 RomFieldsPrivate::~RomFieldsPrivate()
@@ -88,7 +131,10 @@ void RomFieldsPrivate::delete_data(void)
 					break;
 
 				case RomFields::RFT_STRING:
-					delete const_cast<string*>(field.data.str);
+					// NOTE: Allocated in the arena.
+					if (field.data.str) {
+						const_cast<string*>(field.data.str)->~string();
+					}
 					break;
 				case RomFields::RFT_BITFIELD:
 					delete const_cast<vector<string>*>(field.desc.bitfield.names);
@@ -105,7 +151,7 @@ void RomFieldsPrivate::delete_data(void)
 					}
 					break;
 				case RomFields::RFT_AGE_RATINGS:
-					delete const_cast<RomFields::age_ratings_t*>(field.data.age_ratings);
+					// NOTE: Allocated in the arena.
 					break;
 				case RomFields::RFT_STRING_MULTI:
 					delete const_cast<RomFields::StringMultiMap_t*>(field.data.str_multi);
@@ -120,6 +166,55 @@ void RomFieldsPrivate::delete_data(void)
 
 	// Clear the fields vector.
 	this->fields.clear();
+
+	// Free the arena.
+	arena_blocks.clear();
+	arena_used = ARENA_BLOCK_SIZE;
+}
+
+/**
+ * Allocate memory from the arena.
+ * @param size Size, in bytes.
+ * @return Memory, aligned for any fundamental type.
+ */
+void *RomFieldsPrivate::arena_alloc(size_t size)
+{
+	// Round up to the maximum fundamental alignment.
+	static const size_t align = 16;
+	size = (size + (align - 1)) & ~(align - 1);
+
+	if (size > ARENA_BLOCK_SIZE / 4) {
+		// Large allocation. Use a separate block, and insert it
+		// before the last block so the last block can still be used.
+		// NOTE: new[] returns memory suitably aligned for any fundamental type.
+		char *const block = new char[size];
+		const auto pos = (arena_blocks.empty() ? arena_blocks.end() : arena_blocks.end() - 1);
+		arena_blocks.emplace(pos, block);
+		return block;
+	}
+
+	if (arena_used + size > ARENA_BLOCK_SIZE) {
+		// Start a new block.
+		arena_blocks.emplace_back(new char[ARENA_BLOCK_SIZE]);
+		arena_used = 0;
+	}
+
+	char *const ptr = arena_blocks.back().get() + arena_used;
+	arena_used += size;
+	return ptr;
+}
+
+/**
+ * Copy a string into the arena.
+ * @param str String.
+ * @return Copy of the string in the arena.
+ */
+const char *RomFieldsPrivate::arena_strdup(const char *str)
+{
+	const size_t len = strlen(str) + 1;
+	char *const ptr = static_cast<char*>(arena_alloc(len));
+	memcpy(ptr, str, len);
+	return ptr;
 }
 
 /** RomFields **/
@@ -724,7 +819,7 @@ int RomFields::addFields_romFields(const RomFields *other, int tabOffset)
 		const Field &field_src = *old_iter;
 		Field &field_dest = d->fields.at(idx);
 
-		field_dest.name = field_src.name;
+		field_dest.name = d->arena_strdup(field_src.name);
 		field_dest.type = field_src.type;
 		field_dest.tabIdx = (tabOffset != -1 ? (field_src.tabIdx + tabOffset) : d->tabIdx);
 		field_dest.isValid = field_src.isValid;
@@ -736,7 +831,7 @@ int RomFields::addFields_romFields(const RomFields *other, int tabOffset)
 				break;
 
 			case RFT_STRING:
-				field_dest.data.str = (field_src.data.str ? new string(*field_src.data.str) : nullptr);
+				field_dest.data.str = (field_src.data.str ? d->arena_new_string(*field_src.data.str) : nullptr);
 				break;
 			case RFT_BITFIELD:
 				field_dest.desc.bitfield.elemsPerRow = field_src.desc.bitfield.elemsPerRow;
@@ -769,6 +864,10 @@ int RomFields::addFields_romFields(const RomFields *other, int tabOffset)
 					field_dest.data.list_data.mxd.icons = (field_src.data.list_data.mxd.icons
 						? new ListDataIcons_t(*(field_src.data.list_data.mxd.icons))
 						: nullptr);
+					// NOTE: The deferred icon loader belongs to the source
+					// RomData object, which must outlive this RomFields.
+					field_dest.data.list_data.iconLoader =
+						field_src.data.list_data.iconLoader;
 				} else {
 					// No icons. Copy checkboxes.
 					field_dest.data.list_data.mxd.checkboxes =
@@ -780,7 +879,7 @@ int RomFields::addFields_romFields(const RomFields *other, int tabOffset)
 				break;
 			case RFT_AGE_RATINGS:
 				field_dest.data.age_ratings = (field_src.data.age_ratings
-						? new age_ratings_t(*field_src.data.age_ratings)
+						? new (d->arena_alloc(sizeof(age_ratings_t))) age_ratings_t(*field_src.data.age_ratings)
 						: nullptr);
 				break;
 			case RFT_DIMENSIONS:
@@ -821,8 +920,8 @@ int RomFields::addField_string(const char *name, const char *str, unsigned int f
 	d->fields.resize(idx+1);
 	Field &field = d->fields.at(idx);
 
-	string *const nstr = (str ? new string(str) : nullptr);
-	field.name = name;
+	string *const nstr = (str ? d->arena_new_string(str) : nullptr);
+	field.name = d->arena_strdup(name);
 	field.type = RFT_STRING;
 	field.desc.flags = flags;
 	field.data.str = nstr;
@@ -855,8 +954,43 @@ int RomFields::addField_string(const char *name, const string &str, unsigned int
 	d->fields.resize(idx+1);
 	Field &field = d->fields.at(idx);
 
-	string *const nstr = (!str.empty() ? new string(str) : nullptr);
-	field.name = name;
+	string *const nstr = (!str.empty() ? d->arena_new_string(str) : nullptr);
+	field.name = d->arena_strdup(name);
+	field.type = RFT_STRING;
+	field.desc.flags = flags;
+	field.data.str = nstr;
+	field.tabIdx = d->tabIdx;
+	field.isValid = true;
+
+	// Handle string trimming flags.
+	if (nstr && (flags & STRF_TRIM_END)) {
+		trimEnd(*nstr);
+	}
+	return static_cast<int>(idx);
+}
+
+/**
+ * Add string field data.
+ * The string is moved into the RomFields object.
+ * @param name Field name.
+ * @param str String.
+ * @param flags Formatting flags.
+ * @return Field index.
+ */
+int RomFields::addField_string(const char *name, string &&str, unsigned int flags)
+{
+	assert(name != nullptr);
+	if (!name)
+		return -1;
+
+	// RFT_STRING
+	RP_D(RomFields);
+	size_t idx = d->fields.size();
+	d->fields.resize(idx+1);
+	Field &field = d->fields.at(idx);
+
+	string *const nstr = (!str.empty() ? d->arena_new_string(std::move(str)) : nullptr);
+	field.name = d->arena_strdup(name);
 	field.type = RFT_STRING;
 	field.desc.flags = flags;
 	field.data.str = nstr;
@@ -899,8 +1033,7 @@ int RomFields::addField_string_numeric(const char *name, uint32_t val, Base base
 			break;
 	}
 
-	const string str = rp_sprintf(fmtstr, digits, val);
-	return addField_string(name, str, flags);
+	return addField_string(name, rp_sprintf(fmtstr, digits, val), flags);
 }
 
 /**
@@ -995,7 +1128,7 @@ int RomFields::addField_string_address_range(const char *name,
 		str += suffix;
 	}
 
-	return addField_string(name, str, flags);
+	return addField_string(name, std::move(str), flags);
 }
 
 /**
@@ -1022,7 +1155,7 @@ int RomFields::addField_bitfield(const char *name,
 	d->fields.resize(idx+1);
 	Field &field = d->fields.at(idx);
 
-	field.name = name;
+	field.name = d->arena_strdup(name);
 	field.type = RFT_BITFIELD;
 	field.desc.bitfield.elemsPerRow = elemsPerRow;
 	field.desc.bitfield.names = bit_names;
@@ -1070,7 +1203,7 @@ int RomFields::addField_listData(const char *name, const AFLD_PARAMS *params)
 	d->fields.resize(idx+1);
 	Field &field = d->fields.at(idx);
 
-	field.name = name;
+	field.name = d->arena_strdup(name);
 	field.type = RFT_LISTDATA;
 	field.desc.list_data.flags = params->flags;
 	assert(params->rows_visible >= 0);
@@ -1099,6 +1232,7 @@ int RomFields::addField_listData(const char *name, const AFLD_PARAMS *params)
 		assert(params->mxd.icons != nullptr);
 		if (params->mxd.icons) {
 			field.data.list_data.mxd.icons = params->mxd.icons;
+			field.data.list_data.iconLoader = params->iconLoader;
 		} else {
 			// No icons. Remove the flag.
 			field.desc.list_data.flags &= ~RFT_LISTDATA_ICONS;
@@ -1109,6 +1243,48 @@ int RomFields::addField_listData(const char *name, const AFLD_PARAMS *params)
 	return static_cast<int>(idx);
 }
 
+/**
+ * Get an icon from an RFT_LISTDATA_ICONS field.
+ *
+ * If the field has a deferred icon loader and the icon
+ * hasn't been loaded yet, it's loaded now. UI frontends
+ * should call this when a row is shown instead of reading
+ * the icons vector directly.
+ *
+ * @param field	[in] RFT_LISTDATA field
+ * @param row	[in] Row index
+ * @return Icon, or nullptr if the row doesn't have an icon.
+ */
+const rp_image *RomFields::listDataIcon(const Field &field, unsigned int row)
+{
+	assert(field.type == RFT_LISTDATA);
+	assert(field.desc.list_data.flags & RFT_LISTDATA_ICONS);
+	if (field.type != RFT_LISTDATA ||
+	    !(field.desc.list_data.flags & RFT_LISTDATA_ICONS))
+	{
+		// Not an RFT_LISTDATA field with icons.
+		return nullptr;
+	}
+
+	const ListDataIcons_t *const icons = field.data.list_data.mxd.icons;
+	if (!icons || row >= icons->size()) {
+		return nullptr;
+	}
+
+	const rp_image *icon = (*icons)[row];
+	if (!icon && field.data.list_data.iconLoader.func) {
+		// Load the deferred icon.
+		const ListDataIconLoader_t &loader = field.data.list_data.iconLoader;
+		icon = loader.func(loader.userdata, row);
+		if (icon) {
+			// Save the icon for next time.
+			// NOTE: The icons vector is owned by RomFields.
+			(*const_cast<ListDataIcons_t*>(icons))[row] = icon;
+		}
+	}
+	return icon;
+}
+
 /**
  * Add DateTime.
  * @param name Field name.
@@ -1128,7 +1304,7 @@ int RomFields::addField_dateTime(const char *name, time_t date_time, unsigned in
 	d->fields.resize(idx+1);
 	Field &field = d->fields.at(idx);
 
-	field.name = name;
+	field.name = d->arena_strdup(name);
 	field.type = RFT_DATETIME;
 	field.desc.flags = flags;
 	field.data.date_time = date_time;
@@ -1156,9 +1332,9 @@ int RomFields::addField_ageRatings(const char *name, const age_ratings_t &age_ra
 	d->fields.resize(idx+1);
 	Field &field = d->fields.at(idx);
 
-	field.name = name;
+	field.name = d->arena_strdup(name);
 	field.type = RFT_AGE_RATINGS;
-	field.data.age_ratings = new age_ratings_t(age_ratings);
+	field.data.age_ratings = new (d->arena_alloc(sizeof(age_ratings_t))) age_ratings_t(age_ratings);
 	field.tabIdx = d->tabIdx;
 	field.isValid = true;
 	return static_cast<int>(idx);
@@ -1184,7 +1360,7 @@ int RomFields::addField_dimensions(const char *name, int dimX, int dimY, int dim
 	d->fields.resize(idx+1);
 	Field &field = d->fields.at(idx);
 
-	field.name = name;
+	field.name = d->arena_strdup(name);
 	field.type = RFT_DIMENSIONS;
 	field.data.dimensions[0] = dimX;
 	field.data.dimensions[1] = dimY;
@@ -1219,7 +1395,7 @@ int RomFields::addField_string_multi(const char *name, const StringMultiMap_t *s
 		d->def_lc = def_lc;
 	}
 
-	field.name = name;
+	field.name = d->arena_strdup(name);
 	field.type = RFT_STRING_MULTI;
 	field.desc.flags = flags;
 	field.data.str_multi = (str_multi ? str_multi : nullptr);
@@ -241,10 +241,25 @@ class RomFields
 		typedef std::map<uint32_t, ListData_t> ListDataMultiMap_t;
 		typedef std::vector<const LibRpTexture::rp_image*> ListDataIcons_t;
 
+		/**
+		 * Deferred icon loader for RFT_LISTDATA_ICONS.
+		 * Called by listDataIcon() for rows whose icon is nullptr.
+		 * @param userdata	[in] User data, from AFLD_PARAMS::iconLoader.
+		 * @param row		[in] Row index.
+		 * @return Icon, or nullptr if the row doesn't have an icon. (owned by the RomData subclass)
+		 */
+		typedef const LibRpTexture::rp_image *(*pfnListDataIconLoader_t)(void *userdata, unsigned int row);
+
+		// Deferred icon loader. (RFT_LISTDATA_ICONS)
+		struct ListDataIconLoader_t {
+			pfnListDataIconLoader_t func;	// nullptr if icons aren't deferred
+			void *userdata;
+		};
+
 		// ROM field struct.
 		// Dynamically allocated.
 		struct Field {
-			std::string name;	// Field name.
+			const char *name;	// Field name. (owned by RomFields)
 			RomFieldType type;	// ROM field type.
 			uint8_t tabIdx;		// Tab index. (0 for default)
 			bool isValid;		// True if this field has valid data.
@@ -311,6 +326,11 @@ class RomFields
 						// Requires RFT_LISTDATA_ICONS.
 						const ListDataIcons_t *icons;
 					} mxd;
+
+					// Deferred icon loader.
+					// Requires RFT_LISTDATA_ICONS.
+					// Use listDataIcon() to get an icon.
+					ListDataIconLoader_t iconLoader;
 				} list_data;
 
 				// RFT_DATETIME (UNIX format)
@@ -548,6 +568,16 @@ class RomFields
 		 */
 		int addField_string(const char *name, const std::string &str, unsigned int flags = 0);
 
+		/**
+		 * Add string field data.
+		 * The string is moved into the RomFields object.
+		 * @param name Field name.
+		 * @param str String.
+		 * @param flags Formatting flags.
+		 * @return Field index.
+		 */
+		int addField_string(const char *name, std::string &&str, unsigned int flags = 0);
+
 		enum class Base {
 			Dec,	// Decimal (Base 10)
 			Hex,	// Hexadecimal (Base 16)
@@ -637,6 +667,8 @@ class RomFields
 
 				data.single = nullptr;
 				mxd.icons = nullptr;
+				iconLoader.func = nullptr;
+				iconLoader.userdata = nullptr;
 			}
 			AFLD_PARAMS(unsigned int flags, int rows_visible)
 				: flags(flags), rows_visible(rows_visible)
@@ -653,6 +685,8 @@ class RomFields
 
 				data.single = nullptr;
 				mxd.icons = nullptr;
+				iconLoader.func = nullptr;
+				iconLoader.userdata = nullptr;
 			}
 
 			// Formatting
@@ -682,6 +716,12 @@ class RomFields
 				// Requires RFT_LISTDATA_ICONS.
 				const std::vector<const LibRpTexture::rp_image*> *icons;
 			} mxd;
+
+			// Deferred icon loader. (optional)
+			// Requires RFT_LISTDATA_ICONS.
+			// If set, rows with a nullptr icon are loaded
+			// by listDataIcon() when they're first shown.
+			ListDataIconLoader_t iconLoader;
 		};
 
 		/**
@@ -697,6 +737,20 @@ class RomFields
 		 */
 		int addField_listData(const char *name, const AFLD_PARAMS *params);
 
+		/**
+		 * Get an icon from an RFT_LISTDATA_ICONS field.
+		 *
+		 * If the field has a deferred icon loader and the icon
+		 * hasn't been loaded yet, it's loaded now. UI frontends
+		 * should call this when a row is shown instead of reading
+		 * the icons vector directly.
+		 *
+		 * @param field	[in] RFT_LISTDATA field
+		 * @param row	[in] Row index
+		 * @return Icon, or nullptr if the row doesn't have an icon.
+		 */
+		static const LibRpTexture::rp_image *listDataIcon(const Field &field, unsigned int row);
+
 		/**
 		 * Add DateTime.
 		 * @param name Field name.
@@ -45,6 +45,9 @@ class RomMetaDataPrivate
 		// Property type mapping.
 		static const PropertyType PropertyTypeMap[];
 
+		// Property name mapping.
+		static const char *const PropertyNameMap[];
+
 		/**
 		 * Add or overwrite a Property.
 		 * @param name Property name.
@@ -147,10 +150,105 @@ const PropertyType RomMetaDataPrivate::PropertyTypeMap[] = {
 	PropertyType::String,	// License
 };
 
+// Property name mapping.
+// These match the Property enum names.
+const char *const RomMetaDataPrivate::PropertyNameMap[] = {
+	"Empty",
+
+	// Audio
+	"BitRate",
+	"Channels",
+	"Duration",
+	"Genre",
+	"SampleRate",
+	"TrackNumber",
+	"ReleaseYear",
+	"Comment",
+	"Artist",
+	"Album",
+	"AlbumArtist",
+	"Composer",
+	"Lyricist",
+
+	// Document
+	"Author",
+	"Title",
+	"Subject",
+	"Generator",
+	"PageCount",
+	"WordCount",
+	"LineCount",
+	"Language",
+	"Copyright",
+	"Publisher",
+	"CreationDate",
+	"Keywords",
+
+	// Media
+	"Width",
+	"Height",
+	"AspectRatio",
+	"FrameRate",
+
+	// Images
+	"ImageMake",
+	"ImageModel",
+	"ImageDateTime",
+	"ImageOrientation",
+	"PhotoFlash",
+	"PhotoPixelXDimension",
+	"PhotoPixelYDimension",
+	"PhotoDateTimeOriginal",
+	"PhotoFocalLength",
+	"PhotoFocalLengthIn35mmFilm",
+	"PhotoExposureTime",
+	"PhotoFNumber",
+	"PhotoApertureValue",
+	"PhotoExposureBiasValue",
+	"PhotoWhiteBalance",
+	"PhotoMeteringMode",
+	"PhotoISOSpeedRatings",
+	"PhotoSaturation",
+	"PhotoSharpness",
+	"PhotoGpsLatitude",
+	"PhotoGpsLongitude",
+	"PhotoGpsAltitude",
+
+	// Translations
+	"TranslationUnitsTotal",
+	"TranslationUnitsWithTranslation",
+	"TranslationUnitsWithDraftTranslation",
+	"TranslationLastAuthor",
+	"TranslationLastUpDate",
+	"TranslationTemplateDate",
+
+	// Origin
+	"OriginUrl",
+	"OriginEmailSubject",
+	"OriginEmailSender",
+	"OriginEmailMessageId",
+
+	// Audio
+	"DiscNumber",
+	"Location",
+	"Performer",
+	"Ensemble",
+	"Arranger",
+	"Conductor",
+	"Opus",
+
+	// Other
+	"Label",
+	"Compilation",
+	"License",
+};
+
 RomMetaDataPrivate::RomMetaDataPrivate()
 {
 	static_assert(ARRAY_SIZE(RomMetaDataPrivate::PropertyTypeMap) == (int)Property::PropertyCount,
 		      "PropertyTypeMap needs to be updated!");
+	static_assert(ARRAY_SIZE(RomMetaDataPrivate::PropertyNameMap) == (int)Property::PropertyCount,
+		      "PropertyNameMap needs to be updated!");
 	map_metaData.fill(Property::Invalid);
 }
 
@@ -292,6 +390,42 @@ bool RomMetaData::empty(void) const
 	return d->metaData.empty();
 }
 
+/** Property names. **/
+
+/**
+ * Get the name of a Property.
+ * The name matches the Property enum identifier.
+ * @param name Property.
+ * @return Property name, or nullptr if the Property is invalid.
+ */
+const char *RomMetaData::getPropertyName(Property name)
+{
+	assert(name > Property::FirstProperty);
+	assert(name < Property::PropertyCount);
+	if (name <= Property::FirstProperty || name >= Property::PropertyCount)
+		return nullptr;
+	return RomMetaDataPrivate::PropertyNameMap[(int)name];
+}
+
+/**
+ * Look up a Property by name. (case-insensitive)
+ * @param name Property name.
+ * @return Property, or Property::Invalid if not found.
+ */
+Property RomMetaData::getPropertyByName(const char *name)
+{
+	assert(name != nullptr);
+	if (!name || name[0] == '\0')
+		return Property::Invalid;
+
+	for (int i = (int)Property::FirstProperty + 1; i < (int)Property::PropertyCount; i++) {
+		if (!strcasecmp(name, RomMetaDataPrivate::PropertyNameMap[i])) {
+			return static_cast<Property>(i);
+		}
+	}
+	return Property::Invalid;
+}
+
 /** Convenience functions for RomData subclasses. **/
 
 /**
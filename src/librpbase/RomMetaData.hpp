@@ -210,6 +210,24 @@ class RomMetaData
 		 */
 		bool empty(void) const;
 
+	public:
+		/** Property names. **/
+
+		/**
+		 * Get the name of a Property.
+		 * The name matches the Property enum identifier.
+		 * @param name Property.
+		 * @return Property name, or nullptr if the Property is invalid.
+		 */
+		static const char *getPropertyName(Property name);
+
+		/**
+		 * Look up a Property by name. (case-insensitive)
+		 * @param name Property name.
+		 * @return Property, or Property::Invalid if not found.
+		 */
+		static Property getPropertyByName(const char *name);
+
 	public:
 		/** Convenience functions for RomData subclasses. **/
 
@@ -0,0 +1,213 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * TextFuncs_ascii.hpp: Text encoding functions. (ASCII fast path)         *
+ *                                                                         *
+ * Copyright (c) 2009-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_TEXTFUNCS_ASCII_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_TEXTFUNCS_ASCII_HPP__
+
+#include "common.h"
+#include "librpcpu/cpu_dispatch.h"
+
+// Most ROM header strings are plain 7-bit ASCII, which is
+// identical in UTF-8, UTF-16, and all of the ASCII-compatible
+// code pages. These functions let the conversion functions
+// skip iconv() and the Win32 conversion APIs in that case.
+
+// SSE2 is always available on amd64. On i386, only use it
+// if it's part of the compiler's baseline.
+// NEON is always available on ARM64.
+#if defined(RP_CPU_AMD64) || (defined(RP_CPU_I386) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+# include <emmintrin.h>
+# define TEXTFUNCS_ASCII_SSE2 1
+#elif defined(RP_CPU_ARM64)
+# include <arm_neon.h>
+# define TEXTFUNCS_ASCII_NEON 1
+#endif
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+// C++ includes.
+#include <string>
+
+namespace LibRpBase {
+
+/**
+ * Is an 8-bit string entirely 7-bit ASCII?
+ * @param str	[in] String.
+ * @param len	[in] Length of str, in bytes.
+ * @return True if all bytes are 0x00-0x7F.
+ */
+static inline bool is_ascii(const char *str, size_t len)
+{
+#if defined(TEXTFUNCS_ASCII_SSE2)
+	for (; len >= 16; str += 16, len -= 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
+		if (_mm_movemask_epi8(v) != 0)
+			return false;
+	}
+#elif defined(TEXTFUNCS_ASCII_NEON)
+	for (; len >= 16; str += 16, len -= 16) {
+		const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(str));
+		if (vmaxvq_u8(v) >= 0x80)
+			return false;
+	}
+#else
+	for (; len >= 8; str += 8, len -= 8) {
+		uint64_t v;
+		memcpy(&v, str, sizeof(v));
+		if (v & 0x8080808080808080ULL)
+			return false;
+	}
+#endif
+
+	for (; len > 0; str++, len--) {
+		if (static_cast<uint8_t>(*str) >= 0x80)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Is a UTF-16 string (host-endian) entirely 7-bit ASCII?
+ * @param wcs	[in] String.
+ * @param len	[in] Length of wcs, in characters.
+ * @return True if all characters are U+0000-U+007F.
+ */
+static inline bool is_ascii(const char16_t *wcs, size_t len)
+{
+#if defined(TEXTFUNCS_ASCII_SSE2)
+	const __m128i mask = _mm_set1_epi16(static_cast<short>(0xFF80));
+	for (; len >= 8; wcs += 8, len -= 8) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(wcs));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, mask), _mm_setzero_si128())) != 0xFFFF)
+			return false;
+	}
+#elif defined(TEXTFUNCS_ASCII_NEON)
+	for (; len >= 8; wcs += 8, len -= 8) {
+		const uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t*>(wcs));
+		if (vmaxvq_u16(v) >= 0x80)
+			return false;
+	}
+#else
+	for (; len >= 4; wcs += 4, len -= 4) {
+		uint64_t v;
+		memcpy(&v, wcs, sizeof(v));
+		if (v & 0xFF80FF80FF80FF80ULL)
+			return false;
+	}
+#endif
+
+	for (; len > 0; wcs++, len--) {
+		if (*wcs >= 0x80)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Widen a 7-bit ASCII string to UTF-16. (host-endian)
+ * The string must have been checked with is_ascii().
+ * @param str	[in] ASCII string.
+ * @param len	[in] Length of str, in bytes.
+ * @return UTF-16 string.
+ */
+static inline std::u16string ascii_to_utf16(const char *str, size_t len)
+{
+	std::u16string ret;
+	ret.resize(len);
+	char16_t *dest = &ret[0];
+
+#if defined(TEXTFUNCS_ASCII_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for (; len >= 16; str += 16, dest += 16, len -= 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest),     _mm_unpacklo_epi8(v, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 8), _mm_unpackhi_epi8(v, zero));
+	}
+#elif defined(TEXTFUNCS_ASCII_NEON)
+	for (; len >= 16; str += 16, dest += 16, len -= 16) {
+		const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(str));
+		vst1q_u16(reinterpret_cast<uint16_t*>(dest),     vmovl_u8(vget_low_u8(v)));
+		vst1q_u16(reinterpret_cast<uint16_t*>(dest + 8), vmovl_u8(vget_high_u8(v)));
+	}
+#endif
+
+	for (; len > 0; str++, dest++, len--) {
+		*dest = static_cast<char16_t>(*str);
+	}
+	return ret;
+}
+
+/**
+ * Narrow a 7-bit ASCII UTF-16 string (host-endian) to 8-bit.
+ * The string must have been checked with is_ascii().
+ * @param wcs	[in] ASCII UTF-16 string.
+ * @param len	[in] Length of wcs, in characters.
+ * @return 8-bit string.
+ */
+static inline std::string ascii_from_utf16(const char16_t *wcs, size_t len)
+{
+	std::string ret;
+	ret.resize(len);
+	char *dest = &ret[0];
+
+#if defined(TEXTFUNCS_ASCII_SSE2)
+	for (; len >= 16; wcs += 16, dest += 16, len -= 16) {
+		const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(wcs));
+		const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(wcs + 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_packus_epi16(lo, hi));
+	}
+#elif defined(TEXTFUNCS_ASCII_NEON)
+	for (; len >= 16; wcs += 16, dest += 16, len -= 16) {
+		const uint16x8_t lo = vld1q_u16(reinterpret_cast<const uint16_t*>(wcs));
+		const uint16x8_t hi = vld1q_u16(reinterpret_cast<const uint16_t*>(wcs + 8));
+		vst1q_u8(reinterpret_cast<uint8_t*>(dest), vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+	}
+#endif
+
+	for (; len > 0; wcs++, dest++, len--) {
+		*dest = static_cast<char>(*wcs);
+	}
+	return ret;
+}
+
+/**
+ * Is a code page ASCII-compatible?
+ * If it is, 7-bit ASCII text is identical in the
+ * code page and in UTF-8.
+ * @param cp Code page number.
+ * @return True if the code page is ASCII-compatible.
+ */
+static inline bool is_ascii_compatible_cp(unsigned int cp)
+{
+	switch (cp) {
+		case 0:		// CP_ACP (assumed to be cp1252 or similar)
+		case 437:	// IBM PC
+		case 850:	// DOS Latin-1
+		case 932:	// Shift-JIS (cp932)
+		case 936:	// GB2312
+		case 949:	// Korean
+		case 950:	// Big5
+		case 1250: case 1251: case 1252: case 1253:
+		case 1254: case 1255: case 1256: case 1257:
+		case 1258:	// Windows code pages
+		case 20932:	// EUC-JP
+		case 28591:	// CP_LATIN1
+		case 65001:	// CP_UTF8
+			return true;
+		default:
+			return false;
+	}
+}
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_TEXTFUNCS_ASCII_HPP__ */
@@ -10,6 +10,7 @@
 #include "config.librpbase.h"
 #include "TextFuncs.hpp"
 #include "TextFuncs_NULL.hpp"
+#include "TextFuncs_ascii.hpp"
 
 #if defined(_WIN32)
 # error TextFuncs_iconv.cpp is not supported on Windows.
@@ -38,12 +39,178 @@
 # include <iconv.h>
 #endif
 
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
 // C++ STL classes.
 using std::string;
 using std::u16string;
 
 namespace LibRpBase {
 
+/** iconv descriptor cache. **/
+
+/**
+ * Cache of iconv descriptors, keyed by character set pair.
+ *
+ * iconv_open() is expensive on glibc, since it has to look up
+ * and lock the gconv modules, so descriptors are kept open and
+ * reused. Each descriptor is only used by one thread at a time.
+ */
+class IconvCache
+{
+	public:
+		IconvCache()
+		{
+			memset(entries, 0, sizeof(entries));
+			for (Entry &entry : entries) {
+				entry.cd = (iconv_t)(-1);
+			}
+		}
+
+		~IconvCache()
+		{
+			for (Entry &entry : entries) {
+				if (entry.cd != (iconv_t)(-1)) {
+					iconv_close(entry.cd);
+				}
+			}
+		}
+
+	private:
+		RP_DISABLE_COPY(IconvCache)
+
+	public:
+		/**
+		 * Handle to an iconv descriptor obtained with get().
+		 */
+		struct Handle {
+			iconv_t cd;
+			int slot;	// Cache slot, or -1 if not cached.
+		};
+
+		/**
+		 * Get an iconv descriptor.
+		 * If a free cached descriptor exists for this character set pair,
+		 * it will be used; otherwise, a new descriptor will be opened.
+		 * @param handle	[out] Descriptor handle.
+		 * @param src_charset	[in] Source character set.
+		 * @param dest_charset	[in] Destination character set.
+		 * @param ignoreErr	[in] If true, ignore errors.
+		 * @return True on success; false if iconv_open() failed.
+		 */
+		bool get(Handle &handle, const char *src_charset, const char *dest_charset, bool ignoreErr)
+		{
+			// Character set names that don't fit in a cache entry
+			// are never cached.
+			const bool cacheable = (strlen(src_charset) < sizeof(entries[0].src_charset) &&
+			                        strlen(dest_charset) < sizeof(entries[0].dest_charset));
+
+			if (cacheable) {
+				MutexLocker mtxLocker(mutex);
+				for (int i = 0; i < static_cast<int>(ARRAY_SIZE(entries)); i++) {
+					Entry &entry = entries[i];
+					if (entry.cd == (iconv_t)(-1))
+						break;
+					if (!entry.inUse && entry.ignoreErr == ignoreErr &&
+					    !strcmp(entry.src_charset, src_charset) &&
+					    !strcmp(entry.dest_charset, dest_charset))
+					{
+						// Found a free descriptor.
+						entry.inUse = true;
+						handle.cd = entry.cd;
+						handle.slot = i;
+						return true;
+					}
+				}
+			}
+
+			// Open a new iconv descriptor.
+			// This is done without holding the mutex.
+			iconv_t cd;
+#if defined(__linux__) || defined(HAVE_ICONV_LIBICONV)
+			// glibc/libiconv: Append "//IGNORE" to the source character set
+			// if ignoreErr == true.
+			// TODO: Destination, not source?
+			if (ignoreErr) {
+				char tmpsrc[32];
+				snprintf(tmpsrc, sizeof(tmpsrc), "%s//IGNORE", src_charset);
+				cd = iconv_open(dest_charset, tmpsrc);
+			} else {
+				// Not ignoring errors.
+				cd = iconv_open(dest_charset, src_charset);
+			}
+#else
+			cd = iconv_open(dest_charset, src_charset);
+#endif
+
+			if (cd == (iconv_t)(-1)) {
+				// Error opening iconv.
+				return false;
+			}
+
+			handle.cd = cd;
+			handle.slot = -1;
+			if (!cacheable)
+				return true;
+
+			// Add the descriptor to the cache if there's room.
+			MutexLocker mtxLocker(mutex);
+			for (int i = 0; i < static_cast<int>(ARRAY_SIZE(entries)); i++) {
+				Entry &entry = entries[i];
+				if (entry.cd != (iconv_t)(-1))
+					continue;
+
+				strcpy(entry.src_charset, src_charset);
+				strcpy(entry.dest_charset, dest_charset);
+				entry.ignoreErr = ignoreErr;
+				entry.inUse = true;
+				entry.cd = cd;
+				handle.slot = i;
+				break;
+			}
+			return true;
+		}
+
+		/**
+		 * Release an iconv descriptor obtained with get().
+		 * Cached descriptors are reset to the initial conversion state;
+		 * uncached descriptors are closed.
+		 * @param handle Descriptor handle.
+		 */
+		void put(const Handle &handle)
+		{
+			if (handle.slot < 0) {
+				iconv_close(handle.cd);
+				return;
+			}
+
+			// Reset the conversion state.
+			iconv(handle.cd, nullptr, nullptr, nullptr, nullptr);
+
+			MutexLocker mtxLocker(mutex);
+			entries[handle.slot].inUse = false;
+		}
+
+	private:
+		struct Entry {
+			char src_charset[24];
+			char dest_charset[24];
+			bool ignoreErr;
+			bool inUse;
+			iconv_t cd;	// (iconv_t)(-1) if this entry is empty
+		};
+
+		// Entries are filled in order, so the first
+		// empty entry marks the end of the cache.
+		Entry entries[16];
+		Mutex mutex;
+};
+
+static IconvCache iconvCache;
+
 /** OS-specific text conversion functions. **/
 
 /**
@@ -75,28 +242,13 @@ static char *rp_iconv(const char *src, int len,
 	// * http://www.delorie.com/gnu/docs/glibc/libc_101.html
 	// * http://www.codase.com/search/call?name=iconv
 
-	// Open an iconv descriptor.
-	iconv_t cd;
-#if defined(__linux__) || defined(HAVE_ICONV_LIBICONV)
-	// glibc/libiconv: Append "//IGNORE" to the source character set
-	// if ignoreErr == true.
-	// TODO: Destination, not source?
-	if (ignoreErr) {
-		char tmpsrc[32];
-		snprintf(tmpsrc, sizeof(tmpsrc), "%s//IGNORE", src_charset);
-		cd = iconv_open(dest_charset, tmpsrc);
-	} else {
-		// Not ignoring errors.
-		cd = iconv_open(dest_charset, src_charset);
-	}
-#else
-	cd = iconv_open(dest_charset, src_charset);
-#endif
-
-	if (cd == (iconv_t)(-1)) {
+	// Get an iconv descriptor.
+	IconvCache::Handle cdh;
+	if (!iconvCache.get(cdh, src_charset, dest_charset, ignoreErr)) {
 		// Error opening iconv.
 		return nullptr;
 	}
+	iconv_t cd = cdh.cd;
 
 	// Allocate the output buffer.
 	// UTF-8 is variable length, and the largest UTF-8 character is 4 bytes long.
@@ -137,8 +289,8 @@ static char *rp_iconv(const char *src, int len,
 		}
 	}
 
-	// Close the iconv descriptor.
-	iconv_close(cd);
+	// Release the iconv descriptor.
+	iconvCache.put(cdh);
 
 	if (success) {
 		// The string was converted successfully.
@@ -203,6 +355,11 @@ string cpN_to_utf8(unsigned int cp, const char *str, int len, unsigned int flags
 {
 	len = check_NULL_terminator(str, len);
 
+	if (is_ascii_compatible_cp(cp) && is_ascii(str, len)) {
+		// 7-bit ASCII. No conversion is needed.
+		return string(str, len);
+	}
+
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
 	codePageToEncName(cp_name, sizeof(cp_name), cp);
@@ -270,6 +427,11 @@ u16string cpN_to_utf16(unsigned int cp, const char *str, int len, unsigned int f
 {
 	len = check_NULL_terminator(str, len);
 
+	if (is_ascii_compatible_cp(cp) && is_ascii(str, len)) {
+		// 7-bit ASCII. Widen it directly.
+		return ascii_to_utf16(str, len);
+	}
+
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
 	codePageToEncName(cp_name, sizeof(cp_name), cp);
@@ -333,6 +495,11 @@ string utf8_to_cpN(unsigned int cp, const char *str, int len)
 {
 	len = check_NULL_terminator(str, len);
 
+	if (is_ascii_compatible_cp(cp) && is_ascii(str, len)) {
+		// 7-bit ASCII. No conversion is needed.
+		return string(str, len);
+	}
+
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
 	codePageToEncName(cp_name, sizeof(cp_name), cp);
@@ -363,6 +530,11 @@ string utf16_to_cpN(unsigned int cp, const char16_t *wcs, int len)
 {
 	len = check_NULL_terminator(wcs, len);
 
+	if (is_ascii_compatible_cp(cp) && is_ascii(wcs, len)) {
+		// 7-bit ASCII. Narrow it directly.
+		return ascii_from_utf16(wcs, len);
+	}
+
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
 	codePageToEncName(cp_name, sizeof(cp_name), cp);
@@ -393,6 +565,13 @@ string utf16le_to_utf8(const char16_t *wcs, int len)
 {
 	len = check_NULL_terminator(wcs, len);
 
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
+	if (is_ascii(wcs, len)) {
+		// 7-bit ASCII. Narrow it directly.
+		return ascii_from_utf16(wcs, len);
+	}
+#endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
+
 	// Attempt to convert the text from UTF-16LE to UTF-8.
 	string ret;
 	char *mbs = reinterpret_cast<char*>(rp_iconv((char*)wcs, len*sizeof(*wcs), "UTF-16LE", "UTF-8"));
@@ -414,6 +593,13 @@ string utf16be_to_utf8(const char16_t *wcs, int len)
 {
 	len = check_NULL_terminator(wcs, len);
 
+#if SYS_BYTEORDER == SYS_BIG_ENDIAN
+	if (is_ascii(wcs, len)) {
+		// 7-bit ASCII. Narrow it directly.
+		return ascii_from_utf16(wcs, len);
+	}
+#endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+
 	// Attempt to convert the text from UTF-16BE to UTF-8.
 	string ret;
 	char *mbs = reinterpret_cast<char*>(rp_iconv((char*)wcs, len*sizeof(*wcs), "UTF-16BE", "UTF-8"));
@@ -10,6 +10,7 @@
 #include "config.librpbase.h"
 #include "TextFuncs.hpp"
 #include "TextFuncs_NULL.hpp"
+#include "TextFuncs_ascii.hpp"
 
 #ifndef _WIN32
 # error TextFuncs_win32.cpp is for Windows only.
@@ -137,6 +138,12 @@ static char *W32U_UTF16_to_mbs(const char16_t *wcs, int cchWcs,
 string cpN_to_utf8(unsigned int cp, const char *str, int len, unsigned int flags)
 {
 	len = check_NULL_terminator(str, len);
+
+	if (is_ascii_compatible_cp(cp) && is_ascii(str, len)) {
+		// 7-bit ASCII. No conversion is needed.
+		return string(str, len);
+	}
+
 	DWORD dwFlags = 0;
 	if (flags & TEXTCONV_FLAG_CP1252_FALLBACK) {
 		// Fallback is enabled.
@@ -188,6 +195,12 @@ string cpN_to_utf8(unsigned int cp, const char *str, int len, unsigned int flags
 u16string cpN_to_utf16(unsigned int cp, const char *str, int len, unsigned int flags)
 {
 	len = check_NULL_terminator(str, len);
+
+	if (is_ascii_compatible_cp(cp) && is_ascii(str, len)) {
+		// 7-bit ASCII. Widen it directly.
+		return ascii_to_utf16(str, len);
+	}
+
 	DWORD dwFlags = 0;
 	if (flags & TEXTCONV_FLAG_CP1252_FALLBACK) {
 		// Fallback is enabled.
@@ -233,6 +246,11 @@ string utf8_to_cpN(unsigned int cp, const char *str, int len)
 {
 	len = check_NULL_terminator(str, len);
 
+	if (is_ascii_compatible_cp(cp) && is_ascii(str, len)) {
+		// 7-bit ASCII. No conversion is needed.
+		return string(str, len);
+	}
+
 	// Convert from UTF-8 to UTF-16.
 	string ret;
 	int cchWcs;
@@ -271,6 +289,11 @@ string utf16_to_cpN(unsigned int cp, const char16_t *wcs, int len)
 {
 	len = check_NULL_terminator(wcs, len);
 
+	if (is_ascii_compatible_cp(cp) && is_ascii(wcs, len)) {
+		// 7-bit ASCII. Narrow it directly.
+		return ascii_from_utf16(wcs, len);
+	}
+
 	// Convert from UTF-16 to `cp`.
 	string ret;
 	int cbMbs;
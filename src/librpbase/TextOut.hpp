@@ -16,11 +16,26 @@
 // C++ includes.
 #include <string>
 #include <ostream>
+#include <utility>
+#include <vector>
+
+#include "RomMetaData.hpp"
 
 namespace LibRpBase {
 
 class RomData;
 
+/**
+ * Output filter for ROMOutput and JSONROMOutput.
+ * If a filter is set, only the selected fields and
+ * metadata properties are printed. Images and
+ * external image URLs are not printed.
+ */
+struct RomOutputFilter {
+	std::vector<std::string> fields;	// Field names (case-insensitive)
+	std::vector<Property> metaData;		// Metadata properties
+};
+
 /**
  * Partially unescape a URL.
  * %20, %23, and %25 are left escaped.
@@ -32,15 +47,42 @@ std::string urlPartialUnescape(const std::string &url);
 class ROMOutput {
 	const RomData *const romdata;
 	uint32_t lc;
+	const RomOutputFilter *filter_;
 public:
 	explicit ROMOutput(const RomData *romdata, uint32_t lc = 0);
 	friend std::ostream& operator<<(std::ostream& os, const ROMOutput& fo);
+
+	/**
+	 * Set an output filter.
+	 * The RomOutputFilter object must remain valid until
+	 * the ROMOutput object has been written.
+	 * @param filter Output filter, or nullptr for none.
+	 */
+	inline void setFilter(const RomOutputFilter *filter) {
+		filter_ = filter;
+	}
+};
+
+/**
+ * Hashes of a ROM image, for JSONROMOutput.
+ */
+struct RomHashes {
+	// [algorithm name, hex string], e.g. ["md5", "d41d8cd9..."]
+	typedef std::vector<std::pair<std::string, std::string> > List;
+
+	List file;		// Hashes of the file as stored.
+	std::string streamType;	// Container type, e.g. "GCZ". (empty if none)
+	List stream;		// Hashes of the decompressed stream.
 };
 
 class JSONROMOutput {
 	const RomData *const romdata;
 	uint32_t lc;
 	bool crlf_;
+	bool compact_;
+	const RomHashes *hashes_;
+	const char *filename_;
+	const RomOutputFilter *filter_;
 public:
 	explicit JSONROMOutput(const RomData *romdata, uint32_t lc = 0);
 	friend std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo);
@@ -52,6 +94,49 @@ public:
 	inline void setCrlf(bool val) {
 		crlf_ = val;
 	}
+
+	inline bool compact(void) const {
+		return compact_;
+	}
+
+	/**
+	 * Use compact JSON output instead of pretty-printing.
+	 * (No whitespace or newlines are written.)
+	 * @param val True for compact output.
+	 */
+	inline void setCompact(bool val) {
+		compact_ = val;
+	}
+
+	/**
+	 * Set hashes to include in the output.
+	 * The RomHashes object must remain valid until
+	 * the JSONROMOutput object has been written.
+	 * @param hashes Hashes, or nullptr for none.
+	 */
+	inline void setHashes(const RomHashes *hashes) {
+		hashes_ = hashes;
+	}
+
+	/**
+	 * Set a filename to include in the output.
+	 * The string must remain valid until the
+	 * JSONROMOutput object has been written.
+	 * @param filename Filename, or nullptr for none.
+	 */
+	inline void setFilename(const char *filename) {
+		filename_ = filename;
+	}
+
+	/**
+	 * Set an output filter.
+	 * The RomOutputFilter object must remain valid until
+	 * the JSONROMOutput object has been written.
+	 * @param filter Output filter, or nullptr for none.
+	 */
+	inline void setFilter(const RomOutputFilter *filter) {
+		filter_ = filter;
+	}
 };
 
 }
@@ -22,6 +22,7 @@ using std::vector;
 // librpbase
 #include "RomData.hpp"
 #include "RomFields.hpp"
+#include "RomMetaData.hpp"
 #include "TextFuncs.hpp"
 #include "img/IconAnimData.hpp"
 
@@ -30,21 +31,60 @@ using std::vector;
 using LibRpTexture::rp_image;
 
 // rapidjson
-#include "rapidjson/document.h"
 #include "rapidjson/ostreamwrapper.h"
 #include "rapidjson/prettywriter.h"
+#include "rapidjson/writer.h"
 using namespace rapidjson;
 
 namespace LibRpBase {
 
-template<typename Allocator>
+/**
+ * Write RomFields to a rapidjson SAX writer.
+ * The fields are streamed directly to the writer,
+ * so no intermediate DOM is built.
+ */
+template<typename Writer>
 class JSONFieldsOutput {
 	const RomFields& fields;
+	Writer& writer;
+	const vector<string> *names;	// Selected field names (nullptr for all)
 public:
-	explicit JSONFieldsOutput(const RomFields& fields) :fields(fields) {}
+	JSONFieldsOutput(const RomFields& fields, Writer& writer, const vector<string> *names = nullptr)
+		: fields(fields), writer(writer), names(names) {}
 
 private:
-	static Value lcToValue(uint32_t lc, Allocator &allocator)
+	/**
+	 * Write a string key.
+	 * @param key Key.
+	 */
+	inline void key(const char *key)
+	{
+		writer.Key(key);
+	}
+
+	/**
+	 * Write a string value.
+	 * @param str String.
+	 */
+	inline void string_val(const char *str)
+	{
+		writer.String(str);
+	}
+
+	/**
+	 * Write a string value.
+	 * @param str String.
+	 */
+	inline void string_val(const string &str)
+	{
+		writer.String(str.data(), static_cast<SizeType>(str.size()));
+	}
+
+	/**
+	 * Write a language code as a key.
+	 * @param lc Language code.
+	 */
+	void lcKey(uint32_t lc)
 	{
 		char s_lc[8];
 		int s_lc_pos = 0;
@@ -56,324 +96,439 @@ private:
 		}
 		s_lc[s_lc_pos] = '\0';
 
-		Value s_lc_name;
-		s_lc_name.SetString(s_lc, s_lc_pos, allocator);
-		return s_lc_name;
+		writer.Key(s_lc, static_cast<SizeType>(s_lc_pos));
 	}
 
-	static Value listDataToValue(const RomFields::Field &field,
-		const RomFields::ListData_t *list_data, Allocator &allocator)
+	/**
+	 * Write list data as an array of rows.
+	 * If the list data is empty, "ERROR" is written instead.
+	 * @param field RFT_LISTDATA field.
+	 * @param list_data List data.
+	 */
+	void writeListData(const RomFields::Field &field,
+		const RomFields::ListData_t *list_data)
 	{
-		Value data_array(kArrayType);	// data
 		assert(list_data != nullptr);
-		if (!list_data) {
+		if (!list_data || list_data->empty()) {
 			// No data...
-			return data_array;
+			string_val("ERROR");
+			return;
 		}
 
+		writer.StartArray();	// data
 		const bool has_checkboxes = !!(field.desc.list_data.flags & RomFields::RFT_LISTDATA_CHECKBOXES);
 		uint32_t checkboxes = field.data.list_data.mxd.checkboxes;
 		const auto list_data_cend = list_data->cend();
 		for (auto it = list_data->cbegin(); it != list_data_cend; ++it) {
-			Value row_array(kArrayType);
+			writer.StartArray();
 			if (has_checkboxes) {
 				// TODO: Better JSON schema for RFT_LISTDATA_CHECKBOXES?
-				row_array.PushBack((checkboxes & 1) ? true : false, allocator);
+				writer.Bool((checkboxes & 1) ? true : false);
 				checkboxes >>= 1;
 			}
 
 			const auto it_cend = it->cend();
 			for (auto jt = it->cbegin(); jt != it_cend; ++jt) {
-				row_array.PushBack(StringRef(*jt), allocator);
+				string_val(*jt);
 			}
 
-			data_array.PushBack(row_array, allocator);
+			writer.EndArray();
 		}
-
-		return data_array;
+		writer.EndArray();
 	}
 
-public:
-	void writeToJSON(Value &fields_array, Allocator &allocator)
+	/**
+	 * Write a "desc" object containing only the field name.
+	 * @param romField Field.
+	 */
+	void writeDescNameOnly(const RomFields::Field &romField)
 	{
-		const auto fields_cend = fields.cend();
-		for (auto iter = fields.cbegin(); iter != fields_cend; ++iter) {
-			const auto &romField = *iter;
-			if (!romField.isValid)
-				continue;
+		key("desc");
+		writer.StartObject();
+		key("name"); string_val(romField.name);
+		writer.EndObject();
+	}
 
-			Value field_obj(kObjectType);	// field
+	/**
+	 * Write a single field as an object.
+	 * @param romField Field.
+	 */
+	void writeField(const RomFields::Field &romField)
+	{
+		writer.StartObject();	// field
 
-			switch (romField.type) {
-				case RomFields::RFT_INVALID: {
-					assert(!"INVALID field type");
-					field_obj.AddMember("type", "INVALID", allocator);
-					break;
-				}
+		switch (romField.type) {
+			case RomFields::RFT_INVALID: {
+				assert(!"INVALID field type");
+				key("type"); string_val("INVALID");
+				break;
+			}
 
-				case RomFields::RFT_STRING: {
-					field_obj.AddMember("type", "STRING", allocator);
+			case RomFields::RFT_STRING: {
+				key("type"); string_val("STRING");
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("format", romField.desc.flags, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
+				key("desc");
+				writer.StartObject();
+				key("name"); string_val(romField.name);
+				key("format"); writer.Uint(romField.desc.flags);
+				writer.EndObject();
 
-					field_obj.AddMember("data",
-						romField.data.str ? StringRef(*(romField.data.str)) : StringRef(""),
-						allocator);
-					break;
+				key("data");
+				if (romField.data.str) {
+					string_val(*(romField.data.str));
+				} else {
+					string_val("");
 				}
+				break;
+			}
 
-				case RomFields::RFT_BITFIELD: {
-					field_obj.AddMember("type", "BITFIELD", allocator);
-					const auto &bitfieldDesc = romField.desc.bitfield;
-
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("elementsPerRow", bitfieldDesc.elemsPerRow, allocator);
-
-					assert(bitfieldDesc.names != nullptr);
-					if (bitfieldDesc.names) {
-						Value names_array(kArrayType);	// names
-						unsigned int count = static_cast<unsigned int>(bitfieldDesc.names->size());
-						assert(count <= 32);
-						if (count > 32)
-							count = 32;
-						const auto names_cend = bitfieldDesc.names->cend();
-						for (auto iter = bitfieldDesc.names->cbegin(); iter != names_cend; ++iter) {
-							const string &name = *iter;
-							if (name.empty())
-								continue;
-
-							names_array.PushBack(StringRef(name), allocator);
-						}
-						if (!names_array.Empty()) {
-							desc_obj.AddMember("names", names_array, allocator);
-						} else {
-							desc_obj.AddMember("names", "ERROR", allocator);
+			case RomFields::RFT_BITFIELD: {
+				key("type"); string_val("BITFIELD");
+				const auto &bitfieldDesc = romField.desc.bitfield;
+
+				key("desc");
+				writer.StartObject();
+				key("name"); string_val(romField.name);
+				key("elementsPerRow"); writer.Int(bitfieldDesc.elemsPerRow);
+
+				key("names");
+				assert(bitfieldDesc.names != nullptr);
+				bool hasNames = false;
+				if (bitfieldDesc.names) {
+					assert(bitfieldDesc.names->size() <= 32);
+					for (const string &name : *(bitfieldDesc.names)) {
+						if (!name.empty()) {
+							hasNames = true;
+							break;
 						}
-					} else {
-						desc_obj.AddMember("names", "ERROR", allocator);
 					}
-
-					field_obj.AddMember("desc", desc_obj, allocator);
-					field_obj.AddMember("data", romField.data.bitfield, allocator);
-					break;
 				}
+				if (hasNames) {
+					writer.StartArray();	// names
+					const auto names_cend = bitfieldDesc.names->cend();
+					for (auto iter = bitfieldDesc.names->cbegin(); iter != names_cend; ++iter) {
+						const string &name = *iter;
+						if (name.empty())
+							continue;
 
-				case RomFields::RFT_LISTDATA: {
-					field_obj.AddMember("type", "LISTDATA", allocator);
-					const auto &listDataDesc = romField.desc.list_data;
-
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-
-					Value names_array(kArrayType);	// names
-					if (listDataDesc.names) {
-						if (listDataDesc.flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
-							// TODO: Better JSON schema for RFT_LISTDATA_CHECKBOXES?
-							names_array.PushBack("checked", allocator);
-						}
-						const auto names_cend = listDataDesc.names->cend();
-						for (auto iter = listDataDesc.names->cbegin();
-						     iter != names_cend; ++iter)
-						{
-							const string &name = *iter;
-							names_array.PushBack(StringRef(name), allocator);
-						}
-					}
-					desc_obj.AddMember("names", names_array, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
-
-					if (!(listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI)) {
-						// Single-language ListData.
-						Value data_array = listDataToValue(romField,
-							romField.data.list_data.data.single, allocator);
-						if (!data_array.Empty()) {
-							field_obj.AddMember("data", data_array, allocator);
-						} else {
-							// No data...
-							field_obj.AddMember("data", "ERROR", allocator);
-							break;
-						}
-					} else {
-						// Multi-language ListData.
-						Value data_obj(kObjectType);	// data
-						const auto *const list_data = romField.data.list_data.data.multi;
-						assert(list_data != nullptr);
-						if (!list_data) {
-							// No data...
-							field_obj.AddMember("data", "ERROR", allocator);
-							break;
-						}
-
-						const auto list_data_cend = list_data->cend();
-						for (auto mapIter = list_data->cbegin(); mapIter != list_data_cend; ++mapIter) {
-							// Key: Language code
-							// Value: Vector of string data
-							Value s_lc_name = lcToValue(mapIter->first, allocator);
-
-							Value lc_array = listDataToValue(romField,
-								&mapIter->second, allocator);
-							if (!lc_array.Empty()) {
-								data_obj.AddMember(s_lc_name, lc_array, allocator);
-							} else {
-								// No data...
-								data_obj.AddMember(s_lc_name, "ERROR", allocator);
-								continue;
-							}
-						}
-
-						field_obj.AddMember("data", data_obj, allocator);
+						string_val(name);
 					}
-					break;
+					writer.EndArray();
+				} else {
+					string_val("ERROR");
 				}
+				writer.EndObject();
 
-				case RomFields::RFT_DATETIME: {
-					field_obj.AddMember("type", "DATETIME", allocator);
-
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("flags", romField.desc.flags, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
+				key("data"); writer.Uint(romField.data.bitfield);
+				break;
+			}
 
-					field_obj.AddMember("data", static_cast<int64_t>(romField.data.date_time), allocator);
-					break;
+			case RomFields::RFT_LISTDATA: {
+				key("type"); string_val("LISTDATA");
+				const auto &listDataDesc = romField.desc.list_data;
+
+				key("desc");
+				writer.StartObject();
+				key("name"); string_val(romField.name);
+				key("names");
+				writer.StartArray();	// names
+				if (listDataDesc.names) {
+					if (listDataDesc.flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+						// TODO: Better JSON schema for RFT_LISTDATA_CHECKBOXES?
+						string_val("checked");
+					}
+					const auto names_cend = listDataDesc.names->cend();
+					for (auto iter = listDataDesc.names->cbegin();
+					     iter != names_cend; ++iter)
+					{
+						string_val(*iter);
+					}
 				}
-
-				case RomFields::RFT_AGE_RATINGS: {
-					field_obj.AddMember("type", "AGE_RATINGS", allocator);
-
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
-
-					const RomFields::age_ratings_t *age_ratings = romField.data.age_ratings;
-					assert(age_ratings != nullptr);
-					if (!age_ratings) {
-						field_obj.AddMember("data", "ERROR", allocator);
+				writer.EndArray();
+				writer.EndObject();
+
+				key("data");
+				if (!(listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI)) {
+					// Single-language ListData.
+					writeListData(romField, romField.data.list_data.data.single);
+				} else {
+					// Multi-language ListData.
+					const auto *const list_data = romField.data.list_data.data.multi;
+					assert(list_data != nullptr);
+					if (!list_data) {
+						// No data...
+						string_val("ERROR");
 						break;
 					}
 
-					Value data_array(kArrayType);	// data
-					const unsigned int age_ratings_max = static_cast<unsigned int>(age_ratings->size());
-					for (unsigned int j = 0; j < age_ratings_max; j++) {
-						const uint16_t rating = age_ratings->at(j);
-						if (!(rating & RomFields::AGEBF_ACTIVE))
-							continue;
+					writer.StartObject();	// data
+					const auto list_data_cend = list_data->cend();
+					for (auto mapIter = list_data->cbegin(); mapIter != list_data_cend; ++mapIter) {
+						// Key: Language code
+						// Value: Vector of string data
+						lcKey(mapIter->first);
+						writeListData(romField, &mapIter->second);
+					}
+					writer.EndObject();
+				}
+				break;
+			}
 
-						Value rating_obj(kObjectType);
-						const char *const abbrev = RomFields::ageRatingAbbrev((RomFields::AgeRatingsCountry)j);
-						if (abbrev) {
-							rating_obj.AddMember("name", StringRef(abbrev), allocator);
-						} else {
-							// Invalid age rating.
-							// Use the numeric index.
-							rating_obj.AddMember("name", j, allocator);
-						}
+			case RomFields::RFT_DATETIME: {
+				key("type"); string_val("DATETIME");
 
-						const string s_age_rating = RomFields::ageRatingDecode((RomFields::AgeRatingsCountry)j, rating);
-						Value rating_val;
-						rating_val.SetString(s_age_rating, allocator);
-						rating_obj.AddMember("rating", rating_val, allocator);
+				key("desc");
+				writer.StartObject();
+				key("name"); string_val(romField.name);
+				key("flags"); writer.Uint(romField.desc.flags);
+				writer.EndObject();
 
-						data_array.PushBack(rating_obj, allocator);
-					}
+				key("data"); writer.Int64(static_cast<int64_t>(romField.data.date_time));
+				break;
+			}
+
+			case RomFields::RFT_AGE_RATINGS: {
+				key("type"); string_val("AGE_RATINGS");
+				writeDescNameOnly(romField);
 
-					field_obj.AddMember("data", data_array, allocator);
+				key("data");
+				const RomFields::age_ratings_t *age_ratings = romField.data.age_ratings;
+				assert(age_ratings != nullptr);
+				if (!age_ratings) {
+					string_val("ERROR");
 					break;
 				}
 
-				case RomFields::RFT_DIMENSIONS: {
-					field_obj.AddMember("type", "DIMENSIONS", allocator);
-
-					const int *const dimensions = romField.data.dimensions;
-					Value data_obj(kObjectType);	// data
-					data_obj.AddMember("w", dimensions[0], allocator);
-					if (dimensions[1] > 0) {
-						data_obj.AddMember("h", dimensions[1], allocator);
-						if (dimensions[2] > 0) {
-							data_obj.AddMember("d", dimensions[2], allocator);
-						}
+				writer.StartArray();	// data
+				const unsigned int age_ratings_max = static_cast<unsigned int>(age_ratings->size());
+				for (unsigned int j = 0; j < age_ratings_max; j++) {
+					const uint16_t rating = age_ratings->at(j);
+					if (!(rating & RomFields::AGEBF_ACTIVE))
+						continue;
+
+					writer.StartObject();
+					key("name");
+					const char *const abbrev = RomFields::ageRatingAbbrev((RomFields::AgeRatingsCountry)j);
+					if (abbrev) {
+						string_val(abbrev);
+					} else {
+						// Invalid age rating.
+						// Use the numeric index.
+						writer.Uint(j);
 					}
-					field_obj.AddMember("data", data_obj, allocator);
-					break;
+
+					key("rating");
+					string_val(RomFields::ageRatingDecode((RomFields::AgeRatingsCountry)j, rating));
+					writer.EndObject();
 				}
+				writer.EndArray();
+				break;
+			}
 
-				case RomFields::RFT_STRING_MULTI: {
-					// TODO: Act like RFT_STRING if there's only one language?
-					field_obj.AddMember("type", "STRING_MULTI", allocator);
-
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("format", romField.desc.flags, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
-
-					Value data_obj(kObjectType);	// data
-					const auto *const pStr_multi = romField.data.str_multi;
-					const auto pStr_multi_cend = pStr_multi->cend();
-					for (auto iter = pStr_multi->cbegin(); iter != pStr_multi_cend; ++iter) {
-						Value s_lc_name = lcToValue(iter->first, allocator);
-						data_obj.AddMember(s_lc_name, StringRef(iter->second), allocator);
+			case RomFields::RFT_DIMENSIONS: {
+				key("type"); string_val("DIMENSIONS");
+
+				const int *const dimensions = romField.data.dimensions;
+				key("data");
+				writer.StartObject();
+				key("w"); writer.Int(dimensions[0]);
+				if (dimensions[1] > 0) {
+					key("h"); writer.Int(dimensions[1]);
+					if (dimensions[2] > 0) {
+						key("d"); writer.Int(dimensions[2]);
 					}
+				}
+				writer.EndObject();
+				break;
+			}
 
-					field_obj.AddMember("data", data_obj, allocator);
-					break;
+			case RomFields::RFT_STRING_MULTI: {
+				// TODO: Act like RFT_STRING if there's only one language?
+				key("type"); string_val("STRING_MULTI");
+
+				key("desc");
+				writer.StartObject();
+				key("name"); string_val(romField.name);
+				key("format"); writer.Uint(romField.desc.flags);
+				writer.EndObject();
+
+				key("data");
+				writer.StartObject();
+				const auto *const pStr_multi = romField.data.str_multi;
+				const auto pStr_multi_cend = pStr_multi->cend();
+				for (auto iter = pStr_multi->cbegin(); iter != pStr_multi_cend; ++iter) {
+					lcKey(iter->first);
+					string_val(iter->second);
 				}
+				writer.EndObject();
+				break;
+			}
 
-				default: {
-					assert(!"Unknown RomFieldType");
-					field_obj.AddMember("type", "NYI", allocator);
+			default: {
+				assert(!"Unknown RomFieldType");
+				key("type"); string_val("NYI");
+				writeDescNameOnly(romField);
+				break;
+			}
+		}
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
-					break;
-				}
+		writer.EndObject();
+	}
+
+	/**
+	 * Is a field selected for output?
+	 * @param field Field.
+	 * @return True if the field is valid and selected.
+	 */
+	bool isSelected(const RomFields::Field &field) const
+	{
+		if (!field.isValid)
+			return false;
+		if (!names)
+			return true;
+		for (const string &name : *names) {
+			if (!strcasecmp(name.c_str(), field.name))
+				return true;
+		}
+		return false;
+	}
+
+public:
+	/**
+	 * Write the "fields" array.
+	 * Nothing is written if there are no valid fields.
+	 */
+	void writeToJSON(void)
+	{
+		const auto fields_cend = fields.cend();
+		bool hasValidFields = false;
+		for (auto iter = fields.cbegin(); iter != fields_cend; ++iter) {
+			if (isSelected(*iter)) {
+				hasValidFields = true;
+				break;
 			}
+		}
+		if (!hasValidFields)
+			return;
 
-			fields_array.PushBack(field_obj, allocator);
+		key("fields");
+		writer.StartArray();
+		for (auto iter = fields.cbegin(); iter != fields_cend; ++iter) {
+			if (isSelected(*iter)) {
+				writeField(*iter);
+			}
 		}
+		writer.EndArray();
 	}
 };
 
+/**
+ * Write the selected metadata properties as a "metadata" object.
+ * Properties that aren't present are skipped.
+ * @param writer	[in] Writer.
+ * @param metaData	[in] RomMetaData object.
+ * @param props		[in] Selected properties.
+ */
+template<typename Writer>
+static void writeMetaDataToJSON(Writer &writer, const RomMetaData &metaData,
+	const vector<Property> &props)
+{
+	writer.Key("metadata");
+	writer.StartObject();
+	const int count = metaData.count();
+	for (const Property prop : props) {
+		const RomMetaData::MetaData *pMetaData = nullptr;
+		for (int i = 0; i < count; i++) {
+			const RomMetaData::MetaData *const p = metaData.prop(i);
+			if (p && p->name == prop) {
+				pMetaData = p;
+				break;
+			}
+		}
+		if (!pMetaData)
+			continue;
+
+		writer.Key(RomMetaData::getPropertyName(prop));
+		switch (pMetaData->type) {
+			case PropertyType::Integer:
+				writer.Int(pMetaData->data.ivalue);
+				break;
+			case PropertyType::UnsignedInteger:
+				writer.Uint(pMetaData->data.uvalue);
+				break;
+			case PropertyType::String:
+				if (pMetaData->data.str) {
+					writer.String(pMetaData->data.str->data(),
+						static_cast<SizeType>(pMetaData->data.str->size()));
+				} else {
+					writer.Null();
+				}
+				break;
+			case PropertyType::Timestamp:
+				writer.Int64(static_cast<int64_t>(pMetaData->data.timestamp));
+				break;
+			default:
+				assert(!"Unsupported RomMetaData PropertyType.");
+				writer.Null();
+				break;
+		}
+	}
+	writer.EndObject();
+}
 
-JSONROMOutput::JSONROMOutput(const RomData *romdata, uint32_t lc)
-	: romdata(romdata)
-	, lc(lc)
-	, crlf_(false) { }
-std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
-	auto romdata = fo.romdata;
-	assert(romdata && romdata->isValid());
-
+/**
+ * Write a RomData object to a rapidjson SAX writer.
+ * @param writer	[in] Writer.
+ * @param romdata	[in] RomData object.
+ * @param hashes	[in,opt] Hashes.
+ * @param filename	[in,opt] Filename.
+ * @param filter	[in,opt] Output filter.
+ */
+template<typename Writer>
+static void writeRomDataToJSON(Writer &writer, const RomData *romdata,
+	const RomHashes *hashes, const char *filename, const RomOutputFilter *filter)
+{
 	const char *const systemName = romdata->systemName(RomData::SYSNAME_TYPE_LONG | RomData::SYSNAME_REGION_ROM_LOCAL);
 	const char *const fileType = romdata->fileType_string();
 	assert(systemName != nullptr);
 	assert(fileType != nullptr);
 
-	Document document;
-	document.SetObject();	// document should be an object, not an array
-	Document::AllocatorType& allocator = document.GetAllocator();
-	document.AddMember("system", StringRef(systemName ? systemName : "unknown"), allocator);
-	document.AddMember("filetype", StringRef(fileType ? fileType : "unknown"), allocator);
+	writer.StartObject();	// document should be an object, not an array
+	if (filename) {
+		writer.Key("filename");
+		writer.String(filename);
+	}
+	writer.Key("system");
+	writer.String(systemName ? systemName : "unknown");
+	writer.Key("filetype");
+	writer.String(fileType ? fileType : "unknown");
 
 	// Fields.
-	const RomFields *const fields = romdata->fields();
-	assert(fields != nullptr);
-	if (fields) {
-		Value fields_array(kArrayType);	// fields
-		JSONFieldsOutput<Document::AllocatorType>(*fields).writeToJSON(fields_array, allocator);
-		if (!fields_array.Empty()) {
-			document.AddMember("fields", fields_array, allocator);
+	// NOTE: If a filter is set, fields() is only called if
+	// fields were selected, and images are skipped entirely.
+	if (!filter || !filter->fields.empty()) {
+		const RomFields *const fields = romdata->fields();
+		assert(fields != nullptr);
+		if (fields) {
+			JSONFieldsOutput<Writer>(*fields, writer,
+				(filter ? &filter->fields : nullptr)).writeToJSON();
+		}
+	}
+
+	// Metadata.
+	if (filter && !filter->metaData.empty()) {
+		const RomMetaData *const metaData = romdata->metaData();
+		if (metaData) {
+			writeMetaDataToJSON(writer, *metaData, filter->metaData);
 		}
 	}
 
 	// Internal images.
-	const uint32_t imgbf = romdata->supportedImageTypes();
+	const uint32_t imgbf = (!filter ? romdata->supportedImageTypes() : 0);
 	if (imgbf != 0) {
-		Value imgint_array(kArrayType);	// imgint
-
+		// Get the valid internal images first, since the
+		// "imgint" array is omitted if there aren't any.
+		vector<std::pair<RomData::ImageType, const rp_image*> > images;
 		for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
 			if (!(imgbf & (1U << i)))
 				continue;
@@ -382,48 +537,64 @@ std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
 			if (!image || !image->isValid())
 				continue;
 
-			Value imgint_obj(kObjectType);
-			imgint_obj.AddMember("type", StringRef(RomData::getImageTypeName((RomData::ImageType)i)), allocator);
-			imgint_obj.AddMember("format", StringRef(rp_image::getFormatName(image->format())), allocator);
-
-			Value size_array(kArrayType);	// size
-			size_array.PushBack(image->width(), allocator);
-			size_array.PushBack(image->height(), allocator);
-			imgint_obj.AddMember("size", size_array, allocator);
+			images.emplace_back((RomData::ImageType)i, image);
+		}
 
-			const uint32_t ppf = romdata->imgpf((RomData::ImageType)i);
-			if (ppf) {
-				imgint_obj.AddMember("postprocessing", ppf, allocator);
-			}
+		if (!images.empty()) {
+			writer.Key("imgint");
+			writer.StartArray();
+			for (const auto &p : images) {
+				const RomData::ImageType imageType = p.first;
+				const rp_image *const image = p.second;
+
+				writer.StartObject();
+				writer.Key("type");
+				writer.String(RomData::getImageTypeName(imageType));
+				writer.Key("format");
+				writer.String(rp_image::getFormatName(image->format()));
+
+				writer.Key("size");
+				writer.StartArray();
+				writer.Int(image->width());
+				writer.Int(image->height());
+				writer.EndArray();
+
+				const uint32_t ppf = romdata->imgpf(imageType);
+				if (ppf) {
+					writer.Key("postprocessing");
+					writer.Uint(ppf);
+				}
 
-			if (ppf & RomData::IMGPF_ICON_ANIMATED) {
-				auto animdata = romdata->iconAnimData();
-				if (animdata) {
-					imgint_obj.AddMember("frames", animdata->count, allocator);
+				if (ppf & RomData::IMGPF_ICON_ANIMATED) {
+					auto animdata = romdata->iconAnimData();
+					if (animdata) {
+						writer.Key("frames");
+						writer.Int(animdata->count);
 
-					Value animseq(kArrayType);	// sequence
-					for (int j = 0; j < animdata->seq_count; j++) {
-						animseq.PushBack((unsigned)animdata->seq_index[j], allocator);
-					}
-					imgint_obj.AddMember("sequence", animseq, allocator);
+						writer.Key("sequence");
+						writer.StartArray();
+						for (int j = 0; j < animdata->seq_count; j++) {
+							writer.Uint((unsigned)animdata->seq_index[j]);
+						}
+						writer.EndArray();
 
-					Value animdelay(kArrayType);	// delay
-					for (int j = 0; j < animdata->seq_count; j++) {
-						animdelay.PushBack(animdata->delays[j].ms, allocator);
+						writer.Key("delay");
+						writer.StartArray();
+						for (int j = 0; j < animdata->seq_count; j++) {
+							writer.Uint(animdata->delays[j].ms);
+						}
+						writer.EndArray();
 					}
-					imgint_obj.AddMember("delay", animdelay, allocator);
 				}
-			}
 
-			imgint_array.PushBack(imgint_obj, allocator);
-		}
-		if (!imgint_array.Empty()) {
-			document.AddMember("imgint", imgint_array, allocator);
+				writer.EndObject();
+			}
+			writer.EndArray();
 		}
 
 		// External images.
 		// NOTE: IMGPF_ICON_ANIMATED won't ever appear in external image
-		Value imgext_array(kArrayType);	// imgext
+		bool hasImgExt = false;
 		vector<RomData::ExtURL> extURLs;
 		for (int i = RomData::IMG_EXT_MIN; i <= RomData::IMG_EXT_MAX; i++) {
 			if (!(imgbf & (1U << i)))
@@ -439,33 +610,81 @@ std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
 			if (ret != 0 || extURLs.empty())
 				continue;
 
-			Value imgext_obj(kObjectType);
-			imgext_obj.AddMember("type", StringRef(RomData::getImageTypeName((RomData::ImageType)i)), allocator);
+			if (!hasImgExt) {
+				writer.Key("imgext");
+				writer.StartArray();
+				hasImgExt = true;
+			}
+
+			writer.StartObject();
+			writer.Key("type");
+			writer.String(RomData::getImageTypeName((RomData::ImageType)i));
 
-			Value exturls_obj(kObjectType);
+			writer.Key("exturls");
+			writer.StartObject();
 			const auto extURLs_cend = extURLs.cend();
 			for (auto iter = extURLs.cbegin(); iter != extURLs_cend; ++iter) {
-				Value url_val;
 				const string url_str = urlPartialUnescape(iter->url);
-				url_val.SetString(url_str, allocator);
-				exturls_obj.AddMember("url", url_val, allocator);
-
-				Value cache_key_val;
-				cache_key_val.SetString(iter->cache_key, allocator);
-				exturls_obj.AddMember("cache_key", cache_key_val, allocator);
+				writer.Key("url");
+				writer.String(url_str.data(), static_cast<SizeType>(url_str.size()));
+				writer.Key("cache_key");
+				writer.String(iter->cache_key.data(), static_cast<SizeType>(iter->cache_key.size()));
 			}
-			imgext_obj.AddMember("exturls", exturls_obj, allocator);
-			imgext_array.PushBack(imgext_obj, allocator);
+			writer.EndObject();
+			writer.EndObject();
+		}
+		if (hasImgExt) {
+			writer.EndArray();
+		}
+	}
+
+	// Hashes.
+	if (hashes && !hashes->file.empty()) {
+		writer.Key("hashes");
+		writer.StartObject();
+		for (const auto &p : hashes->file) {
+			writer.Key(p.first.data(), static_cast<SizeType>(p.first.size()));
+			writer.String(p.second.data(), static_cast<SizeType>(p.second.size()));
 		}
-		if (!imgext_array.Empty()) {
-			document.AddMember("imgext", imgext_array, allocator);
+		writer.EndObject();
+	}
+	if (hashes && !hashes->streamType.empty() && !hashes->stream.empty()) {
+		writer.Key("stream_hashes");
+		writer.StartObject();
+		writer.Key("type");
+		writer.String(hashes->streamType.data(), static_cast<SizeType>(hashes->streamType.size()));
+		for (const auto &p : hashes->stream) {
+			writer.Key(p.first.data(), static_cast<SizeType>(p.first.size()));
+			writer.String(p.second.data(), static_cast<SizeType>(p.second.size()));
 		}
+		writer.EndObject();
 	}
 
+	writer.EndObject();
+}
+
+JSONROMOutput::JSONROMOutput(const RomData *romdata, uint32_t lc)
+	: romdata(romdata)
+	, lc(lc)
+	, crlf_(false)
+	, compact_(false)
+	, hashes_(nullptr)
+	, filename_(nullptr)
+	, filter_(nullptr) { }
+std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
+	auto romdata = fo.romdata;
+	assert(romdata && romdata->isValid());
+
+	// NOTE: The JSON data is streamed directly to the ostream.
 	OStreamWrapper oswr(os);
-	PrettyWriter<OStreamWrapper> writer(oswr);
-	writer.SetNewlineMode(fo.crlf_);
-	document.Accept(writer);
+	if (fo.compact_) {
+		Writer<OStreamWrapper> writer(oswr);
+		writeRomDataToJSON(writer, romdata, fo.hashes_, fo.filename_, fo.filter_);
+	} else {
+		PrettyWriter<OStreamWrapper> writer(oswr);
+		writer.SetNewlineMode(fo.crlf_);
+		writeRomDataToJSON(writer, romdata, fo.hashes_, fo.filename_, fo.filter_);
+	}
 
 	os.flush();
 	return os;
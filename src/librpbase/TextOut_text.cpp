@@ -30,6 +30,7 @@ using std::vector;
 // librpbase
 #include "RomData.hpp"
 #include "RomFields.hpp"
+#include "RomMetaData.hpp"
 #include "TextFuncs.hpp"
 #include "img/IconAnimData.hpp"
 
@@ -172,7 +173,7 @@ public:
 	friend ostream& operator<<(ostream& os, const StringField& field) {
 		// NOTE: nullptr string is an empty string, not an error.
 		auto romField = field.romField;
-		os << ColonPad(field.width, romField.name.c_str());
+		os << ColonPad(field.width, romField.name);
 		if (romField.data.str) {
 			os << SafeString(romField.data.str, true, field.width);
 		} else {
@@ -223,7 +224,7 @@ public:
 		// Print the bits.
 		// FIXME: Why do we need to subtract 1 here to correctly align
 		// the first-row boxes? Maybe it should be somewhere else...
-		os << ColonPad(field.width-1, romField.name.c_str());
+		os << ColonPad(field.width-1, romField.name);
 		StreamStateSaver state(os);
 		os << left;
 		col = 0;
@@ -361,7 +362,7 @@ public:
 
 		/** Print the list data. **/
 
-		os << ColonPad(field.width, romField.name.c_str());
+		os << ColonPad(field.width, romField.name);
 		StreamStateSaver state(os);
 
 		// Print the list on a separate row from the field name?
@@ -533,7 +534,7 @@ public:
 		auto romField = field.romField;
 		auto flags = romField.desc.flags;
 
-		os << ColonPad(field.width, romField.name.c_str());
+		os << ColonPad(field.width, romField.name);
 		StreamStateSaver state(os);
 
 		if (romField.data.date_time == -1) {
@@ -588,7 +589,7 @@ public:
 	friend ostream& operator<<(ostream& os, const AgeRatingsField& field) {
 		auto romField = field.romField;
 
-		os << ColonPad(field.width, romField.name.c_str());
+		os << ColonPad(field.width, romField.name);
 		StreamStateSaver state(os);
 
 		// Convert the age ratings field to a string.
@@ -607,7 +608,7 @@ public:
 	friend ostream& operator<<(ostream& os, const DimensionsField& field) {
 		auto romField = field.romField;
 
-		os << ColonPad(field.width, romField.name.c_str());
+		os << ColonPad(field.width, romField.name);
 		StreamStateSaver state(os);
 
 		// Convert the dimensions field to a string.
@@ -637,7 +638,7 @@ public:
 	friend ostream& operator<<(ostream& os, const StringMultiField& field) {
 		// NOTE: nullptr string is an empty string, not an error.
 		auto romField = field.romField;
-		os << ColonPad(field.width, romField.name.c_str());
+		os << ColonPad(field.width, romField.name);
 
 		const auto *const pStr_multi = romField.data.str_multi;
 		assert(pStr_multi != nullptr);
@@ -655,22 +656,44 @@ public:
 	}
 };
 
+/**
+ * Is a field selected by a list of field names?
+ * @param names Field names (case-insensitive), or nullptr for all fields.
+ * @param field Field.
+ * @return True if the field is selected.
+ */
+static bool isFieldSelected(const vector<string> *names, const RomFields::Field &field)
+{
+	if (!names)
+		return true;
+	for (const string &name : *names) {
+		if (!strcasecmp(name.c_str(), field.name))
+			return true;
+	}
+	return false;
+}
+
 class FieldsOutput {
 	const RomFields& fields;
 	uint32_t lc;
+	const vector<string> *names;	// Selected field names (nullptr for all)
 public:
-	explicit FieldsOutput(const RomFields& fields, uint32_t lc = 0)
-		: fields(fields), lc(lc) { }
+	explicit FieldsOutput(const RomFields& fields, uint32_t lc = 0, const vector<string> *names = nullptr)
+		: fields(fields), lc(lc), names(names) { }
 	friend std::ostream& operator<<(std::ostream& os, const FieldsOutput& fo) {
 		size_t maxWidth = 0;
 		std::for_each(fo.fields.cbegin(), fo.fields.cend(),
-			[&maxWidth](const RomFields::Field &field) {
-				maxWidth = max(maxWidth, field.name.size());
+			[&maxWidth, &fo](const RomFields::Field &field) {
+				if (isFieldSelected(fo.names, field)) {
+					maxWidth = max(maxWidth, strlen(field.name));
+				}
 			}
 		);
 		maxWidth += 2;
 
-		const int tabCount = fo.fields.tabCount();
+		// NOTE: Tab headers aren't printed if only
+		// some of the fields are selected.
+		const int tabCount = (fo.names ? 1 : fo.fields.tabCount());
 		int tabIdx = -1;
 
 		// Language codes.
@@ -681,7 +704,7 @@ public:
 		const auto fields_cend = fo.fields.cend();
 		for (auto iter = fo.fields.cbegin(); iter != fields_cend; ++iter) {
 			const auto &romField = *iter;
-			if (!romField.isValid)
+			if (!romField.isValid || !isFieldSelected(fo.names, romField))
 				continue;
 
 			if (printed_first)
@@ -708,7 +731,7 @@ public:
 			switch (romField.type) {
 				case RomFields::RFT_INVALID:
 					assert(!"INVALID field type");
-					os << ColonPad(maxWidth, romField.name.c_str()) << "INVALID";
+					os << ColonPad(maxWidth, romField.name) << "INVALID";
 					break;
 				case RomFields::RFT_STRING:
 					os << StringField(maxWidth, romField);
@@ -733,7 +756,7 @@ public:
 					break;
 				default:
 					assert(!"Unknown RomFieldType");
-					os << ColonPad(maxWidth, romField.name.c_str()) << "NYI";
+					os << ColonPad(maxWidth, romField.name) << "NYI";
 					break;
 			}
 
@@ -743,10 +766,76 @@ public:
 	}
 };
 
+class MetaDataOutput {
+	const RomMetaData& metaData;
+	const vector<Property>& props;
+public:
+	explicit MetaDataOutput(const RomMetaData& metaData, const vector<Property>& props)
+		: metaData(metaData), props(props) { }
+	friend std::ostream& operator<<(std::ostream& os, const MetaDataOutput& mo) {
+		size_t maxWidth = 0;
+		for (const Property prop : mo.props) {
+			const char *const name = RomMetaData::getPropertyName(prop);
+			if (name) {
+				maxWidth = max(maxWidth, strlen(name));
+			}
+		}
+		maxWidth += 2;
+
+		// Properties are printed in the order they were requested.
+		// Properties that aren't present are skipped.
+		const int count = mo.metaData.count();
+		for (const Property prop : mo.props) {
+			const RomMetaData::MetaData *pMetaData = nullptr;
+			for (int i = 0; i < count; i++) {
+				const RomMetaData::MetaData *const p = mo.metaData.prop(i);
+				if (p && p->name == prop) {
+					pMetaData = p;
+					break;
+				}
+			}
+			if (!pMetaData)
+				continue;
+
+			os << ColonPad(maxWidth, RomMetaData::getPropertyName(prop));
+			switch (pMetaData->type) {
+				case PropertyType::Integer:
+					os << pMetaData->data.ivalue;
+					break;
+				case PropertyType::UnsignedInteger:
+					os << pMetaData->data.uvalue;
+					break;
+				case PropertyType::String:
+					os << SafeString(pMetaData->data.str, true, maxWidth);
+					break;
+				case PropertyType::Timestamp: {
+					struct tm timestamp;
+					const time_t date_time = pMetaData->data.timestamp;
+					if (gmtime_r(&date_time, &timestamp)) {
+						char str[64];
+						strftime(str, sizeof(str), "%Y-%m-%d %H:%M:%S", &timestamp);
+						os << str;
+					} else {
+						os << "Invalid DateTime";
+					}
+					break;
+				}
+				default:
+					assert(!"Unsupported RomMetaData PropertyType.");
+					os << "NYI";
+					break;
+			}
+			os << '\n';
+		}
+		return os;
+	}
+};
+
 
 ROMOutput::ROMOutput(const RomData *romdata, uint32_t lc)
 	: romdata(romdata)
-	, lc(lc) { }
+	, lc(lc)
+	, filter_(nullptr) { }
 std::ostream& operator<<(std::ostream& os, const ROMOutput& fo) {
 	auto romdata = fo.romdata;
 	const char *const systemName = romdata->systemName(RomData::SYSNAME_TYPE_LONG | RomData::SYSNAME_REGION_ROM_LOCAL);
@@ -764,6 +853,29 @@ std::ostream& operator<<(std::ostream& os, const ROMOutput& fo) {
 		os << "-- " << detectMsg << '\n';
 	}
 
+	const RomOutputFilter *const filter = fo.filter_;
+	if (filter) {
+		// Only print the selected fields and metadata properties.
+		// NOTE: The RomData object still loads all of its fields;
+		// only the output is filtered.
+		if (!filter->fields.empty()) {
+			const RomFields *const fields = romdata->fields();
+			assert(fields != nullptr);
+			if (fields) {
+				os << FieldsOutput(*fields, fo.lc, &filter->fields) << '\n';
+			}
+		}
+		if (!filter->metaData.empty()) {
+			const RomMetaData *const metaData = romdata->metaData();
+			if (metaData) {
+				os << "-- " << C_("TextOut", "Metadata:") << '\n';
+				os << MetaDataOutput(*metaData, filter->metaData);
+			}
+		}
+		os.flush();
+		return os;
+	}
+
 	const RomFields *const fields = romdata->fields();
 	assert(fields != nullptr);
 	if (fields) {
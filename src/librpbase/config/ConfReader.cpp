@@ -17,7 +17,7 @@
 #endif
 #include "librpfile/FileSystem.hpp"
 using namespace LibRpFile;
-using LibRpThreads::MutexLocker;
+using LibRpThreads::WriteLocker;
 
 namespace LibRpBase {
 
@@ -48,6 +48,36 @@ int ConfReaderPrivate::processConfigLine_static(void *user, const char *section,
 	return static_cast<ConfReaderPrivate*>(user)->processConfigLine(section, name, value);
 }
 
+/**
+ * Load the configuration from a binary cache.
+ * Called by ConfReader::load() before parsing the configuration file.
+ * The default implementation doesn't have a cache.
+ *
+ * @param fileSize	[in] Configuration file size.
+ * @param mtime		[in] Configuration file mtime.
+ * @return True if the cache was loaded; false if the configuration file must be parsed.
+ */
+bool ConfReaderPrivate::loadCache(off64_t fileSize, time_t mtime)
+{
+	RP_UNUSED(fileSize);
+	RP_UNUSED(mtime);
+	return false;
+}
+
+/**
+ * Save the configuration to a binary cache.
+ * Called by ConfReader::load() after parsing the configuration file.
+ * The default implementation doesn't have a cache.
+ *
+ * @param fileSize	[in] Configuration file size.
+ * @param mtime		[in] Configuration file mtime.
+ */
+void ConfReaderPrivate::saveCache(off64_t fileSize, time_t mtime) const
+{
+	RP_UNUSED(fileSize);
+	RP_UNUSED(mtime);
+}
+
 /** ConfReader **/
 
 /**
@@ -104,28 +134,39 @@ int ConfReader::load(bool force)
 		}
 		d->conf_last_checked = cur_time;
 
-		// Check if the keys.conf timestamp has changed.
-		// Initial check. (fast path)
-		time_t mtime;
-		int ret = FileSystem::get_mtime(d->conf_filename, &mtime);
-		if (ret != 0) {
-			// Failed to retrieve the mtime.
-			// Leave everything as-is.
-			// TODO: Proper error code?
-			return -EIO;
-		}
+		if (d->conf_watcher.isWatching()) {
+			// Check for change notifications. (fast path)
+			// If there are any, the timestamp is checked
+			// once the mutex is locked.
+			if (!d->conf_watcher.hasChanged()) {
+				// File has not changed.
+				return 0;
+			}
+		} else {
+			// Check if the keys.conf timestamp has changed.
+			// Initial check. (fast path)
+			time_t mtime;
+			int ret = FileSystem::get_mtime(d->conf_filename, &mtime);
+			if (ret != 0) {
+				// Failed to retrieve the mtime.
+				// Leave everything as-is.
+				// TODO: Proper error code?
+				return -EIO;
+			}
 
-		if (mtime == d->conf_mtime) {
-			// Timestamp has not changed.
-			return 0;
+			if (mtime == d->conf_mtime) {
+				// Timestamp has not changed.
+				return 0;
+			}
 		}
 	}
 
-	// loadKeys() mutex.
+	// Exclusive lock while (re)loading.
 	// NOTE: This may result in the configuration being loaded
 	// twice in some cases, but that's better than the configuration
 	// being loaded twice at the same time and causing collisions.
-	MutexLocker mtxLocker(d->mtxLoad);
+	// This also blocks lookups until the new configuration is ready.
+	WriteLocker wrLocker(d->rwLock);
 
 	if (d->conf_filename.empty()) {
 		// Get the configuration filename.
@@ -135,6 +176,10 @@ int ConfReader::load(bool force)
 				d->conf_filename += DIR_SEP_CHR;
 			}
 			d->conf_filename += d->conf_rel_filename;
+
+			// Watch the configuration file for changes.
+			// If this fails, the mtime will be checked instead.
+			d->conf_watcher.watch(d->conf_filename);
 		}
 	} else if (!force && d->conf_was_found) {
 		// Check if the keys.conf timestamp has changed.
@@ -157,6 +202,18 @@ int ConfReader::load(bool force)
 	// Reset the configuration to the default values.
 	d->reset();
 
+	// Check for a binary cache of the configuration file.
+	off64_t cache_fileSize = 0;
+	time_t cache_mtime = 0;
+	const bool has_size_and_mtime = (FileSystem::get_file_size_and_mtime(
+		d->conf_filename, &cache_fileSize, &cache_mtime) == 0);
+	if (has_size_and_mtime && d->loadCache(cache_fileSize, cache_mtime)) {
+		// Configuration loaded from the cache.
+		d->conf_mtime = cache_mtime;
+		d->conf_was_found = true;
+		return 0;
+	}
+
 	// Parse the configuration file.
 	// NOTE: We're using the filename directly, since it's always
 	// on the local file system, and it's easier to let inih
@@ -189,11 +246,17 @@ int ConfReader::load(bool force)
 	}
 
 	// Save the mtime from the keys.conf file.
-	// TODO: Combine with earlier check?
+	off64_t fileSize;
 	time_t mtime;
-	ret = FileSystem::get_mtime(d->conf_filename, &mtime);
+	ret = FileSystem::get_file_size_and_mtime(d->conf_filename, &fileSize, &mtime);
 	if (ret == 0) {
 		d->conf_mtime = mtime;
+
+		// Update the cache, but only if the file
+		// wasn't changed while it was being parsed.
+		if (has_size_and_mtime && fileSize == cache_fileSize && mtime == cache_mtime) {
+			d->saveCache(fileSize, mtime);
+		}
 	} else {
 		// mtime error...
 		// TODO: What do we do here?
@@ -11,13 +11,17 @@
 
 #include "librpbase/config.librpbase.h"
 #include "common.h"
+#include "ConfWatcher.hpp"
 
 // librpthreads
-#include "librpthreads/Mutex.hpp"
+#include "librpthreads/RWLock.hpp"
 
 // INI parser.
 #include "ini.h"
 
+// C includes.
+#include <time.h>
+
 // C++ includes.
 #include <string>
 
@@ -38,8 +42,10 @@ class ConfReaderPrivate
 		RP_DISABLE_COPY(ConfReaderPrivate)
 
 	public:
-		// load() mutex.
-		LibRpThreads::Mutex mtxLoad;
+		// Configuration lock.
+		// load() takes an exclusive lock while reloading;
+		// lookups in subclasses take a shared lock.
+		mutable LibRpThreads::RWLock rwLock;
 
 		// Configuration filename.
 		const char *const conf_rel_filename;	// from ctor
@@ -50,6 +56,10 @@ class ConfReaderPrivate
 		time_t conf_mtime;
 		time_t conf_last_checked;
 
+		// Change notification for the configuration file.
+		// If it's active, it's used instead of checking the mtime.
+		ConfWatcher conf_watcher;
+
 	public:
 		/**
 		 * Reset the configuration to the default values.
@@ -80,6 +90,27 @@ class ConfReaderPrivate
 		 */
 		virtual int processConfigLine(const char *section,
 			const char *name, const char *value) = 0;
+
+		/**
+		 * Load the configuration from a binary cache.
+		 * Called by ConfReader::load() before parsing the configuration file.
+		 * The default implementation doesn't have a cache.
+		 *
+		 * @param fileSize	[in] Configuration file size.
+		 * @param mtime		[in] Configuration file mtime.
+		 * @return True if the cache was loaded; false if the configuration file must be parsed.
+		 */
+		virtual bool loadCache(off64_t fileSize, time_t mtime);
+
+		/**
+		 * Save the configuration to a binary cache.
+		 * Called by ConfReader::load() after parsing the configuration file.
+		 * The default implementation doesn't have a cache.
+		 *
+		 * @param fileSize	[in] Configuration file size.
+		 * @param mtime		[in] Configuration file mtime.
+		 */
+		virtual void saveCache(off64_t fileSize, time_t mtime) const;
 };
 
 }
@@ -0,0 +1,306 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * ConfWatcher.cpp: Configuration file change notification.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ConfWatcher.hpp"
+
+// librpbase
+#ifdef _WIN32
+# include "TextFuncs_wchar.hpp"
+#endif
+
+#if defined(_WIN32)
+// Nothing else is needed.
+#elif defined(HAVE_INOTIFY_INIT1)
+# include <sys/inotify.h>
+# include <fcntl.h>
+# include <unistd.h>
+#elif defined(HAVE_KQUEUE)
+# include <sys/types.h>
+# include <sys/event.h>
+# include <sys/time.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+// C includes. (C++ namespace)
+#include <cerrno>
+
+// C++ STL classes.
+using std::string;
+
+// librpthreads
+using LibRpThreads::MutexLocker;
+
+namespace LibRpBase {
+
+ConfWatcher::ConfWatcher()
+#if defined(_WIN32)
+	: m_hChange(INVALID_HANDLE_VALUE)
+#elif defined(HAVE_INOTIFY_INIT1)
+	: m_fd(-1)
+	, m_dirGone(false)
+#elif defined(HAVE_KQUEUE)
+	: m_kq(-1)
+	, m_dirFd(-1)
+	, m_fileFd(-1)
+#endif
+{ }
+
+ConfWatcher::~ConfWatcher()
+{
+	close();
+}
+
+/**
+ * Stop watching the file.
+ */
+void ConfWatcher::close(void)
+{
+#if defined(_WIN32)
+	if (m_hChange != INVALID_HANDLE_VALUE) {
+		FindCloseChangeNotification(m_hChange);
+		m_hChange = INVALID_HANDLE_VALUE;
+	}
+#elif defined(HAVE_INOTIFY_INIT1)
+	if (m_fd >= 0) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+	m_dirGone = false;
+#elif defined(HAVE_KQUEUE)
+	if (m_fileFd >= 0) {
+		::close(m_fileFd);
+		m_fileFd = -1;
+	}
+	if (m_dirFd >= 0) {
+		::close(m_dirFd);
+		m_dirFd = -1;
+	}
+	if (m_kq >= 0) {
+		::close(m_kq);
+		m_kq = -1;
+	}
+#endif
+}
+
+/**
+ * Start watching a file.
+ * The file's directory must exist, but the file itself doesn't.
+ * @param filename Filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ConfWatcher::watch(const string &filename)
+{
+	close();
+
+	// Split the filename into the directory and the basename.
+#ifdef _WIN32
+	const size_t slash_pos = filename.find_last_of("\\/");
+#else /* !_WIN32 */
+	const size_t slash_pos = filename.rfind('/');
+#endif /* _WIN32 */
+	if (slash_pos == string::npos || slash_pos == 0 || slash_pos + 1 >= filename.size()) {
+		// No directory, or no filename.
+		return -EINVAL;
+	}
+	const string dirname = filename.substr(0, slash_pos);
+
+#if defined(_WIN32)
+	// NOTE: FindFirstChangeNotification() reports changes to any
+	// file in the directory, so it's only a hint.
+	m_hChange = FindFirstChangeNotification(U82T_s(dirname), FALSE,
+		FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE |
+		FILE_NOTIFY_CHANGE_LAST_WRITE);
+	if (m_hChange == INVALID_HANDLE_VALUE) {
+		return -ENOENT;
+	}
+	return 0;
+#elif defined(HAVE_INOTIFY_INIT1)
+	m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_fd < 0) {
+		return -errno;
+	}
+
+	// Watch the directory instead of the file itself, since
+	// editors usually replace the file instead of rewriting it,
+	// and the file might not exist yet.
+	const int wd = inotify_add_watch(m_fd, dirname.c_str(),
+		IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE |
+		IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+		IN_ONLYDIR);
+	if (wd < 0) {
+		const int err = errno;
+		close();
+		return -err;
+	}
+
+	m_basename = filename.substr(slash_pos + 1);
+	return 0;
+#elif defined(HAVE_KQUEUE)
+	m_kq = kqueue();
+	if (m_kq < 0) {
+		return -errno;
+	}
+	fcntl(m_kq, F_SETFD, FD_CLOEXEC);
+
+	// kqueue can't report changes to files within a directory,
+	// so watch the directory for new, deleted, and renamed files,
+	// and watch the file itself for writes.
+# ifdef O_EVTONLY
+	m_dirFd = open(dirname.c_str(), O_EVTONLY | O_DIRECTORY | O_CLOEXEC);
+# else /* !O_EVTONLY */
+	m_dirFd = open(dirname.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+# endif /* O_EVTONLY */
+	if (m_dirFd < 0) {
+		const int err = errno;
+		close();
+		return -err;
+	}
+
+	struct kevent kev;
+	EV_SET(&kev, m_dirFd, EVFILT_VNODE, EV_ADD | EV_CLEAR,
+		NOTE_WRITE | NOTE_DELETE | NOTE_RENAME, 0, nullptr);
+	if (kevent(m_kq, &kev, 1, nullptr, 0, nullptr) < 0) {
+		const int err = errno;
+		close();
+		return -err;
+	}
+
+	m_filename = filename;
+	watchFile();
+	return 0;
+#else
+	// No change notification API is available.
+	return -ENOTSUP;
+#endif
+}
+
+#if defined(HAVE_KQUEUE) && !defined(_WIN32) && !defined(HAVE_INOTIFY_INIT1)
+/**
+ * Open the file and add it to the kqueue.
+ */
+void ConfWatcher::watchFile(void)
+{
+	// NOTE: Closing the fd removes it from the kqueue.
+	if (m_fileFd >= 0) {
+		::close(m_fileFd);
+		m_fileFd = -1;
+	}
+
+# ifdef O_EVTONLY
+	m_fileFd = open(m_filename.c_str(), O_EVTONLY | O_CLOEXEC);
+# else /* !O_EVTONLY */
+	m_fileFd = open(m_filename.c_str(), O_RDONLY | O_CLOEXEC);
+# endif /* O_EVTONLY */
+	if (m_fileFd < 0) {
+		// File doesn't exist yet.
+		// The directory watch will report it when it's created.
+		return;
+	}
+
+	struct kevent kev;
+	EV_SET(&kev, m_fileFd, EVFILT_VNODE, EV_ADD | EV_CLEAR,
+		NOTE_WRITE | NOTE_EXTEND | NOTE_ATTRIB | NOTE_DELETE | NOTE_RENAME,
+		0, nullptr);
+	if (kevent(m_kq, &kev, 1, nullptr, 0, nullptr) < 0) {
+		::close(m_fileFd);
+		m_fileFd = -1;
+	}
+}
+#endif /* HAVE_KQUEUE && !_WIN32 && !HAVE_INOTIFY_INIT1 */
+
+/**
+ * Is a file being watched?
+ * @return True if a file is being watched.
+ */
+bool ConfWatcher::isWatching(void) const
+{
+#if defined(_WIN32)
+	return (m_hChange != INVALID_HANDLE_VALUE);
+#elif defined(HAVE_INOTIFY_INIT1)
+	return (m_fd >= 0 && !m_dirGone);
+#elif defined(HAVE_KQUEUE)
+	return (m_kq >= 0);
+#else
+	return false;
+#endif
+}
+
+/**
+ * Has the file changed since the last call to hasChanged()?
+ * If no file is being watched, this always returns true.
+ * @return True if the file might have changed; false if it hasn't.
+ */
+bool ConfWatcher::hasChanged(void)
+{
+	if (!isWatching()) {
+		// Not watching anything. Assume the file has changed.
+		return true;
+	}
+
+#if defined(_WIN32)
+	if (WaitForSingleObject(m_hChange, 0) != WAIT_OBJECT_0) {
+		// No changes.
+		return false;
+	}
+
+	// Something in the directory changed.
+	// Re-arm the notification for the next change.
+	FindNextChangeNotification(m_hChange);
+	return true;
+#elif defined(HAVE_INOTIFY_INIT1)
+	// Read all pending events.
+	bool changed = false;
+	union {
+		struct inotify_event ev;
+		char buf[4096];
+	} events;
+	ssize_t size;
+	while ((size = read(m_fd, events.buf, sizeof(events.buf))) > 0) {
+		const char *p = events.buf;
+		const char *const p_end = events.buf + size;
+		while (p < p_end) {
+			const struct inotify_event *const ev =
+				reinterpret_cast<const struct inotify_event*>(p);
+			if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+				// The directory is gone.
+				// Assume the file always changes from now on.
+				m_dirGone = true;
+				changed = true;
+			} else if (ev->mask & IN_Q_OVERFLOW) {
+				// Events were lost.
+				changed = true;
+			} else if (ev->len > 0 && m_basename == ev->name) {
+				// The file was changed.
+				changed = true;
+			}
+			p += sizeof(*ev) + ev->len;
+		}
+	}
+	return changed;
+#elif defined(HAVE_KQUEUE)
+	struct kevent evs[4];
+	static const struct timespec ts_zero = {0, 0};
+	const int n = kevent(m_kq, nullptr, 0, evs, static_cast<int>(ARRAY_SIZE(evs)), &ts_zero);
+	if (n <= 0) {
+		// No changes.
+		return false;
+	}
+
+	// Something changed. The file might have been created,
+	// deleted, or replaced, so re-open it.
+	MutexLocker mtxLocker(m_mtxFile);
+	watchFile();
+	return true;
+#else
+	return true;
+#endif
+}
+
+}
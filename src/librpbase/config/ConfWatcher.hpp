@@ -0,0 +1,100 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * ConfWatcher.hpp: Configuration file change notification.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CONFIG_CONFWATCHER_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CONFIG_CONFWATCHER_HPP__
+
+#include "librpbase/config.librpbase.h"
+#include "common.h"
+
+#ifdef _WIN32
+# include "libwin32common/RpWin32_sdk.h"
+#endif
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+
+// C++ includes.
+#include <string>
+
+namespace LibRpBase {
+
+/**
+ * Watches a configuration file for changes.
+ *
+ * This uses the operating system's change notification API:
+ * - Linux: inotify
+ * - BSD and macOS: kqueue
+ * - Windows: FindFirstChangeNotification()
+ *
+ * Notifications are polled by hasChanged(); no threads are used.
+ * A change notification is only a hint, since other files in the
+ * same directory may trigger it on some systems. The caller should
+ * still check the file's mtime before reloading it.
+ */
+class ConfWatcher
+{
+	public:
+		ConfWatcher();
+		~ConfWatcher();
+
+	private:
+		RP_DISABLE_COPY(ConfWatcher)
+
+	public:
+		/**
+		 * Start watching a file.
+		 * The file's directory must exist, but the file itself doesn't.
+		 * @param filename Filename.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int watch(const std::string &filename);
+
+		/**
+		 * Is a file being watched?
+		 * @return True if a file is being watched.
+		 */
+		bool isWatching(void) const;
+
+		/**
+		 * Has the file changed since the last call to hasChanged()?
+		 * If no file is being watched, this always returns true.
+		 * @return True if the file might have changed; false if it hasn't.
+		 */
+		bool hasChanged(void);
+
+	private:
+		/**
+		 * Stop watching the file.
+		 */
+		void close(void);
+
+	private:
+#if defined(_WIN32)
+		HANDLE m_hChange;	// FindFirstChangeNotification() handle
+#elif defined(HAVE_INOTIFY_INIT1)
+		int m_fd;		// inotify fd
+		volatile bool m_dirGone;	// True if the directory was deleted or moved
+		std::string m_basename;	// Filename without the directory
+#elif defined(HAVE_KQUEUE)
+		int m_kq;		// kqueue fd
+		int m_dirFd;		// Directory fd
+		int m_fileFd;		// File fd (-1 if the file doesn't exist)
+		std::string m_filename;	// Full filename
+		LibRpThreads::Mutex m_mtxFile;	// Protects m_fileFd
+
+		/**
+		 * Open the file and add it to the kqueue.
+		 */
+		void watchFile(void);
+#endif
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CONFIG_CONFWATCHER_HPP__ */
@@ -13,10 +13,19 @@
 #include "ConfReader_p.hpp"
 #include "ctypex.h"
 
+// librpthreads
+#include "librpthreads/pthread_once.h"
+
+// C includes. (C++ namespace)
+#include <climits>
+
 // C++ STL classes.
 using std::string;
 using std::unordered_map;
 
+// librpthreads
+using LibRpThreads::ReadLocker;
+
 #include "RomData.hpp"
 
 namespace LibRpBase {
@@ -32,10 +41,15 @@ class ConfigPrivate : public ConfReaderPrivate
 
 	public:
 		// Static Config instance.
-		// TODO: Q_GLOBAL_STATIC() equivalent, though we
-		// may need special initialization if the compiler
-		// doesn't support thread-safe statics.
-		static Config instance;
+		// Constructed on first use by initInstance().
+		static pthread_once_t once_control;
+		static Config *pInstance;
+
+		/**
+		 * Construct the singleton instance.
+		 * Called by pthread_once().
+		 */
+		static void initInstance(void);
 
 	public:
 		/**
@@ -82,7 +96,11 @@ class ConfigPrivate : public ConfReaderPrivate
 		bool useIntIconForSmallSizes;
 		bool downloadHighResScans;
 		bool storeFileOriginInfo;
+		bool offlineOnly;
+		bool packCache;
 		uint32_t palLanguageForGameTDB;
+		uint8_t maxConnectionsPerHost;
+		unsigned int maxCacheSize;
 
 		// DMG title screen mode. [index is ROM type]
 		Config::DMG_TitleScreen_Mode dmgTSMode[Config::DMG_TitleScreen_Mode::DMG_TS_MAX];
@@ -90,14 +108,30 @@ class ConfigPrivate : public ConfReaderPrivate
 		// Other options.
 		bool showDangerousPermissionsOverlayIcon;
 		bool enableThumbnailOnNetworkFS;
+		bool fastThumbnailPNG;
+		bool verifyROMChecksums;
+		unsigned int threadPoolSize;
+		unsigned int memoryBudget;
+		bool parsedResultCache;
 };
 
 /** ConfigPrivate **/
 
 // Singleton instance.
-// Using a static non-pointer variable in order to
-// handle proper destruction when the DLL is unloaded.
-Config ConfigPrivate::instance;
+// Constructed on first use instead of during static initialization,
+// so processes (and DLLs) that never use it don't pay for it.
+pthread_once_t ConfigPrivate::once_control = PTHREAD_ONCE_INIT;
+Config *ConfigPrivate::pInstance = nullptr;
+
+void ConfigPrivate::initInstance(void)
+{
+	// Using a function-local static variable in order to
+	// handle proper destruction when the DLL is unloaded.
+	// NOTE: pthread_once() is used because older compilers
+	// don't support thread-safe statics.
+	static Config instance;
+	pInstance = &instance;
+}
 
 /**
  * Default image type priority.
@@ -124,11 +158,24 @@ ConfigPrivate::ConfigPrivate()
 	, useIntIconForSmallSizes(true)
 	, downloadHighResScans(true)
 	, storeFileOriginInfo(true)
+	, offlineOnly(false)
+	, packCache(false)
 	, palLanguageForGameTDB('en')
+	, maxConnectionsPerHost(4)
+	, maxCacheSize(0)
 	/* Overlay icon */
 	, showDangerousPermissionsOverlayIcon(true)
 	/* Enable thumbnailing and metadata on network FS */
 	, enableThumbnailOnNetworkFS(false)
+	/* Fast PNG compression for thumbnails */
+	, fastThumbnailPNG(true)
+	/* Verify full ROM checksums */
+	, verifyROMChecksums(false)
+	/* Thread pool size */
+	, threadPoolSize(0)
+	, memoryBudget(64)
+	/* Parsed-result cache */
+	, parsedResultCache(false)
 {
 	// NOTE: Configuration is also initialized in the reset() function.
 	memset(dmgTSMode, 0, sizeof(dmgTSMode));
@@ -155,6 +202,10 @@ void ConfigPrivate::reset(void)
 	useIntIconForSmallSizes = true;
 	downloadHighResScans = true;
 	storeFileOriginInfo = true;
+	offlineOnly = false;
+	packCache = false;
+	maxConnectionsPerHost = 4;
+	maxCacheSize = 0;
 
 	// DMG title screen mode.
 	dmgTSMode[Config::DMG_TitleScreen_Mode::DMG_TS_DMG] = Config::DMG_TitleScreen_Mode::DMG_TS_DMG;
@@ -165,6 +216,16 @@ void ConfigPrivate::reset(void)
 	showDangerousPermissionsOverlayIcon = true;
 	// Enable thumbnail and metadata on network FS
 	enableThumbnailOnNetworkFS = false;
+	// Fast PNG compression for thumbnails
+	fastThumbnailPNG = true;
+	// Verify full ROM checksums
+	verifyROMChecksums = false;
+	// Thread pool size
+	threadPoolSize = 0;
+	// Memory budget for cached RomData objects, in MiB
+	memoryBudget = 64;
+	// Parsed-result cache
+	parsedResultCache = false;
 }
 
 /**
@@ -201,6 +262,10 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 			param = &downloadHighResScans;
 		} else if (!strcasecmp(name, "StoreFileOriginInfo")) {
 			param = &storeFileOriginInfo;
+		} else if (!strcasecmp(name, "OfflineOnly")) {
+			param = &offlineOnly;
+		} else if (!strcasecmp(name, "PackCache")) {
+			param = &packCache;
 		} else if (!strcasecmp(name, "PalLanguageForGameTDB")) {
 			// PAL language. Parse the language code.
 			// NOTE: Converting to lowercase.
@@ -211,6 +276,24 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 				palLanguageForGameTDB |= TOLOWER(*value);
 			}
 			return 1;
+		} else if (!strcasecmp(name, "MaxConnectionsPerHost")) {
+			// Maximum number of connections per host.
+			// Valid range is 1-64.
+			char *endptr = nullptr;
+			const long val = strtol(value, &endptr, 10);
+			if (endptr && *endptr == '\0' && val >= 1 && val <= 64) {
+				maxConnectionsPerHost = static_cast<uint8_t>(val);
+			}
+			return 1;
+		} else if (!strcasecmp(name, "MaxCacheSize")) {
+			// Maximum download cache size, in MiB.
+			// 0 is unlimited.
+			char *endptr = nullptr;
+			const unsigned long val = strtoul(value, &endptr, 10);
+			if (endptr && *endptr == '\0' && endptr != value && val <= UINT_MAX) {
+				maxCacheSize = static_cast<unsigned int>(val);
+			}
+			return 1;
 		} else {
 			// Invalid option.
 			return 1;
@@ -261,6 +344,28 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 			param = &showDangerousPermissionsOverlayIcon;
 		} else if (!strcasecmp(name, "EnableThumbnailOnNetworkFS")) {
 			param = &enableThumbnailOnNetworkFS;
+		} else if (!strcasecmp(name, "FastThumbnailPNG")) {
+			param = &fastThumbnailPNG;
+		} else if (!strcasecmp(name, "VerifyROMChecksums")) {
+			param = &verifyROMChecksums;
+		} else if (!strcasecmp(name, "ParsedResultCache")) {
+			param = &parsedResultCache;
+		} else if (!strcasecmp(name, "ThreadPoolSize")) {
+			// Number of worker threads. (0 for the number of CPUs)
+			char *endptr = nullptr;
+			const unsigned long val = strtoul(value, &endptr, 10);
+			if (endptr && *endptr == '\0' && endptr != value && val <= 256) {
+				threadPoolSize = static_cast<unsigned int>(val);
+			}
+			return 1;
+		} else if (!strcasecmp(name, "MemoryBudget")) {
+			// Memory budget for cached RomData objects, in MiB. (0 for unlimited)
+			char *endptr = nullptr;
+			const unsigned long val = strtoul(value, &endptr, 10);
+			if (endptr && *endptr == '\0' && endptr != value && val <= 4096) {
+				memoryBudget = static_cast<unsigned int>(val);
+			}
+			return 1;
 		} else {
 			// Invalid option.
 			return 1;
@@ -442,7 +547,8 @@ Config::Config()
 Config *Config::instance(void)
 {
 	// Initialize the singleton instance.
-	Config *const q = &ConfigPrivate::instance;
+	pthread_once(&ConfigPrivate::once_control, ConfigPrivate::initInstance);
+	Config *const q = ConfigPrivate::pInstance;
 
 	// Load the configuration if necessary.
 	q->load(false);
@@ -469,9 +575,12 @@ Config::ImgTypeResult Config::getImgTypePrio(const char *className, ImgTypePrio_
 	}
 
 	// Find the class name in the map.
+	// NOTE: The returned data is only valid until the
+	// configuration is reloaded.
 	RP_D(const Config);
 	string className_lower(className);
 	std::transform(className_lower.begin(), className_lower.end(), className_lower.begin(), ::tolower);
+	ReadLocker rdLocker(d->rwLock);
 	auto iter = d->mapImgTypePrio.find(className_lower);
 	if (iter == d->mapImgTypePrio.end()) {
 		// Class name not found.
@@ -570,6 +679,28 @@ bool Config::storeFileOriginInfo(void) const
 	return d->storeFileOriginInfo;
 }
 
+/**
+ * Only use images that are already in the download cache.
+ * If enabled, rp-download will never be run.
+ * @return True if offline only; false if not.
+ */
+bool Config::offlineOnly(void) const
+{
+	RP_D(const Config);
+	return d->offlineOnly;
+}
+
+/**
+ * Store downloaded images in a single pack file
+ * instead of one file per image?
+ * @return True if the pack file should be used; false if not.
+ */
+bool Config::packCache(void) const
+{
+	RP_D(const Config);
+	return d->packCache;
+}
+
 /**
  * Language code for PAL titles on GameTDB.
  * @return Language code.
@@ -580,6 +711,28 @@ uint32_t Config::palLanguageForGameTDB(void) const
 	return d->palLanguageForGameTDB;
 }
 
+/**
+ * Maximum number of simultaneous connections per host
+ * when downloading images from external databases.
+ * @return Maximum number of connections per host. (1-64)
+ */
+unsigned int Config::maxConnectionsPerHost(void) const
+{
+	RP_D(const Config);
+	return d->maxConnectionsPerHost;
+}
+
+/**
+ * Maximum size of the download cache.
+ * Least-recently-used files are deleted if the cache is larger.
+ * @return Maximum cache size, in MiB. (0 == unlimited)
+ */
+unsigned int Config::maxCacheSize(void) const
+{
+	RP_D(const Config);
+	return d->maxCacheSize;
+}
+
 /** DMG title screen mode **/
 
 /**
@@ -626,4 +779,63 @@ bool Config::enableThumbnailOnNetworkFS(void) const
 	return d->enableThumbnailOnNetworkFS;
 }
 
+/**
+ * Use fast PNG compression when writing thumbnails?
+ * Thumbnails will be larger, but they'll be written faster.
+ * NOTE: Call load() before using this function.
+ * @return True if we should use fast PNG compression; false if not.
+ */
+bool Config::fastThumbnailPNG(void) const
+{
+	RP_D(const Config);
+	return d->fastThumbnailPNG;
+}
+
+/**
+ * Verify full ROM checksums?
+ * This requires reading the entire ROM image.
+ * NOTE: Call load() before using this function.
+ * @return True if we should verify full ROM checksums; false if not.
+ */
+bool Config::verifyROMChecksums(void) const
+{
+	RP_D(const Config);
+	return d->verifyROMChecksums;
+}
+
+/**
+ * Number of worker threads in the process-wide thread pool.
+ * NOTE: Call load() before using this function.
+ * @return Number of worker threads. (0 for the number of CPUs)
+ */
+unsigned int Config::threadPoolSize(void) const
+{
+	RP_D(const Config);
+	return d->threadPoolSize;
+}
+
+/**
+ * Memory budget for cached RomData objects, in MiB.
+ * NOTE: Call load() before using this function.
+ * @return Memory budget, in MiB. (0 for unlimited)
+ */
+unsigned int Config::memoryBudget(void) const
+{
+	RP_D(const Config);
+	return d->memoryBudget;
+}
+
+/**
+ * Cache parsed fields, metadata, and small internal images
+ * on disk, so property pages for large files don't have to
+ * parse the file again?
+ * NOTE: Call load() before using this function.
+ * @return True if the parsed-result cache is enabled; false if not.
+ */
+bool Config::parsedResultCache(void) const
+{
+	RP_D(const Config);
+	return d->parsedResultCache;
+}
+
 }
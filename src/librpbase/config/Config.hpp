@@ -115,12 +115,40 @@ class Config : public ConfReader
 		 */
 		bool storeFileOriginInfo(void) const;
 
+		/**
+		 * Only use images that are already in the download cache.
+		 * If enabled, rp-download will never be run.
+		 * @return True if offline only; false if not.
+		 */
+		bool offlineOnly(void) const;
+
+		/**
+		 * Store downloaded images in a single pack file
+		 * instead of one file per image?
+		 * @return True if the pack file should be used; false if not.
+		 */
+		bool packCache(void) const;
+
 		/**
 		 * Language code for PAL titles on GameTDB.
 		 * @return Language code.
 		 */
 		uint32_t palLanguageForGameTDB(void) const;
 
+		/**
+		 * Maximum number of simultaneous connections per host
+		 * when downloading images from external databases.
+		 * @return Maximum number of connections per host. (1-64)
+		 */
+		unsigned int maxConnectionsPerHost(void) const;
+
+		/**
+		 * Maximum size of the download cache.
+		 * Least-recently-used files are deleted if the cache is larger.
+		 * @return Maximum cache size, in MiB. (0 == unlimited)
+		 */
+		unsigned int maxCacheSize(void) const;
+
 		/** DMG title screen mode **/
 
 		enum DMG_TitleScreen_Mode : uint8_t {
@@ -153,6 +181,45 @@ class Config : public ConfReader
 		 * @return True if we should enable; false if not.
 		 */
 		bool enableThumbnailOnNetworkFS(void) const;
+
+		/**
+		 * Use fast PNG compression when writing thumbnails?
+		 * Thumbnails will be larger, but they'll be written faster.
+		 * NOTE: Call load() before using this function.
+		 * @return True if we should use fast PNG compression; false if not.
+		 */
+		bool fastThumbnailPNG(void) const;
+
+		/**
+		 * Verify full ROM checksums?
+		 * This requires reading the entire ROM image.
+		 * NOTE: Call load() before using this function.
+		 * @return True if we should verify full ROM checksums; false if not.
+		 */
+		bool verifyROMChecksums(void) const;
+
+		/**
+		 * Number of worker threads in the process-wide thread pool.
+		 * NOTE: Call load() before using this function.
+		 * @return Number of worker threads. (0 for the number of CPUs)
+		 */
+		unsigned int threadPoolSize(void) const;
+
+		/**
+		 * Memory budget for cached RomData objects, in MiB.
+		 * NOTE: Call load() before using this function.
+		 * @return Memory budget, in MiB. (0 for unlimited)
+		 */
+		unsigned int memoryBudget(void) const;
+
+		/**
+		 * Cache parsed fields, metadata, and small internal images
+		 * on disk, so property pages for large files don't have to
+		 * parse the file again?
+		 * NOTE: Call load() before using this function.
+		 * @return True if the parsed-result cache is enabled; false if not.
+		 */
+		bool parsedResultCache(void) const;
 };
 
 }
@@ -13,6 +13,9 @@
 #include "libwin32common/RpWin32_sdk.h"
 #include "libwin32common/w32err.h"
 
+// librpfile
+#include "librpfile/RpTrace.hpp"
+
 // References:
 // - http://www.codeproject.com/Tips/787096/Operation-Password-CryptoAPI-with-AES
 //   [Google: "CryptoAPI decrypting AES example" (no quotes)]
@@ -313,6 +316,7 @@ int AesCAPI::setIV(const uint8_t *RESTRICT pIV, size_t size)
  */
 size_t AesCAPI::decrypt(uint8_t *RESTRICT pData, size_t size)
 {
+	RP_TRACE_SCOPE_D("IAesCipher::decrypt", "AesCAPI");
 	RP_D(AesCAPI);
 	if (d->hKey == 0) {
 		// Key hasn't been set.
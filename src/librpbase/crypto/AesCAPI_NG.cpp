@@ -15,6 +15,9 @@
 // librpthreads
 #include "librpthreads/Atomics.h"
 
+// librpfile
+#include "librpfile/RpTrace.hpp"
+
 // References:
 // - https://msdn.microsoft.com/en-us/library/windows/desktop/aa376234%28v=vs.85%29.aspx?f=255&MSPPError=-2147217396
 #include <bcrypt.h>
@@ -472,6 +475,7 @@ int AesCAPI_NG::setIV(const uint8_t *RESTRICT pIV, size_t size)
  */
 size_t AesCAPI_NG::decrypt(uint8_t *RESTRICT pData, size_t size)
 {
+	RP_TRACE_SCOPE_D("IAesCipher::decrypt", "AesCAPI_NG");
 	RP_D(AesCAPI_NG);
 	if (!d->hBcryptDll || !d->hAesAlg || !d->hKey) {
 		// Algorithm is not available,
@@ -18,6 +18,7 @@
 #elif defined(HAVE_NETTLE)
 # include "AesNettle.hpp"
 #endif
+#include "AesNI.hpp"
 
 namespace LibRpBase {
 
@@ -32,6 +33,15 @@ namespace LibRpBase {
  */
 IAesCipher *AesCipherFactory::create(void)
 {
+#ifdef AESNI_IS_SUPPORTED
+	// x86: Use AES-NI if the CPU supports it.
+	// This is significantly faster than the OS libraries,
+	// which have to handle every block size and mode.
+	if (AesNI::isUsable()) {
+		return new AesNI();
+	}
+#endif /* AESNI_IS_SUPPORTED */
+
 #if defined(_WIN32)
 	// Windows: Use CryptoAPI NG if available.
 	// If not, fall back to CryptoAPI.
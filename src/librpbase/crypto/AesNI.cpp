@@ -0,0 +1,535 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * AesNI.cpp: AES decryption class using AES-NI.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "AesNI.hpp"
+
+// librpfile
+#include "librpfile/RpTrace.hpp"
+
+// librpcpu
+#include "librpcpu/byteswap_rp.h"
+#include "librpcpu/cpuflags_x86.h"
+
+// AES-NI intrinsics
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+namespace LibRpBase {
+
+#define AES_BLOCK_SIZE 16
+
+// Number of blocks to process at once.
+// AESDEC/AESENC have a latency of several cycles, but they
+// can be issued every cycle if the blocks are independent.
+#define AESNI_PIPELINE_BLOCKS 4
+
+class AesNIPrivate
+{
+	public:
+		AesNIPrivate();
+		~AesNIPrivate();
+
+	private:
+		RP_DISABLE_COPY(AesNIPrivate)
+
+	public:
+		// Round keys.
+		// Stored as bytes, since this object isn't guaranteed
+		// to be 16-byte aligned on all systems. The round keys
+		// are loaded into registers when decrypting.
+		// NOTE: dec_keys[] uses the Equivalent Inverse Cipher
+		// order, i.e. dec_keys[0] is the last encryption round key.
+		uint8_t enc_keys[15][AES_BLOCK_SIZE];
+		uint8_t dec_keys[15][AES_BLOCK_SIZE];
+		unsigned int rounds;	// 0 if no key has been set.
+
+		// CBC: Initialization vector.
+		// CTR: Counter.
+		uint8_t iv[AES_BLOCK_SIZE];
+
+		IAesCipher::ChainingMode chainingMode;
+
+	public:
+		/**
+		 * Expand the key into the round keys.
+		 * @param pKey	[in] Key data.
+		 * @param size	[in] Size of pKey, in bytes. (16, 24, or 32)
+		 */
+		void expandKey(const uint8_t *RESTRICT pKey, size_t size);
+
+		/**
+		 * Decrypt data using ECB.
+		 * @param pData	[in/out] Data.
+		 * @param blocks	[in] Number of blocks.
+		 */
+		void decryptECB(uint8_t *RESTRICT pData, size_t blocks) const;
+
+		/**
+		 * Decrypt data using CBC.
+		 * The IV is updated for the next call.
+		 * @param pData	[in/out] Data.
+		 * @param blocks	[in] Number of blocks.
+		 */
+		void decryptCBC(uint8_t *RESTRICT pData, size_t blocks);
+
+		/**
+		 * Decrypt data using CTR.
+		 * The counter is updated for the next call.
+		 * @param pData	[in/out] Data.
+		 * @param blocks	[in] Number of blocks.
+		 */
+		void cryptCTR(uint8_t *RESTRICT pData, size_t blocks);
+};
+
+/** AesNIPrivate **/
+
+AesNIPrivate::AesNIPrivate()
+	: rounds(0)
+	, chainingMode(IAesCipher::ChainingMode::ECB)
+{
+	// Clear the round keys.
+	memset(enc_keys, 0, sizeof(enc_keys));
+	memset(dec_keys, 0, sizeof(dec_keys));
+	memset(iv, 0, sizeof(iv));
+}
+
+AesNIPrivate::~AesNIPrivate()
+{
+	// Don't leave the round keys in memory.
+	volatile uint8_t *p = &enc_keys[0][0];
+	for (size_t i = sizeof(enc_keys); i > 0; i--, p++) {
+		*p = 0;
+	}
+	p = &dec_keys[0][0];
+	for (size_t i = sizeof(dec_keys); i > 0; i--, p++) {
+		*p = 0;
+	}
+}
+
+/**
+ * Apply the AES S-box to each byte of a key schedule word.
+ * @param w Word
+ * @param rot If true, also rotate the word. (RotWord)
+ * @return SubWord(w), or SubWord(RotWord(w)) if rot is true.
+ */
+static inline uint32_t subWord(uint32_t w, bool rot)
+{
+	// AESKEYGENASSIST returns, for dwords 1 and 3:
+	// - dword 0: SubWord(X1)
+	// - dword 1: RotWord(SubWord(X1)) ^ RCON
+	// RCON is set to 0 so the key schedule can handle it,
+	// since AESKEYGENASSIST requires an immediate value.
+	const __m128i x = _mm_aeskeygenassist_si128(_mm_set1_epi32(static_cast<int>(w)), 0);
+	return static_cast<uint32_t>(_mm_cvtsi128_si32(rot ? _mm_shuffle_epi32(x, 0x55) : x));
+}
+
+/**
+ * Expand the key into the round keys.
+ * @param pKey	[in] Key data.
+ * @param size	[in] Size of pKey, in bytes. (16, 24, or 32)
+ */
+void AesNIPrivate::expandKey(const uint8_t *RESTRICT pKey, size_t size)
+{
+	// FIPS-197 key expansion. This handles all three key sizes
+	// the same way; AESKEYGENASSIST is only used for SubWord().
+	const unsigned int nk = static_cast<unsigned int>(size / 4);
+	rounds = nk + 6;
+	const unsigned int words = (rounds + 1) * 4;
+
+	uint32_t w[15*4];
+	memcpy(w, pKey, size);
+	uint32_t rcon = 0x01;
+	for (unsigned int i = nk; i < words; i++) {
+		uint32_t temp = w[i - 1];
+		if (i % nk == 0) {
+			temp = subWord(temp, true) ^ rcon;
+			rcon = ((rcon << 1) ^ ((rcon & 0x80) ? 0x1B : 0)) & 0xFF;
+		} else if (nk > 6 && i % nk == 4) {
+			temp = subWord(temp, false);
+		}
+		w[i] = w[i - nk] ^ temp;
+	}
+	memcpy(enc_keys, w, words * 4);
+
+	// Decryption round keys for the Equivalent Inverse Cipher.
+	memcpy(dec_keys[0], enc_keys[rounds], AES_BLOCK_SIZE);
+	for (unsigned int i = 1; i < rounds; i++) {
+		const __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(enc_keys[rounds - i]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dec_keys[i]), _mm_aesimc_si128(k));
+	}
+	memcpy(dec_keys[rounds], enc_keys[0], AES_BLOCK_SIZE);
+
+	// Clear the expanded key from the stack.
+	volatile uint32_t *p = w;
+	for (unsigned int i = words; i > 0; i--, p++) {
+		*p = 0;
+	}
+}
+
+/**
+ * Decrypt four blocks.
+ * @param rk Decryption round keys
+ * @param rounds Number of rounds
+ * @param b Blocks
+ */
+static inline void aesni_decrypt4(const __m128i *rk, unsigned int rounds, __m128i b[AESNI_PIPELINE_BLOCKS])
+{
+	b[0] = _mm_xor_si128(b[0], rk[0]);
+	b[1] = _mm_xor_si128(b[1], rk[0]);
+	b[2] = _mm_xor_si128(b[2], rk[0]);
+	b[3] = _mm_xor_si128(b[3], rk[0]);
+	for (unsigned int i = 1; i < rounds; i++) {
+		b[0] = _mm_aesdec_si128(b[0], rk[i]);
+		b[1] = _mm_aesdec_si128(b[1], rk[i]);
+		b[2] = _mm_aesdec_si128(b[2], rk[i]);
+		b[3] = _mm_aesdec_si128(b[3], rk[i]);
+	}
+	b[0] = _mm_aesdeclast_si128(b[0], rk[rounds]);
+	b[1] = _mm_aesdeclast_si128(b[1], rk[rounds]);
+	b[2] = _mm_aesdeclast_si128(b[2], rk[rounds]);
+	b[3] = _mm_aesdeclast_si128(b[3], rk[rounds]);
+}
+
+/**
+ * Decrypt a single block.
+ * @param rk Decryption round keys
+ * @param rounds Number of rounds
+ * @param b Block
+ * @return Decrypted block.
+ */
+static inline __m128i aesni_decrypt1(const __m128i *rk, unsigned int rounds, __m128i b)
+{
+	b = _mm_xor_si128(b, rk[0]);
+	for (unsigned int i = 1; i < rounds; i++) {
+		b = _mm_aesdec_si128(b, rk[i]);
+	}
+	return _mm_aesdeclast_si128(b, rk[rounds]);
+}
+
+/**
+ * Encrypt four blocks.
+ * @param rk Encryption round keys
+ * @param rounds Number of rounds
+ * @param b Blocks
+ */
+static inline void aesni_encrypt4(const __m128i *rk, unsigned int rounds, __m128i b[AESNI_PIPELINE_BLOCKS])
+{
+	b[0] = _mm_xor_si128(b[0], rk[0]);
+	b[1] = _mm_xor_si128(b[1], rk[0]);
+	b[2] = _mm_xor_si128(b[2], rk[0]);
+	b[3] = _mm_xor_si128(b[3], rk[0]);
+	for (unsigned int i = 1; i < rounds; i++) {
+		b[0] = _mm_aesenc_si128(b[0], rk[i]);
+		b[1] = _mm_aesenc_si128(b[1], rk[i]);
+		b[2] = _mm_aesenc_si128(b[2], rk[i]);
+		b[3] = _mm_aesenc_si128(b[3], rk[i]);
+	}
+	b[0] = _mm_aesenclast_si128(b[0], rk[rounds]);
+	b[1] = _mm_aesenclast_si128(b[1], rk[rounds]);
+	b[2] = _mm_aesenclast_si128(b[2], rk[rounds]);
+	b[3] = _mm_aesenclast_si128(b[3], rk[rounds]);
+}
+
+/**
+ * Encrypt a single block.
+ * @param rk Encryption round keys
+ * @param rounds Number of rounds
+ * @param b Block
+ * @return Encrypted block.
+ */
+static inline __m128i aesni_encrypt1(const __m128i *rk, unsigned int rounds, __m128i b)
+{
+	b = _mm_xor_si128(b, rk[0]);
+	for (unsigned int i = 1; i < rounds; i++) {
+		b = _mm_aesenc_si128(b, rk[i]);
+	}
+	return _mm_aesenclast_si128(b, rk[rounds]);
+}
+
+/**
+ * Load round keys into an aligned array.
+ * @param rk	[out] Round keys
+ * @param keys	[in] Round keys, as bytes
+ * @param rounds	[in] Number of rounds
+ */
+static inline void load_round_keys(__m128i rk[15], const uint8_t keys[15][AES_BLOCK_SIZE], unsigned int rounds)
+{
+	for (unsigned int i = 0; i <= rounds; i++) {
+		rk[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys[i]));
+	}
+}
+
+/**
+ * Decrypt data using ECB.
+ * @param pData	[in/out] Data.
+ * @param blocks	[in] Number of blocks.
+ */
+void AesNIPrivate::decryptECB(uint8_t *RESTRICT pData, size_t blocks) const
+{
+	__m128i rk[15];
+	load_round_keys(rk, dec_keys, rounds);
+
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+	for (; blocks >= AESNI_PIPELINE_BLOCKS; blocks -= AESNI_PIPELINE_BLOCKS, p += AESNI_PIPELINE_BLOCKS) {
+		__m128i b[AESNI_PIPELINE_BLOCKS];
+		b[0] = _mm_loadu_si128(&p[0]);
+		b[1] = _mm_loadu_si128(&p[1]);
+		b[2] = _mm_loadu_si128(&p[2]);
+		b[3] = _mm_loadu_si128(&p[3]);
+		aesni_decrypt4(rk, rounds, b);
+		_mm_storeu_si128(&p[0], b[0]);
+		_mm_storeu_si128(&p[1], b[1]);
+		_mm_storeu_si128(&p[2], b[2]);
+		_mm_storeu_si128(&p[3], b[3]);
+	}
+	for (; blocks > 0; blocks--, p++) {
+		_mm_storeu_si128(p, aesni_decrypt1(rk, rounds, _mm_loadu_si128(p)));
+	}
+}
+
+/**
+ * Decrypt data using CBC.
+ * The IV is updated for the next call.
+ * @param pData	[in/out] Data.
+ * @param blocks	[in] Number of blocks.
+ */
+void AesNIPrivate::decryptCBC(uint8_t *RESTRICT pData, size_t blocks)
+{
+	__m128i rk[15];
+	load_round_keys(rk, dec_keys, rounds);
+
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+	for (; blocks >= AESNI_PIPELINE_BLOCKS; blocks -= AESNI_PIPELINE_BLOCKS, p += AESNI_PIPELINE_BLOCKS) {
+		__m128i c[AESNI_PIPELINE_BLOCKS], b[AESNI_PIPELINE_BLOCKS];
+		b[0] = c[0] = _mm_loadu_si128(&p[0]);
+		b[1] = c[1] = _mm_loadu_si128(&p[1]);
+		b[2] = c[2] = _mm_loadu_si128(&p[2]);
+		b[3] = c[3] = _mm_loadu_si128(&p[3]);
+		aesni_decrypt4(rk, rounds, b);
+		_mm_storeu_si128(&p[0], _mm_xor_si128(b[0], prev));
+		_mm_storeu_si128(&p[1], _mm_xor_si128(b[1], c[0]));
+		_mm_storeu_si128(&p[2], _mm_xor_si128(b[2], c[1]));
+		_mm_storeu_si128(&p[3], _mm_xor_si128(b[3], c[2]));
+		prev = c[3];
+	}
+	for (; blocks > 0; blocks--, p++) {
+		const __m128i c = _mm_loadu_si128(p);
+		_mm_storeu_si128(p, _mm_xor_si128(aesni_decrypt1(rk, rounds, c), prev));
+		prev = c;
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(iv), prev);
+}
+
+/**
+ * Get the current CTR counter block and increment the counter.
+ * @param ctr_hi	[in/out] High 64 bits of the counter
+ * @param ctr_lo	[in/out] Low 64 bits of the counter
+ * @return Counter block.
+ */
+static inline __m128i ctr_next(uint64_t &ctr_hi, uint64_t &ctr_lo)
+{
+	const __m128i b = _mm_set_epi64x(
+		static_cast<int64_t>(cpu_to_be64(ctr_lo)),
+		static_cast<int64_t>(cpu_to_be64(ctr_hi)));
+	if (++ctr_lo == 0) {
+		ctr_hi++;
+	}
+	return b;
+}
+
+/**
+ * Decrypt data using CTR.
+ * The counter is updated for the next call.
+ * @param pData	[in/out] Data.
+ * @param blocks	[in] Number of blocks.
+ */
+void AesNIPrivate::cryptCTR(uint8_t *RESTRICT pData, size_t blocks)
+{
+	__m128i rk[15];
+	load_round_keys(rk, enc_keys, rounds);
+
+	// The counter is a 128-bit big-endian value.
+	uint64_t ctr[2];
+	memcpy(ctr, iv, sizeof(ctr));
+	uint64_t ctr_hi = be64_to_cpu(ctr[0]);
+	uint64_t ctr_lo = be64_to_cpu(ctr[1]);
+
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+	for (; blocks >= AESNI_PIPELINE_BLOCKS; blocks -= AESNI_PIPELINE_BLOCKS, p += AESNI_PIPELINE_BLOCKS) {
+		__m128i b[AESNI_PIPELINE_BLOCKS];
+		b[0] = ctr_next(ctr_hi, ctr_lo);
+		b[1] = ctr_next(ctr_hi, ctr_lo);
+		b[2] = ctr_next(ctr_hi, ctr_lo);
+		b[3] = ctr_next(ctr_hi, ctr_lo);
+		aesni_encrypt4(rk, rounds, b);
+		_mm_storeu_si128(&p[0], _mm_xor_si128(b[0], _mm_loadu_si128(&p[0])));
+		_mm_storeu_si128(&p[1], _mm_xor_si128(b[1], _mm_loadu_si128(&p[1])));
+		_mm_storeu_si128(&p[2], _mm_xor_si128(b[2], _mm_loadu_si128(&p[2])));
+		_mm_storeu_si128(&p[3], _mm_xor_si128(b[3], _mm_loadu_si128(&p[3])));
+	}
+	for (; blocks > 0; blocks--, p++) {
+		const __m128i b = ctr_next(ctr_hi, ctr_lo);
+		_mm_storeu_si128(p, _mm_xor_si128(aesni_encrypt1(rk, rounds, b), _mm_loadu_si128(p)));
+	}
+
+	ctr[0] = cpu_to_be64(ctr_hi);
+	ctr[1] = cpu_to_be64(ctr_lo);
+	memcpy(iv, ctr, sizeof(ctr));
+}
+
+/** AesNI **/
+
+AesNI::AesNI()
+	: d_ptr(new AesNIPrivate())
+{ }
+
+AesNI::~AesNI()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is AES-NI usable on this system?
+ * @return True if the CPU supports AES-NI.
+ */
+bool AesNI::isUsable(void)
+{
+	return !!RP_CPU_HasAES();
+}
+
+/**
+ * Get the name of the AesCipher implementation.
+ * @return Name.
+ */
+const char *AesNI::name(void) const
+{
+	return "AES-NI";
+}
+
+/**
+ * Has the cipher been initialized properly?
+ * @return True if initialized; false if not.
+ */
+bool AesNI::isInit(void) const
+{
+	// The CPU must support AES-NI.
+	return isUsable();
+}
+
+/**
+ * Set the encryption key.
+ * @param pKey	[in] Key data.
+ * @param size	[in] Size of pKey, in bytes.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setKey(const uint8_t *RESTRICT pKey, size_t size)
+{
+	// Acceptable key lengths:
+	// - 16 (AES-128)
+	// - 24 (AES-192)
+	// - 32 (AES-256)
+	if (!pKey || !(size == 16 || size == 24 || size == 32)) {
+		return -EINVAL;
+	} else if (!isUsable()) {
+		return -ENOTSUP;
+	}
+
+	// NOTE: Both the encryption and decryption round keys
+	// are expanded here, so changing the chaining mode
+	// doesn't require a key update.
+	RP_D(AesNI);
+	d->expandKey(pKey, size);
+	return 0;
+}
+
+/**
+ * Set the cipher chaining mode.
+ *
+ * Note that the IV/counter must be set *after* setting
+ * the chaining mode; otherwise, setIV() will fail.
+ *
+ * @param mode Cipher chaining mode.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setChainingMode(ChainingMode mode)
+{
+	if (mode < ChainingMode::ECB || mode >= ChainingMode::Max) {
+		return -EINVAL;
+	}
+
+	RP_D(AesNI);
+	d->chainingMode = mode;
+	return 0;
+}
+
+/**
+ * Set the IV (CBC mode) or counter (CTR mode).
+ * @param pIV	[in] IV/counter data.
+ * @param size	[in] Size of pIV, in bytes.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setIV(const uint8_t *RESTRICT pIV, size_t size)
+{
+	RP_D(AesNI);
+	if (!pIV || size != AES_BLOCK_SIZE ||
+	    d->chainingMode < ChainingMode::CBC || d->chainingMode >= ChainingMode::Max)
+	{
+		// Invalid parameters and/or chaining mode.
+		return -EINVAL;
+	}
+
+	// Set the IV/counter.
+	memcpy(d->iv, pIV, AES_BLOCK_SIZE);
+	return 0;
+}
+
+/**
+ * Decrypt a block of data.
+ * @param pData	[in/out] Data block.
+ * @param size	[in] Length of data block. (Must be a multiple of 16.)
+ * @return Number of bytes decrypted on success; 0 on error.
+ */
+size_t AesNI::decrypt(uint8_t *RESTRICT pData, size_t size)
+{
+	RP_TRACE_SCOPE_D("IAesCipher::decrypt", "AesNI");
+	if (!pData || size == 0 || (size % AES_BLOCK_SIZE != 0)) {
+		// Invalid parameters.
+		return 0;
+	}
+
+	RP_D(AesNI);
+	if (d->rounds == 0) {
+		// No key set...
+		return 0;
+	}
+
+	const size_t blocks = size / AES_BLOCK_SIZE;
+	switch (d->chainingMode) {
+		case ChainingMode::ECB:
+			d->decryptECB(pData, blocks);
+			break;
+		case ChainingMode::CBC:
+			// IV is automatically updated for the next block.
+			d->decryptCBC(pData, blocks);
+			break;
+		case ChainingMode::CTR:
+			// Counter is automatically updated for the next block.
+			// NOTE: CTR uses the *encrypt* function, even for decryption.
+			d->cryptCTR(pData, blocks);
+			break;
+		default:
+			return 0;
+	}
+
+	return size;
+}
+
+}
@@ -11,6 +11,9 @@
 
 #include "AesNettle.hpp"
 
+// librpfile
+#include "librpfile/RpTrace.hpp"
+
 // Nettle AES functions.
 #include <nettle/nettle-types.h>
 #include <nettle/aes.h>
@@ -222,6 +225,7 @@ int AesNettle::setIV(const uint8_t *RESTRICT pIV, size_t size)
  */
 size_t AesNettle::decrypt(uint8_t *RESTRICT pData, size_t size)
 {
+	RP_TRACE_SCOPE_D("IAesCipher::decrypt", "AesNettle");
 	if (!pData || size == 0 || (size % AES_BLOCK_SIZE != 0)) {
 		// Invalid parameters.
 		return 0;
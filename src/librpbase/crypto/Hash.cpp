@@ -0,0 +1,51 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Hash.cpp: Incremental hash class. (common functions)                    *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "Hash.hpp"
+
+namespace LibRpBase {
+
+/**
+ * Get the hash length.
+ * @return Hash length, in bytes. (0 if the algorithm is invalid)
+ */
+size_t Hash::hashLength(void) const
+{
+	switch (algorithm()) {
+		case Algorithm::CRC32:
+			return 4;
+		case Algorithm::MD5:
+			return 16;
+		case Algorithm::SHA1:
+			return 20;
+		default:
+			break;
+	}
+	return 0;
+}
+
+/**
+ * Get the name of a hash algorithm.
+ * @param algorithm Hash algorithm.
+ * @return Name, e.g. "md5"; nullptr if invalid.
+ */
+const char *Hash::algorithmName(Algorithm algorithm)
+{
+	static const char *const algorithm_names[] = {
+		nullptr,
+		"crc32", "md5", "sha1",
+	};
+	static_assert(ARRAY_SIZE(algorithm_names) == static_cast<size_t>(Algorithm::Max),
+		"algorithm_names[] is out of sync with Hash::Algorithm.");
+
+	const unsigned int idx = static_cast<unsigned int>(algorithm);
+	return (idx < ARRAY_SIZE(algorithm_names) ? algorithm_names[idx] : nullptr);
+}
+
+}
@@ -0,0 +1,104 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Hash.hpp: Incremental hash class. (CRC32, MD5, SHA-1)                   *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASH_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASH_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stddef.h>	/* size_t */
+#include <stdint.h>
+
+namespace LibRpBase {
+
+class HashPrivate;
+class Hash
+{
+	public:
+		enum class Algorithm {
+			Unknown = 0,
+
+			CRC32	= 1,
+			MD5	= 2,
+			SHA1	= 3,
+
+			Max
+		};
+
+		/**
+		 * Create a hash object.
+		 * @param algorithm Hash algorithm.
+		 */
+		explicit Hash(Algorithm algorithm);
+		~Hash();
+
+	private:
+		RP_DISABLE_COPY(Hash)
+	private:
+		friend class HashPrivate;
+		HashPrivate *const d_ptr;
+
+	public:
+		/**
+		 * Get the hash algorithm.
+		 * @return Hash algorithm.
+		 */
+		Algorithm algorithm(void) const;
+
+		/**
+		 * Is the hash object usable?
+		 * @return True if it is; false if not.
+		 */
+		bool isUsable(void) const;
+
+		/**
+		 * Get the hash length.
+		 * @return Hash length, in bytes. (0 if the algorithm is invalid)
+		 */
+		size_t hashLength(void) const;
+
+		/**
+		 * Reset the hash state in order to hash new data.
+		 */
+		void reset(void);
+
+		/**
+		 * Process a block of data.
+		 * @param pData	[in] Input data.
+		 * @param len	[in] Data length.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		ATTR_ACCESS_SIZE(read_only, 2, 3)
+		int process(const void *pData, size_t len);
+
+		/**
+		 * Get the hash of all data processed since the last reset().
+		 * This does not change the hash state.
+		 *
+		 * CRC32 is stored as big-endian, so all hashes can be
+		 * printed as hex strings in the usual byte order.
+		 *
+		 * @param pHash		[out] Output hash buffer. (Must be at least hashLength() bytes.)
+		 * @param hash_len	[in] Size of hash buffer.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 2, 3)
+		int getHash(uint8_t *pHash, size_t hash_len);
+
+		/**
+		 * Get the name of a hash algorithm.
+		 * @param algorithm Hash algorithm.
+		 * @return Name, e.g. "md5"; nullptr if invalid.
+		 */
+		static const char *algorithmName(Algorithm algorithm);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASH_HPP__ */
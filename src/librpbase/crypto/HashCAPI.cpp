@@ -0,0 +1,265 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * HashCAPI.cpp: Incremental hash class. (Win32 CryptoAPI)                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "Hash.hpp"
+
+// librpcpu
+#include "librpcpu/byteswap_rp.h"
+#include "librpcpu/crc32_rp.h"
+
+// libwin32common
+#include "libwin32common/RpWin32_sdk.h"
+#include "libwin32common/w32err.h"
+
+// References:
+// - https://docs.microsoft.com/en-us/windows/win32/seccrypto/example-c-program--creating-an-md-5-hash-from-file-content
+#include <wincrypt.h>
+
+namespace LibRpBase {
+
+class HashPrivate
+{
+	public:
+		explicit HashPrivate(Hash::Algorithm algorithm);
+		~HashPrivate();
+
+	private:
+		RP_DISABLE_COPY(HashPrivate)
+
+	public:
+		Hash::Algorithm algorithm;
+
+		// CRC32 is handled by librpcpu.
+		uint32_t crc32;
+
+		// MD5 and SHA-1 are handled by CryptoAPI.
+		HCRYPTPROV hProvider;
+		HCRYPTHASH hHash;
+
+	public:
+		/**
+		 * (Re-)create the CryptoAPI hash object.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int createHash(void);
+};
+
+/** HashPrivate **/
+
+HashPrivate::HashPrivate(Hash::Algorithm algorithm)
+	: algorithm(algorithm)
+	, crc32(0)
+	, hProvider(0)
+	, hHash(0)
+{
+	if (algorithm != Hash::Algorithm::MD5 && algorithm != Hash::Algorithm::SHA1) {
+		// Not a CryptoAPI algorithm.
+		return;
+	}
+
+	// Get handle to the crypto provider
+	if (!CryptAcquireContext(&hProvider, nullptr, nullptr,
+	    PROV_RSA_FULL, CRYPT_VERIFYCONTEXT | CRYPT_SILENT))
+	{
+		// Failed to get a handle to the crypto provider.
+		hProvider = 0;
+	}
+}
+
+HashPrivate::~HashPrivate()
+{
+	if (hHash) {
+		CryptDestroyHash(hHash);
+	}
+	if (hProvider) {
+		CryptReleaseContext(hProvider, 0);
+	}
+}
+
+/**
+ * (Re-)create the CryptoAPI hash object.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int HashPrivate::createHash(void)
+{
+	if (hHash) {
+		CryptDestroyHash(hHash);
+		hHash = 0;
+	}
+	if (!hProvider) {
+		return -EBADF;
+	}
+
+	const ALG_ID algId = (algorithm == Hash::Algorithm::SHA1 ? CALG_SHA1 : CALG_MD5);
+	if (!CryptCreateHash(hProvider, algId, 0, 0, &hHash)) {
+		// Error creating the hash object.
+		hHash = 0;
+		return -w32err_to_posix(GetLastError());
+	}
+	return 0;
+}
+
+/** Hash **/
+
+/**
+ * Create a hash object.
+ * @param algorithm Hash algorithm.
+ */
+Hash::Hash(Algorithm algorithm)
+	: d_ptr(new HashPrivate(algorithm))
+{
+	reset();
+}
+
+Hash::~Hash()
+{
+	delete d_ptr;
+}
+
+/**
+ * Get the hash algorithm.
+ * @return Hash algorithm.
+ */
+Hash::Algorithm Hash::algorithm(void) const
+{
+	RP_D(const Hash);
+	return d->algorithm;
+}
+
+/**
+ * Is the hash object usable?
+ * @return True if it is; false if not.
+ */
+bool Hash::isUsable(void) const
+{
+	RP_D(const Hash);
+	switch (d->algorithm) {
+		case Algorithm::CRC32:
+			return true;
+		case Algorithm::MD5:
+		case Algorithm::SHA1:
+			return (d->hHash != 0);
+		default:
+			break;
+	}
+	return false;
+}
+
+/**
+ * Reset the hash state in order to hash new data.
+ */
+void Hash::reset(void)
+{
+	RP_D(Hash);
+	switch (d->algorithm) {
+		case Algorithm::CRC32:
+			d->crc32 = 0;
+			break;
+		case Algorithm::MD5:
+		case Algorithm::SHA1:
+			d->createHash();
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * Process a block of data.
+ * @param pData	[in] Input data.
+ * @param len	[in] Data length.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::process(const void *pData, size_t len)
+{
+	assert(pData != nullptr || len == 0);
+	if (!pData && len != 0) {
+		return -EINVAL;
+	}
+
+	RP_D(Hash);
+	const uint8_t *const p8 = static_cast<const uint8_t*>(pData);
+	switch (d->algorithm) {
+		case Algorithm::CRC32:
+			d->crc32 = rp_crc32(d->crc32, p8, len);
+			break;
+		case Algorithm::MD5:
+		case Algorithm::SHA1: {
+			if (!d->hHash) {
+				return -EBADF;
+			}
+			// CryptHashData() takes a DWORD.
+			size_t pos = 0;
+			while (pos < len) {
+				const DWORD sz = static_cast<DWORD>(std::min(len - pos, static_cast<size_t>(1U << 30)));
+				if (!CryptHashData(d->hHash, &p8[pos], sz, 0)) {
+					// Error hashing the data.
+					return -w32err_to_posix(GetLastError());
+				}
+				pos += sz;
+			}
+			break;
+		}
+		default:
+			return -EBADF;
+	}
+	return 0;
+}
+
+/**
+ * Get the hash of all data processed since the last reset().
+ * This does not change the hash state.
+ *
+ * CRC32 is stored as big-endian, so all hashes can be
+ * printed as hex strings in the usual byte order.
+ *
+ * @param pHash		[out] Output hash buffer. (Must be at least hashLength() bytes.)
+ * @param hash_len	[in] Size of hash buffer.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::getHash(uint8_t *pHash, size_t hash_len)
+{
+	const size_t len = hashLength();
+	assert(pHash != nullptr);
+	assert(hash_len >= len);
+	if (!pHash || len == 0 || hash_len < len) {
+		// Invalid parameters.
+		return -EINVAL;
+	}
+
+	RP_D(const Hash);
+	if (d->algorithm == Algorithm::CRC32) {
+		const uint32_t crc32_be = cpu_to_be32(d->crc32);
+		memcpy(pHash, &crc32_be, sizeof(crc32_be));
+		return 0;
+	} else if (!d->hHash) {
+		return -EBADF;
+	}
+
+	// NOTE: CryptGetHashParam(HP_HASHVAL) finalizes the hash object,
+	// so a duplicate of the hash object is finalized instead.
+	HCRYPTHASH hDupHash;
+	if (!CryptDuplicateHash(d->hHash, nullptr, 0, &hDupHash)) {
+		return -w32err_to_posix(GetLastError());
+	}
+
+	int ret = 0;
+	DWORD cbHash = static_cast<DWORD>(len);
+	if (!CryptGetHashParam(hDupHash, HP_HASHVAL, pHash, &cbHash, 0)) {
+		// Error getting the hash.
+		ret = -w32err_to_posix(GetLastError());
+	} else if (cbHash != static_cast<DWORD>(len)) {
+		// Wrong hash length.
+		ret = -EINVAL;
+	}
+	CryptDestroyHash(hDupHash);
+	return ret;
+}
+
+}
@@ -0,0 +1,184 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * HashNettle.cpp: Incremental hash class. (GNU Nettle)                    *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "Hash.hpp"
+
+// librpcpu
+#include "librpcpu/byteswap_rp.h"
+#include "librpcpu/crc32_rp.h"
+
+// Nettle hash functions.
+#include <nettle/md5.h>
+#include <nettle/sha1.h>
+
+namespace LibRpBase {
+
+class HashPrivate
+{
+	public:
+		explicit HashPrivate(Hash::Algorithm algorithm);
+
+	private:
+		RP_DISABLE_COPY(HashPrivate)
+
+	public:
+		Hash::Algorithm algorithm;
+
+		union {
+			uint32_t crc32;
+			struct md5_ctx md5;
+			struct sha1_ctx sha1;
+		} ctx;
+};
+
+/** HashPrivate **/
+
+HashPrivate::HashPrivate(Hash::Algorithm algorithm)
+	: algorithm(algorithm)
+{
+	memset(&ctx, 0, sizeof(ctx));
+}
+
+/** Hash **/
+
+/**
+ * Create a hash object.
+ * @param algorithm Hash algorithm.
+ */
+Hash::Hash(Algorithm algorithm)
+	: d_ptr(new HashPrivate(algorithm))
+{
+	reset();
+}
+
+Hash::~Hash()
+{
+	delete d_ptr;
+}
+
+/**
+ * Get the hash algorithm.
+ * @return Hash algorithm.
+ */
+Hash::Algorithm Hash::algorithm(void) const
+{
+	RP_D(const Hash);
+	return d->algorithm;
+}
+
+/**
+ * Is the hash object usable?
+ * @return True if it is; false if not.
+ */
+bool Hash::isUsable(void) const
+{
+	// Nettle always works if the algorithm is valid.
+	RP_D(const Hash);
+	return (d->algorithm > Algorithm::Unknown && d->algorithm < Algorithm::Max);
+}
+
+/**
+ * Reset the hash state in order to hash new data.
+ */
+void Hash::reset(void)
+{
+	RP_D(Hash);
+	switch (d->algorithm) {
+		case Algorithm::CRC32:
+			d->ctx.crc32 = 0;
+			break;
+		case Algorithm::MD5:
+			md5_init(&d->ctx.md5);
+			break;
+		case Algorithm::SHA1:
+			sha1_init(&d->ctx.sha1);
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * Process a block of data.
+ * @param pData	[in] Input data.
+ * @param len	[in] Data length.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::process(const void *pData, size_t len)
+{
+	assert(pData != nullptr || len == 0);
+	if (!pData && len != 0) {
+		return -EINVAL;
+	}
+
+	RP_D(Hash);
+	const uint8_t *const p8 = static_cast<const uint8_t*>(pData);
+	switch (d->algorithm) {
+		case Algorithm::CRC32:
+			d->ctx.crc32 = rp_crc32(d->ctx.crc32, p8, len);
+			break;
+		case Algorithm::MD5:
+			md5_update(&d->ctx.md5, len, p8);
+			break;
+		case Algorithm::SHA1:
+			sha1_update(&d->ctx.sha1, len, p8);
+			break;
+		default:
+			return -EBADF;
+	}
+	return 0;
+}
+
+/**
+ * Get the hash of all data processed since the last reset().
+ * This does not change the hash state.
+ *
+ * CRC32 is stored as big-endian, so all hashes can be
+ * printed as hex strings in the usual byte order.
+ *
+ * @param pHash		[out] Output hash buffer. (Must be at least hashLength() bytes.)
+ * @param hash_len	[in] Size of hash buffer.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::getHash(uint8_t *pHash, size_t hash_len)
+{
+	const size_t len = hashLength();
+	assert(pHash != nullptr);
+	assert(hash_len >= len);
+	if (!pHash || len == 0 || hash_len < len) {
+		// Invalid parameters.
+		return -EINVAL;
+	}
+
+	// NOTE: Nettle's digest functions reset the context,
+	// so a copy of the context is finalized instead.
+	RP_D(const Hash);
+	switch (d->algorithm) {
+		case Algorithm::CRC32: {
+			const uint32_t crc32_be = cpu_to_be32(d->ctx.crc32);
+			memcpy(pHash, &crc32_be, sizeof(crc32_be));
+			break;
+		}
+		case Algorithm::MD5: {
+			struct md5_ctx md5 = d->ctx.md5;
+			md5_digest(&md5, len, pHash);
+			break;
+		}
+		case Algorithm::SHA1: {
+			struct sha1_ctx sha1 = d->ctx.sha1;
+			sha1_digest(&sha1, len, pHash);
+			break;
+		}
+		default:
+			return -EBADF;
+	}
+	return 0;
+}
+
+}
@@ -18,9 +18,32 @@ using std::string;
 using std::unique_ptr;
 using std::unordered_map;
 
+// librpthreads
+#include "librpthreads/pthread_once.h"
+using LibRpThreads::ReadLocker;
+
 #include "IAesCipher.hpp"
 #include "AesCipherFactory.hpp"
 
+#ifdef ENABLE_DECRYPTION
+// librpcpu, librpfile
+#include "librpcpu/byteswap_rp.h"
+#include "librpcpu/crc32_rp.h"
+#include "librpfile/FileSystem.hpp"
+#include "librpfile/RpFile.hpp"
+using LibRpFile::RpFile;
+
+# ifdef _WIN32
+// Win32 needed for GetCurrentProcessId() and MoveFileEx().
+#  include "libwin32common/RpWin32_sdk.h"
+#  include "TextFuncs_wchar.hpp"
+# else /* !_WIN32 */
+// chmod(), getpid(), rename()
+#  include <sys/stat.h>
+#  include <unistd.h>
+# endif /* _WIN32 */
+#endif /* ENABLE_DECRYPTION */
+
 namespace LibRpBase {
 
 class KeyManagerPrivate : public ConfReaderPrivate
@@ -35,10 +58,15 @@ class KeyManagerPrivate : public ConfReaderPrivate
 #ifdef ENABLE_DECRYPTION
 	public:
 		// Static KeyManager instance.
-		// TODO: Q_GLOBAL_STATIC() equivalent, though we
-		// may need special initialization if the compiler
-		// doesn't support thread-safe statics.
-		static KeyManager instance;
+		// Constructed on first use by initInstance().
+		static pthread_once_t once_control;
+		static KeyManager *pInstance;
+
+		/**
+		 * Construct the singleton instance.
+		 * Called by pthread_once().
+		 */
+		static void initInstance(void);
 #endif /* ENABLE_DECRYPTION */
 
 	public:
@@ -59,6 +87,67 @@ class KeyManagerPrivate : public ConfReaderPrivate
 		int processConfigLine(const char *section,
 			const char *name, const char *value) final;
 
+#ifdef ENABLE_DECRYPTION
+		/**
+		 * Load the keys from keys.cache.
+		 * Called by ConfReader::load() before parsing keys.conf.
+		 *
+		 * @param fileSize	[in] keys.conf size.
+		 * @param mtime		[in] keys.conf mtime.
+		 * @return True if the cache was loaded; false if keys.conf must be parsed.
+		 */
+		bool loadCache(off64_t fileSize, time_t mtime) final;
+
+		/**
+		 * Save the keys to keys.cache.
+		 * Called by ConfReader::load() after parsing keys.conf.
+		 *
+		 * @param fileSize	[in] keys.conf size.
+		 * @param mtime		[in] keys.conf mtime.
+		 */
+		void saveCache(off64_t fileSize, time_t mtime) const final;
+
+	private:
+		/**
+		 * Get the keys.cache filename.
+		 * @return keys.cache filename, or empty string on error.
+		 */
+		string getCacheFilename(void) const;
+
+		/**
+		 * keys.cache: Binary cache of the decoded keys from keys.conf.
+		 * This allows the keys to be loaded without parsing keys.conf.
+		 * All fields are in little-endian.
+		 *
+		 * The header is followed by:
+		 * - KeysCacheEntry[count]
+		 * - Key data. (keys_len bytes; same layout as vKeys)
+		 * - Key names. (names_len bytes; not NULL-terminated)
+		 */
+		struct KeysCacheHeader {
+			char magic[8];		// [0x000] "RPKEYC01"
+			uint64_t conf_size;	// [0x008] keys.conf size
+			int64_t conf_mtime;	// [0x010] keys.conf mtime
+			uint32_t count;		// [0x018] Number of keys
+			uint32_t keys_len;	// [0x01C] Length of the key data, in bytes
+			uint32_t names_len;	// [0x020] Length of the key names, in bytes
+			uint32_t crc32;		// [0x024] CRC32 of the remainder of the file
+		};
+		ASSERT_STRUCT(KeysCacheHeader, 0x28);
+
+		struct KeysCacheEntry {
+			uint32_t name_offset;	// [0x000] Offset of the key name in the key names block
+			uint32_t key_offset;	// [0x004] Offset of the key in the key data block
+			uint16_t name_len;	// [0x008] Length of the key name
+			uint8_t key_len;	// [0x00A] Length of the key
+			uint8_t reserved;	// [0x00B]
+		};
+		ASSERT_STRUCT(KeysCacheEntry, 12);
+
+		// keys.cache size limit. (keys.conf is usually only a few KB.)
+		static const size_t KEYS_CACHE_MAX_SIZE = 1U*1024U*1024U;
+#endif /* ENABLE_DECRYPTION */
+
 	public:
 #ifdef ENABLE_DECRYPTION
 		// Encryption key data.
@@ -89,9 +178,17 @@ class KeyManagerPrivate : public ConfReaderPrivate
 
 #ifdef ENABLE_DECRYPTION
 // Singleton instance.
-// Using a static non-pointer variable in order to
-// handle proper destruction when the DLL is unloaded.
-KeyManager KeyManagerPrivate::instance;
+// keys.conf is only needed for encrypted images, so the
+// instance isn't constructed until it's actually used.
+pthread_once_t KeyManagerPrivate::once_control = PTHREAD_ONCE_INIT;
+KeyManager *KeyManagerPrivate::pInstance = nullptr;
+
+void KeyManagerPrivate::initInstance(void)
+{
+	// Function-local static; see ConfigPrivate::initInstance().
+	static KeyManager instance;
+	pInstance = &instance;
+}
 
 // Verification test string.
 // NOTE: This string is NOT NULL-terminated!
@@ -215,6 +312,228 @@ int KeyManagerPrivate::processConfigLine(const char *section, const char *name,
 #endif /* ENABLE_DECRYPTION */
 }
 
+#ifdef ENABLE_DECRYPTION
+// keys.cache magic number.
+static const char KEYS_CACHE_MAGIC[] = {'R','P','K','E','Y','C','0','1'};
+
+/**
+ * Get the keys.cache filename.
+ * @return keys.cache filename, or empty string on error.
+ */
+string KeyManagerPrivate::getCacheFilename(void) const
+{
+	if (conf_filename.empty()) {
+		// keys.conf filename hasn't been determined.
+		return string();
+	}
+	return LibRpFile::FileSystem::replace_ext(conf_filename.c_str(), ".cache");
+}
+
+/**
+ * Load the keys from keys.cache.
+ * Called by ConfReader::load() before parsing keys.conf.
+ *
+ * @param fileSize	[in] keys.conf size.
+ * @param mtime		[in] keys.conf mtime.
+ * @return True if the cache was loaded; false if keys.conf must be parsed.
+ */
+bool KeyManagerPrivate::loadCache(off64_t fileSize, time_t mtime)
+{
+	const string cache_filename = getCacheFilename();
+	if (cache_filename.empty()) {
+		return false;
+	}
+
+	RpFile *const file = new RpFile(cache_filename,
+		static_cast<RpFile::FileMode>(RpFile::FM_OPEN_READ | RpFile::FM_MMAP));
+	if (!file->isOpen()) {
+		// No cache file.
+		file->unref();
+		return false;
+	}
+
+	const off64_t cacheSize = file->size();
+	if (cacheSize < static_cast<off64_t>(sizeof(KeysCacheHeader)) ||
+	    cacheSize > static_cast<off64_t>(KEYS_CACHE_MAX_SIZE))
+	{
+		// Incorrect cache file size.
+		file->unref();
+		return false;
+	}
+
+	// Use the memory-mapped file if possible.
+	// Otherwise, read the entire file into memory.
+	ao::uvector<uint8_t> buf;
+	const uint8_t *data = file->peek(0, static_cast<size_t>(cacheSize));
+	if (!data) {
+		buf.resize(static_cast<size_t>(cacheSize));
+		if (file->read(buf.data(), buf.size()) != buf.size()) {
+			// Read error.
+			file->unref();
+			return false;
+		}
+		data = buf.data();
+	}
+
+	// Check the header.
+	KeysCacheHeader header;
+	memcpy(&header, data, sizeof(header));
+	const uint32_t count = le32_to_cpu(header.count);
+	const uint32_t keys_len = le32_to_cpu(header.keys_len);
+	const uint32_t names_len = le32_to_cpu(header.names_len);
+	const size_t remainder_len = static_cast<size_t>(cacheSize) - sizeof(header);
+	if (memcmp(header.magic, KEYS_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+	    le64_to_cpu(header.conf_size) != static_cast<uint64_t>(fileSize) ||
+	    static_cast<int64_t>(le64_to_cpu(header.conf_mtime)) != static_cast<int64_t>(mtime) ||
+	    keys_len > KEYS_CACHE_MAX_SIZE || names_len > KEYS_CACHE_MAX_SIZE ||
+	    count > (KEYS_CACHE_MAX_SIZE / sizeof(KeysCacheEntry)) ||
+	    (static_cast<size_t>(count) * sizeof(KeysCacheEntry)) + keys_len + names_len != remainder_len ||
+	    rp_crc32(0, &data[sizeof(header)], remainder_len) != le32_to_cpu(header.crc32))
+	{
+		// Cache is invalid or out of date.
+		file->unref();
+		return false;
+	}
+
+	const uint8_t *const pEntries = &data[sizeof(header)];
+	const uint8_t *const pKeys = pEntries + (static_cast<size_t>(count) * sizeof(KeysCacheEntry));
+	const char *const pNames = reinterpret_cast<const char*>(pKeys + keys_len);
+
+	// Validate all entries before loading anything.
+	for (uint32_t i = 0; i < count; i++) {
+		KeysCacheEntry entry;
+		memcpy(&entry, &pEntries[i * sizeof(entry)], sizeof(entry));
+		const uint32_t name_offset = le32_to_cpu(entry.name_offset);
+		const uint32_t key_offset = le32_to_cpu(entry.key_offset);
+		const uint16_t name_len = le16_to_cpu(entry.name_len);
+		if (name_len == 0 || name_offset > names_len || name_len > names_len - name_offset ||
+		    key_offset > keys_len || entry.key_len > keys_len - key_offset)
+		{
+			// Invalid entry.
+			file->unref();
+			return false;
+		}
+	}
+
+	// Load the keys.
+	vKeys.resize(keys_len);
+	if (keys_len > 0) {
+		memcpy(vKeys.data(), pKeys, keys_len);
+	}
+#ifdef HAVE_UNORDERED_MAP_RESERVE
+	mapKeyNames.reserve(count);
+#endif
+	for (uint32_t i = 0; i < count; i++) {
+		KeysCacheEntry entry;
+		memcpy(&entry, &pEntries[i * sizeof(entry)], sizeof(entry));
+		const uint32_t keyIdx = le32_to_cpu(entry.key_offset) | (static_cast<uint32_t>(entry.key_len) << 24);
+		mapKeyNames.insert(std::make_pair(
+			string(&pNames[le32_to_cpu(entry.name_offset)], le16_to_cpu(entry.name_len)), keyIdx));
+	}
+
+	file->unref();
+	return true;
+}
+
+/**
+ * Save the keys to keys.cache.
+ * Called by ConfReader::load() after parsing keys.conf.
+ *
+ * @param fileSize	[in] keys.conf size.
+ * @param mtime		[in] keys.conf mtime.
+ */
+void KeyManagerPrivate::saveCache(off64_t fileSize, time_t mtime) const
+{
+	const string cache_filename = getCacheFilename();
+	if (cache_filename.empty()) {
+		return;
+	}
+
+	// Build the key names block.
+	const size_t count = mapKeyNames.size();
+	const size_t entries_len = count * sizeof(KeysCacheEntry);
+	string names;
+	ao::uvector<uint8_t> buf;
+	buf.resize(sizeof(KeysCacheHeader) + entries_len);
+	uint8_t *pEntry = &buf[sizeof(KeysCacheHeader)];
+	for (const auto &p : mapKeyNames) {
+		if (p.first.size() > 0xFFFFU) {
+			// Key name is too long.
+			return;
+		}
+
+		KeysCacheEntry entry;
+		entry.name_offset = cpu_to_le32(static_cast<uint32_t>(names.size()));
+		entry.key_offset = cpu_to_le32(p.second & 0xFFFFFFU);
+		entry.name_len = cpu_to_le16(static_cast<uint16_t>(p.first.size()));
+		entry.key_len = static_cast<uint8_t>(p.second >> 24);
+		entry.reserved = 0;
+		memcpy(pEntry, &entry, sizeof(entry));
+		pEntry += sizeof(entry);
+		names += p.first;
+	}
+
+	if (vKeys.size() > KEYS_CACHE_MAX_SIZE || names.size() > KEYS_CACHE_MAX_SIZE ||
+	    buf.size() + vKeys.size() + names.size() > KEYS_CACHE_MAX_SIZE)
+	{
+		// Too much data to cache.
+		return;
+	}
+
+	// Append the key data and key names.
+	buf.insert(buf.end(), vKeys.begin(), vKeys.end());
+	buf.insert(buf.end(), names.begin(), names.end());
+
+	// Header.
+	KeysCacheHeader header;
+	memcpy(header.magic, KEYS_CACHE_MAGIC, sizeof(header.magic));
+	header.conf_size = cpu_to_le64(static_cast<uint64_t>(fileSize));
+	header.conf_mtime = cpu_to_le64(static_cast<int64_t>(mtime));
+	header.count = cpu_to_le32(static_cast<uint32_t>(count));
+	header.keys_len = cpu_to_le32(static_cast<uint32_t>(vKeys.size()));
+	header.names_len = cpu_to_le32(static_cast<uint32_t>(names.size()));
+	header.crc32 = cpu_to_le32(rp_crc32(0, &buf[sizeof(header)], buf.size() - sizeof(header)));
+	memcpy(buf.data(), &header, sizeof(header));
+
+	// Write to a temporary file, then rename it over keys.cache.
+	// This ensures other processes never see a partially-written cache,
+	// and that existing memory mappings of the old cache remain valid.
+	char pid_buf[24];
+#ifdef _WIN32
+	snprintf(pid_buf, sizeof(pid_buf), ".%lu.tmp", static_cast<unsigned long>(GetCurrentProcessId()));
+#else /* !_WIN32 */
+	snprintf(pid_buf, sizeof(pid_buf), ".%ld.tmp", static_cast<long>(getpid()));
+#endif /* _WIN32 */
+	const string tmp_filename = cache_filename + pid_buf;
+
+	RpFile *const file = new RpFile(tmp_filename, RpFile::FM_CREATE_WRITE);
+	if (!file->isOpen()) {
+		file->unref();
+		return;
+	}
+#ifndef _WIN32
+	// The cache contains encryption keys, so it should
+	// only be readable by the current user.
+	chmod(tmp_filename.c_str(), S_IRUSR | S_IWUSR);
+#endif /* !_WIN32 */
+	const size_t size = file->write(buf.data(), buf.size());
+	file->unref();
+
+	bool ok = (size == buf.size());
+	if (ok) {
+#ifdef _WIN32
+		ok = !!MoveFileEx(U82T_s(tmp_filename), U82T_s(cache_filename), MOVEFILE_REPLACE_EXISTING);
+#else /* !_WIN32 */
+		ok = (rename(tmp_filename.c_str(), cache_filename.c_str()) == 0);
+#endif /* _WIN32 */
+	}
+	if (!ok) {
+		// Write or rename failed. Remove the temporary file.
+		LibRpFile::FileSystem::delete_file(tmp_filename);
+	}
+}
+#endif /* ENABLE_DECRYPTION */
+
 /** KeyManager **/
 
 KeyManager::KeyManager()
@@ -268,8 +587,11 @@ const char *KeyManager::verifyResultToString(VerifyResult res)
  */
 KeyManager *KeyManager::instance(void)
 {
+	// Initialize the singleton instance.
+	pthread_once(&KeyManagerPrivate::once_control, KeyManagerPrivate::initInstance);
+
 	// Return the singleton instance.
-	return &KeyManagerPrivate::instance;
+	return KeyManagerPrivate::pInstance;
 }
 
 /**
@@ -298,7 +620,9 @@ KeyManager::VerifyResult KeyManager::get(const char *keyName, KeyData_t *pKeyDat
 	}
 
 	// Attempt to get the key from the map.
+	// NOTE: The key data is only valid until keys.conf is reloaded.
 	RP_D(const KeyManager);
+	ReadLocker rdLocker(d->rwLock);
 	auto iter = d->mapKeyNames.find(keyName);
 	if (iter == d->mapKeyNames.end()) {
 		// Key was not parsed. Figure out why.
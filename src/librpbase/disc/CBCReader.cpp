@@ -20,6 +20,9 @@
 // librpfile
 #include "librpfile/IRpFile.hpp"
 
+// C++ includes.
+#include <memory>
+
 namespace LibRpBase {
 
 class CBCReaderPrivate
@@ -47,6 +50,31 @@ class CBCReaderPrivate
 		uint8_t key[16];
 		uint8_t iv[16];
 		LibRpBase::IAesCipher *cipher;
+		bool isCBC;
+
+		// IV carried over from the previous decryption.
+		// This is the last ciphertext block before next_iv_pos.
+		uint8_t next_iv[16];
+		off64_t next_iv_pos;	// -1 if not valid
+
+		// Decrypted data buffer.
+		// Sequential reads are decrypted BUFFER_SIZE bytes at a time.
+		static const size_t BUFFER_SIZE = 64U*1024U;
+		std::unique_ptr<uint8_t[]> buf;
+		off64_t buf_pos;	// Position of buf[0]. (multiple of 16)
+		size_t buf_len;		// Amount of valid data in buf.
+
+		// End of the previous read, used to detect sequential access.
+		off64_t last_read_end;
+
+		/**
+		 * Read and decrypt full blocks from the underlying file.
+		 * @param pos_block	[in] Starting position. (Must be a multiple of 16.)
+		 * @param ptr		[out] Output buffer.
+		 * @param size		[in] Amount of data to read. (Must be a multiple of 16.)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int decryptAt(off64_t pos_block, uint8_t *ptr, size_t size);
 #endif /* ENABLE_DECRYPTION */
 };
 
@@ -61,6 +89,11 @@ CBCReaderPrivate::CBCReaderPrivate(CBCReader *q,
 	, pos(0)
 #ifdef ENABLE_DECRYPTION
 	, cipher(nullptr)
+	, isCBC(iv != nullptr)
+	, next_iv_pos(-1)
+	, buf_pos(0)
+	, buf_len(0)
+	, last_read_end(-1)
 #endif
 {
 	assert(q->m_file != nullptr);
@@ -118,6 +151,86 @@ CBCReaderPrivate::~CBCReaderPrivate()
 #endif /* ENABLE_DECRYPTION */
 }
 
+#ifdef ENABLE_DECRYPTION
+/**
+ * Read and decrypt full blocks from the underlying file.
+ * @param pos_block	[in] Starting position. (Must be a multiple of 16.)
+ * @param ptr		[out] Output buffer.
+ * @param size		[in] Amount of data to read. (Must be a multiple of 16.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CBCReaderPrivate::decryptAt(off64_t pos_block, uint8_t *ptr, size_t size)
+{
+	assert(pos_block % 16 == 0);
+	assert(size % 16 == 0);
+	assert(size != 0);
+	RP_Q(CBCReader);
+
+	if (isCBC) {
+		// Get the IV.
+		// If this continues the previous decryption, the IV
+		// was already saved. Otherwise, it's either the
+		// specified IV or the previous ciphertext block.
+		uint8_t iv_tmp[16];
+		const uint8_t *pIV;
+		if (pos_block == 0) {
+			// Start of data.
+			pIV = this->iv;
+		} else if (pos_block == next_iv_pos) {
+			// Continuing from the previous decryption.
+			pIV = next_iv;
+		} else {
+			// Read the IV from the previous 16 bytes.
+			size_t sz_read = q->m_file->readAt(offset + pos_block - 16, iv_tmp, sizeof(iv_tmp));
+			if (sz_read != sizeof(iv_tmp)) {
+				// Read error.
+				q->m_lastError = q->m_file->lastError();
+				if (q->m_lastError == 0) {
+					q->m_lastError = EIO;
+				}
+				return -q->m_lastError;
+			}
+			pIV = iv_tmp;
+		}
+
+		if (cipher->setIV(pIV, 16) != 0) {
+			// setIV() failed.
+			q->m_lastError = EIO;
+			return -EIO;
+		}
+	}
+
+	size_t sz_read = q->m_file->readAt(offset + pos_block, ptr, size);
+	if (sz_read != size) {
+		// Short read.
+		// Cannot decrypt with a short read.
+		q->m_lastError = q->m_file->lastError();
+		if (q->m_lastError == 0) {
+			q->m_lastError = EIO;
+		}
+		return -q->m_lastError;
+	}
+
+	// Save the last ciphertext block. It's the IV
+	// for the next block if the next read continues here.
+	uint8_t last_block[16];
+	memcpy(last_block, &ptr[size - 16], sizeof(last_block));
+
+	// Decrypt the data.
+	size_t sz_dec = cipher->decrypt(ptr, size);
+	if (sz_dec != size) {
+		// decrypt() failed.
+		next_iv_pos = -1;
+		q->m_lastError = EIO;
+		return -EIO;
+	}
+
+	memcpy(next_iv, last_block, sizeof(next_iv));
+	next_iv_pos = pos_block + size;
+	return 0;
+}
+#endif /* ENABLE_DECRYPTION */
+
 /** CBCReader **/
 
 /**
@@ -185,7 +298,7 @@ size_t CBCReader::read(void *ptr, size_t size)
 #endif /* ENABLE_DECRYPTION */
 	{
 		// No encryption. Read directly from the file.
-		size_t sz_read = m_file->seekAndRead(d->offset + d->pos, ptr, size);
+		size_t sz_read = m_file->readAt(d->offset + d->pos, ptr, size);
 		if (sz_read != size) {
 			// Seek and/or read error.
 			m_lastError = m_file->lastError();
@@ -201,139 +314,74 @@ size_t CBCReader::read(void *ptr, size_t size)
 #ifdef ENABLE_DECRYPTION
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 
-	// TODO: Check for overflow.
-	if (d->pos + (off64_t)size > d->length) {
-		// Reduce size so it doesn't go out of bounds.
-		size = d->length - d->pos;
-	}
-
-	uint8_t iv[16];
-
-	// Read the first block.
-	// NOTE: If we're in the middle of a block, round it down.
-	const off64_t pos_block = d->pos & ~15LL;
-
 	// Total number of bytes read.
 	size_t total_sz_read = 0;
 
-	// Get the IV.
-	if (pos_block == 0) {
-		// Start of data.
-		// Use the specified IV.
-		memcpy(iv, d->iv, sizeof(iv));
-		m_file->seek(d->offset);
-	} else {
-		// Not start of data.
-		// Read the IV from the previous 16 bytes.
-		// TODO: Cache it!
-		m_file->seek(d->offset + pos_block - 16);
-		size_t sz_read = m_file->read(iv, sizeof(iv));
-		if (sz_read != sizeof(iv)) {
-			// Read error.
-			m_lastError = m_file->lastError();
-			if (m_lastError == 0) {
-				m_lastError = EIO;
-			}
-			return 0;
+	// If this read continues the previous one, assume
+	// sequential access and fill the entire buffer.
+	const bool isSequential = (d->pos == d->last_read_end);
+
+	// End of the data, rounded up to a full block.
+	// NOTE: d->length is const, so copy it first to
+	// prevent ALIGN_BYTES() from using a const cast.
+	off64_t length_block = d->length;
+	length_block = ALIGN_BYTES(16, length_block);
+
+	while (size > 0) {
+		if (d->pos >= d->buf_pos && d->pos < d->buf_pos + static_cast<off64_t>(d->buf_len)) {
+			// Copy data from the buffer.
+			const size_t buf_offset = static_cast<size_t>(d->pos - d->buf_pos);
+			const size_t sz = std::min(size, d->buf_len - buf_offset);
+			memcpy(ptr8, &d->buf[buf_offset], sz);
+			ptr8 += sz;
+			size -= sz;
+			total_sz_read += sz;
+			d->pos += sz;
+			continue;
 		}
-	}
 
-	// Set the IV.
-	int ret = d->cipher->setIV(iv, sizeof(iv));
-	if (ret != 0) {
-		// setIV() failed.
-		m_lastError = EIO;
-		return 0;
-	}
-
-	uint8_t block_tmp[16];
-	if (d->pos != pos_block) {
-		// We're in the middle of a block.
-		// Read and decrypt the full block, and copy out
-		// the necessary bytes.
-		const size_t sz = std::min(16U - (static_cast<size_t>(d->pos) & 15U), size);
-		size_t sz_read = m_file->read(block_tmp, sizeof(block_tmp));
-		if (sz_read != sizeof(block_tmp)) {
-			// Read error.
-			m_lastError = m_file->lastError();
-			if (m_lastError == 0) {
-				m_lastError = EIO;
+		const off64_t pos_block = d->pos & ~15LL;
+		if (d->pos == pos_block && size >= CBCReaderPrivate::BUFFER_SIZE) {
+			// Large aligned read. Decrypt full blocks directly
+			// into the output buffer. The rest will be read
+			// using the buffer.
+			const size_t full_block_sz = size & ~static_cast<size_t>(15);
+			if (d->decryptAt(pos_block, ptr8, full_block_sz) != 0) {
+				// Read error.
+				break;
 			}
-			return 0;
-		}
-
-		// Decrypt the data.
-		size_t sz_dec = d->cipher->decrypt(block_tmp, sizeof(block_tmp));
-		if (sz_dec != sizeof(block_tmp)) {
-			// decrypt() failed.
-			m_lastError = EIO;
-			return 0;
+			ptr8 += full_block_sz;
+			size -= full_block_sz;
+			total_sz_read += full_block_sz;
+			d->pos += full_block_sz;
+			continue;
 		}
 
-		memcpy(ptr8, &block_tmp[d->pos & 15], sz);
-		ptr8 += sz;
-		size -= sz;
-		total_sz_read += sz;
-		d->pos += sz;
-	}
-
-	// Read full blocks.
-	size_t full_block_sz = size & ~15LL;
-	if (full_block_sz > 0) {
-		size_t sz_read = m_file->read(ptr8, full_block_sz);
-		if (sz_read != full_block_sz) {
-			// Short read.
-			// Cannot decrypt with a short read.
-			m_lastError = m_file->lastError();
-			if (m_lastError == 0) {
-				m_lastError = EIO;
-			}
-			return 0;
+		// Fill the buffer.
+		// Sequential reads fill the entire buffer. Random reads
+		// only read the blocks that are needed.
+		if (!d->buf) {
+			d->buf.reset(new uint8_t[CBCReaderPrivate::BUFFER_SIZE]);
 		}
-
-		// Decrypt the data.
-		size_t sz_dec = d->cipher->decrypt(ptr8, full_block_sz);
-		if (sz_dec != full_block_sz) {
-			// decrypt() failed.
-			m_lastError = EIO;
-			return 0;
+		off64_t fill_sz = (isSequential
+			? static_cast<off64_t>(CBCReaderPrivate::BUFFER_SIZE)
+			: ALIGN_BYTES(16, d->pos + static_cast<off64_t>(size)) - pos_block);
+		fill_sz = std::min(fill_sz, length_block - pos_block);
+		if (fill_sz > static_cast<off64_t>(CBCReaderPrivate::BUFFER_SIZE)) {
+			fill_sz = CBCReaderPrivate::BUFFER_SIZE;
 		}
 
-		ptr8 += sz_read;
-		size -= sz_read;
-		total_sz_read += sz_read;
-		d->pos += sz_read;
-	}
-
-	if (size > 0) {
-		// We need to decrypt a partial block at the end.
-		// Read and decrypt the full block, and copy out
-		// the necessary bytes.
-		size_t sz_read = m_file->read(block_tmp, sizeof(block_tmp));
-		if (sz_read != sizeof(block_tmp)) {
+		d->buf_len = 0;
+		if (d->decryptAt(pos_block, d->buf.get(), static_cast<size_t>(fill_sz)) != 0) {
 			// Read error.
-			m_lastError = m_file->lastError();
-			if (m_lastError == 0) {
-				m_lastError = EIO;
-			}
-			return 0;
-		}
-
-		// Decrypt the data.
-		size_t sz_dec = d->cipher->decrypt(block_tmp, sizeof(block_tmp));
-		if (sz_dec != sizeof(block_tmp)) {
-			// decrypt() failed.
-			m_lastError = EIO;
-			return 0;
+			break;
 		}
-
-		memcpy(ptr8, block_tmp, size);
-		ptr8 += size;
-		total_sz_read += size;
-		d->pos += size;
-		size = 0;
+		d->buf_pos = pos_block;
+		d->buf_len = static_cast<size_t>(std::min(fill_sz, d->length - pos_block));
 	}
 
+	d->last_read_end = d->pos;
+
 	// Data read and decrypted successfully.
 	return total_sz_read;
 #else
@@ -365,7 +413,7 @@ int CBCReader::seek(off64_t pos)
 	} else if (pos >= d->length) {
 		d->pos = d->length;
 	} else {
-		d->pos = static_cast<uint32_t>(pos);
+		d->pos = pos;
 	}
 	return 0;
 }
@@ -12,6 +12,7 @@
 #include "DiscReader.hpp"
 
 // librpfile
+#include "librpfile/RpTrace.hpp"
 using LibRpFile::IRpFile;
 
 namespace LibRpBase {
@@ -26,6 +27,7 @@ DiscReader::DiscReader(IRpFile *file)
 	: super(file)
 	, m_offset(0)
 	, m_length(0)
+	, m_pos(0)
 {
 	if (!m_file) {
 		m_lastError = EBADF;
@@ -51,6 +53,7 @@ DiscReader::DiscReader(IRpFile *file, off64_t offset, off64_t length)
 	: super(file)
 	, m_offset(0)
 	, m_length(0)
+	, m_pos(0)
 {
 	if (!m_file) {
 		m_lastError = EBADF;
@@ -113,13 +116,41 @@ size_t DiscReader::read(void *ptr, size_t size)
 		return 0;
 	}
 
+	const size_t ret = readAt(m_pos, ptr, size);
+	m_pos += ret;
+	return ret;
+}
+
+/**
+ * Read data from the disc image at the specified position.
+ * The disc image position is not changed.
+ *
+ * This is thread-safe if the underlying file's
+ * readAt() is thread-safe.
+ *
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t DiscReader::readAt(off64_t pos, void *ptr, size_t size)
+{
+	RP_TRACE_SCOPE("DiscReader::readAt");
+	assert(m_file != nullptr);
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0 || pos >= m_length) {
+		// Out of range.
+		return 0;
+	}
+
 	// Constrain size based on offset and length.
-	off64_t pos = m_file->tell();
-	if (pos + static_cast<off64_t>(size) > m_offset + m_length) {
-		size = static_cast<size_t>(m_offset + m_length - pos);
+	if (static_cast<off64_t>(size) > m_length - pos) {
+		size = static_cast<size_t>(m_length - pos);
 	}
 
-	size_t ret = m_file->read(ptr, size);
+	size_t ret = m_file->readAt(m_offset + pos, ptr, size);
 	m_lastError = m_file->lastError();
 	return ret;
 }
@@ -135,13 +166,13 @@ int DiscReader::seek(off64_t pos)
 	if (!m_file) {
 		m_lastError = EBADF;
 		return -1;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return -1;
 	}
 
-	int ret = m_file->seek(pos + m_offset);
-	if (ret != 0) {
-		m_lastError = m_file->lastError();
-	}
-	return ret;
+	m_pos = pos;
+	return 0;
 }
 
 /**
@@ -156,11 +187,9 @@ off64_t DiscReader::tell(void)
 		return -1;
 	}
 
-	off64_t ret = m_file->tell();
-	if (ret < 0) {
-		m_lastError = m_file->lastError();
-	}
-	return ret;
+	// NOTE: This has always returned the position
+	// in the underlying file, including m_offset.
+	return m_offset + m_pos;
 }
 
 /**
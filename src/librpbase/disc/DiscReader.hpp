@@ -71,6 +71,21 @@ class DiscReader : public IDiscReader
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) override;
 
+		/**
+		 * Read data from the disc image at the specified position.
+		 * The disc image position is not changed.
+		 *
+		 * This is thread-safe if the underlying file's
+		 * readAt() is thread-safe.
+		 *
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) override;
+
 		/**
 		 * Set the disc image position.
 		 * @param pos Disc image position.
@@ -94,6 +109,10 @@ class DiscReader : public IDiscReader
 		// Offset/length. Useful for e.g. GameCube TGC.
 		off64_t m_offset;
 		off64_t m_length;
+
+		// Read position, relative to m_offset.
+		// The underlying file's position is not used.
+		off64_t m_pos;
 };
 
 }
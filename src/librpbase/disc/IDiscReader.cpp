@@ -59,6 +59,30 @@ bool IDiscReader::isOpen(void) const
 	}
 }
 
+/**
+ * Read data from the disc image at the specified position.
+ * The disc image position is not changed.
+ *
+ * The default implementation saves the position, seeks,
+ * reads, and restores the position, so it is NOT
+ * thread-safe. Subclasses that can read without changing
+ * the position should override it.
+ *
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t IDiscReader::readAt(off64_t pos, void *ptr, size_t size)
+{
+	const off64_t prev_pos = this->tell();
+	const size_t ret = this->seekAndRead(pos, ptr, size);
+	if (prev_pos >= 0) {
+		this->seek(prev_pos);
+	}
+	return ret;
+}
+
 /**
  * Seek to the specified address, then read data.
  * @param pos	[in] Requested seek address.
@@ -76,6 +100,23 @@ size_t IDiscReader::seekAndRead(off64_t pos, void *ptr, size_t size)
 	return this->read(ptr, size);
 }
 
+/**
+ * Get the natural block size of the disc image.
+ *
+ * Reads that start on a block boundary and cover whole
+ * blocks don't have to decrypt or decompress data that
+ * is thrown away. PartitionFile uses this to align its
+ * read-ahead buffer.
+ *
+ * The default implementation returns 0.
+ *
+ * @return Block size, in bytes, or 0 if there isn't a natural block size.
+ */
+unsigned int IDiscReader::blockSize(void) const
+{
+	return 0;
+}
+
 /** Device file functions **/
 
 /**
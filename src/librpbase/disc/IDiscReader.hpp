@@ -88,6 +88,23 @@ class IDiscReader : public RefBase
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		virtual size_t read(void *ptr, size_t size) = 0;
 
+		/**
+		 * Read data from the disc image at the specified position.
+		 * The disc image position is not changed.
+		 *
+		 * The default implementation saves the position, seeks,
+		 * reads, and restores the position, so it is NOT
+		 * thread-safe. Subclasses that can read without changing
+		 * the position should override it.
+		 *
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		virtual size_t readAt(off64_t pos, void *ptr, size_t size);
+
 		/**
 		 * Set the disc image position.
 		 * @param pos disc image position.
@@ -115,6 +132,20 @@ class IDiscReader : public RefBase
 		 */
 		virtual off64_t size(void) = 0;
 
+		/**
+		 * Get the natural block size of the disc image.
+		 *
+		 * Reads that start on a block boundary and cover whole
+		 * blocks don't have to decrypt or decompress data that
+		 * is thrown away. PartitionFile uses this to align its
+		 * read-ahead buffer.
+		 *
+		 * The default implementation returns 0.
+		 *
+		 * @return Block size, in bytes, or 0 if there isn't a natural block size.
+		 */
+		virtual unsigned int blockSize(void) const;
+
 	public:
 		/** Convenience functions implemented for all IRpFile classes. **/
 
@@ -15,6 +15,9 @@
 // C includes.
 #include <stdint.h>
 
+// C includes. (C++ namespace)
+#include <cerrno>
+
 // Directory type values.
 // Based on dirent.h from glibc-2.23.
 #include "d_type.h"
@@ -107,6 +110,22 @@ class IFst
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
 		virtual int find_file(const char *filename, DirEnt *dirent) = 0;
+
+	public:
+		/**
+		 * Build an index of all paths in the FST.
+		 *
+		 * By default, each path lookup walks the FST. With the index,
+		 * find_file() and opendir() use a single hash table lookup.
+		 * Subclasses that support it may also build the index
+		 * automatically once enough lookups have been done.
+		 *
+		 * @return 0 on success; negative POSIX error code on error. (-ENOTSUP if not supported)
+		 */
+		virtual int buildPathIndex(void)
+		{
+			return -ENOTSUP;
+		}
 };
 
 /**
@@ -59,6 +59,24 @@ class IPartition : public IDiscReader
 		 * @return Used partition size, or -1 on error.
 		 */
 		virtual off64_t partition_size_used(void) const = 0;
+
+	public:
+		/**
+		 * Get the approximate amount of memory used by
+		 * cached metadata, e.g. directory tables or the FST.
+		 * @return Approximate memory usage, in bytes.
+		 */
+		virtual size_t memoryUsage(void) const
+		{
+			return 0;
+		}
+
+		/**
+		 * Release cached metadata.
+		 * It will be reloaded on demand.
+		 */
+		virtual void releaseMemory(void)
+		{ }
 };
 
 /**
@@ -27,12 +27,28 @@ PartitionFile::PartitionFile(IDiscReader *partition, off64_t offset, off64_t siz
 	, m_offset(offset)
 	, m_size(size)
 	, m_pos(0)
+	, m_raStart(0)
+	, m_raNext(-1)
+	, m_raLen(0)
+	, m_raWindow(0)
+	, m_raMaxWindow(0)
+	, m_blockSize(0)
 {
 	if (partition) {
 		m_partition = partition->ref();
 	} else {
 		m_partition = nullptr;
 		m_lastError = EBADF;
+		return;
+	}
+
+	// Use a read-ahead buffer if the partition has a natural
+	// block size that isn't larger than the maximum window.
+	const unsigned int blockSize = partition->blockSize();
+	if (blockSize > 0 && blockSize <= READAHEAD_MAX_SIZE) {
+		m_blockSize = blockSize;
+		m_raMaxWindow = (READAHEAD_MAX_SIZE / blockSize) * blockSize;
+		m_raWindow = blockSize;
 	}
 
 	// TODO: Reference counting?
@@ -59,6 +75,8 @@ bool PartitionFile::isOpen(void) const
 void PartitionFile::close(void)
 {
 	UNREF_AND_NULL(m_partition);
+	m_raBuf.reset();
+	m_raLen = 0;
 }
 
 /**
@@ -86,17 +104,14 @@ size_t PartitionFile::read(void *ptr, size_t size)
 		}
 	}
 
-	m_partition->clearError();
-	int iRet = m_partition->seek(m_offset + m_pos);
-	if (iRet != 0) {
-		m_lastError = m_partition->lastError();
-		return 0;
-	}
-
 	size_t ret = 0;
 	if (size > 0) {
 		m_partition->clearError();
-		ret = m_partition->read(ptr, size);
+		if (m_blockSize != 0) {
+			ret = readWithReadAhead(m_offset + m_pos, static_cast<uint8_t*>(ptr), size);
+		} else {
+			ret = m_partition->readAt(m_offset + m_pos, ptr, size);
+		}
 		m_pos += ret;
 		m_lastError = m_partition->lastError();
 	}
@@ -104,6 +119,106 @@ size_t PartitionFile::read(void *ptr, size_t size)
 	return ret;
 }
 
+/**
+ * Read data from the partition using the read-ahead buffer.
+ * @param addr	[in] Partition address.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes. (Must be within the file!)
+ * @return Number of bytes read.
+ */
+size_t PartitionFile::readWithReadAhead(off64_t addr, uint8_t *ptr, size_t size)
+{
+	size_t ret = 0;
+
+	// Copy whatever's already in the buffer.
+	if (addr >= m_raStart && addr < m_raStart + m_raLen) {
+		const size_t sz = std::min(size, static_cast<size_t>(m_raStart + m_raLen - addr));
+		memcpy(ptr, &m_raBuf[static_cast<size_t>(addr - m_raStart)], sz);
+		addr += sz;
+		ptr += sz;
+		size -= sz;
+		ret = sz;
+		if (size == 0) {
+			m_raNext = addr;
+			return ret;
+		}
+	}
+
+	// Buffer miss. If this continues the previous read,
+	// double the read-ahead window. Otherwise, reset it.
+	if (addr == m_raNext) {
+		m_raWindow = std::min(m_raWindow * 2, m_raMaxWindow);
+	} else {
+		m_raWindow = m_blockSize;
+	}
+
+	if (size >= m_raWindow) {
+		// Large read. Read it directly.
+		const size_t sz = m_partition->readAt(addr, ptr, size);
+		m_raNext = addr + sz;
+		return ret + sz;
+	}
+
+	// Fill the buffer, starting at the block that contains addr.
+	// The buffer always includes the rest of this read, and it
+	// doesn't extend past the block containing the end of the file.
+	const off64_t raStart = addr - (addr % m_blockSize);
+	off64_t raEnd = std::max(raStart + m_raWindow, addr + static_cast<off64_t>(size));
+	raEnd = std::min(raEnd, m_offset + m_size);
+	if (raEnd % m_blockSize != 0) {
+		raEnd += m_blockSize - (raEnd % m_blockSize);
+	}
+
+	if (!m_raBuf) {
+		// The window may need one extra block if addr isn't aligned.
+		m_raBuf.reset(new uint8_t[m_raMaxWindow + m_blockSize]);
+	}
+	m_raStart = raStart;
+	m_raLen = static_cast<unsigned int>(m_partition->readAt(
+		raStart, m_raBuf.get(), static_cast<size_t>(raEnd - raStart)));
+
+	// Copy the requested data.
+	size_t sz = 0;
+	if (m_raStart + m_raLen > addr) {
+		sz = std::min(size, static_cast<size_t>(m_raStart + m_raLen - addr));
+		memcpy(ptr, &m_raBuf[static_cast<size_t>(addr - m_raStart)], sz);
+	}
+	m_raNext = addr + sz;
+	return ret + sz;
+}
+
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t PartitionFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	if (!m_partition) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	} else if (pos >= m_size) {
+		// Nothing left.
+		return 0;
+	}
+
+	// Check if size is in bounds.
+	if (static_cast<off64_t>(size) > m_size - pos) {
+		size = static_cast<size_t>(m_size - pos);
+	}
+
+	m_partition->clearError();
+	size_t ret = m_partition->readAt(m_offset + pos, ptr, size);
+	m_lastError = m_partition->lastError();
+	return ret;
+}
+
 /**
  * Write data to the file.
  * (NOTE: Not valid for PartitionFile; this will always return 0.)
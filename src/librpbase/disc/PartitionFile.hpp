@@ -11,10 +11,23 @@
 
 #include "librpfile/IRpFile.hpp"
 
+// C++ includes.
+#include <memory>
+
 namespace LibRpBase {
 
 class IDiscReader;
 
+/**
+ * IRpFile implementation for a file within an IPartition.
+ *
+ * If the partition has a natural block size, e.g. a Wii partition's
+ * 31 KiB sectors, sequential read() calls go through a read-ahead
+ * buffer aligned to that block size. The read-ahead window starts at
+ * one block and doubles each time a read continues where the previous
+ * one ended, up to READAHEAD_MAX_SIZE. Any other read resets it.
+ * readAt() always reads from the partition directly.
+ */
 class PartitionFile : public LibRpFile::IRpFile
 {
 	public:
@@ -55,6 +68,17 @@ class PartitionFile : public LibRpFile::IRpFile
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the file at the specified position.
+		 * The file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
 		/**
 		 * Write data to the file.
 		 * (NOTE: Not valid for PartitionFile; this will always return 0.)
@@ -93,11 +117,44 @@ class PartitionFile : public LibRpFile::IRpFile
 		 */
 		std::string filename(void) const final;
 
+		/**
+		 * Get the file's starting offset within the partition.
+		 * @return Starting offset.
+		 */
+		inline off64_t offset(void) const
+		{
+			return m_offset;
+		}
+
+	private:
+		/**
+		 * Read data from the partition using the read-ahead buffer.
+		 * @param addr	[in] Partition address.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes. (Must be within the file!)
+		 * @return Number of bytes read.
+		 */
+		size_t readWithReadAhead(off64_t addr, uint8_t *ptr, size_t size);
+
+	public:
+		// Maximum read-ahead window.
+		static const unsigned int READAHEAD_MAX_SIZE = 256U*1024U;
+
 	protected:
 		IDiscReader *m_partition;
 		off64_t m_offset;	// File starting offset.
 		off64_t m_size;		// File size.
 		off64_t m_pos;		// Current position.
+
+	private:
+		// Read-ahead buffer. (partition addresses)
+		std::unique_ptr<uint8_t[]> m_raBuf;
+		off64_t m_raStart;		// Partition address of m_raBuf[0].
+		off64_t m_raNext;		// Partition address after the last read() call.
+		unsigned int m_raLen;		// Valid data in m_raBuf.
+		unsigned int m_raWindow;	// Current read-ahead window, in bytes.
+		unsigned int m_raMaxWindow;	// Maximum read-ahead window, in bytes.
+		unsigned int m_blockSize;	// Partition block size. (0 == no read-ahead)
 };
 
 }
@@ -12,8 +12,12 @@
 #include "SparseDiscReader_p.hpp"
 
 // librpfile
+#include "librpfile/RpTrace.hpp"
 using LibRpFile::IRpFile;
 
+// librpthreads
+using LibRpThreads::MutexLocker;
+
 namespace LibRpBase {
 
 /** SparseDiscReaderPrivate **/
@@ -23,6 +27,9 @@ SparseDiscReaderPrivate::SparseDiscReaderPrivate(SparseDiscReader *q)
 	, disc_size(0)
 	, pos(-1)
 	, block_size(0)
+	, rawBlocks(true)
+	, blockCacheCount(BLOCK_CACHE_AUTO)
+	, blockCacheUseCounter(0)
 {
 	// NOTE: Can't check q->m_file here.
 
@@ -30,6 +37,251 @@ SparseDiscReaderPrivate::SparseDiscReaderPrivate(SparseDiscReader *q)
 	// set by the subclass.
 }
 
+/**
+ * Read the specified block using the block cache.
+ * Parameters are the same as SparseDiscReader::readBlock().
+ * @param blockIdx	[in] Block index.
+ * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
+ * @param ptr		[out] Output data buffer.
+ * @param size		[in] Amount of data to read, in bytes. (Must be <= the block size!)
+ * @param insert	[in] If true, add the block to the cache if it isn't cached.
+ * @return Number of bytes read, or -1 if the block index is invalid.
+ */
+int SparseDiscReaderPrivate::readBlockCached(uint32_t blockIdx, int pos, void *ptr, size_t size, bool insert)
+{
+	RP_Q(SparseDiscReader);
+	assert(pos >= 0 && pos < (int)block_size);
+	assert(size <= block_size);
+
+	if (unlikely(size == 0)) {
+		// Nothing to read.
+		return 0;
+	}
+
+	off64_t key = blockIdx;
+	if (rawBlocks) {
+		const off64_t physBlockAddr = q->getPhysBlockAddr(blockIdx);
+		if (physBlockAddr <= 0) {
+			// Empty block or out of range. Nothing to cache.
+			return q->readBlock(blockIdx, pos, ptr, size);
+		}
+		key = physBlockAddr;
+	}
+
+	unsigned int lru = 0;
+	{
+		MutexLocker mtxLocker(blockCacheMutex);
+		if (blockCacheCount == BLOCK_CACHE_AUTO) {
+			// Size the cache based on the block size.
+			// Raw blocks are only cached if they're small, since otherwise
+			// a small read would have to read the entire block. Other blocks
+			// must be decompressed in full anyway, so always cache two of them.
+			unsigned int count = BLOCK_CACHE_MAX_SIZE / block_size;
+			if (rawBlocks && block_size > BLOCK_CACHE_MAX_RAW_BLOCK_SIZE) {
+				count = 0;
+			} else if (count > 64) {
+				count = 64;
+			} else if (count < 2) {
+				count = 2;
+			}
+			blockCacheCount = count;
+			blockCache.reserve(count);
+		}
+
+		// Check if the block is cached.
+		// If it isn't, find the least recently used block.
+		for (unsigned int i = 0; i < static_cast<unsigned int>(blockCache.size()); i++) {
+			CachedBlock &blk = blockCache[i];
+			if (blk.key == key) {
+				// Block is cached.
+				if (static_cast<size_t>(pos) + size > blk.size) {
+					// Short block. (end of the disc)
+					// NOTE: With deduplication, a different logical
+					// block might be able to read more of it.
+					insert = false;
+					break;
+				}
+				blk.lastUse = ++blockCacheUseCounter;
+				memcpy(ptr, &blk.data[pos], size);
+				return static_cast<int>(size);
+			}
+			if (blk.lastUse < blockCache[lru].lastUse) {
+				lru = i;
+			}
+		}
+
+		if (blockCacheCount == 0) {
+			// Block cache is disabled.
+			insert = false;
+		}
+	}
+
+	if (!insert) {
+		return q->readBlock(blockIdx, pos, ptr, size);
+	}
+
+	// Read the entire block.
+	// NOTE: The last block may be short.
+	const off64_t blockPos = static_cast<off64_t>(blockIdx) * block_size;
+	if (blockPos >= disc_size) {
+		// Out of range.
+		return -1;
+	}
+	const uint32_t blockValid = static_cast<uint32_t>(
+		std::min(static_cast<off64_t>(block_size), disc_size - blockPos));
+	if (static_cast<size_t>(pos) + size > blockValid) {
+		// Short block. (end of the disc)
+		return q->readBlock(blockIdx, pos, ptr, size);
+	}
+	ao::uvector<uint8_t> data;
+	data.resize(blockValid);
+	const int rd = q->readBlock(blockIdx, 0, data.data(), blockValid);
+	if (rd != static_cast<int>(blockValid)) {
+		// Unable to read the entire block.
+		// Read only the requested data instead.
+		return q->readBlock(blockIdx, pos, ptr, size);
+	}
+	memcpy(ptr, &data[pos], size);
+
+	// Add the block to the cache.
+	MutexLocker mtxLocker(blockCacheMutex);
+	CachedBlock *pBlk;
+	if (blockCache.size() < blockCacheCount) {
+		blockCache.resize(blockCache.size() + 1);
+		pBlk = &blockCache.back();
+	} else {
+		// Replace the least recently used block.
+		// NOTE: Another thread may have replaced it in the meantime,
+		// but that only affects which block gets evicted.
+		pBlk = &blockCache[lru];
+	}
+	pBlk->key = key;
+	pBlk->lastUse = ++blockCacheUseCounter;
+	pBlk->size = blockValid;
+	pBlk->data.swap(data);
+	return static_cast<int>(size);
+}
+
+/**
+ * Read data that spans more than one raw block using a single batch read.
+ * - Blocks that are consecutive in the file are read using a single request.
+ * - Full blocks that refer to the same physical block (deduplication)
+ *   are only read once, and then copied.
+ * Afterwards, the OS is asked to prefetch the next run of
+ * consecutive physical blocks.
+ *
+ * This bypasses the block cache.
+ * pos and size must have already been validated by readAt().
+ *
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t SparseDiscReaderPrivate::readRawBlocks(off64_t pos, uint8_t *ptr, size_t size)
+{
+	RP_Q(SparseDiscReader);
+	assert(rawBlocks);
+	IRpFile *const file = q->m_file;
+
+	const unsigned int blockIdxStart = static_cast<unsigned int>(pos / block_size);
+	const unsigned int blockIdxEnd = static_cast<unsigned int>((pos + static_cast<off64_t>(size) - 1) / block_size) + 1;
+
+	std::vector<IRpFile::ReadRequest> reqs;
+	std::vector<size_t> reqOutPos;	// Output position of each request.
+	std::unordered_map<off64_t, size_t> physBlockMap;	// Physical address -> output position
+	std::vector<std::pair<size_t, size_t> > dupBlocks;	// (src, dest) output positions
+	reqs.reserve(blockIdxEnd - blockIdxStart);
+	reqOutPos.reserve(blockIdxEnd - blockIdxStart);
+
+	size_t sizeOk = size;
+	size_t outPos = 0;
+	off64_t nextPhysAddr = -1;
+	uint32_t blockOffset = static_cast<uint32_t>(pos % block_size);
+	for (unsigned int blockIdx = blockIdxStart; blockIdx < blockIdxEnd; blockIdx++) {
+		const size_t segSize = std::min(static_cast<size_t>(block_size - blockOffset), size - outPos);
+		const off64_t physBlockAddr = q->getPhysBlockAddr(blockIdx);
+		const auto iterDup = (segSize == block_size && physBlockAddr > 0)
+			? physBlockMap.find(physBlockAddr)
+			: physBlockMap.end();
+		if (physBlockAddr < 0) {
+			// Out of range.
+			sizeOk = outPos;
+			break;
+		} else if (physBlockAddr == 0) {
+			// Empty block.
+			memset(&ptr[outPos], 0, segSize);
+			nextPhysAddr = -1;
+		} else if (iterDup != physBlockMap.end()) {
+			// Physical block was already requested.
+			dupBlocks.emplace_back(iterDup->second, outPos);
+			nextPhysAddr = -1;
+		} else {
+			const off64_t physAddr = physBlockAddr + blockOffset;
+			if (segSize == block_size) {
+				physBlockMap.emplace(physBlockAddr, outPos);
+			}
+
+			if (physAddr == nextPhysAddr) {
+				// Consecutive physical block. Extend the previous request.
+				reqs.back().size += segSize;
+			} else {
+				IRpFile::ReadRequest req;
+				req.pos = physAddr;
+				req.ptr = &ptr[outPos];
+				req.size = segSize;
+				reqs.emplace_back(req);
+				reqOutPos.emplace_back(outPos);
+			}
+			nextPhysAddr = physAddr + segSize;
+		}
+
+		outPos += segSize;
+		blockOffset = 0;
+	}
+
+	const size_t reqsOk = file->readBatch(reqs.data(), reqs.size());
+	if (reqsOk != reqs.size()) {
+		// Error reading the data.
+		q->m_lastError = file->lastError();
+		if (reqOutPos[reqsOk] < sizeOk) {
+			sizeOk = reqOutPos[reqsOk];
+		}
+	}
+
+	// Copy the deduplicated blocks.
+	// NOTE: The source block is always before the destination block,
+	// so if the destination block is OK, the source block is, too.
+	for (const auto &dup : dupBlocks) {
+		if (dup.second >= sizeOk)
+			break;
+		memcpy(&ptr[dup.second], &ptr[dup.first], block_size);
+	}
+
+	if (sizeOk == size && blockIdxEnd < static_cast<unsigned int>((disc_size + block_size - 1) / block_size)) {
+		// Let the OS know that the next run of consecutive physical blocks
+		// will probably be needed, since this is likely a sequential read.
+		// The run is limited to the number of blocks that were just read.
+		// NOTE: Errors are ignored, since this is only a hint.
+		const off64_t physRunStart = q->getPhysBlockAddr(blockIdxEnd);
+		if (physRunStart > 0) {
+			const unsigned int maxRunBlocks = blockIdxEnd - blockIdxStart;
+			const unsigned int lastBlockIdx = static_cast<unsigned int>((disc_size - 1) / block_size);
+			unsigned int runBlocks = 1;
+			while (runBlocks < maxRunBlocks && blockIdxEnd + runBlocks <= lastBlockIdx &&
+			       q->getPhysBlockAddr(blockIdxEnd + runBlocks) ==
+			       physRunStart + static_cast<off64_t>(runBlocks) * block_size)
+			{
+				runBlocks++;
+			}
+			file->adviseAccess(IRpFile::AccessPattern::WillNeed,
+				physRunStart, static_cast<off64_t>(runBlocks) * block_size);
+		}
+	}
+
+	return sizeOk;
+}
+
 /** SparseDiscReader **/
 
 SparseDiscReader::SparseDiscReader(SparseDiscReaderPrivate *d, IRpFile *file)
@@ -63,24 +315,68 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 		return -1;
 	}
 
+	const size_t ret = readAt(d->pos, ptr, size);
+	d->pos += ret;
+	return ret;
+}
+
+/**
+ * Read data from the disc image at the specified position.
+ * The disc image position is not changed.
+ *
+ * This is thread-safe if the underlying file's readAt()
+ * and the subclass's readBlock() are thread-safe.
+ * (The block cache is protected by a mutex.)
+ *
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t SparseDiscReader::readAt(off64_t pos, void *ptr, size_t size)
+{
+	RP_TRACE_SCOPE("SparseDiscReader::readAt");
+	RP_D(SparseDiscReader);
+	assert(m_file != nullptr);
+	assert(d->disc_size > 0);
+	assert(d->block_size != 0);
+	if (!m_file || d->disc_size <= 0 || d->block_size == 0) {
+		// Disc image wasn't initialized properly.
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 	size_t ret = 0;
 
 	// Are we already at the end of the disc?
-	if (d->pos >= d->disc_size) {
+	if (pos >= d->disc_size) {
 		// End of the disc.
 		return 0;
 	}
 
-	// Make sure d->pos + size <= d->disc_size.
+	// Make sure pos + size <= d->disc_size.
 	// If it isn't, we'll do a short read.
-	if (d->pos + static_cast<off64_t>(size) >= d->disc_size) {
-		size = static_cast<size_t>(d->disc_size - d->pos);
+	if (pos + static_cast<off64_t>(size) >= d->disc_size) {
+		size = static_cast<size_t>(d->disc_size - pos);
 	}
 
-	// Check if we're not starting on a block boundary.
+	// Reads of raw blocks that span more than one block
+	// are done using a single batch read.
 	const uint32_t block_size = d->block_size;
-	const uint32_t blockStartOffset = d->pos % block_size;
+	if (d->rawBlocks && size > static_cast<size_t>(block_size - (pos % block_size))) {
+		return d->readRawBlocks(pos, ptr8, size);
+	}
+
+	// Full blocks are only added to the block cache for small reads.
+	// Large reads would evict everything else.
+	const bool insertFullBlocks = (size < SparseDiscReaderPrivate::BLOCK_CACHE_MAX_SIZE / 2);
+
+	// Check if we're not starting on a block boundary.
+	const uint32_t blockStartOffset = pos % block_size;
 	if (blockStartOffset != 0) {
 		// Not a block boundary.
 		// Read the end of the block.
@@ -89,8 +385,8 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 			read_sz = static_cast<uint32_t>(size);
 		}
 
-		const unsigned int blockIdx = static_cast<unsigned int>(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, blockStartOffset, ptr8, read_sz);
+		const unsigned int blockIdx = static_cast<unsigned int>(pos / block_size);
+		int rd = d->readBlockCached(blockIdx, blockStartOffset, ptr8, read_sz);
 		if (rd < 0 || rd != static_cast<int>(read_sz)) {
 			// Error reading the data.
 			return (rd > 0 ? rd : 0);
@@ -100,17 +396,47 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 		size -= read_sz;
 		ptr8 += read_sz;
 		ret += read_sz;
-		d->pos += read_sz;
+		pos += read_sz;
+	}
+
+	if (size >= block_size * 2) {
+		// If reading more than one block, let the OS know which
+		// physical blocks we need so it can start reading them now.
+		// NOTE: Errors are ignored, since this is only a hint.
+		const unsigned int blockIdxStart = static_cast<unsigned int>(pos / block_size);
+		const unsigned int blockIdxEnd = static_cast<unsigned int>((pos + size) / block_size);
+		for (unsigned int blockIdx = blockIdxStart; blockIdx < blockIdxEnd; blockIdx++) {
+			const off64_t physBlockAddr = getPhysBlockAddr(blockIdx);
+			if (physBlockAddr > 0) {
+				m_file->adviseAccess(IRpFile::AccessPattern::WillNeed, physBlockAddr, block_size);
+			}
+		}
 	}
 
 	// Read entire blocks.
+	if (!d->rawBlocks && !insertFullBlocks && size >= block_size * 2) {
+		// Large read. Let the subclass read all of the blocks at once.
+		const unsigned int blockIdxStart = static_cast<unsigned int>(pos / block_size);
+		const unsigned int blockCount = static_cast<unsigned int>(size / block_size);
+		const unsigned int blocksOk = readBlocks(blockIdxStart, blockCount, ptr8);
+
+		const size_t sz_blocks = static_cast<size_t>(blocksOk) * block_size;
+		ret += sz_blocks;
+		pos += sz_blocks;
+		if (blocksOk != blockCount) {
+			// Error reading the data.
+			return ret;
+		}
+		size -= sz_blocks;
+		ptr8 += sz_blocks;
+	}
 	for (; size >= block_size;
 	    size -= block_size, ptr8 += block_size,
-	    ret += block_size, d->pos += block_size)
+	    ret += block_size, pos += block_size)
 	{
-		assert(d->pos % block_size == 0);
-		const unsigned int blockIdx = static_cast<unsigned int>(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, 0, ptr8, block_size);
+		assert(pos % block_size == 0);
+		const unsigned int blockIdx = static_cast<unsigned int>(pos / block_size);
+		int rd = d->readBlockCached(blockIdx, 0, ptr8, block_size, insertFullBlocks);
 		if (rd < 0 || rd != static_cast<int>(block_size)) {
 			// Error reading the data.
 			return ret + (rd > 0 ? rd : 0);
@@ -120,18 +446,18 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 	// Check if we still have data left. (not a full block)
 	if (size > 0) {
 		// Not a full block.
-		assert(d->pos % block_size == 0);
+		assert(pos % block_size == 0);
 
 		// Read the start of the block.
-		const unsigned int blockIdx = static_cast<unsigned int>(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, 0, ptr8, size);
+		const unsigned int blockIdx = static_cast<unsigned int>(pos / block_size);
+		int rd = d->readBlockCached(blockIdx, 0, ptr8, size);
 		if (rd < 0 || rd != static_cast<int>(size)) {
 			// Error reading the data.
 			return ret + (rd > 0 ? rd : 0);
 		}
 
 		ret += size;
-		d->pos += size;
+		pos += size;
 	}
 
 	// Finished reading the data.
@@ -209,6 +535,21 @@ off64_t SparseDiscReader::size(void)
 	return d->disc_size;
 }
 
+/**
+ * Get the natural block size of the disc image.
+ *
+ * This is only set for formats that convert or decompress
+ * each block. Raw blocks can be partially read at no cost,
+ * so this returns 0 for them.
+ *
+ * @return Block size, in bytes, or 0 if there isn't a natural block size.
+ */
+unsigned int SparseDiscReader::blockSize(void) const
+{
+	RP_D(const SparseDiscReader);
+	return (d->rawBlocks ? 0 : d->block_size);
+}
+
 /** SparseDiscReader **/
 
 /**
@@ -258,9 +599,37 @@ int SparseDiscReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t si
 	}
 
 	// Read from the block.
-	size_t sz_read = m_file->seekAndRead(physBlockAddr + pos, ptr, size);
+	size_t sz_read = m_file->readAt(physBlockAddr + pos, ptr, size);
 	m_lastError = m_file->lastError();
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read multiple full blocks.
+ *
+ * This is used for large reads of non-raw blocks.
+ * The default implementation calls readBlock() for each block.
+ * Subclasses can override this if multiple blocks can be
+ * read and/or decompressed more efficiently at once.
+ *
+ * @param blockIdxStart	[in] First block index.
+ * @param blockCount	[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+ * @return Number of blocks read. (If less than blockCount, an error occurred.)
+ */
+unsigned int SparseDiscReader::readBlocks(uint32_t blockIdxStart, unsigned int blockCount, void *ptr)
+{
+	RP_D(const SparseDiscReader);
+	const uint32_t block_size = d->block_size;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	for (unsigned int i = 0; i < blockCount; i++, ptr8 += block_size) {
+		int rd = this->readBlock(blockIdxStart + i, 0, ptr8, block_size);
+		if (rd < 0 || rd != static_cast<int>(block_size)) {
+			// Error reading the data.
+			return i;
+		}
+	}
+	return blockCount;
+}
+
 }
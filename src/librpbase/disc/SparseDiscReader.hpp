@@ -41,6 +41,22 @@ class SparseDiscReader : public IDiscReader
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the disc image at the specified position.
+		 * The disc image position is not changed.
+		 *
+		 * This is thread-safe if the underlying file's readAt()
+		 * and the subclass's readBlock() are thread-safe.
+		 * (The block cache is protected by a mutex.)
+		 *
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
 		/**
 		 * Set the disc image position.
 		 * @param pos disc image position.
@@ -60,6 +76,17 @@ class SparseDiscReader : public IDiscReader
 		 */
 		off64_t size(void) final;
 
+		/**
+		 * Get the natural block size of the disc image.
+		 *
+		 * This is only set for formats that convert or decompress
+		 * each block. Raw blocks can be partially read at no cost,
+		 * so this returns 0 for them.
+		 *
+		 * @return Block size, in bytes, or 0 if there isn't a natural block size.
+		 */
+		unsigned int blockSize(void) const final;
+
 	protected:
 		/** Virtual functions for SparseDiscReader subclasses. **/
 
@@ -94,6 +121,21 @@ class SparseDiscReader : public IDiscReader
 		 */
 		ATTR_ACCESS_SIZE(write_only, 4, 5)
 		virtual int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size);
+
+		/**
+		 * Read multiple full blocks.
+		 *
+		 * This is used for large reads of non-raw blocks.
+		 * The default implementation calls readBlock() for each block.
+		 * Subclasses can override this if multiple blocks can be
+		 * read and/or decompressed more efficiently at once.
+		 *
+		 * @param blockIdxStart	[in] First block index.
+		 * @param blockCount	[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least blockCount * block_size bytes!)
+		 * @return Number of blocks read. (If less than blockCount, an error occurred.)
+		 */
+		virtual unsigned int readBlocks(uint32_t blockIdxStart, unsigned int blockCount, void *ptr);
 };
 
 }
@@ -13,6 +13,11 @@
 
 #include <stdint.h>
 #include "common.h"
+#include "uvector.h"
+#include "librpthreads/Mutex.hpp"
+
+// C++ includes.
+#include <vector>
 
 namespace LibRpBase {
 
@@ -34,6 +39,66 @@ class SparseDiscReaderPrivate
 		off64_t disc_size;		// Virtual disc image size.
 		off64_t pos;			// Read position.
 		unsigned int block_size;	// Block size.
+
+		// If true, blocks are stored as-is at the addresses
+		// returned by getPhysBlockAddr(), so multiple blocks
+		// can be read using IRpFile::readBatch().
+		// Subclasses that override readBlock() must set this
+		// to false.
+		bool rawBlocks;
+
+		// Block cache. (LRU)
+		// Blocks returned by readBlock() are kept here, so reading
+		// the same block again doesn't call into the subclass.
+		// Raw blocks are keyed by physical address, since multiple
+		// logical blocks may refer to the same physical block.
+		// Subclasses may set blockCacheCount in their constructor:
+		// - BLOCK_CACHE_AUTO: Size the cache based on block_size. (default)
+		// - 0: Disable the cache.
+		static const unsigned int BLOCK_CACHE_AUTO = ~0U;
+		static const unsigned int BLOCK_CACHE_MAX_SIZE = 1024U*1024U;
+		static const unsigned int BLOCK_CACHE_MAX_RAW_BLOCK_SIZE = 64U*1024U;
+		unsigned int blockCacheCount;
+
+		struct CachedBlock {
+			off64_t key;		// Block index, or physical address if rawBlocks.
+			uint32_t lastUse;	// Last use. (for LRU replacement)
+			uint32_t size;		// Valid data size. (may be short at the end of the disc)
+			ao::uvector<uint8_t> data;
+		};
+		std::vector<CachedBlock> blockCache;
+		uint32_t blockCacheUseCounter;
+		LibRpThreads::Mutex blockCacheMutex;
+
+		/**
+		 * Read the specified block using the block cache.
+		 * Parameters are the same as SparseDiscReader::readBlock().
+		 * @param blockIdx	[in] Block index.
+		 * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
+		 * @param ptr		[out] Output data buffer.
+		 * @param size		[in] Amount of data to read, in bytes. (Must be <= the block size!)
+		 * @param insert	[in] If true, add the block to the cache if it isn't cached.
+		 * @return Number of bytes read, or -1 if the block index is invalid.
+		 */
+		int readBlockCached(uint32_t blockIdx, int pos, void *ptr, size_t size, bool insert = true);
+
+		/**
+		 * Read data that spans more than one raw block using a single batch read.
+		 * - Blocks that are consecutive in the file are read using a single request.
+		 * - Full blocks that refer to the same physical block (deduplication)
+		 *   are only read once, and then copied.
+		 * Afterwards, the OS is asked to prefetch the next run of
+		 * consecutive physical blocks.
+		 *
+		 * This bypasses the block cache.
+		 * pos and size must have already been validated by readAt().
+		 *
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t readRawBlocks(off64_t pos, uint8_t *ptr, size_t size);
 };
 
 }
@@ -0,0 +1,195 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * IconAnimData.cpp: Icon animation data.                                  *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "IconAnimData.hpp"
+
+// librptexture
+using LibRpTexture::rp_image;
+
+// librpthreads
+using LibRpThreads::MutexLocker;
+
+namespace LibRpBase {
+
+/**
+ * Set the frame decoder.
+ *
+ * Frames that are nullptr in the frames array will be
+ * decoded by the frame decoder when frame() is called.
+ * The count field must be set before calling this function.
+ *
+ * @param decoder Frame decoder. (IconAnimData takes ownership)
+ */
+void IconAnimData::setFrameDecoder(FrameDecoder *decoder)
+{
+	assert(count >= 0);
+	assert(count <= (int)frames.size());
+
+	MutexLocker mtxLocker(frameMutex);
+	delete frameDecoder;
+	frameDecoder = nullptr;
+	framesPending = 0;
+	if (!decoder)
+		return;
+
+	for (int i = 0; i < count; i++) {
+		if (!frames[i]) {
+			framesPending |= (1ULL << i);
+		}
+	}
+	if (framesPending != 0) {
+		frameDecoder = decoder;
+	} else {
+		// All frames are already decoded.
+		delete decoder;
+	}
+}
+
+/**
+ * Get a frame, decoding it if necessary.
+ * @param idx Frame index.
+ * @return Frame, or nullptr if the frame is empty or invalid.
+ */
+const rp_image *IconAnimData::frame(int idx) const
+{
+	assert(idx >= 0);
+	assert(idx < (int)frames.size());
+	if (idx < 0 || idx >= (int)frames.size()) {
+		// Invalid frame index.
+		return nullptr;
+	}
+
+	MutexLocker mtxLocker(frameMutex);
+	if (framesPending & (1ULL << idx)) {
+		// Decode the frame.
+		assert(frameDecoder != nullptr);
+		const_cast<IconAnimData*>(this)->frames[idx] = frameDecoder->decodeFrame(idx);
+		framesPending &= ~(1ULL << idx);
+		if (framesPending == 0) {
+			// All frames have been decoded.
+			delete frameDecoder;
+			frameDecoder = nullptr;
+		}
+	}
+	return frames[idx];
+}
+
+/**
+ * Get the frame atlas.
+ *
+ * All frames are packed horizontally into a single ARGB32 image,
+ * in frame order. Each frame occupies a cell of atlasFrameWidth()
+ * by atlas()->height() pixels. nullptr frames are left transparent.
+ *
+ * The atlas is created on first use and cached here, so every view
+ * of the same IconAnimData only has to convert a single image.
+ *
+ * NOTE: The frames must not be modified after calling this function.
+ * NOTE 2: Not thread-safe. Only call this from the UI thread.
+ *
+ * @return Frame atlas, or nullptr if there are no valid frames.
+ */
+const rp_image *IconAnimData::atlas(void) const
+{
+	if (atlas_img) {
+		// Atlas was already created.
+		return atlas_img;
+	}
+
+	assert(count > 0);
+	assert(count <= (int)frames.size());
+	if (count <= 0 || count > (int)frames.size()) {
+		// Invalid frame count.
+		return nullptr;
+	}
+
+	// Determine the cell size.
+	// Frames are usually the same size, but use the
+	// largest frame just in case.
+	int cell_w = 0, cell_h = 0;
+	const rp_image *first_frame = nullptr;
+	for (int i = 0; i < count; i++) {
+		const rp_image *const frame = this->frame(i);
+		if (!frame || !frame->isValid())
+			continue;
+
+		if (!first_frame) {
+			first_frame = frame;
+		}
+		cell_w = std::max(cell_w, frame->width());
+		cell_h = std::max(cell_h, frame->height());
+	}
+	if (!first_frame) {
+		// No valid frames.
+		return nullptr;
+	}
+
+	rp_image *const img = new rp_image(cell_w * count, cell_h, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Clear the image first, since frames may be missing
+	// or smaller than the cell size.
+	memset(img->bits(), 0, img->data_len());
+
+	for (int i = 0; i < count; i++) {
+		const rp_image *const frame = frames[i];	// decoded above
+		if (!frame || !frame->isValid())
+			continue;
+
+		// Convert the frame to ARGB32 if necessary.
+		rp_image *frame_argb = nullptr;
+		const rp_image *src = frame;
+		if (frame->format() != rp_image::Format::ARGB32) {
+			frame_argb = frame->dup_ARGB32();
+			if (!frame_argb) {
+				// Unable to convert the frame.
+				continue;
+			}
+			src = frame_argb;
+		}
+
+		const size_t row_bytes = src->width() * sizeof(uint32_t);
+		const int height = src->height();
+		for (int y = 0; y < height; y++) {
+			uint32_t *const dest = static_cast<uint32_t*>(img->scanLine(y)) + (i * cell_w);
+			memcpy(dest, src->scanLine(y), row_bytes);
+		}
+
+		UNREF(frame_argb);
+	}
+
+	// Use the first frame's sBIT, if set.
+	rp_image::sBIT_t sBIT;
+	if (first_frame->get_sBIT(&sBIT) == 0) {
+		img->set_sBIT(&sBIT);
+	}
+
+	atlas_img = img;
+	return atlas_img;
+}
+
+/**
+ * Get the width of a single frame in the atlas.
+ * @return Frame width, or 0 if there are no valid frames.
+ */
+int IconAnimData::atlasFrameWidth(void) const
+{
+	const rp_image *const img = atlas();
+	if (!img) {
+		// No valid frames.
+		return 0;
+	}
+	return img->width() / count;
+}
+
+}
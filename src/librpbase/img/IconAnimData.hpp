@@ -26,6 +26,9 @@
 // librptexture
 #include "librptexture/img/rp_image.hpp"
 
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+
 namespace LibRpBase {
 
 struct IconAnimData : public RefBase
@@ -61,11 +64,39 @@ struct IconAnimData : public RefBase
 	// the previous frame should be used.
 	// NOTE 2: Frames stored here must be ref()'d.
 	// They will be automatically unref()'d in the destructor.
+	// NOTE 3: If a frame decoder is set, frames may not have
+	// been decoded yet. Use frame() to access them.
 	std::array<LibRpTexture::rp_image*, MAX_FRAMES> frames;
 
+	/**
+	 * Frame decoder for lazily-decoded frames.
+	 *
+	 * The decoder must keep its own copy of the raw frame data,
+	 * since the IconAnimData may outlive the RomData object.
+	 */
+	class FrameDecoder
+	{
+		public:
+			FrameDecoder() { }
+			virtual ~FrameDecoder() { }
+		private:
+			RP_DISABLE_COPY(FrameDecoder)
+
+		public:
+			/**
+			 * Decode a frame.
+			 * @param idx Frame index.
+			 * @return Decoded frame, or nullptr if the frame is empty or invalid.
+			 */
+			virtual LibRpTexture::rp_image *decodeFrame(int idx) = 0;
+	};
+
 	IconAnimData()
 		: count(0)
 		, seq_count(0)
+		, frameDecoder(nullptr)
+		, framesPending(0)
+		, atlas_img(nullptr)
 	{
 		seq_index.fill(0);
 		frames.fill(0);
@@ -84,11 +115,66 @@ protected:
 				UNREF(img);
 			}
 		);
+		UNREF(atlas_img);
+		delete frameDecoder;
 	}
 
 private:
 	RP_DISABLE_COPY(IconAnimData);
 
+	// Frame decoder. (deleted once all frames are decoded)
+	mutable FrameDecoder *frameDecoder;
+	// Frames that haven't been decoded yet. (bitfield)
+	mutable uint64_t framesPending;
+	// Protects frameDecoder, framesPending, and lazily-decoded frames.
+	mutable LibRpThreads::Mutex frameMutex;
+
+	// Frame atlas. (created on demand)
+	mutable LibRpTexture::rp_image *atlas_img;
+
+public:
+	/**
+	 * Set the frame decoder.
+	 *
+	 * Frames that are nullptr in the frames array will be
+	 * decoded by the frame decoder when frame() is called.
+	 * The count field must be set before calling this function.
+	 *
+	 * @param decoder Frame decoder. (IconAnimData takes ownership)
+	 */
+	void setFrameDecoder(FrameDecoder *decoder);
+
+	/**
+	 * Get a frame, decoding it if necessary.
+	 * @param idx Frame index.
+	 * @return Frame, or nullptr if the frame is empty or invalid.
+	 */
+	const LibRpTexture::rp_image *frame(int idx) const;
+
+public:
+	/**
+	 * Get the frame atlas.
+	 *
+	 * All frames are packed horizontally into a single ARGB32 image,
+	 * in frame order. Each frame occupies a cell of atlasFrameWidth()
+	 * by atlas()->height() pixels. nullptr frames are left transparent.
+	 *
+	 * The atlas is created on first use and cached here, so every view
+	 * of the same IconAnimData only has to convert a single image.
+	 *
+	 * NOTE: The frames must not be modified after calling this function.
+	 * NOTE 2: Not thread-safe. Only call this from the UI thread.
+	 *
+	 * @return Frame atlas, or nullptr if there are no valid frames.
+	 */
+	const LibRpTexture::rp_image *atlas(void) const;
+
+	/**
+	 * Get the width of a single frame in the atlas.
+	 * @return Frame width, or 0 if there are no valid frames.
+	 */
+	int atlasFrameWidth(void) const;
+
 public:
 	inline IconAnimData *ref(void)
 	{
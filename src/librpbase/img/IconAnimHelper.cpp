@@ -68,9 +68,8 @@ int IconAnimHelper::nextFrame(int *pDelay)
 	}
 
 	// Check if this frame is valid.
-	if (m_iconAnimData->frames[m_frame] != nullptr &&
-	    m_iconAnimData->frames[m_frame]->isValid())
-	{
+	const LibRpTexture::rp_image *const frame = m_iconAnimData->frame(m_frame);
+	if (frame != nullptr && frame->isValid()) {
 		// Frame is valid.
 		m_last_valid_frame = m_frame;
 	}
@@ -40,6 +40,27 @@ class RpImageLoaderPrivate
 		static const uint8_t jpeg_magic_1[4];
 		static const uint8_t jpeg_magic_2[4];
 #endif /* HAVE_JPEG */
+
+	public:
+		/**
+		 * Get a PNG image's dimensions and format without decoding it.
+		 * @param file	[in] IRpFile to probe.
+		 * @param buf	[in] First part of the file.
+		 * @param sz	[in] Size of buf.
+		 * @param pInfo	[out] Image information.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int probe_PNG(IRpFile *file, const uint8_t *buf, size_t sz, RpImageLoader::ImageInfo *pInfo);
+
+#ifdef HAVE_JPEG
+		/**
+		 * Get a JPEG image's dimensions and format without decoding it.
+		 * @param file	[in] IRpFile to probe.
+		 * @param pInfo	[out] Image information.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int probe_JPEG(IRpFile *file, RpImageLoader::ImageInfo *pInfo);
+#endif /* HAVE_JPEG */
 };
 
 /** RpImageLoaderPrivate **/
@@ -54,14 +75,207 @@ const uint8_t RpImageLoaderPrivate::jpeg_magic_2[4] =
 	{'J','F','I','F'};
 #endif /* HAVE_JPEG */
 
+/**
+ * Get a PNG image's dimensions and format without decoding it.
+ * @param file	[in] IRpFile to probe.
+ * @param buf	[in] First part of the file.
+ * @param sz	[in] Size of buf.
+ * @param pInfo	[out] Image information.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpImageLoaderPrivate::probe_PNG(IRpFile *file, const uint8_t *buf, size_t sz, RpImageLoader::ImageInfo *pInfo)
+{
+	// IHDR must be the first chunk.
+	// Layout: length (BE32), "IHDR", width (BE32), height (BE32),
+	// bit depth, color type, compression, filter, interlace, CRC32
+	static const size_t IHDR_ADDR = sizeof(png_magic);
+	static const size_t IHDR_FULL_SIZE = 4+4+13+4;
+	if (sz < IHDR_ADDR + IHDR_FULL_SIZE) {
+		// File is too small.
+		return -EIO;
+	}
+
+	const uint8_t *const ihdr = &buf[IHDR_ADDR];
+	uint32_t u32;
+	memcpy(&u32, &ihdr[0], sizeof(u32));
+	if (be32_to_cpu(u32) != 13 || memcmp(&ihdr[4], "IHDR", 4) != 0) {
+		// Not a valid IHDR chunk.
+		return -EIO;
+	}
+
+	memcpy(&u32, &ihdr[8], sizeof(u32));
+	const uint32_t width = be32_to_cpu(u32);
+	memcpy(&u32, &ihdr[12], sizeof(u32));
+	const uint32_t height = be32_to_cpu(u32);
+	if (width == 0 || height == 0 || width > INT32_MAX || height > INT32_MAX) {
+		// Invalid image size.
+		return -EIO;
+	}
+
+	uint8_t channels;
+	const uint8_t color_type = ihdr[17];
+	switch (color_type) {
+		case 0:	// Grayscale
+		case 3:	// Palette
+			channels = 1;
+			break;
+		case 2:	// RGB
+			channels = 3;
+			break;
+		case 4:	// Grayscale + Alpha
+			channels = 2;
+			break;
+		case 6:	// RGB + Alpha
+			channels = 4;
+			break;
+		default:
+			// Invalid color type.
+			return -EIO;
+	}
+
+	pInfo->width = static_cast<int>(width);
+	pInfo->height = static_cast<int>(height);
+	pInfo->fileType = RpImageLoader::FileType::PNG;
+	pInfo->bitDepth = ihdr[16];
+	pInfo->channels = channels;
+	pInfo->isPaletted = (color_type == 3);
+	pInfo->palette_len = 0;
+	if (!pInfo->isPaletted) {
+		// Not paletted. We're done here.
+		return 0;
+	}
+
+	// Find the PLTE chunk. It must be located before IDAT.
+	// NOTE: Only the chunk headers are read.
+	off64_t pos = static_cast<off64_t>(IHDR_ADDR + IHDR_FULL_SIZE);
+	for (unsigned int i = 0; i < 64; i++) {
+		uint8_t chunk_hdr[8];
+		size_t size = file->seekAndRead(pos, chunk_hdr, sizeof(chunk_hdr));
+		if (size != sizeof(chunk_hdr)) {
+			// Seek and/or read error.
+			break;
+		}
+
+		memcpy(&u32, &chunk_hdr[0], sizeof(u32));
+		const uint32_t chunk_len = be32_to_cpu(u32);
+		if (!memcmp(&chunk_hdr[4], "PLTE", 4)) {
+			// Found the palette.
+			if (chunk_len % 3 != 0 || chunk_len > 256*3) {
+				// Invalid palette size.
+				return -EIO;
+			}
+			pInfo->palette_len = static_cast<uint16_t>(chunk_len / 3);
+			return 0;
+		} else if (!memcmp(&chunk_hdr[4], "IDAT", 4) ||
+			   !memcmp(&chunk_hdr[4], "IEND", 4))
+		{
+			// PLTE wasn't found before the image data.
+			break;
+		}
+
+		// Next chunk. (length, name, data, CRC32)
+		pos += 4 + 4 + static_cast<off64_t>(chunk_len) + 4;
+	}
+
+	// PLTE chunk is missing.
+	return -EIO;
+}
+
+#ifdef HAVE_JPEG
+/**
+ * Get a JPEG image's dimensions and format without decoding it.
+ * @param file	[in] IRpFile to probe.
+ * @param pInfo	[out] Image information.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpImageLoaderPrivate::probe_JPEG(IRpFile *file, RpImageLoader::ImageInfo *pInfo)
+{
+	// Find the SOF marker. It must be located before SOS.
+	// NOTE: Only the marker headers are read.
+	off64_t pos = 2;	// skip SOI
+	for (;;) {
+		uint8_t mkr[4];
+		size_t size = file->seekAndRead(pos, mkr, sizeof(mkr));
+		if (size != sizeof(mkr) || mkr[0] != 0xFF) {
+			// Seek and/or read error, or not a marker.
+			break;
+		}
+
+		const uint8_t marker = mkr[1];
+		if (marker == 0xFF) {
+			// Fill byte.
+			pos++;
+			continue;
+		} else if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+			// Standalone marker. (TEM, RSTn)
+			pos += 2;
+			continue;
+		} else if (marker == 0xD9 || marker == 0xDA) {
+			// EOI or SOS: SOF wasn't found before the image data.
+			break;
+		}
+
+		// Segment length includes the length field.
+		const unsigned int seg_len = (mkr[2] << 8) | mkr[3];
+		if (seg_len < 2) {
+			// Invalid segment length.
+			break;
+		}
+
+		if (marker >= 0xC0 && marker <= 0xCF &&
+		    marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+		{
+			// SOFn: precision, height (BE16), width (BE16), components
+			uint8_t sof[6];
+			size = file->seekAndRead(pos + 4, sof, sizeof(sof));
+			if (size != sizeof(sof) || seg_len < 2 + sizeof(sof)) {
+				// Seek and/or read error.
+				break;
+			}
+
+			const int height = (sof[1] << 8) | sof[2];
+			const int width = (sof[3] << 8) | sof[4];
+			if (width == 0 || height == 0 || sof[5] == 0) {
+				// Invalid image size or number of components.
+				// NOTE: A height of 0 indicates that the height is
+				// specified by a DNL marker, which isn't supported.
+				break;
+			}
+
+			pInfo->width = width;
+			pInfo->height = height;
+			pInfo->fileType = RpImageLoader::FileType::JPEG;
+			pInfo->bitDepth = sof[0];
+			pInfo->channels = sof[5];
+			pInfo->isPaletted = false;
+			pInfo->palette_len = 0;
+			return 0;
+		}
+
+		// Next marker.
+		pos += 2 + seg_len;
+	}
+
+	// SOF marker is missing.
+	return -EIO;
+}
+#endif /* HAVE_JPEG */
+
 /** RpImageLoader **/
 
 /**
  * Load an image from an IRpFile.
- * @param file IRpFile to load from.
+ *
+ * If req_size is specified, JPEG images may be decoded at a reduced
+ * scale, as long as the larger dimension is at least req_size.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param req_size	[in,opt] Requested image size. (0 for full size)
+ * @param pFullWidth	[out,opt] Full image width.
+ * @param pFullHeight	[out,opt] Full image height.
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpImageLoader::load(IRpFile *file)
+rp_image *RpImageLoader::load(IRpFile *file, int req_size, int *pFullWidth, int *pFullHeight)
 {
 	file->rewind();
 
@@ -74,7 +288,16 @@ rp_image *RpImageLoader::load(IRpFile *file)
 		     sizeof(RpImageLoaderPrivate::png_magic)))
 		{
 			// Found a PNG image.
-			return RpPng::load(file);
+			rp_image *const img = RpPng::load(file);
+			if (img) {
+				if (pFullWidth) {
+					*pFullWidth = img->width();
+				}
+				if (pFullHeight) {
+					*pFullHeight = img->height();
+				}
+			}
+			return img;
 		}
 #ifdef HAVE_JPEG
 		else if (!memcmp(buf, RpImageLoaderPrivate::jpeg_magic_1,
@@ -83,7 +306,7 @@ rp_image *RpImageLoader::load(IRpFile *file)
 			  sizeof(RpImageLoaderPrivate::jpeg_magic_2)))
 		{
 			// Found a JPEG image.
-			return RpJpeg::load(file);
+			return RpJpeg::load(file, req_size, pFullWidth, pFullHeight);
 		}
 #endif /* HAVE_JPEG */
 	}
@@ -92,4 +315,47 @@ rp_image *RpImageLoader::load(IRpFile *file)
 	return nullptr;
 }
 
+/**
+ * Get an image's dimensions and format without decoding it.
+ * Only the PNG IHDR (and PLTE) chunks or the JPEG SOF marker are read.
+ * @param file	[in] IRpFile to probe.
+ * @param pInfo	[out] Image information.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpImageLoader::probe(IRpFile *file, ImageInfo *pInfo)
+{
+	assert(file != nullptr);
+	assert(pInfo != nullptr);
+	if (!file || !pInfo) {
+		return -EINVAL;
+	}
+
+	// Check the file header to see what kind of image this is.
+	uint8_t buf[64];
+	size_t sz = file->seekAndRead(0, buf, sizeof(buf));
+	if (sz >= sizeof(RpImageLoaderPrivate::png_magic)) {
+		// Check for PNG.
+		if (!memcmp(buf, RpImageLoaderPrivate::png_magic,
+		     sizeof(RpImageLoaderPrivate::png_magic)))
+		{
+			// Found a PNG image.
+			return RpImageLoaderPrivate::probe_PNG(file, buf, sz, pInfo);
+		}
+#ifdef HAVE_JPEG
+		else if (sz >= 10 &&
+			 !memcmp(buf, RpImageLoaderPrivate::jpeg_magic_1,
+			  sizeof(RpImageLoaderPrivate::jpeg_magic_1)) &&
+			 !memcmp(&buf[6], RpImageLoaderPrivate::jpeg_magic_2,
+			  sizeof(RpImageLoaderPrivate::jpeg_magic_2)))
+		{
+			// Found a JPEG image.
+			return RpImageLoaderPrivate::probe_JPEG(file, pInfo);
+		}
+#endif /* HAVE_JPEG */
+	}
+
+	// Unsupported image format.
+	return -ENOTSUP;
+}
+
 }
@@ -11,6 +11,9 @@
 
 #include "common.h"
 
+// C includes.
+#include <stdint.h>
+
 namespace LibRpFile {
 	class IRpFile;
 }
@@ -31,10 +34,47 @@ class RpImageLoader
 	public:
 		/**
 		 * Load an image from an IRpFile.
-		 * @param file IRpFile to load from.
+		 *
+		 * If req_size is specified, JPEG images may be decoded at a reduced
+		 * scale, as long as the larger dimension is at least req_size.
+		 *
+		 * @param file		[in] IRpFile to load from.
+		 * @param req_size	[in,opt] Requested image size. (0 for full size)
+		 * @param pFullWidth	[out,opt] Full image width.
+		 * @param pFullHeight	[out,opt] Full image height.
 		 * @return rp_image*, or nullptr on error.
 		 */
-		static LibRpTexture::rp_image *load(LibRpFile::IRpFile *file);
+		static LibRpTexture::rp_image *load(LibRpFile::IRpFile *file, int req_size = 0,
+			int *pFullWidth = nullptr, int *pFullHeight = nullptr);
+
+		// Image file type.
+		enum class FileType : uint8_t {
+			Unknown = 0,
+			PNG,
+			JPEG,
+		};
+
+		/**
+		 * Image information, as returned by probe().
+		 */
+		struct ImageInfo {
+			int width;		// Image width
+			int height;		// Image height
+			FileType fileType;	// File type
+			uint8_t bitDepth;	// Bits per channel (or per palette index)
+			uint8_t channels;	// Number of channels (1 for paletted images)
+			bool isPaletted;	// True if the image is paletted
+			uint16_t palette_len;	// Number of palette entries (0 if not paletted)
+		};
+
+		/**
+		 * Get an image's dimensions and format without decoding it.
+		 * Only the PNG IHDR (and PLTE) chunks or the JPEG SOF marker are read.
+		 * @param file	[in] IRpFile to probe.
+		 * @param pInfo	[out] Image information.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int probe(LibRpFile::IRpFile *file, ImageInfo *pInfo);
 };
 
 }
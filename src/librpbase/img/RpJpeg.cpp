@@ -207,10 +207,17 @@ void RpJpegPrivate::jpeg_IRpFile_src(j_decompress_ptr cinfo, IRpFile *infile)
 
 /**
  * Load a JPEG image from an IRpFile.
- * @param file IRpFile to load from.
+ *
+ * If req_size is specified, the image may be decoded at a reduced
+ * scale, as long as the larger dimension is at least req_size.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param req_size	[in,opt] Requested image size. (0 for full size)
+ * @param pFullWidth	[out,opt] Full image width.
+ * @param pFullHeight	[out,opt] Full image height.
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpJpeg::load(IRpFile *file)
+rp_image *RpJpeg::load(IRpFile *file, int req_size, int *pFullWidth, int *pFullHeight)
 {
 	if (!file)
 		return nullptr;
@@ -288,6 +295,21 @@ rp_image *RpJpeg::load(IRpFile *file)
 	}
 
 	/** Step 4: Set parameters for decompression. **/
+	// If a smaller image was requested, let libjpeg downscale it
+	// in the DCT domain. This is much faster than decoding the
+	// full image and then downscaling it.
+	// NOTE: Scale factors of 1/2, 1/4, and 1/8 are supported by
+	// all versions of libjpeg and libjpeg-turbo.
+	if (req_size > 0) {
+		const unsigned int max_dim = std::max(cinfo.image_width, cinfo.image_height);
+		unsigned int denom = 1;
+		while (denom < 8 && (max_dim / (denom * 2)) >= static_cast<unsigned int>(req_size)) {
+			denom *= 2;
+		}
+		cinfo.scale_num = 1;
+		cinfo.scale_denom = denom;
+	}
+
 	// Make sure we use libjpeg's built-in colorspace conversion
 	// where possible.
 	switch (cinfo.jpeg_color_space) {
@@ -387,7 +409,7 @@ rp_image *RpJpeg::load(IRpFile *file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				jpeg_destroy_decompress(&cinfo);
@@ -408,7 +430,7 @@ rp_image *RpJpeg::load(IRpFile *file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				jpeg_destroy_decompress(&cinfo);
@@ -427,7 +449,7 @@ rp_image *RpJpeg::load(IRpFile *file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				jpeg_destroy_decompress(&cinfo);
@@ -576,6 +598,14 @@ rp_image *RpJpeg::load(IRpFile *file)
 	// with the stdio data source (and IRpFile).
 	jpeg_finish_decompress(&cinfo);
 
+	// Return the full image size.
+	if (pFullWidth) {
+		*pFullWidth = static_cast<int>(cinfo.image_width);
+	}
+	if (pFullHeight) {
+		*pFullHeight = static_cast<int>(cinfo.image_height);
+	}
+
 	/** Step 8: Release JPEG decompression object. **/
 	// This will automatically free any memory allocated using
 	// libjpeg's allocation functions.
@@ -31,10 +31,18 @@ class RpJpeg
 	public:
 		/**
 		 * Load a JPEG image from an IRpFile.
-		 * @param file IRpFile to load from.
+		 *
+		 * If req_size is specified, the image may be decoded at a reduced
+		 * scale, as long as the larger dimension is at least req_size.
+		 *
+		 * @param file		[in] IRpFile to load from.
+		 * @param req_size	[in,opt] Requested image size. (0 for full size)
+		 * @param pFullWidth	[out,opt] Full image width.
+		 * @param pFullHeight	[out,opt] Full image height.
 		 * @return rp_image*, or nullptr on error.
 		 */
-		static LibRpTexture::rp_image *load(LibRpFile::IRpFile *file);
+		static LibRpTexture::rp_image *load(LibRpFile::IRpFile *file, int req_size = 0,
+			int *pFullWidth = nullptr, int *pFullHeight = nullptr);
 };
 
 }
@@ -36,11 +36,20 @@ namespace LibRpBase {
 
 /**
  * Load a JPEG image from an IRpFile.
- * @param file IRpFile to load from.
+ *
+ * If req_size is specified, the image may be decoded at a reduced
+ * scale, as long as the larger dimension is at least req_size.
+ * NOTE: GDI+ doesn't support scaled decoding, so req_size is ignored.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param req_size	[in,opt] Requested image size. (0 for full size)
+ * @param pFullWidth	[out,opt] Full image width.
+ * @param pFullHeight	[out,opt] Full image height.
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpJpeg::load(IRpFile *file)
+rp_image *RpJpeg::load(IRpFile *file, int req_size, int *pFullWidth, int *pFullHeight)
 {
+	RP_UNUSED(req_size);
 	if (!file)
 		return nullptr;
 
@@ -58,7 +67,14 @@ rp_image *RpJpeg::load(IRpFile *file)
 
 	// Create an rp_image using the GDI+ bitmap.
 	RpGdiplusBackend *const backend = new RpGdiplusBackend(pGdipBmp);
-	return new rp_image(backend);
+	rp_image *const img = new rp_image(backend);
+	if (pFullWidth) {
+		*pFullWidth = img->width();
+	}
+	if (pFullHeight) {
+		*pFullHeight = img->height();
+	}
+	return img;
 }
 
 }
@@ -10,6 +10,7 @@
 #include "config.librpbase.h"
 
 #include "RpPng.hpp"
+#include "RpPng_p.hpp"
 
 // librpfile
 #include "librpfile/RpFile.hpp"
@@ -20,6 +21,10 @@ using LibRpFile::IRpFile;
 using LibRpTexture::rp_image;
 using LibRpTexture::argb32_t;
 
+#ifdef RPPNG_HAS_SSSE3
+# include "librpcpu/cpuflags_x86.h"
+#endif /* RPPNG_HAS_SSSE3 */
+
 // PNG writer.
 #include "RpPngWriter.hpp"
 
@@ -28,7 +33,6 @@ using std::unique_ptr;
 
 // Image format libraries.
 #include <zlib.h>	// get_crc_table()
-#include <png.h>
 
 #if PNG_LIBPNG_VER < 10209 || \
     (PNG_LIBPNG_VER == 10209 && \
@@ -44,16 +48,6 @@ using std::unique_ptr;
 	png_set_gray_1_2_4_to_8(png_ptr)
 #endif
 
-// PNGCAPI was added in libpng-1.5.0beta14.
-// Older versions will need this.
-#ifndef PNGCAPI
-# ifdef _MSC_VER
-#  define PNGCAPI __cdecl
-# else
-#  define PNGCAPI
-# endif
-#endif /* !PNGCAPI */
-
 #if defined(_MSC_VER) && (defined(ZLIB_IS_DLL) || defined(PNG_IS_DLL))
 // Need zlib for delay-load checks.
 #include <zlib.h>
@@ -82,76 +76,6 @@ static int DelayLoad_test_zlib_and_png(void)
 }
 #endif /* defined(_MSC_VER) && (defined(ZLIB_IS_DLL) || defined(PNG_IS_DLL)) */
 
-class RpPngPrivate
-{
-	private:
-		// RpPngPrivate is a static class.
-		RpPngPrivate();
-		~RpPngPrivate();
-		RP_DISABLE_COPY(RpPngPrivate)
-
-	public:
-		/** I/O functions. **/
-
-		/**
-		 * libpng I/O read handler for IRpFile.
-		 * @param png_ptr	[in]  PNG pointer.
-		 * @param data		[out] Buffer for the data to read.
-		 * @param length	[in]  Size of data.
-		 */
-		static void PNGCAPI png_io_IRpFile_read(png_structp png_ptr, png_bytep data, png_size_t length);
-
-		/**
-		 * libpng I/O write handler for IRpFile.
-		 * @param png_ptr	[in] PNG pointer.
-		 * @param data		[in] Data to write.
-		 * @param length	[in] Size of data.
-		 */
-		static void PNGCAPI png_io_IRpFile_write(png_structp png_ptr, png_bytep data, png_size_t length);
-
-		/**
-		 * libpng I/O flush handler for IRpFile.
-		 * @param png_ptr	[in] PNG pointer.
-		 */
-		static void PNGCAPI png_io_IRpFile_flush(png_structp png_ptr);
-
-		/** Error handler functions. **/
-
-#ifdef PNG_WARNINGS_SUPPORTED
-		/**
-		 * libpng warning handler function that simply ignores warnings.
-		 *
-		 * Certain PNG images have "known incorrect" sRGB profiles,
-		 * and we don't want libpng to spam stderr with warnings
-		 * about them.
-		 *
-		 * @param png_ptr	[in] PNG pointer.
-		 * @param msg		[in] Warning message.
-		 */
-		static void PNGCAPI png_warning_fn(png_structp png_ptr, png_const_charp msg);
-#endif /* PNG_WARNINGS_SUPPORTED */
-
-		/** Read functions. **/
-
-		/**
-		 * Read the palette for a CI8 image.
-		 * @param png_ptr png_structp
-		 * @param info_ptr png_infop
-		 * @param color_type PNG color type.
-		 * @param img rp_image to store the palette in.
-		 */
-		static void Read_CI8_Palette(png_structp png_ptr, png_infop info_ptr,
-					     int color_type, rp_image *img);
-
-		/**
-		 * Load a PNG image from an opened PNG handle.
-		 * @param png_ptr png_structp
-		 * @param info_ptr png_infop
-		 * @return rp_image*, or nullptr on error.
-		 */
-		static rp_image *loadPng(png_structp png_ptr, png_infop info_ptr);
-};
-
 /** RpPngPrivate **/
 
 /** I/O functions. **/
@@ -332,8 +256,8 @@ void RpPngPrivate::Read_CI8_Palette(png_structp png_ptr, png_infop info_ptr,
  */
 rp_image *RpPngPrivate::loadPng(png_structp png_ptr, png_infop info_ptr)
 {
-	// Row pointers. (NOTE: Allocated after IHDR is read.)
-	const png_byte **row_pointers = nullptr;
+	// Row buffer for SSSE3 RGB24 expansion. (NOTE: Allocated after IHDR is read.)
+	png_byte *row_buf = nullptr;
 	rp_image *img = nullptr;
 
 	bool has_sBIT = false;
@@ -344,7 +268,7 @@ rp_image *RpPngPrivate::loadPng(png_structp png_ptr, png_infop info_ptr)
 	// WARNING: Do NOT initialize any C++ objects past this point!
 	if (setjmp(png_jmpbuf(png_ptr))) {
 		// PNG read failed.
-		png_free(png_ptr, row_pointers);
+		png_free(png_ptr, row_buf);
 		UNREF(img);
 		return nullptr;
 	}
@@ -491,22 +415,36 @@ rp_image *RpPngPrivate::loadPng(png_structp png_ptr, png_infop info_ptr)
 	png_get_IHDR(png_ptr, info_ptr, &width, &height,
 		&bit_depth, &color_type, nullptr, nullptr, nullptr);
 
-	if (is24bit) {
-		// rp_image doesn't support 24-bit color.
-		// Expand it by having libpng fill the alpha channel
-		// with 0xFF (opaque).
-		png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
-	}
+	// Interlaced images are read in multiple passes.
+	// NOTE: This must be set before png_read_update_info().
+	const int passes = png_set_interlace_handling(png_ptr);
+
+	// rp_image doesn't support 24-bit color.
+#ifdef RPPNG_HAS_SSSE3
+	// If SSSE3 is available, 24-bit RGB rows are expanded to ARGB32
+	// using SSSE3 instead of libpng's filler and BGR transforms.
+	// NOTE: Interlaced images need the previous pass's data in the
+	// row buffer, so they're always handled by libpng.
+	const bool expand_ssse3 = (is24bit && passes == 1 && RP_CPU_HasSSSE3());
+#else /* !RPPNG_HAS_SSSE3 */
+	static const bool expand_ssse3 = false;
+#endif /* RPPNG_HAS_SSSE3 */
+
+	if (!expand_ssse3) {
+		if (is24bit) {
+			// Expand it by having libpng fill the alpha channel
+			// with 0xFF (opaque).
+			png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
+		}
 
-	// We're using "BGR" color.
-	png_set_bgr(png_ptr);
+		// We're using "BGR" color.
+		png_set_bgr(png_ptr);
+	}
 
 	// Update the PNG info.
 	png_read_update_info(png_ptr, info_ptr);
 
 	// Create the rp_image.
-
-	// Initialize the row pointers array.
 	img = new rp_image(width, height, fmt);
 	if (!img->isValid()) {
 		// Could not allocate the image.
@@ -514,25 +452,35 @@ rp_image *RpPngPrivate::loadPng(png_structp png_ptr, png_infop info_ptr)
 		return nullptr;
 	}
 
-	// Allocate the row pointers.
-	row_pointers = static_cast<const png_byte**>(
-		png_malloc(png_ptr, sizeof(const png_byte*) * height));
-	if (!row_pointers) {
-		img->unref();
-		return nullptr;
-	}
-
-	// Initialize the row pointers array.
-	const png_byte *pb = static_cast<const png_byte*>(img->bits());
+	// Read the image directly into the rp_image.
+	png_byte *pb = static_cast<png_byte*>(img->bits());
 	const int stride = img->stride();
-	for (png_uint_32 y = 0; y < height; y++, pb += stride) {
-		row_pointers[y] = pb;
+#ifdef RPPNG_HAS_SSSE3
+	if (expand_ssse3) {
+		// Read each row into the row buffer, then expand it.
+		row_buf = static_cast<png_byte*>(png_malloc(png_ptr, png_get_rowbytes(png_ptr, info_ptr)));
+		if (!row_buf) {
+			img->unref();
+			return nullptr;
+		}
+		for (png_uint_32 y = 0; y < height; y++, pb += stride) {
+			png_read_row(png_ptr, row_buf, nullptr);
+			expandRGBtoARGB(reinterpret_cast<argb32_t*>(pb), row_buf, width);
+		}
+		png_free(png_ptr, row_buf);
+	} else
+#endif /* RPPNG_HAS_SSSE3 */
+	{
+		// NOTE: Reading one row at a time avoids having to
+		// allocate a row pointers array.
+		for (int pass = 0; pass < passes; pass++) {
+			png_byte *pb_row = pb;
+			for (png_uint_32 y = 0; y < height; y++, pb_row += stride) {
+				png_read_row(png_ptr, pb_row, nullptr);
+			}
+		}
 	}
 
-	// Read the image.
-	png_read_image(png_ptr, const_cast<png_byte**>(row_pointers));
-	png_free(png_ptr, row_pointers);
-
 	// If CI8, read the palette.
 	if (fmt == rp_image::Format::CI8) {
 		Read_CI8_Palette(png_ptr, info_ptr, color_type, img);
@@ -15,6 +15,7 @@
 
 // librpfile
 #include "librpfile/RpFile.hpp"
+#include "librpfile/RpTrace.hpp"
 using LibRpFile::IRpFile;
 using LibRpFile::RpFile;
 
@@ -119,18 +120,21 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(IRpFile *file, int width, int height, rp_image::Format format)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Default)
 		{
 			init(file, width, height, format);
 		}
 		RpPngWriterPrivate(IRpFile *file, const rp_image *img)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Default)
 		{
 			init(file, img);
 		}
 		RpPngWriterPrivate(IRpFile *file, const IconAnimData *iconAnimData)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Default)
 		{
 			init(file, iconAnimData);
 		}
@@ -138,6 +142,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const char *filename, int width, int height, rp_image::Format format)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Default)
 		{
 			RpFile *const file = (filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(file, width, height, format);
@@ -146,6 +151,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const char *filename, const rp_image *img)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Default)
 		{
 			RpFile *const file = (filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(file, img);
@@ -154,6 +160,7 @@ class RpPngWriterPrivate
 		RpPngWriterPrivate(const char *filename, const IconAnimData *iconAnimData)
 			: lastError(0), file(nullptr), imageTag(ImageTag::Invalid)
 			, png_ptr(nullptr), info_ptr(nullptr), IHDR_written(false)
+			, profile(RpPngWriter::Profile::Default)
 		{
 			RpFile *const file = (filename ? new RpFile(filename, RpFile::FM_CREATE_WRITE) : nullptr);
 			init(file, iconAnimData);
@@ -277,6 +284,9 @@ class RpPngWriterPrivate
 		// Current state.
 		bool IHDR_written;
 
+		// Compression profile.
+		RpPngWriter::Profile profile;
+
 	public:
 		/**
 		 * Initialize the PNG write structs.
@@ -542,7 +552,7 @@ void RpPngWriterPrivate::init(IRpFile *file, const IconAnimData *iconAnimData)
 	if (imageTag == ImageTag::IconAnimData) {
 		this->iconAnimData = iconAnimData;
 		// Cache the image parameters.
-		const rp_image *const img0 = iconAnimData->frames[iconAnimData->seq_index[0]];
+		const rp_image *const img0 = iconAnimData->frame(iconAnimData->seq_index[0]);
 		assert(img0 != nullptr);
 		if (unlikely(!img0)) {
 			// Invalid animated image.
@@ -551,7 +561,7 @@ void RpPngWriterPrivate::init(IRpFile *file, const IconAnimData *iconAnimData)
 		}
 		cache.setFrom(img0);
 	} else {
-		this->img = iconAnimData->frames[iconAnimData->seq_index[0]];
+		this->img = iconAnimData->frame(iconAnimData->seq_index[0]);
 		cache.setFrom(img);
 	}
 
@@ -852,9 +862,6 @@ int RpPngWriterPrivate::write_IDAT_APNG(void)
 		return -lastError;
 	}
 
-	// Row pointers. (NOTE: Allocated after IHDR is written.)
-	const png_byte **row_pointers = nullptr;
-
 	// Using the cached width/height from the first image.
 	// TODO: Handle animated images where the different frames
 	// have different widths, heights, and/or formats.
@@ -863,7 +870,6 @@ int RpPngWriterPrivate::write_IDAT_APNG(void)
 	// WARNING: Do NOT initialize any C++ objects past this point!
 	if (setjmp(png_jmpbuf(png_ptr))) {
 		// PNG read failed.
-		png_free(png_ptr, row_pointers);
 		return -EIO;
 	}
 #endif /* PNG_SETJMP_SUPPORTED */
@@ -873,43 +879,59 @@ int RpPngWriterPrivate::write_IDAT_APNG(void)
 	// TODO: What format on big-endian?
 	png_set_bgr(png_ptr);
 
-	// Allocate the row pointers.
-	row_pointers = static_cast<const png_byte**>(
-		png_malloc(png_ptr, sizeof(const png_byte*) * cache.height));
-	if (!row_pointers) {
-		lastError = ENOMEM;
-		return -lastError;
-	}
-
-	// Write the images.
+	// APNG frames can't reference other frames' image data, but
+	// IconAnimData sequences often repeat frames. If a sequence entry
+	// uses the image that's already on the canvas, it's written as a
+	// 1x1 frame that copies the image's top-left pixel, so the frame
+	// isn't encoded again.
+	// If the frame after the next one returns to the current canvas,
+	// e.g. A,B,A,B, the next frame uses PNG_DISPOSE_OP_PREVIOUS so
+	// the canvas reverts to the current image afterwards.
+	// NOTE: Frames are compared by rp_image pointer.
+	// NOTE 2: Rows are written directly from the rp_image buffers.
+	const rp_image *canvas = nullptr;	// Image on the canvas before the current frame.
 	for (int i = 0; i < iconAnimData->seq_count; i++) {
-		const rp_image *const img = iconAnimData->frames[iconAnimData->seq_index[i]];
+		const rp_image *const img = iconAnimData->frame(iconAnimData->seq_index[i]);
 		if (!img)
 			break;
 
-		// Initialize the row pointers array.
-		for (int y = cache.height-1; y >= 0; y--) {
-			row_pointers[y] = static_cast<const png_byte*>(img->scanLine(y));
+		// If the next frame would return to the canvas from before
+		// this frame, restore it when this frame is disposed of.
+		// NOTE: PNG_DISPOSE_OP_PREVIOUS is treated as
+		// PNG_DISPOSE_OP_BACKGROUND on the first frame.
+		png_byte dispose_op = PNG_DISPOSE_OP_NONE;
+		if (i > 0 && i + 1 < iconAnimData->seq_count) {
+			const rp_image *const next = iconAnimData->frame(iconAnimData->seq_index[i + 1]);
+			if (next != img && next == canvas) {
+				dispose_op = PNG_DISPOSE_OP_PREVIOUS;
+			}
 		}
 
 		// Frame header.
-		png_write_frame_head(png_ptr, info_ptr, (png_bytepp)row_pointers,
-				cache.width, cache.height, 0, 0,	// width, height, x offset, y offset
+		const bool reuse = (img == canvas);
+		const int frame_w = (reuse ? 1 : cache.width);
+		const int frame_h = (reuse ? 1 : cache.height);
+		png_write_frame_head(png_ptr, info_ptr, nullptr,
+				frame_w, frame_h, 0, 0,	// width, height, x offset, y offset
 				iconAnimData->delays[i].numer,
 				iconAnimData->delays[i].denom,
-				PNG_DISPOSE_OP_NONE,
+				dispose_op,
 				PNG_BLEND_OP_SOURCE);
 
 		// Write the image data.
+		// NOTE: For 1x1 frames, only the first pixel of the first row is used.
 		// TODO: Individual palette for CI8?
-		png_write_image(png_ptr, (png_bytepp)row_pointers);
+		for (int y = 0; y < frame_h; y++) {
+			png_write_row(png_ptr, PNG_CONST_CAST(png_bytep)(static_cast<const png_byte*>(img->scanLine(y))));
+		}
 
 		// Frame tail.
 		png_write_frame_tail(png_ptr, info_ptr);
-	}
 
-	png_free(png_ptr, row_pointers);
-	row_pointers = nullptr;
+		if (dispose_op != PNG_DISPOSE_OP_PREVIOUS) {
+			canvas = img;
+		}
+	}
 
 	// Finished writing.
 	png_write_end(png_ptr, info_ptr);
@@ -1087,6 +1109,18 @@ void RpPngWriter::close(void)
 	d->close();
 }
 
+/**
+ * Set the compression profile.
+ * This must be called before write_IHDR().
+ * @param profile Compression profile.
+ */
+void RpPngWriter::setProfile(Profile profile)
+{
+	RP_D(RpPngWriter);
+	assert(!d->IHDR_written);
+	d->profile = profile;
+}
+
 /**
  * Write the PNG IHDR.
  * This must be called before writing any other image data.
@@ -1122,9 +1156,24 @@ int RpPngWriter::write_IHDR(void)
 #endif /* PNG_SETJMP_SUPPORTED */
 
 	// Initialize compression parameters.
-	// TODO: Customizable?
-	png_set_filter(d->png_ptr, 0, PNG_FILTER_NONE);
-	png_set_compression_level(d->png_ptr, PNG_Z_DEFAULT_COMPRESSION);
+	switch (d->profile) {
+		default:
+		case RpPngWriter::Profile::Default:
+			png_set_filter(d->png_ptr, 0, PNG_FILTER_NONE);
+			png_set_compression_level(d->png_ptr, PNG_Z_DEFAULT_COMPRESSION);
+			break;
+
+		case RpPngWriter::Profile::Fast:
+			// The Sub filter turns runs of identical pixels into
+			// runs of zero bytes, which Z_RLE handles quickly.
+			// Paletted images are left unfiltered, since filtering
+			// palette indexes usually makes compression worse.
+			png_set_filter(d->png_ptr, 0,
+				(d->cache.format == rp_image::Format::CI8) ? PNG_FILTER_NONE : PNG_FILTER_SUB);
+			png_set_compression_level(d->png_ptr, 1);
+			png_set_compression_strategy(d->png_ptr, Z_RLE);
+			break;
+	}
 
 	// Write the PNG header.
 	switch (d->cache.format) {
@@ -1408,6 +1457,7 @@ int RpPngWriter::write_tEXt(const kv_vector &kv)
  */
 int RpPngWriter::write_IDAT(const uint8_t *const *row_pointers, bool is_abgr)
 {
+	RP_TRACE_SCOPE("RpPngWriter::write_IDAT");
 	assert(row_pointers != nullptr);
 	if (unlikely(!row_pointers)) {
 		return -EINVAL;
@@ -1438,6 +1488,7 @@ int RpPngWriter::write_IDAT(const uint8_t *const *row_pointers, bool is_abgr)
  */
 int RpPngWriter::write_IDAT(void)
 {
+	RP_TRACE_SCOPE("RpPngWriter::write_IDAT");
 	RP_D(RpPngWriter);
 	int ret = -1;
 	switch (d->imageTag) {
@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (librpbase)                        *
  * RpPngWriter.hpp: PNG image writer.                                      *
  *                                                                         *
- * Copyright (c) 2016-2020 by David Korth.                                 *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -172,6 +172,24 @@ class RpPngWriter
 		 */
 		void close(void);
 
+		// Compression profiles.
+		enum class Profile : uint8_t {
+			// Default zlib compression level with no filtering.
+			Default = 0,
+
+			// Fast compression, e.g. for thumbnail caches.
+			// Uses the Sub filter and zlib's Z_RLE strategy.
+			// CI8 images are still written unfiltered.
+			Fast,
+		};
+
+		/**
+		 * Set the compression profile.
+		 * This must be called before write_IHDR().
+		 * @param profile Compression profile.
+		 */
+		void setProfile(Profile profile);
+
 		/**
 		 * Write the PNG IHDR.
 		 * This must be called before writing any other image data.
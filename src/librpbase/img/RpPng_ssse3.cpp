@@ -0,0 +1,72 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * RpPng_ssse3.cpp: PNG image handler.                                     *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RpPng_p.hpp"
+
+// librptexture
+using LibRpTexture::argb32_t;
+
+// SSSE3 intrinsics.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+namespace LibRpBase {
+
+/**
+ * Expand a row of 24-bit RGB pixels to 32-bit ARGB.
+ * SSSE3-optimized version.
+ * NOTE: This function should ONLY be called from loadPng().
+ * @param dest	[out] Destination row. (ARGB32)
+ * @param src	[in] Source row. (RGB24, as read by libpng)
+ * @param width	[in] Width, in pixels.
+ */
+void RpPngPrivate::expandRGBtoARGB(argb32_t *RESTRICT dest, const uint8_t *RESTRICT src, unsigned int width)
+{
+	// Same shuffle as RpJpegPrivate::decodeBGRtoARGB().
+	// libpng returns bytes in R,G,B order; rp_image wants B,G,R,A.
+	const __m128i shuf_mask = _mm_setr_epi8(2,1,0,-1, 5,4,3,-1, 8,7,6,-1, 11,10,9,-1);
+	const __m128i alpha_mask = _mm_setr_epi8(0,0,0,-1, 0,0,0,-1, 0,0,0,-1, 0,0,0,-1);
+
+	// Process 16 pixels per iteration using SSSE3.
+	// NOTE: The source row buffer is allocated by libpng,
+	// so it might not be 16-byte aligned.
+	unsigned int x = width;
+	for (; x > 15; x -= 16, dest += 16, src += 16*3) {
+		const __m128i *xmm_src = reinterpret_cast<const __m128i*>(src);
+		__m128i *xmm_dest = reinterpret_cast<__m128i*>(dest);
+
+		__m128i sa = _mm_loadu_si128(&xmm_src[0]);
+		__m128i sb = _mm_loadu_si128(&xmm_src[1]);
+		__m128i sc = _mm_loadu_si128(&xmm_src[2]);
+
+		__m128i val = _mm_shuffle_epi8(sa, shuf_mask);
+		val = _mm_or_si128(val, alpha_mask);
+		_mm_storeu_si128(&xmm_dest[0], val);
+		val = _mm_shuffle_epi8(_mm_alignr_epi8(sb, sa, 12), shuf_mask);
+		val = _mm_or_si128(val, alpha_mask);
+		_mm_storeu_si128(&xmm_dest[1], val);
+		val = _mm_shuffle_epi8(_mm_alignr_epi8(sc, sb, 8), shuf_mask);
+		val = _mm_or_si128(val, alpha_mask);
+		_mm_storeu_si128(&xmm_dest[2], val);
+		val = _mm_shuffle_epi8(_mm_alignr_epi8(sc, sc, 4), shuf_mask);
+		val = _mm_or_si128(val, alpha_mask);
+		_mm_storeu_si128(&xmm_dest[3], val);
+	}
+
+	// Remaining pixels.
+	for (; x > 0; x--, dest++, src += 3) {
+		dest->b = src[2];
+		dest->g = src[1];
+		dest->r = src[0];
+		dest->a = 0xFF;
+	}
+}
+
+}
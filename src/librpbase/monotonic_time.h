@@ -0,0 +1,52 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * monotonic_time.h: Monotonic clock for timing measurements.              *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_MONOTONIC_TIME_H__
+#define __ROMPROPERTIES_LIBRPBASE_MONOTONIC_TIME_H__
+
+#include <stdint.h>
+
+#ifdef _WIN32
+# ifndef WIN32_LEAN_AND_MEAN
+#  define WIN32_LEAN_AND_MEAN 1
+# endif
+# include <windows.h>
+#else /* !_WIN32 */
+# include <time.h>
+#endif /* _WIN32 */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get the current value of a monotonic clock.
+ * Only useful for measuring time intervals.
+ * @return Monotonic time, in nanoseconds.
+ */
+static inline uint64_t rp_monotonic_ns(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	// Split the calculation to avoid overflow.
+	return ((uint64_t)(count.QuadPart / freq.QuadPart) * 1000000000ULL) +
+	       ((uint64_t)(count.QuadPart % freq.QuadPart) * 1000000000ULL / (uint64_t)freq.QuadPart);
+#else /* !_WIN32 */
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+#endif /* _WIN32 */
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_MONOTONIC_TIME_H__ */
@@ -18,6 +18,7 @@
 #else /* !_WIN32 */
 # include "../crypto/AesNettle.hpp"
 #endif /* _WIN32 */
+#include "../crypto/AesNI.hpp"
 
 // C includes. (C++ namespace)
 #include <cstdio>
@@ -703,6 +704,9 @@ AesDecryptTestSet(CAPI_NG, false)
 #else /* !_WIN32 */
 AesDecryptTestSet(Nettle, true)
 #endif /* _WIN32 */
+#ifdef AESNI_IS_SUPPORTED
+AesDecryptTestSet(NI, false)
+#endif /* AESNI_IS_SUPPORTED */
 
 } }
 
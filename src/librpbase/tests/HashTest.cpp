@@ -0,0 +1,170 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * HashTest.cpp: Hash class test.                                          *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+
+// Hash
+#include "../crypto/Hash.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+using std::string;
+
+namespace LibRpBase { namespace Tests {
+
+struct HashTest_mode
+{
+	// String to hash.
+	const char *str;
+
+	// Expected hashes, as hex strings.
+	const char *crc32;
+	const char *md5;
+	const char *sha1;
+
+	HashTest_mode(const char *str, const char *crc32, const char *md5, const char *sha1)
+		: str(str), crc32(crc32), md5(md5), sha1(sha1)
+	{ }
+};
+
+class HashTest : public ::testing::TestWithParam<HashTest_mode>
+{
+	public:
+		/**
+		 * Get the hash as a hex string.
+		 * @param hash Hash object.
+		 * @return Hex string.
+		 */
+		static string getHashString(Hash &hash);
+
+		/**
+		 * Get the expected hash for an algorithm.
+		 * @param mode Test mode.
+		 * @param algorithm Hash algorithm.
+		 * @return Expected hash, as a hex string.
+		 */
+		static const char *expectedHash(const HashTest_mode &mode, Hash::Algorithm algorithm);
+};
+
+/**
+ * Get the hash as a hex string.
+ * @param hash Hash object.
+ * @return Hex string.
+ */
+string HashTest::getHashString(Hash &hash)
+{
+	uint8_t buf[64];
+	const size_t len = hash.hashLength();
+	EXPECT_LE(len, sizeof(buf));
+	EXPECT_EQ(0, hash.getHash(buf, sizeof(buf)));
+
+	string s;
+	char printf_buf[4];
+	for (size_t i = 0; i < len; i++) {
+		snprintf(printf_buf, sizeof(printf_buf), "%02x", buf[i]);
+		s += printf_buf;
+	}
+	return s;
+}
+
+/**
+ * Get the expected hash for an algorithm.
+ * @param mode Test mode.
+ * @param algorithm Hash algorithm.
+ * @return Expected hash, as a hex string.
+ */
+const char *HashTest::expectedHash(const HashTest_mode &mode, Hash::Algorithm algorithm)
+{
+	switch (algorithm) {
+		case Hash::Algorithm::CRC32:
+			return mode.crc32;
+		case Hash::Algorithm::MD5:
+			return mode.md5;
+		case Hash::Algorithm::SHA1:
+			return mode.sha1;
+		default:
+			break;
+	}
+	return nullptr;
+}
+
+static const Hash::Algorithm hash_algorithms[] = {
+	Hash::Algorithm::CRC32,
+	Hash::Algorithm::MD5,
+	Hash::Algorithm::SHA1,
+};
+
+/**
+ * Hash the string all at once.
+ */
+TEST_P(HashTest, singleBlock)
+{
+	const HashTest_mode &mode = GetParam();
+
+	for (Hash::Algorithm algorithm : hash_algorithms) {
+		Hash hash(algorithm);
+		ASSERT_TRUE(hash.isUsable());
+		EXPECT_EQ(0, hash.process(mode.str, strlen(mode.str)));
+		EXPECT_EQ(expectedHash(mode, algorithm), getHashString(hash)) <<
+			"Algorithm: " << Hash::algorithmName(algorithm);
+	}
+}
+
+/**
+ * Hash the string one byte at a time.
+ * getHash() is called before every byte, since it
+ * must not change the hash state.
+ */
+TEST_P(HashTest, byteAtATime)
+{
+	const HashTest_mode &mode = GetParam();
+	const size_t len = strlen(mode.str);
+
+	for (Hash::Algorithm algorithm : hash_algorithms) {
+		Hash hash(algorithm);
+		ASSERT_TRUE(hash.isUsable());
+		for (size_t i = 0; i < len; i++) {
+			getHashString(hash);
+			EXPECT_EQ(0, hash.process(&mode.str[i], 1));
+		}
+		EXPECT_EQ(expectedHash(mode, algorithm), getHashString(hash)) <<
+			"Algorithm: " << Hash::algorithmName(algorithm);
+
+		// Reset the hash and try again.
+		hash.reset();
+		EXPECT_EQ(0, hash.process(mode.str, len));
+		EXPECT_EQ(expectedHash(mode, algorithm), getHashString(hash)) <<
+			"Algorithm: " << Hash::algorithmName(algorithm) << " (after reset)";
+	}
+}
+
+/** Hash tests. **/
+
+INSTANTIATE_TEST_SUITE_P(HashStringTest, HashTest,
+	::testing::Values(
+		HashTest_mode("",
+			"00000000",
+			"d41d8cd98f00b204e9800998ecf8427e",
+			"da39a3ee5e6b4b0d3255bfef95601890afd80709"),
+		HashTest_mode("The quick brown fox jumps over the lazy dog.",
+			"519025e9",
+			"e4d909c290d0fb1ca068ffaddf22cbd0",
+			"408d94384216f890ff7a0c3528e8bed1e0b01621"),
+		HashTest_mode("Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.",
+			"474b756f",
+			"818c6e601a24f72750da0f6c9b8ebe28",
+			"cca0871ecbe200379f0a1e4b46de177e2d62e655")
+		)
+	);
+
+} }
@@ -0,0 +1,134 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RefBaseBenchmark.cpp: RefBase reference counting benchmarks.            *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Benchmark
+#include <benchmark/benchmark.h>
+#include "common.h"
+#include "RefBase.hpp"
+
+// C includes.
+#include <stdio.h>
+
+namespace LibRpBase { namespace Benchmarks {
+
+/**
+ * RefBase subclass with no extra data.
+ */
+class TestRefBase : public RefBase
+{
+	public:
+		TestRefBase() { }
+};
+
+/**
+ * Reference-counted class using the original SEQ_CST
+ * atomics, for comparison with RefBase.
+ */
+class SeqCstRefBase
+{
+	public:
+		SeqCstRefBase() : m_ref_cnt(1) { }
+		virtual ~SeqCstRefBase() { }
+
+	public:
+		inline SeqCstRefBase *ref(void)
+		{
+			ATOMIC_INC_FETCH(&m_ref_cnt);
+			return this;
+		}
+
+		void unref(void)
+		{
+			if (ATOMIC_DEC_FETCH(&m_ref_cnt) <= 0) {
+				delete this;
+			}
+		}
+
+	private:
+		volatile int m_ref_cnt;
+};
+
+/**
+ * Take a reference to an object.
+ * @param obj Object
+ * @return obj
+ */
+static inline SeqCstRefBase *doRef(SeqCstRefBase *obj)
+{
+	return obj->ref();
+}
+
+/**
+ * Take a reference to an object.
+ * @param obj Object
+ * @return obj
+ */
+static inline TestRefBase *doRef(TestRefBase *obj)
+{
+	return obj->ref<TestRefBase>();
+}
+
+// Number of ref()/unref() pairs per iteration.
+static const int REFS_PER_ITERATION = 64;
+
+/**
+ * Benchmark ref()/unref() pairs on a single object.
+ * With multiple threads, all threads share the same object.
+ */
+template<class T>
+static void BM_ref_unref(benchmark::State &state)
+{
+	// NOTE: The shared object is never deleted.
+	static T *const obj = new T();
+
+	for (auto _ : state) {
+		for (int i = 0; i < REFS_PER_ITERATION; i++) {
+			T *const p = doRef(obj);
+			benchmark::DoNotOptimize(p);
+			p->unref();
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * REFS_PER_ITERATION);
+}
+
+BENCHMARK_TEMPLATE(BM_ref_unref, SeqCstRefBase)->ThreadRange(1, 4)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ref_unref, TestRefBase)->ThreadRange(1, 4)->UseRealTime();
+
+/**
+ * Benchmark creating and deleting objects.
+ * This covers the acquire fence in RefBase::unref().
+ */
+template<class T>
+static void BM_new_unref(benchmark::State &state)
+{
+	for (auto _ : state) {
+		T *const obj = new T();
+		benchmark::DoNotOptimize(obj);
+		obj->unref();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_new_unref, SeqCstRefBase);
+BENCHMARK_TEMPLATE(BM_new_unref, TestRefBase);
+
+} }
+
+/**
+ * Benchmark suite main function.
+ */
+int main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRpBase benchmark suite: RefBase reference counting.\n\n");
+	fflush(nullptr);
+
+	::benchmark::Initialize(&argc, argv);
+	if (::benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
@@ -730,6 +730,40 @@ TEST_F(TextFuncsTest, utf16_to_latin1)
 	EXPECT_EQ((const char*)cp1252_data, str);
 }
 
+/**
+ * Test the 7-bit ASCII fast path with a single non-ASCII
+ * character at various positions, including the first
+ * and last characters of a 16-character block.
+ */
+TEST_F(TextFuncsTest, ascii_fast_path)
+{
+	static const char ascii_in[] = "0123456789ABCDEF0123456789abcdef01234567";
+	static const unsigned int positions[] = {0, 7, 15, 16, 31, 32, 39};
+
+	// All ASCII.
+	EXPECT_EQ(ascii_in, latin1_to_utf8(ascii_in, -1));
+	const u16string ascii_utf16 = latin1_to_utf16(ascii_in, -1);
+	EXPECT_EQ(ascii_in, utf16_to_utf8(ascii_utf16.data(), static_cast<int>(ascii_utf16.size())));
+
+	for (unsigned int pos : positions) {
+		// 8-bit: Replace one character with U+00E9.
+		string latin1_in(ascii_in);
+		latin1_in[pos] = static_cast<char>(0xE9);
+		string utf8_exp(ascii_in);
+		utf8_exp.replace(pos, 1, "\xC3\xA9");
+
+		const string utf8_str = latin1_to_utf8(latin1_in);
+		EXPECT_EQ(utf8_exp, utf8_str) << "pos == " << pos;
+
+		// UTF-16: Same character.
+		const u16string utf16_str = latin1_to_utf16(latin1_in.data(), static_cast<int>(latin1_in.size()));
+		ASSERT_EQ(latin1_in.size(), utf16_str.size()) << "pos == " << pos;
+		EXPECT_EQ(0xE9, utf16_str[pos]) << "pos == " << pos;
+		EXPECT_EQ(utf8_exp, utf16_to_utf8(utf16_str.data(), static_cast<int>(utf16_str.size()))) << "pos == " << pos;
+		EXPECT_EQ(latin1_in, utf16_to_latin1(utf16_str.data(), static_cast<int>(utf16_str.size()))) << "pos == " << pos;
+	}
+}
+
 /** Miscellaneous functions. **/
 
 /**
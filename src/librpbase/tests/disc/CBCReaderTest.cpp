@@ -0,0 +1,299 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * CBCReaderTest.cpp: CBCReader tests.                                     *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpbase, librpfile
+#include "librpbase/crypto/AesCipherFactory.hpp"
+#include "librpbase/crypto/IAesCipher.hpp"
+#include "librpbase/disc/CBCReader.hpp"
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::RpMemFile;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+struct DiscReaderUnrefDeleter {
+	void operator()(IDiscReader *discReader) {
+		UNREF(discReader);
+	}
+};
+
+class CBCReaderTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Encrypted data offset within the file.
+		static const unsigned int DATA_OFFSET = 0x210;
+		// Encrypted data length.
+		// This should be several times CBCReader's internal buffer size.
+		static const unsigned int DATA_LENGTH = (256U*1024U) + 48;
+
+		static const uint8_t key[16];
+		static const uint8_t iv[16];
+
+		/**
+		 * Decrypt the ciphertext in one go.
+		 * @param mode Chaining mode
+		 * @param out Plaintext
+		 */
+		void decryptAll(IAesCipher::ChainingMode mode, vector<uint8_t> &out);
+
+		/**
+		 * Read from a CBCReader and compare to the expected data.
+		 * @param reader CBCReader
+		 * @param expected Expected plaintext
+		 * @param pos Position
+		 * @param size Size
+		 * @param useReadAt If true, use readAt(); otherwise, use seek() and read().
+		 */
+		static void checkRead(CBCReader *reader, const vector<uint8_t> &expected,
+			size_t pos, size_t size, bool useReadAt);
+
+		/**
+		 * Do a series of random reads and compare them to the expected data.
+		 * @param reader CBCReader
+		 * @param expected Expected plaintext
+		 */
+		static void checkRandomReads(CBCReader *reader, const vector<uint8_t> &expected);
+
+		/**
+		 * Read the entire data using read() with varying chunk sizes.
+		 * @param reader CBCReader
+		 * @param expected Expected plaintext
+		 */
+		static void checkSequentialReads(CBCReader *reader, const vector<uint8_t> &expected);
+
+	protected:
+		vector<uint8_t> m_fileData;	// File data, including the ciphertext
+		RpMemFile *m_file;
+};
+
+const unsigned int CBCReaderTest::DATA_OFFSET;
+const unsigned int CBCReaderTest::DATA_LENGTH;
+
+const uint8_t CBCReaderTest::key[16] = {
+	0x2B,0x7E,0x15,0x16,0x28,0xAE,0xD2,0xA6,
+	0xAB,0xF7,0x15,0x88,0x09,0xCF,0x4F,0x3C,
+};
+const uint8_t CBCReaderTest::iv[16] = {
+	0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,
+	0x08,0x09,0x0A,0x0B,0x0C,0x0D,0x0E,0x0F,
+};
+
+void CBCReaderTest::SetUp(void)
+{
+	// Any data can be "ciphertext". The expected plaintext
+	// is obtained by decrypting all of it at once.
+	m_fileData.resize(DATA_OFFSET + DATA_LENGTH + 0x100);
+	uint32_t seed = 0xDEADBEEFU;
+	for (size_t i = 0; i < m_fileData.size(); i++) {
+		seed = (seed * 1664525U) + 1013904223U;
+		m_fileData[i] = static_cast<uint8_t>(seed >> 24);
+	}
+	m_file = new RpMemFile(m_fileData.data(), m_fileData.size());
+}
+
+void CBCReaderTest::TearDown(void)
+{
+	UNREF_AND_NULL(m_file);
+}
+
+/**
+ * Decrypt the ciphertext in one go.
+ * @param mode Chaining mode
+ * @param out Plaintext
+ */
+void CBCReaderTest::decryptAll(IAesCipher::ChainingMode mode, vector<uint8_t> &out)
+{
+	unique_ptr<IAesCipher> cipher(AesCipherFactory::create());
+	ASSERT_TRUE(cipher != nullptr);
+	ASSERT_TRUE(cipher->isInit());
+	ASSERT_EQ(0, cipher->setKey(key, sizeof(key)));
+	ASSERT_EQ(0, cipher->setChainingMode(mode));
+	if (mode == IAesCipher::ChainingMode::CBC) {
+		ASSERT_EQ(0, cipher->setIV(iv, sizeof(iv)));
+	}
+
+	out.assign(m_fileData.begin() + DATA_OFFSET, m_fileData.begin() + DATA_OFFSET + DATA_LENGTH);
+	ASSERT_EQ(out.size(), cipher->decrypt(out.data(), out.size()));
+}
+
+/**
+ * Read from a CBCReader and compare to the expected data.
+ * @param reader CBCReader
+ * @param expected Expected plaintext
+ * @param pos Position
+ * @param size Size
+ * @param useReadAt If true, use readAt(); otherwise, use seek() and read().
+ */
+void CBCReaderTest::checkRead(CBCReader *reader, const vector<uint8_t> &expected,
+	size_t pos, size_t size, bool useReadAt)
+{
+	size_t expSize = size;
+	if (pos >= expected.size()) {
+		expSize = 0;
+	} else if (expSize > expected.size() - pos) {
+		expSize = expected.size() - pos;
+	}
+
+	unique_ptr<uint8_t[]> buf(new uint8_t[size > 0 ? size : 1]);
+	size_t sz_read;
+	if (useReadAt) {
+		sz_read = reader->readAt(static_cast<off64_t>(pos), buf.get(), size);
+	} else {
+		ASSERT_EQ(0, reader->seek(static_cast<off64_t>(pos)));
+		sz_read = reader->read(buf.get(), size);
+	}
+	ASSERT_EQ(expSize, sz_read) << "pos == " << pos << ", size == " << size;
+	if (expSize > 0) {
+		ASSERT_EQ(0, memcmp(buf.get(), &expected[pos], expSize))
+			<< "pos == " << pos << ", size == " << size;
+	}
+}
+
+/**
+ * Do a series of random reads and compare them to the expected data.
+ * @param reader CBCReader
+ * @param expected Expected plaintext
+ */
+void CBCReaderTest::checkRandomReads(CBCReader *reader, const vector<uint8_t> &expected)
+{
+	uint32_t seed = 0x13579BDFU;
+	for (unsigned int i = 0; i < 512; i++) {
+		seed = (seed * 1664525U) + 1013904223U;
+		const size_t pos = seed % (expected.size() + 64);
+		seed = (seed * 1664525U) + 1013904223U;
+		// Mostly small reads, with some reads larger than the buffer.
+		const size_t size = (i % 16 == 0)
+			? seed % (160U*1024U)
+			: seed % 1024;
+		ASSERT_NO_FATAL_FAILURE(checkRead(reader, expected, pos, size, (i & 1)));
+	}
+}
+
+/**
+ * Read the entire data using read() with varying chunk sizes.
+ * @param reader CBCReader
+ * @param expected Expected plaintext
+ */
+void CBCReaderTest::checkSequentialReads(CBCReader *reader, const vector<uint8_t> &expected)
+{
+	static const size_t chunkSizes[] = {1, 15, 16, 17, 1000, 4096, 65537};
+
+	ASSERT_EQ(0, reader->seek(0));
+	vector<uint8_t> buf(expected.size());
+	size_t total = 0;
+	for (unsigned int i = 0; total < buf.size(); i++) {
+		size_t chunkSize = chunkSizes[i % ARRAY_SIZE(chunkSizes)];
+		if (chunkSize > buf.size() - total) {
+			chunkSize = buf.size() - total;
+		}
+		const size_t sz_read = reader->read(&buf[total], chunkSize);
+		ASSERT_EQ(chunkSize, sz_read) << "pos == " << total;
+		total += sz_read;
+	}
+	EXPECT_EQ(static_cast<off64_t>(expected.size()), reader->tell());
+	EXPECT_EQ(0, memcmp(buf.data(), expected.data(), expected.size()));
+
+	// Nothing left to read.
+	uint8_t b;
+	EXPECT_EQ(0U, reader->read(&b, 1));
+}
+
+/**
+ * CBC: Random-offset reads must match a plain decryption.
+ */
+TEST_F(CBCReaderTest, cbcRandomReads)
+{
+	vector<uint8_t> expected;
+	ASSERT_NO_FATAL_FAILURE(decryptAll(IAesCipher::ChainingMode::CBC, expected));
+
+	unique_ptr<CBCReader, DiscReaderUnrefDeleter> reader(
+		new CBCReader(m_file, DATA_OFFSET, DATA_LENGTH, key, iv), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+	ASSERT_NO_FATAL_FAILURE(checkRandomReads(reader.get(), expected));
+}
+
+/**
+ * CBC: Sequential reads of odd sizes must carry the IV between reads.
+ */
+TEST_F(CBCReaderTest, cbcSequentialReads)
+{
+	vector<uint8_t> expected;
+	ASSERT_NO_FATAL_FAILURE(decryptAll(IAesCipher::ChainingMode::CBC, expected));
+
+	unique_ptr<CBCReader, DiscReaderUnrefDeleter> reader(
+		new CBCReader(m_file, DATA_OFFSET, DATA_LENGTH, key, iv), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+	ASSERT_NO_FATAL_FAILURE(checkSequentialReads(reader.get(), expected));
+	// Again, after a random read in the middle.
+	ASSERT_NO_FATAL_FAILURE(checkRead(reader.get(), expected, 12345, 678, false));
+	ASSERT_NO_FATAL_FAILURE(checkSequentialReads(reader.get(), expected));
+}
+
+/**
+ * ECB: Random-offset and sequential reads must match a plain decryption.
+ */
+TEST_F(CBCReaderTest, ecbReads)
+{
+	vector<uint8_t> expected;
+	ASSERT_NO_FATAL_FAILURE(decryptAll(IAesCipher::ChainingMode::ECB, expected));
+
+	unique_ptr<CBCReader, DiscReaderUnrefDeleter> reader(
+		new CBCReader(m_file, DATA_OFFSET, DATA_LENGTH, key, nullptr), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+	ASSERT_NO_FATAL_FAILURE(checkRandomReads(reader.get(), expected));
+	ASSERT_NO_FATAL_FAILURE(checkSequentialReads(reader.get(), expected));
+}
+
+/**
+ * No key: The data is passed through as-is.
+ */
+TEST_F(CBCReaderTest, noKey)
+{
+	const vector<uint8_t> expected(m_fileData.begin() + DATA_OFFSET,
+		m_fileData.begin() + DATA_OFFSET + DATA_LENGTH);
+
+	unique_ptr<CBCReader, DiscReaderUnrefDeleter> reader(
+		new CBCReader(m_file, DATA_OFFSET, DATA_LENGTH, nullptr, nullptr), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+	ASSERT_NO_FATAL_FAILURE(checkRandomReads(reader.get(), expected));
+	ASSERT_NO_FATAL_FAILURE(checkSequentialReads(reader.get(), expected));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: CBCReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,498 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * SparseDiscReaderTest.cpp: SparseDiscReader tests.                       *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpbase, librpfile
+#include "librpbase/disc/SparseDiscReader.hpp"
+#include "librpbase/disc/SparseDiscReader_p.hpp"
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::IRpFile;
+using LibRpFile::RpMemFile;
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+/**
+ * RpMemFile that counts batch read requests.
+ */
+class CountingMemFile : public RpMemFile
+{
+	public:
+		CountingMemFile(const void *buf, size_t size)
+			: super(buf, size)
+			, reqCount(0)
+			, bytesRead(0)
+		{ }
+
+	private:
+		typedef RpMemFile super;
+		RP_DISABLE_COPY(CountingMemFile)
+
+	public:
+		size_t readBatch(const ReadRequest *reqs, size_t count) final
+		{
+			reqCount += count;
+			for (size_t i = 0; i < count; i++) {
+				bytesRead += reqs[i].size;
+			}
+			return super::readBatch(reqs, count);
+		}
+
+	public:
+		size_t reqCount;	// Number of batch read requests
+		size_t bytesRead;	// Number of bytes requested by batch reads
+};
+
+class TestSparseReaderPrivate;
+
+/**
+ * SparseDiscReader with a fixed block map.
+ *
+ * Raw blocks are read from the file as-is. Otherwise, each byte
+ * is XORed with NONRAW_XOR to simulate a block that has to be
+ * converted, and readBlock() is used for all reads.
+ */
+class TestSparseReader : public SparseDiscReader
+{
+	public:
+		/**
+		 * Create a TestSparseReader.
+		 * @param file		[in] Physical file
+		 * @param blockMap	[in] Physical address of each logical block (0 == empty)
+		 * @param blockSize	[in] Block size
+		 * @param discSize	[in] Disc size
+		 * @param rawBlocks	[in] If true, blocks are raw.
+		 */
+		TestSparseReader(IRpFile *file, const vector<off64_t> &blockMap,
+			unsigned int blockSize, off64_t discSize, bool rawBlocks);
+
+	private:
+		typedef SparseDiscReader super;
+		RP_DISABLE_COPY(TestSparseReader)
+
+	public:
+		static const uint8_t NONRAW_XOR = 0xA5;
+
+		int isDiscSupported(const uint8_t *pHeader, size_t szHeader) const final
+		{
+			RP_UNUSED(pHeader);
+			RP_UNUSED(szHeader);
+			return 0;
+		}
+
+		/**
+		 * Number of readBlock() calls.
+		 */
+		unsigned int readBlockCount;
+
+	protected:
+		off64_t getPhysBlockAddr(uint32_t blockIdx) const final
+		{
+			if (blockIdx >= m_blockMap.size())
+				return -1;
+			return m_blockMap[blockIdx];
+		}
+
+		int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size) final
+		{
+			readBlockCount++;
+			const int ret = super::readBlock(blockIdx, pos, ptr, size);
+			if (!m_rawBlocks && ret > 0 && getPhysBlockAddr(blockIdx) > 0) {
+				uint8_t *const ptr8 = static_cast<uint8_t*>(ptr);
+				for (int i = 0; i < ret; i++) {
+					ptr8[i] ^= NONRAW_XOR;
+				}
+			}
+			return ret;
+		}
+
+	private:
+		vector<off64_t> m_blockMap;
+		bool m_rawBlocks;
+};
+
+class TestSparseReaderPrivate : public SparseDiscReaderPrivate
+{
+	public:
+		explicit TestSparseReaderPrivate(TestSparseReader *q)
+			: super(q)
+		{ }
+
+	private:
+		typedef SparseDiscReaderPrivate super;
+		RP_DISABLE_COPY(TestSparseReaderPrivate)
+};
+
+TestSparseReader::TestSparseReader(IRpFile *file, const vector<off64_t> &blockMap,
+	unsigned int blockSize, off64_t discSize, bool rawBlocks)
+	: super(new TestSparseReaderPrivate(this), file)
+	, readBlockCount(0)
+	, m_blockMap(blockMap)
+	, m_rawBlocks(rawBlocks)
+{
+	RP_D(SparseDiscReader);
+	d->block_size = blockSize;
+	d->disc_size = discSize;
+	d->pos = 0;
+	d->rawBlocks = rawBlocks;
+}
+
+const uint8_t TestSparseReader::NONRAW_XOR;
+
+struct DiscReaderUnrefDeleter {
+	void operator()(IDiscReader *discReader) {
+		UNREF(discReader);
+	}
+};
+
+class SparseDiscReaderTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final;
+		void TearDown(void) final;
+
+	public:
+		// Block size.
+		static const unsigned int BLOCK_SIZE = 4096;
+		// Number of logical blocks.
+		static const unsigned int BLOCK_COUNT = 96;
+		// Disc size. The last block is short.
+		static const off64_t DISC_SIZE = (static_cast<off64_t>(BLOCK_COUNT) * BLOCK_SIZE) - 1000;
+
+		/**
+		 * Get the physical address of a physical block.
+		 * Physical block 0 is at 0x1000, since 0 means "empty".
+		 * @param physIdx Physical block index
+		 * @return Physical address
+		 */
+		static inline off64_t physAddr(unsigned int physIdx)
+		{
+			return static_cast<off64_t>(physIdx + 1) * BLOCK_SIZE;
+		}
+
+		/**
+		 * Create a reader for the test image.
+		 * @param rawBlocks If true, blocks are raw.
+		 * @return TestSparseReader
+		 */
+		TestSparseReader *createReader(bool rawBlocks)
+		{
+			return new TestSparseReader(m_file, m_blockMap, BLOCK_SIZE, DISC_SIZE, rawBlocks);
+		}
+
+		/**
+		 * Read from a TestSparseReader and compare to the expected data.
+		 * @param reader Reader
+		 * @param expected Expected disc image
+		 * @param pos Position
+		 * @param size Size
+		 */
+		static void checkRead(TestSparseReader *reader, const vector<uint8_t> &expected, size_t pos, size_t size);
+
+		/**
+		 * Do a series of random reads and compare them to the expected data.
+		 * @param reader Reader
+		 * @param expected Expected disc image
+		 * @param seed Random seed
+		 */
+		static void checkRandomReads(TestSparseReader *reader, const vector<uint8_t> &expected, uint32_t seed);
+
+	protected:
+		vector<uint8_t> m_physData;	// Physical file data
+		vector<off64_t> m_blockMap;	// Logical block -> physical address
+		vector<uint8_t> m_expectedRaw;	// Expected disc image if blocks are raw
+		vector<uint8_t> m_expectedNonRaw;	// Expected disc image if blocks aren't raw
+		CountingMemFile *m_file;
+};
+
+const unsigned int SparseDiscReaderTest::BLOCK_SIZE;
+const unsigned int SparseDiscReaderTest::BLOCK_COUNT;
+const off64_t SparseDiscReaderTest::DISC_SIZE;
+
+void SparseDiscReaderTest::SetUp(void)
+{
+	// Block map:
+	// - 0-7: Physical blocks 0-7. (consecutive)
+	// - 8-9: Empty.
+	// - 10-13: Physical block 8. (deduplicated)
+	// - 14-21: Physical blocks 16-9. (reversed)
+	// - 22-23: Physical block 8. (deduplicated, not adjacent to 10-13)
+	// - 24-95: Physical blocks 17-88. (consecutive)
+	m_blockMap.resize(BLOCK_COUNT);
+	for (unsigned int i = 0; i < 8; i++) {
+		m_blockMap[i] = physAddr(i);
+	}
+	m_blockMap[8] = 0;
+	m_blockMap[9] = 0;
+	for (unsigned int i = 10; i < 14; i++) {
+		m_blockMap[i] = physAddr(8);
+	}
+	for (unsigned int i = 14; i < 22; i++) {
+		m_blockMap[i] = physAddr(16 - (i - 14));
+	}
+	m_blockMap[22] = physAddr(8);
+	m_blockMap[23] = physAddr(8);
+	for (unsigned int i = 24; i < BLOCK_COUNT; i++) {
+		m_blockMap[i] = physAddr(17 + (i - 24));
+	}
+	const unsigned int physCount = 17 + (BLOCK_COUNT - 24);
+
+	// Physical file: One header block, then the physical blocks.
+	m_physData.resize(static_cast<size_t>(physAddr(physCount)));
+	uint32_t seed = 0x600DF00DU;
+	for (size_t i = 0; i < m_physData.size(); i++) {
+		seed = (seed * 1664525U) + 1013904223U;
+		m_physData[i] = static_cast<uint8_t>(seed >> 24);
+	}
+
+	// Expected disc images.
+	m_expectedRaw.resize(static_cast<size_t>(DISC_SIZE));
+	m_expectedNonRaw.resize(static_cast<size_t>(DISC_SIZE));
+	for (unsigned int i = 0; i < BLOCK_COUNT; i++) {
+		const size_t pos = static_cast<size_t>(i) * BLOCK_SIZE;
+		const size_t len = std::min(static_cast<size_t>(BLOCK_SIZE), m_expectedRaw.size() - pos);
+		if (m_blockMap[i] == 0) {
+			memset(&m_expectedRaw[pos], 0, len);
+			memset(&m_expectedNonRaw[pos], 0, len);
+			continue;
+		}
+		const uint8_t *const src = &m_physData[static_cast<size_t>(m_blockMap[i])];
+		memcpy(&m_expectedRaw[pos], src, len);
+		for (size_t j = 0; j < len; j++) {
+			m_expectedNonRaw[pos + j] = src[j] ^ TestSparseReader::NONRAW_XOR;
+		}
+	}
+
+	m_file = new CountingMemFile(m_physData.data(), m_physData.size());
+}
+
+void SparseDiscReaderTest::TearDown(void)
+{
+	UNREF_AND_NULL(m_file);
+}
+
+/**
+ * Read from a TestSparseReader and compare to the expected data.
+ * @param reader Reader
+ * @param expected Expected disc image
+ * @param pos Position
+ * @param size Size
+ */
+void SparseDiscReaderTest::checkRead(TestSparseReader *reader, const vector<uint8_t> &expected, size_t pos, size_t size)
+{
+	size_t expSize = size;
+	if (pos >= expected.size()) {
+		expSize = 0;
+	} else if (expSize > expected.size() - pos) {
+		expSize = expected.size() - pos;
+	}
+
+	unique_ptr<uint8_t[]> buf(new uint8_t[size > 0 ? size : 1]);
+	ASSERT_EQ(expSize, reader->readAt(static_cast<off64_t>(pos), buf.get(), size))
+		<< "pos == " << pos << ", size == " << size;
+	if (expSize > 0) {
+		ASSERT_EQ(0, memcmp(buf.get(), &expected[pos], expSize))
+			<< "pos == " << pos << ", size == " << size;
+	}
+}
+
+/**
+ * Do a series of random reads and compare them to the expected data.
+ * @param reader Reader
+ * @param expected Expected disc image
+ * @param seed Random seed
+ */
+void SparseDiscReaderTest::checkRandomReads(TestSparseReader *reader, const vector<uint8_t> &expected, uint32_t seed)
+{
+	for (unsigned int i = 0; i < 1024; i++) {
+		seed = (seed * 1664525U) + 1013904223U;
+		const size_t pos = seed % (expected.size() + BLOCK_SIZE);
+		seed = (seed * 1664525U) + 1013904223U;
+		// Mostly small reads, with some multi-block reads.
+		const size_t size = (i % 8 == 0)
+			? seed % (BLOCK_SIZE * 24)
+			: seed % (BLOCK_SIZE + 64);
+		ASSERT_NO_FATAL_FAILURE(checkRead(reader, expected, pos, size));
+	}
+}
+
+/**
+ * Random-offset reads of raw blocks must match a plain read.
+ */
+TEST_F(SparseDiscReaderTest, rawRandomReads)
+{
+	unique_ptr<TestSparseReader, DiscReaderUnrefDeleter> reader(createReader(true), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+	ASSERT_NO_FATAL_FAILURE(checkRandomReads(reader.get(), m_expectedRaw, 0x1234U));
+	// Repeat with a warm block cache.
+	ASSERT_NO_FATAL_FAILURE(checkRandomReads(reader.get(), m_expectedRaw, 0x1234U));
+}
+
+/**
+ * Random-offset reads of non-raw blocks must match a plain read.
+ */
+TEST_F(SparseDiscReaderTest, nonRawRandomReads)
+{
+	unique_ptr<TestSparseReader, DiscReaderUnrefDeleter> reader(createReader(false), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+	ASSERT_NO_FATAL_FAILURE(checkRandomReads(reader.get(), m_expectedNonRaw, 0x5678U));
+	// Repeat with a warm block cache.
+	ASSERT_NO_FATAL_FAILURE(checkRandomReads(reader.get(), m_expectedNonRaw, 0x5678U));
+}
+
+/**
+ * Sequential reads using read() must match a plain read.
+ */
+TEST_F(SparseDiscReaderTest, sequentialRead)
+{
+	unique_ptr<TestSparseReader, DiscReaderUnrefDeleter> reader(createReader(false), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+
+	vector<uint8_t> buf(m_expectedNonRaw.size() + 4096);
+	size_t total = 0;
+	static const size_t chunkSize = 1000;
+	for (;;) {
+		const size_t sz = reader->read(&buf[total], chunkSize);
+		total += sz;
+		if (sz != chunkSize)
+			break;
+	}
+	ASSERT_EQ(m_expectedNonRaw.size(), total);
+	EXPECT_EQ(0, memcmp(buf.data(), m_expectedNonRaw.data(), total));
+}
+
+/**
+ * Small reads from the same non-raw block only call readBlock() once,
+ * until the block is evicted from the cache.
+ */
+TEST_F(SparseDiscReaderTest, nonRawBlockCache)
+{
+	unique_ptr<TestSparseReader, DiscReaderUnrefDeleter> reader(createReader(false), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+
+	// Several small reads from block 0.
+	for (unsigned int i = 0; i < 8; i++) {
+		ASSERT_NO_FATAL_FAILURE(checkRead(reader.get(), m_expectedNonRaw, i * 300, 100));
+	}
+	EXPECT_EQ(1U, reader->readBlockCount);
+
+	// Read a small part of enough other blocks to evict block 0.
+	// NOTE: The cache holds at most 64 blocks.
+	for (unsigned int i = 1; i < BLOCK_COUNT; i++) {
+		ASSERT_NO_FATAL_FAILURE(checkRead(reader.get(), m_expectedNonRaw, (i * BLOCK_SIZE) + 16, 16));
+	}
+	reader->readBlockCount = 0;
+	ASSERT_NO_FATAL_FAILURE(checkRead(reader.get(), m_expectedNonRaw, 100, 100));
+	EXPECT_EQ(1U, reader->readBlockCount);
+
+	// The most recently used blocks are still cached.
+	reader->readBlockCount = 0;
+	ASSERT_NO_FATAL_FAILURE(checkRead(reader.get(), m_expectedNonRaw, ((BLOCK_COUNT - 2) * BLOCK_SIZE) + 32, 64));
+	EXPECT_EQ(0U, reader->readBlockCount);
+}
+
+/**
+ * Raw blocks are cached by physical address, so logical blocks
+ * that refer to the same physical block share a cache entry.
+ */
+TEST_F(SparseDiscReaderTest, rawBlockCacheByPhysAddr)
+{
+	unique_ptr<TestSparseReader, DiscReaderUnrefDeleter> reader(createReader(true), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+
+	// Logical blocks 10-13 and 22-23 are all physical block 8.
+	ASSERT_NO_FATAL_FAILURE(checkRead(reader.get(), m_expectedRaw, (10 * BLOCK_SIZE) + 8, 32));
+	EXPECT_EQ(1U, reader->readBlockCount);
+	static const unsigned int dupBlocks[] = {11, 12, 13, 22, 23};
+	for (unsigned int blockIdx : dupBlocks) {
+		ASSERT_NO_FATAL_FAILURE(checkRead(reader.get(), m_expectedRaw, (blockIdx * BLOCK_SIZE) + 100, 200));
+	}
+	EXPECT_EQ(1U, reader->readBlockCount);
+}
+
+/**
+ * Raw blocks that are consecutive in the file are read
+ * using a single request, even if the read isn't aligned.
+ */
+TEST_F(SparseDiscReaderTest, rawCoalescedRead)
+{
+	unique_ptr<TestSparseReader, DiscReaderUnrefDeleter> reader(createReader(true), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+
+	// Logical blocks 24-40 are physical blocks 17-33.
+	const size_t pos = (24 * BLOCK_SIZE) + 100;
+	const size_t size = (16 * BLOCK_SIZE) + 200;
+	ASSERT_NO_FATAL_FAILURE(checkRead(reader.get(), m_expectedRaw, pos, size));
+	EXPECT_EQ(1U, m_file->reqCount);
+	EXPECT_EQ(size, m_file->bytesRead);
+	EXPECT_EQ(0U, reader->readBlockCount);
+}
+
+/**
+ * Full raw blocks that refer to the same physical block are only read once.
+ */
+TEST_F(SparseDiscReaderTest, rawDeduplicatedRead)
+{
+	unique_ptr<TestSparseReader, DiscReaderUnrefDeleter> reader(createReader(true), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+
+	// Logical blocks 10-13 are all physical block 8.
+	ASSERT_NO_FATAL_FAILURE(checkRead(reader.get(), m_expectedRaw, 10 * BLOCK_SIZE, 4 * BLOCK_SIZE));
+	EXPECT_EQ(1U, m_file->reqCount);
+	EXPECT_EQ(static_cast<size_t>(BLOCK_SIZE), m_file->bytesRead);
+}
+
+/**
+ * A read spanning consecutive, empty, deduplicated, and out-of-order
+ * raw blocks only requests each physical block once, and only
+ * merges requests for blocks that are consecutive in the file.
+ */
+TEST_F(SparseDiscReaderTest, rawMixedRead)
+{
+	unique_ptr<TestSparseReader, DiscReaderUnrefDeleter> reader(createReader(true), DiscReaderUnrefDeleter());
+	ASSERT_TRUE(reader->isOpen());
+
+	// Logical blocks 0-23:
+	// - 0-7: One request. (physical blocks 0-7)
+	// - 8-9: Empty. (no request)
+	// - 10-13: One request. (physical block 8; not merged with 0-7 due to the gap)
+	// - 14-21: One request per block. (reversed)
+	// - 22-23: No request. (physical block 8 was already read)
+	ASSERT_NO_FATAL_FAILURE(checkRead(reader.get(), m_expectedRaw, 0, 24 * BLOCK_SIZE));
+	EXPECT_EQ(1U + 1U + 8U, m_file->reqCount);
+	EXPECT_EQ(static_cast<size_t>(8 + 1 + 8) * BLOCK_SIZE, m_file->bytesRead);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: SparseDiscReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
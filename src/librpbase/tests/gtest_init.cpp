@@ -55,6 +55,10 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		SCMP_SYS(mprotect),	// iconv_open()
 		SCMP_SYS(munmap),	// free() [in some cases]
 		SCMP_SYS(lseek), SCMP_SYS(_llseek),
+		SCMP_SYS(madvise),	// LibRpFile::RpFile::adviseAccess() [FM_MMAP]
+		SCMP_SYS(statfs), SCMP_SYS(statfs64),	// LibRpFile::FileSystem::isOnBadFS() [FM_MMAP]
+		SCMP_SYS(fadvise64), SCMP_SYS(fadvise64_64),	// LibRpFile::RpFile::adviseAccess()
+		SCMP_SYS(pread64), SCMP_SYS(preadv),	// LibRpFile::RpFile::readAt(), readBatch()
 		SCMP_SYS(open),		// Ubuntu 16.04
 		SCMP_SYS(openat),	// glibc-2.31
 #if defined(__SNR_openat2)
@@ -68,6 +72,23 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 					// - testing::internal::UnitTestImpl::AddTestInfo()
 		SCMP_SYS(ioctl),	// testing::internal::posix::IsATTY()
 
+		// XdgThumbnailCacheTest
+		SCMP_SYS(access),	// FileSystem::access()
+		SCMP_SYS(mkdir), SCMP_SYS(mkdirat),	// FileSystem::rmkdir(), mkdtemp()
+		SCMP_SYS(ftruncate), SCMP_SYS(ftruncate64),	// RpFile::truncate() [RpPngWriter]
+		SCMP_SYS(rmdir), SCMP_SYS(unlink), SCMP_SYS(unlinkat),	// test cleanup
+#ifdef __SNR_getrandom
+		SCMP_SYS(getrandom),	// mkdtemp() [glibc-2.36]
+#endif /* __SNR_getrandom */
+
+		// NegativeDetectCacheTest
+		SCMP_SYS(rename), SCMP_SYS(renameat),	// NegativeDetectCache::rewriteCache(), test renames
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),	// glibc-2.28+ on architectures without renameat()
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(getpid),	// NegativeDetectCache::rewriteCache() [temporary filename]
+		SCMP_SYS(utimensat),	// test mtime changes
+
 		// MiniZip
 		SCMP_SYS(close),	// mktime() [mz_zip_dosdate_to_time_t()]
 		SCMP_SYS(stat), SCMP_SYS(stat64),	// mktime() [mz_zip_dosdate_to_time_t()]
@@ -76,6 +97,9 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		// TODO: Restrict connect() to AF_UNIX.
 		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
 
+#if defined(__SNR_io_uring_setup) || defined(__NR_io_uring_setup)
+		SCMP_SYS(io_uring_setup), SCMP_SYS(io_uring_enter),	// LibRpFile::IoUring
+#endif /* __SNR_io_uring_setup || __NR_io_uring_setup */
 #if defined(__SNR_statx) || defined(__NR_statx)
 		//SCMP_SYS(getcwd),	// called by glibc's statx() [referenced above]
 		SCMP_SYS(statx),
@@ -94,7 +118,8 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 #else
 	param.dummy = 0;
 #endif
-	rp_secure_enable(param);
+	// NOTE: Some tests use LibRpThreads::ThreadPool.
+	rp_secure_enable_ex(param, RP_SECURE_PROFILE_PARALLEL);
 
 #ifdef _WIN32
 	// Initialize GDI+.
@@ -0,0 +1,216 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * PngBenchmark.cpp: RpPngWriter and RpPng benchmarks.                     *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Benchmark
+#include <benchmark/benchmark.h>
+#include "common.h"
+
+// librpbase, librpfile, librptexture
+#include "librpbase/img/RpPng.hpp"
+#include "librpbase/img/RpPngWriter.hpp"
+#include "librpfile/RpMemFile.hpp"
+#include "librpfile/RpVectorFile.hpp"
+#include "librptexture/img/rp_image.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+using LibRpTexture::rp_image;
+
+// zlib
+#include <zlib.h>
+
+// C includes.
+#include <stdint.h>
+#include <stdio.h>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRpBase { namespace Benchmarks {
+
+/**
+ * Create a thumbnail-like test image.
+ * The image has smooth gradients, flat areas, and some noise,
+ * so it compresses roughly like a typical thumbnail.
+ * @param size Image width and height.
+ * @param format Image format. (ARGB32 or CI8)
+ * @return rp_image.
+ */
+static rp_image *createTestImage(int size, rp_image::Format format)
+{
+	rp_image *const img = new rp_image(size, size, format);
+	if (format == rp_image::Format::CI8) {
+		uint32_t *const palette = img->palette();
+		for (int i = 0; i < img->palette_len(); i++) {
+			palette[i] = 0xFF000000U | (i << 16) | ((255 - i) << 8) | ((i * 3) & 0xFF);
+		}
+	}
+
+	uint32_t x = 0x12345678;
+	for (int y = 0; y < size; y++) {
+		uint8_t *const line8 = static_cast<uint8_t*>(img->scanLine(y));
+		uint32_t *const line32 = static_cast<uint32_t*>(img->scanLine(y));
+		for (int px = 0; px < size; px++) {
+			// xorshift32
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+
+			uint32_t argb;
+			if (y < size / 4) {
+				// Flat border area.
+				argb = 0x00000000;
+			} else if (px < size / 2) {
+				// Gradient.
+				argb = 0xFF000000U | ((px * 255 / size) << 16) | ((y * 255 / size) << 8) | 0x40;
+			} else {
+				// Gradient with some noise.
+				argb = 0xFF000000U | ((px * 255 / size) << 8) | ((x & 0x0F0F0F) + (y & 0xC0));
+			}
+
+			if (format == rp_image::Format::CI8) {
+				line8[px] = static_cast<uint8_t>((argb >> 8) ^ argb);
+			} else {
+				line32[px] = argb;
+			}
+		}
+	}
+	return img;
+}
+
+/**
+ * Encode an rp_image as PNG.
+ * @param img rp_image.
+ * @param profile Compression profile.
+ * @return PNG data, or an empty vector on error.
+ */
+static vector<uint8_t> encodePng(const rp_image *img, RpPngWriter::Profile profile)
+{
+	vector<uint8_t> ret;
+	RpVectorFile *const file = new RpVectorFile();
+	RpPngWriter *const pngWriter = new RpPngWriter(file, img);
+	if (pngWriter->isOpen()) {
+		pngWriter->setProfile(profile);
+		if (pngWriter->write_IHDR() == 0 && pngWriter->write_IDAT() == 0) {
+			pngWriter->close();
+			ret = file->vector();
+		}
+	}
+	delete pngWriter;
+	file->unref();
+	return ret;
+}
+
+/**
+ * Report the throughput of a benchmark in MPix/s.
+ * This is shown as "MPix=###/s" in the console output.
+ * @param state Benchmark state.
+ * @param pixels Number of pixels processed per iteration.
+ */
+static void setPixelRate(benchmark::State &state, int64_t pixels)
+{
+	state.counters["MPix"] = benchmark::Counter(
+		static_cast<double>(state.iterations() * pixels) / 1000000.0,
+		benchmark::Counter::kIsRate);
+}
+
+/**
+ * Thumbnail sizes used for each benchmark.
+ * These are the XDG thumbnail cache sizes: normal, large, x-large.
+ * @param b Benchmark.
+ */
+static void thumbnailSizes(benchmark::internal::Benchmark *b)
+{
+	b->Arg(128)->Arg(256)->Arg(512);
+}
+
+/** Benchmarks **/
+
+/**
+ * Benchmark writing a PNG image.
+ * @param state Benchmark state. (range(0) == image size)
+ * @param format Image format.
+ * @param profile Compression profile.
+ */
+static void BM_PngWrite(benchmark::State &state, rp_image::Format format, RpPngWriter::Profile profile)
+{
+	const int size = static_cast<int>(state.range(0));
+	rp_image *const img = createTestImage(size, format);
+
+	size_t png_size = 0;
+	for (auto _ : state) {
+		const vector<uint8_t> png = encodePng(img, profile);
+		if (png.empty()) {
+			state.SkipWithError("RpPngWriter failed.");
+			break;
+		}
+		png_size = png.size();
+	}
+
+	setPixelRate(state, static_cast<int64_t>(size) * size);
+	state.counters["PNG_bytes"] = static_cast<double>(png_size);
+	img->unref();
+}
+BENCHMARK_CAPTURE(BM_PngWrite, ARGB32_Default, rp_image::Format::ARGB32, RpPngWriter::Profile::Default)->Apply(thumbnailSizes);
+BENCHMARK_CAPTURE(BM_PngWrite, ARGB32_Fast, rp_image::Format::ARGB32, RpPngWriter::Profile::Fast)->Apply(thumbnailSizes);
+BENCHMARK_CAPTURE(BM_PngWrite, CI8_Default, rp_image::Format::CI8, RpPngWriter::Profile::Default)->Apply(thumbnailSizes);
+BENCHMARK_CAPTURE(BM_PngWrite, CI8_Fast, rp_image::Format::CI8, RpPngWriter::Profile::Fast)->Apply(thumbnailSizes);
+
+/**
+ * Benchmark reading a PNG image.
+ * @param state Benchmark state. (range(0) == image size)
+ * @param format Image format.
+ * @param profile Compression profile used to write the image.
+ */
+static void BM_PngRead(benchmark::State &state, rp_image::Format format, RpPngWriter::Profile profile)
+{
+	const int size = static_cast<int>(state.range(0));
+	rp_image *const img = createTestImage(size, format);
+	const vector<uint8_t> png = encodePng(img, profile);
+	img->unref();
+	if (png.empty()) {
+		state.SkipWithError("RpPngWriter failed.");
+		return;
+	}
+
+	for (auto _ : state) {
+		RpMemFile *const file = new RpMemFile(png.data(), png.size());
+		rp_image *const dec = RpPng::load(file);
+		file->unref();
+		if (!dec) {
+			state.SkipWithError("RpPng::load() failed.");
+			break;
+		}
+		dec->unref();
+	}
+
+	setPixelRate(state, static_cast<int64_t>(size) * size);
+}
+BENCHMARK_CAPTURE(BM_PngRead, ARGB32_Default, rp_image::Format::ARGB32, RpPngWriter::Profile::Default)->Apply(thumbnailSizes);
+BENCHMARK_CAPTURE(BM_PngRead, ARGB32_Fast, rp_image::Format::ARGB32, RpPngWriter::Profile::Fast)->Apply(thumbnailSizes);
+
+} }
+
+/**
+ * Benchmark suite main function.
+ */
+int main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRpBase benchmark suite: RpPngWriter and RpPng.\n\n");
+	fflush(nullptr);
+
+	// Show which zlib implementation is in use.
+	// zlib-ng in zlib-compatible mode reports e.g. "1.2.11.zlib-ng".
+	::benchmark::AddCustomContext("zlib", zlibVersion());
+
+	::benchmark::Initialize(&argc, argv);
+	if (::benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
@@ -985,6 +985,37 @@ TEST_P(RpPngFormatTest, loadTest)
 	}
 }
 
+/**
+ * Run an RpImageLoader::probe() test.
+ */
+TEST_P(RpPngFormatTest, probeTest)
+{
+	const RpPngFormatTest_mode &mode = GetParam();
+
+	// Create an RpMemFile.
+	unique_RefBase<RpMemFile> png_mem_file(new RpMemFile(m_png_buf.data(), m_png_buf.size()));
+	ASSERT_TRUE(png_mem_file->isOpen());
+
+	// Probe the PNG image.
+	RpImageLoader::ImageInfo info;
+	ASSERT_EQ(0, RpImageLoader::probe(png_mem_file.get(), &info));
+
+	// Check the image information.
+	EXPECT_EQ(RpImageLoader::FileType::PNG, info.fileType);
+	EXPECT_EQ((int)mode.ihdr.width, info.width);
+	EXPECT_EQ((int)mode.ihdr.height, info.height);
+	EXPECT_EQ(mode.ihdr.bit_depth, info.bitDepth);
+	if (mode.ihdr.color_type == PNG_COLOR_TYPE_PALETTE) {
+		EXPECT_TRUE(info.isPaletted);
+		EXPECT_EQ(1U, info.channels);
+		EXPECT_GT(info.palette_len, 0U);
+		EXPECT_LE(info.palette_len, 1U << info.bitDepth);
+	} else {
+		EXPECT_FALSE(info.isPaletted);
+		EXPECT_EQ(0U, info.palette_len);
+	}
+}
+
 /**
  * Test case suffix generator.
  * @param info Test parameter information.
@@ -0,0 +1,90 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * byteswap_neon.c: Byteswapping functions.                                *
+ * NEON-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2008-2020 by David Korth                                  *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "byteswap_rp.h"
+
+// C includes.
+#include <assert.h>
+
+// NOTE: On 32-bit ARM, NEON is only used if it's
+// part of the compiler's baseline.
+#ifdef BYTESWAP_HAS_NEON
+
+// NEON intrinsics.
+#include <arm_neon.h>
+
+/**
+ * 16-bit byteswap function.
+ * NEON-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 16-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 2; an extra odd byte will be ignored.)
+ */
+void __byte_swap_16_array_neon(uint16_t *ptr, size_t n)
+{
+	// Verify the block is 16-bit aligned
+	// and is a multiple of 2 bytes.
+	assert(((uintptr_t)ptr & 1) == 0);
+	assert((n & 1) == 0);
+	n &= ~1;
+
+	// NEON loads and stores don't require 16-byte alignment,
+	// so there's no need to swap WORDs manually first.
+
+	// Process 16 WORDs per iteration using NEON.
+	for (; n >= 32; n -= 32, ptr += 16) {
+		uint8_t *const u8_ptr = (uint8_t*)ptr;
+
+		const uint8x16_t v0 = vld1q_u8(&u8_ptr[0]);
+		const uint8x16_t v1 = vld1q_u8(&u8_ptr[16]);
+
+		vst1q_u8(&u8_ptr[0], vrev16q_u8(v0));
+		vst1q_u8(&u8_ptr[16], vrev16q_u8(v1));
+	}
+
+	// Process the remaining data, one WORD at a time.
+	for (; n > 0; n -= 2, ptr++) {
+		*ptr = __swab16(*ptr);
+	}
+}
+
+/**
+ * 32-bit byteswap function.
+ * NEON-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 32-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 4; extra bytes will be ignored.)
+ */
+void __byte_swap_32_array_neon(uint32_t *ptr, size_t n)
+{
+	// Verify the block is 32-bit aligned
+	// and is a multiple of 4 bytes.
+	assert(((uintptr_t)ptr & 3) == 0);
+	assert((n & 3) == 0);
+	n &= ~3;
+
+	// NEON loads and stores don't require 16-byte alignment,
+	// so there's no need to swap DWORDs manually first.
+
+	// Process 8 DWORDs per iteration using NEON.
+	for (; n >= 32; n -= 32, ptr += 8) {
+		uint8_t *const u8_ptr = (uint8_t*)ptr;
+
+		const uint8x16_t v0 = vld1q_u8(&u8_ptr[0]);
+		const uint8x16_t v1 = vld1q_u8(&u8_ptr[16]);
+
+		vst1q_u8(&u8_ptr[0], vrev32q_u8(v0));
+		vst1q_u8(&u8_ptr[16], vrev32q_u8(v1));
+	}
+
+	// Process the remaining data, one DWORD at a time.
+	for (; n > 0; n -= 4, ptr++) {
+		*ptr = __swab32(*ptr);
+	}
+}
+
+#endif /* BYTESWAP_HAS_NEON */
@@ -30,10 +30,19 @@
 # endif
 # define BYTESWAP_HAS_SSE2 1
 # define BYTESWAP_HAS_SSSE3 1
+# define BYTESWAP_HAS_AVX2 1
 #endif
 #ifdef RP_CPU_AMD64
 # define BYTESWAP_ALWAYS_HAS_SSE2 1
 #endif
+#if defined(RP_CPU_ARM64) || \
+    (defined(RP_CPU_ARM) && (defined(__ARM_NEON) || defined(__ARM_NEON__)))
+/* NEON is always available on ARM64. On 32-bit ARM, */
+/* only use it if it's part of the compiler's baseline. */
+# include "cpuflags_arm.h"
+# define BYTESWAP_HAS_NEON 1
+# define BYTESWAP_ALWAYS_HAS_NEON 1
+#endif
 
 #if defined(_MSC_VER)
 
@@ -186,6 +195,42 @@ void __byte_swap_16_array_ssse3(uint16_t *ptr, size_t n);
 void __byte_swap_32_array_ssse3(uint32_t *ptr, size_t n);
 #endif /* BYTESWAP_HAS_SSSE3 */
 
+#ifdef BYTESWAP_HAS_AVX2
+/**
+ * 16-bit byteswap function.
+ * AVX2-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 16-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 2; an extra odd byte will be ignored.)
+ */
+void __byte_swap_16_array_avx2(uint16_t *ptr, size_t n);
+
+/**
+ * 32-bit byteswap function.
+ * AVX2-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 32-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 4; extra bytes will be ignored.)
+ */
+void __byte_swap_32_array_avx2(uint32_t *ptr, size_t n);
+#endif /* BYTESWAP_HAS_AVX2 */
+
+#ifdef BYTESWAP_HAS_NEON
+/**
+ * 16-bit byteswap function.
+ * NEON-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 16-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 2; an extra odd byte will be ignored.)
+ */
+void __byte_swap_16_array_neon(uint16_t *ptr, size_t n);
+
+/**
+ * 32-bit byteswap function.
+ * NEON-optimized version.
+ * @param ptr Pointer to array to swap. (MUST be 32-bit aligned!)
+ * @param n Number of bytes to swap. (Must be divisible by 4; extra bytes will be ignored.)
+ */
+void __byte_swap_32_array_neon(uint32_t *ptr, size_t n);
+#endif /* BYTESWAP_HAS_NEON */
+
 #if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /* System has IFUNC. Use it for dispatching. */
 
@@ -213,6 +258,14 @@ void __byte_swap_32_array(uint32_t *ptr, size_t n);
  */
 static inline void __byte_swap_16_array(uint16_t *ptr, size_t n)
 {
+# ifdef BYTESWAP_ALWAYS_HAS_NEON
+	__byte_swap_16_array_neon(ptr, n);
+# else /* !BYTESWAP_ALWAYS_HAS_NEON */
+# ifdef BYTESWAP_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		__byte_swap_16_array_avx2(ptr, n);
+	} else
+# endif /* BYTESWAP_HAS_AVX2 */
 # ifdef BYTESWAP_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		__byte_swap_16_array_ssse3(ptr, n);
@@ -238,6 +291,7 @@ static inline void __byte_swap_16_array(uint16_t *ptr, size_t n)
 		__byte_swap_16_array_c(ptr, n);
 	}
 # endif /* BYTESWAP_ALWAYS_HAS_SSE2 */
+# endif /* BYTESWAP_ALWAYS_HAS_NEON */
 }
 
 /**
@@ -247,6 +301,14 @@ static inline void __byte_swap_16_array(uint16_t *ptr, size_t n)
  */
 static inline void __byte_swap_32_array(uint32_t *ptr, size_t n)
 {
+# ifdef BYTESWAP_ALWAYS_HAS_NEON
+	__byte_swap_32_array_neon(ptr, n);
+# else /* !BYTESWAP_ALWAYS_HAS_NEON */
+# ifdef BYTESWAP_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		__byte_swap_32_array_avx2(ptr, n);
+	} else
+# endif /* BYTESWAP_HAS_AVX2 */
 # ifdef BYTESWAP_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		__byte_swap_32_array_ssse3(ptr, n);
@@ -273,6 +335,7 @@ static inline void __byte_swap_32_array(uint32_t *ptr, size_t n)
 		__byte_swap_32_array_c(ptr, n);
 	}
 # endif /* !BYTESWAP_ALWAYS_HAS_SSE2 */
+# endif /* BYTESWAP_ALWAYS_HAS_NEON */
 }
 
 #endif /* RP_HAS_IFUNC && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64)) */
@@ -0,0 +1,313 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * byteswap_struct.hpp: Compile-time struct byteswapping.                  *
+ *                                                                         *
+ * Copyright (c) 2008-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPCPU_BYTESWAP_STRUCT_HPP__
+#define __ROMPROPERTIES_LIBRPCPU_BYTESWAP_STRUCT_HPP__
+
+#ifndef __cplusplus
+# error byteswap_struct.hpp is C++ only.
+#endif
+
+#include "byteswap_rp.h"
+
+// C includes. (C++ namespace)
+#include <cstddef>
+#include <cstring>
+
+// C++ includes.
+#include <type_traits>
+
+/**
+ * On-disk structs are described once as a list of fields
+ * that need to be byteswapped:
+ *
+ * RP_BYTESWAP_LAYOUT(GczHeader,
+ *	RP_BYTESWAP_FIELD(GczHeader, magic),
+ *	RP_BYTESWAP_FIELD(GczHeader, sub_type),
+ *	...
+ * )
+ *
+ * Field sizes are taken from the field types, so an incorrect
+ * size can't be specified by accident. Byte fields can be omitted.
+ * Arrays of 16-bit and 32-bit fields use the SIMD byteswap functions.
+ * Nested structs use RP_BYTESWAP_NESTED() and need their own layout.
+ *
+ * RP_BYTESWAP_LAYOUT() must be used in the global namespace.
+ *
+ * le_struct_to_cpu() and be_struct_to_cpu() convert a struct in place.
+ * If the struct is already in host byte order, they compile to nothing.
+ */
+
+namespace LibRpCpu { namespace ByteSwap {
+
+/**
+ * Byteswap a single value in place.
+ * memcpy() is used, since on-disk structs might be packed.
+ * @tparam Size Value size, in bytes.
+ */
+template<size_t Size>
+struct SwapValue;
+
+template<>
+struct SwapValue<1> {
+	static inline void swap(uint8_t *p) { ((void)p); }
+};
+
+template<>
+struct SwapValue<2> {
+	static inline void swap(uint8_t *p)
+	{
+		uint16_t v;
+		memcpy(&v, p, sizeof(v));
+		v = __swab16(v);
+		memcpy(p, &v, sizeof(v));
+	}
+};
+
+template<>
+struct SwapValue<4> {
+	static inline void swap(uint8_t *p)
+	{
+		uint32_t v;
+		memcpy(&v, p, sizeof(v));
+		v = __swab32(v);
+		memcpy(p, &v, sizeof(v));
+	}
+};
+
+template<>
+struct SwapValue<8> {
+	static inline void swap(uint8_t *p)
+	{
+		uint64_t v;
+		memcpy(&v, p, sizeof(v));
+		v = __swab64(v);
+		memcpy(p, &v, sizeof(v));
+	}
+};
+
+// Minimum number of array elements to use the SIMD byteswap functions.
+static const size_t SWAP_ARRAY_MIN_COUNT = 16;
+
+/**
+ * Byteswap an array of values in place.
+ * @tparam Size Value size, in bytes.
+ * @tparam Count Number of values.
+ * @param p Pointer to the first value.
+ */
+template<size_t Size, size_t Count>
+static inline void swapArray(uint8_t *p)
+{
+	if (Count >= SWAP_ARRAY_MIN_COUNT && (Size == 2 || Size == 4) &&
+	    (reinterpret_cast<uintptr_t>(p) % Size) == 0)
+	{
+		// Large, aligned array. Use the SIMD byteswap functions.
+		if (Size == 2) {
+			__byte_swap_16_array(reinterpret_cast<uint16_t*>(p), Size * Count);
+		} else {
+			__byte_swap_32_array(reinterpret_cast<uint32_t*>(p), Size * Count);
+		}
+		return;
+	}
+
+	for (size_t i = 0; i < Count; i++, p += Size) {
+		SwapValue<Size>::swap(p);
+	}
+}
+
+/**
+ * Field descriptor. Use RP_BYTESWAP_FIELD().
+ * @tparam Offset Field offset.
+ * @tparam T Field type. (integer, enum, float, or an array of these)
+ */
+template<size_t Offset, typename T>
+struct Field {
+	typedef typename std::remove_all_extents<T>::type elem_t;
+	static_assert(std::is_arithmetic<elem_t>::value || std::is_enum<elem_t>::value,
+		"Use RP_BYTESWAP_NESTED() for nested structs.");
+	static_assert(sizeof(elem_t) == 1 || sizeof(elem_t) == 2 ||
+		      sizeof(elem_t) == 4 || sizeof(elem_t) == 8,
+		"Unsupported field size.");
+
+	static const size_t count = sizeof(T) / sizeof(elem_t);
+
+	static inline void swap(uint8_t *s)
+	{
+		swapArray<sizeof(elem_t), count>(s + Offset);
+	}
+};
+
+/**
+ * Struct layout. Specialized using RP_BYTESWAP_LAYOUT().
+ * @tparam T Struct type.
+ */
+template<typename T>
+struct StructLayout;
+
+/**
+ * Nested struct descriptor. Use RP_BYTESWAP_NESTED().
+ * @tparam Offset Field offset.
+ * @tparam T Nested struct type. (must have its own layout)
+ */
+template<size_t Offset, typename T>
+struct Nested {
+	static const size_t count = 1;
+
+	static inline void swap(uint8_t *s)
+	{
+		StructLayout<T>::swap(s + Offset);
+	}
+};
+
+/**
+ * List of fields.
+ * @tparam Fields Field descriptors.
+ */
+template<typename... Fields>
+struct Layout;
+
+template<>
+struct Layout<> {
+	static const size_t field_count = 0;
+	static inline void swap(uint8_t *s) { ((void)s); }
+};
+
+template<typename F, typename... Rest>
+struct Layout<F, Rest...> {
+	// NOTE: Referencing F::count ensures the field
+	// descriptor is validated on all architectures.
+	static const size_t field_count = (F::count > 0) + Layout<Rest...>::field_count;
+
+	static inline void swap(uint8_t *s)
+	{
+		F::swap(s);
+		Layout<Rest...>::swap(s);
+	}
+};
+
+/**
+ * Byteswap a struct in place, regardless of host byte order.
+ * @param s Struct.
+ */
+template<typename T>
+static inline void swap_struct(T &s)
+{
+	StructLayout<T>::swap(reinterpret_cast<uint8_t*>(&s));
+}
+
+/**
+ * Byteswap an array of structs in place, regardless of host byte order.
+ * @param s Array of structs.
+ * @param count Number of structs.
+ */
+template<typename T>
+static inline void swap_struct_array(T *s, size_t count)
+{
+	for (; count > 0; count--, s++) {
+		StructLayout<T>::swap(reinterpret_cast<uint8_t*>(s));
+	}
+}
+
+} }
+
+/**
+ * Define the byteswap layout for a struct.
+ * @param type Struct type.
+ * @param ... Fields. (RP_BYTESWAP_FIELD(), RP_BYTESWAP_NESTED())
+ */
+#define RP_BYTESWAP_LAYOUT(type, ...) \
+	namespace LibRpCpu { namespace ByteSwap { \
+		template<> struct StructLayout<type> : public Layout<__VA_ARGS__> { \
+			static_assert(std::is_standard_layout<type>::value, \
+				#type " must be a standard-layout type."); \
+			static_assert(Layout<__VA_ARGS__>::field_count > 0, \
+				#type " has no fields."); \
+		}; \
+	} }
+
+/**
+ * Field to byteswap.
+ * @param type Struct type.
+ * @param field Field name.
+ */
+#define RP_BYTESWAP_FIELD(type, field) \
+	LibRpCpu::ByteSwap::Field<offsetof(type, field), decltype(type::field)>
+
+/**
+ * Nested struct to byteswap.
+ * @param type Struct type.
+ * @param field Field name.
+ */
+#define RP_BYTESWAP_NESTED(type, field) \
+	LibRpCpu::ByteSwap::Nested<offsetof(type, field), decltype(type::field)>
+
+/**
+ * Convert a little-endian struct to host-endian in place.
+ * @param s Struct.
+ */
+template<typename T>
+static inline void le_struct_to_cpu(T &s)
+{
+#if SYS_BYTEORDER == SYS_BIG_ENDIAN
+	LibRpCpu::ByteSwap::swap_struct(s);
+#else /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
+	static_assert(LibRpCpu::ByteSwap::StructLayout<T>::field_count > 0, "No layout.");
+	((void)s);
+#endif
+}
+
+/**
+ * Convert an array of little-endian structs to host-endian in place.
+ * @param s Array of structs.
+ * @param count Number of structs.
+ */
+template<typename T>
+static inline void le_struct_array_to_cpu(T *s, size_t count)
+{
+#if SYS_BYTEORDER == SYS_BIG_ENDIAN
+	LibRpCpu::ByteSwap::swap_struct_array(s, count);
+#else /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
+	static_assert(LibRpCpu::ByteSwap::StructLayout<T>::field_count > 0, "No layout.");
+	((void)s);
+	((void)count);
+#endif
+}
+
+/**
+ * Convert a big-endian struct to host-endian in place.
+ * @param s Struct.
+ */
+template<typename T>
+static inline void be_struct_to_cpu(T &s)
+{
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
+	LibRpCpu::ByteSwap::swap_struct(s);
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+	static_assert(LibRpCpu::ByteSwap::StructLayout<T>::field_count > 0, "No layout.");
+	((void)s);
+#endif
+}
+
+/**
+ * Convert an array of big-endian structs to host-endian in place.
+ * @param s Array of structs.
+ * @param count Number of structs.
+ */
+template<typename T>
+static inline void be_struct_array_to_cpu(T *s, size_t count)
+{
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
+	LibRpCpu::ByteSwap::swap_struct_array(s, count);
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+	static_assert(LibRpCpu::ByteSwap::StructLayout<T>::field_count > 0, "No layout.");
+	((void)s);
+	((void)count);
+#endif
+}
+
+#endif /* __ROMPROPERTIES_LIBRPCPU_BYTESWAP_STRUCT_HPP__ */
@@ -0,0 +1,90 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * cpuflags_arm.c: ARM CPU flags detection.                                *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "cpuflags_arm.h"
+#include "config.librpcpu.h"
+
+#if !defined(__arm__) && !defined(__thumb__) && !defined(__arm) && \
+    !defined(_ARM) && !defined(_M_ARM) && !defined(__aarch64__)
+#error Do not compile cpuflags_arm.c on non-ARM CPUs!
+#endif
+
+// librpthreads
+#include "librpthreads/pthread_once.h"
+
+// Linux: CPU features are reported in the ELF auxiliary vector.
+#ifdef HAVE_SYS_AUXV_H
+# include <sys/auxv.h>
+#endif
+
+// HWCAP bits. (Linux)
+// References:
+// - arch/arm64/include/uapi/asm/hwcap.h
+// - arch/arm/include/uapi/asm/hwcap.h
+#ifdef __aarch64__
+# define RP_HWCAP_CRC32		(1UL << 7)	/* AT_HWCAP */
+#else
+# define RP_HWCAP_NEON		(1UL << 12)	/* AT_HWCAP */
+# define RP_HWCAP2_CRC32	(1UL << 4)	/* AT_HWCAP2 */
+#endif
+
+uint32_t RP_CPU_Flags = 0;
+int RP_CPU_Flags_Init = 0;	// 1 if RP_CPU_Flags has been initialized.
+
+/**
+ * Initialize RP_CPU_Flags. (internal function)
+ * Called by pthread_once().
+ */
+static void RP_CPU_InitCPUFlags_int(void)
+{
+	// Make sure the CPU flags variable is empty.
+	RP_CPU_Flags = 0;
+
+#ifdef __aarch64__
+	// NEON (Advanced SIMD) is required on ARM64.
+	RP_CPU_Flags |= RP_CPUFLAG_ARM_NEON;
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	// Compiled with NEON as part of the baseline.
+	RP_CPU_Flags |= RP_CPUFLAG_ARM_NEON;
+#endif
+
+#if defined(__APPLE__) && defined(__aarch64__)
+	// All Apple ARM64 CPUs support ARMv8.1 or later,
+	// which requires the CRC32 instructions.
+	RP_CPU_Flags |= RP_CPUFLAG_ARM_CRC32;
+#elif defined(HAVE_SYS_AUXV_H)
+# ifdef __aarch64__
+	if (getauxval(AT_HWCAP) & RP_HWCAP_CRC32) {
+		RP_CPU_Flags |= RP_CPUFLAG_ARM_CRC32;
+	}
+# else /* !__aarch64__ */
+	if (getauxval(AT_HWCAP) & RP_HWCAP_NEON) {
+		RP_CPU_Flags |= RP_CPUFLAG_ARM_NEON;
+	}
+#  ifdef AT_HWCAP2
+	if (getauxval(AT_HWCAP2) & RP_HWCAP2_CRC32) {
+		RP_CPU_Flags |= RP_CPUFLAG_ARM_CRC32;
+	}
+#  endif /* AT_HWCAP2 */
+# endif /* __aarch64__ */
+#endif
+	// TODO: Windows on ARM: IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE)
+	// TODO: Windows on ARM: IsProcessorFeaturePresent(PF_ARM_NEON_INSTRUCTIONS_AVAILABLE)
+
+	// CPU flags initialized.
+	RP_CPU_Flags_Init = 1;
+}
+
+/**
+ * Initialize RP_CPU_Flags.
+ */
+void RP_CPU_InitCPUFlags(void)
+{
+	static pthread_once_t once_control = PTHREAD_ONCE_INIT;
+	pthread_once(&once_control, RP_CPU_InitCPUFlags_int);
+}
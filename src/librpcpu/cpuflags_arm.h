@@ -0,0 +1,72 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * cpuflags_arm.h: ARM CPU flags detection.                                *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPCPU_CPUFLAGS_ARM_H__
+#define __ROMPROPERTIES_LIBRPCPU_CPUFLAGS_ARM_H__
+
+#include <stdint.h>
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* CPU flags (ARM/ARM64) */
+#if defined(__arm__) || defined(__thumb__) || defined(__arm) || \
+    defined(_ARM) || defined(_M_ARM) || defined(__aarch64__)
+
+// Set of CPU flags we check for right now.
+// More flags will be added if needed.
+#define RP_CPUFLAG_ARM_CRC32		((uint32_t)(1U << 0))
+#define RP_CPUFLAG_ARM_NEON		((uint32_t)(1U << 1))
+
+#endif /* ARM */
+
+// Don't modify these!
+extern uint32_t RP_CPU_Flags;
+extern int RP_CPU_Flags_Init;	// 1 if RP_CPU_Flags has been initialized.
+
+/**
+ * Initialize RP_CPU_Flags.
+ */
+void RP_CPU_InitCPUFlags(void);
+
+/**
+ * Check if the CPU supports the ARMv8 CRC32 instructions.
+ * @return Non-zero if CRC32 is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasCRC32(void)
+{
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_ARM_CRC32);
+}
+
+/**
+ * Check if the CPU supports NEON (Advanced SIMD).
+ * NOTE: NEON is always available on ARM64.
+ * @return Non-zero if NEON is supported; 0 if not.
+ */
+static FORCEINLINE int RP_CPU_HasNEON(void)
+{
+#ifdef __aarch64__
+	return 1;
+#else /* !__aarch64__ */
+	if (unlikely(!RP_CPU_Flags_Init)) {
+		RP_CPU_InitCPUFlags();
+	}
+	return (RP_CPU_Flags & RP_CPUFLAG_ARM_NEON);
+#endif /* __aarch64__ */
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ROMPROPERTIES_LIBRPCPU_CPUFLAGS_ARM_H__ */
@@ -43,9 +43,11 @@
 
 // Flags stored in the %ecx register.
 #define CPUFLAG_IA32_ECX_SSE3		((uint32_t)(1U << 0))
+#define CPUFLAG_IA32_ECX_PCLMULQDQ	((uint32_t)(1U << 1))
 #define CPUFLAG_IA32_ECX_SSSE3		((uint32_t)(1U << 9))
 #define CPUFLAG_IA32_ECX_SSE41		((uint32_t)(1U << 19))
 #define CPUFLAG_IA32_ECX_SSE42		((uint32_t)(1U << 20))
+#define CPUFLAG_IA32_ECX_AES		((uint32_t)(1U << 25))
 #define CPUFLAG_IA32_ECX_XSAVE		((uint32_t)(1U << 26))
 #define CPUFLAG_IA32_ECX_OSXSAVE	((uint32_t)(1U << 27))
 #define CPUFLAG_IA32_ECX_AVX		((uint32_t)(1U << 28))
@@ -69,6 +71,10 @@
 #define CPUFLAG_IA32_EXT_ECX_XOP	((uint32_t)(1U << 11))
 #define CPUFLAG_IA32_EXT_ECX_FMA4	((uint32_t)(1U << 16))
 
+// XCR0: Extended Control Register 0
+#define XCR0_SSE_STATE		((uint32_t)(1U << 1))
+#define XCR0_AVX_STATE		((uint32_t)(1U << 2))
+
 // CPUID functions.
 #define CPUID_MAX_FUNCTIONS			((uint32_t)(0x00000000U))
 #define CPUID_PROC_INFO_FEATURE_BITS		((uint32_t)(0x00000001U))
@@ -185,6 +191,69 @@ static FORCEINLINE void cpuid(unsigned int level, unsigned int regs[4])
 #endif
 }
 
+/**
+ * Run the `cpuid` instruction with a subleaf.
+ * @param level
+ * @param subleaf Subleaf. (%ecx)
+ * @param regs Registers. (%eax, %ebx, %ecx, %edx)
+ */
+static FORCEINLINE void cpuid_count(unsigned int level, unsigned int subleaf, unsigned int regs[4])
+{
+#if defined(__GNUC__)
+# ifdef ASM_RESERVE_EBX
+	__asm__ (
+		"xchgl	%%ebx, %1\n"
+		"cpuid\n"
+		"xchgl	%%ebx, %1\n"
+		: "=a" (regs[0]), "=r" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+		: "0" (level), "2" (subleaf)
+		);
+# else /* !ASM_RESERVE_EBX */
+	__asm__ (
+		"cpuid\n"
+		: "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+		: "0" (level), "2" (subleaf)
+		);
+# endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1500
+	// CPUID with subleaf for MSVC 2008+
+	__cpuidex((int*)regs, level, subleaf);
+#else
+	// No subleaf support. Clear the registers
+	// so extended features won't be detected.
+	((void)level);
+	((void)subleaf);
+	regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#endif
+}
+
+/**
+ * Get the low 32 bits of XCR0.
+ * NOTE: Only call this if CPUID reports OSXSAVE.
+ * @return XCR0 (low 32 bits)
+ */
+static FORCEINLINE uint32_t xgetbv_xcr0(void)
+{
+#if defined(__GNUC__)
+	// Using the opcode directly in case the
+	// assembler doesn't know `xgetbv`.
+	uint32_t __eax, __edx;
+	__asm__ (
+		".byte 0x0f, 0x01, 0xd0\n"
+		: "=a" (__eax), "=d" (__edx)
+		: "c" (0)
+		);
+	((void)__edx);
+	return __eax;
+#elif defined(_MSC_VER) && _MSC_VER >= 1600
+	// _xgetbv() for MSVC 2010 SP1+
+	return (uint32_t)_xgetbv(0);
+#else
+	// Cannot check XCR0. Assume AVX isn't supported.
+	return 0;
+#endif
+}
+
 // Register indexes.
 #define REG_EAX 0
 #define REG_EBX 1
@@ -295,6 +364,10 @@ static void RP_CPU_InitCPUFlags_int(void)
 				RP_CPU_Flags |= RP_CPUFLAG_X86_SSE41;
 			if (regs[REG_ECX] & CPUFLAG_IA32_ECX_SSE42)
 				RP_CPU_Flags |= RP_CPUFLAG_X86_SSE42;
+			if (regs[REG_ECX] & CPUFLAG_IA32_ECX_AES)
+				RP_CPU_Flags |= RP_CPUFLAG_X86_AES;
+			if (regs[REG_ECX] & CPUFLAG_IA32_ECX_PCLMULQDQ)
+				RP_CPU_Flags |= RP_CPUFLAG_X86_PCLMULQDQ;
 		}
 #else /* !(defined(__i386__) || defined(_M_IX86)) */
 		// AMD64: SSE2 and lower are always supported.
@@ -307,7 +380,30 @@ static void RP_CPU_InitCPUFlags_int(void)
 			RP_CPU_Flags |= RP_CPUFLAG_X86_SSE41;
 		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_SSE42)
 			RP_CPU_Flags |= RP_CPUFLAG_X86_SSE42;
+		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_AES)
+			RP_CPU_Flags |= RP_CPUFLAG_X86_AES;
+		if (regs[REG_ECX] & CPUFLAG_IA32_ECX_PCLMULQDQ)
+			RP_CPU_Flags |= RP_CPUFLAG_X86_PCLMULQDQ;
 #endif /* defined(__i386__) || defined(_M_IX86) */
+
+		// AVX requires the OS to save the YMM registers.
+		// Check OSXSAVE, then check XCR0 for the SSE and AVX state.
+		if ((RP_CPU_Flags & RP_CPUFLAG_X86_SSE2) &&
+		    (regs[REG_ECX] & (CPUFLAG_IA32_ECX_OSXSAVE | CPUFLAG_IA32_ECX_AVX)) ==
+		     (CPUFLAG_IA32_ECX_OSXSAVE | CPUFLAG_IA32_ECX_AVX))
+		{
+			const uint32_t xcr0 = xgetbv_xcr0();
+			if ((xcr0 & (XCR0_SSE_STATE | XCR0_AVX_STATE)) == (XCR0_SSE_STATE | XCR0_AVX_STATE)) {
+				RP_CPU_Flags |= RP_CPUFLAG_X86_AVX;
+			}
+		}
+	}
+
+	if (maxFunc >= CPUID_EXT_FEATURES && (RP_CPU_Flags & RP_CPUFLAG_X86_AVX)) {
+		// Get the extended features. (subleaf 0)
+		cpuid_count(CPUID_EXT_FEATURES, 0, regs);
+		if (regs[REG_EBX] & CPUFLAG_IA32_FN7_EBX_AVX2)
+			RP_CPU_Flags |= RP_CPUFLAG_X86_AVX2;
 	}
 
 	// CPU flags initialized.
@@ -0,0 +1,63 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * crc16.c: CRC16 functions.                                               *
+ * Standard version. (C code only)                                         *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "crc16_rp.h"
+#include "byteswap_rp.h"
+#include "crc16_tables.h"
+
+// C includes.
+#include <string.h>
+
+/**
+ * CRC16 function, using the reflected polynomial 0xA001.
+ * Standard version using slicing-by-8.
+ *
+ * Unlike rp_crc32(), this function does not invert the CRC
+ * before or after processing, so the caller must specify the
+ * initial value. (CRC-16/ARC uses 0; CRC-16/MODBUS and the
+ * Nintendo DS use 0xFFFF.)
+ *
+ * @param crc Previous CRC16, or the initial value for the first block.
+ * @param buf Buffer.
+ * @param len Length of buf, in bytes.
+ * @return Updated CRC16.
+ */
+uint16_t rp_crc16(uint16_t crc, const void *buf, size_t len)
+{
+	const uint8_t *p = (const uint8_t*)buf;
+
+	// Process bytes until the pointer is 32-bit aligned.
+	for (; len > 0 && ((uintptr_t)p & 3) != 0; len--, p++) {
+		crc = crc16_table[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+	}
+
+	// Process 8 bytes at a time.
+	for (; len >= 8; len -= 8, p += 8) {
+		uint32_t lo, hi;
+		memcpy(&lo, p, sizeof(lo));
+		memcpy(&hi, p + 4, sizeof(hi));
+		lo = le32_to_cpu(lo) ^ crc;
+		hi = le32_to_cpu(hi);
+		crc = crc16_table[7][ lo        & 0xFF] ^
+		      crc16_table[6][(lo >>  8) & 0xFF] ^
+		      crc16_table[5][(lo >> 16) & 0xFF] ^
+		      crc16_table[4][ lo >> 24        ] ^
+		      crc16_table[3][ hi        & 0xFF] ^
+		      crc16_table[2][(hi >>  8) & 0xFF] ^
+		      crc16_table[1][(hi >> 16) & 0xFF] ^
+		      crc16_table[0][ hi >> 24        ];
+	}
+
+	// Process the remaining bytes.
+	for (; len > 0; len--, p++) {
+		crc = crc16_table[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+	}
+
+	return crc;
+}
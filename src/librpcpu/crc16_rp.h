@@ -0,0 +1,40 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * crc16_rp.h: CRC16 functions.                                            *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPCPU_CRC16_RP_H__
+#define __ROMPROPERTIES_LIBRPCPU_CRC16_RP_H__
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * CRC16 function, using the reflected polynomial 0xA001.
+ * Standard version using slicing-by-8.
+ *
+ * Unlike rp_crc32(), this function does not invert the CRC
+ * before or after processing, so the caller must specify the
+ * initial value. (CRC-16/ARC uses 0; CRC-16/MODBUS and the
+ * Nintendo DS use 0xFFFF.)
+ *
+ * @param crc Previous CRC16, or the initial value for the first block.
+ * @param buf Buffer.
+ * @param len Length of buf, in bytes.
+ * @return Updated CRC16.
+ */
+uint16_t rp_crc16(uint16_t crc, const void *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ROMPROPERTIES_LIBRPCPU_CRC16_RP_H__ */
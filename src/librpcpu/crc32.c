@@ -0,0 +1,58 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * crc32.c: CRC32 functions.                                               *
+ * Standard version. (C code only)                                         *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "crc32_rp.h"
+#include "byteswap_rp.h"
+#include "crc32_tables.h"
+
+// C includes.
+#include <string.h>
+
+/**
+ * CRC32 function.
+ * Standard version using slicing-by-8.
+ * @param crc Previous CRC32. (Use 0 for the first block.)
+ * @param buf Buffer.
+ * @param len Length of buf, in bytes.
+ * @return Updated CRC32.
+ */
+uint32_t rp_crc32_c(uint32_t crc, const void *buf, size_t len)
+{
+	const uint8_t *p = (const uint8_t*)buf;
+	crc = ~crc;
+
+	// Process bytes until the pointer is 32-bit aligned.
+	for (; len > 0 && ((uintptr_t)p & 3) != 0; len--, p++) {
+		crc = crc32_table[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+	}
+
+	// Process 8 bytes at a time.
+	for (; len >= 8; len -= 8, p += 8) {
+		uint32_t lo, hi;
+		memcpy(&lo, p, sizeof(lo));
+		memcpy(&hi, p + 4, sizeof(hi));
+		lo = le32_to_cpu(lo) ^ crc;
+		hi = le32_to_cpu(hi);
+		crc = crc32_table[7][ lo        & 0xFF] ^
+		      crc32_table[6][(lo >>  8) & 0xFF] ^
+		      crc32_table[5][(lo >> 16) & 0xFF] ^
+		      crc32_table[4][ lo >> 24        ] ^
+		      crc32_table[3][ hi        & 0xFF] ^
+		      crc32_table[2][(hi >>  8) & 0xFF] ^
+		      crc32_table[1][(hi >> 16) & 0xFF] ^
+		      crc32_table[0][ hi >> 24        ];
+	}
+
+	// Process the remaining bytes.
+	for (; len > 0; len--, p++) {
+		crc = crc32_table[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
@@ -0,0 +1,58 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * crc32_armv8.c: CRC32 functions.                                         *
+ * ARMv8 CRC32 instruction version.                                        *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "crc32_rp.h"
+
+// C includes.
+#include <string.h>
+
+// ARM CRC32 intrinsics.
+#include <arm_acle.h>
+
+/**
+ * CRC32 function.
+ * ARMv8 CRC32 instruction version.
+ * @param crc Previous CRC32. (Use 0 for the first block.)
+ * @param buf Buffer.
+ * @param len Length of buf, in bytes.
+ * @return Updated CRC32.
+ */
+uint32_t rp_crc32_armv8(uint32_t crc, const void *buf, size_t len)
+{
+	const uint8_t *p = (const uint8_t*)buf;
+	crc = ~crc;
+
+	// Process bytes until the pointer is 64-bit aligned.
+	for (; len > 0 && ((uintptr_t)p & 7) != 0; len--, p++) {
+		crc = __crc32b(crc, *p);
+	}
+
+#ifdef RP_CPU_ARM64
+	// Process 8 bytes at a time.
+	for (; len >= 8; len -= 8, p += 8) {
+		uint64_t d;
+		memcpy(&d, p, sizeof(d));
+		crc = __crc32d(crc, d);
+	}
+#else /* !RP_CPU_ARM64 */
+	// Process 4 bytes at a time.
+	for (; len >= 4; len -= 4, p += 4) {
+		uint32_t w;
+		memcpy(&w, p, sizeof(w));
+		crc = __crc32w(crc, w);
+	}
+#endif /* RP_CPU_ARM64 */
+
+	// Process the remaining bytes.
+	for (; len > 0; len--, p++) {
+		crc = __crc32b(crc, *p);
+	}
+
+	return ~crc;
+}
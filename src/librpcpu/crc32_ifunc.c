@@ -0,0 +1,33 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * crc32_ifunc.c: CRC32 functions. (IFUNC)                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "crc32_rp.h"
+#include "cpu_dispatch.h"
+
+#ifdef RP_HAS_IFUNC
+
+/**
+ * IFUNC resolver function for rp_crc32().
+ * @return Function pointer.
+ */
+static __typeof__(&rp_crc32_c) rp_crc32_resolve(void)
+{
+#ifdef CRC32_HAS_PCLMULQDQ
+	if (RP_CPU_HasSSE2() && RP_CPU_HasPCLMULQDQ()) {
+		return &rp_crc32_pclmulqdq;
+	} else
+#endif /* CRC32_HAS_PCLMULQDQ */
+	{
+		return &rp_crc32_c;
+	}
+}
+
+uint32_t rp_crc32(uint32_t crc, const void *buf, size_t len)
+	IFUNC_ATTR(rp_crc32_resolve);
+
+#endif /* RP_HAS_IFUNC */
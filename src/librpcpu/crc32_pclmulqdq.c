@@ -0,0 +1,132 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * crc32_pclmulqdq.c: CRC32 functions.                                     *
+ * PCLMULQDQ-optimized version.                                            *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "crc32_rp.h"
+
+// SSE2 and PCLMULQDQ intrinsics.
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+// References:
+// - "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction"
+//   by Vinodh Gopal, et al. (Intel, 2009)
+// - Linux kernel: arch/x86/crypto/crc32-pclmul_asm.S
+// - Chromium zlib: crc32_simd.c
+
+/**
+ * CRC32 function.
+ * PCLMULQDQ-optimized version. (Requires SSE2 and PCLMULQDQ.)
+ * @param crc Previous CRC32. (Use 0 for the first block.)
+ * @param buf Buffer.
+ * @param len Length of buf, in bytes.
+ * @return Updated CRC32.
+ */
+uint32_t rp_crc32_pclmulqdq(uint32_t crc, const void *buf, size_t len)
+{
+	const uint8_t *p = (const uint8_t*)buf;
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+	size_t fold_len;
+
+	if (len < 64) {
+		// Not enough data for folding.
+		return rp_crc32_c(crc, buf, len);
+	}
+
+	// Bit-reflected folding constants, as 64-bit pairs:
+	// - k1k2: x^(4*128+32) mod P, x^(4*128-32) mod P (fold by 4)
+	// - k3k4: x^(128+32) mod P, x^(128-32) mod P (fold by 1)
+	// - k5k0: x^64 mod P
+	// - poly: P', mu (Barrett reduction)
+	// NOTE: _mm_setr_epi32() is used instead of _mm_set_epi64x(),
+	// since the latter isn't available in 32-bit MSVC builds.
+	const __m128i k1k2 = _mm_setr_epi32(0x54442BD4, 0x00000001, 0xC6E41596, 0x00000001);
+	const __m128i k3k4 = _mm_setr_epi32(0x751997D0, 0x00000001, 0xCCAA009E, 0x00000000);
+	const __m128i k5k0 = _mm_setr_epi32(0x63CD6124, 0x00000001, 0x00000000, 0x00000000);
+	const __m128i poly = _mm_setr_epi32(0xDB710641, 0x00000001, 0xF7011641, 0x00000001);
+	const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+	// Only fold multiples of 16 bytes.
+	// The remainder is handled by the standard version.
+	fold_len = len & ~(size_t)15;
+	len -= fold_len;
+
+	x1 = _mm_loadu_si128((const __m128i*)(p + 0x00));
+	x2 = _mm_loadu_si128((const __m128i*)(p + 0x10));
+	x3 = _mm_loadu_si128((const __m128i*)(p + 0x20));
+	x4 = _mm_loadu_si128((const __m128i*)(p + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)~crc));
+	p += 64;
+	fold_len -= 64;
+
+	// Fold 64 bytes at a time.
+	x0 = k1k2;
+	for (; fold_len >= 64; fold_len -= 64, p += 64) {
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*)(p + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*)(p + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*)(p + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*)(p + 0x30)));
+	}
+
+	// Fold the four 128-bit values into one.
+	x0 = k3k4;
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	// Fold 16 bytes at a time.
+	for (; fold_len >= 16; fold_len -= 16, p += 16) {
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i*)p)), x5);
+	}
+
+	// Fold 128 bits to 64 bits.
+	x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, mask32);
+	x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// Barrett reduction to 32 bits.
+	x2 = _mm_and_si128(x1, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+	x2 = _mm_and_si128(x2, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// The CRC is in bits 32-63.
+	// NOTE: _mm_extract_epi32() requires SSE4.1.
+	crc = ~(uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+
+	// Process the remaining bytes.
+	if (len > 0) {
+		crc = rp_crc32_c(crc, p, len);
+	}
+	return crc;
+}
@@ -0,0 +1,118 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * crc32_rp.h: CRC32 functions.                                            *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPCPU_CRC32_RP_H__
+#define __ROMPROPERTIES_LIBRPCPU_CRC32_RP_H__
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpu_dispatch.h"
+
+#if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
+# include "cpuflags_x86.h"
+# define CRC32_HAS_PCLMULQDQ 1
+#endif
+#if defined(RP_CPU_ARM) || defined(RP_CPU_ARM64)
+# include "cpuflags_arm.h"
+# include "config.librpcpu.h"
+# ifdef HAVE_ARMV8_CRC32
+#  define CRC32_HAS_ARMV8 1
+# endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The CRC32 functions here use the same polynomial and conventions as
+ * zlib's crc32(): Start with crc == 0, and pass the previous return
+ * value when processing data in multiple blocks.
+ */
+
+/**
+ * CRC32 function.
+ * Standard version using slicing-by-8.
+ * @param crc Previous CRC32. (Use 0 for the first block.)
+ * @param buf Buffer.
+ * @param len Length of buf, in bytes.
+ * @return Updated CRC32.
+ */
+uint32_t rp_crc32_c(uint32_t crc, const void *buf, size_t len);
+
+#ifdef CRC32_HAS_PCLMULQDQ
+/**
+ * CRC32 function.
+ * PCLMULQDQ-optimized version. (Requires SSE2 and PCLMULQDQ.)
+ * @param crc Previous CRC32. (Use 0 for the first block.)
+ * @param buf Buffer.
+ * @param len Length of buf, in bytes.
+ * @return Updated CRC32.
+ */
+uint32_t rp_crc32_pclmulqdq(uint32_t crc, const void *buf, size_t len);
+#endif /* CRC32_HAS_PCLMULQDQ */
+
+#ifdef CRC32_HAS_ARMV8
+/**
+ * CRC32 function.
+ * ARMv8 CRC32 instruction version.
+ * @param crc Previous CRC32. (Use 0 for the first block.)
+ * @param buf Buffer.
+ * @param len Length of buf, in bytes.
+ * @return Updated CRC32.
+ */
+uint32_t rp_crc32_armv8(uint32_t crc, const void *buf, size_t len);
+#endif /* CRC32_HAS_ARMV8 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/* System has IFUNC. Use it for dispatching. */
+
+/**
+ * CRC32 function.
+ * @param crc Previous CRC32. (Use 0 for the first block.)
+ * @param buf Buffer.
+ * @param len Length of buf, in bytes.
+ * @return Updated CRC32.
+ */
+uint32_t rp_crc32(uint32_t crc, const void *buf, size_t len);
+
+#else /* !RP_HAS_IFUNC && !(defined(RP_CPU_I386) || defined(RP_CPU_AMD64)) */
+/* System does not have IFUNC. Use inline dispatch functions. */
+
+/**
+ * CRC32 function.
+ * @param crc Previous CRC32. (Use 0 for the first block.)
+ * @param buf Buffer.
+ * @param len Length of buf, in bytes.
+ * @return Updated CRC32.
+ */
+static inline uint32_t rp_crc32(uint32_t crc, const void *buf, size_t len)
+{
+# if defined(CRC32_HAS_PCLMULQDQ)
+	if (RP_CPU_HasSSE2() && RP_CPU_HasPCLMULQDQ()) {
+		return rp_crc32_pclmulqdq(crc, buf, len);
+	} else
+# elif defined(CRC32_HAS_ARMV8)
+	if (RP_CPU_HasCRC32()) {
+		return rp_crc32_armv8(crc, buf, len);
+	} else
+# endif
+	{
+		return rp_crc32_c(crc, buf, len);
+	}
+}
+
+#endif /* RP_HAS_IFUNC && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64)) */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ROMPROPERTIES_LIBRPCPU_CRC32_RP_H__ */
@@ -0,0 +1,34 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * sum8.c: Byte sum functions. (for additive checksums)                    *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "sum8_rp.h"
+
+/**
+ * Byte sum function.
+ * Standard version.
+ * @param sum	[in,out] Sums. (Initialize to 0 for the first block.)
+ * @param buf	[in] Buffer.
+ * @param len	[in] Length of buf, in bytes.
+ */
+void rp_sum8_c(rp_sum8_t *sum, const void *buf, size_t len)
+{
+	const uint8_t *p = (const uint8_t*)buf;
+	uint64_t even = 0, odd = 0;
+
+	for (; len >= 2; p += 2, len -= 2) {
+		even += p[0];
+		odd += p[1];
+	}
+	if (len != 0) {
+		// Last byte is at an even offset.
+		even += p[0];
+	}
+
+	sum->even += even;
+	sum->odd += odd;
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * sum8_rp.h: Byte sum functions. (for additive checksums)                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPCPU_SUM8_RP_H__
+#define __ROMPROPERTIES_LIBRPCPU_SUM8_RP_H__
+
+// C includes.
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpu_dispatch.h"
+
+#if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
+# include "cpuflags_x86.h"
+# define SUM8_HAS_SSE2 1
+#endif
+#ifdef RP_CPU_AMD64
+# define SUM8_ALWAYS_HAS_SSE2 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Byte sums.
+ *
+ * Bytes at even and odd offsets are summed separately, which
+ * allows for both 8-bit and 16-bit additive checksums:
+ * - 8-bit sum:          even + odd
+ * - 16-bit BE word sum: (even << 8) + odd
+ * - 16-bit LE word sum: even + (odd << 8)
+ *
+ * Offsets are relative to the start of the first block, so when
+ * summing data in multiple blocks, all blocks except for the last
+ * one must have an even length.
+ */
+typedef struct _rp_sum8_t {
+	uint64_t even;	// Sum of bytes at even offsets
+	uint64_t odd;	// Sum of bytes at odd offsets
+} rp_sum8_t;
+
+/**
+ * Byte sum function.
+ * Standard version.
+ * @param sum	[in,out] Sums. (Initialize to 0 for the first block.)
+ * @param buf	[in] Buffer.
+ * @param len	[in] Length of buf, in bytes.
+ */
+void rp_sum8_c(rp_sum8_t *sum, const void *buf, size_t len);
+
+#ifdef SUM8_HAS_SSE2
+/**
+ * Byte sum function.
+ * SSE2-optimized version.
+ * @param sum	[in,out] Sums. (Initialize to 0 for the first block.)
+ * @param buf	[in] Buffer.
+ * @param len	[in] Length of buf, in bytes.
+ */
+void rp_sum8_sse2(rp_sum8_t *sum, const void *buf, size_t len);
+#endif /* SUM8_HAS_SSE2 */
+
+/**
+ * Byte sum function.
+ * @param sum	[in,out] Sums. (Initialize to 0 for the first block.)
+ * @param buf	[in] Buffer.
+ * @param len	[in] Length of buf, in bytes.
+ */
+static inline void rp_sum8(rp_sum8_t *sum, const void *buf, size_t len)
+{
+#if defined(SUM8_ALWAYS_HAS_SSE2)
+	rp_sum8_sse2(sum, buf, len);
+#else /* !SUM8_ALWAYS_HAS_SSE2 */
+# ifdef SUM8_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		rp_sum8_sse2(sum, buf, len);
+	} else
+# endif /* SUM8_HAS_SSE2 */
+	{
+		rp_sum8_c(sum, buf, len);
+	}
+#endif /* SUM8_ALWAYS_HAS_SSE2 */
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ROMPROPERTIES_LIBRPCPU_SUM8_RP_H__ */
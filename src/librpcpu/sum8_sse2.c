@@ -0,0 +1,63 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu)                         *
+ * sum8_sse2.c: Byte sum functions. (for additive checksums)               *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "sum8_rp.h"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+
+/**
+ * Byte sum function.
+ * SSE2-optimized version.
+ * @param sum	[in,out] Sums. (Initialize to 0 for the first block.)
+ * @param buf	[in] Buffer.
+ * @param len	[in] Length of buf, in bytes.
+ */
+void rp_sum8_sse2(rp_sum8_t *sum, const void *buf, size_t len)
+{
+	const uint8_t *p = (const uint8_t*)buf;
+
+	// PSADBW against zero sums each group of 8 bytes into a
+	// 16-bit value in each 64-bit lane. Masking off the odd
+	// bytes or shifting out the even bytes of each 16-bit
+	// word gives the even and odd sums separately.
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask_even = _mm_set1_epi16(0x00FF);
+	__m128i acc_even = _mm_setzero_si128();
+	__m128i acc_odd = _mm_setzero_si128();
+
+	// Process 32 bytes per iteration.
+	for (; len >= 32; p += 32, len -= 32) {
+		const __m128i v0 = _mm_loadu_si128((const __m128i*)p);
+		const __m128i v1 = _mm_loadu_si128((const __m128i*)(p + 16));
+
+		acc_even = _mm_add_epi64(acc_even, _mm_sad_epu8(_mm_and_si128(v0, mask_even), zero));
+		acc_odd  = _mm_add_epi64(acc_odd,  _mm_sad_epu8(_mm_srli_epi16(v0, 8), zero));
+		acc_even = _mm_add_epi64(acc_even, _mm_sad_epu8(_mm_and_si128(v1, mask_even), zero));
+		acc_odd  = _mm_add_epi64(acc_odd,  _mm_sad_epu8(_mm_srli_epi16(v1, 8), zero));
+	}
+
+	// Combine the 64-bit lanes.
+	{
+		union {
+			__m128i v;
+			uint64_t u64[2];
+		} even, odd;
+		even.v = acc_even;
+		odd.v = acc_odd;
+		sum->even += even.u64[0] + even.u64[1];
+		sum->odd += odd.u64[0] + odd.u64[1];
+	}
+
+	// Process the remaining bytes.
+	// NOTE: 32 is even, so the remaining bytes have the same parity.
+	if (len != 0) {
+		rp_sum8_c(sum, p, len);
+	}
+}
@@ -12,11 +12,45 @@
 
 // Byteswap functions.
 #include "librpcpu/byteswap_rp.h"
+#include "librpcpu/byteswap_struct.hpp"
 #include "librpbase/aligned_malloc.h"
 
 // C includes. (C++ namespace)
 #include <cstdio>
 
+// Test structs for struct byteswapping.
+typedef struct _ByteswapTestNested {
+	uint32_t a;
+	uint16_t b;
+	uint16_t c;
+} ByteswapTestNested;
+
+typedef struct _ByteswapTestStruct {
+	uint32_t u32;
+	uint8_t u8;
+	uint8_t pad;
+	uint16_t u16;
+	uint64_t u64;
+	float f;
+	uint32_t arr32[16];	// Large enough for the SIMD functions.
+	uint16_t arr16[4];
+	ByteswapTestNested nested;
+} ByteswapTestStruct;
+
+RP_BYTESWAP_LAYOUT(ByteswapTestNested,
+	RP_BYTESWAP_FIELD(ByteswapTestNested, a),
+	RP_BYTESWAP_FIELD(ByteswapTestNested, b),
+	RP_BYTESWAP_FIELD(ByteswapTestNested, c))
+RP_BYTESWAP_LAYOUT(ByteswapTestStruct,
+	RP_BYTESWAP_FIELD(ByteswapTestStruct, u32),
+	RP_BYTESWAP_FIELD(ByteswapTestStruct, u8),
+	RP_BYTESWAP_FIELD(ByteswapTestStruct, u16),
+	RP_BYTESWAP_FIELD(ByteswapTestStruct, u64),
+	RP_BYTESWAP_FIELD(ByteswapTestStruct, f),
+	RP_BYTESWAP_FIELD(ByteswapTestStruct, arr32),
+	RP_BYTESWAP_FIELD(ByteswapTestStruct, arr16),
+	RP_BYTESWAP_NESTED(ByteswapTestStruct, nested))
+
 namespace LibRpCpu { namespace Tests {
 
 class ByteswapTest : public ::testing::Test
@@ -145,12 +179,63 @@ TEST_F(ByteswapTest, nonHostEndianMacroTest)
 #endif
 }
 
+/**
+ * Test struct byteswapping.
+ */
+TEST_F(ByteswapTest, structTest)
+{
+	ByteswapTestStruct orig, test;
+	uint8_t *const p = reinterpret_cast<uint8_t*>(&orig);
+	for (size_t i = 0; i < sizeof(orig); i++) {
+		p[i] = static_cast<uint8_t>(i * 7 + 1);
+	}
+
+	memcpy(&test, &orig, sizeof(test));
+	LibRpCpu::ByteSwap::swap_struct(test);
+	EXPECT_EQ(__swab32(orig.u32), test.u32);
+	EXPECT_EQ(orig.u8, test.u8);
+	EXPECT_EQ(orig.pad, test.pad);
+	EXPECT_EQ(__swab16(orig.u16), test.u16);
+	EXPECT_EQ(__swab64(orig.u64), test.u64);
+	uint32_t f_orig, f_test;
+	memcpy(&f_orig, &orig.f, sizeof(f_orig));
+	memcpy(&f_test, &test.f, sizeof(f_test));
+	EXPECT_EQ(__swab32(f_orig), f_test);
+	for (size_t i = 0; i < ARRAY_SIZE(orig.arr32); i++) {
+		EXPECT_EQ(__swab32(orig.arr32[i]), test.arr32[i]);
+	}
+	for (size_t i = 0; i < ARRAY_SIZE(orig.arr16); i++) {
+		EXPECT_EQ(__swab16(orig.arr16[i]), test.arr16[i]);
+	}
+	EXPECT_EQ(__swab32(orig.nested.a), test.nested.a);
+	EXPECT_EQ(__swab16(orig.nested.b), test.nested.b);
+	EXPECT_EQ(__swab16(orig.nested.c), test.nested.c);
+
+	// Swapping again should restore the original struct.
+	LibRpCpu::ByteSwap::swap_struct(test);
+	EXPECT_EQ(0, memcmp(&orig, &test, sizeof(test)));
+
+	// Exactly one of the host-endian conversions is a no-op.
+	ByteswapTestStruct le_test, be_test;
+	memcpy(&le_test, &orig, sizeof(le_test));
+	memcpy(&be_test, &orig, sizeof(be_test));
+	le_struct_to_cpu(le_test);
+	be_struct_to_cpu(be_test);
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
+	EXPECT_EQ(0, memcmp(&orig, &le_test, sizeof(le_test)));
+	EXPECT_NE(0, memcmp(&orig, &be_test, sizeof(be_test)));
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+	EXPECT_NE(0, memcmp(&orig, &le_test, sizeof(le_test)));
+	EXPECT_EQ(0, memcmp(&orig, &be_test, sizeof(be_test)));
+#endif
+}
+
 #define __byte_swap_16_array_dispatch(ptr, n) __byte_swap_16_array(ptr, n)
 #define __byte_swap_32_array_dispatch(ptr, n) __byte_swap_32_array(ptr, n)
 
 /**
  * Macro for testing a 16-bit byteswap function.
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2, neon; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -171,7 +256,7 @@ TEST_F(ByteswapTest, __byte_swap_16_array_##opt##_test) \
 
 /**
  * Macro for benchmarking a 16-bit byteswap function.
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2, neon; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -193,7 +278,7 @@ TEST_F(ByteswapTest, __byte_swap_16_array_##opt##_benchmark) \
  * This version has data that is 16-bit aligned, but not 32-bit aligned,
  * and the block has an odd number of WORDs at the end.
  *
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2, neon; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -218,7 +303,7 @@ TEST_F(ByteswapTest, __byte_swap_16_array_unDWORD_##opt##_test) \
  * This version has data that is 16-bit aligned, but not 32-bit aligned,
  * and the block has an odd number of WORDs at the end.
  *
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2, neon; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -236,7 +321,7 @@ TEST_F(ByteswapTest, __byte_swap_16_array_unDWORD_##opt##_benchmark) \
 
 /**
  * Macro for testing a 32-bit byteswap function.
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2, neon; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -257,7 +342,7 @@ TEST_F(ByteswapTest, __byte_swap_32_array_##opt##_test) \
 
 /**
  * Macro for benchmarking a 32-bit byteswap function.
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2, neon; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -279,7 +364,7 @@ TEST_F(ByteswapTest, __byte_swap_32_array_##opt##_benchmark) \
  * This version has data that is 32-bit aligned, but not 64-bit aligned,
  * and the block has an odd number of DWORDs at the end.
  *
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2, neon; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -304,7 +389,7 @@ TEST_F(ByteswapTest, __byte_swap_32_array_unQWORD_##opt##_test) \
  * This version has data that is 32-bit aligned, but not 64-bit aligned,
  * and the block has an odd number of DWORDs at the end.
  *
- * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3; dispatch for the dispatch function)
+ * @param opt		Byteswap function optimization. (c, mmx, sse2, ssse3, avx2, neon; dispatch for the dispatch function)
  * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
  * @param errmsg	Error message to display if the optimization cannot be used.
  */
@@ -366,8 +451,33 @@ DO_ARRAY_32_unQWORD_TEST	(ssse3, RP_CPU_HasSSSE3(), "*** SSSE3 is not supported
 DO_ARRAY_32_unQWORD_BENCHMARK	(ssse3, RP_CPU_HasSSSE3(), "*** SSSE3 is not supported on this CPU. Skipping test.\n")
 #endif /* BYTESWAP_HAS_SSSE3 */
 
+#ifdef BYTESWAP_HAS_AVX2
+// AVX2-optimized tests.
+DO_ARRAY_16_TEST		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_BENCHMARK		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_unDWORD_TEST	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_unDWORD_BENCHMARK	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_TEST		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_BENCHMARK		(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_unQWORD_TEST	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_unQWORD_BENCHMARK	(avx2, RP_CPU_HasAVX2(), "*** AVX2 is not supported on this CPU. Skipping test.\n")
+#endif /* BYTESWAP_HAS_AVX2 */
+
+#ifdef BYTESWAP_HAS_NEON
+// NEON-optimized tests.
+DO_ARRAY_16_TEST		(neon, RP_CPU_HasNEON(), "*** NEON is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_BENCHMARK		(neon, RP_CPU_HasNEON(), "*** NEON is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_unDWORD_TEST	(neon, RP_CPU_HasNEON(), "*** NEON is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_16_unDWORD_BENCHMARK	(neon, RP_CPU_HasNEON(), "*** NEON is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_TEST		(neon, RP_CPU_HasNEON(), "*** NEON is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_BENCHMARK		(neon, RP_CPU_HasNEON(), "*** NEON is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_unQWORD_TEST	(neon, RP_CPU_HasNEON(), "*** NEON is not supported on this CPU. Skipping test.\n")
+DO_ARRAY_32_unQWORD_BENCHMARK	(neon, RP_CPU_HasNEON(), "*** NEON is not supported on this CPU. Skipping test.\n")
+#endif /* BYTESWAP_HAS_NEON */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(BYTESWAP_HAS_MMX) || defined(BYTESWAP_HAS_SSE2) || defined(BYTESWAP_HAS_SSSE3)
+#if defined(BYTESWAP_HAS_MMX) || defined(BYTESWAP_HAS_SSE2) || defined(BYTESWAP_HAS_SSSE3) || \
+    defined(BYTESWAP_HAS_AVX2) || defined(BYTESWAP_HAS_NEON)
 // Dispatch functions.
 DO_ARRAY_16_TEST		(dispatch, true, "")
 DO_ARRAY_16_BENCHMARK		(dispatch, true, "")
@@ -377,7 +487,7 @@ DO_ARRAY_32_TEST		(dispatch, true, "")
 DO_ARRAY_32_BENCHMARK		(dispatch, true, "")
 DO_ARRAY_32_unQWORD_TEST	(dispatch, true, "")
 DO_ARRAY_32_unQWORD_BENCHMARK	(dispatch, true, "")
-#endif /* BYTESWAP_HAS_MMX || BYTESWAP_HAS_SSE2 || BYTESWAP_HAS_SSSE3 */
+#endif /* BYTESWAP_HAS_MMX || BYTESWAP_HAS_SSE2 || BYTESWAP_HAS_SSSE3 || BYTESWAP_HAS_AVX2 || BYTESWAP_HAS_NEON */
 
 } }
 
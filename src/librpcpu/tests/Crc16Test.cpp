@@ -0,0 +1,163 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu/tests)                   *
+ * Crc16Test.cpp: CRC16 functions test.                                    *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// CRC16 functions.
+#include "librpcpu/crc16_rp.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+namespace LibRpCpu { namespace Tests {
+
+class Crc16Test : public ::testing::Test
+{
+	public:
+		// Test buffer size.
+		// This is the size of a Nintendo DS secure area,
+		// plus extra bytes for misaligned tests.
+		static const unsigned int TEST_BUF_SIZE = 16384 + 16;
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 10000;
+
+	public:
+		void SetUp(void) final;
+
+	public:
+		/**
+		 * Reference CRC16 implementation. (byte-at-a-time table)
+		 * This was previously used by libromdata's nds_crc.
+		 * @param crc Previous CRC16.
+		 * @param buf Buffer.
+		 * @param len Length of buf.
+		 * @return Updated CRC16.
+		 */
+		static uint16_t crc16_ref(uint16_t crc, const uint8_t *buf, size_t len);
+
+	public:
+		// Test data. (pseudo-random)
+		uint8_t test_buf[TEST_BUF_SIZE];
+
+		// Byte-at-a-time table.
+		static uint16_t crc16_ref_table[256];
+};
+
+uint16_t Crc16Test::crc16_ref_table[256];
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void Crc16Test::SetUp(void)
+{
+	// Simple LCG to get repeatable test data.
+	uint32_t seed = 0x87654321;
+	for (unsigned int i = 0; i < TEST_BUF_SIZE; i++) {
+		seed = (seed * 1103515245U) + 12345U;
+		test_buf[i] = static_cast<uint8_t>(seed >> 16);
+	}
+
+	// Initialize the byte-at-a-time table.
+	for (unsigned int n = 0; n < 256; n++) {
+		uint16_t c = static_cast<uint16_t>(n);
+		for (unsigned int bit = 0; bit < 8; bit++) {
+			c = (c & 1) ? ((c >> 1) ^ 0xA001) : (c >> 1);
+		}
+		crc16_ref_table[n] = c;
+	}
+}
+
+/**
+ * Reference CRC16 implementation. (byte-at-a-time table)
+ * This was previously used by libromdata's nds_crc.
+ * @param crc Previous CRC16.
+ * @param buf Buffer.
+ * @param len Length of buf.
+ * @return Updated CRC16.
+ */
+uint16_t Crc16Test::crc16_ref(uint16_t crc, const uint8_t *buf, size_t len)
+{
+	for (; len > 0; len--, buf++) {
+		crc = (crc >> 8) ^ crc16_ref_table[(crc ^ *buf) & 0xFF];
+	}
+	return crc;
+}
+
+/**
+ * Test the CRC16 function.
+ */
+TEST_F(Crc16Test, crc16_test)
+{
+	// Standard check values.
+	EXPECT_EQ(0xBB3D, rp_crc16(0, "123456789", 9));		// CRC-16/ARC
+	EXPECT_EQ(0x4B37, rp_crc16(0xFFFF, "123456789", 9));	// CRC-16/MODBUS
+	EXPECT_EQ(0xFFFF, rp_crc16(0xFFFF, nullptr, 0));
+
+	// Lengths from 0 to 300 bytes, with all 16 misalignments.
+	for (unsigned int offset = 0; offset < 16; offset++) {
+		for (unsigned int len = 0; len <= 300; len++) {
+			EXPECT_EQ(crc16_ref(0xFFFF, &test_buf[offset], len), rp_crc16(0xFFFF, &test_buf[offset], len)) <<
+				"offset == " << offset << ", len == " << len;
+		}
+	}
+
+	// Full buffer, processed in multiple blocks.
+	const uint16_t crc_full = crc16_ref(0xFFFF, test_buf, TEST_BUF_SIZE);
+	EXPECT_EQ(crc_full, rp_crc16(0xFFFF, test_buf, TEST_BUF_SIZE));
+	uint16_t crc = 0xFFFF;
+	for (unsigned int pos = 0; pos < TEST_BUF_SIZE; pos += 1000) {
+		const unsigned int len = (TEST_BUF_SIZE - pos < 1000 ? TEST_BUF_SIZE - pos : 1000);
+		crc = rp_crc16(crc, &test_buf[pos], len);
+	}
+	EXPECT_EQ(crc_full, crc);
+}
+
+/**
+ * Benchmark the byte-at-a-time table version.
+ */
+TEST_F(Crc16Test, crc16_ref_benchmark)
+{
+	uint16_t crc = 0xFFFF;
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		crc = crc16_ref(crc, test_buf, 16384);
+	}
+	EXPECT_NE(0U, crc);
+}
+
+/**
+ * Benchmark the slicing-by-8 version.
+ */
+TEST_F(Crc16Test, crc16_benchmark)
+{
+	uint16_t crc = 0xFFFF;
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		crc = rp_crc16(crc, test_buf, 16384);
+	}
+	EXPECT_NE(0U, crc);
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpCpu test suite: CRC16 tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n", LibRpCpu::Tests::Crc16Test::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,175 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu/tests)                   *
+ * Crc32Test.cpp: CRC32 functions test.                                    *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// CRC32 functions.
+#include "librpcpu/crc32_rp.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+namespace LibRpCpu { namespace Tests {
+
+class Crc32Test : public ::testing::Test
+{
+	public:
+		// Test buffer size.
+		// Includes extra bytes for misaligned tests.
+		static const unsigned int TEST_BUF_SIZE = 4096 + 16;
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 10000;
+
+	public:
+		void SetUp(void) final;
+
+	public:
+		/**
+		 * Reference CRC32 implementation. (bit-at-a-time)
+		 * @param crc Previous CRC32.
+		 * @param buf Buffer.
+		 * @param len Length of buf.
+		 * @return Updated CRC32.
+		 */
+		static uint32_t crc32_ref(uint32_t crc, const uint8_t *buf, size_t len);
+
+	public:
+		// Test data. (pseudo-random)
+		uint8_t test_buf[TEST_BUF_SIZE];
+};
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void Crc32Test::SetUp(void)
+{
+	// Simple LCG to get repeatable test data.
+	uint32_t seed = 0x12345678;
+	for (unsigned int i = 0; i < TEST_BUF_SIZE; i++) {
+		seed = (seed * 1103515245U) + 12345U;
+		test_buf[i] = static_cast<uint8_t>(seed >> 16);
+	}
+}
+
+/**
+ * Reference CRC32 implementation. (bit-at-a-time)
+ * @param crc Previous CRC32.
+ * @param buf Buffer.
+ * @param len Length of buf.
+ * @return Updated CRC32.
+ */
+uint32_t Crc32Test::crc32_ref(uint32_t crc, const uint8_t *buf, size_t len)
+{
+	crc = ~crc;
+	for (; len > 0; len--, buf++) {
+		crc ^= *buf;
+		for (unsigned int bit = 0; bit < 8; bit++) {
+			crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1)));
+		}
+	}
+	return ~crc;
+}
+
+/**
+ * Macro for testing a CRC32 function.
+ * @param opt		CRC32 function optimization. (c, pclmulqdq, armv8; dispatch for the dispatch function)
+ * @param func		CRC32 function.
+ * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
+ * @param errmsg	Error message to display if the optimization cannot be used.
+ */
+#define DO_CRC32_TEST(opt, func, expr, errmsg) \
+TEST_F(Crc32Test, crc32_##opt##_test) \
+{ \
+	if (!(expr)) { \
+		fputs(errmsg, stderr); \
+		return; \
+	} \
+	/* Standard check value. */ \
+	EXPECT_EQ(0xCBF43926U, func(0, "123456789", 9)); \
+	EXPECT_EQ(0U, func(0, nullptr, 0)); \
+	\
+	/* Lengths from 0 to 300 bytes, with all 16 misalignments. */ \
+	for (unsigned int offset = 0; offset < 16; offset++) { \
+		for (unsigned int len = 0; len <= 300; len++) { \
+			EXPECT_EQ(crc32_ref(0, &test_buf[offset], len), func(0, &test_buf[offset], len)) << \
+				"offset == " << offset << ", len == " << len; \
+		} \
+	} \
+	\
+	/* Full buffer, processed in multiple blocks. */ \
+	const uint32_t crc_full = crc32_ref(0, test_buf, TEST_BUF_SIZE); \
+	EXPECT_EQ(crc_full, func(0, test_buf, TEST_BUF_SIZE)); \
+	uint32_t crc = 0; \
+	for (unsigned int pos = 0; pos < TEST_BUF_SIZE; pos += 1000) { \
+		const unsigned int len = (TEST_BUF_SIZE - pos < 1000 ? TEST_BUF_SIZE - pos : 1000); \
+		crc = func(crc, &test_buf[pos], len); \
+	} \
+	EXPECT_EQ(crc_full, crc); \
+}
+
+/**
+ * Macro for benchmarking a CRC32 function.
+ * @param opt		CRC32 function optimization. (c, pclmulqdq, armv8; dispatch for the dispatch function)
+ * @param func		CRC32 function.
+ * @param expr		Expression to check if this optimization can be used. (Use `true` for c.)
+ * @param errmsg	Error message to display if the optimization cannot be used.
+ */
+#define DO_CRC32_BENCHMARK(opt, func, expr, errmsg) \
+TEST_F(Crc32Test, crc32_##opt##_benchmark) \
+{ \
+	if (!(expr)) { \
+		fputs(errmsg, stderr); \
+		return; \
+	} \
+	uint32_t crc = 0; \
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) { \
+		crc = func(crc, test_buf, TEST_BUF_SIZE); \
+	} \
+	EXPECT_NE(0U, crc); \
+}
+
+// Standard tests.
+DO_CRC32_TEST		(c, rp_crc32_c, true, "")
+DO_CRC32_BENCHMARK	(c, rp_crc32_c, true, "")
+
+#ifdef CRC32_HAS_PCLMULQDQ
+// PCLMULQDQ-optimized tests.
+DO_CRC32_TEST		(pclmulqdq, rp_crc32_pclmulqdq, RP_CPU_HasSSE2() && RP_CPU_HasPCLMULQDQ(), "*** PCLMULQDQ is not supported on this CPU. Skipping test.\n")
+DO_CRC32_BENCHMARK	(pclmulqdq, rp_crc32_pclmulqdq, RP_CPU_HasSSE2() && RP_CPU_HasPCLMULQDQ(), "*** PCLMULQDQ is not supported on this CPU. Skipping test.\n")
+#endif /* CRC32_HAS_PCLMULQDQ */
+
+#ifdef CRC32_HAS_ARMV8
+// ARMv8 CRC32 instruction tests.
+DO_CRC32_TEST		(armv8, rp_crc32_armv8, RP_CPU_HasCRC32(), "*** ARMv8 CRC32 is not supported on this CPU. Skipping test.\n")
+DO_CRC32_BENCHMARK	(armv8, rp_crc32_armv8, RP_CPU_HasCRC32(), "*** ARMv8 CRC32 is not supported on this CPU. Skipping test.\n")
+#endif /* CRC32_HAS_ARMV8 */
+
+// Dispatch function.
+DO_CRC32_TEST		(dispatch, rp_crc32, true, "")
+DO_CRC32_BENCHMARK	(dispatch, rp_crc32, true, "")
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpCpu test suite: CRC32 tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n", LibRpCpu::Tests::Crc32Test::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,190 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpcpu/tests)                   *
+ * Sum8Test.cpp: Byte sum functions test.                                  *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// Byte sum functions.
+#include "librpcpu/sum8_rp.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+namespace LibRpCpu { namespace Tests {
+
+class Sum8Test : public ::testing::Test
+{
+	public:
+		// Test buffer size.
+		// Extra bytes are included for misaligned tests.
+		static const unsigned int TEST_BUF_SIZE = 65536 + 16;
+
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 10000;
+
+	public:
+		void SetUp(void) final;
+
+	public:
+		/**
+		 * Reference byte sum implementation.
+		 * @param sum	[in,out] Sums.
+		 * @param buf	[in] Buffer.
+		 * @param len	[in] Length of buf.
+		 */
+		static void sum8_ref(rp_sum8_t *sum, const uint8_t *buf, size_t len);
+
+	public:
+		// Test data. (pseudo-random)
+		uint8_t test_buf[TEST_BUF_SIZE];
+};
+
+/**
+ * SetUp() function.
+ * Run before each test.
+ */
+void Sum8Test::SetUp(void)
+{
+	// Simple LCG to get repeatable test data.
+	uint32_t seed = 0x12345678;
+	for (unsigned int i = 0; i < TEST_BUF_SIZE; i++) {
+		seed = (seed * 1103515245U) + 12345U;
+		test_buf[i] = static_cast<uint8_t>(seed >> 16);
+	}
+}
+
+/**
+ * Reference byte sum implementation.
+ * @param sum	[in,out] Sums.
+ * @param buf	[in] Buffer.
+ * @param len	[in] Length of buf.
+ */
+void Sum8Test::sum8_ref(rp_sum8_t *sum, const uint8_t *buf, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		if (i & 1) {
+			sum->odd += buf[i];
+		} else {
+			sum->even += buf[i];
+		}
+	}
+}
+
+/**
+ * Test the standard byte sum function.
+ */
+TEST_F(Sum8Test, sum8_c_test)
+{
+	// Lengths from 0 to 300 bytes, with all 16 misalignments.
+	for (unsigned int offset = 0; offset < 16; offset++) {
+		for (unsigned int len = 0; len <= 300; len++) {
+			rp_sum8_t ref = {0, 0}, sum = {0, 0};
+			sum8_ref(&ref, &test_buf[offset], len);
+			rp_sum8_c(&sum, &test_buf[offset], len);
+			EXPECT_EQ(ref.even, sum.even) << "offset == " << offset << ", len == " << len;
+			EXPECT_EQ(ref.odd, sum.odd) << "offset == " << offset << ", len == " << len;
+		}
+	}
+}
+
+#ifdef SUM8_HAS_SSE2
+/**
+ * Test the SSE2-optimized byte sum function.
+ */
+TEST_F(Sum8Test, sum8_sse2_test)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Lengths from 0 to 300 bytes, with all 16 misalignments.
+	for (unsigned int offset = 0; offset < 16; offset++) {
+		for (unsigned int len = 0; len <= 300; len++) {
+			rp_sum8_t ref = {0, 0}, sum = {0, 0};
+			sum8_ref(&ref, &test_buf[offset], len);
+			rp_sum8_sse2(&sum, &test_buf[offset], len);
+			EXPECT_EQ(ref.even, sum.even) << "offset == " << offset << ", len == " << len;
+			EXPECT_EQ(ref.odd, sum.odd) << "offset == " << offset << ", len == " << len;
+		}
+	}
+}
+#endif /* SUM8_HAS_SSE2 */
+
+/**
+ * Test the dispatch function with multiple blocks.
+ */
+TEST_F(Sum8Test, sum8_blocks_test)
+{
+	rp_sum8_t ref = {0, 0};
+	sum8_ref(&ref, test_buf, TEST_BUF_SIZE);
+
+	rp_sum8_t sum = {0, 0};
+	rp_sum8(&sum, test_buf, TEST_BUF_SIZE);
+	EXPECT_EQ(ref.even, sum.even);
+	EXPECT_EQ(ref.odd, sum.odd);
+
+	// Process the buffer in even-sized blocks.
+	sum.even = 0;
+	sum.odd = 0;
+	for (unsigned int pos = 0; pos < TEST_BUF_SIZE; pos += 1000) {
+		const unsigned int len = (TEST_BUF_SIZE - pos < 1000 ? TEST_BUF_SIZE - pos : 1000);
+		rp_sum8(&sum, &test_buf[pos], len);
+	}
+	EXPECT_EQ(ref.even, sum.even);
+	EXPECT_EQ(ref.odd, sum.odd);
+}
+
+/**
+ * Benchmark the standard byte sum function.
+ */
+TEST_F(Sum8Test, sum8_c_benchmark)
+{
+	rp_sum8_t sum = {0, 0};
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_sum8_c(&sum, test_buf, 65536);
+	}
+	EXPECT_NE(0U, sum.even + sum.odd);
+}
+
+#ifdef SUM8_HAS_SSE2
+/**
+ * Benchmark the SSE2-optimized byte sum function.
+ */
+TEST_F(Sum8Test, sum8_sse2_benchmark)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	rp_sum8_t sum = {0, 0};
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_sum8_sse2(&sum, test_buf, 65536);
+	}
+	EXPECT_NE(0U, sum.even + sum.odd);
+}
+#endif /* SUM8_HAS_SSE2 */
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpCpu test suite: Byte sum tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n", LibRpCpu::Tests::Sum8Test::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
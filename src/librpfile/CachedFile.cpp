@@ -0,0 +1,266 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * CachedFile.cpp: IRpFile wrapper with an LRU page cache.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CachedFile.hpp"
+
+// C++ STL classes.
+using std::unique_ptr;
+
+namespace LibRpFile {
+
+/**
+ * Create a CachedFile.
+ * The underlying file is ref()'d.
+ * @param file		[in] Underlying file.
+ * @param pageSize	[in] Page size. (must be a power of two)
+ * @param cacheSize	[in] Maximum amount of cached data, in bytes.
+ */
+CachedFile::CachedFile(IRpFile *file, unsigned int pageSize, size_t cacheSize)
+	: super()
+	, m_file(nullptr)
+	, m_pos(0)
+	, m_size(0)
+	, m_pageSize(pageSize)
+	, m_maxPages(0)
+	, m_raEnd(-1)
+	, m_raPages(1)
+	, m_raMaxPages(1)
+{
+	assert(file != nullptr);
+	assert(pageSize >= 512);
+	const bool isPow2 = (pageSize & (pageSize - 1)) == 0;
+	assert(isPow2);
+	if (!file || !file->isOpen()) {
+		m_lastError = EBADF;
+		return;
+	} else if (pageSize < 512 || !isPow2) {
+		m_lastError = EINVAL;
+		return;
+	}
+
+	m_size = file->size();
+	if (m_size < 0) {
+		m_lastError = file->lastError();
+		if (m_lastError == 0) {
+			m_lastError = EIO;
+		}
+		return;
+	}
+
+	// Keep at least 4 pages so a small read
+	// spanning page boundaries can always be cached.
+	m_maxPages = cacheSize / pageSize;
+	if (m_maxPages < 4) {
+		m_maxPages = 4;
+	}
+	m_pageMap.reserve(m_maxPages);
+	m_raMaxPages = static_cast<unsigned int>(m_maxPages / 4);
+
+	m_file = file->ref();
+	m_isCompressed = file->isCompressed();
+	m_fileType = static_cast<uint8_t>(file->fileType());
+}
+
+CachedFile::~CachedFile()
+{
+	UNREF(m_file);
+}
+
+/**
+ * Close the file.
+ */
+void CachedFile::close(void)
+{
+	UNREF_AND_NULL(m_file);
+	m_pageMap.clear();
+	m_pages.clear();
+}
+
+/**
+ * Load pages into the cache, evicting the least recently
+ * used pages if necessary. Consecutive pages that aren't
+ * cached are read from the underlying file using a single read.
+ * @param pageIdxStart	[in] First page index.
+ * @param pageCount	[in] Number of pages.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CachedFile::loadPages(off64_t pageIdxStart, unsigned int pageCount)
+{
+	assert(pageCount <= m_maxPages);
+	const off64_t pageIdxEnd = pageIdxStart + pageCount;
+
+	for (off64_t pageIdx = pageIdxStart; pageIdx < pageIdxEnd; ) {
+		auto iter = m_pageMap.find(pageIdx);
+		if (iter != m_pageMap.end()) {
+			// Page is already cached.
+			// Move it to the front of the LRU list.
+			m_pages.splice(m_pages.begin(), m_pages, iter->second);
+			pageIdx++;
+			continue;
+		}
+
+		// Find the end of this run of uncached pages.
+		off64_t runEnd = pageIdx + 1;
+		while (runEnd < pageIdxEnd && m_pageMap.find(runEnd) == m_pageMap.end()) {
+			runEnd++;
+		}
+
+		// Read the entire run at once.
+		const off64_t runPos = pageIdx * m_pageSize;
+		off64_t runSize64 = (runEnd - pageIdx) * m_pageSize;
+		if (runPos + runSize64 > m_size) {
+			runSize64 = m_size - runPos;
+		}
+		const size_t runSize = static_cast<size_t>(runSize64);
+		unique_ptr<uint8_t[]> runBuf(new uint8_t[runSize]);
+		const size_t sz_read = m_file->seekAndRead(runPos, runBuf.get(), runSize);
+		if (sz_read != runSize) {
+			// Read error.
+			m_lastError = m_file->lastError();
+			if (m_lastError == 0) {
+				m_lastError = EIO;
+			}
+			return -m_lastError;
+		}
+
+		// Split the run into pages.
+		for (size_t offset = 0; pageIdx < runEnd; pageIdx++, offset += m_pageSize) {
+			Page page;
+			page.pageIdx = pageIdx;
+			page.size = std::min(static_cast<size_t>(m_pageSize), runSize - offset);
+			page.data.reset(new uint8_t[page.size]);
+			memcpy(page.data.get(), &runBuf[offset], page.size);
+			m_pages.emplace_front(std::move(page));
+			m_pageMap[pageIdx] = m_pages.begin();
+		}
+	}
+
+	// Evict the least recently used pages.
+	while (m_pages.size() > m_maxPages) {
+		m_pageMap.erase(m_pages.back().pageIdx);
+		m_pages.pop_back();
+	}
+	return 0;
+}
+
+/**
+ * Read data from the file.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t CachedFile::read(void *ptr, size_t size)
+{
+	const size_t ret = readAt(m_pos, ptr, size);
+	m_pos += ret;
+	return ret;
+}
+
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t CachedFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	} else if (pos >= m_size || size == 0) {
+		// Nothing to read.
+		return 0;
+	}
+
+	if (static_cast<off64_t>(size) > m_size - pos) {
+		size = static_cast<size_t>(m_size - pos);
+	}
+
+	// Don't cache large reads, since they would
+	// evict most of the cache.
+	if (size >= (m_maxPages / 2) * m_pageSize) {
+		const size_t ret = m_file->seekAndRead(pos, ptr, size);
+		m_lastError = m_file->lastError();
+		return ret;
+	}
+
+	const off64_t pageIdxStart = pos / m_pageSize;
+	const off64_t pageIdxEnd = (pos + size - 1) / m_pageSize + 1;
+
+	// Find the first uncached page, if any.
+	off64_t missIdx = pageIdxStart;
+	while (missIdx < pageIdxEnd && m_pageMap.find(missIdx) != m_pageMap.end()) {
+		missIdx++;
+	}
+
+	off64_t loadEnd = pageIdxEnd;
+	if (missIdx < pageIdxEnd) {
+		// Cache miss. If it continues the previous read-ahead,
+		// the file is being read sequentially, so double the window.
+		if (missIdx == m_raEnd) {
+			m_raPages = std::min(m_raPages * 2, m_raMaxPages);
+		} else {
+			m_raPages = 1;
+		}
+
+		const off64_t pageCount = (m_size + m_pageSize - 1) / m_pageSize;
+		loadEnd = std::min(std::max(pageIdxEnd, missIdx + m_raPages), pageCount);
+		m_raEnd = loadEnd;
+	}
+
+	if (loadPages(pageIdxStart, static_cast<unsigned int>(loadEnd - pageIdxStart)) != 0) {
+		// Read error.
+		return 0;
+	}
+
+	// Copy the data from the cached pages.
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	for (off64_t pageIdx = pageIdxStart; pageIdx < pageIdxEnd; pageIdx++) {
+		const Page &page = *(m_pageMap.find(pageIdx)->second);
+		const size_t pageOffset = static_cast<size_t>(pos - (pageIdx * m_pageSize));
+		if (pageOffset >= page.size) {
+			// Short page. (end of file)
+			break;
+		}
+
+		const size_t sz = std::min(size - ret, page.size - pageOffset);
+		memcpy(ptr8, &page.data[pageOffset], sz);
+		ptr8 += sz;
+		pos += sz;
+		ret += sz;
+	}
+	return ret;
+}
+
+/**
+ * Set the file position.
+ * @param pos File position.
+ * @return 0 on success; -1 on error.
+ */
+int CachedFile::seek(off64_t pos)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return -1;
+	}
+
+	m_pos = pos;
+	return 0;
+}
+
+}
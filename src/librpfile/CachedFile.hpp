@@ -0,0 +1,212 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * CachedFile.hpp: IRpFile wrapper with an LRU page cache.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPFILE_CACHEDFILE_HPP__
+#define __ROMPROPERTIES_LIBRPFILE_CACHEDFILE_HPP__
+
+#include "librpfile/IRpFile.hpp"
+
+// C++ includes.
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace LibRpFile {
+
+/**
+ * IRpFile wrapper that caches fixed-size, aligned pages
+ * of the underlying file in an LRU cache.
+ *
+ * This is intended for files where each read is expensive,
+ * e.g. RpFile_kio and RpFile_gio, since RomData subclasses
+ * tend to re-read the same regions.
+ *
+ * Cache misses also read ahead. The read-ahead window starts
+ * at one page and doubles each time a miss continues where the
+ * previous read-ahead ended, up to a quarter of the cache.
+ * Any other miss resets the window.
+ *
+ * NOTE: CachedFile is read-only, and it is NOT thread-safe.
+ */
+class CachedFile final : public IRpFile
+{
+	public:
+		// Default page size and cache size.
+		static const unsigned int DEFAULT_PAGE_SIZE = 64U*1024U;
+		static const size_t DEFAULT_CACHE_SIZE = 4U*1024U*1024U;
+
+		/**
+		 * Create a CachedFile.
+		 * The underlying file is ref()'d.
+		 * @param file		[in] Underlying file.
+		 * @param pageSize	[in] Page size. (must be a power of two)
+		 * @param cacheSize	[in] Maximum amount of cached data, in bytes.
+		 */
+		explicit CachedFile(IRpFile *file,
+			unsigned int pageSize = DEFAULT_PAGE_SIZE,
+			size_t cacheSize = DEFAULT_CACHE_SIZE);
+	protected:
+		virtual ~CachedFile();	// call unref() instead
+
+	private:
+		typedef IRpFile super;
+		RP_DISABLE_COPY(CachedFile)
+
+	public:
+		/**
+		 * Is the file open?
+		 * This usually only returns false if an error occurred.
+		 * @return True if the file is open; false if it isn't.
+		 */
+		bool isOpen(void) const final
+		{
+			return (m_file != nullptr && m_file->isOpen());
+		}
+
+		/**
+		 * Close the file.
+		 */
+		void close(void) final;
+
+		/**
+		 * Read data from the file.
+		 * @param ptr Output data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 2, 3)
+		size_t read(void *ptr, size_t size) final;
+
+		/**
+		 * Read data from the file at the specified position.
+		 * The file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
+		/**
+		 * Write data to the file.
+		 * (NOTE: Not valid for CachedFile; this will always return 0.)
+		 * @param ptr Input data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes written.
+		 */
+		ATTR_ACCESS_SIZE(read_only, 2, 3)
+		size_t write(const void *ptr, size_t size) final
+		{
+			// Not a valid operation for CachedFile.
+			RP_UNUSED(ptr);
+			RP_UNUSED(size);
+			m_lastError = EBADF;
+			return 0;
+		}
+
+		/**
+		 * Set the file position.
+		 * @param pos File position.
+		 * @return 0 on success; -1 on error.
+		 */
+		int seek(off64_t pos) final;
+
+		/**
+		 * Get the file position.
+		 * @return File position, or -1 on error.
+		 */
+		off64_t tell(void) final
+		{
+			if (!m_file) {
+				m_lastError = EBADF;
+				return -1;
+			}
+			return m_pos;
+		}
+
+		/**
+		 * Advise the OS of the expected access pattern.
+		 * This is forwarded to the underlying file.
+		 * @param pattern	[in] Access pattern.
+		 * @param offset	[in] Starting offset.
+		 * @param len		[in] Length, or 0 for the rest of the file.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int adviseAccess(AccessPattern pattern, off64_t offset = 0, off64_t len = 0) final
+		{
+			if (!m_file) {
+				m_lastError = EBADF;
+				return -EBADF;
+			}
+			return m_file->adviseAccess(pattern, offset, len);
+		}
+
+	public:
+		/** File properties **/
+
+		/**
+		 * Get the file size.
+		 * @return File size, or negative on error.
+		 */
+		off64_t size(void) final
+		{
+			if (!m_file) {
+				m_lastError = EBADF;
+				return -1;
+			}
+			return m_size;
+		}
+
+		/**
+		 * Get the filename.
+		 * @return Filename. (May be empty if the filename is not available.)
+		 */
+		std::string filename(void) const final
+		{
+			return (m_file ? m_file->filename() : std::string());
+		}
+
+	private:
+		struct Page {
+			off64_t pageIdx;			// Page index.
+			size_t size;				// Valid data size. (may be short at EOF)
+			std::unique_ptr<uint8_t[]> data;	// Page data.
+		};
+		typedef std::list<Page> PageList;
+
+		/**
+		 * Load pages into the cache, evicting the least recently
+		 * used pages if necessary. Consecutive pages that aren't
+		 * cached are read from the underlying file using a single read.
+		 * @param pageIdxStart	[in] First page index.
+		 * @param pageCount	[in] Number of pages.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadPages(off64_t pageIdxStart, unsigned int pageCount);
+
+	private:
+		IRpFile *m_file;
+		off64_t m_pos;		// Current position.
+		off64_t m_size;		// File size.
+		unsigned int m_pageSize;
+		size_t m_maxPages;
+
+		// Read-ahead
+		off64_t m_raEnd;		// Page index after the last read-ahead.
+		unsigned int m_raPages;		// Current read-ahead window, in pages.
+		unsigned int m_raMaxPages;	// Maximum read-ahead window, in pages.
+
+		// LRU list. (most recently used first)
+		PageList m_pages;
+		std::unordered_map<off64_t, PageList::iterator> m_pageMap;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPFILE_CACHEDFILE_HPP__ */
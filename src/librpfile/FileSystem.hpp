@@ -179,6 +179,25 @@ bool isOnBadFS(const char *filename, bool netFS = false);
  */
 int get_file_size_and_mtime(const std::string &filename, off64_t *pFileSize, time_t *pMtime);
 
+/**
+ * File identity information.
+ * Used to detect if a file has changed without reading it.
+ */
+struct FileIdentity {
+	uint64_t device;	// Device ID (Windows: volume serial number)
+	uint64_t inode;		// Inode number (Windows: file index)
+	int64_t size;		// File size
+	int64_t mtime_ns;	// Modification time, in nanoseconds since the Unix epoch
+};
+
+/**
+ * Get a file's identity: device, inode, size, and modification time.
+ * @param filename	[in] Filename.
+ * @param pIdentity	[out] File identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_identity(const std::string &filename, FileIdentity *pIdentity);
+
 } }
 
 #endif /* __ROMPROPERTIES_LIBRPFILE_FILESYSTEM_HPP__ */
@@ -18,6 +18,7 @@
 
 #ifdef __linux__
 // TODO: Remove once /proc/mounts parsing is implemented.
+# include <sys/sysmacros.h>	// makedev()
 # include <sys/vfs.h>
 # include <linux/magic.h>
 // from `man 2 fstatfs`, but not present in linux/magic.h on 4.14-r1
@@ -41,6 +42,17 @@
 # endif /* OCFS2_SUPER_MAGIC */
 #endif /* __linux__ */
 
+#ifdef __linux__
+// librpthreads
+# include "librpthreads/Mutex.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+// C++ includes.
+# include <unordered_map>
+using std::unordered_map;
+#endif /* __linux__ */
+
 // C++ STL classes.
 using std::string;
 using std::u16string;
@@ -270,30 +282,40 @@ string resolve_symlink(const char *filename)
 	return ret;
 }
 
+#ifdef __linux__
+namespace FileSystemPrivate {
+
+// File system classification for isOnBadFS().
+enum class FsClass : uint8_t {
+	Unknown,	// statfs() failed
+	Normal,		// Local file system
+	Bad,		// procfs, sysfs, etc.
+	Network,	// Network file system
+};
+
+// File system classification cache, keyed by device ID.
+// Every thumbnail request calls isOnBadFS(), and files in
+// the same directory are nearly always on the same device.
+static unordered_map<dev_t, FsClass> map_fsClass;
+static Mutex mtxFsClass;
+
+// Maximum number of devices in the classification cache.
+static const size_t MAX_FS_CLASS_ENTRIES = 64;
+
 /**
- * Is a file located on a "bad" file system?
- *
- * We don't want to check files on e.g. procfs,
- * or on network file systems if the option is disabled.
- *
+ * Classify the file system a file is located on.
  * @param filename Filename.
- * @param netFS If true, allow network file systems.
- *
- * @return True if this file is on a "bad" file system; false if not.
+ * @return File system classification.
  */
-bool isOnBadFS(const char *filename, bool netFS)
+static FsClass classifyFS(const char *filename)
 {
-	bool bRet = false;
-
-#ifdef __linux__
 	// TODO: Get the mount point, then look it up in /proc/mounts.
 
 	struct statfs sfbuf;
 	int ret = statfs(filename, &sfbuf);
 	if (ret != 0) {
 		// statfs() failed.
-		// Assume this isn't a network file system.
-		return false;
+		return FsClass::Unknown;
 	}
 
 	switch (static_cast<uint32_t>(sfbuf.f_type)) {
@@ -311,8 +333,7 @@ bool isOnBadFS(const char *filename, bool netFS)
 		case TRACEFS_MAGIC:
 		case USBDEVICE_SUPER_MAGIC:
 			// Bad file systems.
-			bRet = true;
-			break;
+			return FsClass::Bad;
 
 		case AFS_SUPER_MAGIC:
 		case CIFS_MAGIC_NUMBER:
@@ -324,27 +345,99 @@ bool isOnBadFS(const char *filename, bool netFS)
 		case SMB_SUPER_MAGIC:
 		case V9FS_MAGIC:
 			// Network file system.
-			// Allow it if we're allowing network file systems.
-			bRet = !netFS;
-			break;
+			return FsClass::Network;
 
 		case FUSE_SUPER_MAGIC:	// TODO: Check the actual fs type.
 			// Other file system.
 			// FIXME: `fuse` is used for various local file systems
 			// as well as sshfs. Local is more common, so let's assume
 			// it's in use for a local file system.
-			break;
+			return FsClass::Normal;
 
 		default:
-			break;
+			return FsClass::Normal;
+	}
+}
+
+}
+#endif /* __linux__ */
+
+/**
+ * Is a file located on a "bad" file system?
+ *
+ * We don't want to check files on e.g. procfs,
+ * or on network file systems if the option is disabled.
+ *
+ * On Linux, file system classifications are cached by device ID,
+ * so statfs() is only called once per mounted file system.
+ *
+ * @param filename Filename.
+ * @param netFS If true, allow network file systems.
+ *
+ * @return True if this file is on a "bad" file system; false if not.
+ */
+bool isOnBadFS(const char *filename, bool netFS)
+{
+#ifdef __linux__
+	using namespace FileSystemPrivate;
+
+	// Get the file's device ID. This is usually answered from the
+	// inode cache, whereas statfs() may require a round trip to
+	// the server on network file systems.
+	dev_t dev;
+#ifdef HAVE_STATX
+	struct statx sbx;
+	int ret = statx(AT_FDCWD, filename, 0, 0, &sbx);
+	if (ret != 0) {
+		// statx() failed.
+		// Assume this isn't a network file system.
+		return false;
+	}
+	dev = makedev(sbx.stx_dev_major, sbx.stx_dev_minor);
+#else /* !HAVE_STATX */
+	struct stat sb;
+	int ret = stat(filename, &sb);
+	if (ret != 0) {
+		// stat() failed.
+		// Assume this isn't a network file system.
+		return false;
+	}
+	dev = sb.st_dev;
+#endif /* HAVE_STATX */
+
+	FsClass fsClass;
+	{
+		MutexLocker mtxLocker(mtxFsClass);
+		auto iter = map_fsClass.find(dev);
+		if (iter != map_fsClass.end()) {
+			fsClass = iter->second;
+		} else {
+			fsClass = classifyFS(filename);
+			if (fsClass != FsClass::Unknown) {
+				if (map_fsClass.size() >= MAX_FS_CLASS_ENTRIES) {
+					// Too many devices. Start over.
+					map_fsClass.clear();
+				}
+				map_fsClass.emplace(dev, fsClass);
+			}
+		}
+	}
+
+	switch (fsClass) {
+		case FsClass::Bad:
+			return true;
+		case FsClass::Network:
+			// Allow it if we're allowing network file systems.
+			return !netFS;
+		default:
+			return false;
 	}
 #else
 # warning TODO: Implement "badfs" support for non-Linux systems.
 	RP_UNUSED(filename);
 	RP_UNUSED(netFS);
+	return false;
 #endif
-
-	return bRet;
 }
 
 /**
@@ -404,4 +497,60 @@ int get_file_size_and_mtime(const string &filename, off64_t *pFileSize, time_t *
 	return 0;
 }
 
+/**
+ * Get a file's identity: device, inode, size, and modification time.
+ * @param filename	[in] Filename.
+ * @param pIdentity	[out] File identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_identity(const string &filename, FileIdentity *pIdentity)
+{
+	assert(pIdentity != nullptr);
+
+#ifdef HAVE_STATX
+	struct statx sbx;
+	static const unsigned int mask = STATX_TYPE | STATX_INO | STATX_MTIME | STATX_SIZE;
+	int ret = statx(AT_FDCWD, filename.c_str(), 0, mask, &sbx);
+	if (ret != 0 || (sbx.stx_mask & mask) != mask) {
+		// statx() failed and/or did not return the required fields.
+		int ret = -errno;
+		return (ret != 0 ? ret : -EIO);
+	}
+
+	// Make sure this is not a directory.
+	if (S_ISDIR(sbx.stx_mode)) {
+		// It's a directory.
+		return -EISDIR;
+	}
+
+	pIdentity->device = (static_cast<uint64_t>(sbx.stx_dev_major) << 32) | sbx.stx_dev_minor;
+	pIdentity->inode = sbx.stx_ino;
+	pIdentity->size = sbx.stx_size;
+	pIdentity->mtime_ns = (static_cast<int64_t>(sbx.stx_mtime.tv_sec) * 1000000000LL) + sbx.stx_mtime.tv_nsec;
+#else /* !HAVE_STATX */
+	struct stat sb;
+	int ret = stat(filename.c_str(), &sb);
+	if (ret != 0) {
+		// stat() failed.
+		int ret = -errno;
+		return (ret != 0 ? ret : -EIO);
+	}
+
+	// Make sure this is not a directory.
+	if (S_ISDIR(sb.st_mode)) {
+		// It's a directory.
+		return -EISDIR;
+	}
+
+	// NOTE: Only using the seconds field, since the
+	// nanoseconds field isn't portable.
+	pIdentity->device = sb.st_dev;
+	pIdentity->inode = sb.st_ino;
+	pIdentity->size = sb.st_size;
+	pIdentity->mtime_ns = static_cast<int64_t>(sb.st_mtime) * 1000000000LL;
+#endif /* HAVE_STATX */
+
+	return 0;
+}
+
 } }
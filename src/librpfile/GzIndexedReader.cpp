@@ -0,0 +1,468 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * GzIndexedReader.cpp: gzip decompressor with a random-access index.      *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "GzIndexedReader.hpp"
+
+namespace LibRpFile {
+
+// Maximum deflate window size.
+#define GZ_WINDOW_SIZE 32768U
+// Input buffer size.
+#define GZ_INBUF_SIZE 32768U
+
+// librpthreads
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+// C++ STL classes.
+using std::string;
+using std::vector;
+
+// Process-wide index cache.
+vector<GzIndexedReader::CachedIndex> GzIndexedReader::ms_indexCache;
+Mutex GzIndexedReader::ms_indexCacheMutex;
+
+/**
+ * Create a GzIndexedReader.
+ * @param pfnReadAt	[in] Function to read compressed data.
+ * @param userdata	[in] User data for pfnReadAt.
+ */
+GzIndexedReader::GzIndexedReader(pfnReadAt_t pfnReadAt, void *userdata)
+	: m_pfnReadAt(pfnReadAt)
+	, m_userdata(userdata)
+	, m_isInit(false)
+	, m_isRaw(false)
+	, m_isEOF(false)
+	, m_lastError(0)
+	, m_pos(0)
+	, m_outPos(0)
+	, m_inPos(0)
+	, m_winPos(0)
+	, m_winFill(0)
+	, m_prefixLen(0)
+	, m_recentPos(0)
+	, m_recentLen(0)
+	, m_cacheCompSize(0)
+	, m_cacheMtime(0)
+{
+	assert(pfnReadAt != nullptr);
+
+	memset(&m_strm, 0, sizeof(m_strm));
+	// gzip format only. (15 + 16)
+	if (inflateInit2(&m_strm, 15+16) != Z_OK) {
+		m_lastError = ENOMEM;
+		return;
+	}
+
+	m_inBuf.reset(new uint8_t[GZ_INBUF_SIZE]);
+	m_window.reset(new uint8_t[GZ_WINDOW_SIZE]);
+	m_prefix.reset(new uint8_t[PREFIX_SIZE]);
+	m_isInit = true;
+}
+
+GzIndexedReader::~GzIndexedReader()
+{
+	if (m_isInit) {
+		if (!m_cacheFilename.empty()) {
+			saveIndexCache();
+		}
+		inflateEnd(&m_strm);
+	}
+}
+
+/**
+ * Use the process-wide index cache for this file.
+ * If a previous reader cached an index for this file,
+ * it will be loaded now. The index will be cached again
+ * when this reader is destroyed.
+ *
+ * This must be called before the first read().
+ *
+ * @param filename	[in] Filename
+ * @param compSize	[in] Compressed file size
+ * @param mtime		[in] Modification time
+ */
+void GzIndexedReader::useIndexCache(const string &filename, off64_t compSize, time_t mtime)
+{
+	assert(!filename.empty());
+	assert(m_outPos == 0 && m_prefixLen == 0);
+	if (!m_isInit || filename.empty() || m_outPos != 0 || m_prefixLen != 0) {
+		return;
+	}
+
+	m_cacheFilename = filename;
+	m_cacheCompSize = compSize;
+	m_cacheMtime = mtime;
+
+	MutexLocker mtxLocker(ms_indexCacheMutex);
+	for (auto iter = ms_indexCache.begin(); iter != ms_indexCache.end(); ++iter) {
+		if (iter->filename != filename)
+			continue;
+
+		if (iter->compSize == compSize && iter->mtime == mtime) {
+			// Found a valid index.
+			// NOTE: The index is moved, not copied. If the same file
+			// is opened again before this reader is destroyed, the
+			// other reader will build its own index.
+			m_checkpoints = std::move(iter->checkpoints);
+			if (iter->prefix) {
+				m_prefix = std::move(iter->prefix);
+				m_prefixLen = iter->prefixLen;
+			}
+			m_recent = std::move(iter->recent);
+			m_recentPos = iter->recentPos;
+			m_recentLen = iter->recentLen;
+		}
+
+		// The cache entry is either stale or in use now.
+		ms_indexCache.erase(iter);
+		break;
+	}
+}
+
+/**
+ * Save the index to the process-wide index cache.
+ */
+void GzIndexedReader::saveIndexCache(void)
+{
+	if (m_lastError != 0 || (m_prefixLen == 0 && m_checkpoints.empty())) {
+		// Nothing worth caching.
+		return;
+	}
+
+	CachedIndex index;
+	index.filename = std::move(m_cacheFilename);
+	index.compSize = m_cacheCompSize;
+	index.mtime = m_cacheMtime;
+	index.checkpoints = std::move(m_checkpoints);
+	index.prefix = std::move(m_prefix);
+	index.prefixLen = m_prefixLen;
+
+	if (m_winFill > 0) {
+		// Save the most recently decompressed data, oldest byte first.
+		index.recent.reset(new uint8_t[m_winFill]);
+		index.recentPos = m_outPos - m_winFill;
+		index.recentLen = m_winFill;
+		if (m_winFill == GZ_WINDOW_SIZE) {
+			const unsigned int tail = GZ_WINDOW_SIZE - m_winPos;
+			memcpy(index.recent.get(), &m_window[m_winPos], tail);
+			memcpy(&index.recent[tail], m_window.get(), m_winPos);
+		} else {
+			// The window hasn't wrapped around since the last reset.
+			assert(m_winPos >= m_winFill);
+			memcpy(index.recent.get(), &m_window[m_winPos - m_winFill], m_winFill);
+		}
+	} else {
+		// Nothing was decompressed by this reader.
+		// Keep the data from the previous reader, if any.
+		index.recent = std::move(m_recent);
+		index.recentPos = m_recentPos;
+		index.recentLen = m_recentLen;
+	}
+
+	MutexLocker mtxLocker(ms_indexCacheMutex);
+	for (auto iter = ms_indexCache.begin(); iter != ms_indexCache.end(); ++iter) {
+		if (iter->filename == index.filename) {
+			// Another reader cached this file in the meantime.
+			ms_indexCache.erase(iter);
+			break;
+		}
+	}
+	if (ms_indexCache.size() >= INDEX_CACHE_MAX) {
+		// Remove the least recently used entry.
+		ms_indexCache.pop_back();
+	}
+	ms_indexCache.emplace(ms_indexCache.begin(), std::move(index));
+}
+
+/**
+ * Restart decompression from the beginning of the file.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GzIndexedReader::restart(void)
+{
+	if (inflateReset2(&m_strm, 15+16) != Z_OK) {
+		m_lastError = EIO;
+		return -EIO;
+	}
+	m_strm.avail_in = 0;
+	m_isRaw = false;
+	m_isEOF = false;
+	m_outPos = 0;
+	m_inPos = 0;
+	m_winPos = 0;
+	m_winFill = 0;
+	return 0;
+}
+
+/**
+ * Restart decompression from a checkpoint.
+ * @param idx Checkpoint index.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GzIndexedReader::restoreCheckpoint(size_t idx)
+{
+	assert(idx < m_checkpoints.size());
+	const Checkpoint &cp = m_checkpoints[idx];
+
+	// Checkpoints are in the middle of a deflate stream,
+	// so the gzip header must not be processed.
+	if (inflateReset2(&m_strm, -15) != Z_OK) {
+		m_lastError = EIO;
+		return -EIO;
+	}
+	m_strm.avail_in = 0;
+	m_isRaw = true;
+	m_isEOF = false;
+
+	m_inPos = cp.in;
+	if (cp.bits != 0) {
+		// Checkpoint is in the middle of a byte.
+		uint8_t b;
+		if (m_pfnReadAt(m_userdata, cp.in - 1, &b, 1) != 1) {
+			m_lastError = EIO;
+			return -EIO;
+		}
+		inflatePrime(&m_strm, cp.bits, b >> (8 - cp.bits));
+	}
+	inflateSetDictionary(&m_strm, cp.window.get(), cp.winLen);
+
+	// Restore the sliding window so new checkpoints can be saved.
+	memcpy(m_window.get(), cp.window.get(), cp.winLen);
+	m_winPos = cp.winLen;
+	m_winFill = cp.winLen;
+	m_outPos = cp.out;
+	return 0;
+}
+
+/**
+ * Save a checkpoint at the current position.
+ * This must be called at a deflate block boundary.
+ */
+void GzIndexedReader::saveCheckpoint(void)
+{
+	Checkpoint cp;
+	cp.out = m_outPos;
+	cp.in = m_inPos - m_strm.avail_in;
+	cp.bits = m_strm.data_type & 7;
+
+	// Save the window in order, oldest byte first.
+	// NOTE: m_outPos is always >= GZ_WINDOW_SIZE here,
+	// since checkpoints are at least CHECKPOINT_SPAN apart.
+	assert(m_outPos >= GZ_WINDOW_SIZE);
+	cp.window.reset(new uint8_t[GZ_WINDOW_SIZE]);
+	cp.winLen = GZ_WINDOW_SIZE;
+	const unsigned int tail = GZ_WINDOW_SIZE - m_winPos;
+	memcpy(cp.window.get(), &m_window[m_winPos], tail);
+	memcpy(&cp.window[tail], m_window.get(), m_winPos);
+
+	m_checkpoints.emplace_back(std::move(cp));
+}
+
+/**
+ * Decompress data from the current stream position.
+ * @param ptr Output buffer, or nullptr to discard the data.
+ * @param size Amount of data to decompress.
+ * @return Number of bytes decompressed.
+ */
+size_t GzIndexedReader::inflateTo(uint8_t *ptr, size_t size)
+{
+	size_t done = 0;
+	while (done < size && !m_isEOF) {
+		if (m_strm.avail_in == 0) {
+			const size_t sz_read = m_pfnReadAt(m_userdata, m_inPos, m_inBuf.get(), GZ_INBUF_SIZE);
+			if (sz_read == 0) {
+				// End of file. (The gzip stream may be truncated.)
+				m_isEOF = true;
+				break;
+			}
+			m_inPos += sz_read;
+			m_strm.next_in = m_inBuf.get();
+			m_strm.avail_in = static_cast<uInt>(sz_read);
+		}
+
+		// Decompress into the sliding window.
+		if (m_winPos == GZ_WINDOW_SIZE) {
+			m_winPos = 0;
+		}
+		unsigned int avail = GZ_WINDOW_SIZE - m_winPos;
+		if (avail > size - done) {
+			avail = static_cast<unsigned int>(size - done);
+		}
+		uint8_t *const out = &m_window[m_winPos];
+		m_strm.next_out = out;
+		m_strm.avail_out = avail;
+		const int ret = inflate(&m_strm, Z_BLOCK);
+		const unsigned int have = avail - m_strm.avail_out;
+
+		if (have > 0) {
+			if (m_outPos == m_prefixLen && m_prefixLen < PREFIX_SIZE) {
+				// Save the decompressed prefix.
+				const unsigned int sz = std::min(have, PREFIX_SIZE - static_cast<unsigned int>(m_outPos));
+				memcpy(&m_prefix[m_prefixLen], out, sz);
+				m_prefixLen += sz;
+			}
+			if (ptr) {
+				memcpy(&ptr[done], out, have);
+			}
+			m_winPos += have;
+			m_winFill = std::min(m_winFill + have, GZ_WINDOW_SIZE);
+			m_outPos += have;
+			done += have;
+		}
+
+		switch (ret) {
+			case Z_OK:
+			case Z_BUF_ERROR: {
+				// Save a checkpoint at block boundaries, other than the last block.
+				const off64_t lastOut = (!m_checkpoints.empty() ? m_checkpoints.back().out : 0);
+				if ((m_strm.data_type & 128) && !(m_strm.data_type & 64) &&
+				    m_outPos >= lastOut + CHECKPOINT_SPAN)
+				{
+					saveCheckpoint();
+				}
+				break;
+			}
+
+			case Z_STREAM_END: {
+				// End of a gzip member.
+				off64_t nextIn = m_inPos - m_strm.avail_in;
+				if (m_isRaw) {
+					// Raw deflate doesn't process the trailer. (CRC32 + ISIZE)
+					nextIn += 8;
+				}
+
+				// Check for another gzip member.
+				// Anything else after the member is ignored, same as gzread().
+				uint8_t gzmagic[2];
+				if (m_pfnReadAt(m_userdata, nextIn, gzmagic, sizeof(gzmagic)) == sizeof(gzmagic) &&
+				    gzmagic[0] == 0x1F && gzmagic[1] == 0x8B &&
+				    inflateReset2(&m_strm, 15+16) == Z_OK)
+				{
+					m_strm.avail_in = 0;
+					m_inPos = nextIn;
+					m_isRaw = false;
+				} else {
+					m_isEOF = true;
+				}
+				break;
+			}
+
+			default:
+				// Decompression error.
+				m_lastError = EIO;
+				m_isEOF = true;
+				break;
+		}
+	}
+
+	return done;
+}
+
+/**
+ * Read decompressed data.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t GzIndexedReader::read(void *ptr, size_t size)
+{
+	if (!m_isInit) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	if (m_prefixLen == 0 && m_outPos == 0 && m_pos < PREFIX_SIZE) {
+		// Decompress the entire prefix on the first read.
+		// This should be enough for the whole detection pass.
+		inflateTo(nullptr, PREFIX_SIZE);
+	}
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	if (m_pos < m_prefixLen) {
+		// Read from the prefix cache.
+		const size_t sz = std::min(size, static_cast<size_t>(m_prefixLen - m_pos));
+		memcpy(ptr8, &m_prefix[static_cast<size_t>(m_pos)], sz);
+		m_pos += sz;
+		ptr8 += sz;
+		size -= sz;
+		ret = sz;
+		if (size == 0) {
+			return ret;
+		}
+	}
+
+	if (m_recentLen > 0 && m_pos >= m_recentPos && m_pos < m_recentPos + m_recentLen) {
+		// Read from the previous reader's most recently decompressed data.
+		const size_t sz = std::min(size, static_cast<size_t>(m_recentPos + m_recentLen - m_pos));
+		memcpy(ptr8, &m_recent[static_cast<size_t>(m_pos - m_recentPos)], sz);
+		m_pos += sz;
+		ptr8 += sz;
+		size -= sz;
+		ret += sz;
+		if (size == 0) {
+			return ret;
+		}
+	}
+
+	if (m_pos != m_outPos) {
+		// Find the last checkpoint at or before the requested position.
+		auto iter = std::upper_bound(m_checkpoints.cbegin(), m_checkpoints.cend(), m_pos,
+			[](off64_t pos, const Checkpoint &cp) { return pos < cp.out; });
+		const bool hasCheckpoint = (iter != m_checkpoints.cbegin());
+		const size_t idx = (hasCheckpoint ? (iter - m_checkpoints.cbegin() - 1) : 0);
+
+		int err = 0;
+		if (hasCheckpoint && (m_pos < m_outPos || m_checkpoints[idx].out > m_outPos)) {
+			err = restoreCheckpoint(idx);
+		} else if (m_pos < m_outPos) {
+			err = restart();
+		}
+		if (err != 0) {
+			return ret;
+		}
+
+		// Skip ahead to the requested position.
+		while (m_outPos < m_pos && !m_isEOF) {
+			const off64_t skip = std::min(m_pos - m_outPos, static_cast<off64_t>(1U << 30));
+			inflateTo(nullptr, static_cast<size_t>(skip));
+		}
+		if (m_outPos != m_pos) {
+			// Seeked past the end of the file.
+			return ret;
+		}
+	}
+
+	const size_t sz = inflateTo(ptr8, size);
+	m_pos += sz;
+	return ret + sz;
+}
+
+/**
+ * Set the decompressed position.
+ * The actual seek is deferred until the next read().
+ * @param pos Decompressed position.
+ * @return 0 on success; -1 on error.
+ */
+int GzIndexedReader::seek(off64_t pos)
+{
+	if (!m_isInit) {
+		m_lastError = EBADF;
+		return -1;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return -1;
+	}
+
+	m_pos = pos;
+	return 0;
+}
+
+}
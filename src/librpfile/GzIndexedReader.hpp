@@ -0,0 +1,243 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * GzIndexedReader.hpp: gzip decompressor with a random-access index.      *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPFILE_GZINDEXEDREADER_HPP__
+#define __ROMPROPERTIES_LIBRPFILE_GZINDEXEDREADER_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
+
+// C++ includes.
+#include <memory>
+#include <string>
+#include <vector>
+
+// zlib
+#include <zlib.h>
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+
+namespace LibRpFile {
+
+/**
+ * Transparent gzip decompressor with a random-access index.
+ *
+ * gzseek() restarts decompression from the beginning of the file
+ * for backwards seeks. This class records a checkpoint (the inflate
+ * state at a deflate block boundary, plus the 32 KiB window) about
+ * every CHECKPOINT_SPAN bytes of output as the file is decompressed,
+ * so a seek only has to decompress from the closest checkpoint.
+ * The first PREFIX_SIZE bytes are also kept, since detection reads
+ * the beginning of the file repeatedly.
+ *
+ * If useIndexCache() is called, the index, the prefix, and the most
+ * recently decompressed 32 KiB are kept in a small process-wide cache
+ * when the reader is destroyed, so reopening the same file doesn't
+ * have to decompress it again. Formats like VGZ store their tags at
+ * the end of the file, which otherwise requires decompressing the
+ * entire file every time it's opened.
+ *
+ * Based on zran.c from the zlib examples.
+ *
+ * NOTE: This class is NOT thread-safe.
+ */
+class GzIndexedReader
+{
+	public:
+		/**
+		 * Read compressed data from the underlying file.
+		 * @param userdata	[in] User data
+		 * @param pos		[in] File position
+		 * @param ptr		[out] Output buffer
+		 * @param size		[in] Amount of data to read
+		 * @return Number of bytes read.
+		 */
+		typedef size_t (*pfnReadAt_t)(void *userdata, off64_t pos, void *ptr, size_t size);
+
+		/**
+		 * Create a GzIndexedReader.
+		 * @param pfnReadAt	[in] Function to read compressed data.
+		 * @param userdata	[in] User data for pfnReadAt.
+		 */
+		GzIndexedReader(pfnReadAt_t pfnReadAt, void *userdata);
+		~GzIndexedReader();
+
+	private:
+		RP_DISABLE_COPY(GzIndexedReader)
+
+	public:
+		// Approximate distance between checkpoints, in uncompressed bytes.
+		static const unsigned int CHECKPOINT_SPAN = 1024U*1024U;
+		// Size of the decompressed prefix cache.
+		static const unsigned int PREFIX_SIZE = 64U*1024U;
+		// Maximum number of files in the process-wide index cache.
+		static const unsigned int INDEX_CACHE_MAX = 8;
+
+		/**
+		 * Is the decompressor initialized?
+		 * @return True if it is; false if not.
+		 */
+		inline bool isOpen(void) const
+		{
+			return m_isInit;
+		}
+
+		/**
+		 * Get the last error.
+		 * @return Last POSIX error, or 0 if no error.
+		 */
+		inline int lastError(void) const
+		{
+			return m_lastError;
+		}
+
+		/**
+		 * Read decompressed data.
+		 * @param ptr Output data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		size_t read(void *ptr, size_t size);
+
+		/**
+		 * Set the decompressed position.
+		 * The actual seek is deferred until the next read().
+		 * @param pos Decompressed position.
+		 * @return 0 on success; -1 on error.
+		 */
+		int seek(off64_t pos);
+
+		/**
+		 * Get the decompressed position.
+		 * @return Decompressed position.
+		 */
+		inline off64_t tell(void) const
+		{
+			return m_pos;
+		}
+
+		/**
+		 * Use the process-wide index cache for this file.
+		 * If a previous reader cached an index for this file,
+		 * it will be loaded now. The index will be cached again
+		 * when this reader is destroyed.
+		 *
+		 * This must be called before the first read().
+		 *
+		 * @param filename	[in] Filename
+		 * @param compSize	[in] Compressed file size
+		 * @param mtime		[in] Modification time
+		 */
+		void useIndexCache(const std::string &filename, off64_t compSize, time_t mtime);
+
+	private:
+		/**
+		 * Restart decompression from the beginning of the file.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int restart(void);
+
+		/**
+		 * Restart decompression from a checkpoint.
+		 * @param idx Checkpoint index.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int restoreCheckpoint(size_t idx);
+
+		/**
+		 * Save a checkpoint at the current position.
+		 * This must be called at a deflate block boundary.
+		 */
+		void saveCheckpoint(void);
+
+		/**
+		 * Decompress data from the current stream position.
+		 * @param ptr Output buffer, or nullptr to discard the data.
+		 * @param size Amount of data to decompress.
+		 * @return Number of bytes decompressed.
+		 */
+		size_t inflateTo(uint8_t *ptr, size_t size);
+
+		/**
+		 * Save the index to the process-wide index cache.
+		 */
+		void saveIndexCache(void);
+
+	private:
+		pfnReadAt_t m_pfnReadAt;
+		void *m_userdata;
+
+		z_stream m_strm;
+		bool m_isInit;
+		bool m_isRaw;		// True if restored from a checkpoint. (raw deflate)
+		bool m_isEOF;		// True if the end of the gzip data was reached.
+		int m_lastError;
+
+		off64_t m_pos;		// Requested decompressed position.
+		off64_t m_outPos;	// Decompressed position of the stream.
+		off64_t m_inPos;	// Compressed position of the next input read.
+
+		// Input buffer.
+		std::unique_ptr<uint8_t[]> m_inBuf;
+
+		// Sliding window. (circular)
+		std::unique_ptr<uint8_t[]> m_window;
+		unsigned int m_winPos;
+		unsigned int m_winFill;	// Number of valid bytes in the window.
+
+		// Decompressed prefix cache.
+		std::unique_ptr<uint8_t[]> m_prefix;
+		unsigned int m_prefixLen;
+
+		struct Checkpoint {
+			off64_t out;	// Decompressed position.
+			off64_t in;	// Compressed position of the first full byte.
+			int bits;	// Number of bits from the previous byte. (0-7)
+			std::unique_ptr<uint8_t[]> window;	// Uncompressed data preceding this point.
+			unsigned int winLen;
+		};
+		std::vector<Checkpoint> m_checkpoints;
+
+		// Most recently decompressed data from a previous reader.
+		// Only set if it was loaded from the index cache.
+		std::unique_ptr<uint8_t[]> m_recent;
+		off64_t m_recentPos;		// Decompressed position.
+		unsigned int m_recentLen;
+
+		// Index cache key. (empty filename if not cached)
+		std::string m_cacheFilename;
+		off64_t m_cacheCompSize;
+		time_t m_cacheMtime;
+
+		// Cached index for a file.
+		struct CachedIndex {
+			std::string filename;
+			off64_t compSize;
+			time_t mtime;
+
+			std::vector<Checkpoint> checkpoints;
+			std::unique_ptr<uint8_t[]> prefix;
+			unsigned int prefixLen;
+			std::unique_ptr<uint8_t[]> recent;
+			off64_t recentPos;
+			unsigned int recentLen;
+		};
+
+		// Process-wide index cache. (most recently used first)
+		static std::vector<CachedIndex> ms_indexCache;
+		static LibRpThreads::Mutex ms_indexCacheMutex;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPFILE_GZINDEXEDREADER_HPP__ */
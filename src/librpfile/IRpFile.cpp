@@ -58,6 +58,66 @@ int IRpFile::ungetc(int c)
 	return this->seek(pos-1);
 }
 
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ *
+ * The default implementation saves the file position,
+ * seeks, reads, and restores the file position, so it
+ * is NOT thread-safe. Subclasses that can read without
+ * changing the file position should override it.
+ *
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t IRpFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	const off64_t prev_pos = this->tell();
+	const size_t ret = this->seekAndRead(pos, ptr, size);
+	if (prev_pos >= 0) {
+		this->seek(prev_pos);
+	}
+	return ret;
+}
+
+/**
+ * Read multiple ranges from the file.
+ *
+ * Requests are processed in order. Reading stops at the
+ * first request that can't be read in full.
+ *
+ * The default implementation uses seek() and read(), but it
+ * skips the seek for requests that are adjacent in the file.
+ * Afterwards, the file position is undefined.
+ *
+ * @param reqs	[in,out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read in full.
+ */
+size_t IRpFile::readBatch(const ReadRequest *reqs, size_t count)
+{
+	off64_t pos = -1;
+	for (size_t i = 0; i < count; i++) {
+		const ReadRequest &req = reqs[i];
+		if (req.pos != pos) {
+			if (this->seek(req.pos) != 0) {
+				// Seek error.
+				return i;
+			}
+		}
+
+		const size_t size = this->read(req.ptr, req.size);
+		if (size != req.size) {
+			// Short read.
+			return i;
+		}
+		pos = req.pos + req.size;
+	}
+	return count;
+}
+
 /**
  * Copy data from this IRpFile to another IRpFile.
  * Read/write positions must be set before calling this function.
@@ -79,6 +139,10 @@ int IRpFile::copyTo(IRpFile *pDestFile, off64_t size,
 	off64_t cbReadTotal = 0;
 	off64_t cbWrittenTotal = 0;
 
+	// This is a single sequential pass.
+	// NOTE: Errors are ignored, since this is only a hint.
+	this->adviseAccess(AccessPattern::Sequential, this->tell(), size);
+
 	// Read buffer.
 #define COPYTO_BUFFER_SIZE (64*1024)
 	uint8_t *buf = static_cast<uint8_t*>(malloc(COPYTO_BUFFER_SIZE));
@@ -121,6 +121,66 @@ class IRpFile : public RefBase
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		virtual size_t read(void *ptr, size_t size) = 0;
 
+		/**
+		 * Read data from the file at the specified position.
+		 * The file position is not changed.
+		 *
+		 * The default implementation saves the file position,
+		 * seeks, reads, and restores the file position, so it
+		 * is NOT thread-safe. Subclasses that can read without
+		 * changing the file position should override it.
+		 *
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		virtual size_t readAt(off64_t pos, void *ptr, size_t size);
+
+		// Read request for readBatch().
+		struct ReadRequest {
+			off64_t pos;	// [in] File position.
+			void *ptr;	// [out] Output data buffer.
+			size_t size;	// [in] Amount of data to read, in bytes.
+		};
+
+		/**
+		 * Read multiple ranges from the file.
+		 *
+		 * Requests are processed in order. Reading stops at the
+		 * first request that can't be read in full.
+		 *
+		 * The default implementation uses seek() and read(), but it
+		 * skips the seek for requests that are adjacent in the file.
+		 * Afterwards, the file position is undefined.
+		 *
+		 * @param reqs	[in,out] Read requests.
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read in full.
+		 */
+		virtual size_t readBatch(const ReadRequest *reqs, size_t count);
+
+		/**
+		 * Get a pointer to file data without copying it.
+		 * This is only supported by files that are backed by memory,
+		 * e.g. RpMemFile, RpVectorFile, and memory-mapped RpFile.
+		 *
+		 * The pointer is valid until the file is modified or closed.
+		 * The file position is not changed.
+		 *
+		 * @param pos	[in] File position.
+		 * @param size	[in] Amount of data, in bytes.
+		 * @return Pointer to the data, or nullptr if not supported or out of range.
+		 */
+		virtual const uint8_t *peek(off64_t pos, size_t size)
+		{
+			// Not supported.
+			RP_UNUSED(pos);
+			RP_UNUSED(size);
+			return nullptr;
+		}
+
 		/**
 		 * Write data to the file.
 		 * @param ptr	[in] Input data buffer.
@@ -174,6 +234,32 @@ class IRpFile : public RefBase
 			return -ENOTSUP;
 		}
 
+		// Access patterns for adviseAccess().
+		enum class AccessPattern : uint8_t {
+			Normal,		// No special treatment.
+			Sequential,	// Data will be read sequentially.
+			Random,		// Data will be read in random order.
+			WillNeed,	// Data will be read soon.
+			DontNeed,	// Data will not be read again soon.
+		};
+
+		/**
+		 * Advise the OS of the expected access pattern.
+		 * This is only a hint; it does not affect the data read.
+		 * @param pattern	[in] Access pattern.
+		 * @param offset	[in] Starting offset.
+		 * @param len		[in] Length, or 0 for the rest of the file.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		virtual int adviseAccess(AccessPattern pattern, off64_t offset = 0, off64_t len = 0)
+		{
+			// Not supported.
+			RP_UNUSED(pattern);
+			RP_UNUSED(offset);
+			RP_UNUSED(len);
+			return -ENOTSUP;
+		}
+
 	public:
 		/** File properties **/
 
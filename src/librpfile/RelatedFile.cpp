@@ -11,11 +11,181 @@
 #include "FileSystem.hpp"
 #include "RpFile.hpp"
 
+#ifndef _WIN32
+// C includes.
+#  include <dirent.h>
+#  include <sys/stat.h>
+
+// librpthreads
+#  include "librpthreads/Mutex.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+// C++ includes.
+#  include <list>
+#  include <unordered_map>
+#  include <unordered_set>
+using std::list;
+using std::unordered_map;
+using std::unordered_set;
+#endif /* !_WIN32 */
+
 // C++ STL classes.
 using std::string;
 
 namespace LibRpFile { namespace FileSystem {
 
+#ifndef _WIN32
+namespace RelatedFilePrivate {
+
+// Directory listing cache entry.
+struct DirListing {
+	string dir;		// Directory, as passed to findInDir()
+	dev_t device;
+	ino_t inode;
+	time_t mtime;		// Directory mtime when it was listed
+	time_t listed;		// time() when the directory was listed
+
+	unordered_set<string> names;			// Exact filenames
+	unordered_map<string, string> folded;		// Case-folded filename -> filename
+};
+
+// Maximum number of directory listings in the cache.
+// Related files are usually opened for a few files in
+// the same directory, so this is kept small.
+static const size_t MAX_DIRS = 8;
+
+// Directory listings, from most recently used to least recently used.
+static list<DirListing> lst_dirs;
+static Mutex mtxDirs;
+
+/**
+ * Case-fold a filename. (ASCII only)
+ * @param name Filename
+ * @return Case-folded filename
+ */
+static string foldName(const string &name)
+{
+	string s_folded = name;
+	std::transform(s_folded.begin(), s_folded.end(), s_folded.begin(),
+		[](unsigned char c) { return std::tolower(c); });
+	return s_folded;
+}
+
+/**
+ * Read a directory listing.
+ * @param listing	[in/out] DirListing (dir must be set)
+ * @param sb		[in] stat() of the directory
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int readDir(DirListing &listing, const struct stat &sb)
+{
+	DIR *const pdir = opendir(listing.dir.empty() ? "." : listing.dir.c_str());
+	if (!pdir) {
+		int err = -errno;
+		return (err != 0 ? err : -EIO);
+	}
+
+	listing.device = sb.st_dev;
+	listing.inode = sb.st_ino;
+	listing.mtime = sb.st_mtime;
+	listing.listed = time(nullptr);
+	listing.names.clear();
+	listing.folded.clear();
+
+	const struct dirent *d;
+	while ((d = readdir(pdir)) != nullptr) {
+		if (d->d_name[0] == '.' &&
+		    (d->d_name[1] == '\0' || (d->d_name[1] == '.' && d->d_name[2] == '\0')))
+		{
+			// "." or ".."
+			continue;
+		}
+
+		string name = d->d_name;
+		string s_folded = foldName(name);
+		listing.names.emplace(name);
+		// If multiple files differ only in case, keep the first one.
+		listing.folded.emplace(std::move(s_folded), std::move(name));
+	}
+	closedir(pdir);
+	return 0;
+}
+
+/**
+ * Find a file in a directory using the directory listing cache.
+ *
+ * The directory is listed once, and the listing is reused as long
+ * as the directory's mtime doesn't change. Listings made in the
+ * same second as the directory's last modification aren't reused,
+ * since the mtime may only have one-second resolution.
+ *
+ * @param s_dir		[in] Directory, including trailing slash. (empty for the current directory)
+ * @param candidates	[in] Exact filenames to check, in order of preference
+ * @param s_found	[out] Filename that was found (without the directory)
+ * @return 0 if found; -ENOENT if not found; other negative POSIX error code if the directory can't be listed.
+ */
+static int findInDir(const string &s_dir, const string *candidates, size_t count, string &s_found)
+{
+	assert(count > 0);
+
+	struct stat sb;
+	if (stat(s_dir.empty() ? "." : s_dir.c_str(), &sb) != 0) {
+		int err = -errno;
+		return (err != 0 ? err : -EIO);
+	}
+
+	MutexLocker mtxLocker(mtxDirs);
+
+	auto iter = std::find_if(lst_dirs.begin(), lst_dirs.end(),
+		[&s_dir](const DirListing &listing) { return (listing.dir == s_dir); });
+	if (iter != lst_dirs.end()) {
+		// Move the listing to the front of the list.
+		lst_dirs.splice(lst_dirs.begin(), lst_dirs, iter);
+	} else {
+		// Add a new listing, removing the least recently used one if necessary.
+		if (lst_dirs.size() >= MAX_DIRS) {
+			lst_dirs.pop_back();
+		}
+		lst_dirs.emplace_front();
+		lst_dirs.front().dir = s_dir;
+		lst_dirs.front().listed = 0;
+	}
+
+	DirListing &listing = lst_dirs.front();
+	if (listing.listed == 0 ||
+	    listing.device != sb.st_dev || listing.inode != sb.st_ino ||
+	    listing.mtime != sb.st_mtime || listing.listed <= listing.mtime)
+	{
+		// Listing is missing or out of date.
+		int ret = readDir(listing, sb);
+		if (ret != 0) {
+			lst_dirs.pop_front();
+			return ret;
+		}
+	}
+
+	// Check for exact matches first.
+	for (size_t i = 0; i < count; i++) {
+		if (listing.names.find(candidates[i]) != listing.names.end()) {
+			s_found = candidates[i];
+			return 0;
+		}
+	}
+
+	// Check for case-insensitive matches.
+	auto iter_folded = listing.folded.find(foldName(candidates[0]));
+	if (iter_folded != listing.folded.end()) {
+		s_found = iter_folded->second;
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
+}
+#endif /* !_WIN32 */
+
 /**
  * Attempt to open a related file. (read-only)
  *
@@ -26,6 +196,10 @@ namespace LibRpFile { namespace FileSystem {
  * If the primary file is a symlink, the related file may
  * be located in the original file's directory.
  *
+ * On non-Windows systems, the filename is matched case-insensitively
+ * using a cached directory listing, so opening several
+ * related files in the same directory only lists it once.
+ *
  * @param filename	[in] Primary filename.
  * @param basename	[in] New basename.
  * @param ext		[in] New extension, including leading dot.
@@ -72,6 +246,36 @@ IRpFile *openRelatedFile(const char *filename, const char *basename, const char
 	std::transform(s_ext.begin(), s_ext.end(), s_ext.begin(),
 		[](unsigned char c) { return std::toupper(c); });
 
+#ifndef _WIN32
+	// Check the directory listing cache first. This avoids failed
+	// open() calls for each case variant in large directories.
+	string candidates[2];
+	candidates[0] = s_basename + s_ext;
+	std::transform(s_ext.begin(), s_ext.end(), s_ext.begin(),
+		[](unsigned char c) { return std::tolower(c); });
+	candidates[1] = s_basename + s_ext;
+
+	IRpFile *test_file = nullptr;
+	string s_found;
+	int ret = RelatedFilePrivate::findInDir(s_dir, candidates, ARRAY_SIZE(candidates), s_found);
+	if (ret == 0) {
+		test_file = new RpFile(s_dir + s_found, RpFile::FM_OPEN_READ);
+		if (!test_file->isOpen()) {
+			UNREF_AND_NULL_NOCHK(test_file);
+		}
+	} else if (ret != -ENOENT) {
+		// Unable to list the directory.
+		// Try opening the case variants directly.
+		test_file = new RpFile(s_dir + candidates[0], RpFile::FM_OPEN_READ);
+		if (!test_file->isOpen()) {
+			test_file->unref();
+			test_file = new RpFile(s_dir + candidates[1], RpFile::FM_OPEN_READ);
+			if (!test_file->isOpen()) {
+				UNREF_AND_NULL_NOCHK(test_file);
+			}
+		}
+	}
+#else /* _WIN32 */
 	// Attempt to open the related file.
 	string rel_filename = s_dir + s_basename + s_ext;
 	IRpFile *test_file = new RpFile(rel_filename, RpFile::FM_OPEN_READ);
@@ -89,6 +293,7 @@ IRpFile *openRelatedFile(const char *filename, const char *basename, const char
 			UNREF_AND_NULL_NOCHK(test_file);
 		}
 	}
+#endif /* _WIN32 */
 
 	if (!test_file && FileSystem::is_symlink(filename)) {
 		// Could not open the related file, but the
@@ -25,6 +25,10 @@ namespace LibRpFile { namespace FileSystem {
  * If the primary file is a symlink, the related file may
  * be located in the original file's directory.
  *
+ * On non-Windows systems, the filename is matched case-insensitively
+ * using a cached directory listing, so opening several
+ * related files in the same directory only lists it once.
+ *
  * @param filename	[in] Primary filename.
  * @param basename	[in,opt] New basename. If nullptr, uses the existing basename.
  * @param ext		[in] New extension, including leading dot.
@@ -44,6 +44,17 @@ class RpFile : public IRpFile
 			// Extras.
 			FM_GZIP_DECOMPRESS = 4,	// Transparent gzip decompression. (read-only!)
 			FM_OPEN_READ_GZ = FM_READ | FM_GZIP_DECOMPRESS,
+
+			// Memory-map local regular files for peek(). (read-only!)
+			// Falls back to regular file access for devices, gzipped
+			// files, files on network file systems, and files that
+			// were modified recently and might still be written to.
+			// Regular reads always use pread(), so they can't crash
+			// if the file is truncated.
+			// NOTE: Currently only implemented on POSIX systems.
+			FM_MMAP = 8,
+			FM_OPEN_READ_MMAP = FM_OPEN_READ | FM_MMAP,
+			FM_OPEN_READ_GZ_MMAP = FM_OPEN_READ_GZ | FM_MMAP,
 		};
 
 		/**
@@ -88,6 +99,53 @@ class RpFile : public IRpFile
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the file at the specified position.
+		 * The file position is not changed.
+		 *
+		 * This is thread-safe for regular files.
+		 * Devices and gzipped files use the (non-thread-safe)
+		 * default implementation.
+		 *
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
+		/**
+		 * Read multiple ranges from the file.
+		 *
+		 * Requests are processed in order. Reading stops at the
+		 * first request that can't be read in full.
+		 *
+		 * Afterwards, the file position is undefined.
+		 *
+		 * @param reqs	[in,out] Read requests.
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read in full.
+		 */
+		size_t readBatch(const ReadRequest *reqs, size_t count) final;
+
+		/**
+		 * Get a pointer to file data without copying it.
+		 * This is only supported if the file is memory-mapped. (FM_MMAP)
+		 * The pointer is valid until the file is made writable or closed.
+		 *
+		 * NOTE: If the file is truncated while the pointer is in use,
+		 * accessing it will crash with SIGBUS. The file size is checked
+		 * before returning the pointer, but the pointer should only be
+		 * used for short-lived accesses.
+		 *
+		 * The file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param size	[in] Amount of data, in bytes.
+		 * @return Pointer to the data, or nullptr if not supported or out of range.
+		 */
+		const uint8_t *peek(off64_t pos, size_t size) final;
+
 		/**
 		 * Write data to the file.
 		 * @param ptr Input data buffer.
@@ -124,6 +182,16 @@ class RpFile : public IRpFile
 		 */
 		int flush(void) final;
 
+		/**
+		 * Advise the OS of the expected access pattern.
+		 * This is only a hint; it does not affect the data read.
+		 * @param pattern	[in] Access pattern.
+		 * @param offset	[in] Starting offset.
+		 * @param len		[in] Length, or 0 for the rest of the file.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int adviseAccess(AccessPattern pattern, off64_t offset = 0, off64_t len = 0) final;
+
 	public:
 		/** File properties **/
 
@@ -14,6 +14,7 @@
 
 // C includes. (C++ namespace)
 #include <cassert>
+#include <cstring>
 
 // C++ includes.
 #include <string>
@@ -21,17 +22,8 @@
 using std::string;
 using std::vector;
 
-// zlib for transparent gzip decompression.
-#include <zlib.h>
-// gzclose_r() and gzclose_w() were introduced in zlib-1.2.4.
-#if (ZLIB_VER_MAJOR > 1) || \
-    (ZLIB_VER_MAJOR == 1 && ZLIB_VER_MINOR > 2) || \
-    (ZLIB_VER_MAJOR == 1 && ZLIB_VER_MINOR == 2 && ZLIB_VER_REVISION >= 4)
-// zlib-1.2.4 or later
-#else
-#  define gzclose_r(file) gzclose(file)
-#  define gzclose_w(file) gzclose(file)
-#endif
+// Transparent gzip decompression.
+#include "GzIndexedReader.hpp"
 
 #ifdef _WIN32
 // Windows SDK
@@ -74,10 +66,18 @@ class RpFilePrivate
 
 		RpFilePrivate(RpFile *q, const char *filename, RpFile::FileMode mode)
 			: q_ptr(q), file(INVALID_HANDLE_VALUE), filename(filename)
-			, mode(mode), gzfd(nullptr), gzsz(-1), devInfo(nullptr) { }
+			, mode(mode), gzReader(nullptr), gzsz(-1), devInfo(nullptr)
+#ifdef HAVE_MMAP
+			, mmap_ptr(nullptr), mmap_size(0), mmap_pos(0), mmap_truncated(false)
+#endif /* HAVE_MMAP */
+			{ }
 		RpFilePrivate(RpFile *q, const string &filename, RpFile::FileMode mode)
 			: q_ptr(q), file(INVALID_HANDLE_VALUE), filename(filename)
-			, mode(mode), gzfd(nullptr), gzsz(-1), devInfo(nullptr) { }
+			, mode(mode), gzReader(nullptr), gzsz(-1), devInfo(nullptr)
+#ifdef HAVE_MMAP
+			, mmap_ptr(nullptr), mmap_size(0), mmap_pos(0), mmap_truncated(false)
+#endif /* HAVE_MMAP */
+			{ }
 		~RpFilePrivate();
 
 	private:
@@ -89,7 +89,7 @@ class RpFilePrivate
 		string filename;	// Filename.
 		RpFile::FileMode mode;	// File mode.
 
-		gzFile gzfd;		// Used for transparent gzip decompression.
+		GzIndexedReader *gzReader;	// Used for transparent gzip decompression.
 		off64_t gzsz;		// Uncompressed file size.
 
 		// Device information struct.
@@ -101,9 +101,24 @@ class RpFilePrivate
 			uint32_t sector_size;	// Sector size. (bytes per sector)
 			bool isKreonUnlocked;	// Is Kreon mode unlocked?
 
+			// Maximum transfer length for SCSI READ commands.
+			uint32_t os_max_xfer_size;	// Maximum transfer size allowed by the OS, in bytes. (0 == unknown)
+			uint16_t max_xfer_lbas;		// Maximum transfer length, in LBAs. (0 == not queried yet)
+
 			// Sector cache.
-			uint8_t *sector_cache;	// Sector cache.
-			uint32_t lba_cache;	// Last LBA cached.
+			// Recently-read, aligned blocks of SECTOR_CACHE_BLOCK_SIZE bytes.
+			// Small reads, e.g. volume descriptors and directory tables,
+			// are served from here instead of reading from the drive again.
+			static const unsigned int SECTOR_CACHE_BLOCK_SIZE = 65536;
+			static const unsigned int SECTOR_CACHE_BLOCK_COUNT = 8;
+			uint8_t *sector_cache;	// Sector cache. (SECTOR_CACHE_BLOCK_COUNT blocks)
+			struct CacheBlock {
+				uint32_t lba;		// First LBA.
+				uint32_t lba_count;	// Number of LBAs. (0 == unused)
+				uint32_t last_use;	// Last use. (for LRU replacement)
+			};
+			CacheBlock cache_blocks[SECTOR_CACHE_BLOCK_COUNT];
+			uint32_t cache_use_counter;
 
 			// OS-specific variables.
 #ifdef USING_FREEBSD_CAMLIB
@@ -115,12 +130,16 @@ class RpFilePrivate
 				, device_size(0)
 				, sector_size(0)
 				, isKreonUnlocked(0)
+				, os_max_xfer_size(0)
+				, max_xfer_lbas(0)
 				, sector_cache(nullptr)
-				, lba_cache(~0U)
+				, cache_use_counter(0)
 #ifdef USING_FREEBSD_CAMLIB
 				, cam(nullptr)
 #endif /* USING_FREEBSD_CAMLIB */
-			{ }
+			{
+				invalidate_sector_cache();
+			}
 
 			~DeviceInfo()
 			{
@@ -138,15 +157,21 @@ class RpFilePrivate
 				assert(sector_size <= 65536);
 				if (!sector_cache) {
 					if (sector_size >= 512 && sector_size <= 65536) {
-						sector_cache = new uint8_t[sector_size];
+						sector_cache = new uint8_t[SECTOR_CACHE_BLOCK_SIZE * SECTOR_CACHE_BLOCK_COUNT];
 					}
 				}
 			}
 
+			void invalidate_sector_cache(void)
+			{
+				memset(cache_blocks, 0, sizeof(cache_blocks));
+			}
+
 			void close(void)
 			{
 				delete[] sector_cache;
 				sector_cache = nullptr;
+				invalidate_sector_cache();
 
 #ifdef USING_FREEBSD_CAMLIB
 				if (cam) {
@@ -159,6 +184,39 @@ class RpFilePrivate
 
 		DeviceInfo *devInfo;
 
+#ifdef HAVE_MMAP
+		// Memory-mapped file. (FM_MMAP)
+		// The mapping is only used by peek(). Reads use pread(),
+		// since accessing the mapping after the file is truncated
+		// would crash with SIGBUS.
+		uint8_t *mmap_ptr;	// Mapped file data.
+		size_t mmap_size;	// Mapped file size.
+		off64_t mmap_pos;	// Current position.
+		bool mmap_truncated;	// File was truncated after mapping it.
+
+		/**
+		 * Memory-map the file, if possible.
+		 * This is only done for read-only local regular files.
+		 * On failure, regular file access is used.
+		 *
+		 * INTERNAL FUNCTION. The file must be open.
+		 */
+		void mapFile(void);
+
+		/**
+		 * Unmap the file.
+		 * The stdio file position is set to the mapped position.
+		 */
+		void unmapFile(void);
+
+		/**
+		 * Check if the file still covers the entire mapping.
+		 * If it doesn't, the mapping won't be used by peek() anymore.
+		 * @return True if the mapping can be used; false if not.
+		 */
+		bool checkMapSize(void);
+#endif /* HAVE_MMAP */
+
 	public:
 #ifdef _WIN32
 		/**
@@ -188,7 +246,7 @@ class RpFilePrivate
 		/**
 		 * (Re-)Open the main file.
 		 *
-		 * INTERNAL FUNCTION. This does NOT affect gzfd.
+		 * INTERNAL FUNCTION. This does NOT affect gzReader.
 		 * NOTE: This function sets q->m_lastError.
 		 *
 		 * Uses parameters stored in this->filename and this->mode.
@@ -196,13 +254,37 @@ class RpFilePrivate
 		 */
 		int reOpenFile(void);
 
+		/**
+		 * Read compressed data for gzReader.
+		 * This does not change the file position.
+		 * @param userdata	[in] RpFilePrivate
+		 * @param pos		[in] File position
+		 * @param ptr		[out] Output buffer
+		 * @param size		[in] Amount of data to read
+		 * @return Number of bytes read.
+		 */
+		static size_t gzReadAt(void *userdata, off64_t pos, void *ptr, size_t size);
+
 	public:
 		/**
-		 * Read one sector into the sector cache.
+		 * Read LBAs from the device, bypassing the sector cache.
+		 * Kreon drives use SCSI READ commands with the maximum
+		 * supported transfer length; other drives use the OS API.
+		 * @param lbaStart	[in] Starting LBA.
+		 * @param lbaCount	[in] Number of LBAs to read.
+		 * @param pBuf		[out] Output buffer. (must be at least lbaCount * sector_size bytes)
+		 * @return Number of bytes read.
+		 */
+		size_t readLBAs(uint32_t lbaStart, uint32_t lbaCount, uint8_t *pBuf);
+
+		/**
+		 * Get a sector from the sector cache.
+		 * If it isn't cached, the aligned block containing
+		 * the sector is read from the device.
 		 * @param lba LBA to read.
-		 * @return 0 on success; non-zero on error.
+		 * @return Pointer to the sector data, or nullptr on error.
 		 */
-		int readOneLBA(uint32_t lba);
+		const uint8_t *readCachedLBA(uint32_t lba);
 
 		/**
 		 * Read using block reads.
@@ -246,6 +328,15 @@ class RpFilePrivate
 		ATTR_ACCESS(write_only, 3)
 		int scsi_read_capacity(off64_t *pDeviceSize, uint32_t *pSectorSize = nullptr);
 
+		/**
+		 * Get the maximum transfer length for SCSI READ commands.
+		 * This uses the Block Limits VPD page if it's supported,
+		 * limited by the OS maximum transfer size.
+		 * The result is saved in devInfo->max_xfer_lbas.
+		 * @return Maximum transfer length, in LBAs.
+		 */
+		uint16_t scsi_get_max_xfer_lbas(void);
+
 		/**
 		 * Read data from a device using SCSI commands.
 		 * @param lbaStart	[in] Starting LBA of the data to read.
@@ -15,11 +15,28 @@
 
 #include "RpFile.hpp"
 #include "RpFile_p.hpp"
+#include "FileSystem.hpp"
 
 // C includes.
 #include <fcntl.h>	// AT_EMPTY_PATH
 #include <sys/stat.h>	// stat(), statx()
 #include <unistd.h>	// ftruncate()
+#ifdef HAVE_MMAP
+#  include <sys/mman.h>	// mmap()
+#endif /* HAVE_MMAP */
+#ifdef HAVE_PREADV
+#  include <sys/uio.h>	// preadv()
+#  include <climits>	// IOV_MAX
+#  ifndef IOV_MAX
+#    define IOV_MAX 16
+#  endif /* !IOV_MAX */
+#endif /* HAVE_PREADV */
+#ifdef HAVE_IO_URING
+#  include "linux/IoUring.hpp"
+#endif /* HAVE_IO_URING */
+
+// C++ STL classes.
+using std::unique_ptr;
 
 namespace LibRpFile {
 
@@ -27,9 +44,12 @@ namespace LibRpFile {
 
 RpFilePrivate::~RpFilePrivate()
 {
-	if (gzfd != 0) {
-		gzclose_r(gzfd);
+#ifdef HAVE_MMAP
+	if (mmap_ptr) {
+		munmap(mmap_ptr, mmap_size);
 	}
+#endif /* HAVE_MMAP */
+	delete gzReader;
 	if (file) {
 		fclose(file);
 	}
@@ -60,7 +80,7 @@ inline const char *RpFilePrivate::mode_to_str(RpFile::FileMode mode)
 /**
  * (Re-)Open the main file.
  *
- * INTERNAL FUNCTION. This does NOT affect gzfd.
+ * INTERNAL FUNCTION. This does NOT affect gzReader.
  * NOTE: This function sets q->m_lastError.
  *
  * Uses parameters stored in this->filename and this->mode.
@@ -193,6 +213,150 @@ int RpFilePrivate::reOpenFile(void)
 	return 0;
 }
 
+/**
+ * Read compressed data for gzReader.
+ * This does not change the file position.
+ * @param userdata	[in] RpFilePrivate
+ * @param pos		[in] File position
+ * @param ptr		[out] Output buffer
+ * @param size		[in] Amount of data to read
+ * @return Number of bytes read.
+ */
+size_t RpFilePrivate::gzReadAt(void *userdata, off64_t pos, void *ptr, size_t size)
+{
+	RpFilePrivate *const d = static_cast<RpFilePrivate*>(userdata);
+	const int fd = fileno(d->file);
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	while (size > 0) {
+		const ssize_t sret = pread(fd, ptr8, size, pos);
+		if (sret < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		} else if (sret == 0) {
+			// End of file.
+			break;
+		}
+		ptr8 += sret;
+		pos += sret;
+		size -= sret;
+		ret += sret;
+	}
+	return ret;
+}
+
+#ifdef HAVE_MMAP
+/**
+ * Memory-map the file, if possible.
+ * This is only done for read-only local regular files.
+ * On failure, regular file access is used.
+ *
+ * INTERNAL FUNCTION. The file must be open.
+ */
+void RpFilePrivate::mapFile(void)
+{
+	RP_Q(RpFile);
+	assert(file != nullptr);
+	assert(mmap_ptr == nullptr);
+	if (!file || mmap_ptr || q->m_fileType != DT_REG ||
+	    (mode & RpFile::FM_WRITE) || gzReader != nullptr)
+	{
+		// Only read-only, uncompressed regular files can be mapped.
+		return;
+	}
+
+	// Don't map files on network file systems.
+	// If the remote file is truncated, accessing
+	// the mapping would crash with SIGBUS.
+	if (FileSystem::isOnBadFS(filename.c_str(), false)) {
+		return;
+	}
+
+	struct stat sb;
+	if (fstat(fileno(file), &sb) != 0 || !S_ISREG(sb.st_mode)) {
+		return;
+	}
+	const off64_t fileSize = sb.st_size;
+	if (fileSize <= 0) {
+		// Empty files can't be mapped.
+		return;
+	}
+
+	// Don't map files that were modified within the last few seconds.
+	// They might still be written to, e.g. by a download or a copy,
+	// so they're more likely to be truncated while mapped.
+	static const time_t MMAP_MIN_AGE = 2;
+	const time_t now = time(nullptr);
+	if (sb.st_mtime > now - MMAP_MIN_AGE) {
+		return;
+	}
+#if SIZE_MAX <= 0xFFFFFFFFU
+	// 32-bit: Don't map large files, since we might
+	// run out of address space.
+	static const off64_t MMAP_MAX_SIZE_32 = 512LL*1024*1024;
+	if (fileSize > MMAP_MAX_SIZE_32) {
+		return;
+	}
+#endif /* SIZE_MAX <= 0xFFFFFFFFU */
+
+	void *const ptr = mmap(nullptr, static_cast<size_t>(fileSize),
+		PROT_READ, MAP_SHARED, fileno(file), 0);
+	if (ptr == MAP_FAILED) {
+		// Unable to map the file.
+		return;
+	}
+
+	mmap_ptr = static_cast<uint8_t*>(ptr);
+	mmap_size = static_cast<size_t>(fileSize);
+	mmap_pos = 0;
+	mmap_truncated = false;
+}
+
+/**
+ * Unmap the file.
+ * The stdio file position is set to the mapped position.
+ */
+void RpFilePrivate::unmapFile(void)
+{
+	if (!mmap_ptr)
+		return;
+
+	munmap(mmap_ptr, mmap_size);
+	mmap_ptr = nullptr;
+	mmap_size = 0;
+	if (file) {
+		fseeko(file, mmap_pos, SEEK_SET);
+	}
+	mmap_pos = 0;
+	mmap_truncated = false;
+}
+
+/**
+ * Check if the file still covers the entire mapping.
+ * If it doesn't, the mapping won't be used by peek() anymore.
+ * @return True if the mapping can be used; false if not.
+ */
+bool RpFilePrivate::checkMapSize(void)
+{
+	if (!mmap_ptr || mmap_truncated)
+		return false;
+
+	// NOTE: The mapping is kept until the file is closed,
+	// since pointers returned by peek() might still be in use.
+	struct stat sb;
+	if (fstat(fileno(file), &sb) != 0 ||
+	    sb.st_size < static_cast<off_t>(mmap_size))
+	{
+		// The file was truncated.
+		mmap_truncated = true;
+		return false;
+	}
+	return true;
+}
+#endif /* HAVE_MMAP */
+
 /** RpFile **/
 
 /**
@@ -247,7 +411,7 @@ void RpFile::init(void)
 	// Check if this is a gzipped file.
 	// If it is, use transparent decompression.
 	// Reference: https://www.forensicswiki.org/wiki/Gzip
-	if (d->mode == FM_OPEN_READ_GZ) {
+	if ((d->mode & ~FM_MMAP) == FM_OPEN_READ_GZ) {
 		uint16_t gzmagic;
 		size_t size = fread(&gzmagic, 1, sizeof(gzmagic), d->file);
 		if (size == sizeof(gzmagic) && gzmagic == be16_to_cpu(0x1F8B)) {
@@ -270,32 +434,40 @@ void RpFile::init(void)
 						// Make sure the CRC32 table is initialized.
 						get_crc_table();
 
-						// Open the file with gzdopen().
-						::rewind(d->file);
-						::fflush(d->file);
-						int gzfd_dup = ::dup(fileno(d->file));
-						if (gzfd_dup >= 0) {
-							d->gzfd = gzdopen(gzfd_dup, "r");
-							if (d->gzfd) {
-								m_isCompressed = true;
-							} else {
-								// gzdopen() failed.
-								// Close the dup()'d handle to prevent a leak.
-								::close(gzfd_dup);
+						// Use GzIndexedReader for decompression.
+						d->gzReader = new GzIndexedReader(RpFilePrivate::gzReadAt, d);
+						if (d->gzReader->isOpen()) {
+							m_isCompressed = true;
+
+							// Reuse the decompression index if this file was opened recently.
+							time_t mtime;
+							if (!d->filename.empty() && FileSystem::get_mtime(d->filename, &mtime) == 0) {
+								d->gzReader->useIndexCache(d->filename, real_sz, mtime);
 							}
+						} else {
+							// Unable to initialize zlib.
+							delete d->gzReader;
+							d->gzReader = nullptr;
 						}
 					}
 				}
 			}
 		}
 
-		if (!d->gzfd) {
+		if (!d->gzReader) {
 			// Not a gzipped file.
 			// Rewind and flush the file.
 			::rewind(d->file);
 			::fflush(d->file);
 		}
 	}
+
+#ifdef HAVE_MMAP
+	// Memory-map the file if requested.
+	if (d->mode & FM_MMAP) {
+		d->mapFile();
+	}
+#endif /* HAVE_MMAP */
 }
 
 RpFile::~RpFile()
@@ -329,10 +501,17 @@ void RpFile::close(void)
 		d->devInfo->close();
 	}
 
-	if (d->gzfd != 0) {
-		gzclose_r(d->gzfd);
-		d->gzfd = nullptr;
+#ifdef HAVE_MMAP
+	if (d->mmap_ptr) {
+		munmap(d->mmap_ptr, d->mmap_size);
+		d->mmap_ptr = nullptr;
+		d->mmap_size = 0;
+		d->mmap_pos = 0;
 	}
+#endif /* HAVE_MMAP */
+
+	delete d->gzReader;
+	d->gzReader = nullptr;
 	if (d->file) {
 		fclose(d->file);
 		d->file = nullptr;
@@ -358,15 +537,23 @@ size_t RpFile::read(void *ptr, size_t size)
 		return d->readUsingBlocks(ptr, size);
 	}
 
+#ifdef HAVE_MMAP
+	if (d->mmap_ptr) {
+		// Memory-mapped file.
+		// Use pread() instead of copying from the mapping,
+		// since the file might have been truncated.
+		const size_t ret = readAt(d->mmap_pos, ptr, size);
+		d->mmap_pos += ret;
+		return ret;
+	}
+#endif /* HAVE_MMAP */
+
 	size_t ret;
-	if (d->gzfd != 0) {
-		int iret = gzread(d->gzfd, ptr, size);
-		if (iret >= 0) {
-			ret = (size_t)iret;
-		} else {
+	if (d->gzReader) {
+		ret = d->gzReader->read(ptr, size);
+		if (d->gzReader->lastError() != 0) {
 			// An error occurred.
-			ret = 0;
-			m_lastError = errno;
+			m_lastError = d->gzReader->lastError();
 		}
 	} else {
 		ret = fread(ptr, 1, size, d->file);
@@ -378,6 +565,227 @@ size_t RpFile::read(void *ptr, size_t size)
 	return ret;
 }
 
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ *
+ * This is thread-safe for regular files.
+ * Devices and gzipped files use the (non-thread-safe)
+ * default implementation.
+ *
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	RP_D(RpFile);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	if (d->devInfo || d->gzReader) {
+		// Devices and gzipped files need to use regular reads.
+		return super::readAt(pos, ptr, size);
+	}
+
+	// NOTE: Memory-mapped files also use pread() here, since
+	// copying from the mapping would crash with SIGBUS if the
+	// file was truncated after it was mapped.
+
+	// Positional reads don't use the stdio buffer.
+	// Make sure any pending writes are flushed first.
+	if (m_isWritable) {
+		::fflush(d->file);
+	}
+	const int fd = fileno(d->file);
+
+	// pread() may return less data than requested,
+	// so keep reading until we reach EOF.
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	while (size > 0) {
+		const ssize_t sret = pread(fd, ptr8, size, pos);
+		if (sret < 0) {
+			if (errno == EINTR)
+				continue;
+			// Read error.
+			m_lastError = errno;
+			break;
+		} else if (sret == 0) {
+			// End of file.
+			break;
+		}
+		ptr8 += sret;
+		pos += sret;
+		size -= static_cast<size_t>(sret);
+		ret += static_cast<size_t>(sret);
+	}
+	return ret;
+}
+
+/**
+ * Read multiple ranges from the file.
+ *
+ * Requests are processed in order. Reading stops at the
+ * first request that can't be read in full.
+ *
+ * Afterwards, the file position is undefined.
+ *
+ * @param reqs	[in,out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read in full.
+ */
+size_t RpFile::readBatch(const ReadRequest *reqs, size_t count)
+{
+	RP_D(RpFile);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	if (d->devInfo || d->gzReader) {
+		// Devices and gzipped files need to use regular reads.
+		return super::readBatch(reqs, count);
+	}
+
+	// Positional reads don't use the stdio buffer.
+	// Make sure any pending writes are flushed first.
+	if (m_isWritable) {
+		::fflush(d->file);
+	}
+	const int fd = fileno(d->file);
+
+#ifdef HAVE_IO_URING
+	// If the requests aren't all adjacent, submit them together
+	// using io_uring so the device can service them concurrently.
+	bool isAdjacent = true;
+	for (size_t i = 1; i < count; i++) {
+		if (reqs[i].pos != reqs[i-1].pos + static_cast<off64_t>(reqs[i-1].size)) {
+			isAdjacent = false;
+			break;
+		}
+	}
+	IoUring *const ring = (!isAdjacent ? IoUring::forThread() : nullptr);
+	if (ring) {
+		unique_ptr<IoUring::Request[]> ureqs(new IoUring::Request[count]);
+		for (size_t i = 0; i < count; i++) {
+			ureqs[i].fd = fd;
+			ureqs[i].pos = reqs[i].pos;
+			ureqs[i].ptr = reqs[i].ptr;
+			ureqs[i].size = reqs[i].size;
+		}
+		if (ring->read(ureqs.get(), count) == 0) {
+			for (size_t i = 0; i < count; i++) {
+				if (ureqs[i].result < 0) {
+					// Read error.
+					m_lastError = static_cast<int>(-ureqs[i].result);
+					return i;
+				} else if (static_cast<size_t>(ureqs[i].result) != reqs[i].size) {
+					// Short read.
+					return i;
+				}
+			}
+			return count;
+		}
+		// The ring failed. Fall back to regular positional reads.
+	}
+#endif /* HAVE_IO_URING */
+
+	size_t i = 0;
+	while (i < count) {
+#ifdef HAVE_PREADV
+		// Use a single preadv() for requests that are adjacent in the file.
+		struct iovec iov[IOV_MAX < 64 ? IOV_MAX : 64];
+		size_t iovcnt = 0;
+		size_t total = 0;
+		const off64_t startPos = reqs[i].pos;
+		off64_t pos = startPos;
+		while (i + iovcnt < count && iovcnt < ARRAY_SIZE(iov) &&
+		       reqs[i + iovcnt].pos == pos)
+		{
+			iov[iovcnt].iov_base = reqs[i + iovcnt].ptr;
+			iov[iovcnt].iov_len = reqs[i + iovcnt].size;
+			pos += reqs[i + iovcnt].size;
+			total += reqs[i + iovcnt].size;
+			iovcnt++;
+		}
+
+		ssize_t sret;
+		do {
+			sret = preadv(fd, iov, static_cast<int>(iovcnt), startPos);
+		} while (sret < 0 && errno == EINTR);
+		if (sret < 0) {
+			// Read error.
+			m_lastError = errno;
+			return i;
+		} else if (static_cast<size_t>(sret) != total) {
+			// Short read. Count the requests that were read in full.
+			size_t remain = static_cast<size_t>(sret);
+			for (size_t j = 0; j < iovcnt; j++, i++) {
+				if (remain < iov[j].iov_len)
+					break;
+				remain -= iov[j].iov_len;
+			}
+			return i;
+		}
+		i += iovcnt;
+#else /* !HAVE_PREADV */
+		const ReadRequest &req = reqs[i];
+		ssize_t sret;
+		do {
+			sret = pread(fd, req.ptr, req.size, req.pos);
+		} while (sret < 0 && errno == EINTR);
+		if (sret < 0) {
+			// Read error.
+			m_lastError = errno;
+			return i;
+		} else if (static_cast<size_t>(sret) != req.size) {
+			// Short read.
+			return i;
+		}
+		i++;
+#endif /* HAVE_PREADV */
+	}
+
+	return count;
+}
+
+/**
+ * Get a pointer to file data without copying it.
+ * This is only supported if the file is memory-mapped. (FM_MMAP)
+ * The pointer is valid until the file is made writable or closed.
+ * The file position is not changed.
+ * @param pos	[in] File position.
+ * @param size	[in] Amount of data, in bytes.
+ * @return Pointer to the data, or nullptr if not supported or out of range.
+ */
+const uint8_t *RpFile::peek(off64_t pos, size_t size)
+{
+#ifdef HAVE_MMAP
+	RP_D(RpFile);
+	if (d->mmap_ptr && pos >= 0 && pos <= static_cast<off64_t>(d->mmap_size) &&
+	    size <= d->mmap_size - static_cast<size_t>(pos))
+	{
+		// Make sure the file wasn't truncated since it was mapped.
+		if (d->checkMapSize()) {
+			return &d->mmap_ptr[pos];
+		}
+	}
+#else /* !HAVE_MMAP */
+	RP_UNUSED(pos);
+	RP_UNUSED(size);
+#endif /* HAVE_MMAP */
+
+	// Not memory-mapped, or out of range.
+	return nullptr;
+}
+
 /**
  * Write data to the file.
  * @param ptr Input data buffer.
@@ -429,18 +837,24 @@ int RpFile::seek(off64_t pos)
 		return 0;
 	}
 
+#ifdef HAVE_MMAP
+	if (d->mmap_ptr) {
+		// Memory-mapped file.
+		// Seeking past the end is allowed, same as fseeko().
+		if (pos < 0) {
+			m_lastError = EINVAL;
+			return -1;
+		}
+		d->mmap_pos = pos;
+		return 0;
+	}
+#endif /* HAVE_MMAP */
+
 	int ret;
-	if (d->gzfd != 0) {
-		errno = 0;
-		z_off_t zret = gzseek(d->gzfd, pos, SEEK_SET);
-		if (zret >= 0) {
-			ret = 0;
-		} else {
-			ret = -1;
-			m_lastError = -errno;
-			if (m_lastError == 0) {
-				m_lastError = -EIO;
-			}
+	if (d->gzReader) {
+		ret = d->gzReader->seek(pos);
+		if (ret != 0) {
+			m_lastError = d->gzReader->lastError();
 		}
 	} else {
 		ret = fseeko(d->file, pos, SEEK_SET);
@@ -464,9 +878,14 @@ off64_t RpFile::tell(void)
 		return -1;
 	}
 
-	if (d->gzfd != 0) {
-		return (off64_t)gztell(d->gzfd);
+	if (d->gzReader) {
+		return d->gzReader->tell();
+	}
+#ifdef HAVE_MMAP
+	if (d->mmap_ptr) {
+		return d->mmap_pos;
 	}
+#endif /* HAVE_MMAP */
 	return ftello(d->file);
 }
 
@@ -538,6 +957,83 @@ int RpFile::flush(void)
 	return 0;
 }
 
+/**
+ * Advise the OS of the expected access pattern.
+ * This is only a hint; it does not affect the data read.
+ * @param pattern	[in] Access pattern.
+ * @param offset	[in] Starting offset.
+ * @param len		[in] Length, or 0 for the rest of the file.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpFile::adviseAccess(AccessPattern pattern, off64_t offset, off64_t len)
+{
+	RP_D(RpFile);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return -EBADF;
+	} else if (d->gzReader) {
+		// Offsets don't match the underlying file.
+		return -ENOTSUP;
+	} else if (offset < 0 || len < 0) {
+		return -EINVAL;
+	}
+
+#ifdef HAVE_MMAP
+	if (d->mmap_ptr) {
+		// Memory-mapped file. Use madvise() for peek(),
+		// and posix_fadvise() below for regular reads.
+		int advice;
+		switch (pattern) {
+			default:
+			case AccessPattern::Normal:	advice = MADV_NORMAL;		break;
+			case AccessPattern::Sequential:	advice = MADV_SEQUENTIAL;	break;
+			case AccessPattern::Random:	advice = MADV_RANDOM;		break;
+			case AccessPattern::WillNeed:	advice = MADV_WILLNEED;		break;
+			case AccessPattern::DontNeed:	advice = MADV_DONTNEED;		break;
+		}
+
+		if (offset < static_cast<off64_t>(d->mmap_size)) {
+			off64_t map_len = len;
+			if (map_len == 0 || map_len > static_cast<off64_t>(d->mmap_size) - offset) {
+				map_len = static_cast<off64_t>(d->mmap_size) - offset;
+			}
+
+			// madvise() requires a page-aligned address.
+			static const long pageSize = sysconf(_SC_PAGESIZE);
+			const off64_t start = (pageSize > 0) ? (offset & ~(static_cast<off64_t>(pageSize) - 1)) : offset;
+			int ret = madvise(&d->mmap_ptr[start], static_cast<size_t>(map_len + (offset - start)), advice);
+			if (ret != 0) {
+				m_lastError = errno;
+				return -m_lastError;
+			}
+		}
+	}
+#endif /* HAVE_MMAP */
+
+#ifdef HAVE_POSIX_FADVISE
+	int advice;
+	switch (pattern) {
+		default:
+		case AccessPattern::Normal:	advice = POSIX_FADV_NORMAL;	break;
+		case AccessPattern::Sequential:	advice = POSIX_FADV_SEQUENTIAL;	break;
+		case AccessPattern::Random:	advice = POSIX_FADV_RANDOM;	break;
+		case AccessPattern::WillNeed:	advice = POSIX_FADV_WILLNEED;	break;
+		case AccessPattern::DontNeed:	advice = POSIX_FADV_DONTNEED;	break;
+	}
+
+	// NOTE: posix_fadvise() returns the error code directly.
+	int ret = posix_fadvise(fileno(d->file), offset, len, advice);
+	if (ret != 0) {
+		m_lastError = ret;
+		return -ret;
+	}
+	return 0;
+#else /* !HAVE_POSIX_FADVISE */
+	RP_UNUSED(pattern);
+	return -ENOTSUP;
+#endif /* HAVE_POSIX_FADVISE */
+}
+
 /** File properties **/
 
 /**
@@ -557,11 +1053,17 @@ off64_t RpFile::size(void)
 	if (d->devInfo) {
 		// Block device. Use the cached device size.
 		return d->devInfo->device_size;
-	} else if (d->gzfd != 0) {
+	} else if (d->gzReader) {
 		// gzipped files have the uncompressed size stored
 		// at the end of the stream.
 		return d->gzsz;
 	}
+#ifdef HAVE_MMAP
+	else if (d->mmap_ptr) {
+		// Memory-mapped file. Use the mapped size.
+		return static_cast<off64_t>(d->mmap_size);
+	}
+#endif /* HAVE_MMAP */
 
 	// Save the current position.
 	off64_t cur_pos = ftello(d->file);
@@ -604,6 +1106,10 @@ int RpFile::makeWritable(void)
 	}
 
 	RP_D(RpFile);
+#ifdef HAVE_MMAP
+	// Writable files can't be memory-mapped.
+	d->unmapFile();
+#endif /* HAVE_MMAP */
 	off64_t prev_pos = ftello(d->file);
 	fclose(d->file);
 	d->file = fopen(d->filename.c_str(), "rb+");
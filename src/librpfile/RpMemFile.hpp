@@ -66,6 +66,27 @@ class RpMemFile : public IRpFile
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the file at the specified position.
+		 * The file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
+		/**
+		 * Get a pointer to file data without copying it.
+		 * The pointer is valid until the file is closed.
+		 * The file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param size	[in] Amount of data, in bytes.
+		 * @return Pointer to the data, or nullptr if out of range.
+		 */
+		const uint8_t *peek(off64_t pos, size_t size) final;
+
 		/**
 		 * Write data to the file.
 		 * (NOTE: Not valid for RpMemFile; this will always return 0.)
@@ -0,0 +1,44 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * RpTrace.cpp: Trace points for hot paths.                                *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RpTrace.hpp"
+
+#ifdef HAVE_TRACELOGGING_PROVIDER_H
+// Provider: "RomProperties"
+// {75D14BA7-B168-4C81-9FDB-17DEF49BC7DA}
+TRACELOGGING_DEFINE_PROVIDER(g_hRpTraceProvider, "RomProperties",
+	(0x75d14ba7, 0xb168, 0x4c81, 0x9f, 0xdb, 0x17, 0xde, 0xf4, 0x9b, 0xc7, 0xda));
+#endif /* HAVE_TRACELOGGING_PROVIDER_H */
+
+namespace LibRpFile {
+
+/**
+ * Register the trace provider.
+ * Only needed on Windows; does nothing otherwise.
+ * Call this once at startup, e.g. in DllMain().
+ */
+void rp_trace_register(void)
+{
+#ifdef HAVE_TRACELOGGING_PROVIDER_H
+	TraceLoggingRegister(g_hRpTraceProvider);
+#endif /* HAVE_TRACELOGGING_PROVIDER_H */
+}
+
+/**
+ * Unregister the trace provider.
+ * Must be called before a DLL is unloaded if rp_trace_register() was called.
+ */
+void rp_trace_unregister(void)
+{
+#ifdef HAVE_TRACELOGGING_PROVIDER_H
+	TraceLoggingUnregister(g_hRpTraceProvider);
+#endif /* HAVE_TRACELOGGING_PROVIDER_H */
+}
+
+}
@@ -0,0 +1,131 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * RpTrace.hpp: Trace points for hot paths.                                *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+/**
+ * Trace points are compiled in if ENABLE_TRACING is set and
+ * the platform's tracing header is available:
+ *
+ * - Linux: USDT probes (sys/sdt.h, from SystemTap)
+ *   Provider "rom_properties", probes "begin" and "end".
+ *   Both take two string arguments: name and detail. (detail may be NULL)
+ *   Example: bpftrace -e 'usdt:/usr/bin/rpcli:rom_properties:begin { printf("%s\n", str(arg0)); }'
+ *   Each probe is a single NOP until a tracer attaches.
+ *
+ * - Windows: ETW TraceLogging
+ *   Provider "RomProperties", events "Begin" and "End",
+ *   with "Name" and "Detail" string fields.
+ *   Events are only written if a session has enabled the provider.
+ *   rp_trace_register() must be called at startup.
+ *
+ * Otherwise, the macros compile to nothing.
+ */
+
+#ifndef __ROMPROPERTIES_LIBRPFILE_RPTRACE_HPP__
+#define __ROMPROPERTIES_LIBRPFILE_RPTRACE_HPP__
+
+#include "config.librpfile.h"
+#include "common.h"
+
+#if defined(HAVE_SYS_SDT_H)
+# include <sys/sdt.h>
+# define RP_TRACE_BEGIN(name, detail)	DTRACE_PROBE2(rom_properties, begin, (name), (detail))
+# define RP_TRACE_END(name, detail)	DTRACE_PROBE2(rom_properties, end, (name), (detail))
+#elif defined(HAVE_TRACELOGGING_PROVIDER_H)
+# include "libwin32common/RpWin32_sdk.h"
+# include <TraceLoggingProvider.h>
+TRACELOGGING_DECLARE_PROVIDER(g_hRpTraceProvider);
+# define RP_TRACE_BEGIN(name, detail) \
+	TraceLoggingWrite(g_hRpTraceProvider, "Begin", \
+		TraceLoggingString((name), "Name"), \
+		TraceLoggingString((detail), "Detail"))
+# define RP_TRACE_END(name, detail) \
+	TraceLoggingWrite(g_hRpTraceProvider, "End", \
+		TraceLoggingString((name), "Name"), \
+		TraceLoggingString((detail), "Detail"))
+#else
+# define RP_TRACE_BEGIN(name, detail)	do { } while (0)
+# define RP_TRACE_END(name, detail)	do { } while (0)
+#endif
+
+#if defined(HAVE_SYS_SDT_H) || defined(HAVE_TRACELOGGING_PROVIDER_H)
+# define RP_TRACE_ENABLED 1
+#endif
+
+namespace LibRpFile {
+
+/**
+ * Register the trace provider.
+ * Only needed on Windows; does nothing otherwise.
+ * Call this once at startup, e.g. in DllMain().
+ */
+void rp_trace_register(void);
+
+/**
+ * Unregister the trace provider.
+ * Must be called before a DLL is unloaded if rp_trace_register() was called.
+ */
+void rp_trace_unregister(void);
+
+/**
+ * Emit begin/end trace events for the current scope.
+ * The name and detail strings must outlive the scope.
+ */
+class RpTraceScope
+{
+	public:
+		inline explicit RpTraceScope(const char *name, const char *detail = nullptr)
+#ifdef RP_TRACE_ENABLED
+			: m_name(name)
+			, m_detail(detail)
+#endif /* RP_TRACE_ENABLED */
+		{
+#ifdef RP_TRACE_ENABLED
+			RP_TRACE_BEGIN(m_name, m_detail);
+#else /* !RP_TRACE_ENABLED */
+			((void)name);
+			((void)detail);
+#endif /* RP_TRACE_ENABLED */
+		}
+
+		inline ~RpTraceScope()
+		{
+			RP_TRACE_END(m_name, m_detail);
+		}
+
+	private:
+		RP_DISABLE_COPY(RpTraceScope)
+
+#ifdef RP_TRACE_ENABLED
+	private:
+		const char *const m_name;
+		const char *const m_detail;
+#endif /* RP_TRACE_ENABLED */
+};
+
+}
+
+// Concatenation helpers for unique variable names.
+#define RP_TRACE_CONCAT2(a, b) a##b
+#define RP_TRACE_CONCAT(a, b) RP_TRACE_CONCAT2(a, b)
+
+/**
+ * Trace the current scope.
+ * @param name Name (string literal)
+ */
+#define RP_TRACE_SCOPE(name) \
+	LibRpFile::RpTraceScope RP_TRACE_CONCAT(_rpTraceScope_, __LINE__)(name)
+
+/**
+ * Trace the current scope, with a detail string.
+ * @param name Name (string literal)
+ * @param detail Detail string, e.g. a class name. (must outlive the scope)
+ */
+#define RP_TRACE_SCOPE_D(name, detail) \
+	LibRpFile::RpTraceScope RP_TRACE_CONCAT(_rpTraceScope_, __LINE__)((name), (detail))
+
+#endif /* __ROMPROPERTIES_LIBRPFILE_RPTRACE_HPP__ */
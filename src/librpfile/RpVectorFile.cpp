@@ -57,6 +57,59 @@ size_t RpVectorFile::read(void *ptr, size_t size)
 	return size;
 }
 
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpVectorFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	if (unlikely(size == 0) || pos >= static_cast<off64_t>(m_vector.size())) {
+		// Not reading anything...
+		return 0;
+	}
+
+	// Check if size is in bounds.
+	if (size > m_vector.size() - static_cast<size_t>(pos)) {
+		// Not enough data.
+		// Copy whatever's left in the buffer.
+		size = m_vector.size() - static_cast<size_t>(pos);
+	}
+
+	// Copy the data.
+	const uint8_t *const buf = m_vector.data();
+	memcpy(ptr, &buf[pos], size);
+	return size;
+}
+
+/**
+ * Get a pointer to file data without copying it.
+ * The pointer is valid until the file is modified or closed.
+ * The file position is not changed.
+ * @param pos	[in] File position.
+ * @param size	[in] Amount of data, in bytes.
+ * @return Pointer to the data, or nullptr if out of range.
+ */
+const uint8_t *RpVectorFile::peek(off64_t pos, size_t size)
+{
+	if (pos < 0 || pos > static_cast<off64_t>(m_vector.size()) ||
+	    size > m_vector.size() - static_cast<size_t>(pos))
+	{
+		// Out of range.
+		return nullptr;
+	}
+
+	return &m_vector.data()[pos];
+}
+
 /**
  * Write data to the file.
  * @param ptr Input data buffer.
@@ -107,4 +160,26 @@ int RpVectorFile::seek(off64_t pos)
 	return 0;
 }
 
+/**
+ * Truncate the file.
+ * @param size New size. (default is 0)
+ * @return 0 on success; -1 on error.
+ */
+int RpVectorFile::truncate(off64_t size)
+{
+	if (size < 0) {
+		m_lastError = EINVAL;
+		return -1;
+	}
+
+	// Resize the std::vector.
+	// If the current position is past the new size,
+	// move it to the end of the file.
+	m_vector.resize(static_cast<size_t>(size));
+	if (m_pos > m_vector.size()) {
+		m_pos = m_vector.size();
+	}
+	return 0;
+}
+
 }
@@ -60,6 +60,27 @@ class RpVectorFile final : public IRpFile
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the file at the specified position.
+		 * The file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
+		/**
+		 * Get a pointer to file data without copying it.
+		 * The pointer is valid until the file is modified or closed.
+		 * The file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param size	[in] Amount of data, in bytes.
+		 * @return Pointer to the data, or nullptr if out of range.
+		 */
+		const uint8_t *peek(off64_t pos, size_t size) final;
+
 		/**
 		 * Write data to the file.
 		 * @param ptr Input data buffer.
@@ -85,6 +106,13 @@ class RpVectorFile final : public IRpFile
 			return static_cast<off64_t>(m_pos);
 		}
 
+		/**
+		 * Truncate the file.
+		 * @param size New size. (default is 0)
+		 * @return 0 on success; -1 on error.
+		 */
+		int truncate(off64_t size = 0) final;
+
 		/**
 		 * Flush buffers.
 		 * This operation only makes sense on writable files.
@@ -79,10 +79,67 @@ class SubFile final : public IRpFile
 				return 0;
 			}
 
-			// NOTE: Not enforcing length bounds.
+			// Don't read past the end of the subfile.
+			const off64_t pos = m_file->tell() - m_offset;
+			if (pos < 0 || pos >= m_length) {
+				// Out of range.
+				return 0;
+			} else if (static_cast<off64_t>(size) > m_length - pos) {
+				size = static_cast<size_t>(m_length - pos);
+			}
 			return m_file->read(ptr, size);
 		}
 
+		/**
+		 * Read data from the file at the specified position.
+		 * The file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final
+		{
+			if (!m_file) {
+				m_lastError = EBADF;
+				return 0;
+			} else if (pos < 0) {
+				m_lastError = EINVAL;
+				return 0;
+			} else if (pos >= m_length) {
+				// End of subfile.
+				return 0;
+			}
+
+			// Don't read past the end of the subfile.
+			if (static_cast<off64_t>(size) > m_length - pos) {
+				size = static_cast<size_t>(m_length - pos);
+			}
+			return m_file->readAt(m_offset + pos, ptr, size);
+		}
+
+		/**
+		 * Get a pointer to file data without copying it.
+		 * This is forwarded to the underlying file.
+		 * @param pos	[in] File position.
+		 * @param size	[in] Amount of data, in bytes.
+		 * @return Pointer to the data, or nullptr if not supported or out of range.
+		 */
+		const uint8_t *peek(off64_t pos, size_t size) final
+		{
+			if (!m_file) {
+				m_lastError = EBADF;
+				return nullptr;
+			} else if (pos < 0 || pos > m_length ||
+			           static_cast<off64_t>(size) > m_length - pos)
+			{
+				// Out of range.
+				return nullptr;
+			}
+			return m_file->peek(m_offset + pos, size);
+		}
+
 		/**
 		 * Write data to the file.
 		 * @param ptr Input data buffer.
@@ -151,6 +208,34 @@ class SubFile final : public IRpFile
 			return m_file->flush();
 		}
 
+		/**
+		 * Advise the OS of the expected access pattern.
+		 * This is only a hint; it does not affect the data read.
+		 * @param pattern	[in] Access pattern.
+		 * @param offset	[in] Starting offset.
+		 * @param len		[in] Length, or 0 for the rest of the file.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int adviseAccess(AccessPattern pattern, off64_t offset = 0, off64_t len = 0) final
+		{
+			if (!m_file) {
+				m_lastError = EBADF;
+				return -EBADF;
+			} else if (offset < 0 || len < 0 || offset > m_length) {
+				return -EINVAL;
+			}
+
+			// Don't advise past the end of the subfile.
+			if (len == 0 || len > m_length - offset) {
+				len = m_length - offset;
+			}
+			if (len == 0) {
+				// Nothing to advise.
+				return 0;
+			}
+			return m_file->adviseAccess(pattern, m_offset + offset, len);
+		}
+
 	public:
 		/** File properties **/
 
@@ -0,0 +1,289 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * IoUring.cpp: Minimal io_uring wrapper for batched reads. (Linux only)   *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "IoUring.hpp"
+
+// C includes.
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// C++ includes.
+#include <memory>
+
+// C++ STL classes.
+using std::string;
+using std::unique_ptr;
+
+namespace LibRpFile {
+
+// Set if io_uring_setup() failed because io_uring
+// isn't supported or is disabled on this system.
+static bool s_unsupported = false;
+
+static inline int sys_io_uring_setup(unsigned int entries, struct io_uring_params *p)
+{
+	return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+static inline int sys_io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags)
+{
+	return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+/**
+ * Create an io_uring instance.
+ * @param entries Number of submission queue entries.
+ */
+IoUring::IoUring(unsigned int entries)
+	: m_ringFd(-1)
+	, m_lastError(0)
+	, m_sqRing(MAP_FAILED)
+	, m_sqRingSize(0)
+	, m_sqHead(nullptr)
+	, m_sqTail(nullptr)
+	, m_sqMask(0)
+	, m_sqEntries(0)
+	, m_sqArray(nullptr)
+	, m_sqes(static_cast<struct io_uring_sqe*>(MAP_FAILED))
+	, m_sqesSize(0)
+	, m_cqRing(MAP_FAILED)
+	, m_cqRingSize(0)
+	, m_cqHead(nullptr)
+	, m_cqTail(nullptr)
+	, m_cqMask(0)
+	, m_cqes(nullptr)
+	, m_iov(nullptr)
+{
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	const int fd = sys_io_uring_setup(entries, &p);
+	if (fd < 0) {
+		m_lastError = errno;
+		if (m_lastError == ENOSYS || m_lastError == EPERM) {
+			// Not supported by the kernel, or disabled by the administrator.
+			__atomic_store_n(&s_unsupported, true, __ATOMIC_RELAXED);
+		}
+		return;
+	}
+
+	// Map the submission queue, the SQE array, and the completion queue.
+	// NOTE: IORING_FEAT_SINGLE_MMAP isn't used, since mapping
+	// the two rings separately works on all kernels.
+	m_sqRingSize = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+	m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	m_sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+	m_sqes = static_cast<struct io_uring_sqe*>(mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+	m_cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+	if (m_sqRing == MAP_FAILED || m_sqes == MAP_FAILED || m_cqRing == MAP_FAILED) {
+		m_lastError = errno;
+		::close(fd);
+		return;
+	}
+
+	uint8_t *const sq = static_cast<uint8_t*>(m_sqRing);
+	m_sqHead = reinterpret_cast<uint32_t*>(sq + p.sq_off.head);
+	m_sqTail = reinterpret_cast<uint32_t*>(sq + p.sq_off.tail);
+	m_sqMask = *reinterpret_cast<uint32_t*>(sq + p.sq_off.ring_mask);
+	m_sqEntries = p.sq_entries;
+	m_sqArray = reinterpret_cast<uint32_t*>(sq + p.sq_off.array);
+
+	uint8_t *const cq = static_cast<uint8_t*>(m_cqRing);
+	m_cqHead = reinterpret_cast<uint32_t*>(cq + p.cq_off.head);
+	m_cqTail = reinterpret_cast<uint32_t*>(cq + p.cq_off.tail);
+	m_cqMask = *reinterpret_cast<uint32_t*>(cq + p.cq_off.ring_mask);
+	m_cqes = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+
+	m_iov = new struct iovec[m_sqEntries];
+	m_ringFd = fd;
+}
+
+IoUring::~IoUring()
+{
+	if (m_sqRing != MAP_FAILED) {
+		munmap(m_sqRing, m_sqRingSize);
+	}
+	if (m_sqes != MAP_FAILED) {
+		munmap(m_sqes, m_sqesSize);
+	}
+	if (m_cqRing != MAP_FAILED) {
+		munmap(m_cqRing, m_cqRingSize);
+	}
+	if (m_ringFd >= 0) {
+		::close(m_ringFd);
+	}
+	delete[] m_iov;
+}
+
+/**
+ * Get this thread's IoUring instance.
+ * The instance is created on first use.
+ * @return IoUring instance, or nullptr if io_uring isn't available.
+ */
+IoUring *IoUring::forThread(void)
+{
+	static thread_local unique_ptr<IoUring> tls_ring;
+	static thread_local bool tls_tried = false;
+
+	if (!tls_tried) {
+		tls_tried = true;
+		if (!__atomic_load_n(&s_unsupported, __ATOMIC_RELAXED)) {
+			tls_ring.reset(new IoUring());
+			if (!tls_ring->isOpen()) {
+				tls_ring.reset();
+			}
+		}
+	}
+	return tls_ring.get();
+}
+
+/**
+ * Wait for completions.
+ * @param reqs Requests
+ * @param toSubmit Number of queued submissions
+ * @param pending Number of pending completions
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int IoUring::submitAndWait(Request *reqs, unsigned int toSubmit, unsigned int pending)
+{
+	while (pending > 0) {
+		const int ret = sys_io_uring_enter(m_ringFd, toSubmit, 1, IORING_ENTER_GETEVENTS);
+		if (ret < 0) {
+			if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+				continue;
+			}
+			m_lastError = errno;
+			return -m_lastError;
+		}
+		toSubmit -= std::min(toSubmit, static_cast<unsigned int>(ret));
+
+		// Reap the completions.
+		uint32_t head = *m_cqHead;
+		const uint32_t tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+		for (; head != tail; head++) {
+			const struct io_uring_cqe *const cqe = &m_cqes[head & m_cqMask];
+			reqs[cqe->user_data].result = cqe->res;
+			pending--;
+		}
+		__atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+	}
+
+	return 0;
+}
+
+/**
+ * Submit multiple reads and wait for all of them to complete.
+ * The result of each read is stored in its Request.
+ * @param reqs Requests
+ * @param count Number of requests
+ * @return 0 on success; negative POSIX error code if the ring failed.
+ */
+int IoUring::read(Request *reqs, size_t count)
+{
+	if (m_ringFd < 0) {
+		return -EBADF;
+	}
+
+	size_t i = 0;
+	while (i < count) {
+		// Queue as many requests as the submission queue can hold.
+		uint32_t tail = *m_sqTail;
+		unsigned int queued = 0;
+		for (; i < count && queued < m_sqEntries; i++, queued++) {
+			Request &req = reqs[i];
+			req.result = -EIO;
+
+			const uint32_t idx = tail & m_sqMask;
+			m_iov[idx].iov_base = req.ptr;
+			m_iov[idx].iov_len = req.size;
+
+			// NOTE: IORING_OP_READV is used instead of IORING_OP_READ,
+			// since the latter requires Linux 5.6.
+			struct io_uring_sqe *const sqe = &m_sqes[idx];
+			memset(sqe, 0, sizeof(*sqe));
+			sqe->opcode = IORING_OP_READV;
+			sqe->fd = req.fd;
+			sqe->off = static_cast<uint64_t>(req.pos);
+			sqe->addr = reinterpret_cast<uintptr_t>(&m_iov[idx]);
+			sqe->len = 1;
+			sqe->user_data = i;
+			m_sqArray[idx] = idx;
+			tail++;
+		}
+		__atomic_store_n(m_sqTail, tail, __ATOMIC_RELEASE);
+
+		const int ret = submitAndWait(reqs, queued, queued);
+		if (ret != 0) {
+			// The ring is in an unknown state. Don't use it again.
+			::close(m_ringFd);
+			m_ringFd = -1;
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Read the beginning of multiple files into the page cache.
+ * The reads are submitted together, so the files are
+ * fetched concurrently; the data itself is discarded.
+ * @param filenames Filenames
+ * @param count Number of filenames
+ * @param size Amount of data to read from each file
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int IoUring::prefetch(const string *filenames, size_t count, size_t size)
+{
+	if (m_ringFd < 0) {
+		return -EBADF;
+	} else if (count == 0 || size == 0) {
+		return 0;
+	}
+
+	unique_ptr<Request[]> reqs(new Request[count]);
+	unique_ptr<uint8_t[]> buf(new uint8_t[count * size]);
+	size_t reqCount = 0;
+	for (size_t i = 0; i < count; i++) {
+		// Only prefetch regular files.
+		// Devices (e.g. optical drives) should not be read here.
+		const int fd = open(filenames[i].c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+		if (fd < 0) {
+			continue;
+		}
+		struct stat sb;
+		if (fstat(fd, &sb) != 0 || !S_ISREG(sb.st_mode)) {
+			::close(fd);
+			continue;
+		}
+
+		Request &req = reqs[reqCount];
+		req.fd = fd;
+		req.pos = 0;
+		req.ptr = &buf[reqCount * size];
+		req.size = size;
+		reqCount++;
+	}
+
+	const int ret = read(reqs.get(), reqCount);
+	for (size_t i = 0; i < reqCount; i++) {
+		::close(reqs[i].fd);
+	}
+	return ret;
+}
+
+}
@@ -0,0 +1,152 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * IoUring.hpp: Minimal io_uring wrapper for batched reads. (Linux only)   *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPFILE_LINUX_IOURING_HPP__
+#define __ROMPROPERTIES_LIBRPFILE_LINUX_IOURING_HPP__
+
+#include "config.librpfile.h"
+#ifndef HAVE_IO_URING
+#  error IoUring requires io_uring support.
+#endif /* !HAVE_IO_URING */
+
+#include "common.h"
+
+// C includes.
+#include <stdint.h>
+#include <sys/types.h>
+
+// C++ includes.
+#include <string>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct iovec;
+
+namespace LibRpFile {
+
+/**
+ * Minimal io_uring wrapper.
+ *
+ * This only supports reads. All requests passed to a single
+ * read() call are submitted together, so the device can
+ * service them concurrently instead of one at a time.
+ *
+ * liburing is not used; the ring is set up using the raw
+ * syscalls, since only a tiny subset is needed.
+ *
+ * NOTE: An IoUring object must only be used by a single thread.
+ * Use IoUring::forThread() to get a per-thread instance.
+ */
+class IoUring
+{
+	public:
+		/**
+		 * Create an io_uring instance.
+		 * @param entries Number of submission queue entries.
+		 */
+		explicit IoUring(unsigned int entries = 64);
+		~IoUring();
+
+	private:
+		RP_DISABLE_COPY(IoUring)
+
+	public:
+		/**
+		 * Is the ring set up?
+		 * @return True if it is; false if not.
+		 */
+		inline bool isOpen(void) const
+		{
+			return (m_ringFd >= 0);
+		}
+
+		/**
+		 * Get the last error.
+		 * @return Last POSIX error, or 0 if no error.
+		 */
+		inline int lastError(void) const
+		{
+			return m_lastError;
+		}
+
+		/**
+		 * Get this thread's IoUring instance.
+		 * The instance is created on first use.
+		 * @return IoUring instance, or nullptr if io_uring isn't available.
+		 */
+		static IoUring *forThread(void);
+
+	public:
+		struct Request {
+			int fd;		// [in] File descriptor
+			off64_t pos;	// [in] File position
+			void *ptr;	// [in] Output buffer
+			size_t size;	// [in] Amount of data to read
+			ssize_t result;	// [out] Bytes read, or negative POSIX error code
+		};
+
+		/**
+		 * Submit multiple reads and wait for all of them to complete.
+		 * The result of each read is stored in its Request.
+		 * @param reqs Requests
+		 * @param count Number of requests
+		 * @return 0 on success; negative POSIX error code if the ring failed.
+		 */
+		int read(Request *reqs, size_t count);
+
+		/**
+		 * Read the beginning of multiple files into the page cache.
+		 * The reads are submitted together, so the files are
+		 * fetched concurrently; the data itself is discarded.
+		 * @param filenames Filenames
+		 * @param count Number of filenames
+		 * @param size Amount of data to read from each file
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int prefetch(const std::string *filenames, size_t count, size_t size);
+
+	private:
+		/**
+		 * Wait for completions.
+		 * @param reqs Requests
+		 * @param toSubmit Number of queued submissions
+		 * @param pending Number of pending completions
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int submitAndWait(Request *reqs, unsigned int toSubmit, unsigned int pending);
+
+	private:
+		int m_ringFd;
+		int m_lastError;
+
+		// Submission queue
+		void *m_sqRing;
+		size_t m_sqRingSize;
+		uint32_t *m_sqHead;
+		uint32_t *m_sqTail;
+		uint32_t m_sqMask;
+		uint32_t m_sqEntries;
+		uint32_t *m_sqArray;
+		struct io_uring_sqe *m_sqes;
+		size_t m_sqesSize;
+
+		// Completion queue
+		void *m_cqRing;
+		size_t m_cqRingSize;
+		uint32_t *m_cqHead;
+		uint32_t *m_cqTail;
+		uint32_t m_cqMask;
+		struct io_uring_cqe *m_cqes;
+
+		// iovecs for IORING_OP_READV. (one per SQE)
+		struct iovec *m_iov;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPFILE_LINUX_IOURING_HPP__ */
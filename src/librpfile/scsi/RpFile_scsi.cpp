@@ -22,15 +22,20 @@
 namespace LibRpFile {
 
 /**
- * Read one sector into the sector cache.
- * @param lba LBA to read.
- * @return 0 on success; non-zero on error.
+ * Read LBAs from the device, bypassing the sector cache.
+ * Kreon drives use SCSI READ commands with the maximum
+ * supported transfer length; other drives use the OS API.
+ * @param lbaStart	[in] Starting LBA.
+ * @param lbaCount	[in] Number of LBAs to read.
+ * @param pBuf		[out] Output buffer. (must be at least lbaCount * sector_size bytes)
+ * @return Number of bytes read.
  */
-int RpFilePrivate::readOneLBA(uint32_t lba)
+size_t RpFilePrivate::readLBAs(uint32_t lbaStart, uint32_t lbaCount, uint8_t *pBuf)
 {
+	assert(devInfo != nullptr);
 	if (!devInfo) {
 		// Not a device.
-		return -ENODEV;
+		return 0;
 	}
 
 	// FIXME: On NetBSD and OpenBSD, the Kreon feature list command is failing
@@ -42,87 +47,135 @@ int RpFilePrivate::readOneLBA(uint32_t lba)
 	//
 	// TODO: Not sure about NetBSD...
 	RP_Q(RpFile);
-	if (lba == devInfo->lba_cache) {
-		// This LBA is already cached.
-		// TODO: Special case for ~0U?
-		if (!devInfo->isKreonUnlocked) {
-			// OSAPI: Seek to the next sector.
-			const off64_t seek_pos = (static_cast<off64_t>(lba) + 1) * devInfo->sector_size;
-#ifdef _WIN32
-			LARGE_INTEGER liSeekPos;
-			liSeekPos.QuadPart = seek_pos;
-			BOOL bRet = SetFilePointerEx(file, liSeekPos, nullptr, FILE_BEGIN);
-			if (!bRet) {
-				// Seek error.
-				q->m_lastError = w32err_to_posix(GetLastError());
-				return -q->m_lastError;
-			}
-#else /* !_WIN32 */
-			int ret = fseeko(file, seek_pos, SEEK_SET);
-			if (ret != 0) {
-				// Seek error.
-				q->m_lastError = errno;
-				return -q->m_lastError;
-			}
-#endif /* !_WIN32 */
-		}
-		return 0;
-	}
+	size_t ret = 0;
 
-	// Read the first block.
 	if (devInfo->isKreonUnlocked) {
 		// Kreon drive. Use SCSI commands.
-		int sret = scsi_read(lba, 1, devInfo->sector_cache, devInfo->sector_size);
-		if (sret != 0) {
-			// Read error.
-			// TODO: Handle this properly?
-			devInfo->lba_cache = ~0U;
-			q->m_lastError = sret;
-			return sret;
+		// Each READ(10) transfers as many LBAs as the drive supports.
+		const uint32_t lba_increment = scsi_get_max_xfer_lbas();
+		while (lbaCount > 0) {
+			const uint16_t lba_cur_count = static_cast<uint16_t>(std::min(lbaCount, lba_increment));
+			const size_t lba_cur_size = static_cast<size_t>(lba_cur_count) * devInfo->sector_size;
+			int sret = scsi_read(lbaStart, lba_cur_count, pBuf, lba_cur_size);
+			if (sret != 0) {
+				// Read error.
+				// TODO: Handle this properly?
+				q->m_lastError = sret;
+				return ret;
+			}
+			lbaStart += lba_cur_count;
+			lbaCount -= lba_cur_count;
+			pBuf += lba_cur_size;
+			ret += lba_cur_size;
 		}
-	} else {
-		// Not a Kreon drive. Use the OS API.
-		const off64_t seek_pos = static_cast<off64_t>(lba) * devInfo->sector_size;
+		return ret;
+	}
+
+	// Not a Kreon drive. Use the OS API.
+	// The OS splits the read into transfers that the drive supports.
+	const off64_t seek_pos = static_cast<off64_t>(lbaStart) * devInfo->sector_size;
+	const size_t contig_size = static_cast<size_t>(lbaCount) * devInfo->sector_size;
 #ifdef _WIN32
-		LARGE_INTEGER liSeekPos;
-		liSeekPos.QuadPart = seek_pos;
-		BOOL bRet = SetFilePointerEx(file, liSeekPos, nullptr, FILE_BEGIN);
-		if (!bRet) {
-			// Seek error.
-			devInfo->lba_cache = ~0U;
-			q->m_lastError = w32err_to_posix(GetLastError());
-			return -q->m_lastError;
-		}
+	LARGE_INTEGER liSeekPos;
+	liSeekPos.QuadPart = seek_pos;
+	BOOL bRet = SetFilePointerEx(file, liSeekPos, nullptr, FILE_BEGIN);
+	if (!bRet) {
+		// Seek error.
+		q->m_lastError = w32err_to_posix(GetLastError());
+		return 0;
+	}
 
-		DWORD bytesRead;
-		bRet = ReadFile(file, devInfo->sector_cache, devInfo->sector_size, &bytesRead, nullptr);
-		if (bRet == 0 || bytesRead != devInfo->sector_size) {
-			// Read error.
-			devInfo->lba_cache = ~0U;
-			q->m_lastError = w32err_to_posix(GetLastError());
-			return -q->m_lastError;
-		}
+	DWORD bytesRead;
+	bRet = ReadFile(file, pBuf, static_cast<DWORD>(contig_size), &bytesRead, nullptr);
+	if (bRet == 0 || bytesRead != contig_size) {
+		// Read error.
+		q->m_lastError = w32err_to_posix(GetLastError());
+	}
+	ret = bytesRead;
 #else /* !_WIN32 */
-		int ret = fseeko(file, seek_pos, SEEK_SET);
-		if (ret != 0) {
-			// Seek error.
-			devInfo->lba_cache = ~0U;
-			q->m_lastError = errno;
-			return -q->m_lastError;
+	int sret = fseeko(file, seek_pos, SEEK_SET);
+	if (sret != 0) {
+		// Seek error.
+		q->m_lastError = errno;
+		return 0;
+	}
+	ret = fread(pBuf, 1, contig_size, file);
+	if (ferror(file) || ret != contig_size) {
+		// Read error.
+		q->m_lastError = errno;
+	}
+#endif /* !_WIN32 */
+	return ret;
+}
+
+/**
+ * Get a sector from the sector cache.
+ * If it isn't cached, the aligned block containing
+ * the sector is read from the device.
+ * @param lba LBA to read.
+ * @return Pointer to the sector data, or nullptr on error.
+ */
+const uint8_t *RpFilePrivate::readCachedLBA(uint32_t lba)
+{
+	assert(devInfo != nullptr);
+	if (!devInfo) {
+		// Not a device.
+		return nullptr;
+	}
+
+	// Make sure the sector cache is allocated.
+	devInfo->alloc_sector_cache();
+	if (!devInfo->sector_cache) {
+		// Invalid sector size.
+		return nullptr;
+	}
+
+	// Check if the LBA is cached.
+	// If it isn't, replace the least recently used block.
+	static const unsigned int BLOCK_SIZE = DeviceInfo::SECTOR_CACHE_BLOCK_SIZE;
+	unsigned int lru = 0;
+	for (unsigned int i = 0; i < DeviceInfo::SECTOR_CACHE_BLOCK_COUNT; i++) {
+		DeviceInfo::CacheBlock &blk = devInfo->cache_blocks[i];
+		if (blk.lba_count != 0 && lba >= blk.lba && lba - blk.lba < blk.lba_count) {
+			// LBA is cached.
+			blk.last_use = ++devInfo->cache_use_counter;
+			return &devInfo->sector_cache[(i * BLOCK_SIZE) +
+				((lba - blk.lba) * devInfo->sector_size)];
 		}
-		size_t bytesRead = fread(devInfo->sector_cache, 1, devInfo->sector_size, file);
-		if (ferror(file) || bytesRead != devInfo->sector_size) {
-			// Read error.
-			devInfo->lba_cache = ~0U;
-			q->m_lastError = errno;
-			return -q->m_lastError;
+		if (blk.last_use < devInfo->cache_blocks[lru].last_use) {
+			lru = i;
 		}
-#endif /* _WIN32 */
+	}
+
+	// Read the entire aligned block in a single transfer.
+	// sector_size is a power of two, and it's <= BLOCK_SIZE.
+	const uint32_t lbas_per_block = BLOCK_SIZE / devInfo->sector_size;
+	const uint32_t lba_start = lba & ~(lbas_per_block - 1);
+	const off64_t lba_total = devInfo->device_size / devInfo->sector_size;
+	if (static_cast<off64_t>(lba) >= lba_total) {
+		// Out of range.
+		return nullptr;
+	}
+	const uint32_t lba_count = static_cast<uint32_t>(
+		std::min(static_cast<off64_t>(lbas_per_block), lba_total - lba_start));
+
+	DeviceInfo::CacheBlock &blk = devInfo->cache_blocks[lru];
+	uint8_t *const pBlock = &devInfo->sector_cache[lru * BLOCK_SIZE];
+	blk.lba_count = 0;
+	const size_t sz_read = readLBAs(lba_start, lba_count, pBlock);
+	const uint32_t lba_read = static_cast<uint32_t>(sz_read / devInfo->sector_size);
+	if (lba - lba_start >= lba_read) {
+		// Read error.
+		// NOTE: q->m_lastError is set by readLBAs().
+		return nullptr;
 	}
 
 	// Sector cache has been updated.
-	devInfo->lba_cache = lba;
-	return 0;
+	// NOTE: On a short read, only the LBAs that were read are cached.
+	blk.lba = lba_start;
+	blk.lba_count = lba_read;
+	blk.last_use = ++devInfo->cache_use_counter;
+	return &pBlock[(lba - lba_start) * devInfo->sector_size];
 }
 
 /**
@@ -152,8 +205,6 @@ size_t RpFilePrivate::readUsingBlocks(void *ptr, size_t size)
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 	size_t ret = 0;
 
-	RP_Q(RpFile);
-
 	// Are we already at the end of the block device?
 	if (devInfo->device_pos >= devInfo->device_size) {
 		// End of the block device.
@@ -171,36 +222,38 @@ size_t RpFilePrivate::readUsingBlocks(void *ptr, size_t size)
 	// TODO: 64-bit LBAs?
 	uint32_t lba_cur = static_cast<uint32_t>(devInfo->device_pos / devInfo->sector_size);
 
-	// Make sure the sector cache is allocated.
-	devInfo->alloc_sector_cache();
+	// Small reads are handled entirely by the sector cache, since
+	// the same sectors are usually read multiple times. Otherwise,
+	// only a partial first or last sector goes through the cache.
+	const bool useCache = (size < DeviceInfo::SECTOR_CACHE_BLOCK_SIZE);
 
 	// Check if we're not starting on a block boundary.
 	const uint32_t blockStartOffset = devInfo->device_pos % devInfo->sector_size;
-	if (blockStartOffset != 0) {
-		// Not a block boundary.
-		// Read the end of the first block.
-		int lret = readOneLBA(lba_cur);
-		if (lret != 0) {
-			// Read error.
-			// NOTE: q->m_lastError is set by readOneLBA().
-			// TODO: readOneLBA() should return number of bytes read,
-			// then return that value instead of 0?
-			return 0;
-		}
-
-		// Copy the data from the sector buffer.
-		uint32_t read_sz = devInfo->sector_size - blockStartOffset;
-		if (size < static_cast<size_t>(read_sz)) {
-			read_sz = static_cast<uint32_t>(size);
-		}
-		memcpy(ptr8, &devInfo->sector_cache[blockStartOffset], read_sz);
+	if (blockStartOffset != 0 || useCache) {
+		// Read sectors from the sector cache.
+		uint32_t sectorOffset = blockStartOffset;
+		do {
+			const uint8_t *const pSector = readCachedLBA(lba_cur);
+			if (!pSector) {
+				// Read error.
+				// NOTE: q->m_lastError is set by readCachedLBA().
+				return ret;
+			}
 
-		// Starting block read.
-		lba_cur++;
-		devInfo->device_pos += read_sz;
-		size -= read_sz;
-		ptr8 += read_sz;
-		ret += read_sz;
+			// Copy the data from the sector buffer.
+			uint32_t read_sz = devInfo->sector_size - sectorOffset;
+			if (size < static_cast<size_t>(read_sz)) {
+				read_sz = static_cast<uint32_t>(size);
+			}
+			memcpy(ptr8, &pSector[sectorOffset], read_sz);
+
+			lba_cur++;
+			devInfo->device_pos += read_sz;
+			size -= read_sz;
+			ptr8 += read_sz;
+			ret += read_sz;
+			sectorOffset = 0;
+		} while (useCache && size > 0);
 	}
 
 	if (size == 0) {
@@ -212,77 +265,20 @@ size_t RpFilePrivate::readUsingBlocks(void *ptr, size_t size)
 	assert(devInfo->device_pos % devInfo->sector_size == 0);
 
 	// Read contiguous blocks.
-	uint32_t lba_count = static_cast<uint32_t>(size / devInfo->sector_size);
-	size_t contig_size = static_cast<off64_t>(lba_count) * devInfo->sector_size;
-	if (devInfo->isKreonUnlocked) {
-		// Kreon drive. Use SCSI commands.
-		// NOTE: Reading up to 65535 LBAs at a time due to READ(10) limitations.
-		// TODO: Move the 65535 LBA code down to RpFile::scsi_read()?
-		// FIXME: Seems to have issues above a certain number of LBAs on Linux...
-		// Reducing it to 64 KB maximum reads.
-		// TODO: Use the sector cache for the first LBA if possible.
-		uint32_t lba_increment = 65536 / devInfo->sector_size;
-		for (; lba_count > 0; lba_count -= lba_increment) {
-			const uint16_t lba_cur_count = (lba_count > lba_increment ? lba_increment : (uint16_t)lba_count);
-			const size_t lba_cur_size = (size_t)lba_cur_count * devInfo->sector_size;
-			int sret = scsi_read(lba_cur, lba_cur_count, ptr8, lba_cur_size);
-			if (sret != 0) {
-				// Read error.
-				// TODO: Handle this properly?
-				q->m_lastError = sret;
-				return ret;
-			}
-			devInfo->device_pos += lba_cur_size;
-			lba_cur += lba_cur_count;
-			size -= lba_cur_size;
-			ptr8 += lba_cur_size;
-			ret += lba_cur_size;
-		}
-	} else {
-		// Not a Kreon drive. Use the OS API.
-		// TODO: Use the sector cache for the first LBA if possible.
-
-		// Make sure we're at the correct address. The initial seek may
-		// have been skipped if we started at the beginning of a block
-		// or if the partial block was cached.
-		const off64_t seek_pos = static_cast<off64_t>(lba_cur) * devInfo->sector_size;
-#ifdef _WIN32
-		LARGE_INTEGER liSeekPos;
-		liSeekPos.QuadPart = seek_pos;
-		BOOL bRet = SetFilePointerEx(file, liSeekPos, nullptr, FILE_BEGIN);
-		if (!bRet) {
-			// Seek error.
-			q->m_lastError = w32err_to_posix(GetLastError());
-			return ret;
-		}
-
-		DWORD bytesRead;
-		bRet = ReadFile(file, ptr8, static_cast<DWORD>(contig_size), &bytesRead, nullptr);
-		if (bRet == 0 || bytesRead != contig_size) {
+	const uint32_t lba_count = static_cast<uint32_t>(size / devInfo->sector_size);
+	if (lba_count > 0) {
+		const size_t contig_size = static_cast<size_t>(lba_count) * devInfo->sector_size;
+		const size_t sz_read = readLBAs(lba_cur, lba_count, ptr8);
+		devInfo->device_pos += sz_read;
+		ret += sz_read;
+		if (sz_read != contig_size) {
 			// Read error.
-			q->m_lastError = w32err_to_posix(GetLastError());
-			return ret + bytesRead;
-		}
-#else /* !_WIN32 */
-		int sret = fseeko(file, seek_pos, SEEK_SET);
-		if (sret != 0) {
-			// Seek error.
-			q->m_lastError = errno;
+			// NOTE: q->m_lastError is set by readLBAs().
 			return ret;
 		}
-		size_t bytesRead = fread(ptr8, 1, contig_size, file);
-		if (ferror(file) || bytesRead != contig_size) {
-			// Read error.
-			q->m_lastError = errno;
-			return ret + bytesRead;
-		}
-#endif /* !_WIN32 */
-
-		devInfo->device_pos += contig_size;
 		lba_cur += lba_count;
 		size -= contig_size;
 		ptr8 += contig_size;
-		ret += contig_size;
 	}
 
 	// Check if we still have data left. (not a full block)
@@ -291,17 +287,15 @@ size_t RpFilePrivate::readUsingBlocks(void *ptr, size_t size)
 		assert(devInfo->device_pos % devInfo->sector_size == 0);
 
 		// Read the last block.
-		int lret = readOneLBA(lba_cur);
-		if (lret != 0) {
+		const uint8_t *const pSector = readCachedLBA(lba_cur);
+		if (!pSector) {
 			// Read error.
-			// NOTE: q->m_lastError is set by readOneLBA().
-			// TODO: readOneLBA() should return number of bytes read,
-			// then add it to ret?
+			// NOTE: q->m_lastError is set by readCachedLBA().
 			return ret;
 		}
 
 		// Copy the data from the sector buffer.
-		memcpy(ptr8, devInfo->sector_cache, size);
+		memcpy(ptr8, pSector, size);
 
 		devInfo->device_pos += size;
 		ret += size;
@@ -412,6 +406,69 @@ int RpFilePrivate::scsi_read_capacity(off64_t *pDeviceSize, uint32_t *pSectorSiz
 #endif /* RP_OS_SCSI_SUPPORTED */
 }
 
+/**
+ * Get the maximum transfer length for SCSI READ commands.
+ * This uses the Block Limits VPD page if it's supported,
+ * limited by the OS maximum transfer size.
+ * The result is saved in devInfo->max_xfer_lbas.
+ * @return Maximum transfer length, in LBAs.
+ */
+uint16_t RpFilePrivate::scsi_get_max_xfer_lbas(void)
+{
+	assert(devInfo != nullptr);
+	assert(devInfo->sector_size >= 512);
+	if (devInfo->max_xfer_lbas != 0) {
+		// Already queried.
+		return devInfo->max_xfer_lbas;
+	}
+
+	// Default to 64 KB transfers.
+	// FIXME: Some drives seem to have issues above 64 KB on Linux,
+	// so this is the maximum unless the drive reports a higher limit.
+	uint32_t max_lbas = 65536 / devInfo->sector_size;
+
+#ifdef RP_OS_SCSI_SUPPORTED
+	// Check the Block Limits VPD page.
+	// NOTE: Most optical drives don't support this page.
+	SCSI_CDB_INQUIRY cdb;
+	SCSI_RESP_INQUIRY_VPD_BLOCK_LIMITS resp;
+	ASSERT_STRUCT(SCSI_CDB_INQUIRY, 6);
+	ASSERT_STRUCT(SCSI_RESP_INQUIRY_VPD_BLOCK_LIMITS, 16);
+	cdb.OpCode = SCSI_OP_INQUIRY;
+	cdb.EVPD = 1;
+	cdb.PageCode = SCSI_VPD_BLOCK_LIMITS;
+	cdb.AllocLen = cpu_to_be16(sizeof(resp));
+	cdb.Control = 0;
+
+	memset(&resp, 0, sizeof(resp));
+	int ret = scsi_send_cdb(&cdb, sizeof(cdb), &resp, sizeof(resp), ScsiDirection::In);
+	if (ret == 0 && resp.PageCode == SCSI_VPD_BLOCK_LIMITS) {
+		// Prefer the optimal transfer length, if it's set.
+		uint32_t vpd_lbas = be32_to_cpu(resp.OptimalTransferLength);
+		const uint32_t vpd_max_lbas = be32_to_cpu(resp.MaxTransferLength);
+		if (vpd_lbas == 0 || (vpd_max_lbas != 0 && vpd_lbas > vpd_max_lbas)) {
+			vpd_lbas = vpd_max_lbas;
+		}
+		if (vpd_lbas > max_lbas) {
+			max_lbas = vpd_lbas;
+		}
+	}
+#endif /* RP_OS_SCSI_SUPPORTED */
+
+	// Don't exceed the OS limit.
+	if (devInfo->os_max_xfer_size >= devInfo->sector_size) {
+		max_lbas = std::min(max_lbas, devInfo->os_max_xfer_size / devInfo->sector_size);
+	}
+	// READ(10) has a 16-bit transfer length.
+	max_lbas = std::min(max_lbas, 65535U);
+	if (max_lbas == 0) {
+		max_lbas = 1;
+	}
+
+	devInfo->max_xfer_lbas = static_cast<uint16_t>(max_lbas);
+	return devInfo->max_xfer_lbas;
+}
+
 /**
  * Read data from a device using SCSI commands.
  * @param lbaStart	[in] Starting LBA of the data to read.
@@ -59,6 +59,13 @@ int RpFile::rereadDeviceSizeOS(off64_t *pDeviceSize, uint32_t *pSectorSize)
 		return -EIO;
 	}
 
+	// Get the maximum transfer size for SG_IO.
+	// NOTE: BLKSECTGET returns the limit in 512-byte sectors.
+	unsigned short max_sectors = 0;
+	if (ioctl(fd, BLKSECTGET, &max_sectors) == 0 && max_sectors != 0) {
+		d->devInfo->os_max_xfer_size = static_cast<uint32_t>(max_sectors) * 512U;
+	}
+
 	// Return the values.
 	if (pDeviceSize) {
 		*pDeviceSize = d->devInfo->device_size;
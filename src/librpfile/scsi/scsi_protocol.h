@@ -351,6 +351,19 @@ typedef struct PACKED _SCSI_RESP_INQUIRY_STD {
 	uint8_t Reserved2[40];
 } SCSI_RESP_INQUIRY_STD;
 
+/* INQUIRY response for the Block Limits VPD page. (EVPD == 1, PageCode == 0xB0) */
+#define SCSI_VPD_BLOCK_LIMITS	0xB0
+typedef struct PACKED _SCSI_RESP_INQUIRY_VPD_BLOCK_LIMITS {
+	uint8_t PeripheralDeviceType;	/* High 3 bits == qualifier; low 5 bits == type */
+	uint8_t PageCode;		/* 0xB0 */
+	uint16_t PageLength;		/* (BE16) */
+	uint8_t WSNZ;
+	uint8_t MaxCompareAndWriteLength;
+	uint16_t OptimalTransferLengthGranularity;	/* (BE16) */
+	uint32_t MaxTransferLength;	/* (BE32) Maximum transfer length, in blocks. (0 == no limit) */
+	uint32_t OptimalTransferLength;	/* (BE32) Optimal transfer length, in blocks. */
+} SCSI_RESP_INQUIRY_VPD_BLOCK_LIMITS;
+
 /* Peripheral device types. (PeripheralDeviceType & 0x1F) */
 #define SCSI_DEVICE_TYPE_DASD		0x00	/* Direct-access block device, e.g. HDD. */
 #define SCSI_DEVICE_TYPE_SEQD		0x01	/* Sequential-access device, e.g. tape. */
@@ -0,0 +1,264 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile/tests)                  *
+ * GzIndexedReaderTest.cpp: GzIndexedReader tests.                         *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpfile
+#include "librpfile/GzIndexedReader.hpp"
+
+// zlib
+#include <zlib.h>
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <memory>
+#include <string>
+#include <vector>
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace LibRpFile { namespace Tests {
+
+class GzIndexedReaderTest : public ::testing::Test
+{
+	public:
+		// Uncompressed test data size.
+		// This should be several times CHECKPOINT_SPAN.
+		static const unsigned int DATA_SIZE = 4U*1024U*1024U;
+
+		// Uncompressed test data.
+		static vector<uint8_t> ms_data;
+		// gzip-compressed test data.
+		static vector<uint8_t> ms_gzData;
+
+		static void SetUpTestCase(void);
+		static void TearDownTestCase(void);
+
+	public:
+		/**
+		 * In-memory compressed file.
+		 */
+		struct MemSource {
+			const vector<uint8_t> *data;
+			size_t bytesRead;	// Total number of compressed bytes read
+		};
+
+		/**
+		 * Read compressed data from a MemSource.
+		 * @param userdata	[in] MemSource
+		 * @param pos		[in] File position
+		 * @param ptr		[out] Output buffer
+		 * @param size		[in] Amount of data to read
+		 * @return Number of bytes read.
+		 */
+		static size_t memReadAt(void *userdata, off64_t pos, void *ptr, size_t size)
+		{
+			MemSource *const src = static_cast<MemSource*>(userdata);
+			if (pos < 0 || static_cast<size_t>(pos) >= src->data->size())
+				return 0;
+			if (size > src->data->size() - static_cast<size_t>(pos)) {
+				size = src->data->size() - static_cast<size_t>(pos);
+			}
+			memcpy(ptr, src->data->data() + pos, size);
+			src->bytesRead += size;
+			return size;
+		}
+
+		/**
+		 * Read from a GzIndexedReader and compare to the uncompressed data.
+		 * @param gzr GzIndexedReader
+		 * @param pos Position
+		 * @param size Size
+		 */
+		static void checkRead(GzIndexedReader &gzr, size_t pos, size_t size)
+		{
+			size_t expected = size;
+			if (pos >= ms_data.size()) {
+				expected = 0;
+			} else if (expected > ms_data.size() - pos) {
+				expected = ms_data.size() - pos;
+			}
+
+			unique_ptr<uint8_t[]> buf(new uint8_t[size > 0 ? size : 1]);
+			ASSERT_EQ(0, gzr.seek(static_cast<off64_t>(pos)));
+			ASSERT_EQ(expected, gzr.read(buf.get(), size)) << "pos == " << pos << ", size == " << size;
+			EXPECT_EQ(static_cast<off64_t>(pos + expected), gzr.tell());
+			if (expected > 0) {
+				ASSERT_EQ(0, memcmp(buf.get(), &ms_data[pos], expected)) << "pos == " << pos << ", size == " << size;
+			}
+		}
+};
+
+const unsigned int GzIndexedReaderTest::DATA_SIZE;
+vector<uint8_t> GzIndexedReaderTest::ms_data;
+vector<uint8_t> GzIndexedReaderTest::ms_gzData;
+
+/**
+ * Generate the test data and compress it.
+ */
+void GzIndexedReaderTest::SetUpTestCase(void)
+{
+	// Compressible pseudo-random data: short runs of
+	// symbols from a small alphabet, so the deflate
+	// stream has plenty of blocks and back-references.
+	ms_data.resize(DATA_SIZE);
+	uint32_t seed = 0x12345678U;
+	for (size_t i = 0; i < ms_data.size(); ) {
+		seed = (seed * 1664525U) + 1013904223U;
+		const uint8_t chr = 'A' + ((seed >> 24) & 15);
+		size_t run = ((seed >> 16) & 7) + 1;
+		if (run > ms_data.size() - i) {
+			run = ms_data.size() - i;
+		}
+		memset(&ms_data[i], chr, run);
+		i += run;
+	}
+
+	// Compress the data in gzip format.
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+	ASSERT_EQ(Z_OK, deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY));
+	ms_gzData.resize(deflateBound(&strm, static_cast<uLong>(ms_data.size())));
+	strm.next_in = ms_data.data();
+	strm.avail_in = static_cast<uInt>(ms_data.size());
+	strm.next_out = ms_gzData.data();
+	strm.avail_out = static_cast<uInt>(ms_gzData.size());
+	const int ret = deflate(&strm, Z_FINISH);
+	ms_gzData.resize(strm.total_out);
+	deflateEnd(&strm);
+	ASSERT_EQ(Z_STREAM_END, ret);
+}
+
+void GzIndexedReaderTest::TearDownTestCase(void)
+{
+	vector<uint8_t>().swap(ms_data);
+	vector<uint8_t>().swap(ms_gzData);
+}
+
+/**
+ * Read the entire file sequentially.
+ */
+TEST_F(GzIndexedReaderTest, sequentialRead)
+{
+	MemSource src = {&ms_gzData, 0};
+	GzIndexedReader gzr(memReadAt, &src);
+	ASSERT_TRUE(gzr.isOpen());
+
+	static const size_t chunkSize = 65536 + 17;
+	for (size_t pos = 0; pos < ms_data.size(); pos += chunkSize) {
+		ASSERT_NO_FATAL_FAILURE(checkRead(gzr, pos, chunkSize));
+	}
+	EXPECT_EQ(0, gzr.lastError());
+}
+
+/**
+ * Random-offset reads must match a plain read of the uncompressed data.
+ * This exercises backwards seeks, which restart from a checkpoint.
+ */
+TEST_F(GzIndexedReaderTest, randomReads)
+{
+	MemSource src = {&ms_gzData, 0};
+	GzIndexedReader gzr(memReadAt, &src);
+	ASSERT_TRUE(gzr.isOpen());
+
+	uint32_t seed = 0xCAFEF00DU;
+	for (unsigned int i = 0; i < 256; i++) {
+		seed = (seed * 1664525U) + 1013904223U;
+		const size_t pos = seed % (ms_data.size() + 4096);
+		seed = (seed * 1664525U) + 1013904223U;
+		const size_t size = seed % 100000;
+		ASSERT_NO_FATAL_FAILURE(checkRead(gzr, pos, size));
+	}
+	EXPECT_EQ(0, gzr.lastError());
+}
+
+/**
+ * Seeking backwards to the end of the file after the index
+ * has been built shouldn't decompress the file from the start.
+ */
+TEST_F(GzIndexedReaderTest, backwardsSeekUsesCheckpoint)
+{
+	MemSource src = {&ms_gzData, 0};
+	GzIndexedReader gzr(memReadAt, &src);
+	ASSERT_TRUE(gzr.isOpen());
+
+	// Build the index.
+	const size_t tailPos = ms_data.size() - 4096;
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzr, tailPos, 4096));
+	// Read past the prefix cache, then go back to the tail.
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzr, GzIndexedReader::PREFIX_SIZE + 4096, 4096));
+
+	src.bytesRead = 0;
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzr, tailPos, 4096));
+	EXPECT_LT(src.bytesRead, ms_gzData.size() / 2);
+}
+
+/**
+ * A cached index is reused by a later reader for the same file,
+ * but only if the compressed size and mtime are unchanged.
+ */
+TEST_F(GzIndexedReaderTest, indexCache)
+{
+	const string filename = "GzIndexedReaderTest.indexCache.gz";
+	const off64_t compSize = static_cast<off64_t>(ms_gzData.size());
+	const size_t tailPos = ms_data.size() - 65536;
+
+	{
+		// Build the index and cache it.
+		MemSource src = {&ms_gzData, 0};
+		GzIndexedReader gzr(memReadAt, &src);
+		ASSERT_TRUE(gzr.isOpen());
+		gzr.useIndexCache(filename, compSize, 1000);
+		ASSERT_NO_FATAL_FAILURE(checkRead(gzr, tailPos, 65536));
+		ASSERT_NO_FATAL_FAILURE(checkRead(gzr, 0, 4096));
+	}
+
+	{
+		// Same file: The index should be reused.
+		MemSource src = {&ms_gzData, 0};
+		GzIndexedReader gzr(memReadAt, &src);
+		ASSERT_TRUE(gzr.isOpen());
+		gzr.useIndexCache(filename, compSize, 1000);
+		ASSERT_NO_FATAL_FAILURE(checkRead(gzr, 0, 4096));
+		ASSERT_NO_FATAL_FAILURE(checkRead(gzr, tailPos, 65536));
+		EXPECT_LT(src.bytesRead, ms_gzData.size() / 2);
+	}
+
+	{
+		// Modified file: The cached index must not be used.
+		MemSource src = {&ms_gzData, 0};
+		GzIndexedReader gzr(memReadAt, &src);
+		ASSERT_TRUE(gzr.isOpen());
+		gzr.useIndexCache(filename, compSize, 2000);
+		ASSERT_NO_FATAL_FAILURE(checkRead(gzr, tailPos, 65536));
+		EXPECT_GE(src.bytesRead, ms_gzData.size() / 2);
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpFile test suite: GzIndexedReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -510,4 +510,52 @@ int get_file_size_and_mtime(const string &filename, off64_t *pFileSize, time_t *
 	return 0;
 }
 
+/**
+ * Get a file's identity: device, inode, size, and modification time.
+ * @param filename	[in] Filename.
+ * @param pIdentity	[out] File identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_identity(const string &filename, FileIdentity *pIdentity)
+{
+	assert(pIdentity != nullptr);
+	const tstring tfilename = makeWinPath(filename);
+
+	// Open the file with no access rights in order to
+	// get the volume serial number and file index.
+	HANDLE hFile = CreateFile(tfilename.c_str(),
+		0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+	if (!hFile || hFile == INVALID_HANDLE_VALUE) {
+		// An error occurred.
+		const int err = w32err_to_posix(GetLastError());
+		return (err != 0 ? -err : -EIO);
+	}
+
+	BY_HANDLE_FILE_INFORMATION bhfi;
+	BOOL bRet = GetFileInformationByHandle(hFile, &bhfi);
+	CloseHandle(hFile);
+	if (!bRet) {
+		const int err = w32err_to_posix(GetLastError());
+		return (err != 0 ? -err : -EIO);
+	}
+
+	// Make sure this is not a directory.
+	if (bhfi.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+		// It's a directory.
+		return -EISDIR;
+	}
+
+	pIdentity->device = bhfi.dwVolumeSerialNumber;
+	pIdentity->inode = (static_cast<uint64_t>(bhfi.nFileIndexHigh) << 32) | bhfi.nFileIndexLow;
+	pIdentity->size = (static_cast<int64_t>(bhfi.nFileSizeHigh) << 32) | bhfi.nFileSizeLow;
+
+	// FILETIME is in 100ns units since 1601/01/01.
+	LARGE_INTEGER li;
+	li.LowPart = bhfi.ftLastWriteTime.dwLowDateTime;
+	li.HighPart = static_cast<LONG>(bhfi.ftLastWriteTime.dwHighDateTime);
+	pIdentity->mtime_ns = (li.QuadPart - FILETIME_1970) * 100;
+	return 0;
+}
+
 } }
@@ -10,15 +10,13 @@
 
 #include "../RpFile.hpp"
 #include "../RpFile_p.hpp"
+#include "../FileSystem.hpp"
 
 // libwin32common
 #include "libwin32common/MiniU82T.hpp"
 #include "libwin32common/w32err.h"
 using LibWin32Common::U82T_s;
 
-// C includes.
-#include <fcntl.h>
-
 // C++ STL classes.
 using std::string;
 using std::wstring;
@@ -39,9 +37,7 @@ DELAYLOAD_TEST_FUNCTION_IMPL0(get_crc_table);
 
 RpFilePrivate::~RpFilePrivate()
 {
-	if (gzfd) {
-		gzclose_r(gzfd);
-	}
+	delete gzReader;
 	if (file && file != INVALID_HANDLE_VALUE) {
 		CloseHandle(file);
 	}
@@ -90,7 +86,7 @@ inline int RpFilePrivate::mode_to_win32(RpFile::FileMode mode,
 /**
  * (Re-)Open the main file.
  *
- * INTERNAL FUNCTION. This does NOT affect gzfd.
+ * INTERNAL FUNCTION. This does NOT affect gzReader.
  * NOTE: This function sets q->m_lastError.
  *
  * Uses parameters stored in this->filename and this->mode.
@@ -261,6 +257,32 @@ int RpFilePrivate::reOpenFile(void)
 	return (!file || file == INVALID_HANDLE_VALUE);
 }
 
+/**
+ * Read compressed data for gzReader.
+ * This does not change the file position.
+ * @param userdata	[in] RpFilePrivate
+ * @param pos		[in] File position
+ * @param ptr		[out] Output buffer
+ * @param size		[in] Amount of data to read
+ * @return Number of bytes read.
+ */
+size_t RpFilePrivate::gzReadAt(void *userdata, off64_t pos, void *ptr, size_t size)
+{
+	RpFilePrivate *const d = static_cast<RpFilePrivate*>(userdata);
+
+	// Use an OVERLAPPED struct to specify the offset.
+	// NOTE: This changes the file pointer, but it isn't
+	// used for gzipped files.
+	OVERLAPPED ov;
+	memset(&ov, 0, sizeof(ov));
+	ov.Offset = static_cast<DWORD>(pos & 0xFFFFFFFFU);
+	ov.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(pos) >> 32);
+
+	DWORD bytesRead;
+	BOOL bRet = ReadFile(d->file, ptr, static_cast<DWORD>(size), &bytesRead, &ov);
+	return (bRet ? bytesRead : 0);
+}
+
 /** RpFile **/
 
 /**
@@ -315,7 +337,8 @@ void RpFile::init(void)
 	// Check if this is a gzipped file.
 	// If it is, use transparent decompression.
 	// Reference: https://www.forensicswiki.org/wiki/Gzip
-	if (!d->devInfo && d->mode == FM_OPEN_READ_GZ) {
+	// NOTE: FM_MMAP is not implemented on Windows.
+	if (!d->devInfo && (d->mode & ~FM_MMAP) == FM_OPEN_READ_GZ) {
 #if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
 		// Delay load verification.
 		// TODO: Only if linked with /DELAYLOAD?
@@ -354,45 +377,27 @@ void RpFile::init(void)
 						// TODO: Add better verification heuristics?
 						d->gzsz = (off64_t)uncomp_sz;
 
-						liSeekPos.QuadPart = 0;
-						SetFilePointerEx(d->file, liSeekPos, nullptr, FILE_BEGIN);
-						// NOTE: Not sure if this is needed on Windows.
-						FlushFileBuffers(d->file);
-
-						// Open the file with gzdopen().
-						HANDLE hGzDup;
-						BOOL bRet = DuplicateHandle(
-							GetCurrentProcess(),	// hSourceProcessHandle
-							d->file,		// hSourceHandle
-							GetCurrentProcess(),	// hTargetProcessHandle
-							&hGzDup,		// lpTargetHandle
-							0,			// dwDesiredAccess
-							FALSE,			// bInheritHandle
-							DUPLICATE_SAME_ACCESS);	// dwOptions
-						if (bRet) {
-							// NOTE: close() on gzfd_dup() will close the
-							// underlying Windows handle.
-							int gzfd_dup = _open_osfhandle((intptr_t)hGzDup, _O_RDONLY);
-							if (gzfd_dup >= 0) {
-								d->gzfd = gzdopen(gzfd_dup, "r");
-								if (d->gzfd) {
-									m_isCompressed = true;
-								} else {
-									// gzdopen() failed.
-									// Close the dup()'d handle to prevent a leak.
-									_close(gzfd_dup);
-								}
-							} else {
-								// Unable to open an fd.
-								CloseHandle(hGzDup);
+						// Use GzIndexedReader for decompression.
+						d->gzReader = new GzIndexedReader(RpFilePrivate::gzReadAt, d);
+						if (d->gzReader->isOpen()) {
+							m_isCompressed = true;
+
+							// Reuse the decompression index if this file was opened recently.
+							time_t mtime;
+							if (!d->filename.empty() && FileSystem::get_mtime(d->filename, &mtime) == 0) {
+								d->gzReader->useIndexCache(d->filename, liFileSize.QuadPart, mtime);
 							}
+						} else {
+							// Unable to initialize zlib.
+							delete d->gzReader;
+							d->gzReader = nullptr;
 						}
 					}
 				}
 			}
 		}
 
-		if (!d->gzfd) {
+		if (!d->gzReader) {
 			// Not a gzipped file.
 			// Rewind and flush the file.
 			LARGE_INTEGER liSeekPos;
@@ -435,10 +440,8 @@ void RpFile::close(void)
 		d->devInfo->close();
 	}
 
-	if (d->gzfd) {
-		gzclose_r(d->gzfd);
-		d->gzfd = nullptr;
-	}
+	delete d->gzReader;
+	d->gzReader = nullptr;
 	if (d->file && d->file != INVALID_HANDLE_VALUE) {
 		CloseHandle(d->file);
 		d->file = INVALID_HANDLE_VALUE;
@@ -468,14 +471,11 @@ size_t RpFile::read(void *ptr, size_t size)
 	}
 
 	DWORD bytesRead;
-	if (d->gzfd) {
-		int iret = gzread(d->gzfd, ptr, (unsigned int)size);
-		if (iret >= 0) {
-			bytesRead = (DWORD)iret;
-		} else {
+	if (d->gzReader) {
+		bytesRead = static_cast<DWORD>(d->gzReader->read(ptr, size));
+		if (d->gzReader->lastError() != 0) {
 			// An error occurred.
-			bytesRead = 0;
-			m_lastError = errno;
+			m_lastError = d->gzReader->lastError();
 		}
 	} else {
 		BOOL bRet = ReadFile(d->file, ptr, static_cast<DWORD>(size), &bytesRead, nullptr);
@@ -489,6 +489,87 @@ size_t RpFile::read(void *ptr, size_t size)
 	return bytesRead;
 }
 
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ *
+ * This is thread-safe for regular files.
+ * Devices and gzipped files use the (non-thread-safe)
+ * default implementation.
+ *
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	RP_D(RpFile);
+	if (!d->file || d->file == INVALID_HANDLE_VALUE) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	} else if (size == 0) {
+		// Nothing to read.
+		return 0;
+	}
+
+	if (d->devInfo || d->gzReader) {
+		// Devices and gzipped files need to use regular reads.
+		return super::readAt(pos, ptr, size);
+	}
+
+	// Use an OVERLAPPED struct to specify the offset.
+	// NOTE: For synchronous handles, ReadFile() updates the file
+	// pointer after reading, so save and restore it. Concurrent
+	// readAt() calls are safe, since they all specify an offset.
+	LARGE_INTEGER liZero, liPos;
+	liZero.QuadPart = 0;
+	BOOL bRet = SetFilePointerEx(d->file, liZero, &liPos, FILE_CURRENT);
+	if (!bRet) {
+		m_lastError = w32err_to_posix(GetLastError());
+		return 0;
+	}
+
+	OVERLAPPED ov;
+	memset(&ov, 0, sizeof(ov));
+	ov.Offset = static_cast<DWORD>(pos & 0xFFFFFFFFU);
+	ov.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(pos) >> 32);
+
+	DWORD bytesRead;
+	bRet = ReadFile(d->file, ptr, static_cast<DWORD>(size), &bytesRead, &ov);
+	if (!bRet) {
+		const DWORD dwError = GetLastError();
+		if (dwError != ERROR_HANDLE_EOF) {
+			// An error occurred.
+			m_lastError = w32err_to_posix(dwError);
+		}
+		bytesRead = 0;
+	}
+
+	SetFilePointerEx(d->file, liPos, nullptr, FILE_BEGIN);
+	return bytesRead;
+}
+
+/**
+ * Get a pointer to file data without copying it.
+ * This is only supported if the file is memory-mapped. (FM_MMAP)
+ * The pointer is valid until the file is made writable or closed.
+ * The file position is not changed.
+ * @param pos	[in] File position.
+ * @param size	[in] Amount of data, in bytes.
+ * @return Pointer to the data, or nullptr if not supported or out of range.
+ */
+const uint8_t *RpFile::peek(off64_t pos, size_t size)
+{
+	// TODO: Implement FM_MMAP on Windows using MapViewOfFile().
+	RP_UNUSED(pos);
+	RP_UNUSED(size);
+	return nullptr;
+}
+
 /**
  * Write data to the file.
  * @param ptr Input data buffer.
@@ -550,17 +631,10 @@ int RpFile::seek(off64_t pos)
 	}
 
 	int ret;
-	if (d->gzfd) {
-		// FIXME: Might not work with >2GB files...
-		z_off_t zret = gzseek(d->gzfd, (long)pos, SEEK_SET);
-		if (zret >= 0) {
-			ret = 0;
-		} else {
-			ret = -1;
-			m_lastError = -errno;
-			if (m_lastError == 0) {
-				m_lastError = -EIO;
-			}
+	if (d->gzReader) {
+		ret = d->gzReader->seek(pos);
+		if (ret != 0) {
+			m_lastError = d->gzReader->lastError();
 		}
 	} else {
 		LARGE_INTEGER liSeekPos;
@@ -596,8 +670,8 @@ off64_t RpFile::tell(void)
 		return d->devInfo->device_pos;
 	}
 
-	if (d->gzfd) {
-		return (off64_t)gztell(d->gzfd);
+	if (d->gzReader) {
+		return d->gzReader->tell();
 	}
 
 	LARGE_INTEGER liSeekPos, liSeekRet;
@@ -687,6 +761,32 @@ int RpFile::flush(void)
 	return 0;
 }
 
+/**
+ * Advise the OS of the expected access pattern.
+ * This is only a hint; it does not affect the data read.
+ * @param pattern	[in] Access pattern.
+ * @param offset	[in] Starting offset.
+ * @param len		[in] Length, or 0 for the rest of the file.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpFile::adviseAccess(AccessPattern pattern, off64_t offset, off64_t len)
+{
+	RP_D(RpFile);
+	if (!d->file || d->file == INVALID_HANDLE_VALUE) {
+		m_lastError = EBADF;
+		return -EBADF;
+	} else if (offset < 0 || len < 0) {
+		return -EINVAL;
+	}
+
+	// TODO: FILE_FLAG_SEQUENTIAL_SCAN and FILE_FLAG_RANDOM_ACCESS
+	// can only be set when opening the file, and ReOpenFile()
+	// requires Windows Vista. PrefetchVirtualMemory() requires
+	// Windows 8 and a memory-mapped file.
+	RP_UNUSED(pattern);
+	return -ENOTSUP;
+}
+
 /** File properties **/
 
 /**
@@ -706,7 +806,7 @@ off64_t RpFile::size(void)
 	if (d->devInfo) {
 		// Block device. Use the cached device size.
 		return d->devInfo->device_size;
-	} else if (d->gzfd) {
+	} else if (d->gzReader) {
 		// gzipped files have the uncompressed size stored
 		// at the end of the stream.
 		return d->gzsz;
@@ -67,6 +67,17 @@ typedef struct _rp_secure_param_t {
 #endif
 } rp_secure_param_t;
 
+/**
+ * Security profile flags for rp_secure_enable_ex().
+ */
+typedef enum {
+	// Parallel profile: Allow the syscalls needed by worker threads
+	// (LibRpThreads::ThreadPool), memory-mapped files (RpFile FM_MMAP),
+	// readahead hints (RpFile::adviseAccess()), and asynchronous I/O
+	// (LibRpFile::IoUring). clone() is restricted to creating threads.
+	RP_SECURE_PROFILE_PARALLEL	= (1U << 0),
+} rp_secure_profile_t;
+
 /**
  * Enable OS-specific security functionality.
  * @param param OS-specific parameter.
@@ -82,6 +93,28 @@ static inline int rp_secure_enable(rp_secure_param_t param)
 }
 #endif /* ENABLE_EXTRA_SECURITY */
 
+/**
+ * Enable OS-specific security functionality with additional profiles.
+ *
+ * The profiles add syscalls to the OS-specific parameter.
+ * On systems other than Linux, the profiles are already covered
+ * by the OS-specific parameter, e.g. pledge("stdio") allows
+ * creating threads, so this is the same as rp_secure_enable().
+ *
+ * @param param OS-specific parameter.
+ * @param profiles Security profile flags. (See rp_secure_profile_t.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+#if defined(ENABLE_EXTRA_SECURITY) && defined(HAVE_SECCOMP)
+int rp_secure_enable_ex(rp_secure_param_t param, unsigned int profiles);
+#else /* !ENABLE_EXTRA_SECURITY || !HAVE_SECCOMP */
+static inline int rp_secure_enable_ex(rp_secure_param_t param, unsigned int profiles)
+{
+	((void)profiles);
+	return rp_secure_enable(param);
+}
+#endif /* ENABLE_EXTRA_SECURITY && HAVE_SECCOMP */
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,12 +29,37 @@
 #  define SCMP_ACTION SCMP_ACT_KILL
 #endif /* ENABLE_SECCOMP_DEBUG */
 
+/**
+ * Add the clone() syscall to a seccomp filter.
+ * Only threads can be created; fork() isn't allowed.
+ * @param ctx seccomp filter
+ */
+static void add_clone_threads_only(scmp_filter_ctx ctx)
+{
+	const struct scmp_arg_cmp clone_params[] = {
+		SCMP_A0(SCMP_CMP_MASKED_EQ, CLONE_THREAD, CLONE_THREAD),
+	};
+	seccomp_rule_add_array(ctx, SCMP_ACT_ALLOW, SCMP_SYS(clone),
+		(unsigned int)(sizeof(clone_params)/sizeof(clone_params[0])), clone_params);
+}
+
 /**
  * Enable OS-specific security functionality.
  * @param param OS-specific parameter.
  * @return 0 on success; negative POSIX error code on error.
  */
 int rp_secure_enable(rp_secure_param_t param)
+{
+	return rp_secure_enable_ex(param, 0);
+}
+
+/**
+ * Enable OS-specific security functionality with additional profiles.
+ * @param param OS-specific parameter.
+ * @param profiles Security profile flags. (See rp_secure_profile_t.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rp_secure_enable_ex(rp_secure_param_t param, unsigned int profiles)
 {
 	assert(param.syscall_wl != NULL);
 	if (!param.syscall_wl) {
@@ -96,15 +121,64 @@ int rp_secure_enable(rp_secure_param_t param)
 		seccomp_rule_add_array(ctx, SCMP_ACT_ALLOW, *p, 0, NULL);
 	}
 
+	if (profiles & RP_SECURE_PROFILE_PARALLEL) {
+		static const int syscall_wl_parallel[] = {
+			// Worker threads (LibRpThreads::ThreadPool)
+			// NOTE: clone() is added separately.
+			SCMP_SYS(futex),		// pthread_join(), Mutex, Semaphore
+#if defined(__SNR_futex_time64) || defined(__NR_futex_time64)
+			SCMP_SYS(futex_time64),		// 32-bit with 64-bit time_t
+#endif /* __SNR_futex_time64 || __NR_futex_time64 */
+			SCMP_SYS(set_robust_list),	// start_thread()
+#if defined(__SNR_rseq)
+			SCMP_SYS(rseq),			// start_thread() [glibc-2.35]
+#elif defined(__NR_rseq)
+			__NR_rseq,			// start_thread() [glibc-2.35]
+#endif /* __SNR_rseq || __NR_rseq */
+			SCMP_SYS(rt_sigaction),		// pthread_create() [SIGCANCEL/SIGSETXID]
+			SCMP_SYS(rt_sigprocmask),	// pthread_create() [blocks signals during setup]
+			SCMP_SYS(sched_getaffinity),	// sysconf(_SC_NPROCESSORS_ONLN) [Thread::cpuCount()]
+			SCMP_SYS(sched_yield),
+			SCMP_SYS(gettid),
+			SCMP_SYS(mprotect),		// pthread_create() [stack guard page]
+
+			// Memory-mapped files and thread stacks
+			SCMP_SYS(mmap), SCMP_SYS(mmap2),
+			SCMP_SYS(munmap),
+			SCMP_SYS(madvise),		// RpFile::adviseAccess() [FM_MMAP]; thread stack release
+
+			// Readahead hints
+			SCMP_SYS(fadvise64), SCMP_SYS(fadvise64_64),	// RpFile::adviseAccess()
+			SCMP_SYS(pread64), SCMP_SYS(preadv),		// RpFile::readAt(), readBatch()
+
+			// Asynchronous I/O
+#if defined(__SNR_io_uring_setup) || defined(__NR_io_uring_setup)
+			SCMP_SYS(io_uring_setup), SCMP_SYS(io_uring_enter),	// LibRpFile::IoUring
+#endif /* __SNR_io_uring_setup || __NR_io_uring_setup */
+
+			-1	// End of whitelist
+		};
+
+		add_clone_threads_only(ctx);
+#if defined(__SNR_clone3) || defined(__NR_clone3)
+		// clone3() takes its flags in a struct, so they can't be
+		// checked by seccomp. Return ENOSYS so glibc falls back
+		// to clone(), which only allows threads.
+		seccomp_rule_add_array(ctx, SCMP_ACT_ERRNO(ENOSYS), SCMP_SYS(clone3), 0, NULL);
+#endif /* __SNR_clone3 || __NR_clone3 */
+
+		for (p = syscall_wl_parallel; *p != -1; p++) {
+			seccomp_rule_add_array(ctx, SCMP_ACT_ALLOW, *p, 0, NULL);
+		}
+	}
+
 	// NOTE: If clone() is wanted, it should be the first syscall in the list.
 	p = param.syscall_wl;
 	if (*p == SCMP_SYS(clone)) {
 		// clone() syscall. Only allow threads.
-		const struct scmp_arg_cmp clone_params[] = {
-			SCMP_A0(SCMP_CMP_MASKED_EQ, CLONE_THREAD, CLONE_THREAD),
-		};
-		seccomp_rule_add_array(ctx, SCMP_ACT_ALLOW, SCMP_SYS(clone),
-			(unsigned int)(sizeof(clone_params)/sizeof(clone_params[0])), clone_params);
+		if (!(profiles & RP_SECURE_PROFILE_PARALLEL)) {
+			add_clone_threads_only(ctx);
+		}
 
 		// Skip clone() in the loop.
 		p++;
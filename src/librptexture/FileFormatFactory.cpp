@@ -14,6 +14,7 @@
 
 // librpbase, librpfile
 #include "librpfile/FileSystem.hpp"
+#include "librpfile/SubFile.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
 
@@ -90,6 +91,29 @@ class FileFormatFactoryPrivate
 		// FileFormat subclasses that have special checks.
 		// This array is for file extensions and MIME types only.
 		static const FileFormatFns FileFormatFns_mime[];
+
+		// File header used for the magic number checks.
+		union magic_t {
+			uint8_t u8[32];
+			uint32_t u32[32/4];
+		};
+
+		/**
+		 * Check if a file header might be a TGA file.
+		 * Based on heuristics from `file`.
+		 * NOTE: The file extension must be checked by the caller
+		 * due to conflicts with "WWF Raw" on SNES.
+		 * @param magic File header.
+		 * @return True if this might be a TGA file; false if not.
+		 */
+		static bool isTgaHeader(const magic_t &magic);
+
+		/**
+		 * Find a FileFormatFns_magic[] entry for a 32-bit magic number.
+		 * @param magic32 Magic number at address 0, in host-endian.
+		 * @return FileFormatFns_magic[] entry, or nullptr if not found.
+		 */
+		static const FileFormatFns *findMagic(uint32_t magic32);
 };
 
 /** FileFormatFactoryPrivate **/
@@ -126,6 +150,70 @@ const FileFormatFactoryPrivate::FileFormatFns FileFormatFactoryPrivate::FileForm
 	{nullptr, nullptr, nullptr, 0}
 };
 
+/**
+ * Check if a file header might be a TGA file.
+ * Based on heuristics from `file`.
+ * NOTE: The file extension must be checked by the caller
+ * due to conflicts with "WWF Raw" on SNES.
+ * @param magic File header.
+ * @return True if this might be a TGA file; false if not.
+ */
+bool FileFormatFactoryPrivate::isTgaHeader(const magic_t &magic)
+{
+	// test of Color Map Type 0~no 1~color map
+	// and Image Type 1 2 3 9 10 11 32 33
+	// and Color Map Entry Size 0 15 16 24 32
+	if (((magic.u32[0] & be32_to_cpu(0x00FEC400)) != 0) ||
+	    ((magic.u32[1] & be32_to_cpu(0x000000C0)) != 0))
+	{
+		return false;
+	}
+
+	const TGA_Header *const tgaHeader = reinterpret_cast<const TGA_Header*>(&magic);
+
+	// skip some MPEG sequence *.vob and some CRI ADX audio with improbable interleave bits
+	if ((tgaHeader->img.attr_dir & 0xC0) == 0xC0 ||
+	// skip more garbage like *.iso by looking for positive image type
+	     tgaHeader->image_type == 0 ||
+	// skip some compiled terminfo like xterm+tmux by looking for image type less equal 33
+	     tgaHeader->image_type >= 34 ||
+	// skip some MPEG sequence *.vob HV001T01.EVO winnicki.mpg with unacceptable alpha channel depth 11
+	    (tgaHeader->img.attr_dir & 0x0F) == 11)
+	{
+		return false;
+	}
+
+	// skip arches.3200 , Finder.Root , Slp.1 by looking for low pixel depth 1 8 15 16 24 32
+	switch (tgaHeader->img.bpp) {
+		case 1:  case 8:
+		case 15: case 16:
+		case 24: case 32:
+			// Valid color depth.
+			// This might be TGA.
+			return true;
+
+		default:
+			break;
+	}
+	return false;
+}
+
+/**
+ * Find a FileFormatFns_magic[] entry for a 32-bit magic number.
+ * @param magic32 Magic number at address 0, in host-endian.
+ * @return FileFormatFns_magic[] entry, or nullptr if not found.
+ */
+const FileFormatFactoryPrivate::FileFormatFns *FileFormatFactoryPrivate::findMagic(uint32_t magic32)
+{
+	const FileFormatFns *fns = &FileFormatFns_magic[0];
+	for (; fns->supportedFileExtensions != nullptr; fns++) {
+		if (magic32 == fns->magic) {
+			return fns;
+		}
+	}
+	return nullptr;
+}
+
 /** FileFormatFactory **/
 
 /**
@@ -153,16 +241,20 @@ FileFormat *FileFormatFactory::create(IRpFile *file)
 	}
 
 	// Read the file's magic number.
-	union {
-		uint8_t u8[32];
-		uint32_t u32[32/4];
-	} magic;
-	file->rewind();
-	size_t size = file->read(&magic, sizeof(magic));
-	if (size != sizeof(magic)) {
-		// Read error.
-		return nullptr;
+	// If the file is memory-mapped, use the data in place.
+	typedef FileFormatFactoryPrivate::magic_t magic_t;
+	magic_t magic_buf;
+	const magic_t *pMagic = reinterpret_cast<const magic_t*>(file->peek(0, sizeof(magic_buf)));
+	if (!pMagic) {
+		file->rewind();
+		size_t size = file->read(&magic_buf, sizeof(magic_buf));
+		if (size != sizeof(magic_buf)) {
+			// Read error.
+			return nullptr;
+		}
+		pMagic = &magic_buf;
 	}
+	const magic_t &magic = *pMagic;
 
 	// Special check for Khronos KTX, which has the same
 	// 32-bit magic number for two completely different versions.
@@ -211,75 +303,125 @@ FileFormat *FileFormatFactory::create(IRpFile *file)
 		}
 	}
 
-	// test of Color Map Type 0~no 1~color map
-	// and Image Type 1 2 3 9 10 11 32 33
-	// and Color Map Entry Size 0 15 16 24 32
-	if (ext_ok &&
-	    ((magic.u32[0] & be32_to_cpu(0x00FEC400)) == 0) &&
-	    ((magic.u32[1] & be32_to_cpu(0x000000C0)) == 0))
-	{
-		const TGA_Header *const tgaHeader = reinterpret_cast<const TGA_Header*>(&magic);
-
-		// skip some MPEG sequence *.vob and some CRI ADX audio with improbable interleave bits
-		if ((tgaHeader->img.attr_dir & 0xC0) != 0xC0 &&
-		// skip more garbage like *.iso by looking for positive image type
-		     tgaHeader->image_type > 0 &&
-		// skip some compiled terminfo like xterm+tmux by looking for image type less equal 33
-		     tgaHeader->image_type < 34 &&
-		// skip some MPEG sequence *.vob HV001T01.EVO winnicki.mpg with unacceptable alpha channel depth 11
-		    (tgaHeader->img.attr_dir & 0x0F) != 11)
-		{
-			// skip arches.3200 , Finder.Root , Slp.1 by looking for low pixel depth 1 8 15 16 24 32
-			switch (tgaHeader->img.bpp) {
-				case 1:  case 8:
-				case 15: case 16:
-				case 24: case 32: {
-					// Valid color depth.
-					// This might be TGA.
-					FileFormat *const fileFormat = new TGA(file);
-					if (fileFormat->isValid()) {
-						// FileFormat subclass obtained.
-						return fileFormat;
-					}
-				}
-
-				default:
-					break;
-			}
+	if (ext_ok && FileFormatFactoryPrivate::isTgaHeader(magic)) {
+		// This might be TGA.
+		FileFormat *const fileFormat = new TGA(file);
+		if (fileFormat->isValid()) {
+			// FileFormat subclass obtained.
+			return fileFormat;
 		}
-	}
 
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
-	// Magic number needs to be in host-endian.
-	magic.u32[0] = be32_to_cpu(magic.u32[0]);
-#endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
+		// Not actually supported.
+		fileFormat->unref();
+	}
 
 	// Check FileFormat subclasses that take a header at 0
 	// and definitely have a 32-bit magic number at address 0.
-	const FileFormatFactoryPrivate::FileFormatFns *fns =
-		&FileFormatFactoryPrivate::FileFormatFns_magic[0];
-	for (; fns->supportedFileExtensions != nullptr; fns++) {
-		// Check the magic number.
-		if (magic.u32[0] == fns->magic) {
-			// Found a matching magic number.
-			// TODO: Implement fns->isTextureSupported.
-			/*if (fns->isTextureSupported(&info) >= 0)*/ {
-				FileFormat *const fileFormat = fns->newFileFormat(file);
-				if (fileFormat->isValid()) {
-					// FileFormat subclass obtained.
-					return fileFormat;
-				}
-
-				// Not actually supported.
-				fileFormat->unref();
-			}
+	// NOTE: Magic number needs to be in host-endian.
+	const FileFormatFactoryPrivate::FileFormatFns *const fns =
+		FileFormatFactoryPrivate::findMagic(be32_to_cpu(magic.u32[0]));
+	if (fns) {
+		// Found a matching magic number.
+		// TODO: Implement fns->isTextureSupported.
+		FileFormat *const fileFormat = fns->newFileFormat(file);
+		if (fileFormat->isValid()) {
+			// FileFormat subclass obtained.
+			return fileFormat;
 		}
+
+		// Not actually supported.
+		fileFormat->unref();
 	}
 
 	// Not supported.
 	return nullptr;
 }
 
+/**
+ * Check if a texture file might be supported, based on its header.
+ *
+ * Only the magic number and header heuristics are checked,
+ * so a FileFormat subclass isn't constructed. create() may
+ * still fail if the texture file is invalid.
+ *
+ * @param pHeader	[in] Header at the start of the file. (must be 32-bit aligned)
+ * @param size		[in] Size of pHeader.
+ * @param ext		[in,opt] File extension, including the leading dot.
+ * @return True if the texture file might be supported; false if not.
+ */
+bool FileFormatFactory::isTextureSupported(const uint8_t *pHeader, size_t size, const char *ext)
+{
+	typedef FileFormatFactoryPrivate::magic_t magic_t;
+	assert(pHeader != nullptr);
+	assert((reinterpret_cast<uintptr_t>(pHeader) & 3) == 0);
+	if (!pHeader || size < sizeof(magic_t)) {
+		// create() needs a full 32-byte header.
+		return false;
+	}
+	const magic_t &magic = *reinterpret_cast<const magic_t*>(pHeader);
+
+	// Khronos KTX: Check the version, too.
+	if (magic.u32[0] == cpu_to_be32('\xABKTX')) {
+		if (magic.u32[1] == cpu_to_be32(' 11\xBB') ||
+		    magic.u32[1] == cpu_to_be32(' 20\xBB'))
+		{
+			return true;
+		}
+	}
+
+	// TGA: Same extension check as create().
+	// NOTE: The extension before ".gz" isn't available here,
+	// so ".gz" is allowed in order to handle ".tga.gz".
+	const bool ext_ok = (!ext || ext[0] == '\0' ||
+		!strcasecmp(ext, ".tga") || !strcasecmp(ext, ".gz"));
+	if (ext_ok && FileFormatFactoryPrivate::isTgaHeader(magic)) {
+		return true;
+	}
+
+	// Check FileFormat subclasses that take a header at 0
+	// and definitely have a 32-bit magic number at address 0.
+	return (FileFormatFactoryPrivate::findMagic(be32_to_cpu(magic.u32[0])) != nullptr);
+}
+
+/**
+ * Create a FileFormat subclass for a texture embedded in another file.
+ *
+ * The texture is read in place using a SubFile view,
+ * so the texture data doesn't need to be copied.
+ *
+ * @param file	[in] File containing the texture.
+ * @param offset	[in] Starting offset of the texture.
+ * @param length	[in] Length of the texture.
+ * @return FileFormat subclass, or nullptr if the texture isn't supported.
+ */
+FileFormat *FileFormatFactory::create(IRpFile *file, off64_t offset, off64_t length)
+{
+	assert(file != nullptr);
+	assert(offset >= 0);
+	assert(length > 0);
+	if (!file || offset < 0 || length <= 0) {
+		return nullptr;
+	}
+
+	// Make sure the texture is in bounds.
+	const off64_t fileSize = file->size();
+	if (offset >= fileSize || length > fileSize - offset) {
+		// Out of bounds.
+		return nullptr;
+	}
+
+	// NOTE: The FileFormat object takes its own reference
+	// to the SubFile, so we can unref() it here.
+	SubFile *const subFile = new SubFile(file, offset, length);
+	if (!subFile->isOpen()) {
+		subFile->unref();
+		return nullptr;
+	}
+	FileFormat *const fileFormat = create(subFile);
+	subFile->unref();
+	return fileFormat;
+}
+
 /**
  * Get all supported file extensions.
  * Used for Win32 COM registration.
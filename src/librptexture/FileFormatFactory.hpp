@@ -47,6 +47,33 @@ class FileFormatFactory
 		 */
 		static LibRpTexture::FileFormat *create(LibRpFile::IRpFile *file);
 
+		/**
+		 * Create a FileFormat subclass for a texture embedded in another file.
+		 *
+		 * The texture is read in place using a SubFile view,
+		 * so the texture data doesn't need to be copied.
+		 *
+		 * @param file	[in] File containing the texture.
+		 * @param offset	[in] Starting offset of the texture.
+		 * @param length	[in] Length of the texture.
+		 * @return FileFormat subclass, or nullptr if the texture isn't supported.
+		 */
+		static LibRpTexture::FileFormat *create(LibRpFile::IRpFile *file, off64_t offset, off64_t length);
+
+		/**
+		 * Check if a texture file might be supported, based on its header.
+		 *
+		 * Only the magic number and header heuristics are checked,
+		 * so a FileFormat subclass isn't constructed. create() may
+		 * still fail if the texture file is invalid.
+		 *
+		 * @param pHeader	[in] Header at the start of the file. (must be 32-bit aligned)
+		 * @param size		[in] Size of pHeader.
+		 * @param ext		[in,opt] File extension, including the leading dot.
+		 * @return True if the texture file might be supported; false if not.
+		 */
+		static bool isTextureSupported(const uint8_t *pHeader, size_t size, const char *ext);
+
 		/**
 		 * Get all supported file extensions.
 		 * Used for Win32 COM registration.
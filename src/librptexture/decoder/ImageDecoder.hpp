@@ -24,11 +24,24 @@
 # include "librpcpu/cpuflags_x86.h"
 # define IMAGEDECODER_HAS_SSE2 1
 # define IMAGEDECODER_HAS_SSSE3 1
+# define IMAGEDECODER_HAS_SSE41 1
+# define IMAGEDECODER_HAS_AVX2 1
 #endif
 #ifdef RP_CPU_AMD64
 # define IMAGEDECODER_ALWAYS_HAS_SSE2 1
 #endif
+#if defined(RP_CPU_ARM64) || \
+    (defined(RP_CPU_ARM) && (defined(__ARM_NEON) || defined(__ARM_NEON__)))
+// NEON is always available on ARM64. On 32-bit ARM,
+// only use it if it's part of the compiler's baseline.
+# include "librpcpu/cpuflags_arm.h"
+# define IMAGEDECODER_HAS_NEON 1
+# define IMAGEDECODER_ALWAYS_HAS_NEON 1
+#endif
 
+namespace LibRpFile {
+	class IRpFile;
+}
 namespace LibRpTexture {
 	class rp_image;
 }
@@ -137,6 +150,15 @@ enum class PixelFormat : uint8_t {
 #endif
 };
 
+/**
+ * Set the maximum number of threads used to decode large
+ * block-compressed images. (BC7, ETC1/ETC2, S3TC)
+ * Small images are always decoded on the calling thread.
+ * Decoding uses the process-wide LibRpThreads::ThreadPool.
+ * @param threads Maximum number of threads (0 for the thread pool size; 1 to disable multithreading)
+ */
+void setMaxThreads(unsigned int threads);
+
 /**
  * Convert a linear CI4 image to rp_image with a little-endian 16-bit palette.
  * @param px_format Palette pixel format.
@@ -236,31 +258,42 @@ rp_image *fromLinear16_sse2(PixelFormat px_format,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSE2 */
 
-#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
-
-#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
-// System does support IFUNC, but it's always guaranteed to have SSE2.
-// Eliminate the IFUNC dispatch on this system.
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a linear 16-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 16-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear16_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
 
+#ifdef IMAGEDECODER_HAS_NEON
 /**
  * Convert a linear 16-bit RGB image to rp_image.
+ * NEON-optimized version.
  * @param px_format	[in] 16-bit pixel format.
  * @param width		[in] Image width.
  * @param height	[in] Image height.
- * @param img_buf	[in] Image buffer.
- * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
  * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
  * @return rp_image, or nullptr on error.
  */
-static inline rp_image *fromLinear16(PixelFormat px_format,
+rp_image *fromLinear16_neon(PixelFormat px_format,
 	int width, int height,
-	const uint16_t *img_buf, int img_siz, int stride = 0)
-{
-	// amd64 always has SSE2.
-	return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
-}
-#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
-// System supports IFUNC and is not guaranteed to always have SSE2.
+	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_NEON */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+// NOTE: IFUNC is used on amd64 as well, since AVX2 isn't guaranteed.
 
 /**
  * Convert a linear 16-bit RGB image to rp_image.
@@ -272,10 +305,9 @@ static inline rp_image *fromLinear16(PixelFormat px_format,
  * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
  * @return rp_image, or nullptr on error.
  */
-IFUNC_SSE2_STATIC_INLINE rp_image *fromLinear16(PixelFormat px_format,
+IFUNC_STATIC_INLINE rp_image *fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0);
-#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
 
 #else /* !RP_HAS_IFUNC or not i386/amd64 */
 // System does not support IFUNC, or we aren't guaranteed to have
@@ -295,19 +327,31 @@ static inline rp_image *fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz, int stride = 0)
 {
-#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
-	// amd64 always has SSE2.
-	return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
-#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
-#    ifdef IMAGEDECODER_HAS_SSE2
+#  if defined(IMAGEDECODER_ALWAYS_HAS_NEON)
+	// ARM64 always has NEON.
+	return fromLinear16_neon(px_format, width, height, img_buf, img_siz, stride);
+#  else /* !IMAGEDECODER_ALWAYS_HAS_NEON */
+#    ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear16_avx2(px_format, width, height, img_buf, img_siz, stride);
+	} else
+#    endif /* IMAGEDECODER_HAS_AVX2 */
+#    if defined(IMAGEDECODER_ALWAYS_HAS_SSE2)
+	{
+		// amd64 always has SSE2.
+		return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
+	}
+#    else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#      ifdef IMAGEDECODER_HAS_SSE2
 	if (RP_CPU_HasSSE2()) {
 		return fromLinear16_sse2(px_format, width, height, img_buf, img_siz, stride);
 	} else
-#    endif /* IMAGEDECODER_HAS_SSE2 */
+#      endif /* IMAGEDECODER_HAS_SSE2 */
 	{
 		return fromLinear16_cpp(px_format, width, height, img_buf, img_siz, stride);
 	}
-#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#    endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#  endif /* IMAGEDECODER_ALWAYS_HAS_NEON */
 }
 
 #endif /* RP_HAS_IFUNC */
@@ -427,6 +471,40 @@ rp_image *fromLinear32_ssse3(PixelFormat px_format,
 	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0);
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Convert a linear 32-bit RGB image to rp_image.
+ * AVX2-optimized version.
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 32-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear32_avx2(PixelFormat px_format,
+	int width, int height,
+	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
+#ifdef IMAGEDECODER_HAS_NEON
+/**
+ * Convert a linear 32-bit RGB image to rp_image.
+ * NEON-optimized version.
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 32-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear32_neon(PixelFormat px_format,
+	int width, int height,
+	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0);
+#endif /* IMAGEDECODER_HAS_NEON */
+
 #if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a linear 32-bit RGB image to rp_image.
@@ -459,19 +537,60 @@ static inline rp_image *fromLinear32(PixelFormat px_format,
 	int width, int height,
 	const uint32_t *RESTRICT img_buf, int img_siz, int stride = 0)
 {
-#  ifdef IMAGEDECODER_HAS_SSSE3
+#  ifdef IMAGEDECODER_ALWAYS_HAS_NEON
+	// ARM64 always has NEON.
+	return fromLinear32_neon(px_format, width, height, img_buf, img_siz, stride);
+#  else /* !IMAGEDECODER_ALWAYS_HAS_NEON */
+#    ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return fromLinear32_avx2(px_format, width, height, img_buf, img_siz, stride);
+	} else
+#    endif /* IMAGEDECODER_HAS_AVX2 */
+#    ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return fromLinear32_ssse3(px_format, width, height, img_buf, img_siz, stride);
 	} else
-#  endif /* IMAGEDECODER_HAS_SSSE3 */
+#    endif /* IMAGEDECODER_HAS_SSSE3 */
 	{
 		return fromLinear32_cpp(px_format, width, height, img_buf, img_siz, stride);
 	}
+#  endif /* IMAGEDECODER_ALWAYS_HAS_NEON */
 }
 #endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
 
 /** GameCube **/
 
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * Standard version using regular C++ code.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_cpp(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * SSSE3-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_ssse3(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
  * Convert a GameCube 16-bit image to rp_image.
  * @param px_format 16-bit pixel format.
@@ -481,9 +600,36 @@ static inline rp_image *fromLinear32(PixelFormat px_format,
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromGcn16(PixelFormat px_format,
+IFUNC_STATIC_INLINE rp_image *fromGcn16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+static inline rp_image *fromGcn16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromGcn16_ssse3(px_format, width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromGcn16_cpp(px_format, width, height, img_buf, img_siz);
+	}
+}
+#endif /* !RP_HAS_IFUNC || (!RP_CPU_I386 && !RP_CPU_AMD64) */
 
 /**
  * Convert a GameCube CI8 image to rp_image.
@@ -533,17 +679,19 @@ rp_image *fromNDS_CI4(int width, int height,
 
 /**
  * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf RGB565 tiled image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromN3DSTiledRGB565(int width, int height,
+rp_image *fromN3DSTiledRGB565_cpp(int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz);
 
 /**
  * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf RGB565 tiled image buffer.
@@ -553,329 +701,1378 @@ rp_image *fromN3DSTiledRGB565(int width, int height,
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 5, 6)
-rp_image *fromN3DSTiledRGB565_A4(int width, int height,
+rp_image *fromN3DSTiledRGB565_A4_cpp(int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz,
 	const uint8_t *RESTRICT alpha_buf, int alpha_siz);
 
-/* S3TC */
-
+#ifdef IMAGEDECODER_HAS_SSE2
 /**
- * Convert a GameCube DXT1 image to rp_image.
- * The GameCube variant has 2x2 block tiling in addition to 4x4 pixel tiling.
- * S3TC palette index 3 will be interpreted as fully transparent.
- *
+ * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
+ * SSE2-optimized version.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf DXT1 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT1_GCN(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
+rp_image *fromN3DSTiledRGB565_sse2(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
 
 /**
- * Convert a DXT1 image to rp_image.
- * S3TC palette index 3 will be interpreted as black.
- *
+ * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
+ * SSE2-optimized version.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf DXT1 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param alpha_buf A4 tiled alpha buffer.
+ * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT1(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
+ATTR_ACCESS_SIZE(read_only, 5, 6)
+rp_image *fromN3DSTiledRGB565_A4_sse2(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+// System does support IFUNC, but it's always guaranteed to have SSE2.
+// Eliminate the IFUNC dispatch on this system.
 
 /**
- * Convert a DXT1 image to rp_image.
- * S3TC palette index 3 will be interpreted as fully transparent.
- *
+ * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf DXT1 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT1_A1(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
+static inline rp_image *fromN3DSTiledRGB565(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// amd64 always has SSE2.
+	return fromN3DSTiledRGB565_sse2(width, height, img_buf, img_siz);
+}
 
 /**
- * Convert a DXT2 image to rp_image.
+ * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf DXT2 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param alpha_buf A4 tiled alpha buffer.
+ * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT2(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
+ATTR_ACCESS_SIZE(read_only, 5, 6)
+static inline rp_image *fromN3DSTiledRGB565_A4(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz)
+{
+	// amd64 always has SSE2.
+	return fromN3DSTiledRGB565_A4_sse2(width, height, img_buf, img_siz, alpha_buf, alpha_siz);
+}
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+// System supports IFUNC and is not guaranteed to always have SSE2.
 
 /**
- * Convert a DXT3 image to rp_image.
+ * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf DXT3 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT3(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
+IFUNC_SSE2_STATIC_INLINE rp_image *fromN3DSTiledRGB565(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
 
 /**
- * Convert a DXT4 image to rp_image.
+ * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf DXT4 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param alpha_buf A4 tiled alpha buffer.
+ * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT4(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
+ATTR_ACCESS_SIZE(read_only, 5, 6)
+IFUNC_SSE2_STATIC_INLINE rp_image *fromN3DSTiledRGB565_A4(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz);
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
+#else /* !RP_HAS_IFUNC or not i386/amd64 */
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
 
 /**
- * Convert a DXT5 image to rp_image.
+ * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf DXT5 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromDXT5(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
+static inline rp_image *fromN3DSTiledRGB565(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	// amd64 always has SSE2.
+	return fromN3DSTiledRGB565_sse2(width, height, img_buf, img_siz);
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#    ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return fromN3DSTiledRGB565_sse2(width, height, img_buf, img_siz);
+	} else
+#    endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return fromN3DSTiledRGB565_cpp(width, height, img_buf, img_siz);
+	}
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
 
 /**
- * Convert a BC4 (ATI1) image to rp_image.
- * Color component is Red.
- *
+ * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf BC4 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
- * @return rp_image, or nullptr on error.
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param alpha_buf A4 tiled alpha buffer.
+ * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromBC4(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
+ATTR_ACCESS_SIZE(read_only, 5, 6)
+static inline rp_image *fromN3DSTiledRGB565_A4(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz)
+{
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	// amd64 always has SSE2.
+	return fromN3DSTiledRGB565_A4_sse2(width, height, img_buf, img_siz, alpha_buf, alpha_siz);
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#    ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return fromN3DSTiledRGB565_A4_sse2(width, height, img_buf, img_siz, alpha_buf, alpha_siz);
+	} else
+#    endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return fromN3DSTiledRGB565_A4_cpp(width, height, img_buf, img_siz, alpha_buf, alpha_siz);
+	}
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
+
+/* S3TC */
 
 /**
- * Convert a BC5 (ATI2) image to rp_image.
- * Color components are Red and Green.
+ * Convert a GameCube DXT1 image to rp_image.
+ * The GameCube variant has 2x2 block tiling in addition to 4x4 pixel tiling.
+ * S3TC palette index 3 will be interpreted as fully transparent.
  *
  * @param width Image width.
  * @param height Image height.
- * @param img_buf BC4 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromBC5(int width, int height,
+rp_image *fromDXT1_GCN(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
- * Convert a Red image to Luminance.
- * Use with fromBC4() to decode an LATC1 texture.
- * @param img rp_image to convert in-place.
- * @return 0 on success; negative POSIX error code on error.
- */
-int fromRed8ToL8(rp_image *img);
-
-/**
- * Convert a Red+Green image to Luminance+Alpha.
- * Use with fromBC5() to decode an LATC2 texture.
- * @param img rp_image to convert in-place.
- * @return 0 on success; negative POSIX error code on error.
- */
- int fromRG8ToLA8(rp_image *img);
-
-/* Dreamcast */
-
-/**
- * Convert a Dreamcast square twiddled 16-bit image to rp_image.
- * @param px_format 16-bit pixel format.
- * @param width Image width. (Maximum is 4096.)
- * @param height Image height. (Must be equal to width.)
- * @param img_buf 16-bit image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * Convert a DXT1 image to rp_image.
+ * Standard version using regular C++ code.
+ * S3TC palette index 3 will be interpreted as black.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
-	int width, int height,
-	const uint16_t *RESTRICT img_buf, int img_siz);
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
 
+#ifdef IMAGEDECODER_HAS_SSSE3
 /**
- * Convert a Dreamcast vector-quantized image to rp_image.
- * @param px_format Palette pixel format.
- * @param smallVQ If true, handle this image as SmallVQ.
- * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
- * @param width Image width. (Maximum is 4096.)
- * @param height Image height. (Must be equal to width.)
- * @param img_buf VQ image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)*2]
- * @param pal_buf Palette buffer.
- * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * Convert a DXT1 image to rp_image.
+ * SSSE3-optimized version.
+ * S3TC palette index 3 will be interpreted as black.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-ATTR_ACCESS_SIZE(read_only, 6, 7)
-rp_image *fromDreamcastVQ16(PixelFormat px_format,
-	bool smallVQ, bool hasMipmaps,
-	int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz,
-	const uint16_t *RESTRICT pal_buf, int pal_siz);
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
- * Get the number of palette entries for Dreamcast SmallVQ textures.
- * This version is for textures without mipmaps.
- * TODO: constexpr?
- * @param width Texture width.
- * @return Number of palette entries.
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
  */
-static inline int calcDreamcastSmallVQPaletteEntries_NoMipmaps(int width)
-{
-	if (width <= 16) {
-		return 8*4;
-	} else if (width <= 32) {
-		return 32*4;
-	} else if (width <= 64) {
-		return 128*4;
-	} else {
-		return 256*4;
-	}
-}
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromDXT1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
 
 /**
- * Get the number of palette entries for Dreamcast SmallVQ textures.
- * This version is for textures with mipmaps.
- * TODO: constexpr?
- * @param width Texture width.
- * @return Number of palette entries.
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as black.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
  */
-static inline int calcDreamcastSmallVQPaletteEntries_WithMipmaps(int width)
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromDXT1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
 {
-	if (width <= 16) {
-		return 16*4;
-	} else if (width <= 32) {
-		return 64*4;
-	} else if (width <= 64) {
-		return 128*4;
-	} else {
-		return 256*4;
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT1_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT1_cpp(width, height, img_buf, img_siz);
 	}
 }
-
-/* ETC1 */
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
 
 /**
- * Convert an ETC1 image to rp_image.
+ * Convert a DXT1 image to rp_image.
+ * Standard version using regular C++ code.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
  * @param width Image width.
  * @param height Image height.
- * @param img_buf ETC1 image buffer.
+ * @param img_buf DXT1 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromETC1(int width, int height,
+rp_image *fromDXT1_A1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
 
+#ifdef IMAGEDECODER_HAS_SSSE3
 /**
- * Convert an ETC2 RGB image to rp_image.
+ * Convert a DXT1 image to rp_image.
+ * SSSE3-optimized version.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
  * @param width Image width.
  * @param height Image height.
- * @param img_buf ETC2 RGB image buffer.
+ * @param img_buf DXT1 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromETC2_RGB(int width, int height,
+rp_image *fromDXT1_A1_ssse3(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
 /**
- * Convert an ETC2 RGBA image to rp_image.
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
  * @param width Image width.
  * @param height Image height.
- * @param img_buf ETC2 RGBA image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromETC2_RGBA(int width, int height,
+IFUNC_STATIC_INLINE rp_image *fromDXT1_A1(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
 
 /**
- * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * Convert a DXT1 image to rp_image.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
  * @param width Image width.
  * @param height Image height.
- * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_buf DXT1 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromETC2_RGB_A1(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz);
-
-#ifdef ENABLE_PVRTC
-/* PVRTC */
-
-enum PVRTC_Mode_e {
-	// bpp
-	PVRTC_4BPP		= (0U << 0),
-	PVRTC_2BPP		= (1U << 0),
-	PVRTC_BPP_MASK		= (1U << 0),
-
-	// Alpha channel (PVRTC-I only)
-	PVRTC_ALPHA_NONE	= (0U << 1),
-	PVRTC_ALPHA_YES		= (1U << 1),
-	PVRTC_ALPHA_MASK	= (1U << 1),
-};
+static inline rp_image *fromDXT1_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT1_A1_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT1_A1_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
 
 /**
- * Convert a PVRTC 2bpp or 4bpp image to rp_image.
+ * Convert a DXT2 image to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf PVRTC image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/4]
- * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @param img_buf DXT2 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromPVRTC(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz,
-	uint8_t mode);
+rp_image *fromDXT2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
- * Convert a PVRTC-II 2bpp or 4bpp image to rp_image.
+ * Convert a DXT3 image to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf PVRTC image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)/4]
- * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @param img_buf DXT3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromPVRTCII(int width, int height,
-	const uint8_t *RESTRICT img_buf, int img_siz,
-	uint8_t mode);
-#endif /* ENABLE_PVRTC */
-
-/* BC7 */
+rp_image *fromDXT3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
 
 /**
- * Convert a BC7 image to rp_image.
+ * Convert a DXT4 image to rp_image.
  * @param width Image width.
  * @param height Image height.
- * @param img_buf BC7 image buffer.
+ * @param img_buf DXT4 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
 ATTR_ACCESS_SIZE(read_only, 3, 4)
-rp_image *fromBC7(int width, int height,
-	const uint8_t *img_buf, int img_siz);
+rp_image *fromDXT4(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT5_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a DXT5 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromDXT5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Convert a DXT5 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromDXT5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromDXT5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromDXT5_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromDXT5_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Standard version using regular C++ code.
+ * Color component is Red.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC4_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * SSSE3-optimized version.
+ * Color component is Red.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC4_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromBC4(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * Color component is Red.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromBC4(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromBC4_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromBC4_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Standard version using regular C++ code.
+ * Color components are Red and Green.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC5_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSSE3
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * SSSE3-optimized version.
+ * Color components are Red and Green.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromBC5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * Color components are Red and Green.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromBC5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return fromBC5_ssse3(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return fromBC5_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
+
+/**
+ * Convert a Red image to Luminance.
+ * Use with fromBC4() to decode an LATC1 texture.
+ * @param img rp_image to convert in-place.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int fromRed8ToL8(rp_image *img);
+
+/**
+ * Convert a Red+Green image to Luminance+Alpha.
+ * Use with fromBC5() to decode an LATC2 texture.
+ * @param img rp_image to convert in-place.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+ int fromRG8ToLA8(rp_image *img);
+
+/* Dreamcast */
+
+/**
+ * Convert a Dreamcast square twiddled 16-bit image to rp_image.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf 16-bit image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert a Dreamcast vector-quantized image to rp_image.
+ * @param px_format Palette pixel format.
+ * @param smallVQ If true, handle this image as SmallVQ.
+ * @param hasMipmaps If true, the image has mipmaps. (Needed for SmallVQ.)
+ * @param width Image width. (Maximum is 4096.)
+ * @param height Image height. (Must be equal to width.)
+ * @param img_buf VQ image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 1024*2; for SmallVQ, 64*2, 256*2, or 512*2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 6, 7)
+rp_image *fromDreamcastVQ16(PixelFormat px_format,
+	bool smallVQ, bool hasMipmaps,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const uint16_t *RESTRICT pal_buf, int pal_siz);
+
+/**
+ * Get the number of palette entries for Dreamcast SmallVQ textures.
+ * This version is for textures without mipmaps.
+ * TODO: constexpr?
+ * @param width Texture width.
+ * @return Number of palette entries.
+ */
+static inline int calcDreamcastSmallVQPaletteEntries_NoMipmaps(int width)
+{
+	if (width <= 16) {
+		return 8*4;
+	} else if (width <= 32) {
+		return 32*4;
+	} else if (width <= 64) {
+		return 128*4;
+	} else {
+		return 256*4;
+	}
+}
+
+/**
+ * Get the number of palette entries for Dreamcast SmallVQ textures.
+ * This version is for textures with mipmaps.
+ * TODO: constexpr?
+ * @param width Texture width.
+ * @return Number of palette entries.
+ */
+static inline int calcDreamcastSmallVQPaletteEntries_WithMipmaps(int width)
+{
+	if (width <= 16) {
+		return 16*4;
+	} else if (width <= 32) {
+		return 64*4;
+	} else if (width <= 64) {
+		return 128*4;
+	} else {
+		return 256*4;
+	}
+}
+
+/* ETC1 */
+
+/**
+ * Convert an ETC1 image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC1_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGB image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGB_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGBA image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGBA image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGBA_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGB_A1_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSE41
+/**
+ * Convert an ETC1 image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC1_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGB image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGB_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGBA image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGBA image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGBA_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromETC2_RGB_A1_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSE41 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Convert an ETC1 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromETC1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGB image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromETC2_RGB(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGBA image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGBA image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromETC2_RGBA(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+
+/**
+ * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromETC2_RGB_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert an ETC1 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromETC1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return fromETC1_sse41(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return fromETC1_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert an ETC2 RGB image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromETC2_RGB(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return fromETC2_RGB_sse41(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return fromETC2_RGB_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert an ETC2 RGBA image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGBA image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromETC2_RGBA(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return fromETC2_RGBA_sse41(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return fromETC2_RGBA_cpp(width, height, img_buf, img_siz);
+	}
+}
+
+/**
+ * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromETC2_RGB_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return fromETC2_RGB_A1_sse41(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return fromETC2_RGB_A1_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
+
+#ifdef ENABLE_PVRTC
+/* PVRTC */
+
+enum PVRTC_Mode_e {
+	// bpp
+	PVRTC_4BPP		= (0U << 0),
+	PVRTC_2BPP		= (1U << 0),
+	PVRTC_BPP_MASK		= (1U << 0),
+
+	// Alpha channel (PVRTC-I only)
+	PVRTC_ALPHA_NONE	= (0U << 1),
+	PVRTC_ALPHA_YES		= (1U << 1),
+	PVRTC_ALPHA_MASK	= (1U << 1),
+};
+
+/**
+ * Convert a PVRTC 2bpp or 4bpp image to rp_image.
+ * Standard version using the PowerVR Native SDK.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromPVRTC_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode);
+
+/**
+ * Convert a PVRTC-II 2bpp or 4bpp image to rp_image.
+ * Standard version using the PowerVR Native SDK.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromPVRTCII_cpp(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode);
+
+#ifdef IMAGEDECODER_HAS_SSE2
+/**
+ * Convert a PVRTC 2bpp or 4bpp image to rp_image.
+ * SSE2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromPVRTC_sse2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode);
+
+/**
+ * Convert a PVRTC-II 2bpp or 4bpp image to rp_image.
+ * SSE2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromPVRTCII_sse2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+// System does support IFUNC, but it's always guaranteed to have SSE2.
+// Eliminate the IFUNC dispatch on this system.
+
+/**
+ * Convert a PVRTC 2bpp or 4bpp image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromPVRTC(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode)
+{
+	// amd64 always has SSE2.
+	return fromPVRTC_sse2(width, height, img_buf, img_siz, mode);
+}
+
+/**
+ * Convert a PVRTC-II 2bpp or 4bpp image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromPVRTCII(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode)
+{
+	// amd64 always has SSE2.
+	return fromPVRTCII_sse2(width, height, img_buf, img_siz, mode);
+}
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+// System supports IFUNC and is not guaranteed to always have SSE2.
+
+/**
+ * Convert a PVRTC 2bpp or 4bpp image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_SSE2_STATIC_INLINE rp_image *fromPVRTC(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode);
+
+/**
+ * Convert a PVRTC-II 2bpp or 4bpp image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_SSE2_STATIC_INLINE rp_image *fromPVRTCII(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode);
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
+#else /* !RP_HAS_IFUNC or not i386/amd64 */
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a PVRTC 2bpp or 4bpp image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromPVRTC(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode)
+{
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	// amd64 always has SSE2.
+	return fromPVRTC_sse2(width, height, img_buf, img_siz, mode);
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#    ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return fromPVRTC_sse2(width, height, img_buf, img_siz, mode);
+	} else
+#    endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return fromPVRTC_cpp(width, height, img_buf, img_siz, mode);
+	}
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
+
+/**
+ * Convert a PVRTC-II 2bpp or 4bpp image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromPVRTCII(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode)
+{
+#  ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	// amd64 always has SSE2.
+	return fromPVRTCII_sse2(width, height, img_buf, img_siz, mode);
+#  else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+#    ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return fromPVRTCII_sse2(width, height, img_buf, img_siz, mode);
+	} else
+#    endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return fromPVRTCII_cpp(width, height, img_buf, img_siz, mode);
+	}
+#  endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
+
+#endif /* RP_HAS_IFUNC */
+#endif /* ENABLE_PVRTC */
+
+/* BC7 */
+
+/**
+ * Convert a BC7 image to rp_image.
+ * Standard version using regular C++ code.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC7_cpp(int width, int height,
+	const uint8_t *img_buf, int img_siz);
+
+#ifdef IMAGEDECODER_HAS_SSE41
+/**
+ * Convert a BC7 image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+rp_image *fromBC7_sse41(int width, int height,
+	const uint8_t *img_buf, int img_siz);
+#endif /* IMAGEDECODER_HAS_SSE41 */
+
+#if defined(RP_HAS_IFUNC) && (defined(RP_CPU_I386) || defined(RP_CPU_AMD64))
+/**
+ * Convert a BC7 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+IFUNC_STATIC_INLINE rp_image *fromBC7(int width, int height,
+	const uint8_t *img_buf, int img_siz);
+#else
+// System does not support IFUNC, or we aren't guaranteed to have
+// optimizations for these CPUs. Use standard inline dispatch.
+
+/**
+ * Convert a BC7 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 3, 4)
+static inline rp_image *fromBC7(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+#  ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return fromBC7_sse41(width, height, img_buf, img_siz);
+	} else
+#  endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return fromBC7_cpp(width, height, img_buf, img_siz);
+	}
+}
+#endif /* RP_HAS_IFUNC && (RP_CPU_I386 || RP_CPU_AMD64) */
+
+/** Partial regions **/
+
+// NOTE: These functions only decode the specified region of the image.
+// The returned rp_image has the size of the region, not the full image.
+
+/**
+ * Convert a region of a linear 8-bit RGB image to rp_image.
+ * @param px_format	[in] 8-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 8-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)]
+ * @param stride	[in] Stride, in bytes. If 0, assumes width*bytespp.
+ * @param x		[in] Region X position.
+ * @param y		[in] Region Y position.
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return rp_image with the size of the region, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 4, 5)
+rp_image *fromLinear8_region(PixelFormat px_format,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz, int stride,
+	int x, int y, int w, int h);
+
+/**
+ * Convert a region of a linear 16-bit RGB image to rp_image.
+ * @param px_format	[in] 16-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
+ * @param stride	[in] Stride, in bytes. If 0, assumes width*bytespp.
+ * @param x		[in] Region X position.
+ * @param y		[in] Region Y position.
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return rp_image with the size of the region, or nullptr on error.
+ */
+rp_image *fromLinear16_region(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz, int stride,
+	int x, int y, int w, int h);
+
+/**
+ * Convert a region of a linear 24-bit RGB image to rp_image.
+ * @param px_format	[in] 24-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 24-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param stride	[in] Stride, in bytes. If 0, assumes width*bytespp.
+ * @param x		[in] Region X position.
+ * @param y		[in] Region Y position.
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return rp_image with the size of the region, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 4, 5)
+rp_image *fromLinear24_region(PixelFormat px_format,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz, int stride,
+	int x, int y, int w, int h);
+
+/**
+ * Convert a region of a linear 32-bit RGB image to rp_image.
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 32-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*4]
+ * @param stride	[in] Stride, in bytes. If 0, assumes width*bytespp.
+ * @param x		[in] Region X position.
+ * @param y		[in] Region Y position.
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return rp_image with the size of the region, or nullptr on error.
+ */
+rp_image *fromLinear32_region(PixelFormat px_format,
+	int width, int height,
+	const uint32_t *RESTRICT img_buf, int img_siz, int stride,
+	int x, int y, int w, int h);
+
+/**
+ * Tiled or block-compressed image decoding function.
+ * Used by fromTiled_region().
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf Image buffer.
+ * @param img_siz Size of image data.
+ * @return rp_image, or nullptr on error.
+ */
+typedef rp_image *(*pfnFromTiled_t)(int width, int height, const uint8_t *img_buf, int img_siz);
+
+/**
+ * Convert a region of a tiled or block-compressed image to rp_image.
+ *
+ * Tiles must be stored in row-major order, and each tile must be
+ * stored contiguously. The tiles that cover the region are gathered
+ * into a temporary buffer, which is then decoded by pfnDecode().
+ * The rest of the image is not decoded.
+ *
+ * Examples:
+ * - DXT1, BC4, ETC1, ETC2_RGB: 4x4 tiles, 8 bytes per tile
+ * - DXT3, DXT5, BC5, BC7, ETC2_RGBA: 4x4 tiles, 16 bytes per tile
+ *
+ * @param pfnDecode	[in] Decoding function for the full image format.
+ * @param tileW		[in] Tile width.
+ * @param tileH		[in] Tile height.
+ * @param tileSize	[in] Size of each tile, in bytes.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] Image buffer.
+ * @param img_siz	[in] Size of image data.
+ * @param x		[in] Region X position. [must be a multiple of tileW]
+ * @param y		[in] Region Y position. [must be a multiple of tileH]
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return rp_image with the size of the region, or nullptr on error.
+ */
+ATTR_ACCESS_SIZE(read_only, 7, 8)
+rp_image *fromTiled_region(pfnFromTiled_t pfnDecode,
+	int tileW, int tileH, int tileSize,
+	int width, int height,
+	const uint8_t *img_buf, int img_siz,
+	int x, int y, int w, int h);
+
+/** Streamed decoding **/
+
+/**
+ * Band decoding function.
+ * Used by fromFile_banded().
+ * @param param User parameter.
+ * @param height Band height. (The band width is always the image width.)
+ * @param img_buf Image buffer for the band.
+ * @param img_siz Size of image data for the band.
+ * @return rp_image, or nullptr on error.
+ */
+typedef rp_image *(*pfnDecodeBand_t)(void *param, int height, const uint8_t *img_buf, int img_siz);
+
+/**
+ * Decode an image directly from a file.
+ *
+ * If the file can provide a direct view of the image data, e.g. using
+ * a memory mapping, the image is decoded from that view without copying.
+ * Otherwise, small images are read in full, and large images are read
+ * and decoded in bands of tile rows, so a full-size temporary buffer
+ * isn't needed.
+ *
+ * Tile rows must be stored contiguously in top-to-bottom order.
+ *
+ * @param pfnDecode	[in] Band decoding function.
+ * @param param		[in] User parameter for pfnDecode().
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param tileH		[in] Tile height. (1 for linear images; height if the image can't be split)
+ * @param tileRowSize	[in] Size of one row of tiles, in bytes.
+ * @param file		[in] File to read from.
+ * @param addr		[in] Starting address of the image data.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromFile_banded(pfnDecodeBand_t pfnDecode, void *param,
+	int width, int height, int tileH, int tileRowSize,
+	LibRpFile::IRpFile *file, off64_t addr);
 
 } }
 
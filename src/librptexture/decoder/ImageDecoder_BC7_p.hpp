@@ -0,0 +1,67 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_BC7_p.hpp: Image decoding functions. (BC7) (PRIVATE)       *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_BC7_P_HPP__
+#define __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_BC7_P_HPP__
+
+#include "common.h"
+#include "../img/rp_image.hpp"
+
+// C includes. (C++ namespace)
+#include <cassert>
+
+// C++ includes.
+#include <array>
+
+// Shared between the standard and SIMD-optimized BC7 decoders.
+namespace LibRpTexture { namespace ImageDecoder { namespace BC7 {
+
+// Interpolation values.
+extern const uint8_t aWeight2[4];
+extern const uint8_t aWeight3[8];
+extern const uint8_t aWeight4[16];
+
+// Partition definitions for modes with 2 subsets.
+extern const uint32_t bc7_2sub[64];
+
+// Anchor indexes for the second subset (idx == 1) in 2-subset modes.
+extern const uint8_t anchorIndexes_subset2of2[64];
+
+/**
+ * Get the mode number.
+ * @param dword0 LSB DWORD.
+ * @return Mode number.
+ */
+static inline int get_mode(uint32_t dword0)
+{
+	// TODO: ctz/_BitScanForward?
+	// Benchmarks showed it was *slower* than this function...
+	for (unsigned int i = 0; i < 8; i++, dword0 >>= 1) {
+		if (dword0 & 1) {
+			// Found the mode number.
+			return i;
+		}
+	}
+
+	// Invalid mode.
+	assert(!"BC7 block has an invalid mode.");
+	return -1;
+}
+
+/**
+ * Decode a single BC7 block.
+ * Standard version using regular C++ code.
+ * @param tileBuf	[out] Tile buffer.
+ * @param bc7_src	[in] BC7 block. (128-bit little-endian)
+ * @return True on success; false if the block mode is invalid.
+ */
+bool decodeBlock(std::array<argb32_t, 4*4> &tileBuf, const uint64_t *bc7_src);
+
+} } }
+
+#endif /* __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_BC7_P_HPP__ */
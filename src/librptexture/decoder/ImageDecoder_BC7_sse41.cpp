@@ -0,0 +1,452 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_BC7.cpp: Image decoding functions. (BC7)                   *
+ * SSE4.1-optimized version.                                               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+#include "ImageDecoder_BC7_p.hpp"
+
+// librpthreads
+#include "librpthreads/Atomics.h"
+
+// C++ STL classes.
+using std::array;
+
+// SSE4.1 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <smmintrin.h>
+
+// References:
+// - https://msdn.microsoft.com/en-us/library/windows/desktop/hh308953(v=vs.85).aspx
+// - https://msdn.microsoft.com/en-us/library/windows/desktop/hh308954(v=vs.85).aspx
+
+// Modes 1, 5, and 6 are the most common modes in BC7 textures
+// produced by current encoders, so they have dedicated decoders
+// here. All other modes use the standard BC7::decodeBlock().
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+// Weight lookup tables for _mm_shuffle_epi8().
+struct BC7_WeightTables {
+	__m128i w2_lo;	// aWeight2[n & 3]
+	__m128i w2_hi;	// aWeight2[n >> 2]
+	__m128i w4;	// aWeight4[n]
+};
+
+/**
+ * Extract a bitfield from a 128-bit BC7 block.
+ * @param lsb	[in] LSB QWORD
+ * @param msb	[in] MSB QWORD
+ * @param pos	[in] Bit position
+ * @param bits	[in] Number of bits (must be less than 32)
+ * @return Bitfield value
+ */
+static FORCEINLINE unsigned int extract_bits(uint64_t lsb, uint64_t msb, unsigned int pos, unsigned int bits)
+{
+	assert(pos < 128);
+	assert(bits < 32);
+	uint64_t val;
+	if (pos >= 64) {
+		val = msb >> (pos - 64);
+	} else if (pos == 0) {
+		val = lsb;
+	} else {
+		val = (lsb >> pos) | (msb << (64 - pos));
+	}
+	return static_cast<unsigned int>(val & ((1U << bits) - 1));
+}
+
+/**
+ * Expand per-texel weights to per-component weights.
+ * @param w_out	[out] Per-component weights for each row of four texels.
+ * @param wc	[in] Color weights, one byte per texel.
+ * @param wa	[in] Alpha weights, one byte per texel.
+ */
+static FORCEINLINE void expand_weights(__m128i w_out[4], __m128i wc, __m128i wa)
+{
+	// argb32_t is stored as BGRA on little-endian.
+	const __m128i shuf_lo = _mm_setr_epi8(0,0,0,1, 2,2,2,3, 4,4,4,5, 6,6,6,7);
+	const __m128i shuf_hi = _mm_setr_epi8(8,8,8,9, 10,10,10,11, 12,12,12,13, 14,14,14,15);
+
+	const __m128i wl = _mm_unpacklo_epi8(wc, wa);
+	const __m128i wh = _mm_unpackhi_epi8(wc, wa);
+	w_out[0] = _mm_shuffle_epi8(wl, shuf_lo);
+	w_out[1] = _mm_shuffle_epi8(wl, shuf_hi);
+	w_out[2] = _mm_shuffle_epi8(wh, shuf_lo);
+	w_out[3] = _mm_shuffle_epi8(wh, shuf_hi);
+}
+
+/**
+ * Interpolate four texels.
+ * Equivalent to ((64 - w) * e0 + w * e1 + 32) >> 6 for each component.
+ * @param e0	[in] Endpoint 0 for each texel. (ARGB32)
+ * @param e1	[in] Endpoint 1 for each texel. (ARGB32)
+ * @param w	[in] Weight for each component. (0-64)
+ * @return Interpolated texels. (ARGB32)
+ */
+static FORCEINLINE __m128i interpolate4(__m128i e0, __m128i e1, __m128i w)
+{
+	const __m128i iw = _mm_sub_epi8(_mm_set1_epi8(64), w);
+	const __m128i round = _mm_set1_epi16(32);
+
+	// NOTE: The maximum sum is 255*64 == 16320, so the
+	// signed saturation in pmaddubsw is never hit.
+	__m128i lo = _mm_maddubs_epi16(_mm_unpacklo_epi8(e0, e1), _mm_unpacklo_epi8(iw, w));
+	__m128i hi = _mm_maddubs_epi16(_mm_unpackhi_epi8(e0, e1), _mm_unpackhi_epi8(iw, w));
+	lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 6);
+	hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 6);
+	return _mm_packus_epi16(lo, hi);
+}
+
+/**
+ * Convert 2-bit indexes to weights.
+ * @param idx	[in] 16 2-bit indexes, with the anchor bit already inserted.
+ * @param wt	[in] Weight tables.
+ * @return Weights, one byte per texel.
+ */
+static FORCEINLINE __m128i weights_2bit(uint32_t idx, const BC7_WeightTables &wt)
+{
+	// Split into nybbles, then look up both indexes in each nybble.
+	const __m128i mask_nyb = _mm_set1_epi8(0x0F);
+	const __m128i v = _mm_cvtsi32_si128(static_cast<int>(idx));
+	const __m128i nyb = _mm_unpacklo_epi8(
+		_mm_and_si128(v, mask_nyb),
+		_mm_and_si128(_mm_srli_epi16(v, 4), mask_nyb));
+	return _mm_unpacklo_epi8(
+		_mm_shuffle_epi8(wt.w2_lo, nyb),
+		_mm_shuffle_epi8(wt.w2_hi, nyb));
+}
+
+/**
+ * Convert 4-bit indexes to weights.
+ * @param idx	[in] 16 4-bit indexes, with the anchor bit already inserted.
+ * @param wt	[in] Weight tables.
+ * @return Weights, one byte per texel.
+ */
+static FORCEINLINE __m128i weights_4bit(uint64_t idx, const BC7_WeightTables &wt)
+{
+	const __m128i mask_nyb = _mm_set1_epi8(0x0F);
+	const __m128i v = _mm_set_epi32(0, 0,
+		static_cast<int>(idx >> 32), static_cast<int>(idx & 0xFFFFFFFFU));
+	const __m128i nyb = _mm_unpacklo_epi8(
+		_mm_and_si128(v, mask_nyb),
+		_mm_and_si128(_mm_srli_epi16(v, 4), mask_nyb));
+	return _mm_shuffle_epi8(wt.w4, nyb);
+}
+
+/**
+ * Store a decoded 4x4 tile in an rp_image.
+ * @param pDest		[out] First pixel of the tile in the rp_image.
+ * @param stride_px	[in] rp_image stride, in pixels.
+ * @param rows		[in] Decoded rows.
+ */
+static FORCEINLINE void store_tile(uint32_t *pDest, int stride_px, const __m128i rows[4])
+{
+	for (unsigned int i = 0; i < 4; i++, pDest += stride_px) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), rows[i]);
+	}
+}
+
+/**
+ * Decode a BC7 mode 1 block.
+ * Two subsets; 6-bit RGB endpoints with a shared P-bit per subset; 3-bit indexes.
+ * @param pDest		[out] First pixel of the tile in the rp_image.
+ * @param stride_px	[in] rp_image stride, in pixels.
+ * @param lsb		[in] LSB QWORD
+ * @param msb		[in] MSB QWORD
+ */
+static inline void decodeBlock_mode1(uint32_t *pDest, int stride_px, uint64_t lsb, uint64_t msb)
+{
+	const unsigned int partition = extract_bits(lsb, msb, 2, 6);
+
+	// Endpoints: R0-R3, G0-G3, B0-B3
+	uint32_t ep[4];
+	const unsigned int pbits = extract_bits(lsb, msb, 80, 2);
+	for (unsigned int i = 0; i < 4; i++) {
+		const unsigned int p = ((pbits >> (i / 2)) & 1) << 1;
+		unsigned int r = (extract_bits(lsb, msb,  8 + (i * 6), 6) << 2) | p;
+		unsigned int g = (extract_bits(lsb, msb, 32 + (i * 6), 6) << 2) | p;
+		unsigned int b = (extract_bits(lsb, msb, 56 + (i * 6), 6) << 2) | p;
+		r |= (r >> 7);
+		g |= (g >> 7);
+		b |= (b >> 7);
+		ep[i] = 0xFF000000U | (r << 16) | (g << 8) | b;
+	}
+
+	// Color indexes. (3-bit)
+	// NOTE: Both anchor texels only have 2 bits.
+	const uint32_t subset = BC7::bc7_2sub[partition];
+	const uint8_t anchor_index[2] = {0, BC7::anchorIndexes_subset2of2[partition]};
+	uint64_t idxData = msb >> 18;
+	uint32_t subsetData = subset;
+	ALIGNED_VAR(16, uint8_t wbuf[16]);
+	for (unsigned int i = 0; i < 16; i++, subsetData >>= 2) {
+		const unsigned int subset_idx = subsetData & 1;
+		if (i == anchor_index[subset_idx]) {
+			wbuf[i] = BC7::aWeight3[idxData & 3];
+			idxData >>= 2;
+		} else {
+			wbuf[i] = BC7::aWeight3[idxData & 7];
+			idxData >>= 3;
+		}
+	}
+
+	// Alpha is always 255, so the alpha weights don't matter.
+	const __m128i wc = _mm_load_si128(reinterpret_cast<const __m128i*>(wbuf));
+	__m128i w[4];
+	expand_weights(w, wc, wc);
+
+	// Select the endpoints for each texel based on its subset.
+	const __m128i ep0_s0 = _mm_set1_epi32(static_cast<int>(ep[0]));
+	const __m128i ep1_s0 = _mm_set1_epi32(static_cast<int>(ep[1]));
+	const __m128i ep0_s1 = _mm_set1_epi32(static_cast<int>(ep[2]));
+	const __m128i ep1_s1 = _mm_set1_epi32(static_cast<int>(ep[3]));
+	const __m128i subset_bits = _mm_setr_epi32(1 << 0, 1 << 2, 1 << 4, 1 << 6);
+
+	__m128i rows[4];
+	for (unsigned int y = 0; y < 4; y++) {
+		const __m128i sub = _mm_and_si128(_mm_set1_epi32(static_cast<int>(subset >> (y * 8))), subset_bits);
+		const __m128i mask = _mm_cmpeq_epi32(sub, subset_bits);
+		rows[y] = interpolate4(
+			_mm_blendv_epi8(ep0_s0, ep0_s1, mask),
+			_mm_blendv_epi8(ep1_s0, ep1_s1, mask),
+			w[y]);
+	}
+	store_tile(pDest, stride_px, rows);
+}
+
+/**
+ * Decode a BC7 mode 5 block.
+ * One subset; 7-bit RGB endpoints; 8-bit alpha endpoints;
+ * separate 2-bit color and alpha indexes; component rotation.
+ * @param pDest		[out] First pixel of the tile in the rp_image.
+ * @param stride_px	[in] rp_image stride, in pixels.
+ * @param lsb		[in] LSB QWORD
+ * @param msb		[in] MSB QWORD
+ * @param wt		[in] Weight tables.
+ */
+static inline void decodeBlock_mode5(uint32_t *pDest, int stride_px, uint64_t lsb, uint64_t msb,
+	const BC7_WeightTables &wt)
+{
+	const unsigned int rotation_mode = extract_bits(lsb, msb, 6, 2);
+
+	// Endpoints: R0, R1, G0, G1, B0, B1, A0, A1
+	uint32_t ep[2];
+	for (unsigned int i = 0; i < 2; i++) {
+		unsigned int r = extract_bits(lsb, msb,  8 + (i * 7), 7) << 1;
+		unsigned int g = extract_bits(lsb, msb, 22 + (i * 7), 7) << 1;
+		unsigned int b = extract_bits(lsb, msb, 36 + (i * 7), 7) << 1;
+		const unsigned int a = extract_bits(lsb, msb, 50 + (i * 8), 8);
+		r |= (r >> 7);
+		g |= (g >> 7);
+		b |= (b >> 7);
+		ep[i] = (a << 24) | (r << 16) | (g << 8) | b;
+	}
+
+	// Color and alpha indexes. (2-bit, 31 bits each)
+	// Insert the implied anchor bit for texel 0.
+	const uint32_t cidx = static_cast<uint32_t>(msb >> 2) & 0x7FFFFFFFU;
+	const uint32_t aidx = static_cast<uint32_t>(msb >> 33);
+	__m128i w[4];
+	expand_weights(w,
+		weights_2bit(((cidx >> 1) << 2) | (cidx & 1), wt),
+		weights_2bit(((aidx >> 1) << 2) | (aidx & 1), wt));
+
+	const __m128i e0 = _mm_set1_epi32(static_cast<int>(ep[0]));
+	const __m128i e1 = _mm_set1_epi32(static_cast<int>(ep[1]));
+	__m128i rows[4];
+	for (unsigned int y = 0; y < 4; y++) {
+		rows[y] = interpolate4(e0, e1, w[y]);
+	}
+
+	// Component rotation.
+	if (rotation_mode != 0) {
+		static const uint8_t rotation_shuf[3][16] = {
+			// RAGB: Swap A and R.
+			{0,1,3,2, 4,5,7,6, 8,9,11,10, 12,13,15,14},
+			// GRAB: Swap A and G.
+			{0,3,2,1, 4,7,6,5, 8,11,10,9, 12,15,14,13},
+			// BRGA: Swap A and B.
+			{3,1,2,0, 7,5,6,4, 11,9,10,8, 15,13,14,12},
+		};
+		const __m128i shuf = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rotation_shuf[rotation_mode - 1]));
+		for (unsigned int y = 0; y < 4; y++) {
+			rows[y] = _mm_shuffle_epi8(rows[y], shuf);
+		}
+	}
+
+	store_tile(pDest, stride_px, rows);
+}
+
+/**
+ * Decode a BC7 mode 6 block.
+ * One subset; 7-bit RGBA endpoints with a unique P-bit per endpoint;
+ * 4-bit indexes shared by color and alpha.
+ * @param pDest		[out] First pixel of the tile in the rp_image.
+ * @param stride_px	[in] rp_image stride, in pixels.
+ * @param lsb		[in] LSB QWORD
+ * @param msb		[in] MSB QWORD
+ * @param wt		[in] Weight tables.
+ */
+static inline void decodeBlock_mode6(uint32_t *pDest, int stride_px, uint64_t lsb, uint64_t msb,
+	const BC7_WeightTables &wt)
+{
+	// Endpoints: R0, R1, G0, G1, B0, B1, A0, A1, P0, P1
+	uint32_t ep[2];
+	const unsigned int pbits = extract_bits(lsb, msb, 63, 2);
+	for (unsigned int i = 0; i < 2; i++) {
+		const unsigned int p = (pbits >> i) & 1;
+		const unsigned int r = (extract_bits(lsb, msb,  7 + (i * 7), 7) << 1) | p;
+		const unsigned int g = (extract_bits(lsb, msb, 21 + (i * 7), 7) << 1) | p;
+		const unsigned int b = (extract_bits(lsb, msb, 35 + (i * 7), 7) << 1) | p;
+		const unsigned int a = (extract_bits(lsb, msb, 49 + (i * 7), 7) << 1) | p;
+		ep[i] = (a << 24) | (r << 16) | (g << 8) | b;
+	}
+
+	// Indexes. (4-bit, 63 bits)
+	// Insert the implied anchor bit for texel 0.
+	const uint64_t idx = msb >> 1;
+	const __m128i wc = weights_4bit(((idx >> 3) << 4) | (idx & 7), wt);
+	__m128i w[4];
+	expand_weights(w, wc, wc);
+
+	const __m128i e0 = _mm_set1_epi32(static_cast<int>(ep[0]));
+	const __m128i e1 = _mm_set1_epi32(static_cast<int>(ep[1]));
+	__m128i rows[4];
+	for (unsigned int y = 0; y < 4; y++) {
+		rows[y] = interpolate4(e0, e1, w[y]);
+	}
+	store_tile(pDest, stride_px, rows);
+}
+
+/**
+ * Convert a BC7 image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC7_sse41(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// BC7 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= (width * height));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < (physWidth * physHeight))
+	{
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// sBIT metadata.
+	// TODO: Dynamically determine if we have alpha?
+	// Rotation bits makes this difficult...
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+
+	// Weight lookup tables.
+	BC7_WeightTables wt;
+	{
+		ALIGNED_VAR(16, uint8_t w2_lo[16]);
+		ALIGNED_VAR(16, uint8_t w2_hi[16]);
+		for (unsigned int n = 0; n < 16; n++) {
+			w2_lo[n] = BC7::aWeight2[n & 3];
+			w2_hi[n] = BC7::aWeight2[n >> 2];
+		}
+		wt.w2_lo = _mm_load_si128(reinterpret_cast<const __m128i*>(w2_lo));
+		wt.w2_hi = _mm_load_si128(reinterpret_cast<const __m128i*>(w2_hi));
+		wt.w4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(BC7::aWeight4));
+	}
+
+	uint32_t *const pImgBuf = static_cast<uint32_t*>(img->bits());
+	const int stride_px = img->stride() / sizeof(uint32_t);
+
+	volatile int invalidMode = 0;
+	ImageDecoderPrivate::decodeTileRows(img, tilesY,
+		[img, img_buf, tilesX, pImgBuf, stride_px, &wt, &invalidMode](unsigned int yStart, unsigned int yEnd)
+	{
+		const uint64_t *bc7_src = reinterpret_cast<const uint64_t*>(img_buf) +
+			(static_cast<size_t>(yStart) * tilesX * 2);
+
+		// Temporary tile buffer for modes that don't have optimized decoders.
+		array<argb32_t, 4*4> tileBuf;
+
+		for (unsigned int y = yStart; y < yEnd; y++) {
+			uint32_t *pDest = pImgBuf + (y * 4 * stride_px);
+			for (unsigned int x = 0; x < tilesX; x++, bc7_src += 2, pDest += 4) {
+				const uint64_t lsb = le64_to_cpu(bc7_src[0]);
+				const uint64_t msb = le64_to_cpu(bc7_src[1]);
+
+				switch (BC7::get_mode(static_cast<uint32_t>(lsb))) {
+					case -1:
+						// Invalid mode.
+						ATOMIC_OR_FETCH(&invalidMode, 1);
+						return;
+					case 1:
+						decodeBlock_mode1(pDest, stride_px, lsb, msb);
+						break;
+					case 5:
+						decodeBlock_mode5(pDest, stride_px, lsb, msb, wt);
+						break;
+					case 6:
+						decodeBlock_mode6(pDest, stride_px, lsb, msb, wt);
+						break;
+					default:
+						// Use the standard decoder.
+						BC7::decodeBlock(tileBuf, bc7_src);
+						ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
+						break;
+				}
+			}
+		}
+	});
+
+	if (invalidMode) {
+		// At least one block has an invalid mode.
+		img->unref();
+		return nullptr;
+	}
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+} }
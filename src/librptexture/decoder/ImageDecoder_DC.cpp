@@ -18,45 +18,35 @@ using namespace LibRpTexture::PixelConversion;
 // C++ STL classes.
 using std::unique_ptr;
 
-// One-time initialization.
-#include "librpthreads/pthread_once.h"
-
 namespace LibRpTexture { namespace ImageDecoder {
 
 /**
- * Dreamcast twiddle map.
- * Must be initialized using initDreamcastTwiddleMap().
+ * Get the Dreamcast twiddle value for a coordinate.
+ * Bit n of the coordinate is moved to bit 2n.
  *
- * Supports textures up to 4096x4096.
- */
-static unsigned int dc_tmap[4096];
-
-// pthread_once() control variable.
-static pthread_once_t once_control = PTHREAD_ONCE_INIT;
-
-/**
- * Initialize the Dreamcast twiddle map.
- * This initializes dc_tmap[].
+ * Supports coordinates up to 65535.
  *
- * This function MUST be called using pthread_once().
+ * @param v Coordinate.
+ * @return Twiddle value.
  */
-static void initDreamcastTwiddleMap_int(void)
+static inline unsigned int dcTwiddle(unsigned int v)
 {
-	for (unsigned int i = 0; i < ARRAY_SIZE(dc_tmap); i++) {
-		dc_tmap[i] = 0;
-		for (unsigned int j = 0, k = 1; k <= i; j++, k <<= 1) {
-			dc_tmap[i] |= ((i & k) << j);
-		}
-	}
+	v = (v | (v << 8)) & 0x00FF00FFU;
+	v = (v | (v << 4)) & 0x0F0F0F0FU;
+	v = (v | (v << 2)) & 0x33333333U;
+	v = (v | (v << 1)) & 0x55555555U;
+	return v;
 }
 
 /**
- * Initialize the Dreamcast twiddle map.
- * This initializes dc_tmap[].
+ * Get the Dreamcast twiddle value for the next coordinate.
+ * @param t Twiddle value for v.
+ * @return Twiddle value for v+1.
  */
-static FORCEINLINE void initDreamcastTwiddleMap(void)
+static inline unsigned int dcTwiddleNext(unsigned int t)
 {
-	pthread_once(&once_control, initDreamcastTwiddleMap_int);
+	// Set the odd bits so the carry propagates across them.
+	return ((t | 0xAAAAAAAAU) + 1) & 0x55555555U;
 }
 
 /**
@@ -86,9 +76,6 @@ rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
 		return nullptr;
 	}
 
-	// Initialize the twiddle map.
-	initDreamcastTwiddleMap();
-
 	// Create an rp_image.
 	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
@@ -103,10 +90,13 @@ rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
 	switch (px_format) {
 		case PixelFormat::ARGB1555: {
 			for (unsigned int y = 0; y < static_cast<unsigned int>(height); y++) {
+				const unsigned int ty = dcTwiddle(y);
+				unsigned int tx = 0;
 				for (unsigned int x = 0; x < static_cast<unsigned int>(width); x++) {
-					const unsigned int srcIdx = ((dc_tmap[x] << 1) | dc_tmap[y]);
+					const unsigned int srcIdx = ((tx << 1) | ty);
 					*px_dest = ARGB1555_to_ARGB32(le16_to_cpu(img_buf[srcIdx]));
 					px_dest++;
+					tx = dcTwiddleNext(tx);
 				}
 				px_dest += dest_stride_adj;
 			}
@@ -118,10 +108,13 @@ rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
 
 		case PixelFormat::RGB565: {
 			for (unsigned int y = 0; y < static_cast<unsigned int>(height); y++) {
+				const unsigned int ty = dcTwiddle(y);
+				unsigned int tx = 0;
 				for (unsigned int x = 0; x < static_cast<unsigned int>(width); x++) {
-					const unsigned int srcIdx = ((dc_tmap[x] << 1) | dc_tmap[y]);
+					const unsigned int srcIdx = ((tx << 1) | ty);
 					*px_dest = RGB565_to_ARGB32(le16_to_cpu(img_buf[srcIdx]));
 					px_dest++;
+					tx = dcTwiddleNext(tx);
 				}
 				px_dest += dest_stride_adj;
 			}
@@ -133,10 +126,13 @@ rp_image *fromDreamcastSquareTwiddled16(PixelFormat px_format,
 
 		case PixelFormat::ARGB4444: {
 			for (unsigned int y = 0; y < static_cast<unsigned int>(height); y++) {
+				const unsigned int ty = dcTwiddle(y);
+				unsigned int tx = 0;
 				for (unsigned int x = 0; x < static_cast<unsigned int>(width); x++) {
-					const unsigned int srcIdx = ((dc_tmap[x] << 1) | dc_tmap[y]);
+					const unsigned int srcIdx = ((tx << 1) | ty);
 					*px_dest = ARGB4444_to_ARGB32(le16_to_cpu(img_buf[srcIdx]));
 					px_dest++;
+					tx = dcTwiddleNext(tx);
 				}
 				px_dest += dest_stride_adj;
 			}
@@ -211,9 +207,6 @@ rp_image *fromDreamcastVQ16(PixelFormat px_format,
 		return nullptr;
 	}
 
-	// Initialize the twiddle map.
-	initDreamcastTwiddleMap();
-
 	// Create an rp_image.
 	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
@@ -270,8 +263,10 @@ rp_image *fromDreamcastVQ16(PixelFormat px_format,
 	const int dest_stride = (img->stride() / sizeof(uint32_t));
 	const int dest_stride_adj = dest_stride + dest_stride - img->width();
 	for (unsigned int y = 0; y < static_cast<unsigned int>(height); y += 2, px_dest += dest_stride_adj) {
-	for (unsigned int x = 0; x < static_cast<unsigned int>(width); x += 2, px_dest += 2) {
-		const unsigned int srcIdx = ((dc_tmap[x >> 1] << 1) | dc_tmap[y >> 1]);
+	const unsigned int ty = dcTwiddle(y >> 1);
+	unsigned int tx = 0;
+	for (unsigned int x = 0; x < static_cast<unsigned int>(width); x += 2, px_dest += 2, tx = dcTwiddleNext(tx)) {
+		const unsigned int srcIdx = ((tx << 1) | ty);
 		assert(srcIdx < (unsigned int)img_siz);
 		if (srcIdx >= static_cast<unsigned int>(img_siz)) {
 			// Out of bounds.
@@ -9,6 +9,7 @@
 #include "stdafx.h"
 #include "ImageDecoder.hpp"
 #include "ImageDecoder_p.hpp"
+#include "ImageDecoder_ETC1_p.hpp"
 
 // C++ STL classes.
 using std::array;
@@ -20,103 +21,7 @@ using std::array;
 
 namespace LibRpTexture { namespace ImageDecoder {
 
-// ETC1 block format.
-// NOTE: Layout maps to on-disk format, which is big-endian.
-typedef union _etc1_block {
-	struct {
-		// Base colors
-		// Byte layout:
-		// - diffbit == 0: 4 MSB == base 1, 4 LSB == base 2
-		// - diffbit == 1: 5 MSB == base, 3 LSB == differential
-		// Some compilers pad this structure to a multiple of 4 bytes
-#pragma pack(1)
-		union PACKED {
-			// Indiv/Diff
-			struct PACKED {
-				uint8_t R;
-				uint8_t G;
-				uint8_t B;
-			} id;
-
-			// ETC2 'T' mode
-			struct PACKED {
-				uint8_t R1;
-				uint8_t G1B1;
-				uint8_t R2G2;
-				// B2 is in `control`.
-			} t;
-
-			// ETC2 'H' mode
-			struct PACKED {
-				uint8_t R1G1a;
-				uint8_t G1bB1aB1b;
-				uint8_t B1bR2G2;
-				// Part of G2 is in `control`.
-				// B2 is in `control`.
-			} h;
-		};
-#pragma pack()
-
-		// Control byte: [ETC1]
-		// - 3 MSB:  table code word 1
-		// - 3 next: table code word 2
-		// - 1 bit:  diff bit
-		// - 1 LSB:  flip bit
-		uint8_t control;
-
-		// Pixel index bits. (big-endian)
-		uint16_t msb;
-		uint16_t lsb;
-	};
-
-	struct {
-		// Planar mode has 3 colors in RGB676 format.
-		// Colors are labelled 'O', 'H', and 'V'.
-		uint8_t RO_GO1;		// 6-1: RO;     0: GO1
-		uint8_t GO2_BO1;	// 6-1: GO2;    0: BO1
-		uint8_t BO2_BO3;	// 4-3: BO2;  1-0: BO3a
-		uint8_t BO3_RH;		//   7: BO3b; 6-2: RH1; 0: RH2
-		uint8_t GH_BH;		// 7-1: GH;     0: BH
-		uint8_t BH_RV;		// 7-3: BH;   2-0: RV
-		uint8_t RV_GV;		// 7-5: RV;   4-0: GV
-		uint8_t GV_BV;		// 7-6: GV;   5-0: BV
-	} planar;
-} etc1_block;
-ASSERT_STRUCT(etc1_block, sizeof(uint64_t));
-
-// ETC2 alpha block format.
-// NOTE: Layout maps to on-disk format, which is big-endian.
-typedef union _etc2_alpha {
-	struct {
-		uint8_t base_codeword;	// Base codeword.
-		uint8_t mult_tbl_idx;	// Multiplier (high 4); table index (low 4)
-		uint8_t values[6];	// Alpha values. (48-bit unsigned; 3-bit per pixel)
-	};
-	uint64_t u64;				// Access the 48-bit alpha value directly. (Requires shifting.)
-} etc2_alpha;
-ASSERT_STRUCT(etc2_alpha, sizeof(uint64_t));
-
-// ETC2 RGBA block format.
-// NOTE: Layout maps to on-disk format, which is big-endian.
-typedef struct _etc2_rgba_block {
-	etc2_alpha alpha;
-	etc1_block etc1;
-} etc2_rgba_block;
-ASSERT_STRUCT(etc2_rgba_block, 16);
-
-/**
- * Extract the 48-bit code value from etc2_alpha.
- * @param data etc2_alpha.
- * @return 48-bit code value.
- */
-static FORCEINLINE uint64_t extract48(const etc2_alpha *RESTRICT data)
-{
-	// values[6] starts at 0x02 within etc2_alpha.
-	// Hence, we need to mask it after byteswapping.
-	// TODO: constexpr?
-	// TODO: Verify on big-endian.
-	return be64_to_cpu(data->u64) & 0x0000FFFFFFFFFFFFULL;
-}
+namespace ETC {
 
 /**
  * Pixel index values:
@@ -142,7 +47,7 @@ static FORCEINLINE uint64_t extract48(const etc2_alpha *RESTRICT data)
  * index values in ascending two-bit value order as
  * listed above instead of mapping to ETC1 table 3.17.2.
  */
-static const int16_t etc1_intensity[8][4] = {
+const int16_t etc1_intensity[8][4] = {
 	{ 2,   8,  -2,   -8},
 	{ 5,  17,  -5,  -17},
 	{ 9,  29,  -9,  -29},
@@ -162,7 +67,7 @@ static const int16_t etc1_intensity[8][4] = {
  * index values in ascending two-bit value order as
  * listed above instead of mapping to ETC1 table 3.17.2.
  */
-static const int16_t etc2_intensity_a1[8][4] = {
+const int16_t etc2_intensity_a1[8][4] = {
 	{0,   8, 0,   -8},
 	{0,  17, 0,  -17},
 	{0,  29, 0,  -29},
@@ -172,7 +77,6 @@ static const int16_t etc2_intensity_a1[8][4] = {
 	{0, 106, 0, -106},
 	{0, 183, 0, -183},
 };
-
 // ETC1 arranges pixels by column, then by row.
 // This table maps it back to linear.
 static const uint8_t etc1_mapping[16] = {
@@ -198,14 +102,6 @@ static const int8_t etc1_3bit_diff_tbl[8] = {
 	0, 1, 2, 3, -4, -3, -2, -1
 };
 
-// ETC2 block mode.
-enum class etc2_block_mode {
-	Unknown = 0,
-	ETC1,	// ETC1-compatible mode (indiv, diff)
-	TH,	// ETC2 'T' or 'H' mode
-	Planar,	// ETC2 'Planar' mode
-};
-
 // ETC2 distance table for 'T' and 'H' modes.
 static const uint8_t etc2_dist_tbl[8] = {
 	 3,  6, 11, 16,
@@ -213,7 +109,7 @@ static const uint8_t etc2_dist_tbl[8] = {
 };
 
 // ETC2 alpha modifiers table.
-static const int8_t etc2_alpha_tbl[16][8] = {
+const int8_t etc2_alpha_tbl[16][8] = {
 	{-3, -6,  -9, -15, 2, 5, 8, 14},
 	{-3, -7, -10, -13, 2, 6, 9, 12},
 	{-2, -5,  -8, -13, 1, 4, 7, 12},
@@ -271,15 +167,6 @@ static inline uint8_t extend_7to8bits(uint8_t value)
 {
 	return (value << 1) | (value >> 6);
 }
-
-// Temporary RGB structure that allows us to clamp it later.
-// TODO: Use SSE2?
-struct ColorRGB {
-	int R;
-	int G;
-	int B;
-};
-
 /**
  * Clamp a ColorRGB struct and convert it to xRGB32.
  * @param color ColorRGB struct.
@@ -306,25 +193,15 @@ static inline uint32_t clamp_ColorRGB(const ColorRGB &color)
 	return xrgb32 | 0xFF000000;
 }
 
-// ETC decoding mode.
-enum ETC_Decoding_Mode {
-	// Bit 0: ETC1 vs. ETC2
-	ETC_DM_ETC1	= (0U << 0),	// ETC1
-	ETC_DM_ETC2	= (1U << 0),	// ETC2
-	ETC_DM_MASK12	= (1U << 0),
-
-	// Bit 1: ETC2 punchthrough alpha
-	ETC2_DM_A1	= (1U << 1),
-};
-
 /**
- * Decode an ETC1/ETC2 RGB block.
- * @param mode          [in] Mode flags.
- * @param tileBuf	[out] Destination tile buffer.
- * @param src		[in] Source RGB block.
+ * Decode the colors of an ETC1/ETC2 RGB block.
+ * The pixel indexes are not decoded.
+ * @tparam mode		[in] Mode flags. (ETC_Decoding_Mode)
+ * @param colors	[out] Block colors.
+ * @param etc1_src	[in] Source RGB block.
  */
 template</* ETC_Decoding_Mode */ unsigned int mode>
-static void decodeBlock_ETC_RGB(array<uint32_t, 4*4> &tileBuf, const etc1_block *etc1_src)
+void decodeBlockColors(BlockColors &colors, const etc1_block *etc1_src)
 {
 	// Prevent invalid combinations from being used.
 	static_assert(mode != (ETC_DM_ETC1 | ETC2_DM_A1), "Cannot use ETC1 with punchthrough alpha.");
@@ -333,16 +210,21 @@ static void decodeBlock_ETC_RGB(array<uint32_t, 4*4> &tileBuf, const etc1_block
 	// For ETC1 mode, these are used as base colors for the two subblocks.
 	// For 'T' and 'H' mode, these are used to calculate the paint colors.
 	// For 'Planar' mode, three colors are used as 'O', 'H', and 'V'.
-	ColorRGB base_color[3];
+	ColorRGB *const base_color = colors.base_color;
 
 	// 'T', 'H' modes: Paint colors are used instead of base colors.
 	// Intensity modifications are not supported, so we'll store the
 	// final xRGB32 values instead of ColorRGB.
-	uint32_t paint_color[4];
+	uint32_t *const paint_color = colors.paint_color;
 
 	// ETC2 block mode.
 	etc2_block_mode block_mode = etc2_block_mode::Unknown;
 
+	// ETC2 punchthrough alpha: The diffbit is repurposed as the opaque bit.
+	colors.transparent = ((mode & ETC2_DM_A1) && !(etc1_src->control & 0x02));
+	// control, bit 0: flip
+	colors.flip = !!(etc1_src->control & 0x01);
+
 	// TODO: Optimize the extend function by assuming the value is MSB-aligned.
 
 	// control, bit 1: diffbit
@@ -488,6 +370,41 @@ static void decodeBlock_ETC_RGB(array<uint32_t, 4*4> &tileBuf, const etc1_block
 		}
 	}
 
+	if (block_mode == etc2_block_mode::ETC1) {
+		// Intensities for the table codewords.
+		if (colors.transparent) {
+			// ETC2, punchthrough alpha: Opaque bit is unset.
+			colors.tbl[0] = etc2_intensity_a1[ etc1_src->control >> 5];
+			colors.tbl[1] = etc2_intensity_a1[(etc1_src->control >> 2) & 0x07];
+		} else {
+			// All other versions.
+			colors.tbl[0] = etc1_intensity[ etc1_src->control >> 5];
+			colors.tbl[1] = etc1_intensity[(etc1_src->control >> 2) & 0x07];
+		}
+	}
+
+	colors.block_mode = block_mode;
+}
+
+// Explicit instantiation for the decoding modes in use.
+template void decodeBlockColors<ETC_DM_ETC1>(BlockColors &colors, const etc1_block *etc1_src);
+template void decodeBlockColors<ETC_DM_ETC2>(BlockColors &colors, const etc1_block *etc1_src);
+template void decodeBlockColors<ETC_DM_ETC2 | ETC2_DM_A1>(BlockColors &colors, const etc1_block *etc1_src);
+
+/**
+ * Decode an ETC1/ETC2 RGB block.
+ * @param mode          [in] Mode flags.
+ * @param tileBuf	[out] Destination tile buffer.
+ * @param src		[in] Source RGB block.
+ */
+template</* ETC_Decoding_Mode */ unsigned int mode>
+static void decodeBlock_ETC_RGB(array<uint32_t, 4*4> &tileBuf, const etc1_block *etc1_src)
+{
+	// NOTE: Zero-initialized to silence gcc's -Wmaybe-uninitialized,
+	// since it can't tell which colors are set for each block mode.
+	BlockColors colors = {};
+	decodeBlockColors<mode>(colors, etc1_src);
+
 	// Tile arrangement:
 	// flip == 0        flip == 1
 	// a e | i m        a e   i m
@@ -497,10 +414,9 @@ static void decodeBlock_ETC_RGB(array<uint32_t, 4*4> &tileBuf, const etc1_block
 	// d h | l p        d h   l p
 
 	// Process the 16 pixel indexes.
-	// TODO: Use SSE2 for saturated arithmetic?
 	uint16_t px_msb = be16_to_cpu(etc1_src->msb);
 	uint16_t px_lsb = be16_to_cpu(etc1_src->lsb);
-	switch (block_mode) {
+	switch (colors.block_mode) {
 		default:
 			// TODO: Return an error code?
 			assert(!"Invalid ETC2 block mode.");
@@ -509,38 +425,22 @@ static void decodeBlock_ETC_RGB(array<uint32_t, 4*4> &tileBuf, const etc1_block
 
 		case etc2_block_mode::ETC1: {
 			// ETC1 block mode.
-
-			// Intensities for the table codewords.
-			const int16_t *tbl[2];
-			if ((mode & ETC2_DM_A1) && !(etc1_src->control & 0x02)) {
-				// ETC2, punchthrough alpha: Opaque bit is unset.
-				tbl[0] = etc2_intensity_a1[ etc1_src->control >> 5];
-				tbl[1] = etc2_intensity_a1[(etc1_src->control >> 2) & 0x07];
-			} else {
-				// All other versions.
-				tbl[0] = etc1_intensity[ etc1_src->control >> 5];
-				tbl[1] = etc1_intensity[(etc1_src->control >> 2) & 0x07];
-			}
-
-			// control, bit 0: flip
-			uint16_t subblock = etc1_subblock_mapping[etc1_src->control & 0x01];
+			uint16_t subblock = etc1_subblock_mapping[colors.flip];
 			for (unsigned int i = 0; i < 16; i++, px_msb >>= 1, px_lsb >>= 1, subblock >>= 1) {
 				uint32_t *const p = &tileBuf[etc1_mapping[i]];
 				const unsigned int px_idx = ((px_msb & 1) << 1) | (px_lsb & 1);
 
-				if ((mode & ETC2_DM_A1) && !(etc1_src->control & 0x02)) {
+				if (colors.transparent && px_idx == 2) {
 					// ETC2 punchthrough alpha: opaque bit is 0.
-					if (px_idx == 2) {
-						// Pixel is completely transparent.
-						*p = 0;
-						continue;
-					}
+					// Pixel is completely transparent.
+					*p = 0;
+					continue;
 				}
 
 				// Select the table codeword based on the current subblock.
 				const uint8_t cur_sub = subblock & 1;
-				const int adj = tbl[cur_sub][px_idx];
-				ColorRGB color = base_color[cur_sub];
+				const int adj = colors.tbl[cur_sub][px_idx];
+				ColorRGB color = colors.base_color[cur_sub];
 				color.R += adj;
 				color.G += adj;
 				color.B += adj;
@@ -557,17 +457,15 @@ static void decodeBlock_ETC_RGB(array<uint32_t, 4*4> &tileBuf, const etc1_block
 				uint32_t *const p = &tileBuf[etc1_mapping[i]];
 				const unsigned int px_idx = ((px_msb & 1) << 1) | (px_lsb & 1);
 
-				if ((mode & ETC2_DM_A1) && !(etc1_src->control & 0x02)) {
+				if (colors.transparent && px_idx == 2) {
 					// ETC2 punchthrough alpha: opaque bit is 0.
-					if (px_idx == 2) {
-						// Pixel is completely transparent.
-						*p = 0;
-						continue;
-					}
+					// Pixel is completely transparent.
+					*p = 0;
+					continue;
 				}
 
 				// Pixel index indicates the paint color to use.
-				*p = paint_color[px_idx];
+				*p = colors.paint_color[px_idx];
 			}
 			break;
 		}
@@ -575,6 +473,7 @@ static void decodeBlock_ETC_RGB(array<uint32_t, 4*4> &tileBuf, const etc1_block
 		case etc2_block_mode::Planar: {
 			// ETC2 'Planar' mode.
 			// Each pixel is interpolated using the three RGB676 colors.
+			const ColorRGB *const base_color = colors.base_color;
 			for (unsigned int i = 0; i < 16; i++) {
 				// NOTE: Using ETC1 pixel arrangement.
 				// Rows first, then columns.
@@ -582,7 +481,6 @@ static void decodeBlock_ETC_RGB(array<uint32_t, 4*4> &tileBuf, const etc1_block
 				const int pY = i % 4;
 
 				// Color order: 0, 1, 2 => 'O', 'H', 'V'
-				// TODO: SIMD optimization?
 				ColorRGB tmp;
 				tmp.R = ((pX * (base_color[1].R - base_color[0].R)) +
 					 (pY * (base_color[2].R - base_color[0].R)) +
@@ -602,15 +500,58 @@ static void decodeBlock_ETC_RGB(array<uint32_t, 4*4> &tileBuf, const etc1_block
 	}
 }
 
+/**
+ * Decode an ETC2 alpha block.
+ * @param tileBuf	[out] Destination tile buffer.
+ * @param src		[in] Source alpha block.
+ */
+static void decodeBlock_ETC2_alpha(array<uint32_t, 4*4> &tileBuf, const etc2_alpha *alpha)
+{
+	// argb32_t for alpha channel handling.
+	argb32_t *const pArgb = reinterpret_cast<argb32_t*>(tileBuf.data());
+
+	// Get the base codeword and multiplier.
+	// NOTE: mult == 0 is not allowed to be used by the encoder,
+	// but the specification requires decoders to handle it.
+	const uint8_t base = alpha->base_codeword;
+	const uint8_t mult = (alpha->mult_tbl_idx >> 4);
+
+	// Table pointer.
+	const int8_t *const tbl = etc2_alpha_tbl[alpha->mult_tbl_idx & 0x0F];
+
+	// TODO: Zero out the alpha channel in the entire tile using SIMD.
+
+	// Pixel index.
+	uint64_t alpha48 = extract48(alpha);
+
+	// NOTE: alpha is stored *backwards*.
+	// TODO: Optimize to eliminate double-shifting.
+	for (unsigned int i = 0; i < 16; i++, alpha48 <<= 3) {
+		// Calculate the alpha value for this pixel.
+		int A = base + (tbl[(alpha48 >> 45) & 0x07] * mult);
+		if (A > 255) {
+			A = 255;
+		} else if (A < 0) {
+			A = 0;
+		}
+
+		// Set the new alpha value.
+		pArgb[etc1_mapping[i]].a = static_cast<uint8_t>(A);
+	}
+}
+
+}
+
 /**
  * Convert an ETC1 image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf ETC1 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromETC1(int width, int height,
+rp_image *fromETC1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -638,23 +579,28 @@ rp_image *fromETC1(int width, int height,
 		return nullptr;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
-
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
 
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
+	ImageDecoderPrivate::decodeTileRows(img, tilesY,
+		[img, img_buf, tilesX](unsigned int yStart, unsigned int yEnd)
+	{
+		const ETC::etc1_block *etc1_src = reinterpret_cast<const ETC::etc1_block*>(img_buf) +
+			(static_cast<size_t>(yStart) * tilesX);
+
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
 
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
-		// Decode the ETC1 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC1>(tileBuf, etc1_src);
+		for (unsigned int y = yStart; y < yEnd; y++) {
+		for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
+			// Decode the ETC1 RGB block.
+			ETC::decodeBlock_ETC_RGB<ETC::ETC_DM_ETC1>(tileBuf, etc1_src);
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
-	} }
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
+		} }
+	});
 
 	// Set the sBIT metadata.
 	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
@@ -666,13 +612,14 @@ rp_image *fromETC1(int width, int height,
 
 /**
  * Convert an ETC2 RGB image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf ETC2 RGB image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromETC2_RGB(int width, int height,
+rp_image *fromETC2_RGB_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -700,23 +647,28 @@ rp_image *fromETC2_RGB(int width, int height,
 		return nullptr;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
-
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
 
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
+	ImageDecoderPrivate::decodeTileRows(img, tilesY,
+		[img, img_buf, tilesX](unsigned int yStart, unsigned int yEnd)
+	{
+		const ETC::etc1_block *etc1_src = reinterpret_cast<const ETC::etc1_block*>(img_buf) +
+			(static_cast<size_t>(yStart) * tilesX);
+
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
 
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
-		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, etc1_src);
+		for (unsigned int y = yStart; y < yEnd; y++) {
+		for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
+			// Decode the ETC2 RGB block.
+			ETC::decodeBlock_ETC_RGB<ETC::ETC_DM_ETC2>(tileBuf, etc1_src);
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
-	} }
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
+		} }
+	});
 
 	// Set the sBIT metadata.
 	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
@@ -726,55 +678,16 @@ rp_image *fromETC2_RGB(int width, int height,
 	return img;
 }
 
-/**
- * Decode an ETC2 alpha block.
- * @param tileBuf	[out] Destination tile buffer.
- * @param src		[in] Source alpha block.
- */
-static void decodeBlock_ETC2_alpha(array<uint32_t, 4*4> &tileBuf, const etc2_alpha *alpha)
-{
-	// argb32_t for alpha channel handling.
-	argb32_t *const pArgb = reinterpret_cast<argb32_t*>(tileBuf.data());
-
-	// Get the base codeword and multiplier.
-	// NOTE: mult == 0 is not allowed to be used by the encoder,
-	// but the specification requires decoders to handle it.
-	const uint8_t base = alpha->base_codeword;
-	const uint8_t mult = (alpha->mult_tbl_idx >> 4);
-
-	// Table pointer.
-	const int8_t *const tbl = etc2_alpha_tbl[alpha->mult_tbl_idx & 0x0F];
-
-	// TODO: Zero out the alpha channel in the entire tile using SIMD.
-
-	// Pixel index.
-	uint64_t alpha48 = extract48(alpha);
-
-	// NOTE: alpha is stored *backwards*.
-	// TODO: Optimize to eliminate double-shifting.
-	for (unsigned int i = 0; i < 16; i++, alpha48 <<= 3) {
-		// Calculate the alpha value for this pixel.
-		int A = base + (tbl[(alpha48 >> 45) & 0x07] * mult);
-		if (A > 255) {
-			A = 255;
-		} else if (A < 0) {
-			A = 0;
-		}
-
-		// Set the new alpha value.
-		pArgb[etc1_mapping[i]].a = static_cast<uint8_t>(A);
-	}
-}
-
 /**
  * Convert an ETC2 RGBA image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf ETC2 RGBA image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromETC2_RGBA(int width, int height,
+rp_image *fromETC2_RGBA_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -802,27 +715,32 @@ rp_image *fromETC2_RGBA(int width, int height,
 		return nullptr;
 	}
 
-	const etc2_rgba_block *etc2_src = reinterpret_cast<const etc2_rgba_block*>(img_buf);
-
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
 
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
+	ImageDecoderPrivate::decodeTileRows(img, tilesY,
+		[img, img_buf, tilesX](unsigned int yStart, unsigned int yEnd)
+	{
+		const ETC::etc2_rgba_block *etc2_src = reinterpret_cast<const ETC::etc2_rgba_block*>(img_buf) +
+			(static_cast<size_t>(yStart) * tilesX);
+
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
 
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc2_src++) {
-		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, &etc2_src->etc1);
+		for (unsigned int y = yStart; y < yEnd; y++) {
+		for (unsigned int x = 0; x < tilesX; x++, etc2_src++) {
+			// Decode the ETC2 RGB block.
+			ETC::decodeBlock_ETC_RGB<ETC::ETC_DM_ETC2>(tileBuf, &etc2_src->etc1);
 
-		// Decode the ETC2 alpha block.
-		// TODO: Don't fill in the alpha channel in decodeBlock_ETC2_RGB()?
-		decodeBlock_ETC2_alpha(tileBuf, &etc2_src->alpha);
+			// Decode the ETC2 alpha block.
+			// TODO: Don't fill in the alpha channel in decodeBlock_ETC2_RGB()?
+			ETC::decodeBlock_ETC2_alpha(tileBuf, &etc2_src->alpha);
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
-	} }
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
+		} }
+	});
 
 	// Set the sBIT metadata.
 	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
@@ -834,13 +752,14 @@ rp_image *fromETC2_RGBA(int width, int height,
 
 /**
  * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * Standard version using regular C++ code.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf ETC2 RGB+A1 image buffer.
  * @param img_siz Size of image data. [must be >= (w*h)/2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromETC2_RGB_A1(int width, int height,
+rp_image *fromETC2_RGB_A1_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz)
 {
 	// Verify parameters.
@@ -868,23 +787,28 @@ rp_image *fromETC2_RGB_A1(int width, int height,
 		return nullptr;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
-
 	// Calculate the total number of tiles.
 	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
 
-	// Temporary tile buffer.
-	array<uint32_t, 4*4> tileBuf;
+	ImageDecoderPrivate::decodeTileRows(img, tilesY,
+		[img, img_buf, tilesX](unsigned int yStart, unsigned int yEnd)
+	{
+		const ETC::etc1_block *etc1_src = reinterpret_cast<const ETC::etc1_block*>(img_buf) +
+			(static_cast<size_t>(yStart) * tilesX);
+
+		// Temporary tile buffer.
+		array<uint32_t, 4*4> tileBuf;
 
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
-		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2 | ETC2_DM_A1>(tileBuf, etc1_src);
+		for (unsigned int y = yStart; y < yEnd; y++) {
+		for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
+			// Decode the ETC2 RGB block.
+			ETC::decodeBlock_ETC_RGB<ETC::ETC_DM_ETC2 | ETC::ETC2_DM_A1>(tileBuf, etc1_src);
 
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
-	} }
+			// Blit the tile to the main image buffer.
+			ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
+		} }
+	});
 
 	// Set the sBIT metadata.
 	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
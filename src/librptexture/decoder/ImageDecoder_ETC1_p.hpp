@@ -0,0 +1,185 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_ETC1_p.hpp: Image decoding functions. (ETC1) (PRIVATE)     *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_ETC1_P_HPP__
+#define __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_ETC1_P_HPP__
+
+#include "common.h"
+#include "librpcpu/byteswap_rp.h"
+
+// Shared between the standard and SIMD-optimized ETC1/ETC2 decoders.
+namespace LibRpTexture { namespace ImageDecoder { namespace ETC {
+
+// ETC1 block format.
+// NOTE: Layout maps to on-disk format, which is big-endian.
+typedef union _etc1_block {
+	struct {
+		// Base colors
+		// Byte layout:
+		// - diffbit == 0: 4 MSB == base 1, 4 LSB == base 2
+		// - diffbit == 1: 5 MSB == base, 3 LSB == differential
+		// Some compilers pad this structure to a multiple of 4 bytes
+#pragma pack(1)
+		union PACKED {
+			// Indiv/Diff
+			struct PACKED {
+				uint8_t R;
+				uint8_t G;
+				uint8_t B;
+			} id;
+
+			// ETC2 'T' mode
+			struct PACKED {
+				uint8_t R1;
+				uint8_t G1B1;
+				uint8_t R2G2;
+				// B2 is in `control`.
+			} t;
+
+			// ETC2 'H' mode
+			struct PACKED {
+				uint8_t R1G1a;
+				uint8_t G1bB1aB1b;
+				uint8_t B1bR2G2;
+				// Part of G2 is in `control`.
+				// B2 is in `control`.
+			} h;
+		};
+#pragma pack()
+
+		// Control byte: [ETC1]
+		// - 3 MSB:  table code word 1
+		// - 3 next: table code word 2
+		// - 1 bit:  diff bit
+		// - 1 LSB:  flip bit
+		uint8_t control;
+
+		// Pixel index bits. (big-endian)
+		uint16_t msb;
+		uint16_t lsb;
+	};
+
+	struct {
+		// Planar mode has 3 colors in RGB676 format.
+		// Colors are labelled 'O', 'H', and 'V'.
+		uint8_t RO_GO1;		// 6-1: RO;     0: GO1
+		uint8_t GO2_BO1;	// 6-1: GO2;    0: BO1
+		uint8_t BO2_BO3;	// 4-3: BO2;  1-0: BO3a
+		uint8_t BO3_RH;		//   7: BO3b; 6-2: RH1; 0: RH2
+		uint8_t GH_BH;		// 7-1: GH;     0: BH
+		uint8_t BH_RV;		// 7-3: BH;   2-0: RV
+		uint8_t RV_GV;		// 7-5: RV;   4-0: GV
+		uint8_t GV_BV;		// 7-6: GV;   5-0: BV
+	} planar;
+} etc1_block;
+ASSERT_STRUCT(etc1_block, sizeof(uint64_t));
+
+// ETC2 alpha block format.
+// NOTE: Layout maps to on-disk format, which is big-endian.
+typedef union _etc2_alpha {
+	struct {
+		uint8_t base_codeword;	// Base codeword.
+		uint8_t mult_tbl_idx;	// Multiplier (high 4); table index (low 4)
+		uint8_t values[6];	// Alpha values. (48-bit unsigned; 3-bit per pixel)
+	};
+	uint64_t u64;				// Access the 48-bit alpha value directly. (Requires shifting.)
+} etc2_alpha;
+ASSERT_STRUCT(etc2_alpha, sizeof(uint64_t));
+
+// ETC2 RGBA block format.
+// NOTE: Layout maps to on-disk format, which is big-endian.
+typedef struct _etc2_rgba_block {
+	etc2_alpha alpha;
+	etc1_block etc1;
+} etc2_rgba_block;
+ASSERT_STRUCT(etc2_rgba_block, 16);
+
+/**
+ * Extract the 48-bit code value from etc2_alpha.
+ * @param data etc2_alpha.
+ * @return 48-bit code value.
+ */
+static FORCEINLINE uint64_t extract48(const etc2_alpha *RESTRICT data)
+{
+	// values[6] starts at 0x02 within etc2_alpha.
+	// Hence, we need to mask it after byteswapping.
+	// TODO: constexpr?
+	// TODO: Verify on big-endian.
+	return be64_to_cpu(data->u64) & 0x0000FFFFFFFFFFFFULL;
+}
+
+// Intensity modifier sets.
+extern const int16_t etc1_intensity[8][4];
+// Intensity modifier sets. (ETC2 with punchthrough alpha if opaque == 0)
+extern const int16_t etc2_intensity_a1[8][4];
+// ETC2 alpha modifiers table.
+extern const int8_t etc2_alpha_tbl[16][8];
+
+// ETC decoding mode.
+enum ETC_Decoding_Mode {
+	// Bit 0: ETC1 vs. ETC2
+	ETC_DM_ETC1	= (0U << 0),	// ETC1
+	ETC_DM_ETC2	= (1U << 0),	// ETC2
+	ETC_DM_MASK12	= (1U << 0),
+
+	// Bit 1: ETC2 punchthrough alpha
+	ETC2_DM_A1	= (1U << 1),
+};
+
+// ETC2 block mode.
+enum class etc2_block_mode {
+	Unknown = 0,
+	ETC1,	// ETC1-compatible mode (indiv, diff)
+	TH,	// ETC2 'T' or 'H' mode
+	Planar,	// ETC2 'Planar' mode
+};
+
+// Temporary RGB structure that allows us to clamp it later.
+struct ColorRGB {
+	int R;
+	int G;
+	int B;
+};
+
+// Decoded colors for an ETC1/ETC2 RGB block.
+struct BlockColors {
+	etc2_block_mode block_mode;
+
+	// ETC2 punchthrough alpha: If the opaque bit is unset,
+	// pixels with index 2 are completely transparent.
+	bool transparent;
+
+	// ETC1 mode: flip bit
+	// - false: 2x4 subblocks
+	// - true:  4x2 subblocks
+	bool flip;
+
+	// ETC1 mode: Base colors for the two subblocks.
+	// 'Planar' mode: 'O', 'H', and 'V' colors.
+	ColorRGB base_color[3];
+
+	// ETC1 mode: Intensity modifiers for the two subblocks.
+	const int16_t *tbl[2];
+
+	// 'T', 'H' modes: Paint colors. (xRGB32)
+	uint32_t paint_color[4];
+};
+
+/**
+ * Decode the colors of an ETC1/ETC2 RGB block.
+ * The pixel indexes are not decoded.
+ * @tparam mode		[in] Mode flags. (ETC_Decoding_Mode)
+ * @param colors	[out] Block colors.
+ * @param etc1_src	[in] Source RGB block.
+ */
+template</* ETC_Decoding_Mode */ unsigned int mode>
+void decodeBlockColors(BlockColors &colors, const etc1_block *etc1_src);
+
+} } }
+
+#endif /* __ROMPROPERTIES_LIBRPTEXTURE_DECODER_IMAGEDECODER_ETC1_P_HPP__ */
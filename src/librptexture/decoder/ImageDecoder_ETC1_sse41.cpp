@@ -0,0 +1,361 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_ETC1_sse41.cpp: Image decoding functions. (ETC1)           *
+ * SSE4.1-optimized version.                                               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+#include "ImageDecoder_ETC1_p.hpp"
+
+// SSE4.1 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <smmintrin.h>
+
+// References:
+// - https://www.khronos.org/registry/OpenGL/extensions/OES/OES_compressed_ETC1_RGB8_texture.txt
+// - https://www.khronos.org/registry/DataFormat/specs/1.1/dataformat.1.1.html#ETC1
+// - https://www.khronos.org/registry/DataFormat/specs/1.1/dataformat.1.1.html#ETC2
+
+// Block colors are decoded using the standard ETC::decodeBlockColors().
+// The intensity modifiers, clamping, and per-pixel palette lookups are
+// done here using SSE4.1, one row of four pixels at a time.
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Get the pixel indexes of an ETC1/ETC2 RGB block.
+ * ETC arranges pixels by column, then by row; the indexes
+ * returned here are in linear order. (row, then column)
+ * @param etc1_src	[in] Source RGB block.
+ * @return Pixel indexes, multiplied by 4. (one byte per pixel)
+ */
+static FORCEINLINE __m128i getPixelIndexes(const ETC::etc1_block *etc1_src)
+{
+	// Bytes 0-1: MSBs; bytes 2-3: LSBs
+	const uint32_t px = static_cast<uint32_t>(be16_to_cpu(etc1_src->msb)) |
+			   (static_cast<uint32_t>(be16_to_cpu(etc1_src->lsb)) << 16);
+	const __m128i px_bits = _mm_cvtsi32_si128(static_cast<int>(px));
+
+	// Pixel (row, col) is ETC pixel (col*4 + row), which is
+	// located in byte (col / 2), bit ((col % 2) * 4 + row).
+	const __m128i shuf_msb = _mm_setr_epi8(0,0,1,1, 0,0,1,1, 0,0,1,1, 0,0,1,1);
+	const __m128i shuf_lsb = _mm_setr_epi8(2,2,3,3, 2,2,3,3, 2,2,3,3, 2,2,3,3);
+	const __m128i bitmask = _mm_setr_epi8(
+		0x01, 0x10, 0x01, 0x10,
+		0x02, 0x20, 0x02, 0x20,
+		0x04, 0x40, 0x04, 0x40,
+		0x08, (char)0x80, 0x08, (char)0x80);
+
+	const __m128i msb = _mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(px_bits, shuf_msb), bitmask), bitmask);
+	const __m128i lsb = _mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(px_bits, shuf_lsb), bitmask), bitmask);
+
+	// Pixel index: (msb << 1) | lsb; multiplied by 4 for palette lookups.
+	return _mm_or_si128(_mm_and_si128(msb, _mm_set1_epi8(8)), _mm_and_si128(lsb, _mm_set1_epi8(4)));
+}
+
+/**
+ * Decode an ETC1/ETC2 RGB block.
+ * @tparam mode		[in] Mode flags. (ETC_Decoding_Mode)
+ * @param rows		[out] Decoded rows. (4 pixels per row)
+ * @param etc1_src	[in] Source RGB block.
+ */
+template</* ETC_Decoding_Mode */ unsigned int mode>
+static inline void decodeBlock_ETC_RGB_sse41(__m128i rows[4], const ETC::etc1_block *etc1_src)
+{
+	ETC::BlockColors colors;
+	ETC::decodeBlockColors<mode>(colors, etc1_src);
+
+	// Palettes for the left/top and right/bottom halves of the block.
+	__m128i pal[2];
+
+	switch (colors.block_mode) {
+		default:
+			// TODO: Return an error code?
+			assert(!"Invalid ETC2 block mode.");
+			rows[0] = rows[1] = rows[2] = rows[3] = _mm_setzero_si128();
+			return;
+
+		case ETC::etc2_block_mode::ETC1: {
+			// ETC1 block mode.
+			// Each subblock has four colors: base color + intensity modifier.
+			// The modifier is broadcast to B, G, and R, and packus clamps to [0,255].
+			const __m128i shuf_adj01 = _mm_setr_epi8(0,1,0,1,0,1,-1,-1, 2,3,2,3,2,3,-1,-1);
+			const __m128i shuf_adj23 = _mm_setr_epi8(4,5,4,5,4,5,-1,-1, 6,7,6,7,6,7,-1,-1);
+			for (unsigned int s = 0; s < 2; s++) {
+				const ETC::ColorRGB &bc = colors.base_color[s];
+				const __m128i base = _mm_setr_epi16(bc.B, bc.G, bc.R, 255, bc.B, bc.G, bc.R, 255);
+				const __m128i tbl = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(colors.tbl[s]));
+				const __m128i c01 = _mm_add_epi16(base, _mm_shuffle_epi8(tbl, shuf_adj01));
+				const __m128i c23 = _mm_add_epi16(base, _mm_shuffle_epi8(tbl, shuf_adj23));
+				pal[s] = _mm_packus_epi16(c01, c23);
+			}
+			break;
+		}
+
+		case ETC::etc2_block_mode::TH:
+			// ETC2 'T' or 'H' mode.
+			// Pixel index indicates the paint color to use.
+			pal[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors.paint_color));
+			pal[1] = pal[0];
+			break;
+
+		case ETC::etc2_block_mode::Planar: {
+			// ETC2 'Planar' mode.
+			// Each pixel is interpolated using the three RGB676 colors:
+			// ((col * (H - O)) + (row * (V - O)) + (4 * O) + 2) >> 2
+			// Alpha is 1020 in 'O', and 0 in the deltas, so it ends up as 255.
+			const ETC::ColorRGB *const bc = colors.base_color;
+			const __m128i dH = _mm_setr_epi16(
+				bc[1].B - bc[0].B, bc[1].G - bc[0].G, bc[1].R - bc[0].R, 0,
+				bc[1].B - bc[0].B, bc[1].G - bc[0].G, bc[1].R - bc[0].R, 0);
+			const __m128i dV = _mm_setr_epi16(
+				bc[2].B - bc[0].B, bc[2].G - bc[0].G, bc[2].R - bc[0].R, 0,
+				bc[2].B - bc[0].B, bc[2].G - bc[0].G, bc[2].R - bc[0].R, 0);
+
+			// Column deltas: [0, dH] and [2*dH, 3*dH]
+			const __m128i col01 = _mm_blend_epi16(_mm_setzero_si128(), dH, 0xF0);
+			const __m128i col23 = _mm_add_epi16(_mm_add_epi16(dH, dH), col01);
+
+			__m128i row_base = _mm_setr_epi16(
+				(4 * bc[0].B) + 2, (4 * bc[0].G) + 2, (4 * bc[0].R) + 2, 1020,
+				(4 * bc[0].B) + 2, (4 * bc[0].G) + 2, (4 * bc[0].R) + 2, 1020);
+			for (unsigned int r = 0; r < 4; r++, row_base = _mm_add_epi16(row_base, dV)) {
+				const __m128i px01 = _mm_srai_epi16(_mm_add_epi16(row_base, col01), 2);
+				const __m128i px23 = _mm_srai_epi16(_mm_add_epi16(row_base, col23), 2);
+				rows[r] = _mm_packus_epi16(px01, px23);
+			}
+			return;
+		}
+	}
+
+	if ((mode & ETC::ETC2_DM_A1) && colors.transparent) {
+		// ETC2 punchthrough alpha: opaque bit is 0.
+		// Pixels with index 2 are completely transparent.
+		pal[0] = _mm_insert_epi32(pal[0], 0, 2);
+		pal[1] = _mm_insert_epi32(pal[1], 0, 2);
+	}
+
+	// Palette lookup.
+	// Each pixel index (multiplied by 4) is expanded to the four bytes
+	// of its row's dword, then offset by the byte position within the dword.
+	const __m128i px_idx = getPixelIndexes(etc1_src);
+	const __m128i byte_offset = _mm_setr_epi8(0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3);
+	__m128i shuf_row = _mm_setr_epi8(0,0,0,0, 1,1,1,1, 2,2,2,2, 3,3,3,3);
+	const __m128i shuf_row_inc = _mm_set1_epi8(4);
+
+	// Tile arrangement:
+	// flip == 0        flip == 1
+	// a e | i m        a e   i m
+	// b f | j n        b f   j n
+	//     |            ---------
+	// c g | k o        c g   k o
+	// d h | l p        d h   l p
+	// NOTE: 'T' and 'H' modes have identical palettes for both halves.
+	for (unsigned int r = 0; r < 4; r++, shuf_row = _mm_add_epi8(shuf_row, shuf_row_inc)) {
+		const __m128i shuf_pal = _mm_or_si128(_mm_shuffle_epi8(px_idx, shuf_row), byte_offset);
+		if (colors.flip) {
+			// 4x2 subblocks: top half uses pal[0]; bottom half uses pal[1].
+			rows[r] = _mm_shuffle_epi8(pal[r >> 1], shuf_pal);
+		} else {
+			// 2x4 subblocks: left half uses pal[0]; right half uses pal[1].
+			rows[r] = _mm_blend_epi16(
+				_mm_shuffle_epi8(pal[0], shuf_pal),
+				_mm_shuffle_epi8(pal[1], shuf_pal), 0xF0);
+		}
+	}
+}
+
+/**
+ * Decode an ETC2 alpha block.
+ * The alpha channel of the decoded rows is replaced.
+ * @param rows		[in/out] Decoded rows. (4 pixels per row)
+ * @param alpha		[in] Source alpha block.
+ */
+static inline void decodeBlock_ETC2_alpha_sse41(__m128i rows[4], const ETC::etc2_alpha *alpha)
+{
+	// Get the base codeword and multiplier.
+	// NOTE: mult == 0 is not allowed to be used by the encoder,
+	// but the specification requires decoders to handle it.
+	const uint8_t base = alpha->base_codeword;
+	const uint8_t mult = (alpha->mult_tbl_idx >> 4);
+
+	// Alpha palette: base + (tbl[n] * mult), clamped to [0,255].
+	const __m128i tbl = _mm_cvtepi8_epi16(_mm_loadl_epi64(
+		reinterpret_cast<const __m128i*>(ETC::etc2_alpha_tbl[alpha->mult_tbl_idx & 0x0F])));
+	__m128i apal = _mm_add_epi16(_mm_mullo_epi16(tbl, _mm_set1_epi16(mult)), _mm_set1_epi16(base));
+	apal = _mm_packus_epi16(apal, apal);
+
+	// Pixel indexes. (3-bit, stored *backwards*)
+	// Rearrange them from ETC order to linear order.
+	ALIGNED_VAR(16, uint8_t a_idx[16]);
+	uint64_t alpha48 = ETC::extract48(alpha);
+	for (unsigned int i = 0; i < 16; i++, alpha48 <<= 3) {
+		a_idx[((i & 3) << 2) | (i >> 2)] = (alpha48 >> 45) & 0x07;
+	}
+	const __m128i a_px = _mm_shuffle_epi8(apal, _mm_load_si128(reinterpret_cast<const __m128i*>(a_idx)));
+
+	// Move the alpha values into the alpha channel of each row.
+	const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+	__m128i shuf_row = _mm_setr_epi8(-1,-1,-1,0, -1,-1,-1,1, -1,-1,-1,2, -1,-1,-1,3);
+	const __m128i shuf_row_inc = _mm_set1_epi32(4 << 24);
+	for (unsigned int r = 0; r < 4; r++, shuf_row = _mm_add_epi32(shuf_row, shuf_row_inc)) {
+		rows[r] = _mm_or_si128(_mm_and_si128(rows[r], rgb_mask), _mm_shuffle_epi8(a_px, shuf_row));
+	}
+}
+
+/**
+ * Convert an ETC1/ETC2 image to rp_image.
+ * @tparam mode		[in] Mode flags. (ETC_Decoding_Mode)
+ * @tparam hasAlpha	[in] If true, each block has an ETC2 alpha block. (ETC2 RGBA)
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC image buffer.
+ * @param img_siz Size of image data.
+ * @param sBIT sBIT metadata.
+ * @return rp_image, or nullptr on error.
+ */
+template</* ETC_Decoding_Mode */ unsigned int mode, bool hasAlpha>
+static rp_image *T_fromETC_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	const rp_image::sBIT_t *sBIT)
+{
+	// Verify parameters.
+	// NOTE: ETC2 RGBA uses 16 bytes per block; others use 8 bytes.
+	static const int bytesPerBlock = (hasAlpha ? 16 : 8);
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) / 16 * bytesPerBlock));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) / 16 * bytesPerBlock))
+	{
+		return nullptr;
+	}
+
+	// ETC uses 4x4 tiles.
+	assert(width % 4 == 0);
+	assert(height % 4 == 0);
+	if (width % 4 != 0 || height % 4 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
+
+	uint32_t *const pImgBuf = static_cast<uint32_t*>(img->bits());
+	const int stride_px = img->stride() / sizeof(uint32_t);
+
+	ImageDecoderPrivate::decodeTileRows(img, tilesY,
+		[img_buf, tilesX, pImgBuf, stride_px](unsigned int yStart, unsigned int yEnd)
+	{
+		const uint8_t *pSrc = img_buf + (static_cast<size_t>(yStart) * tilesX * bytesPerBlock);
+		__m128i rows[4];
+
+		for (unsigned int y = yStart; y < yEnd; y++) {
+			uint32_t *pDest = pImgBuf + (y * 4 * stride_px);
+			for (unsigned int x = 0; x < tilesX; x++, pSrc += bytesPerBlock, pDest += 4) {
+				if (hasAlpha) {
+					const ETC::etc2_rgba_block *const etc2_src =
+						reinterpret_cast<const ETC::etc2_rgba_block*>(pSrc);
+					decodeBlock_ETC_RGB_sse41<mode>(rows, &etc2_src->etc1);
+					decodeBlock_ETC2_alpha_sse41(rows, &etc2_src->alpha);
+				} else {
+					decodeBlock_ETC_RGB_sse41<mode>(rows,
+						reinterpret_cast<const ETC::etc1_block*>(pSrc));
+				}
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), rows[0]);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + stride_px), rows[1]);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + stride_px*2), rows[2]);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + stride_px*3), rows[3]);
+			}
+		}
+	});
+
+	// Set the sBIT metadata.
+	img->set_sBIT(sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert an ETC1 image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC1_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
+	return T_fromETC_sse41<ETC::ETC_DM_ETC1, false>(width, height, img_buf, img_siz, &sBIT);
+}
+
+/**
+ * Convert an ETC2 RGB image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC2_RGB_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
+	return T_fromETC_sse41<ETC::ETC_DM_ETC2, false>(width, height, img_buf, img_siz, &sBIT);
+}
+
+/**
+ * Convert an ETC2 RGBA image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGBA image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC2_RGBA_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+	return T_fromETC_sse41<ETC::ETC_DM_ETC2, true>(width, height, img_buf, img_siz, &sBIT);
+}
+
+/**
+ * Convert an ETC2 RGB+A1 (punchthrough alpha) image to rp_image.
+ * SSE4.1-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf ETC2 RGB+A1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromETC2_RGB_A1_sse41(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	return T_fromETC_sse41<ETC::ETC_DM_ETC2 | ETC::ETC2_DM_A1, false>(width, height, img_buf, img_siz, &sBIT);
+}
+
+} }
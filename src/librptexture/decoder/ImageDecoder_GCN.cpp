@@ -20,6 +20,7 @@ namespace LibRpTexture { namespace ImageDecoder {
 
 /**
  * Convert a GameCube 16-bit image to rp_image.
+ * Standard version using regular C++ code.
  * @param px_format 16-bit pixel format.
  * @param width Image width.
  * @param height Image height.
@@ -27,7 +28,7 @@ namespace LibRpTexture { namespace ImageDecoder {
  * @param img_siz Size of image data. [must be >= (w*h)*2]
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromGcn16(PixelFormat px_format,
+rp_image *fromGcn16_cpp(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *RESTRICT img_buf, int img_siz)
 {
@@ -63,15 +64,27 @@ rp_image *fromGcn16(PixelFormat px_format,
 	// Temporary tile buffer.
 	array<uint32_t, 4*4> tileBuf;
 
+	// Large images use a lookup table, since RGB5A3 and RGB565
+	// need a lot of arithmetic for each pixel.
+	const bool useLut = (static_cast<unsigned int>(width * height) >= LUT16_MIN_PIXELS);
+
 	switch (px_format) {
 		case PixelFormat::RGB5A3: {
+			const uint32_t *const lut = (useLut ? getLut16(Lut16::RGB5A3) : nullptr);
 			for (unsigned int y = 0; y < tilesY; y++) {
 				for (unsigned int x = 0; x < tilesX; x++) {
 					// Convert each tile to ARGB32 manually.
 					// TODO: Optimize using pointers instead of indexes?
-					for (unsigned int i = 0; i < 4*4; i += 2, img_buf += 2) {
-						tileBuf[i+0] = RGB5A3_to_ARGB32(be16_to_cpu(img_buf[0]));
-						tileBuf[i+1] = RGB5A3_to_ARGB32(be16_to_cpu(img_buf[1]));
+					if (lut) {
+						for (unsigned int i = 0; i < 4*4; i += 2, img_buf += 2) {
+							tileBuf[i+0] = lut[be16_to_cpu(img_buf[0])];
+							tileBuf[i+1] = lut[be16_to_cpu(img_buf[1])];
+						}
+					} else {
+						for (unsigned int i = 0; i < 4*4; i += 2, img_buf += 2) {
+							tileBuf[i+0] = RGB5A3_to_ARGB32(be16_to_cpu(img_buf[0]));
+							tileBuf[i+1] = RGB5A3_to_ARGB32(be16_to_cpu(img_buf[1]));
+						}
 					}
 
 					// Blit the tile to the main image buffer.
@@ -88,13 +101,21 @@ rp_image *fromGcn16(PixelFormat px_format,
 		}
 
 		case PixelFormat::RGB565: {
+			const uint32_t *const lut = (useLut ? getLut16(Lut16::RGB565) : nullptr);
 			for (unsigned int y = 0; y < tilesY; y++) {
 				for (unsigned int x = 0; x < tilesX; x++) {
 					// Convert each tile to ARGB32 manually.
 					// TODO: Optimize using pointers instead of indexes?
-					for (unsigned int i = 0; i < 4*4; i += 2, img_buf += 2) {
-						tileBuf[i+0] = RGB565_to_ARGB32(be16_to_cpu(img_buf[0]));
-						tileBuf[i+1] = RGB565_to_ARGB32(be16_to_cpu(img_buf[1]));
+					if (lut) {
+						for (unsigned int i = 0; i < 4*4; i += 2, img_buf += 2) {
+							tileBuf[i+0] = lut[be16_to_cpu(img_buf[0])];
+							tileBuf[i+1] = lut[be16_to_cpu(img_buf[1])];
+						}
+					} else {
+						for (unsigned int i = 0; i < 4*4; i += 2, img_buf += 2) {
+							tileBuf[i+0] = RGB565_to_ARGB32(be16_to_cpu(img_buf[0]));
+							tileBuf[i+1] = RGB565_to_ARGB32(be16_to_cpu(img_buf[1]));
+						}
 					}
 
 					// Blit the tile to the main image buffer.
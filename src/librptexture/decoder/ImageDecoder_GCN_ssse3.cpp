@@ -0,0 +1,259 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_GCN.cpp: Image decoding functions. (GameCube)              *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSSE3 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Combine BG and RA words into two rows of ARGB32 pixels.
+ * @param bg	[in] 16-bit words: B (low byte), G (high byte)
+ * @param ra	[in] 16-bit words: R (low byte), A (high byte)
+ * @param px0	[out] First tile row. (pixels 0-3)
+ * @param px1	[out] Second tile row. (pixels 4-7)
+ */
+static FORCEINLINE void combine_BG_RA(__m128i bg, __m128i ra, __m128i &px0, __m128i &px1)
+{
+	px0 = _mm_unpacklo_epi16(bg, ra);
+	px1 = _mm_unpackhi_epi16(bg, ra);
+}
+
+/**
+ * Convert two tile rows of RGB5A3 pixels to ARGB32.
+ * @param src	[in] 8 RGB5A3 pixels. (big-endian)
+ * @param px0	[out] First tile row.
+ * @param px1	[out] Second tile row.
+ */
+static FORCEINLINE void RGB5A3_to_ARGB32_ssse3(__m128i src, __m128i &px0, __m128i &px1)
+{
+	const __m128i shuf_bswap16 = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+	// 3-bit alpha expansion. (Same values as a3_lookup[].)
+	const __m128i a3_lut = _mm_setr_epi8(0x00,0x24,0x49,0x6D,0x92,0xB6,0xDB,0xFF, 0,0,0,0,0,0,0,0);
+	const __m128i mask_F8 = _mm_set1_epi16(0x00F8);
+	const __m128i mask_0F = _mm_set1_epi16(0x000F);
+	const __m128i mask_07 = _mm_set1_epi16(0x0007);
+	const __m128i alpha_FF = _mm_set1_epi16(0xFF00);
+
+	const __m128i px = _mm_shuffle_epi8(src, shuf_bswap16);
+	// High bit set: RGB555. High bit clear: RGB4A3.
+	const __m128i is555 = _mm_srai_epi16(px, 15);
+
+	// RGB555: xRRRRRGG GGGBBBBB
+	__m128i b5 = _mm_and_si128(_mm_slli_epi16(px, 3), mask_F8);
+	__m128i g5 = _mm_and_si128(_mm_srli_epi16(px, 2), mask_F8);
+	__m128i r5 = _mm_and_si128(_mm_srli_epi16(px, 7), mask_F8);
+	b5 = _mm_or_si128(b5, _mm_srli_epi16(b5, 5));
+	g5 = _mm_or_si128(g5, _mm_srli_epi16(g5, 5));
+	r5 = _mm_or_si128(r5, _mm_srli_epi16(r5, 5));
+	const __m128i bg555 = _mm_or_si128(b5, _mm_slli_epi16(g5, 8));
+	const __m128i ra555 = _mm_or_si128(r5, alpha_FF);
+
+	// RGB4A3: xAAARRRR GGGGBBBB
+	__m128i b4 = _mm_and_si128(px, mask_0F);
+	__m128i g4 = _mm_and_si128(_mm_srli_epi16(px, 4), mask_0F);
+	__m128i r4 = _mm_and_si128(_mm_srli_epi16(px, 8), mask_0F);
+	b4 = _mm_or_si128(b4, _mm_slli_epi16(b4, 4));
+	g4 = _mm_or_si128(g4, _mm_slli_epi16(g4, 4));
+	r4 = _mm_or_si128(r4, _mm_slli_epi16(r4, 4));
+	// The high byte of each index word is 0, so the alpha
+	// lookup leaves it as 0.
+	const __m128i a3 = _mm_shuffle_epi8(a3_lut,
+		_mm_and_si128(_mm_srli_epi16(px, 12), mask_07));
+	const __m128i bg4443 = _mm_or_si128(b4, _mm_slli_epi16(g4, 8));
+	const __m128i ra4443 = _mm_or_si128(r4, _mm_slli_epi16(a3, 8));
+
+	const __m128i bg = _mm_or_si128(_mm_and_si128(is555, bg555), _mm_andnot_si128(is555, bg4443));
+	const __m128i ra = _mm_or_si128(_mm_and_si128(is555, ra555), _mm_andnot_si128(is555, ra4443));
+	combine_BG_RA(bg, ra, px0, px1);
+}
+
+/**
+ * Convert two tile rows of RGB565 pixels to ARGB32.
+ * @param src	[in] 8 RGB565 pixels. (big-endian)
+ * @param px0	[out] First tile row.
+ * @param px1	[out] Second tile row.
+ */
+static FORCEINLINE void RGB565_to_ARGB32_ssse3(__m128i src, __m128i &px0, __m128i &px1)
+{
+	const __m128i shuf_bswap16 = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+	const __m128i mask_F8 = _mm_set1_epi16(0x00F8);
+	const __m128i mask_FC = _mm_set1_epi16(0x00FC);
+	const __m128i alpha_FF = _mm_set1_epi16(0xFF00);
+
+	// RGB565: RRRRRGGG GGGBBBBB
+	const __m128i px = _mm_shuffle_epi8(src, shuf_bswap16);
+	__m128i b = _mm_and_si128(_mm_slli_epi16(px, 3), mask_F8);
+	__m128i g = _mm_and_si128(_mm_srli_epi16(px, 3), mask_FC);
+	__m128i r = _mm_and_si128(_mm_srli_epi16(px, 8), mask_F8);
+	b = _mm_or_si128(b, _mm_srli_epi16(b, 5));
+	g = _mm_or_si128(g, _mm_srli_epi16(g, 6));
+	r = _mm_or_si128(r, _mm_srli_epi16(r, 5));
+
+	combine_BG_RA(_mm_or_si128(b, _mm_slli_epi16(g, 8)), _mm_or_si128(r, alpha_FF), px0, px1);
+}
+
+/**
+ * Convert two tile rows of IA8 pixels to ARGB32.
+ * @param src	[in] 8 IA8 pixels. (big-endian)
+ * @param px0	[out] First tile row.
+ * @param px1	[out] Second tile row.
+ */
+static FORCEINLINE void IA8_to_ARGB32_ssse3(__m128i src, __m128i &px0, __m128i &px1)
+{
+	// IA8 bytes: I, A -> ARGB32 bytes: I, I, I, A
+	const __m128i shuf_lo = _mm_setr_epi8(0,0,0,1, 2,2,2,3, 4,4,4,5, 6,6,6,7);
+	const __m128i shuf_hi = _mm_setr_epi8(8,8,8,9, 10,10,10,11, 12,12,12,13, 14,14,14,15);
+	px0 = _mm_shuffle_epi8(src, shuf_lo);
+	px1 = _mm_shuffle_epi8(src, shuf_hi);
+}
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * @tparam px_format 16-bit pixel format.
+ * @param img Destination image. (must be ARGB32)
+ * @param img_buf 16-bit image buffer.
+ */
+template<PixelFormat px_format>
+static inline void T_fromGcn16_ssse3(rp_image *img, const uint16_t *RESTRICT img_buf)
+{
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(img->width() / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(img->height() / 4);
+
+	uint32_t *const pImgBuf = static_cast<uint32_t*>(img->bits());
+	const int stride_px = img->stride() / sizeof(uint32_t);
+
+	// Each 4x4 tile is 32 bytes: two tile rows per SSE register.
+	// The converted rows are stored directly into the image.
+	const __m128i *xmm_src = reinterpret_cast<const __m128i*>(img_buf);
+	for (unsigned int y = 0; y < tilesY; y++) {
+		uint32_t *pDest = pImgBuf + (y * 4 * stride_px);
+		for (unsigned int x = 0; x < tilesX; x++, pDest += 4) {
+			for (unsigned int row = 0; row < 4; row += 2, xmm_src++) {
+				const __m128i src = _mm_loadu_si128(xmm_src);
+				__m128i px0, px1;
+				switch (px_format) {
+					case PixelFormat::RGB5A3:
+						RGB5A3_to_ARGB32_ssse3(src, px0, px1);
+						break;
+					case PixelFormat::RGB565:
+						RGB565_to_ARGB32_ssse3(src, px0, px1);
+						break;
+					case PixelFormat::IA8:
+						IA8_to_ARGB32_ssse3(src, px0, px1);
+						break;
+					default:
+						assert(!"Invalid pixel format for this function.");
+						return;
+				}
+
+				_mm_store_si128(reinterpret_cast<__m128i*>(&pDest[(row+0) * stride_px]), px0);
+				_mm_store_si128(reinterpret_cast<__m128i*>(&pDest[(row+1) * stride_px]), px1);
+			}
+		}
+	}
+}
+
+/**
+ * Convert a GameCube 16-bit image to rp_image.
+ * SSSE3-optimized version.
+ * @param px_format 16-bit pixel format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB5A3 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromGcn16_ssse3(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * 2))
+	{
+		return nullptr;
+	}
+
+	// GameCube RGB5A3 uses 4x4 tiles.
+	assert(width % 4 == 0);
+	assert(height % 4 == 0);
+	if (width % 4 != 0 || height % 4 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	switch (px_format) {
+		case PixelFormat::RGB5A3: {
+			T_fromGcn16_ssse3<PixelFormat::RGB5A3>(img, img_buf);
+			// Set the sBIT metadata.
+			// NOTE: Pixels may be RGB555 or ARGB4444.
+			// We'll use 555 for RGB, and 4 for alpha.
+			// TODO: Set alpha to 0 if no translucent pixels were found.
+			static const rp_image::sBIT_t sBIT = {5,5,5,0,4};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PixelFormat::RGB565: {
+			T_fromGcn16_ssse3<PixelFormat::RGB565>(img, img_buf);
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		case PixelFormat::IA8: {
+			T_fromGcn16_ssse3<PixelFormat::IA8>(img, img_buf);
+			// Set the sBIT metadata.
+			// NOTE: Setting the grayscale value, though we're
+			// not saving grayscale PNGs at the moment.
+			static const rp_image::sBIT_t sBIT = {8,8,8,8,8};
+			img->set_sBIT(&sBIT);
+			break;
+		}
+
+		default:
+			assert(!"Invalid pixel format for this function.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
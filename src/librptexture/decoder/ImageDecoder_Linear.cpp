@@ -643,6 +643,312 @@ rp_image *fromLinearMono(int width, int height,
 	return img;
 }
 
+/** Linear pixel kernels **/
+
+/**
+ * Extract a pixel component and expand it to 8-bit.
+ * @tparam Shift	[in] Component shift amount.
+ * @tparam Bits		[in] Component bit count. (0 == component is not present)
+ * @param px		[in] Source pixel.
+ * @return 8-bit component.
+ */
+template<uint8_t Shift, uint8_t Bits>
+static FORCEINLINE uint32_t extract_component(uint32_t px)
+{
+	static_assert(Bits <= 8, "Component cannot be larger than 8 bits.");
+	if (Bits == 0) {
+		return 0;
+	}
+
+	// Expand to 8-bit by replicating the high bits into the low bits.
+	// NOTE: Components smaller than 4 bits need more than one copy.
+	uint32_t c = ((px >> Shift) & ((1U << Bits) - 1)) << (8 - Bits);
+	c |= (c >> Bits);
+	if (Bits * 2 < 8) {
+		c |= (c >> (Bits * 2));
+	}
+	if (Bits * 4 < 8) {
+		c |= (c >> (Bits * 4));
+	}
+	return c;
+}
+
+/**
+ * Convert a packed pixel to ARGB32.
+ * Each component is a contiguous bit field in the source pixel.
+ * Luminance formats use the same bit field for R, G, and B.
+ *
+ * @tparam Ashift	[in] Alpha shift amount.
+ * @tparam Rshift	[in] Red shift amount.
+ * @tparam Gshift	[in] Green shift amount.
+ * @tparam Bshift	[in] Blue shift amount.
+ * @tparam Abits	[in] Alpha bit count. (0 == opaque)
+ * @tparam Rbits	[in] Red bit count. (0 == component is not present)
+ * @tparam Gbits	[in] Green bit count. (0 == component is not present)
+ * @tparam Bbits	[in] Blue bit count. (0 == component is not present)
+ * @param px		[in] Source pixel. (host-endian)
+ * @return ARGB32 pixel.
+ */
+template<typename src_t,
+	uint8_t Ashift, uint8_t Rshift, uint8_t Gshift, uint8_t Bshift,
+	uint8_t Abits, uint8_t Rbits, uint8_t Gbits, uint8_t Bbits>
+static FORCEINLINE uint32_t T_ARGB_cpp(src_t px)
+{
+	const uint32_t a = (Abits != 0) ? extract_component<Ashift, Abits>(px) : 0xFF;
+	return (a << 24) |
+	       (extract_component<Rshift, Rbits>(px) << 16) |
+	       (extract_component<Gshift, Gbits>(px) <<  8) |
+	        extract_component<Bshift, Bbits>(px);
+}
+
+// Source pixel loaders.
+static FORCEINLINE uint8_t load_8(uint8_t px) { return px; }
+static FORCEINLINE uint16_t load_le16(uint16_t px) { return le16_to_cpu(px); }
+static FORCEINLINE uint32_t load_le32(uint32_t px) { return le32_to_cpu(px); }
+static FORCEINLINE uint32_t load_host32(uint32_t px) { return px; }
+
+/**
+ * Convert a row of linear pixels to ARGB32.
+ * This loop has no dependencies between pixels,
+ * so the compiler can vectorize it.
+ *
+ * @tparam src_t	[in] Source pixel type.
+ * @tparam load		[in] Source pixel loader. (handles byteswapping)
+ * @tparam convert	[in] Pixel conversion function.
+ * @param px_dest	[out] Destination image buffer.
+ * @param img_buf	[in] Source image buffer.
+ * @param width		[in] Number of pixels.
+ */
+template<typename src_t, src_t (*load)(src_t), uint32_t (*convert)(src_t)>
+static void T_convertRow(uint32_t *RESTRICT px_dest, const src_t *RESTRICT img_buf, unsigned int width)
+{
+	for (unsigned int x = 0; x < width; x++) {
+		px_dest[x] = convert(load(img_buf[x]));
+	}
+}
+
+/**
+ * Convert a row of linear 24-bit pixels to ARGB32.
+ * @tparam Ridx		[in] Red byte index.
+ * @tparam Gidx		[in] Green byte index.
+ * @tparam Bidx		[in] Blue byte index.
+ * @param px_dest	[out] Destination image buffer.
+ * @param img_buf	[in] Source image buffer.
+ * @param width		[in] Number of pixels.
+ */
+template<uint8_t Ridx, uint8_t Gidx, uint8_t Bidx>
+static void T_convertRow24(uint32_t *RESTRICT px_dest, const uint8_t *RESTRICT img_buf, unsigned int width)
+{
+	for (unsigned int x = 0; x < width; x++, img_buf += 3) {
+		px_dest[x] = 0xFF000000U |
+			(static_cast<uint32_t>(img_buf[Ridx]) << 16) |
+			(static_cast<uint32_t>(img_buf[Gidx]) <<  8) |
+			 static_cast<uint32_t>(img_buf[Bidx]);
+	}
+}
+
+/**
+ * Linear row kernel for a pixel format.
+ * The kernel is selected once per image.
+ */
+template<typename src_t>
+struct LinearRowKernel {
+	PixelFormat px_format;
+	void (*convertRow)(uint32_t *RESTRICT px_dest, const src_t *RESTRICT img_buf, unsigned int width);
+	rp_image::sBIT_t sBIT;
+};
+
+/**
+ * Find the row kernel for a pixel format.
+ * @param kernels	[in] Row kernel table.
+ * @param px_format	[in] Pixel format.
+ * @return Row kernel, or nullptr if the pixel format isn't in the table.
+ */
+template<typename src_t, size_t N>
+static const LinearRowKernel<src_t> *findRowKernel(const LinearRowKernel<src_t> (&kernels)[N], PixelFormat px_format)
+{
+	for (const LinearRowKernel<src_t> &kernel : kernels) {
+		if (kernel.px_format == px_format) {
+			return &kernel;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Convert a linear image to ARGB32 using a row kernel.
+ * @param kernel	[in] Row kernel.
+ * @param img		[in,out] Destination rp_image. (ARGB32)
+ * @param img_buf	[in] Source image buffer.
+ * @param src_stride	[in] Source stride, in pixels.
+ */
+template<typename src_t>
+static void T_convertImage(const LinearRowKernel<src_t> *kernel, rp_image *img,
+	const src_t *RESTRICT img_buf, int src_stride)
+{
+	const unsigned int width = static_cast<unsigned int>(img->width());
+	const int dest_stride = img->stride() / sizeof(argb32_t);
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+	for (unsigned int y = static_cast<unsigned int>(img->height()); y > 0; y--) {
+		kernel->convertRow(px_dest, img_buf, width);
+		img_buf += src_stride;
+		px_dest += dest_stride;
+	}
+
+	// Set the sBIT metadata.
+	img->set_sBIT(&kernel->sBIT);
+}
+
+/**
+ * Convert a linear little-endian 16-bit image to ARGB32 using a lookup table.
+ * @param lut		[in] Lookup table. (65536 entries, host-endian)
+ * @param sBIT		[in] sBIT metadata.
+ * @param img		[in,out] Destination rp_image. (ARGB32)
+ * @param img_buf	[in] Source image buffer.
+ * @param src_stride	[in] Source stride, in pixels.
+ */
+static void convertImageLut16(const uint32_t *RESTRICT lut, const rp_image::sBIT_t *sBIT,
+	rp_image *img, const uint16_t *RESTRICT img_buf, int src_stride)
+{
+	const unsigned int width = static_cast<unsigned int>(img->width());
+	const int dest_stride = img->stride() / sizeof(argb32_t);
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+	for (unsigned int y = static_cast<unsigned int>(img->height()); y > 0; y--) {
+		for (unsigned int x = 0; x < width; x++) {
+			px_dest[x] = lut[le16_to_cpu(img_buf[x])];
+		}
+		img_buf += src_stride;
+		px_dest += dest_stride;
+	}
+
+	// Set the sBIT metadata.
+	img->set_sBIT(sBIT);
+}
+
+// Row kernels for packed pixel formats.
+#define PACKED8(As,Rs,Gs,Bs, Ab,Rb,Gb,Bb) \
+	T_convertRow<uint8_t, load_8, T_ARGB_cpp<uint8_t, As,Rs,Gs,Bs, Ab,Rb,Gb,Bb> >
+#define PACKED16(As,Rs,Gs,Bs, Ab,Rb,Gb,Bb) \
+	T_convertRow<uint16_t, load_le16, T_ARGB_cpp<uint16_t, As,Rs,Gs,Bs, Ab,Rb,Gb,Bb> >
+#define PACKED32(As,Rs,Gs,Bs, Ab,Rb,Gb,Bb) \
+	T_convertRow<uint32_t, load_host32, T_ARGB_cpp<uint32_t, As,Rs,Gs,Bs, Ab,Rb,Gb,Bb> >
+#define PACKED32LE(As,Rs,Gs,Bs, Ab,Rb,Gb,Bb) \
+	T_convertRow<uint32_t, load_le32, T_ARGB_cpp<uint32_t, As,Rs,Gs,Bs, Ab,Rb,Gb,Bb> >
+
+// 8-bit row kernels.
+static const LinearRowKernel<uint8_t> linear8_kernels[] = {
+	// Luminance.
+	{PixelFormat::L8,	PACKED8(0,0,0,0, 0,8,8,8),	{8,8,8,8,0}},
+	{PixelFormat::A4L4,	PACKED8(4,0,0,0, 4,4,4,4),	{4,4,4,4,4}},
+
+	// Alpha.
+	// NOTE: Have to specify RGB bits...
+	{PixelFormat::A8,	PACKED8(0,0,0,0, 8,0,0,0),	{1,1,1,1,8}},
+};
+
+// 24-bit row kernels.
+// NOTE: Byte addressing, since 24-bit pixels aren't aligned.
+static const LinearRowKernel<uint8_t> linear24_kernels[] = {
+	{PixelFormat::RGB888,	T_convertRow24<2,1,0>,	{8,8,8,0,0}},
+	{PixelFormat::BGR888,	T_convertRow24<0,1,2>,	{8,8,8,0,0}},
+};
+
+// 16-bit row kernels.
+static const LinearRowKernel<uint16_t> linear16_kernels[] = {
+	// 16-bit RGB.
+	{PixelFormat::RGB565,	PACKED16( 0,11, 5, 0,  0,5,6,5),	{5,6,5,0,0}},
+	{PixelFormat::BGR565,	PACKED16( 0, 0, 5,11,  0,5,6,5),	{5,6,5,0,0}},
+	{PixelFormat::ARGB1555,	PACKED16(15,10, 5, 0,  1,5,5,5),	{5,5,5,0,1}},
+	{PixelFormat::ABGR1555,	PACKED16(15, 0, 5,10,  1,5,5,5),	{5,5,5,0,1}},
+	{PixelFormat::RGBA5551,	PACKED16( 0,11, 6, 1,  1,5,5,5),	{5,5,5,0,1}},
+	{PixelFormat::BGRA5551,	PACKED16( 0, 1, 6,11,  1,5,5,5),	{5,5,5,0,1}},
+	{PixelFormat::ARGB4444,	PACKED16(12, 8, 4, 0,  4,4,4,4),	{4,4,4,0,4}},
+	{PixelFormat::ABGR4444,	PACKED16(12, 0, 4, 8,  4,4,4,4),	{4,4,4,0,4}},
+	{PixelFormat::RGBA4444,	PACKED16( 0,12, 8, 4,  4,4,4,4),	{4,4,4,0,4}},
+	{PixelFormat::BGRA4444,	PACKED16( 0, 4, 8,12,  4,4,4,4),	{4,4,4,0,4}},
+	{PixelFormat::xRGB4444,	PACKED16( 0, 8, 4, 0,  0,4,4,4),	{4,4,4,0,4}},
+	{PixelFormat::xBGR4444,	PACKED16( 0, 0, 4, 8,  0,4,4,4),	{4,4,4,0,4}},
+	{PixelFormat::RGBx4444,	PACKED16( 0,12, 8, 4,  0,4,4,4),	{4,4,4,0,4}},
+	{PixelFormat::BGRx4444,	PACKED16( 0, 4, 8,12,  0,4,4,4),	{4,4,4,0,4}},
+	{PixelFormat::ARGB8332,	PACKED16( 8, 5, 2, 0,  8,3,3,2),	{3,3,2,0,8}},
+
+	// PlayStation 2.
+	{PixelFormat::BGR5A3,	T_convertRow<uint16_t, load_le16, BGR5A3_to_ARGB32>,	{5,5,5,0,4}},
+
+	// 15-bit RGB.
+	{PixelFormat::RGB555,	PACKED16( 0,10, 5, 0,  0,5,5,5),	{5,5,5,0,0}},
+	{PixelFormat::BGR555,	PACKED16( 0, 0, 5,10,  0,5,5,5),	{5,5,5,0,0}},
+
+	// IA8
+	{PixelFormat::IA8,	PACKED16( 0, 8, 8, 8,  8,8,8,8),	{8,8,8,8,8}},
+
+	// Luminance.
+	// TODO: 16-bit support. Downconverted to 8 for now.
+	{PixelFormat::L16,	PACKED16( 0, 8, 8, 8,  0,8,8,8),	{8,8,8,8,0}},
+	{PixelFormat::A8L8,	PACKED16( 8, 0, 0, 0,  8,8,8,8),	{8,8,8,8,8}},
+	{PixelFormat::L8A8,	PACKED16( 0, 8, 8, 8,  8,8,8,8),	{8,8,8,8,8}},
+
+	// RG formats.
+	{PixelFormat::RG88,	PACKED16( 0, 8, 0, 0,  0,8,8,0),	{8,8,1,0,0}},
+	{PixelFormat::GR88,	PACKED16( 0, 0, 8, 0,  0,8,8,0),	{8,8,1,0,0}},
+};
+
+// 32-bit row kernels.
+// NOTE: Host_ARGB32 is copied directly, so it isn't listed here.
+static const LinearRowKernel<uint32_t> linear32_kernels[] = {
+	// Host-endian and byteswapped ARGB32 variants.
+	{PixelFormat::Host_RGBA32,	PACKED32( 0,24,16, 8,  8,8,8,8),	{8,8,8,0,8}},
+	{PixelFormat::Host_xRGB32,	PACKED32( 0,16, 8, 0,  0,8,8,8),	{8,8,8,0,0}},
+	{PixelFormat::Host_RGBx32,	PACKED32( 0,24,16, 8,  0,8,8,8),	{8,8,8,0,0}},
+	{PixelFormat::Swap_ARGB32,	PACKED32( 0, 8,16,24,  8,8,8,8),	{8,8,8,0,8}},
+	{PixelFormat::Swap_RGBA32,	PACKED32(24, 0, 8,16,  8,8,8,8),	{8,8,8,0,8}},
+	{PixelFormat::Swap_xRGB32,	PACKED32( 0, 8,16,24,  0,8,8,8),	{8,8,8,0,0}},
+	{PixelFormat::Swap_RGBx32,	PACKED32( 0, 0, 8,16,  0,8,8,8),	{8,8,8,0,0}},
+
+	// VTF "ARGB8888", which is actually RABG.
+	// TODO: This might be a VTFEdit bug. (Tested versions: 1.2.5, 1.3.3)
+	// TODO: Verify on big-endian.
+	{PixelFormat::RABG8888,	PACKED32(16,24, 0, 8,  8,8,8,8),	{8,8,8,0,0}},
+
+	/** Uncommon 32-bit formats. **/
+
+	// TODO: Add an ARGB64 format to rp_image.
+	// For now, truncating it to G8R8.
+	// NOTE: We have to set '1' for the empty Blue channel,
+	// since libpng complains if it's set to '0'.
+	{PixelFormat::G16R16,	PACKED32LE( 0, 8,24, 0,  0,8,8,0),	{8,8,1,0,0}},
+
+	// TODO: Add an ARGB64 format to rp_image.
+	// For now, truncating it to ARGB32.
+	{PixelFormat::A2R10G10B10,	PACKED32LE(30,22,12, 2,  2,8,8,8),	{8,8,8,0,2}},
+	{PixelFormat::A2B10G10R10,	PACKED32LE(30, 2,12,22,  2,8,8,8),	{8,8,8,0,2}},
+	{PixelFormat::RGB9_E5,	T_convertRow<uint32_t, load_le32, RGB9_E5_to_ARGB32>,	{8,8,8,0,0}},
+
+	// PS2's wacky 32-bit format.
+	{PixelFormat::BGR888_ABGR7888,	T_convertRow<uint32_t, load_le32, BGR888_ABGR7888_to_ARGB32>,	{8,8,8,0,8}},
+};
+
+/**
+ * Get the lookup table for a linear 16-bit pixel format.
+ * Lookup tables are only used for large images. (LUT16_MIN_PIXELS)
+ * @param px_format	[in] 16-bit pixel format.
+ * @return Lookup table, or nullptr if the pixel format doesn't have one.
+ */
+static const uint32_t *getLinearLut16(PixelFormat px_format)
+{
+	switch (px_format) {
+		case PixelFormat::RGB565:
+			return getLut16(Lut16::RGB565);
+		case PixelFormat::ARGB1555:
+			return getLut16(Lut16::ARGB1555);
+		case PixelFormat::ARGB4444:
+			return getLut16(Lut16::ARGB4444);
+		default:
+			break;
+	}
+	return nullptr;
+}
+
 /**
  * Convert a linear 8-bit RGB image to rp_image.
  * Usually used for luminance and alpha images.
@@ -686,6 +992,14 @@ rp_image *fromLinear8(PixelFormat px_format,
 		src_stride_adj = (stride / bytespp) - width;
 	}
 
+	// Get the row kernel.
+	const LinearRowKernel<uint8_t> *const kernel = findRowKernel(linear8_kernels, px_format);
+	assert(kernel != nullptr);
+	if (!kernel) {
+		// Unsupported 8-bit pixel format.
+		return nullptr;
+	}
+
 	// Create an rp_image.
 	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
@@ -693,48 +1007,9 @@ rp_image *fromLinear8(PixelFormat px_format,
 		img->unref();
 		return nullptr;
 	}
-	const int dest_stride_adj = (img->stride() / sizeof(argb32_t)) - img->width();
-	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
-
-#define fromLinear8_convert(fmt, r,g,b,gr,a) \
-		case PixelFormat::fmt: { \
-			for (unsigned int y = (unsigned int)height; y > 0; y--) { \
-				unsigned int x; \
-				for (x = (unsigned int)width; x > 1; x -= 2) { \
-					px_dest[0] = fmt##_to_ARGB32(img_buf[0]); \
-					px_dest[1] = fmt##_to_ARGB32(img_buf[1]); \
-					img_buf += 2; \
-					px_dest += 2; \
-				} \
-				if (x == 1) { \
-					/* Extra pixel. */ \
-					*px_dest = fmt##_to_ARGB32(*img_buf); \
-					img_buf++; \
-					px_dest++; \
-				} \
-				img_buf += src_stride_adj; \
-				px_dest += dest_stride_adj; \
-			} \
-			/* Set the sBIT data. */ \
-			static const rp_image::sBIT_t sBIT = {r,g,b,gr,a}; \
-			img->set_sBIT(&sBIT); \
-		} break
 
 	// Convert one line at a time. (8-bit -> ARGB32)
-	switch (px_format) {
-		// Luminance.
-		fromLinear8_convert(L8, 8,8,8,8,0);
-		fromLinear8_convert(A4L4, 4,4,4,4,4);
-
-		// Alpha.
-		// NOTE: Have to specify RGB bits...
-		fromLinear8_convert(A8, 1,1,1,1,8);
-
-		default:
-			assert(!"Unsupported 8-bit pixel format.");
-			img->unref();
-			return nullptr;
-	}
+	T_convertImage(kernel, img, img_buf, width + src_stride_adj);
 
 	// Image has been converted.
 	return img;
@@ -783,6 +1058,14 @@ rp_image *fromLinear16_cpp(PixelFormat px_format,
 		src_stride_adj = (stride / bytespp) - width;
 	}
 
+	// Get the row kernel.
+	const LinearRowKernel<uint16_t> *const kernel = findRowKernel(linear16_kernels, px_format);
+	assert(kernel != nullptr);
+	if (!kernel) {
+		// Unsupported 16-bit pixel format.
+		return nullptr;
+	}
+
 	// Create an rp_image.
 	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
@@ -790,68 +1073,19 @@ rp_image *fromLinear16_cpp(PixelFormat px_format,
 		img->unref();
 		return nullptr;
 	}
-	const int dest_stride_adj = (img->stride() / sizeof(argb32_t)) - img->width();
-	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
 
-#define fromLinear16_convert(fmt, r,g,b,gr,a) \
-		case PixelFormat::fmt: { \
-			for (unsigned int y = (unsigned int)height; y > 0; y--) { \
-				for (unsigned int x = (unsigned int)width; x > 0; x--) { \
-					*px_dest = fmt##_to_ARGB32(le16_to_cpu(*img_buf)); \
-					img_buf++; \
-					px_dest++; \
-				} \
-				img_buf += src_stride_adj; \
-				px_dest += dest_stride_adj; \
-			} \
-			/* Set the sBIT data. */ \
-			static const rp_image::sBIT_t sBIT = {r,g,b,gr,a}; \
-			img->set_sBIT(&sBIT); \
-		} break
-			
 	// Convert one line at a time. (16-bit -> ARGB32)
-	switch (px_format) {
-		// 16-bit RGB.
-		fromLinear16_convert(RGB565, 5,6,5,0,0);
-		fromLinear16_convert(BGR565, 5,6,5,0,0);
-		fromLinear16_convert(ARGB1555, 5,5,5,0,1);
-		fromLinear16_convert(ABGR1555, 5,5,5,0,1);
-		fromLinear16_convert(RGBA5551, 5,5,5,0,1);
-		fromLinear16_convert(BGRA5551, 5,5,5,0,1);
-		fromLinear16_convert(ARGB4444, 4,4,4,0,4);
-		fromLinear16_convert(ABGR4444, 4,4,4,0,4);
-		fromLinear16_convert(RGBA4444, 4,4,4,0,4);
-		fromLinear16_convert(BGRA4444, 4,4,4,0,4);
-		fromLinear16_convert(xRGB4444, 4,4,4,0,4);
-		fromLinear16_convert(xBGR4444, 4,4,4,0,4);
-		fromLinear16_convert(RGBx4444, 4,4,4,0,4);
-		fromLinear16_convert(BGRx4444, 4,4,4,0,4);
-		fromLinear16_convert(ARGB8332, 3,3,2,0,8);
-
-		// PlayStation 2.
-		fromLinear16_convert(BGR5A3, 5,5,5,0,4);
-
-		// 15-bit RGB.
-		fromLinear16_convert(RGB555, 5,5,5,0,0);
-		fromLinear16_convert(BGR555, 5,5,5,0,0);
-
-		// IA8
-		fromLinear16_convert(IA8, 8,8,8,8,8);
-
-		// Luminance.
-		// TODO: 16-bit support. Downconverted to 8 for now.
-		fromLinear16_convert(L16, 8,8,8,8,0);
-		fromLinear16_convert(A8L8, 8,8,8,8,8);
-		fromLinear16_convert(L8A8, 8,8,8,8,8);
-
-		// RG formats.
-		fromLinear16_convert(RG88, 8,8,1,0,0);
-		fromLinear16_convert(GR88, 8,8,1,0,0);
-
-		default:
-			assert(!"Unsupported 16-bit pixel format.");
-			img->unref();
-			return nullptr;
+	// NOTE: Large images use a lookup table for common formats.
+	// Each pixel is a single load, which is faster on systems
+	// that don't have a SIMD decoder for these formats.
+	const uint32_t *const lut =
+		(static_cast<unsigned int>(width * height) >= LUT16_MIN_PIXELS
+			? getLinearLut16(px_format)
+			: nullptr);
+	if (lut) {
+		convertImageLut16(lut, &kernel->sBIT, img, img_buf, width + src_stride_adj);
+	} else {
+		T_convertImage(kernel, img, img_buf, width + src_stride_adj);
 	}
 
 	// Image has been converted.
@@ -901,6 +1135,14 @@ rp_image *fromLinear24_cpp(PixelFormat px_format,
 		src_stride_adj = stride - (width * bytespp);
 	}
 
+	// Get the row kernel.
+	const LinearRowKernel<uint8_t> *const kernel = findRowKernel(linear24_kernels, px_format);
+	assert(kernel != nullptr);
+	if (!kernel) {
+		// Unsupported 24-bit pixel format.
+		return nullptr;
+	}
+
 	// Create an rp_image.
 	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
@@ -908,52 +1150,9 @@ rp_image *fromLinear24_cpp(PixelFormat px_format,
 		img->unref();
 		return nullptr;
 	}
-	const int dest_stride_adj = (img->stride() / sizeof(argb32_t)) - img->width();
-	argb32_t *px_dest = static_cast<argb32_t*>(img->bits());
-
-	// TODO: Is it faster or slower to use argb32_t vs. shifting?
 
 	// Convert one line at a time. (24-bit -> ARGB32)
-	switch (px_format) {
-		case PixelFormat::RGB888:
-			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-				for (unsigned int x = static_cast<unsigned int>(width); x > 0; x--) {
-					px_dest->b = img_buf[0];
-					px_dest->g = img_buf[1];
-					px_dest->r = img_buf[2];
-					px_dest->a = 0xFF;
-					img_buf += 3;
-					px_dest++;
-				}
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
-			break;
-
-		case PixelFormat::BGR888:
-			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-				for (unsigned int x = static_cast<unsigned int>(width); x > 0; x--) {
-					px_dest->b = img_buf[2];
-					px_dest->g = img_buf[1];
-					px_dest->r = img_buf[0];
-					px_dest->a = 0xFF;
-					img_buf += 3;
-					px_dest++;
-				}
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
-			break;
-
-		default:
-			assert(!"Unsupported 24-bit pixel format.");
-			img->unref();
-			return nullptr;
-	}
-
-	// Set the sBIT metadata.
-	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
-	img->set_sBIT(&sBIT);
+	T_convertImage(kernel, img, img_buf, (width * bytespp) + src_stride_adj);
 
 	// Image has been converted.
 	return img;
@@ -1002,6 +1201,18 @@ rp_image *fromLinear32_cpp(PixelFormat px_format,
 		src_stride_adj = (stride / bytespp) - width;
 	}
 
+	// Get the row kernel.
+	// NOTE: Host_ARGB32 is copied directly.
+	const LinearRowKernel<uint32_t> *kernel = nullptr;
+	if (px_format != PixelFormat::Host_ARGB32) {
+		kernel = findRowKernel(linear32_kernels, px_format);
+		assert(kernel != nullptr);
+		if (!kernel) {
+			// Unsupported 32-bit pixel format.
+			return nullptr;
+		}
+	}
+
 	// Create an rp_image.
 	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
@@ -1009,308 +1220,42 @@ rp_image *fromLinear32_cpp(PixelFormat px_format,
 		img->unref();
 		return nullptr;
 	}
-	int dest_stride = img->stride();
-	const int dest_stride_adj = (dest_stride / sizeof(argb32_t)) - img->width();
 
-	// sBIT for standard ARGB32.
-	static const rp_image::sBIT_t sBIT_x32 = {8,8,8,0,0};
-	static const rp_image::sBIT_t sBIT_A32 = {8,8,8,0,8};
-
-	// Convert one line at a time. (32-bit -> ARGB32)
-	// NOTE: All functions except PixelFormat::Host_ARGB32 are partially unrolled.
-	switch (px_format) {
-		case PixelFormat::Host_ARGB32:
-			// Host-endian ARGB32.
-			// We can directly copy the image data without conversions.
-			if (stride == 0) {
-				// Calculate the stride based on image width.
-				stride = width * bytespp;
-			}
-
-			if (stride == dest_stride) {
-				// Stride is identical. Copy the whole image all at once.
-				// TODO: Partial copy for the last line?
-				memcpy(img->bits(), img_buf, stride * height);
-			} else {
-				// Stride is not identical. Copy each scanline.
-				stride /= bytespp;
-				dest_stride /= bytespp;
-				uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
-				const unsigned int copy_len = static_cast<unsigned int>(width * bytespp);
-				for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-					memcpy(px_dest, img_buf, copy_len);
-					img_buf += stride;
-					px_dest += dest_stride;
-				}
-			}
-			// Set the sBIT metadata.
-			img->set_sBIT(&sBIT_A32);
-			break;
-
-		case PixelFormat::Host_RGBA32: {
-			// Host-endian RGBA32.
-			// Pixel copy is needed, with shifting.
-			uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
-			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-				unsigned int x;
-				for (x = static_cast<unsigned int>(width); x > 1; x -= 2) {
-					px_dest[0] = (img_buf[0] >> 8) | (img_buf[0] << 24);
-					px_dest[1] = (img_buf[1] >> 8) | (img_buf[1] << 24);
-					img_buf += 2;
-					px_dest += 2;
-				}
-				if (x == 1) {
-					// Extra pixel.
-					*px_dest = (*img_buf >> 8) | (*img_buf << 24);
-					img_buf++;
-					px_dest++;
-				}
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
-			// Set the sBIT metadata.
-			img->set_sBIT(&sBIT_A32);
-			break;
-		}
-
-		case PixelFormat::Host_xRGB32: {
-			// Host-endian XRGB32.
-			// Pixel copy is needed, with alpha channel masking.
-			uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
-			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-				unsigned int x;
-				for (x = static_cast<unsigned int>(width); x > 1; x -= 2) {
-					px_dest[0] = img_buf[0] | 0xFF000000;
-					px_dest[1] = img_buf[1] | 0xFF000000;
-					img_buf += 2;
-					px_dest += 2;
-				}
-				if (x == 1) {
-					// Extra pixel.
-					*px_dest = *img_buf | 0xFF000000;
-					img_buf++;
-					px_dest++;
-				}
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
-			// Set the sBIT metadata.
-			img->set_sBIT(&sBIT_x32);
-			break;
-		}
-
-		case PixelFormat::Host_RGBx32: {
-			// Host-endian RGBx32.
-			// Pixel copy is needed, with a right shift.
-			uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
-			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-				unsigned int x;
-				for (x = static_cast<unsigned int>(width); x > 1; x -= 2) {
-					px_dest[0] = (img_buf[0] >> 8) | 0xFF000000;
-					px_dest[1] = (img_buf[1] >> 8) | 0xFF000000;
-					img_buf += 2;
-					px_dest += 2;
-				}
-				if (x == 1) {
-					// Extra pixel.
-					*px_dest = (*img_buf >> 8) | 0xFF000000;
-					img_buf++;
-					px_dest++;
-				}
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
-			// Set the sBIT metadata.
-			img->set_sBIT(&sBIT_x32);
-			break;
-		}
-
-		case PixelFormat::Swap_ARGB32: {
-			// Byteswapped ARGB32.
-			// Pixel copy is needed, with byteswapping.
-			uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
-			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-				unsigned int x;
-				for (x = static_cast<unsigned int>(width); x > 1; x -= 2) {
-					px_dest[0] = __swab32(img_buf[0]);
-					px_dest[1] = __swab32(img_buf[1]);
-					img_buf += 2;
-					px_dest += 2;
-				}
-				if (x == 1) {
-					// Extra pixel.
-					*px_dest = __swab32(*img_buf);
-					img_buf++;
-					px_dest++;
-				}
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
-			// Set the sBIT metadata.
-			img->set_sBIT(&sBIT_A32);
-			break;
-		}
-
-		case PixelFormat::Swap_RGBA32: {
-			// Byteswapped ABGR32.
-			// Pixel copy is needed, with shifting.
-			uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
-			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-				unsigned int x;
-				for (x = static_cast<unsigned int>(width); x > 1; x -= 2) {
-					const uint32_t px0 = __swab32(img_buf[0]);
-					const uint32_t px1 = __swab32(img_buf[1]);
-					px_dest[0] = (px0 >> 8) | (px0 << 24);
-					px_dest[1] = (px1 >> 8) | (px1 << 24);
-					img_buf += 2;
-					px_dest += 2;
-				}
-				if (x == 1) {
-					// Extra pixel.
-					const uint32_t px = __swab32(*img_buf);
-					*px_dest = (px >> 8) | (px << 24);
-					img_buf++;
-					px_dest++;
-				}
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
-			// Set the sBIT metadata.
-			img->set_sBIT(&sBIT_A32);
-			break;
-		}
-
-		case PixelFormat::Swap_xRGB32: {
-			// Byteswapped XRGB32.
-			// Pixel copy is needed, with byteswapping and alpha channel masking.
-			uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
-			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-				unsigned int x;
-				for (x = static_cast<unsigned int>(width); x > 1; x -= 2) {
-					px_dest[0] = __swab32(img_buf[0]) | 0xFF000000;
-					px_dest[1] = __swab32(img_buf[1]) | 0xFF000000;
-					img_buf += 2;
-					px_dest += 2;
-				}
-				if (x == 1) {
-					// Extra pixel.
-					*px_dest = __swab32(*img_buf) | 0xFF000000;
-					img_buf++;
-					px_dest++;
-				}
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
-			// Set the sBIT metadata.
-			img->set_sBIT(&sBIT_x32);
-			break;
-		}
+	if (kernel) {
+		// Convert one line at a time. (32-bit -> ARGB32)
+		T_convertImage(kernel, img, img_buf, width + src_stride_adj);
+		return img;
+	}
 
-		case PixelFormat::Swap_RGBx32: {
-			// Byteswapped RGBx32.
-			// Pixel copy is needed, with byteswapping and a right shift.
-			uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
-			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-				unsigned int x;
-				for (x = static_cast<unsigned int>(width); x > 1; x -= 2) {
-					px_dest[0] = (__swab32(img_buf[0]) >> 8) | 0xFF000000;
-					px_dest[1] = (__swab32(img_buf[1]) >> 8) | 0xFF000000;
-					img_buf += 2;
-					px_dest += 2;
-				}
-				if (x == 1) {
-					// Extra pixel.
-					*px_dest = (__swab32(*img_buf) >> 8) | 0xFF000000;
-					img_buf++;
-					px_dest++;
-				}
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
-			// Set the sBIT metadata.
-			img->set_sBIT(&sBIT_x32);
-			break;
-		}
+	// Host-endian ARGB32.
+	// We can directly copy the image data without conversions.
+	int dest_stride = img->stride();
+	if (stride == 0) {
+		// Calculate the stride based on image width.
+		stride = width * bytespp;
+	}
 
-		case PixelFormat::RABG8888: {
-			// VTF "ARGB8888", which is actually RABG.
-			// TODO: This might be a VTFEdit bug. (Tested versions: 1.2.5, 1.3.3)
-			// TODO: Verify on big-endian.
-			uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
-			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
-				unsigned int x;
-				for (x = static_cast<unsigned int>(width); x > 1; x -= 2) {
-					px_dest[0]  = (img_buf[0] >> 8) & 0xFF;
-					px_dest[0] |= (img_buf[0] & 0xFF) << 8;
-					px_dest[0] |= (img_buf[0] << 8) & 0xFF000000;
-					px_dest[0] |= (img_buf[0] >> 8) & 0x00FF0000;
-
-					px_dest[1]  = (img_buf[1] >> 8) & 0xFF;
-					px_dest[1] |= (img_buf[1] & 0xFF) << 8;
-					px_dest[1] |= (img_buf[1] << 8) & 0xFF000000;
-					px_dest[1] |= (img_buf[1] >> 8) & 0x00FF0000;
-
-					img_buf += 2;
-					px_dest += 2;
-				}
-				if (x == 1) {
-					// Extra pixel.
-					*px_dest  = (*img_buf >> 8) & 0xFF;
-					*px_dest |= (*img_buf & 0xFF) << 8;
-					*px_dest |= (*img_buf << 8) & 0xFF000000;
-					*px_dest |= (*img_buf >> 8) & 0x00FF0000;
-					img_buf++;
-					px_dest++;
-				}
-				img_buf += src_stride_adj;
-				px_dest += dest_stride_adj;
-			}
-			// Set the sBIT metadata.
-			img->set_sBIT(&sBIT_x32);
-			break;
+	if (stride == dest_stride) {
+		// Stride is identical. Copy the whole image all at once.
+		// TODO: Partial copy for the last line?
+		memcpy(img->bits(), img_buf, stride * height);
+	} else {
+		// Stride is not identical. Copy each scanline.
+		stride /= bytespp;
+		dest_stride /= bytespp;
+		uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+		const unsigned int copy_len = static_cast<unsigned int>(width * bytespp);
+		for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+			memcpy(px_dest, img_buf, copy_len);
+			img_buf += stride;
+			px_dest += dest_stride;
 		}
-
-		/** Uncommon 32-bit formats. **/
-
-#define fromLinear32_convert(fmt, r,g,b,gr,a) \
-		case PixelFormat::fmt: { \
-			uint32_t *px_dest = static_cast<uint32_t*>(img->bits()); \
-			for (unsigned int y = (unsigned int)height; y > 0; y--) { \
-				for (unsigned int x = (unsigned int)width; x > 0; x--) { \
-					*px_dest = fmt##_to_ARGB32(le32_to_cpu(*img_buf)); \
-					img_buf++; \
-					px_dest++; \
-				} \
-				img_buf += src_stride_adj; \
-				px_dest += dest_stride_adj; \
-			} \
-			/* Set the sBIT data. */ \
-			static const rp_image::sBIT_t sBIT = {r,g,b,gr,a}; \
-			img->set_sBIT(&sBIT); \
-		} break
-
-		// TODO: Add an ARGB64 format to rp_image.
-		// For now, truncating it to G8R8.
-		// TODO: This might be a candidate for SSE2 optimization.
-		// NOTE: We have to set '1' for the empty Blue channel,
-		// since libpng complains if it's set to '0'.
-		fromLinear32_convert(G16R16, 8,8,1,0,0);
-
-		// TODO: Add an ARGB64 format to rp_image.
-		// For now, truncating it to ARGB32.
-		fromLinear32_convert(A2R10G10B10, 8,8,8,0,2);
-		fromLinear32_convert(A2B10G10R10, 8,8,8,0,2);
-		fromLinear32_convert(RGB9_E5, 8,8,8,0,0);
-
-		// PS2's wacky 32-bit format.
-		fromLinear32_convert(BGR888_ABGR7888, 8,8,8,0,8);
-
-		default:
-			assert(!"Unsupported 16-bit pixel format.");
-			img->unref();
-			return nullptr;
 	}
 
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+	img->set_sBIT(&sBIT);
+
 	// Image has been converted.
 	return img;
 }
@@ -0,0 +1,444 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_Linear.cpp: Image decoding functions. (Linear)             *
+ * NEON-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+#include "PixelConversion.hpp"
+using namespace LibRpTexture::PixelConversion;
+
+// NOTE: On 32-bit ARM, NEON is only used if it's
+// part of the compiler's baseline.
+#ifdef IMAGEDECODER_HAS_NEON
+
+// NEON intrinsics.
+#include <arm_neon.h>
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Extract a 16-bit pixel component and expand it to 8-bit.
+ * @tparam Shift	[in] Component shift amount.
+ * @tparam Bits		[in] Component bit count. (0 == component is not present)
+ * @param px		[in] 16-bit pixels.
+ * @return 8-bit components, in the low byte of each word.
+ */
+template<uint8_t Shift, uint8_t Bits>
+static FORCEINLINE uint16x8_t extract_component_neon(uint16x8_t px)
+{
+	if (Bits == 0) {
+		return vdupq_n_u16(0);
+	}
+
+	// NOTE: Using register shifts instead of immediate shifts,
+	// since immediate shifts can't be 0.
+	const uint16x8_t c = vandq_u16(vshlq_u16(px, vdupq_n_s16(-Shift)),
+		vdupq_n_u16((1U << Bits) - 1));
+	if (Bits == 1) {
+		// 1-bit component: either 0x00 or 0xFF.
+		return vmulq_n_u16(c, 0xFF);
+	}
+
+	// Expand to 8-bit by copying the high bits into the low bits.
+	const uint16x8_t hi = vshlq_u16(c, vdupq_n_s16(8 - Bits));
+	return vorrq_u16(hi, vshlq_u16(hi, vdupq_n_s16(-Bits)));
+}
+
+/**
+ * Templated function for 15/16-bit RGB conversion using NEON.
+ * Processes 8 pixels per iteration.
+ * Use this in the inner loop of the main code.
+ *
+ * @tparam Ashift	[in] Alpha shift amount.
+ * @tparam Rshift	[in] Red shift amount.
+ * @tparam Gshift	[in] Green shift amount.
+ * @tparam Bshift	[in] Blue shift amount.
+ * @tparam Abits	[in] Alpha bit count. (0 == opaque)
+ * @tparam Rbits	[in] Red bit count.
+ * @tparam Gbits	[in] Green bit count.
+ * @tparam Bbits	[in] Blue bit count.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param px_dest	[out] Destination image buffer.
+ */
+template<uint8_t Ashift, uint8_t Rshift, uint8_t Gshift, uint8_t Bshift,
+	uint8_t Abits, uint8_t Rbits, uint8_t Gbits, uint8_t Bbits>
+static FORCEINLINE void T_ARGB16_neon(const uint16_t *RESTRICT img_buf, uint32_t *RESTRICT px_dest)
+{
+	const uint16x8_t px = vld1q_u16(img_buf);
+
+	const uint16x8_t r = extract_component_neon<Rshift, Rbits>(px);
+	const uint16x8_t g = extract_component_neon<Gshift, Gbits>(px);
+	const uint16x8_t b = extract_component_neon<Bshift, Bbits>(px);
+	const uint16x8_t a = (Abits != 0)
+		? extract_component_neon<Ashift, Abits>(px)
+		: vdupq_n_u16(0xFF);
+
+	// Combine into BG and RA words, then interleave to get ARGB32.
+	const uint16x8_t bg = vorrq_u16(b, vshlq_n_u16(g, 8));
+	const uint16x8_t ra = vorrq_u16(r, vshlq_n_u16(a, 8));
+	const uint16x8x2_t argb = vzipq_u16(bg, ra);
+
+	vst1q_u32(&px_dest[0], vreinterpretq_u32_u16(argb.val[0]));
+	vst1q_u32(&px_dest[4], vreinterpretq_u32_u16(argb.val[1]));
+}
+
+/**
+ * Convert a linear 16-bit RGB image to rp_image.
+ * NEON-optimized version.
+ * @param px_format	[in] 16-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear16_neon(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz, int stride)
+{
+	static const int bytespp = 2;
+
+	// FIXME: Add support for these formats.
+	// For now, redirect back to the C++ version.
+	switch (px_format) {
+		case PixelFormat::ARGB8332:
+		case PixelFormat::RGB5A3:
+		case PixelFormat::IA8:
+		case PixelFormat::BGR555_PS1:
+		case PixelFormat::BGR5A3:
+		case PixelFormat::L16:
+		case PixelFormat::A8L8:
+		case PixelFormat::L8A8:
+			return fromLinear16_cpp(px_format, width, height, img_buf, img_siz, stride);
+
+		default:
+			break;
+	}
+
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * bytespp));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * bytespp))
+	{
+		return nullptr;
+	}
+
+	// Stride adjustment.
+	// NOTE: NEON loads don't require 16-byte alignment,
+	// so any valid stride can be used here.
+	int src_stride_adj = 0;
+	assert(stride >= 0);
+	if (stride > 0) {
+		// Set src_stride_adj to the number of pixels we need to
+		// add to the end of each line to get to the next row.
+		assert(stride % bytespp == 0);
+		assert(stride >= (width * bytespp));
+		if (unlikely(stride % bytespp != 0 || stride < (width * bytespp))) {
+			// Invalid stride.
+			return nullptr;
+		}
+		src_stride_adj = (stride / bytespp) - width;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	const int dest_stride_adj = (img->stride() / sizeof(uint32_t)) - img->width();
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+
+	// sBIT metadata.
+	static const rp_image::sBIT_t sBIT_RGB565   = {5,6,5,0,0};
+	static const rp_image::sBIT_t sBIT_ARGB1555 = {5,5,5,0,1};
+	static const rp_image::sBIT_t sBIT_xRGB4444 = {4,4,4,0,0};
+	static const rp_image::sBIT_t sBIT_ARGB4444 = {4,4,4,0,4};
+	static const rp_image::sBIT_t sBIT_RGB555   = {5,5,5,0,0};
+	static const rp_image::sBIT_t sBIT_RG88     = {8,8,1,0,0};
+
+	// Macro for 16-bit formats.
+	// Component shift and bit counts are relative to the 16-bit pixel.
+#define fromLinear16_convert(fmt, sBIT, Ashift, Rshift, Gshift, Bshift, Abits, Rbits, Gbits, Bbits) \
+		case PixelFormat::fmt: { \
+			for (unsigned int y = (unsigned int)height; y > 0; y--) { \
+				/* Process 8 pixels per iteration using NEON. */ \
+				unsigned int x = (unsigned int)width; \
+				for (; x > 7; x -= 8, px_dest += 8, img_buf += 8) { \
+					T_ARGB16_neon<Ashift, Rshift, Gshift, Bshift, Abits, Rbits, Gbits, Bbits>( \
+						img_buf, px_dest); \
+				} \
+				\
+				/* Remaining pixels. */ \
+				for (; x > 0; x--) { \
+					*px_dest = fmt##_to_ARGB32(*img_buf); \
+					img_buf++; \
+					px_dest++; \
+				} \
+				\
+				/* Next line. */ \
+				img_buf += src_stride_adj; \
+				px_dest += dest_stride_adj; \
+			} \
+			/* Set the sBIT metadata. */ \
+			img->set_sBIT(&sBIT); \
+		} break
+
+	switch (px_format) {
+		/** RGB565 **/
+		fromLinear16_convert(RGB565, sBIT_RGB565, 0, 11, 5,  0, 0, 5, 6, 5);
+		fromLinear16_convert(BGR565, sBIT_RGB565, 0,  0, 5, 11, 0, 5, 6, 5);
+
+		/** ARGB1555 **/
+		fromLinear16_convert(ARGB1555, sBIT_ARGB1555, 15, 10, 5,  0, 1, 5, 5, 5);
+		fromLinear16_convert(ABGR1555, sBIT_ARGB1555, 15,  0, 5, 10, 1, 5, 5, 5);
+		fromLinear16_convert(RGBA5551, sBIT_ARGB1555,  0, 11, 6,  1, 1, 5, 5, 5);
+		fromLinear16_convert(BGRA5551, sBIT_ARGB1555,  0,  1, 6, 11, 1, 5, 5, 5);
+
+		/** ARGB4444 **/
+		fromLinear16_convert(ARGB4444, sBIT_ARGB4444, 12,  8, 4,  0, 4, 4, 4, 4);
+		fromLinear16_convert(ABGR4444, sBIT_ARGB4444, 12,  0, 4,  8, 4, 4, 4, 4);
+		fromLinear16_convert(RGBA4444, sBIT_ARGB4444,  0, 12, 8,  4, 4, 4, 4, 4);
+		fromLinear16_convert(BGRA4444, sBIT_ARGB4444,  0,  4, 8, 12, 4, 4, 4, 4);
+
+		/** xRGB4444 **/
+		fromLinear16_convert(xRGB4444, sBIT_xRGB4444, 0,  8, 4,  0, 0, 4, 4, 4);
+		fromLinear16_convert(xBGR4444, sBIT_xRGB4444, 0,  0, 4,  8, 0, 4, 4, 4);
+		fromLinear16_convert(RGBx4444, sBIT_xRGB4444, 0, 12, 8,  4, 0, 4, 4, 4);
+		fromLinear16_convert(BGRx4444, sBIT_xRGB4444, 0,  4, 8, 12, 0, 4, 4, 4);
+
+		/** RGB555 **/
+		fromLinear16_convert(RGB555, sBIT_RGB555, 0, 10, 5,  0, 0, 5, 5, 5);
+		fromLinear16_convert(BGR555, sBIT_RGB555, 0,  0, 5, 10, 0, 5, 5, 5);
+
+		/** RG88 **/
+		fromLinear16_convert(RG88, sBIT_RG88, 0, 8, 0, 0, 0, 8, 8, 0);
+		fromLinear16_convert(GR88, sBIT_RG88, 0, 0, 8, 0, 0, 8, 8, 0);
+
+		default:
+			assert(!"Pixel format not supported.");
+			img->unref();
+			return nullptr;
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a linear 32-bit RGB image to rp_image.
+ * NEON-optimized version.
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 32-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param stride	[in,opt] Stride, in bytes. If 0, assumes width*bytespp.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromLinear32_neon(PixelFormat px_format,
+	int width, int height,
+	const uint32_t *RESTRICT img_buf, int img_siz, int stride)
+{
+	static const int bytespp = 4;
+
+	// Determine the byte shuffle mask.
+	// NOTE: Each mask covers two pixels; vtbl1_u8() is used
+	// on each half of the register, since vqtbl1q_u8() is
+	// only available on ARM64.
+	static const uint8_t shuf_xRGB32[8]  = {0,1,2,3, 4,5,6,7};
+	static const uint8_t shuf_RGBA32[8]  = {1,2,3,0, 5,6,7,4};
+	static const uint8_t shuf_sARGB32[8] = {3,2,1,0, 7,6,5,4};
+	static const uint8_t shuf_sRGBA32[8] = {2,1,0,3, 6,5,4,7};
+	// NOTE: Truncates to G8R8.
+	static const uint8_t shuf_G16R16[8]  = {0xFF,3,1,0xFF, 0xFF,7,5,0xFF};
+	static const uint8_t shuf_RABG8888[8] = {1,0,3,2, 5,4,7,6};
+
+	const uint8_t *shuf;
+	bool has_alpha;
+	switch (px_format) {
+		case PixelFormat::Host_ARGB32:
+			// Handled separately.
+			shuf = nullptr;
+			has_alpha = true;
+			break;
+
+		case PixelFormat::Host_xRGB32:
+			shuf = shuf_xRGB32;
+			has_alpha = false;
+			break;
+
+		case PixelFormat::Host_RGBA32:
+		case PixelFormat::Host_RGBx32:
+			shuf = shuf_RGBA32;
+			has_alpha = (px_format == PixelFormat::Host_RGBA32);
+			break;
+
+		case PixelFormat::Swap_ARGB32:
+		case PixelFormat::Swap_xRGB32:
+			shuf = shuf_sARGB32;
+			has_alpha = (px_format == PixelFormat::Swap_ARGB32);
+			break;
+
+		case PixelFormat::Swap_RGBA32:
+		case PixelFormat::Swap_RGBx32:
+			shuf = shuf_sRGBA32;
+			has_alpha = (px_format == PixelFormat::Swap_RGBA32);
+			break;
+
+		case PixelFormat::G16R16:
+			shuf = shuf_G16R16;
+			has_alpha = false;
+			break;
+
+		case PixelFormat::RABG8888:
+			shuf = shuf_RABG8888;
+			has_alpha = true;
+			break;
+
+		default:
+			// FIXME: Add support for other formats.
+			// For now, redirect back to the C++ version.
+			return fromLinear32_cpp(px_format, width, height, img_buf, img_siz, stride);
+	}
+
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * bytespp));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * bytespp))
+	{
+		return nullptr;
+	}
+
+	// Stride adjustment.
+	// NOTE: NEON loads don't require 16-byte alignment,
+	// so any valid stride can be used here.
+	int src_stride_adj = 0;
+	assert(stride >= 0);
+	if (stride > 0) {
+		// Set src_stride_adj to the number of pixels we need to
+		// add to the end of each line to get to the next row.
+		assert(stride % bytespp == 0);
+		assert(stride >= (width * bytespp));
+		if (unlikely(stride % bytespp != 0 || stride < (width * bytespp))) {
+			// Invalid stride.
+			return nullptr;
+		}
+		src_stride_adj = (stride / bytespp) - width;
+	} else {
+		stride = width * bytespp;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	if (px_format == PixelFormat::Host_ARGB32) {
+		// Host-endian ARGB32.
+		// We can directly copy the image data without conversions.
+		if (stride == img->stride()) {
+			// Stride is identical. Copy the whole image all at once.
+			memcpy(img->bits(), img_buf, stride * height);
+		} else {
+			// Stride is not identical. Copy each scanline.
+			const int dest_stride = img->stride() / sizeof(uint32_t);
+			uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+			const unsigned int copy_len = static_cast<unsigned int>(width * bytespp);
+			for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+				memcpy(px_dest, img_buf, copy_len);
+				img_buf += (stride / bytespp);
+				px_dest += dest_stride;
+			}
+		}
+		// Set the sBIT metadata.
+		static const rp_image::sBIT_t sBIT_A32 = {8,8,8,0,8};
+		img->set_sBIT(&sBIT_A32);
+		return img;
+	}
+
+	const int dest_stride_adj = (img->stride() / sizeof(uint32_t)) - img->width();
+	uint32_t *px_dest = static_cast<uint32_t*>(img->bits());
+
+	const uint8x8_t shuf_mask = vld1_u8(shuf);
+	// If the image doesn't have an alpha channel, set it to 0xFF.
+	const uint32x4_t alpha_mask = vdupq_n_u32(has_alpha ? 0U : 0xFF000000U);
+
+	// Shuffle 4 pixels using NEON.
+#define SHUFFLE_ARGB32_NEON(v) \
+	vorrq_u32(alpha_mask, vreinterpretq_u32_u8(vcombine_u8( \
+		vtbl1_u8(vget_low_u8(v), shuf_mask), \
+		vtbl1_u8(vget_high_u8(v), shuf_mask))))
+
+	for (unsigned int y = static_cast<unsigned int>(height); y > 0; y--) {
+		// Process 8 pixels per iteration using NEON.
+		unsigned int x = static_cast<unsigned int>(width);
+		for (; x > 7; x -= 8, px_dest += 8, img_buf += 8) {
+			const uint8x16_t sa = vld1q_u8(reinterpret_cast<const uint8_t*>(&img_buf[0]));
+			const uint8x16_t sb = vld1q_u8(reinterpret_cast<const uint8_t*>(&img_buf[4]));
+
+			vst1q_u32(&px_dest[0], SHUFFLE_ARGB32_NEON(sa));
+			vst1q_u32(&px_dest[4], SHUFFLE_ARGB32_NEON(sb));
+		}
+
+		// Remaining pixels.
+		// Use a temporary buffer so the same shuffle can be used.
+		if (x > 0) {
+			uint32_t tmp[4];
+			do {
+				const unsigned int n = (x > 4 ? 4 : x);
+				memcpy(tmp, img_buf, n * sizeof(uint32_t));
+				const uint8x16_t sa = vld1q_u8(reinterpret_cast<const uint8_t*>(tmp));
+				vst1q_u32(tmp, SHUFFLE_ARGB32_NEON(sa));
+				memcpy(px_dest, tmp, n * sizeof(uint32_t));
+
+				x -= n;
+				img_buf += n;
+				px_dest += n;
+			} while (x > 0);
+		}
+
+		// Next line.
+		img_buf += src_stride_adj;
+		px_dest += dest_stride_adj;
+	}
+#undef SHUFFLE_ARGB32_NEON
+
+	// Set the sBIT metadata.
+	if (has_alpha) {
+		static const rp_image::sBIT_t sBIT_A32 = {8,8,8,0,8};
+		img->set_sBIT(&sBIT_A32);
+	} else if (unlikely(px_format == PixelFormat::G16R16)) {
+		static const rp_image::sBIT_t sBIT_G16R16 = {8,8,1,0,0};
+		img->set_sBIT(&sBIT_G16R16);
+	} else {
+		static const rp_image::sBIT_t sBIT_x32 = {8,8,8,0,0};
+		img->set_sBIT(&sBIT_x32);
+	}
+
+	// Image has been converted.
+	return img;
+}
+
+} }
+
+#endif /* IMAGEDECODER_HAS_NEON */
@@ -0,0 +1,255 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_N3DS.cpp: Image decoding functions. (Nintendo 3DS)         *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+
+// MSVC complains when the high bit is set in hex values
+// when setting SSE2 registers.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4309)
+#endif
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * N3DS uses 3-level Z-ordered tiling within each 8x8 tile.
+ * Pixel index bits, LSB first: x0, y0, x1, y1, x2, y2
+ *
+ * For a pair of rows (y0 == 0, 1), the pixels are stored as two
+ * runs of 8 pixels: x2 == 0 and x2 == 1. Within each run, 32-bit
+ * dwords 0 and 2 are the even row, and dwords 1 and 3 are the
+ * odd row, so a single pshufd separates the rows.
+ *
+ * @param lo	[in] Pixels 0-7 of the run. (x = 0-3)
+ * @param hi	[in] Pixels 0-7 of the run. (x = 4-7)
+ * @param row0	[out] Even row. (16-bit pixels, x = 0-7)
+ * @param row1	[out] Odd row. (16-bit pixels, x = 0-7)
+ */
+static FORCEINLINE void untwiddle_row_pair(__m128i lo, __m128i hi, __m128i &row0, __m128i &row1)
+{
+	lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3,1,2,0));
+	hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3,1,2,0));
+	row0 = _mm_unpacklo_epi64(lo, hi);
+	row1 = _mm_unpackhi_epi64(lo, hi);
+}
+
+/**
+ * Convert 8 RGB565 pixels to ARGB32 and store them.
+ * @param px	[in] RGB565 pixels. (host-endian)
+ * @param a8	[in] 8-bit alpha values, in the high byte of each word.
+ * @param pDest	[out] Destination. (must be 16-byte aligned)
+ */
+static FORCEINLINE void RGB565_to_ARGB32_sse2(__m128i px, __m128i a8, uint32_t *pDest)
+{
+	const __m128i mask_F8 = _mm_set1_epi16(0x00F8);
+	const __m128i mask_FC = _mm_set1_epi16(0x00FC);
+
+	// RGB565: RRRRRGGG GGGBBBBB
+	__m128i b = _mm_and_si128(_mm_slli_epi16(px, 3), mask_F8);
+	__m128i g = _mm_and_si128(_mm_srli_epi16(px, 3), mask_FC);
+	__m128i r = _mm_and_si128(_mm_srli_epi16(px, 8), mask_F8);
+	b = _mm_or_si128(b, _mm_srli_epi16(b, 5));
+	g = _mm_or_si128(g, _mm_srli_epi16(g, 6));
+	r = _mm_or_si128(r, _mm_srli_epi16(r, 5));
+
+	const __m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+	const __m128i ra = _mm_or_si128(r, a8);
+
+	__m128i *const xmm_dest = reinterpret_cast<__m128i*>(pDest);
+	_mm_store_si128(&xmm_dest[0], _mm_unpacklo_epi16(bg, ra));
+	_mm_store_si128(&xmm_dest[1], _mm_unpackhi_epi16(bg, ra));
+}
+
+/**
+ * Expand 8 A4 values to 8-bit alpha in the high byte of each word.
+ * @param a4	[in] Pointer to 4 bytes of A4 data. (LeftLSN)
+ * @return 8-bit alpha values.
+ */
+static FORCEINLINE __m128i expand_A4_sse2(const uint8_t *a4)
+{
+	const __m128i mask_0F = _mm_set1_epi8(0x0F);
+
+	uint32_t a32;
+	memcpy(&a32, a4, sizeof(a32));
+	const __m128i a = _mm_cvtsi32_si128(static_cast<int>(a32));
+	const __m128i lsn = _mm_and_si128(a, mask_0F);
+	const __m128i msn = _mm_and_si128(_mm_srli_epi16(a, 4), mask_0F);
+
+	// Interleave the nybbles: LSN is the first pixel.
+	// Each nybble ends up in the high byte of a word.
+	__m128i a8 = _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_unpacklo_epi8(lsn, msn));
+	return _mm_or_si128(a8, _mm_slli_epi16(a8, 4));
+}
+
+/**
+ * Convert a Nintendo 3DS RGB565 or RGB565+A4 tiled image.
+ * @tparam hasAlpha If true, use the A4 alpha buffer.
+ * @param img Destination image. (must be ARGB32)
+ * @param img_buf RGB565 tiled image buffer.
+ * @param alpha_buf A4 tiled alpha buffer. (if hasAlpha)
+ */
+template<bool hasAlpha>
+static inline void T_fromN3DSTiled_sse2(rp_image *img,
+	const uint16_t *RESTRICT img_buf, const uint8_t *RESTRICT alpha_buf)
+{
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(img->width() / 8);
+	const unsigned int tilesY = static_cast<unsigned int>(img->height() / 8);
+
+	uint32_t *const pImgBuf = static_cast<uint32_t*>(img->bits());
+	const int stride_px = img->stride() / sizeof(uint32_t);
+
+	const __m128i alpha_FF = _mm_set1_epi16(0xFF00);
+	__m128i a8_row0 = alpha_FF, a8_row1 = alpha_FF;
+
+	for (unsigned int y = 0; y < tilesY; y++) {
+		uint32_t *pTileDest = pImgBuf + (y * 8 * stride_px);
+		for (unsigned int x = 0; x < tilesX; x++, pTileDest += 8) {
+			// Each pair of rows is stored as pixels [base, base+8) and [base+16, base+24),
+			// where base = (y1 << 3) | (y2 << 5).
+			for (unsigned int row = 0; row < 8; row += 2) {
+				const unsigned int base = ((row & 2) << 2) | ((row & 4) << 3);
+
+				__m128i row0, row1;
+				untwiddle_row_pair(
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[base])),
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(&img_buf[base + 16])),
+					row0, row1);
+				if (hasAlpha) {
+					untwiddle_row_pair(
+						expand_A4_sse2(&alpha_buf[base / 2]),
+						expand_A4_sse2(&alpha_buf[(base + 16) / 2]),
+						a8_row0, a8_row1);
+				}
+
+				RGB565_to_ARGB32_sse2(row0, a8_row0, &pTileDest[(row+0) * stride_px]);
+				RGB565_to_ARGB32_sse2(row1, a8_row1, &pTileDest[(row+1) * stride_px]);
+			}
+
+			img_buf += 8*8;
+			if (hasAlpha) {
+				alpha_buf += (8*8) / 2;
+			}
+		}
+	}
+}
+
+/**
+ * Convert a Nintendo 3DS RGB565 tiled icon to rp_image.
+ * SSE2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromN3DSTiledRGB565_sse2(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * 2))
+	{
+		return nullptr;
+	}
+
+	// N3DS tiled images use 8x8 tiles.
+	assert(width % 8 == 0);
+	assert(height % 8 == 0);
+	if (width % 8 != 0 || height % 8 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	T_fromN3DSTiled_sse2<false>(img, img_buf, nullptr);
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {5,6,5,0,0};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a Nintendo 3DS RGB565+A4 tiled icon to rp_image.
+ * SSE2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf RGB565 tiled image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param alpha_buf A4 tiled alpha buffer.
+ * @param alpha_siz Size of alpha data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromN3DSTiledRGB565_A4_sse2(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(alpha_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(img_siz >= ((width * height) * 2));
+	assert(alpha_siz >= ((width * height) / 2));
+	if (!img_buf || !alpha_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((width * height) * 2) ||
+	    alpha_siz < ((width * height) / 2))
+	{
+		return nullptr;
+	}
+
+	// N3DS tiled images use 8x8 tiles.
+	assert(width % 8 == 0);
+	assert(height % 8 == 0);
+	if (width % 8 != 0 || height % 8 != 0)
+		return nullptr;
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// FIXME: Nybble ordering for A4?
+	// Assuming LeftLSN, same as NDS CI4.
+	T_fromN3DSTiled_sse2<true>(img, img_buf, alpha_buf);
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {5,6,5,0,4};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+} }
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
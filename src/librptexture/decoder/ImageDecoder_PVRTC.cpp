@@ -24,6 +24,7 @@ namespace LibRpTexture { namespace ImageDecoder {
 
 /**
  * Convert a PVRTC 2bpp or 4bpp image to rp_image.
+ * Standard version using the PowerVR Native SDK.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf PVRTC image buffer.
@@ -31,7 +32,7 @@ namespace LibRpTexture { namespace ImageDecoder {
  * @param mode Mode bitfield. (See PVRTC_Mode_e.)
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromPVRTC(int width, int height,
+rp_image *fromPVRTC_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz,
 	uint8_t mode)
 {
@@ -99,7 +100,8 @@ rp_image *fromPVRTC(int width, int height,
 }
 
 /**
- * Convert a PVRTC 2bpp or 4bpp image to rp_image.
+ * Convert a PVRTC-II 2bpp or 4bpp image to rp_image.
+ * Standard version using the PowerVR Native SDK.
  * @param width Image width.
  * @param height Image height.
  * @param img_buf PVRTC image buffer.
@@ -107,7 +109,7 @@ rp_image *fromPVRTC(int width, int height,
  * @param mode Mode bitfield. (See PVRTC_Mode_e.)
  * @return rp_image, or nullptr on error.
  */
-rp_image *fromPVRTCII(int width, int height,
+rp_image *fromPVRTCII_cpp(int width, int height,
 	const uint8_t *RESTRICT img_buf, int img_siz,
 	uint8_t mode)
 {
@@ -139,7 +141,7 @@ rp_image *fromPVRTCII(int width, int height,
 	}
 
 	// Create an rp_image.
-	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
 		// Could not allocate the image.
 		img->unref();
@@ -0,0 +1,518 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_PVRTC_sse2.cpp: Image decoding functions. (PVRTC)          *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2019-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+
+// References:
+// - https://www.khronos.org/registry/OpenGL/extensions/IMG/IMG_texture_compression_pvrtc.txt
+// - http://cdn2.imgtec.com/documentation/PVRTextureCompression.pdf
+
+// The standard decoder uses the PowerVR Native SDK, which decodes each
+// 2x2 group of words separately, so the bilinear upscaling and the
+// modulation unpacking is redone for every word four times.
+//
+// This decoder handles the whole image at once:
+// - Color A and B of every word are unpacked once.
+// - Modulation values are unpacked into a per-pixel map once.
+//   (PVRTC 2bpp interpolated values are filled in afterwards.)
+// - Each row is upscaled vertically, then horizontally, and
+//   modulated using SSE2, two pixels at a time.
+//
+// The output is bit-exact with the PowerVR Native SDK.
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+// Modulation map: punchthrough alpha flag.
+// The lower 4 bits contain the modulation value. (0-8)
+static const uint8_t PVRTC_MOD_PUNCHTHROUGH = 0x10;
+
+/**
+ * Get Color A from a PVRTC word.
+ * @tparam isPVRTCII	[in] If true, this is PVRTC-II.
+ * @param colorData	[in] Color data.
+ * @param bgra		[out] Color A. (B, G, R, A; 5-bit RGB, 4-bit alpha)
+ */
+template<bool isPVRTCII>
+static inline void getColorA(uint32_t colorData, int16_t bgra[4])
+{
+	const uint32_t opaque_flag = (isPVRTCII ? 0x80000000 : 0x8000);
+	if (colorData & opaque_flag) {
+		// Opaque Color Mode: RGB554
+		bgra[0] = (colorData & 0x1E) | ((colorData & 0x1E) >> 4);
+		bgra[1] = (colorData & 0x3E0) >> 5;
+		bgra[2] = (colorData & 0x7C00) >> 10;
+		bgra[3] = 0xF;
+	} else {
+		// Transparent Color Mode: ARGB3443
+		bgra[0] = ((colorData & 0xE) << 1) | ((colorData & 0xE) >> 2);
+		bgra[1] = ((colorData & 0xF0) >> 3) | ((colorData & 0xF0) >> 7);
+		bgra[2] = ((colorData & 0xF00) >> 7) | ((colorData & 0xF00) >> 11);
+		bgra[3] = (colorData & 0x7000) >> 11;
+	}
+}
+
+/**
+ * Get Color B from a PVRTC word.
+ * @tparam isPVRTCII	[in] If true, this is PVRTC-II.
+ * @param colorData	[in] Color data.
+ * @param bgra		[out] Color B. (B, G, R, A; 5-bit RGB, 4-bit alpha)
+ */
+template<bool isPVRTCII>
+static inline void getColorB(uint32_t colorData, int16_t bgra[4])
+{
+	if (colorData & 0x80000000) {
+		// Opaque Color Mode: RGB555
+		bgra[0] = (colorData & 0x1F0000) >> 16;
+		bgra[1] = (colorData & 0x3E00000) >> 21;
+		bgra[2] = (colorData & 0x7C000000) >> 26;
+		bgra[3] = 0xF;
+	} else {
+		// Transparent Color Mode: ARGB3444
+		bgra[0] = ((colorData & 0xF0000) >> 15) | ((colorData & 0xF0000) >> 19);
+		bgra[1] = ((colorData & 0xF00000) >> 19) | ((colorData & 0xF00000) >> 23);
+		bgra[2] = ((colorData & 0xF000000) >> 23) | ((colorData & 0xF000000) >> 27);
+		bgra[3] = (colorData & 0x70000000) >> 27;
+		if (isPVRTCII) {
+			// PVRTC-II sets the low alpha bit of Color B to 1, not 0.
+			bgra[3] |= 1;
+		}
+	}
+}
+
+/**
+ * Get the word index for the specified word position.
+ * PVRTC-I uses Morton order; PVRTC-II uses linear order.
+ * @tparam isPVRTCII	[in] If true, this is PVRTC-II.
+ * @param numX		[in] Width, in words.
+ * @param numY		[in] Height, in words.
+ * @param wx		[in] Word X position.
+ * @param wy		[in] Word Y position.
+ * @return Word index.
+ */
+template<bool isPVRTCII>
+static inline unsigned int getWordIndex(unsigned int numX, unsigned int numY, unsigned int wx, unsigned int wy)
+{
+	if (isPVRTCII) {
+		return (wy * numX) + wx;
+	}
+
+	// Interleave the bits of the smaller dimension,
+	// then append the remaining bits of the larger one.
+	unsigned int minDimension = numX;
+	unsigned int maxValue = wy;
+	if (numY < numX) {
+		minDimension = numY;
+		maxValue = wx;
+	}
+
+	unsigned int twiddled = 0;
+	unsigned int srcBit = 1, dstBit = 1;
+	unsigned int shiftCount = 0;
+	for (; srcBit < minDimension; srcBit <<= 1, dstBit <<= 2, shiftCount++) {
+		if (wy & srcBit)
+			twiddled |= dstBit;
+		if (wx & srcBit)
+			twiddled |= (dstBit << 1);
+	}
+
+	return twiddled | ((maxValue >> shiftCount) << (2 * shiftCount));
+}
+
+/**
+ * Unpack the modulation values of a PVRTC 4bpp word.
+ * @param pMod		[out] Modulation map at the word's top-left pixel.
+ * @param stride	[in] Modulation map stride.
+ * @param word		[in] PVRTC word. (modulation data, color data)
+ */
+static inline void unpackModulation_4bpp(uint8_t *pMod, unsigned int stride, const uint32_t word[2])
+{
+	// Mode 0: Standard bilinear. (0, 3/8, 5/8, 1)
+	// Mode 1: Punchthrough alpha. (0, 1/2, 1/2 + transparent, 1)
+	static const uint8_t modTbl[2][4] = {
+		{0, 3, 5, 8},
+		{0, 4, PVRTC_MOD_PUNCHTHROUGH | 4, 8},
+	};
+	const uint8_t *const tbl = modTbl[word[1] & 1];
+
+	uint32_t modBits = word[0];
+	for (unsigned int y = 0; y < 4; y++, pMod += stride) {
+		for (unsigned int x = 0; x < 4; x++, modBits >>= 2) {
+			pMod[x] = tbl[modBits & 3];
+		}
+	}
+}
+
+/**
+ * Unpack the modulation values of a PVRTC 2bpp word.
+ * Interpolated values are not filled in here.
+ * @param pMod		[out] Modulation map at the word's top-left pixel.
+ * @param stride	[in] Modulation map stride.
+ * @param word		[in] PVRTC word. (modulation data, color data)
+ * @return Modulation mode. (0 == direct; 1 == H+V; 2 == H-only; 3 == V-only)
+ */
+static inline uint8_t unpackModulation_2bpp(uint8_t *pMod, unsigned int stride, const uint32_t word[2])
+{
+	static const uint8_t repVals[4] = {0, 3, 5, 8};
+	uint32_t modBits = word[0];
+
+	if (!(word[1] & 1)) {
+		// Direct encoding: 1 bit per pixel.
+		for (unsigned int y = 0; y < 4; y++, pMod += stride) {
+			for (unsigned int x = 0; x < 8; x++, modBits >>= 1) {
+				pMod[x] = (modBits & 1) ? 8 : 0;
+			}
+		}
+		return 0;
+	}
+
+	// Interpolated encoding: 2 bits per stored pixel, checkerboard pattern.
+	uint8_t modMode = 1;
+	if (modBits & 1) {
+		// The LSB of the center texel (y == 2, x == 4) selects H-only or V-only.
+		modMode = (modBits & (1U << 20)) ? 3 : 2;
+		// Duplicate the center texel's remaining bit.
+		if (modBits & (1U << 21)) {
+			modBits |= (1U << 20);
+		} else {
+			modBits &= ~(1U << 20);
+		}
+	}
+	// Duplicate the first texel's remaining bit.
+	if (modBits & 2) {
+		modBits |= 1;
+	} else {
+		modBits &= ~1U;
+	}
+
+	for (unsigned int y = 0; y < 4; y++, pMod += stride) {
+		for (unsigned int x = (y & 1); x < 8; x += 2, modBits >>= 2) {
+			pMod[x] = repVals[modBits & 3];
+		}
+	}
+	return modMode;
+}
+
+/**
+ * Convert a PVRTC or PVRTC-II image to rp_image.
+ * @tparam isPVRTCII	[in] If true, this is PVRTC-II.
+ * @param img		[in/out] rp_image. (ARGB32; must be physWidth x physHeight)
+ * @param img_buf	[in] PVRTC image buffer.
+ * @param is2bpp	[in] If true, this is 2bpp; otherwise, 4bpp.
+ */
+template<bool isPVRTCII>
+static void T_decodePVRTC_sse2(rp_image *img, const uint8_t *RESTRICT img_buf, bool is2bpp)
+{
+	const unsigned int width = static_cast<unsigned int>(img->width());
+	const unsigned int height = static_cast<unsigned int>(img->height());
+	const unsigned int wordW = (is2bpp ? 8 : 4);
+	const unsigned int wordH = 4;
+	const unsigned int numX = width / wordW;
+	const unsigned int numY = height / wordH;
+
+	// Colors A and B for each word, as 16-bit BGRA.
+	// Rows are padded to an even number of words for SSE2.
+	const unsigned int colStride = ALIGN_BYTES(2, numX) * 4;
+	auto colA = aligned_uptr<int16_t>(16, colStride * numY);
+	auto colB = aligned_uptr<int16_t>(16, colStride * numY);
+	memset(colA.get(), 0, colStride * numY * sizeof(int16_t));
+	memset(colB.get(), 0, colStride * numY * sizeof(int16_t));
+
+	// Per-pixel modulation map.
+	auto modMap = aligned_uptr<uint8_t>(16, width * height);
+	// Per-word modulation modes. (2bpp only)
+	auto wordModes = aligned_uptr<uint8_t>(16, numX * numY);
+
+	const uint32_t *const pWords = reinterpret_cast<const uint32_t*>(img_buf);
+	for (unsigned int wy = 0; wy < numY; wy++) {
+		int16_t *pColA = colA.get() + (wy * colStride);
+		int16_t *pColB = colB.get() + (wy * colStride);
+		uint8_t *pMod = modMap.get() + (wy * wordH * width);
+		for (unsigned int wx = 0; wx < numX; wx++, pColA += 4, pColB += 4, pMod += wordW) {
+			const uint32_t *const pWord = &pWords[getWordIndex<isPVRTCII>(numX, numY, wx, wy) * 2];
+			const uint32_t word[2] = {le32_to_cpu(pWord[0]), le32_to_cpu(pWord[1])};
+
+			getColorA<isPVRTCII>(word[1], pColA);
+			getColorB<isPVRTCII>(word[1], pColB);
+			if (is2bpp) {
+				wordModes.get()[(wy * numX) + wx] = unpackModulation_2bpp(pMod, width, word);
+			} else {
+				unpackModulation_4bpp(pMod, width, word);
+			}
+		}
+	}
+
+	if (is2bpp) {
+		// Fill in the interpolated modulation values.
+		// These are averaged from the neighboring stored values,
+		// which may be in adjacent words. (wrapping around the edges)
+		uint8_t *const pModMap = modMap.get();
+		for (unsigned int y = 0; y < height; y++) {
+			const uint8_t *const pModUp = pModMap + (((y + height - 1) % height) * width);
+			const uint8_t *const pModDown = pModMap + (((y + 1) % height) * width);
+			uint8_t *const pMod = pModMap + (y * width);
+			const uint8_t *const pWordMode = wordModes.get() + ((y / wordH) * numX);
+			for (unsigned int x = (~y & 1); x < width; x += 2) {
+				const unsigned int xl = (x + width - 1) % width;
+				const unsigned int xr = (x + 1) % width;
+				switch (pWordMode[x / wordW]) {
+					default:
+					case 0:
+						// Direct encoding: All values are stored.
+						break;
+					case 1:
+						// H+V interpolation
+						pMod[x] = (pModUp[x] + pModDown[x] + pMod[xl] + pMod[xr] + 2) / 4;
+						break;
+					case 2:
+						// H-only interpolation
+						pMod[x] = (pMod[xl] + pMod[xr] + 1) / 2;
+						break;
+					case 3:
+						// V-only interpolation
+						pMod[x] = (pModUp[x] + pModDown[x] + 1) / 2;
+						break;
+				}
+			}
+		}
+	}
+
+	uint8_t *const pImgBits = static_cast<uint8_t*>(img->bits());
+	const int stride = img->stride();
+	const uint8_t *const pModMap = modMap.get();
+	const int16_t *const pColA = colA.get();
+	const int16_t *const pColB = colB.get();
+
+	ImageDecoderPrivate::decodeTileRows(img, numY,
+		[=](unsigned int yStart, unsigned int yEnd)
+	{
+		// Vertically-upscaled colors for the current row. (one per word)
+		auto vertA_buf = aligned_uptr<int16_t>(16, colStride);
+		auto vertB_buf = aligned_uptr<int16_t>(16, colStride);
+		int16_t *const vertA = vertA_buf.get();
+		int16_t *const vertB = vertB_buf.get();
+
+		// Pixels are interpolated between the centers of four words.
+		// Total weight is wordW * wordH: 16 for 4bpp; 32 for 2bpp.
+		// For 2bpp, the extra bit is discarded before expanding to 8-bit.
+		const __m128i alphaMask = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+		const __m128i punchMask = (isPVRTCII ? _mm_set1_epi16(-1) : alphaMask);
+		const __m128i modMask = _mm_set1_epi16(0x0F);
+		const __m128i modPunch = _mm_set1_epi16(PVRTC_MOD_PUNCHTHROUGH - 1);
+		const __m128i xmm_wordW = _mm_set1_epi16(static_cast<short>(wordW));
+		const int expShift = (is2bpp ? 1 : 0);
+
+		for (unsigned int y = yStart * wordH; y < yEnd * wordH; y++) {
+			// Vertical pass: Interpolate between word rows P and R.
+			const unsigned int cy = y + height - (wordH / 2);
+			const unsigned int rowP = (cy / wordH) % numY;
+			const unsigned int rowR = (rowP + 1) % numY;
+			const short r = static_cast<short>(cy % wordH);
+			const __m128i wP = _mm_set1_epi16(static_cast<short>(wordH) - r);
+			const __m128i wR = _mm_set1_epi16(r);
+			for (unsigned int i = 0; i < colStride; i += 8) {
+				const __m128i aP = _mm_load_si128(reinterpret_cast<const __m128i*>(&pColA[(rowP * colStride) + i]));
+				const __m128i aR = _mm_load_si128(reinterpret_cast<const __m128i*>(&pColA[(rowR * colStride) + i]));
+				const __m128i bP = _mm_load_si128(reinterpret_cast<const __m128i*>(&pColB[(rowP * colStride) + i]));
+				const __m128i bR = _mm_load_si128(reinterpret_cast<const __m128i*>(&pColB[(rowR * colStride) + i]));
+				_mm_store_si128(reinterpret_cast<__m128i*>(&vertA[i]),
+					_mm_add_epi16(_mm_mullo_epi16(aP, wP), _mm_mullo_epi16(aR, wR)));
+				_mm_store_si128(reinterpret_cast<__m128i*>(&vertB[i]),
+					_mm_add_epi16(_mm_mullo_epi16(bP, wP), _mm_mullo_epi16(bR, wR)));
+			}
+
+			// Horizontal pass: Interpolate between word columns P and Q,
+			// then modulate. Two pixels are processed per iteration.
+			// Pixel x is at offset (x + wordW/2) % wordW from the center of word P.
+			uint32_t *const pDest = reinterpret_cast<uint32_t*>(pImgBits + (y * stride));
+			const uint8_t *const pMod = pModMap + (y * width);
+			for (unsigned int x = 0; x < width; x += 2) {
+				const unsigned int cx = x + width - (wordW / 2);
+				const unsigned int colP = (cx / wordW) % numX;
+				const unsigned int colQ = (colP + 1) % numX;
+				const short c = static_cast<short>(cx % wordW);
+
+				// Weights for pixels c and c+1: [wordW - c, c]
+				const __m128i wQ = _mm_setr_epi16(c, c, c, c, c+1, c+1, c+1, c+1);
+				const __m128i wP2 = _mm_sub_epi16(xmm_wordW, wQ);
+
+				const __m128i aP = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&vertA[colP * 4]));
+				const __m128i aQ = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&vertA[colQ * 4]));
+				const __m128i bP = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&vertB[colP * 4]));
+				const __m128i bQ = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&vertB[colQ * 4]));
+				__m128i upA = _mm_add_epi16(
+					_mm_mullo_epi16(_mm_unpacklo_epi64(aP, aP), wP2),
+					_mm_mullo_epi16(_mm_unpacklo_epi64(aQ, aQ), wQ));
+				__m128i upB = _mm_add_epi16(
+					_mm_mullo_epi16(_mm_unpacklo_epi64(bP, bP), wP2),
+					_mm_mullo_epi16(_mm_unpacklo_epi64(bQ, bQ), wQ));
+
+				// Expand to 8-bit:
+				// - RGB: (v >> 6) + (v >> 1)
+				// - Alpha: (v >> 4) + v
+				upA = _mm_srli_epi16(upA, expShift);
+				upB = _mm_srli_epi16(upB, expShift);
+				upA = _mm_or_si128(
+					_mm_andnot_si128(alphaMask, _mm_add_epi16(_mm_srli_epi16(upA, 6), _mm_srli_epi16(upA, 1))),
+					_mm_and_si128(alphaMask, _mm_add_epi16(_mm_srli_epi16(upA, 4), upA)));
+				upB = _mm_or_si128(
+					_mm_andnot_si128(alphaMask, _mm_add_epi16(_mm_srli_epi16(upB, 6), _mm_srli_epi16(upB, 1))),
+					_mm_and_si128(alphaMask, _mm_add_epi16(_mm_srli_epi16(upB, 4), upB)));
+
+				// Modulation values: [m0 x4, m1 x4]
+				__m128i mod = _mm_cvtsi32_si128(pMod[x] | (pMod[x+1] << 16));
+				mod = _mm_unpacklo_epi16(mod, mod);
+				mod = _mm_unpacklo_epi32(mod, mod);
+				const __m128i isPunch = _mm_cmpgt_epi16(mod, modPunch);
+				mod = _mm_and_si128(mod, modMask);
+
+				// ((A * (8 - mod)) + (B * mod)) / 8
+				__m128i px = _mm_add_epi16(_mm_slli_epi16(upA, 3),
+					_mm_mullo_epi16(_mm_sub_epi16(upB, upA), mod));
+				px = _mm_srli_epi16(px, 3);
+
+				// Punchthrough alpha:
+				// - PVRTC-I: Alpha is 0.
+				// - PVRTC-II: ARGB are all 0.
+				px = _mm_andnot_si128(_mm_and_si128(isPunch, punchMask), px);
+
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(&pDest[x]), _mm_packus_epi16(px, px));
+			}
+		}
+	});
+}
+
+/**
+ * Convert a PVRTC 2bpp or 4bpp image to rp_image.
+ * SSE2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromPVRTC_sse2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	const bool is2bpp = ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP);
+	const int expected_size_in = ((width * height) / (is2bpp ? 4 : 2));
+
+	assert(img_siz >= expected_size_in);
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < expected_size_in)
+	{
+		return nullptr;
+	}
+
+	// PVRTC 2bpp uses 8x4 tiles.
+	// PVRTC 4bpp uses 4x4 tiles.
+	if (is2bpp) {
+		// PVRTC 2bpp
+		assert(width % 8 == 0);
+		assert(height % 4 == 0);
+		if (width % 8 != 0 || height % 4 != 0)
+			return nullptr;
+	} else {
+		// PVRTC 4bpp
+		assert(width % 4 == 0);
+		assert(height % 4 == 0);
+		if (width % 4 != 0 || height % 4 != 0)
+			return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	T_decodePVRTC_sse2<false>(img, img_buf, is2bpp);
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT_alpha  = {8,8,8,0,8};
+	static const rp_image::sBIT_t sBIT_opaque = {8,8,8,0,0};
+	img->set_sBIT(((mode & PVRTC_ALPHA_MASK) == PVRTC_ALPHA_YES) ? &sBIT_alpha : &sBIT_opaque);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a PVRTC-II 2bpp or 4bpp image to rp_image.
+ * SSE2-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf PVRTC image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/4]
+ * @param mode Mode bitfield. (See PVRTC_Mode_e.)
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromPVRTCII_sse2(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// PVRTC-II uses 4x4 tiles (4bpp) or 8x4 tiles (2bpp), but
+	// PVRTC-II allows the last tile to be cut off, so round
+	// up for the physical tile size.
+	const bool is2bpp = ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP);
+	const int physWidth = (is2bpp ? ALIGN_BYTES(8, width) : ALIGN_BYTES(4, width));
+	const int physHeight = ALIGN_BYTES(4, height);
+	const int expected_size_in = ((physWidth * physHeight) / (is2bpp ? 4 : 2));
+
+	assert(img_siz >= expected_size_in);
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < expected_size_in)
+	{
+		return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	T_decodePVRTC_sse2<true>(img, img_buf, is2bpp);
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	// NOTE: Assuming PVRTC-II always has alpha for now.
+	static const rp_image::sBIT_t sBIT  = {8,8,8,0,8};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+} }
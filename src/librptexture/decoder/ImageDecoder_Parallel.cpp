@@ -0,0 +1,116 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_Parallel.cpp: Multithreaded tile row decoding.             *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// librpthreads
+#include "librpthreads/Atomics.h"
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::ThreadPool;
+
+namespace LibRpTexture {
+
+// Out-of-class definitions for the constants, since they're
+// ODR-used in some builds.
+const unsigned int ImageDecoderPrivate::PARALLEL_MIN_PIXELS;
+const unsigned int ImageDecoderPrivate::PARALLEL_STRIPS_PER_THREAD;
+
+// Maximum number of decoding threads. (0 == thread pool size)
+volatile int ImageDecoderPrivate::maxThreads = 0;
+
+namespace {
+
+struct TileRowJob {
+	ImageDecoderPrivate::pfnDecodeTileRows_t func;
+	void *param;
+};
+
+/**
+ * Tile row decoding function for ThreadPool::parallelFor().
+ * @param param TileRowJob
+ * @param begin First tile row
+ * @param end Last tile row, plus one
+ */
+void tileRowRange(void *param, size_t begin, size_t end)
+{
+	const TileRowJob *const job = static_cast<const TileRowJob*>(param);
+	job->func(job->param, static_cast<unsigned int>(begin), static_cast<unsigned int>(end));
+}
+
+}
+
+/**
+ * Decode all tile rows in an image.
+ *
+ * If the image has at least PARALLEL_MIN_PIXELS pixels, it will be
+ * split into horizontal strips of tile rows, which are decoded by
+ * the process-wide ThreadPool. Otherwise, all tile rows are decoded
+ * on the calling thread.
+ *
+ * The decoding function must only write to its own tile rows.
+ *
+ * @param img		[in] rp_image being decoded
+ * @param tilesY	[in] Number of tile rows
+ * @param func		[in] Tile row decoding function
+ * @param param		[in] Function parameter
+ */
+void ImageDecoderPrivate::decodeTileRows(const rp_image *img, unsigned int tilesY,
+	pfnDecodeTileRows_t func, void *param)
+{
+	assert(img != nullptr);
+	assert(func != nullptr);
+	if (tilesY == 0)
+		return;
+
+	const unsigned int maxThreads = static_cast<unsigned int>(ImageDecoderPrivate::maxThreads);
+	if (maxThreads == 1 || static_cast<int64_t>(img->width()) * img->height() < PARALLEL_MIN_PIXELS) {
+		// Decode everything on the calling thread.
+		func(param, 0, tilesY);
+		return;
+	}
+
+	TileRowJob job;
+	job.func = func;
+	job.param = param;
+
+	// parallelFor() never runs more chunks at once than there are
+	// chunks, so if the thread count was limited, use one strip per
+	// thread. Otherwise, use more strips than threads to prevent one
+	// slow strip from holding up the entire image.
+	ThreadPool *const pool = ThreadPool::instance();
+	unsigned int strips;
+	if (maxThreads != 0) {
+		strips = maxThreads;
+	} else {
+		strips = (pool->threadCount() + 1) * PARALLEL_STRIPS_PER_THREAD;
+	}
+	strips = std::min(strips, tilesY);
+	const unsigned int rowsPerStrip = (tilesY + strips - 1) / strips;
+
+	pool->parallelFor(0, tilesY, tileRowRange, &job, rowsPerStrip);
+}
+
+namespace ImageDecoder {
+
+/**
+ * Set the maximum number of threads used to decode large
+ * block-compressed images. (BC7, ETC1/ETC2, S3TC)
+ * Small images are always decoded on the calling thread.
+ * @param threads Maximum number of threads (0 for the thread pool size; 1 to disable multithreading)
+ */
+void setMaxThreads(unsigned int threads)
+{
+	ATOMIC_EXCHANGE(&ImageDecoderPrivate::maxThreads, static_cast<int>(threads));
+}
+
+}
+
+}
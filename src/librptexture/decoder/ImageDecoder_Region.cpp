@@ -0,0 +1,303 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_Region.cpp: Image decoding functions: Partial regions.     *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Verify a region of an image.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param x		[in] Region X position.
+ * @param y		[in] Region Y position.
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return True if the region is valid; false if not.
+ */
+static inline bool isRegionValid(int width, int height, int x, int y, int w, int h)
+{
+	return (width > 0 && height > 0 &&
+	        x >= 0 && y >= 0 && w > 0 && h > 0 &&
+	        x < width && y < height &&
+	        w <= (width - x) && h <= (height - y));
+}
+
+/**
+ * Get the starting offset of a region in a linear image.
+ * @param bytespp	[in] Bytes per pixel.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_siz	[in] Size of image data.
+ * @param pStride	[in/out] Stride, in bytes. If 0, set to width*bytespp.
+ * @param x		[in] Region X position.
+ * @param y		[in] Region Y position.
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return Offset of the first pixel in the region, in bytes, or -1 on error.
+ */
+static int linearRegionOffset(int bytespp, int width, int height, int img_siz,
+	int *pStride, int x, int y, int w, int h)
+{
+	assert(isRegionValid(width, height, x, y, w, h));
+	if (!isRegionValid(width, height, x, y, w, h)) {
+		// Invalid region.
+		return -1;
+	}
+
+	int stride = *pStride;
+	if (stride <= 0) {
+		stride = width * bytespp;
+		*pStride = stride;
+	} else if (stride < width * bytespp) {
+		// Stride is too small.
+		return -1;
+	}
+
+	// The last row of the region doesn't need to be padded to the stride.
+	const int64_t offset = (static_cast<int64_t>(y) * stride) + (x * bytespp);
+	const int64_t end = offset + (static_cast<int64_t>(h - 1) * stride) + (w * bytespp);
+	assert(end <= img_siz);
+	if (end > img_siz) {
+		// Image buffer is too small.
+		return -1;
+	}
+	return static_cast<int>(offset);
+}
+
+/**
+ * Check if a region pointer is aligned for the SIMD linear decoders.
+ * The region's starting offset usually isn't a multiple of 16,
+ * so the standard C++ decoders have to be used in that case.
+ * @param ptr Pointer to the first pixel in the region.
+ * @return True if aligned; false if not.
+ */
+static inline bool isAlignedForSIMD(const void *ptr)
+{
+	return (reinterpret_cast<uintptr_t>(ptr) % 16 == 0);
+}
+
+/**
+ * Convert a region of a linear 8-bit RGB image to rp_image.
+ * @param px_format	[in] 8-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 8-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)]
+ * @param stride	[in] Stride, in bytes. If 0, assumes width*bytespp.
+ * @param x		[in] Region X position.
+ * @param y		[in] Region Y position.
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return rp_image with the size of the region, or nullptr on error.
+ */
+rp_image *fromLinear8_region(PixelFormat px_format,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz, int stride,
+	int x, int y, int w, int h)
+{
+	assert(img_buf != nullptr);
+	if (!img_buf)
+		return nullptr;
+
+	const int offset = linearRegionOffset(1, width, height, img_siz, &stride, x, y, w, h);
+	if (offset < 0)
+		return nullptr;
+
+	return fromLinear8(px_format, w, h, img_buf + offset, img_siz - offset, stride);
+}
+
+/**
+ * Convert a region of a linear 16-bit RGB image to rp_image.
+ * @param px_format	[in] 16-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 16-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*2]
+ * @param stride	[in] Stride, in bytes. If 0, assumes width*bytespp.
+ * @param x		[in] Region X position.
+ * @param y		[in] Region Y position.
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return rp_image with the size of the region, or nullptr on error.
+ */
+rp_image *fromLinear16_region(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz, int stride,
+	int x, int y, int w, int h)
+{
+	assert(img_buf != nullptr);
+	if (!img_buf)
+		return nullptr;
+
+	const int offset = linearRegionOffset(2, width, height, img_siz, &stride, x, y, w, h);
+	if (offset < 0)
+		return nullptr;
+
+	const uint16_t *const pRegion = reinterpret_cast<const uint16_t*>(
+		reinterpret_cast<const uint8_t*>(img_buf) + offset);
+	if (!isAlignedForSIMD(pRegion)) {
+		// The SIMD decoders require a 16-byte aligned buffer.
+		return fromLinear16_cpp(px_format, w, h, pRegion, img_siz - offset, stride);
+	}
+	return fromLinear16(px_format, w, h, pRegion, img_siz - offset, stride);
+}
+
+/**
+ * Convert a region of a linear 24-bit RGB image to rp_image.
+ * @param px_format	[in] 24-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 24-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*3]
+ * @param stride	[in] Stride, in bytes. If 0, assumes width*bytespp.
+ * @param x		[in] Region X position.
+ * @param y		[in] Region Y position.
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return rp_image with the size of the region, or nullptr on error.
+ */
+rp_image *fromLinear24_region(PixelFormat px_format,
+	int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz, int stride,
+	int x, int y, int w, int h)
+{
+	assert(img_buf != nullptr);
+	if (!img_buf)
+		return nullptr;
+
+	const int offset = linearRegionOffset(3, width, height, img_siz, &stride, x, y, w, h);
+	if (offset < 0)
+		return nullptr;
+
+	const uint8_t *const pRegion = img_buf + offset;
+	if (!isAlignedForSIMD(pRegion)) {
+		// The SIMD decoders require a 16-byte aligned buffer.
+		return fromLinear24_cpp(px_format, w, h, pRegion, img_siz - offset, stride);
+	}
+	return fromLinear24(px_format, w, h, pRegion, img_siz - offset, stride);
+}
+
+/**
+ * Convert a region of a linear 32-bit RGB image to rp_image.
+ * @param px_format	[in] 32-bit pixel format.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] 32-bit image buffer.
+ * @param img_siz	[in] Size of image data. [must be >= (w*h)*4]
+ * @param stride	[in] Stride, in bytes. If 0, assumes width*bytespp.
+ * @param x		[in] Region X position.
+ * @param y		[in] Region Y position.
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return rp_image with the size of the region, or nullptr on error.
+ */
+rp_image *fromLinear32_region(PixelFormat px_format,
+	int width, int height,
+	const uint32_t *RESTRICT img_buf, int img_siz, int stride,
+	int x, int y, int w, int h)
+{
+	assert(img_buf != nullptr);
+	if (!img_buf)
+		return nullptr;
+
+	const int offset = linearRegionOffset(4, width, height, img_siz, &stride, x, y, w, h);
+	if (offset < 0)
+		return nullptr;
+
+	const uint32_t *const pRegion = reinterpret_cast<const uint32_t*>(
+		reinterpret_cast<const uint8_t*>(img_buf) + offset);
+	if (!isAlignedForSIMD(pRegion)) {
+		// The SIMD decoders require a 16-byte aligned buffer.
+		return fromLinear32_cpp(px_format, w, h, pRegion, img_siz - offset, stride);
+	}
+	return fromLinear32(px_format, w, h, pRegion, img_siz - offset, stride);
+}
+
+/**
+ * Convert a region of a tiled or block-compressed image to rp_image.
+ *
+ * Tiles must be stored in row-major order, and each tile must be
+ * stored contiguously. The tiles that cover the region are gathered
+ * into a temporary buffer, which is then decoded by pfnDecode().
+ * The rest of the image is not decoded.
+ *
+ * @param pfnDecode	[in] Decoding function for the full image format.
+ * @param tileW		[in] Tile width.
+ * @param tileH		[in] Tile height.
+ * @param tileSize	[in] Size of each tile, in bytes.
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param img_buf	[in] Image buffer.
+ * @param img_siz	[in] Size of image data.
+ * @param x		[in] Region X position. [must be a multiple of tileW]
+ * @param y		[in] Region Y position. [must be a multiple of tileH]
+ * @param w		[in] Region width.
+ * @param h		[in] Region height.
+ * @return rp_image with the size of the region, or nullptr on error.
+ */
+rp_image *fromTiled_region(pfnFromTiled_t pfnDecode,
+	int tileW, int tileH, int tileSize,
+	int width, int height,
+	const uint8_t *img_buf, int img_siz,
+	int x, int y, int w, int h)
+{
+	assert(pfnDecode != nullptr);
+	assert(tileW > 0 && tileH > 0 && tileSize > 0);
+	assert(img_buf != nullptr);
+	assert(isRegionValid(width, height, x, y, w, h));
+	assert(x % tileW == 0);
+	assert(y % tileH == 0);
+	if (!pfnDecode || tileW <= 0 || tileH <= 0 || tileSize <= 0 || !img_buf ||
+	    !isRegionValid(width, height, x, y, w, h) ||
+	    x % tileW != 0 || y % tileH != 0)
+	{
+		return nullptr;
+	}
+
+	// Partial tiles at the right and bottom edges are stored as full tiles.
+	const unsigned int tilesX = static_cast<unsigned int>((width + tileW - 1) / tileW);
+	const unsigned int tilesY = static_cast<unsigned int>((height + tileH - 1) / tileH);
+	const size_t srcRowBytes = static_cast<size_t>(tilesX) * tileSize;
+	assert(srcRowBytes * tilesY <= static_cast<size_t>(img_siz));
+	if (srcRowBytes * tilesY > static_cast<size_t>(img_siz)) {
+		// Image buffer is too small.
+		return nullptr;
+	}
+
+	// Tiles covering the region.
+	const unsigned int regTilesX = static_cast<unsigned int>((w + tileW - 1) / tileW);
+	const unsigned int regTilesY = static_cast<unsigned int>((h + tileH - 1) / tileH);
+	const size_t regRowBytes = static_cast<size_t>(regTilesX) * tileSize;
+	const size_t regSize = regRowBytes * regTilesY;
+	const uint8_t *pSrc = img_buf +
+		(static_cast<size_t>(y / tileH) * srcRowBytes) +
+		(static_cast<size_t>(x / tileW) * tileSize);
+
+	if (regTilesX == tilesX) {
+		// The region covers full rows of tiles.
+		// The tile data is already contiguous.
+		return pfnDecode(w, h, pSrc, static_cast<int>(regSize));
+	}
+
+	// Gather the tile rows into a temporary buffer.
+	auto regBuf = aligned_uptr<uint8_t>(16, regSize);
+	uint8_t *pDest = regBuf.get();
+	for (unsigned int ty = regTilesY; ty > 0; ty--) {
+		memcpy(pDest, pSrc, regRowBytes);
+		pDest += regRowBytes;
+		pSrc += srcRowBytes;
+	}
+
+	return pfnDecode(w, h, regBuf.get(), static_cast<int>(regSize));
+}
+
+} }
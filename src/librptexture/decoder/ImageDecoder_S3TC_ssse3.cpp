@@ -0,0 +1,641 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_S3TC.cpp: Image decoding functions. (S3TC)                 *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// SSSE3 headers.
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+// Each DXT1 palette has four ARGB32 colors, so it fits in a single
+// 128-bit register, and pshufb can be used to look up four texels
+// at once. DXT5-style 3-bit channels have an eight-entry palette,
+// which also fits in a register.
+//
+// DXT1 color palettes are calculated for four blocks at a time.
+// The results are identical to the standard C++ version.
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Swap adjacent 16-bit lanes.
+ * @param x Vector.
+ * @return Vector with lanes [1,0,3,2,5,4,7,6].
+ */
+static FORCEINLINE __m128i swap_epi16_pairs(__m128i x)
+{
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(2,3,0,1)), _MM_SHUFFLE(2,3,0,1));
+}
+
+/**
+ * Decode the DXT1 color palettes for four blocks.
+ * @tparam color3_alpha If true, color3 is transparent if color0 <= color1.
+ * @param pal	[out] Palettes: four ARGB32 colors per block.
+ * @param c	[in] RGB565 colors: [c0, c1] for each of the four blocks.
+ */
+template<bool color3_alpha>
+static FORCEINLINE void decode_DXT1_palettes4(__m128i pal[4], __m128i c)
+{
+	// Convert from RGB565 to 8-bit components in 16-bit lanes.
+	// Same expansion as RGB565_to_ARGB32().
+	const __m128i r5 = _mm_srli_epi16(c, 11);
+	const __m128i g6 = _mm_and_si128(_mm_srli_epi16(c, 5), _mm_set1_epi16(0x3F));
+	const __m128i b5 = _mm_and_si128(c, _mm_set1_epi16(0x1F));
+	const __m128i r = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+	const __m128i g = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+	const __m128i b = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+
+	// color0 > color1? (unsigned comparison)
+	// Broadcast the result from the color0 lane to the color1 lane.
+	const __m128i sign = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+	const __m128i cx = _mm_xor_si128(c, sign);
+	__m128i gt = _mm_cmpgt_epi16(cx, swap_epi16_pairs(cx));
+	gt = _mm_shufflehi_epi16(_mm_shufflelo_epi16(gt, _MM_SHUFFLE(2,2,0,0)), _MM_SHUFFLE(2,2,0,0));
+
+	// color3 lanes for blocks where color0 <= color1.
+	const __m128i odd = _mm_setr_epi16(0, -1, 0, -1, 0, -1, 0, -1);
+	const __m128i c3_black = _mm_andnot_si128(gt, odd);
+
+	// Calculate color2 and color3.
+	// - color0 > color1: even lanes are (2*c0 + c1) / 3; odd lanes are (2*c1 + c0) / 3.
+	// - color0 <= color1: both lanes are (c0 + c1) / 2.
+	// NOTE: The maximum numerator is 765. (x * 21846) >> 16 is exact
+	// for division by 3 for all values in this range.
+	const __m128i div3 = _mm_set1_epi16(21846);
+	__m128i ch01[3] = {b, g, r};
+	__m128i ch23[3];
+	for (unsigned int i = 0; i < 3; i++) {
+		const __m128i x = ch01[i];
+		const __m128i xs = swap_epi16_pairs(x);
+		const __m128i third = _mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(x, x), xs), div3);
+		const __m128i half = _mm_srli_epi16(_mm_add_epi16(x, xs), 1);
+		ch23[i] = _mm_andnot_si128(c3_black,
+			_mm_or_si128(_mm_and_si128(gt, third), _mm_andnot_si128(gt, half)));
+	}
+
+	const __m128i a01 = _mm_set1_epi16(0xFF);
+	const __m128i a23 = (color3_alpha
+		? _mm_andnot_si128(c3_black, a01)
+		: a01);
+
+	// Combine the components into ARGB32.
+	const __m128i bg01 = _mm_or_si128(ch01[0], _mm_slli_epi16(ch01[1], 8));
+	const __m128i ra01 = _mm_or_si128(ch01[2], _mm_slli_epi16(a01, 8));
+	const __m128i bg23 = _mm_or_si128(ch23[0], _mm_slli_epi16(ch23[1], 8));
+	const __m128i ra23 = _mm_or_si128(ch23[2], _mm_slli_epi16(a23, 8));
+
+	// [c0_0, c1_0, c0_1, c1_1] and [c0_2, c1_2, c0_3, c1_3]
+	const __m128i p01_lo = _mm_unpacklo_epi16(bg01, ra01);
+	const __m128i p01_hi = _mm_unpackhi_epi16(bg01, ra01);
+	const __m128i p23_lo = _mm_unpacklo_epi16(bg23, ra23);
+	const __m128i p23_hi = _mm_unpackhi_epi16(bg23, ra23);
+
+	pal[0] = _mm_unpacklo_epi64(p01_lo, p23_lo);
+	pal[1] = _mm_unpackhi_epi64(p01_lo, p23_lo);
+	pal[2] = _mm_unpacklo_epi64(p01_hi, p23_hi);
+	pal[3] = _mm_unpackhi_epi64(p01_hi, p23_hi);
+}
+
+/**
+ * Look up four rows of DXT1 texels in a color palette.
+ * @param rows		[out] Decoded rows.
+ * @param pal		[in] Palette: four ARGB32 colors.
+ * @param indexes	[in] 2-bit color indexes.
+ */
+static FORCEINLINE void lookup_DXT1_rows(__m128i rows[4], __m128i pal, uint32_t indexes)
+{
+	// Convert the indexes to byte offsets in the palette. (idx * 4)
+	const __m128i tbl_lo = _mm_setr_epi8(0,4,8,12, 0,4,8,12, 0,4,8,12, 0,4,8,12);
+	const __m128i tbl_hi = _mm_setr_epi8(0,0,0,0, 4,4,4,4, 8,8,8,8, 12,12,12,12);
+	const __m128i mask_nyb = _mm_set1_epi8(0x0F);
+	const __m128i v = _mm_cvtsi32_si128(static_cast<int>(indexes));
+	const __m128i nyb = _mm_unpacklo_epi8(
+		_mm_and_si128(v, mask_nyb),
+		_mm_and_si128(_mm_srli_epi16(v, 4), mask_nyb));
+	const __m128i offs = _mm_unpacklo_epi8(
+		_mm_shuffle_epi8(tbl_lo, nyb),
+		_mm_shuffle_epi8(tbl_hi, nyb));
+
+	// Expand each offset to four bytes, then look up the colors.
+	const __m128i bytepos = _mm_setr_epi8(0,1,2,3, 0,1,2,3, 0,1,2,3, 0,1,2,3);
+	const __m128i rowsel0 = _mm_setr_epi8(0,0,0,0, 1,1,1,1, 2,2,2,2, 3,3,3,3);
+	const __m128i four = _mm_set1_epi8(4);
+	__m128i rowsel = rowsel0;
+	for (unsigned int i = 0; i < 4; i++, rowsel = _mm_add_epi8(rowsel, four)) {
+		const __m128i mask = _mm_add_epi8(_mm_shuffle_epi8(offs, rowsel), bytepos);
+		rows[i] = _mm_shuffle_epi8(pal, mask);
+	}
+}
+
+/**
+ * Decode a DXT5-style 3-bit channel block.
+ * Used for DXT5 alpha and BC4/BC5 color channels.
+ * @param blk [in] 8-byte block: two endpoints, then 48-bit codes.
+ * @return Channel values, one byte per texel.
+ */
+static FORCEINLINE __m128i decode_DXT5_alpha_block(const uint8_t *blk)
+{
+	const unsigned int a0 = blk[0];
+	const unsigned int a1 = blk[1];
+
+	// Calculate the 8-entry palette.
+	// NOTE: (x * 9363) >> 16 and (x * 13108) >> 16 are exact for
+	// division by 7 and 5 for all possible numerators here.
+	__m128i pal;
+	if (a0 > a1) {
+		const __m128i x = _mm_add_epi16(
+			_mm_mullo_epi16(_mm_set1_epi16(static_cast<int16_t>(a0)), _mm_setr_epi16(7, 0, 6, 5, 4, 3, 2, 1)),
+			_mm_mullo_epi16(_mm_set1_epi16(static_cast<int16_t>(a1)), _mm_setr_epi16(0, 7, 1, 2, 3, 4, 5, 6)));
+		pal = _mm_mulhi_epu16(x, _mm_set1_epi16(9363));
+	} else {
+		const __m128i x = _mm_add_epi16(
+			_mm_mullo_epi16(_mm_set1_epi16(static_cast<int16_t>(a0)), _mm_setr_epi16(5, 0, 4, 3, 2, 1, 0, 0)),
+			_mm_mullo_epi16(_mm_set1_epi16(static_cast<int16_t>(a1)), _mm_setr_epi16(0, 5, 1, 2, 3, 4, 0, 0)));
+		pal = _mm_or_si128(_mm_mulhi_epu16(x, _mm_set1_epi16(13108)),
+			_mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, 255));
+	}
+	pal = _mm_packus_epi16(pal, pal);
+
+	// Extract the 3-bit codes into 16-bit lanes.
+	// Code i starts at bit (16 + 3i); the per-lane shift
+	// is done by multiplying by 2^(7 - shift) and then
+	// shifting right by 7.
+	const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(blk));
+	const __m128i shuf_lo = _mm_setr_epi8(2,3, 2,3, 2,3, 3,4, 3,4, 3,4, 4,5, 4,5);
+	const __m128i shuf_hi = _mm_setr_epi8(5,6, 5,6, 5,6, 6,7, 6,7, 6,7, 7,8, 7,8);
+	const __m128i mult = _mm_setr_epi16(128, 16, 2, 64, 8, 1, 32, 4);
+	const __m128i mask3 = _mm_set1_epi16(7);
+	const __m128i idx_lo = _mm_and_si128(_mm_srli_epi16(
+		_mm_mullo_epi16(_mm_shuffle_epi8(v, shuf_lo), mult), 7), mask3);
+	const __m128i idx_hi = _mm_and_si128(_mm_srli_epi16(
+		_mm_mullo_epi16(_mm_shuffle_epi8(v, shuf_hi), mult), 7), mask3);
+
+	return _mm_shuffle_epi8(pal, _mm_packus_epi16(idx_lo, idx_hi));
+}
+
+/**
+ * Get a pshufb mask that moves four channel values from
+ * decode_DXT5_alpha_block() into one byte of each ARGB32 texel.
+ * @param row	[in] Row number. (0-3)
+ * @param pos	[in] Byte position within the texel. (0 == B, 1 == G, 2 == R, 3 == A)
+ * @return pshufb mask.
+ */
+static FORCEINLINE __m128i channel_row_mask(unsigned int row, unsigned int pos)
+{
+	ALIGNED_VAR(16, uint8_t mask[16]);
+	memset(mask, 0x80, sizeof(mask));
+	for (unsigned int i = 0; i < 4; i++) {
+		mask[(i * 4) + pos] = static_cast<uint8_t>((row * 4) + i);
+	}
+	return _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+}
+
+/**
+ * Store four decoded 4x4 tiles in an rp_image.
+ * @param pDest		[out] First pixel of the first tile in the rp_image.
+ * @param stride_px	[in] rp_image stride, in pixels.
+ * @param rows		[in] Decoded rows for each tile.
+ * @param count		[in] Number of tiles to store. (1-4)
+ */
+static FORCEINLINE void store_tiles(uint32_t *pDest, int stride_px, const __m128i rows[4][4], unsigned int count)
+{
+	for (unsigned int i = 0; i < 4; i++, pDest += stride_px) {
+		for (unsigned int tile = 0; tile < count; tile++) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&pDest[tile * 4]), rows[tile][i]);
+		}
+	}
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * SSSE3-optimized version.
+ * @tparam color3_alpha If true, color3 is transparent if color0 <= color1.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+template<bool color3_alpha>
+static rp_image *T_fromDXT1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// DXT1 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= ((width * height) / 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((physWidth * physHeight) / 2))
+	{
+		return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	uint32_t *const pImgBuf = static_cast<uint32_t*>(img->bits());
+	const int stride_px = img->stride() / sizeof(uint32_t);
+
+	ImageDecoderPrivate::decodeTileRows(img, tilesY,
+		[img_buf, tilesX, pImgBuf, stride_px](unsigned int yStart, unsigned int yEnd)
+	{
+		// Temporary buffer for the last group of blocks in a row.
+		ALIGNED_VAR(16, uint8_t tailBuf[4*8]);
+
+		const uint8_t *src = img_buf + (static_cast<size_t>(yStart) * tilesX * 8);
+		for (unsigned int y = yStart; y < yEnd; y++) {
+			uint32_t *pDest = pImgBuf + (y * 4 * stride_px);
+			for (unsigned int x = 0; x < tilesX; x += 4, pDest += 16) {
+				// Decode four blocks at once.
+				const unsigned int count = std::min(tilesX - x, 4U);
+				const uint8_t *blk = src;
+				if (count < 4) {
+					memset(tailBuf, 0, sizeof(tailBuf));
+					memcpy(tailBuf, src, count * 8);
+					blk = tailBuf;
+				}
+				src += count * 8;
+
+				// Separate the colors and indexes.
+				const __m128i b01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[0]));
+				const __m128i b23 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[16]));
+				const __m128i t = _mm_unpacklo_epi32(b01, b23);
+				const __m128i u = _mm_unpackhi_epi32(b01, b23);
+				ALIGNED_VAR(16, uint32_t indexes[4]);
+				_mm_store_si128(reinterpret_cast<__m128i*>(indexes), _mm_unpackhi_epi32(t, u));
+
+				__m128i pal[4];
+				decode_DXT1_palettes4<color3_alpha>(pal, _mm_unpacklo_epi32(t, u));
+
+				__m128i rows[4][4];
+				for (unsigned int tile = 0; tile < 4; tile++) {
+					lookup_DXT1_rows(rows[tile], pal[tile], indexes[tile]);
+				}
+				store_tiles(pDest, stride_px, rows, count);
+			}
+		}
+	});
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * SSSE3-optimized version.
+ * S3TC palette index 3 will be interpreted as black.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return T_fromDXT1_ssse3<false>(width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert a DXT1 image to rp_image.
+ * SSSE3-optimized version.
+ * S3TC palette index 3 will be interpreted as fully transparent.
+ *
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT1 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT1_A1_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	return T_fromDXT1_ssse3<true>(width, height, img_buf, img_siz);
+}
+
+/**
+ * Convert a DXT5 image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf DXT5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromDXT5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// DXT5 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= (physWidth * physHeight));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < (physWidth * physHeight))
+	{
+		return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	uint32_t *const pImgBuf = static_cast<uint32_t*>(img->bits());
+	const int stride_px = img->stride() / sizeof(uint32_t);
+
+	// pshufb masks for the alpha channel.
+	__m128i amask[4];
+	for (unsigned int i = 0; i < 4; i++) {
+		amask[i] = channel_row_mask(i, 3);
+	}
+	const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+
+	ImageDecoderPrivate::decodeTileRows(img, tilesY,
+		[img_buf, tilesX, pImgBuf, stride_px, &amask, &rgb_mask](unsigned int yStart, unsigned int yEnd)
+	{
+		// Temporary buffer for the last group of blocks in a row.
+		ALIGNED_VAR(16, uint8_t tailBuf[4*16]);
+
+		const uint8_t *src = img_buf + (static_cast<size_t>(yStart) * tilesX * 16);
+		for (unsigned int y = yStart; y < yEnd; y++) {
+			uint32_t *pDest = pImgBuf + (y * 4 * stride_px);
+			for (unsigned int x = 0; x < tilesX; x += 4, pDest += 16) {
+				// Decode four blocks at once.
+				const unsigned int count = std::min(tilesX - x, 4U);
+				const uint8_t *blk = src;
+				if (count < 4) {
+					memset(tailBuf, 0, sizeof(tailBuf));
+					memcpy(tailBuf, src, count * 16);
+					blk = tailBuf;
+				}
+				src += count * 16;
+
+				// Separate the colors and indexes.
+				// Each block has 8 bytes of alpha data, followed by a DXT1 block.
+				const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[ 0]));
+				const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[16]));
+				const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[32]));
+				const __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[48]));
+				const __m128i t01 = _mm_unpackhi_epi32(b0, b1);
+				const __m128i t23 = _mm_unpackhi_epi32(b2, b3);
+				ALIGNED_VAR(16, uint32_t indexes[4]);
+				_mm_store_si128(reinterpret_cast<__m128i*>(indexes), _mm_unpackhi_epi64(t01, t23));
+
+				__m128i pal[4];
+				decode_DXT1_palettes4<false>(pal, _mm_unpacklo_epi64(t01, t23));
+
+				__m128i rows[4][4];
+				for (unsigned int tile = 0; tile < 4; tile++) {
+					lookup_DXT1_rows(rows[tile], pal[tile], indexes[tile]);
+					const __m128i alpha = decode_DXT5_alpha_block(&blk[tile * 16]);
+					for (unsigned int i = 0; i < 4; i++) {
+						rows[tile][i] = _mm_or_si128(
+							_mm_and_si128(rows[tile][i], rgb_mask),
+							_mm_shuffle_epi8(alpha, amask[i]));
+					}
+				}
+				store_tiles(pDest, stride_px, rows, count);
+			}
+		}
+	});
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a BC4 (ATI1) image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC4 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)/2]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC4_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// BC4 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= ((width * height) / 2));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < ((physWidth * physHeight) / 2))
+	{
+		return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	uint32_t *const pImgBuf = static_cast<uint32_t*>(img->bits());
+	const int stride_px = img->stride() / sizeof(uint32_t);
+
+	// pshufb masks for the red channel.
+	// NOTE: Using red instead of grayscale here.
+	__m128i rmask[4];
+	for (unsigned int i = 0; i < 4; i++) {
+		rmask[i] = channel_row_mask(i, 2);
+	}
+	const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000U));
+
+	ImageDecoderPrivate::decodeTileRows(img, tilesY,
+		[img_buf, tilesX, pImgBuf, stride_px, &rmask, &opaque](unsigned int yStart, unsigned int yEnd)
+	{
+		const uint8_t *src = img_buf + (static_cast<size_t>(yStart) * tilesX * 8);
+		for (unsigned int y = yStart; y < yEnd; y++) {
+			uint32_t *pDest = pImgBuf + (y * 4 * stride_px);
+			for (unsigned int x = 0; x < tilesX; x++, src += 8, pDest += 4) {
+				// BC4 colors are determined using DXT5-style alpha interpolation.
+				const __m128i red = decode_DXT5_alpha_block(src);
+				uint32_t *pRow = pDest;
+				for (unsigned int i = 0; i < 4; i++, pRow += stride_px) {
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow),
+						_mm_or_si128(_mm_shuffle_epi8(red, rmask[i]), opaque));
+				}
+			}
+		}
+	});
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	// NOTE: We have to set '1' for the empty Green and Blue channels,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT = {8,1,1,0,0};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Convert a BC5 (ATI2) image to rp_image.
+ * SSSE3-optimized version.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC5 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC5_ssse3(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// BC5 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= (width * height));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < (physWidth * physHeight))
+	{
+		return nullptr;
+	}
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	uint32_t *const pImgBuf = static_cast<uint32_t*>(img->bits());
+	const int stride_px = img->stride() / sizeof(uint32_t);
+
+	// pshufb masks for the red and green channels.
+	__m128i rmask[4], gmask[4];
+	for (unsigned int i = 0; i < 4; i++) {
+		rmask[i] = channel_row_mask(i, 2);
+		gmask[i] = channel_row_mask(i, 1);
+	}
+	const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000U));
+
+	ImageDecoderPrivate::decodeTileRows(img, tilesY,
+		[img_buf, tilesX, pImgBuf, stride_px, &rmask, &gmask, &opaque](unsigned int yStart, unsigned int yEnd)
+	{
+		const uint8_t *src = img_buf + (static_cast<size_t>(yStart) * tilesX * 16);
+		for (unsigned int y = yStart; y < yEnd; y++) {
+			uint32_t *pDest = pImgBuf + (y * 4 * stride_px);
+			for (unsigned int x = 0; x < tilesX; x++, src += 16, pDest += 4) {
+				// BC5 colors are determined using DXT5-style alpha interpolation.
+				const __m128i red   = decode_DXT5_alpha_block(&src[0]);
+				const __m128i green = decode_DXT5_alpha_block(&src[8]);
+				uint32_t *pRow = pDest;
+				for (unsigned int i = 0; i < 4; i++, pRow += stride_px) {
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow),
+						_mm_or_si128(_mm_or_si128(
+							_mm_shuffle_epi8(red, rmask[i]),
+							_mm_shuffle_epi8(green, gmask[i])), opaque));
+				}
+			}
+		}
+	});
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	// NOTE: We have to set '1' for the empty Blue channel,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT = {8,8,1,0,0};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+} }
@@ -0,0 +1,173 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_Stream.cpp: Image decoding functions: Streamed decoding.   *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// librpbase, librpfile
+#include "librpbase/aligned_malloc.h"
+#include "librpfile/IRpFile.hpp"
+using LibRpFile::IRpFile;
+
+namespace LibRpTexture { namespace ImageDecoder {
+
+/**
+ * Maximum number of pixels to decode at once in fromFile_banded().
+ * This limits both the temporary read buffer and the band image.
+ */
+static const int BAND_MAX_PIXELS = 1024*1024;
+
+/**
+ * Decode an image directly from a file.
+ *
+ * If the file can provide a direct view of the image data, e.g. using
+ * a memory mapping, the image is decoded from that view without copying.
+ * Otherwise, small images are read in full, and large images are read
+ * and decoded in bands of tile rows, so a full-size temporary buffer
+ * isn't needed.
+ *
+ * @param pfnDecode	[in] Band decoding function.
+ * @param param		[in] User parameter for pfnDecode().
+ * @param width		[in] Image width.
+ * @param height	[in] Image height.
+ * @param tileH		[in] Tile height. (1 for linear images; height if the image can't be split)
+ * @param tileRowSize	[in] Size of one row of tiles, in bytes.
+ * @param file		[in] File to read from.
+ * @param addr		[in] Starting address of the image data.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromFile_banded(pfnDecodeBand_t pfnDecode, void *param,
+	int width, int height, int tileH, int tileRowSize,
+	IRpFile *file, off64_t addr)
+{
+	assert(pfnDecode != nullptr);
+	assert(file != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+	assert(tileH > 0);
+	assert(tileRowSize > 0);
+	if (!pfnDecode || !file ||
+	    width <= 0 || height <= 0 || tileH <= 0 || tileRowSize <= 0)
+	{
+		return nullptr;
+	}
+
+	const int tileRows = (height + tileH - 1) / tileH;
+	const int64_t img_siz64 = static_cast<int64_t>(tileRows) * tileRowSize;
+	if (img_siz64 > INT32_MAX) {
+		// Image is too big.
+		return nullptr;
+	}
+	const int img_siz = static_cast<int>(img_siz64);
+
+	// If the file is memory-mapped, decode directly from the mapping.
+	// NOTE: The decoders may use aligned SIMD loads.
+	const uint8_t *const pView = file->peek(addr, img_siz);
+	if (pView && (reinterpret_cast<uintptr_t>(pView) & 15) == 0) {
+		return pfnDecode(param, height, pView, img_siz);
+	}
+
+	// Number of tile rows per band.
+	int bandTileRows = BAND_MAX_PIXELS / (width * tileH);
+	if (bandTileRows <= 0) {
+		bandTileRows = 1;
+	}
+
+	if (bandTileRows >= tileRows) {
+		// Small image. Read and decode it all at once.
+		auto buf = aligned_uptr<uint8_t>(16, img_siz);
+		size_t size = file->seekAndRead(addr, buf.get(), img_siz);
+		if (size != static_cast<size_t>(img_siz)) {
+			// Seek and/or read error.
+			return nullptr;
+		}
+		return pfnDecode(param, height, buf.get(), img_siz);
+	}
+
+	// Large image. Decode it in bands.
+	const int bandSize = bandTileRows * tileRowSize;
+	auto buf = aligned_uptr<uint8_t>(16, bandSize);
+	rp_image *img = nullptr;
+	int row_bytes = 0;
+
+	for (int y = 0; y < height; y += bandTileRows * tileH) {
+		const int bandH = std::min(bandTileRows * tileH, height - y);
+		const int curSize = ((bandH + tileH - 1) / tileH) * tileRowSize;
+		size_t size = file->seekAndRead(addr, buf.get(), curSize);
+		if (size != static_cast<size_t>(curSize)) {
+			// Seek and/or read error.
+			break;
+		}
+		addr += curSize;
+
+		rp_image *const bandImg = pfnDecode(param, bandH, buf.get(), curSize);
+		if (!bandImg) {
+			// Decoding error.
+			break;
+		}
+		assert(bandImg->width() == width);
+		assert(bandImg->height() == bandH);
+		if (!img) {
+			// First band. Create the full image using the band's format.
+			img = new rp_image(width, height, bandImg->format());
+			if (!img->isValid()) {
+				// Could not allocate the image.
+				bandImg->unref();
+				break;
+			}
+			switch (img->format()) {
+				case rp_image::Format::CI8:
+					assert(img->palette_len() == bandImg->palette_len());
+					memcpy(img->palette(), bandImg->palette(),
+						std::min(img->palette_len(), bandImg->palette_len()) * sizeof(uint32_t));
+					img->set_tr_idx(bandImg->tr_idx());
+					row_bytes = width;
+					break;
+				case rp_image::Format::ARGB32:
+					row_bytes = width * sizeof(uint32_t);
+					break;
+				default:
+					assert(!"Unsupported rp_image format.");
+					break;
+			}
+
+			rp_image::sBIT_t sBIT;
+			if (bandImg->get_sBIT(&sBIT) == 0) {
+				img->set_sBIT(&sBIT);
+			}
+		}
+		if (row_bytes == 0 || bandImg->format() != img->format() ||
+		    bandImg->width() != width || bandImg->height() != bandH)
+		{
+			// Band doesn't match the full image.
+			bandImg->unref();
+			break;
+		}
+
+		// Copy the band into the full image.
+		for (int row = 0; row < bandH; row++) {
+			memcpy(img->scanLine(y + row), bandImg->scanLine(row), row_bytes);
+		}
+		bandImg->unref();
+
+		if (y + bandH >= height) {
+			// Finished decoding the image.
+			return img;
+		}
+	}
+
+	// An error occurred.
+	if (img) {
+		img->unref();
+	}
+	return nullptr;
+}
+
+} }
@@ -17,23 +17,32 @@ using namespace LibRpTexture;
 // IFUNC attribute doesn't support C++ name mangling.
 extern "C" {
 
-#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
 /**
  * IFUNC resolver function for fromLinear16().
  * @return Function pointer.
  */
 static __typeof__(&ImageDecoder::fromLinear16_cpp) fromLinear16_resolve(void)
 {
-#ifdef IMAGEDECODER_HAS_SSE2
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear16_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_ALWAYS_HAS_SSE2
+	{
+		return &ImageDecoder::fromLinear16_sse2;
+	}
+#else /* !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+# ifdef IMAGEDECODER_HAS_SSE2
 	if (RP_CPU_HasSSE2()) {
 		return &ImageDecoder::fromLinear16_sse2;
 	} else
-#endif /* IMAGEDECODER_HAS_SSE2 */
+# endif /* IMAGEDECODER_HAS_SSE2 */
 	{
 		return &ImageDecoder::fromLinear16_cpp;
 	}
-}
 #endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+}
 
 /**
  * IFUNC resolver function for fromLinear24().
@@ -57,6 +66,11 @@ static __typeof__(&ImageDecoder::fromLinear24_cpp) fromLinear24_resolve(void)
  */
 static __typeof__(&ImageDecoder::fromLinear32_cpp) fromLinear32_resolve(void)
 {
+#ifdef IMAGEDECODER_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return &ImageDecoder::fromLinear32_avx2;
+	} else
+#endif /* IMAGEDECODER_HAS_AVX2 */
 #ifdef IMAGEDECODER_HAS_SSSE3
 	if (RP_CPU_HasSSSE3()) {
 		return &ImageDecoder::fromLinear32_ssse3;
@@ -67,14 +81,256 @@ static __typeof__(&ImageDecoder::fromLinear32_cpp) fromLinear32_resolve(void)
 	}
 }
 
+/**
+ * IFUNC resolver function for fromGcn16().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromGcn16_cpp) fromGcn16_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromGcn16_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromGcn16_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDXT1().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT1_cpp) fromDXT1_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT1_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT1_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDXT1_A1().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT1_A1_cpp) fromDXT1_A1_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT1_A1_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT1_A1_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromDXT5().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromDXT5_cpp) fromDXT5_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromDXT5_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromDXT5_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromBC4().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromBC4_cpp) fromBC4_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromBC4_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromBC4_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromBC5().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromBC5_cpp) fromBC5_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return &ImageDecoder::fromBC5_ssse3;
+	} else
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+	{
+		return &ImageDecoder::fromBC5_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromBC7().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromBC7_cpp) fromBC7_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return &ImageDecoder::fromBC7_sse41;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return &ImageDecoder::fromBC7_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromETC1().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromETC1_cpp) fromETC1_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return &ImageDecoder::fromETC1_sse41;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return &ImageDecoder::fromETC1_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromETC2_RGB().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromETC2_RGB_cpp) fromETC2_RGB_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return &ImageDecoder::fromETC2_RGB_sse41;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return &ImageDecoder::fromETC2_RGB_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromETC2_RGBA().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromETC2_RGBA_cpp) fromETC2_RGBA_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return &ImageDecoder::fromETC2_RGBA_sse41;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return &ImageDecoder::fromETC2_RGBA_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromETC2_RGB_A1().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromETC2_RGB_A1_cpp) fromETC2_RGB_A1_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return &ImageDecoder::fromETC2_RGB_A1_sse41;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE41 */
+	{
+		return &ImageDecoder::fromETC2_RGB_A1_cpp;
+	}
 }
 
 #ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
+/**
+ * IFUNC resolver function for fromN3DSTiledRGB565().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromN3DSTiledRGB565_cpp) fromN3DSTiledRGB565_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return &ImageDecoder::fromN3DSTiledRGB565_sse2;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return &ImageDecoder::fromN3DSTiledRGB565_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromN3DSTiledRGB565_A4().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromN3DSTiledRGB565_A4_cpp) fromN3DSTiledRGB565_A4_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return &ImageDecoder::fromN3DSTiledRGB565_A4_sse2;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return &ImageDecoder::fromN3DSTiledRGB565_A4_cpp;
+	}
+}
+#endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
+#if defined(ENABLE_PVRTC) && !defined(IMAGEDECODER_ALWAYS_HAS_SSE2)
+/**
+ * IFUNC resolver function for fromPVRTC().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromPVRTC_cpp) fromPVRTC_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return &ImageDecoder::fromPVRTC_sse2;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return &ImageDecoder::fromPVRTC_cpp;
+	}
+}
+
+/**
+ * IFUNC resolver function for fromPVRTCII().
+ * @return Function pointer.
+ */
+static __typeof__(&ImageDecoder::fromPVRTCII_cpp) fromPVRTCII_resolve(void)
+{
+#ifdef IMAGEDECODER_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return &ImageDecoder::fromPVRTCII_sse2;
+	} else
+#endif /* IMAGEDECODER_HAS_SSE2 */
+	{
+		return &ImageDecoder::fromPVRTCII_cpp;
+	}
+}
+#endif /* ENABLE_PVRTC && !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
+}
+
 rp_image *ImageDecoder::fromLinear16(PixelFormat px_format,
 	int width, int height,
 	const uint16_t *img_buf, int img_siz, int stride)
 	IFUNC_ATTR(fromLinear16_resolve);
-#endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
 
 rp_image *ImageDecoder::fromLinear24(PixelFormat px_format,
 	int width, int height,
@@ -86,4 +342,72 @@ rp_image *ImageDecoder::fromLinear32(PixelFormat px_format,
 	const uint32_t *img_buf, int img_siz, int stride)
 	IFUNC_ATTR(fromLinear32_resolve);
 
+rp_image *ImageDecoder::fromGcn16(PixelFormat px_format,
+	int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromGcn16_resolve);
+
+rp_image *ImageDecoder::fromDXT1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT1_resolve);
+
+rp_image *ImageDecoder::fromDXT1_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT1_A1_resolve);
+
+rp_image *ImageDecoder::fromDXT5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromDXT5_resolve);
+
+rp_image *ImageDecoder::fromBC4(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromBC4_resolve);
+
+rp_image *ImageDecoder::fromBC5(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromBC5_resolve);
+
+rp_image *ImageDecoder::fromBC7(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+	IFUNC_ATTR(fromBC7_resolve);
+
+rp_image *ImageDecoder::fromETC1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromETC1_resolve);
+
+rp_image *ImageDecoder::fromETC2_RGB(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromETC2_RGB_resolve);
+
+rp_image *ImageDecoder::fromETC2_RGBA(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromETC2_RGBA_resolve);
+
+rp_image *ImageDecoder::fromETC2_RGB_A1(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromETC2_RGB_A1_resolve);
+
+#ifndef IMAGEDECODER_ALWAYS_HAS_SSE2
+rp_image *ImageDecoder::fromN3DSTiledRGB565(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz)
+	IFUNC_ATTR(fromN3DSTiledRGB565_resolve);
+
+rp_image *ImageDecoder::fromN3DSTiledRGB565_A4(int width, int height,
+	const uint16_t *RESTRICT img_buf, int img_siz,
+	const uint8_t *RESTRICT alpha_buf, int alpha_siz)
+	IFUNC_ATTR(fromN3DSTiledRGB565_A4_resolve);
+#endif /* IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
+#if defined(ENABLE_PVRTC) && !defined(IMAGEDECODER_ALWAYS_HAS_SSE2)
+rp_image *ImageDecoder::fromPVRTC(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode)
+	IFUNC_ATTR(fromPVRTC_resolve);
+
+rp_image *ImageDecoder::fromPVRTCII(int width, int height,
+	const uint8_t *RESTRICT img_buf, int img_siz,
+	uint8_t mode)
+	IFUNC_ATTR(fromPVRTCII_resolve);
+#endif /* ENABLE_PVRTC && !IMAGEDECODER_ALWAYS_HAS_SSE2 */
+
 #endif /* RP_HAS_IFUNC */
@@ -94,6 +94,57 @@ class ImageDecoderPrivate
 		static inline void BlitTile_CI4_LeftLSN(
 			rp_image *RESTRICT img, const std::array<uint8_t, tileW*tileH/2> &tileBuf,
 			unsigned int tileX, unsigned int tileY);
+
+	public:
+		// Minimum image size, in pixels, for multithreaded decoding.
+		static const unsigned int PARALLEL_MIN_PIXELS = 1024U*1024U;
+		// Number of strips per thread, for load balancing.
+		static const unsigned int PARALLEL_STRIPS_PER_THREAD = 4;
+
+		// Maximum number of decoding threads set by ImageDecoder::setMaxThreads().
+		static volatile int maxThreads;
+
+		/**
+		 * Tile row decoding function.
+		 * @param param	[in] Function parameter
+		 * @param yStart	[in] First tile row
+		 * @param yEnd	[in] Last tile row, plus one
+		 */
+		typedef void (*pfnDecodeTileRows_t)(void *param, unsigned int yStart, unsigned int yEnd);
+
+		/**
+		 * Decode all tile rows in an image.
+		 *
+		 * If the image has at least PARALLEL_MIN_PIXELS pixels, it will be
+		 * split into horizontal strips of tile rows, which are decoded by
+		 * the process-wide ThreadPool. Otherwise, all tile rows are decoded
+		 * on the calling thread.
+		 *
+		 * The decoding function must only write to its own tile rows.
+		 *
+		 * @param img		[in] rp_image being decoded
+		 * @param tilesY	[in] Number of tile rows
+		 * @param func		[in] Tile row decoding function
+		 * @param param		[in] Function parameter
+		 */
+		static void decodeTileRows(const rp_image *img, unsigned int tilesY,
+			pfnDecodeTileRows_t func, void *param);
+
+		/**
+		 * Decode all tile rows in an image. (function object)
+		 * See decodeTileRows() above.
+		 * @tparam Func		[in] Function object: void(unsigned int yStart, unsigned int yEnd)
+		 * @param img		[in] rp_image being decoded
+		 * @param tilesY	[in] Number of tile rows
+		 * @param func		[in] Tile row decoding function object
+		 */
+		template<typename Func>
+		static inline void decodeTileRows(const rp_image *img, unsigned int tilesY, const Func &func)
+		{
+			decodeTileRows(img, tilesY, [](void *param, unsigned int yStart, unsigned int yEnd) {
+				(*static_cast<const Func*>(param))(yStart, yEnd);
+			}, const_cast<Func*>(&func));
+		}
 };
 
 /**
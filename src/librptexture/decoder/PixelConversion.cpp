@@ -9,6 +9,9 @@
 #include "stdafx.h"
 #include "PixelConversion.hpp"
 
+// librpthreads
+#include "librpthreads/pthread_once.h"
+
 namespace LibRpTexture { namespace PixelConversion {
 
 // 2-bit alpha lookup table.
@@ -36,4 +39,64 @@ const uint8_t c3_lookup[8] = {
 	0x92, 0xB6, 0xDB, 0xFF
 };
 
+/** 16-bit lookup tables. **/
+
+// NOTE: The tables are zero-initialized, so they don't
+// take up any memory until they're built.
+static uint32_t lut16_tables[static_cast<size_t>(Lut16::Max)][65536];
+
+// pthread_once() control variables.
+static pthread_once_t lut16_once[static_cast<size_t>(Lut16::Max)] = {
+	PTHREAD_ONCE_INIT, PTHREAD_ONCE_INIT,
+	PTHREAD_ONCE_INIT, PTHREAD_ONCE_INIT,
+};
+
+/**
+ * Build a 16-bit lookup table.
+ * Called by pthread_once().
+ * @tparam id Lookup table ID.
+ * @tparam convert Pixel conversion function.
+ */
+template<Lut16 id, uint32_t (*convert)(uint16_t)>
+static void initLut16(void)
+{
+	uint32_t *const lut = lut16_tables[static_cast<size_t>(id)];
+	for (unsigned int px16 = 0; px16 < 65536; px16++) {
+		lut[px16] = convert(static_cast<uint16_t>(px16));
+	}
+}
+
+/**
+ * Get a 16-bit to ARGB32 lookup table.
+ * The table is built on first use.
+ * @param id Lookup table ID.
+ * @return Lookup table (65536 entries), or nullptr on error.
+ */
+const uint32_t *getLut16(Lut16 id)
+{
+	switch (id) {
+		case Lut16::RGB565:
+			pthread_once(&lut16_once[static_cast<size_t>(id)],
+				initLut16<Lut16::RGB565, RGB565_to_ARGB32>);
+			break;
+		case Lut16::ARGB1555:
+			pthread_once(&lut16_once[static_cast<size_t>(id)],
+				initLut16<Lut16::ARGB1555, ARGB1555_to_ARGB32>);
+			break;
+		case Lut16::ARGB4444:
+			pthread_once(&lut16_once[static_cast<size_t>(id)],
+				initLut16<Lut16::ARGB4444, ARGB4444_to_ARGB32>);
+			break;
+		case Lut16::RGB5A3:
+			pthread_once(&lut16_once[static_cast<size_t>(id)],
+				initLut16<Lut16::RGB5A3, RGB5A3_to_ARGB32>);
+			break;
+		default:
+			assert(!"Invalid 16-bit lookup table ID.");
+			return nullptr;
+	}
+
+	return lut16_tables[static_cast<size_t>(id)];
+}
+
 } }
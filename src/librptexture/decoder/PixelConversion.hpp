@@ -27,6 +27,32 @@ extern const uint8_t c2_lookup[4];
 // 3-bit color lookup table.
 extern const uint8_t c3_lookup[8];
 
+/** 16-bit lookup tables. **/
+// Each table has 65536 entries, indexed by the host-endian 16-bit pixel.
+// Tables are built on first use.
+
+// Minimum number of pixels to use a 16-bit lookup table.
+// Each table is 256 KB, so smaller images are faster with the
+// conversion functions, even if the table was already built.
+static const unsigned int LUT16_MIN_PIXELS = 256*256;
+
+enum class Lut16 : uint8_t {
+	RGB565,
+	ARGB1555,
+	ARGB4444,
+	RGB5A3,
+
+	Max
+};
+
+/**
+ * Get a 16-bit to ARGB32 lookup table.
+ * The table is built on first use.
+ * @param id Lookup table ID.
+ * @return Lookup table (65536 entries), or nullptr on error.
+ */
+const uint32_t *getLut16(Lut16 id);
+
 // 16-bit RGB
 
 /**
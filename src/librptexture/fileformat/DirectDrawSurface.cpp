@@ -15,6 +15,9 @@
 #include "dds_structs.h"
 #include "data/DX10Formats.hpp"
 
+// librpcpu
+#include "librpcpu/byteswap_struct.hpp"
+
 // librpbase, librpfile
 #include "libi18n/i18n.h"
 using LibRpBase::rp_sprintf;
@@ -29,6 +32,41 @@ using LibRpFile::IRpFile;
 using std::string;
 using std::vector;
 
+// DDS header byteswap layouts.
+// NOTE: FourCC is handled separately.
+RP_BYTESWAP_LAYOUT(DDS_PIXELFORMAT,
+	RP_BYTESWAP_FIELD(DDS_PIXELFORMAT, dwSize),
+	RP_BYTESWAP_FIELD(DDS_PIXELFORMAT, dwFlags),
+	RP_BYTESWAP_FIELD(DDS_PIXELFORMAT, dwRGBBitCount),
+	RP_BYTESWAP_FIELD(DDS_PIXELFORMAT, dwRBitMask),
+	RP_BYTESWAP_FIELD(DDS_PIXELFORMAT, dwGBitMask),
+	RP_BYTESWAP_FIELD(DDS_PIXELFORMAT, dwBBitMask),
+	RP_BYTESWAP_FIELD(DDS_PIXELFORMAT, dwABitMask))
+RP_BYTESWAP_LAYOUT(DDS_HEADER,
+	RP_BYTESWAP_FIELD(DDS_HEADER, dwSize),
+	RP_BYTESWAP_FIELD(DDS_HEADER, dwFlags),
+	RP_BYTESWAP_FIELD(DDS_HEADER, dwHeight),
+	RP_BYTESWAP_FIELD(DDS_HEADER, dwWidth),
+	RP_BYTESWAP_FIELD(DDS_HEADER, dwPitchOrLinearSize),
+	RP_BYTESWAP_FIELD(DDS_HEADER, dwDepth),
+	RP_BYTESWAP_FIELD(DDS_HEADER, dwMipMapCount),
+	RP_BYTESWAP_NESTED(DDS_HEADER, ddspf),
+	RP_BYTESWAP_FIELD(DDS_HEADER, dwCaps),
+	RP_BYTESWAP_FIELD(DDS_HEADER, dwCaps2),
+	RP_BYTESWAP_FIELD(DDS_HEADER, dwCaps3),
+	RP_BYTESWAP_FIELD(DDS_HEADER, dwCaps4))
+RP_BYTESWAP_LAYOUT(DDS_HEADER_DXT10,
+	RP_BYTESWAP_FIELD(DDS_HEADER_DXT10, dxgiFormat),
+	RP_BYTESWAP_FIELD(DDS_HEADER_DXT10, resourceDimension),
+	RP_BYTESWAP_FIELD(DDS_HEADER_DXT10, miscFlag),
+	RP_BYTESWAP_FIELD(DDS_HEADER_DXT10, arraySize),
+	RP_BYTESWAP_FIELD(DDS_HEADER_DXT10, miscFlags2))
+RP_BYTESWAP_LAYOUT(DDS_HEADER_XBOX,
+	RP_BYTESWAP_FIELD(DDS_HEADER_XBOX, tileMode),
+	RP_BYTESWAP_FIELD(DDS_HEADER_XBOX, baseAlignment),
+	RP_BYTESWAP_FIELD(DDS_HEADER_XBOX, dataSize),
+	RP_BYTESWAP_FIELD(DDS_HEADER_XBOX, xdkVer))
+
 namespace LibRpTexture {
 
 FILEFORMAT_IMPL(DirectDrawSurface)
@@ -52,19 +90,57 @@ class DirectDrawSurfacePrivate final : public FileFormatPrivate
 		// Texture data start address.
 		unsigned int texDataStartAddr;
 
-		// Decoded image.
-		rp_image *img;
+		// Decoded mipmaps.
+		// Mipmap 0 is the full image.
+		vector<rp_image*> mipmaps;
 
 		// Pixel format message.
 		// NOTE: Used for both valid and invalid pixel formats
 		// due to various bit specifications.
 		char pixel_format[32];
 
+		/**
+		 * Get the physical dimensions of a mipmap level, as stored in the file.
+		 * PVRTC images are padded to a minimum of 16x8 (2bpp) or 8x8 (4bpp).
+		 * Other formats use the mipmap level's actual dimensions.
+		 * @param mip		[in] Mipmap number. (0 == full image)
+		 * @param pWidth	[out] Physical width.
+		 * @param pHeight	[out] Physical height.
+		 */
+		void getPhysDimensions(int mip, unsigned int *pWidth, unsigned int *pHeight) const;
+
+		/**
+		 * Calculate the size of a mipmap level.
+		 * @param mip		[in] Mipmap number. (0 == full image)
+		 * @param pStride	[out,opt] Row stride. (uncompressed formats only)
+		 * @return Size of the mipmap level, in bytes, or 0 if not supported.
+		 */
+		unsigned int calcMipmapSize(int mip, unsigned int *pStride = nullptr) const;
+
+		// Parameters for decodeBand().
+		struct DecodeParams {
+			const DirectDrawSurfacePrivate *d;
+			int width;	// Image width.
+			int stride;	// Row stride. (uncompressed formats only)
+		};
+
+		/**
+		 * Decode a band of the image.
+		 * Used as the band decoding function for ImageDecoder::fromFile_banded().
+		 * @param param DecodeParams
+		 * @param height Band height.
+		 * @param img_buf Image buffer for the band.
+		 * @param img_siz Size of image data for the band.
+		 * @return rp_image, or nullptr on error.
+		 */
+		static rp_image *decodeBand(void *param, int height, const uint8_t *img_buf, int img_siz);
+
 		/**
 		 * Load the image.
+		 * @param mip Mipmap number. (0 == full image)
 		 * @return Image, or nullptr on error.
 		 */
-		const rp_image *loadImage(void);
+		const rp_image *loadImage(int mip);
 
 	public:
 		// Supported uncompressed RGB formats.
@@ -475,7 +551,6 @@ int DirectDrawSurfacePrivate::updatePixelFormat(void)
 DirectDrawSurfacePrivate::DirectDrawSurfacePrivate(DirectDrawSurface *q, IRpFile *file)
 	: super(q, file)
 	, texDataStartAddr(0)
-	, img(nullptr)
 	, pxf_uncomp(ImageDecoder::PixelFormat::Unknown)
 	, bytespp(0)
 	, dxgi_format(0)
@@ -490,81 +565,83 @@ DirectDrawSurfacePrivate::DirectDrawSurfacePrivate(DirectDrawSurface *q, IRpFile
 
 DirectDrawSurfacePrivate::~DirectDrawSurfacePrivate()
 {
-	UNREF(img);
+	std::for_each(mipmaps.begin(), mipmaps.end(), [](rp_image *img) { UNREF(img); });
 }
 
 /**
- * Load the image.
- * @return Image, or nullptr on error.
+ * Get the physical dimensions of a mipmap level, as stored in the file.
+ * PVRTC images are padded to a minimum of 16x8 (2bpp) or 8x8 (4bpp).
+ * Other formats use the mipmap level's actual dimensions.
+ * @param mip		[in] Mipmap number. (0 == full image)
+ * @param pWidth	[out] Physical width.
+ * @param pHeight	[out] Physical height.
  */
-const rp_image *DirectDrawSurfacePrivate::loadImage(void)
+void DirectDrawSurfacePrivate::getPhysDimensions(int mip, unsigned int *pWidth, unsigned int *pHeight) const
 {
-	if (img) {
-		// Image has already been loaded.
-		return img;
-	} else if (!this->file || !this->isValid) {
-		// Can't load the image.
-		return nullptr;
-	}
-
-	// Sanity check: Maximum image dimensions of 32768x32768.
-	assert(ddsHeader.dwWidth > 0);
-	assert(ddsHeader.dwWidth <= 32768);
-	assert(ddsHeader.dwHeight > 0);
-	assert(ddsHeader.dwHeight <= 32768);
-	if (ddsHeader.dwWidth == 0 || ddsHeader.dwWidth > 32768 ||
-	    ddsHeader.dwHeight == 0 || ddsHeader.dwHeight > 32768)
-	{
-		// Invalid image dimensions.
-		return nullptr;
-	}
+	// Each mipmap level is half the size of the previous level,
+	// with a minimum of 1 pixel in each dimension.
+	unsigned int width = std::max(ddsHeader.dwWidth >> mip, 1U);
+	unsigned int height = std::max(ddsHeader.dwHeight >> mip, 1U);
 
-	// Texture cannot start inside of the DDS header.
-	// TODO: Also dxt10Header for DX10?
-	// TODO: ...and xb1Header for XBOX?
-	assert(texDataStartAddr >= sizeof(ddsHeader));
-	if (texDataStartAddr < sizeof(ddsHeader)) {
-		// Invalid texture data start address.
-		return nullptr;
+#ifdef ENABLE_PVRTC
+	switch (dxgi_format) {
+		case DXGI_FORMAT_FAKE_PVRTC_2bpp:
+			// PVRTC 2bpp uses 8x4 tiles, and the PowerVR SDK
+			// decodes at least 2x2 tiles.
+			width = std::max(width, 16U);
+			height = std::max(height, 8U);
+			width = ALIGN_BYTES(8, width);
+			height = ALIGN_BYTES(4, height);
+			break;
+		case DXGI_FORMAT_FAKE_PVRTC_4bpp:
+			// PVRTC 4bpp uses 4x4 tiles, and the PowerVR SDK
+			// decodes at least 2x2 tiles.
+			width = std::max(width, 8U);
+			height = std::max(height, 8U);
+			width = ALIGN_BYTES(4, width);
+			height = ALIGN_BYTES(4, height);
+			break;
+		default:
+			break;
 	}
+#endif /* ENABLE_PVRTC */
 
-	if (file->size() > 128*1024*1024) {
-		// Sanity check: DDS files shouldn't be more than 128 MB.
-		return nullptr;
-	}
-	const uint32_t file_sz = static_cast<uint32_t>(file->size());
+	*pWidth = width;
+	*pHeight = height;
+}
 
-	// Seek to the start of the texture data.
-	int ret = file->seek(texDataStartAddr);
-	if (ret != 0) {
-		// Seek error.
-		return nullptr;
+/**
+ * Calculate the size of a mipmap level.
+ * @param mip		[in] Mipmap number. (0 == full image)
+ * @param pStride	[out,opt] Row stride. (uncompressed formats only)
+ * @return Size of the mipmap level, in bytes, or 0 if not supported.
+ */
+unsigned int DirectDrawSurfacePrivate::calcMipmapSize(int mip, unsigned int *pStride) const
+{
+	assert(mip >= 0);
+	assert(mip < 16);
+	if (mip < 0 || mip >= 16) {
+		// Invalid mipmap number.
+		return 0;
 	}
 
-	// TODO: Handle DX10 alpha processing.
-	// Currently, we're assuming straight alpha for formats
-	// that have an alpha channel, except for DXT2 and DXT4,
-	// which use premultiplied alpha.
+	unsigned int width, height;
+	getPhysDimensions(mip, &width, &height);
 
-	// NOTE: Mipmaps are stored *after* the main image.
-	// Hence, no mipmap processing is necessary.
 	if (dxgi_format != 0) {
 		// Compressed RGB data.
-
 		// NOTE: dwPitchOrLinearSize is not necessarily correct.
-		// Calculate the expected size.
-		uint32_t expected_size;
 		switch (dxgi_format) {
 #ifdef ENABLE_PVRTC
 			case DXGI_FORMAT_FAKE_PVRTC_2bpp:
 				// 32 pixels compressed into 64 bits. (2bpp)
-				expected_size = (ddsHeader.dwWidth * ddsHeader.dwHeight) / 4;
-				break;
+				// NOTE: Physical dimensions are padded to 16x8.
+				return (width * height) / 4;
 
 			case DXGI_FORMAT_FAKE_PVRTC_4bpp:
 				// 16 pixels compressed into 64 bits. (4bpp)
-				expected_size = (ddsHeader.dwWidth * ddsHeader.dwHeight) / 2;
-				break;
+				// NOTE: Physical dimensions are padded to 8x8.
+				return (width * height) / 2;
 #endif /* ENABLE_PVRTC */
 
 			case DXGI_FORMAT_BC1_TYPELESS:
@@ -575,9 +652,7 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case DXGI_FORMAT_BC4_SNORM:
 				// 16 pixels compressed into 64 bits. (4bpp)
 				// NOTE: Width and height must be rounded to the nearest tile. (4x4)
-				expected_size = ALIGN_BYTES(4, ddsHeader.dwWidth) *
-				                ALIGN_BYTES(4, ddsHeader.dwHeight) / 2;
-				break;
+				return ALIGN_BYTES(4, width) * ALIGN_BYTES(4, height) / 2;
 
 			case DXGI_FORMAT_BC2_TYPELESS:
 			case DXGI_FORMAT_BC2_UNORM:
@@ -593,81 +668,260 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case DXGI_FORMAT_BC7_UNORM_SRGB:
 				// 16 pixels compressed into 128 bits. (8bpp)
 				// NOTE: Width and height must be rounded to the nearest tile. (4x4)
-				expected_size = ALIGN_BYTES(4, ddsHeader.dwWidth) *
-				                ALIGN_BYTES(4, ddsHeader.dwHeight);
-				break;
+				return ALIGN_BYTES(4, width) * ALIGN_BYTES(4, height);
 
 			case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
 				// Uncompressed "special" 32bpp formats.
-				expected_size = ddsHeader.dwWidth * ddsHeader.dwHeight * 4;
-				break;
+				return width * height * 4;
 
 			default:
 				// Not supported.
-				return nullptr;
+				return 0;
 		}
+	}
 
-		// Verify file size.
-		if (expected_size >= file_sz + texDataStartAddr) {
-			// File is too small.
-			return nullptr;
+	// Uncompressed linear image data.
+	assert(pxf_uncomp != ImageDecoder::PixelFormat::Unknown);
+	assert(bytespp != 0);
+	if (pxf_uncomp == ImageDecoder::PixelFormat::Unknown || bytespp == 0) {
+		// Pixel format wasn't updated...
+		return 0;
+	}
+
+	// NOTE: The pitch in the DDS header only applies to the full image.
+	unsigned int stride = 0;
+	if (mip == 0) {
+		// If DDSD_LINEARSIZE is set, the field is linear size,
+		// so it needs to be divided by the image height.
+		if (ddsHeader.dwFlags & DDSD_LINEARSIZE) {
+			if (ddsHeader.dwHeight != 0) {
+				stride = ddsHeader.dwPitchOrLinearSize / ddsHeader.dwHeight;
+			}
+		} else {
+			stride = ddsHeader.dwPitchOrLinearSize;
 		}
+	}
+	if (stride == 0) {
+		// Invalid stride. Assume stride == width * bytespp.
+		// TODO: Check for stride is too small but non-zero?
+		stride = width * bytespp;
+	} else if (stride > (width * 16)) {
+		// Stride is too large.
+		return 0;
+	}
+
+	if (pStride) {
+		*pStride = stride;
+	}
+	return height * stride;
+}
+
+/**
+ * Load the image.
+ * @param mip Mipmap number. (0 == full image)
+ * @return Image, or nullptr on error.
+ */
+const rp_image *DirectDrawSurfacePrivate::loadImage(int mip)
+{
+	// NOTE: DDSD_MIPMAPCOUNT might not be accurate, so ignore it.
+	// Mipmap count is clamped to 16. (32768x32768 has 16 levels.)
+	int mipmapCount = std::min(ddsHeader.dwMipMapCount, 16U);
+	if (mipmapCount <= 0) {
+		// No mipmaps == one image.
+		mipmapCount = 1;
+	}
 
-		// Read the texture data.
-		auto buf = aligned_uptr<uint8_t>(16, expected_size);
-		size_t size = file->read(buf.get(), expected_size);
-		if (size != expected_size) {
-			// Read error.
+	assert(mip >= 0);
+	assert(mip < mipmapCount);
+	if (mip < 0 || mip >= mipmapCount) {
+		// Invalid mipmap number.
+		return nullptr;
+	}
+
+	if (!mipmaps.empty() && mipmaps[mip] != nullptr) {
+		// Image has already been loaded.
+		return mipmaps[mip];
+	} else if (!this->file || !this->isValid) {
+		// Can't load the image.
+		return nullptr;
+	}
+
+	// Sanity check: Maximum image dimensions of 32768x32768.
+	assert(ddsHeader.dwWidth > 0);
+	assert(ddsHeader.dwWidth <= 32768);
+	assert(ddsHeader.dwHeight > 0);
+	assert(ddsHeader.dwHeight <= 32768);
+	if (ddsHeader.dwWidth == 0 || ddsHeader.dwWidth > 32768 ||
+	    ddsHeader.dwHeight == 0 || ddsHeader.dwHeight > 32768)
+	{
+		// Invalid image dimensions.
+		return nullptr;
+	}
+
+	// Texture cannot start inside of the DDS header.
+	// TODO: Also dxt10Header for DX10?
+	// TODO: ...and xb1Header for XBOX?
+	assert(texDataStartAddr >= sizeof(ddsHeader));
+	if (texDataStartAddr < sizeof(ddsHeader)) {
+		// Invalid texture data start address.
+		return nullptr;
+	}
+
+	// Volume textures have multiple depth slices per mipmap level.
+	// Each level has half as many slices as the previous level.
+	// Only the first slice of the selected level is decoded.
+	const bool isVolume = ((ddsHeader.dwCaps2 & DDSCAPS2_VOLUME) && ddsHeader.dwDepth > 1);
+
+	// NOTE: Only the selected mipmap is read, and it's read in bands
+	// if necessary, so large files don't need to be rejected here.
+	const off64_t file_sz = file->size();
+
+	// NOTE: Mipmaps are stored *after* the main image.
+	// For cubemaps, all mipmaps for a face are stored
+	// before the next face, so this works for the first face.
+	off64_t start_addr = texDataStartAddr;
+	for (int i = 0; i < mip; i++) {
+		const unsigned int mip_size = calcMipmapSize(i);
+		if (mip_size == 0) {
+			// Mipmap size calculation error...
 			return nullptr;
 		}
+		const unsigned int depth = (isVolume ? std::max(ddsHeader.dwDepth >> i, 1U) : 1U);
+		start_addr += static_cast<off64_t>(mip_size) * depth;
+	}
 
+	// NOTE: PVRTC mipmaps may be padded. If so, the image will be
+	// decoded using the physical dimensions, then cropped.
+	const unsigned int width = std::max(ddsHeader.dwWidth >> mip, 1U);
+	const unsigned int height = std::max(ddsHeader.dwHeight >> mip, 1U);
+	unsigned int physWidth, physHeight;
+	getPhysDimensions(mip, &physWidth, &physHeight);
+	unsigned int stride = 0;
+	const unsigned int expected_size = calcMipmapSize(mip, &stride);
+	if (expected_size == 0) {
+		// Not supported.
+		return nullptr;
+	}
+
+	// Verify file size.
+	if (start_addr + expected_size > file_sz) {
+		// File is too small.
+		return nullptr;
+	}
+
+	// Determine the tile layout for streamed decoding.
+	int tileH;
+	if (dxgi_format == 0 || dxgi_format == DXGI_FORMAT_R9G9B9E5_SHAREDEXP) {
+		// Linear image data.
+		tileH = 1;
+#ifdef ENABLE_PVRTC
+	} else if (dxgi_format == DXGI_FORMAT_FAKE_PVRTC_2bpp ||
+	           dxgi_format == DXGI_FORMAT_FAKE_PVRTC_4bpp)
+	{
+		// PVRTC blocks depend on neighboring blocks,
+		// so the image must be decoded all at once.
+		tileH = physHeight;
+#endif /* ENABLE_PVRTC */
+	} else {
+		// Block-compressed image data. (4x4 tiles)
+		tileH = 4;
+	}
+	const unsigned int tileRows = (physHeight + tileH - 1) / tileH;
+
+	// Read and decode the texture data.
+	DecodeParams params;
+	params.d = this;
+	params.width = physWidth;
+	params.stride = stride;
+	rp_image *img = ImageDecoder::fromFile_banded(decodeBand, &params,
+		physWidth, physHeight, tileH, expected_size / tileRows,
+		file, start_addr);
+
+	if (img && (physWidth != width || physHeight != height)) {
+		// Crop the padding from the decoded image.
+		rp_image *const img_crop = img->resized(width, height);
+		img->unref();
+		img = img_crop;
+	}
+
+	// TODO: Untile textures for XBOX format.
+	if (img) {
+		if (mipmaps.empty()) {
+			mipmaps.resize(mipmapCount);
+		}
+		mipmaps[mip] = img;
+	}
+	return img;
+}
+
+/**
+ * Decode a band of the image.
+ * Used as the band decoding function for ImageDecoder::fromFile_banded().
+ * @param param DecodeParams
+ * @param height Band height.
+ * @param img_buf Image buffer for the band.
+ * @param img_siz Size of image data for the band.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *DirectDrawSurfacePrivate::decodeBand(void *param, int height, const uint8_t *img_buf, int img_siz)
+{
+	const DecodeParams *const params = static_cast<const DecodeParams*>(param);
+	const DirectDrawSurfacePrivate *const d = params->d;
+
+	// TODO: Handle DX10 alpha processing.
+	// Currently, we're assuming straight alpha for formats
+	// that have an alpha channel, except for DXT2 and DXT4,
+	// which use premultiplied alpha.
+	rp_image *img = nullptr;
+	if (d->dxgi_format != 0) {
+		// Compressed RGB data.
 		// TODO: Handle typeless, signed, sRGB, float.
-		switch (dxgi_format) {
+		switch (d->dxgi_format) {
 			case DXGI_FORMAT_BC1_TYPELESS:
 			case DXGI_FORMAT_BC1_UNORM:
 			case DXGI_FORMAT_BC1_UNORM_SRGB:
-				if (likely(dxgi_alpha != DDS_ALPHA_MODE_OPAQUE)) {
+				if (likely(d->dxgi_alpha != DDS_ALPHA_MODE_OPAQUE)) {
 					// 1-bit alpha.
 					img = ImageDecoder::fromDXT1_A1(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						params->width, height,
+						img_buf, img_siz);
 				} else {
 					// No alpha channel.
 					img = ImageDecoder::fromDXT1(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						params->width, height,
+						img_buf, img_siz);
 				}
 				break;
 
 			case DXGI_FORMAT_BC2_TYPELESS:
 			case DXGI_FORMAT_BC2_UNORM:
 			case DXGI_FORMAT_BC2_UNORM_SRGB:
-				if (likely(dxgi_alpha != DDS_ALPHA_MODE_PREMULTIPLIED)) {
+				if (likely(d->dxgi_alpha != DDS_ALPHA_MODE_PREMULTIPLIED)) {
 					// Standard alpha: DXT3
 					img = ImageDecoder::fromDXT3(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						params->width, height,
+						img_buf, img_siz);
 				} else {
 					// Premultiplied alpha: DXT2
 					img = ImageDecoder::fromDXT2(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						params->width, height,
+						img_buf, img_siz);
 				}
 				break;
 
 			case DXGI_FORMAT_BC3_TYPELESS:
 			case DXGI_FORMAT_BC3_UNORM:
 			case DXGI_FORMAT_BC3_UNORM_SRGB:
-				if (likely(dxgi_alpha != DDS_ALPHA_MODE_PREMULTIPLIED)) {
+				if (likely(d->dxgi_alpha != DDS_ALPHA_MODE_PREMULTIPLIED)) {
 					// Standard alpha: DXT5
 					img = ImageDecoder::fromDXT5(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						params->width, height,
+						img_buf, img_siz);
 				} else {
 					// Premultiplied alpha: DXT4
 					img = ImageDecoder::fromDXT4(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
-						buf.get(), expected_size);
+						params->width, height,
+						img_buf, img_siz);
 				}
 				break;
 
@@ -675,40 +929,40 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case DXGI_FORMAT_BC4_UNORM:
 			case DXGI_FORMAT_BC4_SNORM:
 				img = ImageDecoder::fromBC4(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size);
+					params->width, height,
+					img_buf, img_siz);
 				break;
 
 			case DXGI_FORMAT_BC5_TYPELESS:
 			case DXGI_FORMAT_BC5_UNORM:
 			case DXGI_FORMAT_BC5_SNORM:
 				img = ImageDecoder::fromBC5(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size);
+					params->width, height,
+					img_buf, img_siz);
 				break;
 
 			case DXGI_FORMAT_BC7_TYPELESS:
 			case DXGI_FORMAT_BC7_UNORM:
 			case DXGI_FORMAT_BC7_UNORM_SRGB:
 				img = ImageDecoder::fromBC7(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size);
+					params->width, height,
+					img_buf, img_siz);
 				break;
 
 #ifdef ENABLE_PVRTC
 			case DXGI_FORMAT_FAKE_PVRTC_2bpp:
 				// PVRTC, 2bpp, has alpha.
 				img = ImageDecoder::fromPVRTC(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size,
+					params->width, height,
+					img_buf, img_siz,
 					ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES);
 				break;
 
 			case DXGI_FORMAT_FAKE_PVRTC_4bpp:
 				// PVRTC, 4bpp, has alpha.
 				img = ImageDecoder::fromPVRTC(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size,
+					params->width, height,
+					img_buf, img_siz,
 					ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES);
 				break;
 #endif /* ENABLE_PVRTC */
@@ -717,9 +971,9 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 				// RGB9_E5 (technically uncompressed...)
 				img = ImageDecoder::fromLinear32(
 					ImageDecoder::PixelFormat::RGB9_E5,
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
-					reinterpret_cast<const uint32_t*>(buf.get()),
-					expected_size);
+					params->width, height,
+					reinterpret_cast<const uint32_t*>(img_buf),
+					img_siz);
 				break;
 
 			default:
@@ -728,76 +982,35 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 		}
 	} else {
 		// Uncompressed linear image data.
-		assert(pxf_uncomp != ImageDecoder::PixelFormat::Unknown);
-		assert(bytespp != 0);
-		if (pxf_uncomp == ImageDecoder::PixelFormat::Unknown || bytespp == 0) {
-			// Pixel format wasn't updated...
-			return nullptr;
-		}
-
-		// If DDSD_LINEARSIZE is set, the field is linear size,
-		// so it needs to be divided by the image height.
-		unsigned int stride = 0;
-		if (ddsHeader.dwFlags & DDSD_LINEARSIZE) {
-			if (ddsHeader.dwHeight != 0) {
-				stride = ddsHeader.dwPitchOrLinearSize / ddsHeader.dwHeight;
-			}
-		} else {
-			stride = ddsHeader.dwPitchOrLinearSize;
-		}
-		if (stride == 0) {
-			// Invalid stride. Assume stride == width * bytespp.
-			// TODO: Check for stride is too small but non-zero?
-			stride = ddsHeader.dwWidth * bytespp;
-		} else if (stride > (ddsHeader.dwWidth * 16)) {
-			// Stride is too large.
-			return nullptr;
-		}
-		const unsigned int expected_size = ddsHeader.dwHeight * stride;
-
-		// Verify file size.
-		if (expected_size >= file_sz + texDataStartAddr) {
-			// File is too small.
-			return nullptr;
-		}
-
-		// Read the texture data.
-		auto buf = aligned_uptr<uint8_t>(16, expected_size);
-		size_t size = file->read(buf.get(), expected_size);
-		if (size != expected_size) {
-			// Read error.
-			return nullptr;
-		}
-
-		switch (bytespp) {
+		switch (d->bytespp) {
 			case sizeof(uint8_t):
 				// 8-bit image. (Usually luminance or alpha.)
 				img = ImageDecoder::fromLinear8(
-					pxf_uncomp, ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size, stride);
+					d->pxf_uncomp, params->width, height,
+					img_buf, img_siz, params->stride);
 				break;
 
 			case sizeof(uint16_t):
 				// 16-bit RGB image.
 				img = ImageDecoder::fromLinear16(
-					pxf_uncomp, ddsHeader.dwWidth, ddsHeader.dwHeight,
-					reinterpret_cast<const uint16_t*>(buf.get()),
-					expected_size, stride);
+					d->pxf_uncomp, params->width, height,
+					reinterpret_cast<const uint16_t*>(img_buf),
+					img_siz, params->stride);
 				break;
 
 			case 24/8:
 				// 24-bit RGB image.
 				img = ImageDecoder::fromLinear24(
-					pxf_uncomp, ddsHeader.dwWidth, ddsHeader.dwHeight,
-					buf.get(), expected_size, stride);
+					d->pxf_uncomp, params->width, height,
+					img_buf, img_siz, params->stride);
 				break;
 
 			case sizeof(uint32_t):
 				// 32-bit RGB image.
 				img = ImageDecoder::fromLinear32(
-					pxf_uncomp, ddsHeader.dwWidth, ddsHeader.dwHeight,
-					reinterpret_cast<const uint32_t*>(buf.get()),
-					expected_size, stride);
+					d->pxf_uncomp, params->width, height,
+					reinterpret_cast<const uint32_t*>(img_buf),
+					img_siz, params->stride);
 				break;
 
 			default:
@@ -806,8 +1019,6 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 				break;
 		}
 	}
-
-	// TODO: Untile textures for XBOX format.
 	return img;
 }
 
@@ -889,21 +1100,12 @@ DirectDrawSurface::DirectDrawSurface(IRpFile *file)
 			memcpy(&d->xb1Header, &header[4+sizeof(DDS_HEADER)+sizeof(DDS_HEADER_DXT10)], sizeof(d->xb1Header));
 		}
 
-#if SYS_BYTEORDER == SYS_BIG_ENDIAN
 		// Byteswap the DXT10 header.
-		d->dxt10Header.dxgiFormat = (DXGI_FORMAT)le32_to_cpu((uint32_t)d->dxt10Header.dxgiFormat);
-		d->dxt10Header.resourceDimension = (D3D10_RESOURCE_DIMENSION)le32_to_cpu((uint32_t)d->dxt10Header.resourceDimension);
-		d->dxt10Header.miscFlag   = le32_to_cpu(d->dxt10Header.miscFlag);
-		d->dxt10Header.arraySize  = le32_to_cpu(d->dxt10Header.arraySize);
-		d->dxt10Header.miscFlags2 = le32_to_cpu(d->dxt10Header.miscFlags2);
+		le_struct_to_cpu(d->dxt10Header);
 		if (isXbox) {
 			// Byteswap the Xbox One header.
-			d->xb1Header.tileMode		= le32_to_cpu(d->xb1Header.tileMode);
-			d->xb1Header.baseAlignment	= le32_to_cpu(d->xb1Header.baseAlignment);
-			d->xb1Header.dataSize		= le32_to_cpu(d->xb1Header.dataSize);
-			d->xb1Header.xdkVer		= le32_to_cpu(d->xb1Header.xdkVer);
+			le_struct_to_cpu(d->xb1Header);
 		}
-#endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
 
 		// Make sure the dxgiFormat is not one of our "fake" formats.
 		// If it is, assume the texture isn't supported for now.
@@ -928,34 +1130,12 @@ DirectDrawSurface::DirectDrawSurface(IRpFile *file)
 	// Save the DDS header.
 	memcpy(&d->ddsHeader, pSrcHeader, sizeof(d->ddsHeader));
 
-#if SYS_BYTEORDER == SYS_BIG_ENDIAN
 	// Byteswap the DDS header.
-	d->ddsHeader.dwSize		= le32_to_cpu(d->ddsHeader.dwSize);
-	d->ddsHeader.dwFlags		= le32_to_cpu(d->ddsHeader.dwFlags);
-	d->ddsHeader.dwHeight		= le32_to_cpu(d->ddsHeader.dwHeight);
-	d->ddsHeader.dwWidth		= le32_to_cpu(d->ddsHeader.dwWidth);
-	d->ddsHeader.dwPitchOrLinearSize	= le32_to_cpu(d->ddsHeader.dwPitchOrLinearSize);
-	d->ddsHeader.dwDepth		= le32_to_cpu(d->ddsHeader.dwDepth);
-	d->ddsHeader.dwMipMapCount	= le32_to_cpu(d->ddsHeader.dwMipMapCount);
-	d->ddsHeader.dwCaps	= le32_to_cpu(d->ddsHeader.dwCaps);
-	d->ddsHeader.dwCaps2	= le32_to_cpu(d->ddsHeader.dwCaps2);
-	d->ddsHeader.dwCaps3	= le32_to_cpu(d->ddsHeader.dwCaps3);
-	d->ddsHeader.dwCaps4	= le32_to_cpu(d->ddsHeader.dwCaps4);
-
-	// Byteswap the DDS pixel format.
-	// NOTE: FourCC is handled separately.
-	DDS_PIXELFORMAT &ddspf = d->ddsHeader.ddspf;
-	ddspf.dwSize		= le32_to_cpu(ddspf.dwSize);
-	ddspf.dwFlags		= le32_to_cpu(ddspf.dwFlags);
-	ddspf.dwRGBBitCount	= le32_to_cpu(ddspf.dwRGBBitCount);
-	ddspf.dwRBitMask	= le32_to_cpu(ddspf.dwRBitMask);
-	ddspf.dwGBitMask	= le32_to_cpu(ddspf.dwGBitMask);
-	ddspf.dwBBitMask	= le32_to_cpu(ddspf.dwBBitMask);
-	ddspf.dwABitMask	= le32_to_cpu(ddspf.dwABitMask);
-#else /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
+	le_struct_to_cpu(d->ddsHeader);
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
 	// FourCC is considered to be big-endian.
 	d->ddsHeader.ddspf.dwFourCC = be32_to_cpu(d->ddsHeader.ddspf.dwFourCC);
-#endif
+#endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
 
 	// Update the pixel format.
 	d->updatePixelFormat();
@@ -1331,11 +1511,7 @@ const rp_image *DirectDrawSurface::mipmap(int mip) const
 		return nullptr;
 	}
 
-	// FIXME: Support decoding mipmaps.
-	if (mip == 0) {
-		return const_cast<DirectDrawSurfacePrivate*>(d)->loadImage();
-	}
-	return nullptr;
+	return const_cast<DirectDrawSurfacePrivate*>(d)->loadImage(mip);
 }
 
 }
@@ -144,4 +144,85 @@ int FileFormat::getDimensions(int pBuf[3]) const
 	return 0;
 }
 
+/** Image accessors **/
+
+/**
+ * Get the embedded low-resolution preview image.
+ * Some formats, e.g. Valve VTF, store a small preview
+ * image separately from the mipmaps.
+ * @return Preview image, or nullptr if not available.
+ */
+const rp_image *FileFormat::previewImage(void) const
+{
+	// Not supported by default.
+	return nullptr;
+}
+
+/**
+ * Get the embedded preview image's dimensions.
+ * This does not decode the preview image.
+ * @param pBuf Two-element array for [x, y].
+ * @return 0 on success; negative POSIX error code on error. (-ENOENT if not available)
+ */
+int FileFormat::getPreviewDimensions(int pBuf[2]) const
+{
+	// Not supported by default.
+	RP_UNUSED(pBuf);
+	return -ENOENT;
+}
+
+/**
+ * Get the smallest image that is at least the requested size.
+ *
+ * The embedded preview image and the mipmaps are checked,
+ * so the full image doesn't need to be decoded for small
+ * thumbnails. If no smaller image is large enough, or if
+ * it can't be decoded, the full image is returned.
+ *
+ * @param size Requested size, in pixels. (largest dimension)
+ * @return Image, or nullptr on error.
+ */
+const rp_image *FileFormat::imageForSize(int size) const
+{
+	RP_D(const FileFormat);
+	if (!d->isValid) {
+		// Not supported.
+		return nullptr;
+	} else if (size <= 0) {
+		// Use the full image.
+		return image();
+	}
+
+	// Check the preview image first. It's usually
+	// smaller than any mipmap, e.g. 16x16 for VTF.
+	int pdims[2];
+	if (getPreviewDimensions(pdims) == 0 && std::max(pdims[0], pdims[1]) >= size) {
+		const rp_image *const img = previewImage();
+		if (img) {
+			return img;
+		}
+	}
+
+	// Find the smallest mipmap that is at least the requested size.
+	// NOTE: Height might be 0 for 1D textures.
+	const int width = d->dimensions[0];
+	const int height = d->dimensions[1];
+	const int mipmapCount = this->mipmapCount();
+	int mip = 0;
+	for (int i = 1; i < mipmapCount; i++) {
+		if (std::max(width >> i, height >> i) < size)
+			break;
+		mip = i;
+	}
+	if (mip > 0) {
+		// NOTE: Some formats can only decode mipmap 0.
+		const rp_image *const img = mipmap(mip);
+		if (img) {
+			return img;
+		}
+	}
+
+	return image();
+}
+
 }
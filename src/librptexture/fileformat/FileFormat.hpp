@@ -194,6 +194,35 @@ class FileFormat : public RefBase
 		 * @return Image, or nullptr on error.
 		 */
 		virtual const rp_image *mipmap(int mip) const = 0;
+
+		/**
+		 * Get the embedded low-resolution preview image.
+		 * Some formats, e.g. Valve VTF, store a small preview
+		 * image separately from the mipmaps.
+		 * @return Preview image, or nullptr if not available.
+		 */
+		virtual const rp_image *previewImage(void) const;
+
+		/**
+		 * Get the embedded preview image's dimensions.
+		 * This does not decode the preview image.
+		 * @param pBuf Two-element array for [x, y].
+		 * @return 0 on success; negative POSIX error code on error. (-ENOENT if not available)
+		 */
+		virtual int getPreviewDimensions(int pBuf[2]) const;
+
+		/**
+		 * Get the smallest image that is at least the requested size.
+		 *
+		 * The embedded preview image and the mipmaps are checked,
+		 * so the full image doesn't need to be decoded for small
+		 * thumbnails. If no smaller image is large enough, or if
+		 * it can't be decoded, the full image is returned.
+		 *
+		 * @param size Requested size, in pixels. (largest dimension)
+		 * @return Image, or nullptr on error.
+		 */
+		const rp_image *imageForSize(int size) const;
 };
 
 }
@@ -162,6 +162,27 @@ class klass final : public LibRpTexture::FileFormat { \
 		 */ \
 		void close(void) final;
 
+/**
+ * FileFormat subclass function declarations for embedded preview images.
+ * Only needed if the format stores a low-resolution image separately
+ * from the mipmaps, e.g. Valve VTF.
+ */
+#define FILEFORMAT_DECL_PREVIEW() \
+	public: \
+		/** \
+		 * Get the embedded low-resolution preview image. \
+		 * @return Preview image, or nullptr if not available. \
+		 */ \
+		const LibRpTexture::rp_image *previewImage(void) const final; \
+		\
+		/** \
+		 * Get the embedded preview image's dimensions. \
+		 * This does not decode the preview image. \
+		 * @param pBuf Two-element array for [x, y]. \
+		 * @return 0 on success; negative POSIX error code on error. (-ENOENT if not available) \
+		 */ \
+		int getPreviewDimensions(int pBuf[2]) const final;
+
 /**
  * End of FileFormat subclass declaration.
  */
@@ -78,6 +78,23 @@ class KhronosKTXPrivate final : public FileFormatPrivate
 		// RFT_LISTDATA.
 		vector<vector<string> > kv_data;
 
+		// Parameters for decodeBand().
+		struct DecodeParams {
+			const KhronosKTXPrivate *d;
+			int stride;	// Row stride. (uncompressed formats only)
+		};
+
+		/**
+		 * Decode a band of the image.
+		 * Used as the band decoding function for ImageDecoder::fromFile_banded().
+		 * @param param DecodeParams
+		 * @param height Band height.
+		 * @param img_buf Image buffer for the band.
+		 * @param img_siz Size of image data for the band.
+		 * @return rp_image, or nullptr on error.
+		 */
+		static rp_image *decodeBand(void *param, int height, const uint8_t *img_buf, int img_siz);
+
 		/**
 		 * Load the image.
 		 * @return Image, or nullptr on error.
@@ -142,11 +159,9 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 		return nullptr;
 	}
 
-	if (file->size() > 128*1024*1024) {
-		// Sanity check: KTX files shouldn't be more than 128 MB.
-		return nullptr;
-	}
-	const uint32_t file_sz = static_cast<uint32_t>(file->size());
+	// NOTE: Only the first image is read, and it's read in bands
+	// if necessary, so large files don't need to be rejected here.
+	const off64_t file_sz = file->size();
 
 	// Seek to the start of the texture data.
 	int ret = file->seek(texDataStartAddr);
@@ -164,8 +179,10 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 
 	// Calculate the expected size.
 	// NOTE: Scanlines are 4-byte aligned.
+	// NOTE: tileH is the number of rows that must be decoded together.
 	uint32_t expected_size;
 	int stride = 0;
+	int tileH = 1;
 	switch (ktxHeader.glFormat) {
 		case GL_RGB:
 			// 24-bit RGB.
@@ -202,6 +219,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 				case GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG:
 					// 32 pixels compressed into 64 bits. (2bpp)
 					expected_size = (ktxHeader.pixelWidth * height) / 4;
+					tileH = height;
 					break;
 
 				case GL_COMPRESSED_RGBA_PVRTC_2BPPV2_IMG:
@@ -209,18 +227,21 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// NOTE: Width and height must be rounded to the nearest tile. (8x4)
 					expected_size = ALIGN_BYTES(8, ktxHeader.pixelWidth) *
 					                ALIGN_BYTES(4, (int)height) / 4;
+					tileH = height;
 					break;
 
 				case GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG:
 				case GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG:
 					// 16 pixels compressed into 64 bits. (4bpp)
 					expected_size = (ktxHeader.pixelWidth * height) / 2;
+					tileH = height;
 					break;
 
 				case GL_COMPRESSED_RGBA_PVRTC_4BPPV2_IMG:
 					// NOTE: Width and height must be rounded to the nearest tile. (4x4)
 					expected_size = ALIGN_BYTES(4, ktxHeader.pixelWidth) *
 					                ALIGN_BYTES(4, (int)height) / 2;
+					tileH = height;
 					break;
 #endif /* ENABLE_PVRTC */
 
@@ -243,6 +264,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// NOTE: Width and height must be rounded to the nearest tile. (4x4)
 					expected_size = ALIGN_BYTES(4, ktxHeader.pixelWidth) *
 					                ALIGN_BYTES(4, (int)height) / 2;
+					tileH = 4;
 					break;
 
 				//case GL_RGBA_S3TC:	// TODO
@@ -265,6 +287,7 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// NOTE: Width and height must be rounded to the nearest tile. (4x4)
 					expected_size = ALIGN_BYTES(4, ktxHeader.pixelWidth) *
 					                ALIGN_BYTES(4, (int)height);
+					tileH = 4;
 					break;
 
 				case GL_RGB9_E5:
@@ -281,7 +304,9 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 	}
 
 	// Verify file size.
-	if (texDataStartAddr + expected_size > file_sz) {
+	if (expected_size == 0 ||
+	    static_cast<off64_t>(texDataStartAddr) + static_cast<off64_t>(sizeof(uint32_t)) + expected_size > file_sz)
+	{
 		// File is too small.
 		return nullptr;
 	}
@@ -311,40 +336,68 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 		}
 	}
 
-	// Read the texture data.
-	auto buf = aligned_uptr<uint8_t>(16, expected_size);
-	size = file->read(buf.get(), expected_size);
-	if (size != expected_size) {
-		// Read error.
-		return nullptr;
+	// Read and decode the texture data.
+	const unsigned int tileRows = (height + tileH - 1) / tileH;
+	DecodeParams params;
+	params.d = this;
+	params.stride = stride;
+	img = ImageDecoder::fromFile_banded(decodeBand, &params,
+		ktxHeader.pixelWidth, height, tileH, expected_size / tileRows,
+		file, texDataStartAddr + sizeof(imageSize));
+
+	// Post-processing: Check if a flip is needed.
+	if (img && flipOp != rp_image::FLIP_NONE) {
+		rp_image *const flipimg = img->flip(flipOp);
+		if (flipimg) {
+			img->unref();
+			img = flipimg;
+		}
 	}
 
+	return img;
+}
+
+/**
+ * Decode a band of the image.
+ * Used as the band decoding function for ImageDecoder::fromFile_banded().
+ * @param param DecodeParams
+ * @param height Band height.
+ * @param img_buf Image buffer for the band.
+ * @param img_siz Size of image data for the band.
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *KhronosKTXPrivate::decodeBand(void *param, int height, const uint8_t *img_buf, int img_siz)
+{
+	const DecodeParams *const params = static_cast<const DecodeParams*>(param);
+	const KhronosKTXPrivate *const d = params->d;
+
 	// TODO: Byteswapping.
 	// TODO: Handle variants. Check for channel sizes in glInternalFormat?
 	// TODO: Handle sRGB post-processing? (for e.g. GL_SRGB8)
-	switch (ktxHeader.glFormat) {
+	rp_image *img = nullptr;
+	switch (d->ktxHeader.glFormat) {
 		case GL_RGB:
 			// 24-bit RGB.
 			img = ImageDecoder::fromLinear24(
 				ImageDecoder::PixelFormat::BGR888,
-				ktxHeader.pixelWidth, height,
-				buf.get(), expected_size, stride);
+				d->ktxHeader.pixelWidth, height,
+				img_buf, img_siz, params->stride);
 			break;
 
 		case GL_RGBA:
 			// 32-bit RGBA.
 			img = ImageDecoder::fromLinear32(
 				ImageDecoder::PixelFormat::ABGR8888,
-				ktxHeader.pixelWidth, height,
-				reinterpret_cast<const uint32_t*>(buf.get()), expected_size, stride);
+				d->ktxHeader.pixelWidth, height,
+				reinterpret_cast<const uint32_t*>(img_buf), img_siz, params->stride);
 			break;
 
 		case GL_LUMINANCE:
 			// 8-bit Luminance.
 			img = ImageDecoder::fromLinear8(
 				ImageDecoder::PixelFormat::L8,
-				ktxHeader.pixelWidth, height,
-				buf.get(), expected_size, stride);
+				d->ktxHeader.pixelWidth, height,
+				img_buf, img_siz, params->stride);
 			break;
 
 		case GL_RGB9_E5:
@@ -352,36 +405,36 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 			// TODO: Does KTX handle GL_RGB9_E5 as compressed?
 			img = ImageDecoder::fromLinear32(
 				ImageDecoder::PixelFormat::RGB9_E5,
-				ktxHeader.pixelWidth, height,
-				reinterpret_cast<const uint32_t*>(buf.get()), expected_size, stride);
+				d->ktxHeader.pixelWidth, height,
+				reinterpret_cast<const uint32_t*>(img_buf), img_siz, params->stride);
 			break;
 
 		case 0:
 		default:
 			// May be a compressed format.
 			// TODO: sRGB post-processing for sRGB formats?
-			switch (ktxHeader.glInternalFormat) {
+			switch (d->ktxHeader.glInternalFormat) {
 				case GL_RGB_S3TC:
 				case GL_RGB4_S3TC:
 				case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
 					// DXT1-compressed texture.
 					img = ImageDecoder::fromDXT1(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					break;
 
 				case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
 					// DXT1-compressed texture with 1-bit alpha.
 					img = ImageDecoder::fromDXT1_A1(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					break;
 
 				case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
 					// DXT3-compressed texture.
 					img = ImageDecoder::fromDXT3(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					break;
 
 				case GL_RGBA_DXT5_S3TC:
@@ -389,15 +442,15 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 				case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
 					// DXT5-compressed texture.
 					img = ImageDecoder::fromDXT5(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					break;
 
 				case GL_ETC1_RGB8_OES:
 					// ETC1-compressed texture.
 					img = ImageDecoder::fromETC1(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					break;
 
 				case GL_COMPRESSED_RGB8_ETC2:
@@ -405,8 +458,8 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// ETC2-compressed RGB texture.
 					// TODO: Handle sRGB.
 					img = ImageDecoder::fromETC2_RGB(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					break;
 
 				case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
@@ -415,8 +468,8 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// with punchthrough alpha.
 					// TODO: Handle sRGB.
 					img = ImageDecoder::fromETC2_RGB_A1(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					break;
 
 				case GL_COMPRESSED_RGBA8_ETC2_EAC:
@@ -425,8 +478,8 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// with EAC-compressed alpha channel.
 					// TODO: Handle sRGB.
 					img = ImageDecoder::fromETC2_RGBA(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					break;
 
 				case GL_COMPRESSED_RED_RGTC1:
@@ -434,8 +487,8 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// RGTC, one component. (BC4)
 					// TODO: Handle signed properly.
 					img = ImageDecoder::fromBC4(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					break;
 
 				case GL_COMPRESSED_RG_RGTC2:
@@ -443,8 +496,8 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// RGTC, two components. (BC5)
 					// TODO: Handle signed properly.
 					img = ImageDecoder::fromBC5(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					break;
 
 				case GL_COMPRESSED_LUMINANCE_LATC1_EXT:
@@ -452,8 +505,8 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// LATC, one component. (BC4)
 					// TODO: Handle signed properly.
 					img = ImageDecoder::fromBC4(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					// TODO: If this fails, return it anyway or return nullptr?
 					ImageDecoder::fromRed8ToL8(img);
 					break;
@@ -463,8 +516,8 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// LATC, two components. (BC5)
 					// TODO: Handle signed properly.
 					img = ImageDecoder::fromBC5(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					// TODO: If this fails, return it anyway or return nullptr?
 					ImageDecoder::fromRG8ToLA8(img);
 					break;
@@ -473,52 +526,52 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 				case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
 					// BPTC-compressed RGBA texture. (BC7)
 					img = ImageDecoder::fromBC7(
-						ktxHeader.pixelWidth, height,
-						buf.get(), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz);
 					break;
 
 #ifdef ENABLE_PVRTC
 				case GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG:
 					// PVRTC, 2bpp, no alpha.
-					img = ImageDecoder::fromPVRTC(ktxHeader.pixelWidth, height,
-						buf.get(), expected_size,
+					img = ImageDecoder::fromPVRTC(d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz,
 						ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_NONE);
 					break;
 
 				case GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG:
 					// PVRTC, 2bpp, has alpha.
-					img = ImageDecoder::fromPVRTC(ktxHeader.pixelWidth, height,
-						buf.get(), expected_size,
+					img = ImageDecoder::fromPVRTC(d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz,
 						ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES);
 					break;
 
 				case GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG:
 					// PVRTC, 4bpp, no alpha.
-					img = ImageDecoder::fromPVRTC(ktxHeader.pixelWidth, height,
-						buf.get(), expected_size,
+					img = ImageDecoder::fromPVRTC(d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz,
 						ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_NONE);
 					break;
 
 				case GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG:
 					// PVRTC, 4bpp, has alpha.
-					img = ImageDecoder::fromPVRTC(ktxHeader.pixelWidth, height,
-						buf.get(), expected_size,
+					img = ImageDecoder::fromPVRTC(d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz,
 						ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES);
 					break;
 
 				case GL_COMPRESSED_RGBA_PVRTC_2BPPV2_IMG:
 					// PVRTC-II, 2bpp.
 					// NOTE: Assuming this has alpha.
-					img = ImageDecoder::fromPVRTCII(ktxHeader.pixelWidth, height,
-						buf.get(), expected_size,
+					img = ImageDecoder::fromPVRTCII(d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz,
 						ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES);
 					break;
 
 				case GL_COMPRESSED_RGBA_PVRTC_4BPPV2_IMG:
 					// PVRTC-II, 4bpp.
 					// NOTE: Assuming this has alpha.
-					img = ImageDecoder::fromPVRTCII(ktxHeader.pixelWidth, height,
-						buf.get(), expected_size,
+					img = ImageDecoder::fromPVRTCII(d->ktxHeader.pixelWidth, height,
+						img_buf, img_siz,
 						ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES);
 					break;
 #endif /* ENABLE_PVRTC */
@@ -528,8 +581,8 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 					// TODO: Does KTX handle GL_RGB9_E5 as compressed?
 					img = ImageDecoder::fromLinear32(
 						ImageDecoder::PixelFormat::RGB9_E5,
-						ktxHeader.pixelWidth, height,
-						reinterpret_cast<const uint32_t*>(buf.get()), expected_size);
+						d->ktxHeader.pixelWidth, height,
+						reinterpret_cast<const uint32_t*>(img_buf), img_siz);
 					break;
 
 				default:
@@ -538,16 +591,6 @@ const rp_image *KhronosKTXPrivate::loadImage(void)
 			}
 			break;
 	}
-
-	// Post-processing: Check if a flip is needed.
-	if (img && flipOp != rp_image::FLIP_NONE) {
-		rp_image *const flipimg = img->flip(flipOp);
-		if (flipimg) {
-			img->unref();
-			img = flipimg;
-		}
-	}
-
 	return img;
 }
 
@@ -630,7 +673,7 @@ void KhronosKTXPrivate::loadKeyValueData(void)
 		data_row.reserve(2);
 		data_row.emplace_back(string(p, k_end - p));
 		data_row.emplace_back(string(k_end + 1, kv_end - k_end - 2));
-		kv_data.emplace_back(data_row);
+		kv_data.emplace_back(std::move(data_row));
 
 		// Check if this is KTXorientation.
 		// NOTE: Only the first instance is used.
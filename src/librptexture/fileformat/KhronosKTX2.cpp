@@ -22,6 +22,9 @@
 #include "vk_defs.h"
 #include "data/VkEnumStrings.hpp"
 
+// librpcpu
+#include "librpcpu/byteswap_struct.hpp"
+
 // librpbase, librpfile
 #include "libi18n/i18n.h"
 using LibRpBase::rp_sprintf;
@@ -42,6 +45,28 @@ using std::vector;
 // FIXME: Move out of librpbase?
 #include "librpbase/uvector.h"
 
+// KTX2 byteswap layouts.
+RP_BYTESWAP_LAYOUT(KTX2_Header,
+	RP_BYTESWAP_FIELD(KTX2_Header, vkFormat),
+	RP_BYTESWAP_FIELD(KTX2_Header, typeSize),
+	RP_BYTESWAP_FIELD(KTX2_Header, pixelWidth),
+	RP_BYTESWAP_FIELD(KTX2_Header, pixelHeight),
+	RP_BYTESWAP_FIELD(KTX2_Header, pixelDepth),
+	RP_BYTESWAP_FIELD(KTX2_Header, layerCount),
+	RP_BYTESWAP_FIELD(KTX2_Header, faceCount),
+	RP_BYTESWAP_FIELD(KTX2_Header, levelCount),
+	RP_BYTESWAP_FIELD(KTX2_Header, supercompressionScheme),
+	RP_BYTESWAP_FIELD(KTX2_Header, dfdByteOffset),
+	RP_BYTESWAP_FIELD(KTX2_Header, dfdByteLength),
+	RP_BYTESWAP_FIELD(KTX2_Header, kvdByteOffset),
+	RP_BYTESWAP_FIELD(KTX2_Header, kvdByteLength),
+	RP_BYTESWAP_FIELD(KTX2_Header, sgdByteOffset),
+	RP_BYTESWAP_FIELD(KTX2_Header, sgdByteLength))
+RP_BYTESWAP_LAYOUT(KTX2_Mipmap_Index,
+	RP_BYTESWAP_FIELD(KTX2_Mipmap_Index, byteOffset),
+	RP_BYTESWAP_FIELD(KTX2_Mipmap_Index, byteLength),
+	RP_BYTESWAP_FIELD(KTX2_Mipmap_Index, uncompressedByteLength))
+
 namespace LibRpTexture {
 
 FILEFORMAT_IMPL(KhronosKTX2)
@@ -601,7 +626,7 @@ void KhronosKTX2Private::loadKeyValueData(void)
 		data_row.reserve(2);
 		data_row.emplace_back(string(p, k_end - p));
 		data_row.emplace_back(string(k_end + 1, kv_end - k_end - 2));
-		kv_data.emplace_back(data_row);
+		kv_data.emplace_back(std::move(data_row));
 
 		// Check if this is KTXorientation.
 		// NOTE: Only the first instance is used.
@@ -677,25 +702,8 @@ KhronosKTX2::KhronosKTX2(IRpFile *file)
 		return;
 	}
 
-#if SYS_BYTEORDER == SYS_BIG_ENDIAN
 	// Byteswap the header.
-	d->ktx2Header.vkFormat			= le32_to_cpu(d->ktx2Header.vkFormat);
-	d->ktx2Header.typeSize			= le32_to_cpu(d->ktx2Header.typeSize);
-	d->ktx2Header.pixelWidth		= le32_to_cpu(d->ktx2Header.pixelWidth);
-	d->ktx2Header.pixelHeight		= le32_to_cpu(d->ktx2Header.pixelHeight);
-	d->ktx2Header.pixelDepth		= le32_to_cpu(d->ktx2Header.pixelDepth);
-	d->ktx2Header.layerCount		= le32_to_cpu(d->ktx2Header.layerCount);
-	d->ktx2Header.faceCount			= le32_to_cpu(d->ktx2Header.faceCount);
-	d->ktx2Header.levelCount		= le32_to_cpu(d->ktx2Header.levelCount);
-	d->ktx2Header.supercompressionScheme	= le32_to_cpu(d->ktx2Header.supercompressionScheme);
-
-	d->ktx2Header.dfdByteOffset		= le32_to_cpu(d->ktx2Header.dfdByteOffset);
-	d->ktx2Header.dfdByteLength		= le32_to_cpu(d->ktx2Header.dfdByteLength);
-	d->ktx2Header.kvdByteOffset		= le32_to_cpu(d->ktx2Header.kvdByteOffset);
-	d->ktx2Header.kvdByteLength		= le32_to_cpu(d->ktx2Header.kvdByteLength);
-	d->ktx2Header.sgdByteOffset		= le32_to_cpu(d->ktx2Header.sgdByteOffset);
-	d->ktx2Header.sgdByteLength		= le32_to_cpu(d->ktx2Header.sgdByteLength);
-#endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+	le_struct_to_cpu(d->ktx2Header);
 
 	// Read the mipmap info.
 	int mipmapCount = d->ktx2Header.levelCount;
@@ -712,13 +720,7 @@ KhronosKTX2::KhronosKTX2(IRpFile *file)
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
 	}
-#if SYS_BYTEORDER == SYS_BIG_ENDIAN
-	std::for_each(d->mipmap_data.begin(), d->mipmap_data.end(), [](KTX2_Mipmap_Index &mipdata) {
-		mipdata.byteOffset = le64_to_cpu(mipdata.byteOffset);
-		mipdata.byteLength = le64_to_cpu(mipdata.byteLength);
-		mipdata.uncompressedByteLength = le64_to_cpu(mipdata.uncompressedByteLength);
-	});
-#endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+	le_struct_array_to_cpu(d->mipmap_data.data(), d->mipmap_data.size());
 
 	// Load key/value data.
 	// This function also checks for KTXorientation
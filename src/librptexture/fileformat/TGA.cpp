@@ -23,6 +23,13 @@ using LibRpFile::IRpFile;
 // librptexture
 #include "img/rp_image.hpp"
 #include "decoder/ImageDecoder.hpp"
+#include "decoder/PixelConversion.hpp"
+using namespace LibRpTexture::PixelConversion;
+
+#ifdef RP_IMAGE_ALWAYS_HAS_SSE2
+// SSE2 intrinsics (RLE run filling)
+#  include <emmintrin.h>
+#endif /* RP_IMAGE_ALWAYS_HAS_SSE2 */
 
 // C++ STL classes.
 using std::string;
@@ -70,20 +77,107 @@ class TGAPrivate final : public FileFormatPrivate
 		// Default without orientation metadata is HFlip=false, VFlip=false
 		rp_image::FlipOp flipOp;
 
+		/** RLE pixel readers. (TGA pixels are little-endian) **/
+
+		static inline uint8_t readPx_CI8(const uint8_t *p)
+		{
+			return p[0];
+		}
+
+		static inline uint32_t readPx_RGB555(const uint8_t *p)
+		{
+			return RGB555_to_ARGB32(p[0] | (p[1] << 8));
+		}
+
+		static inline uint32_t readPx_ARGB1555(const uint8_t *p)
+		{
+			return ARGB1555_to_ARGB32(p[0] | (p[1] << 8));
+		}
+
+		static inline uint32_t readPx_IA8(const uint8_t *p)
+		{
+			return IA8_to_ARGB32(p[0] | (p[1] << 8));
+		}
+
+		static inline uint32_t readPx_RGB888(const uint8_t *p)
+		{
+			return 0xFF000000U | p[0] | (p[1] << 8) | (p[2] << 16);
+		}
+
+		static inline uint32_t readPx_xRGB8888(const uint8_t *p)
+		{
+			return 0xFF000000U | p[0] | (p[1] << 8) | (p[2] << 16);
+		}
+
+		static inline uint32_t readPx_ARGB8888(const uint8_t *p)
+		{
+			return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+		}
+
 		/**
-		 * Decompress RLE image data.
-		 * @param pDest Output buffer.
-		 * @param dest_len Size of output buffer.
-		 * @param pSrc Input buffer.
-		 * @param src_len Size of input buffer.
-		 * @param bytespp Bytes per pixel.
-		 * @return 0 on success; non-zero on error.
+		 * Fill a run of pixels.
+		 * @param pDest Destination.
+		 * @param px Pixel value.
+		 * @param count Number of pixels.
 		 */
-		ATTR_ACCESS_SIZE(write_only, 1, 2)
-		ATTR_ACCESS_SIZE(read_only, 3, 4)
-		static int decompressRLE(uint8_t *pDest, size_t dest_len,
-					 const uint8_t *pSrc, size_t s_len,
-					 uint8_t bytespp);
+		static inline void fillRun(uint8_t *pDest, uint8_t px, unsigned int count)
+		{
+			memset(pDest, px, count);
+		}
+
+		/**
+		 * Fill a run of pixels.
+		 * @param pDest Destination.
+		 * @param px Pixel value.
+		 * @param count Number of pixels.
+		 */
+		static inline void fillRun(uint32_t *pDest, uint32_t px, unsigned int count)
+		{
+#ifdef RP_IMAGE_ALWAYS_HAS_SSE2
+			const __m128i xmm_px = _mm_set1_epi32(px);
+			for (; count >= 4; count -= 4, pDest += 4) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), xmm_px);
+			}
+#endif /* RP_IMAGE_ALWAYS_HAS_SSE2 */
+			for (; count > 0; count--) {
+				*pDest++ = px;
+			}
+		}
+
+		/**
+		 * Decode RLE image data directly into an rp_image.
+		 *
+		 * Each run packet's pixel is converted once and then filled;
+		 * raw packets are converted as they're copied. Scanlines are
+		 * written bottom-up if vflip is set, so a separate flip pass
+		 * isn't needed for the default TGA orientation.
+		 *
+		 * TGA 2.0 says RLE packets must not cross scanlines.
+		 * TGA 1.0 allowed this, so we'll allow it for compatibility.
+		 *
+		 * @tparam pixel Destination pixel type. (uint8_t for CI8; uint32_t for ARGB32)
+		 * @tparam bytespp Source bytes per pixel.
+		 * @tparam readPx Pixel reader.
+		 * @param img		[in/out] Destination image. (must be CI8 or ARGB32 as appropriate)
+		 * @param vflip		[in] If true, write scanlines bottom-up.
+		 * @param pSrc		[in] RLE data.
+		 * @param src_len	[in] Size of RLE data.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		template<typename pixel, unsigned int bytespp, pixel (*readPx)(const uint8_t *p)>
+		static int decodeRLE(rp_image *img, bool vflip, const uint8_t *pSrc, size_t src_len);
+
+		/**
+		 * Decode an RLE-compressed TGA image directly into an rp_image.
+		 * @param pSrc		[in] RLE data.
+		 * @param src_len	[in] Size of RLE data.
+		 * @param pal_data	[in] Palette data. (256 entries; colormap images only)
+		 * @param hasAlpha	[in] True if the image has an alpha channel.
+		 * @param vflip		[in] If true, write scanlines bottom-up.
+		 * @return Image, or nullptr on error.
+		 */
+		rp_image *loadTGAImageRLE(const uint8_t *pSrc, size_t src_len,
+					  const uint8_t *pal_data, bool hasAlpha, bool vflip) const;
 
 		/**
 		 * Load the TGA image.
@@ -120,70 +214,293 @@ TGAPrivate::~TGAPrivate()
 }
 
 /**
- * Decompress RLE image data.
- * @param pDest Output buffer.
- * @param dest_len Size of output buffer.
- * @param pSrc Input buffer.
- * @param src_len Size of input buffer.
- * @param bytespp Bytes per pixel.
- * @return 0 on success; non-zero on error.
+ * Decode RLE image data directly into an rp_image.
+ *
+ * Each run packet's pixel is converted once and then filled;
+ * raw packets are converted as they're copied. Scanlines are
+ * written bottom-up if vflip is set, so a separate flip pass
+ * isn't needed for the default TGA orientation.
+ *
+ * TGA 2.0 says RLE packets must not cross scanlines.
+ * TGA 1.0 allowed this, so we'll allow it for compatibility.
+ *
+ * @tparam pixel Destination pixel type. (uint8_t for CI8; uint32_t for ARGB32)
+ * @tparam bytespp Source bytes per pixel.
+ * @tparam readPx Pixel reader.
+ * @param img		[in/out] Destination image. (must be CI8 or ARGB32 as appropriate)
+ * @param vflip		[in] If true, write scanlines bottom-up.
+ * @param pSrc		[in] RLE data.
+ * @param src_len	[in] Size of RLE data.
+ * @return 0 on success; negative POSIX error code on error.
  */
-int TGAPrivate::decompressRLE(uint8_t *pDest, size_t dest_len,
-			      const uint8_t *pSrc, size_t src_len,
-			      uint8_t bytespp)
+template<typename pixel, unsigned int bytespp, pixel (*readPx)(const uint8_t *p)>
+int TGAPrivate::decodeRLE(rp_image *img, bool vflip, const uint8_t *pSrc, size_t src_len)
 {
-	// TGA 2.0 says RLE packets must not cross scanlines.
-	// TGA 1.0 allowed this, so we'll allow it for compatibility.
-	// TODO: Make bytespp a template parameter?
-
-	// Process RLE packets until we run out of source data or
-	// space in the destination buffer.
 	const uint8_t *const pSrcEnd = pSrc + src_len;
-	uint8_t *const pDestEnd = pDest + dest_len;
+	const unsigned int width = static_cast<unsigned int>(img->width());
+	const int height = img->height();
+
+	// Current packet.
+	unsigned int count = 0;	// Pixels remaining in the current packet
+	bool isRun = false;	// True if this is an RLE packet.
+	pixel runPx = 0;	// Pixel value for RLE packets.
+
+	for (int y = 0; y < height; y++) {
+		pixel *pDest = static_cast<pixel*>(img->scanLine(vflip ? (height - 1 - y) : y));
+		unsigned int x = width;
+		while (x > 0) {
+			if (count == 0) {
+				// Check the next packet.
+				if (pSrc >= pSrcEnd) {
+					// Out of data.
+					break;
+				}
+				const uint8_t pkt = *pSrc++;
+				// Low 7 bits indicate number of pixels.
+				// [0,127]; add 1 for [1,128].
+				count = (pkt & 0x7F) + 1;
+				isRun = !!(pkt & 0x80);
+				if (isRun) {
+					// High bit is set. This is an RLE packet.
+					// One pixel is duplicated `count` number of times.
+					if (pSrc + bytespp > pSrcEnd) {
+						// Out of data.
+						count = 0;
+						break;
+					}
+					runPx = readPx(pSrc);
+					pSrc += bytespp;
+				}
+			}
+
+			unsigned int n = (count < x ? count : x);
+			if (isRun) {
+				fillRun(pDest, runPx, n);
+			} else {
+				// High bit is clear. This is a raw packet.
+				// `count` number of pixels follow.
+				const unsigned int avail = static_cast<unsigned int>((pSrcEnd - pSrc) / bytespp);
+				if (n > avail) {
+					// Not enough data for the full packet.
+					n = avail;
+					count = n;
+					if (n == 0)
+						break;
+				}
+				for (unsigned int i = 0; i < n; i++, pSrc += bytespp) {
+					pDest[i] = readPx(pSrc);
+				}
+			}
+			pDest += n;
+			x -= n;
+			count -= n;
+		}
 
-	for (; pSrc < pSrcEnd && pDest < pDestEnd; ) {
-		// Check the next packet.
-		const uint8_t pkt = *pSrc++;
-		// Low 7 bits indicate number of pixels.
-		// [0,127]; add 1 for [1,128].
-		unsigned int count = (pkt & 0x7F) + 1;
-		if (pDest + (count * bytespp) > pDestEnd) {
-			// Buffer overflow!
-			return -EIO;
+		if (x > 0) {
+			// Out of data. Clear the rest of the image.
+			memset(pDest, 0, x * sizeof(pixel));
+			for (y++; y < height; y++) {
+				pDest = static_cast<pixel*>(img->scanLine(vflip ? (height - 1 - y) : y));
+				memset(pDest, 0, width * sizeof(pixel));
+			}
+			return 0;
 		}
+	}
 
-		if (pkt & 0x80) {
-			// High bit is set. This is an RLE packet.
-			// One pixel is duplicated `count` number of times.
+	// If a packet extends past the end of the image,
+	// the RLE data is invalid.
+	return (count == 0 ? 0 : -EIO);
+}
 
-			// Based on Duff's Device.
-			for (; count > 0; count--) {
-				const uint8_t *pSrcTmp = pSrc;
-				switch (bytespp) {
-					case 4:		*pDest++ = *pSrcTmp++;	// fall-through
-					case 3:		*pDest++ = *pSrcTmp++;	// fall-through
-					case 2:		*pDest++ = *pSrcTmp++;	// fall-through
-					case 1:		*pDest++ = *pSrcTmp++;	// fall-through
-					default:	break;
+/**
+ * Decode an RLE-compressed TGA image directly into an rp_image.
+ * @param pSrc		[in] RLE data.
+ * @param src_len	[in] Size of RLE data.
+ * @param pal_data	[in] Palette data. (256 entries; colormap images only)
+ * @param hasAlpha	[in] True if the image has an alpha channel.
+ * @param vflip		[in] If true, write scanlines bottom-up.
+ * @return Image, or nullptr on error.
+ */
+rp_image *TGAPrivate::loadTGAImageRLE(const uint8_t *pSrc, size_t src_len,
+				      const uint8_t *pal_data, bool hasAlpha, bool vflip) const
+{
+	const int width = tgaHeader.img.width;
+	const int height = tgaHeader.img.height;
+	rp_image *img = nullptr;
+	int ret = -EINVAL;
+
+	switch (tgaHeader.image_type & ~TGA_IMAGETYPE_RLE_FLAG) {
+		case TGA_IMAGETYPE_COLORMAP: {
+			// Palette
+			// TODO: attr_dir number of bits for alpha?
+			if (tgaHeader.img.bpp != 8 || !pal_data)
+				break;
+
+			img = new rp_image(width, height, rp_image::Format::CI8);
+			if (!img->isValid() || img->palette_len() < 256)
+				break;
+
+			// Convert the palette.
+			uint32_t *const palette = img->palette();
+			int tr_idx = -1;
+			const uint8_t *p = pal_data;
+			switch (tgaHeader.cmap.bpp) {
+				case 15:
+					for (unsigned int i = 0; i < 256; i++, p += 2) {
+						palette[i] = readPx_RGB555(p);
+					}
+					break;
+				case 16:
+					for (unsigned int i = 0; i < 256; i++, p += 2) {
+						palette[i] = (hasAlpha ? readPx_ARGB1555(p) : readPx_RGB555(p));
+					}
+					break;
+				case 24:
+					for (unsigned int i = 0; i < 256; i++, p += 3) {
+						palette[i] = readPx_RGB888(p);
+					}
+					break;
+				case 32:
+					for (unsigned int i = 0; i < 256; i++, p += 4) {
+						palette[i] = (hasAlpha ? readPx_ARGB8888(p) : readPx_xRGB8888(p));
+					}
+					break;
+				default:
+					assert(!"Unsupported TGA color map format.");
+					img->unref();
+					return nullptr;
+			}
+			if (hasAlpha) {
+				for (unsigned int i = 0; i < 256; i++) {
+					if ((palette[i] >> 24) == 0) {
+						// Found the transparent color.
+						tr_idx = static_cast<int>(i);
+						break;
+					}
 				}
 			}
-			pSrc += bytespp;
-		} else {
-			// High bit is clear. This is a raw packet.
-			// `count` number of pixels follow.
-			const unsigned int cpysize = count * bytespp;
-			memcpy(pDest, pSrc, cpysize);
-			pDest += cpysize;
-			pSrc += cpysize;
+			img->set_tr_idx(tr_idx);
+
+			// Set the sBIT metadata.
+			static const rp_image::sBIT_t sBIT_15 = {5,5,5,0,0};
+			static const rp_image::sBIT_t sBIT_16 = {5,5,5,0,1};
+			static const rp_image::sBIT_t sBIT_24 = {8,8,8,0,0};
+			static const rp_image::sBIT_t sBIT_32 = {8,8,8,0,8};
+			if (tgaHeader.cmap.bpp <= 16) {
+				img->set_sBIT(hasAlpha && tgaHeader.cmap.bpp == 16 ? &sBIT_16 : &sBIT_15);
+			} else {
+				img->set_sBIT(hasAlpha && tgaHeader.cmap.bpp == 32 ? &sBIT_32 : &sBIT_24);
+			}
+
+			ret = decodeRLE<uint8_t, 1, readPx_CI8>(img, vflip, pSrc, src_len);
+			break;
 		}
+
+		case TGA_IMAGETYPE_TRUECOLOR: {
+			// Truecolor
+			// TODO: attr_dir number of bits for alpha?
+			img = new rp_image(width, height, rp_image::Format::ARGB32);
+			if (!img->isValid())
+				break;
+
+			static const rp_image::sBIT_t sBIT_RGB555 = {5,5,5,0,0};
+			static const rp_image::sBIT_t sBIT_ARGB1555 = {5,5,5,0,1};
+			static const rp_image::sBIT_t sBIT_x32 = {8,8,8,0,0};
+			static const rp_image::sBIT_t sBIT_A32 = {8,8,8,0,8};
+			switch (tgaHeader.img.bpp) {
+				case 15:
+				case 16:
+					// RGB555/ARGB1555
+					if (hasAlpha) {
+						img->set_sBIT(&sBIT_ARGB1555);
+						ret = decodeRLE<uint32_t, 2, readPx_ARGB1555>(img, vflip, pSrc, src_len);
+					} else {
+						img->set_sBIT(&sBIT_RGB555);
+						ret = decodeRLE<uint32_t, 2, readPx_RGB555>(img, vflip, pSrc, src_len);
+					}
+					break;
+
+				case 24:
+					// RGB888
+					img->set_sBIT(&sBIT_x32);
+					ret = decodeRLE<uint32_t, 3, readPx_RGB888>(img, vflip, pSrc, src_len);
+					break;
+
+				case 32:
+					// xRGB8888/ARGB8888
+					// TODO: Verify alpha channel depth.
+					if (hasAlpha) {
+						img->set_sBIT(&sBIT_A32);
+						ret = decodeRLE<uint32_t, 4, readPx_ARGB8888>(img, vflip, pSrc, src_len);
+					} else {
+						img->set_sBIT(&sBIT_x32);
+						ret = decodeRLE<uint32_t, 4, readPx_xRGB8888>(img, vflip, pSrc, src_len);
+					}
+					break;
+
+				default:
+					break;
+			}
+			break;
+		}
+
+		case TGA_IMAGETYPE_GRAYSCALE:
+			// Grayscale
+			switch (tgaHeader.img.bpp) {
+				case 8: {
+					assert(!hasAlpha);
+					if (hasAlpha)
+						break;
+
+					img = new rp_image(width, height, rp_image::Format::CI8);
+					if (!img->isValid() || img->palette_len() < 256)
+						break;
+
+					// Create a grayscale palette.
+					uint32_t *const palette = img->palette();
+					uint32_t gray = 0xFF000000U;
+					for (unsigned int i = 0; i < 256; i++, gray += 0x010101U) {
+						palette[i] = gray;
+					}
+					static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+					img->set_sBIT(&sBIT);
+
+					ret = decodeRLE<uint8_t, 1, readPx_CI8>(img, vflip, pSrc, src_len);
+					break;
+				}
+
+				case 16: {
+					assert(hasAlpha);
+					assert((tgaHeader.img.attr_dir & 0x0F) == 8);
+					if (!hasAlpha || (tgaHeader.img.attr_dir & 0x0F) != 8)
+						break;
+
+					img = new rp_image(width, height, rp_image::Format::ARGB32);
+					if (!img->isValid())
+						break;
+
+					static const rp_image::sBIT_t sBIT = {8,8,8,8,8};
+					img->set_sBIT(&sBIT);
+					ret = decodeRLE<uint32_t, 2, readPx_IA8>(img, vflip, pSrc, src_len);
+					break;
+				}
+
+				default:
+					break;
+			}
+			break;
+
+		default:
+			assert(!"Unsupported TGA format.");
+			break;
 	}
 
-	// In case we didn't have enough data, clear the rest of
-	// the destination buffer.
-	if (pDest < pDestEnd) {
-		memset(pDest, 0, pDestEnd - pDest);
+	if (ret != 0) {
+		// Error decoding the RLE image.
+		UNREF(img);
+		return nullptr;
 	}
-	return 0;
+	return img;
 }
 
 /**
@@ -261,11 +578,10 @@ const rp_image *TGAPrivate::loadTGAImage(void)
 		}
 	}
 
-	// Allocate a buffer for the image.
-	// NOTE: Assuming scanlines are not padded. (pitch == width)
-	const unsigned int bytespp = (tgaHeader.img.bpp == 15 ? 2 : (tgaHeader.img.bpp / 8));
-	const int img_size = tgaHeader.img.width * tgaHeader.img.height * bytespp;
-	auto img_data = aligned_uptr<uint8_t>(16, img_size);
+	// TODO: attr_dir number of bits for alpha?
+	// TODO: Handle premultiplied alpha.
+	const bool hasAlpha = (alphaType >= TGA_ALPHATYPE_PRESENT) &&
+			      ((tgaHeader.img.attr_dir & 0x0F) > 0);
 
 	if (tgaHeader.image_type == TGA_IMAGETYPE_HUFFMAN_COLORMAP) {
 		// TODO: Huffman+Delta compression.
@@ -291,26 +607,34 @@ const rp_image *TGAPrivate::loadTGAImage(void)
 			return nullptr;
 		}
 
-		// Decompress the RLE image.
-		int ret = decompressRLE(img_data.get(), img_size, rle_data.get(), rle_size, bytespp);
-		if (ret != 0) {
-			// Error decompressing the RLE image.
-			return nullptr;
-		}
-	} else {
-		// Image is not compressed. Read it directly.
-		size_t size = file->read(img_data.get(), img_size);
-		if (size != static_cast<size_t>(img_size)) {
-			// Read error.
-			return nullptr;
+		// Decode the RLE image directly into an rp_image.
+		// The vertical flip is handled by the decoder.
+		rp_image *imgtmp = loadTGAImageRLE(rle_data.get(), rle_size,
+			pal_data.get(), hasAlpha, (flipOp & rp_image::FLIP_V));
+		if (imgtmp && (flipOp & rp_image::FLIP_H)) {
+			rp_image *const flipimg = imgtmp->flip(rp_image::FLIP_H);
+			if (flipimg) {
+				imgtmp->unref();
+				imgtmp = flipimg;
+			}
 		}
+
+		img = imgtmp;
+		return img;
+	}
+
+	// Image is not compressed. Read it directly.
+	// NOTE: Assuming scanlines are not padded. (pitch == width)
+	const unsigned int bytespp = (tgaHeader.img.bpp == 15 ? 2 : (tgaHeader.img.bpp / 8));
+	const int img_size = tgaHeader.img.width * tgaHeader.img.height * bytespp;
+	auto img_data = aligned_uptr<uint8_t>(16, img_size);
+	size_t size = file->read(img_data.get(), img_size);
+	if (size != static_cast<size_t>(img_size)) {
+		// Read error.
+		return nullptr;
 	}
 
 	// Decode the image.
-	// TODO: attr_dir number of bits for alpha?
-	// TODO: Handle premultiplied alpha.
-	const bool hasAlpha = (alphaType >= TGA_ALPHATYPE_PRESENT) &&
-			      ((tgaHeader.img.attr_dir & 0x0F) > 0);
 	rp_image *imgtmp = nullptr;
 	switch (tgaHeader.image_type & ~TGA_IMAGETYPE_RLE_FLAG) {
 		case TGA_IMAGETYPE_COLORMAP:
@@ -17,6 +17,9 @@
 
 #include "vtf_structs.h"
 
+// librpcpu
+#include "librpcpu/byteswap_struct.hpp"
+
 // librpbase, librpfile
 #include "libi18n/i18n.h"
 using LibRpBase::rp_sprintf;
@@ -31,6 +34,23 @@ using LibRpFile::IRpFile;
 using std::string;
 using std::vector;
 
+// VTF header byteswap layout.
+// NOTE: Signature is *not* byteswapped.
+RP_BYTESWAP_LAYOUT(VTFHEADER,
+	RP_BYTESWAP_FIELD(VTFHEADER, version),
+	RP_BYTESWAP_FIELD(VTFHEADER, headerSize),
+	RP_BYTESWAP_FIELD(VTFHEADER, width),
+	RP_BYTESWAP_FIELD(VTFHEADER, height),
+	RP_BYTESWAP_FIELD(VTFHEADER, flags),
+	RP_BYTESWAP_FIELD(VTFHEADER, frames),
+	RP_BYTESWAP_FIELD(VTFHEADER, firstFrame),
+	RP_BYTESWAP_FIELD(VTFHEADER, reflectivity),
+	RP_BYTESWAP_FIELD(VTFHEADER, bumpmapScale),
+	RP_BYTESWAP_FIELD(VTFHEADER, highResImageFormat),
+	RP_BYTESWAP_FIELD(VTFHEADER, lowResImageFormat),
+	RP_BYTESWAP_FIELD(VTFHEADER, depth),
+	RP_BYTESWAP_FIELD(VTFHEADER, numResources))
+
 namespace LibRpTexture {
 
 FILEFORMAT_IMPL(ValveVTF)
@@ -67,6 +87,9 @@ class ValveVTFPrivate final : public FileFormatPrivate
 		};
 		vector<mipmap_data_t> mipmap_data;
 
+		// Decoded low-resolution image.
+		rp_image *lowResImage;
+
 		// Invalid pixel format message.
 		char invalid_pixel_format[24];
 
@@ -97,6 +120,20 @@ class ValveVTFPrivate final : public FileFormatPrivate
 		 */
 		int getMipmapInfo(void);
 
+		/**
+		 * Decode a VTF image.
+		 * @param format VTF image format.
+		 * @param width Image width.
+		 * @param height Image height.
+		 * @param row_width Row width, in pixels. (must be a power of 2)
+		 * @param buf Image data.
+		 * @param size Size of the image data, in bytes.
+		 * @return Image, or nullptr on error.
+		 */
+		static rp_image *decodeImage(VTF_IMAGE_FORMAT format,
+			int width, int height, int row_width,
+			const uint8_t *buf, unsigned int size);
+
 		/**
 		 * Load the image.
 		 * @param mip Mipmap number. (0 == full image)
@@ -104,23 +141,12 @@ class ValveVTFPrivate final : public FileFormatPrivate
 		 */
 		const rp_image *loadImage(int mip);
 
-#if SYS_BYTEORDER == SYS_BIG_ENDIAN
 		/**
-		 * Byteswap a float. (TODO: Move to byteswap_rp.h?)
-		 * @param f Float to byteswap.
-		 * @return Byteswapped flaot.
+		 * Load the low-resolution image.
+		 * This is usually a 16x16 DXT1 image stored before the mipmaps.
+		 * @return Image, or nullptr on error.
 		 */
-		static inline float __swabf(float f)
-		{
-			union {
-				uint32_t u32;
-				float f;
-			} u32_f;
-			u32_f.f = f;
-			u32_f.u32 = __swab32(u32_f.u32);
-			return u32_f.f;
-		}
-#endif
+		const rp_image *loadLowResImage(void);
 };
 
 /** ValveVTFPrivate **/
@@ -163,6 +189,7 @@ static_assert(ARRAY_SIZE(ValveVTFPrivate::img_format_tbl)-1 == VTF_IMAGE_FORMAT_
 ValveVTFPrivate::ValveVTFPrivate(ValveVTF *q, IRpFile *file)
 	: super(q, file)
 	, texDataStartAddr(0)
+	, lowResImage(nullptr)
 {
 	// Clear the structs and arrays.
 	memset(&vtfHeader, 0, sizeof(vtfHeader));
@@ -172,6 +199,7 @@ ValveVTFPrivate::ValveVTFPrivate(ValveVTF *q, IRpFile *file)
 ValveVTFPrivate::~ValveVTFPrivate()
 {
 	std::for_each(mipmaps.begin(), mipmaps.end(), [](rp_image *img) { UNREF(img); });
+	UNREF(lowResImage);
 }
 
 /**
@@ -418,165 +446,96 @@ int ValveVTFPrivate::getMipmapInfo(void)
 }
 
 /**
- * Load the image.
- * @param mip Mipmap number. (0 == full image)
+ * Decode a VTF image.
+ * @param format VTF image format.
+ * @param width Image width.
+ * @param height Image height.
+ * @param row_width Row width, in pixels. (must be a power of 2)
+ * @param buf Image data.
+ * @param size Size of the image data, in bytes.
  * @return Image, or nullptr on error.
  */
-const rp_image *ValveVTFPrivate::loadImage(int mip)
+rp_image *ValveVTFPrivate::decodeImage(VTF_IMAGE_FORMAT format,
+	int width, int height, int row_width,
+	const uint8_t *buf, unsigned int size)
 {
-	// TODO: Option to load the low-res image instead?
-	int mipmapCount = vtfHeader.mipmapCount;
-	if (mipmapCount <= 0) {
-		// No mipmaps == one image.
-		mipmapCount = 1;
-	}
-
-	assert(mip >= 0);
-	assert(mip < mipmapCount);
-	if (mip < 0 || mip >= mipmapCount) {
-		// Invalid mipmap number.
-		return nullptr;
-	}
-
-	if (!mipmaps.empty() && mipmaps[mip] != nullptr) {
-		// Image has already been loaded.
-		return mipmaps[mip];
-	} else if (!this->file || !this->isValid) {
-		// Can't load the image.
-		return nullptr;
-	}
-
-	// Sanity check: Maximum image dimensions of 32768x32768.
-	// NOTE: `height == 0` is allowed here. (1D texture)
-	assert(vtfHeader.width > 0);
-	assert(vtfHeader.width <= 32768);
-	assert(vtfHeader.height <= 32768);
-	if (vtfHeader.width == 0 || vtfHeader.width > 32768 ||
-	    vtfHeader.height > 32768)
-	{
-		// Invalid image dimensions.
-		return nullptr;
-	}
-
-	if (file->size() > 128*1024*1024) {
-		// Sanity check: VTF files shouldn't be more than 128 MB.
-		return nullptr;
-	}
-	const uint32_t file_sz = static_cast<uint32_t>(file->size());
-
-	// Make sure we have the mipmap info.
-	int ret = getMipmapInfo();
-	assert(ret == 0);
-	assert(!mipmap_data.empty());
-	if (ret != 0 || mipmap_data.empty()) {
-		// Error getting the mipmap info.
-		return nullptr;
-	}
-	const auto &mdata = mipmap_data[mip];
-
-	// TODO: Handle environment maps (6-faced cube map) and volumetric textures.
-
-	// Verify file size.
-	if (mdata.addr + mdata.size > file_sz) {
-		// File is too small.
-		return nullptr;
-	}
-
-	// Texture cannot start inside of the VTF header.
-	assert(mdata.addr >= sizeof(vtfHeader));
-	if (mdata.addr < sizeof(vtfHeader)) {
-		// Invalid texture data start address.
-		return nullptr;
-	}
-
-	// Read the texture data.
-	auto buf = aligned_uptr<uint8_t>(16, mdata.size);
-	size_t size = file->seekAndRead(mdata.addr, buf.get(), mdata.size);
-	if (size != mdata.size) {
-		// Read error.
-		return nullptr;
-	}
-
-	// FIXME: Smaller mipmaps have read errors if encoded with e.g. DXTn,
-	// since the width is smaller than 4.
-
 	// Decode the image.
 	// NOTE: VTF channel ordering does NOT match ImageDecoder channel ordering.
 	// (The channels appear to be backwards.)
 	// TODO: Lookup table to convert to PXF constants?
 	// TODO: Verify on big-endian?
 	rp_image *img = nullptr;
-	switch (vtfHeader.highResImageFormat) {
+	switch (format) {
 		/* 32-bit */
 		case VTF_IMAGE_FORMAT_RGBA8888:
 		case VTF_IMAGE_FORMAT_UVWQ8888:	// handling as RGBA8888
 		case VTF_IMAGE_FORMAT_UVLX8888:	// handling as RGBA8888
 			img = ImageDecoder::fromLinear32(
 				ImageDecoder::PixelFormat::ABGR8888,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint32_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint32_t));
+				width, height,
+				reinterpret_cast<const uint32_t*>(buf), size,
+				row_width * sizeof(uint32_t));
 			break;
 		case VTF_IMAGE_FORMAT_ABGR8888:
 			img = ImageDecoder::fromLinear32(
 				ImageDecoder::PixelFormat::RGBA8888,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint32_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint32_t));
+				width, height,
+				reinterpret_cast<const uint32_t*>(buf), size,
+				row_width * sizeof(uint32_t));
 			break;
 		case VTF_IMAGE_FORMAT_ARGB8888:
 			// This is stored as RAGB for some reason...
 			// FIXME: May be a bug in VTFEdit. (Tested versions: 1.2.5, 1.3.3)
 			img = ImageDecoder::fromLinear32(
 				ImageDecoder::PixelFormat::RABG8888,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint32_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint32_t));
+				width, height,
+				reinterpret_cast<const uint32_t*>(buf), size,
+				row_width * sizeof(uint32_t));
 			break;
 		case VTF_IMAGE_FORMAT_BGRA8888:
 			img = ImageDecoder::fromLinear32(
 				ImageDecoder::PixelFormat::ARGB8888,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint32_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint32_t));
+				width, height,
+				reinterpret_cast<const uint32_t*>(buf), size,
+				row_width * sizeof(uint32_t));
 			break;
 		case VTF_IMAGE_FORMAT_BGRx8888:
 			img = ImageDecoder::fromLinear32(
 				ImageDecoder::PixelFormat::xRGB8888,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint32_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint32_t));
+				width, height,
+				reinterpret_cast<const uint32_t*>(buf), size,
+				row_width * sizeof(uint32_t));
 			break;
 
 		/* 24-bit */
 		case VTF_IMAGE_FORMAT_RGB888:
 			img = ImageDecoder::fromLinear24(
 				ImageDecoder::PixelFormat::BGR888,
-				mdata.width, mdata.height,
-				buf.get(), mdata.size,
-				mdata.row_width * 3);
+				width, height,
+				buf, size,
+				row_width * 3);
 			break;
 		case VTF_IMAGE_FORMAT_BGR888:
 			img = ImageDecoder::fromLinear24(
 				ImageDecoder::PixelFormat::RGB888,
-				mdata.width, mdata.height,
-				buf.get(), mdata.size,
-				mdata.row_width * 3);
+				width, height,
+				buf, size,
+				row_width * 3);
 			break;
 		case VTF_IMAGE_FORMAT_RGB888_BLUESCREEN:
 			img = ImageDecoder::fromLinear24(
 				ImageDecoder::PixelFormat::BGR888,
-				mdata.width, mdata.height,
-				buf.get(), mdata.size,
-				mdata.row_width * 3);
+				width, height,
+				buf, size,
+				row_width * 3);
 			img->apply_chroma_key(0xFF0000FF);
 			break;
 		case VTF_IMAGE_FORMAT_BGR888_BLUESCREEN:
 			img = ImageDecoder::fromLinear24(
 				ImageDecoder::PixelFormat::RGB888,
-				mdata.width, mdata.height,
-				buf.get(), mdata.size,
-				mdata.row_width * 3);
+				width, height,
+				buf, size,
+				row_width * 3);
 			img->apply_chroma_key(0xFF0000FF);
 			break;
 
@@ -584,37 +543,37 @@ const rp_image *ValveVTFPrivate::loadImage(int mip)
 		case VTF_IMAGE_FORMAT_RGB565:
 			img = ImageDecoder::fromLinear16(
 				ImageDecoder::PixelFormat::BGR565,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint16_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint16_t));
+				width, height,
+				reinterpret_cast<const uint16_t*>(buf), size,
+				row_width * sizeof(uint16_t));
 			break;
 		case VTF_IMAGE_FORMAT_BGR565:
 			img = ImageDecoder::fromLinear16(
 				ImageDecoder::PixelFormat::RGB565,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint16_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint16_t));
+				width, height,
+				reinterpret_cast<const uint16_t*>(buf), size,
+				row_width * sizeof(uint16_t));
 			break;
 		case VTF_IMAGE_FORMAT_BGRx5551:
 			img = ImageDecoder::fromLinear16(
 				ImageDecoder::PixelFormat::RGB555,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint16_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint16_t));
+				width, height,
+				reinterpret_cast<const uint16_t*>(buf), size,
+				row_width * sizeof(uint16_t));
 			break;
 		case VTF_IMAGE_FORMAT_BGRA4444:
 			img = ImageDecoder::fromLinear16(
 				ImageDecoder::PixelFormat::ARGB4444,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint16_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint16_t));
+				width, height,
+				reinterpret_cast<const uint16_t*>(buf), size,
+				row_width * sizeof(uint16_t));
 			break;
 		case VTF_IMAGE_FORMAT_BGRA5551:
 			img = ImageDecoder::fromLinear16(
 				ImageDecoder::PixelFormat::ARGB1555,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint16_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint16_t));
+				width, height,
+				reinterpret_cast<const uint16_t*>(buf), size,
+				row_width * sizeof(uint16_t));
 			break;
 		case VTF_IMAGE_FORMAT_IA88:
 			// FIXME: I8 might have the alpha channel set to the I channel,
@@ -625,17 +584,17 @@ const rp_image *ValveVTFPrivate::loadImage(int mip)
 			// TODO: Add ImageDecoder::fromLinear16() support for IA8 later.
 			img = ImageDecoder::fromLinear16(
 				ImageDecoder::PixelFormat::A8L8,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint16_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint16_t));
+				width, height,
+				reinterpret_cast<const uint16_t*>(buf), size,
+				row_width * sizeof(uint16_t));
 			break;
 		case VTF_IMAGE_FORMAT_UV88:
 			// We're handling this as a GR88 texture.
 			img = ImageDecoder::fromLinear16(
 				ImageDecoder::PixelFormat::GR88,
-				mdata.width, mdata.height,
-				reinterpret_cast<const uint16_t*>(buf.get()), mdata.size,
-				mdata.row_width * sizeof(uint16_t));
+				width, height,
+				reinterpret_cast<const uint16_t*>(buf), size,
+				row_width * sizeof(uint16_t));
 			break;
 
 		/* 8-bit */
@@ -645,38 +604,38 @@ const rp_image *ValveVTFPrivate::loadImage(int mip)
 			// https://www.opengl.org/discussion_boards/showthread.php/151701-GL_LUMINANCE-vs-GL_INTENSITY
 			img = ImageDecoder::fromLinear8(
 				ImageDecoder::PixelFormat::L8,
-				mdata.width, mdata.height,
-				buf.get(), mdata.size,
-				mdata.row_width);
+				width, height,
+				buf, size,
+				row_width);
 			break;
 		case VTF_IMAGE_FORMAT_A8:
 			img = ImageDecoder::fromLinear8(
 				ImageDecoder::PixelFormat::A8,
-				mdata.width, mdata.height,
-				buf.get(), mdata.size,
-				mdata.row_width);
+				width, height,
+				buf, size,
+				row_width);
 			break;
 
 		/* Compressed */
 		case VTF_IMAGE_FORMAT_DXT1:
 			img = ImageDecoder::fromDXT1(
-				mdata.width, mdata.height,
-				buf.get(), mdata.size);
+				width, height,
+				buf, size);
 			break;
 		case VTF_IMAGE_FORMAT_DXT1_ONEBITALPHA:
 			img = ImageDecoder::fromDXT1_A1(
-				mdata.width, mdata.height,
-				buf.get(), mdata.size);
+				width, height,
+				buf, size);
 			break;
 		case VTF_IMAGE_FORMAT_DXT3:
 			img = ImageDecoder::fromDXT3(
-				mdata.width, mdata.height,
-				buf.get(), mdata.size);
+				width, height,
+				buf, size);
 			break;
 		case VTF_IMAGE_FORMAT_DXT5:
 			img = ImageDecoder::fromDXT5(
-				mdata.width, mdata.height,
-				buf.get(), mdata.size);
+				width, height,
+				buf, size);
 			break;
 
 		case VTF_IMAGE_FORMAT_P8:
@@ -687,10 +646,152 @@ const rp_image *ValveVTFPrivate::loadImage(int mip)
 			break;
 	}
 
+	return img;
+}
+
+/**
+ * Load the image.
+ * @param mip Mipmap number. (0 == full image)
+ * @return Image, or nullptr on error.
+ */
+const rp_image *ValveVTFPrivate::loadImage(int mip)
+{
+	int mipmapCount = vtfHeader.mipmapCount;
+	if (mipmapCount <= 0) {
+		// No mipmaps == one image.
+		mipmapCount = 1;
+	}
+
+	assert(mip >= 0);
+	assert(mip < mipmapCount);
+	if (mip < 0 || mip >= mipmapCount) {
+		// Invalid mipmap number.
+		return nullptr;
+	}
+
+	if (!mipmaps.empty() && mipmaps[mip] != nullptr) {
+		// Image has already been loaded.
+		return mipmaps[mip];
+	} else if (!this->file || !this->isValid) {
+		// Can't load the image.
+		return nullptr;
+	}
+
+	// Sanity check: Maximum image dimensions of 32768x32768.
+	// NOTE: `height == 0` is allowed here. (1D texture)
+	assert(vtfHeader.width > 0);
+	assert(vtfHeader.width <= 32768);
+	assert(vtfHeader.height <= 32768);
+	if (vtfHeader.width == 0 || vtfHeader.width > 32768 ||
+	    vtfHeader.height > 32768)
+	{
+		// Invalid image dimensions.
+		return nullptr;
+	}
+
+	if (file->size() > 128*1024*1024) {
+		// Sanity check: VTF files shouldn't be more than 128 MB.
+		return nullptr;
+	}
+	const uint32_t file_sz = static_cast<uint32_t>(file->size());
+
+	// Make sure we have the mipmap info.
+	int ret = getMipmapInfo();
+	assert(ret == 0);
+	assert(!mipmap_data.empty());
+	if (ret != 0 || mipmap_data.empty()) {
+		// Error getting the mipmap info.
+		return nullptr;
+	}
+	const auto &mdata = mipmap_data[mip];
+
+	// TODO: Handle environment maps (6-faced cube map) and volumetric textures.
+
+	// Verify file size.
+	if (mdata.addr + mdata.size > file_sz) {
+		// File is too small.
+		return nullptr;
+	}
+
+	// Texture cannot start inside of the VTF header.
+	assert(mdata.addr >= sizeof(vtfHeader));
+	if (mdata.addr < sizeof(vtfHeader)) {
+		// Invalid texture data start address.
+		return nullptr;
+	}
+
+	// Read the texture data.
+	auto buf = aligned_uptr<uint8_t>(16, mdata.size);
+	size_t size = file->seekAndRead(mdata.addr, buf.get(), mdata.size);
+	if (size != mdata.size) {
+		// Read error.
+		return nullptr;
+	}
+
+	// FIXME: Smaller mipmaps have read errors if encoded with e.g. DXTn,
+	// since the width is smaller than 4.
+
+	// Decode the image.
+	rp_image *const img = decodeImage(
+		static_cast<VTF_IMAGE_FORMAT>(vtfHeader.highResImageFormat),
+		mdata.width, mdata.height, mdata.row_width,
+		buf.get(), mdata.size);
 	mipmaps[mip] = img;
 	return img;
 }
 
+/**
+ * Load the low-resolution image.
+ * This is usually a 16x16 DXT1 image stored before the mipmaps.
+ * @return Image, or nullptr on error.
+ */
+const rp_image *ValveVTFPrivate::loadLowResImage(void)
+{
+	if (lowResImage) {
+		// Image has already been loaded.
+		return lowResImage;
+	} else if (!this->file || !this->isValid) {
+		// Can't load the image.
+		return nullptr;
+	}
+
+	if (vtfHeader.lowResImageFormat < 0 ||
+	    vtfHeader.lowResImageFormat >= VTF_IMAGE_FORMAT_MAX ||
+	    vtfHeader.lowResImageWidth == 0)
+	{
+		// No low-resolution image.
+		return nullptr;
+	}
+	const VTF_IMAGE_FORMAT format = static_cast<VTF_IMAGE_FORMAT>(vtfHeader.lowResImageFormat);
+	const int width = vtfHeader.lowResImageWidth;
+	const int height = (vtfHeader.lowResImageHeight > 0 ? vtfHeader.lowResImageHeight : 1);
+
+	// NOTE: The low-resolution image is stored immediately
+	// after the header, before the mipmaps.
+	int row_width = width;
+	if (!isPow2(row_width)) {
+		row_width = 1 << (uilog2(row_width) + 1);
+	}
+	const unsigned int size = calcImageSize(format, row_width, height);
+	if (size == 0 || texDataStartAddr < sizeof(vtfHeader) ||
+	    static_cast<off64_t>(texDataStartAddr) + size > file->size())
+	{
+		// Invalid image size or address.
+		return nullptr;
+	}
+
+	// Read the texture data.
+	auto buf = aligned_uptr<uint8_t>(16, size);
+	size_t sz_read = file->seekAndRead(texDataStartAddr, buf.get(), size);
+	if (sz_read != size) {
+		// Read error.
+		return nullptr;
+	}
+
+	lowResImage = decodeImage(format, width, height, row_width, buf.get(), size);
+	return lowResImage;
+}
+
 /** ValveVTF **/
 
 /**
@@ -735,27 +836,9 @@ ValveVTF::ValveVTF(IRpFile *file)
 	// File is valid.
 	d->isValid = true;
 
-#if SYS_BYTEORDER == SYS_BIG_ENDIAN
 	// Header is stored in little-endian, so it always
 	// needs to be byteswapped on big-endian.
-	// NOTE: Signature is *not* byteswapped.
-	d->vtfHeader.version[0]		= le32_to_cpu(d->vtfHeader.version[0]);
-	d->vtfHeader.version[1]		= le32_to_cpu(d->vtfHeader.version[1]);
-	d->vtfHeader.headerSize		= le32_to_cpu(d->vtfHeader.headerSize);
-	d->vtfHeader.width		= le16_to_cpu(d->vtfHeader.width);
-	d->vtfHeader.height		= le16_to_cpu(d->vtfHeader.height);
-	d->vtfHeader.flags		= le32_to_cpu(d->vtfHeader.flags);
-	d->vtfHeader.frames		= le16_to_cpu(d->vtfHeader.frames);
-	d->vtfHeader.firstFrame		= le16_to_cpu(d->vtfHeader.firstFrame);
-	d->vtfHeader.reflectivity[0]	= d->__swabf(d->vtfHeader.reflectivity[0]);
-	d->vtfHeader.reflectivity[1]	= d->__swabf(d->vtfHeader.reflectivity[1]);
-	d->vtfHeader.reflectivity[2]	= d->__swabf(d->vtfHeader.reflectivity[2]);
-	d->vtfHeader.bumpmapScale	= d->__swabf(d->vtfHeader.bumpmapScale);
-	d->vtfHeader.highResImageFormat	= le32_to_cpu(d->vtfHeader.highResImageFormat);
-	d->vtfHeader.lowResImageFormat	= le32_to_cpu(d->vtfHeader.lowResImageFormat);
-	d->vtfHeader.depth		= le16_to_cpu(d->vtfHeader.depth);
-	d->vtfHeader.numResources	= le32_to_cpu(d->vtfHeader.numResources);
-#endif
+	le_struct_to_cpu(d->vtfHeader);
 
 	// Texture data start address.
 	// Note that this is the start of *all* texture data,
@@ -1079,4 +1162,46 @@ const rp_image *ValveVTF::mipmap(int mip) const
 	return const_cast<ValveVTFPrivate*>(d)->loadImage(mip);
 }
 
+/**
+ * Get the embedded low-resolution preview image.
+ * VTF files usually have a 16x16 DXT1 image stored before the mipmaps.
+ * @return Preview image, or nullptr if not available.
+ */
+const rp_image *ValveVTF::previewImage(void) const
+{
+	RP_D(const ValveVTF);
+	if (!d->isValid) {
+		// Unknown file type.
+		return nullptr;
+	}
+
+	// Load the image.
+	return const_cast<ValveVTFPrivate*>(d)->loadLowResImage();
+}
+
+/**
+ * Get the embedded preview image's dimensions.
+ * This does not decode the preview image.
+ * @param pBuf Two-element array for [x, y].
+ * @return 0 on success; negative POSIX error code on error. (-ENOENT if not available)
+ */
+int ValveVTF::getPreviewDimensions(int pBuf[2]) const
+{
+	RP_D(const ValveVTF);
+	if (!d->isValid) {
+		// Unknown file type.
+		return -EIO;
+	} else if (d->vtfHeader.lowResImageFormat < 0 ||
+	           d->vtfHeader.lowResImageFormat >= VTF_IMAGE_FORMAT_MAX ||
+	           d->vtfHeader.lowResImageWidth == 0)
+	{
+		// No low-resolution image.
+		return -ENOENT;
+	}
+
+	pBuf[0] = d->vtfHeader.lowResImageWidth;
+	pBuf[1] = (d->vtfHeader.lowResImageHeight > 0 ? d->vtfHeader.lowResImageHeight : 1);
+	return 0;
+}
+
 }
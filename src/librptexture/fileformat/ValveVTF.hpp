@@ -14,6 +14,7 @@
 namespace LibRpTexture {
 
 FILEFORMAT_DECL_BEGIN(ValveVTF)
+FILEFORMAT_DECL_PREVIEW()
 FILEFORMAT_DECL_END()
 
 }
@@ -12,6 +12,9 @@
 
 #include "vtf3_structs.h"
 
+// librpcpu
+#include "librpcpu/byteswap_struct.hpp"
+
 // librpbase, librpfile
 using LibRpBase::RomFields;
 using LibRpFile::IRpFile;
@@ -20,6 +23,13 @@ using LibRpFile::IRpFile;
 #include "img/rp_image.hpp"
 #include "decoder/ImageDecoder.hpp"
 
+// VTF3 header byteswap layout.
+// NOTE: Signature is *not* byteswapped.
+RP_BYTESWAP_LAYOUT(VTF3HEADER,
+	RP_BYTESWAP_FIELD(VTF3HEADER, flags),
+	RP_BYTESWAP_FIELD(VTF3HEADER, width),
+	RP_BYTESWAP_FIELD(VTF3HEADER, height))
+
 namespace LibRpTexture {
 
 FILEFORMAT_IMPL(ValveVTF3)
@@ -46,24 +56,6 @@ class ValveVTF3Private final : public FileFormatPrivate
 		 * @return Image, or nullptr on error.
 		 */
 		const rp_image *loadImage(void);
-
-#if SYS_BYTEORDER == SYS_BIG_ENDIAN
-		/**
-		 * Byteswap a float. (TODO: Move to byteswap_rp.h?)
-		 * @param f Float to byteswap.
-		 * @return Byteswapped flaot.
-		 */
-		static inline float __swabf(float f)
-		{
-			union {
-				uint32_t u32;
-				float f;
-			} u32_f;
-			u32_f.f = f;
-			u32_f.u32 = __swab32(u32_f.u32);
-			return u32_f.f;
-		}
-#endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
 };
 
 /** ValveVTF3Private **/
@@ -218,14 +210,9 @@ ValveVTF3::ValveVTF3(IRpFile *file)
 	// File is valid.
 	d->isValid = true;
 
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
 	// Header is stored in big-endian, so it always
 	// needs to be byteswapped on little-endian.
-	// NOTE: Signature is *not* byteswapped.
-	d->vtf3Header.flags		= be32_to_cpu(d->vtf3Header.flags);
-	d->vtf3Header.width		= be16_to_cpu(d->vtf3Header.width);
-	d->vtf3Header.height		= be16_to_cpu(d->vtf3Header.height);
-#endif
+	be_struct_to_cpu(d->vtf3Header);
 
 	// Cache the dimensions for the FileFormat base class.
 	d->dimensions[0] = d->vtf3Header.width;
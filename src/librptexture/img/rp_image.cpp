@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (librptexture)                     *
  * rp_image.hpp: Image class.                                              *
  *                                                                         *
- * Copyright (c) 2016-2019 by David Korth.                                 *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -11,11 +11,71 @@
 #include "rp_image_p.hpp"
 #include "rp_image_backend.hpp"
 
+// Atomic functions.
+#include "librpthreads/Atomics.h"
+
 // Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
 #define rp_imagePrivate rp_image_private
 
 namespace LibRpTexture {
 
+/** rp_image_shared_data **/
+
+/**
+ * Image data shared between copy-on-write views.
+ */
+class rp_image_shared_data
+{
+	public:
+		/**
+		 * Take ownership of an image buffer.
+		 * @param data Image buffer, allocated using aligned_malloc().
+		 */
+		explicit rp_image_shared_data(uint8_t *data)
+			: m_ref_cnt(1)
+			, data(data)
+		{ }
+
+	private:
+		~rp_image_shared_data()
+		{
+			aligned_free(data);
+		}
+
+	private:
+		RP_DISABLE_COPY(rp_image_shared_data)
+
+	public:
+		inline rp_image_shared_data *ref(void)
+		{
+			ATOMIC_INC_FETCH(&m_ref_cnt);
+			return this;
+		}
+
+		inline void unref(void)
+		{
+			assert(m_ref_cnt > 0);
+			if (ATOMIC_DEC_FETCH(&m_ref_cnt) <= 0) {
+				// All references removed.
+				delete this;
+			}
+		}
+
+		/**
+		 * Is the image data shared with another backend?
+		 * @return True if shared; false if not.
+		 */
+		inline bool isShared(void) const
+		{
+			return (m_ref_cnt > 1);
+		}
+
+	private:
+		volatile int m_ref_cnt;
+	public:
+		uint8_t *const data;
+};
+
 /** rp_image_backend_default **/
 
 class rp_image_backend_default : public rp_image_backend
@@ -24,13 +84,32 @@ class rp_image_backend_default : public rp_image_backend
 		rp_image_backend_default(int width, int height, rp_image::Format format);
 		virtual ~rp_image_backend_default();
 
+	private:
+		/**
+		 * Create a copy-on-write view of another backend's image data.
+		 * @param other Other backend.
+		 * @param y First row.
+		 * @param width View width.
+		 * @param height View height.
+		 */
+		rp_image_backend_default(const rp_image_backend_default *other, int y, int width, int height);
+
 	private:
 		typedef rp_image_backend super;
 		RP_DISABLE_COPY(rp_image_backend_default)
 
+	private:
+		/**
+		 * Make sure this backend has its own copy of the image data.
+		 */
+		void detach(void);
+
 	public:
 		void *data(void) final
 		{
+			if (m_shared && m_shared->isShared()) {
+				detach();
+			}
 			return m_data;
 		}
 
@@ -68,18 +147,39 @@ class rp_image_backend_default : public rp_image_backend
 		 */
 		int shrink(int width, int height) final;
 
+		/**
+		 * Create a copy-on-write view of this backend's image data.
+		 * @param y First row.
+		 * @param width View width. (must be <= this->width)
+		 * @param height View height. (must be <= this->height - y)
+		 * @return New rp_image_backend, or nullptr on error.
+		 */
+		rp_image_backend *createView(int y, int width, int height) const final;
+
 	private:
-		void *m_data;
+		// Image data.
+		// m_data points into m_shared->data, which may be
+		// shared with other backends.
+		uint8_t *m_data;
 		size_t m_data_len;
+		rp_image_shared_data *m_shared;
 
 		uint32_t *m_palette;
 		int m_palette_len;
+
+		/**
+		 * Allocate a palette and copy it from another backend.
+		 * @param other Other backend, or nullptr to clear the palette.
+		 * @return 0 on success; non-zero on error.
+		 */
+		int initPalette(const rp_image_backend_default *other);
 };
 
 rp_image_backend_default::rp_image_backend_default(int width, int height, rp_image::Format format)
 	: super(width, height, format)
 	, m_data(nullptr)
 	, m_data_len(0)
+	, m_shared(nullptr)
 	, m_palette(nullptr)
 	, m_palette_len(0)
 {
@@ -100,42 +200,150 @@ rp_image_backend_default::rp_image_backend_default(int width, int height, rp_ima
 		return;
 	}
 
-	m_data = aligned_malloc(16, m_data_len);
+	m_data = static_cast<uint8_t*>(aligned_malloc(16, m_data_len));
 	assert(m_data != nullptr);
 	if (!m_data) {
 		// Failed to allocate memory.
+		m_data_len = 0;
 		clear_properties();
 		return;
 	}
+	m_shared = new rp_image_shared_data(m_data);
 
 	// Do we need to allocate memory for the palette?
 	if (format == rp_image::Format::CI8) {
-		// Palette is initialized to 0 to ensure
-		// there's no weird artifacts if the caller
-		// is converting a lower-color image.
-		const size_t palette_sz = 256*sizeof(*m_palette);
-		m_palette = static_cast<uint32_t*>(aligned_malloc(16, palette_sz));
-		if (!m_palette) {
+		if (initPalette(nullptr) != 0) {
 			// Failed to allocate memory.
-			aligned_free(m_data);
+			m_shared->unref();
+			m_shared = nullptr;
 			m_data = nullptr;
 			m_data_len = 0;
 			clear_properties();
 			return;
 		}
+	}
+}
 
-		// 256 colors allocated in the palette.
-		memset(m_palette, 0, palette_sz);
-		m_palette_len = 256;
+/**
+ * Create a copy-on-write view of another backend's image data.
+ * @param other Other backend.
+ * @param y First row.
+ * @param width View width.
+ * @param height View height.
+ */
+rp_image_backend_default::rp_image_backend_default(const rp_image_backend_default *other, int y, int width, int height)
+	: super(width, height, other->format)
+	, m_data(nullptr)
+	, m_data_len(0)
+	, m_shared(nullptr)
+	, m_palette(nullptr)
+	, m_palette_len(0)
+{
+	if (format == rp_image::Format::CI8) {
+		if (initPalette(other) != 0) {
+			// Failed to allocate memory.
+			clear_properties();
+			return;
+		}
+		tr_idx = other->tr_idx;
 	}
+
+	m_shared = other->m_shared->ref();
+	m_data = other->m_data + (y * other->stride);
+	stride = other->stride;
+	m_data_len = height * stride;
 }
 
 rp_image_backend_default::~rp_image_backend_default()
 {
-	aligned_free(m_data);
+	if (m_shared) {
+		m_shared->unref();
+	}
 	aligned_free(m_palette);
 }
 
+/**
+ * Allocate a palette and copy it from another backend.
+ * @param other Other backend, or nullptr to clear the palette.
+ * @return 0 on success; non-zero on error.
+ */
+int rp_image_backend_default::initPalette(const rp_image_backend_default *other)
+{
+	// Palette is initialized to 0 to ensure
+	// there's no weird artifacts if the caller
+	// is converting a lower-color image.
+	const size_t palette_sz = 256*sizeof(*m_palette);
+	m_palette = static_cast<uint32_t*>(aligned_malloc(16, palette_sz));
+	if (!m_palette) {
+		// Failed to allocate memory.
+		return -ENOMEM;
+	}
+
+	// 256 colors allocated in the palette.
+	if (other && other->m_palette) {
+		memcpy(m_palette, other->m_palette, palette_sz);
+	} else {
+		memset(m_palette, 0, palette_sz);
+	}
+	m_palette_len = 256;
+	return 0;
+}
+
+/**
+ * Make sure this backend has its own copy of the image data.
+ */
+void rp_image_backend_default::detach(void)
+{
+	assert(m_shared != nullptr);
+	uint8_t *const new_data = static_cast<uint8_t*>(aligned_malloc(16, m_data_len));
+	assert(new_data != nullptr);
+	if (!new_data) {
+		// Failed to allocate memory.
+		// Keep using the shared image data.
+		return;
+	}
+
+	// NOTE: The last row of a view might not have the full stride
+	// available if columns were removed, so only copy the
+	// active bytes of the last row.
+	const size_t last_row_bytes = (format == rp_image::Format::ARGB32)
+		? (width * sizeof(uint32_t))
+		: width;
+	memcpy(new_data, m_data, ((height - 1) * stride) + last_row_bytes);
+
+	m_shared->unref();
+	m_shared = new rp_image_shared_data(new_data);
+	m_data = new_data;
+}
+
+/**
+ * Create a copy-on-write view of this backend's image data.
+ * @param y First row.
+ * @param width View width. (must be <= this->width)
+ * @param height View height. (must be <= this->height - y)
+ * @return New rp_image_backend, or nullptr on error.
+ */
+rp_image_backend *rp_image_backend_default::createView(int y, int width, int height) const
+{
+	assert(y >= 0);
+	assert(width > 0);
+	assert(height > 0);
+	assert(width <= this->width);
+	assert(y + height <= this->height);
+	if (!m_shared || y < 0 || width <= 0 || height <= 0 ||
+	    width > this->width || y + height > this->height)
+	{
+		return nullptr;
+	}
+
+	rp_image_backend_default *const view = new rp_image_backend_default(this, y, width, height);
+	if (!view->isValid()) {
+		delete view;
+		return nullptr;
+	}
+	return view;
+}
+
 /**
  * Shrink image dimensions.
  * @param width New width.
@@ -376,12 +584,16 @@ rp_image::Format rp_image::format(void) const
 const void *rp_image::bits(void) const
 {
 	RP_D(const rp_image);
-	return d->backend->data();
+	const rp_image_backend *const backend = d->backend;
+	return backend->data();
 }
 
 /**
  * Get a pointer to the first line of image data.
- * TODO: detach()
+ *
+ * If the image data is shared with another rp_image,
+ * e.g. a view created by dup(), it will be detached.
+ *
  * @return Image data.
  */
 void *rp_image::bits(void)
@@ -398,16 +610,20 @@ void *rp_image::bits(void)
 const void *rp_image::scanLine(int i) const
 {
 	RP_D(const rp_image);
-	const uint8_t *data = static_cast<const uint8_t*>(d->backend->data());
+	const rp_image_backend *const backend = d->backend;
+	const uint8_t *data = static_cast<const uint8_t*>(backend->data());
 	if (!data)
 		return nullptr;
 
-	return data + (d->backend->stride * i);
+	return data + (backend->stride * i);
 }
 
 /**
  * Get a pointer to the specified line of image data.
- * TODO: Detach.
+ *
+ * If the image data is shared with another rp_image,
+ * e.g. a view created by dup(), it will be detached.
+ *
  * @param i Line number.
  * @return Line of image data, or nullptr if i is out of range.
  */
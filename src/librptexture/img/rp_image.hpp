@@ -23,10 +23,19 @@
 # include "librpcpu/cpuflags_x86.h"
 # define RP_IMAGE_HAS_SSE2 1
 # define RP_IMAGE_HAS_SSE41 1
+# define RP_IMAGE_HAS_AVX2 1
 #endif
 #ifdef RP_CPU_AMD64
 # define RP_IMAGE_ALWAYS_HAS_SSE2 1
 #endif
+#if defined(RP_CPU_ARM64) || \
+    (defined(RP_CPU_ARM) && (defined(__ARM_NEON) || defined(__ARM_NEON__)))
+// NEON is always available on ARM64. On 32-bit ARM,
+// only use it if it's part of the compiler's baseline.
+# include "librpcpu/cpuflags_arm.h"
+# define RP_IMAGE_HAS_NEON 1
+# define RP_IMAGE_ALWAYS_HAS_NEON 1
+#endif
 
 // TODO: Make this implicitly shared.
 
@@ -208,7 +217,10 @@ class rp_image : public RefBase
 
 		/**
 		 * Get a pointer to the first line of image data.
-		 * TODO: detach()
+		 *
+		 * If the image data is shared with another rp_image,
+		 * e.g. a view created by dup(), it will be detached.
+		 *
 		 * @return Image data.
 		 */
 		void *bits(void);
@@ -222,7 +234,10 @@ class rp_image : public RefBase
 
 		/**
 		 * Get a pointer to the specified line of image data.
-		 * TODO: Detach.
+		 *
+		 * If the image data is shared with another rp_image,
+		 * e.g. a view created by dup(), it will be detached.
+		 *
 		 * @param i Line number.
 		 * @return Line of image data, or nullptr if i is out of range.
 		 */
@@ -307,11 +322,27 @@ class rp_image : public RefBase
 		 */
 		void clear_sBIT(void);
 
+	private:
+		/**
+		 * Create a copy-on-write view of this rp_image.
+		 * The palette, tr_idx, and sBIT are copied.
+		 * @param y First row.
+		 * @param width View width.
+		 * @param height View height.
+		 * @return New rp_image, or nullptr if views aren't supported by the image backend.
+		 */
+		rp_image *createView(int y, int width, int height) const;
+
 	public:
 		/** Image operations. **/
 
 		/**
 		 * Duplicate the rp_image.
+		 *
+		 * If supported by the image backend, the new rp_image
+		 * will share the image data with this one until either
+		 * image is modified. (copy-on-write)
+		 *
 		 * @return New rp_image with a copy of the image data.
 		 */
 		rp_image *dup(void) const;
@@ -371,6 +402,8 @@ class rp_image : public RefBase
 		 *
 		 * If the new dimensions are smaller than the old dimensions,
 		 * the image will be cropped according to the specified alignment.
+		 * If supported by the image backend, a cropped image will share
+		 * the image data with this one. (copy-on-write)
 		 *
 		 * If the new dimensions are larger, the original image will be
 		 * aligned to the top, center, or bottom, depending on alignment,
@@ -386,6 +419,99 @@ class rp_image : public RefBase
 			Alignment alignment = AlignDefault,
 			uint32_t bgColor = 0x00000000) const;
 
+		/**
+		 * Filters for scaled().
+		 */
+		enum class ScaleFilter : uint8_t {
+			Box		= 0,	// Box filter (area averaging)
+			Bilinear	= 1,	// Bilinear (triangle) filter
+		};
+
+		/**
+		 * Scale the rp_image.
+		 * Standard version using regular C++ code.
+		 *
+		 * A new ARGB32 rp_image will be created with the specified
+		 * dimensions. Filtering is done using premultiplied alpha,
+		 * so the color of transparent pixels doesn't bleed into
+		 * the surrounding pixels.
+		 *
+		 * @param width New width
+		 * @param height New height
+		 * @param filter Scaling filter
+		 * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+		 */
+		rp_image *scaled_cpp(int width, int height, ScaleFilter filter) const;
+
+#ifdef RP_IMAGE_HAS_SSE2
+		/**
+		 * Scale the rp_image.
+		 * SSE2-optimized version.
+		 *
+		 * A new ARGB32 rp_image will be created with the specified
+		 * dimensions. Filtering is done using premultiplied alpha,
+		 * so the color of transparent pixels doesn't bleed into
+		 * the surrounding pixels.
+		 *
+		 * @param width New width
+		 * @param height New height
+		 * @param filter Scaling filter
+		 * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+		 */
+		rp_image *scaled_sse2(int width, int height, ScaleFilter filter) const;
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Scale the rp_image.
+		 * AVX2-optimized version.
+		 *
+		 * A new ARGB32 rp_image will be created with the specified
+		 * dimensions. Filtering is done using premultiplied alpha,
+		 * so the color of transparent pixels doesn't bleed into
+		 * the surrounding pixels.
+		 *
+		 * @param width New width
+		 * @param height New height
+		 * @param filter Scaling filter
+		 * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+		 */
+		rp_image *scaled_avx2(int width, int height, ScaleFilter filter) const;
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+#ifdef RP_IMAGE_HAS_NEON
+		/**
+		 * Scale the rp_image.
+		 * NEON-optimized version.
+		 *
+		 * A new ARGB32 rp_image will be created with the specified
+		 * dimensions. Filtering is done using premultiplied alpha,
+		 * so the color of transparent pixels doesn't bleed into
+		 * the surrounding pixels.
+		 *
+		 * @param width New width
+		 * @param height New height
+		 * @param filter Scaling filter
+		 * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+		 */
+		rp_image *scaled_neon(int width, int height, ScaleFilter filter) const;
+#endif /* RP_IMAGE_HAS_NEON */
+
+		/**
+		 * Scale the rp_image.
+		 *
+		 * A new ARGB32 rp_image will be created with the specified
+		 * dimensions. Filtering is done using premultiplied alpha,
+		 * so the color of transparent pixels doesn't bleed into
+		 * the surrounding pixels.
+		 *
+		 * @param width New width
+		 * @param height New height
+		 * @param filter Scaling filter
+		 * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+		 */
+		inline rp_image *scaled(int width, int height, ScaleFilter filter = ScaleFilter::Box) const;
+
 		/**
 		 * Un-premultiply this image.
 		 * Standard version using regular C++ code.
@@ -408,6 +534,30 @@ class rp_image : public RefBase
 		int un_premultiply_sse41(void);
 #endif /* RP_IMAGE_HAS_SSE41 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Un-premultiply this image.
+		 * AVX2-optimized version.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int un_premultiply_avx2(void);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+#ifdef RP_IMAGE_HAS_NEON
+		/**
+		 * Un-premultiply this image.
+		 * NEON-optimized version.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int un_premultiply_neon(void);
+#endif /* RP_IMAGE_HAS_NEON */
+
 		/**
 		 * Un-premultiply this image.
 		 *
@@ -426,12 +576,58 @@ class rp_image : public RefBase
 
 		/**
 		 * Premultiply this image.
+		 * Standard version using regular C++ code.
 		 *
 		 * Image must be ARGB32.
 		 *
 		 * @return 0 on success; non-zero on error.
 		 */
-		int premultiply(void);
+		int premultiply_cpp(void);
+
+#ifdef RP_IMAGE_HAS_SSE41
+		/**
+		 * Premultiply this image.
+		 * SSE4.1-optimized version.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int premultiply_sse41(void);
+#endif /* RP_IMAGE_HAS_SSE41 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+		/**
+		 * Premultiply this image.
+		 * AVX2-optimized version.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int premultiply_avx2(void);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+#ifdef RP_IMAGE_HAS_NEON
+		/**
+		 * Premultiply this image.
+		 * NEON-optimized version.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		int premultiply_neon(void);
+#endif /* RP_IMAGE_HAS_NEON */
+
+		/**
+		 * Premultiply this image.
+		 *
+		 * Image must be ARGB32.
+		 *
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int premultiply(void);
 
 		/**
 		 * Convert a chroma-keyed image to standard ARGB32.
@@ -503,6 +699,49 @@ class rp_image : public RefBase
 		int shrink(int width, int height);
 };
 
+/**
+ * Scale the rp_image.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. Filtering is done using premultiplied alpha,
+ * so the color of transparent pixels doesn't bleed into
+ * the surrounding pixels.
+ *
+ * @param width New width
+ * @param height New height
+ * @param filter Scaling filter
+ * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+ */
+inline rp_image *rp_image::scaled(int width, int height, ScaleFilter filter) const
+{
+	// FIXME: Figure out how to get IFUNC working with  C++ member functions.
+#if defined(RP_IMAGE_ALWAYS_HAS_NEON)
+	// ARM64 always has NEON.
+	return scaled_neon(width, height, filter);
+#else /* !RP_IMAGE_ALWAYS_HAS_NEON */
+# ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return scaled_avx2(width, height, filter);
+	} else
+# endif /* RP_IMAGE_HAS_AVX2 */
+# if defined(RP_IMAGE_ALWAYS_HAS_SSE2)
+	{
+		// amd64 always has SSE2.
+		return scaled_sse2(width, height, filter);
+	}
+# else /* !RP_IMAGE_ALWAYS_HAS_SSE2 */
+#  ifdef RP_IMAGE_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return scaled_sse2(width, height, filter);
+	} else
+#  endif /* RP_IMAGE_HAS_SSE2 */
+	{
+		return scaled_cpp(width, height, filter);
+	}
+# endif /* RP_IMAGE_ALWAYS_HAS_SSE2 */
+#endif /* RP_IMAGE_ALWAYS_HAS_NEON */
+}
+
 /**
  * Un-premultiply this image.
  *
@@ -513,14 +752,54 @@ class rp_image : public RefBase
 inline int rp_image::un_premultiply(void)
 {
 	// FIXME: Figure out how to get IFUNC working with  C++ member functions.
-#ifdef RP_IMAGE_HAS_SSE41
+#if defined(RP_IMAGE_ALWAYS_HAS_NEON)
+	// ARM64 always has NEON.
+	return un_premultiply_neon();
+#else
+# ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return un_premultiply_avx2();
+	} else
+# endif /* RP_IMAGE_HAS_AVX2 */
+# ifdef RP_IMAGE_HAS_SSE41
 	if (RP_CPU_HasSSE41()) {
 		return un_premultiply_sse41();
 	} else
-#endif /* RP_IMAGE_HAS_SSE2 */
+# endif /* RP_IMAGE_HAS_SSE41 */
 	{
 		return un_premultiply_cpp();
 	}
+#endif /* RP_IMAGE_ALWAYS_HAS_NEON */
+}
+
+/**
+ * Premultiply this image.
+ *
+ * Image must be ARGB32.
+ *
+ * @return 0 on success; non-zero on error.
+ */
+inline int rp_image::premultiply(void)
+{
+	// FIXME: Figure out how to get IFUNC working with  C++ member functions.
+#if defined(RP_IMAGE_ALWAYS_HAS_NEON)
+	// ARM64 always has NEON.
+	return premultiply_neon();
+#else
+# ifdef RP_IMAGE_HAS_AVX2
+	if (RP_CPU_HasAVX2()) {
+		return premultiply_avx2();
+	} else
+# endif /* RP_IMAGE_HAS_AVX2 */
+# ifdef RP_IMAGE_HAS_SSE41
+	if (RP_CPU_HasSSE41()) {
+		return premultiply_sse41();
+	} else
+# endif /* RP_IMAGE_HAS_SSE41 */
+	{
+		return premultiply_cpp();
+	}
+#endif /* RP_IMAGE_ALWAYS_HAS_NEON */
 }
 
 /**
@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (librptexture)                     *
  * rp_image_backend.cpp: Image backend and storage classes.                *
  *                                                                         *
- * Copyright (c) 2016-2019 by David Korth.                                 *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -69,6 +69,31 @@ rp_image_backend::rp_image_backend(int width, int height, rp_image::Format forma
 rp_image_backend::~rp_image_backend()
 { }
 
+/**
+ * Create a copy-on-write view of this backend's image data.
+ *
+ * The view shares the image data with this backend until
+ * either backend's non-const data() function is called,
+ * at which point that backend gets its own copy.
+ *
+ * NOTE: The view has the same stride as this backend.
+ * Rows can be removed from the top and bottom, and
+ * columns can be removed from the right.
+ *
+ * @param y First row.
+ * @param width View width. (must be <= this->width)
+ * @param height View height. (must be <= this->height - y)
+ * @return New rp_image_backend, or nullptr if views aren't supported by this backend.
+ */
+rp_image_backend *rp_image_backend::createView(int y, int width, int height) const
+{
+	// Views aren't supported by default.
+	RP_UNUSED(y);
+	RP_UNUSED(width);
+	RP_UNUSED(height);
+	return nullptr;
+}
+
 bool rp_image_backend::isValid(void) const
 {
 	return (width > 0 && height > 0 && stride > 0 &&
@@ -0,0 +1,354 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_backend_pooled.cpp: Image backend using pooled storage.        *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image_backend_pooled.hpp"
+
+// C++ STL classes.
+using std::vector;
+
+namespace LibRpTexture {
+
+/** BufferPool **/
+
+/**
+ * Per-thread pool of image buffers.
+ *
+ * Buffers are grouped into power-of-two size buckets.
+ * Buffers larger than the largest bucket aren't pooled.
+ */
+class BufferPool
+{
+	public:
+		BufferPool();
+		~BufferPool();
+
+	private:
+		RP_DISABLE_COPY(BufferPool)
+
+	public:
+		// Smallest bucket: 1 KiB (CI8 palette)
+		// Largest bucket: 16 MiB (2048x2048 ARGB32)
+		static const unsigned int MIN_BUCKET_SHIFT = 10;
+		static const unsigned int MAX_BUCKET_SHIFT = 24;
+		static const unsigned int BUCKET_COUNT = MAX_BUCKET_SHIFT - MIN_BUCKET_SHIFT + 1;
+
+		// Maximum number of free buffers per bucket.
+		static const size_t MAX_FREE_PER_BUCKET = 8;
+		// Maximum total size of all free buffers.
+		static const size_t MAX_CACHED_SIZE = 32U*1024*1024;
+
+		/**
+		 * Allocate a buffer.
+		 * @param size		[in] Requested size.
+		 * @param pAllocLen	[out] Allocated size. Must be passed to release().
+		 * @return Buffer, or nullptr on error.
+		 */
+		void *alloc(size_t size, size_t *pAllocLen);
+
+		/**
+		 * Release a buffer.
+		 * @param ptr Buffer.
+		 * @param alloc_len Allocated size, as returned by alloc().
+		 */
+		void release(void *ptr, size_t alloc_len);
+
+		/**
+		 * Free all cached buffers.
+		 */
+		void trim(void);
+
+		/**
+		 * Get the total size of all cached buffers.
+		 * @return Cached size, in bytes.
+		 */
+		inline size_t cached_size(void) const
+		{
+			return m_cached_size;
+		}
+
+	private:
+		vector<void*> m_free[BUCKET_COUNT];
+		size_t m_cached_size;
+};
+
+// Set when this thread's pool is destroyed.
+// If any images are deleted after that, e.g. static objects
+// being destroyed on program exit, aligned_free() is used.
+// NOTE: This must be a trivial type so it remains valid
+// after the thread's BufferPool is destroyed.
+static thread_local bool tls_pool_destroyed = false;
+
+BufferPool::BufferPool()
+	: m_cached_size(0)
+{ }
+
+BufferPool::~BufferPool()
+{
+	trim();
+	tls_pool_destroyed = true;
+}
+
+/**
+ * Get the bucket index for the specified size.
+ * @param size Size.
+ * @return Bucket index, or -1 if the size is too big to be pooled.
+ */
+static inline int bucket_index(size_t size)
+{
+	unsigned int shift = BufferPool::MIN_BUCKET_SHIFT;
+	while ((static_cast<size_t>(1) << shift) < size) {
+		shift++;
+		if (shift > BufferPool::MAX_BUCKET_SHIFT) {
+			return -1;
+		}
+	}
+	return static_cast<int>(shift - BufferPool::MIN_BUCKET_SHIFT);
+}
+
+/**
+ * Allocate a buffer.
+ * @param size		[in] Requested size.
+ * @param pAllocLen	[out] Allocated size. Must be passed to release().
+ * @return Buffer, or nullptr on error.
+ */
+void *BufferPool::alloc(size_t size, size_t *pAllocLen)
+{
+	const int idx = bucket_index(size);
+	if (idx < 0) {
+		// Too big to be pooled.
+		*pAllocLen = size;
+		return aligned_malloc(16, size);
+	}
+
+	const size_t alloc_len = static_cast<size_t>(1) << (idx + MIN_BUCKET_SHIFT);
+	*pAllocLen = alloc_len;
+	vector<void*> &bucket = m_free[idx];
+	if (!bucket.empty()) {
+		// Reuse a cached buffer.
+		void *const ptr = bucket.back();
+		bucket.pop_back();
+		m_cached_size -= alloc_len;
+		return ptr;
+	}
+
+	return aligned_malloc(16, alloc_len);
+}
+
+/**
+ * Release a buffer.
+ * @param ptr Buffer.
+ * @param alloc_len Allocated size, as returned by alloc().
+ */
+void BufferPool::release(void *ptr, size_t alloc_len)
+{
+	if (!ptr)
+		return;
+
+	const int idx = bucket_index(alloc_len);
+	if (idx < 0 || (static_cast<size_t>(1) << (idx + MIN_BUCKET_SHIFT)) != alloc_len ||
+	    m_free[idx].size() >= MAX_FREE_PER_BUCKET ||
+	    m_cached_size + alloc_len > MAX_CACHED_SIZE)
+	{
+		// Not pooled, or the pool is full.
+		aligned_free(ptr);
+		return;
+	}
+
+	m_free[idx].push_back(ptr);
+	m_cached_size += alloc_len;
+}
+
+/**
+ * Free all cached buffers.
+ */
+void BufferPool::trim(void)
+{
+	for (unsigned int i = 0; i < BUCKET_COUNT; i++) {
+		for (void *ptr : m_free[i]) {
+			aligned_free(ptr);
+		}
+		m_free[i].clear();
+	}
+	m_cached_size = 0;
+}
+
+/**
+ * Get this thread's buffer pool.
+ * @return Buffer pool, or nullptr if it has already been destroyed.
+ */
+static BufferPool *getPool(void)
+{
+	static thread_local BufferPool tls_pool;
+	if (tls_pool_destroyed) {
+		return nullptr;
+	}
+	return &tls_pool;
+}
+
+/**
+ * Allocate a buffer from this thread's pool.
+ * @param size		[in] Requested size.
+ * @param pAllocLen	[out] Allocated size.
+ * @return Buffer, or nullptr on error.
+ */
+static inline void *pool_alloc(size_t size, size_t *pAllocLen)
+{
+	BufferPool *const pool = getPool();
+	if (!pool) {
+		*pAllocLen = size;
+		return aligned_malloc(16, size);
+	}
+	return pool->alloc(size, pAllocLen);
+}
+
+/**
+ * Release a buffer to this thread's pool.
+ * @param ptr Buffer.
+ * @param alloc_len Allocated size.
+ */
+static inline void pool_release(void *ptr, size_t alloc_len)
+{
+	BufferPool *const pool = getPool();
+	if (!pool) {
+		aligned_free(ptr);
+		return;
+	}
+	pool->release(ptr, alloc_len);
+}
+
+/** rp_image_backend_pooled **/
+
+rp_image_backend_pooled::rp_image_backend_pooled(int width, int height, rp_image::Format format)
+	: super(width, height, format)
+	, m_data(nullptr)
+	, m_data_len(0)
+	, m_data_alloc_len(0)
+	, m_palette(nullptr)
+	, m_palette_len(0)
+	, m_palette_alloc_len(0)
+{
+	if (width == 0 || height == 0) {
+		// Error initializing the backend.
+		// (Width, height, or format is probably broken.)
+		return;
+	}
+
+	// Allocate memory for the image.
+	// We're using the full stride for the last row
+	// to make it easier to manage.
+	m_data_len = height * stride;
+	assert(m_data_len > 0);
+	if (m_data_len == 0) {
+		// Somehow we have a 0-length image...
+		clear_properties();
+		return;
+	}
+
+	m_data = pool_alloc(m_data_len, &m_data_alloc_len);
+	assert(m_data != nullptr);
+	if (!m_data) {
+		// Failed to allocate memory.
+		m_data_len = 0;
+		clear_properties();
+		return;
+	}
+
+	// Do we need to allocate memory for the palette?
+	if (format == rp_image::Format::CI8) {
+		// Palette is initialized to 0 to ensure
+		// there's no weird artifacts if the caller
+		// is converting a lower-color image.
+		// NOTE: Pooled buffers may contain old data,
+		// so this is always necessary.
+		const size_t palette_sz = 256*sizeof(*m_palette);
+		m_palette = static_cast<uint32_t*>(pool_alloc(palette_sz, &m_palette_alloc_len));
+		if (!m_palette) {
+			// Failed to allocate memory.
+			pool_release(m_data, m_data_alloc_len);
+			m_data = nullptr;
+			m_data_len = 0;
+			clear_properties();
+			return;
+		}
+
+		// 256 colors allocated in the palette.
+		memset(m_palette, 0, palette_sz);
+		m_palette_len = 256;
+	}
+}
+
+rp_image_backend_pooled::~rp_image_backend_pooled()
+{
+	pool_release(m_data, m_data_alloc_len);
+	pool_release(m_palette, m_palette_alloc_len);
+}
+
+/**
+ * Creator function for rp_image::setBackendCreatorFn().
+ */
+rp_image_backend *rp_image_backend_pooled::creator_fn(int width, int height, rp_image::Format format)
+{
+	return new rp_image_backend_pooled(width, height, format);
+}
+
+/**
+ * Free all buffers cached by the current thread's pool.
+ * This should be called if the thread is going to be idle
+ * for a while, e.g. after a batch of thumbnails.
+ */
+void rp_image_backend_pooled::trim(void)
+{
+	BufferPool *const pool = getPool();
+	if (pool) {
+		pool->trim();
+	}
+}
+
+/**
+ * Get the total size of all buffers cached by the current thread's pool.
+ * @return Cached size, in bytes.
+ */
+size_t rp_image_backend_pooled::cached_size(void)
+{
+	const BufferPool *const pool = getPool();
+	return (pool ? pool->cached_size() : 0);
+}
+
+/**
+ * Shrink image dimensions.
+ * @param width New width.
+ * @param height New height.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rp_image_backend_pooled::shrink(int width, int height)
+{
+	assert(width > 0);
+	assert(height > 0);
+	assert(this->width > 0);
+	assert(this->height > 0);
+	assert(width <= this->width);
+	assert(height <= this->height);
+	if (width <= 0 || height <= 0 ||
+	    this->width <= 0 || this->height <= 0 ||
+	    width > this->width || height > this->height)
+	{
+		return -EINVAL;
+	}
+
+	// We can simply reduce width/height without actually
+	// adjusting the image data.
+	// NOTE: m_data_alloc_len is unchanged, since the
+	// buffer will be returned to the same bucket.
+	this->width = width;
+	this->height = height;
+	m_data_len = height * stride;
+	return 0;
+}
+
+}
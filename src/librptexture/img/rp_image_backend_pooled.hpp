@@ -0,0 +1,109 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_backend_pooled.hpp: Image backend using pooled storage.        *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_BACKEND_POOLED_HPP__
+#define __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_BACKEND_POOLED_HPP__
+
+#include "rp_image_backend.hpp"
+
+namespace LibRpTexture {
+
+/**
+ * rp_image data storage class using a per-thread buffer pool.
+ *
+ * Image data and palette buffers are allocated from size buckets.
+ * When the backend is deleted, its buffers are returned to the
+ * pool of the thread that deleted it, so creating lots of
+ * short-lived images of similar sizes (e.g. animated icon frames
+ * or thumbnail batches) doesn't hit malloc()/free() every time.
+ *
+ * To use this backend, call:
+ * rp_image::setBackendCreatorFn(rp_image_backend_pooled::creator_fn);
+ */
+class rp_image_backend_pooled : public rp_image_backend
+{
+	public:
+		rp_image_backend_pooled(int width, int height, rp_image::Format format);
+		virtual ~rp_image_backend_pooled();
+
+	private:
+		typedef rp_image_backend super;
+		RP_DISABLE_COPY(rp_image_backend_pooled)
+
+	public:
+		/**
+		 * Creator function for rp_image::setBackendCreatorFn().
+		 */
+		static rp_image_backend *creator_fn(int width, int height, rp_image::Format format);
+
+		/**
+		 * Free all buffers cached by the current thread's pool.
+		 * This should be called if the thread is going to be idle
+		 * for a while, e.g. after a batch of thumbnails.
+		 */
+		static void trim(void);
+
+		/**
+		 * Get the total size of all buffers cached by the current thread's pool.
+		 * @return Cached size, in bytes.
+		 */
+		static size_t cached_size(void);
+
+	public:
+		void *data(void) final
+		{
+			return m_data;
+		}
+
+		const void *data(void) const final
+		{
+			return m_data;
+		}
+
+		size_t data_len(void) const final
+		{
+			return m_data_len;
+		}
+
+		uint32_t *palette(void) final
+		{
+			return m_palette;
+		}
+
+		const uint32_t *palette(void) const final
+		{
+			return m_palette;
+		}
+
+		int palette_len(void) const final
+		{
+			return m_palette_len;
+		}
+
+	public:
+		/**
+		 * Shrink image dimensions.
+		 * @param width New width.
+		 * @param height New height.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int shrink(int width, int height) final;
+
+	private:
+		void *m_data;
+		size_t m_data_len;
+		size_t m_data_alloc_len;	// Allocated size. (bucket size)
+
+		uint32_t *m_palette;
+		int m_palette_len;
+		size_t m_palette_alloc_len;	// Allocated size. (bucket size)
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_BACKEND_POOLED_HPP__ */
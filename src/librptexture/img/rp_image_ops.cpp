@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (librptexture)                     *
  * rp_image_ops.cpp: Image class. (operations)                             *
  *                                                                         *
- * Copyright (c) 2016-2020 by David Korth.                                 *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -18,8 +18,36 @@ namespace LibRpTexture {
 
 /** Image operations. **/
 
+/**
+ * Create a copy-on-write view of this rp_image.
+ * The palette, tr_idx, and sBIT are copied.
+ * @param y First row.
+ * @param width View width.
+ * @param height View height.
+ * @return New rp_image, or nullptr if views aren't supported by the image backend.
+ */
+rp_image *rp_image::createView(int y, int width, int height) const
+{
+	RP_D(const rp_image);
+	rp_image_backend *const view = d->backend->createView(y, width, height);
+	if (!view) {
+		return nullptr;
+	}
+
+	rp_image *const img = new rp_image(view);
+	if (d->has_sBIT) {
+		img->set_sBIT(&d->sBIT);
+	}
+	return img;
+}
+
 /**
  * Duplicate the rp_image.
+ *
+ * If supported by the image backend, the new rp_image
+ * will share the image data with this one until either
+ * image is modified. (copy-on-write)
+ *
  * @return New rp_image with a copy of the image data.
  */
 rp_image *rp_image::dup(void) const
@@ -33,7 +61,13 @@ rp_image *rp_image::dup(void) const
 	assert(width > 0);
 	assert(height > 0);
 
-	rp_image *img = new rp_image(width, height, format);
+	// Create a copy-on-write view if possible.
+	rp_image *img = createView(0, width, height);
+	if (img) {
+		return img;
+	}
+
+	img = new rp_image(width, height, format);
 	if (!img->isValid()) {
 		// Image is invalid. Return it immediately.
 		return img;
@@ -326,6 +360,26 @@ rp_image *rp_image::resized(int width, int height, Alignment alignment, uint32_t
 		return this->dup();
 	}
 
+	if (width <= orig_width && height <= orig_height) {
+		// Cropping only. Create a copy-on-write view if possible.
+		int y = 0;
+		switch (alignment & AlignVertical_Mask) {
+			default:
+			case AlignTop:
+				break;
+			case AlignVCenter:
+				y = (orig_height - height) / 2;
+				break;
+			case AlignBottom:
+				y = orig_height - height;
+				break;
+		}
+		rp_image *const img = createView(y, width, height);
+		if (img) {
+			return img;
+		}
+	}
+
 	const rp_image::Format format = backend->format;
 	rp_image *const img = new rp_image(width, height, format);
 	if (!img->isValid()) {
@@ -579,7 +633,7 @@ rp_image *rp_image::flip(FlipOp op) const
 	}
 
 	RP_D(const rp_image);
-	rp_image_backend *const backend = d->backend;
+	const rp_image_backend *const backend = d->backend;
 
 	const int width = backend->width;
 	const int height = backend->height;
@@ -662,15 +716,6 @@ rp_image *rp_image::flip(FlipOp op) const
 		}
 	}
 
-	// If CI8, copy the palette.
-	if (backend->format == Format::CI8) {
-		int entries = std::min(flipimg->palette_len(), d->backend->palette_len());
-		uint32_t *const dest_pal = flipimg->palette();
-		memcpy(dest_pal, d->backend->palette(), entries * sizeof(uint32_t));
-		// Palette is zero-initialized, so we don't need to
-		// zero remaining entries.
-	}
-
 	// If CI8, copy the palette.
 	if (backend->format == rp_image::Format::CI8) {
 		int entries = std::min(flipimg->palette_len(), backend->palette_len());
@@ -0,0 +1,308 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.cpp: Image class. (scaling)                              *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale_p.hpp"
+
+// C includes. (C++ namespace)
+#include <cmath>
+
+// C++ STL classes.
+using std::vector;
+
+namespace LibRpTexture { namespace ImageScale {
+
+/**
+ * Contributor table for one axis.
+ */
+class ContribTable
+{
+	public:
+		/**
+		 * Calculate the contributors for one axis.
+		 * @param src_size	[in] Source size.
+		 * @param dest_size	[in] Destination size.
+		 * @param filter	[in] Scaling filter.
+		 */
+		ContribTable(int src_size, int dest_size, rp_image::ScaleFilter filter);
+
+	private:
+		RP_DISABLE_COPY(ContribTable)
+
+	public:
+		vector<Contrib> contrib;
+
+	private:
+		vector<int16_t> weights;
+};
+
+/**
+ * Calculate the contributors for one axis.
+ * @param src_size	[in] Source size.
+ * @param dest_size	[in] Destination size.
+ * @param filter	[in] Scaling filter.
+ */
+ContribTable::ContribTable(int src_size, int dest_size, rp_image::ScaleFilter filter)
+{
+	assert(src_size > 0);
+	assert(dest_size > 0);
+
+	// Weight offsets are stored in contrib[].weights until
+	// all weights have been calculated, since the vector
+	// may be reallocated.
+	vector<size_t> offsets;
+	contrib.resize(dest_size);
+	offsets.resize(dest_size);
+
+	const double scale = static_cast<double>(dest_size) / static_cast<double>(src_size);
+	// Bilinear: When downscaling, the filter is widened to cover
+	// all source pixels, which prevents aliasing.
+	const double radius = (scale < 1.0) ? (1.0 / scale) : 1.0;
+
+	vector<double> fw;
+	for (int i = 0; i < dest_size; i++) {
+		int first, last;
+		double lo = 0, hi = 0, center = 0;
+		switch (filter) {
+			default:
+				assert(!"Invalid scaling filter.");
+				// fall-through
+			case rp_image::ScaleFilter::Box:
+				// Source area covered by this destination pixel.
+				lo = static_cast<double>(i) / scale;
+				hi = static_cast<double>(i + 1) / scale;
+				first = static_cast<int>(floor(lo));
+				last = static_cast<int>(ceil(hi)) - 1;
+				break;
+
+			case rp_image::ScaleFilter::Bilinear:
+				center = (static_cast<double>(i) + 0.5) / scale;
+				first = static_cast<int>(floor(center - radius));
+				last = static_cast<int>(ceil(center + radius));
+				break;
+		}
+		if (first < 0) {
+			first = 0;
+		}
+		if (last >= src_size) {
+			last = src_size - 1;
+		}
+
+		// Calculate the floating-point weights.
+		fw.clear();
+		double total = 0;
+		for (int j = first; j <= last; j++) {
+			double w;
+			if (filter == rp_image::ScaleFilter::Bilinear) {
+				w = 1.0 - (fabs((static_cast<double>(j) + 0.5) - center) / radius);
+			} else {
+				w = std::min(hi, static_cast<double>(j + 1)) - std::max(lo, static_cast<double>(j));
+			}
+			if (w < 0) {
+				w = 0;
+			}
+			fw.push_back(w);
+			total += w;
+		}
+
+		// Convert to fixed-point, skipping zero weights at the edges.
+		unsigned int start = 0, end = static_cast<unsigned int>(fw.size());
+		vector<int> iw(fw.size());
+		int isum = 0, imax = 0;
+		unsigned int imax_idx = 0;
+		for (unsigned int j = 0; j < end; j++) {
+			iw[j] = (total > 0)
+				? static_cast<int>(floor((fw[j] / total) * (1 << RP_IMAGE_SCALE_WEIGHT_BITS) + 0.5))
+				: 0;
+			isum += iw[j];
+			if (iw[j] > imax) {
+				imax = iw[j];
+				imax_idx = j;
+			}
+		}
+		if (isum == 0) {
+			// Shouldn't happen, but make sure there's at least one pixel.
+			iw[0] = 0;
+			imax_idx = 0;
+		}
+		// Make sure the weights add up to exactly 1.0.
+		iw[imax_idx] += (1 << RP_IMAGE_SCALE_WEIGHT_BITS) - isum;
+		while (start < end - 1 && iw[start] == 0) {
+			start++;
+		}
+		while (end - 1 > start && iw[end - 1] == 0) {
+			end--;
+		}
+
+		contrib[i].first = first + start;
+		contrib[i].count = static_cast<int>(end - start);
+		offsets[i] = weights.size();
+		for (unsigned int j = start; j < end; j++) {
+			weights.push_back(static_cast<int16_t>(iw[j]));
+		}
+	}
+
+	// Set the weight pointers.
+	for (int i = 0; i < dest_size; i++) {
+		contrib[i].weights = &weights[offsets[i]];
+	}
+}
+
+/**
+ * Scale an rp_image using the specified row scaling functions.
+ * @param img		[in] Source image.
+ * @param width		[in] New width.
+ * @param height	[in] New height.
+ * @param filter	[in] Scaling filter.
+ * @param hscale_row	[in] Horizontal row scaling function.
+ * @param vscale_row	[in] Vertical row scaling function.
+ * @return New ARGB32 rp_image, or nullptr on error.
+ */
+rp_image *scale(const rp_image *img, int width, int height, rp_image::ScaleFilter filter,
+	hscale_row_fn hscale_row, vscale_row_fn vscale_row)
+{
+	assert(width > 0);
+	assert(height > 0);
+	if (width <= 0 || height <= 0 || !img->isValid()) {
+		return nullptr;
+	}
+
+	// Work on a premultiplied ARGB32 copy of the image.
+	// NOTE: dup_ARGB32() copies the sBIT metadata.
+	rp_image *const src = img->dup_ARGB32();
+	if (!src) {
+		return nullptr;
+	}
+	rp_image::sBIT_t sBIT;
+	const bool has_sBIT = (src->get_sBIT(&sBIT) == 0);
+	// If sBIT indicates the image doesn't have an alpha channel,
+	// premultiplication isn't needed.
+	const bool has_alpha = (!has_sBIT || sBIT.alpha != 0);
+	const int src_width = src->width();
+	const int src_height = src->height();
+	if (has_alpha) {
+		src->premultiply();
+
+		// premultiply() leaves fully transparent pixels as-is.
+		// Clear them so their color doesn't affect the result.
+		for (int y = 0; y < src_height; y++) {
+			uint32_t *px = static_cast<uint32_t*>(src->scanLine(y));
+			for (int x = src_width; x > 0; x--, px++) {
+				if ((*px & 0xFF000000U) == 0) {
+					*px = 0;
+				}
+			}
+		}
+	}
+
+	// Horizontal pass: (src_width x src_height) -> (width x src_height)
+	// If the width isn't changing, the source image is used as-is.
+	vector<uint32_t> hbuf;
+	const uint32_t *hpx;
+	int hpx_stride;
+	if (width == src_width) {
+		hpx = static_cast<const uint32_t*>(src->bits());
+		hpx_stride = src->stride() / sizeof(uint32_t);
+	} else {
+		const ContribTable htable(src_width, width, filter);
+		hbuf.resize(static_cast<size_t>(width) * src_height);
+		uint32_t *dest = hbuf.data();
+		for (int y = 0; y < src_height; y++, dest += width) {
+			hscale_row(dest, static_cast<const uint32_t*>(src->scanLine(y)),
+				htable.contrib.data(), width);
+		}
+		hpx = hbuf.data();
+		hpx_stride = width;
+	}
+
+	// Vertical pass: (width x src_height) -> (width x height)
+	rp_image *const dest_img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!dest_img->isValid()) {
+		// Could not allocate the image.
+		dest_img->unref();
+		src->unref();
+		return nullptr;
+	}
+	const ContribTable vtable(src_height, height, filter);
+	for (int y = 0; y < height; y++) {
+		const Contrib &c = vtable.contrib[y];
+		vscale_row(static_cast<uint32_t*>(dest_img->scanLine(y)),
+			&hpx[static_cast<size_t>(c.first) * hpx_stride], hpx_stride, c, width);
+	}
+	src->unref();
+
+	if (has_alpha) {
+		dest_img->un_premultiply();
+	}
+	if (has_sBIT) {
+		dest_img->set_sBIT(&sBIT);
+	}
+	return dest_img;
+}
+
+/**
+ * Scale a row of ARGB32 pixels horizontally.
+ * Standard version using regular C++ code.
+ * @param dest		[out] Destination row.
+ * @param src		[in] Source row.
+ * @param contrib	[in] Contributors for each destination pixel.
+ * @param dest_width	[in] Destination width.
+ */
+void hscale_row_cpp(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	const Contrib *RESTRICT contrib, int dest_width)
+{
+	for (; dest_width > 0; dest_width--, dest++, contrib++) {
+		// NOTE: Contributing pixels are consecutive, so this is
+		// the same as vertical scaling with a stride of 1.
+		*dest = vscale_pixel(&src[contrib->first], 1, *contrib);
+	}
+}
+
+/**
+ * Scale a row of ARGB32 pixels vertically.
+ * Standard version using regular C++ code.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First contributing source row.
+ * @param src_stride	[in] Source stride, in pixels.
+ * @param contrib	[in] Contributors for this row.
+ * @param width		[in] Row width.
+ */
+void vscale_row_cpp(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	int src_stride, const Contrib &contrib, int width)
+{
+	for (; width > 0; width--, dest++, src++) {
+		*dest = vscale_pixel(src, src_stride, contrib);
+	}
+}
+
+} }
+
+namespace LibRpTexture {
+
+/**
+ * Scale the rp_image.
+ * Standard version using regular C++ code.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. Filtering is done using premultiplied alpha,
+ * so the color of transparent pixels doesn't bleed into
+ * the surrounding pixels.
+ *
+ * @param width New width
+ * @param height New height
+ * @param filter Scaling filter
+ * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image *rp_image::scaled_cpp(int width, int height, ScaleFilter filter) const
+{
+	return ImageScale::scale(this, width, height, filter,
+		ImageScale::hscale_row_cpp, ImageScale::vscale_row_cpp);
+}
+
+}
@@ -0,0 +1,121 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.cpp: Image class. (scaling)                              *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale_p.hpp"
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+namespace LibRpTexture { namespace ImageScale {
+
+/**
+ * Pack a pair of filter weights for _mm256_madd_epi16().
+ * @param w0 First weight.
+ * @param w1 Second weight.
+ * @return Packed weights. (w0, w1, w0, w1, ...)
+ */
+static FORCEINLINE __m256i pack_weights_avx2(int16_t w0, int16_t w1)
+{
+	return _mm256_set1_epi32(static_cast<int>(
+		static_cast<uint16_t>(w0) | (static_cast<uint32_t>(static_cast<uint16_t>(w1)) << 16)));
+}
+
+/**
+ * Scale a row of ARGB32 pixels vertically.
+ * AVX2-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First contributing source row.
+ * @param src_stride	[in] Source stride, in pixels.
+ * @param contrib	[in] Contributors for this row.
+ * @param width		[in] Row width.
+ */
+void vscale_row_avx2(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	int src_stride, const Contrib &contrib, int width)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i round = _mm256_set1_epi32(1 << (RP_IMAGE_SCALE_WEIGHT_BITS - 1));
+
+	// Process 8 pixels per iteration using AVX2.
+	// NOTE: Source rows aren't necessarily 32-byte aligned.
+	// NOTE 2: AVX2 unpack and pack instructions operate on each
+	// 128-bit lane separately, but since the results are packed
+	// using the same lane layout, the pixel order is preserved.
+	unsigned int x = static_cast<unsigned int>(width);
+	for (; x > 7; x -= 8, dest += 8, src += 8) {
+		__m256i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+		const uint32_t *px = src;
+		const int16_t *w = contrib.weights;
+
+		// Process two source rows per iteration.
+		int i = contrib.count;
+		for (; i > 0; i -= 2, px += (src_stride * 2), w += 2) {
+			const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(px));
+			__m256i b, wv;
+			if (i > 1) {
+				b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(px + src_stride));
+				wv = pack_weights_avx2(w[0], w[1]);
+			} else {
+				// Remaining row.
+				b = zero;
+				wv = pack_weights_avx2(w[0], 0);
+			}
+
+			const __m256i a_lo = _mm256_unpacklo_epi8(a, zero);
+			const __m256i b_lo = _mm256_unpacklo_epi8(b, zero);
+			const __m256i a_hi = _mm256_unpackhi_epi8(a, zero);
+			const __m256i b_hi = _mm256_unpackhi_epi8(b, zero);
+			acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi16(a_lo, b_lo), wv));
+			acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi16(a_lo, b_lo), wv));
+			acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi16(a_hi, b_hi), wv));
+			acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi16(a_hi, b_hi), wv));
+		}
+
+		acc0 = _mm256_srai_epi32(acc0, RP_IMAGE_SCALE_WEIGHT_BITS);
+		acc1 = _mm256_srai_epi32(acc1, RP_IMAGE_SCALE_WEIGHT_BITS);
+		acc2 = _mm256_srai_epi32(acc2, RP_IMAGE_SCALE_WEIGHT_BITS);
+		acc3 = _mm256_srai_epi32(acc3, RP_IMAGE_SCALE_WEIGHT_BITS);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest),
+			_mm256_packus_epi16(_mm256_packs_epi32(acc0, acc1), _mm256_packs_epi32(acc2, acc3)));
+	}
+
+	// Remaining pixels.
+	for (; x > 0; x--, dest++, src++) {
+		*dest = vscale_pixel(src, src_stride, contrib);
+	}
+}
+
+} }
+
+namespace LibRpTexture {
+
+/**
+ * Scale the rp_image.
+ * AVX2-optimized version.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. Filtering is done using premultiplied alpha,
+ * so the color of transparent pixels doesn't bleed into
+ * the surrounding pixels.
+ *
+ * @param width New width
+ * @param height New height
+ * @param filter Scaling filter
+ * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image *rp_image::scaled_avx2(int width, int height, ScaleFilter filter) const
+{
+	// NOTE: The horizontal pass gathers pixels individually,
+	// so the SSE2 version is used for that.
+	return ImageScale::scale(this, width, height, filter,
+		ImageScale::hscale_row_sse2, ImageScale::vscale_row_avx2);
+}
+
+}
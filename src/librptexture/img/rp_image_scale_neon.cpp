@@ -0,0 +1,122 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.cpp: Image class. (scaling)                              *
+ * NEON-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale_p.hpp"
+
+// NOTE: On 32-bit ARM, NEON is only used if it's
+// part of the compiler's baseline.
+#ifdef RP_IMAGE_HAS_NEON
+
+// NEON intrinsics.
+#include <arm_neon.h>
+
+namespace LibRpTexture { namespace ImageScale {
+
+/**
+ * Scale a row of ARGB32 pixels horizontally.
+ * NEON-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] Source row.
+ * @param contrib	[in] Contributors for each destination pixel.
+ * @param dest_width	[in] Destination width.
+ */
+void hscale_row_neon(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	const Contrib *RESTRICT contrib, int dest_width)
+{
+	for (; dest_width > 0; dest_width--, dest++, contrib++) {
+		const uint32_t *px = &src[contrib->first];
+		const int16_t *w = contrib->weights;
+		uint32x4_t acc = vdupq_n_u32(0);
+
+		for (int i = contrib->count; i > 0; i--, px++, w++) {
+			const uint16x4_t p = vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(*px))));
+			acc = vmlal_n_u16(acc, p, static_cast<uint16_t>(*w));
+		}
+
+		// vrshrn_n_u32() does the rounding and narrowing.
+		const uint16x4_t res = vrshrn_n_u32(acc, RP_IMAGE_SCALE_WEIGHT_BITS);
+		*dest = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(res, res))), 0);
+	}
+}
+
+/**
+ * Scale a row of ARGB32 pixels vertically.
+ * NEON-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First contributing source row.
+ * @param src_stride	[in] Source stride, in pixels.
+ * @param contrib	[in] Contributors for this row.
+ * @param width		[in] Row width.
+ */
+void vscale_row_neon(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	int src_stride, const Contrib &contrib, int width)
+{
+	// Process 4 pixels per iteration using NEON.
+	unsigned int x = static_cast<unsigned int>(width);
+	for (; x > 3; x -= 4, dest += 4, src += 4) {
+		uint32x4_t acc0 = vdupq_n_u32(0), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+		const uint32_t *px = src;
+		const int16_t *w = contrib.weights;
+
+		for (int i = contrib.count; i > 0; i--, px += src_stride, w++) {
+			const uint8x16_t p = vld1q_u8(reinterpret_cast<const uint8_t*>(px));
+			const uint16x8_t p_lo = vmovl_u8(vget_low_u8(p));
+			const uint16x8_t p_hi = vmovl_u8(vget_high_u8(p));
+			const uint16_t wv = static_cast<uint16_t>(*w);
+			acc0 = vmlal_n_u16(acc0, vget_low_u16(p_lo), wv);
+			acc1 = vmlal_n_u16(acc1, vget_high_u16(p_lo), wv);
+			acc2 = vmlal_n_u16(acc2, vget_low_u16(p_hi), wv);
+			acc3 = vmlal_n_u16(acc3, vget_high_u16(p_hi), wv);
+		}
+
+		const uint16x8_t res_lo = vcombine_u16(
+			vrshrn_n_u32(acc0, RP_IMAGE_SCALE_WEIGHT_BITS),
+			vrshrn_n_u32(acc1, RP_IMAGE_SCALE_WEIGHT_BITS));
+		const uint16x8_t res_hi = vcombine_u16(
+			vrshrn_n_u32(acc2, RP_IMAGE_SCALE_WEIGHT_BITS),
+			vrshrn_n_u32(acc3, RP_IMAGE_SCALE_WEIGHT_BITS));
+		vst1q_u8(reinterpret_cast<uint8_t*>(dest),
+			vcombine_u8(vmovn_u16(res_lo), vmovn_u16(res_hi)));
+	}
+
+	// Remaining pixels.
+	for (; x > 0; x--, dest++, src++) {
+		*dest = vscale_pixel(src, src_stride, contrib);
+	}
+}
+
+} }
+
+namespace LibRpTexture {
+
+/**
+ * Scale the rp_image.
+ * NEON-optimized version.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. Filtering is done using premultiplied alpha,
+ * so the color of transparent pixels doesn't bleed into
+ * the surrounding pixels.
+ *
+ * @param width New width
+ * @param height New height
+ * @param filter Scaling filter
+ * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image *rp_image::scaled_neon(int width, int height, ScaleFilter filter) const
+{
+	return ImageScale::scale(this, width, height, filter,
+		ImageScale::hscale_row_neon, ImageScale::vscale_row_neon);
+}
+
+}
+
+#endif /* RP_IMAGE_HAS_NEON */
@@ -0,0 +1,121 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale_p.hpp: Image class. (scaling, internal functions)        *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_SCALE_P_HPP__
+#define __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_SCALE_P_HPP__
+
+#include "rp_image.hpp"
+
+namespace LibRpTexture { namespace ImageScale {
+
+// Filter weights are fixed-point values with WEIGHT_BITS fractional bits.
+// The weights for each destination pixel add up to exactly (1 << WEIGHT_BITS),
+// so the weighted sum of 8-bit components always fits in 8 bits.
+// NOTE: Weights must fit in int16_t for the SSE2 pmaddwd instruction.
+#define RP_IMAGE_SCALE_WEIGHT_BITS 14
+
+/**
+ * Source pixels that contribute to a destination pixel.
+ */
+struct Contrib {
+	int first;		// First source pixel.
+	int count;		// Number of source pixels.
+	const int16_t *weights;	// Filter weights. [count]
+};
+
+/**
+ * Scale a row of ARGB32 pixels horizontally.
+ * @param dest		[out] Destination row.
+ * @param src		[in] Source row.
+ * @param contrib	[in] Contributors for each destination pixel.
+ * @param dest_width	[in] Destination width.
+ */
+typedef void (*hscale_row_fn)(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	const Contrib *RESTRICT contrib, int dest_width);
+
+/**
+ * Scale a row of ARGB32 pixels vertically.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First contributing source row.
+ * @param src_stride	[in] Source stride, in pixels.
+ * @param contrib	[in] Contributors for this row.
+ * @param width		[in] Row width.
+ */
+typedef void (*vscale_row_fn)(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	int src_stride, const Contrib &contrib, int width);
+
+/**
+ * Scale an rp_image using the specified row scaling functions.
+ * @param img		[in] Source image.
+ * @param width		[in] New width.
+ * @param height	[in] New height.
+ * @param filter	[in] Scaling filter.
+ * @param hscale_row	[in] Horizontal row scaling function.
+ * @param vscale_row	[in] Vertical row scaling function.
+ * @return New ARGB32 rp_image, or nullptr on error.
+ */
+rp_image *scale(const rp_image *img, int width, int height, rp_image::ScaleFilter filter,
+	hscale_row_fn hscale_row, vscale_row_fn vscale_row);
+
+/**
+ * Scale a single ARGB32 pixel vertically.
+ * Used for the remaining pixels in the SIMD row functions.
+ * @param src		[in] Source pixel in the first contributing row.
+ * @param src_stride	[in] Source stride, in pixels.
+ * @param contrib	[in] Contributors for this row.
+ * @return Scaled pixel.
+ */
+static inline uint32_t vscale_pixel(const uint32_t *src, int src_stride, const Contrib &contrib)
+{
+	unsigned int b = 1U << (RP_IMAGE_SCALE_WEIGHT_BITS - 1);
+	unsigned int g = b, r = b, a = b;
+	for (int i = 0; i < contrib.count; i++, src += src_stride) {
+		const unsigned int w = static_cast<unsigned int>(contrib.weights[i]);
+		const uint32_t px = *src;
+		b += ( px        & 0xFF) * w;
+		g += ((px >>  8) & 0xFF) * w;
+		r += ((px >> 16) & 0xFF) * w;
+		a += ( px >> 24        ) * w;
+	}
+	return  (b >> RP_IMAGE_SCALE_WEIGHT_BITS) |
+	       ((g >> RP_IMAGE_SCALE_WEIGHT_BITS) <<  8) |
+	       ((r >> RP_IMAGE_SCALE_WEIGHT_BITS) << 16) |
+	       ((a >> RP_IMAGE_SCALE_WEIGHT_BITS) << 24);
+}
+
+/** Row scaling functions **/
+
+void hscale_row_cpp(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	const Contrib *RESTRICT contrib, int dest_width);
+void vscale_row_cpp(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	int src_stride, const Contrib &contrib, int width);
+
+#ifdef RP_IMAGE_HAS_SSE2
+void hscale_row_sse2(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	const Contrib *RESTRICT contrib, int dest_width);
+void vscale_row_sse2(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	int src_stride, const Contrib &contrib, int width);
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+// NOTE: The horizontal pass gathers pixels individually,
+// so AVX2 uses the SSE2 version for that.
+void vscale_row_avx2(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	int src_stride, const Contrib &contrib, int width);
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+#ifdef RP_IMAGE_HAS_NEON
+void hscale_row_neon(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	const Contrib *RESTRICT contrib, int dest_width);
+void vscale_row_neon(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	int src_stride, const Contrib &contrib, int width);
+#endif /* RP_IMAGE_HAS_NEON */
+
+} }
+
+#endif /* __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_SCALE_P_HPP__ */
@@ -0,0 +1,157 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.cpp: Image class. (scaling)                              *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale_p.hpp"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+
+namespace LibRpTexture { namespace ImageScale {
+
+/**
+ * Pack a pair of filter weights for _mm_madd_epi16().
+ * @param w0 First weight.
+ * @param w1 Second weight.
+ * @return Packed weights. (w0, w1, w0, w1, ...)
+ */
+static FORCEINLINE __m128i pack_weights_sse2(int16_t w0, int16_t w1)
+{
+	return _mm_set1_epi32(static_cast<int>(
+		static_cast<uint16_t>(w0) | (static_cast<uint32_t>(static_cast<uint16_t>(w1)) << 16)));
+}
+
+/**
+ * Scale a row of ARGB32 pixels horizontally.
+ * SSE2-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] Source row.
+ * @param contrib	[in] Contributors for each destination pixel.
+ * @param dest_width	[in] Destination width.
+ */
+void hscale_row_sse2(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	const Contrib *RESTRICT contrib, int dest_width)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(1 << (RP_IMAGE_SCALE_WEIGHT_BITS - 1));
+
+	for (; dest_width > 0; dest_width--, dest++, contrib++) {
+		const uint32_t *px = &src[contrib->first];
+		const int16_t *w = contrib->weights;
+		__m128i acc = round;
+
+		// Process two source pixels per iteration.
+		int i = contrib->count;
+		for (; i > 1; i -= 2, px += 2, w += 2) {
+			// Interleave the components of both pixels so
+			// pmaddwd can apply both weights at once.
+			__m128i p = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(px)), zero);
+			p = _mm_unpacklo_epi16(p, _mm_srli_si128(p, 8));
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(p, pack_weights_sse2(w[0], w[1])));
+		}
+		if (i > 0) {
+			// Remaining pixel.
+			__m128i p = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(*px)), zero);
+			p = _mm_unpacklo_epi16(p, zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(p, pack_weights_sse2(w[0], 0)));
+		}
+
+		acc = _mm_srai_epi32(acc, RP_IMAGE_SCALE_WEIGHT_BITS);
+		acc = _mm_packs_epi32(acc, acc);
+		*dest = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(acc, acc)));
+	}
+}
+
+/**
+ * Scale a row of ARGB32 pixels vertically.
+ * SSE2-optimized version.
+ * @param dest		[out] Destination row.
+ * @param src		[in] First contributing source row.
+ * @param src_stride	[in] Source stride, in pixels.
+ * @param contrib	[in] Contributors for this row.
+ * @param width		[in] Row width.
+ */
+void vscale_row_sse2(uint32_t *RESTRICT dest, const uint32_t *RESTRICT src,
+	int src_stride, const Contrib &contrib, int width)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(1 << (RP_IMAGE_SCALE_WEIGHT_BITS - 1));
+
+	// Process 4 pixels per iteration using SSE2.
+	// NOTE: Source rows aren't necessarily 16-byte aligned.
+	unsigned int x = static_cast<unsigned int>(width);
+	for (; x > 3; x -= 4, dest += 4, src += 4) {
+		__m128i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+		const uint32_t *px = src;
+		const int16_t *w = contrib.weights;
+
+		// Process two source rows per iteration.
+		int i = contrib.count;
+		for (; i > 0; i -= 2, px += (src_stride * 2), w += 2) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(px));
+			__m128i b, wv;
+			if (i > 1) {
+				b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(px + src_stride));
+				wv = pack_weights_sse2(w[0], w[1]);
+			} else {
+				// Remaining row.
+				b = zero;
+				wv = pack_weights_sse2(w[0], 0);
+			}
+
+			const __m128i a_lo = _mm_unpacklo_epi8(a, zero);
+			const __m128i b_lo = _mm_unpacklo_epi8(b, zero);
+			const __m128i a_hi = _mm_unpackhi_epi8(a, zero);
+			const __m128i b_hi = _mm_unpackhi_epi8(b, zero);
+			acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(a_lo, b_lo), wv));
+			acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(a_lo, b_lo), wv));
+			acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(a_hi, b_hi), wv));
+			acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(a_hi, b_hi), wv));
+		}
+
+		acc0 = _mm_srai_epi32(acc0, RP_IMAGE_SCALE_WEIGHT_BITS);
+		acc1 = _mm_srai_epi32(acc1, RP_IMAGE_SCALE_WEIGHT_BITS);
+		acc2 = _mm_srai_epi32(acc2, RP_IMAGE_SCALE_WEIGHT_BITS);
+		acc3 = _mm_srai_epi32(acc3, RP_IMAGE_SCALE_WEIGHT_BITS);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest),
+			_mm_packus_epi16(_mm_packs_epi32(acc0, acc1), _mm_packs_epi32(acc2, acc3)));
+	}
+
+	// Remaining pixels.
+	for (; x > 0; x--, dest++, src++) {
+		*dest = vscale_pixel(src, src_stride, contrib);
+	}
+}
+
+} }
+
+namespace LibRpTexture {
+
+/**
+ * Scale the rp_image.
+ * SSE2-optimized version.
+ *
+ * A new ARGB32 rp_image will be created with the specified
+ * dimensions. Filtering is done using premultiplied alpha,
+ * so the color of transparent pixels doesn't bleed into
+ * the surrounding pixels.
+ *
+ * @param width New width
+ * @param height New height
+ * @param filter Scaling filter
+ * @return New ARGB32 rp_image with a scaled version of the original, or nullptr on error.
+ */
+rp_image *rp_image::scaled_sse2(int width, int height, ScaleFilter filter) const
+{
+	return ImageScale::scale(this, width, height, filter,
+		ImageScale::hscale_row_sse2, ImageScale::vscale_row_sse2);
+}
+
+}
@@ -0,0 +1,188 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * un-premultiply_avx2.cpp: Un-premultiply function.                       *
+ * AVX2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_p.hpp"
+#include "rp_image_backend.hpp"
+
+// AVX2 intrinsics.
+#include <immintrin.h>
+
+// Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
+#define rp_imagePrivate rp_image_private
+
+namespace LibRpTexture {
+
+/**
+ * Get a mask of ARGB32 pixels that are either fully opaque or fully transparent.
+ * These pixels are left as-is by both premultiply and un-premultiply.
+ * @param alpha	[in] Alpha values of 8 ARGB32 pixels, as 32-bit integers.
+ * @return Mask with all bits set for pixels with alpha == 0 or alpha == 255.
+ */
+static FORCEINLINE __m256i alpha_0_or_FF_mask_avx2(__m256i alpha)
+{
+	return _mm256_or_si256(
+		_mm256_cmpeq_epi32(alpha, _mm256_setzero_si256()),
+		_mm256_cmpeq_epi32(alpha, _mm256_set1_epi32(0xFF)));
+}
+
+/**
+ * Un-premultiply 8 ARGB32 pixels. (AVX2 version)
+ * Based on Qt 5.9.1's qUnpremultiply().
+ *
+ * This is needed in order to convert DXT2/3 to DXT4/5.
+ *
+ * @param px	[in/out] 8 ARGB32 pixels to un-premultiply, in place.
+ */
+static FORCEINLINE void un_premultiply_8px_avx2(uint32_t *px)
+{
+	const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(px));
+	const __m256i alpha = _mm256_srli_epi32(v, 24);
+
+	// Look up the inverted pre-multiplication factors.
+	const __m256i invAlpha = _mm256_i32gather_epi32(
+		reinterpret_cast<const int*>(rp_image::qt_inv_premul_factor), alpha, 4);
+	const __m256i mask_FF = _mm256_set1_epi32(0xFF);
+	const __m256i round = _mm256_set1_epi32(0x8000);
+
+	// (p*(0x00ff00ff/alpha)) >> 16 == (p*255)/alpha for all p and alpha <= 256.
+	// We add 0x8000 to get even rounding.
+	// NOTE: The C++ version truncates the result to 8 bits.
+	// NOTE 2: The product can't overflow 32 bits. (255 * 0x00FF00FF + 0x8000)
+	__m256i b = _mm256_and_si256(v, mask_FF);
+	__m256i g = _mm256_and_si256(_mm256_srli_epi32(v, 8), mask_FF);
+	__m256i r = _mm256_and_si256(_mm256_srli_epi32(v, 16), mask_FF);
+	b = _mm256_and_si256(_mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(b, invAlpha), round), 16), mask_FF);
+	g = _mm256_and_si256(_mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(g, invAlpha), round), 16), mask_FF);
+	r = _mm256_and_si256(_mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(r, invAlpha), round), 16), mask_FF);
+
+	__m256i res = _mm256_or_si256(b, _mm256_slli_epi32(g, 8));
+	res = _mm256_or_si256(res, _mm256_slli_epi32(r, 16));
+	res = _mm256_or_si256(res, _mm256_slli_epi32(alpha, 24));
+
+	// Pixels with alpha == 0 or alpha == 255 are left as-is.
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(px),
+		_mm256_blendv_epi8(res, v, alpha_0_or_FF_mask_avx2(alpha)));
+}
+
+/**
+ * Premultiply 8 ARGB32 pixels. (AVX2 version)
+ * Based on Qt 5.9.1's qPremultiply().
+ *
+ * This is needed in order to use the Cairo graphics library.
+ *
+ * @param px	[in/out] 8 ARGB32 pixels to premultiply, in place.
+ */
+static FORCEINLINE void premultiply_8px_avx2(uint32_t *px)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i round = _mm256_set1_epi16(0x80);
+	const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(px));
+
+	// Expand to 16-bit and copy each pixel's alpha value to all four words.
+	// NOTE: AVX2 unpack and pack instructions operate on each
+	// 128-bit lane separately, so the pixel order is preserved.
+	__m256i lo = _mm256_unpacklo_epi8(v, zero);
+	__m256i hi = _mm256_unpackhi_epi8(v, zero);
+	const __m256i a_lo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+	const __m256i a_hi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+
+	// t = c * a; c' = (t + (t >> 8) + 0x80) >> 8
+	// NOTE: This can't overflow 16 bits. (max is 0xFF7F)
+	lo = _mm256_mullo_epi16(lo, a_lo);
+	hi = _mm256_mullo_epi16(hi, a_hi);
+	lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), round), 8);
+	hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), round), 8);
+	__m256i res = _mm256_packus_epi16(lo, hi);
+
+	// Restore the original alpha channel.
+	res = _mm256_blendv_epi8(res, v, _mm256_set1_epi32(0xFF000000U));
+
+	// Pixels with alpha == 0 or alpha == 255 are left as-is.
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(px),
+		_mm256_blendv_epi8(res, v, alpha_0_or_FF_mask_avx2(_mm256_srli_epi32(v, 24))));
+}
+
+/**
+ * Process an ARGB32 rp_image using an 8-pixel AVX2 function.
+ * @tparam pxfunc 8-pixel function.
+ * @param backend rp_image_backend.
+ */
+template<void (*pxfunc)(uint32_t *px)>
+static inline void T_process_argb32_avx2(rp_image_backend *backend)
+{
+	// NOTE: Rows might not be 32-byte aligned.
+	const int width = backend->width;
+	uint32_t *px_dest = static_cast<uint32_t*>(backend->data());
+	const int dest_stride_adj = (backend->stride / sizeof(*px_dest)) - width;
+	for (int y = backend->height; y > 0; y--, px_dest += dest_stride_adj) {
+		// Process 8 pixels per iteration using AVX2.
+		int x = width;
+		for (; x > 7; x -= 8, px_dest += 8) {
+			pxfunc(px_dest);
+		}
+
+		// Remaining pixels.
+		// Use a temporary buffer so the same function can be used.
+		if (x > 0) {
+			uint32_t tmp[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+			memcpy(tmp, px_dest, x * sizeof(uint32_t));
+			pxfunc(tmp);
+			memcpy(px_dest, tmp, x * sizeof(uint32_t));
+			px_dest += x;
+		}
+	}
+}
+
+/**
+ * Un-premultiply an ARGB32 rp_image.
+ * AVX2-optimized version.
+ *
+ * Image must be ARGB32.
+ *
+ * @return 0 on success; non-zero on error.
+ */
+int rp_image::un_premultiply_avx2(void)
+{
+	RP_D(const rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == rp_image::Format::ARGB32);
+	if (backend->format != rp_image::Format::ARGB32) {
+		// Incorrect format...
+		return -1;
+	}
+
+	T_process_argb32_avx2<un_premultiply_8px_avx2>(backend);
+	return 0;
+}
+
+/**
+ * Premultiply an ARGB32 rp_image.
+ * AVX2-optimized version.
+ *
+ * Image must be ARGB32.
+ *
+ * @return 0 on success; non-zero on error.
+ */
+int rp_image::premultiply_avx2(void)
+{
+	RP_D(const rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == rp_image::Format::ARGB32);
+	if (backend->format != rp_image::Format::ARGB32) {
+		// Incorrect format...
+		return -1;
+	}
+
+	T_process_argb32_avx2<premultiply_8px_avx2>(backend);
+	return 0;
+}
+
+}
@@ -0,0 +1,190 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * un-premultiply_neon.cpp: Un-premultiply function.                       *
+ * NEON-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2017-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_p.hpp"
+#include "rp_image_backend.hpp"
+
+// NOTE: On 32-bit ARM, NEON is only used if it's
+// part of the compiler's baseline.
+#ifdef RP_IMAGE_HAS_NEON
+
+// NEON intrinsics.
+#include <arm_neon.h>
+
+// Workaround for RP_D() expecting the no-underscore, UpperCamelCase naming convention.
+#define rp_imagePrivate rp_image_private
+
+namespace LibRpTexture {
+
+/**
+ * Get a mask of ARGB32 pixels that are either fully opaque or fully transparent.
+ * These pixels are left as-is by both premultiply and un-premultiply.
+ * @param px	[in] 4 ARGB32 pixels.
+ * @return Mask with all bits set for pixels with alpha == 0 or alpha == 255.
+ */
+static FORCEINLINE uint32x4_t alpha_0_or_FF_mask_neon(uint32x4_t px)
+{
+	const uint32x4_t alpha = vshrq_n_u32(px, 24);
+	return vorrq_u32(vceqq_u32(alpha, vdupq_n_u32(0)), vceqq_u32(alpha, vdupq_n_u32(255)));
+}
+
+/**
+ * Un-premultiply 4 ARGB32 pixels. (NEON version)
+ * Based on Qt 5.9.1's qUnpremultiply().
+ *
+ * This is needed in order to convert DXT2/3 to DXT4/5.
+ *
+ * @param px	[in/out] 4 ARGB32 pixels to un-premultiply, in place.
+ */
+static FORCEINLINE void un_premultiply_4px_neon(uint32_t *px)
+{
+	const uint32x4_t v = vld1q_u32(px);
+
+	// NEON doesn't have a gather instruction, so the
+	// inverted pre-multiplication factors are loaded
+	// from the table one at a time.
+	const uint32_t inv[4] = {
+		rp_image::qt_inv_premul_factor[px[0] >> 24],
+		rp_image::qt_inv_premul_factor[px[1] >> 24],
+		rp_image::qt_inv_premul_factor[px[2] >> 24],
+		rp_image::qt_inv_premul_factor[px[3] >> 24],
+	};
+	const uint32x4_t invAlpha = vld1q_u32(inv);
+	const uint32x4_t mask_FF = vdupq_n_u32(0xFF);
+	const uint32x4_t round = vdupq_n_u32(0x8000);
+
+	// (p*(0x00ff00ff/alpha)) >> 16 == (p*255)/alpha for all p and alpha <= 256.
+	// We add 0x8000 to get even rounding.
+	// NOTE: The C++ version truncates the result to 8 bits.
+	uint32x4_t b = vandq_u32(v, mask_FF);
+	uint32x4_t g = vandq_u32(vshrq_n_u32(v, 8), mask_FF);
+	uint32x4_t r = vandq_u32(vshrq_n_u32(v, 16), mask_FF);
+	b = vandq_u32(vshrq_n_u32(vmlaq_u32(round, b, invAlpha), 16), mask_FF);
+	g = vandq_u32(vshrq_n_u32(vmlaq_u32(round, g, invAlpha), 16), mask_FF);
+	r = vandq_u32(vshrq_n_u32(vmlaq_u32(round, r, invAlpha), 16), mask_FF);
+
+	uint32x4_t res = vorrq_u32(b, vshlq_n_u32(g, 8));
+	res = vorrq_u32(res, vshlq_n_u32(r, 16));
+	res = vorrq_u32(res, vandq_u32(v, vdupq_n_u32(0xFF000000U)));
+
+	// Pixels with alpha == 0 or alpha == 255 are left as-is.
+	vst1q_u32(px, vbslq_u32(alpha_0_or_FF_mask_neon(v), v, res));
+}
+
+/**
+ * Premultiply 4 ARGB32 pixels. (NEON version)
+ * Based on Qt 5.9.1's qPremultiply().
+ *
+ * This is needed in order to use the Cairo graphics library.
+ *
+ * @param px	[in/out] 4 ARGB32 pixels to premultiply, in place.
+ */
+static FORCEINLINE void premultiply_4px_neon(uint32_t *px)
+{
+	const uint32x4_t v = vld1q_u32(px);
+	const uint8x16_t v8 = vreinterpretq_u8_u32(v);
+
+	// Copy each pixel's alpha value to all four bytes.
+	const uint8x16_t alpha8 = vreinterpretq_u8_u32(
+		vmulq_n_u32(vshrq_n_u32(v, 24), 0x01010101U));
+
+	// t = c * a; c' = (t + (t >> 8) + 0x80) >> 8
+	// vraddhn_u16() does the final addition, rounding, and narrowing.
+	const uint16x8_t t_lo = vmull_u8(vget_low_u8(v8), vget_low_u8(alpha8));
+	const uint16x8_t t_hi = vmull_u8(vget_high_u8(v8), vget_high_u8(alpha8));
+	const uint8x16_t res8 = vcombine_u8(
+		vraddhn_u16(t_lo, vshrq_n_u16(t_lo, 8)),
+		vraddhn_u16(t_hi, vshrq_n_u16(t_hi, 8)));
+
+	// Restore the original alpha channel.
+	uint32x4_t res = vbslq_u32(vdupq_n_u32(0xFF000000U), v, vreinterpretq_u32_u8(res8));
+
+	// Pixels with alpha == 0 or alpha == 255 are left as-is.
+	vst1q_u32(px, vbslq_u32(alpha_0_or_FF_mask_neon(v), v, res));
+}
+
+/**
+ * Process an ARGB32 rp_image using a 4-pixel NEON function.
+ * @tparam pxfunc 4-pixel function.
+ * @param backend rp_image_backend.
+ */
+template<void (*pxfunc)(uint32_t *px)>
+static inline void T_process_argb32_neon(rp_image_backend *backend)
+{
+	const int width = backend->width;
+	uint32_t *px_dest = static_cast<uint32_t*>(backend->data());
+	const int dest_stride_adj = (backend->stride / sizeof(*px_dest)) - width;
+	for (int y = backend->height; y > 0; y--, px_dest += dest_stride_adj) {
+		// Process 4 pixels per iteration using NEON.
+		int x = width;
+		for (; x > 3; x -= 4, px_dest += 4) {
+			pxfunc(px_dest);
+		}
+
+		// Remaining pixels.
+		// Use a temporary buffer so the same function can be used.
+		if (x > 0) {
+			uint32_t tmp[4] = {0, 0, 0, 0};
+			memcpy(tmp, px_dest, x * sizeof(uint32_t));
+			pxfunc(tmp);
+			memcpy(px_dest, tmp, x * sizeof(uint32_t));
+			px_dest += x;
+		}
+	}
+}
+
+/**
+ * Un-premultiply an ARGB32 rp_image.
+ * NEON-optimized version.
+ *
+ * Image must be ARGB32.
+ *
+ * @return 0 on success; non-zero on error.
+ */
+int rp_image::un_premultiply_neon(void)
+{
+	RP_D(const rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == rp_image::Format::ARGB32);
+	if (backend->format != rp_image::Format::ARGB32) {
+		// Incorrect format...
+		return -1;
+	}
+
+	T_process_argb32_neon<un_premultiply_4px_neon>(backend);
+	return 0;
+}
+
+/**
+ * Premultiply an ARGB32 rp_image.
+ * NEON-optimized version.
+ *
+ * Image must be ARGB32.
+ *
+ * @return 0 on success; non-zero on error.
+ */
+int rp_image::premultiply_neon(void)
+{
+	RP_D(const rp_image);
+	rp_image_backend *const backend = d->backend;
+	assert(backend->format == rp_image::Format::ARGB32);
+	if (backend->format != rp_image::Format::ARGB32) {
+		// Incorrect format...
+		return -1;
+	}
+
+	T_process_argb32_neon<premultiply_4px_neon>(backend);
+	return 0;
+}
+
+}
+
+#endif /* RP_IMAGE_HAS_NEON */
@@ -0,0 +1,874 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageBenchmark.cpp: ImageDecoder and rp_image benchmarks.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Benchmark
+#include <benchmark/benchmark.h>
+#include "common.h"
+
+// librpbase, librptexture
+#include "librpbase/aligned_malloc.h"
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/decoder/ImageDecoder.hpp"
+#include "librptexture/config.librptexture.h"
+
+// C includes.
+#include <stdint.h>
+#include <stdio.h>
+
+namespace LibRpTexture { namespace Benchmarks {
+
+using namespace ImageDecoder;
+
+/** Common functions **/
+
+// Largest image dimension used in the benchmarks.
+static const int MAX_DIMENSION = 1024;
+// Size of the random source buffer.
+// Large enough for a MAX_DIMENSION x MAX_DIMENSION 32-bit image.
+static const int SRC_BUF_SIZE = MAX_DIMENSION * MAX_DIMENSION * 4;
+
+/**
+ * Get a buffer filled with pseudo-random data.
+ * The buffer is SRC_BUF_SIZE bytes and is shared by all benchmarks.
+ * @return Random data buffer.
+ */
+static const uint8_t *randomBuffer(void)
+{
+	static uint8_t *buf = nullptr;
+	if (!buf) {
+		// Use a fixed seed so results are comparable between runs.
+		buf = static_cast<uint8_t*>(aligned_malloc(16, SRC_BUF_SIZE));
+		uint32_t x = 0x12345678;
+		uint32_t *const p32 = reinterpret_cast<uint32_t*>(buf);
+		for (int i = 0; i < SRC_BUF_SIZE / 4; i++) {
+			// xorshift32
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			p32[i] = x;
+		}
+
+		// BC7 blocks with a 0 in the first byte have an invalid mode.
+		// Make sure every 16-byte block has a valid BC7 mode.
+		for (int i = 0; i < SRC_BUF_SIZE; i += 16) {
+			buf[i] |= 0x80;
+		}
+	}
+	return buf;
+}
+
+/**
+ * Report the throughput of a benchmark in MPix/s.
+ * This is shown as "MPix=###/s" in the console output.
+ * @param state Benchmark state.
+ * @param pixels Number of pixels processed per iteration.
+ */
+static void setPixelRate(benchmark::State &state, int64_t pixels)
+{
+	state.counters["MPix"] = benchmark::Counter(
+		static_cast<double>(state.iterations() * pixels) / 1000000.0,
+		benchmark::Counter::kIsRate);
+}
+
+/**
+ * Image sizes used for each benchmark.
+ * @param b Benchmark.
+ */
+static void imageSizes(benchmark::internal::Benchmark *b)
+{
+	for (int size = 64; size <= MAX_DIMENSION; size *= 4) {
+		b->Args({size, size});
+	}
+}
+
+// CPU feature checks.
+// These are function pointers so the check is done
+// when the benchmark is run, not when it's registered.
+typedef bool (*pfnHasCPU_t)(void);
+static bool cpu_any(void) { return true; }
+#if defined(IMAGEDECODER_HAS_SSE2) || defined(RP_IMAGE_HAS_SSE2)
+static bool cpu_sse2(void) { return !!RP_CPU_HasSSE2(); }
+#endif
+#ifdef IMAGEDECODER_HAS_SSSE3
+static bool cpu_ssse3(void) { return !!RP_CPU_HasSSSE3(); }
+#endif
+#if defined(IMAGEDECODER_HAS_SSE41) || defined(RP_IMAGE_HAS_SSE41)
+static bool cpu_sse41(void) { return !!RP_CPU_HasSSE41(); }
+#endif
+#if defined(IMAGEDECODER_HAS_AVX2) || defined(RP_IMAGE_HAS_AVX2)
+static bool cpu_avx2(void) { return !!RP_CPU_HasAVX2(); }
+#endif
+
+/**
+ * Check if the CPU supports the instruction set needed by a benchmark.
+ * If it doesn't, the benchmark will be skipped.
+ * @param state Benchmark state.
+ * @param pfnHasCPU CPU check function.
+ * @return True if supported; false if not.
+ */
+static bool checkCPU(benchmark::State &state, pfnHasCPU_t pfnHasCPU)
+{
+	if (!pfnHasCPU()) {
+		state.SkipWithError("CPU does not support this instruction set");
+		return false;
+	}
+	return true;
+}
+
+// NOTE: The dispatch functions may be IFUNCs. Taking the address of an
+// IFUNC in an executable resolves it when the executable is loaded,
+// before the CPU flags can be initialized, so the dispatch functions
+// are wrapped in lambdas instead.
+
+/** ImageDecoder: Linear **/
+
+typedef rp_image *(*pfnLinear8_t)(PixelFormat px_format, int width, int height,
+	const uint8_t *img_buf, int img_siz, int stride);
+typedef rp_image *(*pfnLinear16_t)(PixelFormat px_format, int width, int height,
+	const uint16_t *img_buf, int img_siz, int stride);
+typedef rp_image *(*pfnLinear32_t)(PixelFormat px_format, int width, int height,
+	const uint32_t *img_buf, int img_siz, int stride);
+
+/**
+ * Benchmark a linear image decoding function.
+ * @tparam pfn_t Function pointer type.
+ * @tparam pixel_t Source pixel type.
+ * @param state Benchmark state.
+ * @param pfn Decoding function.
+ * @param px_format Pixel format.
+ * @param bytespp Bytes per pixel.
+ * @param pfnHasCPU CPU check function.
+ */
+template<typename pfn_t, typename pixel_t>
+static void BM_Linear(benchmark::State &state, pfn_t pfn, PixelFormat px_format,
+	int bytespp, pfnHasCPU_t pfnHasCPU)
+{
+	if (!checkCPU(state, pfnHasCPU))
+		return;
+
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const pixel_t *const src = reinterpret_cast<const pixel_t*>(randomBuffer());
+	for (auto _ : state) {
+		rp_image *const img = pfn(px_format, width, height, src, width * height * bytespp, 0);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+
+// NOTE: BENCHMARK_CAPTURE() can't take a template function name.
+static void BM_Linear8(benchmark::State &state, pfnLinear8_t pfn, PixelFormat px_format, int bytespp, pfnHasCPU_t pfnHasCPU)
+{
+	BM_Linear<pfnLinear8_t, uint8_t>(state, pfn, px_format, bytespp, pfnHasCPU);
+}
+static void BM_Linear16(benchmark::State &state, pfnLinear16_t pfn, PixelFormat px_format, int bytespp, pfnHasCPU_t pfnHasCPU)
+{
+	BM_Linear<pfnLinear16_t, uint16_t>(state, pfn, px_format, bytespp, pfnHasCPU);
+}
+static void BM_Linear32(benchmark::State &state, pfnLinear32_t pfn, PixelFormat px_format, int bytespp, pfnHasCPU_t pfnHasCPU)
+{
+	BM_Linear<pfnLinear32_t, uint32_t>(state, pfn, px_format, bytespp, pfnHasCPU);
+}
+
+#define BENCHMARK_LINEAR(bm, fn, px_format, bytespp, cpu) \
+	BENCHMARK_CAPTURE(bm, fn##_##px_format, \
+		ImageDecoder::fn, PixelFormat::px_format, bytespp, cpu)->Apply(imageSizes)
+#define BENCHMARK_LINEAR_DISPATCH(bm, pixel_t, fn, px_format, bytespp) \
+	BENCHMARK_CAPTURE(bm, fn##_##px_format, \
+		[](PixelFormat px_format, int width, int height, const pixel_t *img_buf, int img_siz, int stride) { \
+			return ImageDecoder::fn(px_format, width, height, img_buf, img_siz, stride); \
+		}, PixelFormat::px_format, bytespp, cpu_any)->Apply(imageSizes)
+
+BENCHMARK_LINEAR(BM_Linear8, fromLinear8, L8, 1, cpu_any);
+BENCHMARK_LINEAR(BM_Linear8, fromLinear8, A4L4, 1, cpu_any);
+
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_cpp, RGB565, 2, cpu_any);
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_cpp, ARGB1555, 2, cpu_any);
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_cpp, ARGB4444, 2, cpu_any);
+#ifdef IMAGEDECODER_HAS_SSE2
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_sse2, RGB565, 2, cpu_sse2);
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_sse2, ARGB1555, 2, cpu_sse2);
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_sse2, ARGB4444, 2, cpu_sse2);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+#ifdef IMAGEDECODER_HAS_AVX2
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_avx2, RGB565, 2, cpu_avx2);
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_avx2, ARGB1555, 2, cpu_avx2);
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_avx2, ARGB4444, 2, cpu_avx2);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_NEON
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_neon, RGB565, 2, cpu_any);
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_neon, ARGB1555, 2, cpu_any);
+BENCHMARK_LINEAR(BM_Linear16, fromLinear16_neon, ARGB4444, 2, cpu_any);
+#endif /* IMAGEDECODER_HAS_NEON */
+BENCHMARK_LINEAR_DISPATCH(BM_Linear16, uint16_t, fromLinear16, RGB565, 2);
+
+BENCHMARK_LINEAR(BM_Linear8, fromLinear24_cpp, RGB888, 3, cpu_any);
+#ifdef IMAGEDECODER_HAS_SSSE3
+BENCHMARK_LINEAR(BM_Linear8, fromLinear24_ssse3, RGB888, 3, cpu_ssse3);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+BENCHMARK_LINEAR_DISPATCH(BM_Linear8, uint8_t, fromLinear24, RGB888, 3);
+
+BENCHMARK_LINEAR(BM_Linear32, fromLinear32_cpp, ARGB8888, 4, cpu_any);
+BENCHMARK_LINEAR(BM_Linear32, fromLinear32_cpp, ABGR8888, 4, cpu_any);
+#ifdef IMAGEDECODER_HAS_SSSE3
+BENCHMARK_LINEAR(BM_Linear32, fromLinear32_ssse3, ARGB8888, 4, cpu_ssse3);
+BENCHMARK_LINEAR(BM_Linear32, fromLinear32_ssse3, ABGR8888, 4, cpu_ssse3);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+#ifdef IMAGEDECODER_HAS_AVX2
+BENCHMARK_LINEAR(BM_Linear32, fromLinear32_avx2, ARGB8888, 4, cpu_avx2);
+BENCHMARK_LINEAR(BM_Linear32, fromLinear32_avx2, ABGR8888, 4, cpu_avx2);
+#endif /* IMAGEDECODER_HAS_AVX2 */
+#ifdef IMAGEDECODER_HAS_NEON
+BENCHMARK_LINEAR(BM_Linear32, fromLinear32_neon, ARGB8888, 4, cpu_any);
+BENCHMARK_LINEAR(BM_Linear32, fromLinear32_neon, ABGR8888, 4, cpu_any);
+#endif /* IMAGEDECODER_HAS_NEON */
+BENCHMARK_LINEAR_DISPATCH(BM_Linear32, uint32_t, fromLinear32, ARGB8888, 4);
+
+/**
+ * Benchmark fromLinearCI4().
+ * @param state Benchmark state.
+ */
+static void BM_fromLinearCI4(benchmark::State &state)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint8_t *const src = randomBuffer();
+	const uint8_t *const pal = src + (SRC_BUF_SIZE / 2);
+	for (auto _ : state) {
+		rp_image *const img = fromLinearCI4(PixelFormat::RGB565, true,
+			width, height, src, (width * height) / 2, pal, 16*2);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+BENCHMARK(BM_fromLinearCI4)->Apply(imageSizes);
+
+/**
+ * Benchmark fromLinearCI8().
+ * @param state Benchmark state.
+ */
+static void BM_fromLinearCI8(benchmark::State &state)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint8_t *const src = randomBuffer();
+	const uint8_t *const pal = src + (SRC_BUF_SIZE / 2);
+	for (auto _ : state) {
+		rp_image *const img = fromLinearCI8(PixelFormat::ARGB8888,
+			width, height, src, width * height, pal, 256*4);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+BENCHMARK(BM_fromLinearCI8)->Apply(imageSizes);
+
+/**
+ * Benchmark fromLinearMono().
+ * @param state Benchmark state.
+ */
+static void BM_fromLinearMono(benchmark::State &state)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint8_t *const src = randomBuffer();
+	for (auto _ : state) {
+		rp_image *const img = fromLinearMono(width, height, src, (width * height) / 8);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+BENCHMARK(BM_fromLinearMono)->Apply(imageSizes);
+
+/** ImageDecoder: Tiled and block-compressed formats **/
+
+typedef rp_image *(*pfnBlock_t)(int width, int height, const uint8_t *img_buf, int img_siz);
+
+/**
+ * Benchmark a tiled or block-compressed image decoding function.
+ * @param state Benchmark state.
+ * @param pfn Decoding function.
+ * @param bpp Bits per pixel.
+ * @param pfnHasCPU CPU check function.
+ */
+static void BM_Block(benchmark::State &state, pfnBlock_t pfn, int bpp, pfnHasCPU_t pfnHasCPU)
+{
+	if (!checkCPU(state, pfnHasCPU))
+		return;
+
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint8_t *const src = randomBuffer();
+	for (auto _ : state) {
+		rp_image *const img = pfn(width, height, src, (width * height * bpp) / 8);
+		if (!img) {
+			state.SkipWithError("Image decoding failed");
+			break;
+		}
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+
+#define BENCHMARK_BLOCK(fn, bpp, cpu) \
+	BENCHMARK_CAPTURE(BM_Block, fn, ImageDecoder::fn, bpp, cpu)->Apply(imageSizes)
+#define BENCHMARK_BLOCK_DISPATCH(fn, bpp) \
+	BENCHMARK_CAPTURE(BM_Block, fn, \
+		[](int width, int height, const uint8_t *img_buf, int img_siz) { \
+			return ImageDecoder::fn(width, height, img_buf, img_siz); \
+		}, bpp, cpu_any)->Apply(imageSizes)
+
+BENCHMARK_BLOCK(fromGcnI8, 8, cpu_any);
+BENCHMARK_BLOCK(fromDXT1_GCN, 4, cpu_any);
+
+BENCHMARK_BLOCK(fromDXT1_cpp, 4, cpu_any);
+BENCHMARK_BLOCK(fromDXT1_A1_cpp, 4, cpu_any);
+BENCHMARK_BLOCK(fromDXT5_cpp, 8, cpu_any);
+BENCHMARK_BLOCK(fromBC4_cpp, 4, cpu_any);
+BENCHMARK_BLOCK(fromBC5_cpp, 8, cpu_any);
+#ifdef IMAGEDECODER_HAS_SSSE3
+BENCHMARK_BLOCK(fromDXT1_ssse3, 4, cpu_ssse3);
+BENCHMARK_BLOCK(fromDXT1_A1_ssse3, 4, cpu_ssse3);
+BENCHMARK_BLOCK(fromDXT5_ssse3, 8, cpu_ssse3);
+BENCHMARK_BLOCK(fromBC4_ssse3, 4, cpu_ssse3);
+BENCHMARK_BLOCK(fromBC5_ssse3, 8, cpu_ssse3);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+BENCHMARK_BLOCK_DISPATCH(fromDXT1, 4);
+BENCHMARK_BLOCK_DISPATCH(fromDXT1_A1, 4);
+BENCHMARK_BLOCK(fromDXT2, 8, cpu_any);
+BENCHMARK_BLOCK(fromDXT3, 8, cpu_any);
+BENCHMARK_BLOCK(fromDXT4, 8, cpu_any);
+BENCHMARK_BLOCK_DISPATCH(fromDXT5, 8);
+BENCHMARK_BLOCK_DISPATCH(fromBC4, 4);
+BENCHMARK_BLOCK_DISPATCH(fromBC5, 8);
+
+BENCHMARK_BLOCK(fromETC1_cpp, 4, cpu_any);
+BENCHMARK_BLOCK(fromETC2_RGB_cpp, 4, cpu_any);
+BENCHMARK_BLOCK(fromETC2_RGBA_cpp, 8, cpu_any);
+BENCHMARK_BLOCK(fromETC2_RGB_A1_cpp, 4, cpu_any);
+#ifdef IMAGEDECODER_HAS_SSE41
+BENCHMARK_BLOCK(fromETC1_sse41, 4, cpu_sse41);
+BENCHMARK_BLOCK(fromETC2_RGB_sse41, 4, cpu_sse41);
+BENCHMARK_BLOCK(fromETC2_RGBA_sse41, 8, cpu_sse41);
+BENCHMARK_BLOCK(fromETC2_RGB_A1_sse41, 4, cpu_sse41);
+#endif /* IMAGEDECODER_HAS_SSE41 */
+BENCHMARK_BLOCK_DISPATCH(fromETC1, 4);
+BENCHMARK_BLOCK_DISPATCH(fromETC2_RGBA, 8);
+
+BENCHMARK_BLOCK(fromBC7_cpp, 8, cpu_any);
+#ifdef IMAGEDECODER_HAS_SSE41
+BENCHMARK_BLOCK(fromBC7_sse41, 8, cpu_sse41);
+#endif /* IMAGEDECODER_HAS_SSE41 */
+BENCHMARK_BLOCK_DISPATCH(fromBC7, 8);
+
+typedef rp_image *(*pfnGcn16_t)(PixelFormat px_format, int width, int height,
+	const uint16_t *img_buf, int img_siz);
+
+/**
+ * Benchmark a GameCube 16-bit image decoding function.
+ * @param state Benchmark state.
+ * @param pfn Decoding function.
+ * @param px_format Pixel format.
+ * @param pfnHasCPU CPU check function.
+ */
+static void BM_Gcn16(benchmark::State &state, pfnGcn16_t pfn, PixelFormat px_format, pfnHasCPU_t pfnHasCPU)
+{
+	if (!checkCPU(state, pfnHasCPU))
+		return;
+
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint16_t *const src = reinterpret_cast<const uint16_t*>(randomBuffer());
+	for (auto _ : state) {
+		rp_image *const img = pfn(px_format, width, height, src, width * height * 2);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+
+BENCHMARK_CAPTURE(BM_Gcn16, fromGcn16_cpp_RGB5A3, fromGcn16_cpp, PixelFormat::RGB5A3, cpu_any)->Apply(imageSizes);
+BENCHMARK_CAPTURE(BM_Gcn16, fromGcn16_cpp_RGB565, fromGcn16_cpp, PixelFormat::RGB565, cpu_any)->Apply(imageSizes);
+#ifdef IMAGEDECODER_HAS_SSSE3
+BENCHMARK_CAPTURE(BM_Gcn16, fromGcn16_ssse3_RGB565, fromGcn16_ssse3, PixelFormat::RGB565, cpu_ssse3)->Apply(imageSizes);
+#endif /* IMAGEDECODER_HAS_SSSE3 */
+BENCHMARK_CAPTURE(BM_Gcn16, fromGcn16_RGB565,
+	[](PixelFormat px_format, int width, int height, const uint16_t *img_buf, int img_siz) {
+		return fromGcn16(px_format, width, height, img_buf, img_siz);
+	}, PixelFormat::RGB565, cpu_any)->Apply(imageSizes);
+
+/**
+ * Benchmark fromGcnCI8().
+ * @param state Benchmark state.
+ */
+static void BM_fromGcnCI8(benchmark::State &state)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint8_t *const src = randomBuffer();
+	const uint16_t *const pal = reinterpret_cast<const uint16_t*>(src + (SRC_BUF_SIZE / 2));
+	for (auto _ : state) {
+		rp_image *const img = fromGcnCI8(width, height, src, width * height, pal, 256*2);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+BENCHMARK(BM_fromGcnCI8)->Apply(imageSizes);
+
+/**
+ * Benchmark fromNDS_CI4().
+ * @param state Benchmark state.
+ */
+static void BM_fromNDS_CI4(benchmark::State &state)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint8_t *const src = randomBuffer();
+	const uint16_t *const pal = reinterpret_cast<const uint16_t*>(src + (SRC_BUF_SIZE / 2));
+	for (auto _ : state) {
+		rp_image *const img = fromNDS_CI4(width, height, src, (width * height) / 2, pal, 16*2);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+BENCHMARK(BM_fromNDS_CI4)->Apply(imageSizes);
+
+typedef rp_image *(*pfnN3DS_t)(int width, int height, const uint16_t *img_buf, int img_siz);
+typedef rp_image *(*pfnN3DS_A4_t)(int width, int height, const uint16_t *img_buf, int img_siz,
+	const uint8_t *alpha_buf, int alpha_siz);
+
+/**
+ * Benchmark a Nintendo 3DS tiled RGB565 decoding function.
+ * @param state Benchmark state.
+ * @param pfn Decoding function.
+ * @param pfnHasCPU CPU check function.
+ */
+static void BM_N3DS(benchmark::State &state, pfnN3DS_t pfn, pfnHasCPU_t pfnHasCPU)
+{
+	if (!checkCPU(state, pfnHasCPU))
+		return;
+
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint16_t *const src = reinterpret_cast<const uint16_t*>(randomBuffer());
+	for (auto _ : state) {
+		rp_image *const img = pfn(width, height, src, width * height * 2);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+
+/**
+ * Benchmark a Nintendo 3DS tiled RGB565+A4 decoding function.
+ * @param state Benchmark state.
+ * @param pfn Decoding function.
+ * @param pfnHasCPU CPU check function.
+ */
+static void BM_N3DS_A4(benchmark::State &state, pfnN3DS_A4_t pfn, pfnHasCPU_t pfnHasCPU)
+{
+	if (!checkCPU(state, pfnHasCPU))
+		return;
+
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint8_t *const src = randomBuffer();
+	const uint8_t *const alpha = src + (SRC_BUF_SIZE / 2);
+	for (auto _ : state) {
+		rp_image *const img = pfn(width, height, reinterpret_cast<const uint16_t*>(src),
+			width * height * 2, alpha, (width * height) / 2);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+
+BENCHMARK_CAPTURE(BM_N3DS, fromN3DSTiledRGB565_cpp, fromN3DSTiledRGB565_cpp, cpu_any)->Apply(imageSizes);
+BENCHMARK_CAPTURE(BM_N3DS_A4, fromN3DSTiledRGB565_A4_cpp, fromN3DSTiledRGB565_A4_cpp, cpu_any)->Apply(imageSizes);
+#ifdef IMAGEDECODER_HAS_SSE2
+BENCHMARK_CAPTURE(BM_N3DS, fromN3DSTiledRGB565_sse2, fromN3DSTiledRGB565_sse2, cpu_sse2)->Apply(imageSizes);
+BENCHMARK_CAPTURE(BM_N3DS_A4, fromN3DSTiledRGB565_A4_sse2, fromN3DSTiledRGB565_A4_sse2, cpu_sse2)->Apply(imageSizes);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+BENCHMARK_CAPTURE(BM_N3DS, fromN3DSTiledRGB565,
+	[](int width, int height, const uint16_t *img_buf, int img_siz) {
+		return fromN3DSTiledRGB565(width, height, img_buf, img_siz);
+	}, cpu_any)->Apply(imageSizes);
+BENCHMARK_CAPTURE(BM_N3DS_A4, fromN3DSTiledRGB565_A4,
+	[](int width, int height, const uint16_t *img_buf, int img_siz, const uint8_t *alpha_buf, int alpha_siz) {
+		return fromN3DSTiledRGB565_A4(width, height, img_buf, img_siz, alpha_buf, alpha_siz);
+	}, cpu_any)->Apply(imageSizes);
+
+/**
+ * Benchmark fromDreamcastSquareTwiddled16().
+ * @param state Benchmark state.
+ */
+static void BM_fromDreamcastSquareTwiddled16(benchmark::State &state)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint16_t *const src = reinterpret_cast<const uint16_t*>(randomBuffer());
+	for (auto _ : state) {
+		rp_image *const img = fromDreamcastSquareTwiddled16(PixelFormat::ARGB4444,
+			width, height, src, width * height * 2);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+BENCHMARK(BM_fromDreamcastSquareTwiddled16)->Apply(imageSizes);
+
+/**
+ * Benchmark fromDreamcastVQ16().
+ * @param state Benchmark state.
+ */
+static void BM_fromDreamcastVQ16(benchmark::State &state)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint8_t *const src = randomBuffer();
+	const uint16_t *const pal = reinterpret_cast<const uint16_t*>(src + (SRC_BUF_SIZE / 2));
+	for (auto _ : state) {
+		rp_image *const img = fromDreamcastVQ16(PixelFormat::RGB565, false, false,
+			width, height, src, (width * height) / 4, pal, 1024*2);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+BENCHMARK(BM_fromDreamcastVQ16)->Apply(imageSizes);
+
+#ifdef ENABLE_PVRTC
+typedef rp_image *(*pfnPVRTC_t)(int width, int height, const uint8_t *img_buf, int img_siz, uint8_t mode);
+
+/**
+ * Benchmark a PVRTC decoding function.
+ * @param state Benchmark state.
+ * @param pfn Decoding function.
+ * @param mode PVRTC mode.
+ * @param pfnHasCPU CPU check function.
+ */
+static void BM_PVRTC(benchmark::State &state, pfnPVRTC_t pfn, uint8_t mode, pfnHasCPU_t pfnHasCPU)
+{
+	if (!checkCPU(state, pfnHasCPU))
+		return;
+
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const int bpp = ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP) ? 2 : 4;
+	const uint8_t *const src = randomBuffer();
+	for (auto _ : state) {
+		rp_image *const img = pfn(width, height, src, (width * height * bpp) / 8, mode);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+
+BENCHMARK_CAPTURE(BM_PVRTC, fromPVRTC_cpp_4bpp, fromPVRTC_cpp, PVRTC_4BPP | PVRTC_ALPHA_YES, cpu_any)->Apply(imageSizes);
+BENCHMARK_CAPTURE(BM_PVRTC, fromPVRTC_cpp_2bpp, fromPVRTC_cpp, PVRTC_2BPP | PVRTC_ALPHA_YES, cpu_any)->Apply(imageSizes);
+BENCHMARK_CAPTURE(BM_PVRTC, fromPVRTCII_cpp_4bpp, fromPVRTCII_cpp, PVRTC_4BPP, cpu_any)->Apply(imageSizes);
+#ifdef IMAGEDECODER_HAS_SSE2
+BENCHMARK_CAPTURE(BM_PVRTC, fromPVRTC_sse2_4bpp, fromPVRTC_sse2, PVRTC_4BPP | PVRTC_ALPHA_YES, cpu_sse2)->Apply(imageSizes);
+BENCHMARK_CAPTURE(BM_PVRTC, fromPVRTC_sse2_2bpp, fromPVRTC_sse2, PVRTC_2BPP | PVRTC_ALPHA_YES, cpu_sse2)->Apply(imageSizes);
+BENCHMARK_CAPTURE(BM_PVRTC, fromPVRTCII_sse2_4bpp, fromPVRTCII_sse2, PVRTC_4BPP, cpu_sse2)->Apply(imageSizes);
+#endif /* IMAGEDECODER_HAS_SSE2 */
+BENCHMARK_CAPTURE(BM_PVRTC, fromPVRTC_4bpp,
+	[](int width, int height, const uint8_t *img_buf, int img_siz, uint8_t mode) {
+		return fromPVRTC(width, height, img_buf, img_siz, mode);
+	}, PVRTC_4BPP | PVRTC_ALPHA_YES, cpu_any)->Apply(imageSizes);
+#endif /* ENABLE_PVRTC */
+
+/** ImageDecoder: Partial regions **/
+
+/**
+ * Benchmark fromLinear32_region().
+ * The region is the center quarter of the image.
+ * @param state Benchmark state.
+ */
+static void BM_fromLinear32_region(benchmark::State &state)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint32_t *const src = reinterpret_cast<const uint32_t*>(randomBuffer());
+	for (auto _ : state) {
+		rp_image *const img = fromLinear32_region(PixelFormat::ARGB8888,
+			width, height, src, width * height * 4, 0,
+			width / 4, height / 4, width / 2, height / 2);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width / 2) * (height / 2));
+}
+BENCHMARK(BM_fromLinear32_region)->Apply(imageSizes);
+
+/**
+ * Benchmark fromTiled_region() using DXT1.
+ * The region is the center quarter of the image.
+ * @param state Benchmark state.
+ */
+static void BM_fromTiled_region_DXT1(benchmark::State &state)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint8_t *const src = randomBuffer();
+	for (auto _ : state) {
+		rp_image *const img = fromTiled_region(
+			[](int width, int height, const uint8_t *img_buf, int img_siz) {
+				return fromDXT1(width, height, img_buf, img_siz);
+			}, 4, 4, 8,
+			width, height, src, (width * height) / 2,
+			width / 4, height / 4, width / 2, height / 2);
+		benchmark::DoNotOptimize(img);
+		img->unref();
+	}
+	setPixelRate(state, static_cast<int64_t>(width / 2) * (height / 2));
+}
+BENCHMARK(BM_fromTiled_region_DXT1)->Apply(imageSizes);
+
+/** rp_image operations **/
+
+/**
+ * Create an ARGB32 rp_image with random image data.
+ * @param width Image width.
+ * @param height Image height.
+ * @return rp_image.
+ */
+static rp_image *createRandomImage(int width, int height)
+{
+	rp_image *const img = fromLinear32_cpp(PixelFormat::ARGB8888, width, height,
+		reinterpret_cast<const uint32_t*>(randomBuffer()), width * height * 4);
+	return img;
+}
+
+typedef int (rp_image::*pfnInPlaceOp_t)(void);
+
+/**
+ * Benchmark an in-place rp_image operation.
+ * The operation is applied to the same image on each iteration.
+ * @param state Benchmark state.
+ * @param pfn rp_image member function.
+ * @param pfnHasCPU CPU check function.
+ */
+static void BM_InPlaceOp(benchmark::State &state, pfnInPlaceOp_t pfn, pfnHasCPU_t pfnHasCPU)
+{
+	if (!checkCPU(state, pfnHasCPU))
+		return;
+
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	rp_image *const img = createRandomImage(width, height);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize((img->*pfn)());
+	}
+	img->unref();
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+
+#define BENCHMARK_INPLACE(fn, cpu) \
+	BENCHMARK_CAPTURE(BM_InPlaceOp, fn, &rp_image::fn, cpu)->Apply(imageSizes)
+
+BENCHMARK_INPLACE(premultiply_cpp, cpu_any);
+BENCHMARK_INPLACE(un_premultiply_cpp, cpu_any);
+#ifdef RP_IMAGE_HAS_SSE41
+BENCHMARK_INPLACE(premultiply_sse41, cpu_sse41);
+BENCHMARK_INPLACE(un_premultiply_sse41, cpu_sse41);
+#endif /* RP_IMAGE_HAS_SSE41 */
+#ifdef RP_IMAGE_HAS_AVX2
+BENCHMARK_INPLACE(premultiply_avx2, cpu_avx2);
+BENCHMARK_INPLACE(un_premultiply_avx2, cpu_avx2);
+#endif /* RP_IMAGE_HAS_AVX2 */
+#ifdef RP_IMAGE_HAS_NEON
+BENCHMARK_INPLACE(premultiply_neon, cpu_any);
+BENCHMARK_INPLACE(un_premultiply_neon, cpu_any);
+#endif /* RP_IMAGE_HAS_NEON */
+BENCHMARK_INPLACE(premultiply, cpu_any);
+BENCHMARK_INPLACE(un_premultiply, cpu_any);
+
+typedef int (rp_image::*pfnChromaKey_t)(uint32_t key);
+
+/**
+ * Benchmark an apply_chroma_key() function.
+ * @param state Benchmark state.
+ * @param pfn rp_image member function.
+ * @param pfnHasCPU CPU check function.
+ */
+static void BM_ChromaKey(benchmark::State &state, pfnChromaKey_t pfn, pfnHasCPU_t pfnHasCPU)
+{
+	if (!checkCPU(state, pfnHasCPU))
+		return;
+
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	rp_image *const img = createRandomImage(width, height);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize((img->*pfn)(0xFFFF00FF));
+	}
+	img->unref();
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+
+BENCHMARK_CAPTURE(BM_ChromaKey, apply_chroma_key_cpp, &rp_image::apply_chroma_key_cpp, cpu_any)->Apply(imageSizes);
+#ifdef RP_IMAGE_HAS_SSE2
+BENCHMARK_CAPTURE(BM_ChromaKey, apply_chroma_key_sse2, &rp_image::apply_chroma_key_sse2, cpu_sse2)->Apply(imageSizes);
+#endif /* RP_IMAGE_HAS_SSE2 */
+BENCHMARK_CAPTURE(BM_ChromaKey, apply_chroma_key, &rp_image::apply_chroma_key, cpu_any)->Apply(imageSizes);
+
+typedef rp_image *(rp_image::*pfnScaled_t)(int width, int height, rp_image::ScaleFilter filter) const;
+
+/**
+ * Benchmark an rp_image scaling function.
+ * The image is downscaled to half size.
+ * Throughput is measured using the source image size.
+ * @param state Benchmark state.
+ * @param pfn rp_image member function.
+ * @param filter Scaling filter.
+ * @param pfnHasCPU CPU check function.
+ */
+static void BM_Scaled(benchmark::State &state, pfnScaled_t pfn, rp_image::ScaleFilter filter, pfnHasCPU_t pfnHasCPU)
+{
+	if (!checkCPU(state, pfnHasCPU))
+		return;
+
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const rp_image *const img = createRandomImage(width, height);
+	for (auto _ : state) {
+		rp_image *const scaled = (img->*pfn)(width / 2, height / 2, filter);
+		benchmark::DoNotOptimize(scaled);
+		scaled->unref();
+	}
+	img->unref();
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+
+#define BENCHMARK_SCALED(fn, filter, cpu) \
+	BENCHMARK_CAPTURE(BM_Scaled, fn##_##filter, &rp_image::fn, rp_image::ScaleFilter::filter, cpu)->Apply(imageSizes)
+
+BENCHMARK_SCALED(scaled_cpp, Box, cpu_any);
+BENCHMARK_SCALED(scaled_cpp, Bilinear, cpu_any);
+#ifdef RP_IMAGE_HAS_SSE2
+BENCHMARK_SCALED(scaled_sse2, Box, cpu_sse2);
+BENCHMARK_SCALED(scaled_sse2, Bilinear, cpu_sse2);
+#endif /* RP_IMAGE_HAS_SSE2 */
+#ifdef RP_IMAGE_HAS_AVX2
+BENCHMARK_SCALED(scaled_avx2, Box, cpu_avx2);
+BENCHMARK_SCALED(scaled_avx2, Bilinear, cpu_avx2);
+#endif /* RP_IMAGE_HAS_AVX2 */
+#ifdef RP_IMAGE_HAS_NEON
+BENCHMARK_SCALED(scaled_neon, Box, cpu_any);
+BENCHMARK_SCALED(scaled_neon, Bilinear, cpu_any);
+#endif /* RP_IMAGE_HAS_NEON */
+BENCHMARK_SCALED(scaled, Box, cpu_any);
+
+/**
+ * Benchmark rp_image::resized().
+ * @param state Benchmark state.
+ * @param height_num Numerator for the new height.
+ * @param height_den Denominator for the new height.
+ */
+static void BM_resized(benchmark::State &state, int height_num, int height_den)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const rp_image *const img = createRandomImage(width, height);
+	for (auto _ : state) {
+		rp_image *const resized = img->resized(width, (height * height_num) / height_den,
+			rp_image::AlignVCenter, 0xFF000000);
+		benchmark::DoNotOptimize(resized);
+		resized->unref();
+	}
+	img->unref();
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+BENCHMARK_CAPTURE(BM_resized, expand, 5, 4)->Apply(imageSizes);
+BENCHMARK_CAPTURE(BM_resized, crop, 3, 4)->Apply(imageSizes);
+
+/**
+ * Benchmark rp_image::squared().
+ * The source image is twice as wide as it is tall.
+ * @param state Benchmark state.
+ */
+static void BM_squared(benchmark::State &state)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1)) / 2;
+	const rp_image *const img = createRandomImage(width, height);
+	for (auto _ : state) {
+		rp_image *const squared = img->squared();
+		benchmark::DoNotOptimize(squared);
+		squared->unref();
+	}
+	img->unref();
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+BENCHMARK(BM_squared)->Apply(imageSizes);
+
+/**
+ * Benchmark rp_image::flip().
+ * @param state Benchmark state.
+ * @param op Flip operation.
+ */
+static void BM_flip(benchmark::State &state, rp_image::FlipOp op)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const rp_image *const img = createRandomImage(width, height);
+	for (auto _ : state) {
+		rp_image *const flipped = img->flip(op);
+		benchmark::DoNotOptimize(flipped);
+		flipped->unref();
+	}
+	img->unref();
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+BENCHMARK_CAPTURE(BM_flip, FLIP_V, rp_image::FLIP_V)->Apply(imageSizes);
+BENCHMARK_CAPTURE(BM_flip, FLIP_H, rp_image::FLIP_H)->Apply(imageSizes);
+BENCHMARK_CAPTURE(BM_flip, FLIP_VH, rp_image::FLIP_VH)->Apply(imageSizes);
+
+/**
+ * Benchmark rp_image::dup_ARGB32() using a CI8 image.
+ * @param state Benchmark state.
+ */
+static void BM_dup_ARGB32(benchmark::State &state)
+{
+	const int width = static_cast<int>(state.range(0));
+	const int height = static_cast<int>(state.range(1));
+	const uint8_t *const src = randomBuffer();
+	const rp_image *const img = fromLinearCI8(PixelFormat::ARGB8888,
+		width, height, src, width * height, src + (SRC_BUF_SIZE / 2), 256*4);
+	for (auto _ : state) {
+		rp_image *const argb32 = img->dup_ARGB32();
+		benchmark::DoNotOptimize(argb32);
+		argb32->unref();
+	}
+	img->unref();
+	setPixelRate(state, static_cast<int64_t>(width) * height);
+}
+BENCHMARK(BM_dup_ARGB32)->Apply(imageSizes);
+
+} }
+
+/**
+ * Benchmark suite main function.
+ */
+int main(int argc, char *argv[])
+{
+	fprintf(stderr, "LibRpTexture benchmark suite: ImageDecoder and rp_image.\n\n");
+	fflush(nullptr);
+
+	::benchmark::Initialize(&argc, argv);
+	if (::benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
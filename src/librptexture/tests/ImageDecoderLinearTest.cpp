@@ -643,8 +643,103 @@ TEST_P(ImageDecoderLinearTest, fromLinear_ssse3_benchmark)
 }
 #endif /* IMAGEDECODER_HAS_SSSE3 */
 
+#ifdef IMAGEDECODER_HAS_AVX2
+/**
+ * Test the ImageDecoder::fromLinear*() functions. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderLinearTest, fromLinear_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Parameterized test.
+	const ImageDecoderLinearTest_mode &mode = GetParam();
+
+	// Decode the image.
+	switch (mode.bpp) {
+		case 24:
+			// Not implemented...
+			fprintf(stderr, "*** AVX2 decoding is not implemented for %u-bit color.\n", mode.bpp);
+			return;
+
+		case 32:
+			// 32-bit image.
+			m_img = ImageDecoder::fromLinear32_avx2(mode.src_pxf, 128, 128,
+				reinterpret_cast<const uint32_t*>(m_img_buf),
+				static_cast<int>(m_img_buf_len), mode.stride);
+			break;
+
+		case 15:
+		case 16:
+			// 15/16-bit image.
+			m_img = ImageDecoder::fromLinear16_avx2(mode.src_pxf, 128, 128,
+				reinterpret_cast<const uint16_t*>(m_img_buf),
+				static_cast<int>(m_img_buf_len), mode.stride);
+			break;
+
+		default:
+			ASSERT_TRUE(false) << "Invalid bpp: " << mode.bpp;
+			return;
+	}
+
+	ASSERT_TRUE(m_img != nullptr);
+
+	// Validate the image.
+	ASSERT_NO_FATAL_FAILURE(Validate_RpImage(m_img, mode.dest_pixel));
+}
+
+/**
+ * Benchmark the ImageDecoder::fromLinear*() functions. (AVX2-optimized version)
+ */
+TEST_P(ImageDecoderLinearTest, fromLinear_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	// Parameterized test.
+	const ImageDecoderLinearTest_mode &mode = GetParam();
+
+	// Decode the image.
+	switch (mode.bpp) {
+		case 24:
+			// Not implemented...
+			fprintf(stderr, "*** AVX2 decoding is not implemented for %u-bit color.\n", mode.bpp);
+			return;
+
+		case 32:
+			// 32-bit image.
+			for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+				m_img = ImageDecoder::fromLinear32_avx2(mode.src_pxf, 128, 128,
+					reinterpret_cast<const uint32_t*>(m_img_buf),
+					static_cast<int>(m_img_buf_len), mode.stride);
+				UNREF_AND_NULL(m_img);
+			}
+			break;
+
+		case 15:
+		case 16:
+			// 15/16-bit image.
+			for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+				m_img = ImageDecoder::fromLinear16_avx2(mode.src_pxf, 128, 128,
+					reinterpret_cast<const uint16_t*>(m_img_buf),
+					static_cast<int>(m_img_buf_len), mode.stride);
+				UNREF_AND_NULL(m_img);
+			}
+			break;
+
+		default:
+			ASSERT_TRUE(false) << "Invalid bpp: " << mode.bpp;
+			return;
+	}
+}
+#endif /* IMAGEDECODER_HAS_AVX2 */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(IMAGEDECODER_HAS_SSE2) || defined(IMAGEDECODER_HAS_SSSE3)
+#if defined(IMAGEDECODER_HAS_SSE2) || defined(IMAGEDECODER_HAS_SSSE3) || defined(IMAGEDECODER_HAS_AVX2)
 /**
  * Test the ImageDecoder::fromLinear*() dispatch functions.
  */
@@ -732,7 +827,44 @@ TEST_P(ImageDecoderLinearTest, fromLinear_dispatch_benchmark)
 			return;
 	}
 }
-#endif /* IMAGEDECODER_HAS_SSE2 || IMAGEDECODER_HAS_SSSE3 */
+#endif /* IMAGEDECODER_HAS_SSE2 || IMAGEDECODER_HAS_SSSE3 || IMAGEDECODER_HAS_AVX2 */
+
+/**
+ * Test the 16-bit lookup tables in ImageDecoder::fromLinear16_cpp().
+ * A 256x256 image has every 16-bit pixel value and uses the lookup table.
+ * Each row is compared to a 256x1 image, which doesn't use the lookup table.
+ */
+TEST(ImageDecoderLinearLut16Test, fromLinear16_cpp_lut_test)
+{
+	static const ImageDecoder::PixelFormat formats[] = {
+		ImageDecoder::PixelFormat::RGB565,
+		ImageDecoder::PixelFormat::ARGB1555,
+		ImageDecoder::PixelFormat::ARGB4444,
+	};
+
+	ao::uvector<uint16_t> img_buf;
+	img_buf.resize(256*256);
+	for (unsigned int i = 0; i < 256*256; i++) {
+		img_buf[i] = cpu_to_le16(static_cast<uint16_t>(i));
+	}
+
+	for (ImageDecoder::PixelFormat px_format : formats) {
+		rp_image *const img = ImageDecoder::fromLinear16_cpp(px_format, 256, 256,
+			img_buf.data(), static_cast<int>(img_buf.size() * sizeof(uint16_t)));
+		ASSERT_TRUE(img != nullptr);
+
+		for (int y = 0; y < 256; y++) {
+			rp_image *const img_row = ImageDecoder::fromLinear16_cpp(px_format, 256, 1,
+				&img_buf[y * 256], 256 * sizeof(uint16_t));
+			ASSERT_TRUE(img_row != nullptr);
+			EXPECT_EQ(0, memcmp(img->scanLine(y), img_row->scanLine(0), 256 * sizeof(uint32_t)))
+				<< "Pixel format " << static_cast<int>(px_format) << ", row " << y;
+			img_row->unref();
+		}
+
+		img->unref();
+	}
+}
 
 // Test cases.
 
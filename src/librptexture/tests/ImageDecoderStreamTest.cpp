@@ -0,0 +1,219 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageDecoderStreamTest.cpp: Test ImageDecoder::fromFile_banded().       *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpfile
+#include "librpfile/RpMemFile.hpp"
+using LibRpFile::RpMemFile;
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/decoder/ImageDecoder.hpp"
+
+// C includes.
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+namespace LibRpTexture { namespace Tests {
+
+class ImageDecoderStreamTest : public ::testing::Test
+{
+	public:
+		// Test image parameters.
+		// NOTE: Large enough to be decoded in multiple bands.
+		static const int WIDTH = 2044;
+		static const int HEIGHT = 1534;
+
+		// DXT1: 4x4 tiles, 8 bytes per tile
+		static const int DXT1_TILE_ROW_SIZE = ((WIDTH + 3) / 4) * 8;
+		static const int DXT1_IMAGE_SIZE = DXT1_TILE_ROW_SIZE * ((HEIGHT + 3) / 4);
+
+		/**
+		 * Create a buffer with pseudo-random data.
+		 * @param size Buffer size.
+		 * @return Buffer.
+		 */
+		static vector<uint8_t> randomBuffer(size_t size)
+		{
+			vector<uint8_t> buf(size);
+			uint32_t x = 0x12345678;
+			for (uint8_t &b : buf) {
+				// xorshift32
+				x ^= x << 13;
+				x ^= x >> 17;
+				x ^= x << 5;
+				b = static_cast<uint8_t>(x);
+			}
+			return buf;
+		}
+
+		/**
+		 * Band decoding function: DXT1
+		 * @param param Unused.
+		 * @param height Band height.
+		 * @param img_buf Image buffer for the band.
+		 * @param img_siz Size of image data for the band.
+		 * @return rp_image, or nullptr on error.
+		 */
+		static rp_image *decodeBand_DXT1(void *param, int height, const uint8_t *img_buf, int img_siz)
+		{
+			RP_UNUSED(param);
+			return ImageDecoder::fromDXT1(WIDTH, height, img_buf, img_siz);
+		}
+
+		/**
+		 * Band decoding function: 32-bit linear with a padded stride
+		 * @param param Pointer to the stride.
+		 * @param height Band height.
+		 * @param img_buf Image buffer for the band.
+		 * @param img_siz Size of image data for the band.
+		 * @return rp_image, or nullptr on error.
+		 */
+		static rp_image *decodeBand_ARGB8888(void *param, int height, const uint8_t *img_buf, int img_siz)
+		{
+			return ImageDecoder::fromLinear32(ImageDecoder::PixelFormat::ARGB8888,
+				WIDTH, height, reinterpret_cast<const uint32_t*>(img_buf), img_siz,
+				*static_cast<const int*>(param));
+		}
+
+		/**
+		 * Compare two ARGB32 images.
+		 * @param expected Expected image.
+		 * @param actual Actual image.
+		 */
+		static void compareImages(const rp_image *expected, const rp_image *actual)
+		{
+			ASSERT_NE(nullptr, expected);
+			ASSERT_NE(nullptr, actual);
+			ASSERT_EQ(expected->format(), actual->format());
+			ASSERT_EQ(expected->width(), actual->width());
+			ASSERT_EQ(expected->height(), actual->height());
+
+			const size_t row_bytes = expected->width() * sizeof(uint32_t);
+			for (int y = 0; y < expected->height(); y++) {
+				ASSERT_EQ(0, memcmp(expected->scanLine(y), actual->scanLine(y), row_bytes))
+					<< "row " << y;
+			}
+		}
+};
+
+/**
+ * Decode a DXT1 image in bands using regular reads.
+ */
+TEST_F(ImageDecoderStreamTest, dxt1Banded)
+{
+	const int tileRowSize = DXT1_TILE_ROW_SIZE;
+	const int img_siz = DXT1_IMAGE_SIZE;
+	vector<uint8_t> buf = randomBuffer(img_siz + 1);
+
+	rp_image *const expected = ImageDecoder::fromDXT1(WIDTH, HEIGHT, &buf[1], img_siz);
+
+	// NOTE: The image data starts at an odd address, so peek()
+	// can't be used, and the image is read in bands.
+	RpMemFile *const file = new RpMemFile(buf.data(), buf.size());
+	rp_image *const actual = ImageDecoder::fromFile_banded(decodeBand_DXT1, nullptr,
+		WIDTH, HEIGHT, 4, tileRowSize, file, 1);
+	compareImages(expected, actual);
+
+	UNREF(actual);
+	file->unref();
+	expected->unref();
+}
+
+/**
+ * Decode a DXT1 image directly from a memory-backed file.
+ */
+TEST_F(ImageDecoderStreamTest, dxt1Peek)
+{
+	const int tileRowSize = DXT1_TILE_ROW_SIZE;
+	const int img_siz = DXT1_IMAGE_SIZE;
+	vector<uint8_t> buf = randomBuffer(img_siz);
+
+	rp_image *const expected = ImageDecoder::fromDXT1(WIDTH, HEIGHT, buf.data(), img_siz);
+
+	RpMemFile *const file = new RpMemFile(buf.data(), buf.size());
+	rp_image *const actual = ImageDecoder::fromFile_banded(decodeBand_DXT1, nullptr,
+		WIDTH, HEIGHT, 4, tileRowSize, file, 0);
+	compareImages(expected, actual);
+
+	UNREF(actual);
+	file->unref();
+	expected->unref();
+}
+
+/**
+ * Decode a linear image with a padded stride in bands.
+ */
+TEST_F(ImageDecoderStreamTest, linearStrideBanded)
+{
+	int stride = (WIDTH + 4) * sizeof(uint32_t);
+	const int img_siz = stride * HEIGHT;
+	vector<uint8_t> buf = randomBuffer(img_siz + 4);
+
+	// Copy the image data to an aligned buffer for the reference image.
+	vector<uint32_t> ref(img_siz / sizeof(uint32_t));
+	memcpy(ref.data(), &buf[4], img_siz);
+	rp_image *const expected = ImageDecoder::fromLinear32(ImageDecoder::PixelFormat::ARGB8888,
+		WIDTH, HEIGHT, ref.data(), img_siz, stride);
+
+	// NOTE: The image data starts at a non-16-byte-aligned address,
+	// so peek() can't be used, and the image is read in bands.
+	RpMemFile *const file = new RpMemFile(buf.data(), buf.size());
+	rp_image *const actual = ImageDecoder::fromFile_banded(decodeBand_ARGB8888, &stride,
+		WIDTH, HEIGHT, 1, stride, file, 4);
+	compareImages(expected, actual);
+
+	UNREF(actual);
+	file->unref();
+	expected->unref();
+}
+
+/**
+ * Verify that a truncated file fails to decode.
+ */
+TEST_F(ImageDecoderStreamTest, truncatedFile)
+{
+	const int tileRowSize = DXT1_TILE_ROW_SIZE;
+	const int img_siz = DXT1_IMAGE_SIZE;
+	vector<uint8_t> buf = randomBuffer(img_siz);
+
+	RpMemFile *const file = new RpMemFile(buf.data(), buf.size());
+	rp_image *const img = ImageDecoder::fromFile_banded(decodeBand_DXT1, nullptr,
+		WIDTH, HEIGHT, 4, tileRowSize, file, 1);
+	EXPECT_EQ(nullptr, img);
+
+	UNREF(img);
+	file->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: ImageDecoder streamed decoding tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
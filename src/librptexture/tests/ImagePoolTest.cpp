@@ -0,0 +1,149 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImagePoolTest.cpp: Test rp_image_backend_pooled.                        *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+#include "librptexture/img/rp_image_backend_pooled.hpp"
+
+// C includes.
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+namespace LibRpTexture { namespace Tests {
+
+class ImagePoolTest : public ::testing::Test
+{
+	protected:
+		void SetUp(void) final
+		{
+			rp_image_backend_pooled::trim();
+		}
+
+		void TearDown(void) final
+		{
+			rp_image_backend_pooled::trim();
+		}
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100000;
+
+		/**
+		 * Create an rp_image using rp_image_backend_pooled.
+		 * @param width Image width.
+		 * @param height Image height.
+		 * @param format Image format.
+		 * @return rp_image.
+		 */
+		static inline rp_image *createPooledImage(int width, int height, rp_image::Format format)
+		{
+			return new rp_image(rp_image_backend_pooled::creator_fn(width, height, format));
+		}
+};
+
+/**
+ * Verify that a freed image's buffer is reused for an image of a similar size.
+ */
+TEST_F(ImagePoolTest, reuseBuffer)
+{
+	rp_image *img = createPooledImage(64, 64, rp_image::Format::ARGB32);
+	ASSERT_TRUE(img->isValid());
+	const void *const bits = img->bits();
+	img->unref();
+	EXPECT_EQ(16384U, rp_image_backend_pooled::cached_size());
+
+	// 60x60 ARGB32 uses the same bucket as 64x64 ARGB32.
+	img = createPooledImage(60, 60, rp_image::Format::ARGB32);
+	ASSERT_TRUE(img->isValid());
+	EXPECT_EQ(bits, img->bits());
+	EXPECT_EQ(0U, rp_image_backend_pooled::cached_size());
+	img->unref();
+}
+
+/**
+ * Verify that a reused CI8 palette is cleared.
+ */
+TEST_F(ImagePoolTest, ci8PaletteCleared)
+{
+	rp_image *img = createPooledImage(32, 32, rp_image::Format::CI8);
+	ASSERT_TRUE(img->isValid());
+	ASSERT_EQ(256, img->palette_len());
+	memset(img->palette(), 0x55, img->palette_len() * sizeof(uint32_t));
+	img->unref();
+
+	img = createPooledImage(32, 32, rp_image::Format::CI8);
+	ASSERT_TRUE(img->isValid());
+	ASSERT_EQ(256, img->palette_len());
+	const uint32_t *const palette = img->palette();
+	for (int i = 0; i < img->palette_len(); i++) {
+		EXPECT_EQ(0U, palette[i]) << "palette index " << i;
+	}
+	img->unref();
+}
+
+/**
+ * Verify that trim() frees all cached buffers.
+ */
+TEST_F(ImagePoolTest, trim)
+{
+	rp_image *const img1 = createPooledImage(128, 128, rp_image::Format::ARGB32);
+	rp_image *const img2 = createPooledImage(16, 16, rp_image::Format::CI8);
+	img1->unref();
+	img2->unref();
+	EXPECT_GT(rp_image_backend_pooled::cached_size(), 0U);
+
+	rp_image_backend_pooled::trim();
+	EXPECT_EQ(0U, rp_image_backend_pooled::cached_size());
+}
+
+/**
+ * Benchmark allocating and freeing small ARGB32 images.
+ */
+TEST_F(ImagePoolTest, pooled_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		createPooledImage(32, 32, rp_image::Format::ARGB32)->unref();
+	}
+}
+
+/**
+ * Benchmark allocating and freeing small ARGB32 images.
+ * (Default backend)
+ */
+TEST_F(ImagePoolTest, default_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		(new rp_image(32, 32, rp_image::Format::ARGB32))->unref();
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: rp_image_backend_pooled tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ImagePoolTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,352 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageScaleTest.cpp: Test rp_image::scaled().                            *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+
+// C includes.
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+namespace LibRpTexture { namespace Tests {
+
+class ImageScaleTest : public ::testing::Test
+{
+	protected:
+		ImageScaleTest()
+			: m_img(new rp_image(1024, 1024, rp_image::Format::ARGB32))
+		{
+			// Initialize the image with pseudo-random data.
+			// Alpha values are included in order to test
+			// premultiplication.
+			uint32_t seed = 0x12345678;
+			for (int y = 0; y < m_img->height(); y++) {
+				uint32_t *px = static_cast<uint32_t*>(m_img->scanLine(y));
+				for (int x = m_img->width(); x > 0; x--, px++) {
+					seed = (seed * 1103515245U) + 12345U;
+					*px = seed;
+				}
+			}
+		}
+
+		~ImageScaleTest()
+		{
+			m_img->unref();
+		}
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100;
+
+		// Image.
+		rp_image *m_img;
+
+	public:
+		/**
+		 * Compare two ARGB32 images.
+		 * @param expected Expected image.
+		 * @param actual Actual image.
+		 */
+		static void Compare_RpImage(const rp_image *expected, const rp_image *actual);
+
+		/**
+		 * Compare an optimized scaling function to the standard version.
+		 * @param pfn Optimized scaling function.
+		 */
+		void Compare_ScaleFunction(rp_image *(rp_image::*pfn)(int, int, rp_image::ScaleFilter) const);
+};
+
+/**
+ * Compare two ARGB32 images.
+ * @param expected Expected image.
+ * @param actual Actual image.
+ */
+void ImageScaleTest::Compare_RpImage(const rp_image *expected, const rp_image *actual)
+{
+	ASSERT_TRUE(expected != nullptr);
+	ASSERT_TRUE(actual != nullptr);
+	ASSERT_EQ(expected->format(), actual->format());
+	ASSERT_EQ(expected->width(), actual->width());
+	ASSERT_EQ(expected->height(), actual->height());
+
+	const size_t row_bytes = expected->width() * sizeof(uint32_t);
+	for (int y = 0; y < expected->height(); y++) {
+		ASSERT_EQ(0, memcmp(expected->scanLine(y), actual->scanLine(y), row_bytes)) <<
+			"Row " << y << " doesn't match.";
+	}
+}
+
+/**
+ * Compare an optimized scaling function to the standard version.
+ * @param pfn Optimized scaling function.
+ */
+void ImageScaleTest::Compare_ScaleFunction(rp_image *(rp_image::*pfn)(int, int, rp_image::ScaleFilter) const)
+{
+	// Sizes include widths that aren't a multiple of the
+	// SIMD vector size, plus upscaling.
+	static const struct {
+		int width;
+		int height;
+	} sizes[] = {
+		{256, 256}, {255, 129}, {100, 37}, {1, 1},
+		{1024, 300}, {300, 1024}, {1500, 1100},
+	};
+	static const rp_image::ScaleFilter filters[] = {
+		rp_image::ScaleFilter::Box,
+		rp_image::ScaleFilter::Bilinear,
+	};
+
+	for (const auto &filter : filters) {
+		for (const auto &sz : sizes) {
+			rp_image *const expected = m_img->scaled_cpp(sz.width, sz.height, filter);
+			rp_image *const actual = (m_img->*pfn)(sz.width, sz.height, filter);
+			EXPECT_NO_FATAL_FAILURE(Compare_RpImage(expected, actual)) <<
+				"Size: " << sz.width << 'x' << sz.height <<
+				", filter: " << static_cast<int>(filter);
+			UNREF(expected);
+			UNREF(actual);
+		}
+	}
+}
+
+/**
+ * Test box filter averaging.
+ */
+TEST_F(ImageScaleTest, box_average)
+{
+	// 4x4 image with opaque 2x2 blocks.
+	static const uint32_t blocks[4] = {
+		0xFF000000, 0xFFFFFFFF,
+		0xFF204060, 0xFF6080A0,
+	};
+	rp_image *const img = new rp_image(4, 4, rp_image::Format::ARGB32);
+	for (int y = 0; y < 4; y++) {
+		uint32_t *const px = static_cast<uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < 4; x++) {
+			px[x] = blocks[((y / 2) * 2) + (x / 2)];
+		}
+	}
+
+	// Scale to 2x2. Each block becomes a single pixel.
+	rp_image *scaled = img->scaled(2, 2, rp_image::ScaleFilter::Box);
+	ASSERT_TRUE(scaled != nullptr);
+	EXPECT_EQ(rp_image::Format::ARGB32, scaled->format());
+	EXPECT_EQ(2, scaled->width());
+	EXPECT_EQ(2, scaled->height());
+	for (int y = 0; y < 2; y++) {
+		const uint32_t *const px = static_cast<const uint32_t*>(scaled->scanLine(y));
+		EXPECT_EQ(blocks[(y * 2) + 0], px[0]);
+		EXPECT_EQ(blocks[(y * 2) + 1], px[1]);
+	}
+	scaled->unref();
+
+	// Scale to 1x1. All blocks are averaged.
+	scaled = img->scaled(1, 1, rp_image::ScaleFilter::Box);
+	ASSERT_TRUE(scaled != nullptr);
+	EXPECT_EQ(0xFF607080U, *static_cast<const uint32_t*>(scaled->bits()));
+	scaled->unref();
+
+	img->unref();
+}
+
+/**
+ * Verify that transparent pixels don't affect the color of
+ * opaque pixels when scaling. (premultiplied alpha)
+ */
+TEST_F(ImageScaleTest, premultiplied_alpha)
+{
+	// Transparent red and opaque blue.
+	rp_image *const img = new rp_image(2, 1, rp_image::Format::ARGB32);
+	uint32_t *const px = static_cast<uint32_t*>(img->bits());
+	px[0] = 0x00FF0000;
+	px[1] = 0xFF0000FF;
+
+	// Result should be semi-transparent blue, not purple.
+	rp_image *const scaled = img->scaled(1, 1, rp_image::ScaleFilter::Box);
+	ASSERT_TRUE(scaled != nullptr);
+	EXPECT_EQ(0x800000FFU, *static_cast<const uint32_t*>(scaled->bits()));
+	scaled->unref();
+
+	img->unref();
+}
+
+/**
+ * Verify that CI8 images are scaled correctly.
+ */
+TEST_F(ImageScaleTest, ci8_source)
+{
+	rp_image *const img = new rp_image(4, 4, rp_image::Format::CI8);
+	uint32_t *const palette = img->palette();
+	ASSERT_TRUE(palette != nullptr);
+	palette[0] = 0xFF102030;
+	palette[1] = 0xFF304050;
+	for (int y = 0; y < 4; y++) {
+		memset(img->scanLine(y), (y < 2 ? 0 : 1), 4);
+	}
+
+	rp_image *const scaled = img->scaled(1, 2, rp_image::ScaleFilter::Box);
+	ASSERT_TRUE(scaled != nullptr);
+	EXPECT_EQ(rp_image::Format::ARGB32, scaled->format());
+	const uint32_t *const px0 = static_cast<const uint32_t*>(scaled->scanLine(0));
+	const uint32_t *const px1 = static_cast<const uint32_t*>(scaled->scanLine(1));
+	EXPECT_EQ(0xFF102030U, *px0);
+	EXPECT_EQ(0xFF304050U, *px1);
+	scaled->unref();
+
+	img->unref();
+}
+
+#ifdef RP_IMAGE_HAS_SSE2
+/**
+ * Compare rp_image::scaled_sse2() to rp_image::scaled_cpp().
+ */
+TEST_F(ImageScaleTest, scaled_sse2_test)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	ASSERT_NO_FATAL_FAILURE(Compare_ScaleFunction(&rp_image::scaled_sse2));
+}
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Compare rp_image::scaled_avx2() to rp_image::scaled_cpp().
+ */
+TEST_F(ImageScaleTest, scaled_avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	ASSERT_NO_FATAL_FAILURE(Compare_ScaleFunction(&rp_image::scaled_avx2));
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+#ifdef RP_IMAGE_HAS_NEON
+/**
+ * Compare rp_image::scaled_neon() to rp_image::scaled_cpp().
+ */
+TEST_F(ImageScaleTest, scaled_neon_test)
+{
+	if (!RP_CPU_HasNEON()) {
+		fprintf(stderr, "*** NEON is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	ASSERT_NO_FATAL_FAILURE(Compare_ScaleFunction(&rp_image::scaled_neon));
+}
+#endif /* RP_IMAGE_HAS_NEON */
+
+/**
+ * Benchmark the rp_image::scaled() function. (Standard version)
+ */
+TEST_F(ImageScaleTest, scaled_cpp_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const scaled = m_img->scaled_cpp(256, 256, rp_image::ScaleFilter::Box);
+		UNREF(scaled);
+	}
+}
+
+#ifdef RP_IMAGE_HAS_SSE2
+/**
+ * Benchmark the rp_image::scaled() function. (SSE2-optimized version)
+ */
+TEST_F(ImageScaleTest, scaled_sse2_benchmark)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const scaled = m_img->scaled_sse2(256, 256, rp_image::ScaleFilter::Box);
+		UNREF(scaled);
+	}
+}
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Benchmark the rp_image::scaled() function. (AVX2-optimized version)
+ */
+TEST_F(ImageScaleTest, scaled_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const scaled = m_img->scaled_avx2(256, 256, rp_image::ScaleFilter::Box);
+		UNREF(scaled);
+	}
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+#ifdef RP_IMAGE_HAS_NEON
+/**
+ * Benchmark the rp_image::scaled() function. (NEON-optimized version)
+ */
+TEST_F(ImageScaleTest, scaled_neon_benchmark)
+{
+	if (!RP_CPU_HasNEON()) {
+		fprintf(stderr, "*** NEON is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const scaled = m_img->scaled_neon(256, 256, rp_image::ScaleFilter::Box);
+		UNREF(scaled);
+	}
+}
+#endif /* RP_IMAGE_HAS_NEON */
+
+// NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
+#if defined(RP_IMAGE_HAS_SSE2) || defined(RP_IMAGE_HAS_AVX2) || defined(RP_IMAGE_HAS_NEON)
+/**
+ * Benchmark the rp_image::scaled() dispatch function.
+ */
+TEST_F(ImageScaleTest, scaled_dispatch_benchmark)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		rp_image *const scaled = m_img->scaled(256, 256, rp_image::ScaleFilter::Box);
+		UNREF(scaled);
+	}
+}
+#endif /* RP_IMAGE_HAS_SSE2 || RP_IMAGE_HAS_AVX2 || RP_IMAGE_HAS_NEON */
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: rp_image::scaled() tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::ImageScaleTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,147 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * ImageViewTest.cpp: Test rp_image copy-on-write views.                   *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+
+// C includes.
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+namespace LibRpTexture { namespace Tests {
+
+class ImageViewTest : public ::testing::Test
+{
+	public:
+		/**
+		 * Create an ARGB32 rp_image with a unique value in each pixel.
+		 * @param width Image width.
+		 * @param height Image height.
+		 * @return rp_image.
+		 */
+		static rp_image *createTestImage(int width, int height)
+		{
+			rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+			for (int y = 0; y < height; y++) {
+				uint32_t *const line = static_cast<uint32_t*>(img->scanLine(y));
+				for (int x = 0; x < width; x++) {
+					line[x] = 0xFF000000U | (y << 12) | x;
+				}
+			}
+			return img;
+		}
+};
+
+/**
+ * Verify that dup() shares the image data until it's modified.
+ */
+TEST_F(ImageViewTest, dupCopyOnWrite)
+{
+	rp_image *const img = createTestImage(64, 32);
+	const rp_image *const c_img = img;
+	rp_image *const dup = img->dup();
+	ASSERT_TRUE(dup->isValid());
+	const rp_image *const c_dup = dup;
+
+	// Image data should be shared.
+	EXPECT_EQ(c_img->bits(), c_dup->bits());
+	EXPECT_EQ(c_img->stride(), c_dup->stride());
+
+	// Modifying the duplicate should detach it.
+	uint32_t *const bits = static_cast<uint32_t*>(dup->bits());
+	EXPECT_NE(c_img->bits(), c_dup->bits());
+	bits[0] = 0x12345678;
+	EXPECT_EQ(0xFF000000U, static_cast<const uint32_t*>(c_img->bits())[0]);
+
+	// Remaining pixels should have been copied.
+	for (int y = 0; y < 32; y++) {
+		const uint32_t *const line = static_cast<const uint32_t*>(c_dup->scanLine(y));
+		for (int x = (y == 0 ? 1 : 0); x < 64; x++) {
+			ASSERT_EQ(0xFF000000U | (y << 12) | x, line[x]) << "x == " << x << ", y == " << y;
+		}
+	}
+
+	dup->unref();
+	img->unref();
+}
+
+/**
+ * Verify that cropping with resized() shares the correct rows.
+ */
+TEST_F(ImageViewTest, resizedCropView)
+{
+	rp_image *const img = createTestImage(64, 64);
+	const rp_image *const c_img = img;
+
+	rp_image *const crop = img->resized(48, 32, rp_image::AlignVCenter);
+	ASSERT_TRUE(crop->isValid());
+	EXPECT_EQ(48, crop->width());
+	EXPECT_EQ(32, crop->height());
+
+	const rp_image *const c_crop = crop;
+	EXPECT_EQ(c_img->scanLine(16), c_crop->scanLine(0));
+	for (int y = 0; y < 32; y++) {
+		const uint32_t *const line = static_cast<const uint32_t*>(c_crop->scanLine(y));
+		for (int x = 0; x < 48; x++) {
+			ASSERT_EQ(0xFF000000U | ((y + 16) << 12) | x, line[x]) << "x == " << x << ", y == " << y;
+		}
+	}
+
+	// Modifying the original image should detach it.
+	// The cropped image must not be changed.
+	memset(img->bits(), 0, img->data_len());
+	EXPECT_EQ(0xFF000000U | (16 << 12), static_cast<const uint32_t*>(c_crop->bits())[0]);
+
+	crop->unref();
+	img->unref();
+}
+
+/**
+ * Verify that a CI8 view has its own copy of the palette.
+ */
+TEST_F(ImageViewTest, ci8Palette)
+{
+	rp_image *const img = new rp_image(16, 16, rp_image::Format::CI8);
+	img->palette()[1] = 0xFF123456;
+	img->set_tr_idx(0);
+
+	rp_image *const dup = img->dup();
+	ASSERT_TRUE(dup->isValid());
+	EXPECT_EQ(0xFF123456U, dup->palette()[1]);
+	EXPECT_EQ(0, dup->tr_idx());
+
+	dup->palette()[1] = 0;
+	EXPECT_EQ(0xFF123456U, img->palette()[1]);
+
+	dup->unref();
+	img->unref();
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: rp_image copy-on-write view tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (librptexture/tests)               *
  * UnPremutiplyTest.cpp: Test un_premultiply().                            *
  *                                                                         *
- * Copyright (c) 2016-2020 by David Korth.                                 *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -54,8 +54,147 @@ class UnPremultiplyTest : public ::testing::Test
 		rp_image *m_img;
 };
 
-// TODO: Add actual tests to verify that un-premultiply works.
-// Currently we only have benchmark tests.
+/**
+ * Create an ARGB32 image with pseudo-random pixels for correctness tests.
+ * The width isn't a multiple of 8, so the remaining pixels
+ * in each row are also tested.
+ * Every alpha value, including 0 and 255, is present.
+ * @param premultiplied If true, the image will be premultiplied.
+ * @return rp_image
+ */
+static rp_image *createRandomImage(bool premultiplied)
+{
+	rp_image *const img = new rp_image(509, 67, rp_image::Format::ARGB32);
+	uint32_t seed = 0x12345678U;
+	for (int y = 0; y < img->height(); y++) {
+		uint32_t *px = static_cast<uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < img->width(); x++, px++) {
+			seed = (seed * 1103515245U) + 12345U;
+			*px = (seed & 0x00FFFFFFU) | (static_cast<uint32_t>((x + y) & 0xFF) << 24);
+		}
+	}
+
+	if (premultiplied) {
+		// NOTE: un_premultiply() results are only well-defined
+		// if no color channel is larger than the alpha channel.
+		img->premultiply_cpp();
+	}
+	return img;
+}
+
+/**
+ * Compare two images.
+ * @param expected Expected image.
+ * @param actual Actual image.
+ * @return AssertionResult
+ */
+static ::testing::AssertionResult compareImages(const rp_image *expected, const rp_image *actual)
+{
+	const size_t row_bytes = expected->width() * sizeof(uint32_t);
+	for (int y = 0; y < expected->height(); y++) {
+		const uint32_t *const px_expected = static_cast<const uint32_t*>(expected->scanLine(y));
+		const uint32_t *const px_actual = static_cast<const uint32_t*>(actual->scanLine(y));
+		if (memcmp(px_expected, px_actual, row_bytes) != 0) {
+			for (int x = 0; x < expected->width(); x++) {
+				if (px_expected[x] != px_actual[x]) {
+					char buf[64];
+					snprintf(buf, sizeof(buf), "(%d,%d): expected %08X, got %08X",
+						x, y, px_expected[x], px_actual[x]);
+					return ::testing::AssertionFailure() << buf;
+				}
+			}
+		}
+	}
+	return ::testing::AssertionSuccess();
+}
+
+/**
+ * Test a premultiply or un-premultiply function against the standard version.
+ * @param cpp_fn Standard version.
+ * @param test_fn Optimized version.
+ * @param premultiplied If true, use a premultiplied source image.
+ */
+static void testAgainstCpp(int (rp_image::*cpp_fn)(void), int (rp_image::*test_fn)(void), bool premultiplied)
+{
+	rp_image *const img_cpp = createRandomImage(premultiplied);
+	rp_image *const img_test = img_cpp->dup();
+	ASSERT_EQ(0, (img_cpp->*cpp_fn)());
+	ASSERT_EQ(0, (img_test->*test_fn)());
+	EXPECT_TRUE(compareImages(img_cpp, img_test));
+	img_cpp->unref();
+	img_test->unref();
+}
+
+/**
+ * Test premultiply() and un_premultiply() with known pixel values.
+ */
+TEST_F(UnPremultiplyTest, known_values)
+{
+	rp_image *const img = new rp_image(3, 1, rp_image::Format::ARGB32);
+	uint32_t *const px = static_cast<uint32_t*>(img->bits());
+	px[0] = 0x80FF8040U;
+	px[1] = 0x00FF0000U;	// fully transparent: left as-is
+	px[2] = 0xFF123456U;	// fully opaque: left as-is
+
+	ASSERT_EQ(0, img->premultiply());
+	EXPECT_EQ(0x80804020U, px[0]);
+	EXPECT_EQ(0x00FF0000U, px[1]);
+	EXPECT_EQ(0xFF123456U, px[2]);
+
+	ASSERT_EQ(0, img->un_premultiply());
+	EXPECT_EQ(0x80FF8040U, px[0]);
+	EXPECT_EQ(0x00FF0000U, px[1]);
+	EXPECT_EQ(0xFF123456U, px[2]);
+	img->unref();
+}
+
+#ifdef RP_IMAGE_HAS_SSE41
+/**
+ * Test the SSE4.1-optimized functions against the standard versions.
+ */
+TEST_F(UnPremultiplyTest, sse41_test)
+{
+	if (!RP_CPU_HasSSE41()) {
+		fprintf(stderr, "*** SSE4.1 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	testAgainstCpp(&rp_image::un_premultiply_cpp, &rp_image::un_premultiply_sse41, true);
+	testAgainstCpp(&rp_image::premultiply_cpp, &rp_image::premultiply_sse41, false);
+}
+#endif /* RP_IMAGE_HAS_SSE41 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Test the AVX2-optimized functions against the standard versions.
+ */
+TEST_F(UnPremultiplyTest, avx2_test)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	testAgainstCpp(&rp_image::un_premultiply_cpp, &rp_image::un_premultiply_avx2, true);
+	testAgainstCpp(&rp_image::premultiply_cpp, &rp_image::premultiply_avx2, false);
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+#ifdef RP_IMAGE_HAS_NEON
+/**
+ * Test the NEON-optimized functions against the standard versions.
+ */
+TEST_F(UnPremultiplyTest, neon_test)
+{
+	if (!RP_CPU_HasNEON()) {
+		fprintf(stderr, "*** NEON is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	testAgainstCpp(&rp_image::un_premultiply_cpp, &rp_image::un_premultiply_neon, true);
+	testAgainstCpp(&rp_image::premultiply_cpp, &rp_image::premultiply_neon, false);
+}
+#endif /* RP_IMAGE_HAS_NEON */
 
 /**
  * Benchmark the ImageDecoder::un_premultiply() function. (Standard version)
@@ -84,8 +223,42 @@ TEST_F(UnPremultiplyTest, un_premultiply_sse41_benchmark)
 }
 #endif /* RP_IMAGE_HAS_SSE41 */
 
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Benchmark the ImageDecoder::un_premultiply() function. (AVX2-optimized version)
+ */
+TEST_F(UnPremultiplyTest, un_premultiply_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->un_premultiply_avx2();
+	}
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+#ifdef RP_IMAGE_HAS_NEON
+/**
+ * Benchmark the ImageDecoder::un_premultiply() function. (NEON-optimized version)
+ */
+TEST_F(UnPremultiplyTest, un_premultiply_neon_benchmark)
+{
+	if (!RP_CPU_HasNEON()) {
+		fprintf(stderr, "*** NEON is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->un_premultiply_neon();
+	}
+}
+#endif /* RP_IMAGE_HAS_NEON */
+
 // NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
-#if defined(RP_IMAGE_HAS_SSE41)
+#if defined(RP_IMAGE_HAS_SSE41) || defined(RP_IMAGE_HAS_AVX2) || defined(RP_IMAGE_HAS_NEON)
 /**
  * Benchmark the ImageDecoder::un_premultiply() dispatch function.
  */
@@ -95,17 +268,81 @@ TEST_F(UnPremultiplyTest, un_premultiply_dispatch_benchmark)
 		m_img->un_premultiply();
 	}
 }
-#endif /* RP_IMAGE_HAS_SSE41 */
+#endif /* RP_IMAGE_HAS_SSE41 || RP_IMAGE_HAS_AVX2 || RP_IMAGE_HAS_NEON */
 
 /**
  * Benchmark the ImageDecoder::premultiply() function. (Standard version)
  */
 TEST_F(UnPremultiplyTest, premultiply_cpp)
+{
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->premultiply_cpp();
+	}
+}
+
+#ifdef RP_IMAGE_HAS_NEON
+/**
+ * Benchmark the ImageDecoder::premultiply() function. (NEON-optimized version)
+ */
+TEST_F(UnPremultiplyTest, premultiply_neon)
+{
+	if (!RP_CPU_HasNEON()) {
+		fprintf(stderr, "*** NEON is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->premultiply_neon();
+	}
+}
+#endif /* RP_IMAGE_HAS_NEON */
+
+#ifdef RP_IMAGE_HAS_SSE41
+/**
+ * Benchmark the ImageDecoder::premultiply() function. (SSE4.1-optimized version)
+ */
+TEST_F(UnPremultiplyTest, premultiply_sse41_benchmark)
+{
+	if (!RP_CPU_HasSSE41()) {
+		fprintf(stderr, "*** SSE4.1 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->premultiply_sse41();
+	}
+}
+#endif /* RP_IMAGE_HAS_SSE41 */
+
+#ifdef RP_IMAGE_HAS_AVX2
+/**
+ * Benchmark the ImageDecoder::premultiply() function. (AVX2-optimized version)
+ */
+TEST_F(UnPremultiplyTest, premultiply_avx2_benchmark)
+{
+	if (!RP_CPU_HasAVX2()) {
+		fprintf(stderr, "*** AVX2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->premultiply_avx2();
+	}
+}
+#endif /* RP_IMAGE_HAS_AVX2 */
+
+// NOTE: Add more instruction sets to the #ifdef if other optimizations are added.
+#if defined(RP_IMAGE_HAS_SSE41) || defined(RP_IMAGE_HAS_AVX2) || defined(RP_IMAGE_HAS_NEON)
+/**
+ * Benchmark the ImageDecoder::premultiply() dispatch function.
+ */
+TEST_F(UnPremultiplyTest, premultiply_dispatch_benchmark)
 {
 	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
 		m_img->premultiply();
 	}
 }
+#endif /* RP_IMAGE_HAS_SSE41 || RP_IMAGE_HAS_AVX2 || RP_IMAGE_HAS_NEON */
 
 } }
 
@@ -0,0 +1,26 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * CondVar.hpp: System-specific condition variable implementation.         *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTHREADS_CONDVAR_HPP__
+#define __ROMPROPERTIES_LIBRPTHREADS_CONDVAR_HPP__
+
+// CondVar::wait() requires access to the Mutex internals.
+#include "Mutex.hpp"
+
+// NOTE: The .cpp files are #included here in order to inline the functions.
+// Do NOT compile them separately!
+
+// Each .cpp file defines the CondVar class itself, with required fields.
+
+#ifdef _WIN32
+# include "CondVarWin32.cpp"
+#else /* !_WIN32 */
+# include "CondVarPosix.cpp"
+#endif
+
+#endif /* __ROMPROPERTIES_LIBRPTHREADS_CONDVAR_HPP__ */
@@ -0,0 +1,181 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * CondVarPosix.cpp: POSIX condition variable implementation.              *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include <pthread.h>
+#include <sys/time.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+namespace LibRpThreads {
+
+class CondVar
+{
+	public:
+		/**
+		 * Create a condition variable.
+		 */
+		inline explicit CondVar();
+
+		/**
+		 * Delete the condition variable.
+		 * WARNING: No threads may be waiting on it!
+		 */
+		inline ~CondVar();
+
+	private:
+#if __cplusplus >= 201103L
+		CondVar(const CondVar &) = delete; \
+		CondVar &operator=(const CondVar &) = delete;
+#else /* __cplusplus < 201103L */
+		CondVar(const CondVar &); \
+		CondVar &operator=(const CondVar &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Wait for the condition variable to be signalled.
+		 * The mutex must be locked by the caller. It's unlocked
+		 * while waiting, and locked again before returning.
+		 *
+		 * NOTE: Spurious wakeups are possible, so the caller
+		 * should check its condition in a loop.
+		 *
+		 * @param mutex Locked mutex.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int wait(Mutex &mutex);
+
+		/**
+		 * Wait for the condition variable to be signalled, with a timeout.
+		 * The mutex must be locked by the caller. It's unlocked
+		 * while waiting, and locked again before returning.
+		 * @param mutex Locked mutex.
+		 * @param msec Timeout, in milliseconds.
+		 * @return 0 on success; -ETIMEDOUT on timeout; other non-zero on error.
+		 */
+		inline int wait(Mutex &mutex, unsigned int msec);
+
+		/**
+		 * Wake up one waiting thread.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int signal(void);
+
+		/**
+		 * Wake up all waiting threads.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int broadcast(void);
+
+	private:
+		pthread_cond_t m_cond;
+		bool m_isInit;
+};
+
+/**
+ * Create a condition variable.
+ */
+inline CondVar::CondVar()
+	: m_isInit(false)
+{
+	int ret = pthread_cond_init(&m_cond, nullptr);
+	assert(ret == 0);
+	if (ret == 0) {
+		m_isInit = true;
+	} else {
+		// FIXME: Do something if an error occurred here...
+	}
+}
+
+/**
+ * Delete the condition variable.
+ * WARNING: No threads may be waiting on it!
+ */
+inline CondVar::~CondVar()
+{
+	if (m_isInit) {
+		// TODO: Error checking.
+		pthread_cond_destroy(&m_cond);
+	}
+}
+
+/**
+ * Wait for the condition variable to be signalled.
+ * The mutex must be locked by the caller. It's unlocked
+ * while waiting, and locked again before returning.
+ *
+ * NOTE: Spurious wakeups are possible, so the caller
+ * should check its condition in a loop.
+ *
+ * @param mutex Locked mutex.
+ * @return 0 on success; non-zero on error.
+ */
+inline int CondVar::wait(Mutex &mutex)
+{
+	if (!m_isInit || !mutex.m_isInit)
+		return -EBADF;
+
+	return -pthread_cond_wait(&m_cond, &mutex.m_mutex);
+}
+
+/**
+ * Wait for the condition variable to be signalled, with a timeout.
+ * The mutex must be locked by the caller. It's unlocked
+ * while waiting, and locked again before returning.
+ * @param mutex Locked mutex.
+ * @param msec Timeout, in milliseconds.
+ * @return 0 on success; -ETIMEDOUT on timeout; other non-zero on error.
+ */
+inline int CondVar::wait(Mutex &mutex, unsigned int msec)
+{
+	if (!m_isInit || !mutex.m_isInit)
+		return -EBADF;
+
+	// NOTE: Using gettimeofday() because clock_gettime()
+	// isn't available on older versions of macOS.
+	struct timeval tv;
+	gettimeofday(&tv, nullptr);
+	struct timespec ts;
+	ts.tv_sec = tv.tv_sec + (msec / 1000);
+	long nsec = (tv.tv_usec * 1000L) + ((msec % 1000) * 1000000L);
+	if (nsec >= 1000000000L) {
+		ts.tv_sec++;
+		nsec -= 1000000000L;
+	}
+	ts.tv_nsec = nsec;
+
+	return -pthread_cond_timedwait(&m_cond, &mutex.m_mutex, &ts);
+}
+
+/**
+ * Wake up one waiting thread.
+ * @return 0 on success; non-zero on error.
+ */
+inline int CondVar::signal(void)
+{
+	if (!m_isInit)
+		return -EBADF;
+
+	return -pthread_cond_signal(&m_cond);
+}
+
+/**
+ * Wake up all waiting threads.
+ * @return 0 on success; non-zero on error.
+ */
+inline int CondVar::broadcast(void)
+{
+	if (!m_isInit)
+		return -EBADF;
+
+	return -pthread_cond_broadcast(&m_cond);
+}
+
+}
@@ -0,0 +1,150 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * CondVarWin32.cpp: Win32 condition variable implementation.              *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+#ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+
+namespace LibRpThreads {
+
+class CondVar
+{
+	public:
+		/**
+		 * Create a condition variable.
+		 */
+		inline explicit CondVar();
+
+		/**
+		 * Delete the condition variable.
+		 * WARNING: No threads may be waiting on it!
+		 */
+		inline ~CondVar() { }
+
+	private:
+#if __cplusplus >= 201103L
+		CondVar(const CondVar &) = delete; \
+		CondVar &operator=(const CondVar &) = delete;
+#else /* __cplusplus < 201103L */
+		CondVar(const CondVar &); \
+		CondVar &operator=(const CondVar &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Wait for the condition variable to be signalled.
+		 * The mutex must be locked by the caller. It's unlocked
+		 * while waiting, and locked again before returning.
+		 *
+		 * NOTE: Spurious wakeups are possible, so the caller
+		 * should check its condition in a loop.
+		 *
+		 * @param mutex Locked mutex.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int wait(Mutex &mutex);
+
+		/**
+		 * Wait for the condition variable to be signalled, with a timeout.
+		 * The mutex must be locked by the caller. It's unlocked
+		 * while waiting, and locked again before returning.
+		 * @param mutex Locked mutex.
+		 * @param msec Timeout, in milliseconds.
+		 * @return 0 on success; -ETIMEDOUT on timeout; other non-zero on error.
+		 */
+		inline int wait(Mutex &mutex, unsigned int msec);
+
+		/**
+		 * Wake up one waiting thread.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int signal(void);
+
+		/**
+		 * Wake up all waiting threads.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int broadcast(void);
+
+	private:
+		// NOTE: Condition variables require Windows Vista.
+		// They don't need to be deleted.
+		CONDITION_VARIABLE m_cond;
+};
+
+/**
+ * Create a condition variable.
+ */
+inline CondVar::CondVar()
+{
+	InitializeConditionVariable(&m_cond);
+}
+
+/**
+ * Wait for the condition variable to be signalled.
+ * The mutex must be locked by the caller. It's unlocked
+ * while waiting, and locked again before returning.
+ *
+ * NOTE: Spurious wakeups are possible, so the caller
+ * should check its condition in a loop.
+ *
+ * @param mutex Locked mutex.
+ * @return 0 on success; non-zero on error.
+ */
+inline int CondVar::wait(Mutex &mutex)
+{
+	if (!mutex.m_isInit)
+		return -EBADF;
+
+	return (SleepConditionVariableCS(&m_cond, &mutex.m_criticalSection, INFINITE) ? 0 : -EIO);
+}
+
+/**
+ * Wait for the condition variable to be signalled, with a timeout.
+ * The mutex must be locked by the caller. It's unlocked
+ * while waiting, and locked again before returning.
+ * @param mutex Locked mutex.
+ * @param msec Timeout, in milliseconds.
+ * @return 0 on success; -ETIMEDOUT on timeout; other non-zero on error.
+ */
+inline int CondVar::wait(Mutex &mutex, unsigned int msec)
+{
+	if (!mutex.m_isInit)
+		return -EBADF;
+
+	if (SleepConditionVariableCS(&m_cond, &mutex.m_criticalSection, msec))
+		return 0;
+	return (GetLastError() == ERROR_TIMEOUT ? -ETIMEDOUT : -EIO);
+}
+
+/**
+ * Wake up one waiting thread.
+ * @return 0 on success; non-zero on error.
+ */
+inline int CondVar::signal(void)
+{
+	WakeConditionVariable(&m_cond);
+	return 0;
+}
+
+/**
+ * Wake up all waiting threads.
+ * @return 0 on success; non-zero on error.
+ */
+inline int CondVar::broadcast(void)
+{
+	WakeAllConditionVariable(&m_cond);
+	return 0;
+}
+
+}
@@ -53,6 +53,7 @@ class Mutex
 		inline int unlock(void);
 
 	private:
+		friend class CondVar;
 		pthread_mutex_t m_mutex;
 		bool m_isInit;
 };
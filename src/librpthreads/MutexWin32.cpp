@@ -64,6 +64,7 @@ class Mutex
 		_Releases_lock_(this->m_criticalSection) inline int unlock(void);
 
 	private:
+		friend class CondVar;
 		// NOTE: Windows implementation uses critical sections,
 		// since they have less overhead than mutexes.
 		CRITICAL_SECTION m_criticalSection;
@@ -0,0 +1,153 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * RWLockPosix.cpp: POSIX reader-writer lock implementation.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include <pthread.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+namespace LibRpThreads {
+
+class RWLock
+{
+	public:
+		/**
+		 * Create a reader-writer lock.
+		 */
+		inline explicit RWLock();
+
+		/**
+		 * Delete the reader-writer lock.
+		 * WARNING: RWLock MUST be unlocked!
+		 */
+		inline ~RWLock();
+
+	private:
+#if __cplusplus >= 201103L
+		RWLock(const RWLock &) = delete; \
+		RWLock &operator=(const RWLock &) = delete;
+#else /* __cplusplus < 201103L */
+		RWLock(const RWLock &); \
+		RWLock &operator=(const RWLock &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Obtain a shared (read) lock.
+		 * Multiple threads can hold shared locks at the same time.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int lockRead(void);
+
+		/**
+		 * Release a shared (read) lock.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int unlockRead(void);
+
+		/**
+		 * Obtain an exclusive (write) lock.
+		 * This function will block until all other locks are released.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int lockWrite(void);
+
+		/**
+		 * Release an exclusive (write) lock.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int unlockWrite(void);
+
+	private:
+		pthread_rwlock_t m_rwlock;
+		bool m_isInit;
+};
+
+/**
+ * Create a reader-writer lock.
+ */
+inline RWLock::RWLock()
+	: m_isInit(false)
+{
+	int ret = pthread_rwlock_init(&m_rwlock, nullptr);
+	assert(ret == 0);
+	if (ret == 0) {
+		m_isInit = true;
+	} else {
+		// FIXME: Do something if an error occurred here...
+	}
+}
+
+/**
+ * Delete the reader-writer lock.
+ * WARNING: RWLock MUST be unlocked!
+ */
+inline RWLock::~RWLock()
+{
+	if (m_isInit) {
+		// TODO: Error checking.
+		pthread_rwlock_destroy(&m_rwlock);
+	}
+}
+
+/**
+ * Obtain a shared (read) lock.
+ * Multiple threads can hold shared locks at the same time.
+ * @return 0 on success; non-zero on error.
+ */
+inline int RWLock::lockRead(void)
+{
+	if (!m_isInit)
+		return -EBADF;
+
+	// TODO: What error to return?
+	return pthread_rwlock_rdlock(&m_rwlock);
+}
+
+/**
+ * Release a shared (read) lock.
+ * @return 0 on success; non-zero on error.
+ */
+inline int RWLock::unlockRead(void)
+{
+	if (!m_isInit)
+		return -EBADF;
+
+	// TODO: What error to return?
+	return pthread_rwlock_unlock(&m_rwlock);
+}
+
+/**
+ * Obtain an exclusive (write) lock.
+ * This function will block until all other locks are released.
+ * @return 0 on success; non-zero on error.
+ */
+inline int RWLock::lockWrite(void)
+{
+	if (!m_isInit)
+		return -EBADF;
+
+	// TODO: What error to return?
+	return pthread_rwlock_wrlock(&m_rwlock);
+}
+
+/**
+ * Release an exclusive (write) lock.
+ * @return 0 on success; non-zero on error.
+ */
+inline int RWLock::unlockWrite(void)
+{
+	if (!m_isInit)
+		return -EBADF;
+
+	// TODO: What error to return?
+	return pthread_rwlock_unlock(&m_rwlock);
+}
+
+}
@@ -0,0 +1,140 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * RWLockWin32.cpp: Win32 reader-writer lock implementation.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+#ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+
+// SAL 2.0 annotations not supported by Windows SDK 7.1A. (MSVC 2010)
+#ifndef _Acquires_shared_lock_
+# define _Acquires_shared_lock_(lock)
+#endif
+#ifndef _Releases_shared_lock_
+# define _Releases_shared_lock_(lock)
+#endif
+#ifndef _Acquires_exclusive_lock_
+# define _Acquires_exclusive_lock_(lock)
+#endif
+#ifndef _Releases_exclusive_lock_
+# define _Releases_exclusive_lock_(lock)
+#endif
+
+namespace LibRpThreads {
+
+class RWLock
+{
+	public:
+		/**
+		 * Create a reader-writer lock.
+		 */
+		inline explicit RWLock();
+
+		/**
+		 * Delete the reader-writer lock.
+		 * WARNING: RWLock MUST be unlocked!
+		 */
+		inline ~RWLock() { }
+
+	private:
+#if __cplusplus >= 201103L
+		RWLock(const RWLock &) = delete; \
+		RWLock &operator=(const RWLock &) = delete;
+#else /* __cplusplus < 201103L */
+		RWLock(const RWLock &); \
+		RWLock &operator=(const RWLock &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Obtain a shared (read) lock.
+		 * Multiple threads can hold shared locks at the same time.
+		 * @return 0 on success; non-zero on error.
+		 */
+		_Acquires_shared_lock_(this->m_srwLock) inline int lockRead(void);
+
+		/**
+		 * Release a shared (read) lock.
+		 * @return 0 on success; non-zero on error.
+		 */
+		_Releases_shared_lock_(this->m_srwLock) inline int unlockRead(void);
+
+		/**
+		 * Obtain an exclusive (write) lock.
+		 * This function will block until all other locks are released.
+		 * @return 0 on success; non-zero on error.
+		 */
+		_Acquires_exclusive_lock_(this->m_srwLock) inline int lockWrite(void);
+
+		/**
+		 * Release an exclusive (write) lock.
+		 * @return 0 on success; non-zero on error.
+		 */
+		_Releases_exclusive_lock_(this->m_srwLock) inline int unlockWrite(void);
+
+	private:
+		// NOTE: Slim reader-writer locks require Windows Vista.
+		// They don't need to be deleted.
+		SRWLOCK m_srwLock;
+};
+
+/**
+ * Create a reader-writer lock.
+ */
+inline RWLock::RWLock()
+{
+	InitializeSRWLock(&m_srwLock);
+}
+
+/**
+ * Obtain a shared (read) lock.
+ * Multiple threads can hold shared locks at the same time.
+ * @return 0 on success; non-zero on error.
+ */
+_Acquires_shared_lock_(this->m_srwLock) inline int RWLock::lockRead(void)
+{
+	AcquireSRWLockShared(&m_srwLock);
+	return 0;
+}
+
+/**
+ * Release a shared (read) lock.
+ * @return 0 on success; non-zero on error.
+ */
+_Releases_shared_lock_(this->m_srwLock) inline int RWLock::unlockRead(void)
+{
+	ReleaseSRWLockShared(&m_srwLock);
+	return 0;
+}
+
+/**
+ * Obtain an exclusive (write) lock.
+ * This function will block until all other locks are released.
+ * @return 0 on success; non-zero on error.
+ */
+_Acquires_exclusive_lock_(this->m_srwLock) inline int RWLock::lockWrite(void)
+{
+	AcquireSRWLockExclusive(&m_srwLock);
+	return 0;
+}
+
+/**
+ * Release an exclusive (write) lock.
+ * @return 0 on success; non-zero on error.
+ */
+_Releases_exclusive_lock_(this->m_srwLock) inline int RWLock::unlockWrite(void)
+{
+	ReleaseSRWLockExclusive(&m_srwLock);
+	return 0;
+}
+
+}
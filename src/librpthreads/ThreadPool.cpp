@@ -0,0 +1,560 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadPool.cpp: Work-stealing thread pool.                              *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ThreadPool.hpp"
+#include "Mutex.hpp"
+#include "Thread.hpp"
+#include "pthread_once.h"
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <climits>
+
+// C++ includes.
+#include <deque>
+#include <memory>
+using std::deque;
+using std::unique_ptr;
+
+namespace LibRpThreads {
+
+/**
+ * Queued task.
+ */
+struct PoolJob {
+	ThreadPool::pfnTaskFunc_t func;
+	void *param;
+	TaskFuture *future;
+	const CancelToken *token;
+};
+
+/**
+ * Per-worker task deque.
+ * The owning worker pushes and pops at the back;
+ * other workers steal from the front.
+ */
+struct WorkerQueue {
+	Mutex mutex;
+	deque<PoolJob> jobs;
+};
+
+class ThreadPoolPrivate
+{
+	public:
+		ThreadPoolPrivate(ThreadPool *q, unsigned int threadCount);
+		~ThreadPoolPrivate();
+
+	private:
+#if __cplusplus >= 201103L
+		ThreadPoolPrivate(const ThreadPoolPrivate &) = delete; \
+		ThreadPoolPrivate &operator=(const ThreadPoolPrivate &) = delete;
+#else /* __cplusplus < 201103L */
+		ThreadPoolPrivate(const ThreadPoolPrivate &); \
+		ThreadPoolPrivate &operator=(const ThreadPoolPrivate &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Worker thread parameter.
+		 */
+		struct WorkerParam {
+			ThreadPoolPrivate *d;
+			unsigned int index;
+		};
+
+		/**
+		 * Worker thread function.
+		 * @param param WorkerParam
+		 */
+		static void workerFunc(void *param);
+
+		/**
+		 * Run a job and signal its future, if any.
+		 * @param job PoolJob
+		 */
+		static void runJob(const PoolJob &job);
+
+		/**
+		 * Get a job, either from the specified worker's
+		 * own deque or by stealing from another worker.
+		 * @param self	[in] Worker index. (-1 if not a worker)
+		 * @param job	[out] PoolJob
+		 * @return True if a job was found; false if not.
+		 */
+		bool popJob(int self, PoolJob &job);
+
+	public:
+		ThreadPool *const q_ptr;
+
+		unsigned int queueCount;	// Number of worker deques
+		unsigned int running;		// Number of worker threads that started
+		unique_ptr<WorkerQueue[]> queues;
+		unique_ptr<Thread[]> threads;
+		unique_ptr<WorkerParam[]> params;
+
+		// Released once per queued job, plus once per
+		// worker on shutdown. Workers obtain it before
+		// looking for a job, so the count is always at
+		// least the number of queued jobs.
+		Semaphore pending;
+
+		volatile int nextQueue;		// Round-robin queue for non-worker submissions
+		volatile int quit;
+
+	public:
+		// Process-wide pool.
+		static pthread_once_t instance_once_control;
+		static ThreadPool *instance;
+		static unsigned int defaultThreadCount;
+		static ThreadPool::pfnThreadCountFunc_t pfnDefaultThreadCount;
+
+		/**
+		 * Create the process-wide pool.
+		 * Called by pthread_once().
+		 */
+		static void initInstance(void);
+};
+
+// Current thread's pool and worker index.
+// Only set on worker threads.
+static thread_local ThreadPoolPrivate *tls_pool = nullptr;
+static thread_local int tls_index = -1;
+
+pthread_once_t ThreadPoolPrivate::instance_once_control = PTHREAD_ONCE_INIT;
+ThreadPool *ThreadPoolPrivate::instance = nullptr;
+unsigned int ThreadPoolPrivate::defaultThreadCount = 0;
+ThreadPool::pfnThreadCountFunc_t ThreadPoolPrivate::pfnDefaultThreadCount = nullptr;
+
+ThreadPoolPrivate::ThreadPoolPrivate(ThreadPool *q, unsigned int threadCount)
+	: q_ptr(q)
+	, queueCount(threadCount)
+	, running(0)
+	, pending(0)
+	, nextQueue(0)
+	, quit(0)
+{
+	if (queueCount == 0) {
+		queueCount = Thread::cpuCount();
+	}
+
+	queues.reset(new WorkerQueue[queueCount]);
+	threads.reset(new Thread[queueCount]);
+	params.reset(new WorkerParam[queueCount]);
+	for (unsigned int i = 0; i < queueCount; i++) {
+		params[i].d = this;
+		params[i].index = i;
+		if (threads[i].create(workerFunc, &params[i]) == 0) {
+			running++;
+		}
+	}
+}
+
+ThreadPoolPrivate::~ThreadPoolPrivate()
+{
+	// Wake up all workers. Pending jobs are run first,
+	// since each worker only exits once it finds no jobs.
+	ATOMIC_EXCHANGE(&quit, 1);
+	for (unsigned int i = 0; i < running; i++) {
+		pending.release();
+	}
+	for (unsigned int i = 0; i < queueCount; i++) {
+		threads[i].join();
+	}
+
+	// Jobs left on the deques of workers that never started
+	// were run by the other workers, unless none started.
+	// In that case, submit() ran everything inline.
+}
+
+/**
+ * Worker thread function.
+ * @param param WorkerParam
+ */
+void ThreadPoolPrivate::workerFunc(void *param)
+{
+	const WorkerParam *const wp = static_cast<const WorkerParam*>(param);
+	ThreadPoolPrivate *const d = wp->d;
+	const int self = static_cast<int>(wp->index);
+	tls_pool = d;
+	tls_index = self;
+
+	for (;;) {
+		d->pending.obtain();
+		PoolJob job;
+		if (d->popJob(self, job)) {
+			runJob(job);
+			continue;
+		}
+		if (d->quit) {
+			break;
+		}
+	}
+
+	tls_pool = nullptr;
+	tls_index = -1;
+}
+
+/**
+ * Run a job and signal its future, if any.
+ * @param job PoolJob
+ */
+void ThreadPoolPrivate::runJob(const PoolJob &job)
+{
+	const bool skip = (job.token && job.token->isCancelled());
+	if (!skip) {
+		job.func(job.param);
+	}
+
+	TaskFuture *const future = job.future;
+	if (future) {
+		future->m_cancelled = skip;
+		ATOMIC_EXCHANGE(&future->m_done, 1);
+		// NOTE: The future may be deleted as soon as this returns.
+		future->m_sem.release();
+	}
+}
+
+/**
+ * Get a job, either from the specified worker's
+ * own deque or by stealing from another worker.
+ * @param self	[in] Worker index. (-1 if not a worker)
+ * @param job	[out] PoolJob
+ * @return True if a job was found; false if not.
+ */
+bool ThreadPoolPrivate::popJob(int self, PoolJob &job)
+{
+	if (self >= 0) {
+		// Own deque: LIFO, for cache locality.
+		WorkerQueue &wq = queues[self];
+		MutexLocker locker(wq.mutex);
+		if (!wq.jobs.empty()) {
+			job = wq.jobs.back();
+			wq.jobs.pop_back();
+			return true;
+		}
+	}
+
+	// Steal from the other workers: FIFO, so the oldest
+	// (and usually largest) jobs are taken first.
+	const unsigned int start = (self >= 0 ? static_cast<unsigned int>(self) + 1 : 0);
+	for (unsigned int i = 0; i < queueCount; i++) {
+		const unsigned int idx = (start + i) % queueCount;
+		if (static_cast<int>(idx) == self)
+			continue;
+
+		WorkerQueue &wq = queues[idx];
+		MutexLocker locker(wq.mutex);
+		if (!wq.jobs.empty()) {
+			job = wq.jobs.front();
+			wq.jobs.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Create the process-wide pool.
+ * Called by pthread_once().
+ */
+void ThreadPoolPrivate::initInstance(void)
+{
+	// NOTE: The process-wide pool is never deleted. Joining threads
+	// from static destructors deadlocks on Windows if this is in a
+	// DLL that's being unloaded, since DllMain() holds the loader lock.
+	if (pfnDefaultThreadCount) {
+		defaultThreadCount = pfnDefaultThreadCount();
+	}
+	instance = new ThreadPool(defaultThreadCount);
+}
+
+/** ThreadPool **/
+
+/**
+ * Create a thread pool.
+ * @param threadCount Number of worker threads. (0 for the number of CPUs)
+ */
+ThreadPool::ThreadPool(unsigned int threadCount)
+	: d_ptr(new ThreadPoolPrivate(this, threadCount))
+{ }
+
+/**
+ * Delete the thread pool.
+ * Pending tasks are run before the workers are joined.
+ */
+ThreadPool::~ThreadPool()
+{
+	assert(!isWorkerThread());
+	delete d_ptr;
+}
+
+/**
+ * Get the process-wide thread pool.
+ * It's created on first use, sized by setDefaultThreadCount().
+ * @return ThreadPool
+ */
+ThreadPool *ThreadPool::instance(void)
+{
+	pthread_once(&ThreadPoolPrivate::instance_once_control, ThreadPoolPrivate::initInstance);
+	return ThreadPoolPrivate::instance;
+}
+
+/**
+ * Set the number of worker threads for the process-wide pool.
+ * This must be called before the first call to instance();
+ * usually from Config's "ThreadPoolSize" option.
+ * @param threadCount Number of worker threads. (0 for the number of CPUs)
+ */
+void ThreadPool::setDefaultThreadCount(unsigned int threadCount)
+{
+	assert(ThreadPoolPrivate::instance == nullptr);
+	ThreadPoolPrivate::defaultThreadCount = threadCount;
+	ThreadPoolPrivate::pfnDefaultThreadCount = nullptr;
+}
+
+/**
+ * Set a function that returns the number of worker threads
+ * for the process-wide pool. It's called by the first call
+ * to instance(), so the thread count (e.g. from Config) is
+ * only looked up if the pool is actually used.
+ * This must be called before the first call to instance().
+ * @param pfnThreadCount Thread count function. (returns 0 for the number of CPUs)
+ */
+void ThreadPool::setDefaultThreadCountFunc(pfnThreadCountFunc_t pfnThreadCount)
+{
+	assert(ThreadPoolPrivate::instance == nullptr);
+	ThreadPoolPrivate::pfnDefaultThreadCount = pfnThreadCount;
+}
+
+/**
+ * Get the number of worker threads.
+ * @return Number of worker threads. (0 if no threads could be created)
+ */
+unsigned int ThreadPool::threadCount(void) const
+{
+	const ThreadPoolPrivate *const d = d_ptr;
+	return d->running;
+}
+
+/**
+ * Is the calling thread one of this pool's workers?
+ * @return True if it is; false if not.
+ */
+bool ThreadPool::isWorkerThread(void) const
+{
+	return (tls_pool == d_ptr);
+}
+
+/**
+ * Submit a task.
+ *
+ * If submitted from a worker thread, the task is queued on that
+ * worker's own deque; otherwise, queues are chosen round-robin.
+ * Idle workers steal from the other workers' deques.
+ *
+ * If the pool has no worker threads, the task is run immediately.
+ *
+ * @param func	[in] Task function.
+ * @param param	[in] Task function parameter.
+ * @param future	[in,opt] Completion handle. (must remain valid until wait() returns)
+ * @param token	[in,opt] Cancellation token. (must remain valid until the task finishes)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ThreadPool::submit(pfnTaskFunc_t func, void *param,
+	TaskFuture *future, const CancelToken *token)
+{
+	assert(func != nullptr);
+	if (!func)
+		return -EINVAL;
+
+	ThreadPoolPrivate *const d = d_ptr;
+	PoolJob job;
+	job.func = func;
+	job.param = param;
+	job.future = future;
+	job.token = token;
+	if (future) {
+		future->m_pool = this;
+	}
+
+	if (d->running == 0) {
+		// No worker threads. Run the task now.
+		ThreadPoolPrivate::runJob(job);
+		return 0;
+	}
+
+	unsigned int idx;
+	if (tls_pool == d) {
+		idx = static_cast<unsigned int>(tls_index);
+	} else {
+		idx = static_cast<unsigned int>(ATOMIC_INC_FETCH(&d->nextQueue)) % d->queueCount;
+	}
+
+	WorkerQueue &wq = d->queues[idx];
+	wq.mutex.lock();
+	wq.jobs.push_back(job);
+	wq.mutex.unlock();
+	d->pending.release();
+	return 0;
+}
+
+/**
+ * Run one pending task, if any, from the caller's
+ * own deque or by stealing from another worker.
+ * @return True if a task was run; false if none were pending.
+ */
+bool ThreadPool::runPendingTask(void)
+{
+	ThreadPoolPrivate *const d = d_ptr;
+	PoolJob job;
+	if (!d->popJob(tls_pool == d ? tls_index : -1, job))
+		return false;
+
+	// NOTE: pending isn't obtained here, so a worker
+	// may wake up later and find nothing to do.
+	ThreadPoolPrivate::runJob(job);
+	return true;
+}
+
+/**
+ * Wait for the task to finish.
+ * If called from one of the pool's worker threads,
+ * other tasks will be run while waiting.
+ */
+void TaskFuture::wait(void)
+{
+	if (m_pool && m_pool->isWorkerThread()) {
+		// Blocking here could deadlock if the task is
+		// queued behind us, so help out until it's done.
+		// If nothing is pending, the task is running
+		// on another thread, so it's safe to block.
+		while (!m_done) {
+			if (!m_pool->runPendingTask())
+				break;
+		}
+	}
+
+	// Always obtain the semaphore, even if m_done is set,
+	// so runJob() is finished with this object on return.
+	m_sem.obtain();
+}
+
+/** parallelFor() **/
+
+/**
+ * Shared state for a parallelFor() call.
+ */
+struct ParallelForState {
+	ThreadPool::pfnRangeFunc_t func;
+	void *param;
+	size_t begin;
+	size_t end;
+	size_t grain;
+	const CancelToken *token;
+
+	int chunkCount;
+	volatile int nextChunk;
+	volatile int skipped;
+};
+
+/**
+ * Process parallelFor() chunks until none are left.
+ * @param param ParallelForState
+ */
+static void parallelForFunc(void *param)
+{
+	ParallelForState *const st = static_cast<ParallelForState*>(param);
+
+	for (int chunk = ATOMIC_INC_FETCH(&st->nextChunk) - 1; chunk < st->chunkCount;
+	     chunk = ATOMIC_INC_FETCH(&st->nextChunk) - 1)
+	{
+		if (st->token && st->token->isCancelled()) {
+			ATOMIC_EXCHANGE(&st->skipped, 1);
+			break;
+		}
+
+		const size_t cbegin = st->begin + (static_cast<size_t>(chunk) * st->grain);
+		size_t cend = cbegin + st->grain;
+		if (cend > st->end || cend < cbegin) {
+			cend = st->end;
+		}
+		st->func(st->param, cbegin, cend);
+	}
+}
+
+/**
+ * Run func over [begin, end) in chunks of up to grain elements.
+ *
+ * The calling thread participates, so this can be called
+ * from a worker thread without deadlocking. Returns once
+ * all chunks have been processed or skipped.
+ *
+ * @param begin	[in] First index.
+ * @param end	[in] One past the last index.
+ * @param func	[in] Range function. Called with [chunk_begin, chunk_end).
+ * @param param	[in] Range function parameter.
+ * @param grain	[in] Maximum number of indexes per chunk. (0 == 1)
+ * @param token	[in,opt] Cancellation token. Remaining chunks are skipped once cancelled.
+ * @return 0 on success; -ECANCELED if cancelled.
+ */
+int ThreadPool::parallelFor(size_t begin, size_t end,
+	pfnRangeFunc_t func, void *param,
+	size_t grain, const CancelToken *token)
+{
+	assert(func != nullptr);
+	if (!func)
+		return -EINVAL;
+	if (begin >= end)
+		return 0;
+
+	const size_t count = end - begin;
+	if (grain == 0) {
+		grain = 1;
+	}
+	// Make sure the chunk count fits in an int.
+	if (count / grain >= static_cast<size_t>(INT_MAX)) {
+		grain = (count / (INT_MAX - 1)) + 1;
+	}
+
+	ParallelForState st;
+	st.func = func;
+	st.param = param;
+	st.begin = begin;
+	st.end = end;
+	st.grain = grain;
+	st.token = token;
+	st.chunkCount = static_cast<int>((count + grain - 1) / grain);
+	st.nextChunk = 0;
+	st.skipped = 0;
+
+	// One helper per worker, minus the chunk this thread will take.
+	const ThreadPoolPrivate *const d = d_ptr;
+	unsigned int helpers = d->running;
+	if (helpers > static_cast<unsigned int>(st.chunkCount - 1)) {
+		helpers = static_cast<unsigned int>(st.chunkCount - 1);
+	}
+
+	unique_ptr<TaskFuture[]> futures;
+	if (helpers > 0) {
+		futures.reset(new TaskFuture[helpers]);
+		for (unsigned int i = 0; i < helpers; i++) {
+			submit(parallelForFunc, &st, &futures[i], token);
+		}
+	}
+
+	parallelForFunc(&st);
+	for (unsigned int i = 0; i < helpers; i++) {
+		futures[i].wait();
+	}
+
+	return (st.skipped ? -ECANCELED : 0);
+}
+
+}
@@ -0,0 +1,259 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadPool.hpp: Work-stealing thread pool.                              *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTHREADS_THREADPOOL_HPP__
+#define __ROMPROPERTIES_LIBRPTHREADS_THREADPOOL_HPP__
+
+#include "Atomics.h"
+#include "Semaphore.hpp"
+
+// C includes. (C++ namespace)
+#include <cstddef>
+
+namespace LibRpThreads {
+
+/**
+ * Cancellation token.
+ * Shared by the submitter and any number of tasks.
+ * Tasks that haven't started yet are skipped once the token
+ * is cancelled; running tasks should poll isCancelled().
+ */
+class CancelToken
+{
+	public:
+		inline CancelToken()
+			: m_cancelled(0)
+		{ }
+
+	private:
+#if __cplusplus >= 201103L
+		CancelToken(const CancelToken &) = delete; \
+		CancelToken &operator=(const CancelToken &) = delete;
+#else /* __cplusplus < 201103L */
+		CancelToken(const CancelToken &); \
+		CancelToken &operator=(const CancelToken &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Request cancellation.
+		 */
+		inline void cancel(void)
+		{
+			ATOMIC_EXCHANGE(&m_cancelled, 1);
+		}
+
+		/**
+		 * Has cancellation been requested?
+		 * @return True if cancelled; false if not.
+		 */
+		inline bool isCancelled(void) const
+		{
+			return (m_cancelled != 0);
+		}
+
+	private:
+		volatile int m_cancelled;
+};
+
+class ThreadPool;
+class ThreadPoolPrivate;
+
+/**
+ * Completion handle for a submitted task.
+ * The TaskFuture is owned by the submitter, and it must
+ * remain valid until wait() returns.
+ */
+class TaskFuture
+{
+	public:
+		inline TaskFuture()
+			: m_sem(0)
+			, m_pool(nullptr)
+			, m_done(0)
+			, m_cancelled(false)
+		{ }
+
+	private:
+#if __cplusplus >= 201103L
+		TaskFuture(const TaskFuture &) = delete; \
+		TaskFuture &operator=(const TaskFuture &) = delete;
+#else /* __cplusplus < 201103L */
+		TaskFuture(const TaskFuture &); \
+		TaskFuture &operator=(const TaskFuture &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Has the task finished? (or been skipped due to cancellation)
+		 * @return True if finished; false if not.
+		 */
+		inline bool isDone(void) const
+		{
+			return (m_done != 0);
+		}
+
+		/**
+		 * Was the task skipped due to cancellation?
+		 * Only valid after wait() returns.
+		 * @return True if skipped; false if it ran.
+		 */
+		inline bool wasCancelled(void) const
+		{
+			return m_cancelled;
+		}
+
+		/**
+		 * Wait for the task to finish.
+		 * If called from one of the pool's worker threads,
+		 * other tasks will be run while waiting.
+		 */
+		void wait(void);
+
+	private:
+		friend class ThreadPool;
+		friend class ThreadPoolPrivate;
+		Semaphore m_sem;	// Released once when the task finishes.
+		ThreadPool *m_pool;	// Pool the task was submitted to.
+		volatile int m_done;
+		bool m_cancelled;
+};
+
+/**
+ * Work-stealing thread pool.
+ *
+ * Use this for short, CPU-bound tasks and parallel loops.
+ * Tasks must not block waiting for another thread, other than
+ * by TaskFuture::wait() or parallelFor(), since a blocked task
+ * ties up a worker that other tasks may be waiting on.
+ *
+ * Producer/consumer pipelines (e.g. hashing while reading) and
+ * long-lived background threads (e.g. asynchronous downloads)
+ * should use their own Thread objects instead.
+ */
+class ThreadPool
+{
+	public:
+		typedef void (*pfnTaskFunc_t)(void *param);
+		typedef void (*pfnRangeFunc_t)(void *param, size_t begin, size_t end);
+		typedef unsigned int (*pfnThreadCountFunc_t)(void);
+
+		/**
+		 * Create a thread pool.
+		 * @param threadCount Number of worker threads. (0 for the number of CPUs)
+		 */
+		explicit ThreadPool(unsigned int threadCount = 0);
+
+		/**
+		 * Delete the thread pool.
+		 * Pending tasks are run before the workers are joined.
+		 */
+		~ThreadPool();
+
+	private:
+#if __cplusplus >= 201103L
+		ThreadPool(const ThreadPool &) = delete; \
+		ThreadPool &operator=(const ThreadPool &) = delete;
+#else /* __cplusplus < 201103L */
+		ThreadPool(const ThreadPool &); \
+		ThreadPool &operator=(const ThreadPool &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Get the process-wide thread pool.
+		 * It's created on first use, sized by setDefaultThreadCount().
+		 * @return ThreadPool
+		 */
+		static ThreadPool *instance(void);
+
+		/**
+		 * Set the number of worker threads for the process-wide pool.
+		 * This must be called before the first call to instance();
+		 * usually from Config's "ThreadPoolSize" option.
+		 * @param threadCount Number of worker threads. (0 for the number of CPUs)
+		 */
+		static void setDefaultThreadCount(unsigned int threadCount);
+
+		/**
+		 * Set a function that returns the number of worker threads
+		 * for the process-wide pool. It's called by the first call
+		 * to instance(), so the thread count (e.g. from Config) is
+		 * only looked up if the pool is actually used.
+		 * This must be called before the first call to instance().
+		 * @param pfnThreadCount Thread count function. (returns 0 for the number of CPUs)
+		 */
+		static void setDefaultThreadCountFunc(pfnThreadCountFunc_t pfnThreadCount);
+
+		/**
+		 * Get the number of worker threads.
+		 * @return Number of worker threads. (0 if no threads could be created)
+		 */
+		unsigned int threadCount(void) const;
+
+		/**
+		 * Is the calling thread one of this pool's workers?
+		 * @return True if it is; false if not.
+		 */
+		bool isWorkerThread(void) const;
+
+		/**
+		 * Submit a task.
+		 *
+		 * If submitted from a worker thread, the task is queued on that
+		 * worker's own deque; otherwise, queues are chosen round-robin.
+		 * Idle workers steal from the other workers' deques.
+		 *
+		 * If the pool has no worker threads, the task is run immediately.
+		 *
+		 * @param func	[in] Task function.
+		 * @param param	[in] Task function parameter.
+		 * @param future	[in,opt] Completion handle. (must remain valid until wait() returns)
+		 * @param token	[in,opt] Cancellation token. (must remain valid until the task finishes)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int submit(pfnTaskFunc_t func, void *param,
+			TaskFuture *future = nullptr, const CancelToken *token = nullptr);
+
+		/**
+		 * Run func over [begin, end) in chunks of up to grain elements.
+		 *
+		 * The calling thread participates, so this can be called
+		 * from a worker thread without deadlocking. Returns once
+		 * all chunks have been processed or skipped.
+		 *
+		 * @param begin	[in] First index.
+		 * @param end	[in] One past the last index.
+		 * @param func	[in] Range function. Called with [chunk_begin, chunk_end).
+		 * @param param	[in] Range function parameter.
+		 * @param grain	[in] Maximum number of indexes per chunk. (0 == 1)
+		 * @param token	[in,opt] Cancellation token. Remaining chunks are skipped once cancelled.
+		 * @return 0 on success; -ECANCELED if cancelled.
+		 */
+		int parallelFor(size_t begin, size_t end,
+			pfnRangeFunc_t func, void *param,
+			size_t grain = 1, const CancelToken *token = nullptr);
+
+	private:
+		friend class TaskFuture;
+
+		/**
+		 * Run one pending task, if any, from the caller's
+		 * own deque or by stealing from another worker.
+		 * @return True if a task was run; false if none were pending.
+		 */
+		bool runPendingTask(void);
+
+	private:
+		friend class ThreadPoolPrivate;
+		ThreadPoolPrivate *const d_ptr;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPTHREADS_THREADPOOL_HPP__ */
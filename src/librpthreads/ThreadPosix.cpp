@@ -0,0 +1,162 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadPosix.cpp: POSIX thread implementation.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include <pthread.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+namespace LibRpThreads {
+
+class Thread
+{
+	public:
+		typedef void (*pfnThreadFunc_t)(void *param);
+
+		/**
+		 * Initialize a thread object.
+		 * The thread is not started until create() is called.
+		 */
+		inline explicit Thread();
+
+		/**
+		 * Delete the thread object.
+		 * If the thread is still running, it will be joined.
+		 */
+		inline ~Thread();
+
+	private:
+#if __cplusplus >= 201103L
+		Thread(const Thread &) = delete; \
+		Thread &operator=(const Thread &) = delete;
+#else /* __cplusplus < 201103L */
+		Thread(const Thread &); \
+		Thread &operator=(const Thread &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Start the thread.
+		 * @param func Thread function.
+		 * @param param Thread function parameter.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int create(pfnThreadFunc_t func, void *param);
+
+		/**
+		 * Wait for the thread to exit.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int join(void);
+
+		/**
+		 * Get the number of online CPUs.
+		 * @return Number of online CPUs. (at least 1)
+		 */
+		static inline unsigned int cpuCount(void);
+
+	private:
+		/**
+		 * pthread entry point.
+		 * @param arg Thread object.
+		 * @return nullptr
+		 */
+		static void *thread_start(void *arg);
+
+	private:
+		pthread_t m_thread;
+		pfnThreadFunc_t m_func;
+		void *m_param;
+		bool m_isRunning;
+};
+
+/**
+ * Initialize a thread object.
+ * The thread is not started until create() is called.
+ */
+inline Thread::Thread()
+	: m_func(nullptr)
+	, m_param(nullptr)
+	, m_isRunning(false)
+{ }
+
+/**
+ * Delete the thread object.
+ * If the thread is still running, it will be joined.
+ */
+inline Thread::~Thread()
+{
+	if (m_isRunning) {
+		join();
+	}
+}
+
+/**
+ * pthread entry point.
+ * @param arg Thread object.
+ * @return nullptr
+ */
+inline void *Thread::thread_start(void *arg)
+{
+	Thread *const thread = static_cast<Thread*>(arg);
+	thread->m_func(thread->m_param);
+	return nullptr;
+}
+
+/**
+ * Start the thread.
+ * @param func Thread function.
+ * @param param Thread function parameter.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::create(pfnThreadFunc_t func, void *param)
+{
+	assert(!m_isRunning);
+	assert(func != nullptr);
+	if (m_isRunning)
+		return -EBUSY;
+	else if (!func)
+		return -EINVAL;
+
+	m_func = func;
+	m_param = param;
+	int ret = pthread_create(&m_thread, nullptr, thread_start, this);
+	if (ret != 0) {
+		return -ret;
+	}
+	m_isRunning = true;
+	return 0;
+}
+
+/**
+ * Wait for the thread to exit.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::join(void)
+{
+	if (!m_isRunning)
+		return -ESRCH;
+
+	int ret = pthread_join(m_thread, nullptr);
+	m_isRunning = false;
+	return -ret;
+}
+
+/**
+ * Get the number of online CPUs.
+ * @return Number of online CPUs. (at least 1)
+ */
+inline unsigned int Thread::cpuCount(void)
+{
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0 ? static_cast<unsigned int>(count) : 1);
+}
+
+}
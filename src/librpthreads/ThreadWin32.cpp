@@ -0,0 +1,168 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadWin32.cpp: Win32 thread implementation.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+
+#ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+#include <process.h>
+
+namespace LibRpThreads {
+
+class Thread
+{
+	public:
+		typedef void (*pfnThreadFunc_t)(void *param);
+
+		/**
+		 * Initialize a thread object.
+		 * The thread is not started until create() is called.
+		 */
+		inline explicit Thread();
+
+		/**
+		 * Delete the thread object.
+		 * If the thread is still running, it will be joined.
+		 */
+		inline ~Thread();
+
+	private:
+#if __cplusplus >= 201103L
+		Thread(const Thread &) = delete; \
+		Thread &operator=(const Thread &) = delete;
+#else /* __cplusplus < 201103L */
+		Thread(const Thread &); \
+		Thread &operator=(const Thread &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Start the thread.
+		 * @param func Thread function.
+		 * @param param Thread function parameter.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int create(pfnThreadFunc_t func, void *param);
+
+		/**
+		 * Wait for the thread to exit.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		inline int join(void);
+
+		/**
+		 * Get the number of online CPUs.
+		 * @return Number of online CPUs. (at least 1)
+		 */
+		static inline unsigned int cpuCount(void);
+
+	private:
+		/**
+		 * _beginthreadex() entry point.
+		 * @param arg Thread object.
+		 * @return 0
+		 */
+		static unsigned int __stdcall thread_start(void *arg);
+
+	private:
+		HANDLE m_hThread;
+		pfnThreadFunc_t m_func;
+		void *m_param;
+};
+
+/**
+ * Initialize a thread object.
+ * The thread is not started until create() is called.
+ */
+inline Thread::Thread()
+	: m_hThread(nullptr)
+	, m_func(nullptr)
+	, m_param(nullptr)
+{ }
+
+/**
+ * Delete the thread object.
+ * If the thread is still running, it will be joined.
+ */
+inline Thread::~Thread()
+{
+	if (m_hThread) {
+		join();
+	}
+}
+
+/**
+ * _beginthreadex() entry point.
+ * @param arg Thread object.
+ * @return 0
+ */
+inline unsigned int __stdcall Thread::thread_start(void *arg)
+{
+	Thread *const thread = static_cast<Thread*>(arg);
+	thread->m_func(thread->m_param);
+	return 0;
+}
+
+/**
+ * Start the thread.
+ * @param func Thread function.
+ * @param param Thread function parameter.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::create(pfnThreadFunc_t func, void *param)
+{
+	assert(m_hThread == nullptr);
+	assert(func != nullptr);
+	if (m_hThread)
+		return -EBUSY;
+	else if (!func)
+		return -EINVAL;
+
+	m_func = func;
+	m_param = param;
+
+	// NOTE: Using _beginthreadex() instead of CreateThread()
+	// so the CRT is initialized for the new thread.
+	m_hThread = reinterpret_cast<HANDLE>(_beginthreadex(nullptr, 0, thread_start, this, 0, nullptr));
+	if (!m_hThread) {
+		return -EAGAIN;
+	}
+	return 0;
+}
+
+/**
+ * Wait for the thread to exit.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+inline int Thread::join(void)
+{
+	if (!m_hThread)
+		return -ESRCH;
+
+	DWORD dwRet = WaitForSingleObject(m_hThread, INFINITE);
+	CloseHandle(m_hThread);
+	m_hThread = nullptr;
+	return (dwRet == WAIT_OBJECT_0 ? 0 : -EIO);
+}
+
+/**
+ * Get the number of online CPUs.
+ * @return Number of online CPUs. (at least 1)
+ */
+inline unsigned int Thread::cpuCount(void)
+{
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	return (si.dwNumberOfProcessors > 0 ? si.dwNumberOfProcessors : 1);
+}
+
+}
@@ -0,0 +1,308 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads/tests)               *
+ * ThreadPoolTest.cpp: ThreadPool tests.                                   *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librpthreads
+#include "librpthreads/Atomics.h"
+#include "librpthreads/ThreadPool.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+
+// C++ includes.
+#include <memory>
+using std::unique_ptr;
+
+namespace LibRpThreads { namespace Tests {
+
+class ThreadPoolTest : public ::testing::Test
+{
+	protected:
+		ThreadPoolTest()
+			: m_pool(new ThreadPool(POOL_THREADS))
+		{ }
+
+	public:
+		// Number of worker threads in the test pool.
+		static const unsigned int POOL_THREADS = 4;
+
+		// Number of indexes used by the parallelFor() tests.
+		static const unsigned int INDEX_COUNT = 4096;
+
+	protected:
+		unique_ptr<ThreadPool> m_pool;
+
+	public:
+		/**
+		 * Range function: Increment counters[i] for each index.
+		 * @param param volatile int array
+		 * @param begin First index
+		 * @param end One past the last index
+		 */
+		static void incRange(void *param, size_t begin, size_t end)
+		{
+			volatile int *const counters = static_cast<volatile int*>(param);
+			for (size_t i = begin; i < end; i++) {
+				ATOMIC_INC_FETCH(&counters[i]);
+			}
+		}
+
+		/**
+		 * Nested parallelFor() parameters.
+		 */
+		struct NestedParam {
+			ThreadPool *pool;
+			volatile int *counters;
+			size_t innerCount;
+		};
+
+		/**
+		 * Range function: Run an inner parallelFor() for each outer index.
+		 * @param param NestedParam
+		 * @param begin First outer index
+		 * @param end One past the last outer index
+		 */
+		static void nestedRange(void *param, size_t begin, size_t end)
+		{
+			const NestedParam *const np = static_cast<const NestedParam*>(param);
+			for (size_t i = begin; i < end; i++) {
+				const size_t base = i * np->innerCount;
+				np->pool->parallelFor(base, base + np->innerCount,
+					incRange, const_cast<int*>(np->counters), 3);
+			}
+		}
+
+		/**
+		 * Task function: Increment an int.
+		 * @param param volatile int
+		 */
+		static void incTask(void *param)
+		{
+			ATOMIC_INC_FETCH(static_cast<volatile int*>(param));
+		}
+
+		/**
+		 * Parameters for a task that waits for its own subtasks.
+		 */
+		struct WaitParam {
+			ThreadPool *pool;
+			volatile int counter;	// Incremented by each subtask
+			int seen;		// Value of counter after waiting
+			bool wasWorker;		// True if run on a worker thread
+		};
+
+		// Number of subtasks submitted by waitTask().
+		static const unsigned int SUBTASK_COUNT = 16;
+
+		/**
+		 * Task function: Submit subtasks and wait for them.
+		 * @param param WaitParam
+		 */
+		static void waitTask(void *param)
+		{
+			WaitParam *const wp = static_cast<WaitParam*>(param);
+			wp->wasWorker = wp->pool->isWorkerThread();
+
+			TaskFuture futures[SUBTASK_COUNT];
+			for (unsigned int i = 0; i < SUBTASK_COUNT; i++) {
+				wp->pool->submit(incTask, const_cast<int*>(&wp->counter), &futures[i]);
+			}
+			for (unsigned int i = 0; i < SUBTASK_COUNT; i++) {
+				futures[i].wait();
+			}
+			wp->seen = wp->counter;
+		}
+
+		/**
+		 * Cancellation parameters.
+		 */
+		struct CancelParam {
+			CancelToken *token;
+			volatile int processed;	// Number of indexes processed
+			size_t cancelAfter;	// Cancel once this many indexes have been processed
+		};
+
+		/**
+		 * Range function: Cancel the token after a number of indexes.
+		 * @param param CancelParam
+		 * @param begin First index
+		 * @param end One past the last index
+		 */
+		static void cancelRange(void *param, size_t begin, size_t end)
+		{
+			CancelParam *const cp = static_cast<CancelParam*>(param);
+			for (size_t i = begin; i < end; i++) {
+				const int n = ATOMIC_INC_FETCH(&cp->processed);
+				if (static_cast<size_t>(n) >= cp->cancelAfter) {
+					cp->token->cancel();
+				}
+			}
+		}
+};
+
+// Out-of-class definitions for the constants, since they're
+// passed by reference to EXPECT_EQ().
+const unsigned int ThreadPoolTest::POOL_THREADS;
+const unsigned int ThreadPoolTest::INDEX_COUNT;
+const unsigned int ThreadPoolTest::SUBTASK_COUNT;
+
+/**
+ * parallelFor() must process every index exactly once,
+ * regardless of the grain size.
+ */
+TEST_F(ThreadPoolTest, parallelForAllIndexes)
+{
+	static const size_t grains[] = {0, 1, 7, 64, INDEX_COUNT, INDEX_COUNT * 2};
+	for (size_t grain : grains) {
+		unique_ptr<volatile int[]> counters(new volatile int[INDEX_COUNT]);
+		for (unsigned int i = 0; i < INDEX_COUNT; i++) {
+			counters[i] = 0;
+		}
+
+		EXPECT_EQ(0, m_pool->parallelFor(0, INDEX_COUNT, incRange,
+			const_cast<int*>(counters.get()), grain)) << "grain == " << grain;
+		for (unsigned int i = 0; i < INDEX_COUNT; i++) {
+			ASSERT_EQ(1, counters[i]) << "grain == " << grain << ", index == " << i;
+		}
+	}
+}
+
+/**
+ * parallelFor() called from within parallelFor() must not deadlock,
+ * even if there are more outer chunks than worker threads.
+ */
+TEST_F(ThreadPoolTest, parallelForNested)
+{
+	static const size_t outerCount = POOL_THREADS * 4;
+	static const size_t innerCount = 64;
+	unique_ptr<volatile int[]> counters(new volatile int[outerCount * innerCount]);
+	for (size_t i = 0; i < outerCount * innerCount; i++) {
+		counters[i] = 0;
+	}
+
+	NestedParam np;
+	np.pool = m_pool.get();
+	np.counters = counters.get();
+	np.innerCount = innerCount;
+	EXPECT_EQ(0, m_pool->parallelFor(0, outerCount, nestedRange, &np));
+
+	for (size_t i = 0; i < outerCount * innerCount; i++) {
+		ASSERT_EQ(1, counters[i]) << "index == " << i;
+	}
+}
+
+/**
+ * TaskFuture::wait() called from a worker thread must run the
+ * pending subtasks instead of blocking. With a single worker,
+ * the subtasks can't run anywhere else, so this deadlocks
+ * if wait() blocks.
+ */
+TEST_F(ThreadPoolTest, waitFromWorker)
+{
+	m_pool.reset(new ThreadPool(1));
+	ASSERT_EQ(1U, m_pool->threadCount());
+
+	WaitParam wp;
+	wp.pool = m_pool.get();
+	wp.counter = 0;
+	wp.seen = -1;
+	wp.wasWorker = false;
+
+	TaskFuture future;
+	ASSERT_EQ(0, m_pool->submit(waitTask, &wp, &future));
+	future.wait();
+
+	EXPECT_TRUE(future.isDone());
+	EXPECT_FALSE(future.wasCancelled());
+	EXPECT_TRUE(wp.wasWorker);
+	EXPECT_EQ(static_cast<int>(SUBTASK_COUNT), wp.seen);
+}
+
+/**
+ * Tasks submitted with an already-cancelled token are skipped,
+ * and their futures report cancellation.
+ */
+TEST_F(ThreadPoolTest, submitCancelled)
+{
+	CancelToken token;
+	token.cancel();
+
+	volatile int counter = 0;
+	TaskFuture futures[SUBTASK_COUNT];
+	for (unsigned int i = 0; i < SUBTASK_COUNT; i++) {
+		ASSERT_EQ(0, m_pool->submit(incTask, const_cast<int*>(&counter), &futures[i], &token));
+	}
+	for (unsigned int i = 0; i < SUBTASK_COUNT; i++) {
+		futures[i].wait();
+		EXPECT_TRUE(futures[i].isDone()) << "task == " << i;
+		EXPECT_TRUE(futures[i].wasCancelled()) << "task == " << i;
+	}
+	EXPECT_EQ(0, counter);
+}
+
+/**
+ * parallelFor() with an already-cancelled token
+ * doesn't process anything and returns -ECANCELED.
+ */
+TEST_F(ThreadPoolTest, parallelForCancelledBeforeStart)
+{
+	CancelToken token;
+	token.cancel();
+
+	unique_ptr<volatile int[]> counters(new volatile int[INDEX_COUNT]);
+	for (unsigned int i = 0; i < INDEX_COUNT; i++) {
+		counters[i] = 0;
+	}
+
+	EXPECT_EQ(-ECANCELED, m_pool->parallelFor(0, INDEX_COUNT, incRange,
+		const_cast<int*>(counters.get()), 1, &token));
+	for (unsigned int i = 0; i < INDEX_COUNT; i++) {
+		ASSERT_EQ(0, counters[i]) << "index == " << i;
+	}
+}
+
+/**
+ * Cancelling the token while parallelFor() is running skips
+ * the remaining chunks and returns -ECANCELED.
+ */
+TEST_F(ThreadPoolTest, parallelForCancelledWhileRunning)
+{
+	CancelToken token;
+	CancelParam cp;
+	cp.token = &token;
+	cp.processed = 0;
+	cp.cancelAfter = 16;
+
+	EXPECT_EQ(-ECANCELED, m_pool->parallelFor(0, INDEX_COUNT, cancelRange, &cp, 1, &token));
+	EXPECT_TRUE(token.isCancelled());
+	EXPECT_GE(cp.processed, static_cast<int>(cp.cancelAfter));
+	// Chunks that were already running when the token was
+	// cancelled may finish, but nothing else should start.
+	EXPECT_LE(cp.processed, static_cast<int>(cp.cancelAfter + POOL_THREADS + 1));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpThreads test suite: ThreadPool tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
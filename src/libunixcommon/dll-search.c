@@ -13,12 +13,17 @@
 #include <assert.h>
 #include <dlfcn.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
+// stat(), mkdir()
+#include <fcntl.h>
+#include <sys/stat.h>
+
 // OpenBSD 6.5 doesn't have the static_assert() macro,
 // even though it *does* use LLVM/Clang 7.0.1.
 #ifndef static_assert
@@ -308,8 +313,300 @@ static RP_Frontend get_active_de(void)
 	return ret;
 }
 
+/** Plugin resolution cache **/
+
+// Resolved plugins are cached in $XDG_RUNTIME_DIR, which is per-user
+// and is cleared when the user logs out. Each entry is validated by
+// stat()'ing the plugin, so the process tree only has to be walked
+// once per desktop session instead of once per thumbnail.
+// NOTE: Entries store an RP_Frontend index, not a path, so only
+// plugins listed in RP_Extension_Path[] can be loaded from the cache.
+#define DLL_CACHE_SUBDIR	"/rom-properties"
+#define DLL_CACHE_FILENAME	"/dll-search.cache"
+#define DLL_CACHE_MAGIC		"RPDLL1\n"
+#define DLL_CACHE_MAX_ENTRIES	16
+
+// Cache entry.
+typedef struct _dll_cache_entry {
+	char symname[64];
+	unsigned int fe;		// RP_Frontend
+	unsigned long long dev;
+	unsigned long long ino;
+	long long mtime;
+	long long size;
+} dll_cache_entry;
+
+/**
+ * Get the desktop session key for the plugin resolution cache.
+ * The active desktop environment is determined from these
+ * variables, so entries are only valid if they match.
+ * @param buf	[out] Key buffer. (newline-terminated)
+ * @param size	[in] Size of buf.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int dll_cache_get_key(char *buf, size_t size)
+{
+	const char *xdg_current_desktop = getenv("XDG_CURRENT_DESKTOP");
+	const char *xdg_session_desktop = getenv("XDG_SESSION_DESKTOP");
+	if (!xdg_current_desktop)
+		xdg_current_desktop = "";
+	if (!xdg_session_desktop)
+		xdg_session_desktop = "";
+
+	int len = snprintf(buf, size, "desktop=%s;%s\n", xdg_current_desktop, xdg_session_desktop);
+	if (len < 0 || (size_t)len >= size) {
+		// Key is too long.
+		return -ENAMETOOLONG;
+	}
+
+	// The key must only have one newline.
+	if (strchr(buf, '\n') != &buf[len-1]) {
+		return -EINVAL;
+	}
+	return 0;
+}
+
+/**
+ * Get the plugin resolution cache filename.
+ * @param buf	[out] Filename buffer.
+ * @param size	[in] Size of buf.
+ * @param mkdir_subdir [in] If true, create the rom-properties subdirectory.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int dll_cache_get_filename(char *buf, size_t size, bool mkdir_subdir)
+{
+	const char *const xdg_runtime_dir = getenv("XDG_RUNTIME_DIR");
+	if (!xdg_runtime_dir || xdg_runtime_dir[0] != '/') {
+		// $XDG_RUNTIME_DIR must be an absolute path.
+		return -ENOENT;
+	}
+
+	int len = snprintf(buf, size, "%s" DLL_CACHE_SUBDIR, xdg_runtime_dir);
+	if (len < 0 || (size_t)len >= size) {
+		return -ENAMETOOLONG;
+	}
+	if (mkdir_subdir) {
+		if (mkdir(buf, 0700) != 0 && errno != EEXIST) {
+			int err = -errno;
+			return (err != 0 ? err : -EIO);
+		}
+	}
+
+	len = snprintf(buf, size, "%s" DLL_CACHE_SUBDIR DLL_CACHE_FILENAME, xdg_runtime_dir);
+	if (len < 0 || (size_t)len >= size) {
+		return -ENAMETOOLONG;
+	}
+	return 0;
+}
+
+/**
+ * Initialize a cache entry for a plugin.
+ * @param entry		[out] Cache entry.
+ * @param symname	[in] Symbol name.
+ * @param fe		[in] RP_Frontend
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int dll_cache_init_entry(dll_cache_entry *entry, const char *symname, RP_Frontend fe)
+{
+	const char *const plugin_path = RP_Extension_Path[fe];
+	if (!plugin_path || strlen(symname) >= sizeof(entry->symname)) {
+		return -EINVAL;
+	}
+
+	struct stat sb;
+	if (stat(plugin_path, &sb) != 0) {
+		int err = -errno;
+		return (err != 0 ? err : -EIO);
+	}
+
+	strcpy(entry->symname, symname);
+	entry->fe = (unsigned int)fe;
+	entry->dev = (unsigned long long)sb.st_dev;
+	entry->ino = (unsigned long long)sb.st_ino;
+	entry->mtime = (long long)sb.st_mtime;
+	entry->size = (long long)sb.st_size;
+	return 0;
+}
+
+/**
+ * Read the plugin resolution cache.
+ * @param key		[in] Desktop session key.
+ * @param entries	[out] Cache entries. (DLL_CACHE_MAX_ENTRIES)
+ * @return Number of entries read. (0 if the cache is missing or invalid)
+ */
+static int dll_cache_read(const char *key, dll_cache_entry *entries)
+{
+	char filename[256];
+	if (dll_cache_get_filename(filename, sizeof(filename), false) != 0) {
+		return 0;
+	}
+
+	FILE *const f = fopen(filename, "r");
+	if (!f) {
+		return 0;
+	}
+
+	// Verify the magic number and desktop session key.
+	char buf[256];
+	if (!fgets(buf, sizeof(buf), f) || strcmp(buf, DLL_CACHE_MAGIC) != 0 ||
+	    !fgets(buf, sizeof(buf), f) || strcmp(buf, key) != 0)
+	{
+		fclose(f);
+		return 0;
+	}
+
+	int count = 0;
+	while (count < DLL_CACHE_MAX_ENTRIES && fgets(buf, sizeof(buf), f) != NULL) {
+		dll_cache_entry *const entry = &entries[count];
+		if (sscanf(buf, "%63s %u %llu %llu %lld %lld",
+			entry->symname, &entry->fe, &entry->dev,
+			&entry->ino, &entry->mtime, &entry->size) == 6 &&
+		    entry->fe < RP_FE_MAX)
+		{
+			count++;
+		}
+	}
+	fclose(f);
+	return count;
+}
+
+/**
+ * Look up a plugin in the plugin resolution cache.
+ * @param key		[in] Desktop session key.
+ * @param symname	[in] Symbol name.
+ * @return RP_Frontend, or RP_FE_MAX if not found or out of date.
+ */
+static RP_Frontend dll_cache_lookup(const char *key, const char *symname)
+{
+	dll_cache_entry entries[DLL_CACHE_MAX_ENTRIES];
+	const int count = dll_cache_read(key, entries);
+	for (int i = 0; i < count; i++) {
+		if (strcmp(entries[i].symname, symname) != 0)
+			continue;
+
+		// Make sure the plugin hasn't changed.
+		dll_cache_entry cur;
+		if (dll_cache_init_entry(&cur, symname, (RP_Frontend)entries[i].fe) != 0 ||
+		    cur.dev != entries[i].dev || cur.ino != entries[i].ino ||
+		    cur.mtime != entries[i].mtime || cur.size != entries[i].size)
+		{
+			break;
+		}
+		return (RP_Frontend)entries[i].fe;
+	}
+
+	return RP_FE_MAX;
+}
+
+/**
+ * Store a plugin in the plugin resolution cache.
+ * Entries for other symbols are preserved.
+ * @param key		[in] Desktop session key.
+ * @param symname	[in] Symbol name.
+ * @param fe		[in] RP_Frontend
+ */
+static void dll_cache_store(const char *key, const char *symname, RP_Frontend fe)
+{
+	dll_cache_entry entries[DLL_CACHE_MAX_ENTRIES];
+	int count = dll_cache_read(key, entries);
+
+	// Remove the existing entry for this symbol, if any.
+	for (int i = 0; i < count; i++) {
+		if (!strcmp(entries[i].symname, symname)) {
+			memmove(&entries[i], &entries[i+1], (count-i-1) * sizeof(entries[0]));
+			count--;
+			break;
+		}
+	}
+	if (count >= DLL_CACHE_MAX_ENTRIES) {
+		// Drop the oldest entry.
+		memmove(&entries[0], &entries[1], (count-1) * sizeof(entries[0]));
+		count--;
+	}
+	if (dll_cache_init_entry(&entries[count], symname, fe) != 0) {
+		return;
+	}
+	count++;
+
+	char filename[256];
+	char tmp_filename[264];
+	if (dll_cache_get_filename(filename, sizeof(filename), true) != 0) {
+		return;
+	}
+
+	// Write to a temporary file, then rename it, since
+	// multiple processes may be updating the cache.
+	snprintf(tmp_filename, sizeof(tmp_filename), "%s.XXXXXX", filename);
+	const int fd = mkstemp(tmp_filename);
+	if (fd < 0) {
+		return;
+	}
+	FILE *const f = fdopen(fd, "w");
+	if (!f) {
+		close(fd);
+		unlink(tmp_filename);
+		return;
+	}
+
+	fputs(DLL_CACHE_MAGIC, f);
+	fputs(key, f);
+	for (int i = 0; i < count; i++) {
+		fprintf(f, "%s %u %llu %llu %lld %lld\n",
+			entries[i].symname, entries[i].fe, entries[i].dev,
+			entries[i].ino, entries[i].mtime, entries[i].size);
+	}
+	if (fclose(f) != 0 || rename(tmp_filename, filename) != 0) {
+		unlink(tmp_filename);
+	}
+}
+
+/**
+ * Attempt to open a plugin and look up a symbol.
+ * @param fe		[in] RP_Frontend
+ * @param symname	[in] Symbol name to look up.
+ * @param ppDll		[out] Handle to opened library.
+ * @param ppfn		[out] Pointer to function.
+ * @param pfnDebug	[in,opt] Pointer to debug logging function. (may be NULL)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int try_plugin(RP_Frontend fe, const char *symname, void **ppDll, void **ppfn, PFN_RP_DLL_DEBUG pfnDebug)
+{
+	const char *const plugin_path = RP_Extension_Path[fe];
+	if (!plugin_path)
+		return -ENOENT;
+
+	if (pfnDebug) {
+		pfnDebug(LEVEL_DEBUG, "Attempting to open: %s", plugin_path);
+	}
+	*ppDll = dlopen(plugin_path, RTLD_LOCAL|RTLD_LAZY);
+	if (!*ppDll) {
+		// Library not found.
+		return -ENOENT;
+	}
+
+	// Find the requested symbol.
+	if (pfnDebug) {
+		pfnDebug(LEVEL_DEBUG, "Checking for symbol: %s", symname);
+	}
+	*ppfn = dlsym(*ppDll, symname);
+	if (!*ppfn) {
+		// Symbol not found.
+		dlclose(*ppDll);
+		*ppDll = NULL;
+		return -ENOENT;
+	}
+
+	// Found the symbol.
+	return 0;
+}
+
 /**
  * Search for a rom-properties library.
+ *
+ * The resolved library is cached in $XDG_RUNTIME_DIR for the
+ * current desktop session, so the process tree doesn't have
+ * to be walked every time.
+ *
  * @param symname	[in] Symbol name to look up.
  * @param ppDll		[out] Handle to opened library.
  * @param ppfn		[out] Pointer to function.
@@ -318,6 +615,24 @@ static RP_Frontend get_active_de(void)
  */
 int rp_dll_search(const char *symname, void **ppDll, void **ppfn, PFN_RP_DLL_DEBUG pfnDebug)
 {
+	*ppDll = NULL;
+	*ppfn = NULL;
+
+	// Check the plugin resolution cache first.
+	char key[256];
+	const bool use_cache = (dll_cache_get_key(key, sizeof(key)) == 0);
+	if (use_cache) {
+		const RP_Frontend fe = dll_cache_lookup(key, symname);
+		if (fe < RP_FE_MAX) {
+			if (pfnDebug) {
+				pfnDebug(LEVEL_DEBUG, "Using cached plugin: %s", RP_Extension_Path[fe]);
+			}
+			if (try_plugin(fe, symname, ppDll, ppfn, pfnDebug) == 0) {
+				return 0;
+			}
+		}
+	}
+
 	// Attempt to open all available plugins.
 	RP_Frontend cur_desktop = get_active_de();
 	assert(cur_desktop >= 0);
@@ -350,45 +665,19 @@ int rp_dll_search(const char *symname, void **ppDll, void **ppfn, PFN_RP_DLL_DEB
 	}
 
 	const uint8_t *const prio = &plugin_prio[cur_desktop][0];
-	*ppDll = NULL;
-	*ppfn = NULL;
 	for (unsigned int i = 0; i < RP_FE_MAX; i++) {
 		// Attempt to open this plugin.
-		const char *const plugin_path = RP_Extension_Path[prio[i]];
-		if (!plugin_path)
-			continue;
-
-		if (pfnDebug) {
-			pfnDebug(LEVEL_DEBUG, "Attempting to open: %s", plugin_path);
-		}
-		*ppDll = dlopen(plugin_path, RTLD_LOCAL|RTLD_LAZY);
-		if (!*ppDll) {
-			// Library not found.
-			continue;
-		}
-
-		// Find the requested symbol.
-		if (pfnDebug) {
-			pfnDebug(LEVEL_DEBUG, "Checking for symbol: %s", symname);
-		}
-		*ppfn = dlsym(*ppDll, symname);
-		if (!*ppfn) {
-			// Symbol not found.
-			dlclose(*ppDll);
-			*ppDll = NULL;
-			continue;
+		if (try_plugin((RP_Frontend)prio[i], symname, ppDll, ppfn, pfnDebug) == 0) {
+			// Found the symbol.
+			if (use_cache) {
+				dll_cache_store(key, symname, (RP_Frontend)prio[i]);
+			}
+			return 0;
 		}
-
-		// Found the symbol.
-		break;
 	}
 
-	if (!*ppfn) {
-		if (pfnDebug) {
-			pfnDebug(LEVEL_ERROR, "*** ERROR: Could not find %s() in any installed rom-properties plugin.", symname);
-		}
-		return -ENOENT;
+	if (pfnDebug) {
+		pfnDebug(LEVEL_ERROR, "*** ERROR: Could not find %s() in any installed rom-properties plugin.", symname);
 	}
-
-	return 0;
+	return -ENOENT;
 }
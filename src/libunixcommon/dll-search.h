@@ -36,6 +36,11 @@ typedef int (*PFN_RP_DLL_DEBUG)(int level, const char *format, ...) ATTR_PRINTF(
 
 /**
  * Search for a rom-properties library.
+ *
+ * The resolved library is cached in $XDG_RUNTIME_DIR for the
+ * current desktop session, so the process tree doesn't have
+ * to be walked every time.
+ *
  * @param symname	[in] Symbol name to look up.
  * @param ppDll		[out] Handle to opened library.
  * @param ppfn		[out] Pointer to function.
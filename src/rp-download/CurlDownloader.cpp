@@ -19,16 +19,26 @@ namespace RpDownload {
 
 CurlDownloader::CurlDownloader()
 	: super()
+	, m_curl(nullptr)
 { }
 
 CurlDownloader::CurlDownloader(const TCHAR *url)
 	: super(url)
+	, m_curl(nullptr)
 { }
 
 CurlDownloader::CurlDownloader(const tstring &url)
 	: super(url)
+	, m_curl(nullptr)
 { }
 
+CurlDownloader::~CurlDownloader()
+{
+	if (m_curl) {
+		curl_easy_cleanup(static_cast<CURL*>(m_curl));
+	}
+}
+
 /**
  * Internal cURL data write function.
  * @param ptr Data to write.
@@ -151,10 +161,16 @@ size_t CurlDownloader::parse_header(char *ptr, size_t size, size_t nitems, void
 }
 
 /**
- * Download the file.
- * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+ * Prepare the cURL easy handle for downloading the current URL.
+ * The handle can either be used with curl_easy_perform(),
+ * or added to a cURL multi handle.
+ *
+ * The handle is owned by this object. endDownload() must be
+ * called once the transfer has completed.
+ *
+ * @return cURL easy handle (actually CURL*), or nullptr on error.
  */
-int CurlDownloader::download(void)
+void *CurlDownloader::beginDownload(void)
 {
 	// References:
 	// - http://stackoverflow.com/questions/1636333/download-file-using-libcurl-in-c-c
@@ -166,10 +182,16 @@ int CurlDownloader::download(void)
 	m_mtime = -1;
 
 	// Initialize cURL.
-	CURL *curl = curl_easy_init();
+	// NOTE: The handle is reused for subsequent downloads, which
+	// allows cURL to keep the connection alive and reuse it.
+	CURL *curl = static_cast<CURL*>(m_curl);
 	if (!curl) {
-		// Could not initialize cURL.
-		return -ENOMEM;	// TODO: Better error?
+		curl = curl_easy_init();
+		if (!curl) {
+			// Could not initialize cURL.
+			return nullptr;
+		}
+		m_curl = curl;
 	}
 
 	// Proxy settings should be set by the calling application
@@ -186,6 +208,27 @@ int CurlDownloader::download(void)
 	// TODO: Limit the number of redirects?
 	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, true);
 
+	// Use HTTP/2 over TLS if the server supports it.
+	// When used with a cURL multi handle, wait for an existing
+	// connection to be available for multiplexing instead of
+	// opening a new connection.
+#if LIBCURL_VERSION_NUM >= 0x072F00	/* 7.47.0 */
+	curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+#endif /* LIBCURL_VERSION_NUM >= 0x072F00 */
+#if LIBCURL_VERSION_NUM >= 0x072B00	/* 7.43.0 */
+	curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+#endif /* LIBCURL_VERSION_NUM >= 0x072B00 */
+
+	// Conditional request.
+	// NOTE: Always set, since the handle is reused.
+	if (m_ifModifiedSince >= 0) {
+		curl_easy_setopt(curl, CURLOPT_TIMECONDITION, static_cast<long>(CURL_TIMECOND_IFMODSINCE));
+		curl_easy_setopt(curl, CURLOPT_TIMEVALUE, static_cast<long>(m_ifModifiedSince));
+	} else {
+		curl_easy_setopt(curl, CURLOPT_TIMECONDITION, static_cast<long>(CURL_TIMECOND_NONE));
+		curl_easy_setopt(curl, CURLOPT_TIMEVALUE, 0L);
+	}
+
 	// Header and data functions.
 	curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, parse_header);
 	curl_easy_setopt(curl, CURLOPT_HEADERDATA, this);
@@ -206,10 +249,20 @@ int CurlDownloader::download(void)
 	// Set the User-Agent.
 	curl_easy_setopt(curl, CURLOPT_USERAGENT, m_userAgent.c_str());
 
-	// Download the file.
-	CURLcode res = curl_easy_perform(curl);
-	curl_easy_cleanup(curl);
-	switch (res) {
+	m_inProgress = true;
+	return curl;
+}
+
+/**
+ * Finish a download that was started with beginDownload().
+ * @param result CURLcode returned by the transfer.
+ * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+ */
+int CurlDownloader::endDownload(int result)
+{
+	m_inProgress = false;
+
+	switch (static_cast<CURLcode>(result)) {
 		case CURLE_OK:
 			// File downloaded successfully.
 			break;
@@ -223,7 +276,7 @@ int CurlDownloader::download(void)
 			// Check if we have an HTTP response code.
 			// NOTE: GameTDB sometimes returns nothing instead of 404...
 			long response_code = 0;
-			curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+			curl_easy_getinfo(static_cast<CURL*>(m_curl), CURLINFO_RESPONSE_CODE, &response_code);
 			if (response_code <= 0) {
 				// No HTTP response code.
 				// TODO: Return a cURL error code and/or message...
@@ -232,6 +285,17 @@ int CurlDownloader::download(void)
 			return (int)response_code;
 	}
 
+	if (m_ifModifiedSince >= 0) {
+		// Check if the file was not modified.
+		// cURL returns CURLE_OK with no data in this case.
+		long response_code = 0;
+		curl_easy_getinfo(static_cast<CURL*>(m_curl), CURLINFO_RESPONSE_CODE, &response_code);
+		if (response_code == 304) {
+			// Not Modified.
+			return 304;
+		}
+	}
+
 	// Check if we have data.
 	if (m_data.empty()) {
 		// No data.
@@ -242,4 +306,20 @@ int CurlDownloader::download(void)
 	return 0;
 }
 
+/**
+ * Download the file.
+ * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+ */
+int CurlDownloader::download(void)
+{
+	CURL *const curl = static_cast<CURL*>(beginDownload());
+	if (!curl) {
+		// Could not initialize cURL.
+		return -ENOMEM;	// TODO: Better error?
+	}
+
+	// Download the file.
+	return endDownload(curl_easy_perform(curl));
+}
+
 }
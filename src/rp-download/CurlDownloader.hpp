@@ -19,6 +19,7 @@ class CurlDownloader final : public IDownloader
 		CurlDownloader();
 		explicit CurlDownloader(const TCHAR *url);
 		explicit CurlDownloader(const std::tstring &url);
+		~CurlDownloader() final;
 
 	private:
 		typedef IDownloader super;
@@ -46,11 +47,36 @@ class CurlDownloader final : public IDownloader
 		static size_t parse_header(char *ptr, size_t size, size_t nitems, void *userdata);
 
 	public:
+		/**
+		 * Prepare the cURL easy handle for downloading the current URL.
+		 * The handle can either be used with curl_easy_perform(),
+		 * or added to a cURL multi handle.
+		 *
+		 * The handle is owned by this object. endDownload() must be
+		 * called once the transfer has completed.
+		 *
+		 * @return cURL easy handle (actually CURL*), or nullptr on error.
+		 */
+		void *beginDownload(void);
+
+		/**
+		 * Finish a download that was started with beginDownload().
+		 * @param result CURLcode returned by the transfer.
+		 * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+		 */
+		int endDownload(int result);
+
 		/**
 		 * Download the file.
 		 * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
 		 */
 		int download(void) final;
+
+	private:
+		// cURL easy handle. (actually CURL*)
+		// Created on the first download and reused afterwards,
+		// so multiple downloads can share connections.
+		void *m_curl;
 };
 
 }
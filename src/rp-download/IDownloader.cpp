@@ -37,6 +37,7 @@ IDownloader::IDownloader()
 IDownloader::IDownloader(const TCHAR *url)
 	: m_url(url)
 	, m_mtime(-1)
+	, m_ifModifiedSince(-1)
 	, m_inProgress(false)
 	, m_maxSize(0)
 #ifdef _WIN32
@@ -49,6 +50,7 @@ IDownloader::IDownloader(const TCHAR *url)
 IDownloader::IDownloader(const tstring &url)
 	: m_url(url)
 	, m_mtime(-1)
+	, m_ifModifiedSince(-1)
 	, m_inProgress(false)
 	, m_maxSize(0)
 {
@@ -120,6 +122,27 @@ void IDownloader::setMaxSize(size_t maxSize)
 	m_maxSize = maxSize;
 }
 
+/**
+ * Get the If-Modified-Since time for conditional requests.
+ * @return If-Modified-Since time, or -1 if not set.
+ */
+time_t IDownloader::ifModifiedSince(void) const
+{
+	return m_ifModifiedSince;
+}
+
+/**
+ * Set the If-Modified-Since time for conditional requests.
+ * If the file on the server hasn't been modified since
+ * this time, download() will return 304.
+ * @param ifModifiedSince If-Modified-Since time, or -1 to disable.
+ */
+void IDownloader::setIfModifiedSince(time_t ifModifiedSince)
+{
+	assert(!m_inProgress);
+	m_ifModifiedSince = ifModifiedSince;
+}
+
 /** Data accessors. **/
 
 /**
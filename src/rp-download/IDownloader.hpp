@@ -81,6 +81,20 @@ class IDownloader
 		 */
 		void setMaxSize(size_t maxSize);
 
+		/**
+		 * Get the If-Modified-Since time for conditional requests.
+		 * @return If-Modified-Since time, or -1 if not set.
+		 */
+		time_t ifModifiedSince(void) const;
+
+		/**
+		 * Set the If-Modified-Since time for conditional requests.
+		 * If the file on the server hasn't been modified since
+		 * this time, download() will return 304.
+		 * @param ifModifiedSince If-Modified-Since time, or -1 to disable.
+		 */
+		void setIfModifiedSince(time_t ifModifiedSince);
+
 	public:
 		/** Data accessors. **/
 
@@ -110,6 +124,7 @@ class IDownloader
 	public:
 		/**
 		 * Download the file.
+		 * If ifModifiedSince() is set and the file wasn't modified, 304 is returned.
 		 * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
 		 */
 		virtual int download(void) = 0;
@@ -136,6 +151,9 @@ class IDownloader
 		// Last-Modified time.
 		time_t m_mtime;
 
+		// If-Modified-Since time. (-1 if not set)
+		time_t m_ifModifiedSince;
+
 		bool m_inProgress;	// Set when downloading.
 		size_t m_maxSize;	// Maximum buffer size. (0 == unlimited)
 
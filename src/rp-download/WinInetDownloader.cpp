@@ -80,12 +80,26 @@ int WinInetDownloader::download(void)
 		}
 	}
 
+	// Conditional request.
+	TCHAR szHeaders[64];
+	szHeaders[0] = _T('\0');
+	if (m_ifModifiedSince >= 0) {
+		SYSTEMTIME st_ims;
+		UnixTimeToSystemTime(m_ifModifiedSince, &st_ims);
+		TCHAR szTime[INTERNET_RFC1123_BUFSIZE];
+		if (InternetTimeFromSystemTime(&st_ims, INTERNET_RFC1123_FORMAT, szTime, sizeof(szTime))) {
+			_sntprintf(szHeaders, _countof(szHeaders), _T("If-Modified-Since: %s\r\n"), szTime);
+			// Don't let WinInet return its own cached copy.
+			dwFlags |= INTERNET_FLAG_RELOAD;
+		}
+	}
+
 	// Request the URL.
 	HINTERNET hURL = InternetOpenUrl(
 		hConnection,	// hInternet
 		m_url.c_str(),	// lpszUrl (Latin-1 characters only!)
-		nullptr,	// lpszHeaders
-		0,		// dwHeaderLength
+		(szHeaders[0] != _T('\0') ? szHeaders : nullptr),	// lpszHeaders
+		static_cast<DWORD>(-1L),	// dwHeaderLength
 		dwFlags,	// dwFlags
 		reinterpret_cast<DWORD_PTR>(this));	// dwContext
 	if (!hURL) {
@@ -113,6 +127,7 @@ int WinInetDownloader::download(void)
 		if (dwBufferLength == static_cast<DWORD>(sizeof(dwHttpStatusCode))) {
 			// Length is valid.
 			// We're only accepting HTTP 200.
+			// NOTE: 304 is returned as-is for conditional requests.
 			if (dwHttpStatusCode != 200) {
 				// Unexpected status code.
 				InternetCloseHandle(hURL);
@@ -15,6 +15,7 @@
 // C includes.
 #ifndef _WIN32
 # include <fcntl.h>
+# include <poll.h>
 # include <sys/stat.h>
 # include <unistd.h>
 #endif /* _WIN32 */
@@ -35,10 +36,14 @@
 #include <cstdio>
 
 // C++ includes.
+#include <deque>
 #include <memory>
+#include <unordered_map>
+using std::deque;
 using std::string;
 using std::tstring;
 using std::unique_ptr;
+using std::unordered_map;
 
 #ifdef _WIN32
 // libwin32common
@@ -67,6 +72,7 @@ using std::unique_ptr;
 # include "WinInetDownloader.hpp"
 #else
 # include "CurlDownloader.hpp"
+# include <curl/curl.h>
 #endif
 #include "SetFileOriginInfo.hpp"
 using namespace RpDownload;
@@ -83,6 +89,9 @@ static bool verbose = false;
 static void show_usage(void)
 {
 	_ftprintf(stderr, _T("Syntax: %s [-v] [-f] cache_key\n"), argv0);
+#ifndef _WIN32
+	_ftprintf(stderr, _T("        %s [-v] [-f] [-c max_host_connections] -b\n"), argv0);
+#endif /* !_WIN32 */
 }
 
 /**
@@ -288,185 +297,54 @@ int rmkdir(const tstring &path)
 }
 
 /**
- * rp-download: Download an image from a supported online database.
- * @param cache_key Cache key, e.g. "ds/cover/US/ADAE.png"
- * @return 0 on success; non-zero on error.
- *
- * TODO:
- * - More error codes based on the error.
+ * Download job for a single cache key.
  */
-int RP_C_API _tmain(int argc, TCHAR *argv[])
-{
-	// Create a downloader based on OS:
-	// - Linux: CurlDownloader
-	// - Windows: WinInetDownloader
-
-	// Syntax: rp-download cache_key
-	// Example: rp-download ds/coverM/US/ADAE.png
-
-	// If http_proxy or https_proxy are set, they will be used
-	// by the downloader code if supported.
-
-	// Reduce process integrity, if available.
-	rp_secure_reduce_integrity();
-
-	// Set OS-specific security options.
-	rp_secure_param_t param;
-#if defined(_WIN32)
-	param.bHighSec = FALSE;
-#elif defined(HAVE_SECCOMP)
-	static const int syscall_wl[] = {
-		// Syscalls used by rp-download.
-		// TODO: Add more syscalls.
-		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
-		// defined in earlier versions, including Ubuntu 14.04.
-
-		// NOTE: Special case for clone(). If it's the first syscall
-		// in the list, it has a parameter restriction added that
-		// ensures it can only be used to create threads.
-		SCMP_SYS(clone),
-		// Other multi-threading syscalls
-		SCMP_SYS(set_robust_list),
-
-		SCMP_SYS(access), SCMP_SYS(clock_gettime),
-#if defined(__SNR_clock_gettime64) || defined(__NR_clock_gettime64)
-		SCMP_SYS(clock_gettime64),
-#endif /* __SNR_clock_gettime64 || __NR_clock_gettime64 */
-		SCMP_SYS(close),
-		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
-		SCMP_SYS(fsetxattr),
-		SCMP_SYS(fstat),     SCMP_SYS(fstat64),		// __GI___fxstat() [printf()]
-		SCMP_SYS(fstatat64), SCMP_SYS(newfstatat),	// Ubuntu 19.10 (32-bit)
-		SCMP_SYS(futex),
-		SCMP_SYS(getdents), SCMP_SYS(getdents64),
-		SCMP_SYS(getppid),	// for bubblewrap verification
-		SCMP_SYS(getrusage),
-		SCMP_SYS(gettimeofday),	// 32-bit only?
-		SCMP_SYS(getuid),	// TODO: Only use geteuid()?
-		SCMP_SYS(lseek), SCMP_SYS(_llseek),
-		//SCMP_SYS(lstat), SCMP_SYS(lstat64),	// Not sure if used?
-		SCMP_SYS(mkdir), SCMP_SYS(mmap), SCMP_SYS(mmap2),
-		SCMP_SYS(munmap),
-		SCMP_SYS(open),		// Ubuntu 16.04
-		SCMP_SYS(openat),	// glibc-2.31
-#if defined(__SNR_openat2)
-		SCMP_SYS(openat2),	// Linux 5.6
-#elif defined(__NR_openat2)
-		__NR_openat2,		// Linux 5.6
-#endif /* __SNR_openat2 || __NR_openat2 */
-		SCMP_SYS(poll), SCMP_SYS(select),
-		SCMP_SYS(stat), SCMP_SYS(stat64),
-		SCMP_SYS(unlink),	// to delete expired cache files
-		SCMP_SYS(utimensat),
-
-#if defined(__SNR_statx) || defined(__NR_statx)
-		SCMP_SYS(getcwd),	// called by glibc's statx()
-		SCMP_SYS(statx),
-#endif /* __SNR_statx || __NR_statx */
-
-#ifndef NDEBUG
-		// Needed for assert() on some systems.
-		SCMP_SYS(uname),
-#endif /* NDEBUG */
-
-		// glibc ncsd
-		// TODO: Restrict connect() to AF_UNIX.
-		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
-		SCMP_SYS(sendmmsg),	// getaddrinfo() (32-bit only?)
-		SCMP_SYS(ioctl),	// getaddrinfo() (32-bit only?) [FIXME: Filter for FIONREAD]
-		SCMP_SYS(recvfrom),	// getaddrinfo() (32-bit only?)
-
-		// Needed for network access on Kubuntu 20.04 for some reason.
-		SCMP_SYS(getpid), SCMP_SYS(uname),
-
-		// cURL and OpenSSL
-		SCMP_SYS(bind),		// getaddrinfo() [curl_thread_create_thunk(), curl-7.68.0]
-#ifdef __SNR_getrandom
-		SCMP_SYS(getrandom),
-#endif /* __SNR_getrandom */
-		SCMP_SYS(getpeername), SCMP_SYS(getsockname),
-		SCMP_SYS(getsockopt), SCMP_SYS(madvise), SCMP_SYS(mprotect),
-		SCMP_SYS(setsockopt), SCMP_SYS(socket),
-		SCMP_SYS(socketcall),	// FIXME: Enhanced filtering? [cURL+GnuTLS only?]
-		SCMP_SYS(socketpair), SCMP_SYS(sysinfo),
-		SCMP_SYS(rt_sigprocmask),	// Ubuntu 20.04: __GI_getaddrinfo() ->
-						// gaih_inet() ->
-						// _nss_myhostname_gethostbyname4_r()
-
-		// libnss_resolve.so (systemd-resolved)
-		SCMP_SYS(geteuid),
-		SCMP_SYS(sendmsg),	// libpthread.so [_nss_resolve_gethostbyname4_r() from libnss_resolve.so]
-
-		// FIXME: Manjaro is using these syscalls for some reason...
-		SCMP_SYS(prctl), SCMP_SYS(mremap), SCMP_SYS(ppoll),
-
-		-1	// End of whitelist
-	};
-	param.syscall_wl = syscall_wl;
-#elif defined(HAVE_PLEDGE)
-	// Promises:
-	// - stdio: General stdio functionality.
-	// - rpath: Read from ~/.config/rom-properties/ and ~/.cache/rom-properties/
-	// - wpath: Write to ~/.cache/rom-properties/
-	// - cpath: Create ~/.cache/rom-properties/ if it doesn't exist.
-	// - inet: Internet access.
-	// - fattr: Modify file attributes, e.g. mtime.
-	// - dns: Resolve hostnames.
-	// - getpw: Get user's home directory if HOME is empty.
-	param.promises = "stdio rpath wpath cpath inet fattr dns getpw";
-#elif defined(HAVE_TAME)
-	// NOTE: stdio includes fattr, e.g. utimes().
-	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH |
-	                   TAME_INET | TAME_DNS | TAME_GETPW;
-#else
-	param.dummy = 0;
-#endif
-	rp_secure_enable(param);
-
-	// Store argv[0] globally.
-	argv0 = argv[0];
+struct DownloadJob {
+	tstring cache_key;
+	tstring cache_filename;
+	TCHAR full_url[256];
+	FILE *f_out;	// Cache file (opened by prepare_download())
+	time_t if_modified_since;	// Revalidating an existing cache file if >= 0
 
-	if (argc < 2) {
-		show_usage();
-		return EXIT_FAILURE;
+	DownloadJob()
+		: f_out(nullptr)
+		, if_modified_since(-1)
+	{
+		full_url[0] = _T('\0');
 	}
-
-	// Check for arguments. (simple non-getopt version)
-	bool force = false;
-	int optind = 1;
-	for (; optind < argc; optind++) {
-		if (!argv[optind] || argv[optind][0] != '-') {
-			// End of options.
-			break;
-		}
-
-		// Allow multiple options in one argument, e.g. '-vf'.
-		for (int i = 1; argv[optind][i] != '\0'; i++) {
-			switch (argv[optind][i]) {
-				case 'v':
-					// Verbose mode is enabled.
-					verbose = true;
-					break;
-				case 'f':
-					// Force download is enabled.
-					force = true;
-					break;
-				default:
-					// Invalid parameter.
-					show_error(_T("Unrecognized option: %c"), argv[optind][i]);
-					show_usage();
-					return EXIT_FAILURE;
-			}
+	~DownloadJob()
+	{
+		if (f_out) {
+			fclose(f_out);
 		}
 	}
 
-	if (optind >= argc) {
-		show_error(_T("No cache key specified."));
-		show_usage();
-		return EXIT_FAILURE;
-	}
-	const TCHAR *const cache_key = argv[optind];
+private:
+	RP_DISABLE_COPY(DownloadJob)
+};
+
+/**
+ * prepare_download() result.
+ */
+enum PrepareResult {
+	PREP_FAILED,	// Cache key is invalid, or a negative cache file exists.
+	PREP_CACHED,	// Cache file is already downloaded.
+	PREP_DOWNLOAD,	// Cache file needs to be downloaded.
+};
 
+/**
+ * Prepare a cache key for downloading.
+ *
+ * This validates the cache key, determines the full URL, checks
+ * the existing cache file, and opens the cache file for writing.
+ *
+ * @param cache_key	[in] Cache key, e.g. "ds/cover/US/ADAE.png"
+ * @param force		[in] If true, redownload the file even if it's cached.
+ * @param job		[out] Download job
+ * @return PrepareResult
+ */
+static PrepareResult prepare_download(const TCHAR *cache_key, bool force, DownloadJob &job)
+{
 	// Check the cache key prefix. The prefix indicates the system
 	// and identifies the online database used.
 	// [key] indicates the cache key without the prefix.
@@ -489,14 +367,14 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		// - Does not contain any slashes.
 		// - First slash is either the first or the last character.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		return PREP_FAILED;
 	}
 
 	const ptrdiff_t prefix_len = (slash_pos - cache_key);
 	if (prefix_len <= 0) {
 		// Empty prefix.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		return PREP_FAILED;
 	}
 
 	// Cache key must include a lowercase file extension.
@@ -504,14 +382,14 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 	if (!lastdot) {
 		// No dot...
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		return PREP_FAILED;
 	}
 	if (_tcscmp(lastdot, _T(".png")) != 0 &&
 	    _tcscmp(lastdot, _T(".jpg")) != 0)
 	{
 		// Not a supported file extension.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		return PREP_FAILED;
 	}
 
 	// urlencode the cache key.
@@ -521,14 +399,15 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 
 	// Determine the full URL based on the cache key.
 	bool ok = false;
-	TCHAR full_url[256];
+	TCHAR *const full_url = job.full_url;
+	static const size_t full_url_len = _countof(job.full_url);
 	if ((prefix_len == 3 && (!_tcsncmp(cache_key, _T("wii"), 3) || !_tcsncmp(cache_key, _T("3ds"), 3))) ||
 	    (prefix_len == 4 && !_tcsncmp(cache_key, _T("wiiu"), 4)) ||
 	    (prefix_len == 2 && !_tcsncmp(cache_key, _T("ds"), 2)))
 	{
 		// GameTDB: Wii, Wii U, Nintendo 3DS, Nintendo DS
 		ok = true;
-		_sntprintf(full_url, _countof(full_url),
+		_sntprintf(full_url, full_url_len,
 			_T("https://art.gametdb.com/%s"), cache_key_urlencode.c_str());
 	} else if (prefix_len == 6 && !_tcsncmp(cache_key, _T("amiibo"), 6)) {
 		// amiibo.life: amiibo images
@@ -537,12 +416,12 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		if (filename_len <= 4) {
 			// Can't remove the extension...
 			SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-			return EXIT_FAILURE;
+			return PREP_FAILED;
 		}
 		filename_len -= 4;
 
 		ok = true;
-		_sntprintf(full_url, _countof(full_url),
+		_sntprintf(full_url, full_url_len,
 			_T("https://amiibo.life/nfc/%.*s/image"),
 			static_cast<int>(filename_len), slash_pos+1);
 	} else {
@@ -584,7 +463,7 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		}
 
 		if (ok) {
-			_sntprintf(full_url, _countof(full_url),
+			_sntprintf(full_url, full_url_len,
 				_T("https://rpdb.gerbilsoft.com/%s"), cache_key_urlencode.c_str());
 		}
 	}
@@ -592,7 +471,7 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 	if (!ok) {
 		// Prefix is not supported.
 		SHOW_ERROR(_T("Cache key '%s' has an unsupported prefix."), cache_key);
-		return EXIT_FAILURE;
+		return PREP_FAILED;
 	}
 
 	if (verbose) {
@@ -605,15 +484,16 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		// Cache directory is invalid...
 		// This may happen if bubblewrap is in use.
 		SHOW_ERROR(_T("Unable to access cache directory. Check the sandbox environment!"));
-		return EXIT_FAILURE;
+		return PREP_FAILED;
 	}
 
 	// Get the cache filename.
-	tstring cache_filename = LibCacheCommon::getCacheFilename(cache_key);
+	tstring &cache_filename = job.cache_filename;
+	cache_filename = LibCacheCommon::getCacheFilename(cache_key);
 	if (cache_filename.empty()) {
 		// Invalid cache filename.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		return PREP_FAILED;
 	}
 	if (verbose) {
 		_ftprintf(stderr, _T("Cache Filename: %s\n"), cache_filename.c_str());
@@ -644,30 +524,28 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 				// Less than a week old.
 				if (likely(!force)) {
 					SHOW_INFO(_T("Negative cache file for '%s' has not expired; not redownloading."), cache_key);
-					return EXIT_FAILURE;
+					return PREP_FAILED;
 				} else {
 					SHOW_INFO(_T("Negative cache file for '%s' has not expired, but -f was specified. Redownloading anyway."), cache_key);
 				}
 			}
 
-			// More than a week old.
-			// Delete the cache file and try to download it again.
-			if (_tremove(cache_filename.c_str()) != 0) {
-				SHOW_ERROR(_T("Error deleting negative cache file for '%s': %s"), cache_key, _tcserror(errno));
-				return EXIT_FAILURE;
-			}
+			// More than a week old. Try to download it again.
+			// NOTE: The negative cache file isn't deleted here.
+			// It will be overwritten below, which also refreshes
+			// its timestamp if the file still isn't available.
 		} else if (filesize > 0) {
 			// File is larger than 0 bytes, which indicates
 			// it was previously cached successfully
 			if (likely(!force)) {
 				SHOW_INFO(_T("Cache file for '%s' is already downloaded."), cache_key);
-				return EXIT_SUCCESS;
+				return PREP_CACHED;
 			} else {
-				SHOW_INFO(_T("Cache file for '%s' is already downloaded, but -f was specified. Redownloading anyway."), cache_key);
-				if (_tremove(cache_filename.c_str()) != 0) {
-					SHOW_ERROR(_T("Error deleting cache file for '%s': %s"), cache_key, _tcserror(errno));
-					return EXIT_FAILURE;
-				}
+				// Revalidate the cache file using a conditional request.
+				// The cache file's mtime is the server's Last-Modified time,
+				// so the file is only redownloaded if it was modified.
+				SHOW_INFO(_T("Cache file for '%s' is already downloaded, but -f was specified. Revalidating."), cache_key);
+				job.if_modified_since = filemtime;
 			}
 		}
 	} else if (ret == -ENOENT) {
@@ -676,36 +554,51 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		int ret = rmkdir(cache_filename.c_str());
 		if (ret != 0) {
 			SHOW_ERROR(_T("Error creating directory structure: %s"), _tcserror(-ret));
-			return EXIT_FAILURE;
+			return PREP_FAILED;
 		}
 	} else {
 		// Other error.
 		SHOW_ERROR(_T("Error checking cache file for '%s': %s"), cache_key, _tcserror(-ret));
-		return EXIT_FAILURE;
+		return PREP_FAILED;
 	}
 
-	// Attempt to download the file.
-	// TODO: IDownloaderFactory?
-#ifdef _WIN32
-	unique_ptr<IDownloader> m_downloader(new WinInetDownloader());
-#else /* !_WIN32 */
-	unique_ptr<IDownloader> m_downloader(new CurlDownloader());
-#endif /* _WIN32 */
-
 	// Open the cache file now so we can use it as a negative hit
 	// if the download fails.
-	FILE *f_out = _tfopen(cache_filename.c_str(), _T("wb"));
-	if (!f_out) {
-		// Error opening the cache file.
-		SHOW_ERROR(_T("Error writing to cache file: %s"), _tcserror(errno));
-		return EXIT_FAILURE;
+	// NOTE: If revalidating, the existing cache file is kept
+	// until the new version is downloaded.
+	if (job.if_modified_since < 0) {
+		job.f_out = _tfopen(cache_filename.c_str(), _T("wb"));
+		if (!job.f_out) {
+			// Error opening the cache file.
+			SHOW_ERROR(_T("Error writing to cache file: %s"), _tcserror(errno));
+			return PREP_FAILED;
+		}
 	}
 
-	// TODO: Configure this somewhere?
-	m_downloader->setMaxSize(4*1024*1024);
+	// Download is required.
+	job.cache_key = cache_key;
+	return PREP_DOWNLOAD;
+}
+
+
+/**
+ * Finish a download job.
+ * If the download succeeded, the data is written to the cache file.
+ * Otherwise, the cache file is left empty as a negative cache entry,
+ * unless an existing cache file was being revalidated.
+ * @param downloader	[in] Downloader used for the download
+ * @param ret		[in] Download result
+ * @param job		[in,out] Download job
+ * @return EXIT_SUCCESS on success; EXIT_FAILURE on error.
+ */
+static int finish_download(const IDownloader *downloader, int ret, DownloadJob &job)
+{
+	if (ret == 304 && job.if_modified_since >= 0) {
+		// Cache file was not modified on the server.
+		SHOW_INFO(_T("Cache file for '%s' has not been modified on the server."), job.cache_key.c_str());
+		return EXIT_SUCCESS;
+	}
 
-	m_downloader->setUrl(full_url);
-	ret = m_downloader->download();
 	if (ret != 0) {
 		// Error downloading the file.
 		if (verbose) {
@@ -722,35 +615,543 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 				}
 			}
 		}
-		fclose(f_out);
+		if (job.f_out) {
+			fclose(job.f_out);
+			job.f_out = nullptr;
+		}
 		return EXIT_FAILURE;
 	}
 
-	if (m_downloader->dataSize() <= 0) {
+	if (downloader->dataSize() <= 0) {
 		// No data downloaded...
 		SHOW_ERROR(_T("Error downloading file: 0 bytes received"));
-		fclose(f_out);
+		if (job.f_out) {
+			fclose(job.f_out);
+			job.f_out = nullptr;
+		}
 		return EXIT_FAILURE;
 	}
 
+	if (!job.f_out) {
+		// Revalidated cache file was modified on the server.
+		// Open the cache file now.
+		job.f_out = _tfopen(job.cache_filename.c_str(), _T("wb"));
+		if (!job.f_out) {
+			// Error opening the cache file.
+			SHOW_ERROR(_T("Error writing to cache file: %s"), _tcserror(errno));
+			return EXIT_FAILURE;
+		}
+	}
+
 	// Write the file to the cache.
 	// TODO: Verify the size.
-	const size_t dataSize = m_downloader->dataSize();
-	size_t size = fwrite(m_downloader->data(), 1, dataSize, f_out);
-	fflush(f_out);
+	const size_t dataSize = downloader->dataSize();
+	fwrite(downloader->data(), 1, dataSize, job.f_out);
+	fflush(job.f_out);
 
 	// Save the file origin information.
 #ifdef _WIN32
 	// TODO: Figure out how to setFileOriginInfo() on Windows using an open file handle.
-	setFileOriginInfo(f_out, cache_filename.c_str(), full_url, m_downloader->mtime());
+	setFileOriginInfo(job.f_out, job.cache_filename.c_str(), job.full_url, downloader->mtime());
 #else /* !_WIN32 */
-	setFileOriginInfo(f_out, full_url, m_downloader->mtime());
+	setFileOriginInfo(job.f_out, job.full_url, downloader->mtime());
 #endif /* _WIN32 */
-	fclose(f_out);
+	fclose(job.f_out);
+	job.f_out = nullptr;
 
 	// Success.
 	SHOW_INFO(_T("Downloaded cache file for '%s': %u byte%s."),
-		cache_key, static_cast<unsigned int>(dataSize),
+		job.cache_key.c_str(), static_cast<unsigned int>(dataSize),
 		unlikely(dataSize == 1) ? "" : "s");
 	return EXIT_SUCCESS;
 }
+
+/**
+ * Download a single cache key.
+ * @param downloader	[in] Downloader
+ * @param cache_key	[in] Cache key, e.g. "ds/cover/US/ADAE.png"
+ * @param force		[in] If true, redownload the file even if it's cached.
+ * @return EXIT_SUCCESS on success; EXIT_FAILURE on error.
+ */
+static int download_cache_key(IDownloader *downloader, const TCHAR *cache_key, bool force)
+{
+	DownloadJob job;
+	switch (prepare_download(cache_key, force, job)) {
+		default:
+		case PREP_FAILED:
+			return EXIT_FAILURE;
+		case PREP_CACHED:
+			return EXIT_SUCCESS;
+		case PREP_DOWNLOAD:
+			break;
+	}
+
+	// Attempt to download the file.
+	// TODO: Configure this somewhere?
+	downloader->setMaxSize(4*1024*1024);
+
+	downloader->setUrl(job.full_url);
+	downloader->setIfModifiedSince(job.if_modified_since);
+	const int ret = downloader->download();
+	return finish_download(downloader, ret, job);
+}
+
+#ifndef _WIN32
+// Batch mode: Exit if no cache keys are received for this long. (ms)
+static const int BATCH_IDLE_TIMEOUT_MS = 60*1000;
+
+// Batch mode: Maximum number of transfers to run at once.
+// Additional cache keys are queued until a transfer finishes.
+// NOTE: Transfers that are waiting for a connection count towards
+// the cURL timeout, so don't add too many at once.
+static const size_t BATCH_MAX_TRANSFERS = 32;
+
+/**
+ * Batch mode: Write a result line.
+ * @param cache_key Cache key
+ * @param ret EXIT_SUCCESS or EXIT_FAILURE
+ * @return True on success; false on error.
+ */
+static bool write_batch_result(const tstring &cache_key, int ret)
+{
+	string line;
+	line.reserve(cache_key.size() + 3);
+	line += (ret == EXIT_SUCCESS ? '0' : '1');
+	line += ' ';
+	line += cache_key;
+	line += '\n';
+
+	const char *p = line.data();
+	size_t remain = line.size();
+	while (remain > 0) {
+		ssize_t sz = write(STDOUT_FILENO, p, remain);
+		if (sz < 0) {
+			if (errno == EINTR)
+				continue;
+			// The other end probably closed the connection.
+			return false;
+		}
+		p += sz;
+		remain -= sz;
+	}
+	return true;
+}
+
+/**
+ * Batch mode: Download multiple cache keys at once.
+ *
+ * Cache keys are read from stdin, one per line. When a cache key
+ * is done, a line containing "0 cache_key" (success) or
+ * "1 cache_key" (failure) is written to stdout. Results are
+ * written in the order the downloads finish, which may differ
+ * from the order the cache keys were received.
+ *
+ * Downloads are run in parallel using a cURL multi handle, so
+ * connections are reused, and HTTP/2 multiplexing is used if the
+ * server supports it.
+ *
+ * This function returns if stdin is closed and all downloads are
+ * finished, or if no cache keys are received within BATCH_IDLE_TIMEOUT_MS.
+ *
+ * @param force			[in] If true, redownload files even if they're cached.
+ * @param maxHostConnections	[in] Maximum number of connections per host.
+ * @return EXIT_SUCCESS on success; EXIT_FAILURE on error.
+ */
+static int run_batch_mode(bool force, long maxHostConnections)
+{
+	CURLM *const multi = curl_multi_init();
+	if (!multi) {
+		SHOW_ERROR(_T("Batch mode: curl_multi_init() failed."));
+		return EXIT_FAILURE;
+	}
+#if LIBCURL_VERSION_NUM >= 0x072B00	/* 7.43.0 */
+	curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif /* LIBCURL_VERSION_NUM >= 0x072B00 */
+	curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, maxHostConnections);
+
+	// Active transfers.
+	struct Transfer {
+		CurlDownloader downloader;
+		DownloadJob job;
+	};
+	unordered_map<CURL*, unique_ptr<Transfer> > transfers;
+
+	// Cache keys that haven't been started yet.
+	deque<tstring> queue;
+
+	// Line buffer.
+	// NOTE: Not using stdio here, since poll() doesn't know
+	// about data that's already buffered in the FILE*.
+	string buf;
+	buf.reserve(1024);
+
+	bool stdin_open = true;
+	int exit_code = EXIT_SUCCESS;
+	time_t last_activity = time(nullptr);
+	for (;;) {
+		// Start queued transfers.
+		while (!queue.empty() && transfers.size() < BATCH_MAX_TRANSFERS) {
+			const tstring cache_key = std::move(queue.front());
+			queue.pop_front();
+
+			unique_ptr<Transfer> xfer(new Transfer);
+			const PrepareResult prep = prepare_download(cache_key.c_str(), force, xfer->job);
+			if (prep != PREP_DOWNLOAD) {
+				// No download is needed.
+				if (!write_batch_result(cache_key, (prep == PREP_CACHED ? EXIT_SUCCESS : EXIT_FAILURE))) {
+					exit_code = EXIT_FAILURE;
+					goto out;
+				}
+				continue;
+			}
+
+			// TODO: Configure this somewhere?
+			xfer->downloader.setMaxSize(4*1024*1024);
+			xfer->downloader.setUrl(xfer->job.full_url);
+			xfer->downloader.setIfModifiedSince(xfer->job.if_modified_since);
+			CURL *const curl = static_cast<CURL*>(xfer->downloader.beginDownload());
+			if (!curl || curl_multi_add_handle(multi, curl) != CURLM_OK) {
+				// Unable to start the transfer.
+				// NOTE: The empty cache file is left as a negative cache entry.
+				if (!write_batch_result(cache_key, EXIT_FAILURE)) {
+					exit_code = EXIT_FAILURE;
+					goto out;
+				}
+				continue;
+			}
+			transfers.emplace(curl, std::move(xfer));
+		}
+
+		// Run the transfers.
+		int running = 0;
+		curl_multi_perform(multi, &running);
+
+		// Check for finished transfers.
+		CURLMsg *msg;
+		int msgs_left = 0;
+		while ((msg = curl_multi_info_read(multi, &msgs_left)) != nullptr) {
+			if (msg->msg != CURLMSG_DONE)
+				continue;
+
+			CURL *const curl = msg->easy_handle;
+			const CURLcode result = msg->data.result;
+			curl_multi_remove_handle(multi, curl);
+
+			auto iter = transfers.find(curl);
+			assert(iter != transfers.end());
+			if (iter == transfers.end())
+				continue;
+
+			Transfer *const xfer = iter->second.get();
+			int ret = xfer->downloader.endDownload(result);
+			ret = finish_download(&xfer->downloader, ret, xfer->job);
+			const bool ok = write_batch_result(xfer->job.cache_key, ret);
+			transfers.erase(iter);
+			if (!ok) {
+				exit_code = EXIT_FAILURE;
+				goto out;
+			}
+			last_activity = time(nullptr);
+		}
+
+		if (transfers.empty() && queue.empty()) {
+			if (!stdin_open) {
+				// All done.
+				break;
+			}
+			if ((time(nullptr) - last_activity) * 1000 >= BATCH_IDLE_TIMEOUT_MS) {
+				// Idle timeout.
+				SHOW_INFO(_T("Batch mode: Idle timeout; exiting."));
+				break;
+			}
+		}
+
+		// Wait for network activity or more cache keys.
+		struct curl_waitfd wfd;
+		wfd.fd = STDIN_FILENO;
+		wfd.events = CURL_WAIT_POLLIN;
+		wfd.revents = 0;
+		int numfds = 0;
+		if (curl_multi_wait(multi, &wfd, (stdin_open ? 1 : 0), 1000, &numfds) != CURLM_OK) {
+			SHOW_ERROR(_T("Batch mode: curl_multi_wait() failed."));
+			exit_code = EXIT_FAILURE;
+			break;
+		}
+		if (!stdin_open || !(wfd.revents & CURL_WAIT_POLLIN))
+			continue;
+
+		// Read more cache keys.
+		char rdbuf[512];
+		ssize_t sz = read(STDIN_FILENO, rdbuf, sizeof(rdbuf));
+		if (sz == 0) {
+			// stdin was closed.
+			// Finish the remaining transfers, then exit.
+			stdin_open = false;
+			continue;
+		} else if (sz < 0) {
+			if (errno == EINTR)
+				continue;
+			SHOW_ERROR(_T("Batch mode: read() failed: %s"), _tcserror(errno));
+			exit_code = EXIT_FAILURE;
+			break;
+		}
+		buf.append(rdbuf, sz);
+		last_activity = time(nullptr);
+
+		size_t nl_pos;
+		while ((nl_pos = buf.find('\n')) != string::npos) {
+			if (nl_pos > 0) {
+				queue.emplace_back(buf, 0, nl_pos);
+			} else {
+				// Empty cache key.
+				if (!write_batch_result(tstring(), EXIT_FAILURE)) {
+					exit_code = EXIT_FAILURE;
+					goto out;
+				}
+			}
+			buf.erase(0, nl_pos + 1);
+		}
+		if (buf.size() >= 4096) {
+			// Line is too long. Something's wrong.
+			SHOW_ERROR(_T("Batch mode: Cache key is too long."));
+			exit_code = EXIT_FAILURE;
+			break;
+		}
+	}
+
+out:
+	// Abort any remaining transfers.
+	for (auto &p : transfers) {
+		curl_multi_remove_handle(multi, p.first);
+	}
+	transfers.clear();
+	curl_multi_cleanup(multi);
+	return exit_code;
+}
+#endif /* !_WIN32 */
+
+/**
+ * rp-download: Download an image from a supported online database.
+ * @param cache_key Cache key, e.g. "ds/cover/US/ADAE.png"
+ * @return 0 on success; non-zero on error.
+ *
+ * If -b is specified, cache keys are read from stdin instead.
+ * See run_batch_mode() for details.
+ *
+ * TODO:
+ * - More error codes based on the error.
+ */
+int RP_C_API _tmain(int argc, TCHAR *argv[])
+{
+	// Create a downloader based on OS:
+	// - Linux: CurlDownloader
+	// - Windows: WinInetDownloader
+
+	// Syntax: rp-download cache_key
+	// Example: rp-download ds/coverM/US/ADAE.png
+	// Batch mode: rp-download -b < cache_keys.txt
+
+	// If http_proxy or https_proxy are set, they will be used
+	// by the downloader code if supported.
+
+	// Reduce process integrity, if available.
+	rp_secure_reduce_integrity();
+
+	// Set OS-specific security options.
+	rp_secure_param_t param;
+#if defined(_WIN32)
+	param.bHighSec = FALSE;
+#elif defined(HAVE_SECCOMP)
+	static const int syscall_wl[] = {
+		// Syscalls used by rp-download.
+		// TODO: Add more syscalls.
+		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
+		// defined in earlier versions, including Ubuntu 14.04.
+		// NOTE: Multi-threading syscalls (clone() for cURL's threaded
+		// resolver) are added by RP_SECURE_PROFILE_PARALLEL.
+
+		SCMP_SYS(access), SCMP_SYS(clock_gettime),
+#if defined(__SNR_clock_gettime64) || defined(__NR_clock_gettime64)
+		SCMP_SYS(clock_gettime64),
+#endif /* __SNR_clock_gettime64 || __NR_clock_gettime64 */
+		SCMP_SYS(close),
+		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
+		SCMP_SYS(fsetxattr),
+		SCMP_SYS(fstat),     SCMP_SYS(fstat64),		// __GI___fxstat() [printf()]
+		SCMP_SYS(fstatat64), SCMP_SYS(newfstatat),	// Ubuntu 19.10 (32-bit)
+		SCMP_SYS(futex),
+		SCMP_SYS(getdents), SCMP_SYS(getdents64),
+		SCMP_SYS(getppid),	// for bubblewrap verification
+		SCMP_SYS(getrusage),
+		SCMP_SYS(gettimeofday),	// 32-bit only?
+		SCMP_SYS(getuid),	// TODO: Only use geteuid()?
+		SCMP_SYS(lseek), SCMP_SYS(_llseek),
+		//SCMP_SYS(lstat), SCMP_SYS(lstat64),	// Not sure if used?
+		SCMP_SYS(mkdir), SCMP_SYS(mmap), SCMP_SYS(mmap2),
+		SCMP_SYS(munmap),
+		SCMP_SYS(open),		// Ubuntu 16.04
+		SCMP_SYS(openat),	// glibc-2.31
+#if defined(__SNR_openat2)
+		SCMP_SYS(openat2),	// Linux 5.6
+#elif defined(__NR_openat2)
+		__NR_openat2,		// Linux 5.6
+#endif /* __SNR_openat2 || __NR_openat2 */
+		SCMP_SYS(poll), SCMP_SYS(select),
+		SCMP_SYS(stat), SCMP_SYS(stat64),
+		SCMP_SYS(unlink),	// to delete expired cache files
+		SCMP_SYS(utimensat),
+
+#if defined(__SNR_statx) || defined(__NR_statx)
+		SCMP_SYS(getcwd),	// called by glibc's statx()
+		SCMP_SYS(statx),
+#endif /* __SNR_statx || __NR_statx */
+
+#ifndef NDEBUG
+		// Needed for assert() on some systems.
+		SCMP_SYS(uname),
+#endif /* NDEBUG */
+
+		// glibc ncsd
+		// TODO: Restrict connect() to AF_UNIX.
+		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
+		SCMP_SYS(sendmmsg),	// getaddrinfo() (32-bit only?)
+		SCMP_SYS(ioctl),	// getaddrinfo() (32-bit only?) [FIXME: Filter for FIONREAD]
+		SCMP_SYS(recvfrom),	// getaddrinfo() (32-bit only?)
+
+		// Needed for network access on Kubuntu 20.04 for some reason.
+		SCMP_SYS(getpid), SCMP_SYS(uname),
+
+		// cURL and OpenSSL
+		SCMP_SYS(bind),		// getaddrinfo() [curl_thread_create_thunk(), curl-7.68.0]
+#ifdef __SNR_getrandom
+		SCMP_SYS(getrandom),
+#endif /* __SNR_getrandom */
+		SCMP_SYS(getpeername), SCMP_SYS(getsockname),
+		SCMP_SYS(getsockopt), SCMP_SYS(madvise), SCMP_SYS(mprotect),
+		SCMP_SYS(setsockopt), SCMP_SYS(socket),
+		SCMP_SYS(socketcall),	// FIXME: Enhanced filtering? [cURL+GnuTLS only?]
+		SCMP_SYS(socketpair), SCMP_SYS(sysinfo),
+		SCMP_SYS(rt_sigprocmask),	// Ubuntu 20.04: __GI_getaddrinfo() ->
+						// gaih_inet() ->
+						// _nss_myhostname_gethostbyname4_r()
+
+		// libnss_resolve.so (systemd-resolved)
+		SCMP_SYS(geteuid),
+		SCMP_SYS(sendmsg),	// libpthread.so [_nss_resolve_gethostbyname4_r() from libnss_resolve.so]
+
+		// FIXME: Manjaro is using these syscalls for some reason...
+		SCMP_SYS(prctl), SCMP_SYS(mremap), SCMP_SYS(ppoll),
+
+		-1	// End of whitelist
+	};
+	param.syscall_wl = syscall_wl;
+#elif defined(HAVE_PLEDGE)
+	// Promises:
+	// - stdio: General stdio functionality.
+	// - rpath: Read from ~/.config/rom-properties/ and ~/.cache/rom-properties/
+	// - wpath: Write to ~/.cache/rom-properties/
+	// - cpath: Create ~/.cache/rom-properties/ if it doesn't exist.
+	// - inet: Internet access.
+	// - fattr: Modify file attributes, e.g. mtime.
+	// - dns: Resolve hostnames.
+	// - getpw: Get user's home directory if HOME is empty.
+	param.promises = "stdio rpath wpath cpath inet fattr dns getpw";
+#elif defined(HAVE_TAME)
+	// NOTE: stdio includes fattr, e.g. utimes().
+	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH |
+	                   TAME_INET | TAME_DNS | TAME_GETPW;
+#else
+	param.dummy = 0;
+#endif
+	rp_secure_enable_ex(param, RP_SECURE_PROFILE_PARALLEL);
+
+	// Store argv[0] globally.
+	argv0 = argv[0];
+
+	if (argc < 2) {
+		show_usage();
+		return EXIT_FAILURE;
+	}
+
+	// Check for arguments. (simple non-getopt version)
+	bool force = false;
+#ifndef _WIN32
+	bool batch = false;
+	long maxHostConnections = 4;
+#endif /* !_WIN32 */
+	int optind = 1;
+	for (; optind < argc; optind++) {
+		if (!argv[optind] || argv[optind][0] != '-') {
+			// End of options.
+			break;
+		}
+
+#ifndef _WIN32
+		if (!_tcscmp(argv[optind], _T("-c"))) {
+			// Maximum number of connections per host. (batch mode)
+			if (optind+1 >= argc) {
+				show_error(_T("Option -c requires a value."));
+				show_usage();
+				return EXIT_FAILURE;
+			}
+			optind++;
+			TCHAR *endptr = nullptr;
+			const unsigned long val = _tcstoul(argv[optind], &endptr, 10);
+			if (*endptr != _T('\0') || val < 1 || val > 64) {
+				show_error(_T("Invalid connection count: %s"), argv[optind]);
+				return EXIT_FAILURE;
+			}
+			maxHostConnections = static_cast<long>(val);
+			continue;
+		}
+#endif /* !_WIN32 */
+
+		// Allow multiple options in one argument, e.g. '-vf'.
+		for (int i = 1; argv[optind][i] != '\0'; i++) {
+			switch (argv[optind][i]) {
+				case 'v':
+					// Verbose mode is enabled.
+					verbose = true;
+					break;
+				case 'f':
+					// Force download is enabled.
+					force = true;
+					break;
+#ifndef _WIN32
+				case 'b':
+					// Batch mode is enabled.
+					batch = true;
+					break;
+#endif /* !_WIN32 */
+				default:
+					// Invalid parameter.
+					show_error(_T("Unrecognized option: %c"), argv[optind][i]);
+					show_usage();
+					return EXIT_FAILURE;
+			}
+		}
+	}
+
+#ifndef _WIN32
+	if (batch) {
+		// Batch mode: Read cache keys from stdin.
+		return run_batch_mode(force, maxHostConnections);
+	}
+#endif /* !_WIN32 */
+
+	if (optind >= argc) {
+		show_error(_T("No cache key specified."));
+		show_usage();
+		return EXIT_FAILURE;
+	}
+
+	// Create a downloader.
+	// TODO: IDownloaderFactory?
+#ifdef _WIN32
+	unique_ptr<IDownloader> downloader(new WinInetDownloader());
+#else /* !_WIN32 */
+	unique_ptr<IDownloader> downloader(new CurlDownloader());
+#endif /* _WIN32 */
+	return download_cache_key(downloader.get(), argv[optind], force);
+}
+
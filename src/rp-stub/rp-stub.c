@@ -56,6 +56,9 @@ static bool is_rp_config = false;
 // Is debug logging enabled?
 static bool is_debug = false;
 
+// Maximum length of a line in batch mode.
+#define BATCH_LINE_MAX 8192
+
 static void show_version(void)
 {
 	puts(RP_DESCRIPTION);
@@ -84,13 +87,22 @@ static void show_help(const char *argv0)
 	if (!is_rp_config) {
 		printf(C_("rp-stub", "Usage: %s [-s size] source_file output_file"), argv0);
 		putchar('\n');
+		printf(C_("rp-stub", "       %s [-s size] --batch[=list_file]"), argv0);
+		putchar('\n');
 		putchar('\n');
 		puts(C_("rp-stub",
 			"If source_file is a supported ROM image, a thumbnail is\n"
 			"extracted and saved as output_file.\n"
 			"\n"
+			"In batch mode, thumbnail requests are read from list_file,\n"
+			"or from stdin if list_file isn't specified. Each line has\n"
+			"a source file, an output file, and an optional size,\n"
+			"separated by tabs. For each request, the return value and\n"
+			"the output file are written to stdout, separated by a tab.\n"
+			"\n"
 			"Options:\n"
 			"  -s, --size\t\tMaximum thumbnail size. (default is 256px)\n"
+			"  -b, --batch\t\tRead thumbnail requests from a file or stdin.\n"
 			"  -c, --config\t\tShow the configuration dialog instead of thumbnailing.\n"
 			"  -d, --debug\t\tShow debug output when searching for rom-properties.\n"
 			"  -h, --help\t\tDisplay this help and exit.\n"
@@ -127,11 +139,117 @@ static int ATTR_PRINTF(2, 3) fnDebug(int level, const char *format, ...)
 	return ret;
 }
 
+/**
+ * Parse a thumbnail size.
+ * @param str		[in] Size string.
+ * @param pSize		[out] Size.
+ * @return 0 on success; -EINVAL if invalid; -ERANGE if out of range.
+ */
+static int parse_size(const char *str, int *pSize)
+{
+	char *endptr = NULL;
+	errno = 0;
+	const long lTmp = strtol(str, &endptr, 10);
+	if (errno == ERANGE || endptr == str || *endptr != 0) {
+		return -EINVAL;
+	} else if (lTmp <= 0 || lTmp > 32768) {
+		return -ERANGE;
+	}
+	*pSize = (int)lTmp;
+	return 0;
+}
+
+/**
+ * Create thumbnails in batch mode.
+ *
+ * Each line has a source file, an output file, and an optional
+ * size, separated by tabs. Empty lines and lines starting with
+ * '#' are ignored. For each request, the return value and the
+ * output file are written to stdout, separated by a tab.
+ *
+ * The rom-properties library is only loaded once, so this is
+ * much faster than running rp-stub once per file.
+ *
+ * @param pfn		[in] rp_create_thumbnail()
+ * @param f_list	[in] List file.
+ * @param default_size	[in] Size to use if a line doesn't specify one.
+ * @return 0 if all thumbnails were created; non-zero if any failed.
+ */
+static int do_batch(PFN_RP_CREATE_THUMBNAIL pfn, FILE *f_list, int default_size)
+{
+	char *line = malloc(BATCH_LINE_MAX);
+	if (!line) {
+		return -ENOMEM;
+	}
+
+	unsigned int line_num = 0;
+	int ret_all = 0;
+	while (fgets(line, BATCH_LINE_MAX, f_list)) {
+		line_num++;
+
+		// Remove the trailing newline.
+		size_t len = strlen(line);
+		while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r')) {
+			line[--len] = '\0';
+		}
+		if (len == 0 || line[0] == '#') {
+			// Empty line or comment.
+			continue;
+		}
+
+		// Split the line into fields.
+		const char *const source_file = line;
+		char *const output_file = strchr(line, '\t');
+		int maximum_size = default_size;
+		int ret;
+		if (!output_file || output_file[1] == '\0') {
+			// No output file.
+			ret = -EINVAL;
+		} else {
+			*output_file = '\0';
+			char *const size_str = strchr(output_file + 1, '\t');
+			if (size_str) {
+				*size_str = '\0';
+				ret = parse_size(size_str + 1, &maximum_size);
+			} else {
+				ret = 0;
+			}
+		}
+
+		if (ret != 0) {
+			// tr: %1$u == line number
+			fprintf_p(stderr, C_("rp-stub", "*** ERROR: invalid request on line %1$u"), line_num);
+			putc('\n', stderr);
+			printf("%d\t\n", ret);
+		} else {
+			if (is_debug) {
+				// tr: NOTE: Not positional. Don't change argument positions!
+				// tr: Only localize "Calling function:".
+				fprintf(stderr, C_("rp-stub", "Calling function: %s(\"%s\", \"%s\", %d);"),
+					"rp_create_thumbnail", source_file, output_file + 1, maximum_size);
+				putc('\n', stderr);
+			}
+			ret = pfn(source_file, output_file + 1, maximum_size);
+			printf("%d\t%s\n", ret, output_file + 1);
+		}
+
+		// Flush stdout so the caller can read the results as they're available.
+		fflush(stdout);
+		if (ret != 0) {
+			ret_all = EXIT_FAILURE;
+		}
+	}
+
+	free(line);
+	return ret_all;
+}
+
 int main(int argc, char *argv[])
 {
 	/**
 	 * Command line syntax:
 	 * - Thumbnail: rp-stub [-s size] path output
+	 * - Batch:     rp-stub [-s size] --batch[=list_file]
 	 * - Config:    rp-stub -c
 	 *
 	 * If invoked as 'rp-config', the configuration dialog
@@ -166,6 +284,7 @@ int main(int argc, char *argv[])
 
 	static const struct option long_options[] = {
 		{"size",	required_argument,	NULL, 's'},
+		{"batch",	optional_argument,	NULL, 'b'},
 		{"config",	no_argument,		NULL, 'c'},
 		{"debug",	no_argument,		NULL, 'd'},
 		{"help",	no_argument,		NULL, 'h'},
@@ -180,15 +299,15 @@ int main(int argc, char *argv[])
 
 	// Default to 256x256.
 	uint8_t config = is_rp_config;
+	bool batch = false;
+	const char *batch_file = NULL;	// NULL for stdin
 	int maximum_size = 256;
 	int c, option_index;
-	while ((c = getopt_long(argc, argv, "s:cdhV", long_options, &option_index)) != -1) {
+	while ((c = getopt_long(argc, argv, "s:b::cdhV", long_options, &option_index)) != -1) {
 		switch (c) {
 			case 's': {
-				char *endptr = NULL;
-				errno = 0;
-				long lTmp = (int)strtol(optarg, &endptr, 10);
-				if (errno == ERANGE || *endptr != 0) {
+				const int ret = parse_size(optarg, &maximum_size);
+				if (ret == -EINVAL) {
 					// tr: %1$s == program name, %2%s == invalid size
 					fprintf_p(stderr, C_("rp-stub", "%1$s: invalid size '%2$s'"), argv[0], optarg);
 					putc('\n', stderr);
@@ -196,7 +315,7 @@ int main(int argc, char *argv[])
 					fprintf(stderr, str_help_more_info, argv[0]);
 					putc('\n', stderr);
 					return EXIT_FAILURE;
-				} else if (lTmp <= 0 || lTmp > 32768) {
+				} else if (ret != 0) {
 					// tr: %1$s == program name, %2%s == invalid size
 					fprintf_p(stderr, C_("rp-stub", "%1$s: size '%2$s' is out of range"), argv[0], optarg);
 					putc('\n', stderr);
@@ -205,10 +324,15 @@ int main(int argc, char *argv[])
 					putc('\n', stderr);
 					return EXIT_FAILURE;
 				}
-				maximum_size = (int)lTmp;
 				break;
 			}
 
+			case 'b':
+				// Batch mode.
+				batch = true;
+				batch_file = optarg;
+				break;
+
 			case 'c':
 				// Show the configuration dialog.
 				config = true;
@@ -241,7 +365,19 @@ int main(int argc, char *argv[])
 	// and reparse?
 	rp_stub_do_security_options(config);
 
-	if (!config) {
+	if (!config && batch) {
+		// Batch mode.
+		// Filenames are read from the list file.
+		if (optind < argc) {
+			// tr: %s == program name
+			fprintf(stderr, C_("rp-stub", "%s: too many parameters specified"), argv[0]);
+			putc('\n', stderr);
+			// tr: %s == program name
+			fprintf(stderr, str_help_more_info, argv[0]);
+			putc('\n', stderr);
+			return EXIT_FAILURE;
+		}
+	} else if (!config) {
 		// Thumbnailing mode.
 		// We must have 2 filenames specified.
 		if (optind == argc) {
@@ -280,7 +416,22 @@ int main(int argc, char *argv[])
 		return ret;
 	}
 
-	if (!config) {
+	if (!config && batch) {
+		// Create thumbnails in batch mode.
+		FILE *const f_list = (batch_file ? fopen(batch_file, "r") : stdin);
+		if (f_list) {
+			ret = do_batch((PFN_RP_CREATE_THUMBNAIL)pfn, f_list, maximum_size);
+			if (f_list != stdin) {
+				fclose(f_list);
+			}
+		} else {
+			// tr: %1$s == program name, %2$s == list file, %3$s == error message
+			fprintf_p(stderr, C_("rp-stub", "%1$s: cannot open '%2$s': %3$s"),
+				argv[0], batch_file, strerror(errno));
+			putc('\n', stderr);
+			ret = EXIT_FAILURE;
+		}
+	} else if (!config) {
 		// Create the thumbnail.
 		const char *const source_file = argv[optind];
 		const char *const output_file = argv[optind+1];
@@ -303,6 +454,10 @@ int main(int argc, char *argv[])
 	}
 
 	dlclose(pDll);
+	if (batch && !config) {
+		// Results were already written to stdout.
+		return ret;
+	}
 	if (ret == 0) {
 		if (is_debug) {
 			// tr: %1$s == function name, %2$d == return value
@@ -79,6 +79,9 @@ int rp_stub_do_security_options(bool config)
 
 		SCMP_SYS(getppid),	// dll-search.c: walk_proc_tree()
 
+#if defined(__SNR_io_uring_setup) || defined(__NR_io_uring_setup)
+		SCMP_SYS(io_uring_setup), SCMP_SYS(io_uring_enter),	// LibRpFile::IoUring
+#endif /* __SNR_io_uring_setup || __NR_io_uring_setup */
 #if defined(__SNR_statx) || defined(__NR_statx)
 		SCMP_SYS(getcwd),	// called by glibc's statx()
 		SCMP_SYS(statx),
@@ -100,6 +103,16 @@ int rp_stub_do_security_options(bool config)
 		SCMP_SYS(lseek), SCMP_SYS(_llseek),
 		SCMP_SYS(lstat), SCMP_SYS(lstat64),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
 		SCMP_SYS(readlink),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
+		SCMP_SYS(madvise),	// LibRpFile::RpFile::adviseAccess() [FM_MMAP]
+		SCMP_SYS(fadvise64), SCMP_SYS(fadvise64_64),	// LibRpFile::RpFile::adviseAccess()
+		SCMP_SYS(preadv),	// LibRpFile::RpFile::readBatch() [pread64() is listed below]
+		SCMP_SYS(rename), SCMP_SYS(renameat),	// NegativeDetectCache: rewriteCache()
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),	// glibc-2.28+ on architectures without renameat()
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(unlink),	// NegativeDetectCache: rewriteCache() [on error]
+		SCMP_SYS(flock),	// CachePack::append(), compact()
+		SCMP_SYS(pwrite64),	// CachePack::append()
 
 		// ExecRpDownload_posix.cpp
 		// FIXME: Need to fix the clone() check in librpsecure/os-secure_linux.c.
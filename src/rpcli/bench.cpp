@@ -0,0 +1,613 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-bench)                         *
+ * bench.cpp: Per-RomData benchmark over a corpus directory.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+/**
+ * Usage: rp-bench [-n iterations] [-o output.json] corpus_dir
+ *
+ * Every regular file in corpus_dir (recursive) is run through each
+ * stage the given number of times. Results are aggregated by RomData
+ * class and written as JSON, so runs can be compared across commits.
+ *
+ * Stages:
+ * - detect:    RomDataFactory::identify()
+ * - ctor:      RomDataFactory::create()
+ * - fields:    RomData::fields()
+ * - metadata:  RomData::metaData()
+ * - image:     RomData::image() for all supported internal image types
+ * - thumbnail: First internal image, squared and downscaled to 256px
+ *
+ * Files that aren't recognized are counted in the "detect" stage
+ * of the "(unsupported)" class.
+ *
+ * NOTE: The thumbnail stage only uses internal images, unlike
+ * TCreateThumbnail, which may download external images.
+ *
+ * Startup mode: rp-bench -S rpcli [-n iterations] [-L max_ms] [-o output.json] file
+ *
+ * Runs "rpcli file" the given number of times and reports the
+ * wall-clock time of each process, from fork() to exit. This
+ * measures startup and teardown, so file should be trivially small.
+ * If -L is specified, rp-bench fails if the median exceeds max_ms.
+ */
+
+#include "stdafx.h"
+#include "timing.hpp"
+
+// librpbase, librpfile, librptexture
+#include "librpbase/RomData.hpp"
+#include "librpbase/monotonic_time.h"
+#include "librpfile/RpFile.hpp"
+#include "librptexture/img/rp_image.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+using LibRpTexture::rp_image;
+
+// libromdata
+#include "libromdata/RomDataFactory.hpp"
+using LibRomData::RomDataFactory;
+
+// C includes.
+#include <dirent.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdlib>
+
+// C++ includes.
+#include <map>
+#include <string>
+#include <vector>
+using std::map;
+using std::string;
+using std::vector;
+
+// Maximum thumbnail size for the thumbnail stage.
+static const int BENCH_THUMBNAIL_SIZE = 256;
+
+// Stages. (Must match StageId.)
+static const char *const stage_names[] = {
+	"detect", "ctor", "fields", "metadata", "image", "thumbnail",
+};
+
+enum StageId {
+	STAGE_DETECT = 0,
+	STAGE_CTOR,
+	STAGE_FIELDS,
+	STAGE_METADATA,
+	STAGE_IMAGE,
+	STAGE_THUMBNAIL,
+
+	STAGE_MAX
+};
+
+/**
+ * Samples for a single stage.
+ */
+struct StageStats {
+	vector<uint64_t> ns;	// Latency of each operation, in nanoseconds
+	uint64_t bytesRead;	// Total bytes read
+
+	StageStats()
+		: bytesRead(0)
+	{ }
+};
+
+/**
+ * Statistics for a single RomData class.
+ */
+struct ClassStats {
+	unsigned int files;
+	StageStats stages[STAGE_MAX];
+
+	ClassStats()
+		: files(0)
+	{ }
+};
+
+/**
+ * Recursively scan a directory for regular files.
+ * @param path	[in] Directory path.
+ * @param files	[out] Vector to append filenames to.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int recursiveScan(const string &path, vector<string> &files)
+{
+	DIR *const pdir = opendir(path.c_str());
+	if (!pdir) {
+		// Error opening the directory.
+		return -errno;
+	}
+
+	struct dirent *dirent;
+	while ((dirent = readdir(pdir)) != nullptr) {
+		// Skip "." and "..".
+		if (dirent->d_name[0] == '.' &&
+		    (dirent->d_name[1] == '\0' ||
+		     (dirent->d_name[1] == '.' && dirent->d_name[2] == '\0')))
+		{
+			continue;
+		}
+
+		string fullpath(path);
+		if (fullpath.empty() || fullpath[fullpath.size()-1] != '/') {
+			fullpath += '/';
+		}
+		fullpath += dirent->d_name;
+
+		uint8_t d_type = dirent->d_type;
+		if (d_type == DT_UNKNOWN) {
+			// Unknown. Use lstat().
+			struct stat sb;
+			if (lstat(fullpath.c_str(), &sb) != 0)
+				continue;
+			if (S_ISREG(sb.st_mode)) {
+				d_type = DT_REG;
+			} else if (S_ISDIR(sb.st_mode)) {
+				d_type = DT_DIR;
+			}
+		}
+
+		switch (d_type) {
+			case DT_REG:
+				files.emplace_back(std::move(fullpath));
+				break;
+			case DT_DIR:
+				// Errors in subdirectories are ignored.
+				recursiveScan(fullpath, files);
+				break;
+			default:
+				// Not a regular file or directory.
+				break;
+		}
+	}
+
+	closedir(pdir);
+	return 0;
+}
+
+/**
+ * Record a single operation.
+ * @param stats		[in/out] StageStats.
+ * @param start_ns	[in] Start time.
+ * @param statsFile	[in] StatsFile.
+ * @param start_bytes	[in] StatsFile::bytesRead() at the start time.
+ */
+static inline void record(StageStats &stats, uint64_t start_ns,
+	const StatsFile *statsFile, uint64_t start_bytes)
+{
+	stats.ns.push_back(rp_monotonic_ns() - start_ns);
+	stats.bytesRead += statsFile->bytesRead() - start_bytes;
+}
+
+/**
+ * Create a thumbnail from the first internal image.
+ * @param romData RomData
+ * @return True if a thumbnail was created; false if not.
+ */
+static bool createThumbnail(const RomData *romData)
+{
+	const uint32_t imgbf = romData->supportedImageTypes();
+	const rp_image *img = nullptr;
+	for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
+		if (imgbf & (1U << i)) {
+			img = romData->image(static_cast<RomData::ImageType>(i));
+			if (img)
+				break;
+		}
+	}
+	if (!img) {
+		return false;
+	}
+
+	rp_image *const sq = img->squared();
+	if (!sq) {
+		return false;
+	}
+	if (sq->width() > BENCH_THUMBNAIL_SIZE) {
+		// Images are square here, so the aspect ratio doesn't change.
+		rp_image *const sc = sq->scaled(BENCH_THUMBNAIL_SIZE, BENCH_THUMBNAIL_SIZE);
+		if (sc) {
+			sc->unref();
+		}
+	}
+	sq->unref();
+	return true;
+}
+
+/**
+ * Benchmark a single file.
+ * @param filename	[in] Filename.
+ * @param iterations	[in] Number of iterations.
+ * @param classes	[in/out] Per-class statistics.
+ */
+static void benchFile(const char *filename, unsigned int iterations,
+	map<string, ClassStats> &classes)
+{
+	RpFile *const baseFile = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	if (!baseFile->isOpen()) {
+		baseFile->unref();
+		return;
+	}
+	StatsFile *const file = new StatsFile(baseFile);
+	baseFile->unref();
+
+	ClassStats *cs = nullptr;
+	for (unsigned int i = 0; i < iterations; i++) {
+		uint64_t start_bytes = file->bytesRead();
+		uint64_t start_ns = rp_monotonic_ns();
+		RomDataFactory::IdentifyInfo info;
+		RomDataFactory::identify(file, &info);
+		if (!info.className) {
+			// Not supported. Only detection is measured.
+			ClassStats &ucs = classes["(unsupported)"];
+			record(ucs.stages[STAGE_DETECT], start_ns, file, start_bytes);
+			if (i == 0) {
+				ucs.files++;
+			}
+			continue;
+		}
+		cs = &classes[info.className];
+		record(cs->stages[STAGE_DETECT], start_ns, file, start_bytes);
+		if (i == 0) {
+			cs->files++;
+		}
+
+		start_bytes = file->bytesRead();
+		start_ns = rp_monotonic_ns();
+		RomData *romData = RomDataFactory::create(file);
+		if (!romData) {
+			// Detection succeeded, but the RomData isn't valid.
+			continue;
+		}
+		record(cs->stages[STAGE_CTOR], start_ns, file, start_bytes);
+
+		start_bytes = file->bytesRead();
+		start_ns = rp_monotonic_ns();
+		romData->fields();
+		record(cs->stages[STAGE_FIELDS], start_ns, file, start_bytes);
+
+		start_bytes = file->bytesRead();
+		start_ns = rp_monotonic_ns();
+		romData->metaData();
+		record(cs->stages[STAGE_METADATA], start_ns, file, start_bytes);
+
+		const uint32_t imgbf = romData->supportedImageTypes() &
+			((1U << (RomData::IMG_INT_MAX + 1)) - 1);
+		if (imgbf != 0) {
+			start_bytes = file->bytesRead();
+			start_ns = rp_monotonic_ns();
+			for (int j = RomData::IMG_INT_MIN; j <= RomData::IMG_INT_MAX; j++) {
+				if (imgbf & (1U << j)) {
+					romData->image(static_cast<RomData::ImageType>(j));
+				}
+			}
+			record(cs->stages[STAGE_IMAGE], start_ns, file, start_bytes);
+		}
+		romData->unref();
+
+		if (imgbf != 0) {
+			// Images are cached by RomData, so the
+			// thumbnail stage needs a new object.
+			romData = RomDataFactory::create(file);
+			if (romData) {
+				start_bytes = file->bytesRead();
+				start_ns = rp_monotonic_ns();
+				if (createThumbnail(romData)) {
+					record(cs->stages[STAGE_THUMBNAIL], start_ns, file, start_bytes);
+				}
+				romData->unref();
+			}
+		}
+	}
+
+	file->unref();
+}
+
+/**
+ * Append a JSON string, with quotes.
+ * @param out	[in/out] Output string.
+ * @param str	[in] String.
+ */
+static void appendJSONString(string &out, const char *str)
+{
+	out += '"';
+	for (; *str != '\0'; str++) {
+		const uint8_t c = static_cast<uint8_t>(*str);
+		switch (c) {
+			case '"':	out += "\\\""; break;
+			case '\\':	out += "\\\\"; break;
+			case '\n':	out += "\\n"; break;
+			case '\r':	out += "\\r"; break;
+			case '\t':	out += "\\t"; break;
+			default:
+				if (c < 0x20) {
+					char buf[8];
+					snprintf(buf, sizeof(buf), "\\u%04X", c);
+					out += buf;
+				} else {
+					out += static_cast<char>(c);
+				}
+				break;
+		}
+	}
+	out += '"';
+}
+
+/**
+ * Get a percentile from sorted samples. (nearest-rank)
+ * @param sorted	[in] Sorted samples.
+ * @param pct		[in] Percentile. (1-100)
+ * @return Sample value.
+ */
+static uint64_t percentile(const vector<uint64_t> &sorted, unsigned int pct)
+{
+	assert(!sorted.empty());
+	size_t rank = (sorted.size() * pct + 99) / 100;
+	if (rank == 0) {
+		rank = 1;
+	}
+	return sorted[rank - 1];
+}
+
+/**
+ * Write the results as JSON.
+ * @param out		[out] Output string.
+ * @param corpus	[in] Corpus directory.
+ * @param iterations	[in] Number of iterations.
+ * @param fileCount	[in] Number of files scanned.
+ * @param classes	[in] Per-class statistics.
+ */
+static void writeJSON(string &out, const char *corpus, unsigned int iterations,
+	size_t fileCount, map<string, ClassStats> &classes)
+{
+	char buf[256];
+
+	out += "{\n\t\"corpus\": ";
+	appendJSONString(out, corpus);
+	snprintf(buf, sizeof(buf), ",\n\t\"iterations\": %u,\n\t\"files\": %u,\n\t\"classes\": {",
+		iterations, static_cast<unsigned int>(fileCount));
+	out += buf;
+
+	bool firstClass = true;
+	for (auto &p : classes) {
+		out += (firstClass ? "\n\t\t" : ",\n\t\t");
+		firstClass = false;
+		appendJSONString(out, p.first.c_str());
+		snprintf(buf, sizeof(buf), ": {\n\t\t\t\"files\": %u,\n\t\t\t\"stages\": {", p.second.files);
+		out += buf;
+
+		bool firstStage = true;
+		for (int i = 0; i < STAGE_MAX; i++) {
+			StageStats &ss = p.second.stages[i];
+			if (ss.ns.empty())
+				continue;
+
+			uint64_t total_ns = 0;
+			for (uint64_t ns : ss.ns) {
+				total_ns += ns;
+			}
+			std::sort(ss.ns.begin(), ss.ns.end());
+			const double ops_per_sec = (total_ns > 0)
+				? (static_cast<double>(ss.ns.size()) * 1e9 / static_cast<double>(total_ns))
+				: 0.0;
+
+			out += (firstStage ? "\n\t\t\t\t\"" : ",\n\t\t\t\t\"");
+			firstStage = false;
+			out += stage_names[i];
+			snprintf(buf, sizeof(buf), "\": {\"ops\": %u, \"ops_per_sec\": %.1f, "
+				"\"p50_ns\": %" PRIu64 ", \"p99_ns\": %" PRIu64 ", \"bytes_read\": %" PRIu64 "}",
+				static_cast<unsigned int>(ss.ns.size()), ops_per_sec,
+				percentile(ss.ns, 50), percentile(ss.ns, 99), ss.bytesRead);
+			out += buf;
+		}
+		out += "\n\t\t\t}\n\t\t}";
+	}
+	out += "\n\t}\n}\n";
+}
+
+/**
+ * Run "exe filename" once and wait for it to exit.
+ * stdout and stderr are redirected to /dev/null.
+ * @param exe		[in] Executable. (usually rpcli)
+ * @param filename	[in] Filename argument.
+ * @param pNs		[out] Wall-clock time, in nanoseconds.
+ * @return 0 on success; negative POSIX error code on error; positive exit status on failure.
+ */
+static int runProcess(const char *exe, const char *filename, uint64_t *pNs)
+{
+	const uint64_t start_ns = rp_monotonic_ns();
+	const pid_t pid = fork();
+	if (pid < 0) {
+		return -errno;
+	} else if (pid == 0) {
+		// Child process.
+		const int fd = open("/dev/null", O_WRONLY);
+		if (fd >= 0) {
+			dup2(fd, STDOUT_FILENO);
+			dup2(fd, STDERR_FILENO);
+			close(fd);
+		}
+		execl(exe, exe, filename, static_cast<char*>(nullptr));
+		_exit(127);
+	}
+
+	int status = 0;
+	while (waitpid(pid, &status, 0) < 0) {
+		if (errno != EINTR)
+			return -errno;
+	}
+	*pNs = rp_monotonic_ns() - start_ns;
+
+	if (!WIFEXITED(status)) {
+		return -EINTR;
+	}
+	return WEXITSTATUS(status);
+}
+
+/**
+ * Startup mode: Time complete rpcli runs on a single file.
+ * @param argv0		[in] argv[0]
+ * @param exe		[in] rpcli executable.
+ * @param filename	[in] File to pass to rpcli.
+ * @param iterations	[in] Number of runs.
+ * @param max_ms	[in] Maximum allowed median, in milliseconds. (0 for no limit)
+ * @param out		[out] JSON output.
+ * @return EXIT_SUCCESS or EXIT_FAILURE.
+ */
+static int benchStartup(const char *argv0, const char *exe, const char *filename,
+	unsigned int iterations, unsigned int max_ms, string &out)
+{
+	vector<uint64_t> samples;
+	samples.reserve(iterations);
+	for (unsigned int i = 0; i < iterations; i++) {
+		uint64_t ns = 0;
+		const int ret = runProcess(exe, filename, &ns);
+		if (ret != 0) {
+			if (ret < 0) {
+				fprintf(stderr, "%s: %s: %s\n", argv0, exe, strerror(-ret));
+			} else {
+				fprintf(stderr, "%s: %s exited with status %d\n", argv0, exe, ret);
+			}
+			return EXIT_FAILURE;
+		}
+		samples.push_back(ns);
+	}
+	std::sort(samples.begin(), samples.end());
+
+	const uint64_t p50_ns = percentile(samples, 50);
+	char buf[256];
+	out += "{\n\t\"startup\": {\n\t\t\"command\": ";
+	appendJSONString(out, exe);
+	out += ",\n\t\t\"file\": ";
+	appendJSONString(out, filename);
+	snprintf(buf, sizeof(buf), ",\n\t\t\"runs\": %u, \"min_ns\": %" PRIu64
+		", \"p50_ns\": %" PRIu64 ", \"p99_ns\": %" PRIu64 "\n\t}\n}\n",
+		iterations, samples.front(), p50_ns, percentile(samples, 99));
+	out += buf;
+
+	if (max_ms != 0 && p50_ns > static_cast<uint64_t>(max_ms) * 1000000U) {
+		fprintf(stderr, "%s: median startup time %" PRIu64 " ms exceeds the limit of %u ms\n",
+			argv0, p50_ns / 1000000U, max_ms);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+static void usage(const char *argv0)
+{
+	fprintf(stderr, "Usage: %s [-n iterations] [-o output.json] corpus_dir\n", argv0);
+	fprintf(stderr, "       %s -S rpcli [-n iterations] [-L max_ms] [-o output.json] file\n", argv0);
+}
+
+/**
+ * Write the output to a file or stdout.
+ * @param argv0		[in] argv[0]
+ * @param outFilename	[in,opt] Output filename. (If nullptr, use stdout.)
+ * @param out		[in] Output.
+ * @return 0 on success; non-zero on error.
+ */
+static int writeOutput(const char *argv0, const char *outFilename, const string &out)
+{
+	FILE *f = stdout;
+	if (outFilename) {
+		f = fopen(outFilename, "w");
+		if (!f) {
+			fprintf(stderr, "%s: %s: %s\n", argv0, outFilename, strerror(errno));
+			return -1;
+		}
+	}
+	fwrite(out.data(), 1, out.size(), f);
+	if (f != stdout) {
+		fclose(f);
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	static_assert(ARRAY_SIZE(stage_names) == STAGE_MAX, "stage_names[] is out of sync");
+
+	unsigned int iterations = 10;
+	const char *outFilename = nullptr;
+	const char *startupExe = nullptr;
+	unsigned int max_ms = 0;
+
+	int c;
+	while ((c = getopt(argc, argv, "n:o:S:L:h")) != -1) {
+		switch (c) {
+			case 'n': {
+				char *endptr = nullptr;
+				const unsigned long n = strtoul(optarg, &endptr, 10);
+				if (!endptr || *endptr != '\0' || n == 0 || n > 1000000) {
+					fprintf(stderr, "%s: invalid iteration count: %s\n", argv[0], optarg);
+					return EXIT_FAILURE;
+				}
+				iterations = static_cast<unsigned int>(n);
+				break;
+			}
+			case 'o':
+				outFilename = optarg;
+				break;
+			case 'S':
+				startupExe = optarg;
+				break;
+			case 'L': {
+				char *endptr = nullptr;
+				const unsigned long ms = strtoul(optarg, &endptr, 10);
+				if (!endptr || *endptr != '\0' || ms == 0 || ms > 3600000) {
+					fprintf(stderr, "%s: invalid time limit: %s\n", argv[0], optarg);
+					return EXIT_FAILURE;
+				}
+				max_ms = static_cast<unsigned int>(ms);
+				break;
+			}
+			case 'h':
+			default:
+				usage(argv[0]);
+				return (c == 'h' ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+	if (optind + 1 != argc) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (startupExe) {
+		string out;
+		const int ret = benchStartup(argv[0], startupExe, argv[optind], iterations, max_ms, out);
+		if (!out.empty() && writeOutput(argv[0], outFilename, out) != 0) {
+			return EXIT_FAILURE;
+		}
+		return ret;
+	}
+
+	const char *const corpus = argv[optind];
+	vector<string> files;
+	int ret = recursiveScan(corpus, files);
+	if (ret != 0) {
+		fprintf(stderr, "%s: %s: %s\n", argv[0], corpus, strerror(-ret));
+		return EXIT_FAILURE;
+	}
+	// Sort the filenames so runs are reproducible.
+	std::sort(files.begin(), files.end());
+
+	map<string, ClassStats> classes;
+	for (const string &filename : files) {
+		benchFile(filename.c_str(), iterations, classes);
+	}
+
+	string out;
+	writeJSON(out, corpus, iterations, files.size(), classes);
+
+	return (writeOutput(argv[0], outFilename, out) == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,403 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * hashfile.cpp: Calculate CRC32, MD5, and SHA-1 hashes of a file.         *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "hashfile.hpp"
+
+// librpbase
+#include "librpbase/crypto/Hash.hpp"
+#include "librpbase/disc/SparseDiscReader.hpp"
+#include "librpbase/TextFuncs.hpp"
+#include "libi18n/i18n.h"
+using LibRpBase::Hash;
+using LibRpBase::IDiscReader;
+using LibRpBase::RomHashes;
+using LibRpBase::SparseDiscReader;
+using LibRpBase::rp_sprintf;
+
+// librpfile
+#include "librpfile/RpFile.hpp"
+using LibRpFile::IRpFile;
+using LibRpFile::RpFile;
+
+// librpthreads
+#include "librpthreads/Atomics.h"
+#include "librpthreads/Semaphore.hpp"
+#include "librpthreads/Thread.hpp"
+using LibRpThreads::Semaphore;
+using LibRpThreads::Thread;
+
+// libromdata
+#include "libromdata/disc/CisoGcnReader.hpp"
+#include "libromdata/disc/CisoPspReader.hpp"
+#include "libromdata/disc/GczReader.hpp"
+#include "libromdata/disc/WbfsReader.hpp"
+using namespace LibRomData;
+
+// C includes. (C++ namespace)
+#include <cctype>
+
+// C++ includes.
+#include <memory>
+#include <string>
+using std::ostream;
+using std::string;
+using std::unique_ptr;
+
+// Size of each read buffer.
+#define HASH_BUF_SIZE (1024U*1024U)
+// Number of read buffers.
+// The reader can get this many buffers ahead of the slowest hash.
+#define HASH_BUF_COUNT 4
+
+// Hash algorithms. Each one runs in its own thread.
+static const Hash::Algorithm hash_algorithms[] = {
+	Hash::Algorithm::CRC32,
+	Hash::Algorithm::MD5,
+	Hash::Algorithm::SHA1,
+};
+#define HASH_WORKER_COUNT ARRAY_SIZE(hash_algorithms)
+
+/**
+ * Read the next block of data.
+ * @param userdata	[in] User data
+ * @param ptr		[out] Output buffer
+ * @param size		[in] Amount of data to read
+ * @return Number of bytes read. (0 at EOF)
+ */
+typedef size_t (*pfnRead_t)(void *userdata, void *ptr, size_t size);
+
+/**
+ * Pipelined hash calculation.
+ *
+ * The calling thread reads the data into a ring of buffers,
+ * and each hash algorithm runs in its own worker thread.
+ * A buffer is reused once all of the workers are done with it,
+ * so reading and hashing overlap, and the total time is roughly
+ * that of the slowest hash or the read, whichever is slower.
+ */
+class HashPipeline
+{
+	public:
+		HashPipeline();
+
+	private:
+		RP_DISABLE_COPY(HashPipeline)
+
+	public:
+		/**
+		 * Hash a data stream.
+		 * @param pfnRead	[in] Read function
+		 * @param userdata	[in] User data for pfnRead
+		 * @param expectedSize	[in] Expected size of the stream
+		 * @param out		[out] Hashes
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int run(pfnRead_t pfnRead, void *userdata, off64_t expectedSize, RomHashes::List &out);
+
+	private:
+		/**
+		 * Hash worker thread function.
+		 * @param param Worker
+		 */
+		static void workerFunc(void *param);
+
+		struct Buffer {
+			unique_ptr<uint8_t[]> data;
+			size_t size;		// 0 == end of stream
+			volatile int refs;	// Number of workers that haven't processed this buffer yet.
+		};
+
+		struct Worker {
+			HashPipeline *pipeline;
+			unique_ptr<Hash> hash;
+			unique_ptr<Semaphore> filled;	// Released once per filled buffer.
+			Thread thread;
+			bool isRunning;			// If false, the reader thread hashes the data itself.
+		};
+
+		/**
+		 * A worker is done with a buffer.
+		 * @param buf Buffer
+		 */
+		inline void releaseBuffer(Buffer &buf)
+		{
+			if (ATOMIC_DEC_FETCH(&buf.refs) == 0) {
+				m_free.release();
+			}
+		}
+
+		Buffer m_bufs[HASH_BUF_COUNT];
+		Semaphore m_free;	// Number of buffers available to the reader.
+		Worker m_workers[HASH_WORKER_COUNT];
+};
+
+HashPipeline::HashPipeline()
+	: m_free(HASH_BUF_COUNT)
+{
+	for (Buffer &buf : m_bufs) {
+		buf.data.reset(new uint8_t[HASH_BUF_SIZE]);
+		buf.size = 0;
+		buf.refs = 0;
+	}
+	for (unsigned int i = 0; i < HASH_WORKER_COUNT; i++) {
+		Worker &worker = m_workers[i];
+		worker.pipeline = this;
+		worker.hash.reset(new Hash(hash_algorithms[i]));
+		worker.filled.reset(new Semaphore(0));
+		worker.isRunning = false;
+	}
+}
+
+/**
+ * Hash worker thread function.
+ * @param param Worker
+ */
+void HashPipeline::workerFunc(void *param)
+{
+	Worker *const worker = static_cast<Worker*>(param);
+	HashPipeline *const pipeline = worker->pipeline;
+
+	for (unsigned int slot = 0;; slot = (slot + 1) % HASH_BUF_COUNT) {
+		worker->filled->obtain();
+		Buffer &buf = pipeline->m_bufs[slot];
+		if (buf.size == 0) {
+			// End of stream.
+			break;
+		}
+		worker->hash->process(buf.data.get(), buf.size);
+		pipeline->releaseBuffer(buf);
+	}
+}
+
+/**
+ * Hash a data stream.
+ * @param pfnRead	[in] Read function
+ * @param userdata	[in] User data for pfnRead
+ * @param expectedSize	[in] Expected size of the stream
+ * @param out		[out] Hashes
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int HashPipeline::run(pfnRead_t pfnRead, void *userdata, off64_t expectedSize, RomHashes::List &out)
+{
+	// Start the workers.
+	// If a thread can't be created, that hash is
+	// calculated in this thread instead.
+	for (Worker &worker : m_workers) {
+		worker.hash->reset();
+		worker.isRunning = (worker.thread.create(workerFunc, &worker) == 0);
+	}
+
+	off64_t total = 0;
+	for (unsigned int slot = 0;; slot = (slot + 1) % HASH_BUF_COUNT) {
+		m_free.obtain();
+		Buffer &buf = m_bufs[slot];
+		buf.size = pfnRead(userdata, buf.data.get(), HASH_BUF_SIZE);
+		buf.refs = static_cast<int>(HASH_WORKER_COUNT);
+		total += buf.size;
+
+		for (Worker &worker : m_workers) {
+			if (worker.isRunning) {
+				worker.filled->release();
+			} else if (buf.size != 0) {
+				worker.hash->process(buf.data.get(), buf.size);
+				releaseBuffer(buf);
+			}
+		}
+
+		if (buf.size == 0) {
+			// End of stream.
+			break;
+		}
+	}
+
+	// Wait for the workers to finish.
+	for (Worker &worker : m_workers) {
+		if (worker.isRunning) {
+			worker.thread.join();
+			worker.isRunning = false;
+		}
+	}
+	// The end-of-stream buffer is available again.
+	m_free.release();
+
+	if (total != expectedSize) {
+		// Short read.
+		return -EIO;
+	}
+
+	out.clear();
+	out.reserve(HASH_WORKER_COUNT);
+	for (const Worker &worker : m_workers) {
+		uint8_t hash[64];
+		const size_t len = worker.hash->hashLength();
+		if (len > sizeof(hash) || worker.hash->getHash(hash, sizeof(hash)) != 0) {
+			continue;
+		}
+
+		static const char hex_lookup[] = "0123456789abcdef";
+		string s_hash;
+		s_hash.resize(len * 2);
+		for (size_t i = 0; i < len; i++) {
+			s_hash[i*2]   = hex_lookup[hash[i] >> 4];
+			s_hash[i*2+1] = hex_lookup[hash[i] & 0x0F];
+		}
+		out.emplace_back(Hash::algorithmName(worker.hash->algorithm()), std::move(s_hash));
+	}
+	return 0;
+}
+
+/**
+ * pfnRead_t for IRpFile.
+ */
+static size_t readFile(void *userdata, void *ptr, size_t size)
+{
+	return static_cast<IRpFile*>(userdata)->read(ptr, size);
+}
+
+/**
+ * pfnRead_t for IDiscReader.
+ */
+static size_t readDisc(void *userdata, void *ptr, size_t size)
+{
+	return static_cast<IDiscReader*>(userdata)->read(ptr, size);
+}
+
+/**
+ * Calculate the CRC32, MD5, and SHA-1 hashes of a file.
+ *
+ * If the file is a CISO, WBFS, or GCZ disc image, the hashes
+ * of the decompressed disc image are calculated as well.
+ *
+ * @param filename	[in] Filename
+ * @param hashes	[out] Hashes
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int HashFile(const char *filename, RomHashes &hashes)
+{
+	hashes.file.clear();
+	hashes.streamType.clear();
+	hashes.stream.clear();
+
+	// NOTE: Not using FM_OPEN_READ_GZ, since the
+	// hashes should match the file as stored.
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		const int err = file->lastError();
+		file->unref();
+		return (err != 0 ? -err : -EIO);
+	}
+
+	HashPipeline pipeline;
+	file->adviseAccess(IRpFile::AccessPattern::Sequential);
+	int ret = pipeline.run(readFile, file, file->size(), hashes.file);
+	if (ret != 0) {
+		file->unref();
+		return ret;
+	}
+
+	// Check for a compressed disc image.
+	uint8_t header[4096];
+	const size_t szHeader = file->seekAndRead(0, header, sizeof(header));
+	SparseDiscReader *reader = nullptr;
+	const char *streamType = nullptr;
+	if (CisoGcnReader::isDiscSupported_static(header, szHeader) >= 0) {
+		reader = new CisoGcnReader(file);
+		streamType = "CISO";
+	} else if (CisoPspReader::isDiscSupported_static(header, szHeader) >= 0) {
+		reader = new CisoPspReader(file);
+		streamType = "CISO";
+	} else if (WbfsReader::isDiscSupported_static(header, szHeader) >= 0) {
+		reader = new WbfsReader(file);
+		streamType = "WBFS";
+	} else if (GczReader::isDiscSupported_static(header, szHeader) >= 0) {
+		reader = new GczReader(file);
+		streamType = "GCZ";
+	}
+
+	if (reader) {
+		if (reader->isOpen()) {
+			ret = pipeline.run(readDisc, reader, reader->size(), hashes.stream);
+			if (ret == 0) {
+				hashes.streamType = streamType;
+			} else {
+				hashes.stream.clear();
+			}
+		}
+		reader->unref();
+	}
+
+	file->unref();
+	return ret;
+}
+
+/**
+ * Print a list of hashes in text format.
+ * @param os Output stream
+ * @param list Hashes
+ */
+static void PrintHashList(ostream &os, const RomHashes::List &list)
+{
+	for (const auto &p : list) {
+		string name = p.first;
+		std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+		os << "  " << name << ':' << string(6 - std::min<size_t>(name.size(), 5), ' ')
+		   << p.second << '\n';
+	}
+}
+
+/**
+ * Print hashes in text format.
+ * @param os Output stream
+ * @param hashes Hashes
+ */
+void PrintHashes(ostream &os, const RomHashes &hashes)
+{
+	if (!hashes.file.empty()) {
+		os << C_("rpcli", "File hashes:") << '\n';
+		PrintHashList(os, hashes.file);
+	}
+	if (!hashes.streamType.empty() && !hashes.stream.empty()) {
+		// tr: %s == container type, e.g. "GCZ"
+		os << rp_sprintf(C_("rpcli", "Decompressed %s hashes:"), hashes.streamType.c_str()) << '\n';
+		PrintHashList(os, hashes.stream);
+	}
+	os.flush();
+}
+
+/**
+ * Get hashes as JSON object members, without the enclosing braces.
+ * This is used if the file isn't supported by RomData.
+ * @param hashes Hashes
+ * @return JSON object members, e.g. "\"hashes\":{...}"
+ */
+string HashesToJSONMembers(const RomHashes &hashes)
+{
+	// NOTE: Algorithm names, container types, and hex strings
+	// never need to be escaped.
+	string s;
+	if (!hashes.file.empty()) {
+		s += "\"hashes\":{";
+		bool first = true;
+		for (const auto &p : hashes.file) {
+			if (!first) s += ',';
+			first = false;
+			s += '"' + p.first + "\":\"" + p.second + '"';
+		}
+		s += '}';
+	}
+	if (!hashes.streamType.empty() && !hashes.stream.empty()) {
+		if (!s.empty()) s += ',';
+		s += "\"stream_hashes\":{\"type\":\"" + hashes.streamType + '"';
+		for (const auto &p : hashes.stream) {
+			s += ",\"" + p.first + "\":\"" + p.second + '"';
+		}
+		s += '}';
+	}
+	return s;
+}
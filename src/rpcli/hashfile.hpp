@@ -0,0 +1,41 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * hashfile.hpp: Calculate CRC32, MD5, and SHA-1 hashes of a file.         *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RPCLI_HASHFILE_HPP__
+#define __ROMPROPERTIES_RPCLI_HASHFILE_HPP__
+
+#include "librpbase/TextOut.hpp"
+
+/**
+ * Calculate the CRC32, MD5, and SHA-1 hashes of a file.
+ *
+ * If the file is a CISO, WBFS, or GCZ disc image, the hashes
+ * of the decompressed disc image are calculated as well.
+ *
+ * @param filename	[in] Filename
+ * @param hashes	[out] Hashes
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int HashFile(const char *filename, LibRpBase::RomHashes &hashes);
+
+/**
+ * Print hashes in text format.
+ * @param os Output stream
+ * @param hashes Hashes
+ */
+void PrintHashes(std::ostream &os, const LibRpBase::RomHashes &hashes);
+
+/**
+ * Get hashes as JSON object members, without the enclosing braces.
+ * This is used if the file isn't supported by RomData.
+ * @param hashes Hashes
+ * @return JSON object members, e.g. "\"hashes\":{...}"
+ */
+std::string HashesToJSONMembers(const LibRpBase::RomHashes &hashes);
+
+#endif /* __ROMPROPERTIES_RPCLI_HASHFILE_HPP__ */
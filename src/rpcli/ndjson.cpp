@@ -0,0 +1,245 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * ndjson.cpp: NDJSON output for multiple files.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "ndjson.hpp"
+
+// librpbase, librpfile
+#include "librpbase/RomData.hpp"
+#include "librpbase/TextFuncs.hpp"
+#include "librpbase/TextOut.hpp"
+#include "librpfile/RpFile.hpp"
+#include "libi18n/i18n.h"
+using namespace LibRpBase;
+using LibRpFile::RpFile;
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+using LibRpThreads::ThreadPool;
+
+// libromdata
+#include "libromdata/RomDataFactory.hpp"
+using LibRomData::RomDataFactory;
+
+// C includes. (C++ namespace)
+#include <cerrno>
+
+// C++ includes.
+#include <sstream>
+#include <string>
+#include <vector>
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::ostringstream;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+/**
+ * Shared state for the NDJSON workers.
+ */
+struct NDJSONState {
+	const vector<string> *filenames;
+	uint32_t languageCode;
+	const RomOutputFilter *filter;
+	bool ordered;
+
+	// Output state. (protected by outMutex)
+	Mutex outMutex;
+	vector<string> lines;	// Finished lines that haven't been printed yet (ordered mode)
+	vector<bool> done;	// True if the file has been processed (ordered mode)
+	size_t nextOut;		// Index of the next line to print (ordered mode)
+
+	NDJSONState()
+		: filenames(nullptr)
+		, languageCode(0)
+		, filter(nullptr)
+		, ordered(false)
+		, nextOut(0)
+	{ }
+};
+
+/**
+ * Append a string to a JSON line as a quoted JSON string.
+ * @param line	[in/out] JSON line.
+ * @param str	[in] String. (UTF-8)
+ */
+static void appendJSONString(string &line, const string &str)
+{
+	line += '"';
+	for (const char chr : str) {
+		switch (chr) {
+			case '"':	line += "\\\""; break;
+			case '\\':	line += "\\\\"; break;
+			case '\b':	line += "\\b"; break;
+			case '\f':	line += "\\f"; break;
+			case '\n':	line += "\\n"; break;
+			case '\r':	line += "\\r"; break;
+			case '\t':	line += "\\t"; break;
+			default:
+				if (static_cast<uint8_t>(chr) < 0x20) {
+					char buf[8];
+					snprintf(buf, sizeof(buf), "\\u%04X", static_cast<uint8_t>(chr));
+					line += buf;
+				} else {
+					line += chr;
+				}
+				break;
+		}
+	}
+	line += '"';
+}
+
+/**
+ * Get the NDJSON line for a file.
+ * @param state		[in] NDJSONState
+ * @param filename	[in] Filename
+ * @return JSON line, without the trailing newline.
+ */
+static string getFileLine(const NDJSONState *state, const string &filename)
+{
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ_MMAP);
+	if (!file->isOpen()) {
+		string line = "{\"filename\":";
+		appendJSONString(line, filename);
+		line += ",\"error\":\"couldn't open file\",\"code\":";
+		line += std::to_string(file->lastError());
+		line += '}';
+		file->unref();
+		return line;
+	}
+
+	RomData *const romData = RomDataFactory::create(file);
+	file->unref();	// file is ref()'d by RomData.
+	if (!romData || !romData->isValid()) {
+		UNREF(romData);
+		string line = "{\"filename\":";
+		appendJSONString(line, filename);
+		line += ",\"error\":\"rom is not supported\"}";
+		return line;
+	}
+
+	ostringstream oss;
+	JSONROMOutput jsonOut(romData, state->languageCode);
+	jsonOut.setCompact(true);
+	jsonOut.setFilename(filename.c_str());
+	jsonOut.setFilter(state->filter);
+	oss << jsonOut;
+	romData->unref();
+	return oss.str();
+}
+
+/**
+ * NDJSON range function for ThreadPool::parallelFor().
+ * @param param NDJSONState
+ * @param begin First file index
+ * @param end One past the last file index
+ */
+static void ndjsonRangeFunc(void *param, size_t begin, size_t end)
+{
+	NDJSONState *const state = static_cast<NDJSONState*>(param);
+
+	for (size_t i = begin; i < end; i++) {
+		string line = getFileLine(state, (*state->filenames)[i]);
+
+		MutexLocker locker(state->outMutex);
+		if (!state->ordered) {
+			// Print the line now.
+			cout << line << '\n';
+			cout.flush();
+			continue;
+		}
+
+		// Print all lines that are ready, in order.
+		state->lines[i] = std::move(line);
+		state->done[i] = true;
+		bool printed = false;
+		while (state->nextOut < state->done.size() && state->done[state->nextOut]) {
+			cout << state->lines[state->nextOut] << '\n';
+			string().swap(state->lines[state->nextOut]);
+			state->nextOut++;
+			printed = true;
+		}
+		if (printed) {
+			cout.flush();
+		}
+	}
+}
+
+/**
+ * Print information about multiple files in NDJSON format.
+ *
+ * Each file is printed to stdout as a compact JSON object on
+ * a single line, with the filename in the "filename" member.
+ * Files that can't be opened or aren't supported are printed
+ * as objects with an "error" member.
+ *
+ * Files are processed in parallel. Each line is printed as soon
+ * as its file has been processed, unless ordered is true, in which
+ * case the lines are printed in the same order as the filenames.
+ *
+ * @param filenames	[in] Filenames.
+ * @param threadCount	[in] Number of worker threads. (0 for the number of CPUs)
+ * @param ordered	[in] If true, print the lines in the original order.
+ * @param languageCode	[in] Language code. (0 for default)
+ * @param filter	[in,opt] Output filter. (nullptr to print everything)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int DoFilesNDJSON(const vector<string> &filenames,
+	unsigned int threadCount, bool ordered, uint32_t languageCode,
+	const RomOutputFilter *filter)
+{
+	if (filenames.empty())
+		return 0;
+
+	unique_ptr<NDJSONState> state(new NDJSONState());
+	state->filenames = &filenames;
+	state->languageCode = languageCode;
+	state->filter = filter;
+	state->ordered = ordered;
+	if (ordered) {
+		state->lines.resize(filenames.size());
+		state->done.resize(filenames.size());
+	}
+
+	// Use the process-wide thread pool unless a
+	// specific number of threads was requested.
+	// NOTE: The calling thread also processes files.
+	unique_ptr<ThreadPool> localPool;
+	ThreadPool *pool;
+	if (threadCount == 0) {
+		pool = ThreadPool::instance();
+		threadCount = pool->threadCount() + 1;
+	} else {
+		if (threadCount > filenames.size()) {
+			threadCount = static_cast<unsigned int>(filenames.size());
+		}
+		if (threadCount > 1) {
+			localPool.reset(new ThreadPool(threadCount - 1));
+			threadCount = localPool->threadCount() + 1;
+		}
+		pool = localPool.get();
+	}
+	if (threadCount > filenames.size()) {
+		threadCount = static_cast<unsigned int>(filenames.size());
+	}
+	cerr << "-- " << rp_sprintf_p(C_("rpcli", "Reading %1$u file(s) using %2$u thread(s)..."),
+		static_cast<unsigned int>(filenames.size()), threadCount) << endl;
+
+	if (pool) {
+		pool->parallelFor(0, filenames.size(), ndjsonRangeFunc, state.get());
+	} else {
+		ndjsonRangeFunc(state.get(), 0, filenames.size());
+	}
+
+	return 0;
+}
@@ -0,0 +1,46 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * ndjson.hpp: NDJSON output for multiple files.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RPCLI_NDJSON_HPP__
+#define __ROMPROPERTIES_RPCLI_NDJSON_HPP__
+
+// C includes.
+#include <stdint.h>
+
+// C++ includes.
+#include <string>
+#include <vector>
+
+namespace LibRpBase {
+	struct RomOutputFilter;
+}
+
+/**
+ * Print information about multiple files in NDJSON format.
+ *
+ * Each file is printed to stdout as a compact JSON object on
+ * a single line, with the filename in the "filename" member.
+ * Files that can't be opened or aren't supported are printed
+ * as objects with an "error" member.
+ *
+ * Files are processed in parallel. Each line is printed as soon
+ * as its file has been processed, unless ordered is true, in which
+ * case the lines are printed in the same order as the filenames.
+ *
+ * @param filenames	[in] Filenames.
+ * @param threadCount	[in] Number of worker threads. (0 for the number of CPUs)
+ * @param ordered	[in] If true, print the lines in the original order.
+ * @param languageCode	[in] Language code. (0 for default)
+ * @param filter	[in,opt] Output filter. (nullptr to print everything)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int DoFilesNDJSON(const std::vector<std::string> &filenames,
+	unsigned int threadCount, bool ordered, uint32_t languageCode = 0,
+	const LibRpBase::RomOutputFilter *filter = nullptr);
+
+#endif /* __ROMPROPERTIES_RPCLI_NDJSON_HPP__ */
@@ -0,0 +1,148 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * prefetch.cpp: Prefetch external images into the download cache.        *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "prefetch.hpp"
+
+// librpbase
+#include "librpbase/RomData.hpp"
+#include "librpbase/TextFuncs.hpp"
+#include "libi18n/i18n.h"
+using LibRpBase::RomData;
+using LibRpBase::rp_sprintf;
+
+// librpfile
+#include "librpfile/RpFile.hpp"
+using LibRpFile::RpFile;
+
+// libromdata
+#include "libromdata/RomDataFactory.hpp"
+#include "libromdata/img/CacheManager.hpp"
+using LibRomData::CacheManager;
+using LibRomData::RomDataFactory;
+
+// C++ includes.
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+using std::cerr;
+using std::endl;
+using std::string;
+using std::unordered_set;
+using std::vector;
+
+/**
+ * Get the cache keys for all external images of a ROM file.
+ *
+ * All external image types and all image sizes are included,
+ * including high-resolution images.
+ *
+ * @param filename	[in] ROM filename
+ * @param cache_keys	[in/out] Cache keys. (New keys are appended.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GetExtImageCacheKeys(const char *filename, vector<string> &cache_keys)
+{
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ_MMAP);
+	if (!file->isOpen()) {
+		const int err = file->lastError();
+		file->unref();
+		return (err != 0 ? -err : -EIO);
+	}
+
+	RomData *const romData = RomDataFactory::create(file);
+	file->unref();
+	if (!romData || !romData->isValid()) {
+		// ROM is not supported.
+		if (romData) {
+			romData->unref();
+		}
+		return -ENOTSUP;
+	}
+
+	const uint32_t imgbf = romData->supportedImageTypes();
+	for (int i = RomData::IMG_EXT_MIN; i <= RomData::IMG_EXT_MAX; i++) {
+		if (!(imgbf & (1U << i)))
+			continue;
+
+		// Get the URLs for each image size.
+		// NOTE: Some image types don't have size definitions.
+		const RomData::ImageType imageType = static_cast<RomData::ImageType>(i);
+		vector<int> sizes;
+		for (const auto &sizeDef : romData->supportedImageSizes(imageType)) {
+			sizes.push_back(sizeDef.height);
+		}
+		if (sizes.empty()) {
+			sizes.push_back(RomData::IMAGE_SIZE_DEFAULT);
+		}
+
+		for (int size : sizes) {
+			vector<RomData::ExtURL> extURLs;
+			if (romData->extURLs(imageType, &extURLs, size) != 0)
+				continue;
+			for (const RomData::ExtURL &extURL : extURLs) {
+				cache_keys.push_back(extURL.cache_key);
+			}
+		}
+	}
+
+	romData->unref();
+	return 0;
+}
+
+/**
+ * Download external images into the download cache.
+ *
+ * The images are downloaded in parallel using rp-download's batch mode.
+ * This ignores the OfflineOnly configuration option.
+ *
+ * Statistics are printed to stderr when done.
+ *
+ * @param cache_keys Cache keys.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int PrefetchExtImages(const vector<string> &cache_keys)
+{
+	// Remove duplicate cache keys.
+	// Multiple ROMs, image sizes, and region fallbacks
+	// may use the same images.
+	vector<string> keys;
+	keys.reserve(cache_keys.size());
+	unordered_set<string> seen;
+	for (const string &cache_key : cache_keys) {
+		if (!cache_key.empty() && seen.insert(cache_key).second) {
+			keys.push_back(cache_key);
+		}
+	}
+
+	cerr << rp_sprintf(NC_("rpcli",
+		"Prefetching %u external image...",
+		"Prefetching %u external images...",
+		static_cast<unsigned int>(keys.size())),
+		static_cast<unsigned int>(keys.size())) << endl;
+
+	// Download the images.
+	CacheManager cache;
+	cache.setOfflineOnly(false);
+	const vector<int> results = cache.downloadMultiple(keys);
+
+	unsigned int cached = 0;
+	for (int result : results) {
+		if (result == 0) {
+			cached++;
+		}
+	}
+
+	// NOTE: Images that don't exist on the server are stored
+	// as negative cache entries, so they won't be looked up
+	// again when offline.
+	cerr << rp_sprintf(C_("rpcli", "Cached %u of %u external images."),
+		cached, static_cast<unsigned int>(keys.size())) << endl;
+	return 0;
+}
@@ -0,0 +1,41 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * prefetch.hpp: Prefetch external images into the download cache.        *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RPCLI_PREFETCH_HPP__
+#define __ROMPROPERTIES_RPCLI_PREFETCH_HPP__
+
+// C++ includes.
+#include <string>
+#include <vector>
+
+/**
+ * Get the cache keys for all external images of a ROM file.
+ *
+ * All external image types and all image sizes are included,
+ * including high-resolution images.
+ *
+ * @param filename	[in] ROM filename
+ * @param cache_keys	[in/out] Cache keys. (New keys are appended.)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GetExtImageCacheKeys(const char *filename, std::vector<std::string> &cache_keys);
+
+/**
+ * Download external images into the download cache.
+ *
+ * The images are downloaded in parallel using rp-download's batch mode.
+ * This ignores the OfflineOnly configuration option.
+ *
+ * Statistics are printed to stderr when done.
+ *
+ * @param cache_keys Cache keys.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int PrefetchExtImages(const std::vector<std::string> &cache_keys);
+
+#endif /* __ROMPROPERTIES_RPCLI_PREFETCH_HPP__ */
@@ -0,0 +1,642 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * pregen.cpp: Pre-generate thumbnails for a directory tree.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "pregen.hpp"
+
+#ifdef RPCLI_HAS_PREGEN
+
+// librpbase, librpfile, librptexture
+#include "librpbase/RomData.hpp"
+#include "librpbase/TextFuncs.hpp"
+#include "librpbase/monotonic_time.h"
+#include "librpbase/img/RpPngWriter.hpp"
+#include "librpbase/config/Config.hpp"
+#include "librpfile/FileSystem.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librptexture/img/rp_image_backend_pooled.hpp"
+#include "libi18n/i18n.h"
+using namespace LibRpBase;
+using namespace LibRpFile;
+using LibRpTexture::rp_image;
+using LibRpTexture::rp_image_backend_pooled;
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+using LibRpThreads::ThreadPool;
+
+// libromdata
+#include "libromdata/RomDataFactory.hpp"
+#include "libromdata/img/XdgThumbnailCache.hpp"
+using LibRomData::RomDataFactory;
+
+// TCreateThumbnail is a templated class,
+// so we have to #include the .cpp file here.
+#include "libromdata/img/TCreateThumbnail.cpp"
+using LibRomData::TCreateThumbnail;
+
+// C includes.
+#include <dirent.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// C includes. (C++ namespace)
+#include "ctypex.h"
+#include <cerrno>
+#include <cstdlib>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::endl;
+using std::cerr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+// Thumbnail sizes to generate.
+// These are the XDG thumbnail cache's "normal", "large", and "x-large" sizes.
+static const int pregen_sizes[] = {128, 256, 512};
+
+/** PregenCreateThumbnail **/
+
+/**
+ * TCreateThumbnail implementation using rp_image.
+ * Images are always converted to ARGB32 so they can be
+ * written directly by RpPngWriter.
+ */
+class PregenCreateThumbnail : public TCreateThumbnail<const rp_image*>
+{
+	public:
+		PregenCreateThumbnail() { }
+
+	private:
+		typedef TCreateThumbnail<const rp_image*> super;
+		RP_DISABLE_COPY(PregenCreateThumbnail)
+
+	public:
+		/** TCreateThumbnail functions. **/
+
+		/**
+		 * Wrapper function to convert rp_image* to ImgClass.
+		 * @param img rp_image
+		 * @return ImgClass
+		 */
+		inline const rp_image *rpImageToImgClass(const rp_image *img) const final
+		{
+			return (img->format() == rp_image::Format::ARGB32)
+				? img->ref()
+				: img->dup_ARGB32();
+		}
+
+		/**
+		 * Wrapper function to check if an ImgClass is valid.
+		 * @param imgClass ImgClass
+		 * @return True if valid; false if not.
+		 */
+		inline bool isImgClassValid(const rp_image *const &imgClass) const final
+		{
+			return (imgClass != nullptr && imgClass->isValid());
+		}
+
+		/**
+		 * Wrapper function to get a "null" ImgClass.
+		 * @return "Null" ImgClass.
+		 */
+		inline const rp_image *getNullImgClass(void) const final
+		{
+			return nullptr;
+		}
+
+		/**
+		 * Free an ImgClass object.
+		 * @param imgClass ImgClass object.
+		 */
+		inline void freeImgClass(const rp_image *&imgClass) const final
+		{
+			UNREF_AND_NULL(imgClass);
+		}
+
+		/**
+		 * Rescale an ImgClass using the specified scaling method.
+		 * @param imgClass ImgClass object.
+		 * @param sz New size.
+		 * @param method Scaling method.
+		 * @return Rescaled ImgClass.
+		 */
+		const rp_image *rescaleImgClass(const rp_image *const &imgClass, const ImgSize &sz, ScalingMethod method = ScalingMethod::Nearest) const final;
+
+		/**
+		 * Get the size of the specified ImgClass.
+		 * @param imgClass	[in] ImgClass object.
+		 * @param pOutSize	[out] Pointer to ImgSize to store the image size.
+		 * @return 0 on success; non-zero on error.
+		 */
+		inline int getImgClassSize(const rp_image *const &imgClass, ImgSize *pOutSize) const final
+		{
+			pOutSize->width = imgClass->width();
+			pOutSize->height = imgClass->height();
+			return 0;
+		}
+
+		/**
+		 * Get the proxy for the specified URL.
+		 * @return Proxy, or empty string if no proxy is needed.
+		 */
+		inline string proxyForUrl(const string &url) const final
+		{
+			// rp-download uses the system proxy settings.
+			RP_UNUSED(url);
+			return string();
+		}
+};
+
+/**
+ * Rescale an ImgClass using the specified scaling method.
+ * @param imgClass ImgClass object.
+ * @param sz New size.
+ * @param method Scaling method.
+ * @return Rescaled ImgClass.
+ */
+const rp_image *PregenCreateThumbnail::rescaleImgClass(const rp_image *const &imgClass, const ImgSize &sz, ScalingMethod method) const
+{
+	if (method == ScalingMethod::Bilinear) {
+		return imgClass->scaled(sz.width, sz.height, rp_image::ScaleFilter::Bilinear);
+	}
+
+	// Nearest-neighbor scaling.
+	// NOTE: imgClass is always ARGB32. (see rpImageToImgClass())
+	assert(imgClass->format() == rp_image::Format::ARGB32);
+	rp_image *const img = new rp_image(sz.width, sz.height, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		img->unref();
+		return nullptr;
+	}
+
+	const int src_width = imgClass->width();
+	const int src_height = imgClass->height();
+	for (int y = 0; y < sz.height; y++) {
+		const uint32_t *const src = static_cast<const uint32_t*>(
+			imgClass->scanLine((y * src_height) / sz.height));
+		uint32_t *dest = static_cast<uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < sz.width; x++, dest++) {
+			*dest = src[(x * src_width) / sz.width];
+		}
+	}
+
+	rp_image::sBIT_t sBIT;
+	if (imgClass->get_sBIT(&sBIT) == 0) {
+		img->set_sBIT(&sBIT);
+	}
+	return img;
+}
+
+/** Pregen **/
+
+/**
+ * Thumbnail statistics.
+ * Each range of files is counted separately, and then
+ * added to the totals in PregenState.
+ */
+struct PregenStats {
+	unsigned int files_done;	// Files processed
+	unsigned int thumbs_created;	// Thumbnails created
+	unsigned int thumbs_fresh;	// Thumbnails skipped because they're still valid
+	unsigned int thumbs_failed;	// Thumbnails that couldn't be created
+	unsigned int files_unsupported;	// Files not supported by rom-properties
+	uint64_t bytes_read;		// Total size of the supported files
+
+	PregenStats()
+		: files_done(0)
+		, thumbs_created(0)
+		, thumbs_fresh(0)
+		, thumbs_failed(0)
+		, files_unsupported(0)
+		, bytes_read(0)
+	{ }
+
+	PregenStats &operator+=(const PregenStats &other)
+	{
+		files_done += other.files_done;
+		thumbs_created += other.thumbs_created;
+		thumbs_fresh += other.thumbs_fresh;
+		thumbs_failed += other.thumbs_failed;
+		files_unsupported += other.files_unsupported;
+		bytes_read += other.bytes_read;
+		return *this;
+	}
+};
+
+/**
+ * Shared state for the thumbnail worker threads.
+ */
+struct PregenState {
+	vector<string> files;	// Absolute filenames
+	Mutex errMutex;		// Serializes error messages
+	Mutex statsMutex;	// Protects stats
+	PregenStats stats;	// Totals for all files
+};
+
+/**
+ * Recursively scan a directory for regular files.
+ * Symbolic links are not followed.
+ * @param path	[in] Directory to scan.
+ * @param files	[in/out] List of filenames.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int recursiveScan(const string &path, vector<string> &files)
+{
+	DIR *const pdir = opendir(path.c_str());
+	if (!pdir) {
+		// Error opening the directory.
+		return -errno;
+	}
+
+	struct dirent *dirent;
+	while ((dirent = readdir(pdir)) != nullptr) {
+		// Skip "." and "..".
+		if (dirent->d_name[0] == '.' &&
+		    (dirent->d_name[1] == '\0' ||
+		     (dirent->d_name[1] == '.' && dirent->d_name[2] == '\0')))
+		{
+			continue;
+		}
+
+		string fullpath(path);
+		if (fullpath.empty() || fullpath[fullpath.size()-1] != '/') {
+			fullpath += '/';
+		}
+		fullpath += dirent->d_name;
+
+		uint8_t d_type = dirent->d_type;
+		if (d_type == DT_UNKNOWN) {
+			// Unknown. Use lstat().
+			struct stat sb;
+			if (lstat(fullpath.c_str(), &sb) != 0)
+				continue;
+			if (S_ISREG(sb.st_mode)) {
+				d_type = DT_REG;
+			} else if (S_ISDIR(sb.st_mode)) {
+				d_type = DT_DIR;
+			}
+		}
+
+		switch (d_type) {
+			case DT_REG:
+				files.emplace_back(std::move(fullpath));
+				break;
+			case DT_DIR:
+				// Errors in subdirectories are ignored.
+				recursiveScan(fullpath, files);
+				break;
+			default:
+				// Not a regular file or directory.
+				break;
+		}
+	}
+
+	closedir(pdir);
+	return 0;
+}
+
+/**
+ * Convert an absolute filename to a file:// URI.
+ * Characters that aren't allowed in a URI path are percent-encoded.
+ * @param filename Absolute filename.
+ * @return URI
+ */
+static string filenameToURI(const string &filename)
+{
+	static const char hex_lookup[] = "0123456789ABCDEF";
+
+	string uri = "file://";
+	uri.reserve(uri.size() + filename.size() + 16);
+	for (const char chr : filename) {
+		const uint8_t c = static_cast<uint8_t>(chr);
+		if (ISALNUM(c) || strchr("-._~!$&'()*+,;=:@/", c) != nullptr) {
+			uri += static_cast<char>(c);
+		} else {
+			uri += '%';
+			uri += hex_lookup[c >> 4];
+			uri += hex_lookup[c & 0x0F];
+		}
+	}
+	return uri;
+}
+
+/**
+ * Save a thumbnail to the XDG thumbnail cache.
+ * @param romData	[in] RomData
+ * @param outParams	[in] Thumbnail
+ * @param uri		[in] Source file URI
+ * @param sb		[in] Source file information
+ * @param tmp_filename	[in] Temporary filename
+ * @param thumb_filename [in] Thumbnail filename
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int saveThumbnail(const RomData *romData,
+	const PregenCreateThumbnail::GetThumbnailOutParams_t &outParams,
+	const string &uri, const struct stat &sb,
+	const string &tmp_filename, const string &thumb_filename)
+{
+	// The XDG thumbnail specification requires thumbnails
+	// to be readable only by the owner, so create the file
+	// with mode 0600 before RpPngWriter opens it.
+	// NOTE: chmod() isn't allowed by the seccomp() filter.
+	// NOTE: A stale temporary file might be left over from an
+	// earlier run that was interrupted, so remove it first.
+	unlink(tmp_filename.c_str());
+	int fd = open(tmp_filename.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+	if (fd < 0) {
+		return -errno;
+	}
+	close(fd);
+
+	unique_ptr<RpPngWriter> pngWriter(new RpPngWriter(tmp_filename.c_str(),
+		outParams.thumbSize.width, outParams.thumbSize.height,
+		rp_image::Format::ARGB32));
+	if (!pngWriter->isOpen()) {
+		// Could not open the PNG writer.
+		const int err = pngWriter->lastError();
+		pngWriter.reset();
+		unlink(tmp_filename.c_str());
+		return (err != 0 ? -err : -EIO);
+	}
+	if (Config::instance()->fastThumbnailPNG()) {
+		// Thumbnails are written often and read rarely,
+		// so trade file size for compression speed.
+		pngWriter->setProfile(RpPngWriter::Profile::Fast);
+	}
+
+	/** tEXt chunks. **/
+	// NOTE: These are written before IHDR in order to put the
+	// tEXt chunks before the IDAT chunk.
+	// KDE uses this order: Software, MTime, Mimetype, Size, URI
+	RpPngWriter::kv_vector kv;
+	kv.reserve(7);
+	char buf[32];
+
+	kv.emplace_back("Software", "ROM Properties Page shell extension (rpcli)");
+	snprintf(buf, sizeof(buf), "%" PRId64, static_cast<int64_t>(sb.st_mtime));
+	kv.emplace_back("Thumb::MTime", buf);
+	const char *const mimeType = romData->mimeType();
+	if (mimeType) {
+		kv.emplace_back("Thumb::Mimetype", mimeType);
+	}
+	snprintf(buf, sizeof(buf), "%" PRId64, static_cast<int64_t>(sb.st_size));
+	kv.emplace_back("Thumb::Size", buf);
+	if (outParams.fullSize.width > 0 && outParams.fullSize.height > 0) {
+		snprintf(buf, sizeof(buf), "%d", outParams.fullSize.width);
+		kv.emplace_back("Thumb::Image::Width", buf);
+		snprintf(buf, sizeof(buf), "%d", outParams.fullSize.height);
+		kv.emplace_back("Thumb::Image::Height", buf);
+	}
+	kv.emplace_back("Thumb::URI", uri);
+	pngWriter->write_tEXt(kv);
+
+	/** IHDR **/
+
+	// If sBIT wasn't found, all fields will be 0.
+	// RpPngWriter will ignore sBIT in this case.
+	int ret = pngWriter->write_IHDR(&outParams.sBIT);
+	if (ret == 0) {
+		/** IDAT chunk. **/
+		const rp_image *const img = outParams.retImg;
+		unique_ptr<const uint8_t*[]> row_pointers(new const uint8_t*[outParams.thumbSize.height]);
+		for (int y = 0; y < outParams.thumbSize.height; y++) {
+			row_pointers[y] = static_cast<const uint8_t*>(img->scanLine(y));
+		}
+		ret = pngWriter->write_IDAT(row_pointers.get());
+	}
+	pngWriter.reset();
+
+	if (ret != 0) {
+		unlink(tmp_filename.c_str());
+		return ret;
+	}
+
+	// Atomically replace the thumbnail, since file managers
+	// may be reading the thumbnail cache at the same time.
+	if (rename(tmp_filename.c_str(), thumb_filename.c_str()) != 0) {
+		ret = -errno;
+		unlink(tmp_filename.c_str());
+		return ret;
+	}
+	return 0;
+}
+
+/**
+ * Print an error message from a worker thread.
+ * @param state	[in] PregenState
+ * @param msg	[in] Message
+ */
+static void printError(PregenState *state, const string &msg)
+{
+	MutexLocker locker(state->errMutex);
+	cerr << "-- " << msg << endl;
+}
+
+/**
+ * Thumbnail range function for ThreadPool::parallelFor().
+ * @param param PregenState
+ * @param begin First file index
+ * @param end One past the last file index
+ */
+static void pregenRangeFunc(void *param, size_t begin, size_t end)
+{
+	PregenState *const state = static_cast<PregenState*>(param);
+	PregenStats stats;
+	PregenCreateThumbnail d;
+
+	for (size_t i = begin; i < end; i++) {
+		const string &filename = state->files[i];
+		struct stat sb;
+		if (stat(filename.c_str(), &sb) != 0) {
+			// File was removed while scanning?
+			continue;
+		}
+
+		// Check which thumbnails need to be created.
+		const string uri = filenameToURI(filename);
+		string thumb_filenames[ARRAY_SIZE(pregen_sizes)];
+		unsigned int stale = 0;
+		for (unsigned int j = 0; j < ARRAY_SIZE(pregen_sizes); j++) {
+			thumb_filenames[j] = LibRomData::XdgThumbnailCache::getThumbnailFilename(uri.c_str(), pregen_sizes[j]);
+			if (thumb_filenames[j].empty() ||
+			    LibRomData::XdgThumbnailCache::isThumbnailValid(
+				thumb_filenames[j].c_str(), uri.c_str(), sb.st_mtime))
+			{
+				// Thumbnail is still valid.
+				stats.thumbs_fresh++;
+				thumb_filenames[j].clear();
+			} else {
+				stale++;
+			}
+		}
+		stats.files_done++;
+		if (stale == 0)
+			continue;
+
+		// Open the file.
+		RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ_MMAP);
+		if (!file->isOpen()) {
+			printError(state, rp_sprintf_p(C_("rpcli", "Couldn't open file '%1$s': %2$s"),
+				filename.c_str(), strerror(file->lastError())));
+			stats.thumbs_failed += stale;
+			file->unref();
+			continue;
+		}
+
+		RomData *const romData = RomDataFactory::create(file,
+			RomDataFactory::RDA_HAS_THUMBNAIL | RomDataFactory::RDA_EXT_HINT | RomDataFactory::RDA_NEG_CACHE);
+		file->unref();	// file is ref()'d by RomData.
+		if (!romData) {
+			// File is not supported.
+			stats.files_unsupported++;
+			continue;
+		}
+		stats.bytes_read += static_cast<uint64_t>(sb.st_size);
+
+		for (unsigned int j = 0; j < ARRAY_SIZE(pregen_sizes); j++) {
+			const string &thumb_filename = thumb_filenames[j];
+			if (thumb_filename.empty())
+				continue;
+
+			PregenCreateThumbnail::GetThumbnailOutParams_t outParams;
+			int ret = d.getThumbnail(romData, pregen_sizes[j], &outParams);
+			if (ret != 0 || !d.isImgClassValid(outParams.retImg)) {
+				// No image.
+				d.freeImgClass(outParams.retImg);
+				stats.thumbs_failed++;
+				continue;
+			}
+
+			// Make sure the thumbnail directory exists.
+			FileSystem::rmkdir(thumb_filename);
+
+			char tmp_suffix[32];
+			snprintf(tmp_suffix, sizeof(tmp_suffix), ".rpcli-%d-%u.tmp", (int)getpid(), static_cast<unsigned int>(i));
+			ret = saveThumbnail(romData, outParams, uri, sb, thumb_filename + tmp_suffix, thumb_filename);
+			d.freeImgClass(outParams.retImg);
+			if (ret == 0) {
+				stats.thumbs_created++;
+			} else {
+				printError(state, rp_sprintf_p(C_("rpcli", "Couldn't create file '%1$s': %2$s"),
+					thumb_filename.c_str(), strerror(-ret)));
+				stats.thumbs_failed++;
+			}
+		}
+
+		romData->unref();
+	}
+
+	MutexLocker locker(state->statsMutex);
+	state->stats += stats;
+}
+
+/**
+ * Pre-generate thumbnails for all files in a directory tree.
+ *
+ * Thumbnails are written to the XDG thumbnail cache in the standard
+ * sizes: normal (128px), large (256px), and x-large (512px).
+ * Files whose cached thumbnails are still valid are skipped.
+ *
+ * Statistics are printed to stderr when done.
+ *
+ * @param path		[in] Directory to scan.
+ * @param threadCount	[in] Number of worker threads. (0 for the number of CPUs)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int PregenThumbnails(const char *path, unsigned int threadCount)
+{
+	assert(path != nullptr);
+	if (!path || path[0] == '\0')
+		return -EINVAL;
+
+	// Thumbnail URIs must use absolute paths.
+	char *const abspath = realpath(path, nullptr);
+	if (!abspath) {
+		const int err = errno;
+		cerr << "-- " << rp_sprintf_p(C_("rpcli", "Couldn't open directory '%1$s': %2$s"),
+			path, strerror(err)) << endl;
+		return -err;
+	}
+
+	cerr << "== " << rp_sprintf(C_("rpcli", "Scanning directory '%s'..."), abspath) << endl;
+	const uint64_t start_ns = rp_monotonic_ns();
+	unique_ptr<PregenState> state(new PregenState());
+	int ret = recursiveScan(abspath, state->files);
+	if (ret != 0) {
+		cerr << "-- " << rp_sprintf_p(C_("rpcli", "Couldn't open directory '%1$s': %2$s"),
+			abspath, strerror(-ret)) << endl;
+		free(abspath);
+		return ret;
+	}
+	free(abspath);
+
+	// Thumbnails are created in batches, and most of the
+	// rp_images are freed right away, so use pooled image storage.
+	if (!rp_image::backendCreatorFn()) {
+		rp_image::setBackendCreatorFn(rp_image_backend_pooled::creator_fn);
+	}
+
+	// Use the process-wide thread pool unless a
+	// specific number of threads was requested.
+	// NOTE: The calling thread also creates thumbnails.
+	unique_ptr<ThreadPool> localPool;
+	ThreadPool *pool;
+	if (threadCount == 0) {
+		pool = ThreadPool::instance();
+		threadCount = pool->threadCount() + 1;
+	} else {
+		if (threadCount > state->files.size()) {
+			threadCount = static_cast<unsigned int>(state->files.size());
+		}
+		if (threadCount > 1) {
+			localPool.reset(new ThreadPool(threadCount - 1));
+			threadCount = localPool->threadCount() + 1;
+		}
+		pool = localPool.get();
+	}
+	if (threadCount > state->files.size()) {
+		threadCount = static_cast<unsigned int>(state->files.size());
+	}
+	cerr << "-- " << rp_sprintf_p(C_("rpcli", "Generating thumbnails for %1$u file(s) using %2$u thread(s)..."),
+		static_cast<unsigned int>(state->files.size()), threadCount) << endl;
+
+	if (pool) {
+		pool->parallelFor(0, state->files.size(), pregenRangeFunc, state.get());
+	} else {
+		pregenRangeFunc(state.get(), 0, state->files.size());
+	}
+	const PregenStats &stats = state->stats;
+
+	// Print statistics.
+	const uint64_t elapsed_ns = rp_monotonic_ns() - start_ns;
+	const double elapsed_s = static_cast<double>(elapsed_ns) / 1000000000.0;
+	cerr << "-- " << rp_sprintf(C_("rpcli", "Files processed: %u"), stats.files_done) << endl;
+	cerr << "-- " << rp_sprintf(C_("rpcli", "Thumbnails created: %u"), stats.thumbs_created) << endl;
+	cerr << "-- " << rp_sprintf(C_("rpcli", "Thumbnails skipped (still valid): %u"), stats.thumbs_fresh) << endl;
+	cerr << "-- " << rp_sprintf(C_("rpcli", "Thumbnails failed: %u"), stats.thumbs_failed) << endl;
+	cerr << "-- " << rp_sprintf(C_("rpcli", "Unsupported files: %u"), stats.files_unsupported) << endl;
+	cerr << "-- " << rp_sprintf(C_("rpcli", "Elapsed time: %.3f s"), elapsed_s) << endl;
+	if (elapsed_s > 0) {
+		cerr << "-- " << rp_sprintf_p(C_("rpcli", "Throughput: %1$.1f files/s, %2$.1f thumbnails/s, %3$.1f MiB/s"),
+			stats.files_done / elapsed_s,
+			stats.thumbs_created / elapsed_s,
+			(static_cast<double>(stats.bytes_read) / (1024.0*1024.0)) / elapsed_s) << endl;
+	}
+	return 0;
+}
+
+#endif /* RPCLI_HAS_PREGEN */
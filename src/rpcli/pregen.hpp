@@ -0,0 +1,36 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * pregen.hpp: Pre-generate thumbnails for a directory tree.               *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RPCLI_PREGEN_HPP__
+#define __ROMPROPERTIES_RPCLI_PREGEN_HPP__
+
+// NOTE: Only the XDG thumbnail cache is supported.
+#ifndef _WIN32
+# define RPCLI_HAS_PREGEN 1
+#endif /* !_WIN32 */
+
+#ifdef RPCLI_HAS_PREGEN
+
+/**
+ * Pre-generate thumbnails for all files in a directory tree.
+ *
+ * Thumbnails are written to the XDG thumbnail cache in the standard
+ * sizes: normal (128px), large (256px), and x-large (512px).
+ * Files whose cached thumbnails are still valid are skipped.
+ *
+ * Statistics are printed to stderr when done.
+ *
+ * @param path		[in] Directory to scan.
+ * @param threadCount	[in] Number of worker threads. (0 for the number of CPUs)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int PregenThumbnails(const char *path, unsigned int threadCount = 0);
+
+#endif /* RPCLI_HAS_PREGEN */
+
+#endif /* __ROMPROPERTIES_RPCLI_PREGEN_HPP__ */
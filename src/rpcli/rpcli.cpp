@@ -17,11 +17,14 @@
 #include "librpcpu/byteswap_rp.h"
 #include "librpbase/config.librpbase.h"
 #include "librpbase/RomData.hpp"
+#include "librpbase/RomMetaData.hpp"
 #include "librpbase/SystemRegion.hpp"
 #include "librpbase/TextFuncs.hpp"
+#include "librpbase/monotonic_time.h"
 #include "librpbase/img/RpPng.hpp"
 #include "librpbase/img/IconAnimData.hpp"
 #include "librpbase/TextOut.hpp"
+#include "librpbase/config/Config.hpp"
 #include "libi18n/i18n.h"
 using namespace LibRpBase;
 
@@ -29,16 +32,25 @@ using namespace LibRpBase;
 #include "librpfile/config.librpfile.h"
 #include "librpfile/FileSystem.hpp"
 #include "librpfile/RpFile.hpp"
+#include "librpfile/RpTrace.hpp"
 using namespace LibRpFile;
 
 // libromdata
 #include "libromdata/RomDataFactory.hpp"
+#include "libromdata/img/CacheManager.hpp"
+#include "libromdata/utils/RomChecksum.hpp"
+using LibRomData::CacheManager;
+using LibRomData::RomChecksum;
 using LibRomData::RomDataFactory;
 
 // librptexture
 #include "librptexture/img/rp_image.hpp"
 using LibRpTexture::rp_image;
 
+// librpthreads
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::ThreadPool;
+
 #ifdef _WIN32
 #  include "libwin32common/RpWin32_sdk.h"
 #  include "librptexture/img/GdiplusHelper.hpp"
@@ -46,8 +58,13 @@ using LibRpTexture::rp_image;
 
 #ifdef ENABLE_DECRYPTION
 # include "verifykeys.hpp"
+# include "hashfile.hpp"
 #endif /* ENABLE_DECRYPTION */
 #include "device.hpp"
+#include "ndjson.hpp"
+#include "pregen.hpp"
+#include "prefetch.hpp"
+#include "timing.hpp"
 
 // OS-specific userdirs
 #ifdef _WIN32
@@ -70,14 +87,19 @@ using LibRpTexture::rp_image;
 #include <fstream>
 #include <iostream>
 #include <locale>
+#include <sstream>
 #include <string>
 #include <vector>
+using std::cin;
 using std::cout;
 using std::cerr;
 using std::endl;
 using std::locale;
 using std::ofstream;
+using std::ostream;
+using std::ostringstream;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 #include "libi18n/config.libi18n.h"
@@ -91,69 +113,177 @@ DELAYLOAD_TEST_FUNCTION_IMPL1(textdomain, nullptr);
 
 struct ExtractParam {
 	const char* filename;	// Target filename. Can be null due to argv[argc]
-	int image_type;		// Image Type. -1 = iconAnimData, MUST be between -1 and IMG_INT_MAX
+	int image_type;		// Image Type. -1 = iconAnimData, -2 = all images (filename is a pattern)
+				// Otherwise, MUST be between IMG_INT_MIN and IMG_INT_MAX
 
 	ExtractParam(const char *filename, int image_type)
 		: filename(filename), image_type(image_type) { }
 };
 
+// ExtractParam image_type values for special cases.
+#define EXTRACT_ANIMATED_ICON	-1
+#define EXTRACT_ALL_IMAGES	-2
+
+/**
+ * Image extraction job.
+ * The images are decoded by the main thread, since RomData
+ * isn't thread-safe, and are then encoded by worker threads.
+ */
+struct ExtractJob {
+	string filename;			// Target filename
+	const char *imageTypeName;		// Image type name, or nullptr for the animated icon
+	const rp_image *image;			// Image to save (nullptr if animated icon)
+	const IconAnimData *iconAnimData;	// Animated icon to save (nullptr if image)
+	int errcode;				// Result
+	bool apngFallback;			// True if APNG isn't supported, so only the first frame was saved
+
+	ExtractJob(const string &filename, const char *imageTypeName,
+		const rp_image *image, const IconAnimData *iconAnimData)
+		: filename(filename), imageTypeName(imageTypeName)
+		, image(image), iconAnimData(iconAnimData)
+		, errcode(0), apngFallback(false) { }
+};
+
+/**
+ * Shared state for the image extraction worker threads.
+ */
+/**
+ * Image extraction range function for ThreadPool::parallelFor().
+ * @param param ExtractJob vector
+ * @param begin First job index
+ * @param end One past the last job index
+ */
+static void extractRangeFunc(void *param, size_t begin, size_t end)
+{
+	vector<ExtractJob> *const jobs = static_cast<vector<ExtractJob>*>(param);
+	for (size_t i = begin; i < end; i++) {
+		ExtractJob &job = (*jobs)[i];
+		if (job.image) {
+			job.errcode = RpPng::save(job.filename.c_str(), job.image);
+			continue;
+		}
+
+		const IconAnimData *const iconAnimData = job.iconAnimData;
+		job.errcode = RpPng::save(job.filename.c_str(), iconAnimData);
+		if (job.errcode == -ENOTSUP) {
+			// Falling back to outputting the first frame.
+			job.apngFallback = true;
+			job.errcode = RpPng::save(job.filename.c_str(),
+				iconAnimData->frame(iconAnimData->seq_index[0]));
+		}
+	}
+}
+
+/**
+ * Expand an image extraction filename pattern.
+ * - %t: Image type number.
+ * - %m: Image size number. (0 is the default size; mipmaps start at 1)
+ * - %%: Literal '%'.
+ * @param pattern	[in] Filename pattern.
+ * @param imageType	[in] Image type.
+ * @param sizeIdx	[in] Image size number.
+ * @return Filename.
+ */
+static string ExpandExtractPattern(const char *pattern, int imageType, unsigned int sizeIdx)
+{
+	string filename;
+	for (const char *p = pattern; *p != '\0'; p++) {
+		if (*p != '%') {
+			filename += *p;
+			continue;
+		}
+
+		switch (p[1]) {
+			case 't':
+				filename += std::to_string(imageType);
+				p++;
+				break;
+			case 'm':
+				filename += std::to_string(sizeIdx);
+				p++;
+				break;
+			case '%':
+				filename += '%';
+				p++;
+				break;
+			default:
+				filename += '%';
+				break;
+		}
+	}
+	return filename;
+}
+
 /**
 * Extracts images from romdata
 * @param romData RomData containing the images
 * @param extract Vector of image extraction parameters
 */
 static void ExtractImages(const RomData *romData, vector<ExtractParam>& extract) {
-	int supported = romData->supportedImageTypes();
+	const uint32_t supported = romData->supportedImageTypes();
+
+	// Decode the images first.
+	vector<ExtractJob> jobs;
 	const auto extract_cend = extract.cend();
 	for (auto it = extract.cbegin(); it != extract_cend; ++it) {
 		if (!it->filename) continue;
 		bool found = false;
-		
+
+		if (it->image_type == EXTRACT_ALL_IMAGES) {
+			// All internal images, including all image sizes.
+			for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
+				if (!(supported & (1U << i)))
+					continue;
+
+				const RomData::ImageType imageType = (RomData::ImageType)i;
+				const char *const imageTypeName = RomData::getImageTypeName(imageType);
+				auto image = romData->image(imageType);
+				if (image && image->isValid()) {
+					found = true;
+					jobs.emplace_back(ExpandExtractPattern(it->filename, i, 0), imageTypeName, image, nullptr);
+				}
+
+				// Additional image sizes, e.g. mipmaps.
+				const vector<RomData::ImageSizeDef> sizeDefs = romData->supportedImageSizes(imageType);
+				for (size_t j = 1; j < sizeDefs.size(); j++) {
+					const rp_image *sizeImage = nullptr;
+					int ret = const_cast<RomData*>(romData)->loadInternalImageSize(imageType, sizeDefs[j].index, &sizeImage);
+					if (ret == 0 && sizeImage && sizeImage->isValid()) {
+						found = true;
+						jobs.emplace_back(ExpandExtractPattern(it->filename, i, static_cast<unsigned int>(j)),
+							imageTypeName, sizeImage, nullptr);
+					}
+				}
+			}
+
+			if (!found) {
+				cerr << "-- " << C_("rpcli", "No internal images found") << endl;
+			}
+			continue;
+		}
+
 		if (it->image_type >= 0 && supported & (1U << it->image_type)) {
 			// normal image
 			auto image = romData->image((RomData::ImageType)it->image_type);
 			if (image && image->isValid()) {
 				found = true;
-				cerr << "-- " <<
-					// tr: %1$s == image type name, %2$s == output filename
-					rp_sprintf_p(C_("rpcli", "Extracting %1$s into '%2$s'"),
-						RomData::getImageTypeName((RomData::ImageType)it->image_type),
-						it->filename) << endl;
-				int errcode = RpPng::save(it->filename, image);
-				if (errcode != 0) {
-					// tr: %1$s == filename, %2%s == error message
-					cerr << rp_sprintf_p(C_("rpcli", "Couldn't create file '%1$s': %2$s"),
-						it->filename, strerror(-errcode)) << endl;
-				} else {
-					cerr << "   " << C_("rpcli", "Done") << endl;
-				}
+				jobs.emplace_back(it->filename,
+					RomData::getImageTypeName((RomData::ImageType)it->image_type),
+					image, nullptr);
 			}
 		}
 
-		else if (it->image_type == -1) {
+		else if (it->image_type == EXTRACT_ANIMATED_ICON) {
 			// iconAnimData image
 			auto iconAnimData = romData->iconAnimData();
 			if (iconAnimData && iconAnimData->count != 0 && iconAnimData->seq_count != 0) {
 				found = true;
-				cerr << "-- " << rp_sprintf(C_("rpcli", "Extracting animated icon into '%s'"), it->filename) << endl;
-				int errcode = RpPng::save(it->filename, iconAnimData);
-				if (errcode == -ENOTSUP) {
-					cerr << "   " << C_("rpcli", "APNG not supported, extracting only the first frame") << endl;
-					// falling back to outputting the first frame
-					errcode = RpPng::save(it->filename, iconAnimData->frames[iconAnimData->seq_index[0]]);
-				}
-				if (errcode != 0) {
-					cerr << "   " <<
-						rp_sprintf_p(C_("rpcli", "Couldn't create file '%1$s': %2$s"),
-							it->filename, strerror(-errcode)) << endl;
-				} else {
-					cerr << "   " << C_("rpcli", "Done") << endl;
-				}
+				jobs.emplace_back(it->filename, nullptr, nullptr, iconAnimData);
 			}
 		}
 		if (!found) {
 			// TODO: Return an error code?
-			if (it->image_type == -1) {
+			if (it->image_type == EXTRACT_ANIMATED_ICON) {
 				cerr << "-- " << C_("rpcli", "Animated icon not found") << endl;
 			} else {
 				cerr << "-- " <<
@@ -162,40 +292,170 @@ static void ExtractImages(const RomData *romData, vector<ExtractParam>& extract)
 			}
 		}
 	}
+	if (jobs.empty())
+		return;
+
+	// Encode the images using the thread pool.
+	ThreadPool::instance()->parallelFor(0, jobs.size(), extractRangeFunc, &jobs);
+
+	// Print the results in order.
+	for (const ExtractJob &job : jobs) {
+		if (job.imageTypeName) {
+			cerr << "-- " <<
+				// tr: %1$s == image type name, %2$s == output filename
+				rp_sprintf_p(C_("rpcli", "Extracting %1$s into '%2$s'"),
+					job.imageTypeName, job.filename.c_str()) << endl;
+		} else {
+			cerr << "-- " << rp_sprintf(C_("rpcli", "Extracting animated icon into '%s'"), job.filename.c_str()) << endl;
+			if (job.apngFallback) {
+				cerr << "   " << C_("rpcli", "APNG not supported, extracting only the first frame") << endl;
+			}
+		}
+
+		if (job.errcode != 0) {
+			// tr: %1$s == filename, %2%s == error message
+			cerr << "   " <<
+				rp_sprintf_p(C_("rpcli", "Couldn't create file '%1$s': %2$s"),
+					job.filename.c_str(), strerror(-job.errcode)) << endl;
+		} else {
+			cerr << "   " << C_("rpcli", "Done") << endl;
+		}
+	}
 }
 
 /**
  * Shows info about file
+ * @param os Output stream
  * @param filename ROM filename
  * @param json Is program running in json mode?
  * @param extract Vector of image extraction parameters
  * @param languageCode Language code. (0 for default)
+ * @param hash If true, calculate the file's hashes.
+ * @param compact If true, use compact JSON output.
+ * @param timing If true, print per-stage timings and I/O statistics.
+ * @param filter Output filter, or nullptr to print everything.
  */
-static void DoFile(const char *filename, bool json, vector<ExtractParam>& extract, uint32_t languageCode = 0)
+static void DoFile(ostream &os, const char *filename, bool json, vector<ExtractParam>& extract, uint32_t languageCode = 0, bool hash = false, bool compact = false, bool timing = false, const RomOutputFilter *filter = nullptr)
 {
 	cerr << "== " << rp_sprintf(C_("rpcli", "Reading file '%s'..."), filename) << endl;
-	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	FileTimings timings;
+	uint64_t ts_start = rp_monotonic_ns();
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ_MMAP);
+	timings.open_ns = rp_monotonic_ns() - ts_start;
+	StatsFile *statsFile = nullptr;
 	if (file->isOpen()) {
-		RomData *romData = RomDataFactory::create(file);
+		RomHashes hashes;
+		const RomHashes *pHashes = nullptr;
+#ifdef ENABLE_DECRYPTION
+		if (hash) {
+			cerr << "-- " << C_("rpcli", "Calculating hashes") << endl;
+			const int err = HashFile(filename, hashes);
+			if (err != 0) {
+				cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't calculate hashes: %s"), strerror(-err)) << endl;
+			}
+			pHashes = &hashes;
+		}
+#else /* !ENABLE_DECRYPTION */
+		RP_UNUSED(hash);
+#endif /* ENABLE_DECRYPTION */
+
+		RomData *romData;
+		if (timing) {
+			// Count reads and seeks by the RomData subclass.
+			// Detection statistics are used to separate
+			// detection from construction.
+			statsFile = new StatsFile(file);
+			uint64_t ctor_ns_before, ctor_ns_after;
+			RomDataFactory::getDetectStatsTotals(nullptr, &ctor_ns_before);
+			ts_start = rp_monotonic_ns();
+			romData = RomDataFactory::create(statsFile);
+			const uint64_t create_ns = rp_monotonic_ns() - ts_start;
+			RomDataFactory::getDetectStatsTotals(nullptr, &ctor_ns_after);
+			timings.ctor_ns = ctor_ns_after - ctor_ns_before;
+			timings.detect_ns = (create_ns > timings.ctor_ns) ? (create_ns - timings.ctor_ns) : 0;
+		} else {
+			romData = RomDataFactory::create(file);
+		}
+
 		if (romData && romData->isValid()) {
+			if (timing) {
+				// Load the fields, images, and external URLs
+				// before printing so they can be timed separately.
+				// NOTE: Images aren't printed if a filter is set.
+				ts_start = rp_monotonic_ns();
+				romData->fields();
+				timings.fields_ns = rp_monotonic_ns() - ts_start;
+
+				const uint32_t imgbf = (!filter ? romData->supportedImageTypes() : 0);
+				ts_start = rp_monotonic_ns();
+				for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
+					if (imgbf & (1U << i)) {
+						romData->image((RomData::ImageType)i);
+					}
+				}
+				timings.images_ns = rp_monotonic_ns() - ts_start;
+
+				vector<RomData::ExtURL> extURLs;
+				ts_start = rp_monotonic_ns();
+				for (int i = RomData::IMG_EXT_MIN; i <= RomData::IMG_EXT_MAX; i++) {
+					if (imgbf & (1U << i)) {
+						extURLs.clear();
+						romData->extURLs((RomData::ImageType)i, &extURLs, RomData::IMAGE_SIZE_DEFAULT);
+					}
+				}
+				timings.exturls_ns = rp_monotonic_ns() - ts_start;
+			}
+
+			ts_start = rp_monotonic_ns();
 			if (json) {
 				cerr << "-- " << C_("rpcli", "Outputting JSON data") << endl;
-				cout << JSONROMOutput(romData, languageCode) << endl;
+				JSONROMOutput jsonOut(romData, languageCode);
+				jsonOut.setHashes(pHashes);
+				jsonOut.setCompact(compact);
+				jsonOut.setFilter(filter);
+				os << jsonOut << endl;
 			} else {
-				cout << ROMOutput(romData, languageCode) << endl;
+				ROMOutput romOut(romData, languageCode);
+				romOut.setFilter(filter);
+				os << romOut << endl;
+#ifdef ENABLE_DECRYPTION
+				if (pHashes) {
+					PrintHashes(os, *pHashes);
+					os << endl;
+				}
+#endif /* ENABLE_DECRYPTION */
 			}
+			os.flush();
+			timings.output_ns = rp_monotonic_ns() - ts_start;
 
 			ExtractImages(romData, extract);
 		} else {
 			cerr << "-- " << C_("rpcli", "ROM is not supported") << endl;
-			if (json) cout << "{\"error\":\"rom is not supported\"}" << endl;
+#ifdef ENABLE_DECRYPTION
+			if (pHashes) {
+				// Hashes are still useful for unsupported files.
+				if (json) {
+					const string members = HashesToJSONMembers(*pHashes);
+					os << "{\"error\":\"rom is not supported\"" <<
+						(members.empty() ? "" : ",") << members << '}' << endl;
+				} else {
+					PrintHashes(os, *pHashes);
+				}
+			} else
+#endif /* ENABLE_DECRYPTION */
+			if (json) os << "{\"error\":\"rom is not supported\"}" << endl;
 		}
 
 		UNREF(romData);
 	} else {
 		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(file->lastError())) << endl;
-		if (json) cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
+		if (json) os << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
 	}
+
+	if (timing) {
+		PrintTimings(cerr, timings, statsFile);
+	}
+	UNREF(statsFile);
 	file->unref();
 }
 
@@ -261,7 +521,7 @@ static void PrintPathnames(void)
 static void DoScsiInquiry(const char *filename, bool json)
 {
 	cerr << "== " << rp_sprintf(C_("rpcli", "Opening device file '%s'..."), filename) << endl;
-	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ_MMAP);
 	if (file->isOpen()) {
 		// TODO: Check for unsupported devices? (Only CD-ROM is supported.)
 		if (file->isDevice()) {
@@ -292,7 +552,7 @@ static void DoScsiInquiry(const char *filename, bool json)
 static void DoAtaIdentifyDevice(const char *filename, bool json, bool packet)
 {
 	cerr << "== " << rp_sprintf(C_("rpcli", "Opening device file '%s'..."), filename) << endl;
-	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ_MMAP);
 	if (file->isOpen()) {
 		// TODO: Check for unsupported devices? (Only CD-ROM is supported.)
 		if (file->isDevice()) {
@@ -315,14 +575,229 @@ static void DoAtaIdentifyDevice(const char *filename, bool json, bool packet)
 }
 #endif /* RP_OS_SCSI_SUPPORTED */
 
+/**
+ * Parse a language code.
+ * @param s_lang	[in] Language code string, e.g. "en" or "pt_BR"
+ * @param pLc		[out] Language code
+ * @return True if the language code is valid; false if not.
+ */
+static bool ParseLanguageCode(const char *s_lang, uint32_t *pLc)
+{
+	if (!s_lang)
+		return false;
+
+	uint32_t lc = 0;
+	int pos;
+	for (pos = 0; pos < 4 && s_lang[pos] != '\0'; pos++) {
+		lc <<= 8;
+		lc |= (uint8_t)s_lang[pos];
+	}
+	if (pos == 4 && s_lang[pos] != '\0') {
+		// Invalid language code.
+		return false;
+	}
+
+	*pLc = lc;
+	return true;
+}
+
+/**
+ * Parse a comma-separated list of field names and/or
+ * metadata property names for an output filter.
+ * @param s_list	[in] Comma-separated list
+ * @param meta		[in] If true, the list contains metadata property names.
+ * @param filter	[in/out] Output filter
+ */
+static void ParseOutputFilter(const char *s_list, bool meta, RomOutputFilter &filter)
+{
+	if (!s_list)
+		return;
+
+	const char *start = s_list;
+	do {
+		const char *comma = strchr(start, ',');
+		if (!comma) {
+			comma = start + strlen(start);
+		}
+		if (comma > start) {
+			string name(start, comma - start);
+			if (!meta) {
+				filter.fields.emplace_back(std::move(name));
+			} else {
+				const Property prop = RomMetaData::getPropertyByName(name.c_str());
+				if (prop == Property::Invalid) {
+					cerr << rp_sprintf(C_("rpcli", "Warning: skipping unknown metadata property '%s'"), name.c_str()) << endl;
+				} else {
+					filter.metaData.emplace_back(prop);
+				}
+			}
+		}
+		start = (*comma != '\0' ? comma + 1 : nullptr);
+	} while (start);
+}
+
+/**
+ * Run in server mode.
+ *
+ * Requests are read from stdin, one per line. Each request consists
+ * of options and a filename, separated by tab characters:
+ *
+ *   [-j|-jc]\t[-H]\t[-T]\t[-l\tlang]\t[-f\tfields]\t[-m\tprops]\t[-xN\toutfile]...\t[-a\toutfile]\t[-X\tpattern]\tfilename
+ *
+ * Each response is written to stdout as a line containing the size
+ * of the output in bytes, followed by the output itself, i.e. the
+ * same output that rpcli would print for the file.
+ *
+ * The process's state (configuration, encryption keys, etc.) is kept
+ * between requests. Server mode exits when stdin is closed.
+ */
+static void DoServer(void)
+{
+	cerr << "-- " << C_("rpcli", "Server mode: reading requests from stdin") << endl;
+
+	string line;
+	vector<string> args;
+	vector<ExtractParam> extract;
+	while (std::getline(cin, line)) {
+		if (!line.empty() && line[line.size()-1] == '\r') {
+			line.resize(line.size()-1);
+		}
+
+		// Split the request into arguments.
+		args.clear();
+		size_t start = 0;
+		do {
+			size_t tab = line.find('\t', start);
+			if (tab == string::npos) {
+				tab = line.size();
+			}
+			if (tab > start) {
+				args.emplace_back(line, start, tab - start);
+			}
+			start = tab + 1;
+		} while (start <= line.size());
+
+		// Parse the options.
+		bool json = false, compact = false, hash = false, timing = false;
+		uint32_t languageCode = 0;
+		const char *filename = nullptr;
+		RomOutputFilter filter;
+		extract.clear();
+		const size_t argc = args.size();
+		for (size_t i = 0; i < argc; i++) {
+			const char *const arg = args[i].c_str();
+			if (arg[0] != '-') {
+				filename = arg;
+				continue;
+			}
+
+			switch (arg[1]) {
+				case 'j':
+					json = true;
+					compact = (arg[2] == 'c');
+					break;
+				case 'H':
+					hash = true;
+					break;
+				case 'T':
+					timing = true;
+					RomDataFactory::setDetectStatsEnabled(true);
+					break;
+				case 'V':
+					RomChecksum::setForceEnabled(true);
+					break;
+				case 'l': {
+					const char *const s_lang = (arg[2] == '\0')
+						? (i + 1 < argc ? args[++i].c_str() : nullptr)
+						: &arg[2];
+					if (!ParseLanguageCode(s_lang, &languageCode)) {
+						cerr << rp_sprintf(C_("rpcli", "Warning: ignoring invalid language code '%s'"),
+							(s_lang ? s_lang : "")) << endl;
+					}
+					break;
+				}
+				case 'f':
+				case 'm':
+					ParseOutputFilter(i + 1 < argc ? args[++i].c_str() : nullptr, (arg[1] == 'm'), filter);
+					break;
+				case 'x': {
+					const long num = atol(arg + 2);
+					const char *const outfile = (i + 1 < argc ? args[++i].c_str() : nullptr);
+					if (num < RomData::IMG_INT_MIN || num > RomData::IMG_INT_MAX) {
+						cerr << rp_sprintf(C_("rpcli", "Warning: skipping unknown image type %ld"), num) << endl;
+						break;
+					}
+					extract.emplace_back(ExtractParam(outfile, num));
+					break;
+				}
+				case 'a':
+					extract.emplace_back(ExtractParam(i + 1 < argc ? args[++i].c_str() : nullptr, EXTRACT_ANIMATED_ICON));
+					break;
+				case 'X':
+					extract.emplace_back(ExtractParam(i + 1 < argc ? args[++i].c_str() : nullptr, EXTRACT_ALL_IMAGES));
+					break;
+				default:
+					cerr << rp_sprintf(C_("rpcli", "Warning: skipping unknown switch '%c'"), arg[1]) << endl;
+					break;
+			}
+		}
+
+		ostringstream oss;
+		if (filename) {
+			const bool hasFilter = (!filter.fields.empty() || !filter.metaData.empty());
+			DoFile(oss, filename, json, extract, languageCode, hash, compact, timing,
+				(hasFilter ? &filter : nullptr));
+		} else {
+			cerr << "-- " << C_("rpcli", "No filename specified") << endl;
+			if (json) {
+				oss << "{\"error\":\"no filename specified\"}" << endl;
+			}
+		}
+
+		// Write the response.
+		const string out = oss.str();
+		cout << out.size() << '\n';
+		cout.write(out.data(), out.size());
+		cout.flush();
+	}
+}
+
+/**
+ * Get the process-wide thread pool size from the configuration.
+ * Called by ThreadPool::instance() on first use.
+ * @return Thread pool size. (0 for the number of CPUs)
+ */
+static unsigned int ConfigThreadPoolSize(void)
+{
+	return Config::instance()->threadPoolSize();
+}
+
 int RP_C_API main(int argc, char *argv[])
 {
 	// Enable security options.
-	rpcli_do_security_options();
+	// NOTE: Prefetching external images (-D) runs rp-download,
+	// which would inherit rpcli's syscall filter and be unable
+	// to access the network. rp-download enables its own security
+	// options, so rpcli's aren't needed in this case.
+	bool prefetchMode = false;
+	for (int i = 1; i < argc; i++) {
+		if (argv[i][0] == '-' && argv[i][1] == 'D') {
+			prefetchMode = true;
+			break;
+		}
+	}
+	if (!prefetchMode) {
+		rpcli_do_security_options();
+	}
 
 	// Set the C and C++ locales.
 	locale::global(locale(""));
 
+	// Register the trace provider. (Windows only)
+	// The process exits without unloading, so it
+	// doesn't need to be unregistered.
+	rp_trace_register();
+
 #if defined(_MSC_VER) && defined(ENABLE_NLS)
 	// Delay load verification.
 	// TODO: Only if linked with /DELAYLOAD?
@@ -344,18 +819,42 @@ int RP_C_API main(int argc, char *argv[])
 
 	if(argc < 2){
 #ifdef ENABLE_DECRYPTION
-		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-j[c]] [-H] [-T] [-V] [-l lang] [-f fields] [-m props] [[-x[b]N outfile]... [-a apngoutfile] [-X pattern] filename]...") << endl;
 		cerr << "  -k:   " << C_("rpcli", "Verify encryption keys in keys.conf.") << endl;
 #else /* !ENABLE_DECRYPTION */
-		cerr << C_("rpcli", "Usage: rpcli [-c] [-p] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-c] [-p] [-j[c]] [-T] [-V] [-l lang] [-f fields] [-m props] [[-x[b]N outfile]... [-a apngoutfile] [-X pattern] filename]...") << endl;
 #endif /* ENABLE_DECRYPTION */
 		cerr << "  -c:   " << C_("rpcli", "Print system region information.") << endl;
 		cerr << "  -p:   " << C_("rpcli", "Print system path information.") << endl;
 		cerr << "  -j:   " << C_("rpcli", "Use JSON output format.") << endl;
+		cerr << "  -jc:  " << C_("rpcli", "Use compact JSON output format.") << endl;
+		cerr << "  -J[o][N]:  " << C_("rpcli", "Print all following files in NDJSON format using N threads. ('o' keeps the original order)") << endl;
+#ifdef ENABLE_DECRYPTION
+		cerr << "  -H:   " << C_("rpcli", "Calculate CRC32, MD5, and SHA-1 hashes of each file.") << endl;
+#endif /* ENABLE_DECRYPTION */
+		cerr << "  -T:   " << C_("rpcli", "Print per-stage timings and I/O statistics for each file.") << endl;
+		cerr << "  -V:   " << C_("rpcli", "Verify full ROM checksums. (reads the entire ROM image)") << endl;
 		cerr << "  -l:   " << C_("rpcli", "Retrieve the specified language from the ROM image.") << endl;
+		cerr << "  -f:   " << C_("rpcli", "Only print the specified fields. (comma-separated)") << endl;
+		cerr << "  -m:   " << C_("rpcli", "Only print the specified metadata properties. (comma-separated)") << endl;
 		cerr << "  -xN:  " << C_("rpcli", "Extract image N to outfile in PNG format.") << endl;
 		cerr << "  -a:   " << C_("rpcli", "Extract the animated icon to outfile in APNG format.") << endl;
+		cerr << "  -X:   " << C_("rpcli", "Extract all internal images and mipmaps in PNG format.") << endl;
+		cerr << "        " << C_("rpcli", "The output filename pattern may contain %t (image type) and %m (mipmap level).") << endl;
+		cerr << endl;
+		cerr << C_("rpcli", "Download cache maintenance:") << endl;
+		cerr << "  -C[N]:  " << C_("rpcli", "Compact the download cache to N MiB. (default is MaxCacheSize)") << endl;
+		cerr << "  -D:     " << C_("rpcli", "Download external images for all following files into the cache.") << endl;
 		cerr << endl;
+		cerr << C_("rpcli", "Server mode:") << endl;
+		cerr << "  -S:  " << C_("rpcli", "Read tab-separated requests (options and filename) from stdin.") << endl;
+		cerr << "       " << C_("rpcli", "Each response is its size in bytes on one line, followed by the output.") << endl;
+		cerr << endl;
+#ifdef RPCLI_HAS_PREGEN
+		cerr << C_("rpcli", "Thumbnail cache pre-generation:") << endl;
+		cerr << "  -t[N] dir:  " << C_("rpcli", "Create thumbnails for all files in dir using N threads.") << endl;
+		cerr << endl;
+#endif /* RPCLI_HAS_PREGEN */
 #ifdef RP_OS_SCSI_SUPPORTED
 		cerr << C_("rpcli", "Special options for devices:") << endl;
 		cerr << "  -is:   " << C_("rpcli", "Run a SCSI INQUIRY command.") << endl;
@@ -370,14 +869,22 @@ int RP_C_API main(int argc, char *argv[])
 		cerr << "\t " << C_("rpcli", "extracts icon from pokeb2.nds") << endl;
 	}
 	
+	// Size the process-wide thread pool from the configuration.
+	// NOTE: Config is only loaded if the pool is actually used.
+	ThreadPool::setDefaultThreadCountFunc(ConfigThreadPoolSize);
+
 	assert(RomData::IMG_INT_MIN == 0);
 	// DoFile parameters
 	bool json = false;
+	bool compact = false;
 	vector<ExtractParam> extract;
 
 	for (int i = 1; i < argc; i++) { // figure out the json mode in advance
 		if (argv[i][0] == '-' && argv[i][1] == 'j') {
 			json = true;
+			if (argv[i][2] == 'c') {
+				compact = true;
+			}
 		}
 	}
 	if (json) cout << "[\n";
@@ -398,6 +905,15 @@ int RP_C_API main(int argc, char *argv[])
 	bool inq_ata_packet = false;
 #endif /* RP_OS_SCSI_SUPPORTED */
 	uint32_t languageCode = 0;
+	RomOutputFilter filter;
+	bool hash = false;
+	bool timing = false;
+	bool prefetch = false;
+	vector<string> prefetchKeys;
+	bool ndjson = false;
+	bool ndjsonOrdered = false;
+	long ndjsonThreads = 0;
+	vector<string> ndjsonFiles;
 	bool first = true;
 	int ret = 0;
 	for (int i = 1; i < argc; i++){
@@ -413,7 +929,20 @@ int RP_C_API main(int argc, char *argv[])
 				}
 				break;
 			}
+			case 'H':
+				// Calculate hashes of all files after this option.
+				hash = true;
+				break;
 #endif /* ENABLE_DECRYPTION */
+			case 'T':
+				// Print timings for all files after this option.
+				timing = true;
+				RomDataFactory::setDetectStatsEnabled(true);
+				break;
+			case 'V':
+				// Verify full ROM checksums for all files after this option.
+				RomChecksum::setForceEnabled(true);
+				break;
 			case 'c':
 				// Print the system region information.
 				PrintSystemRegion();
@@ -440,12 +969,7 @@ int RP_C_API main(int argc, char *argv[])
 
 				// Parse the language code.
 				uint32_t lc = 0;
-				int pos;
-				for (pos = 0; pos < 4 && s_lang[pos] != '\0'; pos++) {
-					lc <<= 8;
-					lc |= (uint8_t)s_lang[pos];
-				}
-				if (pos == 4 && s_lang[pos] != '\0') {
+				if (!ParseLanguageCode(s_lang, &lc)) {
 					// Invalid language code.
 					cerr << rp_sprintf(C_("rpcli", "Warning: ignoring invalid language code '%s'"), s_lang) << endl;
 					break;
@@ -455,6 +979,20 @@ int RP_C_API main(int argc, char *argv[])
 				languageCode = lc;
 				break;
 			}
+			case 'f':
+			case 'm': {
+				// Output filter for all files after this option.
+				// NOTE: Field names and property names may be
+				// immediately after the option, or they might be
+				// a completely separate argument.
+				const bool meta = (argv[i][1] == 'm');
+				if (argv[i][2] != '\0') {
+					ParseOutputFilter(&argv[i][2], meta, filter);
+				} else if (i + 1 < argc) {
+					ParseOutputFilter(argv[++i], meta, filter);
+				}
+				break;
+			}
 			case 'x': {
 				long num = atol(argv[i] + 2);
 				if (num<RomData::IMG_INT_MIN || num>RomData::IMG_INT_MAX) {
@@ -465,10 +1003,80 @@ int RP_C_API main(int argc, char *argv[])
 				break;
 			}
 			case 'a':
-				extract.emplace_back(ExtractParam(argv[++i], -1));
+				extract.emplace_back(ExtractParam(argv[++i], EXTRACT_ANIMATED_ICON));
+				break;
+			case 'X':
+				// Extract all internal images using a filename pattern.
+				extract.emplace_back(ExtractParam(argv[++i], EXTRACT_ALL_IMAGES));
 				break;
 			case 'j': // do nothing
 				break;
+			case 'D':
+				// Prefetch external images for all files after this option.
+				prefetch = true;
+				break;
+			case 'S':
+				// Server mode.
+				DoServer();
+				break;
+			case 'J': {
+				// NDJSON output for all files after this option.
+				// NOTE: Thread count is optional. (0 == number of CPUs)
+				const char *s_opt = &argv[i][2];
+				if (*s_opt == 'o') {
+					ndjsonOrdered = true;
+					s_opt++;
+				}
+				const long threads = atol(s_opt);
+				if (threads < 0 || threads > 256) {
+					cerr << rp_sprintf(C_("rpcli", "Warning: skipping invalid thread count %ld"), threads) << endl;
+					break;
+				}
+				ndjson = true;
+				ndjsonThreads = threads;
+				break;
+			}
+			case 'C': {
+				// Compact the download cache.
+				// NOTE: Maximum size is optional. (0 == MaxCacheSize)
+				const long maxSizeMiB = atol(argv[i] + 2);
+				if (maxSizeMiB < 0) {
+					cerr << rp_sprintf(C_("rpcli", "Warning: skipping invalid cache size %ld"), maxSizeMiB) << endl;
+					break;
+				}
+				const int evicted = CacheManager::compactCache(
+					static_cast<off64_t>(maxSizeMiB) * 1024 * 1024, true);
+				if (evicted < 0) {
+					cerr << rp_sprintf(C_("rpcli", "Error compacting the download cache: %s"), strerror(-evicted)) << endl;
+					ret = evicted;
+				} else {
+					cerr << rp_sprintf(NC_("rpcli",
+						"Deleted %d file from the download cache.",
+						"Deleted %d files from the download cache.",
+						evicted), evicted) << endl;
+				}
+				break;
+			}
+#ifdef RPCLI_HAS_PREGEN
+			case 't': {
+				// Pre-generate thumbnails for a directory tree.
+				// NOTE: Thread count is optional. (0 == number of CPUs)
+				const long threads = atol(argv[i] + 2);
+				if (threads < 0 || threads > 256) {
+					cerr << rp_sprintf(C_("rpcli", "Warning: skipping invalid thread count %ld"), threads) << endl;
+					i++; continue;
+				}
+				if (i + 1 >= argc) {
+					cerr << C_("rpcli", "Warning: no directory specified for '-t'") << endl;
+					break;
+				}
+				const int pgRet = PregenThumbnails(argv[++i], static_cast<unsigned int>(threads));
+				if (pgRet != 0) {
+					ret = pgRet;
+				}
+				break;
+			}
+#endif /* RPCLI_HAS_PREGEN */
 #ifdef RP_OS_SCSI_SUPPORTED
 			case 'i':
 				// These commands take precedence over the usual rpcli functionality.
@@ -499,6 +1107,17 @@ int RP_C_API main(int argc, char *argv[])
 				cerr << rp_sprintf(C_("rpcli", "Warning: skipping unknown switch '%c'"), argv[i][1]) << endl;
 				break;
 			}
+		} else if (ndjson) {
+			// Files will be processed after all arguments are parsed.
+			ndjsonFiles.emplace_back(argv[i]);
+		} else if (prefetch) {
+			// Get the external image cache keys.
+			// The images will be downloaded after all files are processed.
+			cerr << "== " << rp_sprintf(C_("rpcli", "Reading file '%s'..."), argv[i]) << endl;
+			const int pfRet = GetExtImageCacheKeys(argv[i], prefetchKeys);
+			if (pfRet != 0) {
+				cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't get external images: %s"), strerror(-pfRet)) << endl;
+			}
 		} else {
 			if (first) first = false;
 			else if (json) cout << "," << endl;
@@ -518,7 +1137,9 @@ int RP_C_API main(int argc, char *argv[])
 #endif /* RP_OS_SCSI_SUPPORTED */
 			{
 				// Regular file.
-				DoFile(argv[i], json, extract, languageCode);
+				const bool hasFilter = (!filter.fields.empty() || !filter.metaData.empty());
+				DoFile(cout, argv[i], json, extract, languageCode, hash, compact, timing,
+					(hasFilter ? &filter : nullptr));
 			}
 
 #ifdef RP_OS_SCSI_SUPPORTED
@@ -531,6 +1152,25 @@ int RP_C_API main(int argc, char *argv[])
 	}
 	if (json) cout << "]\n";
 
+	if (!ndjsonFiles.empty()) {
+		// Print the NDJSON data.
+		const bool hasFilter = (!filter.fields.empty() || !filter.metaData.empty());
+		const int ndRet = DoFilesNDJSON(ndjsonFiles,
+			static_cast<unsigned int>(ndjsonThreads), ndjsonOrdered, languageCode,
+			(hasFilter ? &filter : nullptr));
+		if (ndRet != 0) {
+			ret = ndRet;
+		}
+	}
+
+	if (!prefetchKeys.empty()) {
+		// Download the external images.
+		const int pfRet = PrefetchExtImages(prefetchKeys);
+		if (pfRet != 0) {
+			ret = pfRet;
+		}
+	}
+
 #ifdef _WIN32
 	// Shut down GDI+.
 	GdiplusHelper::ShutdownGDIPlus(gdipToken);
@@ -29,15 +29,19 @@ int rpcli_do_security_options(void)
 		SCMP_SYS(close),
 		SCMP_SYS(dup),		// gzdopen()
 		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
+		SCMP_SYS(flock),	// CachePack::append(), compact()
 		SCMP_SYS(fstat),     SCMP_SYS(fstat64),		// __GI___fxstat() [printf()]
 		SCMP_SYS(fstatat64), SCMP_SYS(newfstatat),	// Ubuntu 19.10 (32-bit)
 		SCMP_SYS(ftruncate),	// LibRpBase::RpFile::truncate() [from LibRpBase::RpPngWriterPrivate::init()]
 		SCMP_SYS(ftruncate64),
 		SCMP_SYS(futex),
+		SCMP_SYS(getdents), SCMP_SYS(getdents64),	// opendir() [CacheManager::compactCache()]
 		SCMP_SYS(gettimeofday),	// 32-bit only?
 		SCMP_SYS(ioctl),	// for devices; also afl-fuzz
 		SCMP_SYS(lseek), SCMP_SYS(_llseek),
 		SCMP_SYS(lstat), SCMP_SYS(lstat64),	// LibRpBase::FileSystem::is_symlink(), resolve_symlink()
+		SCMP_SYS(madvise),	// LibRpFile::RpFile::adviseAccess() [FM_MMAP]
+		SCMP_SYS(mkdir), SCMP_SYS(mkdirat),	// LibUnixCommon::getConfigDirectory() [Config], FileSystem::rmkdir() [pregen]
 		SCMP_SYS(mmap), SCMP_SYS(mmap2),
 		SCMP_SYS(mprotect),	// dlopen()
 		SCMP_SYS(munmap),
@@ -48,12 +52,29 @@ int rpcli_do_security_options(void)
 #elif defined(__NR_openat2)
 		__NR_openat2,		// Linux 5.6
 #endif /* __SNR_openat2 || __NR_openat2 */
+		SCMP_SYS(fadvise64), SCMP_SYS(fadvise64_64),	// LibRpFile::RpFile::adviseAccess()
+		SCMP_SYS(pread64), SCMP_SYS(preadv),	// LibRpFile::RpFile::readAt(), readBatch()
+		SCMP_SYS(pwrite64),	// CachePack::append()
 		SCMP_SYS(readlink),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
+		SCMP_SYS(rename), SCMP_SYS(renameat),	// pregen: saveThumbnail()
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),	// glibc-2.28+ on architectures without renameat()
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(getpid),	// pregen: temporary thumbnail filenames
+		SCMP_SYS(statfs), SCMP_SYS(statfs64),	// LibRpFile::FileSystem::isOnBadFS() [FM_MMAP]
 
 		// KeyManager (keys.conf)
 		SCMP_SYS(access),	// LibUnixCommon::isWritableDirectory()
 		SCMP_SYS(stat), SCMP_SYS(stat64),	// LibUnixCommon::isWritableDirectory()
+		SCMP_SYS(unlink),	// CacheManager::compactCache(), packCacheFile()
 
+		// Config (rom-properties.conf)
+		// NOTE: Config is created on first use, after the sandbox is enabled.
+		SCMP_SYS(inotify_init1), SCMP_SYS(inotify_add_watch),	// LibRpBase::ConfWatcher
+
+#if defined(__SNR_io_uring_setup) || defined(__NR_io_uring_setup)
+		SCMP_SYS(io_uring_setup), SCMP_SYS(io_uring_enter),	// LibRpFile::IoUring
+#endif /* __SNR_io_uring_setup || __NR_io_uring_setup */
 #if defined(__SNR_statx) || defined(__NR_statx)
 		SCMP_SYS(getcwd),	// called by glibc's statx()
 		SCMP_SYS(statx),
@@ -91,5 +112,7 @@ int rpcli_do_security_options(void)
 	param.dummy = 0;
 #endif
 
-	return rp_secure_enable(param);
+	// rpcli uses the process-wide thread pool for image extraction (-x),
+	// NDJSON output (-J), and thumbnail pregeneration (-t).
+	return rp_secure_enable_ex(param, RP_SECURE_PROFILE_PARALLEL);
 }
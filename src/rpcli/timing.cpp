@@ -0,0 +1,275 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * timing.cpp: Per-stage timing and I/O statistics.                        *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "timing.hpp"
+
+// librpbase
+#include "librpbase/TextFuncs.hpp"
+#include "libi18n/i18n.h"
+using namespace LibRpBase;
+using LibRpFile::IRpFile;
+
+// C includes. (C++ namespace)
+#include <cerrno>
+
+// C++ includes.
+#include <string>
+using std::endl;
+using std::ostream;
+using std::string;
+
+/** StatsFile **/
+
+/**
+ * Create a StatsFile.
+ * The underlying file is ref()'d.
+ * @param file Underlying file.
+ */
+StatsFile::StatsFile(IRpFile *file)
+	: super()
+	, m_file(nullptr)
+	, m_bytesRead(0)
+	, m_reads(0)
+	, m_seeks(0)
+{
+	assert(file != nullptr);
+	if (!file) {
+		m_lastError = EBADF;
+		return;
+	}
+
+	m_file = file->ref();
+	m_isCompressed = file->isCompressed();
+	m_fileType = static_cast<uint8_t>(file->fileType());
+	m_lastError = file->lastError();
+}
+
+StatsFile::~StatsFile()
+{
+	UNREF(m_file);
+}
+
+/**
+ * Close the file.
+ */
+void StatsFile::close(void)
+{
+	UNREF_AND_NULL(m_file);
+}
+
+/**
+ * Read data from the file.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t StatsFile::read(void *ptr, size_t size)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	const size_t ret = m_file->read(ptr, size);
+	m_lastError = m_file->lastError();
+	m_bytesRead += ret;
+	m_reads++;
+	return ret;
+}
+
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t StatsFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	const size_t ret = m_file->readAt(pos, ptr, size);
+	m_lastError = m_file->lastError();
+	m_bytesRead += ret;
+	m_reads++;
+	return ret;
+}
+
+/**
+ * Read multiple ranges from the file.
+ * @param reqs	[in,out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read in full.
+ */
+size_t StatsFile::readBatch(const ReadRequest *reqs, size_t count)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	const size_t ret = m_file->readBatch(reqs, count);
+	m_lastError = m_file->lastError();
+	for (size_t i = 0; i < ret; i++) {
+		m_bytesRead += reqs[i].size;
+	}
+	m_reads += static_cast<unsigned int>(count);
+	return ret;
+}
+
+/**
+ * Get a pointer to file data without copying it.
+ * @param pos	[in] File position.
+ * @param size	[in] Amount of data, in bytes.
+ * @return Pointer to the data, or nullptr if not supported or out of range.
+ */
+const uint8_t *StatsFile::peek(off64_t pos, size_t size)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return nullptr;
+	}
+
+	const uint8_t *const ret = m_file->peek(pos, size);
+	if (ret) {
+		m_bytesRead += size;
+		m_reads++;
+	}
+	return ret;
+}
+
+/**
+ * Write data to the file.
+ * (NOTE: Not valid for StatsFile; this will always return 0.)
+ * @param ptr Input data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes written.
+ */
+size_t StatsFile::write(const void *ptr, size_t size)
+{
+	// Not a valid operation for StatsFile.
+	RP_UNUSED(ptr);
+	RP_UNUSED(size);
+	m_lastError = EBADF;
+	return 0;
+}
+
+/**
+ * Set the file position.
+ * @param pos File position.
+ * @return 0 on success; -1 on error.
+ */
+int StatsFile::seek(off64_t pos)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+
+	const int ret = m_file->seek(pos);
+	m_lastError = m_file->lastError();
+	m_seeks++;
+	return ret;
+}
+
+/**
+ * Get the file position.
+ * @return File position, or -1 on error.
+ */
+off64_t StatsFile::tell(void)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+	return m_file->tell();
+}
+
+/**
+ * Advise the OS of the expected access pattern.
+ * This is forwarded to the underlying file.
+ * @param pattern	[in] Access pattern.
+ * @param offset	[in] Starting offset.
+ * @param len		[in] Length, or 0 for the rest of the file.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int StatsFile::adviseAccess(AccessPattern pattern, off64_t offset, off64_t len)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -EBADF;
+	}
+	return m_file->adviseAccess(pattern, offset, len);
+}
+
+/**
+ * Get the file size.
+ * @return File size, or negative on error.
+ */
+off64_t StatsFile::size(void)
+{
+	if (!m_file) {
+		m_lastError = EBADF;
+		return -1;
+	}
+	return m_file->size();
+}
+
+/**
+ * Get the filename.
+ * @return Filename. (May be empty if the filename is not available.)
+ */
+string StatsFile::filename(void) const
+{
+	return (m_file ? m_file->filename() : string());
+}
+
+/** Timings **/
+
+/**
+ * Print a single timing value.
+ * @param os	[in] Output stream.
+ * @param name	[in] Stage name.
+ * @param ns	[in] Time, in nanoseconds.
+ */
+static void printTiming(ostream &os, const char *name, uint64_t ns)
+{
+	os << rp_sprintf("   %-20s %10.3f ms", name, static_cast<double>(ns) / 1000000.0) << endl;
+}
+
+/**
+ * Print per-stage timings and I/O statistics for a file.
+ * @param os		[in] Output stream.
+ * @param timings	[in] Timings.
+ * @param statsFile	[in,opt] StatsFile, or nullptr if the file couldn't be opened.
+ */
+void PrintTimings(ostream &os, const FileTimings &timings, const StatsFile *statsFile)
+{
+	os << "-- " << C_("rpcli", "Timings:") << endl;
+	printTiming(os, C_("rpcli", "Open"), timings.open_ns);
+	printTiming(os, C_("rpcli", "Detection"), timings.detect_ns);
+	printTiming(os, C_("rpcli", "Construction"), timings.ctor_ns);
+	printTiming(os, C_("rpcli", "Fields"), timings.fields_ns);
+	printTiming(os, C_("rpcli", "Internal images"), timings.images_ns);
+	printTiming(os, C_("rpcli", "External URLs"), timings.exturls_ns);
+	printTiming(os, C_("rpcli", "Output"), timings.output_ns);
+	printTiming(os, C_("rpcli", "Total"), timings.open_ns + timings.detect_ns +
+		timings.ctor_ns + timings.fields_ns + timings.images_ns +
+		timings.exturls_ns + timings.output_ns);
+
+	if (statsFile) {
+		os << "-- " << rp_sprintf_p(C_("rpcli", "I/O: %1$llu byte(s) read in %2$u read(s), %3$u seek(s)"),
+			static_cast<unsigned long long>(statsFile->bytesRead()),
+			statsFile->reads(), statsFile->seeks()) << endl;
+	}
+}
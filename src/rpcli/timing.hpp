@@ -0,0 +1,112 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * timing.hpp: Per-stage timing and I/O statistics.                        *
+ *                                                                         *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RPCLI_TIMING_HPP__
+#define __ROMPROPERTIES_RPCLI_TIMING_HPP__
+
+#include "librpfile/IRpFile.hpp"
+
+// C includes.
+#include <stdint.h>
+
+// C++ includes.
+#include <ostream>
+
+/**
+ * IRpFile wrapper that counts reads and seeks.
+ * All operations are forwarded to the underlying file.
+ */
+class StatsFile final : public LibRpFile::IRpFile
+{
+	public:
+		/**
+		 * Create a StatsFile.
+		 * The underlying file is ref()'d.
+		 * @param file Underlying file.
+		 */
+		explicit StatsFile(LibRpFile::IRpFile *file);
+	protected:
+		virtual ~StatsFile();	// call unref() instead
+
+	private:
+		typedef LibRpFile::IRpFile super;
+		RP_DISABLE_COPY(StatsFile)
+
+	public:
+		bool isOpen(void) const final
+		{
+			return (m_file != nullptr && m_file->isOpen());
+		}
+
+		void close(void) final;
+
+		ATTR_ACCESS_SIZE(write_only, 2, 3)
+		size_t read(void *ptr, size_t size) final;
+
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
+		size_t readBatch(const ReadRequest *reqs, size_t count) final;
+
+		const uint8_t *peek(off64_t pos, size_t size) final;
+
+		ATTR_ACCESS_SIZE(read_only, 2, 3)
+		size_t write(const void *ptr, size_t size) final;
+
+		int seek(off64_t pos) final;
+
+		off64_t tell(void) final;
+
+		int adviseAccess(AccessPattern pattern, off64_t offset = 0, off64_t len = 0) final;
+
+		off64_t size(void) final;
+
+		std::string filename(void) const final;
+
+	public:
+		/** Statistics **/
+
+		uint64_t bytesRead(void) const { return m_bytesRead; }
+		unsigned int reads(void) const { return m_reads; }
+		unsigned int seeks(void) const { return m_seeks; }
+
+	private:
+		LibRpFile::IRpFile *m_file;
+		uint64_t m_bytesRead;	// Bytes read, including peek()
+		unsigned int m_reads;	// Read operations
+		unsigned int m_seeks;	// seek() calls
+};
+
+/**
+ * Per-stage timings for a single file, in nanoseconds.
+ */
+struct FileTimings {
+	uint64_t open_ns;	// Opening the file
+	uint64_t detect_ns;	// RomDataFactory detection
+	uint64_t ctor_ns;	// RomData construction
+	uint64_t fields_ns;	// loadFieldData()
+	uint64_t images_ns;	// Internal images
+	uint64_t exturls_ns;	// External image URLs
+	uint64_t output_ns;	// Output
+
+	FileTimings()
+		: open_ns(0), detect_ns(0), ctor_ns(0)
+		, fields_ns(0), images_ns(0), exturls_ns(0)
+		, output_ns(0)
+	{ }
+};
+
+/**
+ * Print per-stage timings and I/O statistics for a file.
+ * @param os		[in] Output stream.
+ * @param timings	[in] Timings.
+ * @param statsFile	[in,opt] StatsFile, or nullptr if the file couldn't be opened.
+ */
+void PrintTimings(std::ostream &os, const FileTimings &timings, const StatsFile *statsFile);
+
+#endif /* __ROMPROPERTIES_RPCLI_TIMING_HPP__ */
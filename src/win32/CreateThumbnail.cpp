@@ -10,12 +10,22 @@
 #include "CreateThumbnail.hpp"
 #include "RpImageWin32.hpp"
 
-// librptexture
+// librpbase, librpfile, librptexture
+#include "librpfile/FileSystem.hpp"
 #include "librptexture/img/RpGdiplusBackend.hpp"
+using LibRpBase::RomData;
+using namespace LibRpFile;
 using namespace LibRpTexture;
 
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
 // C++ STL classes.
+using std::list;
 using std::string;
+using std::unordered_map;
 
 // TCreateThumbnail is a templated class,
 // so we have to #include the .cpp file here.
@@ -202,3 +212,225 @@ HBITMAP CreateThumbnailNoAlpha::rescaleImgClass(const HBITMAP &imgClass, const I
 	img->unref();
 	return hbmp;
 }
+
+/** Process-wide thumbnail cache **/
+
+namespace {
+
+/**
+ * Thumbnail cache.
+ * Entries are kept in most-recently-used order.
+ */
+class ThumbnailCache
+{
+	public:
+		ThumbnailCache()
+			: totalBytes(0)
+		{ }
+
+		~ThumbnailCache()
+		{
+			for (Entry &entry : lru) {
+				DeleteBitmap(entry.outParams.retImg);
+			}
+		}
+
+	private:
+		RP_DISABLE_COPY(ThumbnailCache)
+
+	public:
+		struct Entry {
+			string key;
+			CreateThumbnail::GetThumbnailOutParams_t outParams;
+			size_t bytes;
+		};
+
+		list<Entry> lru;
+		unordered_map<string, list<Entry>::iterator> map;
+		size_t totalBytes;
+		Mutex mutex;
+};
+
+ThumbnailCache thumbnailCache;
+
+/**
+ * Copy an HBITMAP.
+ * @param hbmp HBITMAP
+ * @return Copy of the HBITMAP, or nullptr on error.
+ */
+inline HBITMAP copyHBITMAP(HBITMAP hbmp)
+{
+	// LR_CREATEDIBSECTION preserves the alpha channel.
+	return static_cast<HBITMAP>(CopyImage(hbmp, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION));
+}
+
+}
+
+/**
+ * Get the thumbnail cache key for a file.
+ * @param filename	[in] Filename (UTF-8)
+ * @param reqSize	[in] Requested image size.
+ * @param pKey		[out] Cache key.
+ * @return True on success; false if the file can't be cached.
+ */
+bool CreateThumbnail::getThumbnailCacheKey(const string &filename, int reqSize, string *pKey) const
+{
+	if (filename.empty())
+		return false;
+
+	// The file identity includes the size and mtime,
+	// so modified files won't match the cached entry.
+	FileSystem::FileIdentity id;
+	if (FileSystem::get_file_identity(filename, &id) != 0)
+		return false;
+
+	char buf[128];
+	snprintf(buf, sizeof(buf), "|%llx|%llx|%llx|%llx|%d|%d",
+		static_cast<unsigned long long>(id.device),
+		static_cast<unsigned long long>(id.inode),
+		static_cast<unsigned long long>(id.size),
+		static_cast<unsigned long long>(id.mtime_ns),
+		reqSize, (usesAlpha() ? 1 : 0));
+	pKey->reserve(filename.size() + strlen(buf));
+	*pKey = filename;
+	pKey->append(buf);
+	return true;
+}
+
+/**
+ * Look up a thumbnail in the thumbnail cache.
+ * @param key		[in] Cache key.
+ * @param pOutParams	[out] Output parameters. (retImg is a copy of the cached HBITMAP)
+ * @return True if found; false if not.
+ */
+bool CreateThumbnail::lookupThumbnailCache(const string &key, GetThumbnailOutParams_t *pOutParams)
+{
+	MutexLocker mutexLocker(thumbnailCache.mutex);
+	auto iter = thumbnailCache.map.find(key);
+	if (iter == thumbnailCache.map.end())
+		return false;
+
+	HBITMAP hbmp = copyHBITMAP(iter->second->outParams.retImg);
+	if (!hbmp)
+		return false;
+
+	// Move the entry to the front of the list.
+	thumbnailCache.lru.splice(thumbnailCache.lru.begin(), thumbnailCache.lru, iter->second);
+	*pOutParams = iter->second->outParams;
+	pOutParams->retImg = hbmp;
+	return true;
+}
+
+/**
+ * Add a thumbnail to the thumbnail cache.
+ * A copy of pOutParams->retImg is stored in the cache.
+ * @param key		[in] Cache key.
+ * @param outParams	[in] Output parameters.
+ */
+void CreateThumbnail::addThumbnailCache(const string &key, const GetThumbnailOutParams_t &outParams)
+{
+	// Thumbnails are 32-bit DIBs.
+	const size_t bytes = static_cast<size_t>(outParams.thumbSize.width) *
+		static_cast<size_t>(outParams.thumbSize.height) * 4;
+	if (bytes == 0 || bytes > THUMBNAIL_CACHE_MAX_BYTES / 4) {
+		// Don't cache empty or very large thumbnails.
+		return;
+	}
+
+	HBITMAP hbmp = copyHBITMAP(outParams.retImg);
+	if (!hbmp)
+		return;
+
+	MutexLocker mutexLocker(thumbnailCache.mutex);
+	if (thumbnailCache.map.find(key) != thumbnailCache.map.end()) {
+		// Another thread already added this thumbnail.
+		DeleteBitmap(hbmp);
+		return;
+	}
+
+	// Evict the least-recently-used entries if necessary.
+	while (!thumbnailCache.lru.empty() &&
+	       thumbnailCache.totalBytes + bytes > THUMBNAIL_CACHE_MAX_BYTES)
+	{
+		ThumbnailCache::Entry &old = thumbnailCache.lru.back();
+		DeleteBitmap(old.outParams.retImg);
+		thumbnailCache.totalBytes -= old.bytes;
+		thumbnailCache.map.erase(old.key);
+		thumbnailCache.lru.pop_back();
+	}
+
+	thumbnailCache.lru.emplace_front();
+	ThumbnailCache::Entry &entry = thumbnailCache.lru.front();
+	entry.key = key;
+	entry.outParams = outParams;
+	entry.outParams.retImg = hbmp;
+	entry.bytes = bytes;
+	thumbnailCache.totalBytes += bytes;
+	thumbnailCache.map.emplace(key, thumbnailCache.lru.begin());
+}
+
+/**
+ * Create a thumbnail for the specified ROM file,
+ * using the process-wide thumbnail cache.
+ *
+ * Explorer often requests the same file at several sizes,
+ * or requests it again when switching view modes. Converted
+ * thumbnails are cached by filename, file identity, and
+ * requested size, up to THUMBNAIL_CACHE_MAX_BYTES.
+ *
+ * NOTE: pOutParams->retImg is always a new HBITMAP that
+ * must be freed by the caller.
+ *
+ * @param filename	[in] Filename (UTF-8) for the cache key. (If empty, the cache isn't used.)
+ * @param romData	[in] RomData object.
+ * @param reqSize	[in] Requested image size. (single dimension; assuming square image)
+ * @param pOutParams	[out] Output parameters.
+ * @return 0 on success; non-zero on error.
+ */
+int CreateThumbnail::getThumbnailCached(const string &filename, const RomData *romData,
+	int reqSize, GetThumbnailOutParams_t *pOutParams)
+{
+	string key;
+	const bool canCache = getThumbnailCacheKey(filename, reqSize, &key);
+	if (canCache && lookupThumbnailCache(key, pOutParams)) {
+		// Found in the cache.
+		return 0;
+	}
+
+	int ret = getThumbnail(romData, reqSize, pOutParams);
+	if (ret == 0 && pOutParams->retImg && canCache) {
+		addThumbnailCache(key, *pOutParams);
+	}
+	return ret;
+}
+
+/**
+ * Create a thumbnail for the specified ROM file,
+ * using the process-wide thumbnail cache.
+ *
+ * The cache key uses the file's filename. If the filename
+ * isn't available, the cache isn't used.
+ *
+ * NOTE: pOutParams->retImg is always a new HBITMAP that
+ * must be freed by the caller.
+ *
+ * @param file		[in] Open IRpFile object.
+ * @param reqSize	[in] Requested image size. (single dimension; assuming square image)
+ * @param pOutParams	[out] Output parameters.
+ * @return 0 on success; non-zero on error.
+ */
+int CreateThumbnail::getThumbnailCached(IRpFile *file, int reqSize, GetThumbnailOutParams_t *pOutParams)
+{
+	string key;
+	const bool canCache = getThumbnailCacheKey(file->filename(), reqSize, &key);
+	if (canCache && lookupThumbnailCache(key, pOutParams)) {
+		// Found in the cache.
+		return 0;
+	}
+
+	int ret = getThumbnail(file, reqSize, pOutParams);
+	if (ret == 0 && pOutParams->retImg && canCache) {
+		addThumbnailCache(key, *pOutParams);
+	}
+	return ret;
+}
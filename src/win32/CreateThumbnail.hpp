@@ -91,6 +91,87 @@ class CreateThumbnail : public LibRomData::TCreateThumbnail<HBITMAP>
 			((void)url);
 			return std::string();
 		}
+
+	protected:
+		/**
+		 * Does this thumbnailer use alpha transparency?
+		 * Used as part of the thumbnail cache key.
+		 * @return True if alpha transparency is used; false if not.
+		 */
+		virtual bool usesAlpha(void) const
+		{
+			return true;
+		}
+
+	public:
+		/** Process-wide thumbnail cache **/
+
+		/**
+		 * Create a thumbnail for the specified ROM file,
+		 * using the process-wide thumbnail cache.
+		 *
+		 * Explorer often requests the same file at several sizes,
+		 * or requests it again when switching view modes. Converted
+		 * thumbnails are cached by filename, file identity, and
+		 * requested size, up to THUMBNAIL_CACHE_MAX_BYTES.
+		 *
+		 * NOTE: pOutParams->retImg is always a new HBITMAP that
+		 * must be freed by the caller.
+		 *
+		 * @param filename	[in] Filename (UTF-8) for the cache key. (If empty, the cache isn't used.)
+		 * @param romData	[in] RomData object.
+		 * @param reqSize	[in] Requested image size. (single dimension; assuming square image)
+		 * @param pOutParams	[out] Output parameters.
+		 * @return 0 on success; non-zero on error.
+		 */
+		int getThumbnailCached(const std::string &filename, const LibRpBase::RomData *romData,
+			int reqSize, GetThumbnailOutParams_t *pOutParams);
+
+		/**
+		 * Create a thumbnail for the specified ROM file,
+		 * using the process-wide thumbnail cache.
+		 *
+		 * The cache key uses the file's filename. If the filename
+		 * isn't available, the cache isn't used.
+		 *
+		 * NOTE: pOutParams->retImg is always a new HBITMAP that
+		 * must be freed by the caller.
+		 *
+		 * @param file		[in] Open IRpFile object.
+		 * @param reqSize	[in] Requested image size. (single dimension; assuming square image)
+		 * @param pOutParams	[out] Output parameters.
+		 * @return 0 on success; non-zero on error.
+		 */
+		int getThumbnailCached(LibRpFile::IRpFile *file, int reqSize, GetThumbnailOutParams_t *pOutParams);
+
+		// Maximum amount of bitmap data to keep in the thumbnail cache.
+		static const size_t THUMBNAIL_CACHE_MAX_BYTES = 32U*1024U*1024U;
+
+	private:
+		/**
+		 * Get the thumbnail cache key for a file.
+		 * @param filename	[in] Filename (UTF-8)
+		 * @param reqSize	[in] Requested image size.
+		 * @param pKey		[out] Cache key.
+		 * @return True on success; false if the file can't be cached.
+		 */
+		bool getThumbnailCacheKey(const std::string &filename, int reqSize, std::string *pKey) const;
+
+		/**
+		 * Look up a thumbnail in the thumbnail cache.
+		 * @param key		[in] Cache key.
+		 * @param pOutParams	[out] Output parameters. (retImg is a copy of the cached HBITMAP)
+		 * @return True if found; false if not.
+		 */
+		static bool lookupThumbnailCache(const std::string &key, GetThumbnailOutParams_t *pOutParams);
+
+		/**
+		 * Add a thumbnail to the thumbnail cache.
+		 * A copy of pOutParams->retImg is stored in the cache.
+		 * @param key		[in] Cache key.
+		 * @param outParams	[in] Output parameters.
+		 */
+		static void addThumbnailCache(const std::string &key, const GetThumbnailOutParams_t &outParams);
 };
 
 /**
@@ -125,6 +206,17 @@ class CreateThumbnailNoAlpha final : public CreateThumbnail
 		 * @return Rescaled ImgClass.
 		 */
 		HBITMAP rescaleImgClass(const HBITMAP &imgClass, const ImgSize &sz, ScalingMethod method = ScalingMethod::Nearest) const final;
+
+	protected:
+		/**
+		 * Does this thumbnailer use alpha transparency?
+		 * Used as part of the thumbnail cache key.
+		 * @return True if alpha transparency is used; false if not.
+		 */
+		bool usesAlpha(void) const final
+		{
+			return false;
+		}
 };
 
 #endif /* __ROMPROPERTIES_WIN32_CREATETHUMBNAIL_HPP__ */
@@ -56,6 +56,9 @@ static ULONG_PTR gdipToken = 0;
 #include "libromdata/RomDataFactory.hpp"
 using LibRomData::RomDataFactory;
 
+// librpfile
+#include "librpfile/RpTrace.hpp"
+
 // C++ STL classes.
 using std::list;
 using std::string;
@@ -111,6 +114,9 @@ BOOL WINAPI DllMain(HINSTANCE hInstance, DWORD dwReason, LPVOID /*lpReserved*/)
 			DisableThreadLibraryCalls(hInstance);
 #endif /* !defined(_MSC_VER) || defined(_DLL) */
 
+			// Register the ETW trace provider.
+			LibRpFile::rp_trace_register();
+
 			// Register RpGdiplusBackend and AchWin32.
 			rp_image::setBackendCreatorFn(RpGdiplusBackend::creator_fn);
 #if defined(ENABLE_ACHIEVEMENTS)
@@ -122,6 +128,7 @@ BOOL WINAPI DllMain(HINSTANCE hInstance, DWORD dwReason, LPVOID /*lpReserved*/)
 		case DLL_PROCESS_DETACH:
 			// DLL is being unloaded.
 			// TODO: Disable the COM server.
+			LibRpFile::rp_trace_unregister();
 			break;
 
 		default:
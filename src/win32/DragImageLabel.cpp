@@ -62,7 +62,7 @@ class DragImageLabelPrivate
 			HWND m_hwndParent;
 			const LibRpBase::IconAnimData *iconAnimData;
 			UINT_PTR animTimerID;
-			std::array<HBITMAP, LibRpBase::IconAnimData::MAX_FRAMES> iconFrames;
+			HBITMAP hbmpAtlas;		// Frame atlas. (See IconAnimData::atlas().)
 			LibRpBase::IconAnimHelper iconAnimHelper;
 			int last_frame_number;		// Last frame number.
 
@@ -70,18 +70,17 @@ class DragImageLabelPrivate
 				: m_hwndParent(hwndParent)
 				, iconAnimData(nullptr)
 				, animTimerID(0)
+				, hbmpAtlas(nullptr)
 				, last_frame_number(0)
-			{
-				iconFrames.fill(nullptr);
-			}
+			{ }
 			~anim_vars()
 			{
 				if (animTimerID) {
 					KillTimer(m_hwndParent, animTimerID);
 				}
-				std::for_each(iconFrames.cbegin(), iconFrames.cend(),
-					[](HBITMAP hbmp) { if (hbmp) { DeleteBitmap(hbmp); } }
-				);
+				if (hbmpAtlas) {
+					DeleteBitmap(hbmpAtlas);
+				}
 				UNREF(iconAnimData);
 			}
 		};
@@ -228,23 +227,26 @@ bool DragImageLabelPrivate::updateBitmaps(void)
 	if (anim && anim->iconAnimData) {
 		const IconAnimData *const iconAnimData = anim->iconAnimData;
 
-		// Convert the icons to HBITMAP using the window background color.
-		// TODO: Rescale the icon. (port rescaleImage())
-		for (int i = iconAnimData->count-1; i >= 0; i--) {
-			const rp_image *const frame = iconAnimData->frames[i];
-			if (frame && frame->isValid()) {
-				if (actualSize.cx == 0) {
-					// Get the icon size and rescale it, if necessary.
-					actualSize.cx = frame->width();
-					actualSize.cy = frame->height();
-					useNearestNeighbor = rescaleImage(requiredSize, actualSize);
-				}
-
-				// NOTE: Allowing NULL frames here...
-				anim->iconFrames[i] = RpImageWin32::toHBITMAP(frame, gdipBgColor, actualSize, useNearestNeighbor);
-			}
+		// Convert the frame atlas to a single HBITMAP using the window background color.
+		// Individual frames are drawn from the atlas in DragImageLabel::draw().
+		if (anim->hbmpAtlas) {
+			DeleteBitmap(anim->hbmpAtlas);
+			anim->hbmpAtlas = nullptr;
+		}
+		const rp_image *const atlas = iconAnimData->atlas();
+		if (!atlas) {
+			// No valid frames.
+			return false;
 		}
 
+		// Get the icon size and rescale it, if necessary.
+		actualSize.cx = iconAnimData->atlasFrameWidth();
+		actualSize.cy = atlas->height();
+		useNearestNeighbor = rescaleImage(requiredSize, actualSize);
+
+		const SIZE atlasSize = {actualSize.cx * iconAnimData->count, actualSize.cy};
+		anim->hbmpAtlas = RpImageWin32::toHBITMAP(atlas, gdipBgColor, atlasSize, useNearestNeighbor);
+
 		// Set up the IconAnimHelper.
 		anim->iconAnimHelper.setIconAnimData(iconAnimData);
 		if (anim->iconAnimHelper.isAnimated()) {
@@ -605,13 +607,22 @@ void DragImageLabel::resetAnimFrame(void)
 
 /**
  * Get the current bitmap frame.
+ * @param pSrcX	[out,opt] Source X position of the frame within the HBITMAP.
  * @return HBITMAP.
  */
-HBITMAP DragImageLabel::currentFrame(void) const
+HBITMAP DragImageLabel::currentFrame(int *pSrcX) const
 {
 	RP_D(const DragImageLabel);
 	if (d->anim && d->anim->iconAnimData) {
-		return d->anim->iconFrames[d->anim->last_frame_number];
+		// Animated icons use a frame atlas.
+		if (pSrcX) {
+			*pSrcX = d->anim->last_frame_number * d->actualSize.cx;
+		}
+		return d->anim->hbmpAtlas;
+	}
+
+	if (pSrcX) {
+		*pSrcX = 0;
 	}
 	return d->hbmpImg;
 }
@@ -622,7 +633,8 @@ HBITMAP DragImageLabel::currentFrame(void) const
  */
 void DragImageLabel::draw(HDC hdc)
 {
-	HBITMAP hbmp = currentFrame();
+	int srcX = 0;
+	HBITMAP hbmp = currentFrame(&srcX);
 	if (!hbmp) {
 		// Nothing to draw...
 		return;
@@ -635,7 +647,7 @@ void DragImageLabel::draw(HDC hdc)
 	SelectBitmap(hdcMem, hbmp);
 	BitBlt(hdc, d->position.x, d->position.y,
 		d->actualSize.cx, d->actualSize.cy,
-		hdcMem, 0, 0, SRCCOPY);
+		hdcMem, srcX, 0, SRCCOPY);
 
 	DeleteDC(hdcMem);
 }
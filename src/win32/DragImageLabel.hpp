@@ -107,9 +107,10 @@ class DragImageLabel
 	public:
 		/**
 		 * Get the current bitmap frame.
+		 * @param pSrcX	[out,opt] Source X position of the frame within the HBITMAP.
 		 * @return HBITMAP.
 		 */
-		HBITMAP currentFrame(void) const;
+		HBITMAP currentFrame(int *pSrcX = nullptr) const;
 
 		/**
 		 * Draw the image.
@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (Win32)                            *
  * LvData.hpp: ListView data internal implementation.                      *
  *                                                                         *
- * Copyright (c) 2016-2020 by David Korth.                                 *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -27,7 +27,8 @@
 // significantly more complexity.
 struct LvData {
 	std::vector<std::vector<std::tstring> > vvStr;	// String data.
-	std::vector<int> vImageList;			// ImageList indexes.
+	std::vector<int> vImageList;			// ImageList indexes. (ICON_NOT_LOADED if not loaded yet)
+	float iconFactor;				// Icon height scaling factor. (1.0f for no scaling)
 	uint32_t checkboxes;				// Checkboxes.
 	bool hasCheckboxes;				// True if checkboxes are valid.
 
@@ -44,12 +45,20 @@ struct LvData {
 
 	// For RFT_LISTDATA_MULTI only!
 	HWND hListView;
+	bool colWidthsSet;	// True if the column widths have been set.
+
+	// For RFT_LISTDATA_MULTI and RFT_LISTDATA_ICONS.
 	const LibRpBase::RomFields::Field *pField;
 
+	// vImageList value for icons that haven't been loaded yet.
+	enum { ICON_NOT_LOADED = -2 };
+
 	LvData()
-		: checkboxes(0), hasCheckboxes(false)
+		: iconFactor(1.0f)
+		, checkboxes(0), hasCheckboxes(false)
 		, col0sizeadj(0)
-		, hListView(nullptr), pField(nullptr) { }
+		, hListView(nullptr), colWidthsSet(false)
+		, pField(nullptr) { }
 
 public:
 	/** Strings **/
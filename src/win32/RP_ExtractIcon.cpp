@@ -115,7 +115,7 @@ IFACEMETHODIMP RP_ExtractIcon::Load(LPCOLESTR pszFileName, DWORD dwMode)
 
 	// Get the appropriate RomData class for this ROM.
 	// RomData class *must* support at least one image type.
-	d->romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+	d->romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL | RomDataFactory::RDA_CACHE);
 	file->unref();
 
 	// NOTE: Since this is the registered icon handler
@@ -214,7 +214,7 @@ IFACEMETHODIMP RP_ExtractIcon::Extract(LPCWSTR pszFile, UINT nIconIndex,
 	// TODO: Small icon?
 	CreateThumbnail::GetThumbnailOutParams_t outParams;
 	outParams.retImg = nullptr;
-	int ret = d->thumbnailer.getThumbnail(d->romData, LOWORD(nIconSize), &outParams);
+	int ret = d->thumbnailer.getThumbnailCached(d->filename, d->romData, LOWORD(nIconSize), &outParams);
 	if (ret != 0 || !outParams.retImg) {
 		// Thumbnail not available. Use the fallback.
 		if (outParams.retImg) {
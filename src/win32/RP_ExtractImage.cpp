@@ -120,7 +120,7 @@ IFACEMETHODIMP RP_ExtractImage::Load(LPCOLESTR pszFileName, DWORD dwMode)
 
 	// Get the appropriate RomData class for this ROM.
 	// RomData class *must* support at least one image type.
-	d->romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+	d->romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL | RomDataFactory::RDA_CACHE);
 	file->unref();
 
 	// NOTE: Since this is the registered image extractor
@@ -227,7 +227,7 @@ IFACEMETHODIMP RP_ExtractImage::Extract(HBITMAP *phBmpImage)
 	// NOTE: Using width only. (TODO: both width/height?)
 	CreateThumbnail::GetThumbnailOutParams_t outParams;
 	outParams.retImg = nullptr;
-	int ret = d->thumbnailer.getThumbnail(d->romData, d->rgSize.cx, &outParams);
+	int ret = d->thumbnailer.getThumbnailCached(d->filename, d->romData, d->rgSize.cx, &outParams);
 	if (ret != 0 || !outParams.retImg) {
 		// ROM is not supported. Use the fallback.
 		if (outParams.retImg) {
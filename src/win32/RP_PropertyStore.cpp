@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (Win32)                            *
  * RP_PropertyStore.cpp: IPropertyStore implementation.                    *
  *                                                                         *
- * Copyright (c) 2016-2020 by David Korth.                                 *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -156,7 +156,11 @@ RP_PropertyStore_Private::RP_PropertyStore_Private()
 	, pstream(nullptr)
 	, grfMode(0)
 	, romData(nullptr)
-{ }
+	, loaded(false)
+{
+	dimensions.cx = 0;
+	dimensions.cy = 0;
+}
 
 RP_PropertyStore_Private::~RP_PropertyStore_Private()
 {
@@ -165,11 +169,225 @@ RP_PropertyStore_Private::~RP_PropertyStore_Private()
 	// pstream is owned by file,
 	// so don't Release() it here.
 	UNREF(file);
+}
+
+/**
+ * Can this property store ever have a value for the specified key?
+ * This doesn't require loading the RomData object.
+ * @param key Property key.
+ * @return True if the key is handled; false if not.
+ */
+bool RP_PropertyStore_Private::isKeyHandled(REFPROPERTYKEY key)
+{
+	if (key == PKEY_Image_Dimensions)
+		return true;
+
+	for (const MetaDataConv &conv : metaDataConv) {
+		if (conv.pkey && *conv.pkey == key)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Is a RomMetaData property type compatible with a variant type?
+ * @param type RomMetaData property type.
+ * @param vtype Variant type.
+ * @return True if compatible; false if not.
+ */
+static bool isTypeCompatible(PropertyType type, LONG vtype)
+{
+	// FIXME: UIx should only accept PropertyType::UnsignedInteger,
+	// and Ix should only accept PropertyType::Integer.
+	switch (vtype) {
+		case VT_UI8: case VT_UI4: case VT_UI2: case VT_UI1:
+		case VT_I8:  case VT_I4:  case VT_I2:  case VT_I1:
+			return (type == PropertyType::Integer || type == PropertyType::UnsignedInteger);
+		case VT_BSTR:
+		case VT_VECTOR|VT_BSTR:
+			return (type == PropertyType::String);
+		case VT_DATE:
+			return (type == PropertyType::Timestamp);
+		default:
+			// TODO: Add support for multiple strings.
+			// FIXME: Not supported.
+			assert(!"Unsupported PROPVARIANT type.");
+			break;
+	}
+	return false;
+}
+
+/**
+ * Create the RomData object and index its metadata properties.
+ * Only the metadata is loaded; fields and images are not.
+ * Property values are converted in getValue().
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RP_PropertyStore_Private::load(void)
+{
+	if (loaded) {
+		// Already loaded.
+		return (romData ? 0 : -ENOENT);
+	}
+	loaded = true;
+
+	if (!file) {
+		// Initialize() wasn't called.
+		return -EBADF;
+	}
+
+	// Attempt to create a RomData object.
+	romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_METADATA | RomDataFactory::RDA_CACHE);
+	if (!romData) {
+		// No RomData.
+		return -ENOENT;
+	}
+
+	// Get the metadata properties.
+	const RomMetaData *const metaData = romData->metaData();
+	if (!metaData || metaData->empty()) {
+		// No metadata properties.
+		return 0;
+	}
+
+	// Index the metadata.
+	// TODO: Use IPropertyStoreCache?
+	// Reference: https://github.com/Microsoft/Windows-classic-samples/blob/master/Samples/Win7Samples/winui/shell/appshellintegration/RecipePropertyHandler/RecipePropertyHandler.cpp
+	const int count = metaData->count();
+	prop_key.reserve(count + 1);
+	prop_idx.reserve(count + 1);
+	for (int i = 0; i < count; i++) {
+		const RomMetaData::MetaData *const prop = metaData->prop(i);
+		assert(prop != nullptr);
+		if (!prop)
+			continue;
+
+		if (prop->name <= Property::Invalid || (int)prop->name >= ARRAY_SIZE(metaDataConv)) {
+			// FIXME: Should assert here, but Windows doesn't support
+			// certain properties...
+			continue;
+		}
+
+		// Convert from the RomMetaData property indexes to
+		// Windows property keys.
+		const MetaDataConv &conv = metaDataConv[(int)prop->name];
+		if (!conv.pkey || conv.vtype == VT_EMPTY) {
+			// FIXME: Should assert here, but Windows doesn't support
+			// certain properties...
+			continue;
+		}
 
-	// Clear property variants.
-	std::for_each(prop_val.begin(), prop_val.end(),
-		[](PROPVARIANT &pv) { PropVariantClear(&pv); }
-	);
+		const bool compatible = isTypeCompatible(prop->type, conv.vtype);
+		assert(compatible);
+		if (!compatible)
+			continue;
+		if (conv.vtype == VT_BSTR && !prop->data.str)
+			continue;
+
+		prop_key.emplace_back(conv.pkey);
+		prop_idx.emplace_back(i);
+
+		// Special handling for image dimensions.
+		switch (prop->name) {
+			case LibRpBase::Property::Width:
+				assert(dimensions.cx == 0);
+				dimensions.cx = static_cast<uint32_t>(prop->data.uvalue);
+				break;
+			case LibRpBase::Property::Height:
+				assert(dimensions.cy == 0);
+				dimensions.cy = static_cast<uint32_t>(prop->data.uvalue);
+				break;
+			default:
+				break;
+		}
+	}
+
+	// Special handling for System.Image.Dimensions.
+	if (dimensions.cx != 0 && dimensions.cy != 0) {
+		prop_key.emplace_back(&PKEY_Image_Dimensions);
+		prop_idx.emplace_back(PROP_IDX_DIMENSIONS);
+	}
+
+	return 0;
+}
+
+/**
+ * Convert a metadata property to a PROPVARIANT.
+ * @param n	[in] Index in prop_key.
+ * @param pv	[out] PROPVARIANT.
+ * @return HRESULT.
+ */
+HRESULT RP_PropertyStore_Private::getValue(size_t n, PROPVARIANT *pv) const
+{
+	assert(n < prop_idx.size());
+	const int idx = prop_idx[n];
+	if (idx == PROP_IDX_DIMENSIONS) {
+		// System.Image.Dimensions
+		wchar_t buf[64];
+		swprintf(buf, _countof(buf), L"%ldx%ld", dimensions.cx, dimensions.cy);
+		return InitPropVariantFromString(buf, pv);
+	}
+
+	// NOTE: The metadata was already loaded by load().
+	const RomMetaData::MetaData *const prop = romData->metaData()->prop(idx);
+	assert(prop != nullptr);
+	if (!prop)
+		return E_UNEXPECTED;
+
+	const MetaDataConv &conv = metaDataConv[(int)prop->name];
+	switch (conv.vtype) {
+		case VT_UI8:
+			// FIXME: 64-bit values?
+			// NOTE: Converting duration from ms to 100ns.
+			if (prop->name == LibRpBase::Property::Duration) {
+				const uint64_t duration_100ns = static_cast<uint64_t>(prop->data.uvalue) * 10000ULL;
+				return InitPropVariantFromUInt64(duration_100ns, pv);
+			}
+			// Use the value as-is.
+			return InitPropVariantFromUInt64(static_cast<uint64_t>(prop->data.uvalue), pv);
+		case VT_UI4:
+			return InitPropVariantFromUInt32(static_cast<uint32_t>(prop->data.uvalue), pv);
+		case VT_UI2:
+			return InitPropVariantFromUInt16(static_cast<uint16_t>(prop->data.uvalue), pv);
+		case VT_UI1:
+			return InitPropVariantFromUInt8(static_cast<uint8_t>(prop->data.uvalue), pv);
+
+		case VT_I8:
+			// FIXME: 64-bit values?
+			return InitPropVariantFromInt64(static_cast<int64_t>(prop->data.ivalue), pv);
+		case VT_I4:
+			return InitPropVariantFromInt32(static_cast<int32_t>(prop->data.ivalue), pv);
+		case VT_I2:
+			return InitPropVariantFromInt16(static_cast<int16_t>(prop->data.ivalue), pv);
+		case VT_I1:
+			return InitPropVariantFromInt8(static_cast<int8_t>(prop->data.ivalue), pv);
+
+		case VT_BSTR:
+			return InitPropVariantFromString(U82W_s(*prop->data.str), pv);
+
+		case VT_VECTOR|VT_BSTR: {
+			// For now, assuming an array with a single string.
+			const wstring wstr = (prop->data.str ? U82W_s(*prop->data.str) : L"");
+			const wchar_t *vstr[] = {wstr.c_str()};
+			return InitPropVariantFromStringVector(vstr, 1, pv);
+		}
+
+		case VT_DATE: {
+			// Date is stored as Unix time.
+			// Convert to FILETIME, then to VT_DATE.
+			// TODO: Verify timezone handling.
+			FILETIME ft;
+			UnixTimeToFileTime(prop->data.timestamp, &ft);
+			return InitPropVariantFromFileTime(&ft, pv);
+		}
+
+		default:
+			// Filtered out by load().
+			assert(!"Unsupported PROPVARIANT type.");
+			break;
+	}
+
+	return E_UNEXPECTED;
 }
 
 /** RP_PropertyStore **/
@@ -235,202 +453,16 @@ IFACEMETHODIMP RP_PropertyStore::Initialize(IStream *pstream, DWORD grfMode)
 	d->pstream = pstream;
 	d->grfMode = grfMode;
 
-	// Attempt to create a RomData object.
-	d->romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_METADATA);
-	if (!d->romData) {
-		// No RomData.
-		return E_FAIL;
-	}
-
-	// Get the metadata properties.
-	const RomMetaData *metaData = d->romData->metaData();
-	if (!metaData || metaData->empty()) {
-		// No metadata properties.
-		return S_OK;
-	}
-
-	// Special handling for System.Image.Dimensions.
-	SIZE dimensions = {0, 0};
-
-	// Process the metadata.
-	// TODO: Use IPropertyStoreCache?
-	// Reference: https://github.com/Microsoft/Windows-classic-samples/blob/master/Samples/Win7Samples/winui/shell/appshellintegration/RecipePropertyHandler/RecipePropertyHandler.cpp
-	const int count = metaData->count();
-	d->prop_key.reserve(count);
-	d->prop_val.reserve(count);
-	for (int i = 0; i < count; i++) {
-		const RomMetaData::MetaData *prop = metaData->prop(i);
-		assert(prop != nullptr);
-		if (!prop)
-			continue;
-
-		if (prop->name <= Property::Invalid || (int)prop->name >= ARRAY_SIZE(d->metaDataConv)) {
-			// FIXME: Should assert here, but Windows doesn't support
-			// certain properties...
-			continue;
-		}
-
-		// Convert from the RomMetaData property indexes to
-		// Windows property keys.
-		const RP_PropertyStore_Private::MetaDataConv &conv = d->metaDataConv[(int)prop->name];
-		if (!conv.pkey || conv.vtype == VT_EMPTY) {
-			// FIXME: Should assert here, but Windows doesn't support
-			// certain properties...
-			continue;
-		}
-
-		// FIXME: UIx should only accept PropertyType::UnsignedInteger,
-		// and Ix should only accept PropertyType::Integer.
-		PROPVARIANT prop_var;
-		switch (conv.vtype) {
-			case VT_UI8:
-				// FIXME: 64-bit values?
-				assert(prop->type == PropertyType::Integer || prop->type == PropertyType::UnsignedInteger);
-				if (prop->type != PropertyType::Integer && prop->type != PropertyType::UnsignedInteger)
-					continue;
-				// NOTE: Converting duration from ms to 100ns.
-				if (prop->name == LibRpBase::Property::Duration) {
-					uint64_t duration_100ns = static_cast<uint64_t>(prop->data.uvalue) * 10000ULL;
-					InitPropVariantFromUInt64(duration_100ns, &prop_var);
-				} else {
-					// Use the value as-is.
-					InitPropVariantFromUInt64(static_cast<uint64_t>(prop->data.uvalue), &prop_var);
-				}
-				d->prop_key.emplace_back(conv.pkey);
-				d->prop_val.emplace_back(prop_var);
-				break;
-			case VT_UI4:
-				assert(prop->type == PropertyType::Integer || prop->type == PropertyType::UnsignedInteger);
-				if (prop->type != PropertyType::Integer && prop->type != PropertyType::UnsignedInteger)
-					continue;
-				InitPropVariantFromUInt32(static_cast<uint32_t>(prop->data.uvalue), &prop_var);
-				d->prop_key.emplace_back(conv.pkey);
-				d->prop_val.emplace_back(prop_var);
-
-				// Special handling for image dimensions.
-				switch (prop->name) {
-					case LibRpBase::Property::Width:
-						assert(dimensions.cx == 0);
-						dimensions.cx = static_cast<uint32_t>(prop->data.uvalue);
-						break;
-					case LibRpBase::Property::Height:
-						assert(dimensions.cy == 0);
-						dimensions.cy = static_cast<uint32_t>(prop->data.uvalue);
-						break;
-					default:
-						break;
-				}
-				break;
-			case VT_UI2:
-				assert(prop->type == PropertyType::Integer || prop->type == PropertyType::UnsignedInteger);
-				if (prop->type != PropertyType::Integer && prop->type != PropertyType::UnsignedInteger)
-					continue;
-				InitPropVariantFromUInt16(static_cast<uint16_t>(prop->data.uvalue), &prop_var);
-				d->prop_key.emplace_back(conv.pkey);
-				d->prop_val.emplace_back(prop_var);
-				break;
-			case VT_UI1:
-				assert(prop->type == PropertyType::Integer || prop->type == PropertyType::UnsignedInteger);
-				if (prop->type != PropertyType::Integer && prop->type != PropertyType::UnsignedInteger)
-					continue;
-
-				InitPropVariantFromUInt8(static_cast<uint8_t>(prop->data.uvalue), &prop_var);
-				d->prop_key.emplace_back(conv.pkey);
-				d->prop_val.emplace_back(prop_var);
-				break;
-
-			case VT_I8:
-				// FIXME: 64-bit values?
-				assert(prop->type == PropertyType::Integer || prop->type == PropertyType::UnsignedInteger);
-				if (prop->type != PropertyType::Integer && prop->type != PropertyType::UnsignedInteger)
-					continue;
-				InitPropVariantFromInt64(static_cast<int64_t>(prop->data.ivalue), &prop_var);
-				d->prop_key.emplace_back(conv.pkey);
-				d->prop_val.emplace_back(prop_var);
-				break;
-			case VT_I4:
-				assert(prop->type == PropertyType::Integer || prop->type == PropertyType::UnsignedInteger);
-				if (prop->type != PropertyType::Integer && prop->type != PropertyType::UnsignedInteger)
-					continue;
-				InitPropVariantFromInt32(static_cast<int32_t>(prop->data.ivalue), &prop_var);
-				d->prop_key.emplace_back(conv.pkey);
-				d->prop_val.emplace_back(prop_var);
-				break;
-			case VT_I2:
-				assert(prop->type == PropertyType::Integer || prop->type == PropertyType::UnsignedInteger);
-				if (prop->type != PropertyType::Integer && prop->type != PropertyType::UnsignedInteger)
-					continue;
-				InitPropVariantFromInt16(static_cast<int16_t>(prop->data.ivalue), &prop_var);
-				d->prop_key.emplace_back(conv.pkey);
-				d->prop_val.emplace_back(prop_var);
-				break;
-			case VT_I1:
-				assert(prop->type == PropertyType::Integer || prop->type == PropertyType::UnsignedInteger);
-				if (prop->type != PropertyType::Integer && prop->type != PropertyType::UnsignedInteger)
-					continue;
-				InitPropVariantFromInt8(static_cast<int8_t>(prop->data.ivalue), &prop_var);
-				d->prop_key.emplace_back(conv.pkey);
-				d->prop_val.emplace_back(prop_var);
-				break;
-
-			case VT_BSTR:
-				assert(prop->type == PropertyType::String);
-				if (prop->type != PropertyType::String)
-					continue;
-				if (prop->data.str) {
-					InitPropVariantFromString(U82W_s(*prop->data.str), &prop_var);
-					d->prop_key.emplace_back(conv.pkey);
-					d->prop_val.emplace_back(prop_var);
-				}
-				break;
-
-			case VT_VECTOR|VT_BSTR: {
-				// For now, assuming an array with a single string.
-				assert(prop->type == PropertyType::String);
-				if (prop->type != PropertyType::String)
-					continue;
-				const wstring wstr = (prop->data.str ? U82W_s(*prop->data.str) : L"");
-				const wchar_t *vstr[] = {wstr.c_str()};
-				InitPropVariantFromStringVector(vstr, 1, &prop_var);
-				d->prop_key.emplace_back(conv.pkey);
-				d->prop_val.emplace_back(prop_var);
-				break;
-			}
-
-			case VT_DATE: {
-				assert(prop->type == PropertyType::Timestamp);
-				if (prop->type != PropertyType::Timestamp)
-					continue;
-				// Date is stored as Unix time.
-				// Convert to FILETIME, then to VT_DATE.
-				// TODO: Verify timezone handling.
-				FILETIME ft;
-				UnixTimeToFileTime(prop->data.timestamp, &ft);
-				InitPropVariantFromFileTime(&ft, &prop_var);
-				d->prop_key.emplace_back(conv.pkey);
-				d->prop_val.emplace_back(prop_var);
-				break;
-			}
-
-			default:
-				// TODO: Add support for multiple strings.
-				// FIXME: Not supported.
-				assert(!"Unsupported PROPVARIANT type.");
-				break;
-		}
-	}
-
-	// Special handling for System.Image.Dimensions.
-	if (dimensions.cx != 0 && dimensions.cy != 0) {
-		wchar_t buf[64];
-		swprintf(buf, _countof(buf), L"%ldx%ld", dimensions.cx, dimensions.cy);
-
-		PROPVARIANT prop_var;
-		InitPropVariantFromString(buf, &prop_var);
-		d->prop_key.emplace_back(&PKEY_Image_Dimensions);
-		d->prop_val.emplace_back(prop_var);
-	}
-
+	// Discard the previous RomData object, if any.
+	// NOTE: The new RomData object isn't created until a property is
+	// requested, since Windows Search and the Details pane usually only
+	// request a few properties, and might not request any that we handle.
+	UNREF_AND_NULL(d->romData);
+	d->prop_key.clear();
+	d->prop_idx.clear();
+	d->dimensions.cx = 0;
+	d->dimensions.cy = 0;
+	d->loaded = false;
 	return S_OK;
 }
 
@@ -445,7 +477,8 @@ IFACEMETHODIMP RP_PropertyStore::Commit(void)
 
 IFACEMETHODIMP RP_PropertyStore::GetAt(_In_ DWORD iProp, _Out_ PROPERTYKEY *pkey)
 {
-	RP_D(const RP_PropertyStore);
+	RP_D(RP_PropertyStore);
+	d->load();
 	if (iProp >= d->prop_key.size()) {
 		return E_INVALIDARG;
 	} else if (!pkey) {
@@ -462,30 +495,37 @@ IFACEMETHODIMP RP_PropertyStore::GetCount(_Out_ DWORD *cProps)
 		return E_POINTER;
 	}
 
-	RP_D(const RP_PropertyStore);
+	RP_D(RP_PropertyStore);
+	d->load();
 	*cProps = static_cast<DWORD>(d->prop_key.size());
 	return S_OK;
 }
 
 IFACEMETHODIMP RP_PropertyStore::GetValue(_In_ REFPROPERTYKEY key, _Out_ PROPVARIANT *pv)
 {
-	RP_D(const RP_PropertyStore);
+	RP_D(RP_PropertyStore);
 	if (!pv) {
 		return E_POINTER;
 	}
+	PropVariantInit(pv);
+
+	// If we never handle this key, don't bother loading the file.
+	if (!RP_PropertyStore_Private::isKeyHandled(key)) {
+		return S_OK;
+	}
+	d->load();
 
 	// Linear search for the property.
 	// TODO: Optimize this?
 	for (size_t n = 0; n < d->prop_key.size(); n++) {
 		if (*d->prop_key[n] == key) {
 			// Found the property.
-			// Return the property value.
-			return PropVariantCopy(pv, &d->prop_val[n]);
+			// Convert the property value.
+			return d->getValue(n, pv);
 		}
 	}
 
 	// Property not found.
-	PropVariantClear(pv);
 	return S_OK;
 }
 
@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (Win32)                            *
  * RP_PropertyStore_p.hpp: IPropertyStore implementation. (PRIVATE CLASS)  *
  *                                                                         *
- * Copyright (c) 2016-2020 by David Korth.                                 *
+ * Copyright (c) 2016-2021 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -43,15 +43,21 @@ class RP_PropertyStore_Private
 		DWORD grfMode;
 
 		// RomData object.
+		// NOTE: Not created until a property is requested.
 		LibRpBase::RomData *romData;
 
-		// NOTE: prop_key.pid == index + 2,
-		// since pids 0 and 1 are reserved.
+		// Has load() been called?
+		bool loaded;
 
 		// Property keys.
 		std::vector<const PROPERTYKEY*> prop_key;
-		// Property values.
-		std::vector<PROPVARIANT> prop_val;
+		// RomMetaData property indexes for each key.
+		// PROP_IDX_DIMENSIONS is used for System.Image.Dimensions.
+		std::vector<int> prop_idx;
+		enum { PROP_IDX_DIMENSIONS = -1 };
+
+		// Image dimensions, for System.Image.Dimensions.
+		SIZE dimensions;
 
 		/**
 		 * Metadata conversion table.
@@ -65,6 +71,31 @@ class RP_PropertyStore_Private
 			LONG vtype;
 		};
 		static const MetaDataConv metaDataConv[];
+
+	public:
+		/**
+		 * Can this property store ever have a value for the specified key?
+		 * This doesn't require loading the RomData object.
+		 * @param key Property key.
+		 * @return True if the key is handled; false if not.
+		 */
+		static bool isKeyHandled(REFPROPERTYKEY key);
+
+		/**
+		 * Create the RomData object and index its metadata properties.
+		 * Only the metadata is loaded; fields and images are not.
+		 * Property values are converted in getValue().
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int load(void);
+
+		/**
+		 * Convert a metadata property to a PROPVARIANT.
+		 * @param n	[in] Index in prop_key.
+		 * @param pv	[out] PROPVARIANT.
+		 * @return HRESULT.
+		 */
+		HRESULT getValue(size_t n, PROPVARIANT *pv) const;
 };
 
 #endif /* __ROMPROPERTIES_WIN32_RP_PROPERTYSTORE_P_HPP__ */
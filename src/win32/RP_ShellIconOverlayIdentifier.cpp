@@ -21,8 +21,12 @@ extern "C" {
 	extern TCHAR dll_filename[];
 }
 
+// librpthreads
+using LibRpThreads::MutexLocker;
+
 // C++ STL classes.
 using std::string;
+using std::unordered_map;
 
 // CLSID
 const CLSID CLSID_RP_ShellIconOverlayIdentifier =
@@ -54,6 +58,70 @@ RP_ShellIconOverlayIdentifier_Private::~RP_ShellIconOverlayIdentifier_Private()
 	}
 }
 
+// Per-path result cache for IsMemberOf().
+unordered_map<string, RP_ShellIconOverlayIdentifier_Private::CacheEntry> RP_ShellIconOverlayIdentifier_Private::resultCache;
+LibRpThreads::Mutex RP_ShellIconOverlayIdentifier_Private::resultCacheMutex;
+
+/**
+ * Check if a file has "dangerous" permissions.
+ * @param u8filename Filename (UTF-8)
+ * @return S_OK if it does; S_FALSE if not; E_FAIL on error.
+ */
+HRESULT RP_ShellIconOverlayIdentifier_Private::checkFile(const string &u8filename)
+{
+	// Check the result cache first.
+	FileSystem::FileIdentity id;
+	const bool hasId = (FileSystem::get_file_identity(u8filename, &id) == 0);
+	if (hasId) {
+		MutexLocker mutexLocker(resultCacheMutex);
+		auto iter = resultCache.find(u8filename);
+		if (iter != resultCache.end()) {
+			const FileSystem::FileIdentity &c_id = iter->second.id;
+			if (c_id.device == id.device && c_id.inode == id.inode &&
+			    c_id.size == id.size && c_id.mtime_ns == id.mtime_ns)
+			{
+				// File hasn't changed.
+				return (iter->second.isMember ? S_OK : S_FALSE);
+			}
+		}
+	}
+
+	// Open the ROM file.
+	RpFile *const file = new RpFile(u8filename.c_str(), RpFile::FM_OPEN_READ_GZ);
+	if (!file->isOpen()) {
+		// Error opening the ROM file.
+		file->unref();
+		return E_FAIL;
+	}
+
+	// Identify the file before constructing a RomData object.
+	// Most files won't be supported by a RomData subclass
+	// that can have "dangerous" permissions.
+	bool isMember = false;
+	RomDataFactory::IdentifyInfo idInfo;
+	if (RomDataFactory::identify(file, &idInfo, RomDataFactory::RDA_HAS_DPOVERLAY)) {
+		// Attempt to create a RomData object.
+		RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_DPOVERLAY | RomDataFactory::RDA_CACHE);
+		if (romData) {
+			isMember = romData->hasDangerousPermissions();
+			romData->unref();
+		}
+	}
+	file->unref();
+
+	if (hasId) {
+		// Save the result.
+		MutexLocker mutexLocker(resultCacheMutex);
+		if (resultCache.size() >= RESULT_CACHE_MAX) {
+			resultCache.clear();
+		}
+		CacheEntry &entry = resultCache[u8filename];
+		entry.id = id;
+		entry.isMember = isMember;
+	}
+	return (isMember ? S_OK : S_FALSE);
+}
+
 /** RP_PropertyStore **/
 
 RP_ShellIconOverlayIdentifier::RP_ShellIconOverlayIdentifier()
@@ -108,6 +176,13 @@ IFACEMETHODIMP RP_ShellIconOverlayIdentifier::IsMemberOf(_In_ PCWSTR pwszPath, D
 	// Convert the filename to UTF-8.
 	const string u8filename = W2U8(pwszPath);
 
+	// Only a few RomData subclasses can have "dangerous" permissions.
+	// Check the file extension first so other files aren't opened.
+	if (!RomDataFactory::isExtensionSupported(u8filename.c_str(), RomDataFactory::RDA_HAS_DPOVERLAY)) {
+		// File extension isn't supported.
+		return S_FALSE;
+	}
+
 	// Check for "bad" file systems.
 	// TODO: Combine with the above "slow" check?
 	if (FileSystem::isOnBadFS(u8filename.c_str(),
@@ -117,25 +192,7 @@ IFACEMETHODIMP RP_ShellIconOverlayIdentifier::IsMemberOf(_In_ PCWSTR pwszPath, D
 		return S_FALSE;
 	}
 
-	// Open the ROM file.
-	RpFile *const file = new RpFile(u8filename.c_str(), RpFile::FM_OPEN_READ_GZ);
-	if (!file->isOpen()) {
-		// Error opening the ROM file.
-		file->unref();
-		return E_FAIL;
-	}
-
-	// Attempt to create a RomData object.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_DPOVERLAY);
-	file->unref();
-	if (!romData) {
-		// ROM is not supported.
-		return S_FALSE;
-	}
-
-	HRESULT hr = (romData->hasDangerousPermissions() ? S_OK : S_FALSE);
-	romData->unref();
-	return hr;
+	return RP_ShellIconOverlayIdentifier_Private::checkFile(u8filename);
 }
 
 IFACEMETHODIMP RP_ShellIconOverlayIdentifier::GetOverlayInfo(_Out_writes_(cchMax) PWSTR pwszIconFile, int cchMax, _Out_ int *pIndex, _Out_ DWORD *pdwFlags)
@@ -15,6 +15,14 @@
 // librpbase, librpfile
 #include "librpbase/RomData.hpp"
 #include "librpfile/IRpFile.hpp"
+#include "librpfile/FileSystem.hpp"
+
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+
+// C++ includes.
+#include <string>
+#include <unordered_map>
 
 // Workaround for RP_D() expecting the no-underscore naming convention.
 #define RP_ShellIconOverlayIdentifierPrivate RP_ShellIconOverlayIdentifier_Private
@@ -36,6 +44,30 @@ class RP_ShellIconOverlayIdentifier_Private
 		typedef HRESULT (STDAPICALLTYPE *PFNSHGETSTOCKICONINFO)(_In_ SHSTOCKICONID siid, _In_ UINT uFlags, _Out_ SHSTOCKICONINFO *psii);
 		HMODULE hShell32_dll;
 		PFNSHGETSTOCKICONINFO pfnSHGetStockIconInfo;
+
+	public:
+		/**
+		 * Per-path result cache for IsMemberOf().
+		 * Explorer calls IsMemberOf() repeatedly for the same files,
+		 * so cache the result along with the file's identity.
+		 */
+		struct CacheEntry {
+			LibRpFile::FileSystem::FileIdentity id;
+			bool isMember;
+		};
+		static std::unordered_map<std::string, CacheEntry> resultCache;
+		static LibRpThreads::Mutex resultCacheMutex;
+
+		// Maximum number of cached results.
+		// The cache is cleared if this is exceeded.
+		static const size_t RESULT_CACHE_MAX = 4096;
+
+		/**
+		 * Check if a file has "dangerous" permissions.
+		 * @param u8filename Filename (UTF-8)
+		 * @return S_OK if it does; S_FALSE if not; E_FAIL on error.
+		 */
+		static HRESULT checkFile(const std::string &u8filename);
 };
 
 #endif /* __ROMPROPERTIES_WIN32_RP_SHELLICONOVERLAYIDENTIFIER_P_HPP__ */
@@ -175,14 +175,34 @@ class RP_ShellPropSheetExt_Private
 			HWND lblCredits;	// Credits label.
 			POINT curPt;		// Current point.
 			int scrollPos;		// Scrolling position.
+			bool isInit;		// True if the field widgets have been created.
 
-			tab() : hDlg(nullptr), lblCredits(nullptr), scrollPos(0) {
+			tab() : hDlg(nullptr), lblCredits(nullptr), scrollPos(0), isInit(false) {
 				curPt.x = 0; curPt.y = 0;
 			}
 		};
 		vector<tab> tabs;
 		int curTabIndex;
 
+		// Field layout information.
+		// Set by initDialog(); used by initTabFields().
+		struct FieldLayout {
+			vector<tstring> desc_text;		// Description labels, indexed by field.
+			unique_ptr<int[]> max_text_width;	// Maximum description width, indexed by tab.
+			SIZE descSize;				// Description label size.
+			RECT dlgMargin;				// Dialog margin.
+			RECT dlgRect;				// Tab area.
+			int dlg_value_width_base;		// Base width for value widgets.
+			int tabCount;
+
+			FieldLayout() : dlg_value_width_base(0), tabCount(0) {
+				descSize.cx = 0; descSize.cy = 0;
+				memset(&dlgMargin, 0, sizeof(dlgMargin));
+				memset(&dlgRect, 0, sizeof(dlgRect));
+			}
+		};
+		FieldLayout fieldLayout;
+
 		// Sizes.
 		int lblDescHeight;	// Description label height.
 		SIZE dlgSize;		// Visible dialog size.
@@ -290,6 +310,16 @@ class RP_ShellPropSheetExt_Private
 			const POINT &pt_start, const SIZE &size, bool doResize,
 			const RomFields::Field &field, int fieldIdx);
 
+		/**
+		 * Add a ListData icon to the ListView's ImageList.
+		 * Called by ListView_GetDispInfo() the first time a row's icon is needed.
+		 * @param hListView	[in] ListView control.
+		 * @param lvData	[in/out] LvData.
+		 * @param row		[in] Row index. (unsorted)
+		 * @return ImageList index, or -1 if the row doesn't have an icon.
+		 */
+		int loadListDataIcon(HWND hListView, LvData &lvData, int row);
+
 		/**
 		 * Initialize a Date/Time field.
 		 * This function internally calls initString().
@@ -376,6 +406,14 @@ class RP_ShellPropSheetExt_Private
 		 */
 		void initDialog(void);
 
+		/**
+		 * Create the field widgets for a tab.
+		 * Called by initDialog() for the first tab, and when
+		 * another tab is selected for the first time.
+		 * @param tabIdx Tab index.
+		 */
+		void initTabFields(int tabIdx);
+
 		/**
 		 * Adjust tabs for the message widget.
 		 * Message widget must have been created first.
@@ -1401,99 +1439,13 @@ int RP_ShellPropSheetExt_Private::initListData(HWND hDlg, HWND hWndTab,
 		if (himl) {
 			// NOTE: ListView uses LVSIL_SMALL for LVS_REPORT.
 			ListView_SetImageList(hListView, himl, LVSIL_SMALL);
-			const uint32_t lvBgColor[2] = {
-				LibWin32Common::GetSysColor_ARGB32(COLOR_WINDOW),
-				LibWin32Common::getAltRowColor_ARGB32()
-			};
-
-			// Add icons.
-			uint8_t rowColorIdx = 0;
-			const auto &icons = field.data.list_data.mxd.icons;
-			const auto icons_cend = icons->cend();
-			for (auto iter = icons->cbegin(); iter != icons_cend;
-			     ++iter, rowColorIdx = !rowColorIdx)
-			{
-				bool needsUnref = false;
-				int iImage = -1;
-				const rp_image *icon = *iter;
-				if (!icon) {
-					// No icon for this row.
-					lvData.vImageList.emplace_back(iImage);
-					continue;
-				}
-
-				if (dwExStyleRTL != 0) {
-					// WS_EX_LAYOUTRTL will flip bitmaps in the ListView.
-					// ILC_MIRROR mirrors the bitmaps if the process is mirrored,
-					// but we can't rely on that being the case, and this option
-					// was first introduced in Windows XP.
-					// We'll flip the image here to counteract it.
-					const rp_image *const flipimg = icon->flip(rp_image::FLIP_H);
-					assert(flipimg != nullptr);
-					if (flipimg) {
-						icon = flipimg;
-						needsUnref = true;
-					}
-				}
 
-				// Resize the icon, if necessary.
-				if (resizeNeeded) {
-					SIZE szResize = {icon->width(), icon->height()};
-					szResize.cy = static_cast<LONG>(szResize.cy * factor);
-
-					// If the original icon is CI8, it needs to be
-					// converted to ARGB32 first. Otherwise, the
-					// "empty" background area will be black.
-					// NOTE: We still need to specify a background color,
-					// since the ListView highlight won't show up on
-					// alpha-transparent pixels.
-					// TODO: Handle this in rp_image::resized()?
-					// TODO: Handle theme changes?
-					// TODO: Error handling.
-					if (icon->format() != rp_image::Format::ARGB32) {
-						const rp_image *const icon32 = icon->dup_ARGB32();
-						if (icon32) {
-							if (needsUnref) {
-								icon->unref();
-							}
-							icon = icon32;
-							needsUnref = true;
-						}
-					}
-
-					// Resize the icon.
-					const rp_image *const icon_resized = icon->resized(
-						szResize.cx, szResize.cy,
-						rp_image::AlignVCenter, lvBgColor[rowColorIdx]);
-					assert(icon_resized != nullptr);
-					if (icon_resized) {
-						if (needsUnref) {
-							icon->unref();
-						}
-						icon = icon_resized;
-						needsUnref = true;
-					}
-				}
-
-				HICON hIcon = RpImageWin32::toHICON(icon);
-				if (needsUnref) {
-					icon->unref();
-				}
-
-				assert(hIcon != nullptr);
-				if (hIcon) {
-					int idx = ImageList_AddIcon(himl, hIcon);
-					if (idx >= 0) {
-						// Icon added.
-						iImage = idx;
-					}
-					// ImageList makes a copy of the icon.
-					DestroyIcon(hIcon);
-				}
-
-				// Save the ImageList index for later.
-				lvData.vImageList.emplace_back(iImage);
-			}
+			// Icons are converted and added to the ImageList
+			// by loadListDataIcon() when the row is displayed.
+			// The ImageList indexes are cached in vImageList.
+			lvData.pField = &field;
+			lvData.iconFactor = (resizeNeeded ? factor : 1.0f);
+			lvData.vImageList.assign(field.data.list_data.mxd.icons->size(), LvData::ICON_NOT_LOADED);
 		}
 	}
 
@@ -1595,6 +1547,113 @@ int RP_ShellPropSheetExt_Private::initListData(HWND hDlg, HWND hWndTab,
 	return cy;
 }
 
+/**
+ * Add a ListData icon to the ListView's ImageList.
+ * Called by ListView_GetDispInfo() the first time a row's icon is needed.
+ * @param hListView	[in] ListView control.
+ * @param lvData	[in/out] LvData.
+ * @param row		[in] Row index. (unsorted)
+ * @return ImageList index, or -1 if the row doesn't have an icon.
+ */
+int RP_ShellPropSheetExt_Private::loadListDataIcon(HWND hListView, LvData &lvData, int row)
+{
+	assert(row >= 0 && row < static_cast<int>(lvData.vImageList.size()));
+	assert(lvData.pField != nullptr);
+
+	// Mark the icon as loaded, even if it fails,
+	// so we don't try loading it again.
+	int &iImage = lvData.vImageList[row];
+	iImage = -1;
+
+	HIMAGELIST himl = ListView_GetImageList(hListView, LVSIL_SMALL);
+	assert(himl != nullptr);
+	if (!himl || !lvData.pField) {
+		return -1;
+	}
+
+	bool needsUnref = false;
+	const rp_image *icon = RomFields::listDataIcon(*lvData.pField, row);
+	if (!icon) {
+		// No icon for this row.
+		return -1;
+	}
+
+	if (dwExStyleRTL != 0) {
+		// WS_EX_LAYOUTRTL will flip bitmaps in the ListView.
+		// ILC_MIRROR mirrors the bitmaps if the process is mirrored,
+		// but we can't rely on that being the case, and this option
+		// was first introduced in Windows XP.
+		// We'll flip the image here to counteract it.
+		const rp_image *const flipimg = icon->flip(rp_image::FLIP_H);
+		assert(flipimg != nullptr);
+		if (flipimg) {
+			icon = flipimg;
+			needsUnref = true;
+		}
+	}
+
+	// Resize the icon, if necessary.
+	if (lvData.iconFactor != 1.0f) {
+		SIZE szResize = {icon->width(), icon->height()};
+		szResize.cy = static_cast<LONG>(szResize.cy * lvData.iconFactor);
+
+		// If the original icon is CI8, it needs to be
+		// converted to ARGB32 first. Otherwise, the
+		// "empty" background area will be black.
+		// NOTE: We still need to specify a background color,
+		// since the ListView highlight won't show up on
+		// alpha-transparent pixels.
+		// TODO: Handle this in rp_image::resized()?
+		// TODO: Handle theme changes?
+		// TODO: Error handling.
+		if (icon->format() != rp_image::Format::ARGB32) {
+			const rp_image *const icon32 = icon->dup_ARGB32();
+			if (icon32) {
+				if (needsUnref) {
+					icon->unref();
+				}
+				icon = icon32;
+				needsUnref = true;
+			}
+		}
+
+		// Resize the icon.
+		// NOTE: The background color is based on the unsorted row index.
+		const uint32_t lvBgColor = (row & 1)
+			? LibWin32Common::getAltRowColor_ARGB32()
+			: LibWin32Common::GetSysColor_ARGB32(COLOR_WINDOW);
+		const rp_image *const icon_resized = icon->resized(
+			szResize.cx, szResize.cy,
+			rp_image::AlignVCenter, lvBgColor);
+		assert(icon_resized != nullptr);
+		if (icon_resized) {
+			if (needsUnref) {
+				icon->unref();
+			}
+			icon = icon_resized;
+			needsUnref = true;
+		}
+	}
+
+	HICON hIcon = RpImageWin32::toHICON(icon);
+	if (needsUnref) {
+		icon->unref();
+	}
+
+	assert(hIcon != nullptr);
+	if (hIcon) {
+		const int idx = ImageList_AddIcon(himl, hIcon);
+		if (idx >= 0) {
+			// Icon added.
+			iImage = idx;
+		}
+		// ImageList makes a copy of the icon.
+		DestroyIcon(hIcon);
+	}
+
+	return iImage;
+}
+
 /**
  * Initialize a Date/Time field.
  * This function internally calls initString().
@@ -1948,7 +2007,8 @@ void RP_ShellPropSheetExt_Private::updateMulti(uint32_t user_lc)
 			// Resize the columns to fit the contents.
 			// NOTE: Only done on first load. (TODO: Maybe we should do it every time?)
 			// TODO: Need to measure text...
-			if (!cboLanguage) {
+			if (!lvData.colWidthsSet) {
+				lvData.colWidthsSet = true;
 				// TODO: Do this on system theme change?
 				// TODO: Add a flag for 'main data column' and adjust it to
 				// not exceed the viewport.
@@ -2096,6 +2156,11 @@ int RP_ShellPropSheetExt_Private::updateField(int fieldIdx)
 	assert(field->tabIdx < tabs.size());
 	if (field->tabIdx < 0 || field->tabIdx >= tabs.size())
 		return 4;
+	if (!tabs[field->tabIdx].isInit) {
+		// The tab's field widgets haven't been created yet.
+		// They'll use the updated value when they're created.
+		return 0;
+	}
 	HWND hDlg = tabs[field->tabIdx].hDlg;
 
 	// Update the value widget(s).
@@ -2255,13 +2320,13 @@ void RP_ShellPropSheetExt_Private::initDialog(void)
 		if (!field.isValid) {
 			t_desc_text.emplace_back(tstring());
 			continue;
-		} else if (field.name.empty()) {
+		} else if (field.name[0] == '\0') {
 			t_desc_text.emplace_back(tstring());
 			continue;
 		}
 
 		tstring desc_text = U82T_s(rp_sprintf(
-			desc_label_fmt, field.name.c_str()));
+			desc_label_fmt, field.name));
 
 		// Get the width of this specific entry.
 		// TODO: Use measureTextSize()?
@@ -2461,34 +2526,120 @@ void RP_ShellPropSheetExt_Private::initDialog(void)
 		tab.curPt.y = 0;
 	}
 
-	int fieldIdx = 0;	// needed for control IDs
-	auto iter_desc = t_desc_text.cbegin();
-	for (auto iter = pFields->cbegin(); iter != pFields_cend; ++iter, ++iter_desc, fieldIdx++) {
-		assert(iter_desc != t_desc_text.cend());
+	// Save the layout information for initTabFields().
+	fieldLayout.desc_text = std::move(t_desc_text);
+	fieldLayout.max_text_width = std::move(a_max_text_width);
+	fieldLayout.descSize = descSize;
+	fieldLayout.dlgMargin = dlgMargin;
+	fieldLayout.dlgRect = dlgRect;
+	fieldLayout.dlg_value_width_base = dlg_value_width_base;
+	fieldLayout.tabCount = tabCount;
+
+	// Create the field widgets for the first visible tab.
+	// Other tabs are created when they're selected, since creating
+	// all of the widgets up front is slow for files with many fields.
+	const auto tabs_cbegin = tabs.cbegin();
+	const auto tabs_cend = tabs.cend();
+	for (auto iter = tabs_cbegin; iter != tabs_cend; ++iter) {
+		if (iter->hDlg) {
+			initTabFields(static_cast<int>(iter - tabs_cbegin));
+			break;
+		}
+	}
+
+	// Get the supported languages from all multi-language fields,
+	// including fields on tabs that haven't been created yet.
+	for (auto iter = pFields->cbegin(); iter != pFields_cend; ++iter) {
 		const RomFields::Field &field = *iter;
 		if (!field.isValid)
 			continue;
 
-		// Verify the tab index.
-		const int tabIdx = field.tabIdx;
-		assert(tabIdx >= 0 && tabIdx < (int)tabs.size());
-		if (tabIdx < 0 || tabIdx >= (int)tabs.size()) {
-			// Tab index is out of bounds.
-			continue;
-		} else if (!tabs[tabIdx].hDlg) {
-			// Tab name is empty. Tab is hidden.
-			continue;
+		if (field.type == RomFields::RFT_STRING_MULTI && field.data.str_multi) {
+			const auto *const pStr_multi = field.data.str_multi;
+			for (auto iter_sm = pStr_multi->cbegin(); iter_sm != pStr_multi->cend(); ++iter_sm) {
+				set_lc.insert(iter_sm->first);
+			}
+		} else if (field.type == RomFields::RFT_LISTDATA &&
+			   (field.desc.list_data.flags & RomFields::RFT_LISTDATA_MULTI) &&
+			   field.data.list_data.data.multi)
+		{
+			const auto *const pListData_multi = field.data.list_data.data.multi;
+			for (auto iter_ld = pListData_multi->cbegin(); iter_ld != pListData_multi->cend(); ++iter_ld) {
+				set_lc.insert(iter_ld->first);
+			}
 		}
+	}
+
+	// Initial update of RFT_MULTI_STRING fields.
+	if (!set_lc.empty()) {
+		def_lc = pFields->defaultLanguageCode();
+		updateMulti(0);
+	}
+
+	// Check for "viewed" achievements.
+	romData->checkViewedAchievements();
+
+	// Register for WTS session notifications. (Remote Desktop)
+	wts.registerSessionNotification(hDlgSheet, NOTIFY_FOR_THIS_SESSION);
+
+	// Window is fully initialized.
+	isFullyInit = true;
+}
+
+/**
+ * Create the field widgets for a tab.
+ * Called by initDialog() for the first tab, and when
+ * another tab is selected for the first time.
+ * @param tabIdx Tab index.
+ */
+void RP_ShellPropSheetExt_Private::initTabFields(int tabIdx)
+{
+	assert(tabIdx >= 0 && tabIdx < (int)tabs.size());
+	if (tabIdx < 0 || tabIdx >= (int)tabs.size())
+		return;
+	auto &tab = tabs[tabIdx];
+	if (!tab.hDlg || tab.isInit) {
+		// Tab is hidden, or its fields were already created.
+		return;
+	}
+	tab.isInit = true;
+
+	const RomFields *const pFields = romData->fields();
+	assert(pFields != nullptr);
+	if (!pFields)
+		return;
+	const int count = pFields->count();
+	const auto pFields_cend = pFields->cend();
+
+	// Layout information from initDialog().
+	const int tabCount = fieldLayout.tabCount;
+	const RECT &dlgMargin = fieldLayout.dlgMargin;
+	const RECT &dlgRect = fieldLayout.dlgRect;
+	const int dlg_value_width_base = fieldLayout.dlg_value_width_base;
+	SIZE descSize = fieldLayout.descSize;
 
-		// Current tab.
-		auto &tab = tabs[tabIdx];
+	// Create the ROM field widgets for this tab.
+	bool hasMulti = false;
+	int fieldIdx = 0;	// needed for control IDs
+	for (auto iter = pFields->cbegin(); iter != pFields_cend; ++iter, fieldIdx++) {
+		const RomFields::Field &field = *iter;
+		if (!field.isValid || field.tabIdx != tabIdx)
+			continue;
 
 		// Description width is based on the tab index.
-		descSize.cx = a_max_text_width[tabIdx];
+		descSize.cx = fieldLayout.max_text_width[tabIdx];
+
+		// Multi-language fields need to be updated after they're created.
+		if (field.type == RomFields::RFT_STRING_MULTI ||
+		    (field.type == RomFields::RFT_LISTDATA &&
+		     (field.desc.list_data.flags & RomFields::RFT_LISTDATA_MULTI)))
+		{
+			hasMulti = true;
+		}
 
 		// Create the static text widget. (FIXME: Disable mnemonics?)
 		HWND hStatic = CreateWindowEx(WS_EX_NOPARENTNOTIFY | WS_EX_TRANSPARENT,
-			WC_STATIC, iter_desc->c_str(),
+			WC_STATIC, fieldLayout.desc_text[fieldIdx].c_str(),
 			WS_CHILD | WS_VISIBLE | WS_CLIPSIBLINGS | SS_LEFT,
 			tab.curPt.x, tab.curPt.y, descSize.cx, descSize.cy,
 			tab.hDlg, (HMENU)(INT_PTR)IDC_STATIC_DESC(fieldIdx), nullptr, nullptr);
@@ -2612,46 +2763,32 @@ void RP_ShellPropSheetExt_Private::initDialog(void)
 	// Update scrollbar settings.
 	// TODO: If a VScroll bar is added, adjust widths of RFT_LISTDATA.
 	// TODO: HScroll bar?
-	const auto tabs_cend = tabs.cend();
-	for (auto iter = tabs.cbegin(); iter != tabs_cend; ++iter) {
-		// Set scroll info.
-		// FIXME: Separate child dialog for no tabs.
-		const auto &tab = *iter;
-
-		// VScroll bar
-		SCROLLINFO si;
-		si.cbSize = sizeof(SCROLLINFO);
-		si.fMask = SIF_ALL;
-		si.nMin = 0;
-		si.nMax = tab.curPt.y - 2;	// max is exclusive
-		si.nPage = dlgSize.cy;
-		si.nPos = 0;
-		SetScrollInfo(tab.hDlg, SB_VERT, &si, TRUE);
-
-		// HScroll bar
-		// NOTE: ReactOS 0.4.13 is showing an HScroll bar, even though
-		// the child dialog doesn't have WS_HSCROLL set.
-		si.nMin = 0;
-		si.nMax = 1;
-		si.nPage = 2;
-		si.nPos = 0;
-		SetScrollInfo(tab.hDlg, SB_HORZ, &si, TRUE);
-	}
-
-	// Initial update of RFT_MULTI_STRING fields.
-	if (!vecStringMulti.empty()) {
-		def_lc = pFields->defaultLanguageCode();
-		updateMulti(0);
+	// FIXME: Separate child dialog for no tabs.
+
+	// VScroll bar
+	SCROLLINFO si;
+	si.cbSize = sizeof(SCROLLINFO);
+	si.fMask = SIF_ALL;
+	si.nMin = 0;
+	si.nMax = tab.curPt.y - 2;	// max is exclusive
+	si.nPage = dlgSize.cy;
+	si.nPos = 0;
+	SetScrollInfo(tab.hDlg, SB_VERT, &si, TRUE);
+
+	// HScroll bar
+	// NOTE: ReactOS 0.4.13 is showing an HScroll bar, even though
+	// the child dialog doesn't have WS_HSCROLL set.
+	si.nMin = 0;
+	si.nMax = 1;
+	si.nPage = 2;
+	si.nPos = 0;
+	SetScrollInfo(tab.hDlg, SB_HORZ, &si, TRUE);
+
+	if (hasMulti && isFullyInit) {
+		// Tab was created after the dialog was initialized.
+		// Show the multi-language fields in the selected language.
+		updateMulti(cboLanguage ? LanguageComboBox_GetSelectedLC(cboLanguage) : 0);
 	}
-
-	// Check for "viewed" achievements.
-	romData->checkViewedAchievements();
-
-	// Register for WTS session notifications. (Remote Desktop)
-	wts.registerSessionNotification(hDlgSheet, NOTIFY_FOR_THIS_SESSION);
-
-	// Window is fully initialized.
-	isFullyInit = true;
 }
 
 /**
@@ -3329,7 +3466,7 @@ inline BOOL RP_ShellPropSheetExtPrivate::ListView_GetDispInfo(NMLVDISPINFO *plvd
 		// ListView data not found...
 		return FALSE;
 	}
-	const LvData &lvData = iter_lvData->second;
+	LvData &lvData = iter_lvData->second;
 
 	assert(lvData.vvStr.size() == lvData.vSortMap.size());
 	if (lvData.vvStr.size() != lvData.vSortMap.size()) {
@@ -3383,7 +3520,11 @@ inline BOOL RP_ShellPropSheetExtPrivate::ListView_GetDispInfo(NMLVDISPINFO *plvd
 					return FALSE;
 				}
 
-				const int iImage = lvData.vImageList[iItem];
+				int iImage = lvData.vImageList[iItem];
+				if (iImage == LvData::ICON_NOT_LOADED) {
+					// Icon hasn't been loaded yet.
+					iImage = loadListDataIcon(plvdi->hdr.hwndFrom, lvData, iItem);
+				}
 				if (iImage >= 0) {
 					// Set the ImageList index.
 					plvItem->iImage = iImage;
@@ -3549,9 +3690,13 @@ INT_PTR RP_ShellPropSheetExt_Private::DlgProc_WM_NOTIFY(HWND hDlg, NMHDR *pHdr)
 
 			// Tab widget. Show the selected tab.
 			int newTabIndex = TabCtrl_GetCurSel(tabWidget);
+			auto &newTab = tabs[newTabIndex];
+			if (!newTab.isInit) {
+				// Create the field widgets before showing the tab.
+				initTabFields(newTabIndex);
+			}
 			ShowWindow(tabs[curTabIndex].hDlg, SW_HIDE);
 			curTabIndex = newTabIndex;
-			auto &newTab = tabs[newTabIndex];
 			ShowWindow(newTab.hDlg, SW_SHOW);
 			break;
 		}
@@ -120,7 +120,7 @@ IFACEMETHODIMP RP_ThumbnailProvider::GetThumbnail(UINT cx, HBITMAP *phbmp, WTS_A
 
 	CreateThumbnail::GetThumbnailOutParams_t outParams;
 	outParams.retImg = nullptr;
-	int ret = d->thumbnailer.getThumbnail(d->file, cx, &outParams);
+	int ret = d->thumbnailer.getThumbnailCached(d->file, cx, &outParams);
 	if (ret != 0 || !outParams.retImg) {
 		// ROM is not supported. Use the fallback.
 		if (outParams.retImg) {
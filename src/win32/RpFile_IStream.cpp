@@ -25,6 +25,13 @@ using std::unique_ptr;
 // zlib buffer size.
 #define ZLIB_BUFFER_SIZE 16384
 
+// Read-ahead buffer size and alignment.
+// Reads are done in aligned blocks to minimize the number of
+// IStream::Read() calls, which can be expensive for network
+// streams and streams provided by the Windows Search indexer.
+#define READ_BUFFER_SIZE 65536
+#define READ_BUFFER_ALIGN 4096
+
 #ifdef _MSC_VER
 // MSVC: Exception handling for /DELAYLOAD.
 #include "libwin32common/DelayLoadHelper.h"
@@ -51,10 +58,25 @@ RpFile_IStream::RpFile_IStream(IStream *pStream, bool gzip)
 	, m_pZbuf(nullptr)
 	, m_zbufLen(0)
 	, m_zcurPos(0)
+	, m_pos(0)
+	, m_streamPos(-1)
+	// Read-ahead buffer
+	, m_pRdBuf(nullptr)
+	, m_rdBufPos(0)
+	, m_rdBufLen(0)
 {
 	// TODO: Proper writable check.
 	m_isWritable = true;
 
+	// Get the initial stream position.
+	LARGE_INTEGER li;
+	ULARGE_INTEGER uliPos;
+	li.QuadPart = 0;
+	if (SUCCEEDED(m_pStream->Seek(li, STREAM_SEEK_CUR, &uliPos))) {
+		m_pos = static_cast<off64_t>(uliPos.QuadPart);
+		m_streamPos = m_pos;
+	}
+
 	if (gzip) {
 #if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
 		// Delay load verification.
@@ -70,9 +92,6 @@ RpFile_IStream::RpFile_IStream(IStream *pStream, bool gzip)
 		get_crc_table();
 #endif /* defined(_MSC_VER) && defined(ZLIB_IS_DLL) */
 
-		// for IStream::Seek()
-		LARGE_INTEGER li;
-
 		// Check for a gzipped file.
 		uint16_t gzmagic;
 		ULONG cbRead;
@@ -131,13 +150,16 @@ RpFile_IStream::RpFile_IStream(IStream *pStream, bool gzip)
 		}
 
 		// Rewind back to the beginning of the stream.
+		m_pos = 0;
 		li.QuadPart = 0;
-		m_pStream->Seek(li, STREAM_SEEK_SET, nullptr);
+		hr = m_pStream->Seek(li, STREAM_SEEK_SET, nullptr);
+		m_streamPos = (SUCCEEDED(hr) ? 0 : -1);
 	}
 }
 
 RpFile_IStream::~RpFile_IStream()
 {
+	free(m_pRdBuf);
 	free(m_pZbuf);
 
 	if (m_pZstm) {
@@ -148,75 +170,57 @@ RpFile_IStream::~RpFile_IStream()
 }
 
 /**
- * Copy the zlib stream from another RpFile_IStream.
- * @param other
- * @return 0 on success; non-zero on error.
+ * Seek the underlying IStream, if it isn't already at the specified position.
+ * @param pos Stream position.
+ * @return 0 on success; -1 on error.
  */
-int RpFile_IStream::copyZlibStream(const RpFile_IStream &other)
+int RpFile_IStream::seekStream(off64_t pos)
 {
-	int ret = 0;
-
-	// Delete the current stream.
-	if (m_pZstm) {
-		inflateEnd(m_pZstm);
-		free(m_pZstm);
+	if (pos == m_streamPos) {
+		// No seek necessary.
+		return 0;
 	}
-	free(m_pZbuf);
 
-	if (!other.m_pZstm) {
-		// No stream to copy.
-		// Zero everything out.
-		goto zero_all_values;
+	LARGE_INTEGER dlibMove;
+	dlibMove.QuadPart = pos;
+	HRESULT hr = m_pStream->Seek(dlibMove, STREAM_SEEK_SET, nullptr);
+	if (FAILED(hr)) {
+		// TODO: Convert hr to POSIX?
+		m_lastError = EIO;
+		m_streamPos = -1;
+		return -1;
 	}
 
-	// Copy the stream.
-	m_pZstm = static_cast<z_stream*>(malloc(sizeof(z_stream)));
-	if (!m_pZstm) {
-		// Error allocating the z_stream.
-		m_lastError = ENOMEM;
-		ret = -1;
-		goto zero_all_values;
-	}
-	m_pZbuf = static_cast<uint8_t*>(malloc(ZLIB_BUFFER_SIZE));
-	if (!m_pZbuf) {
-		// Error allocating the zlib buffer.
-		free(m_pZstm);
-		m_lastError = ENOMEM;
-		ret = -1;
-		goto zero_all_values;
-	}		
-
-	// Copy the zlib stream.
-	// NOTE: inflateCopy() handles the internal_state struct.
-	inflateCopy(m_pZstm, other.m_pZstm);
-	m_pZstm->next_in = nullptr;
-	m_pZstm->next_out = nullptr;
-
-	// Copy the zlib buffer.
-	memcpy(m_pZbuf, other.m_pZbuf, other.m_zbufLen);
-
-	// Copy the other values.
-	m_z_uncomp_sz = other.m_z_uncomp_sz;
-	m_z_filepos = other.m_z_filepos;
-	m_z_realpos = other.m_z_realpos;
-	m_zbufLen = other.m_zbufLen;
-	m_zcurPos = other.m_zcurPos;
-
-	// We're done here.
+	m_streamPos = pos;
 	return 0;
+}
 
-zero_all_values:
-	// Zero everything.
-	m_pZstm = nullptr;
-	m_pZbuf = nullptr;
+/**
+ * Read data from the underlying IStream at m_pos, bypassing the read-ahead buffer.
+ * @param ptr Output data buffer.
+ * @param size Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFile_IStream::readDirect(void *ptr, size_t size)
+{
+	if (seekStream(m_pos) != 0) {
+		// Unable to seek.
+		return 0;
+	}
 
-	m_z_uncomp_sz = 0;
-	m_z_filepos = 0;
-	m_z_realpos = 0;
-	m_zbufLen = 0;
-	m_zcurPos = 0;
+	ULONG cbRead;
+	HRESULT hr = m_pStream->Read(ptr, (ULONG)size, &cbRead);
+	if (FAILED(hr)) {
+		// An error occurred.
+		// TODO: Convert hr to POSIX?
+		m_lastError = EIO;
+		m_streamPos = -1;
+		return 0;
+	}
 
-	return ret;
+	m_pos += cbRead;
+	m_streamPos = m_pos;
+	return (size_t)cbRead;
 }
 
 /**
@@ -237,6 +241,8 @@ void RpFile_IStream::close(void)
 	if (m_pStream) {
 		m_pStream.Release();
 	}
+	m_rdBufLen = 0;
+	m_streamPos = -1;
 }
 
 /**
@@ -260,22 +266,14 @@ size_t RpFile_IStream::read(void *ptr, size_t size)
 		m_pZstm->next_out = static_cast<Bytef*>(ptr);
 		m_pZstm->avail_out = static_cast<uInt>(size);
 
-		// Only seek if we need to read data.
-		bool didSeek = false;
-
 		if (m_zcurPos == m_zbufLen) {
 			// Need to read more data from the gzipped file.
-			if (!didSeek) {
-				// Seek to the last real position.
-				LARGE_INTEGER dlibMove;
-				dlibMove.QuadPart = m_z_realpos;
-				hr = m_pStream->Seek(dlibMove, STREAM_SEEK_SET, nullptr);
-				if (FAILED(hr)) {
-					// Unable to seek.
-					m_lastError = EIO;
-					return 0;
-				}
-				didSeek = true;
+			// Seek to the last real position.
+			// NOTE: seekStream() skips the seek if the stream
+			// is already at this position.
+			if (seekStream(m_z_realpos) != 0) {
+				// Unable to seek.
+				return 0;
 			}
 			// S_FALSE: End of file. Continue processing with
 			//          whatever's left.
@@ -285,9 +283,11 @@ size_t RpFile_IStream::read(void *ptr, size_t size)
 			if (FAILED(hr) && hr != S_FALSE) {
 				// Read error.
 				m_lastError = EIO;
+				m_streamPos = -1;
 				return 0;
 			}
 			m_z_realpos += m_zbufLen;
+			m_streamPos = m_z_realpos;
 			m_zcurPos = 0;
 		}
 
@@ -321,17 +321,9 @@ size_t RpFile_IStream::read(void *ptr, size_t size)
 			}
 
 			// Read more data from the gzipped file.
-			if (!didSeek) {
-				// Seek to the last real position.
-				LARGE_INTEGER dlibMove;
-				dlibMove.QuadPart = m_z_realpos;
-				hr = m_pStream->Seek(dlibMove, STREAM_SEEK_SET, nullptr);
-				if (FAILED(hr)) {
-					// Unable to seek.
-					m_lastError = EIO;
-					return 0;
-				}
-				didSeek = true;
+			if (seekStream(m_z_realpos) != 0) {
+				// Unable to seek.
+				return 0;
 			}
 
 			m_zcurPos = 0;
@@ -343,10 +335,12 @@ size_t RpFile_IStream::read(void *ptr, size_t size)
 			if (FAILED(hr) && hr != S_FALSE) {
 				// Read error.
 				m_lastError = EIO;
+				m_streamPos = -1;
 				m_zbufLen = 0;
 				return 0;
 			}
 			m_z_realpos += m_zbufLen;
+			m_streamPos = m_z_realpos;
 		} while (m_pZstm->avail_out > 0);
 
 		// Adjust the current seek pointer based on how much data was read.
@@ -357,16 +351,69 @@ size_t RpFile_IStream::read(void *ptr, size_t size)
 		return sz_read;
 	}
 
+	if (size == 0) {
+		return 0;
+	}
+
+	// Copy data from the read-ahead buffer, if available.
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t total = 0;
+	if (m_rdBufLen > 0 && m_pos >= m_rdBufPos && m_pos < m_rdBufPos + m_rdBufLen) {
+		const size_t offset = static_cast<size_t>(m_pos - m_rdBufPos);
+		const size_t sz_copy = std::min(size, static_cast<size_t>(m_rdBufLen) - offset);
+		memcpy(ptr8, &m_pRdBuf[offset], sz_copy);
+		m_pos += sz_copy;
+		total += sz_copy;
+		ptr8 += sz_copy;
+		size -= sz_copy;
+		if (size == 0) {
+			// All data was read from the buffer.
+			return total;
+		}
+	}
+
+	if (size >= READ_BUFFER_SIZE) {
+		// Large read. Read directly into the output buffer.
+		return total + readDirect(ptr8, size);
+	}
+
+	if (!m_pRdBuf) {
+		m_pRdBuf = static_cast<uint8_t*>(malloc(READ_BUFFER_SIZE));
+		if (!m_pRdBuf) {
+			// malloc() failed. Read directly into the output buffer.
+			return total + readDirect(ptr8, size);
+		}
+	}
+
+	// Refill the read-ahead buffer, starting at an aligned block.
+	const off64_t bufPos = m_pos & ~static_cast<off64_t>(READ_BUFFER_ALIGN - 1);
+	m_rdBufLen = 0;
+	if (seekStream(bufPos) != 0) {
+		// Unable to seek.
+		return total;
+	}
 	ULONG cbRead;
-	hr = m_pStream->Read(ptr, (ULONG)size, &cbRead);
+	hr = m_pStream->Read(m_pRdBuf, READ_BUFFER_SIZE, &cbRead);
 	if (FAILED(hr)) {
 		// An error occurred.
 		// TODO: Convert hr to POSIX?
 		m_lastError = EIO;
-		return 0;
+		m_streamPos = -1;
+		return total;
 	}
-
-	return (size_t)cbRead;
+	m_rdBufPos = bufPos;
+	m_rdBufLen = cbRead;
+	m_streamPos = bufPos + cbRead;
+
+	const size_t offset = static_cast<size_t>(m_pos - bufPos);
+	if (offset >= cbRead) {
+		// End of file.
+		return total;
+	}
+	const size_t sz_copy = std::min(size, static_cast<size_t>(cbRead) - offset);
+	memcpy(ptr8, &m_pRdBuf[offset], sz_copy);
+	m_pos += sz_copy;
+	return total + sz_copy;
 }
 
 /**
@@ -389,15 +436,26 @@ size_t RpFile_IStream::write(const void *ptr, size_t size)
 		return 0;
 	}
 
+	// Invalidate the read-ahead buffer.
+	m_rdBufLen = 0;
+
+	if (seekStream(m_pos) != 0) {
+		// Unable to seek.
+		return 0;
+	}
+
 	ULONG cbWritten;
 	HRESULT hr = m_pStream->Write(ptr, (ULONG)size, &cbWritten);
 	if (FAILED(hr)) {
 		// An error occurred.
 		// TODO: Convert HRESULT to POSIX?
 		m_lastError = EIO;
+		m_streamPos = -1;
 		return 0;
 	}
 
+	m_pos += cbWritten;
+	m_streamPos = m_pos;
 	return (size_t)cbWritten;
 }
 
@@ -408,9 +466,6 @@ size_t RpFile_IStream::write(const void *ptr, size_t size)
  */
 int RpFile_IStream::seek(off64_t pos)
 {
-	LARGE_INTEGER dlibMove;
-	HRESULT hr;
-
 	if (!m_pStream) {
 		m_lastError = EBADF;
 		return -1;
@@ -436,10 +491,9 @@ int RpFile_IStream::seek(off64_t pos)
 
 			// Seek to the beginning of the real file.
 			m_z_realpos = 0;
-			dlibMove.QuadPart = 0;
-			hr = m_pStream->Seek(dlibMove, STREAM_SEEK_SET, nullptr);
+			const int sret = seekStream(0);
 
-			if (err != Z_OK || FAILED(hr)) {
+			if (err != Z_OK || sret != 0) {
 				// Error initializing the zlib stream
 				// and/or rewinding the base stream.
 				// Cannot continue with this stream.
@@ -481,38 +535,15 @@ int RpFile_IStream::seek(off64_t pos)
 		return 0;
 	}
 
-	// Seek in the base stream.
-	dlibMove.QuadPart = pos;
-	hr = m_pStream->Seek(dlibMove, STREAM_SEEK_SET, nullptr);
-	if (FAILED(hr)) {
-		// TODO: Convert hr to POSIX?
-		m_lastError = EIO;
+	if (pos < 0) {
+		m_lastError = EINVAL;
 		return -1;
 	}
 
-	if (m_pZstm) {
-		// Reset the zlib stream.
-		m_z_filepos = 0;
-		m_z_realpos = 0;
-		m_zbufLen = 0;
-		m_zcurPos = 0;
-		inflateEnd(m_pZstm);
-		memset(m_pZstm, 0, sizeof(*m_pZstm));
-		int err = inflateInit2(m_pZstm, 16+MAX_WBITS);
-		if (err != Z_OK) {
-			// Error initializing the zlib stream...
-			// Cannot continue with this stream.
-			free(m_pZstm);
-			free(m_pZbuf);
-			m_pZstm = nullptr;
-			m_pZbuf = nullptr;
-			m_z_uncomp_sz = 0;
-
-			m_pStream.Release();
-			return -1;
-		}
-	}
-
+	// Don't seek the base stream here. The seek is done by
+	// the next read() or write(), and is skipped if the
+	// stream is already at the requested position.
+	m_pos = pos;
 	return 0;
 }
 
@@ -532,17 +563,7 @@ off64_t RpFile_IStream::tell(void)
 		return static_cast<off64_t>(m_z_filepos);
 	}
 
-	LARGE_INTEGER dlibMove;
-	ULARGE_INTEGER ulibNewPosition;
-	dlibMove.QuadPart = 0;
-	HRESULT hr = m_pStream->Seek(dlibMove, STREAM_SEEK_CUR, &ulibNewPosition);
-	if (FAILED(hr)) {
-		// TODO: Convert HRESULT to POSIX?
-		m_lastError = EIO;
-		return -1;
-	}
-
-	return static_cast<off64_t>(ulibNewPosition.QuadPart);
+	return m_pos;
 }
 
 /**
@@ -565,21 +586,13 @@ int RpFile_IStream::truncate(off64_t size)
 		return -1;
 	}
 
-	// Get the current stream position.
-	LARGE_INTEGER dlibMove;
-	ULARGE_INTEGER ulibNewPosition;
-	dlibMove.QuadPart = 0;
-	HRESULT hr = m_pStream->Seek(dlibMove, STREAM_SEEK_CUR, &ulibNewPosition);
-	if (FAILED(hr)) {
-		// TODO: Convert HRESULT to POSIX?
-		m_lastError = EIO;
-		return -1;
-	}
+	// Invalidate the read-ahead buffer.
+	m_rdBufLen = 0;
 
 	// Truncate the stream.
 	ULARGE_INTEGER ulibNewSize;
 	ulibNewSize.QuadPart = static_cast<ULONGLONG>(size);
-	hr = m_pStream->SetSize(ulibNewSize);
+	HRESULT hr = m_pStream->SetSize(ulibNewSize);
 	if (FAILED(hr)) {
 		// TODO: Convert HRESULT to POSIX?
 		m_lastError = EIO;
@@ -588,14 +601,8 @@ int RpFile_IStream::truncate(off64_t size)
 
 	// If the previous position was past the new
 	// stream size, reset the pointer.
-	if (ulibNewPosition.QuadPart > ulibNewSize.QuadPart) {
-		dlibMove.QuadPart = size;
-		hr = m_pStream->Seek(dlibMove, STREAM_SEEK_SET, nullptr);
-		if (FAILED(hr)) {
-			// TODO: Convert HRESULT to POSIX?
-			m_lastError = EIO;
-			return -1;
-		}
+	if (m_pos > size) {
+		m_pos = size;
 	}
 
 	// Stream truncated.
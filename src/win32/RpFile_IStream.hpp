@@ -136,12 +136,31 @@ class RpFile_IStream final : public LibRpFile::IRpFile
 		ULONG m_zbufLen;
 		ULONG m_zcurPos;
 
+		// Logical file position. (uncompressed files only)
+		off64_t m_pos;
+		// Current position of m_pStream, or -1 if unknown.
+		// Used to skip IStream::Seek() if the position hasn't changed.
+		off64_t m_streamPos;
+
+		// Read-ahead buffer. (uncompressed files only)
+		uint8_t *m_pRdBuf;
+		off64_t m_rdBufPos;	// file position of m_pRdBuf[0]
+		ULONG m_rdBufLen;	// number of valid bytes in m_pRdBuf
+
 		/**
-		 * Copy the zlib stream from another RpFile_IStream.
-		 * @param other
-		 * @return 0 on success; non-zero on error.
+		 * Seek the underlying IStream, if it isn't already at the specified position.
+		 * @param pos Stream position.
+		 * @return 0 on success; -1 on error.
+		 */
+		int seekStream(off64_t pos);
+
+		/**
+		 * Read data from the underlying IStream at m_pos, bypassing the read-ahead buffer.
+		 * @param ptr Output data buffer.
+		 * @param size Amount of data to read, in bytes.
+		 * @return Number of bytes read.
 		 */
-		int copyZlibStream(const RpFile_IStream &other);
+		size_t readDirect(void *ptr, size_t size);
 };
 
 #endif /* __ROMPROPERTIES_WIN32_RPFILE_ISTREAM_HPP__ */
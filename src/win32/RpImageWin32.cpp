@@ -28,6 +28,77 @@ namespace Gdiplus {
 #include <gdiplus.h>
 #include "librptexture/img/GdiplusHelper.hpp"
 
+/**
+ * Convert a row of CI8 pixels to a monochrome icon mask row.
+ * Pixels matching tr_idx are transparent. (0)
+ * Standard version using regular C++ code.
+ * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+ * @param src	[in] CI8 pixels.
+ * @param width	[in] Width, in pixels.
+ * @param tr_idx	[in] Transparent color index.
+ */
+void RpImageWin32::maskRow_CI8_cpp(uint8_t *dest, const uint8_t *src, unsigned int width, uint8_t tr_idx)
+{
+	unsigned int x = width;
+	for (; x > 7; x -= 8) {
+		uint8_t pxMono = 0;
+		for (unsigned int bit = 8; bit > 0; bit--, src++) {
+			// MSB == left-most pixel.
+			pxMono <<= 1;
+			pxMono |= (*src != tr_idx);
+		}
+		*dest++ = pxMono;
+	}
+
+	// Handle unaligned bits.
+	if (x > 0) {
+		uint8_t pxMono = 0;
+		for (unsigned int bit = x; bit > 0; bit--, src++) {
+			// MSB == left-most pixel.
+			pxMono <<= 1;
+			pxMono |= (*src != tr_idx);
+		}
+		// Not 8px aligned; shift the bits over.
+		pxMono <<= (8 - x);
+		*dest = pxMono;
+	}
+}
+
+/**
+ * Convert a row of ARGB32 pixels to a monochrome icon mask row.
+ * Pixels with a 0 alpha channel are transparent. (0)
+ * Standard version using regular C++ code.
+ * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+ * @param src	[in] ARGB32 pixels.
+ * @param width	[in] Width, in pixels.
+ */
+void RpImageWin32::maskRow_ARGB32_cpp(uint8_t *dest, const uint32_t *src, unsigned int width)
+{
+	unsigned int x = width;
+	for (; x > 7; x -= 8) {
+		uint8_t pxMono = 0;
+		for (unsigned int bit = 8; bit > 0; bit--, src++) {
+			// MSB == left-most pixel.
+			pxMono <<= 1;
+			pxMono |= ((*src & 0xFF000000) != 0);
+		}
+		*dest++ = pxMono;
+	}
+
+	// Handle unaligned bits.
+	if (x > 0) {
+		uint8_t pxMono = 0;
+		for (unsigned int bit = x; bit > 0; bit--, src++) {
+			// MSB == left-most pixel.
+			pxMono <<= 1;
+			pxMono |= ((*src & 0xFF000000) != 0);
+		}
+		// Not 8px aligned; shift the bits over.
+		pxMono <<= (8 - x);
+		*dest = pxMono;
+	}
+}
+
 /**
  * Convert an rp_image to a HBITMAP for use as an icon mask.
  * @param image rp_image.
@@ -59,7 +130,7 @@ HBITMAP RpImageWin32::toHBITMAP_mask(const rp_image *image)
 	// NOTE: Monochrome bitmaps have a stride of 32px. (4 bytes)
 	const int width = image->width();
 	// Stride adjustment per line, in bytes.
-	const int stride = ((width + 31) & 32) / 8;
+	const int stride = ((width + 31) & ~31) / 8;
 	// (Difference between used bytes and unused bytes.)
 	const int stride_adj = (width % 32 == 0 ? 0 : ((32 - (width % 32)) / 8));
 	// Icon size. (stride * height)
@@ -93,6 +164,8 @@ HBITMAP RpImageWin32::toHBITMAP_mask(const rp_image *image)
 	// so this is vertically flipped.
 
 	// AND mask: Parse the original image.
+	// Each row uses (width + 7) / 8 bytes; the rest of the stride is cleared.
+	const unsigned int row_bytes = ((unsigned int)width + 7) / 8;
 	switch (image->format()) {
 		case rp_image::Format::CI8: {
 			// Get the transparent color index.
@@ -103,29 +176,8 @@ HBITMAP RpImageWin32::toHBITMAP_mask(const rp_image *image)
 				for (int y = image->height()-1; y >= 0; y--) {
 					// TODO: Use stride arithmetic instead of image->scanLine().
 					const uint8_t *src = static_cast<const uint8_t*>(image->scanLine(y));
-					unsigned int x = (unsigned int)width;
-					for (unsigned int x = (unsigned int)width; x > 7; x -= 8) {
-						uint8_t pxMono = 0;
-						for (unsigned int bit = 8; bit > 0; bit--, src++) {
-							// MSB == left-most pixel.
-							pxMono <<= 1;
-							pxMono |= (*src != tr_idx);
-						}
-						*dest++ = pxMono;
-					}
-
-					// Handle unaligned bits.
-					if (x > 0) {
-						uint8_t pxMono = 0;
-						for (unsigned int bit = x; bit > 0; bit--, src++) {
-							// MSB == left-most pixel.
-							pxMono <<= 1;
-							pxMono |= (*src != tr_idx);
-						}
-						// Not 8px aligned; shift the bits over.
-						pxMono <<= (8 - x);
-						*dest++ = pxMono;
-					}
+					maskRow_CI8(dest, src, (unsigned int)width, static_cast<uint8_t>(tr_idx));
+					dest += row_bytes;
 
 					// Clear out unused bytes and go to the next line.
 					for (unsigned int x = (unsigned int)stride_adj; x > 0; x--) {
@@ -143,34 +195,12 @@ HBITMAP RpImageWin32::toHBITMAP_mask(const rp_image *image)
 
 		case rp_image::Format::ARGB32: {
 			// Find all pixels with a 0 alpha channel.
-			memset(pvBits, 0xFF, icon_sz);
 			uint8_t *dest = pvBits;
 			for (int y = image->height()-1; y >= 0; y--) {
 				// TODO: Use stride arithmetic instead of image->scanLine().
 				const uint32_t *src = static_cast<const uint32_t*>(image->scanLine(y));
-				unsigned int x = (unsigned int)width;
-				for (; x > 7; x -= 8) {
-					uint8_t pxMono = 0;
-					for (unsigned int bit = 8; bit > 0; bit--, src++) {
-						// MSB == left-most pixel.
-						pxMono <<= 1;
-						pxMono |= ((*src & 0xFF000000) != 0);
-					}
-					*dest++ = pxMono;
-				}
-
-				// Handle unaligned bits.
-				if (x > 0) {
-					uint8_t pxMono = 0;
-					for (unsigned int bit = x; bit > 0; bit--, src++) {
-						// MSB == left-most pixel.
-						pxMono <<= 1;
-						pxMono |= ((*src & 0xFF000000) != 0);
-					}
-					// Not 8px aligned; shift the bits over.
-					pxMono <<= (8 - x);
-					*dest++ = pxMono;
-				}
+				maskRow_ARGB32(dest, src, (unsigned int)width);
+				dest += row_bytes;
 
 				// Clear out unused bytes and go to the next line.
 				for (unsigned int x = (unsigned int)stride_adj; x > 0; x--) {
@@ -14,9 +14,19 @@ namespace LibRpTexture {
 	class rp_image;
 }
 
+#include "librpcpu/cpu_dispatch.h"
+
 // C includes.
 #include <stdint.h>
 
+#if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
+# include "librpcpu/cpuflags_x86.h"
+# define RPIMAGEWIN32_HAS_SSE2 1
+#endif
+#ifdef RP_CPU_AMD64
+# define RPIMAGEWIN32_ALWAYS_HAS_SSE2 1
+#endif
+
 class RpImageWin32
 {
 	private:
@@ -25,6 +35,70 @@ class RpImageWin32
 	private:
 		RP_DISABLE_COPY(RpImageWin32)
 
+	private:
+		/**
+		 * Convert a row of CI8 pixels to a monochrome icon mask row.
+		 * Pixels matching tr_idx are transparent. (0)
+		 * Standard version using regular C++ code.
+		 * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+		 * @param src	[in] CI8 pixels.
+		 * @param width	[in] Width, in pixels.
+		 * @param tr_idx	[in] Transparent color index.
+		 */
+		static void maskRow_CI8_cpp(uint8_t *dest, const uint8_t *src, unsigned int width, uint8_t tr_idx);
+
+		/**
+		 * Convert a row of ARGB32 pixels to a monochrome icon mask row.
+		 * Pixels with a 0 alpha channel are transparent. (0)
+		 * Standard version using regular C++ code.
+		 * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+		 * @param src	[in] ARGB32 pixels.
+		 * @param width	[in] Width, in pixels.
+		 */
+		static void maskRow_ARGB32_cpp(uint8_t *dest, const uint32_t *src, unsigned int width);
+
+#ifdef RPIMAGEWIN32_HAS_SSE2
+		/**
+		 * Convert a row of CI8 pixels to a monochrome icon mask row.
+		 * Pixels matching tr_idx are transparent. (0)
+		 * SSE2-optimized version.
+		 * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+		 * @param src	[in] CI8 pixels.
+		 * @param width	[in] Width, in pixels.
+		 * @param tr_idx	[in] Transparent color index.
+		 */
+		static void maskRow_CI8_sse2(uint8_t *dest, const uint8_t *src, unsigned int width, uint8_t tr_idx);
+
+		/**
+		 * Convert a row of ARGB32 pixels to a monochrome icon mask row.
+		 * Pixels with a 0 alpha channel are transparent. (0)
+		 * SSE2-optimized version.
+		 * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+		 * @param src	[in] ARGB32 pixels.
+		 * @param width	[in] Width, in pixels.
+		 */
+		static void maskRow_ARGB32_sse2(uint8_t *dest, const uint32_t *src, unsigned int width);
+#endif /* RPIMAGEWIN32_HAS_SSE2 */
+
+		/**
+		 * Convert a row of CI8 pixels to a monochrome icon mask row.
+		 * Pixels matching tr_idx are transparent. (0)
+		 * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+		 * @param src	[in] CI8 pixels.
+		 * @param width	[in] Width, in pixels.
+		 * @param tr_idx	[in] Transparent color index.
+		 */
+		static inline void maskRow_CI8(uint8_t *dest, const uint8_t *src, unsigned int width, uint8_t tr_idx);
+
+		/**
+		 * Convert a row of ARGB32 pixels to a monochrome icon mask row.
+		 * Pixels with a 0 alpha channel are transparent. (0)
+		 * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+		 * @param src	[in] ARGB32 pixels.
+		 * @param width	[in] Width, in pixels.
+		 */
+		static inline void maskRow_ARGB32(uint8_t *dest, const uint32_t *src, unsigned int width);
+
 	protected:
 		/**
 		 * Convert an rp_image to a HBITMAP for use as an icon mask.
@@ -107,4 +181,53 @@ class RpImageWin32
 		static HBITMAP getSubBitmap(const LibRpTexture::rp_image *img, int x, int y, int w, int h, UINT dpi = 96);
 };
 
+/**
+ * Convert a row of CI8 pixels to a monochrome icon mask row.
+ * Pixels matching tr_idx are transparent. (0)
+ * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+ * @param src	[in] CI8 pixels.
+ * @param width	[in] Width, in pixels.
+ * @param tr_idx	[in] Transparent color index.
+ */
+inline void RpImageWin32::maskRow_CI8(uint8_t *dest, const uint8_t *src, unsigned int width, uint8_t tr_idx)
+{
+#if defined(RPIMAGEWIN32_ALWAYS_HAS_SSE2)
+	// amd64 always has SSE2.
+	maskRow_CI8_sse2(dest, src, width, tr_idx);
+#else
+# if defined(RPIMAGEWIN32_HAS_SSE2)
+	if (RP_CPU_HasSSE2()) {
+		maskRow_CI8_sse2(dest, src, width, tr_idx);
+	} else
+# endif /* RPIMAGEWIN32_HAS_SSE2 */
+	{
+		maskRow_CI8_cpp(dest, src, width, tr_idx);
+	}
+#endif /* RPIMAGEWIN32_ALWAYS_HAS_SSE2 */
+}
+
+/**
+ * Convert a row of ARGB32 pixels to a monochrome icon mask row.
+ * Pixels with a 0 alpha channel are transparent. (0)
+ * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+ * @param src	[in] ARGB32 pixels.
+ * @param width	[in] Width, in pixels.
+ */
+inline void RpImageWin32::maskRow_ARGB32(uint8_t *dest, const uint32_t *src, unsigned int width)
+{
+#if defined(RPIMAGEWIN32_ALWAYS_HAS_SSE2)
+	// amd64 always has SSE2.
+	maskRow_ARGB32_sse2(dest, src, width);
+#else
+# if defined(RPIMAGEWIN32_HAS_SSE2)
+	if (RP_CPU_HasSSE2()) {
+		maskRow_ARGB32_sse2(dest, src, width);
+	} else
+# endif /* RPIMAGEWIN32_HAS_SSE2 */
+	{
+		maskRow_ARGB32_cpp(dest, src, width);
+	}
+#endif /* RPIMAGEWIN32_ALWAYS_HAS_SSE2 */
+}
+
 #endif /* __ROMPROPERTIES_WIN32_RPIMAGEWIN32_HPP__ */
@@ -0,0 +1,98 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (Win32)                            *
+ * RpImageWin32_sse2.cpp: rp_image to Win32 conversion functions.          *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "RpImageWin32.hpp"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+
+/**
+ * Reverse the byte order within each 64-bit half of an SSE2 register.
+ * This puts the left-most pixel in the MSB of each _mm_movemask_epi8() byte.
+ * @param xmm Register.
+ * @return Register with the bytes reversed in each 64-bit half.
+ */
+static inline __m128i reverse_bytes_64(__m128i xmm)
+{
+	xmm = _mm_shufflelo_epi16(xmm, _MM_SHUFFLE(0,1,2,3));
+	xmm = _mm_shufflehi_epi16(xmm, _MM_SHUFFLE(0,1,2,3));
+	return _mm_or_si128(_mm_slli_epi16(xmm, 8), _mm_srli_epi16(xmm, 8));
+}
+
+/**
+ * Convert a row of CI8 pixels to a monochrome icon mask row.
+ * Pixels matching tr_idx are transparent. (0)
+ * SSE2-optimized version.
+ * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+ * @param src	[in] CI8 pixels.
+ * @param width	[in] Width, in pixels.
+ * @param tr_idx	[in] Transparent color index.
+ */
+void RpImageWin32::maskRow_CI8_sse2(uint8_t *dest, const uint8_t *src, unsigned int width, uint8_t tr_idx)
+{
+	const __m128i xmm_tr_idx = _mm_set1_epi8(static_cast<char>(tr_idx));
+
+	// Process 16 pixels per iteration with SSE2.
+	unsigned int x = width;
+	for (; x > 15; x -= 16, src += 16, dest += 2) {
+		const __m128i xmm_src = reverse_bytes_64(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+
+		// Transparent pixels will be 0xFF.
+		const unsigned int mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(xmm_src, xmm_tr_idx));
+		dest[0] = static_cast<uint8_t>(mask);
+		dest[1] = static_cast<uint8_t>(mask >> 8);
+	}
+
+	// Remaining pixels.
+	if (x > 0) {
+		maskRow_CI8_cpp(dest, src, x, tr_idx);
+	}
+}
+
+/**
+ * Convert a row of ARGB32 pixels to a monochrome icon mask row.
+ * Pixels with a 0 alpha channel are transparent. (0)
+ * SSE2-optimized version.
+ * @param dest	[out] Monochrome mask row. ((width + 7) / 8 bytes)
+ * @param src	[in] ARGB32 pixels.
+ * @param width	[in] Width, in pixels.
+ */
+void RpImageWin32::maskRow_ARGB32_sse2(uint8_t *dest, const uint32_t *src, unsigned int width)
+{
+	const __m128i xmm_alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+	const __m128i xmm_zero = _mm_setzero_si128();
+
+	// Process 16 pixels per iteration with SSE2.
+	unsigned int x = width;
+	for (; x > 15; x -= 16, src += 16, dest += 2) {
+		const __m128i *const xmm_src = reinterpret_cast<const __m128i*>(src);
+
+		// Transparent pixels will be 0xFFFFFFFF.
+		__m128i px0 = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(&xmm_src[0]), xmm_alpha), xmm_zero);
+		__m128i px1 = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(&xmm_src[1]), xmm_alpha), xmm_zero);
+		__m128i px2 = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(&xmm_src[2]), xmm_alpha), xmm_zero);
+		__m128i px3 = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(&xmm_src[3]), xmm_alpha), xmm_zero);
+
+		// Pack the comparison results to one byte per pixel.
+		// Signed saturation keeps 0xFFFFFFFF as 0xFF.
+		const __m128i xmm_px = reverse_bytes_64(
+			_mm_packs_epi16(_mm_packs_epi32(px0, px1), _mm_packs_epi32(px2, px3)));
+
+		const unsigned int mask = ~_mm_movemask_epi8(xmm_px);
+		dest[0] = static_cast<uint8_t>(mask);
+		dest[1] = static_cast<uint8_t>(mask >> 8);
+	}
+
+	// Remaining pixels.
+	if (x > 0) {
+		maskRow_ARGB32_cpp(dest, src, x);
+	}
+}
@@ -575,6 +575,12 @@ int CacheTabPrivate::recursiveScan(const TCHAR *path, list<pair<tstring, DWORD>
 			// Thumbs.db files can be deleted.
 			if (!_tcsicmp(findFileData.cFileName, _T("Thumbs.db")))
 				goto isok;
+			// The download cache's LRU index can be deleted.
+			if (!_tcsicmp(findFileData.cFileName, _T("cache-lru.idx")))
+				goto isok;
+			// Same with the download cache's pack file.
+			if (!_tcsicmp(findFileData.cFileName, _T("cache.pak")))
+				goto isok;
 
 			// Check the extension.
 			size_t len = _tcslen(findFileData.cFileName);